@@ -0,0 +1,65 @@
+// A $match on fields a $project only renames or includes moves ahead of the $project and becomes
+// the query, and a $skip is done by the cursor.
+
+var t = db.jstests_aggregation_cursor_pushdown;
+t.drop();
+
+for (var i = 0; i < 100; i++) {
+    t.insert({_id: i, a: i, b: i % 10, c: 'x'});
+}
+t.ensureIndex({a: 1});
+
+function explainCursor(pipeline) {
+    var explained = t.runCommand('aggregate', {pipeline: pipeline, explain: true});
+    assert.commandWorked(explained);
+    return explained.stages[0]['$cursor'];
+}
+
+function run(pipeline) {
+    return t.aggregate(pipeline).toArray();
+}
+
+// A renamed field.
+var pipeline = [{$project: {x: '$a', b: 1}}, {$match: {x: {$gte: 95}, b: {$ne: 7}}}];
+assert.eq({a: {$gte: 95}, b: {$ne: 7}}, explainCursor(pipeline).query);
+var res = run(pipeline);
+assert.eq(4, res.length);
+res.forEach(function(doc) {
+    assert.eq(doc._id, doc.x, tojson(doc));
+    assert.eq(doc.x % 10, doc.b, tojson(doc));
+    assert(!doc.hasOwnProperty('a'), tojson(doc));
+});
+
+// Also inside $or, and for _id.
+pipeline = [{$project: {x: '$a'}}, {$match: {$or: [{x: 1}, {_id: 2}]}}];
+assert.eq({$or: [{a: 1}, {_id: 2}]}, explainCursor(pipeline).query);
+assert.eq([{_id: 1, x: 1}, {_id: 2, x: 2}], run(pipeline));
+
+// Not when the field is computed, or was excluded.
+pipeline = [{$project: {x: {$add: ['$a', 1]}}}, {$match: {x: 1}}];
+assert.eq({}, explainCursor(pipeline).query);
+assert.eq([{_id: 0, x: 1}], run(pipeline));
+
+pipeline = [{$project: {_id: 0, a: 1}}, {$match: {_id: 1}}];
+assert.eq({}, explainCursor(pipeline).query);
+assert.eq([], run(pipeline));
+
+// Documents dropped by a $skip count toward a $limit after it.
+pipeline = [{$sort: {a: 1}}, {$skip: 10}, {$limit: 5}, {$project: {a: 1}}];
+var cursor = explainCursor(pipeline);
+assert.eq(10, cursor.skip);
+assert.eq(15, cursor.limit);
+assert.eq([{_id: 10, a: 10}, {_id: 11, a: 11}, {_id: 12, a: 12}, {_id: 13, a: 13},
+           {_id: 14, a: 14}],
+          run(pipeline));
+
+pipeline = [{$match: {b: 3}}, {$skip: 8}];
+assert.eq(8, explainCursor(pipeline).skip);
+res = run(pipeline);
+assert.eq(2, res.length);
+assert.eq(83, res[0]._id);
+assert.eq(93, res[1]._id);
+
+pipeline = [{$match: {b: 3}}, {$skip: 8}, {$skip: 2}];
+assert.eq(10, explainCursor(pipeline).skip);
+assert.eq([], run(pipeline));
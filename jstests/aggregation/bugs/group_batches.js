@@ -0,0 +1,62 @@
+// $group processes its input in batches, a run of documents with the same _id at a time.  The
+// results must not depend on how the runs and the batches fall.
+
+var t = db.jstests_aggregation_group_batches;
+t.drop();
+
+// 3000 documents, more than two batches.  In insertion order the 'hour' values come in runs of
+// 100 and the 'mod' values never repeat twice in a row.
+for (var i = 0; i < 3000; i++) {
+    t.insert({_id: i, hour: Math.floor(i / 100), mod: i % 7, n: (i % 2 ? i : i + 0.5)});
+}
+t.insert({_id: 3000, hour: 29, mod: 0, n: "not a number"});
+t.insert({_id: 3001, hour: 29, mod: 1});
+assert.eq(null, db.getLastError());
+
+function check(groupField) {
+    var res = t.aggregate({$sort: {_id: 1}},
+                          {$group: {_id: groupField,
+                                    sum: {$sum: "$n"},
+                                    avg: {$avg: "$n"},
+                                    min: {$min: "$n"},
+                                    max: {$max: "$n"},
+                                    first: {$first: "$_id"},
+                                    last: {$last: "$_id"},
+                                    count: {$sum: 1}}},
+                          {$sort: {_id: 1}}).toArray();
+
+    // Work out the expected groups by hand.
+    var expected = {};
+    t.find().sort({_id: 1}).forEach(function(doc) {
+        var key = doc[groupField.substr(1)];
+        var g = expected[key];
+        if (!g) {
+            g = expected[key] = {sum: 0, numeric: 0, min: null, max: null, first: doc._id,
+                                 count: 0};
+        }
+        if (typeof(doc.n) == "number") {
+            g.sum += doc.n;
+            g.numeric++;
+            if (g.min === null || doc.n < g.min) g.min = doc.n;
+        }
+        if (doc.n !== undefined && (g.max === null || doc.n > g.max || typeof(doc.n) == "string"))
+            g.max = doc.n;
+        g.last = doc._id;
+        g.count++;
+    });
+
+    assert.eq(Object.keySet(expected).length, res.length);
+    res.forEach(function(g) {
+        var e = expected[g._id];
+        assert.close(e.sum, g.sum, tojson(g));
+        assert.close(e.sum / e.numeric, g.avg, tojson(g));
+        assert.eq(e.min, g.min, tojson(g));
+        assert.eq(e.max, g.max, tojson(g));
+        assert.eq(e.first, g.first, tojson(g));
+        assert.eq(e.last, g.last, tojson(g));
+        assert.eq(e.count, g.count, tojson(g));
+    });
+}
+
+check("$hour");
+check("$mod");
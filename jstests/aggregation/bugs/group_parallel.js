@@ -0,0 +1,56 @@
+// With internalDocumentSourceParallelWorkers set, the stages up to a $group run on several threads
+// and their groups are merged.  The results must be the same as with one thread.
+
+var t = db.jstests_aggregation_group_parallel;
+t.drop();
+
+for (var i = 0; i < 5000; i++) {
+    t.insert({_id: i, key: i % 37, n: i, s: (i % 2 ? 'odd' : 'even')});
+}
+assert.eq(null, db.getLastError());
+
+function setWorkers(n) {
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          internalDocumentSourceParallelWorkers: n}));
+}
+
+var pipeline = [{$match: {n: {$gte: 100}}},
+                {$project: {key: 1, n: 1, s: 1, double: {$multiply: ['$n', 2]}}},
+                {$group: {_id: {key: '$key', s: '$s'},
+                          count: {$sum: 1},
+                          total: {$sum: '$double'},
+                          avg: {$avg: '$n'},
+                          min: {$min: '$n'},
+                          max: {$max: '$n'},
+                          all: {$addToSet: '$s'}}},
+                {$sort: {_id: 1}}];
+
+setWorkers(1);
+var expected = t.aggregate(pipeline).toArray();
+assert.eq(74, expected.length);
+
+setWorkers(4);
+var explained = t.runCommand('aggregate', {pipeline: pipeline, explain: true});
+assert.commandWorked(explained);
+assert.eq(4, explained.stages[1]['$parallel'].workers, tojson(explained));
+assert.eq(expected, t.aggregate(pipeline).toArray());
+
+// Nothing to read, and fewer documents than workers.
+assert.eq([], t.aggregate({$match: {n: -1}}, {$group: {_id: '$key'}}).toArray());
+assert.eq([{_id: 0, count: 2}],
+          t.aggregate({$match: {n: {$in: [0, 37]}}},
+                      {$group: {_id: '$key', count: {$sum: 1}}}).toArray());
+
+// A sorted input is not grouped in parallel.
+explained = t.runCommand('aggregate', {pipeline: [{$sort: {_id: 1}}, {$group: {_id: '$key'}}],
+                                       explain: true});
+assert.commandWorked(explained);
+assert(!explained.stages[1].hasOwnProperty('$parallel'), tojson(explained));
+
+// An error in a worker is returned.
+var res = t.runCommand('aggregate', {pipeline: [{$group: {_id: {$add: ['$s', 1]}}}]});
+assert.commandFailed(res);
+assert.eq(16554, res.code, tojson(res));
+
+setWorkers(1);
+t.drop();
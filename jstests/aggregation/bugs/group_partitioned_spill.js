@@ -0,0 +1,56 @@
+// $group may spill to hash partitions instead of sorted runs.  Either way the groups are the same.
+
+var t = db.jstests_aggregation_group_partitioned_spill;
+t.drop();
+
+var pad = new Array(1024).join('x');
+for (var i = 0; i < 5000; i++) {
+    t.insert({_id: i, key: i % 1500, n: i, pad: pad});
+}
+assert.eq(null, db.getLastError());
+
+var pipeline = [{$group: {_id: '$key',
+                          sum: {$sum: '$n'},
+                          count: {$sum: 1},
+                          first: {$first: '$n'},
+                          pads: {$push: '$pad'}}},
+                {$project: {sum: 1, count: 1, first: 1, numPads: {$size: '$pads'}}}];
+
+function setParams(maxMemoryBytes, partitioned) {
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          internalDocumentSourceGroupMaxMemoryBytes:
+                                              maxMemoryBytes,
+                                          internalDocumentSourceGroupPartitionedSpill:
+                                              partitioned}));
+}
+
+function check(res) {
+    assert.eq(1500, res.length);
+    res.forEach(function(g) {
+        var count = g._id < 500 ? 4 : 3;
+        assert.eq(count, g.count, tojson(g));
+        assert.eq(count, g.numPads, tojson(g));
+        assert.eq(g._id, g.first, tojson(g));
+        var sum = 0;
+        for (var j = 0; j < count; j++) {
+            sum += g._id + 1500 * j;
+        }
+        assert.eq(sum, g.sum, tojson(g));
+    });
+}
+
+// 1MB holds well under half the groups, so both kinds of spill happen.
+setParams(1024 * 1024, false);
+assert.commandFailed(t.runCommand('aggregate', {pipeline: pipeline}));
+check(t.aggregate(pipeline, {allowDiskUsage: true}).toArray());
+
+setParams(1024 * 1024, true);
+assert.commandFailed(t.runCommand('aggregate', {pipeline: pipeline}));
+check(t.aggregate(pipeline, {allowDiskUsage: true}).toArray());
+
+// Small enough that partitions have to be split again.
+setParams(16 * 1024, true);
+check(t.aggregate(pipeline, {allowDiskUsage: true}).toArray());
+
+setParams(100 * 1024 * 1024, false);
+t.drop();
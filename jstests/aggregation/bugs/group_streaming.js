@@ -0,0 +1,61 @@
+// A $group right after a $sort on its _id's fields outputs each group as soon as its input has
+// been read.  The groups must be the same as when the whole input is grouped in memory.
+
+var t = db.jstests_aggregation_group_streaming;
+t.drop();
+
+for (var i = 0; i < 1000; i++) {
+    t.insert({_id: i, a: i % 10, b: i % 3, n: i});
+}
+t.insert({_id: 1000, b: 0, n: 1000});
+t.insert({_id: 1001, a: null, b: 1, n: 1001});
+t.insert({_id: 1002, a: [1, 2], b: 2, n: 1002});
+assert.eq(null, db.getLastError());
+
+// Groups the same input with and without a preceding $sort and checks the results match.
+function check(sort, id) {
+    var group = {$group: {_id: id, sum: {$sum: '$n'}, count: {$sum: 1}, ns: {$push: '$n'}}};
+    var expected = t.aggregate(group, {$sort: {_id: 1}}).toArray();
+    var res = t.aggregate({$sort: sort}, group, {$sort: {_id: 1}}).toArray();
+    assert.eq(expected.length, res.length, tojson(sort));
+    for (var i = 0; i < res.length; i++) {
+        assert.eq(expected[i]._id, res[i]._id, tojson(sort));
+        assert.eq(expected[i].sum, res[i].sum, tojson(res[i]));
+        assert.eq(expected[i].count, res[i].count, tojson(res[i]));
+        assert.eq(expected[i].ns.sort(), res[i].ns.sort(), tojson(res[i]));
+    }
+}
+
+check({a: 1}, '$a');
+check({a: -1, n: 1}, '$a');
+check({a: 1, b: -1}, {a: '$a', b: '$b'});
+check({b: 1, a: 1}, {a: '$a', b: '$b'});
+
+// Groups come out in sort order.
+var res = t.aggregate({$sort: {a: -1}}, {$group: {_id: '$a', count: {$sum: 1}}}).toArray();
+assert.eq([1, 2], res[0]._id);
+assert.eq(null, res[res.length - 1]._id);
+assert.eq(2, res[res.length - 1].count);
+
+// Same again with an index providing the sort, including a multikey one.
+t.ensureIndex({a: 1});
+t.ensureIndex({b: 1, a: 1});
+check({a: 1}, '$a');
+check({a: 1}, {a: '$a'});
+check({b: 1, a: 1}, {a: '$a', b: '$b'});
+t.remove({_id: 1002});
+check({a: 1}, '$a');
+check({b: 1, a: 1}, {a: '$a', b: '$b'});
+
+// A $limit between the $sort and the $group is fine too.
+res = t.aggregate({$sort: {a: 1}},
+                  {$limit: 150},
+                  {$group: {_id: '$a', count: {$sum: 1}}},
+                  {$sort: {_id: 1}}).toArray();
+assert.eq(3, res.length);
+assert.eq(null, res[0]._id);
+assert.eq(2, res[0].count);
+assert.eq(0, res[1]._id);
+assert.eq(100, res[1].count);
+assert.eq(1, res[2]._id);
+assert.eq(48, res[2].count);
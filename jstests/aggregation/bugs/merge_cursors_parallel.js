@@ -0,0 +1,52 @@
+// The merging half of a sharded pipeline reads the shards' cursors on a thread each.  The results
+// must be the same as when it reads them one after the other.
+
+var s = new ShardingTest("aggregation_merge_cursors_parallel", 2, 0, 2);
+s.adminCommand({enablesharding: "test"});
+s.adminCommand({shardcollection: "test.data", key: {_id: 1}});
+s.stopBalancer();
+
+var d = s.getDB("test");
+
+// Enough data that each shard returns several batches.
+var pad = new Array(1024).join('x');
+var N = 20000;
+for (var i = 0; i < N; i++) {
+    d.data.insert({_id: i, key: i % 100, pad: pad});
+}
+d.getLastError();
+
+s.adminCommand({split: "test.data", middle: {_id: N / 2}});
+s.adminCommand({movechunk: "test.data", find: {_id: 0}, to: s.getOther(s.getServer("test")).name});
+
+// The merge runs on the primary shard of the database.
+var merger = s.getServer("test");
+
+function setParallel(parallel) {
+    assert.commandWorked(merger.adminCommand({setParameter: 1,
+                                              internalDocumentSourceMergeCursorsParallelFetch:
+                                                  parallel}));
+}
+
+function check() {
+    var res = d.data.aggregate({$group: {_id: '$key', count: {$sum: 1}, sum: {$sum: '$_id'}}},
+                               {$sort: {_id: 1}}).toArray();
+    assert.eq(100, res.length);
+    for (var i = 0; i < 100; i++) {
+        assert.eq(i, res[i]._id);
+        assert.eq(N / 100, res[i].count);
+        assert.eq(i * N / 100 + 100 * (N / 100) * (N / 100 - 1) / 2, res[i].sum);
+    }
+
+    assert.eq(N, d.data.aggregate({$project: {_id: 1}}).itcount());
+
+    // Stopping early still cleans up after the threads.
+    assert.eq(5, d.data.aggregate({$project: {_id: 1}}, {$limit: 5}).itcount());
+}
+
+setParallel(false);
+check();
+setParallel(true);
+check();
+
+s.stop();
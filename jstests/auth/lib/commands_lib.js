@@ -1470,6 +1470,29 @@ var authCommandsLib = {
                 { runOnDb: secondDbName, rolesAllowed: {} }
             ]
         },
+        {
+            testname: "parallelCollectionScan",
+            command: {parallelCollectionScan: "coll", numCursors: 1},
+            skipSharded: true,
+            setup: function (db) { db.coll.insert({}); },
+            teardown: function (db) { db.coll.drop(); },
+            testcases: [
+                {
+                    runOnDb: firstDbName,
+                    rolesAllowed: roles_readWrite,
+                    requiredPrivileges: [
+                        { resource: {db: firstDbName, collection: "coll"}, actions: ["find"] }
+                    ]
+                },
+                {
+                    runOnDb: secondDbName,
+                    rolesAllowed: roles_readWriteAny,
+                    requiredPrivileges: [
+                        { resource: {db: secondDbName, collection: "coll"}, actions: ["find"] }
+                    ]
+                }
+            ]
+        },
         {
             testname: "ping",
             command: {ping: 1},
@@ -1479,6 +1502,121 @@ var authCommandsLib = {
                 { runOnDb: secondDbName, rolesAllowed: roles_all, requiredPrivileges: [ ] }
             ]
         },
+        {
+            testname: "planCacheClear",
+            command: {planCacheClear: "x"},
+            skipSharded: true,
+            setup: function (db) { db.x.save({a: 1}); },
+            teardown: function (db) { db.x.drop(); },
+            testcases: [
+                {
+                    runOnDb: firstDbName,
+                    rolesAllowed: roles_dbAdmin,
+                    requiredPrivileges: [
+                        { resource: {db: firstDbName, collection: "x"}, actions: ["planCacheWrite"] }
+                    ]
+                },
+                {
+                    runOnDb: secondDbName,
+                    rolesAllowed: roles_dbAdminAny,
+                    requiredPrivileges: [
+                        { resource: {db: secondDbName, collection: "x"}, actions: ["planCacheWrite"] }
+                    ]
+                }
+            ]
+        },
+        {
+            testname: "planCacheClearFilters",
+            command: {planCacheClearFilters: "x"},
+            skipSharded: true,
+            setup: function (db) { db.x.save({a: 1}); },
+            teardown: function (db) { db.x.drop(); },
+            testcases: [
+                {
+                    runOnDb: firstDbName,
+                    rolesAllowed: roles_dbAdmin,
+                    requiredPrivileges: [
+                        { resource: {db: firstDbName, collection: "x"}, actions: ["planCacheWrite"] }
+                    ]
+                },
+                {
+                    runOnDb: secondDbName,
+                    rolesAllowed: roles_dbAdminAny,
+                    requiredPrivileges: [
+                        { resource: {db: secondDbName, collection: "x"}, actions: ["planCacheWrite"] }
+                    ]
+                }
+            ]
+        },
+        {
+            testname: "planCacheListFilters",
+            command: {planCacheListFilters: "x"},
+            skipSharded: true,
+            setup: function (db) { db.x.save({a: 1}); },
+            teardown: function (db) { db.x.drop(); },
+            testcases: [
+                {
+                    runOnDb: firstDbName,
+                    rolesAllowed: roles_readWriteDbAdmin,
+                    requiredPrivileges: [
+                        { resource: {db: firstDbName, collection: "x"}, actions: ["planCacheRead"] }
+                    ]
+                },
+                {
+                    runOnDb: secondDbName,
+                    rolesAllowed: roles_readWriteDbAdminAny,
+                    requiredPrivileges: [
+                        { resource: {db: secondDbName, collection: "x"}, actions: ["planCacheRead"] }
+                    ]
+                }
+            ]
+        },
+        {
+            testname: "planCacheListShapes",
+            command: {planCacheListShapes: "x"},
+            skipSharded: true,
+            setup: function (db) { db.x.save({a: 1}); },
+            teardown: function (db) { db.x.drop(); },
+            testcases: [
+                {
+                    runOnDb: firstDbName,
+                    rolesAllowed: roles_readWriteDbAdmin,
+                    requiredPrivileges: [
+                        { resource: {db: firstDbName, collection: "x"}, actions: ["planCacheRead"] }
+                    ]
+                },
+                {
+                    runOnDb: secondDbName,
+                    rolesAllowed: roles_readWriteDbAdminAny,
+                    requiredPrivileges: [
+                        { resource: {db: secondDbName, collection: "x"}, actions: ["planCacheRead"] }
+                    ]
+                }
+            ]
+        },
+        {
+            testname: "planCacheSetFilter",
+            command: {planCacheSetFilter: "x", query: {a: 1}, indexes: [{a: 1}]},
+            skipSharded: true,
+            setup: function (db) { db.x.save({a: 1}); },
+            teardown: function (db) { db.x.drop(); },
+            testcases: [
+                {
+                    runOnDb: firstDbName,
+                    rolesAllowed: roles_dbAdmin,
+                    requiredPrivileges: [
+                        { resource: {db: firstDbName, collection: "x"}, actions: ["planCacheWrite"] }
+                    ]
+                },
+                {
+                    runOnDb: secondDbName,
+                    rolesAllowed: roles_dbAdminAny,
+                    requiredPrivileges: [
+                        { resource: {db: secondDbName, collection: "x"}, actions: ["planCacheWrite"] }
+                    ]
+                }
+            ]
+        },
         {
             testname: "profile",  
             command: {profile: 0},
@@ -0,0 +1,63 @@
+// benchRun reports latency percentiles, paces itself with opsPerSecond, and drives the write
+// commands and aggregation.
+
+t = db.bench_test4;
+t.drop();
+
+function run( ops, extra ) {
+    var benchArgs = { ops : ops , parallel : 2 , seconds : 1 , host : db.getMongo().host };
+    if (jsTest.options().auth) {
+        benchArgs['db'] = 'admin';
+        benchArgs['username'] = jsTest.options().adminUser;
+        benchArgs['password'] = jsTest.options().adminPassword;
+    }
+    for ( var k in extra )
+        benchArgs[k] = extra[k];
+    var res = benchRun( benchArgs );
+    printjson( res );
+    return res;
+}
+
+function checkPercentiles( p ) {
+    assert( p, "no percentiles" );
+    assert.lte( p.p50, p.p95, tojson( p ) );
+    assert.lte( p.p95, p.p99, tojson( p ) );
+    assert.lte( p.p99, p.p999, tojson( p ) );
+    assert.lte( p.p999, p.max, tojson( p ) );
+}
+
+// Write commands, counted the way the legacy writes are.
+res = run( [ { op : "insert" , ns : t.getFullName() , writeCmd : true ,
+               doc : { x : { "#RAND_INT" : [ 0 , 10 ] } } } ,
+             { op : "update" , ns : t.getFullName() , writeCmd : true , multi : true ,
+               query : { x : 5 } , update : { $inc : { y : 1 } } } ] );
+assert.eq( 0, res.errCount );
+checkPercentiles( res.insertLatencyPercentilesMicros );
+checkPercentiles( res.updateLatencyPercentilesMicros );
+assert.lt( 0, t.count() );
+
+res = run( [ { op : "delete" , ns : t.getFullName() , writeCmd : true , multi : false ,
+               query : { x : { "#RAND_INT" : [ 0 , 10 ] } } } ] );
+checkPercentiles( res.deleteLatencyPercentilesMicros );
+
+// A failed write command is an error the way a failed getLastError is.
+t.insert( { _id : 1 } );
+res = run( [ { op : "insert" , ns : t.getFullName() , writeCmd : true , doc : { _id : 1 } } ],
+           { throwGLE : true , handleErrors : true , hideErrors : true } );
+assert.lt( 0, res.errCount );
+
+// Aggregation.
+res = run( [ { op : "aggregate" , ns : t.getFullName() ,
+               pipeline : [ { $match : { x : { $gte : 5 } } } ,
+                            { $group : { _id : null , n : { $sum : 1 } } } ] } ] );
+assert.eq( 0, res.errCount );
+checkPercentiles( res.aggregateLatencyPercentilesMicros );
+
+// With opsPerSecond, the threads together issue about that many ops a second.
+res = run( [ { op : "findOne" , ns : t.getFullName() , query : { _id : 1 } } ],
+           { opsPerSecond : 100 } );
+checkPercentiles( res.findOneLatencyPercentilesMicros );
+assert.gt( 150, res.query, tojson( res ) );
+assert.lt( 50, res.query, tojson( res ) );
+
+t.drop();
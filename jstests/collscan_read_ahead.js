@@ -0,0 +1,31 @@
+// Collection scans ask the OS to read in the extents ahead of them.  That's only a hint, so scans
+// over many extents return the same documents in either direction whatever the setting.
+
+var t = db.jstests_collscan_read_ahead;
+t.drop();
+
+// Small extents so the scan crosses a lot of them.
+db.createCollection(t.getName(), {size: 4096});
+var pad = new Array(2048).join('x');
+for (var i = 0; i < 500; i++) {
+    t.insert({_id: i, pad: pad});
+}
+assert.eq(null, db.getLastError());
+assert.lt(10, t.stats().numExtents);
+
+function check() {
+    assert.eq(500, t.find().itcount());
+    assert.eq(500, t.find().sort({$natural: -1}).itcount());
+    assert.eq(100, t.find({_id: {$gte: 400}}).hint({$natural: 1}).itcount());
+}
+
+check();
+
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryCollScanReadAheadExtents: 0}));
+check();
+
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryCollScanReadAheadExtents: 8}));
+check();
+
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryCollScanReadAheadExtents: 2}));
+t.drop();
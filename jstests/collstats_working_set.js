@@ -0,0 +1,32 @@
+// collStats with workingSet:true estimates how much of a collection and its indexes was touched
+// recently.
+
+var t = db.jstests_collstats_working_set;
+t.drop();
+
+for (var i = 0; i < 1000; i++) {
+    t.insert({_id: i, a: i});
+}
+t.ensureIndex({a: 1});
+assert.eq(null, db.getLastError());
+assert.eq(1000, t.find().itcount());
+
+assert(!t.stats().hasOwnProperty('workingSet'));
+
+var res = t.runCommand('collStats', {workingSet: true});
+assert.commandWorked(res);
+var ws = res.workingSet;
+if (ws.info != 'not supported') {
+    assert.gt(ws.pages, 0, tojson(ws));
+    assert.gt(ws.pagesInMemory, 0, tojson(ws));
+    assert.lte(ws.pagesInMemory, ws.pages, tojson(ws));
+    assert.lte(ws.fractionInMemory, 1, tojson(ws));
+    ['_id_', 'a_1'].forEach(function(name) {
+        var index = ws.indexes[name];
+        assert(index, tojson(ws));
+        assert.gt(index.pages, 0, tojson(ws));
+        assert.lte(index.pagesInMemory, index.pages, tojson(ws));
+    });
+}
+
+t.drop();
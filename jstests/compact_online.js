@@ -0,0 +1,38 @@
+// An online compact empties sparse extents by moving their records in batches, keeps the indexes,
+// and returns the extents it emptied to the free list.
+
+t = db.jstests_compact_online;
+t.drop();
+
+// Several extents: a small first extent and more as the collection grows.
+var pad = new Array( 1000 ).join( 'x' );
+for( var i = 0; i < 5000; i++ ) {
+    t.insert( { _id:i, a:i, pad:pad } );
+}
+t.ensureIndex( { a:1 } );
+assert( !db.getLastError() );
+
+// Leave every extent but the last mostly empty.
+t.remove( { _id:{ $lt:4000, $not:{ $mod:[ 10, 0 ] } } } );
+assert( !db.getLastError() );
+var count = t.count();
+var before = t.stats();
+assert.gt( before.numExtents, 2, tojson( before ) );
+
+// Padding options belong to the offline compact.
+assert.commandFailed( t.runCommand( "compact", { online:true, paddingFactor:1.5 } ) );
+
+var res = t.runCommand( "compact", { online:true } );
+assert.commandWorked( res );
+assert.gt( res.extentsFreed, 0, tojson( res ) );
+
+var after = t.stats();
+assert.lt( after.numExtents, before.numExtents, tojson( { before:before, after:after } ) );
+assert.eq( count, t.count() );
+assert.eq( count, t.find().hint( { a:1 } ).itcount() );
+assert.eq( count, t.find().hint( { _id:1 } ).itcount() );
+assert.eq( 400, t.find( { a:{ $lt:4000 } } ).hint( { a:1 } ).itcount() );
+assert.eq( 1, t.find( { _id:4500 } ).itcount() );
+assert( t.validate( true ).valid );
+
+t.drop();
@@ -0,0 +1,55 @@
+// copydb inserts the documents of each collection in batches, and builds the indexes of a
+// collection together, with one scan of it.
+
+var source = db.getSiblingDB("copydb_indexes_source");
+var target = db.getSiblingDB("copydb_indexes_target");
+source.dropDatabase();
+target.dropDatabase();
+
+for (var i = 0; i < 3000; i++) {
+    source.a.insert({_id: i, x: i % 10, y: [i, i + 1], s: "s" + i, loc: [i % 90, i % 45]});
+}
+source.a.ensureIndex({x: 1});
+source.a.ensureIndex({y: -1});
+source.a.ensureIndex({s: 1}, {unique: true});
+source.a.ensureIndex({x: 1, s: -1}, {name: "compound"});
+source.a.ensureIndex({s: "hashed"});
+source.a.ensureIndex({loc: "2d"});
+source.a.ensureIndex({x: -1}, {background: true});
+
+source.createCollection("capped", {capped: true, size: 100000});
+for (var i = 0; i < 100; i++) {
+    source.capped.insert({i: i});
+}
+source.capped.ensureIndex({i: 1});
+assert.eq(null, source.getLastError());
+
+assert.commandWorked(db.adminCommand({copydb: 1, fromdb: source.getName(),
+                                      todb: target.getName()}));
+
+assert.eq(3000, target.a.count());
+assert.eq(source.a.getIndexes().length, target.a.getIndexes().length);
+assert.eq(100, target.capped.count());
+assert(target.capped.isCapped());
+assert.eq(2, target.capped.getIndexes().length);
+
+var res = target.a.validate(true);
+assert(res.valid, tojson(res));
+var keys = res.keysPerIndex;
+var n = target.a.getFullName();
+assert.eq(3000, keys[n + ".$x_1"]);
+assert.eq(3001, keys[n + ".$y_-1"]);
+assert.eq(3000, keys[n + ".$compound"]);
+assert.eq(3000, keys[n + ".$x_-1"]);
+
+assert.eq(300, target.a.find({x: 3}).hint({x: 1}).itcount());
+assert.eq(2, target.a.find({y: 7}).hint({y: -1}).itcount());
+assert.eq(1, target.a.find({s: "s17"}).hint({s: "hashed"}).itcount());
+assert.eq(10, target.a.find({loc: {$near: [0, 0]}}).limit(10).itcount());
+
+// The unique index holds in the copy.
+target.a.insert({s: "s5"});
+assert.neq(null, target.getLastError());
+
+source.dropDatabase();
+target.dropDatabase();
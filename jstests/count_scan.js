@@ -0,0 +1,51 @@
+// A count whose query is answered by a single range of index keys walks the keys without
+// fetching.  It must count what the collection scan finds.
+
+var t = db.jstests_count_scan;
+t.drop();
+
+t.ensureIndex({a: 1});
+t.ensureIndex({b: 1, c: -1});
+for (var i = 0; i < 200; i++) {
+    t.save({a: i % 50, b: i % 4, c: i});
+}
+t.save({a: 'str', b: 1, c: 'str'});
+t.save({a: null, b: null});
+t.save({b: 2});
+
+function check(query) {
+    var expected = t.find(query).hint({$natural: 1}).itcount();
+    assert.eq(expected, t.count(query), tojson(query));
+}
+
+check({a: 7});
+check({a: {$gte: 10, $lte: 20}});
+check({a: {$gt: 10, $lt: 20}});
+check({a: {$gt: 10}});
+check({a: {$lt: 10}});
+check({a: {$gt: 50}});
+check({a: null});
+check({a: 'str'});
+check({b: 2});
+check({b: {$gt: 1}});
+check({b: 2, c: {$gt: 100}});
+check({b: 2, c: {$lte: 100, $gt: 10}});
+
+// Not a single interval; still counted correctly.
+check({a: {$in: [1, 3, 5]}});
+check({b: {$in: [1, 3]}, c: {$gt: 17}});
+
+// Documents with several keys in range are counted once.
+t.save({a: [5, 6, 7, 8], c: -1});
+t.save({a: [100, 101]});
+check({a: {$gte: 5, $lte: 8}});
+check({a: {$gt: 99}});
+check({a: 6});
+
+// A skip or limit still gets the right answer.
+assert.eq(Math.min(40, t.find({a: {$gt: 10}}).hint({$natural: 1}).itcount()),
+          t.find({a: {$gt: 10}}).limit(40).count(true));
+assert.eq(t.find({a: {$gt: 10}}).hint({$natural: 1}).itcount() - 5,
+          t.find({a: {$gt: 10}}).skip(5).count(true));
+
+t.drop();
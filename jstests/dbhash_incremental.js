@@ -0,0 +1,84 @@
+// dbHash with incremental: true keeps the hashes of the ranges of each collection's _id index,
+// and only rehashes the ranges written to since.  The hashes depend only on the documents.
+
+var testDB = db.getSiblingDB("dbhash_incremental");
+testDB.dropDatabase();
+
+function hashes(opts) {
+    var cmd = {dbHash: 1, collections: ["a", "b"]};
+    for (var k in opts) {
+        cmd[k] = opts[k];
+    }
+    var res = testDB.runCommand(cmd);
+    assert.commandWorked(res);
+    return res;
+}
+
+function fill(coll, n) {
+    for (var i = 0; i < n; i++) {
+        coll.insert({_id: i, x: i, s: "abc" + i});
+    }
+    assert.eq(null, testDB.getLastError());
+}
+
+fill(testDB.a, 20000);
+fill(testDB.b, 20000);
+
+var res = hashes({incremental: true});
+assert.eq(res.collections.a, res.collections.b);
+assert.eq([], res.fromCache);
+assert.gt(res.rangesHashed, 20);
+var initial = res.collections.a;
+var ranges = res.rangesHashed;
+
+res = hashes({incremental: true});
+assert.eq(initial, res.collections.a);
+assert.eq(["dbhash_incremental.a", "dbhash_incremental.b"], res.fromCache);
+assert.eq(0, res.rangesHashed);
+
+// One document changed: one range of one collection is hashed again.
+testDB.a.update({_id: 5000}, {$set: {x: -1}});
+res = hashes({incremental: true});
+assert.neq(initial, res.collections.a);
+assert.eq(initial, res.collections.b);
+assert.eq(["dbhash_incremental.b"], res.fromCache);
+assert.eq(1, res.rangesHashed);
+
+testDB.a.update({_id: 5000}, {$set: {x: 5000}});
+res = hashes({incremental: true});
+assert.eq(initial, res.collections.a);
+
+// Inserts and removes, boundaries among them, hash the same as the same documents hashed afresh.
+testDB.a.remove({_id: {$gte: 1000, $lt: 3000}});
+testDB.a.update({_id: {$gte: 3000, $lt: 3100}}, {$set: {big: new Array(1000).join("x")}},
+                false, true);
+for (var i = 30000; i < 31000; i++) {
+    testDB.a.insert({_id: i});
+}
+assert.eq(null, testDB.getLastError());
+res = hashes({incremental: true});
+assert.lt(res.rangesHashed, ranges);
+var changed = res.collections.a;
+
+testDB.b.drop();
+testDB.a.find().sort({_id: 1}).forEach(function(doc) { testDB.b.insert(doc); });
+assert.eq(null, testDB.getLastError());
+res = hashes({incremental: true});
+assert.eq(changed, res.collections.a);
+assert.eq(changed, res.collections.b);
+
+// The hash type changes the hashes, and not the documents they agree on.
+var fast = hashes({incremental: true, hashType: "murmur3"});
+assert.eq("murmur3", fast.hashType);
+assert.neq(changed, fast.collections.a);
+assert.eq(fast.collections.a, fast.collections.b);
+var full = hashes({hashType: "murmur3"});
+assert.eq(full.collections.a, full.collections.b);
+full = hashes({});
+assert.eq("md5", full.hashType);
+assert.eq(full.collections.a, full.collections.b);
+assert.neq(changed, full.collections.a);
+
+assert.commandFailed(testDB.runCommand({dbHash: 1, hashType: "sha1"}));
+
+testDB.dropDatabase();
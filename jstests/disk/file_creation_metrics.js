@@ -0,0 +1,19 @@
+// serverStatus counts the data files writers created and the time they spent creating them.
+
+port = allocatePorts( 1 )[ 0 ];
+
+var baseName = "jstests_file_creation_metrics";
+
+var m = startMongod( "--port", port, "--dbpath", MongoRunner.dataPath + baseName );
+var db = m.getDB( baseName );
+
+var before = db.serverStatus().metrics.storage.fileCreation;
+db[ baseName ].save( { i:1 } );
+assert( !db.getLastError() );
+var after = db.serverStatus().metrics.storage.fileCreation;
+
+// the namespace file is opened separately; the first data file is created by the insert
+assert.eq( before.num + 1, after.num, tojson( { before:before, after:after } ) );
+assert.gte( after.totalMillis, before.totalMillis );
+
+stopMongod( port );
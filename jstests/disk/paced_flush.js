@@ -0,0 +1,30 @@
+// With pacedDataFileFlushes the background flush goes through the data files a range at a time
+// over each syncdelay interval, and serverStatus backgroundFlushing reports the ranges.
+
+port = allocatePorts( 1 )[ 0 ];
+
+var baseName = "jstests_disk_paced_flush";
+
+var m = startMongod( "--port", port, "--dbpath", MongoRunner.dataPath + baseName,
+                     "--syncdelay", 2, "--smallfiles" );
+var db = m.getDB( baseName );
+
+for( var i = 0; i < 1000; ++i ) {
+    db[ baseName ].save( { i:i } );
+}
+assert( !db.getLastError() );
+
+assert.soon( function() {
+                 var bf = db.serverStatus().backgroundFlushing;
+                 return bf.flushes > 0 && bf.chunks > 0;
+             }, "no paced flush finished", 30000 );
+
+var bf = db.serverStatus().backgroundFlushing;
+// the pass is spread over about the syncdelay interval
+assert.lte( bf.last_ms, bf.last_pass_ms, tojson( bf ) );
+
+// turned off, the old full flushes don't report ranges
+assert.commandWorked( db.adminCommand( { setParameter:1, pacedDataFileFlushes:false } ) );
+assert( !db.serverStatus().backgroundFlushing.hasOwnProperty( "chunks" ) );
+
+stopMongod( port );
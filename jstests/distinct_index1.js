@@ -34,17 +34,18 @@ assert.eq( 1000 , x.stats.nscannedObjects , "AC3" )
 
 t.ensureIndex( { a : 1 } )
 
+// The index is skip-scanned: one key is looked at per distinct value.
 x = d( "a" );
-assert.eq( 1000 , x.stats.n , "BA1" )
-assert.eq( 1000 , x.stats.nscanned , "BA2" )
-// QUERY_MIGRATION: pending projection support
-//assert.eq( 0 , x.stats.nscannedObjects , "BA3" )
+assert.eq( 10 , x.values.length , "BA0" )
+assert.eq( 10 , x.stats.n , "BA1" )
+assert.eq( 10 , x.stats.nscanned , "BA2" )
+assert.eq( 0 , x.stats.nscannedObjects , "BA3" )
 
 x = d( "a" , { a : { $gt : 5 } } );
-assert.eq( 398 , x.stats.n , "BB1" )
-assert.eq( 398 , x.stats.nscanned , "BB2" )
-// QUERY_MIGRATION: pending projection support
-// assert.eq( 0 , x.stats.nscannedObjects , "BB3" )
+assert.eq( 4 , x.values.length , "BB0" )
+assert.eq( 4 , x.stats.n , "BB1" )
+assert.eq( 4 , x.stats.nscanned , "BB2" )
+assert.eq( 0 , x.stats.nscannedObjects , "BB3" )
 
 x = d( "b" , { a : { $gt : 5 } } );
 assert.eq( 398 , x.stats.n , "BC1" )
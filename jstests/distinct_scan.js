@@ -0,0 +1,48 @@
+// A distinct on the leading field of an index looks at one index key per value instead of at
+// every document.  It must find the same values as a distinct without the index.
+
+var t = db.jstests_distinct_scan;
+t.drop();
+
+for (var i = 0; i < 500; i++) {
+    t.save({a: i % 7, b: i % 3, c: 'x' + (i % 4)});
+}
+t.save({b: 1});
+t.save({a: null, b: 2});
+t.save({a: {sub: 1}, b: 1});
+t.save({a: 'str', b: 0});
+
+function sorted(arr) {
+    return arr.sort(function(x, y) { return bsonWoCompare({v: x}, {v: y}); });
+}
+
+var queries = [{}, {a: {$gt: 2}}, {a: {$lte: 4}, b: 1}, {b: 2}, {a: {$in: [1, 3, 'str']}}];
+var expected = [];
+for (var i = 0; i < queries.length; i++) {
+    expected.push(sorted(t.distinct('a', queries[i])));
+}
+
+t.ensureIndex({a: 1, b: 1});
+for (var i = 0; i < queries.length; i++) {
+    assert.eq(expected[i], sorted(t.distinct('a', queries[i])), tojson(queries[i]));
+}
+
+// Only the distinct values are looked at (and each null key, which might be a missing field).
+var res = t.runCommand('distinct', {key: 'a'});
+assert.gt(20, res.stats.n);
+assert.eq(0, res.stats.nscannedObjects);
+assert.gt(20, res.stats.nscanned);
+
+// A descending index works too.
+t.dropIndexes();
+t.ensureIndex({a: -1});
+for (var i = 0; i < queries.length; i++) {
+    assert.eq(expected[i], sorted(t.distinct('a', queries[i])), tojson(queries[i]));
+}
+
+// A multikey index can't be skip-scanned, but the values are the same.
+t.save({a: [100, 101]});
+var multikeyExpected = sorted(expected[0].concat([100, 101]));
+assert.eq(multikeyExpected, sorted(t.distinct('a')));
+
+t.drop();
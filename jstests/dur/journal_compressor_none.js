@@ -0,0 +1,38 @@
+/*
+   --journalCompressor none writes journal sections uncompressed.  recovery must read them, also
+   when the restarted mongod uses the default compressor.
+*/
+
+var testname = "journal_compressor_none";
+var path = MongoRunner.dataPath + testname;
+
+// --journalOptions 8 keeps the writes out of the data files, so they are only in the journal
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--journal", "--smallfiles",
+                            "--journalOptions", 8, "--journalCompressor", "none");
+var d = conn.getDB("test");
+
+// very compressible, so a compressed journal would be far smaller than the data
+var pad = new Array(4000).join('x');
+for (var i = 0; i < 1000; i++) {
+    d.foo.insert({_id: i, pad: pad});
+}
+printjson(conn.getDB("admin").runCommand({getlasterror: 1, fsync: 1}));
+
+var dur = conn.getDB("admin").serverStatus().dur;
+printjson(dur);
+assert.eq(0, dur.timeMs.compress, "sections were compressed");
+
+stopMongod(30001, /*signal*/9);
+
+conn = startMongodNoReset("--port", 30002, "--dbpath", path, "--journal", "--smallfiles",
+                          "--journalOptions", 8);
+d = conn.getDB("test");
+assert.eq(1000, d.foo.count());
+assert.eq(pad, d.foo.findOne({_id: 999}).pad);
+stopMongod(30002);
+
+// an unknown compressor is refused
+assert.neq(0, runMongoProgram("mongod", "--port", 30003, "--dbpath", path, "--journal",
+                              "--journalCompressor", "lz4"));
+
+print(testname + " SUCCESS");
@@ -0,0 +1,55 @@
+/*
+   journal recovery applying writes on several threads (journalRecoveryThreads) must leave the
+   data files the same as recovery on a single thread.
+*/
+
+var testname = "recover_parallel";
+var path = MongoRunner.dataPath + testname;
+var pathSerial = MongoRunner.dataPath + testname + "serial";
+var pathParallel = MongoRunner.dataPath + testname + "parallel";
+
+// --journalOptions 8 keeps the writes out of the data files, so they are only in the journal
+var conn = startMongodEmpty("--port", 30001, "--dbpath", path, "--journal", "--smallfiles",
+                            "--journalOptions", 8);
+
+// enough data in several databases, so the writes of a section span several files
+var pad = new Array(1000).join('x');
+for (var d = 0; d < 4; d++) {
+    var db = conn.getDB("test" + d);
+    for (var i = 0; i < 1000; i++) {
+        db.foo.insert({_id: i, pad: pad});
+    }
+    db.foo.ensureIndex({x: 1});
+    db.foo.update({}, {$set: {x: d}}, false, true);
+}
+printjson(conn.getDB("admin").runCommand({getlasterror: 1, fsync: 1}));
+
+stopMongod(30001, /*signal*/9);
+
+copyDbpath(path, pathSerial);
+copyDbpath(path, pathParallel);
+
+function recover(dbpath, port, threads) {
+    var conn = startMongodNoReset("--port", port, "--dbpath", dbpath, "--journal", "--smallfiles",
+                                  "--journalOptions", 8,
+                                  "--setParameter", "journalRecoveryThreads=" + threads);
+    for (var d = 0; d < 4; d++) {
+        var coll = conn.getDB("test" + d).foo;
+        assert.eq(1000, coll.count());
+        assert.eq(1000, coll.find({x: d}).hint({x: 1}).itcount());
+    }
+    stopMongod(port);
+}
+
+recover(pathSerial, 30002, 1);
+recover(pathParallel, 30003, 4);
+
+for (var d = 0; d < 4; d++) {
+    ["ns", "0", "1"].forEach(function(suffix) {
+        var name = "/test" + d + "." + suffix;
+        var diff = run("diff", pathSerial + name, pathParallel + name);
+        assert.eq(0, diff, "data files differ: " + name);
+    });
+}
+
+print(testname + " SUCCESS");
@@ -0,0 +1,64 @@
+// A verbose explain reports what each stage of the winning plan, and of every plan it raced
+// against, did.
+
+var t = db.jstests_explain_execution_stats;
+t.drop();
+
+t.ensureIndex({a: 1});
+t.ensureIndex({b: 1});
+for (var i = 0; i < 100; i++) {
+    t.save({a: i, b: i % 10});
+}
+
+// Returns the first stage of type 'stageName' in the tree rooted at 'stats', or null.
+function findStage(stats, stageName) {
+    if (stats.stage == stageName) {
+        return stats;
+    }
+    var children = stats.inputStages || [];
+    for (var i = 0; i < children.length; i++) {
+        var found = findStage(children[i], stageName);
+        if (found) {
+            return found;
+        }
+    }
+    return null;
+}
+
+function checkCommon(stats) {
+    assert(stats.hasOwnProperty('works'), tojson(stats));
+    assert(stats.hasOwnProperty('advanced'), tojson(stats));
+    assert.lte(0, stats.executionTimeMicros, tojson(stats));
+    (stats.inputStages || []).forEach(checkCommon);
+}
+
+// Not verbose: no execution stats.
+var explain = t.find({a: {$gte: 50}, b: 3}).explain();
+assert(!explain.hasOwnProperty('executionStats'), tojson(explain));
+assert(!explain.hasOwnProperty('allPlans'), tojson(explain));
+
+explain = t.find({a: {$gte: 50}, b: 3}).explain("executionStats");
+checkCommon(explain.executionStats);
+var ixscan = findStage(explain.executionStats, "IXSCAN");
+assert.neq(null, ixscan, tojson(explain.executionStats));
+assert.eq(explain.nscanned, ixscan.keysExamined, tojson(explain));
+assert.neq(null, findStage(explain.executionStats, "FETCH"), tojson(explain.executionStats));
+
+// The rejected candidates have their own stage trees.
+assert.lt(1, explain.allPlans.length, tojson(explain));
+explain.allPlans.forEach(function(plan) {
+    checkCommon(plan.executionStats);
+});
+
+// A collection scan examines documents, not keys.
+explain = t.find({c: 1}).explain(true);
+var collscan = findStage(explain.executionStats, "COLLSCAN");
+assert.neq(null, collscan, tojson(explain.executionStats));
+assert.eq(100, collscan.docsExamined, tojson(explain.executionStats));
+
+// A blocking sort says how much memory it used.
+explain = t.find({c: {$exists: false}}).sort({c: 1}).explain(true);
+var sort = findStage(explain.executionStats, "SORT");
+assert.neq(null, sort, tojson(explain.executionStats));
+assert.lt(0, sort.memUsage, tojson(sort));
+assert.eq(32 * 1024 * 1024, sort.memLimit, tojson(sort));
@@ -0,0 +1,52 @@
+// findAndModify updates the document its query found and returns the new version of it, whether
+// the update was made in place, moved the document, or made a positional change.
+
+var t = db.find_and_modify_new_doc;
+t.drop();
+t.ensureIndex({ state : 1 });
+
+for ( var i = 0; i < 10; i++ ) t.insert({ _id : i, state : "ready", n : 0, tags : [ "a", "b" ] });
+
+// In place, with the fields projected
+var out = t.findAndModify({ query : { state : "ready" }, update : { $inc : { n : 1 } },
+                            fields : { n : 1 }, 'new' : true });
+assert.eq({ _id : 0, n : 1 }, out);
+
+// Changing the indexed field the query matched on
+out = t.findAndModify({ query : { state : "ready" }, update : { $set : { state : "done" } },
+                        'new' : true });
+assert.eq( "done", out.state );
+assert.eq( 1, out.n );
+assert.eq( 9, t.find({ state : "ready" }).hint({ state : 1 }).itcount() );
+
+// Growing the document past its record
+var big = new Array( 1000 ).join( "x" );
+out = t.findAndModify({ query : { state : "ready" }, update : { $set : { big : big } },
+                        'new' : true });
+assert.eq( 1, out._id );
+assert.eq( big, out.big );
+assert.eq( big, t.findOne({ _id : 1 }).big );
+
+// The old version otherwise
+out = t.findAndModify({ query : { _id : 2 }, update : { $set : { n : 5 } } });
+assert.eq( 0, out.n );
+assert.eq( 5, t.findOne({ _id : 2 }).n );
+
+// Positional
+out = t.findAndModify({ query : { state : "ready", tags : "b" }, update : { $set : { "tags.$" : "c" } },
+                        'new' : true });
+assert.eq( [ "a", "c" ], out.tags );
+
+// A replacement
+out = t.findAndModify({ query : { _id : 3 }, update : { state : "replaced" }, 'new' : true });
+assert.eq({ _id : 3, state : "replaced" }, out);
+
+// A no-op
+out = t.findAndModify({ query : { _id : 3 }, update : { $set : { state : "replaced" } }, 'new' : true });
+assert.eq({ _id : 3, state : "replaced" }, out);
+
+// An upsert
+out = t.findAndModify({ query : { _id : 20 }, update : { $inc : { n : 1 } }, upsert : true, 'new' : true });
+assert.eq({ _id : 20, n : 1 }, out);
+
+assert( t.validate( true ).valid );
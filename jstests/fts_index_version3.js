@@ -0,0 +1,62 @@
+// A text index with textIndexVersion 3 holds compact keys, and finds and scores what a version 2
+// index does.
+
+load( "jstests/libs/fts.js" );
+
+var v2 = db.fts_index_version3_v2;
+var v3 = db.fts_index_version3_v3;
+v2.drop();
+v3.drop();
+
+var longWord = new Array( 200 ).join( "z" );
+var docs = [ { _id : 1, title : "cats", body : "the cat sat on the mat" },
+             { _id : 2, title : "dogs", body : "dogs chase cats and cats run" },
+             { _id : 3, title : "mats", body : "a mat, another mat, more mats" },
+             { _id : 4, title : "long", body : longWord + " cat" },
+             { _id : 5, title : "longer", body : longWord + "y" } ];
+docs.forEach( function( d ) { v2.insert( d ); v3.insert( d ); } );
+
+v2.ensureIndex( { title : "text", body : "text" }, { weights : { title : 5 } } );
+v3.ensureIndex( { title : "text", body : "text" },
+                { weights : { title : 5 }, textIndexVersion : 3 } );
+assert.eq( null, db.getLastError() );
+
+var idx = v3.getIndexes().filter( function( z ) { return z.textIndexVersion; } )[0];
+assert.eq( 3, idx.textIndexVersion, tojson( idx ) );
+
+assert.throws( function() {
+    v3.ensureIndex( { other : "text" }, { textIndexVersion : 4 } );
+    var err = db.getLastError();
+    if ( err )
+        throw err;
+} );
+
+function search( coll, s ) {
+    var res = coll.runCommand( "text", { search : s } );
+    assert.commandWorked( res );
+    return res.results;
+}
+
+[ "cat", "mat", "dog cat", "\"cat sat\"", "mat -another", longWord, longWord + "y" ].forEach(
+    function( s ) {
+        var r2 = search( v2, s );
+        var r3 = search( v3, s );
+        assert.eq( r2.length, r3.length, s );
+        for ( var i = 0; i < r2.length; i++ ) {
+            assert.eq( r2[i].obj._id, r3[i].obj._id, s );
+            assert.close( r2[i].score, r3[i].score, s );
+        }
+    } );
+
+// A long term isn't confused with another it shares its first bytes with.
+assert.eq( [ 4 ], queryIDS( v3, longWord ) );
+assert.eq( [ 5 ], queryIDS( v3, longWord + "y" ) );
+
+// Updates keep the index in step.
+v3.update( { _id : 3 }, { $set : { title : "rugs", body : "no longer" } } );
+assert.eq( [ 1 ], queryIDS( v3, "mat" ) );
+
+assert( v3.validate( true ).valid );
+
+v2.drop();
+v3.drop();
@@ -0,0 +1,59 @@
+// Text search can stop reading the index once no other document can make it into the top
+// results.  Check that it returns the same results as reading everything, which a negated term
+// that matches nothing forces.
+
+var t = db.getSiblingDB("test").getCollection("fts_top_k");
+t.drop();
+
+db.adminCommand({setParameter:1, textSearchEnabled:true});
+db.adminCommand({setParameter:1, newQueryFrameworkEnabled:true});
+
+function repeat(word, n) {
+    var s = "";
+    for (var i = 0; i < n; i++) {
+        s += word + " ";
+    }
+    return s;
+}
+
+for (var i = 0; i < 600; i++) {
+    t.insert({_id: i, b: i % 3,
+              a: repeat("apple", i % 13) + repeat("banana", i % 7) + repeat("cherry", i % 5) +
+                 repeat("filler", i % 11)});
+}
+t.ensureIndex({a: "text"});
+assert.eq(null, db.getLastError());
+
+function check(search, filter) {
+    var query = {$text: {$search: search}};
+    var fullQuery = {$text: {$search: search + " -nosuchword"}};
+    for (var key in filter) {
+        query[key] = filter[key];
+        fullQuery[key] = filter[key];
+    }
+
+    var results = t.find(query, {score: {$textScore: 1}}).toArray();
+    var expected = t.find(fullQuery, {score: {$textScore: 1}}).toArray();
+    assert.eq(expected.length, results.length, search);
+
+    // Scores can differ in the last bits depending on the order terms are added up in, which can
+    // reorder ties.  So compare the scores in order, and each document's score.
+    var expectedScores = {};
+    for (var i = 0; i < expected.length; i++) {
+        expectedScores[expected[i]._id] = expected[i].score;
+    }
+    for (var i = 0; i < results.length; i++) {
+        assert.close(expected[i].score, results[i].score, search);
+        if (results[i]._id in expectedScores) {
+            assert.close(expectedScores[results[i]._id], results[i].score, search);
+        }
+    }
+}
+
+check("apple");
+check("apple banana");
+check("apple banana cherry");
+check("filler cherry");
+check("apple banana", {b: 1});
+
+t.drop();
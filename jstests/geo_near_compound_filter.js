@@ -0,0 +1,55 @@
+// $near and $within on a compound 2d index return the same documents whether the rest of the
+// query can be matched on the index key or needs the document.
+
+var t = db.geo_near_compound_filter;
+t.drop();
+
+for (var i = 0; i < 2000; i++) {
+    t.insert({_id: i, loc: [(i % 50) - 25, Math.floor(i / 50) - 20], cat: i % 7,
+              name: "n" + (i % 13)});
+}
+t.ensureIndex({loc: "2d", cat: 1});
+assert(!db.getLastError());
+
+function matching(pred) {
+    var ids = [];
+    t.find().sort({_id: 1}).forEach(function(doc) {
+        if (pred(doc)) ids.push(doc._id);
+    });
+    return ids;
+}
+
+function ids(cursor) {
+    var out = [];
+    cursor.forEach(function(doc) { out.push(doc._id); });
+    return out.sort(function(a, b) { return a - b; });
+}
+
+var box = {$within: {$box: [[-30, -30], [30, 30]]}};
+
+function check(query, pred) {
+    var q = Object.extend({loc: box}, query);
+    assert.eq(matching(pred), ids(t.find(q)), tojson(query));
+
+    // Everything is within 50 of the origin, so $near with a big limit returns every match.
+    var near = Object.extend({loc: {$near: [0, 0]}}, query);
+    assert.eq(matching(pred), ids(t.find(near).limit(5000)), tojson(query));
+}
+
+// Matched on the key.
+check({cat: 3}, function(d) { return d.cat == 3; });
+check({cat: {$in: [1, 5]}}, function(d) { return d.cat == 1 || d.cat == 5; });
+check({cat: {$nin: [0, 1, 2]}}, function(d) { return d.cat > 2; });
+check({cat: {$not: {$gt: 4}}}, function(d) { return d.cat <= 4; });
+check({$or: [{cat: 2}, {cat: {$gte: 6}}]}, function(d) { return d.cat == 2 || d.cat >= 6; });
+
+// Needs the document.
+check({name: "n4"}, function(d) { return d.name == "n4"; });
+check({cat: 3, name: "n4"}, function(d) { return d.cat == 3 && d.name == "n4"; });
+check({cat: {$exists: true}}, function(d) { return true; });
+
+// Once cat is multikey, $nin can't be answered from one key of a document.
+t.insert({_id: 5000, loc: [0, 0], cat: [1, 9]});
+check({cat: {$nin: [1]}}, function(d) {
+    return !(d.cat == 1 || (d.cat instanceof Array && d.cat.indexOf(1) != -1));
+});
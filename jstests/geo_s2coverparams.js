@@ -0,0 +1,39 @@
+// A 2dsphere index takes the number of cells it covers a geometry with from its spec, and
+// queries repeating a polygon find the same documents as the first one.
+
+var t = db.geo_s2coverparams;
+
+t.drop();
+t.save({loc: [0, 0]});
+t.ensureIndex({loc: "2dsphere"}, {maxCellsInCovering: 0});
+assert(db.getLastError());
+
+t.drop();
+t.save({loc: [0, 0]});
+t.ensureIndex({loc: "2dsphere"}, {maxCellsInCovering: 8, finestIndexedLevel: 20,
+                                  coarsestIndexedLevel: 10});
+assert(!db.getLastError());
+assert.eq(8, t.getIndexes()[1].maxCellsInCovering);
+
+t.drop();
+for (var x = -10; x < 10; x++) {
+    for (var y = -10; y < 10; y++) {
+        t.insert({loc: {type: "Point", coordinates: [x + 0.5, y + 0.5]}});
+    }
+}
+t.insert({loc: {type: "Polygon",
+                coordinates: [[[-1, -1], [1, -1], [1, 1], [-1, 1], [-1, -1]]]}});
+t.ensureIndex({loc: "2dsphere"}, {maxCellsInCovering: 4});
+assert(!db.getLastError());
+
+function box(x1, y1, x2, y2) {
+    return {$geoWithin: {$geometry: {type: "Polygon",
+                                     coordinates: [[[x1, y1], [x2, y1], [x2, y2], [x1, y2],
+                                                    [x1, y1]]]}}};
+}
+
+for (var i = 0; i < 3; i++) {
+    assert.eq(17, t.find({loc: box(-2, -2, 2, 2)}).itcount());
+    assert.eq(25, t.find({loc: box(0, 0, 5, 5)}).itcount());
+    assert.eq(17, t.find({loc: box(-2.1, -2.1, 2.1, 2.1)}).hint({loc: "2dsphere"}).itcount());
+}
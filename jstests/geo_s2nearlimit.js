@@ -0,0 +1,57 @@
+// $near on a 2dsphere index returns the nearest documents in order when the points are dense and
+// the limit small, and finds geometries indexed under many cells.
+
+var t = db.geo_s2nearlimit;
+t.drop();
+
+function rad(deg) { return deg * Math.PI / 180; }
+
+// Great circle distance in radians.
+function distance(a, b) {
+    var dLat = rad(b[1] - a[1]);
+    var dLng = rad(b[0] - a[0]);
+    var h = Math.pow(Math.sin(dLat / 2), 2) +
+            Math.cos(rad(a[1])) * Math.cos(rad(b[1])) * Math.pow(Math.sin(dLng / 2), 2);
+    return 2 * Math.asin(Math.sqrt(h));
+}
+
+var points = [];
+var seed = 7;
+function random() {
+    seed = (seed * 16807) % 2147483647;
+    return seed / 2147483647;
+}
+for (var i = 0; i < 5000; i++) {
+    var p = [-0.5 + random(), 40 + random()];
+    points.push(p);
+    t.insert({_id: i, loc: {type: "Point", coordinates: p}});
+}
+t.ensureIndex({loc: "2dsphere"});
+assert(!db.getLastError());
+
+var origins = [[0, 40.5], [0.3, 40.1], [-0.49, 40.99], [2, 42]];
+origins.forEach(function(origin) {
+    var expected = points.map(function(p, i) { return {_id: i, d: distance(origin, p)}; })
+                         .sort(function(a, b) { return a.d - b.d; });
+    [1, 10, 100].forEach(function(limit) {
+        var res = t.find({loc: {$near: {$geometry: {type: "Point", coordinates: origin}}}})
+                   .limit(limit).toArray();
+        assert.eq(limit, res.length);
+        for (var i = 0; i < limit; i++) {
+            assert.eq(expected[i]._id, res[i]._id, tojson(origin) + " " + limit + " " + i);
+        }
+    });
+});
+
+// A polygon covered by many cells comes before the points if it contains the near point.
+t.insert({_id: "poly", loc: {type: "Polygon",
+                             coordinates: [[[0.1, 40.2], [0.4, 40.2], [0.4, 40.4], [0.1, 40.4],
+                                            [0.1, 40.2]]]}});
+var res = t.find({loc: {$near: {$geometry: {type: "Point", coordinates: [0.25, 40.3]}}}})
+           .limit(3).toArray();
+assert.eq("poly", res[0]._id);
+
+// A maximum distance with fewer matches than the limit.
+res = t.find({loc: {$near: {$geometry: {type: "Point", coordinates: [5, 40.5]},
+                            $maxDistance: 100}}}).limit(10).toArray();
+assert.eq(0, res.length);
@@ -0,0 +1,63 @@
+// group() runs $reduce functions that only add numbers without JavaScript.  The results must be
+// the same as when JavaScript runs them.
+
+var t = db.group_native;
+t.drop();
+
+for (var i = 0; i < 500; i++) {
+    var doc = { a: i % 7, b: "s" + (i % 3), n: i, f: i / 4 };
+    if (i % 11 == 0) doc.n = null;
+    if (i % 13 == 0) delete doc.n;
+    if (i % 17 == 0) doc.f = NumberLong(i);
+    if (i % 19 == 0) doc.a = NumberInt(i % 7);
+    t.insert(doc);
+}
+
+function setNative(on) {
+    assert.commandWorked(db.adminCommand({ setParameter: 1, nativeGroupReduce: on }));
+}
+
+function check(spec) {
+    setNative(true);
+    var nativeRes = db.runCommand({ group: spec });
+    setNative(false);
+    var jsRes = db.runCommand({ group: spec });
+    setNative(true);
+
+    assert.commandWorked(jsRes, tojson(spec));
+    assert.commandWorked(nativeRes, tojson(spec));
+    assert.eq(jsRes.retval, nativeRes.retval, tojson(spec));
+    assert.eq(jsRes.count, nativeRes.count, tojson(spec));
+    assert.eq(jsRes.keys, nativeRes.keys, tojson(spec));
+}
+
+check({ ns: t.getName(), key: { a: 1 },
+        $reduce: function(obj, prev) { prev.count++; },
+        initial: { count: 0 } });
+
+check({ ns: t.getName(), key: { a: 1, b: 1 },
+        $reduce: function(obj, prev) { prev.count += 1; prev.total += obj.f; },
+        initial: { count: 0, total: 0, label: "x" } });
+
+// Missing fields make NaN, nulls add nothing.
+check({ ns: t.getName(), key: { b: 1 },
+        $reduce: function(cur, result) { result.sum = result.sum + cur.n; ++result.c; },
+        initial: { sum: NumberInt(0), c: 0.5 } });
+
+check({ ns: t.getName(), key: {}, cond: { a: { $gt: 2 } },
+        $reduce: function(obj, prev) { prev.sum += obj.n },
+        initial: { sum: 0 } });
+
+// Initial fields sharing a name with the key replace it.
+check({ ns: t.getName(), key: { a: 1 },
+        $reduce: function(obj, prev) { prev.n += obj.f; },
+        initial: { a: "initial", n: 0 } });
+
+// Adding a string concatenates; only JavaScript does that.
+check({ ns: t.getName(), key: { a: 1 },
+        $reduce: function(obj, prev) { prev.s += obj.b; },
+        initial: { s: 0 } });
+
+check({ ns: "group_native_missing", key: { a: 1 },
+        $reduce: function(obj, prev) { prev.count++; },
+        initial: { count: 0 } });
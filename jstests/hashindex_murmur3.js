@@ -0,0 +1,41 @@
+// A hashed index with hashVersion 1 stores MurmurHash3 hashes of its values instead of md5 ones.
+
+var t = db.jstests_hashindex_murmur3;
+t.drop();
+
+var spec = {a: "hashed"};
+
+// An unknown hash version is refused.
+t.ensureIndex(spec, {hashVersion: 2});
+assert(db.getLastError());
+assert.eq(1, t.getIndexes().length);
+
+t.ensureIndex(spec, {hashVersion: 1});
+assert.eq(null, db.getLastError());
+assert.eq(2, t.getIndexes().length);
+
+for (var i = 0; i < 100; i++) {
+    t.insert({a: i});
+    t.insert({a: 'str' + i});
+}
+t.insert({a: 3.1});
+t.insert({a: {b: 1}});
+t.insert({});
+
+assert(t.validate(true).valid);
+assert.eq(1, t.find({a: 3}).hint(spec).itcount());
+assert.eq(1, t.find({a: 3.1}).hint(spec).itcount());
+assert.eq(1, t.find({a: 'str7'}).hint(spec).itcount());
+assert.eq(1, t.find({a: {b: 1}}).hint(spec).itcount());
+assert.eq(1, t.find({a: null}).hint(spec).itcount());
+assert.eq(2, t.find({a: {$in: [5, 'str5']}}).hint(spec).itcount());
+
+// The hashes are those of _hashBSONElement with the same version, and differ from md5 ones.
+var res = db.runCommand({_hashBSONElement: 'hashthis', hashVersion: 1});
+if (res.ok) {
+    assert.eq(1, res.hashVersion);
+    assert.neq(db.runCommand({_hashBSONElement: 'hashthis'}).out, res.out);
+    assert.commandFailed(db.runCommand({_hashBSONElement: 'hashthis', hashVersion: 2}));
+}
+
+t.drop();
@@ -0,0 +1,54 @@
+// An $in over the leading field of a compound index, sorted by the next field, is answered by
+// merging one index scan per $in value rather than by sorting.
+
+var t = db.jstests_in_merge_sort;
+t.drop();
+
+t.ensureIndex({user: 1, ts: -1});
+for (var i = 0; i < 300; i++) {
+    t.save({user: i % 30, ts: i});
+}
+
+var users = [];
+for (var i = 0; i < 10; i++) {
+    users.push(i * 3);
+}
+
+function checkDescending(res) {
+    for (var i = 1; i < res.length; i++) {
+        assert.gt(res[i - 1].ts, res[i].ts, tojson(res));
+    }
+}
+
+// Newest first, which is the index order on 'ts'.
+var res = t.find({user: {$in: users}}).sort({ts: -1}).limit(15).toArray();
+assert.eq(15, res.length);
+checkDescending(res);
+assert.eq(297, res[0].ts);
+
+var explain = t.find({user: {$in: users}}).sort({ts: -1}).limit(15).explain(true);
+assert(!explain.scanAndOrder, tojson(explain));
+assert.eq(15, explain.n, tojson(explain));
+
+// Oldest first is the reverse of the index order.
+res = t.find({user: {$in: users}}).sort({ts: 1}).toArray();
+assert.eq(100, res.length);
+for (var i = 1; i < res.length; i++) {
+    assert.lt(res[i - 1].ts, res[i].ts);
+}
+
+// Same answers with a range on 'ts'.
+res = t.find({user: {$in: users}, ts: {$lt: 150}}).sort({ts: -1}).toArray();
+assert.eq(50, res.length);
+checkDescending(res);
+assert.eq(147, res[0].ts);
+
+// Past the cap on the number of scans we sort instead.
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryMaxScansToExplode: 5}));
+t.runCommand('planCacheClear');
+explain = t.find({user: {$in: users}}).sort({ts: -1}).limit(15).explain(true);
+assert(explain.scanAndOrder, tojson(explain));
+res = t.find({user: {$in: users}}).sort({ts: -1}).limit(15).toArray();
+assert.eq(15, res.length);
+checkDescending(res);
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryMaxScansToExplode: 200}));
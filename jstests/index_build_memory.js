@@ -0,0 +1,33 @@
+// A foreground index build with a small maxIndexBuildMemoryUsageMegabytes spills several sorted
+// runs and still builds a correct index.
+
+var t = db.jstests_index_build_memory;
+t.drop();
+
+var old = db.adminCommand({getParameter: 1, maxIndexBuildMemoryUsageMegabytes: 1});
+assert.commandWorked(old);
+
+var pad = new Array(200).join('x');
+for (var i = 0; i < 20000; i++) {
+    t.insert({a: (i * 7919) % 20000, s: pad + i});
+}
+assert.eq(null, db.getLastError());
+
+assert.commandWorked(db.adminCommand({setParameter: 1, maxIndexBuildMemoryUsageMegabytes: 1}));
+t.ensureIndex({s: 1, a: 1});
+assert.eq(null, db.getLastError());
+assert.commandWorked(db.adminCommand({setParameter: 1,
+                                      maxIndexBuildMemoryUsageMegabytes:
+                                          old.maxIndexBuildMemoryUsageMegabytes}));
+
+assert.commandWorked(t.validate(true));
+assert.eq(20000, t.find().hint({s: 1, a: 1}).itcount());
+var last = null;
+t.find({}, {_id: 0, s: 1}).hint({s: 1, a: 1}).forEach(function(doc) {
+    if (last !== null) {
+        assert.lte(last, doc.s);
+    }
+    last = doc.s;
+});
+
+t.drop();
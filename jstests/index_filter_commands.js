@@ -0,0 +1,64 @@
+// Test the index filter commands: planCacheListFilters, planCacheSetFilter and
+// planCacheClearFilters.
+
+var t = db.jstests_index_filter_commands;
+t.drop();
+
+t.ensureIndex({a: 1});
+t.ensureIndex({b: 1});
+for (var i = 0; i < 100; i++) {
+    t.save({a: i, b: i % 10});
+}
+
+function listFilters() {
+    var res = t.runCommand('planCacheListFilters');
+    assert.commandWorked(res, 'planCacheListFilters failed');
+    return res.filters;
+}
+
+function listShapes() {
+    var res = t.runCommand('planCacheListShapes');
+    assert.commandWorked(res, 'planCacheListShapes failed');
+    return res.shapes;
+}
+
+assert.eq(0, listFilters().length, 'no filters expected');
+
+// Cache a plan for the shape, then pin the shape to the index over b.
+assert.eq(1, t.find({a: 5, b: 5}).itcount());
+assert.eq(1, listShapes().length);
+assert.commandWorked(t.runCommand('planCacheSetFilter',
+                                  {query: {a: 1, b: 1}, indexes: [{b: 1}]}));
+var filters = listFilters();
+assert.eq(1, filters.length);
+assert.eq({a: 1, b: 1}, filters[0].query);
+assert.eq([{b: 1}], filters[0].indexes);
+
+// Setting the filter drops the cached plan of the shape.
+assert.eq(0, listShapes().length, 'cached plan should have been dropped');
+
+// Queries of the shape only use the allowed index, even when hinted elsewhere.
+assert.eq('BtreeCursor b_1', t.find({a: 5, b: 5}).explain().cursor);
+assert.eq('BtreeCursor b_1', t.find({a: 5, b: 5}).hint({a: 1}).explain().cursor);
+assert.eq(1, t.find({a: 5, b: 5}).itcount());
+
+// Queries of other shapes are not affected.
+assert.eq('BtreeCursor a_1', t.find({a: 5}).explain().cursor);
+
+// Malformed filters are rejected.
+assert.commandFailed(t.runCommand('planCacheSetFilter', {query: {a: 1}}));
+assert.commandFailed(t.runCommand('planCacheSetFilter', {query: {a: 1}, indexes: []}));
+assert.commandFailed(t.runCommand('planCacheSetFilter', {query: {a: 1}, indexes: [1]}));
+assert.commandFailed(t.runCommand('planCacheSetFilter', {indexes: [{a: 1}]}));
+
+// Clear a single filter.
+assert.commandWorked(t.runCommand('planCacheClearFilters', {query: {a: 7, b: 7}}));
+assert.eq(0, listFilters().length, 'filter should have been dropped');
+assert.commandFailed(t.runCommand('planCacheClearFilters', {query: {a: 7, b: 7}}));
+
+// Clear all filters.
+assert.commandWorked(t.runCommand('planCacheSetFilter', {query: {a: 1}, indexes: [{a: 1}]}));
+assert.commandWorked(t.runCommand('planCacheSetFilter', {query: {b: 1}, indexes: [{b: 1}]}));
+assert.eq(2, listFilters().length);
+assert.commandWorked(t.runCommand('planCacheClearFilters'));
+assert.eq(0, listFilters().length, 'all filters should have been dropped');
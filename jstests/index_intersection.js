@@ -0,0 +1,47 @@
+// Queries over two separately indexed fields may be answered by intersecting the indices.  The
+// results must be the same whichever plan wins.
+
+var t = db.jstests_index_intersection;
+t.drop();
+
+t.ensureIndex({a: 1});
+t.ensureIndex({b: 1});
+for (var i = 0; i < 200; i++) {
+    t.save({a: i % 20, b: i % 7, c: i});
+}
+
+function check(query, expected) {
+    assert.eq(expected, t.find(query).itcount(), tojson(query));
+    // Run it again so that we use the cached plan.
+    assert.eq(expected, t.find(query).itcount(), tojson(query));
+    // The collection scan is the reference.
+    assert.eq(expected, t.find(query).hint({$natural: 1}).itcount(), tojson(query));
+}
+
+// Point predicates.
+check({a: 3, b: 3}, t.find({a: 3}).toArray().filter(function(x) { return x.b == 3; }).length);
+
+// Ranges.
+check({a: {$gt: 15}, b: {$lt: 2}},
+      t.find({a: {$gt: 15}}).toArray().filter(function(x) { return x.b < 2; }).length);
+
+// A predicate neither index answers.
+check({a: {$gte: 10}, b: {$lte: 4}, c: {$mod: [2, 0]}},
+      t.find({a: {$gte: 10}}).toArray().filter(function(x) {
+          return x.b <= 4 && x.c % 2 == 0;
+      }).length);
+
+// Documents whose indexed values are arrays.
+t.save({a: [3, 4], b: [3, 5], c: -1});
+check({a: 4, b: 5}, 1);
+check({a: 3, b: 3}, t.find({a: 3}).toArray().filter(function(x) {
+    return x.b == 3 || (x.b instanceof Array && x.b.indexOf(3) >= 0);
+}).length);
+
+// With intersection plans disabled we get the same answers.
+assert.commandWorked(db.adminCommand({setParameter: 1,
+                                      internalQueryPlannerEnableIndexIntersection: false}));
+t.runCommand('planCacheClear');
+check({a: 3, b: 3}, t.find({a: 3, b: 3}).hint({$natural: 1}).itcount());
+assert.commandWorked(db.adminCommand({setParameter: 1,
+                                      internalQueryPlannerEnableIndexIntersection: true}));
@@ -0,0 +1,70 @@
+// A v:2 index stores the key data of adjacent duplicate keys once.  It must answer queries as a
+// v:1 index does, stay valid through inserts, splits, deletes and merges, and be smaller when
+// keys repeat.
+
+var v1 = db.jstests_index_v2_v1;
+var v2 = db.jstests_index_v2_v2;
+v1.drop();
+v2.drop();
+
+var pad = new Array(100).join('x');
+function doc(i) {
+    return {_id: i, tenant: pad + (i % 5), n: i % 3};
+}
+
+for (var i = 0; i < 20000; i++) {
+    v1.insert(doc(i));
+    v2.insert(doc(i));
+}
+assert.eq(null, db.getLastError());
+
+// Built bottom up.
+v1.ensureIndex({tenant: 1, n: 1});
+v2.ensureIndex({tenant: 1, n: 1}, {v: 2});
+assert.eq(null, db.getLastError());
+
+function indexEntry(t) {
+    return db.system.indexes.findOne({ns: t.getFullName(), name: 'tenant_1_n_1'});
+}
+assert.eq(1, indexEntry(v1).v);
+assert.eq(2, indexEntry(v2).v);
+
+function check() {
+    assert(v1.validate(true).valid);
+    assert(v2.validate(true).valid);
+    for (var t = 0; t < 5; t++) {
+        for (var n = 0; n < 3; n++) {
+            var query = {tenant: pad + t, n: n};
+            assert.eq(v1.find(query).hint({tenant: 1, n: 1}).itcount(),
+                      v2.find(query).hint({tenant: 1, n: 1}).itcount());
+        }
+    }
+    assert.eq(v1.find({}, {_id: 1}).hint({tenant: 1, n: 1}).toArray(),
+              v2.find({}, {_id: 1}).hint({tenant: 1, n: 1}).toArray());
+}
+
+check();
+assert.lt(v2.stats().indexSizes.tenant_1_n_1 * 2, v1.stats().indexSizes.tenant_1_n_1);
+
+// Keys added one at a time, splitting buckets.
+for (i = 20000; i < 30000; i++) {
+    v1.insert(doc(i));
+    v2.insert(doc(i));
+}
+assert.eq(null, db.getLastError());
+check();
+
+// Keys removed, rebalancing and merging buckets.
+v1.remove({_id: {$mod: [4, 1]}});
+v2.remove({_id: {$mod: [4, 1]}});
+check();
+v1.remove({_id: {$lt: 25000}});
+v2.remove({_id: {$lt: 25000}});
+check();
+
+// This version cannot be built, or used, by an older mongod.
+v2.ensureIndex({n: 1}, {v: 3});
+assert(db.getLastError());
+
+v1.drop();
+v2.drop();
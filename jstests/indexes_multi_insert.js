@@ -0,0 +1,41 @@
+// Index specs inserted into system.indexes together are built with one scan of each collection.
+
+var t = db.jstests_indexes_multi_insert;
+var u = db.jstests_indexes_multi_insert2;
+t.drop();
+u.drop();
+
+for (var i = 0; i < 1000; i++) {
+    t.insert({a: i, b: [i, i + 1], c: i % 10});
+    u.insert({a: i});
+}
+assert.eq(null, db.getLastError());
+
+db.system.indexes.insert([
+    {ns: t.getFullName(), key: {a: 1}, name: "a_1", unique: true},
+    {ns: t.getFullName(), key: {b: 1}, name: "b_1"},
+    {ns: t.getFullName(), key: {c: 1, a: -1}, name: "c_1_a_-1"},
+    {ns: u.getFullName(), key: {a: 1}, name: "a_1"},
+    {ns: u.getFullName(), key: {a: -1}, name: "a_-1"}
+]);
+assert.eq(null, db.getLastError());
+assert.eq(4, t.getIndexes().length);
+assert.eq(3, u.getIndexes().length);
+
+var res = t.validate(true);
+assert(res.valid, tojson(res));
+assert.eq(1000, res.keysPerIndex[t.getFullName() + ".$a_1"]);
+assert.eq(1001, res.keysPerIndex[t.getFullName() + ".$b_1"]);
+assert.eq(100, t.find({c: 3}).hint({c: 1, a: -1}).itcount());
+assert.eq(1, u.find({a: 5}).hint({a: -1}).itcount());
+
+// A unique index on duplicates fails, and the indexes built with it aren't kept.
+db.system.indexes.insert([
+    {ns: t.getFullName(), key: {c: 1}, name: "c_1", unique: true},
+    {ns: t.getFullName(), key: {a: 1, b: 1}, name: "a_1_b_1"}
+]);
+assert.neq(null, db.getLastError());
+assert.eq(4, t.getIndexes().length);
+
+t.drop();
+u.drop();
@@ -0,0 +1,60 @@
+// Documents inserted together by a batch go into the indexes together.  They end up with the same
+// documents, keys and errors as if they had been inserted one at a time.
+
+var coll = db.insert_batch_indexes;
+
+function insert( docs, ordered ) {
+    return coll.runCommand({ insert : coll.getName(), documents : docs, ordered : ordered });
+}
+
+function checkIndexes( n ) {
+    assert.eq( n, coll.count() );
+    assert.eq( n, coll.find().hint({ a : 1 }).itcount() );
+    assert.eq( n, coll.find().hint({ b : 1 }).itcount() );
+    assert( coll.validate( true ).valid );
+}
+
+coll.drop();
+coll.ensureIndex({ a : 1 }, { unique : true });
+coll.ensureIndex({ b : 1 });
+
+// More documents than go in together, in descending key order
+var docs = [];
+for ( var i = 200; i > 0; i-- ) docs.push({ a : i, b : [ i, -i ] });
+var result = insert( docs, true );
+assert( result.ok, tojson( result ) );
+assert.eq( 200, result.n );
+checkIndexes( 200 );
+assert.eq( 1, coll.find({ b : -7 }).hint({ b : 1 }).itcount() );
+assert( coll.find({ b : -7 }).hint({ b : 1 }).explain().isMultiKey );
+
+// A duplicate in the middle stops an ordered batch there
+docs = [ { a : 1000, b : 0 }, { a : 1001, b : 0 }, { a : 1000, b : 0 }, { a : 1002, b : 0 } ];
+result = insert( docs, true );
+assert.eq( 2, result.n, tojson( result ) );
+assert.eq( 1, result.errDetails.length );
+assert.eq( 2, result.errDetails[0].index );
+checkIndexes( 202 );
+assert.eq( 0, coll.find({ a : 1002 }).itcount() );
+
+// ... and only fails itself in an unordered one
+docs = [ { a : 1002, b : 0 }, { a : 5, b : 0 }, { a : 1003, b : 0 }, { a : 1003, b : 0 } ];
+result = insert( docs, false );
+assert.eq( 2, result.n, tojson( result ) );
+assert.eq( 2, result.errDetails.length );
+assert.eq( 1, result.errDetails[0].index );
+assert.eq( 3, result.errDetails[1].index );
+checkIndexes( 204 );
+assert.eq( 0, coll.find({ b : 5 }).hint({ b : 1 }).itcount() );
+
+// A document failing one unique index doesn't keep a later one out of another
+coll.drop();
+coll.ensureIndex({ a : 1 }, { unique : true });
+coll.ensureIndex({ b : 1 }, { unique : true });
+coll.insert({ a : 0, b : 0 });
+result = insert( [ { a : 0, b : 1 }, { a : 1, b : 1 }, { a : 2, b : 2 } ], false );
+assert.eq( 2, result.n, tojson( result ) );
+assert.eq( 1, result.errDetails.length );
+assert.eq( 0, result.errDetails[0].index );
+checkIndexes( 3 );
+assert.eq( 1, coll.find({ a : 1, b : 1 }).hint({ b : 1 }).itcount() );
@@ -0,0 +1,66 @@
+// A mapReduce reduce can be given as accumulators, which reduce the values without calling into
+// JavaScript.  The results are those of the equivalent reduce function.
+
+var t = db.mr_native_reduce;
+t.drop();
+
+for (var i = 0; i < 3000; i++) {
+    t.insert({key: i % 7, n: i});
+}
+assert.eq(null, db.getLastError());
+
+function map() { emit(this.key, this.n); }
+function mapObject() { emit(this.key, {count: 1, top: this.n, low: this.n}); }
+
+function sorted(results) {
+    return results.sort(function(a, b) { return a._id - b._id; });
+}
+
+function check(nativeReduce, reduce, m, options) {
+    options = options || {};
+    options.out = options.out || {inline: 1};
+    var expected = t.mapReduce(m, reduce, options);
+    var res = t.mapReduce(m, nativeReduce, options);
+    assert(res.ok, tojson(res));
+    assert.eq(expected.counts.input, res.counts.input);
+    assert.eq(expected.counts.emit, res.counts.emit);
+    if (options.out.inline) {
+        assert.eq(sorted(expected.results), sorted(res.results));
+    }
+    return res;
+}
+
+check({$sum: 1}, function(k, vs) { return Array.sum(vs); }, map);
+check({$max: 1}, function(k, vs) { return Math.max.apply(null, vs); }, map);
+check({$min: 1}, function(k, vs) { return Math.min.apply(null, vs); }, map);
+
+var objectReduce = function(k, vs) {
+    var out = {count: 0, top: vs[0].top, low: vs[0].low};
+    vs.forEach(function(v) {
+        out.count += v.count;
+        out.top = Math.max(out.top, v.top);
+        out.low = Math.min(out.low, v.low);
+    });
+    return out;
+};
+var nativeObject = {count: {$sum: 1}, top: {$max: 1}, low: {$min: 1}};
+check(nativeObject, objectReduce, mapObject);
+check(nativeObject, objectReduce, mapObject, {jsMode: true});
+check(nativeObject, objectReduce, mapObject,
+      {finalize: function(k, v) { return v.count; }});
+
+// To a collection
+check({$sum: 1}, function(k, vs) { return Array.sum(vs); }, map, {out: 'mr_native_reduce_out'});
+var out = db.mr_native_reduce_out.find().sort({_id: 1}).toArray();
+assert.eq(7, out.length);
+var total = 0;
+out.forEach(function(r) { total += r.value; });
+assert.eq(3000 * 2999 / 2, total);
+
+// Operators that would not reduce again what they reduced are refused
+[{$avg: 1}, {$push: 1}, {$sum: 2}, {}, {$sum: 1, $max: 1}, {a: {$sum: 1, $max: 1}}]
+    .forEach(function(reduce) {
+        var res = db.runCommand({mapReduce: t.getName(), map: map, reduce: reduce,
+                                 out: {inline: 1}});
+        assert(!res.ok, tojson(reduce));
+    });
@@ -0,0 +1,39 @@
+// An update that leaves the indexed fields of a document alone leaves its keys alone, however
+// large the arrays indexed.  Updates that change them still update the keys.
+
+var t = db.jstests_multikey_update_unchanged;
+t.drop();
+
+var tags = [];
+for (var i = 0; i < 5000; i++) {
+    tags.push('tag' + i);
+}
+t.insert({_id: 0, tags: tags, sub: {a: [1, 2, 3]}, n: 0});
+t.ensureIndex({tags: 1});
+t.ensureIndex({'sub.a': 1});
+
+function keyUpdates(update) {
+    db.setProfilingLevel(2);
+    t.update({_id: 0}, update);
+    assert.eq(null, db.getLastError());
+    db.setProfilingLevel(0);
+    var op = db.system.profile.find({ns: t.getFullName(), op: 'update'}).sort({$natural: -1})
+        .limit(1).next();
+    db.system.profile.drop();
+    return op.keyUpdates;
+}
+
+db.system.profile.drop();
+assert.eq(0, keyUpdates({$inc: {n: 1}}));
+assert.eq(0, keyUpdates({$set: {tags: tags}}));
+t.update({_id: 0}, {$push: {tags: 'new'}});
+t.update({_id: 0}, {$set: {'sub.a': [1, 2, 3, 4]}});
+
+assert.eq(1, t.find({tags: 'new'}).hint({tags: 1}).itcount());
+assert.eq(1, t.find({tags: 'tag4999'}).hint({tags: 1}).itcount());
+assert.eq(1, t.find({'sub.a': 4}).hint({'sub.a': 1}).itcount());
+assert.eq(1, t.find({tags: 'tag0', n: 1}).hint({tags: 1}).itcount());
+
+t.update({_id: 0}, {$pull: {tags: 'tag0'}});
+assert.eq(0, t.find({tags: 'tag0'}).hint({tags: 1}).itcount());
+assert(t.validate(true).valid);
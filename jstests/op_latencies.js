@@ -0,0 +1,58 @@
+// The opLatencies serverStatus section and command report latency histograms of the operations
+// run, by type, and with opLatencyNamespaces by namespace.
+
+var t = db.jstests_op_latencies;
+t.drop();
+
+var admin = db.getSisterDB( "admin" );
+
+function latencies() {
+    var res = admin.runCommand( { opLatencies : 1 } );
+    assert.commandWorked( res );
+    return res;
+}
+
+var before = db.serverStatus().opLatencies;
+for ( var i = 0; i < 50; i++ ) {
+    t.insert( { _id : i } );
+    t.findOne( { _id : i } );
+}
+assert.eq( null, db.getLastError() );
+var after = db.serverStatus().opLatencies;
+
+assert.lte( before.insert.count + 50, after.insert.count );
+assert.lte( before.query.count + 50, after.query.count );
+[ "query", "getmore", "insert", "update", "delete", "command" ].forEach( function( op ) {
+    var h = after[op];
+    assert( h, op );
+    assert.lte( h.p50, h.p95, op );
+    assert.lte( h.p95, h.p99, op );
+    assert.lte( h.p99, h.p999, op );
+    assert.isnull( h.buckets, op );
+} );
+
+// The buckets add up to the count.
+var res = latencies();
+var insert = res.totals.insert;
+var inBuckets = 0;
+insert.buckets.forEach( function( b ) { inBuckets += b.count; } );
+assert.eq( insert.count, inBuckets, tojson( insert ) );
+assert.eq( insert.buckets.length,
+           db.serverStatus( { opLatencies : { buckets : true } } ).opLatencies.insert.buckets.length );
+assert.isnull( admin.runCommand( { opLatencies : 1 , buckets : false } ).totals.insert.buckets );
+
+// No namespaces are kept until opLatencyNamespaces is set.
+assert.eq( {}, res.namespaces );
+assert.commandWorked( admin.runCommand( { setParameter : 1 , opLatencyNamespaces : 10 } ) );
+for ( var i = 0; i < 10; i++ )
+    t.findOne( { _id : i } );
+var ns = latencies().namespaces[ t.getFullName() ];
+assert( ns, tojson( latencies().namespaces ) );
+assert.eq( 10, ns.query.count, tojson( ns ) );
+assert.isnull( ns.insert, tojson( ns ) );
+
+// Dropping the collection gives its histograms up.
+t.drop();
+assert.isnull( latencies().namespaces[ t.getFullName() ] );
+
+assert.commandWorked( admin.runCommand( { setParameter : 1 , opLatencyNamespaces : 0 } ) );
@@ -0,0 +1,58 @@
+// parallelCollectionScan returns cursors over disjoint extent ranges which together cover the
+// whole collection.
+
+var t = db.jstests_parallel_collection_scan;
+t.drop();
+
+// Small extents so there are plenty to split up.
+db.createCollection(t.getName(), {size: 4096});
+var pad = new Array(1024).join('x');
+for (var i = 0; i < 1000; i++) {
+    t.insert({_id: i, pad: pad});
+}
+assert.eq(null, db.getLastError());
+var numExtents = t.stats().numExtents;
+assert.lt(2, numExtents);
+
+function drain(numCursors) {
+    var res = t.runCommand({parallelCollectionScan: t.getName(), numCursors: numCursors});
+    assert.commandWorked(res);
+    assert.lte(res.cursors.length, numCursors);
+
+    var seen = {};
+    var total = 0;
+    for (var i = 0; i < res.cursors.length; i++) {
+        var cursor = new DBCommandCursor(db.getMongo(), res.cursors[i], 50);
+        while (cursor.hasNext()) {
+            var id = cursor.next()._id;
+            assert(!seen[id], "saw _id " + id + " twice");
+            seen[id] = true;
+            total++;
+        }
+    }
+    assert.eq(t.count(), total);
+    return res.cursors.length;
+}
+
+assert.eq(1, drain(1));
+assert.lt(1, drain(4));
+
+// We don't make more cursors than there are extents.
+assert.gte(numExtents, drain(numExtents + 10));
+
+// Removed documents aren't returned.
+t.remove({_id: {$lt: 500}});
+drain(3);
+
+// Bad arguments.
+assert.commandFailed(t.runCommand({parallelCollectionScan: t.getName(), numCursors: 0}));
+assert.commandFailed(t.runCommand({parallelCollectionScan: t.getName(), numCursors: "a"}));
+assert.commandFailed(t.runCommand({parallelCollectionScan: "doesnotexist", numCursors: 2}));
+
+db.createCollection("jstests_parallel_collection_scan_capped", {capped: true, size: 4096});
+assert.commandFailed(db.runCommand({parallelCollectionScan:
+                                    "jstests_parallel_collection_scan_capped",
+                                    numCursors: 2}));
+db.jstests_parallel_collection_scan_capped.drop();
+
+t.drop();
@@ -0,0 +1,64 @@
+// Test the plan cache commands: planCacheListShapes, planCacheListPlans and planCacheClear.
+
+var t = db.jstests_plan_cache_commands;
+t.drop();
+
+t.ensureIndex({a: 1});
+t.ensureIndex({b: 1});
+for (var i = 0; i < 100; i++) {
+    t.save({a: i, b: i % 10});
+}
+
+function listShapes() {
+    var res = t.runCommand('planCacheListShapes');
+    assert.commandWorked(res, 'planCacheListShapes failed');
+    return res.shapes;
+}
+
+// Nothing has been cached yet.
+assert.eq(0, listShapes().length, 'plan cache should be empty');
+
+// The query has a choice of indices, so the winning plan is cached.
+assert.eq(10, t.find({a: {$gte: 0}, b: 3}).itcount());
+var shapes = listShapes();
+assert.eq(1, shapes.length, 'one query shape should be cached');
+assert.eq({a: {$gte: 0}, b: 3}, shapes[0].query);
+assert.eq({}, shapes[0].sort);
+assert.eq({}, shapes[0].projection);
+
+// A query of the same shape with different constants uses the cached plan.
+assert.eq(10, t.find({a: {$gte: 10}, b: 5}).itcount());
+assert.lt(0, listShapes()[0].hits, 'cached plan should have been used');
+
+// The cached plan of a shape can be looked up with any query of that shape.
+var res = t.runCommand('planCacheListPlans', {query: {a: {$gte: 50}, b: 1}});
+assert.commandWorked(res, 'planCacheListPlans failed');
+assert.eq(1, res.plans.length);
+assert(res.plans[0].details, 'cached plan should be described');
+assert(res.plans[0].reason, 'cached plan should record why it won');
+
+// Unknown shapes and malformed arguments are errors.
+assert.commandFailed(t.runCommand('planCacheListPlans', {query: {c: 1}}));
+assert.commandFailed(t.runCommand('planCacheListPlans', {}));
+assert.commandFailed(t.runCommand('planCacheListPlans', {query: 1}));
+
+// Clear a single shape.
+assert.commandWorked(t.runCommand('planCacheClear', {query: {a: {$gte: 1}, b: 2}}));
+assert.eq(0, listShapes().length, 'shape should have been dropped');
+assert.commandFailed(t.runCommand('planCacheClear', {query: {a: {$gte: 1}, b: 2}}));
+
+// Clear the whole cache.
+t.find({a: {$gte: 0}, b: 3}).itcount();
+t.find({a: {$gte: 0}, b: 3}).sort({a: 1}).itcount();
+assert.eq(2, listShapes().length);
+assert.commandWorked(t.runCommand('planCacheClear'));
+assert.eq(0, listShapes().length, 'plan cache should be empty after clear');
+
+// Building an index invalidates the cache.
+t.find({a: {$gte: 0}, b: 3}).itcount();
+assert.eq(1, listShapes().length);
+t.ensureIndex({a: 1, b: 1});
+assert.eq(0, listShapes().length, 'index build should clear the plan cache');
+
+// The commands need an existing collection.
+assert.commandFailed(db.jstests_plan_cache_commands_missing.runCommand('planCacheListShapes'));
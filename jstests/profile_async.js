@@ -0,0 +1,77 @@
+// With profileAsync a background thread writes system.profile, and profileSampleRate keeps only
+// that fraction of the operations the profiling level selects.
+
+// special db so that it can be run in parallel tests
+var stddb = db;
+var db = db.getSisterDB( "profile_async" );
+var admin = db.getSisterDB( "admin" );
+
+var t = db.profile_async;
+t.drop();
+for ( var i = 0; i < 200; i++ )
+    t.insert( { _id : i } );
+assert.eq( null, db.getLastError() );
+
+function setParameter( name, value ) {
+    var cmd = { setParameter : 1 };
+    cmd[name] = value;
+    assert.commandWorked( admin.runCommand( cmd ) );
+}
+
+function profiled() {
+    return db.system.profile.find( { ns : t.getFullName() } ).count();
+}
+
+function metrics() {
+    return db.serverStatus().metrics.profile;
+}
+
+function findAll( n ) {
+    for ( var i = 0; i < n; i++ )
+        t.findOne( { _id : i } );
+}
+
+try {
+    db.setProfilingLevel( 0 );
+    db.system.profile.drop();
+
+    // Written in the background, and all of them at the default rate.
+    setParameter( "profileAsync", true );
+    var before = metrics();
+    db.setProfilingLevel( 2 );
+    findAll( 50 );
+    assert.soon( function() { return profiled() >= 50; }, "async profile entries not written" );
+    var after = metrics();
+    assert.lte( before.written + 50, after.written, tojson( after ) );
+    assert.eq( before.sampledOut, after.sampledOut, tojson( after ) );
+
+    // None at rate 0.
+    db.setProfilingLevel( 0 );
+    db.system.profile.drop();
+    setParameter( "profileSampleRate", 0 );
+    db.setProfilingLevel( 2 );
+    findAll( 50 );
+    db.setProfilingLevel( 0 );
+    sleep( 2000 );
+    assert.eq( 0, profiled() );
+    assert.lte( before.sampledOut + 50, metrics().sampledOut );
+
+    // About half at rate 0.5, without profileAsync too.
+    setParameter( "profileAsync", false );
+    setParameter( "profileSampleRate", 0.5 );
+    db.system.profile.drop();
+    db.setProfilingLevel( 2 );
+    findAll( 200 );
+    db.setProfilingLevel( 0 );
+    var n = profiled();
+    assert.lt( 50, n );
+    assert.gt( 150, n );
+}
+finally {
+    db.setProfilingLevel( 0 );
+    setParameter( "profileAsync", false );
+    setParameter( "profileSampleRate", 1.0 );
+    db.system.profile.drop();
+    t.drop();
+    db = stddb;
+}
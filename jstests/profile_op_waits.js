@@ -0,0 +1,49 @@
+// Profile entries say how long the operation yielded, how many of its records weren't in memory
+// and how many page fault exceptions it threw, as well as how long it waited for each lock.
+
+// special db so that it can be run in parallel tests
+var stddb = db;
+var db = db.getSisterDB( "profile_op_waits" );
+
+var t = db.profile_op_waits;
+t.drop();
+for ( var i = 0; i < 1000; i++ )
+    t.insert( { _id : i , x : i % 10 } );
+assert.eq( null, db.getLastError() );
+
+try {
+    db.setProfilingLevel( 0 );
+    db.system.profile.drop();
+    db.setProfilingLevel( 2 );
+
+    t.find( { x : 3 } ).itcount();
+    t.update( { x : 4 }, { $inc : { y : 1 } }, false, true );
+    assert.eq( null, db.getLastError() );
+
+    db.setProfilingLevel( 0 );
+
+    var entries = db.system.profile.find( { ns : t.getFullName() } ).toArray();
+    assert.lte( 2, entries.length, tojson( entries ) );
+    entries.forEach( function( p ) {
+        assert.lte( 0, p.yieldMicros, tojson( p ) );
+        assert.lte( 0, p.accessesNotInMemory, tojson( p ) );
+        assert.lte( 0, p.pageFaultExceptions, tojson( p ) );
+        if ( p.numYield == 0 )
+            assert.eq( 0, p.yieldMicros, tojson( p ) );
+        assert( p.lockStats.timeAcquiringMicros, tojson( p ) );
+    } );
+
+    // currentOp reports them for operations in progress.
+    var ops = db.currentOp( true ).inprog;
+    assert.lt( 0, ops.length );
+    ops.forEach( function( op ) {
+        if ( op.active )
+            assert.lte( 0, op.yieldMicros, tojson( op ) );
+    } );
+}
+finally {
+    db.setProfilingLevel( 0 );
+    db.system.profile.drop();
+    t.drop();
+    db = stddb;
+}
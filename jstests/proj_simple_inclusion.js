@@ -0,0 +1,34 @@
+// Projections which only include top-level fields take a fast path.  Check that it produces the
+// same documents as the general path.
+
+var t = db.jstests_proj_simple_inclusion;
+t.drop();
+
+t.insert({_id: 1, a: 1, b: {c: 2}, d: [1, 2, 3], e: "x", f: null});
+t.insert({_id: 2, b: 5, e: {y: 1}});
+t.insert({_id: 3});
+assert.eq(null, db.getLastError());
+
+function check(proj, expected) {
+    assert.eq(expected, t.find({}, proj).sort({_id: 1}).toArray(), tojson(proj));
+}
+
+// Adjacent and non-adjacent fields, in document order whatever the projection order.
+check({a: 1, b: 1},
+      [{_id: 1, a: 1, b: {c: 2}}, {_id: 2, b: 5}, {_id: 3}]);
+check({e: 1, a: 1},
+      [{_id: 1, a: 1, e: "x"}, {_id: 2, e: {y: 1}}, {_id: 3}]);
+check({d: 1, f: 1, missing: 1},
+      [{_id: 1, d: [1, 2, 3], f: null}, {_id: 2}, {_id: 3}]);
+
+// _id.
+check({_id: 0, b: 1, e: 1},
+      [{b: {c: 2}, e: "x"}, {b: 5, e: {y: 1}}, {}]);
+check({_id: 1, e: 1},
+      [{_id: 1, e: "x"}, {_id: 2, e: {y: 1}}, {_id: 3}]);
+
+// Mixed with a dotted field we take the general path.
+check({a: 1, "b.c": 1},
+      [{_id: 1, a: 1, b: {c: 2}}, {_id: 2}, {_id: 3}]);
+
+t.drop();
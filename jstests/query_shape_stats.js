@@ -0,0 +1,45 @@
+// Test the queryShapeStats and queryShapeStatsClear commands.
+
+var t = db.jstests_query_shape_stats;
+t.drop();
+
+t.ensureIndex({a: 1});
+for (var i = 0; i < 100; i++) {
+    t.save({a: i, b: i % 10});
+}
+
+function listShapes(extra) {
+    var res = t.runCommand('queryShapeStats', extra || {});
+    assert.commandWorked(res, 'queryShapeStats failed');
+    return res.shapes;
+}
+
+assert.commandWorked(t.runCommand('queryShapeStatsClear'));
+assert.eq(0, listShapes().length, 'no shapes should be recorded');
+
+// Queries of the same shape add up, whatever their constants.
+assert.eq(10, t.find({b: 3}).itcount());
+assert.eq(10, t.find({b: 4}).itcount());
+var shapes = listShapes();
+assert.eq(1, shapes.length, tojson(shapes));
+assert.eq(2, shapes[0].count);
+assert.eq(20, shapes[0].nreturned);
+assert.eq(200, shapes[0].docsExamined, 'unindexed query should scan the collection');
+assert.eq(10, shapes[0].docsExaminedPerReturned);
+assert.lte(shapes[0].maxMicros, shapes[0].totalMicros);
+
+// A query using the index is a shape of its own, and examines only what it returns.
+assert.eq(1, t.find({a: 5}).itcount());
+shapes = listShapes();
+assert.eq(2, shapes.length, tojson(shapes));
+var indexed = shapes.filter(function(s) { return s.query.a !== undefined; })[0];
+assert.eq(1, indexed.keysExamined);
+assert.eq(1, indexed.docsExamined);
+assert.eq(1, indexed.nreturned);
+
+assert.eq(1, listShapes({limit: 1}).length);
+assert.commandFailed(t.runCommand('queryShapeStats', {limit: -1}));
+
+// Clearing forgets every shape.
+assert.commandWorked(t.runCommand('queryShapeStatsClear'));
+assert.eq(0, listShapes().length, 'shapes should have been cleared');
@@ -0,0 +1,24 @@
+// serverStatus reports how many deleted records were examined to allocate record space.
+
+var t = db.jstests_record_alloc_metrics;
+t.drop();
+
+function allocMetrics() {
+    return db.serverStatus().metrics.record.alloc;
+}
+
+t.insert({a: 1});
+assert.eq(null, db.getLastError());
+
+var before = allocMetrics();
+for (var i = 0; i < 100; i++) {
+    t.insert({a: i});
+}
+assert.eq(null, db.getLastError());
+var after = allocMetrics();
+
+assert.gte(after.count - before.count, 100, tojson({before: before, after: after}));
+assert.gte(after.probes - before.probes, after.count - before.count,
+           tojson({before: before, after: after}));
+
+t.drop();
@@ -0,0 +1,48 @@
+// A secondary applies the ops on a collection on several writer threads, split by _id, and ends
+// up with the same documents as the primary.  Capped collections and collections with another
+// unique index keep their ops on one writer.
+
+var replTest = new ReplSetTest({name: "apply_ops_by_id", nodes: 2});
+replTest.startSet();
+replTest.initiate();
+
+var primary = replTest.getMaster().getDB("test");
+replTest.awaitSecondaryNodes();
+var secondary = replTest.liveNodes.slaves[0].getDB("test");
+secondary.getMongo().setSlaveOk();
+
+primary.createCollection("capped", {capped: true, size: 100000});
+primary.unique.ensureIndex({u: 1}, {unique: true});
+assert.eq(null, primary.getLastError());
+
+for (var i = 0; i < 2000; i++) {
+    primary.plain.insert({_id: i, n: 0});
+    primary.capped.insert({_id: i, n: i});
+    primary.unique.insert({_id: i, u: i});
+}
+for (var round = 0; round < 5; round++) {
+    for (var i = 0; i < 2000; i++) {
+        primary.plain.update({_id: i}, {$inc: {n: 1}});
+        // u moves between documents, which must be applied in order
+        primary.unique.update({_id: i}, {$set: {u: -1 - i}});
+        primary.unique.update({_id: (i + 1) % 2000}, {$set: {u: i}});
+    }
+}
+for (var i = 0; i < 2000; i += 3) {
+    primary.plain.remove({_id: i});
+}
+assert.eq(null, primary.getLastError());
+replTest.awaitReplication();
+
+["plain", "capped", "unique"].forEach(function(name) {
+    var sort = name == "capped" ? {$natural: 1} : {_id: 1};
+    var expected = primary[name].find().sort(sort).toArray();
+    var actual = secondary[name].find().sort(sort).toArray();
+    assert.eq(expected.length, actual.length, name);
+    for (var i = 0; i < expected.length; i++) {
+        assert.docEq(expected[i], actual[i], name + " " + i);
+    }
+});
+assert.eq(5, secondary.plain.findOne({_id: 1}).n);
+
+replTest.stopSet();
@@ -0,0 +1,47 @@
+// A new member syncing from a secondary copies its data files, with the indexes built, instead of
+// cloning the documents, then catches up on the writes the primary takes meanwhile.  The source
+// takes writes again once the copy is done.
+
+var rs = new ReplSetTest({name: 'initial_sync_copy_files', nodes: 2});
+rs.startSet();
+rs.initiate();
+var primary = rs.getMaster();
+var source = rs.getSecondary();
+var db1 = primary.getDB('test');
+
+var pad = new Array(200).join('x');
+for (var i = 0; i < 20000; i++) {
+    db1.a.insert({_id: i, x: i % 100, pad: pad});
+}
+db1.a.ensureIndex({x: 1});
+primary.getDB('other').b.insert({y: 1});
+assert.eq(null, db1.getLastError());
+rs.awaitReplication();
+
+var writes = startParallelShell(
+    "for (var i = 0; i < 2000; i++) {" +
+    "    db.a.update({_id: i}, {$set: {updated: true}});" +
+    "}" +
+    "db.getLastError();", primary.port);
+
+var secondary = rs.add({setParameter: 'initialSyncCopyDataFiles=true'});
+rs.reInitiate();
+assert.soon(function() {
+    var res = secondary.getDB('admin').runCommand({replSetSyncFrom: source.host});
+    return res.ok;
+});
+rs.awaitSecondaryNodes();
+writes();
+rs.awaitReplication();
+
+assert.eq(false, source.getDB('admin').currentOp().fsyncLock || false);
+
+secondary.setSlaveOk();
+var db2 = secondary.getDB('test');
+assert.eq(20000, db2.a.count());
+assert.eq(2000, db2.a.count({updated: true}));
+assert.eq(200, db2.a.find({x: 7}).hint({x: 1}).itcount());
+assert.eq(1, secondary.getDB('other').b.count());
+assert(db2.a.validate(true).valid);
+
+rs.stopSet();
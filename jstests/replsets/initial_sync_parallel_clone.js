@@ -0,0 +1,49 @@
+// A new member clones the collections of a database on several connections at once, and ends
+// up with the documents and indexes of each, including while the primary takes writes.
+
+var rs = new ReplSetTest({name: 'initial_sync_parallel_clone', nodes: 1});
+rs.startSet();
+rs.initiate();
+var primary = rs.getMaster();
+var db1 = primary.getDB('test');
+
+var pad = new Array(200).join('x');
+var sizes = [0, 1, 2000, 5000, 300, 12000];
+sizes.forEach(function(n, c) {
+    db1.createCollection('c' + c);
+    for (var i = 0; i < n; i++) {
+        db1['c' + c].insert({_id: i, x: i % 100, pad: pad});
+    }
+    db1['c' + c].ensureIndex({x: 1});
+});
+db1.createCollection('capped', {capped: true, size: 100000});
+db1.capped.insert({a: 1});
+assert.eq(null, db1.getLastError());
+
+var writes = startParallelShell(
+    "for (var i = 0; i < 5000; i++) {" +
+    "    db.c5.update({_id: i}, {$set: {updated: true}});" +
+    "    db.c2.insert({_id: 'new' + i, x: -1});" +
+    "}" +
+    "db.getLastError();", primary.port);
+
+var secondary = rs.add({setParameter: 'initialSyncCloneThreads=3'});
+rs.reInitiate();
+rs.awaitSecondaryNodes();
+writes();
+rs.awaitReplication();
+
+secondary.setSlaveOk();
+var db2 = secondary.getDB('test');
+for (var c = 0; c < sizes.length; c++) {
+    var name = 'c' + c;
+    assert.eq(db1[name].count(), db2[name].count(), name);
+    assert.eq(db1[name].find({x: 7}).itcount(), db2[name].find({x: 7}).hint({x: 1}).itcount(),
+              name);
+    assert.eq(2, db2.system.indexes.count({ns: 'test.' + name}), name);
+}
+assert.eq(5000, db2.c5.count({updated: true}));
+assert.eq(1, db2.capped.count());
+assert(db2.capped.isCapped());
+
+rs.stopSet();
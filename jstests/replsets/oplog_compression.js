@@ -0,0 +1,36 @@
+// A secondary that asks for its sync source to compress the oplog gets the same documents, and
+// reports the bytes compression saved.
+
+var replTest = new ReplSetTest({name: "oplog_compression", nodes: 2});
+replTest.startSet();
+replTest.initiate();
+
+var primary = replTest.getMaster();
+replTest.awaitSecondaryNodes();
+var secondary = replTest.liveNodes.slaves[0];
+assert.commandWorked(secondary.getDB("admin").runCommand({setParameter: 1,
+                                                           replOplogCompression: true}));
+
+// a new sync source connection takes the parameter
+assert.commandWorked(secondary.getDB("admin").runCommand({replSetSyncFrom: primary.host}));
+
+var t = primary.getDB("test").oplog_compression;
+var pad = new Array(512).join("compressible ");
+for (var i = 0; i < 5000; i++) {
+    t.insert({_id: i, pad: pad, n: i});
+}
+assert.eq(null, primary.getDB("test").getLastError());
+replTest.awaitReplication();
+
+secondary.setSlaveOk();
+var s = secondary.getDB("test").oplog_compression;
+assert.eq(5000, s.count());
+assert.eq(pad, s.findOne({_id: 4999}).pad);
+
+var saved = secondary.getDB("admin").serverStatus().metrics.repl.network.compressionBytesSaved;
+assert.gt(saved, 0);
+var self = secondary.getDB("admin").runCommand({replSetGetStatus: 1}).members.filter(
+    function(m) { return m.self; })[0];
+assert.gt(self.oplogCompressionBytesSaved, 0, tojson(self));
+
+replTest.stopSet();
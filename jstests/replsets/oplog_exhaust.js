@@ -0,0 +1,39 @@
+// A secondary tailing its sync source's oplog with an exhaust cursor, with and without
+// compression, or with a getMore per batch, ends up with the primary's documents.
+
+var replTest = new ReplSetTest({name: "oplog_exhaust", nodes: 2});
+replTest.startSet();
+replTest.initiate();
+
+var primary = replTest.getMaster();
+replTest.awaitSecondaryNodes();
+var secondary = replTest.liveNodes.slaves[0];
+secondary.setSlaveOk();
+var admin = secondary.getDB("admin");
+
+var t = primary.getDB("test").oplog_exhaust;
+var pad = new Array(100).join("x");
+var n = 0;
+function writeAndCheck(params) {
+    assert.commandWorked(admin.runCommand(Object.extend({setParameter: 1}, params)));
+    // a new connection to the sync source takes the parameters
+    assert.commandWorked(admin.runCommand({replSetSyncFrom: primary.host}));
+
+    for (var i = 0; i < 3000; i++) {
+        t.insert({_id: n++, pad: pad});
+        t.update({_id: n - 1}, {$set: {done: true}});
+    }
+    assert.eq(null, primary.getDB("test").getLastError());
+    replTest.awaitReplication();
+
+    var s = secondary.getDB("test").oplog_exhaust;
+    assert.eq(n, s.count(), tojson(params));
+    assert.eq(n, s.count({done: true}), tojson(params));
+}
+
+writeAndCheck({replOplogExhaust: true, replOplogCompression: false});
+writeAndCheck({replOplogExhaust: true, replOplogCompression: true});
+writeAndCheck({replOplogExhaust: false, replOplogCompression: true});
+writeAndCheck({replOplogExhaust: false, replOplogCompression: false});
+
+replTest.stopSet();
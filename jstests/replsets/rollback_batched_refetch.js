@@ -0,0 +1,73 @@
+// A rollback touching many documents of several collections refetches them from the sync source
+// in batches, a few collections at once, and ends up with the source's version of each: the
+// documents it updated, inserted and removed, including those it has no batch to itself for.
+
+var replTest = new ReplSetTest({ name: 'rollback_batched_refetch', nodes: 3 });
+var nodes = replTest.nodeList();
+
+var conns = replTest.startSet();
+replTest.initiate({ "_id": "rollback_batched_refetch",
+                    "members": [
+                        { "_id": 0, "host": nodes[0] },
+                        { "_id": 1, "host": nodes[1] },
+                        { "_id": 2, "host": nodes[2], arbiterOnly: true}]
+                  });
+
+var master = replTest.getMaster();
+var a_conn = conns[0];
+var b_conn = conns[1];
+a_conn.setSlaveOk();
+b_conn.setSlaveOk();
+var A = a_conn.getDB("test");
+var B = b_conn.getDB("test");
+var AID = replTest.getNodeId(a_conn);
+var BID = replTest.getNodeId(b_conn);
+assert(master == conns[0], "conns[0] assumed to be master");
+
+var colls = ['c0', 'c1', 'c2', 'c3', 'c4'];
+colls.forEach(function(c) {
+    for (var i = 0; i < 500; i++) {
+        A[c].insert({_id: i, v: 'common'});
+    }
+});
+A.runCommand({getLastError : 1, w : 2, wtimeout : 60000});
+replTest.stop(AID);
+
+// the writes B rolls back
+master = replTest.getMaster();
+assert(b_conn.host == master.host);
+colls.forEach(function(c, n) {
+    for (var i = 0; i < 300; i++) {
+        B[c].update({_id: i}, {$set: {v: 'rolledback'}});
+        B[c].insert({_id: 'b' + i});
+    }
+    B[c].remove({_id: {$gte: 400}});
+});
+B.c4.insert({_id: 'only'});
+B.runCommand({getLastError : 1, w : 1, wtimeout : 60000});
+replTest.stop(BID);
+
+replTest.restart(AID);
+master = replTest.getMaster();
+assert(a_conn.host == master.host);
+for (var i = 0; i < 100; i++) {
+    A.c0.update({_id: i}, {$set: {v: 'kept'}});
+}
+A.runCommand({getLastError : 1, w : 1, wtimeout : 60000});
+
+replTest.restart(BID, {setParameter: 'rollbackRefetchBatchSize=64'}); // should rollback
+reconnect(B);
+
+replTest.awaitReplication();
+replTest.awaitSecondaryNodes();
+
+colls.forEach(function(c) {
+    assert.eq(500, B[c].count(), c);
+    assert.eq(0, B[c].count({v: 'rolledback'}), c);
+    assert.eq(0, B[c].count({_id: /^b/}), c);
+    assert.eq(A[c].find().sort({_id: 1}).toArray(), B[c].find().sort({_id: 1}).toArray(), c);
+});
+assert.eq(100, B.c0.count({v: 'kept'}));
+assert.eq(0, B.c4.count({_id: 'only'}));
+
+replTest.stopSet(15);
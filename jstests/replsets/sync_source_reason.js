@@ -0,0 +1,35 @@
+// replSetGetStatus says why a secondary syncs from the member it does, and a secondary keeps its
+// sync source across reconnects when no other member is clearly better.
+
+var rs = new ReplSetTest({name: 'sync_source_reason', nodes: 3});
+rs.startSet();
+rs.initiate();
+var primary = rs.getMaster();
+primary.getDB('test').foo.insert({x: 1});
+rs.awaitReplication();
+
+rs.getSecondaries().forEach(function(secondary) {
+    var status;
+    assert.soon(function() {
+        status = secondary.getDB('admin').runCommand({replSetGetStatus: 1});
+        return status.syncingTo && status.syncSourceReason;
+    }, "no sync source reason");
+    assert(/^score /.test(status.syncSourceReason), tojson(status));
+});
+
+// a sync source chosen by request says so
+var secondary = rs.getSecondary();
+assert.commandWorked(secondary.getDB('admin').runCommand({replSetSyncFrom: primary.host}));
+primary.getDB('test').foo.insert({x: 2});
+rs.awaitReplication();
+assert.soon(function() {
+    var status = secondary.getDB('admin').runCommand({replSetGetStatus: 1});
+    return status.syncingTo == primary.host && status.syncSourceReason == 'by request';
+}, "sync source by request");
+
+// the penalty for lag and the margin to switch are settable
+assert.commandWorked(secondary.getDB('admin').runCommand({setParameter: 1,
+                                                           syncSourceLagPenaltyMillis: 10,
+                                                           syncSourceChangeMarginPercent: 50}));
+
+rs.stopSet();
@@ -0,0 +1,47 @@
+// serverStatus with defaultSections: false returns just the sections asked for, and with a
+// deltaToken just what has changed since the status last returned for the token.
+
+var admin = db.getSisterDB("admin");
+var t = db.jstests_server_status_delta;
+t.drop();
+
+var res = admin.runCommand({serverStatus: 1, defaultSections: false, opcounters: 1});
+assert.commandWorked(res);
+assert(res.opcounters, tojson(res));
+assert(res.host, tojson(res));
+assert.eq(undefined, res.network);
+assert.eq(undefined, res.metrics);
+assert.eq(undefined, res.deltaToken);
+
+// The first status for a token of 0 is all of it.
+var first = admin.runCommand({serverStatus: 1, defaultSections: false, opcounters: 1,
+                              network: 1, deltaToken: 0});
+assert.commandWorked(first);
+assert(first.deltaToken, tojson(first));
+assert.eq(undefined, first.deltaSince);
+assert(first.opcounters.insert !== undefined, tojson(first));
+
+for (var i = 0; i < 10; i++) {
+    t.insert({i: i});
+}
+assert.eq(null, db.getLastError());
+
+var next = admin.runCommand({serverStatus: 1, defaultSections: false, opcounters: 1,
+                             network: 1, deltaToken: first.deltaToken});
+assert.commandWorked(next);
+assert.eq(first.deltaToken, next.deltaSince, tojson(next));
+assert.neq(first.deltaToken, next.deltaToken);
+// what changed is there, and what didn't isn't
+assert.gte(next.opcounters.insert, first.opcounters.insert + 10, tojson(next));
+assert.eq(undefined, next.host, tojson(next));
+assert.eq(undefined, next.version, tojson(next));
+assert.eq(undefined, next.opcounters.getmore, tojson(next));
+
+// A token is good for one status; after that, all of it comes back.
+var again = admin.runCommand({serverStatus: 1, defaultSections: false, opcounters: 1,
+                              deltaToken: first.deltaToken});
+assert.commandWorked(again);
+assert.eq(undefined, again.deltaSince);
+assert(again.host, tojson(again));
+
+t.drop();
@@ -0,0 +1,42 @@
+// serverStatus({ threadRoles : 1 }) adds up the CPU time and page faults of the server's threads
+// by what they do.
+
+var ss = db.serverStatus();
+assert.isnull( ss.threadRoles, "threadRoles is not included by default" );
+
+var roles = db.serverStatus( { threadRoles : 1 } ).threadRoles;
+assert( roles, tojson( ss ) );
+
+if ( roles.note ) {
+    print( "threadRoles: " + roles.note );
+}
+else {
+    [ "connection", "replWriter", "replPrefetch", "journal", "ttl", "rangeDeleter",
+      "dataFileSync", "other" ].forEach( function( name ) {
+        var role = roles[name];
+        assert( role, name + " " + tojson( roles ) );
+        [ "running", "exited" ].forEach( function( which ) {
+            var u = role[which];
+            [ "threads", "userMicros", "systemMicros", "minorFaults", "majorFaults" ].forEach(
+                function( field ) {
+                    assert.lte( 0, u[field], name + "." + which + "." + field );
+                } );
+        } );
+    } );
+
+    // This connection's thread, at least, is running.
+    assert.lte( 1, roles.connection.running.threads, tojson( roles.connection ) );
+
+    // Connections that come and go are counted when they exit.
+    var before = roles.connection.exited.threads;
+    for ( var i = 0; i < 3; i++ ) {
+        var m = new Mongo( db.getMongo().host );
+        m.getDB( "admin" ).runCommand( { ping : 1 } );
+        m = null;
+        gc();
+    }
+    assert.soon( function() {
+        return db.serverStatus( { threadRoles : 1 } ).threadRoles.connection.exited.threads >
+               before;
+    }, "exited connection threads not counted" );
+}
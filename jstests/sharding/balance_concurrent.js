@@ -0,0 +1,44 @@
+// With _maxConcurrentMigrations set, the balancer moves chunks of different collections at the
+// same time when their shards don't overlap.  Both collections must end up balanced and whole.
+
+var st = new ShardingTest({ shards: 4, mongos: 1, other: { chunksize: 1 }});
+st.stopBalancer();
+
+var admin = st.s.getDB('admin');
+var config = st.s.getDB('config');
+
+admin.runCommand({ enableSharding: 'a' });
+admin.runCommand({ enableSharding: 'b' });
+var primaryA = config.databases.findOne({ _id: 'a' }).primary;
+var primaryB = config.databases.findOne({ _id: 'b' }).primary;
+if (primaryA == primaryB) {
+    var otherShard = config.shards.findOne({ _id: { $ne: primaryA }})._id;
+    assert.commandWorked(admin.runCommand({ movePrimary: 'b', to: otherShard }));
+}
+
+var pad = new Array(1024 * 10).join('x');
+['a.foo', 'b.foo'].forEach(function(ns) {
+    assert.commandWorked(admin.runCommand({ shardCollection: ns, key: { _id: 1 }}));
+    var coll = st.s.getCollection(ns);
+    for (var i = 0; i < 1000; i++) {
+        coll.insert({ _id: i, pad: pad });
+    }
+    assert.eq(null, coll.getDB().getLastError());
+    for (var i = 1; i < 20; i++) {
+        admin.runCommand({ split: ns, middle: { _id: i * 50 }});
+    }
+});
+
+config.settings.update({ _id: 'balancer' }, { $set: { _maxConcurrentMigrations: 2 }}, true);
+assert.eq(null, config.getLastError());
+st.startBalancer();
+
+st.awaitBalance('foo', 'a');
+st.awaitBalance('foo', 'b');
+
+st.stopBalancer();
+assert.eq(1000, st.s.getCollection('a.foo').find().itcount());
+assert.eq(1000, st.s.getCollection('b.foo').find().itcount());
+assert.gt(config.changelog.count({ what: 'moveChunk.commit', ns: 'b.foo' }), 0);
+
+st.stop();
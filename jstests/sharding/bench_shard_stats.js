@@ -0,0 +1,40 @@
+// benchRun with shardStats tells queries that mongos sends to one shard from scatter-gather ones,
+// and reports each shard's latencies.
+
+var s = new ShardingTest( "bench_shard_stats" , 2 , 0 , 1 );
+s.stopBalancer();
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { x : 1 } } );
+s.adminCommand( { split : "test.foo" , middle : { x : 50 } } );
+s.adminCommand( { movechunk : "test.foo" , find : { x : 50 } , to : s.getOther( s.getServer( "test" ) ).name } );
+
+var db = s.getDB( "test" );
+for ( var i = 0; i < 100; i++ )
+    db.foo.insert( { x : i , y : i % 10 } );
+assert.eq( null, db.getLastError() );
+
+function run( ops ) {
+    var res = benchRun( { ops : ops , parallel : 2 , seconds : 1 , shardStats : 2 ,
+                          host : s.s.host } );
+    printjson( res );
+    assert.eq( 0, res.errCount );
+    return res.shardStats;
+}
+
+// On the shard key: one shard each.
+var stats = run( [ { op : "findOne" , ns : "test.foo" , query : { x : 10 } } ] );
+assert.lt( 0, stats.targeted, tojson( stats ) );
+assert.eq( 0, stats.scatter, tojson( stats ) );
+assert.eq( 1, Object.keySet( stats.shardLatencyPercentilesMicros ).length, tojson( stats ) );
+
+// Off it: every shard.
+stats = run( [ { op : "find" , ns : "test.foo" , query : { y : 3 } } ] );
+assert.eq( 0, stats.targeted, tojson( stats ) );
+assert.lt( 0, stats.scatter, tojson( stats ) );
+var shards = stats.shardLatencyPercentilesMicros;
+assert.eq( 2, Object.keySet( shards ).length, tojson( stats ) );
+for ( var shard in shards )
+    assert.eq( stats.scatter, shards[shard].n, tojson( stats ) );
+
+s.stop();
@@ -0,0 +1,54 @@
+// Shards count a sample of the writes to each chunk and report them with getChunkLoad, which the
+// balancer uses when _balanceOnLoad is set.
+
+var st = new ShardingTest({ shards: 2, mongos: 1 });
+st.stopBalancer();
+
+var admin = st.s.getDB('admin');
+var coll = st.s.getCollection('test.foo');
+admin.runCommand({ enableSharding: 'test' });
+admin.runCommand({ shardCollection: 'test.foo', key: { x: 1 }});
+admin.runCommand({ split: 'test.foo', middle: { x: 100 }});
+
+var shard = st.getServer('test');
+assert.commandWorked(shard.adminCommand({ setParameter: 1, chunkLoadSampleRate: 1 }));
+
+for (var i = 0; i < 300; i++) {
+    coll.insert({ x: i % 10 });
+}
+for (var i = 0; i < 50; i++) {
+    coll.insert({ x: 100 + i });
+}
+coll.update({ x: 105 }, { $set: { y: 1 }});
+assert.eq(null, coll.getDB().getLastError());
+
+var res = shard.adminCommand({ getChunkLoad: 'test.foo' });
+assert.commandWorked(res);
+assert.eq(1, res.sampleRate);
+assert.eq(2, res.chunks.length, tojson(res));
+
+var byMin = {};
+res.chunks.forEach(function(c) { byMin[tojson(c.min)] = c; });
+assert.eq(300, byMin[tojson({ x: MinKey })].ops, tojson(res));
+assert.eq(51, byMin[tojson({ x: 100 })].ops, tojson(res));
+assert.gt(byMin[tojson({ x: 100 })].bytes, 0);
+
+// a split starts the counts of the parts over
+admin.runCommand({ split: 'test.foo', middle: { x: 5 }});
+coll.insert({ x: 1 });
+assert.eq(null, coll.getDB().getLastError());
+res = shard.adminCommand({ getChunkLoad: 'test.foo' });
+byMin = {};
+res.chunks.forEach(function(c) { byMin[tojson(c.min)] = c; });
+assert.eq(1, byMin[tojson({ x: MinKey })].ops, tojson(res));
+assert.eq(undefined, byMin[tojson({ x: 5 })], tojson(res));
+
+// the balancer can ask for the loads of every collection it balances
+st.s.getDB('config').settings.update({ _id: 'balancer' }, { $set: { _balanceOnLoad: true }},
+                                     true);
+st.startBalancer();
+sleep(10 * 1000);
+st.stopBalancer();
+assert.eq(351, coll.find().itcount());
+
+st.stop();
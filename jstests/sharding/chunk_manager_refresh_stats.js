@@ -0,0 +1,33 @@
+// mongos counts the times it loads each collection's chunks, and how long that takes, in
+// serverStatus({chunkManagerRefreshes: 1}).  Reloads after splits build on the previous chunks.
+
+var st = new ShardingTest({ shards: 2, mongos: 1 });
+st.stopBalancer();
+
+var admin = st.s.getDB('admin');
+admin.runCommand({ enableSharding: 'test' });
+admin.runCommand({ shardCollection: 'test.foo', key: { x: 1 }});
+
+function stats() {
+    return admin.runCommand({ serverStatus: 1, chunkManagerRefreshes: 1 })
+                .chunkManagerRefreshes['test.foo'];
+}
+
+// not part of the default serverStatus
+assert.eq(undefined, admin.runCommand({ serverStatus: 1 }).chunkManagerRefreshes);
+
+var before = stats();
+assert(before, "no refresh stats for test.foo");
+assert.gte(before.refreshes, 1);
+
+for (var i = 1; i <= 5; i++) {
+    assert.commandWorked(admin.runCommand({ split: 'test.foo', middle: { x: i * 10 }}));
+}
+
+var after = stats();
+assert.gte(after.refreshes, before.refreshes + 5, tojson(after));
+assert.gte(after.incremental, before.incremental + 5, tojson(after));
+assert.eq(6, after.chunks, tojson(after));
+assert.gte(after.totalMillis, after.lastMillis);
+
+st.stop();
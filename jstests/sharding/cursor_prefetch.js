@@ -0,0 +1,48 @@
+// mongos asks the shards for the next batches of a cursor as soon as it has replied to the
+// client.  Clients that read several cursors in turn, or leave them idle, must still see every
+// document once, with shardedCursorPrefetch on or off.
+
+var st = new ShardingTest({ shards: 2, mongos: 1 });
+st.stopBalancer();
+
+var admin = st.s.getDB('admin');
+var coll = st.s.getCollection('test.foo');
+admin.runCommand({ enableSharding: 'test' });
+admin.runCommand({ shardCollection: 'test.foo', key: { _id: 1 }});
+admin.runCommand({ split: 'test.foo', middle: { _id: 5000 }});
+assert.commandWorked(admin.runCommand({ moveChunk: 'test.foo', find: { _id: 5000 },
+                                        to: st.getNonPrimaries('test')[0] }));
+
+var N = 10000;
+var pad = new Array(1000).join('x');
+for (var i = 0; i < N; i++) {
+    coll.insert({ _id: i, pad: pad });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+[true, false].forEach(function(prefetch) {
+    assert.commandWorked(admin.runCommand({ setParameter: 1, shardedCursorPrefetch: prefetch }));
+
+    var cursors = [coll.find().batchSize(50),
+                   coll.find().sort({ _id: 1 }).batchSize(50),
+                   coll.find().sort({ _id: -1 })];
+    var seen = [{}, {}, {}];
+    var counts = [0, 0, 0];
+    var open = cursors.length;
+    while (open > 0) {
+        open = 0;
+        for (var c = 0; c < cursors.length; c++) {
+            for (var j = 0; j < 75 && cursors[c].hasNext(); j++) {
+                var id = cursors[c].next()._id;
+                assert(!seen[c][id], "document " + id + " twice, prefetch " + prefetch);
+                seen[c][id] = true;
+                counts[c]++;
+            }
+            if (cursors[c].hasNext())
+                open++;
+        }
+    }
+    assert.eq([N, N, N], counts, "prefetch " + prefetch);
+});
+
+st.stop();
@@ -0,0 +1,17 @@
+// Hashed shard keys are hashed with md5 by mongos and the shards, so a collection can't be
+// sharded on a hashed index of another hashVersion.
+
+var st = new ShardingTest({shards: 1});
+var testDB = st.s.getDB('test');
+assert.commandWorked(testDB.adminCommand({enableSharding: 'test'}));
+
+testDB.murmur.ensureIndex({x: 'hashed'}, {hashVersion: 1});
+assert.eq(null, testDB.getLastError());
+testDB.murmur.insert({x: 1});
+assert.commandFailed(testDB.adminCommand({shardCollection: 'test.murmur', key: {x: 'hashed'}}));
+
+testDB.md5.ensureIndex({x: 'hashed'});
+testDB.md5.insert({x: 1});
+assert.commandWorked(testDB.adminCommand({shardCollection: 'test.md5', key: {x: 'hashed'}}));
+
+st.stop();
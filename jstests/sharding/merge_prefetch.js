@@ -0,0 +1,53 @@
+// mongos sends the getMores of the shard cursors it merges ahead of need.  Sorted and unsorted
+// results across shards come back complete and in order, whatever the batch sizes and limits,
+// and cursors left open half way leave their connections usable.
+
+var st = new ShardingTest({ shards: 3, mongos: 1 });
+st.stopBalancer();
+
+var admin = st.s.getDB('admin');
+var coll = st.s.getCollection('test.foo');
+admin.runCommand({ enableSharding: 'test' });
+admin.runCommand({ shardCollection: 'test.foo', key: { _id: 1 }});
+admin.runCommand({ split: 'test.foo', middle: { _id: 1000 }});
+admin.runCommand({ split: 'test.foo', middle: { _id: 2000 }});
+var others = st.getNonPrimaries('test');
+assert.commandWorked(admin.runCommand({ moveChunk: 'test.foo', find: { _id: 1000 },
+                                        to: others[0] }));
+assert.commandWorked(admin.runCommand({ moveChunk: 'test.foo', find: { _id: 2000 },
+                                        to: others[1] }));
+
+var N = 3000;
+for (var i = 0; i < N; i++) {
+    coll.insert({ _id: i, x: (i * 7) % N });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+[2, 5, 101, 0].forEach(function(batchSize) {
+    var last = -1;
+    var n = 0;
+    var c = coll.find().sort({ x: 1 }).batchSize(batchSize);
+    while (c.hasNext()) {
+        var x = c.next().x;
+        assert.gt(x, last, "batchSize " + batchSize);
+        last = x;
+        n++;
+    }
+    assert.eq(N, n, "batchSize " + batchSize);
+
+    assert.eq(N, coll.find().batchSize(batchSize).itcount(), "unsorted batchSize " + batchSize);
+    assert.eq(250, coll.find().sort({ x: -1 }).batchSize(batchSize).limit(250).itcount());
+});
+
+// leave cursors with getMores in flight and go on using mongos
+for (var i = 0; i < 20; i++) {
+    var c = coll.find().sort({ x: 1 }).batchSize(3);
+    for (var j = 0; j < 10; j++) {
+        c.next();
+    }
+    c.close();
+    assert.eq(N, coll.count());
+}
+assert.eq(N, coll.find({ x: { $gte: 0 }}).sort({ x: 1 }).itcount());
+
+st.stop();
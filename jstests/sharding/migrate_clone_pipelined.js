@@ -0,0 +1,41 @@
+// The recipient of a migration asks the donor for the next batch of documents while it inserts
+// the current one, and inserts them in groups.  Chunks of several full batches must arrive
+// whole, with their indexes.
+
+var st = new ShardingTest({ shards: 2, mongos: 1 });
+st.stopBalancer();
+
+var admin = st.s.getDB('admin');
+var coll = st.s.getCollection('test.foo');
+admin.runCommand({ enableSharding: 'test' });
+admin.runCommand({ shardCollection: 'test.foo', key: { _id: 1 }});
+coll.ensureIndex({ a: 1 });
+
+var N = 40000;
+var pad = new Array(500).join('x');
+for (var i = 0; i < N; i++) {
+    coll.insert({ _id: i, a: i % 100, pad: pad });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+var primary = st.config.databases.findOne({ _id: 'test' }).primary;
+var other = st.getNonPrimaries('test')[0];
+var primaryColl = st.getServer('test').getCollection('test.foo');
+var otherColl = st.getOther(st.getServer('test')).getCollection('test.foo');
+
+assert.commandWorked(admin.runCommand({ moveChunk: 'test.foo', find: { _id: 0 }, to: other,
+                                        _waitForDelete: true }));
+assert.eq(N, otherColl.count());
+assert.eq(N / 100, otherColl.find({ a: 7 }).hint({ a: 1 }).itcount());
+assert.eq(N, coll.find().itcount());
+
+// and half of it back again
+assert.commandWorked(admin.runCommand({ split: 'test.foo', middle: { _id: N / 2 }}));
+assert.commandWorked(admin.runCommand({ moveChunk: 'test.foo', find: { _id: N - 1 }, to: primary,
+                                        _waitForDelete: true }));
+assert.eq(N / 2, primaryColl.count());
+assert.eq(N / 2, otherColl.count());
+assert.eq(N / 200, primaryColl.find({ a: 7 }).hint({ a: 1 }).itcount());
+assert.eq(N, coll.find().itcount());
+
+st.stop();
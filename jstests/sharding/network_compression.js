@@ -0,0 +1,48 @@
+// With networkMessageCompression set, mongos asks its shards in isMaster to compress the
+// messages between them, and so can any client.  Results come back the same.
+
+var st = new ShardingTest({ shards : 1, mongos : 1,
+                            other : { shardOptions : { setParameter : 'networkMessageCompression=true' },
+                                      mongosOptions : { setParameter : 'networkMessageCompression=true' } } });
+
+function compression(conn) {
+    return conn.getDB('admin').serverStatus().network.compression;
+}
+
+var coll = st.s0.getCollection('test.network_compression');
+var filler = new Array(10000).join('x');
+for (var i = 0; i < 100; i++) {
+    coll.insert({ _id : i, filler : filler });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+var before = compression(st.shard0);
+var docs = coll.find().sort({ _id : 1 }).toArray();
+assert.eq(100, docs.length);
+for (var i = 0; i < 100; i++) {
+    assert.eq(i, docs[i]._id);
+    assert.eq(filler, docs[i].filler);
+}
+
+// The shard sent the results compressed
+var after = compression(st.shard0);
+assert.gt(after.uncompressedBytesOut - before.uncompressedBytesOut, 100 * filler.length);
+assert.lt(after.compressedBytesOut - before.compressedBytesOut,
+          after.uncompressedBytesOut - before.uncompressedBytesOut);
+
+// A client asking for it
+var conn = new Mongo(st.s0.host);
+var res = conn.getDB('admin').runCommand({ isMaster : 1, compression : [ 'zlib', 'snappy' ] });
+assert.eq([ 'snappy' ], res.compression, tojson(res));
+before = compression(st.s0);
+assert.eq(100, conn.getCollection(coll + '').find().itcount());
+after = compression(st.s0);
+assert.gt(after.compressedBytesOut, before.compressedBytesOut);
+
+// Not offered when off
+var mongod = MongoRunner.runMongod({});
+res = mongod.getDB('admin').runCommand({ isMaster : 1, compression : [ 'snappy' ] });
+assert.eq(undefined, res.compression);
+MongoRunner.stopMongod(mongod.port);
+
+st.stop();
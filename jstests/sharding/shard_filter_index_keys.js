@@ -0,0 +1,48 @@
+//
+// Orphaned documents are filtered on the shard key held in an index's keys, before they are
+// fetched, and covered queries on the shard key stay covered.
+//
+
+var st = new ShardingTest({ shards : 2, mongos : 1, other : { separateConfig : true } });
+st.stopBalancer();
+
+var mongos = st.s0;
+var admin = mongos.getDB( "admin" );
+var shards = mongos.getCollection( "config.shards" ).find().toArray();
+var coll = mongos.getCollection( "foo.bar" );
+
+assert( admin.runCommand({ enableSharding : coll.getDB() + "" }).ok );
+printjson( admin.runCommand({ movePrimary : coll.getDB() + "", to : shards[0]._id }) );
+assert( admin.runCommand({ shardCollection : coll + "", key : { a : 1 } }).ok );
+assert( admin.runCommand({ split : coll + "", middle : { a : 50 } }).ok );
+assert( admin.runCommand({ moveChunk : coll + "",
+                           find : { a : 50 },
+                           to : shards[1]._id,
+                           _waitForDelete : true }).ok );
+
+for ( var i = 0; i < 100; i++ ) coll.insert({ a : i, b : i });
+assert.eq( null, coll.getDB().getLastError() );
+
+// Orphans on the first shard in the range the second one owns
+var shard0Coll = st.shard0.getCollection( coll + "" );
+for ( var i = 50; i < 100; i++ ) shard0Coll.insert({ a : i, b : -1 });
+assert.eq( null, shard0Coll.getDB().getLastError() );
+assert.eq( 100, shard0Coll.count() );
+
+assert.eq( 100, coll.find({ a : { $gte : 0 } }).itcount() );
+assert.eq( 0, coll.find({ a : { $gte : 0 }, b : -1 }).itcount() );
+
+// Covered by the shard key index, with the orphans dropped before anything is fetched
+var covered = coll.find({ a : { $gte : 0 } }, { _id : 0, a : 1 }).sort({ a : 1 }).toArray();
+assert.eq( 100, covered.length );
+for ( var i = 0; i < 100; i++ ) assert.eq({ a : i }, covered[i]);
+
+var explain = coll.find({ a : { $gte : 0 } }).hint({ a : 1 }).explain();
+printjson( explain );
+for ( var host in explain.shards ) {
+    var shardExplain = explain.shards[host][0];
+    assert.eq( 50, shardExplain.n, tojson( shardExplain ) );
+    assert.eq( 50, shardExplain.nscannedObjects, tojson( shardExplain ) );
+}
+
+st.stop();
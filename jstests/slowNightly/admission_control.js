@@ -0,0 +1,61 @@
+// maxConcurrentReads and maxConcurrentWrites limit the reads and writes running at once.  The
+// rest queue for a ticket, and serverStatus reports how many did and for how long.
+
+var mongod = MongoRunner.runMongod({setParameter: 'maxConcurrentReads=2'});
+var db = mongod.getDB('test');
+var admin = mongod.getDB('admin');
+
+function admission() {
+    return admin.serverStatus().admission;
+}
+
+assert.eq(2, admission().reads.out);
+assert.eq(0, admission().writes.out);
+
+db.admission_control.insert({});
+assert.eq(null, db.getLastError());
+
+var shells = [];
+for (var i = 0; i < 4; i++) {
+    shells.push(startParallelShell(
+        'db.getSiblingDB("test").admission_control.find(' +
+        '    function() { sleep(2000); return true; }).itcount();', mongod.port));
+}
+
+// Two run while the others wait, and commands aren't held up.
+assert.soon(function() {
+    var reads = admission().reads;
+    return reads.used == 2 && reads.waiting.normal == 2;
+}, 'slow reads not queued', 30000);
+
+shells.forEach(function(join) { join(); });
+
+var reads = admission().reads;
+assert.eq(0, reads.used);
+assert.gte(reads.queued, 2);
+assert.gt(reads.totalQueuedMicros, 0);
+
+// Resized at runtime
+assert.commandWorked(admin.runCommand({setParameter: 1, maxConcurrentWrites: 1}));
+assert.eq(1, admission().writes.out);
+assert.commandFailed(admin.runCommand({setParameter: 1, maxConcurrentWrites: -1}));
+
+shells = [];
+for (var i = 0; i < 4; i++) {
+    shells.push(startParallelShell(
+        'var coll = db.getSiblingDB("test").admission_control_writes;' +
+        'for (var j = 0; j < 100; j++) { coll.insert({}); }' +
+        'assert.eq(null, coll.getDB().getLastError());', mongod.port));
+}
+shells.forEach(function(join) { join(); });
+
+assert.eq(400, db.admission_control_writes.count());
+var writes = admission().writes;
+assert.eq(0, writes.used);
+assert.gte(writes.admitted, 400);
+
+// Back to unlimited
+assert.commandWorked(admin.runCommand({setParameter: 1, maxConcurrentReads: 0}));
+assert.eq(1, db.admission_control.find().itcount());
+
+MongoRunner.stopMongod(mongod.port);
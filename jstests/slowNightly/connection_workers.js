@@ -0,0 +1,60 @@
+// With connectionWorkerThreads set, connections are served from a pool of worker threads.  Each
+// connection keeps its own state between messages, and slow operations don't hold up the others.
+
+function checkConnections(host) {
+    var conns = [];
+    for (var i = 0; i < 50; i++) {
+        conns.push(new Mongo(host));
+    }
+
+    // Every other connection gets a duplicate key error, and sees only its own last error.
+    for (var i = 0; i < conns.length; i++) {
+        var coll = conns[i].getDB('test').connection_workers;
+        coll.insert({_id: Math.floor(i / 2)});
+    }
+    for (var i = conns.length - 1; i >= 0; i--) {
+        var err = conns[i].getDB('test').getLastError();
+        if (i % 2 == 0) {
+            assert.eq(null, err, 'connection ' + i);
+        }
+        else {
+            assert.neq(null, err, 'connection ' + i);
+        }
+    }
+    assert.eq(conns.length / 2, conns[0].getDB('test').connection_workers.count());
+
+    assert.gte(conns[0].getDB('admin').serverStatus().connections.current, conns.length);
+    return conns;
+}
+
+function checkSlowOps(conn, port) {
+    var db = conn.getDB('test');
+    db.connection_workers_slow.insert({});
+    assert.eq(null, db.getLastError());
+
+    // More slow queries than there are workers
+    var shells = [];
+    for (var i = 0; i < 4; i++) {
+        shells.push(startParallelShell(
+            'db.getSiblingDB("test").connection_workers_slow.find(' +
+            '    function() { sleep(3000); return true; }).itcount();', port));
+    }
+    sleep(500);
+
+    var start = new Date();
+    assert.eq(1, db.connection_workers_slow.find().itcount());
+    assert.lt(new Date() - start, 2000);
+
+    shells.forEach(function(join) { join(); });
+}
+
+var mongod = MongoRunner.runMongod({setParameter: 'connectionWorkerThreads=2'});
+checkConnections(mongod.host);
+checkSlowOps(mongod, mongod.port);
+MongoRunner.stopMongod(mongod.port);
+
+var st = new ShardingTest({shards: 1, mongos: 1,
+                           other: {mongosOptions: {setParameter: 'connectionWorkerThreads=2'}}});
+checkConnections(st.s0.host);
+checkSlowOps(st.s0, st.s0.port);
+st.stop();
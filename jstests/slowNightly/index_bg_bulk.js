@@ -0,0 +1,65 @@
+// A background index build sorts the keys it scans and builds the tree bottom up, then redoes
+// the keys of the documents written while it ran.  The index must match the collection.
+
+var t = db.index_bg_bulk;
+t.drop();
+
+var N = 100000;
+for (var i = 0; i < N; i++) {
+    t.insert({_id: i, a: i % 1000, pad: ''});
+}
+assert.eq(null, db.getLastError());
+
+assert.commandWorked(db.adminCommand({setParameter: 1, backgroundIndexBuildUsesBulkPath: true}));
+
+// inserts, updates in place and moving, and removes while the index builds
+var writes = startParallelShell(
+    "var t = db.index_bg_bulk;" +
+    "for (var i = 0; i < 20000; i++) {" +
+    "    t.insert({_id: " + N + " + i, a: i % 500});" +
+    "    t.update({_id: i * 3}, {$set: {a: -1}});" +
+    "    t.update({_id: i * 3 + 1}, {$set: {pad: new Array(200).join('x')}});" +
+    "    t.remove({_id: i * 3 + 2});" +
+    "}" +
+    "db.getLastError();");
+
+t.ensureIndex({a: 1}, {background: true});
+assert.eq(null, db.getLastError());
+writes();
+
+var res = t.validate(true);
+assert(res.valid, tojson(res));
+
+function check(query) {
+    assert.eq(t.find(query).hint({$natural: 1}).itcount(), t.find(query).hint({a: 1}).itcount(),
+              tojson(query));
+}
+check({});
+check({a: -1});
+check({a: {$gte: 0, $lt: 500}});
+check({a: {$gte: 500}});
+assert.eq(t.count(), t.find().hint({a: 1}).itcount());
+
+// the same for a unique index with writes that do not conflict
+t.drop();
+for (var i = 0; i < N; i++) {
+    t.insert({_id: i, u: i});
+}
+writes = startParallelShell(
+    "var t = db.index_bg_bulk;" +
+    "for (var i = 0; i < 20000; i++) {" +
+    "    t.insert({_id: " + N + " + i, u: " + N + " + i});" +
+    "    t.update({_id: i * 2}, {$set: {u: -1 - i}});" +
+    "    t.remove({_id: i * 2 + 1});" +
+    "}" +
+    "db.getLastError();");
+t.ensureIndex({u: 1}, {background: true, unique: true});
+assert.eq(null, db.getLastError());
+writes();
+
+res = t.validate(true);
+assert(res.valid, tojson(res));
+assert.eq(t.count(), t.find().hint({u: 1}).itcount());
+assert.eq(20000, t.find({u: {$lt: 0}}).hint({u: 1}).itcount());
+
+t.drop();
@@ -0,0 +1,28 @@
+// With logBufferBytes set, a background thread writes the log file.
+
+var name = "logpath_buffered";
+var dbdir = MongoRunner.dataPath + name + "/";
+var logdir = MongoRunner.dataPath + name + "files/";
+var logfile = logdir + name + ".log";
+
+assert(mkdir(logdir));
+removeFile(logfile);
+
+var port = allocatePorts(1)[0];
+var m = MongoRunner.runMongod({ port: port, dbpath: dbdir, logpath: logfile,
+                                setParameter: "logBufferBytes=65536" });
+var db = m.getDB("test");
+
+// A slow query is logged, and gets to the file.
+db.foo.insert({ x: 1 });
+assert.eq(1, db.foo.find({ $where: "sleep(200); return true;" }).itcount());
+assert.soon(function() { return cat(logfile).indexOf("test.foo") != -1; },
+            "slow query not written to " + logfile);
+
+assert.eq(0, db.serverStatus().metrics.log.droppedLines);
+
+// Rotation still works.
+assert.commandWorked(db.adminCommand({ logRotate: 1 }));
+db.adminCommand({ ping: 1 });
+
+stopMongod(port);
@@ -0,0 +1,73 @@
+// With mapReduceMapThreads set, the map phase runs on several threads, each with its own scope.
+// The results are the same as a mapReduce mapping on one thread, in JS and mixed mode, inline and
+// to a collection.
+
+var mongod = MongoRunner.runMongod({setParameter: 'mapReduceMapThreads=4'});
+var db = mongod.getDB('test');
+var t = db.mr_parallel_map;
+
+for (var i = 0; i < 20000; i++) {
+    t.insert({_id: i, key: i % 997, tags: ['a', 'b', 'c'].slice(0, i % 4), n: i});
+}
+assert.eq(null, db.getLastError());
+
+function map() {
+    emit(this.key, {count: 1, total: this.n});
+    this.tags.forEach(function(tag) { emit(tag, {count: 1, total: 0}); });
+}
+function reduce(key, values) {
+    var out = {count: 0, total: 0};
+    values.forEach(function(v) { out.count += v.count; out.total += v.total; });
+    return out;
+}
+
+function expected() {
+    var results = {};
+    t.find().forEach(function(doc) {
+        var add = function(key, total) {
+            var r = results[key] || (results[key] = {count: 0, total: 0});
+            r.count++;
+            r.total += total;
+        };
+        add(doc.key, doc.n);
+        doc.tags.forEach(function(tag) { add(tag, 0); });
+    });
+    return results;
+}
+
+function check(res) {
+    assert(res.ok, tojson(res));
+    assert.eq(20000, res.counts.input);
+    assert.eq(20000 + 30000, res.counts.emit);
+    assert.eq(997 + 3, res.counts.output);
+}
+
+var want = expected();
+[false, true].forEach(function(jsMode) {
+    var res = t.mapReduce(map, reduce, {out: {inline: 1}, jsMode: jsMode});
+    check(res);
+    res.results.forEach(function(r) { assert.eq(want[r._id], r.value, tojson(r)); });
+
+    res = t.mapReduce(map, reduce, {out: 'mr_parallel_map_out', jsMode: jsMode});
+    check(res);
+    db.mr_parallel_map_out.find().forEach(function(r) {
+        assert.eq(want[r._id], r.value, tojson(r));
+    });
+});
+
+// A limit and a query are applied before the documents are handed out
+var res = t.mapReduce(map, reduce, {out: {inline: 1}, query: {n: {$lt: 1000}}, sort: {n: 1},
+                                    limit: 500});
+assert.eq(500, res.counts.input);
+
+// An error in a map function fails the command
+res = db.runCommand({mapReduce: t.getName(), out: {inline: 1}, reduce: reduce,
+                     map: function() { if (this.n == 12345) throw 'bad doc'; emit(1, 1); }});
+assert(!res.ok, tojson(res));
+
+// Map functions running on the threads can't use the database
+res = db.runCommand({mapReduce: t.getName(), out: {inline: 1}, reduce: reduce,
+                     map: function() { db.mr_parallel_map.findOne(); emit(1, 1); }});
+assert(!res.ok, tojson(res));
+
+MongoRunner.stopMongod(mongod.port);
@@ -0,0 +1,52 @@
+// The TTL monitor deletes expired documents in batches of ttlDeleteBatchSize, oldest first, at no
+// more than ttlDeletesPerSecond, and reports each index's last pass in serverStatus.
+
+var admin = db.getSiblingDB("admin");
+assert.commandWorked(admin.runCommand({setParameter: 1, ttlDeleteBatchSize: 10,
+                                       ttlDeletesPerSecond: 100}));
+
+var now = (new Date()).getTime();
+
+var t = db.ttl_batched;
+t.drop();
+for (var i = 0; i < 500; i++) {
+    t.insert({x: new Date(now - 3600 * 1000 - i)});
+}
+for (var i = 0; i < 20; i++) {
+    t.insert({x: new Date(now + 3600 * 1000)});
+}
+t.insert({x: true});
+t.insert({x: 3});
+
+// A descending index expires the oldest documents just the same.
+var d = db.ttl_batched_desc;
+d.drop();
+for (var i = 0; i < 50; i++) {
+    d.insert({y: [new Date(now - 3600 * 1000), new Date(now - 7200 * 1000)]});
+}
+d.insert({y: new Date(now + 3600 * 1000)});
+assert.eq(null, db.getLastError());
+
+t.ensureIndex({x: 1}, {expireAfterSeconds: 60});
+d.ensureIndex({y: -1}, {expireAfterSeconds: 60});
+
+assert.soon(function() { return t.count() == 22; }, "TTL index on x didn't delete", 180 * 1000);
+assert.soon(function() { return d.count() == 1; }, "TTL index on y didn't delete", 70 * 1000);
+assert.eq(1, t.find({x: true}).count());
+assert.eq(1, t.find({x: 3}).count());
+
+var stats;
+assert.soon(function() {
+    stats = db.serverStatus({ttlIndexes: 1}).ttlIndexes;
+    return stats[t.getFullName() + ".$x_1"] && stats[d.getFullName() + ".$y_-1"];
+});
+printjson(stats);
+var xStats = stats[t.getFullName() + ".$x_1"];
+assert.lte(500, xStats.deletedTotal);
+// 500 deletes at 100 a second
+assert.gte(xStats.passMillis, 4000, tojson(xStats));
+assert.lte(xStats.deletesPerSec, 110, tojson(xStats));
+assert.gte(xStats.lagSecs, 3600 - 60, tojson(xStats));
+
+assert.commandWorked(admin.runCommand({setParameter: 1, ttlDeleteBatchSize: 1000,
+                                       ttlDeletesPerSecond: 0}));
@@ -0,0 +1,32 @@
+// An in-memory sort of more than 32MB fails, unless the query allows it to spill to disk.
+
+var t = db.jstests_sort_allow_disk_use;
+t.drop();
+
+var pad = new Array(100 * 1024).join('x');
+for (var i = 0; i < 400; i++) {
+    t.insert({a: (i * 7) % 400, pad: pad});
+}
+assert.eq(null, db.getLastError());
+
+// No index on 'a', so the sort is done in memory.
+assert.throws(function() {
+    t.find({}, {a: 1, pad: 1}).sort({a: 1}).itcount();
+});
+
+var cursor = t.find({}, {a: 1, pad: 1}).sort({a: 1})._addSpecial("$allowDiskUse", true);
+var expected = 0;
+while (cursor.hasNext()) {
+    assert.eq(expected, cursor.next().a);
+    expected++;
+}
+assert.eq(400, expected);
+
+// Descending, with a limit.
+var res = t.find({}, {a: 1, pad: 1}).sort({a: -1}).limit(5)._addSpecial("$allowDiskUse", true)
+           .toArray();
+assert.eq(5, res.length);
+assert.eq(399, res[0].a);
+assert.eq(395, res[4].a);
+
+t.drop();
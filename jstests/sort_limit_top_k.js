@@ -0,0 +1,31 @@
+// A blocking sort with a limit only keeps skip + limit results, so it doesn't run into the
+// sort stage's 32MB cap however many documents match.
+
+var t = db.jstests_sort_limit_top_k;
+t.drop();
+
+var pad = new Array(100 * 1024).join('x');
+for (var i = 0; i < 400; i++) {
+    t.insert({a: (i * 7) % 400, pad: pad});
+}
+assert.eq(null, db.getLastError());
+
+// No index on 'a', so the sort is done in memory.
+var res = t.find({}, {a: 1, pad: 1}).sort({a: -1}).limit(20).toArray();
+assert.eq(20, res.length);
+for (var i = 0; i < res.length; i++) {
+    assert.eq(399 - i, res[i].a);
+}
+
+res = t.find({}, {a: 1, pad: 1}).sort({a: 1}).skip(10).limit(5).toArray();
+assert.eq(5, res.length);
+for (var i = 0; i < res.length; i++) {
+    assert.eq(10 + i, res[i].a);
+}
+
+// A negative limit is a single batch and is also bounded.
+res = t.find({}, {a: 1, pad: 1}).sort({a: 1}).limit(-3).toArray();
+assert.eq(3, res.length);
+assert.eq(0, res[0].a);
+
+t.drop();
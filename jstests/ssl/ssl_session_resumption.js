@@ -0,0 +1,30 @@
+// Connections from the same client resume its earlier SSL session instead of doing a full
+// handshake, and serverStatus counts the handshakes of each kind.
+
+var port = allocatePorts(1)[0];
+var baseName = "jstests_ssl_ssl_session_resumption";
+
+var md = startMongod("--port", port, "--dbpath", MongoRunner.dataPath + baseName,
+                     "--sslMode", "requireSSL",
+                     "--sslPEMKeyFile", "jstests/libs/server.pem",
+                     "--sslCAFile", "jstests/libs/ca.pem");
+
+var check = 'var host = db.getMongo().host;' +
+            'for (var i = 0; i < 5; i++) {' +
+            '    assert.eq(1, new Mongo(host).getDB("admin").runCommand({ping: 1}).ok);' +
+            '}' +
+            'var accepted = db.serverStatus().network.ssl.accepted;' +
+            'printjson(accepted);' +
+            'assert.gte(accepted.handshakes, 6);' +
+            'assert.gte(accepted.resumed, 5);' +
+            'assert.gt(accepted.handshakes, accepted.resumed);' +
+            'assert.gt(accepted.totalMicros, 0);';
+
+var mongo = runMongoProgram("mongo", "--port", port, "--ssl",
+                            "--sslPEMKeyFile", "jstests/libs/client.pem",
+                            "--eval", check);
+
+// 0 is the exit code for success
+assert(mongo == 0);
+
+stopMongod(port);
@@ -0,0 +1,24 @@
+// A tailable cursor awaiting data on a capped collection returns a document inserted while the
+// getMore is waiting.
+
+t = db.jstests_tailable_await_data;
+t.drop();
+db.createCollection( t.getName(), { capped:true, size:100000 } );
+
+t.insert( { _id:0 } );
+db.getLastError();
+
+var cursor = t.find().addOption( DBQuery.Option.tailable ).addOption( DBQuery.Option.awaitData );
+assert.eq( 0, cursor.next()._id );
+
+s = startParallelShell( 'sleep( 500 ); db.jstests_tailable_await_data.insert( { _id:1 } );' +
+                        'db.getLastError();' );
+
+// the getMore waits for the insert instead of returning empty
+var start = new Date();
+assert.soon( function() { return cursor.hasNext(); } );
+assert.eq( 1, cursor.next()._id );
+assert.lt( new Date() - start, 10000 );
+
+s();
+t.drop();
@@ -0,0 +1,62 @@
+// dumprestore_parallel.js
+// mongodump with --numParallelCollections dumps several collections at once, and with
+// --numCursorsPerCollection reads each collection through several cursors.  mongorestore with
+// --numParallelCollections restores several collections at once.
+
+t = new ToolTest( "dumprestore_parallel" );
+
+c = t.startDB( "foo" );
+var db = c.getDB();
+var names = [ "a", "b", "c", "d", "e" ];
+names.forEach( function( name ) {
+    for ( var i = 0; i < 2000; i++ ) {
+        db[name].insert( { _id : i, name : name, pad : new Array( 200 ).join( "x" ) } );
+    }
+    db[name].ensureIndex( { name : 1, _id : -1 } );
+} );
+db.createCollection( "capped", { capped : true, size : 100000 } );
+for ( var i = 0; i < 100; i++ ) {
+    db.capped.insert( { i : i } );
+}
+assert.eq( null, db.getLastError() );
+
+function check( msg ) {
+    names.forEach( function( name ) {
+        assert.eq( 2000, db[name].count(), msg + " " + name );
+        assert.eq( 2000, db[name].find().sort( { _id : 1 } ).itcount(), msg + " " + name );
+        assert.eq( 2, db[name].getIndexes().length, msg + " " + name );
+    } );
+    assert.eq( 100, db.capped.count(), msg + " capped" );
+    assert( db.capped.isCapped(), msg + " capped" );
+}
+
+function dumpAndRestore( msg ) {
+    var args = [ "dump", "--out", t.ext ].concat( Array.prototype.slice.call( arguments, 1 ) );
+    assert.eq( 0, t.runTool.apply( t, args ), msg );
+    db.dropDatabase();
+    assert.eq( 0, t.runTool( "restore", "--dir", t.ext ), msg );
+    check( msg );
+    resetDbpath( t.ext );
+}
+
+check( "setup" );
+dumpAndRestore( "collections", "--numParallelCollections", "3" );
+dumpAndRestore( "cursors", "--forceTableScan", "--numCursorsPerCollection", "4" );
+dumpAndRestore( "both", "-j", "4", "--forceTableScan", "--numCursorsPerCollection", "3" );
+
+// restoring several collections at once, onto some of the documents already there
+assert.eq( 0, t.runTool( "dump", "--out", t.ext ) );
+db.a.remove( { _id : { $gte : 1000 } } );
+db.b.drop();
+assert.eq( 0, t.runTool( "restore", "--dir", t.ext, "--numParallelCollections", "3" ) );
+check( "parallel restore" );
+db.dropDatabase();
+assert.eq( 0, t.runTool( "restore", "--dir", t.ext, "-j", "10", "--drop" ) );
+check( "parallel restore with drop" );
+resetDbpath( t.ext );
+
+// splitting collections needs a table scan, without a query
+assert.neq( 0, t.runTool( "dump", "--out", t.ext, "--numCursorsPerCollection", "2" ) );
+assert.neq( 0, t.runTool( "dump", "--out", t.ext, "--numParallelCollections", "0" ) );
+
+t.stop();
@@ -0,0 +1,44 @@
+// export_parallel.js
+// mongoexport with --numCursors reads the collection through several cursors at once, and
+// writes every document once, in some order.
+
+t = new ToolTest( "export_parallel" );
+
+c = t.startDB( "foo" );
+for ( var i = 0; i < 20000; i++ ) {
+    c.insert( { _id : i, a : i % 7, s : "doc " + i } );
+}
+assert.eq( null, c.getDB().getLastError() );
+
+function check( msg ) {
+    assert.eq( 20000, c.count(), msg );
+    assert.eq( 20000, c.find().sort( { _id : 1 } ).itcount(), msg );
+    assert.eq( 2857, c.find( { a : 3 } ).itcount(), msg );
+    assert.eq( "doc 12345", c.findOne( { _id : 12345 } ).s, msg );
+}
+
+[ [], [ "--jsonArray" ] ].forEach( function( opts ) {
+    var args = [ "export", "--out", t.extFile, "-d", t.baseName, "-c", "foo",
+                 "--numCursors", "4", "--forceTableScan" ].concat( opts );
+    assert.eq( 0, t.runTool.apply( t, args ), tojson( opts ) );
+    c.drop();
+    args = [ "import", "--file", t.extFile, "-d", t.baseName, "-c", "foo" ].concat( opts );
+    assert.eq( 0, t.runTool.apply( t, args ), tojson( opts ) );
+    check( tojson( opts ) );
+} );
+
+// CSV, with a field list.
+assert.eq( 0, t.runTool( "export", "--out", t.extFile, "-d", t.baseName, "-c", "foo", "--csv",
+                         "-f", "_id,a,s", "--numCursors", "3", "--forceTableScan" ) );
+c.drop();
+assert.eq( 0, t.runTool( "import", "--file", t.extFile, "-d", t.baseName, "-c", "foo",
+                         "--type", "csv", "--headerline" ) );
+check( "csv" );
+
+// Several cursors can't honor a query, or a snapshot.
+assert.neq( 0, t.runTool( "export", "--out", t.extFile, "-d", t.baseName, "-c", "foo",
+                          "--numCursors", "4" ) );
+assert.neq( 0, t.runTool( "export", "--out", t.extFile, "-d", t.baseName, "-c", "foo",
+                          "--numCursors", "4", "--forceTableScan", "-q", "{a: 1}" ) );
+
+t.stop();
@@ -0,0 +1,65 @@
+// exportimport_parallel.js
+// mongoimport with --numParsingThreads parses the input on several threads, and with
+// --numInsertionWorkers inserts it over several connections.
+
+t = new ToolTest( "exportimport_parallel" );
+
+c = t.startDB( "foo" );
+for ( var i = 0; i < 5000; i++ ) {
+    c.insert( { _id : i, a : i % 7, s : "line " + i } );
+}
+assert.eq( null, c.getDB().getLastError() );
+
+t.runTool( "export", "--out", t.extFile, "-d", t.baseName, "-c", "foo" );
+
+function check( msg ) {
+    assert.eq( 5000, c.count(), msg );
+    assert.eq( 714, c.find( { a : 3 } ).itcount(), msg );
+    assert.eq( "line 4321", c.findOne( { _id : 4321 } ).s, msg );
+}
+
+[ [ "--numParsingThreads", "4" ],
+  [ "--numInsertionWorkers", "4" ],
+  [ "--numParsingThreads", "3", "--numInsertionWorkers", "3" ] ].forEach( function( opts ) {
+    c.drop();
+    var args = [ "import", "--file", t.extFile, "-d", t.baseName, "-c", "foo" ].concat( opts );
+    assert.eq( 0, t.runTool.apply( t, args ), tojson( opts ) );
+    check( tojson( opts ) );
+} );
+
+// Duplicates aren't errors, and don't stop the rest of the input going in.
+c.remove( { _id : { $gte : 2500 } } );
+assert.eq( 0, t.runTool( "import", "--file", t.extFile, "-d", t.baseName, "-c", "foo",
+                         "--numParsingThreads", "2", "--numInsertionWorkers", "2" ) );
+check( "duplicates" );
+
+// Upserts with several threads.
+c.update( {}, { $set : { s : "old" } }, false, true );
+assert.eq( 0, t.runTool( "import", "--file", t.extFile, "-d", t.baseName, "-c", "foo",
+                         "--upsert", "--numParsingThreads", "2", "--numInsertionWorkers", "2" ) );
+check( "upsert" );
+assert.eq( 0, c.find( { s : "old" } ).itcount() );
+
+// With --stopOnError, documents still go in in order, and none after a bad line.
+var badFile = "jstests/tool/data/stop_on_error.json";
+c.drop();
+assert.neq( 0, t.runTool( "import", "--file", badFile, "-d", t.baseName, "-c", "foo",
+                          "--stopOnError", "--numParsingThreads", "4" ) );
+assert.eq( 6, c.count() );
+assert.eq( 5, c.find().sort( { _id : -1 } ).next()._id );
+
+// Without it, every good line goes in.
+c.drop();
+assert.neq( 0, t.runTool( "import", "--file", badFile, "-d", t.baseName, "-c", "foo",
+                          "--numParsingThreads", "4", "--numInsertionWorkers", "2" ) );
+assert.eq( 9, c.count() );
+
+// CSV with a header line, and a quoted field over several lines.
+c.drop();
+t.runTool( "import", "--file", "jstests/tool/data/csvimport1.csv", "-d", t.baseName, "-c", "foo",
+           "--type", "csv", "--headerline", "--numParsingThreads", "3" );
+assert.eq( 5, c.count() );
+assert.eq( 1, c.find( { a : 1 } ).itcount() );
+assert.eq( 0, c.find( { a : "a" } ).itcount() );
+
+t.stop();
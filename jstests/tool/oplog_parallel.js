@@ -0,0 +1,71 @@
+/**
+ * mongooplog with --numWriterThreads applies batches of ops over several connections, keeping
+ * the ops on each document in order, and commands and index builds between the ops around them.
+ * Correctness is verified using the dbhash command.
+ */
+
+var repl1 = new ReplSetTest({ name: 'rs1', nodes: [{ nopreallocj: '' },
+    { arbiter: true }, { arbiter: true }]});
+
+repl1.startSet({ oplogSize: 10 });
+repl1.initiate();
+repl1.awaitSecondaryNodes();
+
+var repl1Conn = new Mongo(repl1.getURL());
+var testDB = repl1Conn.getDB('test');
+
+// Ops on the same documents, which have to be applied in order.
+for (var i = 0; i < 2000; i++) {
+    testDB.a.insert({ _id: i, x: 0 });
+}
+for (var n = 0; n < 5; n++) {
+    for (var i = 0; i < 2000; i += 3) {
+        testDB.a.update({ _id: i }, { $inc: { x: 1 }, $push: { order: n } });
+    }
+}
+testDB.a.remove({ _id: { $lt: 100 } });
+
+// A command in the middle of a batch.
+testDB.b.insert({ y: 1 });
+testDB.b.drop();
+testDB.b.insert({ y: 2 });
+
+// An index build, and a unique index other than _id.
+for (var i = 0; i < 500; i++) {
+    testDB.c.insert({ _id: i, u: i });
+}
+testDB.c.ensureIndex({ u: 1 }, { unique: true });
+for (var i = 0; i < 500; i++) {
+    testDB.c.update({ _id: i }, { $set: { u: i + 1000 } });
+}
+
+// A capped collection.
+testDB.createCollection('capped', { capped: true, size: 10000 });
+for (var i = 0; i < 1000; i++) {
+    testDB.capped.insert({ i: i });
+}
+assert.eq(null, testDB.getLastError());
+
+var repl2 = new ReplSetTest({ name: 'rs2', startPort: 31100, nodes: [{ nopreallocj: '' },
+    { arbiter: true }, { arbiter: true }]});
+
+repl2.startSet({ oplogSize: 10 });
+repl2.initiate();
+repl2.awaitSecondaryNodes();
+
+runMongoProgram('mongooplog', '--from', repl1.getPrimary().host,
+    '--host', repl2.getPrimary().host, '--numWriterThreads', '4');
+
+var repl1Hash = testDB.runCommand({ dbhash: 1 });
+
+var repl2Conn = new Mongo(repl2.getURL());
+var testDB2 = repl2Conn.getDB(testDB.getName());
+var repl2Hash = testDB2.runCommand({ dbhash: 1 });
+
+assert(repl1Hash.md5);
+assert.eq(repl1Hash.collections, repl2Hash.collections);
+assert.eq(repl1Hash.md5, repl2Hash.md5);
+assert.eq([0, 1, 2, 3, 4], testDB2.a.findOne({ _id: 999 }).order);
+
+repl1.stopSet();
+repl2.stopSet();
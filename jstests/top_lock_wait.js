@@ -0,0 +1,21 @@
+// top reports, per collection, the time operations spent waiting for the read or write lock.
+
+var t = db.jstests_top_lock_wait;
+t.drop();
+
+t.insert({a: 1});
+t.findOne();
+assert.eq(null, db.getLastError());
+
+var res = db.adminCommand({top: 1});
+assert.commandWorked(res);
+var coll = res.totals[t.getFullName()];
+assert(coll, tojson(res));
+['readLockWait', 'writeLockWait'].forEach(function(name) {
+    assert(coll.hasOwnProperty(name), tojson(coll));
+    assert.gte(coll[name].time, 0, tojson(coll));
+});
+assert.gte(coll.writeLockWait.count, 1, tojson(coll));
+assert.gte(coll.readLockWait.count, 1, tojson(coll));
+
+t.drop();
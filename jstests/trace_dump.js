@@ -0,0 +1,42 @@
+// The trace points record events while traceEnabled is set, and traceDump returns them in the
+// Chrome trace event format.
+
+var admin = db.getSiblingDB("admin");
+var t = db.jstests_trace_dump;
+t.drop();
+
+assert.commandWorked(admin.runCommand({ traceDump: 1, clear: true }));
+assert.commandWorked(admin.runCommand({ setParameter: 1, traceEnabled: true }));
+try {
+    t.insert({ a: 1 });
+    assert.eq(1, t.find({ a: 1 }).itcount());
+
+    var res = admin.runCommand({ traceDump: 1, clear: true });
+    assert.commandWorked(res);
+    assert(res.enabled);
+
+    var names = {};
+    res.traceEvents.forEach(function(e) {
+        assert(e.ph == "X" || e.ph == "i" || e.ph == "M", tojson(e));
+        if (e.ph == "X")
+            assert.gte(e.dur, 0, tojson(e));
+        names[e.name] = true;
+    });
+    assert(names["thread_name"], "no thread names in " + tojson(res));
+    assert(names["acquire DBRead"], "no lock acquisitions in " + tojson(names));
+    assert(names["work"], "no query execution in " + tojson(names));
+}
+finally {
+    assert.commandWorked(admin.runCommand({ setParameter: 1, traceEnabled: false }));
+}
+
+// Nothing more is recorded while disabled.
+function countEvents() {
+    var res = admin.runCommand({ traceDump: 1 });
+    assert.commandWorked(res);
+    assert(!res.enabled);
+    return res.traceEvents.filter(function(e) { return e.ph != "M"; }).length;
+}
+var before = countEvents();
+t.findOne();
+assert.eq(before, countEvents());
@@ -0,0 +1,43 @@
+// Updates that grow a document within its record's padding keep it in place, and keep its index
+// keys when no indexed field changed.  Indexed fields that do change, including those of a text
+// index, still update their keys.
+
+db.adminCommand({setParameter: 1, textSearchEnabled: true});
+db.adminCommand({setParameter: 1, newQueryFrameworkEnabled: true});
+
+var t = db.jstests_update_grow_in_record;
+t.drop();
+
+t.insert({_id: 0, a: 1, s: 'x', pad: new Array(200).join('p')});
+t.ensureIndex({a: 1});
+t.ensureIndex({content: 'text'});
+// Leave room in the record to grow into.
+t.update({_id: 0}, {$set: {pad: 'p'}});
+assert.eq(null, db.getLastError());
+
+function profiled(update) {
+    db.system.profile.drop();
+    db.setProfilingLevel(2);
+    t.update({_id: 0}, update);
+    assert.eq(null, db.getLastError());
+    db.setProfilingLevel(0);
+    return db.system.profile.find({ns: t.getFullName(), op: 'update'}).sort({$natural: -1})
+        .limit(1).next();
+}
+
+var op = profiled({$set: {s: 'a longer string than before'}});
+assert(!op.moved, tojson(op));
+assert.eq(0, op.keyUpdates, tojson(op));
+assert.eq('a longer string than before', t.findOne().s);
+
+op = profiled({$set: {a: 'a longer indexed value'}});
+assert(!op.moved, tojson(op));
+assert.eq(1, t.find({a: 'a longer indexed value'}).hint({a: 1}).itcount());
+assert.eq(0, t.find({a: 1}).hint({a: 1}).itcount());
+
+op = profiled({$set: {content: 'searchable words'}});
+assert(!op.moved, tojson(op));
+assert.eq(1, t.find({$text: {$search: 'searchable'}}).itcount());
+
+assert.eq(1, t.count());
+assert(t.validate(true).valid);
@@ -0,0 +1,52 @@
+// A document that moves when an update grows it keeps the keys the update didn't change, which are
+// pointed at its new location.  Keys shared with other documents stay in record order.
+
+var t = db.jstests_update_move_index_keys;
+t.drop();
+
+var tags = [];
+for (var i = 0; i < 1000; i++) {
+    tags.push('tag' + i);
+}
+t.ensureIndex({tags: 1});
+t.ensureIndex({g: 1});
+t.ensureIndex({u: 1}, {unique: true});
+for (var i = 0; i < 20; i++) {
+    t.insert({_id: i, tags: tags, g: 'same', u: i});
+}
+assert.eq(null, db.getLastError());
+
+function profiled(query, update) {
+    db.system.profile.drop();
+    db.setProfilingLevel(2);
+    t.update(query, update);
+    assert.eq(null, db.getLastError());
+    db.setProfilingLevel(0);
+    return db.system.profile.find({ns: t.getFullName(), op: 'update'}).sort({$natural: -1})
+        .limit(1).next();
+}
+
+// Grow every other document until it moves.  Only the new tag is a new key.
+for (var i = 0; i < 20; i += 2) {
+    var op = profiled({_id: i}, {$push: {tags: 'more' + i},
+                                 $set: {pad: new Array(2000).join('p')}});
+    assert(op.moved, tojson(op));
+    assert.eq(1, op.keyUpdates, tojson(op));
+}
+
+assert.eq(20, t.find({tags: 'tag500'}).hint({tags: 1}).itcount());
+assert.eq(1, t.find({tags: 'more4'}).hint({tags: 1}).itcount());
+assert.eq(20, t.find({g: 'same'}).hint({g: 1}).itcount());
+for (var i = 0; i < 20; i++) {
+    assert.eq(i, t.find({u: i}).hint({u: 1}).next()._id);
+}
+
+// A move that changes a unique key still checks it.
+t.update({_id: 1}, {$set: {u: 0, pad: new Array(2000).join('p')}});
+assert.neq(null, db.getLastError());
+t.update({_id: 1}, {$set: {u: 100, pad: new Array(2000).join('p')}});
+assert.eq(null, db.getLastError());
+assert.eq(0, t.find({u: 1}).hint({u: 1}).itcount());
+assert.eq(1, t.find({u: 100}).hint({u: 1}).itcount());
+
+assert(t.validate(true).valid);
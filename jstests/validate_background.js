@@ -0,0 +1,47 @@
+// validate checks a collection's indexes on several threads, and with background: true yields
+// while it scans, so that writes go on meanwhile.
+
+var t = db.jstests_validate_background;
+t.drop();
+
+for (var i = 0; i < 5000; i++) {
+    t.insert({_id: i, a: i % 100, b: [i, -i], c: "x" + i});
+}
+t.ensureIndex({a: 1});
+t.ensureIndex({b: 1});
+t.ensureIndex({c: -1, a: 1});
+assert.eq(null, db.getLastError());
+
+var res = t.runCommand("validate", {full: true});
+assert.commandWorked(res);
+assert(res.valid, tojson(res));
+assert.eq(4, res.nIndexes);
+var keys = res.keysPerIndex;
+assert.eq(5000, keys[t.getFullName() + ".$_id_"]);
+assert.eq(5000, keys[t.getFullName() + ".$a_1"]);
+// -0 and 0 are one key
+assert.eq(9999, keys[t.getFullName() + ".$b_1"]);
+
+var bg = t.runCommand("validate", {full: true, background: true});
+assert.commandWorked(bg);
+assert(bg.valid, tojson(bg));
+assert.eq(5000, bg.objectsFound);
+assert.eq(keys, bg.keysPerIndex);
+
+// Writes while validating in the background.
+var join = startParallelShell(
+    "for (var i = 5000; i < 15000; i++) {" +
+    "    db.jstests_validate_background.insert({_id: i, a: i % 100, b: [i], c: 'y' + i});" +
+    "    if (i % 3 == 0) db.jstests_validate_background.remove({_id: i - 5000});" +
+    "}" +
+    "db.getLastError();");
+for (var i = 0; i < 5; i++) {
+    bg = t.runCommand("validate", {full: true, background: true});
+    assert.commandWorked(bg);
+    assert(bg.valid, tojson(bg));
+}
+join();
+
+res = t.runCommand("validate", {full: true});
+assert(res.valid, tojson(res));
+assert.eq(t.count(), res.keysPerIndex[t.getFullName() + ".$_id_"]);
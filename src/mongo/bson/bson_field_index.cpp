@@ -0,0 +1,73 @@
+// bson_field_index.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/bson/bson_field_index.h"
+
+namespace mongo {
+
+    BSONFieldIndex::BSONFieldIndex( const BSONObj& obj )
+        : _obj( obj ), _scanned( 0 ), _indexed( false ) {
+    }
+
+    void BSONFieldIndex::_buildIndex() const {
+        _fields.rehash( _obj.nFields() );
+        BSONObjIterator it( _obj );
+        while ( it.more() ) {
+            BSONElement e = it.next();
+            // insert() keeps the first of duplicate names, as getField() finds it.
+            _fields.insert( FieldMap::value_type( e.fieldNameStringData(), e ) );
+        }
+        _indexed = true;
+    }
+
+    BSONElement BSONFieldIndex::getField( const StringData& name ) const {
+        if ( !_indexed ) {
+            if ( _scanned <= kScanLimit ) {
+                BSONObjIterator it( _obj );
+                while ( it.more() ) {
+                    BSONElement e = it.next();
+                    _scanned++;
+                    if ( name == e.fieldNameStringData() )
+                        return e;
+                }
+                return BSONElement();
+            }
+            _buildIndex();
+        }
+
+        FieldMap::const_iterator it = _fields.find( name );
+        if ( it == _fields.end() )
+            return BSONElement();
+        return it->second;
+    }
+
+    BSONElement BSONFieldIndex::getFieldDotted( const StringData& name ) const {
+        BSONElement e = getField( name );
+        if ( !e.eoo() )
+            return e;
+
+        size_t dot = name.find( '.' );
+        if ( dot == string::npos )
+            return e;
+
+        BSONElement sub = getField( name.substr( 0, dot ) );
+        if ( sub.type() != Object && sub.type() != Array )
+            return BSONElement();
+        return sub.embeddedObject().getFieldDotted( name.substr( dot + 1 ) );
+    }
+
+}  // namespace mongo
@@ -0,0 +1,67 @@
+// bson_field_index.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/unordered_map.h"
+
+namespace mongo {
+
+    /**
+     * Top level field lookup for a document that is looked into many times, such as one being
+     * matched against many predicates.  BSONObj::getField scans the elements from the front on
+     * every call.  A BSONFieldIndex scans too, until its lookups have stepped over more than
+     * kScanLimit elements; it then builds a table of the document's fields, and later lookups
+     * find them in constant time.  Documents looked into only a few times, or only for their
+     * first few fields, never pay for the table.
+     *
+     * Meant to live only as long as an operation on the document: it holds the document, and
+     * the names in its table point into it.  Not thread safe.
+     */
+    class BSONFieldIndex {
+        MONGO_DISALLOW_COPYING(BSONFieldIndex);
+    public:
+        explicit BSONFieldIndex( const BSONObj& obj );
+
+        const BSONObj& obj() const { return _obj; }
+
+        /** Same as obj().getField( name ), including returning the first of duplicate fields. */
+        BSONElement getField( const StringData& name ) const;
+
+        /** Same as obj().getFieldDotted( name ), with the first part looked up in the table. */
+        BSONElement getFieldDotted( const StringData& name ) const;
+
+        bool isIndexed() const { return _indexed; }
+
+        static const int kScanLimit = 32;
+
+    private:
+        void _buildIndex() const;
+
+        typedef unordered_map<StringData, BSONElement, StringData::Hasher> FieldMap;
+
+        BSONObj _obj;
+        // Elements stepped over by the lookups done without the table.
+        mutable int _scanned;
+        mutable bool _indexed;
+        mutable FieldMap _fields;
+    };
+
+}  // namespace mongo
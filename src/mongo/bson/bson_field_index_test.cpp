@@ -0,0 +1,96 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/bson/bson_field_index.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+
+    using mongo::BSONElement;
+    using mongo::BSONFieldIndex;
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::fromjson;
+
+    BSONObj wideDoc( int nFields ) {
+        BSONObjBuilder b;
+        for ( int i = 0; i < nFields; i++ ) {
+            b.append( std::string( mongoutils::str::stream() << "f" << i ), i );
+        }
+        return b.obj();
+    }
+
+    TEST(BSONFieldIndex, RepeatedLookups) {
+        BSONObj doc = fromjson( "{a: 1, b: 2, c: 3}" );
+        BSONFieldIndex fields( doc );
+        for ( int i = 0; i < 100; i++ ) {
+            ASSERT_EQUALS( 3, fields.getField( "c" ).numberInt() );
+            ASSERT( fields.getField( "d" ).eoo() );
+        }
+        ASSERT_EQUALS( 2, fields.getField( "b" ).numberInt() );
+    }
+
+    TEST(BSONFieldIndex, WideDocumentIsIndexed) {
+        BSONObj doc = wideDoc( 200 );
+        BSONFieldIndex fields( doc );
+        ASSERT_EQUALS( 150, fields.getField( "f150" ).numberInt() );
+        ASSERT( !fields.isIndexed() );
+        ASSERT_EQUALS( 199, fields.getField( "f199" ).numberInt() );
+        ASSERT( fields.isIndexed() );
+        for ( int i = 0; i < 200; i++ ) {
+            std::string name = mongoutils::str::stream() << "f" << i;
+            ASSERT_EQUALS( doc.getField( name ), fields.getField( name ) );
+        }
+        ASSERT( fields.getField( "f200" ).eoo() );
+        ASSERT( fields.getField( "" ).eoo() );
+    }
+
+    TEST(BSONFieldIndex, DuplicateFieldsFindFirst) {
+        BSONObjBuilder b;
+        b.append( "a", 1 );
+        b.appendElements( wideDoc( 100 ) );
+        b.append( "a", 2 );
+        BSONObj doc = b.obj();
+
+        BSONFieldIndex fields( doc );
+        fields.getField( "f99" );
+        ASSERT( fields.isIndexed() );
+        ASSERT_EQUALS( 1, fields.getField( "a" ).numberInt() );
+    }
+
+    TEST(BSONFieldIndex, Dotted) {
+        BSONObjBuilder b;
+        b.appendElements( wideDoc( 100 ) );
+        b.append( "x", BSON( "y" << BSON( "z" << 5 ) ) );
+        b.append( "x.y", 6 );
+        b.append( "arr", BSON_ARRAY( 7 << 8 ) );
+        BSONObj doc = b.obj();
+
+        BSONFieldIndex fields( doc );
+        fields.getField( "f99" );
+        ASSERT( fields.isIndexed() );
+
+        const char* names[] = { "x.y.z", "x.y", "x", "arr.1", "arr.2", "x.q", "f5.a", "q.r" };
+        for ( size_t i = 0; i < sizeof( names ) / sizeof( names[0] ); i++ ) {
+            ASSERT_EQUALS( doc.getFieldDotted( names[i] ), fields.getFieldDotted( names[i] ) );
+        }
+        ASSERT_EQUALS( 6, fields.getFieldDotted( "x.y" ).numberInt() );
+        ASSERT_EQUALS( 8, fields.getFieldDotted( "arr.1" ).numberInt() );
+    }
+
+} // unnamed namespace
@@ -15,7 +15,12 @@
  *    limitations under the License.
  */
 
-#include <deque>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "mongo/bson/bson_validate.h"
 #include "mongo/bson/oid.h"
@@ -24,6 +29,24 @@ namespace mongo {
 
     namespace {
 
+        /**
+         * Finds the first NUL in [p, p + n).  Most c-strings in BSON are field names of well under
+         * 16 bytes, so one SSE2 compare usually finds it without the call to memchr.
+         */
+        inline const char* findNul( const char* p, uint64_t n ) {
+#if defined(__SSE2__)
+            if ( n >= 16 ) {
+                __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+                int mask = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, _mm_setzero_si128() ) );
+                if ( mask )
+                    return p + __builtin_ctz( mask );
+                p += 16;
+                n -= 16;
+            }
+#endif
+            return static_cast<const char*>( memchr( p, 0, n ) );
+        }
+
         class Buffer {
         public:
             Buffer( const char* buffer, uint64_t maxLength )
@@ -43,10 +66,10 @@ namespace mongo {
             }
 
             Status readCString( StringData* out ) {
-                const void* x = memchr( _buffer + _position, 0, _maxLength - _position );
+                const char* x = findNul( _buffer + _position, _maxLength - _position );
                 if ( !x )
                     return Status( ErrorCodes::InvalidBSON, "no end of c-string" );
-                uint64_t len = static_cast<uint64_t>( static_cast<const char*>(x) - ( _buffer + _position ) );
+                uint64_t len = static_cast<uint64_t>( x - ( _buffer + _position ) );
 
                 StringData data( _buffer + _position, len );
                 _position += len + 1;
@@ -127,6 +150,37 @@ namespace mongo {
             int _startPosition;
         };
 
+        /**
+         * The frames of the objects being validated.  Documents are rarely nested more than a few
+         * levels deep, so the first kInlineFrames live on the stack and validating most documents
+         * allocates nothing.  References to the inline frames stay valid across push and pop.
+         */
+        class ValidationFrameStack {
+        public:
+            ValidationFrameStack() : _size( 0 ) {}
+
+            void push() {
+                if ( _size >= kInlineFrames )
+                    _overflow.push_back( ValidationObjectFrame() );
+                _size++;
+            }
+            void pop() {
+                if ( _size > kInlineFrames )
+                    _overflow.pop_back();
+                _size--;
+            }
+            ValidationObjectFrame& back() {
+                return _size > kInlineFrames ? _overflow.back() : _inline[_size - 1];
+            }
+            bool empty() const { return _size == 0; }
+
+        private:
+            static const size_t kInlineFrames = 32;
+            ValidationObjectFrame _inline[kInlineFrames];
+            std::vector<ValidationObjectFrame> _overflow;
+            size_t _size;
+        };
+
         Status validateElementInfo(Buffer* buffer, ValidationState::State* nextState) {
             Status status = Status::OK();
 
@@ -222,14 +276,14 @@ namespace mongo {
         }
 
         Status validateBSONIterative(Buffer* buffer) {
-            std::deque<ValidationObjectFrame> frames;
+            ValidationFrameStack frames;
             ValidationObjectFrame* curr = NULL;
             ValidationState::State state = ValidationState::BeginObj;
 
             while (state != ValidationState::Done) {
                 switch (state) {
                 case ValidationState::BeginObj:
-                    frames.push_back(ValidationObjectFrame());
+                    frames.push();
                     curr = &frames.back();
                     curr->setStartPosition(buffer->position());
                     curr->setIsCodeWithScope(false);
@@ -251,7 +305,7 @@ namespace mongo {
                         return Status( ErrorCodes::InvalidBSON,
                                        "bson length doesn't match what we found" );
                     }
-                    frames.pop_back();
+                    frames.pop();
                     if (frames.empty()) {
                         state = ValidationState::Done;
                     }
@@ -265,7 +319,7 @@ namespace mongo {
                     break;
                 }
                 case ValidationState::BeginCodeWScope: {
-                    frames.push_back(ValidationObjectFrame());
+                    frames.push();
                     curr = &frames.back();
                     curr->setStartPosition(buffer->position());
                     curr->setIsCodeWithScope(true);
@@ -283,7 +337,7 @@ namespace mongo {
                         return Status( ErrorCodes::InvalidBSON,
                                        "bson length for CodeWScope doesn't match what we found" );
                     }
-                    frames.pop_back();
+                    frames.pop();
                     if (frames.empty())
                         return Status(ErrorCodes::InvalidBSON, "unnested CodeWScope");
                     curr = &frames.back();
@@ -17,6 +17,7 @@
 #include "mongo/unittest/unittest.h"
 #include "mongo/platform/random.h"
 #include "mongo/bson/bson_validate.h"
+#include "mongo/util/timer.h"
 
 namespace {
 
@@ -213,4 +214,46 @@ namespace {
         ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize() / 2));
     }
 
+    TEST(BSONValidateFast, DeeplyNested) {
+        // Deeper than the frames kept on the stack
+        BSONObj x = BSON( "z" << 1 );
+        for ( int i = 0; i < 100; i++ ) {
+            x = BSON( "a" << BSON_ARRAY( x ) << "b" << i );
+        }
+        ASSERT_OK( validateBSON( x.objdata(), x.objsize() ) );
+        ASSERT_NOT_OK( validateBSON( x.objdata(), x.objsize() / 2 ) );
+    }
+
+    TEST(BSONValidateFast, FieldNameLengths) {
+        // Names on either side of 16 bytes, with the end of the buffer close behind
+        for ( int len = 0; len < 40; len++ ) {
+            BSONObj x = BSON( string( len, 'x' ) << 1 );
+            ASSERT_OK( validateBSON( x.objdata(), x.objsize() ) );
+            for ( int size = 0; size < x.objsize(); size++ )
+                ASSERT_NOT_OK( validateBSON( x.objdata(), size ) );
+        }
+    }
+
+    TEST(BSONValidateFast, InsertBatchRate) {
+        vector<BSONObj> batch;
+        for ( int i = 0; i < 1000; i++ ) {
+            batch.push_back( BSON( "_id" << i << "name" << "document name" << "count" << i * 3 <<
+                                   "tags" << BSON_ARRAY( "a" << "b" << "c" ) <<
+                                   "address" << BSON( "street" << "main" << "zip" << 12345 ) ) );
+        }
+
+        const int passes = 100;
+        long long bytes = 0;
+        Timer t;
+        for ( int pass = 0; pass < passes; pass++ ) {
+            for ( size_t i = 0; i < batch.size(); i++ ) {
+                ASSERT_OK( validateBSON( batch[i].objdata(), batch[i].objsize() ) );
+                bytes += batch[i].objsize();
+            }
+        }
+        long long micros = t.micros();
+        log() << "validated " << passes * batch.size() << " documents (" << bytes << " bytes) in "
+              << micros << "us" << endl;
+    }
+
 }
@@ -83,26 +83,36 @@ namespace mutablebson {
 
     /** Sort any children of Element 'parent' by way of Comparator 'comp', which should provide
      *  an operator() that takes two const Element&'s and implements a strict weak ordering.
+     *  Children that are already in order, from the first one, are left where they are.
      */
     template<typename Comparator>
     void sortChildren(Element parent, Comparator comp)  {
-        // TODO: The following works, but obviously is not ideal.
-
-        // First, build a vector of the children.
+        // First, build a vector of the children, noting whether they are sorted already.
         std::vector<Element> children;
+        bool sorted = true;
         Element current = parent.leftChild();
         while (current.ok()) {
+            if (sorted && !children.empty() && comp(current, children.back()))
+                sorted = false;
             children.push_back(current);
             current = current.rightSibling();
         }
+        if (sorted)
+            return;
 
         // Then, sort the child vector with our comparator.
-        std::sort(children.begin(), children.end(), comp);
+        std::vector<Element> sortedChildren(children);
+        std::sort(sortedChildren.begin(), sortedChildren.end(), comp);
 
         // Finally, reorder the children of parent according to the ordering established in
-        // 'children'.
-        std::vector<Element>::iterator where = children.begin();
-        const std::vector<Element>::iterator end = children.end();
+        // 'sortedChildren', starting at the first child out of place.
+        std::vector<Element>::iterator where = sortedChildren.begin();
+        const std::vector<Element>::iterator end = sortedChildren.end();
+        std::vector<Element>::const_iterator before = children.begin();
+        while (where != end && *where == *before) {
+            ++where;
+            ++before;
+        }
         for( ; where != end; ++where ) {
             // Detach from its current location.
             where->remove();
@@ -294,6 +294,23 @@ namespace {
         ASSERT_FALSE(current.ok());
     }
 
+    TEST(SortTest, Unsorted) {
+        Document doc(mongo::fromjson("{ x : [ 1, 4, 2, 5, 3 ] }"));
+        sortChildren(doc.root().leftChild(), woLess(false));
+        ASSERT_TRUE(checkDoc(doc, mongo::fromjson("{x : [ 1, 2, 3, 4, 5 ]}")));
+    }
+
+    TEST(SortTest, SortedIsLeftInPlace) {
+        Document doc(mongo::fromjson("{ x : [ 1, 2, 2, 3 ] }"));
+        sortChildren(doc.root().leftChild(), woLess(false));
+        ASSERT_TRUE(checkDoc(doc, mongo::fromjson("{x : [ 1, 2, 2, 3 ]}")));
+
+        DamageVector damages;
+        const char* source = NULL;
+        ASSERT_TRUE(doc.getInPlaceUpdates(&damages, &source));
+        ASSERT_TRUE(damages.empty());
+    }
+
     TEST(DeduplicateTest, ManyDuplicates) {
         Document doc(mongo::fromjson("{ x : [ 1, 2, 2, 3, 3, 3, 4, 4, 4 ] }"));
         deduplicateChildren(doc.root().leftChild(), woEqual(false));
@@ -18,13 +18,13 @@
 #include "mongo/pch.h"
 
 #include <boost/functional/hash.hpp>
+#include <boost/thread/tss.hpp>
 
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/platform/random.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/oid.h"
-#include "mongo/bson/util/atomic_int.h"
 
 #define verify MONGO_verify
 
@@ -96,12 +96,67 @@ namespace mongo {
         ourMachineAndPid = x;
     }
 
+namespace {
+    /**
+     * Counter values a thread has taken from the shared counter and not used yet.  Taking them
+     * a block at a time keeps the threads generating OIDs from all writing to one cache line.
+     * A block is only used during the second it was taken in, so two OIDs can only share a
+     * counter value if over 2^24 of them were made in one second, as when each took its own.
+     */
+    struct IncBlock {
+        IncBlock() : time( 0 ), next( 0 ), end( 0 ) {}
+        unsigned time;
+        unsigned next;
+        unsigned end;
+    };
+
+    const unsigned incBlockSize = 64;
+
+    AtomicUInt32& sharedInc() {
+        static AtomicUInt32 inc( static_cast<unsigned>(
+            scoped_ptr<SecureRandom>(SecureRandom::create())->nextInt64()) );
+        return inc;
+    }
+
+    /** Returns the first of "n" consecutive counter values for OIDs made at time "t". */
+    unsigned reserveIncs( unsigned t, unsigned n ) {
+        // Never freed, so that OIDs can still be made during shutdown.
+        static boost::thread_specific_ptr<IncBlock>* blocks =
+            new boost::thread_specific_ptr<IncBlock>;
+
+        if ( n > incBlockSize )
+            return sharedInc().fetchAndAdd( n );
+
+        IncBlock* block = blocks->get();
+        if ( !block ) {
+            block = new IncBlock;
+            blocks->reset( block );
+        }
+        if ( block->time != t || block->end - block->next < n ) {
+            block->time = t;
+            block->next = sharedInc().fetchAndAdd( incBlockSize );
+            block->end = block->next + incBlockSize;
+        }
+        unsigned first = block->next;
+        block->next += n;
+        return first;
+    }
+}  // namespace
+
     void OID::init() {
-        static AtomicUInt inc = static_cast<unsigned>(
-            scoped_ptr<SecureRandom>(SecureRandom::create())->nextInt64());
+        unsigned t = (unsigned) time(0);
+        initFromTimeAndInc( t, reserveIncs( t, 1 ) );
+    }
 
+    void OID::gen( OID* oids, size_t n ) {
+        unsigned t = (unsigned) time(0);
+        unsigned inc = reserveIncs( t, n );
+        for ( size_t i = 0; i < n; i++ )
+            oids[i].initFromTimeAndInc( t, inc + i );
+    }
+
+    void OID::initFromTimeAndInc( unsigned t, unsigned inc ) {
         {
-            unsigned t = (unsigned) time(0);
             unsigned char *T = (unsigned char *) &t;
             _time[0] = T[3]; // big endian order because we use memcmp() to compare OID's
             _time[1] = T[2];
@@ -112,8 +167,7 @@ namespace mongo {
         _machineAndPid = ourMachineAndPid;
 
         {
-            int new_inc = inc++;
-            unsigned char *T = (unsigned char *) &new_inc;
+            unsigned char *T = (unsigned char *) &inc;
             _inc[0] = T[2];
             _inc[1] = T[1];
             _inc[2] = T[0];
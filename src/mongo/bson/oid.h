@@ -75,6 +75,12 @@ namespace mongo {
 
         static OID gen() { OID o; o.init(); return o; }
 
+        /**
+         * Fills oids[0] to oids[n-1] with new OIDs, in increasing order, taking the counter that
+         * makes them unique only once.  For bulk inserts.
+         */
+        static void gen( OID* oids, size_t n );
+
         /** sets the contents to a new oid / randomized value */
         void init();
 
@@ -139,6 +145,9 @@ namespace mongo {
 
         static void foldInPid(MachineAndPid& x);
         static MachineAndPid genMachineAndPid();
+
+        /** Sets the contents to the OID with time "t" and counter value "inc". */
+        void initFromTimeAndInc( unsigned t, unsigned inc );
     };
 #pragma pack()
 
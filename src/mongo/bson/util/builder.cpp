@@ -0,0 +1,92 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/bson/util/builder.h"
+
+#include <boost/thread/tss.hpp>
+#include <stdlib.h>
+
+namespace mongo {
+
+    namespace {
+
+        struct CachedBuffers {
+            CachedBuffers() : num(0) { }
+
+            ~CachedBuffers() {
+                for ( int i = 0; i < num; i++ )
+                    free( buffers[i].p );
+            }
+
+            struct Buffer {
+                void* p;
+                size_t sz;
+            };
+            Buffer buffers[BufBuilderCache::MaxBuffers];
+            int num;
+        };
+
+        // Never destroyed, so builders destroyed at exit can still use it
+        boost::thread_specific_ptr<CachedBuffers>& cachedBuffers() {
+            static boost::thread_specific_ptr<CachedBuffers>* cached =
+                new boost::thread_specific_ptr<CachedBuffers>();
+            return *cached;
+        }
+
+        // Sets up the thread specific pointer before there are threads to race for it
+        struct CachedBuffersInit {
+            CachedBuffersInit() { cachedBuffers(); }
+        } cachedBuffersInit;
+
+    } // namespace
+
+    void* BufBuilderCache::take(size_t sz) {
+        CachedBuffers* cached = cachedBuffers().get();
+        if ( !cached )
+            return NULL;
+        for ( int i = cached->num - 1; i >= 0; i-- ) {
+            if ( cached->buffers[i].sz == sz ) {
+                void* p = cached->buffers[i].p;
+                for ( int j = i + 1; j < cached->num; j++ )
+                    cached->buffers[j - 1] = cached->buffers[j];
+                cached->num--;
+                return p;
+            }
+        }
+        return NULL;
+    }
+
+    bool BufBuilderCache::keep(void* p, size_t sz) {
+        if ( sz > MaxBufferSize )
+            return false;
+        CachedBuffers* cached = cachedBuffers().get();
+        if ( !cached ) {
+            cached = new CachedBuffers();
+            cachedBuffers().reset( cached );
+        }
+        if ( cached->num == MaxBuffers ) {
+            // Make room by dropping the oldest
+            free( cached->buffers[0].p );
+            for ( int i = 1; i < MaxBuffers; i++ )
+                cached->buffers[i - 1] = cached->buffers[i];
+            cached->num--;
+        }
+        CachedBuffers::Buffer& buffer = cached->buffers[cached->num++];
+        buffer.p = p;
+        buffer.sz = sz;
+        return true;
+    }
+
+} // namespace mongo
@@ -62,11 +62,33 @@ namespace mongo {
     template <typename Allocator>
     class StringBuilderImpl;
 
+    /** Each thread keeps a few of the buffers its BufBuilders free, and gives them to its next
+        BufBuilders of the same size.  A builder for a reply or a temporary object then costs no
+        malloc or free.  The buffers are malloc'd: one a builder decouple()s is free()d as usual.
+    */
+    class BufBuilderCache {
+    public:
+        /** @return a buffer of exactly sz bytes this thread freed, or NULL if it has none */
+        static void* take(size_t sz);
+
+        /** @return whether this thread kept p, a buffer of sz bytes, rather than the caller
+            having to free it */
+        static bool keep(void* p, size_t sz);
+
+        enum { MaxBuffers = 4, MaxBufferSize = 64 * 1024 };
+    };
+
     class TrivialAllocator { 
     public:
-        void* Malloc(size_t sz) { return malloc(sz); }
+        void* Malloc(size_t sz) {
+            void* p = BufBuilderCache::take(sz);
+            return p ? p : malloc(sz);
+        }
         void* Realloc(void *p, size_t sz) { return realloc(p, sz); }
-        void Free(void *p) { free(p); }
+        void Free(void *p, size_t sz) {
+            if( !BufBuilderCache::keep(p, sz) )
+                free(p);
+        }
     };
 
     class StackAllocator {
@@ -87,7 +109,7 @@ namespace mongo {
             }
             return realloc(p, sz); 
         }
-        void Free(void *p) { 
+        void Free(void *p, size_t sz) { 
             if( p != buf )
                 free(p); 
         }
@@ -117,7 +139,7 @@ namespace mongo {
 
         void kill() {
             if ( data ) {
-                al.Free(data);
+                al.Free(data, size);
                 data = 0;
             }
         }
@@ -128,7 +150,7 @@ namespace mongo {
         void reset( int maxSize ) {
             l = 0;
             if ( maxSize && size > maxSize ) {
-                al.Free(data);
+                al.Free(data, size);
                 data = (char*)al.Malloc(maxSize);
                 if ( data == 0 )
                     msgasserted( 15913 , "out of memory BufBuilder::reset" );
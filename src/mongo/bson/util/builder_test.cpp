@@ -31,4 +31,49 @@ namespace mongo {
         ASSERT_EQUALS( 0, strcmp( bb.buf(), "eliot" ) );
         ASSERT_EQUALS( 0, strcmp( "eliot", bb.buf() ) );
     }
+
+    TEST( Builder, ReusesFreedBuffer ) {
+        const void* first;
+        {
+            BufBuilder bb( 1000 );
+            first = bb.buf();
+        }
+        BufBuilder same( 1000 );
+        ASSERT_EQUALS( first, same.buf() );
+
+        // Only a buffer of the same size is reused
+        BufBuilder other( 2000 );
+        ASSERT_NOT_EQUALS( first, other.buf() );
+    }
+
+    TEST( Builder, DoesNotReuseDecoupledBuffer ) {
+        char* decoupled;
+        {
+            BufBuilder bb( 1024 );
+            bb.appendStr( "eliot" );
+            decoupled = bb.buf();
+            bb.decouple();
+        }
+        BufBuilder next( 1024 );
+        ASSERT_NOT_EQUALS( decoupled, next.buf() );
+        ASSERT_EQUALS( 0, strcmp( "eliot", decoupled ) );
+        free( decoupled );
+    }
+
+    TEST( Builder, DoesNotKeepLargeBuffers ) {
+        void* large = malloc( BufBuilderCache::MaxBufferSize + 1 );
+        ASSERT_FALSE( BufBuilderCache::keep( large, BufBuilderCache::MaxBufferSize + 1 ) );
+        free( large );
+
+        for ( int i = 0; i <= BufBuilderCache::MaxBuffers; i++ ) {
+            BufBuilder bb( 3000 + i );
+        }
+        // The first was dropped to make room for the last
+        ASSERT( !BufBuilderCache::take( 3000 ) );
+        for ( int i = 1; i <= BufBuilderCache::MaxBuffers; i++ ) {
+            void* p = BufBuilderCache::take( 3000 + i );
+            ASSERT( p );
+            free( p );
+        }
+    }
 }
@@ -41,13 +41,13 @@ namespace mongo {
         }
     }
 
-    void PoolForHost::done( DBConnectionPool * pool, DBClientBase * c ) {
+    void PoolForHost::done( DBConnectionPool * pool, DBClientBase * c, unsigned maxPoolSize ) {
         if (c->isFailed()) {
             reportBadConnectionAt(c->getSockCreationMicroSec());
             pool->onDestroy(c);
             delete c;
         }
-        else if (_pool.size() >= _maxPerHost ||
+        else if (_pool.size() >= maxPoolSize ||
                 c->getSockCreationMicroSec() < _minValidCreationTimeMicroSec) {
             pool->onDestroy(c);
             delete c;
@@ -124,25 +124,36 @@ namespace mongo {
         }
     }
 
-    void PoolForHost::getStaleConnections( vector<DBClientBase*>& stale ) {
-        time_t now = time(0);
-
+    void PoolForHost::getIdleConnections( vector<DBClientBase*>& idle , time_t idleSince ) {
         vector<StoredConnection> all;
         while ( ! _pool.empty() ) {
             StoredConnection c = _pool.top();
             _pool.pop();
-            
-            if ( c.ok( now ) )
-                all.push_back( c );
+
+            if ( c.when < idleSince )
+                idle.push_back( c.conn );
             else
-                stale.push_back( c.conn );
+                all.push_back( c );
         }
 
-        for ( size_t i=0; i<all.size(); i++ ) {
-            _pool.push( all[i] );
+        // put the rest back in the same order, most recently used on top
+        for ( vector<StoredConnection>::reverse_iterator i = all.rbegin(); i != all.rend(); ++i ) {
+            _pool.push( *i );
         }
     }
 
+    int PoolForHost::numToWarmUp( unsigned minIdle , unsigned maxPoolSize ) const {
+        int target = std::min( minIdle , maxPoolSize );
+        return std::max( 0 , target - numAvailable() );
+    }
+
+    void PoolForHost::noteAcquired( bool created , long long micros ) {
+        _acquired++;
+        if ( created )
+            _acquiredCreated++;
+        _acquireMicros += micros;
+    }
+
 
     PoolForHost::StoredConnection::StoredConnection( DBClientBase * c ) {
         conn = c;
@@ -172,26 +183,38 @@ namespace mongo {
 
     DBConnectionPool pool;
 
+    // Idle connections are pinged by the background task once they have been in the pool this
+    // long, so that requests don't get handed connections the server has since closed.
+    static const time_t idleCheckSecs = 30;
+
     DBConnectionPool::DBConnectionPool() 
         : _mutex("DBConnectionPool") , 
           _name( "dbconnectionpool" ) , 
+          _maxPoolSize( 0 ) ,
+          _minIdlePerHost( 0 ) ,
           _hooks( new list<DBConnectionHook*>() ) { 
     }
 
-    DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
+    DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ,
+                                         const Timer& waited ) {
         verify( ! inShutdown() );
         scoped_lock L(_mutex);
         PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
         p.initializeHostName(ident);
-        return p.get( this , socketTimeout );
+        DBClientBase* c = p.get( this , socketTimeout );
+        if ( c )
+            p.noteAcquired( false , waited.micros() );
+        return c;
     }
 
-    DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
+    DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout ,
+                                                   DBClientBase* conn , const Timer& waited ) {
         {
             scoped_lock L(_mutex);
             PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
             p.initializeHostName(host);
             p.createdOne( conn );
+            p.noteAcquired( true , waited.micros() );
         }
         
         try {
@@ -207,7 +230,8 @@ namespace mongo {
     }
 
     DBClientBase* DBConnectionPool::get(const ConnectionString& url, double socketTimeout) {
-        DBClientBase * c = _get( url.toString() , socketTimeout );
+        Timer waited;
+        DBClientBase * c = _get( url.toString() , socketTimeout , waited );
         if ( c ) {
             try {
                 onHandedOut( c );
@@ -223,11 +247,12 @@ namespace mongo {
         c = url.connect( errmsg, socketTimeout );
         uassert( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg , c );
 
-        return _finishCreate( url.toString() , socketTimeout , c );
+        return _finishCreate( url.toString() , socketTimeout , c , waited );
     }
 
     DBClientBase* DBConnectionPool::get(const string& host, double socketTimeout) {
-        DBClientBase * c = _get( host , socketTimeout );
+        Timer waited;
+        DBClientBase * c = _get( host , socketTimeout , waited );
         if ( c ) {
             try {
                 onHandedOut( c );
@@ -246,12 +271,85 @@ namespace mongo {
         c = cs.connect( errmsg, socketTimeout );
         if ( ! c )
             throw SocketException( SocketException::CONNECT_ERROR , host , 11002 , str::stream() << _name << " error: " << errmsg );
-        return _finishCreate( host , socketTimeout , c );
+        return _finishCreate( host , socketTimeout , c , waited );
     }
 
     void DBConnectionPool::release(const string& host, DBClientBase *c) {
         scoped_lock L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+        _pools[PoolKey(host,c->getSoTimeout())].done(this,c,_maxPoolSizeLocked());
+    }
+
+    void DBConnectionPool::setMaxPoolSize( unsigned max ) {
+        scoped_lock L(_mutex);
+        _maxPoolSize = max;
+    }
+
+    unsigned DBConnectionPool::getMaxPoolSize() {
+        scoped_lock L(_mutex);
+        return _maxPoolSizeLocked();
+    }
+
+    unsigned DBConnectionPool::_maxPoolSizeLocked() const {
+        return _maxPoolSize ? _maxPoolSize : PoolForHost::getMaxPerHost();
+    }
+
+    void DBConnectionPool::setMinIdlePerHost( unsigned min ) {
+        scoped_lock L(_mutex);
+        _minIdlePerHost = min;
+    }
+
+    unsigned DBConnectionPool::getMinIdlePerHost() {
+        scoped_lock L(_mutex);
+        return _minIdlePerHost;
+    }
+
+    void DBConnectionPool::warmUp( const string& host , double socketTimeout ) {
+        int count;
+        {
+            scoped_lock L(_mutex);
+            PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
+            p.initializeHostName(host);
+            count = p.numToWarmUp( _minIdlePerHost , _maxPoolSizeLocked() );
+        }
+        _warmUp( host , socketTimeout , count );
+    }
+
+    void DBConnectionPool::_warmUp( const string& host , double socketTimeout , int count ) {
+        string errmsg;
+        ConnectionString cs = ConnectionString::parse( host , errmsg );
+        if ( ! cs.isValid() ) {
+            warning() << _name << ": can't warm up invalid host [" << host << "] "
+                      << errmsg << endl;
+            return;
+        }
+
+        for ( int i = 0; i < count && ! inShutdown(); i++ ) {
+            DBClientBase* c = cs.connect( errmsg , socketTimeout );
+            if ( ! c ) {
+                LOG(1) << _name << ": failed to warm up connections to " << host << " : "
+                       << errmsg << endl;
+                return;
+            }
+
+            {
+                scoped_lock L(_mutex);
+                PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
+                p.initializeHostName(host);
+                p.createdOne( c );
+            }
+
+            try {
+                onCreate( c );
+            }
+            catch ( const DBException& e ) {
+                LOG(1) << _name << ": failed to warm up connections to " << host
+                       << causedBy( e ) << endl;
+                delete c;
+                return;
+            }
+
+            release( host , c );
+        }
     }
 
 
@@ -322,6 +420,9 @@ namespace mongo {
 
         int avail = 0;
         long long created = 0;
+        long long acquired = 0;
+        long long acquiredNew = 0;
+        long long acquireMicros = 0;
 
 
         map<ConnectionString::ConnectionType,long long> createdByType;
@@ -340,10 +441,16 @@ namespace mongo {
                 BSONObjBuilder temp( bb.subobjStart( s ) );
                 temp.append( "available" , i->second.numAvailable() );
                 temp.appendNumber( "created" , i->second.numCreated() );
+                temp.appendNumber( "acquired" , i->second.numAcquired() );
+                temp.appendNumber( "acquiredNew" , i->second.numAcquiredCreated() );
+                temp.appendNumber( "acquireMicros" , i->second.acquireMicros() );
                 temp.done();
 
                 avail += i->second.numAvailable();
                 created += i->second.numCreated();
+                acquired += i->second.numAcquired();
+                acquiredNew += i->second.numAcquiredCreated();
+                acquireMicros += i->second.acquireMicros();
 
                 long long& x = createdByType[i->second.type()];
                 x += i->second.numCreated();
@@ -379,6 +486,9 @@ namespace mongo {
 
         b.append( "totalAvailable" , avail );
         b.appendNumber( "totalCreated" , created );
+        b.appendNumber( "totalAcquired" , acquired );
+        b.appendNumber( "totalAcquiredNew" , acquiredNew );
+        b.appendNumber( "totalAcquireMicros" , acquireMicros );
     }
 
     bool DBConnectionPool::serverNameCompare::operator()( const string& a , const string& b ) const{
@@ -438,21 +548,43 @@ namespace mongo {
     }
 
     void DBConnectionPool::taskDoWork() { 
-        vector<DBClientBase*> toDelete;
-        
+        _checkIdleConnections();
+        _warmUpPools();
+    }
+
+    void DBConnectionPool::_checkIdleConnections() {
+        vector< pair<string,DBClientBase*> > toCheck;
+
         {
             // we need to get the connections inside the lock
-            // but we can actually delete them outside
+            // but we can check and delete them outside
             scoped_lock lk( _mutex );
+            const time_t idleSince = time(0) - idleCheckSecs;
             for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
-                i->second.getStaleConnections( toDelete );
+                vector<DBClientBase*> idle;
+                i->second.getIdleConnections( idle , idleSince );
+                for ( size_t j=0; j<idle.size(); j++ ) {
+                    toCheck.push_back( make_pair( i->first.ident , idle[j] ) );
+                }
             }
         }
 
-        for ( size_t i=0; i<toDelete.size(); i++ ) {
+        for ( size_t i=0; i<toCheck.size(); i++ ) {
+            DBClientBase* c = toCheck[i].second;
             try {
-                onDestroy( toDelete[i] );
-                delete toDelete[i];
+                bool isMaster;
+                c->isMaster( isMaster );
+                release( toCheck[i].first , c );
+                continue;
+            }
+            catch ( const DBException& e ) {
+                LOG(1) << "Exception thrown when checking pooled connection to " <<
+                    c->getServerAddress() << ": " << causedBy(e) << endl;
+            }
+
+            try {
+                onDestroy( c );
+                delete c;
             }
             catch ( ... ) {
                 // we don't care if there was a socket error
@@ -460,6 +592,25 @@ namespace mongo {
         }
     }
 
+    void DBConnectionPool::_warmUpPools() {
+        vector< pair<PoolKey,int> > toWarm;
+
+        {
+            scoped_lock lk( _mutex );
+            if ( _minIdlePerHost == 0 )
+                return;
+            for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
+                int count = i->second.numToWarmUp( _minIdlePerHost , _maxPoolSizeLocked() );
+                if ( count > 0 )
+                    toWarm.push_back( make_pair( i->first , count ) );
+            }
+        }
+
+        for ( size_t i=0; i<toWarm.size(); i++ ) {
+            _warmUp( toWarm[i].first.ident , toWarm[i].first.timeout , toWarm[i].second );
+        }
+    }
+
     // ------ ScopedDbConnection ------
 
     void ScopedDbConnection::_setSocketTimeout(){
@@ -22,6 +22,7 @@
 #include "mongo/util/background.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/platform/cstdint.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -35,12 +36,16 @@ namespace mongo {
     class PoolForHost {
     public:
         PoolForHost()
-            : _created(0), _minValidCreationTimeMicroSec(0) {}
+            : _created(0), _minValidCreationTimeMicroSec(0),
+              _acquired(0), _acquiredCreated(0), _acquireMicros(0) {}
 
         PoolForHost( const PoolForHost& other ) {
             verify(other._pool.size() == 0);
             _created = other._created;
             _minValidCreationTimeMicroSec = other._minValidCreationTimeMicroSec;
+            _acquired = other._acquired;
+            _acquiredCreated = other._acquiredCreated;
+            _acquireMicros = other._acquireMicros;
             verify( _created == 0 );
         }
 
@@ -61,11 +66,33 @@ namespace mongo {
         // Deletes all connections in the pool
         void clear();
 
-        void done( DBConnectionPool * pool , DBClientBase * c );
+        /**
+         * Puts c back in the pool, unless it failed or the pool already holds maxPoolSize
+         * connections.
+         */
+        void done( DBConnectionPool * pool , DBClientBase * c , unsigned maxPoolSize );
 
         void flush();
-        
-        void getStaleConnections( vector<DBClientBase*>& stale );
+
+        /**
+         * Takes the connections that have sat in the pool since before idleSince out of it,
+         * to be checked without holding up the threads asking for connections.
+         */
+        void getIdleConnections( vector<DBClientBase*>& idle , time_t idleSince );
+
+        /**
+         * @return how many connections to open to bring the pool up to minIdle available
+         */
+        int numToWarmUp( unsigned minIdle , unsigned maxPoolSize ) const;
+
+        /**
+         * Records a connection handed out, whether it had to be created for the request, and
+         * how long the request waited for it.
+         */
+        void noteAcquired( bool created , long long micros );
+        long long numAcquired() const { return _acquired; }
+        long long numAcquiredCreated() const { return _acquiredCreated; }
+        long long acquireMicros() const { return _acquireMicros; }
 
         /**
          * Sets the lower bound for creation times that can be considered as
@@ -104,6 +131,10 @@ namespace mongo {
         uint64_t _minValidCreationTimeMicroSec;
         ConnectionString::ConnectionType _type;
 
+        int64_t _acquired;
+        int64_t _acquiredCreated;
+        int64_t _acquireMicros;
+
         static unsigned _maxPerHost;
     };
 
@@ -151,6 +182,25 @@ namespace mongo {
 
         void release(const string& host, DBClientBase *c);
 
+        /**
+         * Sets the number of idle connections kept per host, 0 for PoolForHost's default.
+         */
+        void setMaxPoolSize( unsigned max );
+        unsigned getMaxPoolSize();
+
+        /**
+         * Sets the number of idle connections the background task keeps open to every host
+         * this pool has connected to, so that requests don't wait on connection setup.
+         */
+        void setMinIdlePerHost( unsigned min );
+        unsigned getMinIdlePerHost();
+
+        /**
+         * Opens connections to host until the pool has getMinIdlePerHost() of them available.
+         * Failures to connect are logged, not thrown.
+         */
+        void warmUp( const string& host , double socketTimeout = 0 );
+
         void addHook( DBConnectionHook * hook ); // we take ownership
         void appendInfo( BSONObjBuilder& b );
 
@@ -184,9 +234,18 @@ namespace mongo {
     private:
         DBConnectionPool( DBConnectionPool& p );
         
-        DBClientBase* _get( const string& ident , double socketTimeout );
+        DBClientBase* _get( const string& ident , double socketTimeout , const Timer& waited );
 
-        DBClientBase* _finishCreate( const string& ident , double socketTimeout, DBClientBase* conn );
+        DBClientBase* _finishCreate( const string& ident , double socketTimeout, DBClientBase* conn ,
+                                     const Timer& waited );
+
+        /** @return the max pool size to use, with _mutex held */
+        unsigned _maxPoolSizeLocked() const;
+
+        /** pings the idle connections and tops the pools up to _minIdlePerHost */
+        void _checkIdleConnections();
+        void _warmUpPools();
+        void _warmUp( const string& ident , double socketTimeout , int count );
         
         struct PoolKey {
             PoolKey( const std::string& i , double t ) : ident( i ) , timeout( t ) {}
@@ -205,6 +264,9 @@ namespace mongo {
         
         PoolMap _pools;
 
+        unsigned _maxPoolSize;
+        unsigned _minIdlePerHost;
+
         // pointers owned by me, right now they leak on shutdown
         // _hooks itself also leaks because it creates a shutdown race condition
         list<DBConnectionHook*> * _hooks; 
@@ -35,7 +35,12 @@ namespace mongo {
            the QueryOption_AwaitData option. if it doesn't, a repl slave client should sleep
         a little between getMore's.
         */
-        ResultFlag_AwaitCapable = 8
+        ResultFlag_AwaitCapable = 8,
+
+        /* the documents of a getMore reply on the oplog are snappy compressed, as asked for
+           with QueryOption_CompressedOplogReplies.  only mongod's own oplog readers ask.
+        */
+        ResultFlag_Compressed = 16
     };
 
 }
@@ -240,6 +240,7 @@ namespace mongo {
     const BSONField<BSONObj> Query::ReadPrefField("$readPreference");
     const BSONField<string> Query::ReadPrefModeField("mode");
     const BSONField<BSONArray> Query::ReadPrefTagsField("tags");
+    const BSONField<bool> Query::ReadPrefHedgeField("hedge");
 
     Query::Query( const string &json ) : obj( fromjson( json ) ) {}
 
@@ -911,10 +912,36 @@ namespace mongo {
         int sslModeVal = sslGlobalParams.sslMode.load();
         if (sslModeVal == SSLGlobalParams::SSLMode_preferSSL ||
             sslModeVal == SSLGlobalParams::SSLMode_requireSSL) {
-            return p->secure( sslManager(), _server.host() );
+            if ( !p->secure( sslManager(), _server.host() ) )
+                return false;
         }
 #endif
 
+        if ( _messageCompression ) {
+            _failed = false;
+            BSONObj info;
+            try {
+                runCommand( "admin",
+                            BSON( "isMaster" << 1 << "compression" << BSON_ARRAY( "snappy" ) ),
+                            info );
+            }
+            catch ( SocketException& e ) {
+                errmsg = str::stream() << "couldn't connect to server " << _server.toString()
+                                       << ": " << e.toString();
+                _failed = true;
+                return false;
+            }
+
+            // servers that don't know the field leave it out
+            BSONElement compression = info["compression"];
+            if ( compression.type() == Array ) {
+                BSONForEach( e, compression.Obj() ) {
+                    if ( e.type() == String && e.String() == "snappy" )
+                        p->setCompressMessages( true );
+                }
+            }
+        }
+
         return true;
     }
 
@@ -1459,6 +1486,7 @@ namespace mongo {
 
     AtomicUInt DBClientConnection::_numConnections;
     bool DBClientConnection::_lazyKillCursor = true;
+    bool DBClientConnection::_messageCompression = false;
 
 
     bool serverAlive( const string &uri ) {
@@ -32,7 +32,9 @@
 #include "mongo/db/json.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/mutex.h" // for StaticObserver
+#include "mongo/util/net/socket_poll.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -229,9 +231,9 @@ namespace mongo {
      * @param nodes the nodes to select from
      * @param readPreferenceTag the tags to use for choosing the right node
      * @param secOnly never select a primary if true
-     * @param localThresholdMillis the exclusive upper bound of ping time to be
-     *     considered as a local node. Local nodes are favored over non-local
-     *     nodes if multiple nodes matches the other criteria.
+     * @param localThresholdMillis how much more latency than the fastest eligible node
+     *     a node may have to be considered a local node. Local nodes are favored over
+     *     non-local nodes if multiple nodes matches the other criteria.
      * @param lastHost the last host returned (mainly used for doing round-robin).
      *     Will be overwritten with the newly returned host if not empty. Should
      *     never be NULL.
@@ -250,6 +252,16 @@ namespace mongo {
                             bool* isPrimarySelected) {
         HostAndPort fallbackHost;
 
+        // The latency window is relative to the fastest eligible node.
+        int fastestMillis = std::numeric_limits<int>::max();
+        for (size_t x = 0; x < nodes.size(); x++) {
+            const ReplicaSetMonitor::Node& node = nodes[x];
+            if (node.ok && (!secOnly || node.okForSecondaryQueries()) &&
+                    node.matchesTag(readPreferenceTag)) {
+                fastestMillis = std::min(fastestMillis, node.latencyMillis());
+            }
+        }
+
         // Implicit: start from index 0 if lastHost doesn't exist anymore
         size_t nextNodeIndex = 0;
 
@@ -284,10 +296,10 @@ namespace mongo {
                 fallbackHost = node.addr;
                 *isPrimarySelected = node.ismaster;
 
-                if (node.isLocalSecondary(localThresholdMillis)) {
+                if (node.isLocalSecondary(fastestMillis, localThresholdMillis)) {
                     // found a local node.  return early.
                     LOG(2) << "dbclient_rs selecting local secondary " << fallbackHost
-                                      << ", ping time: " << node.pingTimeMillis << endl;
+                                      << ", latency: " << node.latencyMillis() << "ms" << endl;
                     *lastHost = fallbackHost;
                     return fallbackHost;
                 }
@@ -369,6 +381,8 @@ namespace mongo {
                 uasserted(16383, str::stream() << "Unknown read preference mode: " << mode);
             }
 
+            const bool hedge = prefDoc[Query::ReadPrefHedgeField.name()].trueValue();
+
             if (prefDoc.hasField(Query::ReadPrefTagsField.name())) {
                 const BSONElement& tagsElem = prefDoc[Query::ReadPrefTagsField.name()];
                 uassert(16385, "tags for read preference should be an array",
@@ -380,14 +394,45 @@ namespace mongo {
                             tags.getCurrentTag().isEmpty());
                 }
 
-                return new ReadPreferenceSetting(pref, tags);
+                return new ReadPreferenceSetting(pref, tags, hedge);
             }
+
+            TagSet tags(BSON_ARRAY(BSONObj()));
+            return new ReadPreferenceSetting(pref, tags, hedge);
         }
 
         TagSet tags(BSON_ARRAY(BSONObj()));
         return new ReadPreferenceSetting(pref, tags);
     }
 
+    /**
+     * Waits up to timeoutMillis (forever if negative) for a reply to start arriving on one of
+     * the n connections.
+     *
+     * @return the index of the first connection with something to read, -1 on timeout.
+     */
+    int waitForReply(DBClientConnection* const* conns, size_t n, int timeoutMillis) {
+        pollfd fds[2];
+        verify(n <= sizeof(fds) / sizeof(fds[0]));
+        for (size_t i = 0; i < n; i++) {
+            fds[i].fd = conns[i]->port().psock->rawFD();
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+
+        if (socketPoll(fds, n, timeoutMillis) <= 0) {
+            return -1;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            // errors and hangups count too: the receive reports them
+            if (fds[i].revents) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
     /**
      * @return the connection associated with the monitor node. Will also attempt
      *     to establish connection if NULL or broken in background.
@@ -674,6 +719,12 @@ namespace mongo {
         HostAndPort fallbackNode;
         scoped_lock lk( _lock );
 
+        int fastestMillis = std::numeric_limits<int>::max();
+        for ( size_t i = 0; i < _nodes.size(); ++i ) {
+            if ( static_cast<int>( i ) != _master && _nodes[i].okForSecondaryQueries() )
+                fastestMillis = std::min( fastestMillis, _nodes[i].latencyMillis() );
+        }
+
         for ( size_t itNode = 0; itNode < _nodes.size(); ++itNode ) {
             _nextSlave = ( _nextSlave + 1 ) % _nodes.size();
             if ( _nextSlave != _master ) {
@@ -682,11 +733,12 @@ namespace mongo {
                     fallbackNode = _nodes[ _nextSlave ].addr;
                     if ( ! preferLocal )
                         return fallbackNode;
-                    else if ( _nodes[ _nextSlave ].isLocalSecondary( _localThresholdMillis ) ) {
+                    else if ( _nodes[ _nextSlave ].isLocalSecondary( fastestMillis,
+                                                                      _localThresholdMillis ) ) {
                         // found a local slave.  return early.
                         LOG(2) << "dbclient_rs getSlave found local secondary for queries: "
-                               << _nextSlave << ", ping time: "
-                               << _nodes[ _nextSlave ].pingTimeMillis << endl;
+                               << _nextSlave << ", latency: "
+                               << _nodes[ _nextSlave ].latencyMillis() << "ms" << endl;
                         return fallbackNode;
                     }
                 }
@@ -723,6 +775,51 @@ namespace mongo {
         }
     }
 
+    void ReplicaSetMonitor::notifyOpLatency( const HostAndPort& host, long long micros ) {
+        scoped_lock lk( _lock );
+        int x = _find_inlock( host.toString() );
+        if ( x >= 0 ) {
+            _nodes[x].noteOpLatency( micros );
+        }
+    }
+
+    long long ReplicaSetMonitor::getSlowOpMicros( const HostAndPort& host ) const {
+        scoped_lock lk( _lock );
+        int x = _find_inlock( host.toString() );
+        return x >= 0 ? _nodes[x].slowOpMicros() : 0;
+    }
+
+    bool ReplicaSetMonitor::isHostWithinLatencyWindow( const HostAndPort& host,
+                                                       ReadPreference preference,
+                                                       const TagSet* tags ) const {
+        scoped_lock lk( _lock );
+        int fastestMillis = std::numeric_limits<int>::max();
+        const Node* hostNode = NULL;
+        for ( vector<Node>::const_iterator iter = _nodes.begin(); iter != _nodes.end(); ++iter ) {
+            if ( !iter->isCompatible( preference, tags ) )
+                continue;
+            fastestMillis = std::min( fastestMillis, iter->latencyMillis() );
+            if ( iter->addr == host )
+                hostNode = &*iter;
+        }
+        return hostNode && hostNode->isLocalSecondary( fastestMillis, _localThresholdMillis );
+    }
+
+    HostAndPort ReplicaSetMonitor::selectHedgeNode( ReadPreference preference,
+                                                    const TagSet* tags,
+                                                    const HostAndPort& exclude ) const {
+        scoped_lock lk( _lock );
+        const Node* best = NULL;
+        for ( vector<Node>::const_iterator iter = _nodes.begin(); iter != _nodes.end(); ++iter ) {
+            if ( iter->addr == exclude || !iter->okForSecondaryQueries() ||
+                    !iter->isCompatible( preference, tags ) )
+                continue;
+            if ( !best || iter->latencyMillis() < best->latencyMillis() )
+                best = &*iter;
+        }
+        return best ? best->addr : HostAndPort();
+    }
+
     NodeDiff ReplicaSetMonitor::_getHostDiff_inlock( const BSONObj& hostList ){
 
         NodeDiff diff;
@@ -915,6 +1012,14 @@ namespace mongo {
                     node.pingTimeMillis += (commandTime - node.pingTimeMillis) / 4;
                 }
 
+                // Pull the operation latency towards the ping time, so that a node that reads
+                // were steered away from while it was slow gets tried again later.
+                if (node.opLatencyMicros > 0) {
+                    node.opLatencyMicros +=
+                            (node.pingTimeMillis * 1000LL - node.opLatencyMicros) / 4;
+                    node.opLatencyMicros = std::max(node.opLatencyMicros, 1LL);
+                }
+
                 node.hidden = o["hidden"].trueValue();
                 node.secondary = o["secondary"].trueValue();
                 node.ismaster = o["ismaster"].trueValue();
@@ -1088,6 +1193,7 @@ namespace mongo {
             builder.append("hidden", node.hidden);
             builder.append("secondary", node.secondary);
             builder.append("pingTimeMillis", node.pingTimeMillis);
+            builder.append("opLatencyMicros", node.opLatencyMicros);
 
             const BSONElement& tagElem = node.lastIsMaster["tags"];
             if (tagElem.ok() && tagElem.isABSONObj()) {
@@ -1377,6 +1483,20 @@ namespace mongo {
         return false;
     }
 
+    void ReplicaSetMonitor::Node::noteOpLatency(long long micros) {
+        if (opLatencyMicros == 0) {
+            opLatencyMicros = std::max(micros, 1LL);
+            opLatencyDeviationMicros = micros / 2;
+            return;
+        }
+
+        // smoothed like TCP round trip times: 1/8th of the delta for the average, 1/4th
+        // for the deviation
+        const long long delta = micros - opLatencyMicros;
+        opLatencyMicros = std::max(opLatencyMicros + delta / 8, 1LL);
+        opLatencyDeviationMicros += (std::abs(delta) - opLatencyDeviationMicros) / 4;
+    }
+
     BSONObj ReplicaSetMonitor::Node::toBSON() const {
         BSONObjBuilder builder;
         builder.append( "addr", addr.toString() );
@@ -1509,6 +1629,16 @@ namespace mongo {
             return false;
         }
 
+        // Stick with the last secondary only while it is among the fastest compatible nodes.
+        if (_lastSlaveOkConn && _lastSlaveOkConn != _master &&
+                !monitor->isHostWithinLatencyWindow(_lastSlaveOkHost, readPref->pref,
+                                                    &readPref->tags)) {
+            LOG(3) << "dbclient_rs last used node " << _lastSlaveOkHost
+                   << " is no longer within the latency window" << endl;
+            invalidateLastSlaveOkCache();
+            return false;
+        }
+
         return _lastSlaveOkConn && _lastReadPref && _lastReadPref->equals(*readPref);
     }
 
@@ -1646,9 +1776,18 @@ namespace mongo {
                         break;
                     }
 
+                    if (readPref->hedge && conn != _master.get() &&
+                            !(queryOptions & (QueryOption_Exhaust | QueryOption_CursorTailable))) {
+                        return checkSlaveQueryResult(_hedgedQuery(*readPref, ns, query,
+                                nToReturn, nToSkip, fieldsToReturn, queryOptions, batchSize));
+                    }
+
+                    const HostAndPort host = _lastSlaveOkHost;
+                    Timer timer;
                     auto_ptr<DBClientCursor> cursor = conn->query(ns, query,
                             nToReturn, nToSkip, fieldsToReturn, queryOptions,
                             batchSize);
+                    _getMonitor()->notifyOpLatency(host, timer.micros());
 
                     return checkSlaveQueryResult(cursor);
                 }
@@ -1706,7 +1845,17 @@ namespace mongo {
                         break;
                     }
 
-                    return conn->findOne(ns,query,fieldsToReturn,queryOptions);
+                    if (readPref->hedge && conn != _master.get()) {
+                        // goes through query(), which does the hedging
+                        return DBClientBase::findOne(ns, query, fieldsToReturn, queryOptions);
+                    }
+
+                    const HostAndPort host = _lastSlaveOkHost;
+                    Timer timer;
+                    BSONObj result = conn->findOne(ns,query,fieldsToReturn,queryOptions);
+                    _getMonitor()->notifyOpLatency(host, timer.micros());
+
+                    return result;
                 }
                 catch ( const DBException &dbExcep ) {
                     StringBuilder errMsgBuilder;
@@ -1774,6 +1923,87 @@ namespace mongo {
         return result;
     }
 
+    auto_ptr<DBClientCursor> DBClientReplicaSet::_hedgedQuery(const ReadPreferenceSetting& readPref,
+                                                              const string& ns,
+                                                              const Query& query,
+                                                              int nToReturn,
+                                                              int nToSkip,
+                                                              const BSONObj* fieldsToReturn,
+                                                              int queryOptions,
+                                                              int batchSize) {
+        ReplicaSetMonitorPtr monitor = _getMonitor();
+        const HostAndPort host = _lastSlaveOkHost;
+        DBClientConnection* conn = _lastSlaveOkConn.get();
+        const long long slowMicros = monitor->getSlowOpMicros(host);
+
+        const unsigned long long startMicros = curTimeMicros64();
+        auto_ptr<DBClientCursor> cursor(new DBClientCursor(conn, ns, query.obj, nToReturn,
+                nToSkip, fieldsToReturn, queryOptions, batchSize));
+        cursor->initLazy();
+
+        // Nothing to go on, or the reply came in time.
+        if (slowMicros == 0 || !isPollSupported() ||
+                waitForReply(&conn, 1, static_cast<int>(slowMicros / 1000) + 1) >= 0) {
+            return _finishLazyQuery(cursor, host, startMicros);
+        }
+
+        const HostAndPort hedgeHost = monitor->selectHedgeNode(readPref.pref, &readPref.tags,
+                                                               host);
+        if (hedgeHost.empty()) {
+            return _finishLazyQuery(cursor, host, startMicros);
+        }
+
+        string errmsg;
+        ConnectionString connStr(hedgeHost);
+        auto_ptr<DBClientConnection> hedgeConn(dynamic_cast<DBClientConnection*>(
+                connStr.connect(errmsg, _so_timeout)));
+        if (hedgeConn.get() == NULL) {
+            LOG(1) << "dbclient_rs could not connect to " << hedgeHost
+                   << " to hedge a read: " << errmsg << endl;
+            return _finishLazyQuery(cursor, host, startMicros);
+        }
+        hedgeConn->setReplSetClientCallback(this);
+        _auth(hedgeConn.get());
+
+        LOG(2) << "dbclient_rs no reply from " << host << " in " << slowMicros
+               << " micros, hedging read on " << hedgeHost << endl;
+
+        const unsigned long long hedgeStartMicros = curTimeMicros64();
+        auto_ptr<DBClientCursor> hedgeCursor(new DBClientCursor(hedgeConn.get(), ns, query.obj,
+                nToReturn, nToSkip, fieldsToReturn, queryOptions, batchSize));
+        hedgeCursor->initLazy();
+
+        DBClientConnection* const conns[] = { conn, hedgeConn.get() };
+        const int timeoutMillis = _so_timeout > 0 ? static_cast<int>(_so_timeout * 1000) : -1;
+        if (waitForReply(conns, 2, timeoutMillis) != 1) {
+            // The original node won (or neither did, and its receive will time out); the hedge
+            // connection goes, reply and all.
+            hedgeCursor.reset();
+            return _finishLazyQuery(cursor, host, startMicros);
+        }
+
+        // The slow node only gets a lower bound of its latency, which is enough to steer the
+        // next reads away from it.
+        monitor->notifyOpLatency(host, curTimeMicros64() - startMicros);
+        cursor.reset();
+
+        // Its reply is still to come, so the slow node's connection can't be used again.
+        _lastSlaveOkConn.reset(hedgeConn.release());
+        _lastSlaveOkHost = hedgeHost;
+        return _finishLazyQuery(hedgeCursor, hedgeHost, hedgeStartMicros);
+    }
+
+    auto_ptr<DBClientCursor> DBClientReplicaSet::_finishLazyQuery(auto_ptr<DBClientCursor> cursor,
+                                                                  const HostAndPort& host,
+                                                                  unsigned long long startMicros) {
+        bool retry = false;
+        if (!cursor->initLazyFinish(retry)) {
+            return auto_ptr<DBClientCursor>();
+        }
+        _getMonitor()->notifyOpLatency(host, curTimeMicros64() - startMicros);
+        return cursor;
+    }
+
     void DBClientReplicaSet::isntSecondary() {
         log() << "slave no longer has secondary status: " << _lastSlaveOkHost << endl;
         // Failover to next slave
@@ -2183,6 +2413,8 @@ namespace mongo {
         BSONObjBuilder bob;
         bob.append( "pref", readPrefToString( pref ) );
         bob.append( "tags", tags.getTagBSON() );
+        if ( hedge )
+            bob.append( "hedge", true );
         return bob.obj();
     }
 }
@@ -62,7 +62,9 @@ namespace mongo {
                 ismaster(false),
                 secondary( false ),
                 hidden( false ),
-                pingTimeMillis( 0 ) {
+                pingTimeMillis( 0 ),
+                opLatencyMicros( 0 ),
+                opLatencyDeviationMicros( 0 ) {
             }
 
             bool okForSecondaryQueries() const {
@@ -91,11 +93,37 @@ namespace mongo {
             bool matchesTag(const BSONObj& tag) const;
 
             /**
-             * @param  threshold  max ping time (in ms) to be considered local
-             * @return true if node is a local secondary, and can handle queries
+             * @return the expected latency, in ms, of an operation on this node: the moving
+             *     average of the operations clients have timed, or the ping time until they
+             *     have timed some.
+             */
+            int latencyMillis() const {
+                return opLatencyMicros > 0 ? static_cast<int>( opLatencyMicros / 1000 ) :
+                                             pingTimeMillis;
+            }
+
+            /**
+             * @param  fastestMillis  the latency of the fastest eligible node
+             * @param  threshold  how much slower than the fastest a node may be to be local
+             * @return true if node is local, that is within the latency window
              **/
-            bool isLocalSecondary( const int threshold ) const {
-                return pingTimeMillis < threshold;
+            bool isLocalSecondary( const int fastestMillis, const int threshold ) const {
+                return latencyMillis() < fastestMillis + threshold;
+            }
+
+            /**
+             * Adds the time a client took for an operation on this node to its moving
+             * estimates of operation latency.
+             */
+            void noteOpLatency( long long micros );
+
+            /**
+             * @return the latency, in micros, that operations on this node rarely exceed: the
+             *     moving average plus twice the moving mean deviation, roughly the 95th
+             *     percentile.  0 if no operations have been timed.
+             */
+            long long slowOpMicros() const {
+                return opLatencyMicros > 0 ? opLatencyMicros + 2 * opLatencyDeviationMicros : 0;
             }
 
             /**
@@ -131,6 +159,10 @@ namespace mongo {
 
             int pingTimeMillis;
 
+            // moving average and mean deviation of the operations timed by clients, 0 if none
+            long long opLatencyMicros;
+            long long opLatencyDeviationMicros;
+
         };
 
         static const double SOCKET_TIMEOUT_SECS;
@@ -141,9 +173,9 @@ namespace mongo {
          * @param nodes the nodes to select from
          * @param preference the read mode to use
          * @param tags the tags used for filtering nodes
-         * @param localThresholdMillis the exclusive upper bound of ping time to be
-         *     considered as a local node. Local nodes are favored over non-local
-         *     nodes if multiple nodes matches the other criteria.
+         * @param localThresholdMillis how much more latency than the fastest matching node a
+         *     node may have to be considered a local node. Local nodes are favored over
+         *     non-local nodes if multiple nodes matches the other criteria.
          * @param lastHost the host used in the last successful request. This is used for
          *     selecting a different node as much as possible, by doing a simple round
          *     robin, starting from the node next to this lastHost. This will be overwritten
@@ -180,6 +212,34 @@ namespace mongo {
                                        TagSet* tags,
                                        bool* isPrimarySelected);
 
+        /**
+         * Selects a secondary, other than exclude, compatible with the preference and tags, to
+         * send a hedged read to: the one with the lowest latency.
+         *
+         * @return the host object of the node selected, or an empty host if there is none.
+         */
+        HostAndPort selectHedgeNode(ReadPreference preference,
+                                    const TagSet* tags,
+                                    const HostAndPort& exclude) const;
+
+        /**
+         * @return true if host is compatible with the preference and tags and its latency is
+         *     within localThresholdMillis of the fastest compatible node.
+         */
+        bool isHostWithinLatencyWindow(const HostAndPort& host,
+                                       ReadPreference preference,
+                                       const TagSet* tags) const;
+
+        /**
+         * Notes that an operation on host took micros, from sending it to its reply.
+         */
+        void notifyOpLatency(const HostAndPort& host, long long micros);
+
+        /**
+         * @return the Node::slowOpMicros() of host, 0 if it is not part of the set.
+         */
+        long long getSlowOpMicros(const HostAndPort& host) const;
+
         /**
          * Creates a new ReplicaSetMonitor, if it doesn't already exist.
          */
@@ -551,6 +611,32 @@ namespace mongo {
          */
         DBClientConnection* selectNodeUsingTags(shared_ptr<ReadPreferenceSetting> readPref);
 
+        /**
+         * Sends the query to the last slaveOk connection, a secondary, and if no reply has
+         * come in by the time that node usually replies, to the fastest other compatible
+         * secondary too.  The cursor is made on whichever replies first, which becomes the
+         * last slaveOk connection; the other connection, with a reply still to come, is
+         * dropped.
+         */
+        auto_ptr<DBClientCursor> _hedgedQuery(const ReadPreferenceSetting& readPref,
+                                              const string& ns,
+                                              const Query& query,
+                                              int nToReturn,
+                                              int nToSkip,
+                                              const BSONObj* fieldsToReturn,
+                                              int queryOptions,
+                                              int batchSize);
+
+        /**
+         * Receives the reply to a query sent with DBClientCursor::initLazy to host, and notes
+         * the time since startMicros as the latency of host.
+         *
+         * @return the cursor, or NULL if no reply was received.
+         */
+        auto_ptr<DBClientCursor> _finishLazyQuery(auto_ptr<DBClientCursor> cursor,
+                                                  const HostAndPort& host,
+                                                  unsigned long long startMicros);
+
         /**
          * @return true if the last host used in the last slaveOk query is still in the
          * set and can be used for the given read preference.
@@ -703,18 +789,21 @@ namespace mongo {
          *     tag set will have this in a reset state (meaning, this
          *     object's copy of tag will have the iterator in the initial
          *     position).
+         * @param hedge whether queries sent to a secondary that is slow to reply may be
+         *     sent to a second secondary as well.
          */
-        ReadPreferenceSetting(ReadPreference pref, const TagSet& tag):
-            pref(pref), tags(tag) {
+        ReadPreferenceSetting(ReadPreference pref, const TagSet& tag, bool hedge = false):
+            pref(pref), tags(tag), hedge(hedge) {
         }
 
         inline bool equals(const ReadPreferenceSetting& other) const {
-            return pref == other.pref && tags.equals(other.tags);
+            return pref == other.pref && tags.equals(other.tags) && hedge == other.hedge;
         }
 
         BSONObj toBSON() const;
 
         const ReadPreference pref;
         TagSet tags;
+        const bool hedge;
     };
 }
@@ -115,9 +115,7 @@ namespace mongo {
         return ok;
     }
 
-    void DBClientCursor::requestMore() {
-        verify( cursorId && batch.pos == batch.nReturned );
-
+    void DBClientCursor::_assembleGetMore( Message& toSend ) {
         if (haveLimit) {
             nToReturn -= batch.nReturned;
             verify(nToReturn > 0);
@@ -128,10 +126,50 @@ namespace mongo {
         b.appendNum(nextBatchSize());
         b.appendNum(cursorId);
 
-        Message toSend;
         toSend.setData(dbGetMore, b.buf(), b.len());
+    }
+
+    void DBClientCursor::requestMoreLazy() {
+        if ( ! _putBack.empty() || batch.pos < batch.nReturned )
+            return;
+        _sayGetMore();
+    }
+
+    void DBClientCursor::_sayGetMore() {
+        if ( _getMorePending || ! cursorId || ! _client || ! _client->lazySupported() )
+            return;
+        // the limit is reached with this batch
+        if ( haveLimit && batch.nReturned >= nToReturn )
+            return;
+        if ( opts & QueryOption_Exhaust )
+            return;
+
+        Message toSend;
+        _assembleGetMore( toSend );
+        _client->say( toSend );
+        _getMorePending = true;
+    }
+
+    void DBClientCursor::requestMore() {
+        verify( cursorId && batch.pos == batch.nReturned );
+
         auto_ptr<Message> response(new Message());
 
+        if ( _getMorePending ) {
+            // the getMore went out in requestMoreLazy(), only the reply is left to read
+            verify( _client );
+            _getMorePending = false;
+            if ( ! _client->recv( *response ) ) {
+                uasserted( 17298, "recv failed receiving a prefetched getMore reply" );
+            }
+            this->batch.m = response;
+            dataReceived();
+            return;
+        }
+
+        Message toSend;
+        _assembleGetMore( toSend );
+
         if ( _client ) {
             _client->call( toSend, *response );
             this->batch.m = response;
@@ -218,7 +256,10 @@ namespace mongo {
         if ( cursorId == 0 )
             return false;
 
-        requestMore();
+        if ( opts & QueryOption_Exhaust )
+            exhaustReceiveMore();
+        else
+            requestMore();
         return batch.pos < batch.nReturned;
     }
 
@@ -235,6 +276,13 @@ namespace mongo {
         batch.pos++;
         BSONObj o(batch.data);
         batch.data += o.objsize();
+
+        // The reply is read by requestMore() once this batch is used up; getting to it first
+        // would overwrite the batch 'o' points into.  Not with a limit, which the getMore
+        // takes this batch off before it has been read.
+        if ( _prefetch && ! _getMorePending && batch.pos * 2 >= batch.nReturned &&
+             ! haveLimit && ! ( opts & QueryOption_CursorTailable ) )
+            _sayGetMore();
         /* todo would be good to make data null at end of batch for safety */
         return o;
     }
@@ -286,6 +334,7 @@ namespace mongo {
 
     void DBClientCursor::attach( AScopedConnection * conn ) {
         verify( _scopedHost.size() == 0 );
+        verify( ! _getMorePending );
         verify( conn );
         verify( conn->get() );
 
@@ -313,6 +362,21 @@ namespace mongo {
 
         DESTRUCTOR_GUARD (
 
+        if ( _getMorePending && _client ) {
+            // read the reply so the connection can be used for something else; it may also
+            // tell us the cursor is gone already
+            _getMorePending = false;
+            Message response;
+            if ( _client->recv( response ) ) {
+                QueryResult* qr = (QueryResult*) response.singleData();
+                if ( qr->cursorId == 0 )
+                    cursorId = 0;
+            }
+            else {
+                cursorId = 0;
+            }
+        }
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
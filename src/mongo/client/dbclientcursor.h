@@ -120,6 +120,10 @@ namespace mongo {
 
         bool tailable() const { return (opts & QueryOption_CursorTailable) != 0; }
 
+        /** the server sends the batches of an exhaust cursor without waiting to be asked; the
+            connection can be used for nothing else until the cursor is exhausted */
+        bool exhaust() const { return (opts & QueryOption_Exhaust) != 0; }
+
         /** see ResultFlagType (constants.h) for flag values
             mostly these flags are for internal purposes -
             ResultFlag_ErrSet is the possible exception to that
@@ -146,7 +150,9 @@ namespace mongo {
             resultFlags(0),
             cursorId(),
             _ownCursor( true ),
-            wasError( false ) {
+            wasError( false ),
+            _getMorePending( false ),
+            _prefetch( false ) {
             _finishConsInit();
         }
 
@@ -162,7 +168,9 @@ namespace mongo {
             resultFlags(0),
             cursorId(_cursorId),
             _ownCursor(true),
-            wasError(false) {
+            wasError(false),
+            _getMorePending(false),
+            _prefetch(false) {
             _finishConsInit();
         }
 
@@ -201,6 +209,25 @@ namespace mongo {
         void initLazy( bool isRetry = false );
         bool initLazyFinish( bool& retry );
 
+        /**
+         * Sends the getMore for the next batch without waiting for the reply, which the next
+         * more() receives.  Lets a caller reading from several cursors have all of their
+         * getMores in flight at once.  Does nothing unless the current batch is used up, the
+         * cursor is still open and its connection supports lazy requests.
+         */
+        void requestMoreLazy();
+        bool getMorePending() const { return _getMorePending; }
+
+        /**
+         * With prefetch on, the getMore for the next batch goes out once half of the current
+         * batch has been read, so the server works on it while the caller goes through the rest;
+         * at most one batch is ever waiting.  The connection must not be used for anything else
+         * while the cursor is open, and the cursor can't be attach()ed.  Has no effect on
+         * tailable, exhaust and limited cursors, or on connections that don't support lazy
+         * requests.
+         */
+        void setPrefetch( bool prefetch ) { _prefetch = prefetch; }
+
         class Batch : boost::noncopyable { 
             friend class DBClientCursor;
             auto_ptr<Message> m;
@@ -236,10 +263,13 @@ namespace mongo {
         string _scopedHost;
         string _lazyHost;
         bool wasError;
+        bool _getMorePending; // see requestMoreLazy()
+        bool _prefetch; // see setPrefetch()
 
         void dataReceived() { bool retry; string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, string& lazyHost );
         void requestMore();
+        void _sayGetMore(); // for requestMoreLazy() and prefetch
         void exhaustReceiveMore(); // for exhaust
 
         // Don't call from a virtual function
@@ -251,6 +281,7 @@ namespace mongo {
 
         // init pieces
         void _assembleInit( Message& toSend );
+        void _assembleGetMore( Message& toSend );
     };
 
     /** iterate over objects in current batch only - will not cause a network call
@@ -83,6 +83,12 @@ namespace mongo {
          */
         QueryOption_PartialResults = 1 << 7 ,
 
+        /** For replication: getMores on the oplog may reply with their documents compressed,
+            marked with ResultFlag_Compressed.  Servers that do not know it reply as usual.
+            Not in QueryOption_AllSupported, as the client library cannot uncompress replies.
+        */
+        QueryOption_CompressedOplogReplies = 1 << 8,
+
         QueryOption_AllSupported = QueryOption_CursorTailable | QueryOption_SlaveOk | QueryOption_OplogReplay | QueryOption_NoCursorTimeout | QueryOption_AwaitData | QueryOption_Exhaust | QueryOption_PartialResults
 
     };
@@ -332,6 +338,7 @@ namespace mongo {
         static const BSONField<BSONObj> ReadPrefField;
         static const BSONField<std::string> ReadPrefModeField;
         static const BSONField<BSONArray> ReadPrefTagsField;
+        static const BSONField<bool> ReadPrefHedgeField;
 
         BSONObj obj;
         Query() : obj(BSONObj()) { }
@@ -1280,6 +1287,13 @@ namespace mongo {
         static void setLazyKillCursor( bool lazy ) { _lazyKillCursor = lazy; }
         static bool getLazyKillCursor() { return _lazyKillCursor; }
 
+        /**
+         * When set, connections made from then on ask the server in isMaster to compress the
+         * messages on them, and compress theirs too when it agrees.
+         */
+        static void setMessageCompression( bool compress ) { _messageCompression = compress; }
+        static bool getMessageCompression() { return _messageCompression; }
+
         uint64_t getSockCreationMicroSec() const;
 
     protected:
@@ -1306,6 +1320,7 @@ namespace mongo {
 
         static AtomicUInt _numConnections;
         static bool _lazyKillCursor; // lazy means we piggy back kill cursors on next op
+        static bool _messageCompression;
 
 #ifdef MONGO_SSL
         SSLManagerInterface* sslManager();
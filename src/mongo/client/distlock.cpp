@@ -19,9 +19,11 @@
 
 #include "mongo/client/distlock.h"
 
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/thread.hpp>
 
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/s/type_locks.h"
 #include "mongo/s/type_lockpings.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -34,6 +36,56 @@ namespace mongo {
 
     ThreadLocalValue<string> distLockIds("");
 
+namespace {
+
+    struct DistLockStats {
+        DistLockStats() : attempts(0), acquired(0), waits(0), totalWaitMillis(0),
+                          maxWaitMillis(0) {}
+        long long attempts;          // lock_try() calls
+        long long acquired;          // ... that got the lock
+        long long waits;             // ScopedDistributedLock::acquire() calls that got it
+        long long totalWaitMillis;   // ... and how long they took
+        long long maxWaitMillis;
+    };
+
+    SimpleMutex distLockStatsMutex( "distLockStats" );
+    map<string, DistLockStats> distLockStats;
+
+    // Signalled whenever this process releases a distributed lock, so that its own waiters can
+    // retry right away instead of at their next poll.
+    boost::mutex lockReleasedMutex;
+    boost::condition_variable lockReleased;
+    unsigned long long lockReleases = 0;
+
+    // ScopedDistributedLock::acquire() polls this often at first, backing off to its lock try
+    // interval; a lock released by another process is seen sooner when contention is brief.
+    const long long initialLockRetryMillis = 100;
+
+    /** serverStatus( { distLocks : 1 } ), one entry per lock name */
+    class DistLocksSSS : public ServerStatusSection {
+    public:
+        DistLocksSSS() : ServerStatusSection( "distLocks" ) {}
+        virtual bool includeByDefault() const { return false; }
+
+        BSONObj generateSection( const BSONElement& configElement ) const {
+            BSONObjBuilder b;
+            SimpleMutex::scoped_lock lk( distLockStatsMutex );
+            for ( map<string, DistLockStats>::const_iterator i = distLockStats.begin();
+                  i != distLockStats.end(); ++i ) {
+                BSONObjBuilder bb( b.subobjStart( i->first ) );
+                bb.appendNumber( "attempts", i->second.attempts );
+                bb.appendNumber( "acquired", i->second.acquired );
+                bb.appendNumber( "waits", i->second.waits );
+                bb.appendNumber( "totalWaitMillis", i->second.totalWaitMillis );
+                bb.appendNumber( "maxWaitMillis", i->second.maxWaitMillis );
+                bb.done();
+            }
+            return b.obj();
+        }
+    } distLocksSSS;
+
+}  // namespace
+
     /* ==================
      * Module initialization
      */
@@ -555,6 +607,25 @@ namespace mongo {
     // Note:  reenter doesn't actually make this lock re-entrant in the normal sense, since it can still only
     // be unlocked once, instead it is used to verify that the lock is already held.
     bool DistributedLock::lock_try( const string& why , bool reenter, BSONObj * other, double timeout ) {
+        bool got = false;
+        try {
+            got = _lockTry( why, reenter, other, timeout );
+        }
+        catch ( ... ) {
+            SimpleMutex::scoped_lock lk( distLockStatsMutex );
+            distLockStats[_name].attempts++;
+            throw;
+        }
+
+        SimpleMutex::scoped_lock lk( distLockStatsMutex );
+        DistLockStats& stats = distLockStats[_name];
+        stats.attempts++;
+        if ( got )
+            stats.acquired++;
+        return got;
+    }
+
+    bool DistributedLock::_lockTry( const string& why , bool reenter, BSONObj * other, double timeout ) {
 
         // TODO:  Start pinging only when we actually get the lock?
         // If we don't have a thread pinger, make sure we shouldn't have one
@@ -1066,6 +1137,12 @@ namespace mongo {
 
                 LOG( logLvl - 1 ) << "distributed lock '" << lockName << "' unlocked. " << endl;
                 conn.done();
+
+                {
+                    boost::lock_guard<boost::mutex> lk( lockReleasedMutex );
+                    lockReleases++;
+                }
+                lockReleased.notify_all();
                 return;
             }
             catch( UpdateNotTheSame& ) {
@@ -1137,9 +1214,16 @@ namespace mongo {
 
         Timer timer;
         Timer msgTimer;
+        long long retryMillis = std::min(initialLockRetryMillis, _lockTryIntervalMillis);
 
         while (!_acquired && (waitForMillis <= 0 || timer.millis() < waitForMillis)) {
 
+            unsigned long long releasesBefore;
+            {
+                boost::lock_guard<boost::mutex> lk(lockReleasedMutex);
+                releasesBefore = lockReleases;
+            }
+
             string acquireErrMsg;
             _acquired = tryAcquire(&acquireErrMsg);
 
@@ -1159,12 +1243,26 @@ namespace mongo {
                 msgTimer.reset();
             }
 
-            long long timeRemainingMillis = std::max(0LL, waitForMillis - timer.millis());
-            sleepmillis(std::min(_lockTryIntervalMillis, timeRemainingMillis));
+            long long sleepMillis = retryMillis;
+            if (waitForMillis > 0)
+                sleepMillis = std::min(sleepMillis, std::max(0LL, waitForMillis - timer.millis()));
+            retryMillis = std::min(retryMillis * 2, _lockTryIntervalMillis);
+
+            // Wakes early if a lock is released in this process meanwhile.
+            boost::unique_lock<boost::mutex> lk(lockReleasedMutex);
+            if (lockReleases == releasesBefore)
+                lockReleased.timed_wait(lk, boost::posix_time::milliseconds(sleepMillis));
         }
 
         if (_acquired) {
             verify(!_other.isEmpty());
+
+            const long long waitedMillis = timer.millis();
+            SimpleMutex::scoped_lock lk(distLockStatsMutex);
+            DistLockStats& stats = distLockStats[_lock._name];
+            stats.waits++;
+            stats.totalWaitMillis += waitedMillis;
+            stats.maxWaitMillis = std::max(stats.maxWaitMillis, waitedMillis);
             return true;
         }
 
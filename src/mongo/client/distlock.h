@@ -180,6 +180,9 @@ namespace mongo {
 
     private:
 
+        // lock_try() without the bookkeeping for serverStatus
+        bool _lockTry( const string& why , bool reenter, BSONObj * other, double timeout );
+
         void resetLastPing(){ lastPings.setLastPing( _conn, _name, PingData() ); }
         void setLastPing( const PingData& pd ){ lastPings.setLastPing( _conn, _name, pd ); }
         PingData getLastPing(){ return lastPings.getLastPing( _conn, _name ); }
@@ -303,9 +306,10 @@ namespace mongo {
         void unlock();
 
         /**
-         * Tries multiple times to unlock the lock, using the specified lock try interval, until
-         * a certain amount of time has passed.  An error message is immediately returned if the
-         * lock acquisition attempt fails with an error message.
+         * Tries multiple times to acquire the lock, until a certain amount of time has passed.
+         * Tries are more frequent at first, backing off to the lock try interval, and a lock
+         * released by this process triggers one at once.  An error message is immediately
+         * returned if the lock acquisition attempt fails with an error message.
          * waitForMillis = 0 indicates there should only be one attempt to acquire the lock, and
          * no waiting.
          * waitForMillis = -1 indicates we should retry indefinitely.
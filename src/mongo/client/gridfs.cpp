@@ -35,11 +35,42 @@
 #define MIN(a,b) ( (a) < (b) ? (a) : (b) )
 #endif
 
+#ifndef MAX
+#define MAX(a,b) ( (a) > (b) ? (a) : (b) )
+#endif
+
 
 namespace mongo {
 
     const unsigned DEFAULT_CHUNK_SIZE = 256 * 1024;
 
+    // Chunks are inserted in batches of about this many bytes, each batch in one message.
+    const size_t CHUNK_BATCH_BYTES = 8 * 1024 * 1024;
+
+    // Chunks asked of the server per round trip when reading a file.
+    const int CHUNK_READ_BATCH = 32;
+
+namespace {
+
+    /**
+     * Adds 'chunk' to 'batch', inserting the batch once it holds CHUNK_BATCH_BYTES or
+     * 'flush' is set.
+     */
+    void addChunk( DBClientBase& client , const string& ns , vector<BSONObj>& batch ,
+                   size_t& batchBytes , const BSONObj& chunk , bool flush ) {
+        if ( !chunk.isEmpty() ) {
+            batch.push_back( chunk );
+            batchBytes += chunk.objsize();
+        }
+        if ( batch.empty() || ( !flush && batchBytes < CHUNK_BATCH_BYTES ) )
+            return;
+        client.insert( ns , batch );
+        batch.clear();
+        batchBytes = 0;
+    }
+
+}  // namespace
+
     GridFSChunk::GridFSChunk( BSONObj o ) {
         _data = o;
     }
@@ -82,15 +113,18 @@ namespace mongo {
         id.init();
         BSONObj idObj = BSON("_id" << id);
 
+        vector<BSONObj> batch;
+        size_t batchBytes = 0;
         int chunkNumber = 0;
         while (data < end) {
             int chunkLen = MIN(_chunkSize, (unsigned)(end-data));
             GridFSChunk c(idObj, chunkNumber, data, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
+            addChunk( _client , _chunksNS , batch , batchBytes , c._data , false );
 
             chunkNumber++;
             data += chunkLen;
         }
+        addChunk( _client , _chunksNS , batch , batchBytes , BSONObj() , true );
 
         return insertFile(remoteName, id, length, contentType);
     }
@@ -110,6 +144,8 @@ namespace mongo {
         id.init();
         BSONObj idObj = BSON("_id" << id);
 
+        vector<BSONObj> batch;
+        size_t batchBytes = 0;
         int chunkNumber = 0;
         gridfs_offset length = 0;
         while (!feof(fd)) {
@@ -126,12 +162,13 @@ namespace mongo {
             }
 
             GridFSChunk c(idObj, chunkNumber, buf, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
+            addChunk( _client , _chunksNS , batch , batchBytes , c._data , false );
 
             length += chunkLen;
             chunkNumber++;
             delete[] buf;
         }
+        addChunk( _client , _chunksNS , batch , batchBytes , BSONObj() , true );
 
         if (fd != stdin)
             fclose( fd );
@@ -229,18 +266,51 @@ namespace mongo {
 
     gridfs_offset GridFile::write( ostream & out ) const {
         _exists();
+        writeRange( out , 0 , getContentLength() );
+        return getContentLength();
+    }
 
-        const int num = getNumChunks();
+    gridfs_offset GridFile::writeRange( ostream & out , gridfs_offset begin , gridfs_offset end ) const {
+        _exists();
 
-        for ( int i=0; i<num; i++ ) {
-            GridFSChunk c = getChunk( i );
+        end = MIN( end , getContentLength() );
+        if ( begin >= end )
+            return 0;
+
+        const gridfs_offset chunkSize = getChunkSize();
+        const int first = (int)( begin / chunkSize );
+        const int last = (int)( ( end - 1 ) / chunkSize );
+
+        // One query for all the chunks, in order, rather than a findOne per chunk.
+        BSONObjBuilder b;
+        b.appendAs( _obj["_id"] , "files_id" );
+        b.append( "n" , BSON( "$gte" << first << "$lte" << last ) );
+        Query q = Query( b.obj() ).sort( BSON( "files_id" << 1 << "n" << 1 ) );
+        auto_ptr<DBClientCursor> cursor =
+            _grid->_client.query( _grid->_chunksNS , q , 0 , 0 , 0 , 0 ,
+                                  MIN( last - first + 1 , CHUNK_READ_BATCH ) );
+        uassert( 17318 , "couldn't query GridFS chunks" , cursor.get() );
+
+        gridfs_offset written = 0;
+        int n = first;
+        while ( cursor->more() ) {
+            GridFSChunk c( cursor->nextSafe() );
+            uassert( 10014 ,  "chunk is empty!" , c._data["n"].numberInt() == n );
 
             int len;
             const char * data = c.data( len );
-            out.write( data , len );
+            const gridfs_offset chunkBegin = n * chunkSize;
+            const gridfs_offset from = MAX( begin , chunkBegin ) - chunkBegin;
+            const gridfs_offset to = MIN( end , chunkBegin + len ) - chunkBegin;
+            if ( to > from ) {
+                out.write( data + from , to - from );
+                written += to - from;
+            }
+            n++;
         }
+        uassert( 10014 ,  "chunk is empty!" , n == last + 1 );
 
-        return getContentLength();
+        return written;
     }
 
     gridfs_offset GridFile::write( const string& where ) const {
@@ -46,6 +46,7 @@ namespace mongo {
     private:
         BSONObj _data;
         friend class GridFS;
+        friend class GridFile;
     };
 
 
@@ -188,6 +189,13 @@ namespace mongo {
          */
         gridfs_offset write( ostream & out ) const;
 
+        /**
+         * write bytes [begin, end) of the file to the output stream, fetching only the chunks
+         * that hold them.  'end' past the end of the file is taken to be the end of the file.
+         * @return the number of bytes written
+         */
+        gridfs_offset writeRange( ostream & out , gridfs_offset begin , gridfs_offset end ) const;
+
         /**
            write the file to this filename
          */
@@ -1603,10 +1603,22 @@ namespace mongo {
         return false;
     }
 
+    void ParallelSortClusteredCursor::requestMoreLazy() {
+        for ( int i = 0; i < _numServers; i++ ) {
+            DBClientCursor* c = _cursors[i].raw();
+            if ( c )
+                c->requestMoreLazy();
+        }
+    }
+
     BSONObj ParallelSortClusteredCursor::next() {
         BSONObj best = BSONObj();
         int bestFrom = -1;
 
+        // get the getMores of all the shards that ran out in flight together, so we wait for the
+        // slowest shard rather than for each in turn
+        requestMoreLazy();
+
         for( int j = 0; j < _numServers; j++ ){
 
             // Iterate _numServers times, starting one past the last server we used.
@@ -1642,6 +1654,12 @@ namespace mongo {
         uassert( 10019 ,  "no more elements" , ! best.isEmpty() );
         _cursors[bestFrom].next();
 
+        // FilteringClientCursor holds on to the next document, so a shard whose batch just ran
+        // out can fetch the next one while we merge what the others have
+        DBClientCursor* c = _cursors[bestFrom].raw();
+        if ( c )
+            c->requestMoreLazy();
+
         if( _cursors[bestFrom].rawMData() )
             _cursors[bestFrom].rawMData()->pcState->count++;
 
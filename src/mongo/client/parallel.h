@@ -84,6 +84,9 @@ namespace mongo {
         virtual bool more() = 0;
         virtual BSONObj next() = 0;
 
+        /** sends what requests for more results it can ahead of need, without waiting */
+        virtual void requestMoreLazy() {}
+
         static BSONObj concatQuery( const BSONObj& query , const BSONObj& extraFilter );
 
         virtual string type() const = 0;
@@ -344,6 +347,9 @@ namespace mongo {
         virtual BSONObj next();
         virtual string type() const { return "ParallelSort"; }
 
+        /** sends getMores for every shard cursor that has used up its batch, without waiting */
+        virtual void requestMoreLazy();
+
         void fullInit();
         void startInit();
         void finishInit();
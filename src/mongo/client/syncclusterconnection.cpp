@@ -81,21 +81,21 @@ namespace mongo {
     bool SyncClusterConnection::fsync( string& errmsg ) {
         bool ok = true;
         errmsg = "";
-        for ( size_t i=0; i<_conns.size(); i++ ) {
-            string singleErr;
-            try {
-                // this is fsync=true
-                // which with journalling on is a journal commit
-                // without journalling, is a full fsync
-                _conns[i]->simpleCommand( "admin", NULL, "resetError" );
-                singleErr = _conns[i]->getLastError( true );
 
+        // this is fsync=true
+        // which with journalling on is a journal commit
+        // without journalling, is a full fsync
+        vector<BSONObj> results;
+        vector<string> errors;
+        _commandOnAll( "admin", BSON( "resetError" << 1 ), 0, &results, &errors );
+        _commandOnAll( "admin", BSON( "getlasterror" << 1 << "fsync" << 1 ), 0, &results, &errors );
+
+        for ( size_t i=0; i<_conns.size(); i++ ) {
+            string singleErr = errors[i];
+            if ( singleErr.empty() ) {
+                singleErr = getLastErrorString( results[i] );
                 if ( singleErr.size() == 0 )
                     continue;
-
-            }
-            catch ( DBException& e ) {
-                singleErr = e.toString();
             }
             ok = false;
             errmsg += " " + _conns[i]->toString() + ":" + singleErr;
@@ -103,25 +103,54 @@ namespace mongo {
         return ok;
     }
 
-    void SyncClusterConnection::_checkLast() {
-        _lastErrors.clear();
-        vector<string> errors;
+    void SyncClusterConnection::_commandOnAll( const string& dbname, const BSONObj& cmd,
+                                               int options, vector<BSONObj>* results,
+                                               vector<string>* errors ) {
+        const string ns = dbname + ".$cmd";
+        results->assign( _conns.size(), BSONObj() );
+        errors->assign( _conns.size(), "" );
+
+        vector< boost::shared_ptr<DBClientCursor> > cursors( _conns.size() );
+        for ( size_t i=0; i<_conns.size(); i++ ) {
+            try {
+                cursors[i].reset( new DBClientCursor( _conns[i], ns, cmd, -1, 0, NULL,
+                                                      options, 0 ) );
+                cursors[i]->initLazy();
+            }
+            catch ( std::exception& e ) {
+                (*errors)[i] = e.what();
+                cursors[i].reset();
+            }
+        }
 
         for ( size_t i=0; i<_conns.size(); i++ ) {
-            BSONObj res;
-            string err;
+            if ( ! cursors[i] )
+                continue;
             try {
-                if ( ! _conns[i]->runCommand( "admin" , BSON( "getlasterror" << 1 << "fsync" << 1 ) , res ) )
-                    err = "cmd failed: ";
+                bool retry = false;
+                if ( cursors[i]->initLazyFinish( retry ) && cursors[i]->more() )
+                    (*results)[i] = cursors[i]->next().getOwned();
+                else
+                    (*errors)[i] = "no response";
             }
             catch ( std::exception& e ) {
-                err += e.what();
+                (*errors)[i] = e.what();
             }
             catch ( ... ) {
-                err += "unknown failure";
+                (*errors)[i] = "unknown failure";
             }
-            _lastErrors.push_back( res.getOwned() );
-            errors.push_back( err );
+        }
+    }
+
+    void SyncClusterConnection::_checkLast() {
+        vector<string> errors;
+        _commandOnAll( "admin", BSON( "getlasterror" << 1 << "fsync" << 1 ), 0,
+                       &_lastErrors, &errors );
+        for ( size_t i=0; i<errors.size(); i++ ) {
+            if ( ! errors[i].empty() )
+                continue;
+            if ( ! isOk( _lastErrors[i] ) )
+                errors[i] = "cmd failed: ";
         }
 
         verify( _lastErrors.size() == errors.size() && _lastErrors.size() == _conns.size() );
@@ -185,9 +214,8 @@ namespace mongo {
                     throw UserException( PrepareConfigsFailedCode , (string)"SyncClusterConnection::findOne prepare failed: " + errmsg );
 
                 vector<BSONObj> all;
-                for ( size_t i=0; i<_conns.size(); i++ ) {
-                    all.push_back( _conns[i]->findOne( ns , query , 0 , queryOptions ).getOwned() );
-                }
+                vector<string> errors;
+                _commandOnAll( nsToDatabase( ns ) , query.obj , queryOptions , &all , &errors );
 
                 _checkLast();
                 
@@ -196,7 +224,7 @@ namespace mongo {
                     if ( isOk( temp ) )
                         continue;
                     stringstream ss;
-                    ss << "write $cmd failed on a node: " << temp.jsonString();
+                    ss << "write $cmd failed on a node: " << temp.jsonString() << " " << errors[i];
                     ss << " " << _conns[i]->toString();
                     ss << " ns: " << ns;
                     ss << " cmd: " << query.toString();
@@ -352,12 +380,10 @@ namespace mongo {
             throw UserException( 16744, assertMsg + errmsg );
         }
 
-        // We still want one getlasterror per document, even if they're batched.
+        // One message per server.  Going on past a failed document, as the final getlasterror
+        // only checks that the batch got to disk.
         for ( size_t i=0; i<_conns.size(); i++ ) {
-            for ( vector<BSONObj>::const_iterator it = v.begin(); it != v.end(); ++it ) {
-                _conns[i]->insert( ns, *it, flags );
-                _conns[i]->getLastErrorDetailed();
-            }
+            _conns[i]->insert( ns, v, flags | InsertOption_ContinueOnError );
         }
 
         // We issue a final getlasterror, but this time with an fsync.
@@ -122,6 +122,14 @@ namespace mongo {
         auto_ptr<DBClientCursor> _queryOnActive(const string &ns, Query query, int nToReturn, int nToSkip,
                                                 const BSONObj *fieldsToReturn, int queryOptions, int batchSize );
         int _lockType( const string& name );
+
+        /**
+         * Runs 'cmd' on every server, sending it to all of them before waiting on any reply, so
+         * that the servers work on it side by side.  Each server's reply goes in 'results', or if
+         * there is none, the reason in 'errors'.
+         */
+        void _commandOnAll( const string& dbname, const BSONObj& cmd, int options,
+                            vector<BSONObj>* results, vector<string>* errors );
         void _checkLast();
         void _connect( const std::string& host );
 
@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/db/admission_control.h"
+
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_manager.h"
+#include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/dbmessage.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/ticketholder.h"
+
+namespace mongo {
+
+namespace {
+
+    enum Priority { kNormal = 0, kHigh = 1 };
+
+    // 0 is unlimited.  Declared ahead of the parameters, which resize them when set.
+    PriorityTicketHolder readTickets( 0 );
+    PriorityTicketHolder writeTickets( 0 );
+
+    int maxConcurrentReads = 0;
+    int maxConcurrentWrites = 0;
+
+    class MaxConcurrentParameter : public ExportedServerParameter<int> {
+    public:
+        MaxConcurrentParameter( const std::string& name, int* value,
+                                PriorityTicketHolder* tickets ) :
+            ExportedServerParameter<int>( ServerParameterSet::getGlobal(), name, value,
+                                          true, true ),
+            _tickets( tickets ) {}
+
+        virtual Status validate( const int& potentialNewValue ) {
+            if ( potentialNewValue < 0 ) {
+                return Status( ErrorCodes::BadValue,
+                               name() + " must be at least 0 (0 is unlimited)" );
+            }
+            return Status::OK();
+        }
+
+        virtual Status set( const int& newValue ) {
+            Status status = ExportedServerParameter<int>::set( newValue );
+            if ( status.isOK() )
+                _tickets->resize( newValue );
+            return status;
+        }
+
+    private:
+        PriorityTicketHolder* _tickets;
+    };
+
+    MaxConcurrentParameter maxConcurrentReadsParam( "maxConcurrentReads",
+                                                    &maxConcurrentReads, &readTickets );
+    MaxConcurrentParameter maxConcurrentWritesParam( "maxConcurrentWrites",
+                                                     &maxConcurrentWrites, &writeTickets );
+
+    bool isWriteCommand( Message& m ) {
+        DbMessage d( m );
+        QueryMessage q( d );
+        BSONObj cmdObj = q.query;
+        if ( cmdObj.hasField( "$query" ) )
+            cmdObj = cmdObj["$query"].Obj();
+        else if ( cmdObj.hasField( "query" ) && cmdObj["query"].type() == Object )
+            cmdObj = cmdObj["query"].Obj();
+
+        StringData name = cmdObj.firstElementFieldName();
+        return name == "insert" || name == "update" || name == "delete";
+    }
+
+    PriorityTicketHolder* ticketsFor( Message& m, bool isCommand ) {
+        switch ( m.operation() ) {
+        case dbQuery:
+            if ( !isCommand )
+                return &readTickets;
+            return isWriteCommand( m ) ? &writeTickets : NULL;
+        case dbGetMore:
+            return &readTickets;
+        case dbInsert:
+        case dbUpdate:
+        case dbDelete:
+            return &writeTickets;
+        default:
+            return NULL;
+        }
+    }
+
+    Priority priorityOf( Client& client, Message& m ) {
+        StringData db = nsToDatabaseSubstring( m.singleData()->_data + 4 );
+        if ( db == "local" || db == "admin" || db == "config" )
+            return kHigh;
+
+        if ( getGlobalAuthorizationManager()->isAuthEnabled() &&
+             client.getAuthorizationSession()->isAuthorizedForActionsOnResource(
+                     ResourcePattern::forAnyResource(), ActionType::anyAction ) )
+            return kHigh;
+
+        return kNormal;
+    }
+
+    void appendTickets( BSONObjBuilder& b, const PriorityTicketHolder& tickets ) {
+        b.append( "out", tickets.outof() );
+        b.append( "used", tickets.used() );
+        BSONObjBuilder waiting( b.subobjStart( "waiting" ) );
+        waiting.append( "normal", tickets.waiting( kNormal ) );
+        waiting.append( "high", tickets.waiting( kHigh ) );
+        waiting.done();
+        b.appendNumber( "admitted", tickets.admitted() );
+        b.appendNumber( "queued", tickets.queued() );
+        b.appendNumber( "totalQueuedMicros", tickets.queuedMicros() );
+    }
+
+    class AdmissionServerStatusSection : public ServerStatusSection {
+    public:
+        AdmissionServerStatusSection() : ServerStatusSection( "admission" ) {}
+
+        virtual bool includeByDefault() const { return true; }
+
+        BSONObj generateSection( const BSONElement& configElement ) const {
+            BSONObjBuilder b;
+            BSONObjBuilder reads( b.subobjStart( "reads" ) );
+            appendTickets( reads, readTickets );
+            reads.done();
+            BSONObjBuilder writes( b.subobjStart( "writes" ) );
+            appendTickets( writes, writeTickets );
+            writes.done();
+            return b.obj();
+        }
+
+    } admissionServerStatusSection;
+
+} // namespace
+
+    AdmissionTicket::AdmissionTicket( Client& client, Message& m, bool isCommand, bool nested )
+        : _holder( NULL ), _queuedMicros( 0 ) {
+        if ( nested || !client.port() )
+            return;
+
+        PriorityTicketHolder* tickets = ticketsFor( m, isCommand );
+        if ( !tickets )
+            return;
+
+        _queuedMicros = tickets->waitForTicket( priorityOf( client, m ) );
+        _holder = tickets;
+    }
+
+    AdmissionTicket::~AdmissionTicket() {
+        if ( _holder )
+            _holder->release();
+    }
+
+} // namespace mongo
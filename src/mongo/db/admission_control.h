@@ -0,0 +1,64 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+    class Client;
+    class Message;
+    class PriorityTicketHolder;
+
+    /**
+     * Admission control for operations from clients.  Reads and writes each take a ticket from
+     * their own pool, sized by the maxConcurrentReads and maxConcurrentWrites server parameters,
+     * before they go for any lock, so that at saturation the excess queues here instead of on
+     * the lock manager.  Operations on the local, admin and config databases, which is where
+     * replication and cluster bookkeeping run, and operations of internal (__system) users when
+     * auth is on, go ahead of those of other clients.
+     *
+     * Commands other than the insert, update and delete write commands, nested operations, and
+     * operations of threads with no client connection are not limited.
+     */
+    class AdmissionTicket {
+        MONGO_DISALLOW_COPYING(AdmissionTicket);
+    public:
+        AdmissionTicket( Client& client, Message& m, bool isCommand, bool nested );
+        ~AdmissionTicket();
+
+        /** Microseconds spent waiting for the ticket. */
+        long long queuedMicros() const { return _queuedMicros; }
+
+    private:
+        PriorityTicketHolder* _holder;
+        long long _queuedMicros;
+    };
+
+} // namespace mongo
@@ -81,6 +81,7 @@ namespace {
         // Calling add() on the UserSet may return a user that was replaced because it was from the
         // same database.
         User* replacedUser = _authenticatedUsers.add(user);
+        _grantedActionsCache.clear();
         if (replacedUser) {
             getAuthorizationManager().releaseUser(replacedUser);
         }
@@ -98,6 +99,7 @@ namespace {
 
     void AuthorizationSession::logoutDatabase(const std::string& dbname) {
         User* removedUser = _authenticatedUsers.removeByDBName(dbname);
+        _grantedActionsCache.clear();
         if (removedUser) {
             getAuthorizationManager().releaseUser(removedUser);
         }
@@ -121,6 +123,7 @@ namespace {
 
     void AuthorizationSession::grantInternalAuthorization() {
         _authenticatedUsers.add(internalSecurity.user);
+        _grantedActionsCache.clear();
     }
 
     Status AuthorizationSession::checkAuthForQuery(const NamespaceString& ns,
@@ -294,6 +297,7 @@ namespace {
     }
 
     static const int resourceSearchListCapacity = 5;
+    static const size_t grantedActionsCacheCapacity = 1000;
     /**
      * Builds from "target" an exhaustive list of all ResourcePatterns that match "target".
      *
@@ -400,6 +404,7 @@ namespace {
                 case ErrorCodes::OK: {
                     // Success! Replace the old User object with the updated one.
                     fassert(17067, _authenticatedUsers.replaceAt(it, updatedUser) == user);
+                    _grantedActionsCache.clear();
                     authMan.releaseUser(user);
                     LOG(1) << "Updated session cache of user information for " << name;
                     break;
@@ -407,6 +412,7 @@ namespace {
                 case ErrorCodes::UserNotFound: {
                     // User does not exist anymore; remove it from _authenticatedUsers.
                     fassert(17068, _authenticatedUsers.removeAt(it) == user);
+                    _grantedActionsCache.clear();
                     authMan.releaseUser(user);
                     log() << "Removed deleted user " << name <<
                         " from session cache of user information.";
@@ -427,11 +433,6 @@ namespace {
     bool AuthorizationSession::_isAuthorizedForPrivilege(const Privilege& privilege) {
         const ResourcePattern& target(privilege.getResourcePattern());
 
-        ResourcePattern resourceSearchList[resourceSearchListCapacity];
-        const int resourceSearchListLength = buildResourceSearchList(target, resourceSearchList);
-
-        ActionSet unmetRequirements = privilege.getActions();
-
         for (UserSet::iterator it = _authenticatedUsers.begin();
                 it != _authenticatedUsers.end(); ++it) {
             User* user = *it;
@@ -450,9 +451,9 @@ namespace {
                     if (user != updatedUser) {
                         LOG(1) << "Updated session cache for V1 user " << name;
                         fassert(17226, _authenticatedUsers.replaceAt(it, updatedUser) == user);
+                        _grantedActionsCache.clear();
                     }
                     getAuthorizationManager().releaseUser(user);
-                    user = updatedUser;
                 }
                 else if (status != ErrorCodes::UserNotFound) {
                     warning() << "Could not fetch updated user privilege information for V1-style "
@@ -460,17 +461,31 @@ namespace {
                               << status;
                 }
             }
+        }
 
-            for (int i = 0; i < resourceSearchListLength; ++i) {
-                ActionSet userActions = user->getActionsForResource(resourceSearchList[i]);
-                unmetRequirements.removeAllActionsFromSet(userActions);
+        GrantedActionsCache::const_iterator cached = _grantedActionsCache.find(target);
+        if (cached == _grantedActionsCache.end()) {
+            // Sessions touching very many namespaces start over rather than grow without bound.
+            if (_grantedActionsCache.size() >= grantedActionsCacheCapacity)
+                _grantedActionsCache.clear();
+            cached = _grantedActionsCache.insert(
+                    std::make_pair(target, _getGrantedActions(target))).first;
+        }
+        return cached->second.isSupersetOf(privilege.getActions());
+    }
 
-                if (unmetRequirements.empty())
-                    return true;
+    ActionSet AuthorizationSession::_getGrantedActions(const ResourcePattern& target) {
+        ResourcePattern resourceSearchList[resourceSearchListCapacity];
+        const int resourceSearchListLength = buildResourceSearchList(target, resourceSearchList);
+
+        ActionSet granted;
+        for (UserSet::iterator it = _authenticatedUsers.begin();
+                it != _authenticatedUsers.end(); ++it) {
+            for (int i = 0; i < resourceSearchListLength; ++i) {
+                granted.addAllActionsFromSet((*it)->getActionsForResource(resourceSearchList[i]));
             }
         }
-
-        return false;
+        return granted;
     }
 
 } // namespace mongo
@@ -41,6 +41,7 @@
 #include "mongo/db/auth/user_name.h"
 #include "mongo/db/auth/user_set.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
@@ -191,10 +192,20 @@ namespace mongo {
         // lock on the admin database (to update out-of-date user privilege information).
         bool _isAuthorizedForPrivilege(const Privilege& privilege);
 
+        // Returns the actions the authenticated users are granted on "target", through any of the
+        // resource patterns matching it.
+        ActionSet _getGrantedActions(const ResourcePattern& target);
+
         scoped_ptr<AuthzSessionExternalState> _externalState;
 
         // All Users who have been authenticated on this connection
         UserSet _authenticatedUsers;
+
+        // The results of _getGrantedActions() for the resources checked so far.  They hold for the
+        // User objects now in _authenticatedUsers, whose privileges never change, so this is
+        // cleared whenever a user is added, removed or replaced by an up-to-date copy.
+        typedef unordered_map<ResourcePattern, ActionSet> GrantedActionsCache;
+        GrantedActionsCache _grantedActionsCache;
     };
 
 } // namespace mongo
@@ -26,6 +26,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/map_util.h"
+#include "mongo/util/mongoutils/str.h"
 
 #define ASSERT_NULL(EXPR) ASSERT_FALSE(EXPR)
 #define ASSERT_NON_NULL(EXPR) ASSERT_TRUE(EXPR)
@@ -178,6 +179,36 @@ namespace {
                              testFooCollResource, ActionType::collMod));
     }
 
+    TEST_F(AuthorizationSessionTest, ManyResourcesChecked) {
+        ASSERT_OK(managerState->insertPrivilegeDocument("admin",
+                BSON("user" << "spencer" <<
+                     "db" << "test" <<
+                     "credentials" << BSON("MONGODB-CR" << "a") <<
+                     "roles" << BSON_ARRAY(BSON("role" << "read" <<
+                                                "db" << "test"))),
+                BSONObj()));
+        ASSERT_OK(authzSession->addAndAuthorizeUser(UserName("spencer", "test")));
+
+        // More resources than the session remembers decisions for; the answers stay the same.
+        for (int round = 0; round < 2; ++round) {
+            for (int i = 0; i < 1500; ++i) {
+                const std::string coll = mongoutils::str::stream() << "coll" << i;
+                ASSERT_TRUE(authzSession->isAuthorizedForActionsOnResource(
+                                    ResourcePattern::forExactNamespace(
+                                            NamespaceString("test", coll)),
+                                    ActionType::find));
+                ASSERT_FALSE(authzSession->isAuthorizedForActionsOnResource(
+                                     ResourcePattern::forExactNamespace(
+                                             NamespaceString("test", coll)),
+                                     ActionType::insert));
+                ASSERT_FALSE(authzSession->isAuthorizedForActionsOnResource(
+                                     ResourcePattern::forExactNamespace(
+                                             NamespaceString("other", coll)),
+                                     ActionType::find));
+            }
+        }
+    }
+
     TEST_F(AuthorizationSessionTest, DuplicateRolesOK) {
         // Add a user with doubled-up readWrite and single dbAdmin on the test DB
         ASSERT_OK(managerState->insertPrivilegeDocument("admin",
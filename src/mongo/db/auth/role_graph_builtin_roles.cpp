@@ -105,7 +105,8 @@ namespace {
             << ActionType::dbHash
             << ActionType::dbStats
             << ActionType::find
-            << ActionType::killCursors;
+            << ActionType::killCursors
+            << ActionType::planCacheRead; // dbAdmin gets this also
 
         // Read-write role
         readWriteRoleActions += readRoleActions;
@@ -151,6 +152,8 @@ namespace {
             << ActionType::createIndex
             << ActionType::indexStats
             << ActionType::enableProfiler
+            << ActionType::planCacheRead // read gets this also
+            << ActionType::planCacheWrite
             << ActionType::reIndex
             << ActionType::renameCollectionSameDB // read_write gets this also
             << ActionType::repairDatabase
@@ -215,7 +215,8 @@ namespace mongo {
             wassert( foo >= 0 && this->n < Size() );
             foo = this->emptySize;
             wassert( foo >= 0 && this->emptySize < V::BucketSize );
-            wassert( this->topSize >= this->n && this->topSize <= V::BucketSize );
+            wassert( ( this->topSize >= this->n || sharesKeyData() ) &&
+                     this->topSize <= V::BucketSize );
         }
 
         // this is very slow so don't do often
@@ -338,7 +339,8 @@ namespace mongo {
         KeyNode kn = keyNode(this->n-1);
         recLoc = kn.recordLoc;
         key.assign(kn.key);
-        int keysize = kn.key.dataSize();
+        // a key sharing the previous key's data has nothing of its own to unalloc
+        int keysize = keyDataSize(this->n-1);
 
         massert( 10283 , "rchild not null in btree popBack()", this->nextChild.isNull());
 
@@ -356,7 +358,8 @@ namespace mongo {
     /** add a key.  must be > all existing.  be careful to set next ptr right. */
     template< class V >
     bool BucketBasics<V>::_pushBack(const DiskLoc recordLoc, const Key& key, const Ordering &order, const DiskLoc prevChild) {
-        int bytesNeeded = key.dataSize() + sizeof(_KeyNode);
+        int sharedOfs = sharedKeyDataOfs(this->n-1, key);
+        int bytesNeeded = ( sharedOfs < 0 ? key.dataSize() : 0 ) + sizeof(_KeyNode);
         if ( bytesNeeded > this->emptySize )
             return false;
         verify( bytesNeeded <= this->emptySize );
@@ -374,6 +377,10 @@ namespace mongo {
         _KeyNode& kn = k(this->n++);
         kn.prevChildBucket = prevChild;
         kn.recordLoc = recordLoc;
+        if ( sharedOfs >= 0 ) {
+            kn.setKeyDataOfs( (short) sharedOfs );
+            return true;
+        }
         kn.setKeyDataOfs( (short) _alloc(key.dataSize()) );
         short ofs = kn.keyDataOfs();
         char *p = dataAt(ofs);
@@ -394,9 +401,18 @@ namespace mongo {
     bool BucketBasics<V>::basicInsert(const DiskLoc thisLoc, int &keypos, const DiskLoc recordLoc, const Key& key, const Ordering &order) const {
         check( this->n < 1024 );
         check( keypos >= 0 && keypos <= this->n );
-        int bytesNeeded = key.dataSize() + sizeof(_KeyNode);
+        // a duplicate of a neighboring key may point to its key data
+        int sharedOfs = sharedKeyDataOfs(keypos-1, key);
+        if ( sharedOfs < 0 )
+            sharedOfs = sharedKeyDataOfs(keypos, key);
+        int bytesNeeded = ( sharedOfs < 0 ? key.dataSize() : 0 ) + sizeof(_KeyNode);
         if ( bytesNeeded > this->emptySize ) {
             _pack(thisLoc, order, keypos);
+            // packing moves key data and may drop keys, so look for a neighbor to share with again
+            sharedOfs = sharedKeyDataOfs(keypos-1, key);
+            if ( sharedOfs < 0 )
+                sharedOfs = sharedKeyDataOfs(keypos, key);
+            bytesNeeded = ( sharedOfs < 0 ? key.dataSize() : 0 ) + sizeof(_KeyNode);
             if ( bytesNeeded > this->emptySize )
                 return false;
         }
@@ -426,6 +442,10 @@ namespace mongo {
         _KeyNode& kn = b->k(keypos);
         kn.prevChildBucket.Null();
         kn.recordLoc = recordLoc;
+        if ( sharedOfs >= 0 ) {
+            kn.setKeyDataOfs( (short) sharedOfs );
+            return true;
+        }
         kn.setKeyDataOfs((short) b->_alloc(key.dataSize()) );
         char *p = b->dataAt(kn.keyDataOfs());
         getDur().declareWriteIntent(p, key.dataSize());
@@ -442,17 +462,44 @@ namespace mongo {
         return index > 0 && ( index != refPos ) && k( index ).isUnused() && k( index ).prevChildBucket.isNull();
     }
 
+    template< class V >
+    int BucketBasics<V>::keyDataSize( int i ) const {
+        if ( i > 0 && k( i ).keyDataOfs() == k( i - 1 ).keyDataOfs() ) {
+            return 0;
+        }
+        return keyNode( i ).key.dataSize();
+    }
+
+    template< class V >
+    int BucketBasics<V>::sharedKeyDataOfs( int i, const Key& key ) const {
+        if ( !sharesKeyData() || i < 0 || i >= this->n ) {
+            return -1;
+        }
+        const Key existing = keyNode( i ).key;
+        if ( existing.dataSize() != key.dataSize() ||
+             memcmp( existing.data(), key.data(), key.dataSize() ) != 0 ) {
+            return -1;
+        }
+        return k( i ).keyDataOfs();
+    }
+
     template< class V >
     int BucketBasics<V>::packedDataSize( int refPos ) const {
         if ( this->flags & Packed ) {
             return V::BucketSize - this->emptySize - headerSize();
         }
         int size = 0;
+        int lastOfs = -1;
         for( int j = 0; j < this->n; ++j ) {
             if ( mayDropKey( j, refPos ) ) {
                 continue;
             }
-            size += keyNode( j ).key.dataSize() + sizeof( _KeyNode );
+            // shared key data is counted once; packing may share more, never less
+            if ( k( j ).keyDataOfs() != lastOfs ) {
+                size += keyNode( j ).key.dataSize();
+            }
+            lastOfs = k( j ).keyDataOfs();
+            size += sizeof( _KeyNode );
         }
         return size;
     }
@@ -489,6 +536,9 @@ namespace mongo {
         int ofs = tdz;
         this->topSize = 0;
         int i = 0;
+        // the key data last copied, to share it with identical following keys
+        short lastOfsOld = -1;
+        int lastSize = 0;
         for ( int j = 0; j < this->n; j++ ) {
             if( mayDropKey( j, refPos ) ) {
                 continue; // key is unused and has no children - drop it
@@ -501,9 +551,16 @@ namespace mongo {
             }
             short ofsold = k(i).keyDataOfs();
             int sz = keyNode(i).key.dataSize();
-            ofs -= sz;
-            this->topSize += sz;
-            memcpy(temp+ofs, dataAt(ofsold), sz);
+            bool share = i > 0 && ( ofsold == lastOfsOld ||
+                                    ( sharesKeyData() && sz == lastSize &&
+                                      memcmp(temp+ofs, dataAt(ofsold), sz) == 0 ) );
+            if ( !share ) {
+                ofs -= sz;
+                this->topSize += sz;
+                memcpy(temp+ofs, dataAt(ofsold), sz);
+            }
+            lastOfsOld = ofsold;
+            lastSize = sz;
             k(i).setKeyDataOfsSavingUse( ofs );
             ++i;
         }
@@ -564,7 +621,7 @@ namespace mongo {
         // TODO I think we only want to do the 90% split on the rhs node of the tree.
         int rightSizeLimit = ( this->topSize + sizeof( _KeyNode ) * this->n ) / ( keypos == this->n ? 10 : 2 );
         for( int i = this->n - 1; i > -1; --i ) {
-            rightSize += keyNode( i ).key.dataSize() + sizeof( _KeyNode );
+            rightSize += keyDataSize( i ) + sizeof( _KeyNode );
             if ( rightSize > rightSizeLimit ) {
                 split = i;
                 break;
@@ -596,6 +653,11 @@ namespace mongo {
         _KeyNode &kn = k( i );
         kn.recordLoc = recordLoc;
         kn.prevChildBucket = prevChildBucket;
+        int sharedOfs = sharedKeyDataOfs( i - 1, key );
+        if ( sharedOfs >= 0 ) {
+            kn.setKeyDataOfs( (short) sharedOfs );
+            return;
+        }
         short ofs = (short) _alloc( key.dataSize() );
         kn.setKeyDataOfs( ofs );
         char *p = dataAt( ofs );
@@ -754,6 +816,29 @@ namespace mongo {
      */
 
     bool guessIncreasing = false;
+
+    /** cleared by _insert() when the key being inserted is not placed after every key */
+    bool insertAtRightEdge = false;
+
+    namespace {
+        /**
+         * Whether the last key inserted in an index went to the right edge of its btree.  If so
+         * the next one likely does too (timestamps, counters...), and find() checks the last key
+         * of each bucket first.  Direct mapped by IndexDetails address: two indexes sharing a
+         * slot only make a wrong guess, which costs one extra comparison per level.
+         */
+        struct RightEdgeHint {
+            const IndexDetails* idx;
+            bool rightEdge;
+        };
+        RightEdgeHint rightEdgeHints[256];
+
+        RightEdgeHint& rightEdgeHintFor(const IndexDetails& idx) {
+            size_t slot = reinterpret_cast<size_t>(&idx) / sizeof(IndexDetails);
+            return rightEdgeHints[slot % 256];
+        }
+    }
+
     template< class V >
     bool BtreeBucket<V>::find(const IndexDetails& idx, const Key& key, const DiskLoc &rl, 
                               const Ordering &order, int& pos, bool assertIfDup) const {
@@ -770,6 +855,12 @@ namespace mongo {
             m = h;
         }
         while ( l <= h ) {
+            // the next probe is on one side of m or the other: start loading the keys of both
+            // while this one is compared, rather than missing the cache once per level
+            if ( l < m )
+                this->prefetchKey( (l+m-1)/2 );
+            if ( m < h )
+                this->prefetchKey( (m+1+h)/2 );
             KeyNode M = this->keyNode(m);
             int x = key.woCompare(M.key, order);
             if ( x == 0 ) {
@@ -843,6 +934,19 @@ namespace mongo {
         deallocBucket( thisLoc, id );
     }
 
+    template< class V >
+    void BtreeBucket<V>::deallocTree(const DiskLoc thisLoc, const IndexDetails &id) {
+        BtreeBucket<V>* b = thisLoc.btreemod<V>();
+        for ( int i = 0; i <= b->n; i++ ) {
+            const DiskLoc child = b->childForPos( i );
+            if ( !child.isNull() )
+                deallocTree( child, id );
+        }
+        BtreeIndexCursor::aboutToDeleteBucket(thisLoc);
+        IntervalBtreeCursor::aboutToDeleteBucket(thisLoc);
+        b->deallocBucket( thisLoc, id );
+    }
+
     template< class V >
     void BtreeBucket<V>::deallocBucket(const DiskLoc thisLoc, const IndexDetails &id) {
 #if 0
@@ -1007,7 +1111,7 @@ namespace mongo {
         // if we go below the low water mark.
         verify( rightSizeLimit < BtreeBucket<V>::bodySize() );
         for( int i = r->n - 1; i > -1; --i ) {
-            rightSize += r->keyNode( i ).key.dataSize() + KNS;
+            rightSize += r->keyDataSize( i ) + KNS;
             if ( rightSize > rightSizeLimit ) {
                 split = l->n + 1 + i;
                 break;
@@ -1021,7 +1125,7 @@ namespace mongo {
         }
         if ( split == -1 ) {
             for( int i = l->n - 1; i > -1; --i ) {
-                rightSize += l->keyNode( i ).key.dataSize() + KNS;
+                rightSize += l->keyDataSize( i ) + KNS;
                 if ( rightSize > rightSizeLimit ) {
                     split = i;
                     break;
@@ -1262,6 +1366,41 @@ namespace mongo {
         return false;
     }
 
+    template< class V >
+    bool BtreeBucket<V>::moveRecordLoc(const DiskLoc thisLoc, const IndexDetails& id,
+                                       const BSONObj& key, const DiskLoc oldLoc,
+                                       const DiskLoc newLoc) const {
+        int pos;
+        bool found;
+        const Ordering ord = Ordering::make(id.keyPattern());
+        DiskLoc loc = locate(id, thisLoc, key, ord, pos, found, oldLoc, 1);
+        if ( !found || !loc.btree<V>()->isUsed(pos) )
+            return false;
+
+        // keys that are equal are ordered by their record locations, so an equal neighbor on
+        // either side has to stay on that side of the new location
+        Loc to;
+        to = newLoc;
+        const KeyNode node = loc.btree<V>()->keyNode(pos);
+        for ( int direction = -1; direction <= 1; direction += 2 ) {
+            int neighborPos = pos;
+            DiskLoc neighbor = loc.btree<V>()->advance(loc, neighborPos, direction,
+                                                       "moveRecordLoc");
+            if ( neighbor.isNull() )
+                continue;
+            const KeyNode n = neighbor.btree<V>()->keyNode(neighborPos);
+            if ( !n.key.woEqual(node.key) )
+                continue;
+            Loc rl = n.recordLoc;
+            rl.GETOFS() &= ~1;
+            if ( to.compare(rl) * direction >= 0 )
+                return false;
+        }
+
+        loc.btree<V>()->k(pos).writing().recordLoc = to;
+        return true;
+    }
+
     template< class V >
     inline void BtreeBucket<V>::fix(const DiskLoc thisLoc, const DiskLoc child) {
         if ( !child.isNull() ) {
@@ -1457,6 +1596,9 @@ namespace mongo {
         DiskLoc loc = theDataFileMgr.insert(ns.c_str(), 0, V::BucketSize, false, true);
         BtreeBucket *b = BTREEMOD(loc);
         b->init();
+        if ( id.version() == 2 ) {
+            b->setSharesKeyData();
+        }
         return loc;
     }
 
@@ -1565,6 +1707,11 @@ namespace mongo {
                 }
             }
             int m = l + ( h - l ) / 2;
+            // as in find(), load both possible next probes while this one is compared
+            if ( l + 1 < m )
+                bucket->prefetchKey( l + ( m - l ) / 2 );
+            if ( m + 1 < h )
+                bucket->prefetchKey( m + ( h - m ) / 2 );
             int cmp = customBSONCmp( bucket->keyNode( m ).key.toBson(), keyBegin, keyBeginLen, afterKey, keyEnd, keyEndInclusive, order, direction );
             if ( cmp < 0 ) {
                 l = m;
@@ -1726,6 +1873,9 @@ namespace mongo {
 
         int pos;
         bool found = find(idx, key, recordLoc, order, pos, !dupsAllowed);
+        if ( pos != this->n ) {
+            insertAtRightEdge = false;
+        }
         if ( insert_debug ) {
             out() << "  " << thisLoc.toString() << '.' << "_insert " <<
                   key.toString() << '/' << recordLoc.toString() <<
@@ -1795,7 +1945,10 @@ namespace mongo {
                                const BSONObj& _key, const Ordering &order, bool dupsAllowed,
                                IndexDetails& idx, bool toplevel) const 
     {
-        guessIncreasing = _key.firstElementType() == jstOID && idx.isIdIndex();
+        RightEdgeHint& hint = rightEdgeHintFor(idx);
+        guessIncreasing = ( _key.firstElementType() == jstOID && idx.isIdIndex() ) ||
+                          ( hint.idx == &idx && hint.rightEdge );
+        insertAtRightEdge = true;
         KeyOwned key(_key);
 
         dassert(toplevel); 
@@ -1810,6 +1963,8 @@ namespace mongo {
         try {
             x = _insert(thisLoc, recordLoc, key, order, dupsAllowed, DiskLoc(), DiskLoc(), idx);
             this->assertValid( order );
+            hint.idx = &idx;
+            hint.rightEdge = insertAtRightEdge;
         }
         catch( ... ) { 
             guessIncreasing = false;
@@ -390,6 +390,14 @@ namespace mongo {
         static int bodySize() { return Version::BucketSize - headerSize(); }
         static int lowWaterMark() { return bodySize() / 2 - Version::KeyMax - sizeof( _KeyNode ) + 1; } // see comment in btree.cpp
 
+        /**
+         * Hints that the i-indexed key will be compared soon, so that its data is loaded while
+         * other work is done.  Does not check that i is in range.
+         */
+        void prefetchKey( int i ) const {
+            prefetch( const_cast<char*>( this->data ) + k( i ).keyDataOfs() );
+        }
+
         // for testing
         int nKeys() const { return this->n; }
         const DiskLoc getNextChild() const { return this->nextChild; }
@@ -402,6 +410,12 @@ namespace mongo {
         /** Size of the empty region. */
         unsigned int getEmptySize() const { return static_cast<unsigned int>(this->emptySize); }
 
+        /**
+         * @return true if adjacent keys with identical key data may point to a single copy of
+         * it.  Only the buckets of v:2 indexes do this, see SharesKeyData.
+         */
+        bool sharesKeyData() const { return this->flags & SharesKeyData; }
+
     protected:
         char * dataAt(short ofs) { return this->data + ofs; }
 
@@ -481,8 +495,15 @@ namespace mongo {
         /* !Packed means there is deleted fragment space within the bucket.
            We "repack" when we run out of space before considering the node
            to be full.
+
+           SharesKeyData is set on every bucket of a v:2 index.  Such a bucket
+           stores the key data of a run of adjacent keys with identical data
+           (duplicate key values) once, and all of the run's _KeyNodes point to
+           it.  The bucket layout is otherwise the same as that of a v:1 index,
+           but older versions would expand the shared data when packing, so the
+           flag may only be set on buckets of indexes they refuse to open.
            */
-        enum Flags { Packed=1 };
+        enum Flags { Packed=1, SharesKeyData=2 };
 
         /** n == 0 is ok */
         const Loc& childForPos(int p) const { return p == this->n ? this->nextChild : k(p).prevChildBucket; }
@@ -519,6 +540,18 @@ namespace mongo {
         int packedDataSize( int refPos ) const;
         void setNotPacked() { this->flags &= ~Packed; }
         void setPacked() { this->flags |= Packed; }
+        void setSharesKeyData() { this->flags |= SharesKeyData; }
+
+        /**
+         * @return the bytes the i-indexed key uses in the top region: 0 if it points to the
+         * same key data as the key before it.
+         */
+        int keyDataSize( int i ) const;
+        /**
+         * @return the offset of the key data of the i-indexed key if this bucket shares key data
+         * and that data is identical to 'key', or -1.  An out of range i returns -1.
+         */
+        int sharedKeyDataOfs( int i, const Key& key ) const;
         /**
          * Preconditions: 'bytes' is <= emptySize
          * Postconditions: A buffer of size 'bytes' is allocated on the top side,
@@ -597,6 +630,8 @@ namespace mongo {
          *  - The bson 'key' must fit in the bucket without packing.
          *  - If 'key' and 'prevChildBucket' are set at index i, the btree
          *    ordering properties will be maintained.
+         *  - The key at i - 1, if any, has already been set; setKey() may share
+         *    its key data.
          * Postconditions:
          *  - The specified key is set at index i, replacing the existing
          *    _KeyNode data and without shifting any other _KeyNode objects.
@@ -695,6 +730,13 @@ namespace mongo {
          */
         void deallocBucket(const DiskLoc thisLoc, const IndexDetails &id);
 
+        /**
+         * Preconditions: none
+         * Postconditions: the bucket at thisLoc and all the buckets below it are deallocated
+         *  from pdfile storage.  The caller is responsible for the reference to thisLoc.
+         */
+        static void deallocTree(const DiskLoc thisLoc, const IndexDetails &id);
+
         /**
          * Preconditions:
          *  - 'key' has a valid schema for this index.
@@ -724,6 +766,17 @@ namespace mongo {
          */
         bool unindex(const DiskLoc thisLoc, IndexDetails& id, const BSONObj& key, const DiskLoc recordLoc) const;
 
+        /**
+         * Postconditions:
+         *  - If key / oldLoc are in the btree as a used key, and key / newLoc
+         *    sort between the same neighbors, the key is pointed at newLoc in
+         *    place and @return true.
+         *  - Otherwise @return false and do nothing; the key may then be
+         *    unindexed and inserted again.
+         */
+        bool moveRecordLoc(const DiskLoc thisLoc, const IndexDetails& id, const BSONObj& key,
+                           const DiskLoc oldLoc, const DiskLoc newLoc) const;
+
         /**
          * locate may return an "unused" key that is just a marker.  so be careful.
          *   looks for a key:recordloc pair.
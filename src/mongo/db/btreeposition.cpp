@@ -46,7 +46,7 @@ namespace mongo {
         _ordering( ordering ),
         _initialLocation( initialLocation ),
         _initialLocationValid() {
-        fassert( 16494, _indexDetails->version() == 1 );
+        fassert( 16494, _indexDetails->version() == 1 || _indexDetails->version() == 2 );
     }
 
     void LogicalBtreePosition::init() {
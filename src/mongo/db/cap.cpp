@@ -213,6 +213,36 @@ namespace mongo {
         return ret;
     }
 
+    namespace {
+        mongo::mutex cappedInsertMutex( "cappedInsert" );
+        boost::condition cappedInsertCondition;
+        unsigned long long cappedInserts = 0; // guarded by cappedInsertMutex
+        unsigned cappedInsertWaiters = 0; // guarded by cappedInsertMutex
+
+        void notifyCappedInsert() {
+            mutex::scoped_lock lk( cappedInsertMutex );
+            ++cappedInserts;
+            if ( cappedInsertWaiters )
+                cappedInsertCondition.notify_all();
+        }
+    }
+
+    unsigned long long NamespaceDetails::cappedInsertCount() {
+        mutex::scoped_lock lk( cappedInsertMutex );
+        return cappedInserts;
+    }
+
+    void NamespaceDetails::waitForCappedInsert( unsigned long long lastSeen, unsigned millis ) {
+        mutex::scoped_lock lk( cappedInsertMutex );
+        ++cappedInsertWaiters;
+        while ( cappedInserts == lastSeen ) {
+            if ( !cappedInsertCondition.timed_wait( lk.boost(),
+                                                    boost::posix_time::milliseconds( millis ) ) )
+                break; // timed out
+        }
+        --cappedInsertWaiters;
+    }
+
     DiskLoc NamespaceDetails::cappedAlloc(const StringData& ns, int len) {
 
         if ( len > theCapExtent()->length ) {
@@ -301,6 +331,10 @@ namespace mongo {
         if ( _capFirstNewRecord.isValid() && _capFirstNewRecord.isNull() )
             getDur().writingDiskLoc(_capFirstNewRecord) = loc;
 
+        // waiters can't read the new record until we release the write lock, by which time it
+        // has been written
+        notifyCappedInsert();
+
         return loc;
     }
 
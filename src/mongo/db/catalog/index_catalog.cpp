@@ -263,6 +263,113 @@ namespace mongo {
 
     }
 
+    Status IndexCatalog::createIndexes( const vector<BSONObj>& specs, bool mayInterrupt ) {
+
+        // background builds yield, and dropping dups deletes documents the other indexes got
+        // keys for, so those are built one at a time after the others
+        vector<BSONObj> alone;
+
+        Database* db = _collection->_database;
+        OwnedPointerVector<IndexBuildBlock> blocks;
+        vector<string> names;
+        BSONArrayBuilder building;
+
+        for ( size_t i = 0; i < specs.size(); i++ ) {
+            BSONObj spec = specs[i];
+            if ( spec["background"].trueValue() || spec["dropDups"].trueValue() ) {
+                alone.push_back( spec );
+                continue;
+            }
+
+            // the ones already begun count as existing, so duplicates in specs are skipped too
+            Status status = okToAddIndex( spec );
+            if ( status.isOK() ) {
+                spec = fixIndexSpec( spec );
+                status = okToAddIndex( spec );
+            }
+            if ( status.code() == ErrorCodes::IndexAlreadyExists )
+                continue;
+            if ( !status.isOK() )
+                return status;
+
+            string pluginName = IndexNames::findPluginName( spec["key"].Obj() );
+            if ( pluginName.size() ) {
+                Status s = _upgradeDatabaseMinorVersionIfNeeded( pluginName );
+                if ( !s.isOK() )
+                    return s;
+            }
+
+            Collection* systemIndexes = db->getCollection( db->_indexesName );
+            if ( !systemIndexes ) {
+                systemIndexes = db->createCollection( db->_indexesName, false, NULL, false );
+                verify( systemIndexes );
+            }
+
+            StatusWith<DiskLoc> loc = systemIndexes->insertDocument( spec, false );
+            if ( !loc.isOK() )
+                return loc.getStatus();
+            verify( !loc.getValue().isNull() );
+
+            string idxName = spec["name"].valuestr();
+            blocks.mutableVector().push_back( new IndexBuildBlock( this, idxName,
+                                                                   loc.getValue() ) );
+            verify( blocks.vector().back()->indexDetails() );
+            names.push_back( idxName );
+            building.append( spec );
+        }
+
+        if ( !blocks.empty() ) {
+            const BSONArray buildingSpecs = building.arr();
+            if ( mayInterrupt ) {
+                cc().curop()->setQuery( BSON( "createIndexes" << buildingSpecs ) );
+            }
+
+            try {
+                OwnedPointerVector<IndexDescriptor> descs;
+                for ( size_t i = 0; i < names.size(); i++ ) {
+                    int idxNo = _details->findIndexByName( names[i], true );
+                    verify( idxNo >= 0 );
+                    IndexDetails* id = &_details->idx(idxNo);
+                    descs.mutableVector().push_back(
+                        new IndexDescriptor( _collection, idxNo, id, id->info.obj().getOwned() ) );
+                }
+                buildIndexes( _collection, descs.vector(), mayInterrupt );
+
+                for ( size_t i = 0; i < names.size(); i++ ) {
+                    blocks.vector()[i]->success();
+
+                    // TEMP until IndexDescriptor has to direct refs
+                    int idxNo = _details->findIndexByName( names[i], true );
+                    verify( idxNo >= 0 );
+                    _deleteCacheEntry( idxNo );
+                }
+            }
+            catch (DBException& e) {
+                log() << "index build failed."
+                      << " specs: " << buildingSpecs
+                      << " error: " << e;
+
+                for ( size_t i = 0; i < names.size(); i++ ) {
+                    int idxNo = _details->findIndexByName( names[i], true );
+                    verify( idxNo >= 0 );
+                    _deleteCacheEntry( idxNo );
+                }
+
+                return Status( ErrorCodes::InternalError, e.what(), e.getCode() );
+            }
+        }
+
+        for ( size_t i = 0; i < alone.size(); i++ ) {
+            Status status = createIndex( alone[i], mayInterrupt );
+            if ( status.code() == ErrorCodes::IndexAlreadyExists )
+                continue;
+            if ( !status.isOK() )
+                return status;
+        }
+
+        return Status::OK();
+    }
+
     IndexCatalog::IndexBuildBlock::IndexBuildBlock( IndexCatalog* catalog,
                                                     const StringData& indexName,
                                                     const DiskLoc& loc )
@@ -959,11 +1066,47 @@ namespace mongo {
             }
         }
 
+        if ( numIndexesInProgress() )
+            BackgroundIndexSideTable::noteWrite( _collection->ns().ns(), loc, false );
+    }
+
+    void IndexCatalog::indexRecords( const vector<BSONObj>& objs,
+                                     const vector<DiskLoc>& locs,
+                                     vector<bool>* failed ) {
+
+        for ( int i = 0; i < numIndexesTotal(); i++ ) {
+            IndexDescriptor* desc = getDescriptor( i );
+            IndexAccessMethod* iam = getIndex( desc );
+
+            InsertDeleteOptions options;
+            options.logIfError = false;
+            options.dupsAllowed =
+                ignoreUniqueIndex( desc->getOnDisk() ) ||
+                ( !KeyPattern::isIdKeyPattern(desc->keyPattern()) && !desc->unique() );
+
+            int64_t inserted;
+            Status s = iam->insertBulk( objs, locs, options, failed, &inserted );
+            if ( !s.isOK() ) {
+                LOG(2) << "IndexCatalog::indexRecords failed: " << s;
+                failed->assign( objs.size(), true );
+                return;
+            }
+        }
+
+        if ( numIndexesInProgress() ) {
+            for ( size_t i = 0; i < locs.size(); i++ ) {
+                if ( !(*failed)[i] )
+                    BackgroundIndexSideTable::noteWrite( _collection->ns().ns(), locs[i], false );
+            }
+        }
     }
 
     void IndexCatalog::unindexRecord( const BSONObj& obj, const DiskLoc& loc, bool noWarn ) {
         int numIndices = numIndexesTotal();
 
+        if ( numIndexesInProgress() )
+            BackgroundIndexSideTable::noteWrite( _collection->ns().ns(), loc, true );
+
         for (int i = 0; i < numIndices; i++) {
             // If i >= d->nIndexes, it's a background index, and we DO NOT want to log anything.
             bool logIfError = ( i < numIndexesTotal() ) ? !noWarn : false;
@@ -1030,7 +1173,7 @@ namespace mongo {
             // note (one day) we may be able to fresh build less versions than we can use
             // isASupportedIndexVersionNumber() is what we can use
             uassert(14803, str::stream() << "this version of mongod cannot build new indexes of version number " << vv, 
-                    vv == 0 || vv == 1);
+                    vv == 0 || vv == 1 || vv == 2);
             v = (int) vv;
         }
         // idea is to put things we use a lot earlier
@@ -107,6 +107,13 @@ namespace mongo {
 
         Status createIndex( BSONObj spec, bool mayInterrupt );
 
+        /**
+         * creates the indexes of specs, building the foreground ones with a single scan of the
+         * collection.  the ones that already exist are skipped.  if the scan fails none of the
+         * indexes it was building are kept.
+         */
+        Status createIndexes( const vector<BSONObj>& specs, bool mayInterrupt );
+
         Status okToAddIndex( const BSONObj& spec ) const;
 
         Status dropAllIndexes( bool includingIdIndex );
@@ -153,6 +160,15 @@ namespace mongo {
         // this throws for now
         void indexRecord( const BSONObj& obj, const DiskLoc &loc );
 
+        /**
+         * indexes objs at locs, an index at a time; see IndexAccessMethod::insertBulk
+         * the documents whose keys can't all be inserted are marked in failed, and may be in
+         * some of the indexes: unindexRecord them
+         */
+        void indexRecords( const vector<BSONObj>& objs,
+                           const vector<DiskLoc>& locs,
+                           vector<bool>* failed );
+
         void unindexRecord( const BSONObj& obj, const DiskLoc& loc, bool noWarn );
 
         /**
@@ -47,11 +47,54 @@
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/sort_phase_one.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/util/processinfo.h"
 
 namespace mongo {
 
+    // background builds sort the keys they scan and build the tree bottom up, as foreground
+    // builds do, rather than inserting them into the tree one document at a time.
+    MONGO_EXPORT_SERVER_PARAMETER(backgroundIndexBuildUsesBulkPath, bool, true);
+
+    namespace {
+        SimpleMutex sideTablesMutex("bgIndexSideTables");
+        // ns -> the side table of the background index build running on it
+        std::map<std::string, BackgroundIndexSideTable*> sideTables;
+    }
+
+    BackgroundIndexSideTable::BackgroundIndexSideTable( const StringData& ns )
+        : _ns( ns.toString() ) {
+        SimpleMutex::scoped_lock lk( sideTablesMutex );
+        verify( sideTables.find( _ns ) == sideTables.end() );
+        sideTables[_ns] = this;
+    }
+
+    BackgroundIndexSideTable::~BackgroundIndexSideTable() {
+        SimpleMutex::scoped_lock lk( sideTablesMutex );
+        sideTables.erase( _ns );
+    }
+
+    void BackgroundIndexSideTable::noteWrite( const StringData& ns,
+                                              const DiskLoc& loc,
+                                              bool deleted ) {
+        BackgroundIndexSideTable* table;
+        {
+            SimpleMutex::scoped_lock lk( sideTablesMutex );
+            std::map<std::string, BackgroundIndexSideTable*>::const_iterator i =
+                sideTables.find( ns.toString() );
+            if ( i == sideTables.end() )
+                return;
+            table = i->second;
+        }
+        table->_written.insert( loc );
+        if ( deleted )
+            table->_deleted.insert( loc );
+        else
+            table->_deleted.erase( loc );
+    }
+
     /**
      * Add the provided (obj, dl) pair to the provided index.
      */
@@ -82,12 +125,19 @@ namespace mongo {
             : BackgroundOperation(ns) {
         }
 
-        unsigned long long go( Collection* collection, IndexDescriptor* idx );
+        unsigned long long go( Collection* collection, IndexDescriptor* idx, bool mayInterrupt );
 
     private:
         unsigned long long addExistingToIndex( Collection* collection,
                                                IndexDescriptor* idx );
 
+        /**
+         * Scans with yields, sorting the keys, then builds the tree bottom up and adds the keys
+         * of the documents written in the meantime without yielding.
+         */
+        unsigned long long bulkBuild( Collection* collection, IndexDescriptor* idx,
+                                      bool mayInterrupt );
+
         void prep(const StringData& ns ) {
             Lock::assertWriteLocked(ns);
             uassert( 13130 , "can't start bg index b/c in recursive lock (db.eval?)" , !Lock::nested() );
@@ -103,7 +153,9 @@ namespace mongo {
 
     };
 
-    unsigned long long BackgroundIndexBuildJob::go( Collection* collection, IndexDescriptor* idx) {
+    unsigned long long BackgroundIndexBuildJob::go( Collection* collection,
+                                                    IndexDescriptor* idx,
+                                                    bool mayInterrupt ) {
 
         string ns = collection->ns().ns();
 
@@ -115,7 +167,9 @@ namespace mongo {
 
         try {
             idx->getOnDisk().head.writing() = BtreeBasedBuilder::makeEmptyIndex( idx->getOnDisk() );
-            unsigned long long n = addExistingToIndex( collection, idx );
+            unsigned long long n = backgroundIndexBuildUsesBulkPath ?
+                bulkBuild( collection, idx, mayInterrupt ) :
+                addExistingToIndex( collection, idx );
             // idx may point at an invalid index entry at this point
             done( ns );
             return n;
@@ -222,6 +276,113 @@ namespace mongo {
         return n;
     }
 
+    unsigned long long BackgroundIndexBuildJob::bulkBuild( Collection* collection,
+                                                           IndexDescriptor* idx,
+                                                           bool mayInterrupt ) {
+
+        string ns = collection->ns().ns(); // our copy for sanity
+        std::string idxName = idx->indexName();
+        bool dropDups = idx->dropDups();
+
+        // until it goes away, writers tell us which documents to redo the keys of.  they also
+        // keep maintaining the tree made by go(), so conflicts with unique keys of documents
+        // scanned before still fail the writes.
+        BackgroundIndexSideTable sideTable( ns );
+
+        Timer t;
+        CurOp* op = cc().curop();
+        ProgressMeterHolder pm(op->setMessage("bg index build: (1/3) external sort",
+                                              "Background Index Build: (1/3) External Sort Progress",
+                                              collection->numRecords(),
+                                              10));
+
+        SortPhaseOne phase1;
+        BtreeBasedBuilder::initPhaseOne( collection, idx, &phase1 );
+        BtreeBasedAccessMethod* iam = collection->getIndexCatalog()->getBtreeBasedIndex( idx );
+
+        auto_ptr<Runner> runner(InternalPlanner::collectionScan(ns));
+
+        // We're not delegating yielding to the runner because we need to know when a yield
+        // happens.
+        RunnerYieldPolicy yieldPolicy;
+
+        BSONObj js;
+        DiskLoc loc;
+        Runner::RunnerState state;
+        while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&js, &loc))) {
+            RARELY killCurrentOp.checkForInterrupt( !mayInterrupt );
+            BSONObjSet keys;
+            iam->getKeys(js, &keys);
+            phase1.addKeys(keys, loc, mayInterrupt);
+            pm.hit();
+
+            if (yieldPolicy.shouldYield()) {
+                if (!yieldPolicy.yieldAndCheckIfOK(runner.get())) {
+                    uasserted(12584, "cursor gone during bg index");
+                }
+
+                pm->setTotalWhileRunning( collection->numRecords() );
+                // Recalculate idxNo if we yielded
+                idx = collection->getIndexCatalog()->findIndexByName( idxName, true );
+                verify( idx );
+                iam = collection->getIndexCatalog()->getBtreeBasedIndex( idx );
+            }
+        }
+        uassert(17285, "Internal error reading docs from collection", Runner::RUNNER_EOF == state);
+        pm.finished();
+
+        // from here on nothing yields.  the tree the writers kept has only the keys of
+        // documents in the side table, which are all redone below.
+        BtreeBasedBuilder::deallocTree( idx->getOnDisk() );
+
+        const std::set<DiskLoc>& written = sideTable.written();
+        BtreeBasedBuilder::buildFromPhaseOne( collection, idx, &phase1, &written, pm, t,
+                                              mayInterrupt );
+
+        std::vector<DiskLoc> redo;
+        for ( std::set<DiskLoc>::const_iterator i = written.begin(); i != written.end(); ++i ) {
+            if ( !sideTable.deleted( *i ) )
+                redo.push_back( *i );
+        }
+        LOG(t.seconds() > 10 ? 0 : 1) << "\t redoing the keys of " << redo.size()
+                                      << " documents written during the build" << endl;
+
+        unsigned long long numDropped = 0;
+        for ( std::vector<DiskLoc>::const_iterator i = redo.begin(); i != redo.end(); ++i ) {
+            RARELY killCurrentOp.checkForInterrupt( !mayInterrupt );
+            BSONObj doc = collection->docFor( *i );
+            try {
+                if ( dropDups ) {
+                    LastError::Disabled led( lastError.get() );
+                    addKeysToIndex( collection, idx, doc, *i );
+                }
+                else {
+                    addKeysToIndex( collection, idx, doc, *i );
+                }
+            }
+            catch( AssertionException& e ) {
+                if( e.interrupted() ) {
+                    killCurrentOp.checkForInterrupt();
+                }
+
+                if ( !dropDups ) {
+                    log() << "background index build exception " << e.what() << endl;
+                    throw;
+                }
+
+                BSONObj toDelete;
+                collection->deleteDocument( *i, false, true, &toDelete );
+                logOp( "d", ns.c_str(), toDelete );
+                numDropped++;
+            }
+            getDur().commitIfNeeded();
+        }
+
+        if ( dropDups )
+            log() << "\t backgroundIndexBuild dupsToDrop: " << numDropped << endl;
+        return phase1.n;
+    }
+
     // ---------------------------
 
     // throws DBException
@@ -249,11 +410,37 @@ namespace mongo {
         }
         else {
             BackgroundIndexBuildJob j( ns );
-            n = j.go( collection, idx );
+            n = j.go( collection, idx, mayInterrupt );
         }
         MONGO_TLOG(0) << "build index done.  scanned " << n << " total records. "
                       << t.millis() / 1000.0 << " secs" << endl;
     }
 
-}  // namespace mongo
+    // throws DBException
+    void buildIndexes( Collection* collection,
+                       const std::vector<IndexDescriptor*>& idxs,
+                       bool mayInterrupt ) {
+
+        string ns = collection->ns().ns(); // our copy
 
+        for ( size_t i = 0; i < idxs.size(); i++ ) {
+            MONGO_TLOG(0) << "build index on: " << ns
+                          << " properties: " << idxs[i]->toString() << endl;
+            audit::logCreateIndex( currentClient.get(), &idxs[i]->infoObj(),
+                                   idxs[i]->indexName(), ns );
+        }
+
+        Timer t;
+
+        verify( Lock::isWriteLocked( ns ) );
+
+        unsigned long long n = BtreeBasedBuilder::fastBuildIndexes( collection, idxs,
+                                                                    mayInterrupt );
+        for ( size_t i = 0; i < idxs.size(); i++ ) {
+            verify( !idxs[i]->getHead().isNull() );
+        }
+        MONGO_TLOG(0) << "build " << idxs.size() << " indexes done.  scanned " << n
+                      << " total records. " << t.millis() / 1000.0 << " secs" << endl;
+    }
+
+}  // namespace mongo
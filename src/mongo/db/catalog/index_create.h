@@ -30,7 +30,13 @@
 
 #pragma once
 
+#include <set>
 #include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/diskloc.h"
 
 namespace mongo {
     class Collection;
@@ -43,4 +49,41 @@ namespace mongo {
                        IndexDescriptor* idx,
                        bool mayInterrupt );
 
+    // Build the foreground indexes idxs of a collection with one scan of it; none may drop dups
+    void buildIndexes( Collection* collection,
+                       const std::vector<IndexDescriptor*>& idxs,
+                       bool mayInterrupt );
+
+    /**
+     * The documents written to a collection while a background index build scans it.  The
+     * writes still go to the unfinished index, but the keys the scan got for a document may be
+     * stale once it has been written, so the build leaves the scanned keys of these documents
+     * out of the tree it builds from the sorted keys and then adds their current keys.
+     *
+     * One background index build runs on a collection at a time.  Writers and the build hold
+     * the collection's write lock when touching a side table.
+     */
+    class BackgroundIndexSideTable {
+        MONGO_DISALLOW_COPYING(BackgroundIndexSideTable);
+    public:
+        /** registers to capture the writes to ns until destroyed */
+        explicit BackgroundIndexSideTable( const StringData& ns );
+        ~BackgroundIndexSideTable();
+
+        /** a no-op unless a background index build on ns is capturing writes */
+        static void noteWrite( const StringData& ns, const DiskLoc& loc, bool deleted );
+
+        /** where documents were inserted, updated or deleted */
+        const std::set<DiskLoc>& written() const { return _written; }
+
+        /** whether the last write at loc deleted the document there */
+        bool deleted( const DiskLoc& loc ) const { return _deleted.count( loc ) > 0; }
+
+    private:
+        const std::string _ns;
+        std::set<DiskLoc> _written;
+        std::set<DiskLoc> _deleted;
+    };
+
+
 } // namespace mongo
@@ -38,19 +38,21 @@
 namespace mongo {
 
     NamespaceDetails* NamespaceIndex::details(const StringData& ns) {
-        Namespace n(ns);
-        return details(n);
-    }
-
-    NamespaceDetails* NamespaceIndex::details(const Namespace& ns) {
         if ( !_ht )
             return 0;
-        NamespaceDetails *d = _ht->get(ns);
-        if ( d && d->isCapped() )
+        DetailsByName::const_iterator it = _detailsByName.find(ns.toString());
+        if ( it == _detailsByName.end() )
+            return 0;
+        NamespaceDetails *d = it->second;
+        if ( d->isCapped() )
             d->cappedCheckMigrate();
         return d;
     }
 
+    NamespaceDetails* NamespaceIndex::details(const Namespace& ns) {
+        return details(StringData(ns.toString()));
+    }
+
     void NamespaceIndex::add_ns(const StringData& ns, const DiskLoc& loc, bool capped) {
         NamespaceDetails details( loc, capped );
         add_ns( ns, &details );
@@ -65,6 +67,7 @@ namespace mongo {
         Lock::assertWriteLocked(ns.toString());
         init();
         uassert( 10081 , "too many namespaces/collections", _ht->put(ns, *details));
+        _detailsByName[ns.toString()] = _ht->get(ns);
     }
 
     void NamespaceIndex::kill_ns(const StringData& ns) {
@@ -73,11 +76,13 @@ namespace mongo {
             return;
         Namespace n(ns);
         _ht->kill(n);
+        _detailsByName.erase(ns.toString());
 
         for( int i = 0; i<=1; i++ ) {
             try {
                 Namespace extra(n.extraName(i));
                 _ht->kill(extra);
+                _detailsByName.erase(extra.toString());
             }
             catch(DBException&) {
                 MONGO_DLOG(3) << "caught exception in kill_ns" << endl;
@@ -97,6 +102,12 @@ namespace mongo {
         return ret;
     }
 
+    static void namespaceIndexDetailsCallback( const Namespace& k , NamespaceDetails& v , void * extra ) {
+        unordered_map<string, NamespaceDetails*>* m =
+            static_cast<unordered_map<string, NamespaceDetails*>*>(extra);
+        (*m)[k.toString()] = &v;
+    }
+
     static void namespaceGetNamespacesCallback( const Namespace& k , NamespaceDetails& v , void * extra ) {
         list<string> * l = (list<string>*)extra;
         if ( ! k.hasDollarSign() )
@@ -173,6 +184,9 @@ namespace mongo {
 
         verify( len <= 0x7fffffff );
         _ht = new HashTable<Namespace,NamespaceDetails>(p, (int) len, "namespace index");
+
+        _detailsByName.clear();
+        _ht->iterAll( namespaceIndexDetailsCallback , (void*)&_detailsByName );
     }
 
 
@@ -35,6 +35,7 @@
 
 #include "mongo/db/diskloc.h"
 #include "mongo/db/catalog/ondisk/namespace.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/util/hashtab.h"
 
 namespace mongo {
@@ -82,6 +83,13 @@ namespace mongo {
         HashTable<Namespace,NamespaceDetails> *_ht;
         std::string _dir;
         std::string _database;
+
+        // The entries of _ht by name, so that a lookup is a hash probe of the name rather than
+        // a walk of the on-disk chain comparing Namespaces.  Filled when the file is opened and
+        // kept in step by add_ns() and kill_ns(), which run under the write lock, so readers
+        // never modify it.  The pointers are into the mapping of the file, which doesn't move.
+        typedef unordered_map<std::string, NamespaceDetails*> DetailsByName;
+        DetailsByName _detailsByName;
     };
 
 }
@@ -634,7 +634,11 @@ namespace mongo {
         }
 
         if ( curop.numYields() )
-            s << " numYields:" << curop.numYields();
+            s << " numYields:" << curop.numYields() << " yieldMicros:" << curop.yieldMicros();
+        if ( curop.accessesNotInMemory() )
+            s << " accessesNotInMemory:" << curop.accessesNotInMemory();
+        if ( curop.pageFaultExceptions() )
+            s << " pageFaultExceptions:" << curop.pageFaultExceptions();
         
         s << " ";
         curop.lockStat().report( s );
@@ -718,6 +722,9 @@ namespace mongo {
         OPDEBUG_APPEND_NUMBER( keyUpdates );
 
         b.appendNumber( "numYield" , curop.numYields() );
+        b.appendNumber( "yieldMicros" , curop.yieldMicros() );
+        b.appendNumber( "accessesNotInMemory" , curop.accessesNotInMemory() );
+        b.appendNumber( "pageFaultExceptions" , curop.pageFaultExceptions() );
         b.append( "lockStats" , curop.lockStat().report() );
 
         if ( ! exceptionInfo.empty() )
@@ -58,9 +58,10 @@
 namespace mongo {
 
     ClientCursor::CCById ClientCursor::clientCursorsById;
+    ClientCursor::CCByNs ClientCursor::clientCursorsByNs;
     boost::recursive_mutex& ClientCursor::ccmutex( *(new boost::recursive_mutex()) );
     long long ClientCursor::numberTimedOut = 0;
-    set<Runner*> ClientCursor::nonCachedRunners;
+    ClientCursor::RunnersByNs ClientCursor::nonCachedRunners;
 
     void aboutToDeleteForSharding(const StringData& ns,
                                   const Database* db,
@@ -115,6 +116,7 @@ namespace mongo {
         recursive_scoped_lock lock(ccmutex);
         _cursorid = allocCursorId_inlock();
         clientCursorsById.insert( make_pair(_cursorid, this) );
+        clientCursorsByNs[_ns].insert( this );
     }
 
     ClientCursor::~ClientCursor() {
@@ -133,6 +135,14 @@ namespace mongo {
 
             clientCursorsById.erase(_cursorid);
 
+            CCByNs::iterator byNs = clientCursorsByNs.find(_ns);
+            if (byNs != clientCursorsByNs.end()) {
+                byNs->second.erase(this);
+                if (byNs->second.empty()) {
+                    clientCursorsByNs.erase(byNs);
+                }
+            }
+
             // defensive:
             _cursorid = INVALID_CURSOR_ID;
             _pos = -2;
@@ -148,6 +158,7 @@ namespace mongo {
             ClientCursor *cc = clientCursorsById.begin()->second;
             log() << "first one: " << cc->_cursorid << ' ' << cc->_ns << endl;
             clientCursorsById.clear();
+            clientCursorsByNs.clear();
             verify(false);
         }
     }
@@ -166,47 +177,54 @@ namespace mongo {
         verify(ns.startsWith(db->name()));
 
         recursive_scoped_lock cclock(ccmutex);
-        // Look at all active non-cached Runners.  These are the runners that are in auto-yield mode
-        // that are not attached to the the client cursor. For example, all internal runners don't
-        // need to be cached -- there will be no getMore.
-        for (set<Runner*>::iterator it = nonCachedRunners.begin(); it != nonCachedRunners.end();
-             ++it) {
-
-            Runner* runner = *it;
-            const string& runnerNS = runner->ns();
-            if ( ( isDB && StringData(runnerNS).startsWith(ns) ) || ns == runnerNS ) {
-                runner->kill();
+        // Look at the active non-cached Runners over the namespace(s).  These are the runners that
+        // are in auto-yield mode that are not attached to the the client cursor. For example, all
+        // internal runners don't need to be cached -- there will be no getMore.
+        //
+        // The namespaces that start with ns are those of the db, or ns itself and its
+        // subcollections, which are sorted after it.
+        for (RunnersByNs::const_iterator it = nonCachedRunners.lower_bound(ns.toString());
+             it != nonCachedRunners.end() && StringData(it->first).startsWith(ns); ++it) {
+
+            if (!isDB && ns != it->first) {
+                break;
+            }
+            for (set<Runner*>::const_iterator runner = it->second.begin();
+                 runner != it->second.end(); ++runner) {
+                (*runner)->kill();
             }
         }
 
-        // Look at all cached ClientCursor(s).  The CC may have a Runner, a Cursor, or nothing (see
-        // sharding_block.h).
-        CCById::const_iterator it = clientCursorsById.begin();
-        while (it != clientCursorsById.end()) {
-            ClientCursor* cc = it->second;
+        // Look at the cached ClientCursor(s) over the namespace(s).  The CC may have a Runner, a
+        // Cursor, or nothing (see sharding_block.h).
+        vector<CursorId> toDelete;
+        for (CCByNs::const_iterator it = clientCursorsByNs.lower_bound(ns.toString());
+             it != clientCursorsByNs.end() && StringData(it->first).startsWith(ns); ++it) {
 
-            // We're only interested in cursors over one db.
-            if (cc->_db != db) {
-                ++it;
-                continue;
+            if (!isDB && ns != it->first) {
+                break;
             }
 
-            // Note that a valid ClientCursor state is "no cursor no runner."  This is because
-            // the set of active cursor IDs in ClientCursor is used as representation of query
-            // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
-            if (NULL == cc->c() && NULL == cc->_runner.get()) {
-                ++it;
-                continue;
-            }
+            for (CCSet::const_iterator i = it->second.begin(); i != it->second.end(); ++i) {
+                ClientCursor* cc = *i;
+
+                // We're only interested in cursors over one db.
+                if (cc->_db != db) {
+                    continue;
+                }
 
-            bool shouldDelete = false;
+                // Note that a valid ClientCursor state is "no cursor no runner."  This is because
+                // the set of active cursor IDs in ClientCursor is used as representation of query
+                // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
+                if (NULL == cc->c() && NULL == cc->_runner.get()) {
+                    continue;
+                }
 
-            // We will only delete CCs with runners that are not actively in use.  The runners that
-            // are actively in use are instead kill()-ed.
-            if (NULL != cc->_runner.get()) {
-                verify(NULL == cc->c());
+                // We will only delete CCs with runners that are not actively in use.  The runners
+                // that are actively in use are instead kill()-ed.
+                if (NULL != cc->_runner.get()) {
+                    verify(NULL == cc->c());
 
-                if (isDB || cc->_runner->ns() == ns) {
                     // If there is a pinValue >= 100, somebody is actively using the CC and we do
                     // not delete it.  Instead we notify the holder that we killed it.  The holder
                     // will then delete the CC.
@@ -216,38 +234,23 @@ namespace mongo {
                     else {
                         // pinvalue is <100, so there is nobody actively holding the CC.  We can
                         // safely delete it as nobody is holding the CC.
-                        shouldDelete = true;
+                        toDelete.push_back(cc->cursorid());
                     }
                 }
-            }
-            // Begin cursor-only DEPRECATED
-            else if (cc->c()->shouldDestroyOnNSDeletion()) {
-                verify(NULL == cc->_runner.get());
-
-                if (isDB) {
-                    // already checked that db matched above
-                    dassert( StringData(cc->_ns).startsWith( ns ) );
-                    shouldDelete = true;
-                }
-                else {
-                    if ( ns == cc->_ns ) {
-                        shouldDelete = true;
-                    }
+                // Begin cursor-only DEPRECATED
+                else if (cc->c()->shouldDestroyOnNSDeletion()) {
+                    verify(NULL == cc->_runner.get());
+                    toDelete.push_back(cc->cursorid());
                 }
+                // End cursor-only DEPRECATED
             }
-            // End cursor-only DEPRECATED
-
-            if (shouldDelete) {
-                ClientCursor* toDelete = it->second;
-                CursorId id = toDelete->cursorid();
-                delete toDelete;
-                // We're not following the usual paradigm of saving it, ++it, and deleting the saved
-                // 'it' because deleting 'it' might invalidate the next thing in clientCursorsById.
-                // TODO: Why?
-                it = clientCursorsById.upper_bound(id);
-            }
-            else {
-                ++it;
+        }
+
+        for (vector<CursorId>::const_iterator it = toDelete.begin(); it != toDelete.end(); ++it) {
+            // Deleting a ClientCursor might delete others, so each one is looked up again.
+            ClientCursor* cc = find_inlock(*it, false);
+            if (cc) {
+                delete cc;
             }
         }
     }
@@ -267,31 +270,30 @@ namespace mongo {
 
         aboutToDeleteForSharding( ns, db, nsd, dl );
 
-        // Check our non-cached active runner list.
-        for (set<Runner*>::iterator it = nonCachedRunners.begin(); it != nonCachedRunners.end();
-             ++it) {
+        const string nsString = ns.toString();
 
-            Runner* runner = *it;
-            if (0 == ns.compare(runner->ns())) {
-                runner->invalidate(dl);
+        // Check our non-cached active runners over ns.
+        RunnersByNs::const_iterator runners = nonCachedRunners.find(nsString);
+        if (runners != nonCachedRunners.end()) {
+            for (set<Runner*>::const_iterator it = runners->second.begin();
+                 it != runners->second.end(); ++it) {
+                (*it)->invalidate(dl);
             }
         }
 
-        // TODO: This requires optimization.  We walk through *all* CCs and send the delete to every
-        // CC open on the db we're deleting from.  We could:
-        // 1. Map from ns to open runners,
-        // 2. Map from ns -> (a map of DiskLoc -> runners who care about that DL)
+        // Send the delete to the runners of the CCs open on ns.
         //
-        // We could also queue invalidations somehow and have them processed later in the runner's
-        // read locks.
-        for (CCById::const_iterator it = clientCursorsById.begin(); it != clientCursorsById.end();
-             ++it) {
-
-            ClientCursor* cc = it->second;
-            // We're only interested in cursors over one db.
-            if (cc->_db != db) { continue; }
-            if (NULL == cc->_runner.get()) { continue; }
-            cc->_runner->invalidate(dl);
+        // TODO: We could map from ns -> (a map of DiskLoc -> runners who care about that DL), or
+        // queue invalidations somehow and have them processed later in the runner's read locks.
+        CCByNs::const_iterator ccs = clientCursorsByNs.find(nsString);
+        if (ccs != clientCursorsByNs.end()) {
+            for (CCSet::const_iterator it = ccs->second.begin(); it != ccs->second.end(); ++it) {
+                ClientCursor* cc = *it;
+                // We're only interested in cursors over one db.
+                if (cc->_db != db) { continue; }
+                if (NULL == cc->_runner.get()) { continue; }
+                cc->_runner->invalidate(dl);
+            }
         }
 
         // Begin cursor-only.  Only cursors that are in ccByLoc are processed here.
@@ -371,14 +373,19 @@ namespace mongo {
 
     void ClientCursor::registerRunner(Runner* runner) {
         recursive_scoped_lock lock(ccmutex);
-        verify(nonCachedRunners.end() == nonCachedRunners.find(runner));
-        nonCachedRunners.insert(runner);
+        set<Runner*>& runners = nonCachedRunners[runner->ns()];
+        verify(runners.end() == runners.find(runner));
+        runners.insert(runner);
     }
 
     void ClientCursor::deregisterRunner(Runner* runner) {
         recursive_scoped_lock lock(ccmutex);
-        verify(nonCachedRunners.end() != nonCachedRunners.find(runner));
-        nonCachedRunners.erase(runner);
+        RunnersByNs::iterator runners = nonCachedRunners.find(runner->ns());
+        verify(nonCachedRunners.end() != runners);
+        verify(1U == runners->second.erase(runner));
+        if (runners->second.empty()) {
+            nonCachedRunners.erase(runners);
+        }
     }
 
     void yieldOrSleepFor1Microsecond() {
@@ -491,22 +498,26 @@ namespace mongo {
             Lock::GlobalRead lk;
 
             recursive_scoped_lock cclock(ccmutex);
-            CCById::const_iterator it = clientCursorsById.begin();
-            while (it != clientCursorsById.end()) {
-                ClientCursor* cc = it->second;
-                if( cc->shouldTimeout(0) ) {
-                    numberTimedOut++;
-                    LOG(1) << "killing old cursor " << cc->_cursorid << ' ' << cc->_ns
-                           << " idle:" << cc->idleTime() << "ms\n";
-                    ClientCursor* toDelete = it->second;
-                    CursorId id = toDelete->cursorid();
-                    // This is what winds up removing it from the map.
-                    delete toDelete;
-                    it = clientCursorsById.upper_bound(id);
+            vector<CursorId> toDelete;
+            for (CCById::const_iterator it = clientCursorsById.begin();
+                 it != clientCursorsById.end(); ++it) {
+                if (it->second->shouldTimeout(0)) {
+                    toDelete.push_back(it->first);
                 }
-                else {
-                    ++it;
+            }
+
+            for (vector<CursorId>::const_iterator it = toDelete.begin(); it != toDelete.end();
+                 ++it) {
+                // Deleting a ClientCursor might delete others, so each one is looked up again.
+                ClientCursor* cc = find_inlock(*it, false);
+                if (!cc) {
+                    continue;
                 }
+                numberTimedOut++;
+                LOG(1) << "killing old cursor " << cc->_cursorid << ' ' << cc->_ns
+                       << " idle:" << cc->idleTime() << "ms\n";
+                // This is what winds up removing it from the maps.
+                delete cc;
             }
         }
     }
@@ -603,10 +614,11 @@ namespace mongo {
     void ClientCursor::find( const string& ns , set<CursorId>& all ) {
         recursive_scoped_lock lock(ccmutex);
 
-        for ( CCById::iterator i=clientCursorsById.begin(); i!=clientCursorsById.end(); ++i ) {
-            if ( i->second->_ns == ns )
-                all.insert( i->first );
-        }
+        CCByNs::const_iterator ccs = clientCursorsByNs.find(ns);
+        if (ccs == clientCursorsByNs.end())
+            return;
+        for ( CCSet::const_iterator i = ccs->second.begin(); i != ccs->second.end(); ++i )
+            all.insert( (*i)->_cursorid );
     }
 
     // static
@@ -41,6 +41,7 @@
 #include "mongo/db/matcher.h"
 #include "mongo/db/projection.h"
 #include "mongo/db/query/runner.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/s/collection_metadata.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/background.h"
@@ -276,15 +277,21 @@ namespace mongo {
 
         // A map from the CursorId to the ClientCursor behind it.
         // TODO: Consider making this per-connection.
-        typedef map<CursorId, ClientCursor*> CCById;
+        typedef unordered_map<CursorId, ClientCursor*> CCById;
         static CCById clientCursorsById;
 
-        // A list of NON-CACHED runners.  Any runner that yields must be put into this map before
-        // yielding in order to be notified of invalidation and namespace deletion.  Before the
-        // runner is deleted, it must be removed from this map.
-        //
-        // TODO: This is temporary and as such is highly NOT optimized.
-        static set<Runner*> nonCachedRunners;
+        // The same ClientCursors, by the namespace they are over, so that invalidating a
+        // namespace or a DiskLoc in it only looks at the cursors over that namespace.  Ordered so
+        // that all the namespaces of a db are next to each other.
+        typedef set<ClientCursor*> CCSet;
+        typedef map<string, CCSet> CCByNs;
+        static CCByNs clientCursorsByNs;
+
+        // The NON-CACHED runners, by namespace.  Any runner that yields must be put into this map
+        // before yielding in order to be notified of invalidation and namespace deletion.  Before
+        // the runner is deleted, it must be removed from this map.
+        typedef map<string, set<Runner*> > RunnersByNs;
+        static RunnersByNs nonCachedRunners;
 
         // How many cursors have timed out?
         static long long numberTimedOut;
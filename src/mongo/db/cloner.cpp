@@ -30,6 +30,8 @@
 
 #include "mongo/pch.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/base/init.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
@@ -122,8 +124,11 @@ namespace mongo {
                 context->relocked();
             }
 
+            // the documents of a batch are inserted together, before each yield and at its end
+            vector<BSONObj> docs;
             while( i.moreInCurrentBatch() ) {
                 if ( n % 128 == 127 /*yield some*/ ) {
+                    insertDocs( docs );
                     time_t now = time(0);
                     if( now - lastLog >= 60 ) { 
                         // report progress
@@ -163,6 +168,37 @@ namespace mongo {
                     continue;
                 }
 
+                docs.push_back( js );
+
+                RARELY if ( time( 0 ) - saveLast > 60 ) {
+                    log() << n << " objects cloned so far from collection " << from_collection << endl;
+                    saveLast = time( 0 );
+                }
+            }
+            insertDocs( docs );
+        }
+
+        /**
+         * inserts docs into to_collection and clears it.  they go in through the bulk insert path
+         * when to_collection takes it; the ones that don't, one at a time, which says why.
+         */
+        void insertDocs( vector<BSONObj>& docs ) {
+            size_t done = 0;
+            Collection* collection = cc().database()->getCollection( to_collection );
+            if ( collection && !collection->details()->isCapped() &&
+                 NamespaceString::normal( to_collection ) &&
+                 !NamespaceString( to_collection ).isSystem() ) {
+                vector<bool> inserted;
+                theDataFileMgr.insertBatchWithObjMod( to_collection, docs, true, &inserted );
+                for ( ; done < docs.size() && inserted[done]; done++ ) {
+                    if ( logForRepl )
+                        logOp("i", to_collection, docs[done]);
+                }
+                getDur().commitIfNeeded();
+            }
+
+            for ( ; done < docs.size(); done++ ) {
+                BSONObj& js = docs[done];
                 try {
                     DiskLoc loc = theDataFileMgr.insertWithObjMod(to_collection, js);
                     loc.assertOk();
@@ -175,12 +211,8 @@ namespace mongo {
                     error() << "error: exception cloning object in " << from_collection << ' ' << e.what() << " obj:" << js.toString() << '\n';
                     throw;
                 }
-
-                RARELY if ( time( 0 ) - saveLast > 60 ) {
-                    log() << n << " objects cloned so far from collection " << from_collection << endl;
-                    saveLast = time( 0 );
-                }
             }
+            docs.clear();
         }
         int n;
         bool isindex;
@@ -225,24 +257,53 @@ namespace mongo {
         }
 
         if ( storedForLater.size() ) {
+            // the indexes of a collection are built together, with one scan of it
+            vector<string> namespaces;
+            map<string, vector<BSONObj> > specsByNs;
             for (list<BSONObj>::const_iterator i = storedForLater.begin();
                  i != storedForLater.end();
                  ++i) {
-                BSONObj js = *i;
-                try {
-                    theDataFileMgr.insertWithObjMod(to_collection, js);
-
-                    if ( logForRepl )
-                        logOp("i", to_collection, js);
+                string ns = i->getStringField("ns");
+                if ( !specsByNs.count( ns ) )
+                    namespaces.push_back( ns );
+                specsByNs[ns].push_back( *i );
+            }
 
+            Database* db = cc().database();
+            for ( size_t i = 0; i < namespaces.size(); i++ ) {
+                const vector<BSONObj>& specs = specsByNs[namespaces[i]];
+                Collection* collection =
+                    db->ownsNS( namespaces[i] ) ? db->getCollection( namespaces[i] ) : NULL;
+                if ( collection ) {
+                    Status status = collection->getIndexCatalog()->createIndexes( specs, false );
+                    if ( !status.isOK() ) {
+                        error() << "error: exception cloning indexes of " << namespaces[i]
+                                << ' ' << status.toString() << '\n';
+                        uassertStatusOK( status );
+                    }
+                    if ( logForRepl ) {
+                        for ( size_t j = 0; j < specs.size(); j++ )
+                            logOp("i", to_collection, specs[j]);
+                    }
                     getDur().commitIfNeeded();
+                    continue;
                 }
-                catch( UserException& e ) {
-                    error() << "error: exception cloning object in " << from_collection << ' ' << e.what() << " obj:" << js.toString() << '\n';
-                    throw;
-                }
-                catch(const DBException&) {
-                    throw;
+
+                // through system.indexes, which creates the collection or says why it can't
+                for ( size_t j = 0; j < specs.size(); j++ ) {
+                    BSONObj js = specs[j];
+                    try {
+                        theDataFileMgr.insertWithObjMod(to_collection, js);
+
+                        if ( logForRepl )
+                            logOp("i", to_collection, js);
+
+                        getDur().commitIfNeeded();
+                    }
+                    catch( UserException& e ) {
+                        error() << "error: exception cloning object in " << from_collection << ' ' << e.what() << " obj:" << js.toString() << '\n';
+                        throw;
+                    }
                 }
             }
         }
@@ -328,6 +389,123 @@ namespace mongo {
 
     }
 
+    void Cloner::cloneCollection(const BSONObj& collection, const CloneOptions& opts,
+                                 bool masterSameProcess) {
+        string todb = cc().database()->name();
+        LOG(2) << "  really will clone: " << collection << endl;
+        const char * from_name = collection["name"].valuestr();
+        BSONObj options = collection.getObjectField("options");
+
+        /* change name "<fromdb>.collection" -> <todb>.collection */
+        const char *p = strchr(from_name, '.');
+        verify(p);
+        string to_name = todb + p;
+
+        bool wantIdIndex = false;
+        {
+            string err;
+            const char *toname = to_name.c_str();
+            /* we defer building id index for performance - building it in batch is much faster */
+            userCreateNS(toname, options, err, opts.logForRepl, &wantIdIndex);
+        }
+        LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
+        Query q;
+        if( opts.snapshot )
+            q.snapshot();
+        copy(from_name, to_name.c_str(), false, opts.logForRepl, masterSameProcess, opts.slaveOk, opts.mayYield, opts.mayBeInterrupted, q);
+
+        if( wantIdIndex ) {
+            /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
+               that occur during the initial sync.  inDBRepair makes dropDups be true.
+               the database stays write locked from here until inDBRepair is restored, so parallel
+               clones of the database's other collections do not see it.
+               */
+            bool old = inDBRepair;
+            try {
+                inDBRepair = true;
+                Collection* c = cc().database()->getCollection( to_name );
+                if ( c )
+                    c->getIndexCatalog()->ensureHaveIdIndex();
+                inDBRepair = old;
+            }
+            catch(...) {
+                inDBRepair = old;
+                throw;
+            }
+        }
+    }
+
+    /** The collections still to be cloned in parallel, and the first error a thread hit. */
+    struct Cloner::ParallelClone {
+        ParallelClone() : m("ParallelClone"), errCode(0) { }
+        mongo::mutex m;
+        list<BSONObj> toClone;
+        string errmsg;
+        int errCode;
+    };
+
+    void Cloner::cloneThread(const string& masterHost, const string& todb,
+                             const CloneOptions& opts, ParallelClone* state) {
+        Client::initThread("clonecollection");
+        cc().getAuthorizationSession()->grantInternalAuthorization();
+        try {
+            Cloner cloner;
+            string errmsg;
+            ConnectionString cs = ConnectionString::parse( masterHost, errmsg );
+            auto_ptr<DBClientBase> con( cs.connect( errmsg ) );
+            uassert( 17288, str::stream() << "could not connect to " << masterHost << ": "
+                                          << errmsg,
+                     con.get() );
+            uassert( 17289, str::stream() << "could not authenticate to " << masterHost,
+                     replAuthenticate( con.get() ) );
+            cloner._conn = con;
+
+            while ( true ) {
+                BSONObj collection;
+                {
+                    mongo::mutex::scoped_lock lk( state->m );
+                    if ( state->toClone.empty() || !state->errmsg.empty() )
+                        break;
+                    collection = state->toClone.front();
+                    state->toClone.pop_front();
+                }
+                Client::WriteContext ctx( todb );
+                mayInterrupt( opts.mayBeInterrupted );
+                cloner.cloneCollection( collection, opts, false );
+            }
+        }
+        catch ( const DBException& e ) {
+            mongo::mutex::scoped_lock lk( state->m );
+            if ( state->errmsg.empty() ) {
+                state->errmsg = e.toString();
+                state->errCode = e.getCode();
+            }
+        }
+        cc().shutdown();
+    }
+
+    void Cloner::cloneInParallel(const char* masterHost, const CloneOptions& opts,
+                                 const list<BSONObj>& toClone) {
+        ParallelClone state;
+        state.toClone = toClone;
+        const string todb = cc().database()->name();
+        const int nThreads = std::min( opts.cloneThreads, static_cast<int>( toClone.size() ) );
+        LOG(1) << "\t cloning " << toClone.size() << " collections with " << nThreads
+               << " connections" << endl;
+        {
+            // each thread locks the database for itself
+            dbtempreleaseif r( opts.mayYield );
+            boost::thread_group threads;
+            for ( int i = 0; i < nThreads; i++ ) {
+                threads.create_thread( boost::bind( &Cloner::cloneThread, string( masterHost ),
+                                                    todb, boost::cref( opts ), &state ) );
+            }
+            threads.join_all();
+        }
+        if ( !state.errmsg.empty() )
+            uasserted( state.errCode, state.errmsg );
+    }
+
     bool Cloner::go(const char *masterHost, const CloneOptions& opts, set<string>& clonedColls,
                     string& errmsg, int* errCode) {
         if ( errCode ) {
@@ -435,50 +613,17 @@ namespace mongo {
             }
         }
 
-        for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
-            {
-                mayInterrupt( opts.mayBeInterrupted );
-                dbtempreleaseif r( opts.mayYield );
-            }
-            BSONObj collection = *i;
-            LOG(2) << "  really will clone: " << collection << endl;
-            const char * from_name = collection["name"].valuestr();
-            BSONObj options = collection.getObjectField("options");
-
-            /* change name "<fromdb>.collection" -> <todb>.collection */
-            const char *p = strchr(from_name, '.');
-            verify(p);
-            string to_name = todb + p;
-
-            bool wantIdIndex = false;
-            {
-                string err;
-                const char *toname = to_name.c_str();
-                /* we defer building id index for performance - building it in batch is much faster */
-                userCreateNS(toname, options, err, opts.logForRepl, &wantIdIndex);
-            }
-            LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
-            Query q;
-            if( opts.snapshot )
-                q.snapshot();
-            copy(from_name, to_name.c_str(), false, opts.logForRepl, masterSameProcess, opts.slaveOk, opts.mayYield, opts.mayBeInterrupted, q);
-
-            if( wantIdIndex ) {
-                /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
-                   that occur during the initial sync.  inDBRepair makes dropDups be true.
-                   */
-                bool old = inDBRepair;
-                try {
-                    inDBRepair = true;
-                    Collection* c = cc().database()->getCollection( to_name );
-                    if ( c )
-                        c->getIndexCatalog()->ensureHaveIdIndex();
-                    inDBRepair = old;
-                }
-                catch(...) {
-                    inDBRepair = old;
-                    throw;
+        if ( opts.cloneThreads > 1 && toClone.size() > 1 && opts.mayYield &&
+             !masterSameProcess ) {
+            cloneInParallel(masterHost, opts, toClone);
+        }
+        else {
+            for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
+                {
+                    mayInterrupt( opts.mayBeInterrupted );
+                    dbtempreleaseif r( opts.mayYield );
                 }
+                cloneCollection(*i, opts, masterSameProcess);
             }
         }
 
@@ -104,6 +104,24 @@ namespace mongo {
                   bool masterSameProcess, bool slaveOk, bool mayYield, bool mayBeInterrupted,
                   Query q);
 
+        /**
+         * Creates the collection described by its system.namespaces entry in the current
+         * database, copies its documents and builds its _id index.
+         */
+        void cloneCollection(const BSONObj& collection, const CloneOptions& opts,
+                             bool masterSameProcess);
+
+        /**
+         * Clones the collections of toClone into the current database on opts.cloneThreads
+         * threads, each with its own connection to masterHost.
+         */
+        void cloneInParallel(const char* masterHost, const CloneOptions& opts,
+                             const list<BSONObj>& toClone);
+
+        struct ParallelClone;
+        static void cloneThread(const string& masterHost, const string& todb,
+                                const CloneOptions& opts, ParallelClone* state);
+
         struct Fun;
         auto_ptr<DBClientBase> _conn;
     };
@@ -120,6 +138,8 @@ namespace mongo {
 
             syncData = true;
             syncIndexes = true;
+
+            cloneThreads = 1;
         }
             
         string fromDB;
@@ -134,6 +154,10 @@ namespace mongo {
 
         bool syncData;
         bool syncIndexes;
+
+        // connections to clone collections over at once.  used only with mayYield, and not
+        // cloning from this process
+        int cloneThreads;
     };
 
 } // namespace mongo
@@ -34,11 +34,19 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/database.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/hex.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/timer.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
+    // Collections one dbHash hashes at once.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(dbHashThreads, int, 4);
+
     DBHashCmd dbhashCmd;
 
 
@@ -51,6 +59,125 @@ namespace mongo {
         dbhashCmd.wipeCacheForCollection( ns );
     }
 
+namespace {
+
+    /**
+     * Hashes a run of documents in order, with MD5 or with the faster MurmurHash3.  MurmurHash3
+     * has no incremental form, so each document is hashed alone and folded into the hash so far.
+     */
+    class RunningHash {
+    public:
+        explicit RunningHash( bool fast ) : _fast( fast ) {
+            if ( _fast )
+                memset( _murmur, 0, sizeof( _murmur ) );
+            else
+                md5_init( &_md5 );
+        }
+
+        void append( const char* data, int len ) {
+            if ( !_fast ) {
+                md5_append( &_md5, reinterpret_cast<const md5_byte_t*>( data ), len );
+                return;
+            }
+            uint64_t fold[4];
+            memcpy( fold, _murmur, sizeof( _murmur ) );
+            MurmurHash3_x64_128( data, len, 0, fold + 2 );
+            MurmurHash3_x64_128( fold, sizeof( fold ), 0, _murmur );
+        }
+
+        string finish() {
+            if ( _fast )
+                return toHexLower( _murmur, sizeof( _murmur ) );
+            md5digest d;
+            md5_finish( &_md5, d );
+            return digestToString( d );
+        }
+
+    private:
+        bool _fast;
+        md5_state_t _md5;
+        uint64_t _murmur[2];
+    };
+
+    /**
+     * Hashes the documents of the _id index 'desc' from 'start' up to 'end', or to the end of the
+     * index if 'end' is empty, into 'ranges', starting a range at each boundary.  If 'start' is a
+     * boundary that no longer is in the collection, the range before it takes its documents and
+     * is marked to be hashed again instead.  Returns the number of ranges hashed.
+     */
+    long long hashRange( IndexDescriptor* desc, const BSONObj& start, const BSONObj& end,
+                         bool fast, CollectionHashCache::RangeMap* ranges ) {
+        auto_ptr<Runner> runner( InternalPlanner::indexScan( desc, start, end, false,
+                                                             InternalPlanner::FORWARD,
+                                                             InternalPlanner::IXSCAN_FETCH ) );
+
+        BSONObj rangeStart = start;
+        bool startFound = start.firstElement().type() == MinKey;
+        RunningHash hash( fast );
+        long long n = 0;
+
+        Runner::RunnerState state;
+        BSONObj c;
+        while ( Runner::RUNNER_ADVANCED == ( state = runner->getNext( &c, NULL ) ) ) {
+            BSONElement id = c["_id"];
+            if ( !startFound ) {
+                if ( CollectionHashCache::rangeKey( id ).woCompare( start ) != 0 )
+                    break;
+                startFound = true;
+            }
+            else if ( CollectionHashCache::isBoundary( id ) ) {
+                BSONObj key = CollectionHashCache::rangeKey( id );
+                if ( key.woCompare( rangeStart ) != 0 ) {
+                    (*ranges)[rangeStart] = hash.finish();
+                    ++n;
+                    hash = RunningHash( fast );
+                    rangeStart = key;
+                }
+            }
+            hash.append( c.objdata(), c.objsize() );
+        }
+
+        if ( !startFound ) {
+            CollectionHashCache::RangeMap::iterator prev = ranges->lower_bound( start );
+            verify( prev != ranges->begin() );
+            --prev;
+            prev->second.clear();
+            return n;
+        }
+
+        (*ranges)[rangeStart] = hash.finish();
+        return n + 1;
+    }
+
+    mongo::mutex hashPoolMutex( "dbHash pool" );
+    ThreadPool* hashPool = NULL;
+
+    ThreadPool* getHashPool() {
+        scoped_lock lk( hashPoolMutex );
+        if ( NULL == hashPool ) {
+            // Lives as long as the process.
+            hashPool = new ThreadPool( dbHashThreads );
+        }
+        return hashPool;
+    }
+
+} // namespace
+
+    struct DBHashCmd::HashJob {
+        HashJob() : collection( NULL ), fast( false ), incremental( false ), fromCache( false ),
+                    rangesHashed( 0 ) {}
+
+        Collection* collection;
+        string fullCollectionName;
+        bool fast;
+        bool incremental;
+
+        string hash;
+        bool fromCache;
+        long long rangesHashed;
+        string error;
+    };
+
     // ----
 
     DBHashCmd::DBHashCmd()
@@ -66,11 +193,14 @@ namespace mongo {
         out->push_back(Privilege(ResourcePattern::forDatabaseName(dbname), actions));
     }
 
-    string DBHashCmd::hashCollection( const string& fullCollectionName, bool* fromCache ) {
+    string DBHashCmd::hashCollection( Collection* collection,
+                                      const string& fullCollectionName,
+                                      bool fast,
+                                      bool* fromCache ) {
 
         scoped_ptr<scoped_lock> cachedHashedLock;
 
-        if ( isCachable( fullCollectionName ) ) {
+        if ( !fast && isCachable( fullCollectionName ) ) {
             cachedHashedLock.reset( new scoped_lock( _cachedHashedMutex ) );
             string hash = _cachedHashed[fullCollectionName];
             if ( hash.size() > 0 ) {
@@ -80,7 +210,6 @@ namespace mongo {
         }
 
         *fromCache = false;
-        Collection* collection = cc().database()->getCollection( fullCollectionName );
         if ( !collection )
             return "";
 
@@ -103,23 +232,20 @@ namespace mongo {
             return "no _id _index";
         }
 
-        md5_state_t st;
-        md5_init(&st);
+        RunningHash st( fast );
 
         long long n = 0;
         Runner::RunnerState state;
         BSONObj c;
         verify(NULL != runner.get());
         while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&c, NULL))) {
-            md5_append( &st , (const md5_byte_t*)c.objdata() , c.objsize() );
+            st.append( c.objdata() , c.objsize() );
             n++;
         }
         if (Runner::RUNNER_EOF != state) {
             warning() << "error while hashing, db dropped? ns=" << fullCollectionName << endl;
         }
-        md5digest d;
-        md5_finish(&st, d);
-        string hash = digestToString( d );
+        string hash = st.finish();
 
         if ( cachedHashedLock.get() ) {
             _cachedHashed[fullCollectionName] = hash;
@@ -128,6 +254,85 @@ namespace mongo {
         return hash;
     }
 
+    string DBHashCmd::hashCollectionRanges( Collection* collection,
+                                            const string& fullCollectionName,
+                                            bool fast,
+                                            bool* fromCache,
+                                            long long* rangesHashed ) {
+        // capped collections are hashed whole, in natural order
+        IndexDescriptor* desc = collection ? collection->getIndexCatalog()->findIdIndex() : NULL;
+        if ( !desc || collection->details()->isCapped() )
+            return hashCollection( collection, fullCollectionName, fast, fromCache );
+
+        CollectionHashCache* cache = collection->hashCache();
+        scoped_lock lk( cache->getMutex() );
+        CollectionHashCache::RangeMap& ranges = cache->ranges();
+
+        const string hashType = fast ? "murmur3" : "md5";
+        if ( cache->getHashType() != hashType ) {
+            ranges.clear();
+            cache->setHashType( hashType );
+        }
+
+        *fromCache = !ranges.empty();
+        if ( ranges.empty() ) {
+            BSONObjBuilder minKey;
+            minKey.appendMinKey( "" );
+            *rangesHashed += hashRange( desc, minKey.obj(), BSONObj(), fast, &ranges );
+        }
+        else {
+            // last to first, so that a range whose start went away hands its documents to the
+            // one before it, which comes next
+            CollectionHashCache::RangeMap::iterator i = ranges.end();
+            while ( i != ranges.begin() ) {
+                --i;
+                if ( !i->second.empty() )
+                    continue;
+
+                *fromCache = false;
+                CollectionHashCache::RangeMap::iterator next = i;
+                ++next;
+                const BSONObj start = i->first;
+                const BSONObj end = next == ranges.end() ? BSONObj() : next->first;
+                ranges.erase( i );
+                *rangesHashed += hashRange( desc, start, end, fast, &ranges );
+                i = ranges.lower_bound( start );
+            }
+        }
+
+        RunningHash hash( fast );
+        for ( CollectionHashCache::RangeMap::const_iterator i = ranges.begin();
+              i != ranges.end(); ++i ) {
+            hash.append( i->second.data(), i->second.size() );
+        }
+        return hash.finish();
+    }
+
+    void DBHashCmd::runHashJob( HashJob* job ) {
+        // The Client of a pool thread holds no lock; the thread that scheduled us holds the read
+        // lock until we are done.
+        Client::initThreadIfNotAlready( "dbHash worker" );
+
+        try {
+            if ( job->incremental ) {
+                job->hash = dbhashCmd.hashCollectionRanges( job->collection,
+                                                            job->fullCollectionName,
+                                                            job->fast,
+                                                            &job->fromCache,
+                                                            &job->rangesHashed );
+            }
+            else {
+                job->hash = dbhashCmd.hashCollection( job->collection,
+                                                      job->fullCollectionName,
+                                                      job->fast,
+                                                      &job->fromCache );
+            }
+        }
+        catch ( const std::exception& e ) {
+            job->error = e.what();
+        }
+    }
+
     bool DBHashCmd::run(const string& dbname , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
         Timer timer;
 
@@ -144,6 +349,24 @@ namespace mongo {
             }
         }
 
+        // "md5", or "murmur3" which is several times cheaper.  Every member compared has to be
+        // asked for the same one.
+        string hashType = "md5";
+        if ( cmdObj.hasField( "hashType" ) ) {
+            if ( cmdObj["hashType"].type() != String ||
+                 ( cmdObj["hashType"].String() != "md5" &&
+                   cmdObj["hashType"].String() != "murmur3" ) ) {
+                errmsg = "hashType has to be \"md5\" or \"murmur3\"";
+                return false;
+            }
+            hashType = cmdObj["hashType"].String();
+        }
+
+        // Hashes collections as the hash of the ranges of their _id index, keeping the hashes of
+        // the ranges so that hashing again only rereads the ranges written to since.  These
+        // hashes differ from the default ones.
+        const bool incremental = cmdObj["incremental"].trueValue();
+
         list<string> colls;
         Database* db = cc().database();
         if ( db )
@@ -153,12 +376,7 @@ namespace mongo {
         result.appendNumber( "numCollections" , (long long)colls.size() );
         result.append( "host" , prettyHostName() );
 
-        md5_state_t globalState;
-        md5_init(&globalState);
-
-        vector<string> cached;
-
-        BSONObjBuilder bb( result.subobjStart( "collections" ) );
+        vector<HashJob> jobs;
         for ( list<string>::iterator i=colls.begin(); i != colls.end(); i++ ) {
             string fullCollectionName = *i;
             string shortCollectionName = fullCollectionName.substr( dbname.size() + 1 );
@@ -170,14 +388,49 @@ namespace mongo {
                  desiredCollections.count( shortCollectionName ) == 0 )
                 continue;
 
-            bool fromCache = false;
-            string hash = hashCollection( fullCollectionName, &fromCache );
+            HashJob job;
+            job.collection = db->getCollection( fullCollectionName );
+            job.fullCollectionName = fullCollectionName;
+            job.fast = hashType == "murmur3";
+            job.incremental = incremental;
+            jobs.push_back( job );
+        }
+
+        if ( dbHashThreads > 1 && jobs.size() > 1 ) {
+            TaskGroup group( *getHashPool() );
+            for ( size_t i = 0; i < jobs.size(); ++i ) {
+                group.schedule( &DBHashCmd::runHashJob, &jobs[i] );
+            }
+            group.wait();
+        }
+        else {
+            for ( size_t i = 0; i < jobs.size(); ++i ) {
+                runHashJob( &jobs[i] );
+            }
+        }
+
+        md5_state_t globalState;
+        md5_init(&globalState);
+
+        vector<string> cached;
+        long long rangesHashed = 0;
+
+        BSONObjBuilder bb( result.subobjStart( "collections" ) );
+        for ( size_t i = 0; i < jobs.size(); ++i ) {
+            const HashJob& job = jobs[i];
+            if ( !job.error.empty() ) {
+                errmsg = str::stream() << "error hashing " << job.fullCollectionName << ": "
+                                       << job.error;
+                return false;
+            }
 
-            bb.append( shortCollectionName, hash );
+            string shortCollectionName = job.fullCollectionName.substr( dbname.size() + 1 );
+            bb.append( shortCollectionName, job.hash );
 
-            md5_append( &globalState , (const md5_byte_t*)hash.c_str() , hash.size() );
-            if ( fromCache )
-                cached.push_back( fullCollectionName );
+            md5_append( &globalState , (const md5_byte_t*)job.hash.c_str() , job.hash.size() );
+            if ( job.fromCache )
+                cached.push_back( job.fullCollectionName );
+            rangesHashed += job.rangesHashed;
         }
         bb.done();
 
@@ -186,9 +439,12 @@ namespace mongo {
         string hash = digestToString( d );
 
         result.append( "md5" , hash );
+        result.append( "hashType", hashType );
         result.appendNumber( "timeMillis", timer.millis() );
 
         result.append( "fromCache", cached );
+        if ( incremental )
+            result.appendNumber( "rangesHashed", rangesHashed );
 
         return 1;
     }
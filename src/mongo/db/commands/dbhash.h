@@ -34,6 +34,8 @@
 
 namespace mongo {
 
+    class Collection;
+
     void logOpForDbHash( const char* opstr,
                          const char* ns,
                          const BSONObj& obj,
@@ -57,9 +59,23 @@ namespace mongo {
 
     private:
 
+        struct HashJob;
+
+        /** Hashes the collection of 'job' into it.  Runs on the pool threads too. */
+        static void runHashJob( HashJob* job );
+
         bool isCachable( const StringData& ns ) const;
 
-        string hashCollection( const string& fullCollectionName, bool* fromCache );
+        string hashCollection( Collection* collection,
+                               const string& fullCollectionName,
+                               bool fast,
+                               bool* fromCache );
+
+        string hashCollectionRanges( Collection* collection,
+                                     const string& fullCollectionName,
+                                     bool fast,
+                                     bool* fromCache,
+                                     long long* rangesHashed );
 
         map<string,string> _cachedHashed;
         mutex _cachedHashedMutex;
@@ -107,14 +107,16 @@ namespace mongo {
 
             if (newDistinct) {
                 CanonicalQuery* cq;
-                // XXX: project out just the field we're distinct-ing.  May be covered.
                 if (!CanonicalQuery::canonicalize(ns, query, &cq).isOK()) {
                     uasserted(17215, "Can't canonicalize query " + query.toString());
                     return 0;
                 }
 
+                // If an index can provide the values, the runner returns one index key per value
+                // instead of every matching document.
                 Runner* rawRunner;
-                if (!getRunner(cq, &rawRunner).isOK()) {
+                bool isIndexKeys;
+                if (!getRunnerDistinct(cq, key, &rawRunner, &isIndexKeys).isOK()) {
                     uasserted(17216, "Can't get runner for query " + query.toString());
                     return 0;
                 }
@@ -126,10 +128,24 @@ namespace mongo {
                 safety.reset(new DeregisterEvenIfUnderlyingCodeThrows(runner.get()));
 
                 BSONObj obj;
+                DiskLoc loc;
                 Runner::RunnerState state;
-                while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&obj, NULL))) {
+                while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&obj, &loc))) {
                     BSONElementSet elts;
-                    obj.getFieldsDotted(key, elts);
+                    if (isIndexKeys) {
+                        BSONElement keyElt = obj.firstElement();
+                        if (jstNULL == keyElt.type() || Undefined == keyElt.type()) {
+                            // The key can't tell a missing field from a null one, so the
+                            // document has to.
+                            loc.obj().getFieldsDotted(key, elts);
+                        }
+                        else {
+                            elts.insert(keyElt);
+                        }
+                    }
+                    else {
+                        obj.getFieldsDotted(key, elts);
+                    }
 
                     for (BSONElementSet::iterator it = elts.begin(); it != elts.end(); ++it) {
                         BSONElement elt = *it;
@@ -136,7 +136,11 @@ namespace mongo {
             Client::Context cx( ns );
 
             BSONObj doc;
-            bool found = Helpers::findOne( ns.c_str() , queryOriginal , doc );
+            DiskLoc loc = Helpers::findOne( ns , queryOriginal , false );
+            bool found = !loc.isNull();
+            if ( found ) {
+                doc = loc.obj();
+            }
 
             BSONObj queryModified = queryOriginal;
             if ( found && doc["_id"].type() && ! isSimpleIdQuery( queryOriginal ) ) {
@@ -225,6 +229,12 @@ namespace mongo {
                     request.setUpdates(update);
                     request.setUpsert(upsert);
                     request.setUpdateOpLog();
+                    // The update applies to the document we just found, under the same lock,
+                    // and hands back the new version of it rather than us looking it up again.
+                    if ( found ) {
+                        request.setLoc(loc);
+                    }
+                    request.setStoreResultDoc(returnNew);
                     // TODO(greg) We need to send if we are ignoring
                     // the shard version below, but for now no
                     UpdateLifecycleImpl updateLifecycle(false, requestNs);
@@ -233,19 +243,7 @@ namespace mongo {
 
                     LOG(3) << "update result: "  << res ;
                     if ( returnNew ) {
-                        if ( !res.upserted.isEmpty() ) {
-                            BSONElement upsertedElem = res.upserted[kUpsertedFieldName];
-                            LOG(3) << "using new _id to get new doc: "
-                                   << upsertedElem;
-                            queryModified = upsertedElem.wrap("_id");
-                        }
-                        else if ( queryModified["_id"].type() ) {
-                            // we do this so that if the update changes the fields, it still matches
-                            queryModified = queryModified["_id"].wrap();
-                        }
-
-                        LOG(3) << "using modified query to return the new doc: " << queryModified;
-                        if ( ! Helpers::findOne( ns.c_str() , queryModified , doc ) ) {
+                        if ( res.newObj.isEmpty() ) {
                             errmsg = str::stream() << "can't find object after modification  " 
                                                    << " ns: " << ns 
                                                    << " queryModified: " << queryModified 
@@ -253,7 +251,7 @@ namespace mongo {
                             log() << errmsg << endl;
                             return false;
                         }
-                        _appendHelper( result , doc , true , fields );
+                        _appendHelper( result , res.newObj , true , fields );
                     }
                     
                     BSONObjBuilder le( result.subobjStart( "lastErrorObject" ) );
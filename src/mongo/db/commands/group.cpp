@@ -30,6 +30,7 @@
 
 #include "mongo/pch.h"
 
+#include <limits>
 #include <vector>
 
 #include "mongo/db/auth/authorization_session.h"
@@ -51,6 +52,310 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(newGroup, bool, true);
 
+    // Run $reduce functions that only add up numbers without JavaScript.
+    MONGO_EXPORT_SERVER_PARAMETER(nativeGroupReduce, bool, true);
+
+namespace {
+
+    /**
+     * Splits "code" into identifiers, numbers and the punctuation SimpleReduce understands.
+     * Returns false for anything else, comments included.
+     */
+    bool tokenizeReduce(const string& code, vector<string>* tokens) {
+        size_t i = 0;
+        while (i < code.size()) {
+            const unsigned char c = code[i];
+            if (isspace(c)) {
+                i++;
+                continue;
+            }
+            const size_t start = i;
+            if (isalpha(c) || c == '_' || c == '$') {
+                while (i < code.size() && (isalnum(static_cast<unsigned char>(code[i])) ||
+                                           code[i] == '_' || code[i] == '$'))
+                    i++;
+            }
+            else if (isdigit(c)) {
+                while (i < code.size() && (isdigit(static_cast<unsigned char>(code[i])) ||
+                                           code[i] == '.'))
+                    i++;
+            }
+            else if (c == '+' && i + 1 < code.size() && (code[i + 1] == '+' ||
+                                                         code[i + 1] == '=')) {
+                i += 2;
+            }
+            else if (c != '\0' && strchr("(){},;.+=", c)) {
+                i++;
+            }
+            else {
+                return false;
+            }
+            tokens->push_back(code.substr(start, i - start));
+        }
+        return true;
+    }
+
+    /**
+     * Whether group() can build a JavaScript object from "field" and convert it back the way the
+     * scope would.  Top level numbers come back as doubles, except NumberLong; objects and arrays
+     * aren't handled, nor are names V8 would treat as array indexes and reorder.
+     */
+    bool roundTrips(const BSONElement& field) {
+        if (isdigit(static_cast<unsigned char>(field.fieldName()[0])))
+            return false;
+        switch (field.type()) {
+        case NumberDouble:
+        case NumberInt:
+        case NumberLong:
+        case String:
+        case Bool:
+        case jstNULL:
+        case jstOID:
+        case Date:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void appendRoundTripped(BSONObjBuilder& b, const BSONElement& field) {
+        if (field.type() == NumberDouble || field.type() == NumberInt)
+            b.append(field.fieldName(), field.number());
+        else
+            b.append(field);
+    }
+
+    /**
+     * A $reduce function whose statements each add a constant, or a field of the document, to a
+     * numeric field of the initial object, e.g.
+     *     function(obj, prev) { prev.count++; prev.total += obj.price; }
+     * group() runs these without JavaScript, with the same results.
+     */
+    class SimpleReduce {
+    public:
+        /**
+         * Returns false if "code" isn't of that form, or if "initial" holds something
+         * roundTrips() doesn't handle.
+         */
+        bool parse(const string& code, const BSONObj& initial) {
+            vector<string> tokens;
+            if (!tokenizeReduce(code, &tokens))
+                return false;
+
+            BSONObjIterator it(initial);
+            while (it.more()) {
+                if (!roundTrips(it.next()))
+                    return false;
+            }
+            _initial = initial;
+
+            Parser p(tokens);
+            string obj, prev;
+            if (!p.accept("function") || !p.accept("(") || !p.identifier(&obj) ||
+                !p.accept(",") || !p.identifier(&prev) || !p.accept(")") || !p.accept("{") ||
+                obj == prev)
+                return false;
+
+            while (!p.accept("}")) {
+                if (p.accept(";"))
+                    continue;
+
+                Statement st;
+                st.constant = 0;
+                string target;
+                if (p.accept("++")) {
+                    if (!p.field(prev, &target))
+                        return false;
+                    st.constant = 1;
+                }
+                else {
+                    if (!p.field(prev, &target))
+                        return false;
+                    if (p.accept("++")) {
+                        st.constant = 1;
+                    }
+                    else if (p.accept("+=")) {
+                        if (!p.operand(obj, &st.sourceField, &st.constant))
+                            return false;
+                    }
+                    else if (p.accept("=")) {
+                        // prev.f = prev.f + x
+                        string again;
+                        if (!p.field(prev, &again) || again != target || !p.accept("+") ||
+                            !p.operand(obj, &st.sourceField, &st.constant))
+                            return false;
+                    }
+                    else {
+                        return false;
+                    }
+                }
+                if (!p.accept(";") && !p.peek("}"))
+                    return false;
+
+                if (!addTarget(target, &st.target))
+                    return false;
+                _statements.push_back(st);
+            }
+            p.accept(";");
+            return p.atEnd();
+        }
+
+        /** The values of the fields being added to, before any documents are reduced. */
+        const vector<double>& initialValues() const { return _initialValues; }
+
+        /**
+         * Reduces "obj" into "values".  Returns false if the function would do something other
+         * than add numbers, like concatenating a string.
+         */
+        bool reduce(const BSONObj& obj, vector<double>* values) const {
+            for (size_t i = 0; i < _statements.size(); i++) {
+                const Statement& st = _statements[i];
+                double x = st.constant;
+                if (!st.sourceField.empty()) {
+                    BSONElement e = obj[st.sourceField];
+                    if (e.eoo() || e.type() == Undefined)
+                        x = std::numeric_limits<double>::quiet_NaN();
+                    else if (e.isNumber())
+                        x = e.number();
+                    else if (e.type() == jstNULL)
+                        x = 0;
+                    else if (e.type() == Bool)
+                        x = e.boolean() ? 1 : 0;
+                    else
+                        return false;
+                }
+                (*values)[st.target] += x;
+            }
+            return true;
+        }
+
+        /**
+         * Appends a group's result to "arr", with the key's fields first and then those only in
+         * the initial object, as Object.extend() builds it.
+         */
+        void appendResult(const BSONObj& key,
+                          const vector<double>& values,
+                          BSONArrayBuilder* arr) const {
+            BSONObjBuilder b(arr->subobjStart());
+            BSONObjIterator k(key);
+            while (k.more()) {
+                BSONElement e = k.next();
+                if (!appendInitial(b, e.fieldName(), values))
+                    appendRoundTripped(b, e);
+            }
+            BSONObjIterator i(_initial);
+            while (i.more()) {
+                BSONElement e = i.next();
+                if (!key.hasField(e.fieldName()))
+                    appendInitial(b, e.fieldName(), values);
+            }
+            b.done();
+        }
+
+    private:
+        struct Statement {
+            size_t target;       // index into _fields
+            string sourceField;  // document field to add, or empty to add "constant"
+            double constant;
+        };
+
+        class Parser {
+        public:
+            explicit Parser(const vector<string>& tokens) : _tokens(tokens), _pos(0) {}
+
+            bool atEnd() const { return _pos == _tokens.size(); }
+
+            bool peek(const char* token) const {
+                return !atEnd() && _tokens[_pos] == token;
+            }
+
+            bool accept(const char* token) {
+                if (!peek(token))
+                    return false;
+                _pos++;
+                return true;
+            }
+
+            bool identifier(string* out) {
+                if (atEnd())
+                    return false;
+                const char c = _tokens[_pos][0];
+                if (!isalpha(static_cast<unsigned char>(c)) && c != '_' && c != '$')
+                    return false;
+                *out = _tokens[_pos++];
+                return true;
+            }
+
+            /** <object>.<name> */
+            bool field(const string& object, string* name) {
+                string o;
+                return identifier(&o) && o == object && accept(".") && identifier(name);
+            }
+
+            /** A number, or <obj>.<name> */
+            bool operand(const string& obj, string* sourceField, double* constant) {
+                if (!atEnd() && isdigit(static_cast<unsigned char>(_tokens[_pos][0]))) {
+                    const string& t = _tokens[_pos];
+                    // Leading zeros mean octal.
+                    if (t.size() > 1 && t[0] == '0' && t[1] != '.')
+                        return false;
+                    char* end;
+                    *constant = strtod(t.c_str(), &end);
+                    if (*end != '\0')
+                        return false;
+                    _pos++;
+                    return true;
+                }
+                return field(obj, sourceField);
+            }
+
+        private:
+            const vector<string>& _tokens;
+            size_t _pos;
+        };
+
+        /** Finds or adds the field "name", which must be a number in the initial object. */
+        bool addTarget(const string& name, size_t* index) {
+            for (size_t i = 0; i < _fields.size(); i++) {
+                if (_fields[i] == name) {
+                    *index = i;
+                    return true;
+                }
+            }
+            BSONElement e = _initial[name];
+            if (e.type() != NumberDouble && e.type() != NumberInt)
+                return false;
+            *index = _fields.size();
+            _fields.push_back(name);
+            _initialValues.push_back(e.number());
+            return true;
+        }
+
+        /** Appends the initial object's field "name", if it has one, as reduced. */
+        bool appendInitial(BSONObjBuilder& b,
+                           const StringData& name,
+                           const vector<double>& values) const {
+            BSONElement e = _initial[name];
+            if (e.eoo())
+                return false;
+            for (size_t i = 0; i < _fields.size(); i++) {
+                if (_fields[i] == name) {
+                    b.append(name, values[i]);
+                    return true;
+                }
+            }
+            appendRoundTripped(b, e);
+            return true;
+        }
+
+        BSONObj _initial;
+        vector<string> _fields;
+        vector<double> _initialValues;
+        vector<Statement> _statements;
+    };
+
+}  // namespace
+
     class GroupCommand : public Command {
     public:
         GroupCommand() : Command("group") {}
@@ -91,6 +396,73 @@ namespace mongo {
             return obj.extractFields( keyPattern , true ).getOwned();
         }
 
+        Runner* getGroupRunner(const string& ns, const BSONObj& query) {
+            CanonicalQuery* cq;
+            if (!CanonicalQuery::canonicalize(ns, query, &cq).isOK()) {
+                uasserted(17212, "Can't canonicalize query " + query.toString());
+            }
+
+            Runner* runner;
+            if (!getRunner(cq, &runner).isOK()) {
+                uasserted(17213, "Can't get runner for query " + query.toString());
+            }
+            return runner;
+        }
+
+        /**
+         * Runs group with "reduce" in place of the $reduce function.  Returns false, having added
+         * nothing to "result", if a key or document turns up that only JavaScript can handle.
+         */
+        bool groupWithoutJavaScript(const std::string& ns,
+                                    const BSONObj& query,
+                                    const BSONObj& keyPattern,
+                                    const SimpleReduce& reduce,
+                                    BSONObjBuilder& result) {
+            map<BSONObj,int,BSONObjCmp> map;
+            vector<BSONObj> keys;
+            vector<vector<double> > values;
+            long long count = 0;
+
+            Collection* collection = cc().database()->getCollection( ns );
+            if (collection) {
+                auto_ptr<Runner> runner(getGroupRunner(ns, query));
+                ClientCursor::registerRunner(runner.get());
+                runner->setYieldPolicy(Runner::YIELD_AUTO);
+                DeregisterEvenIfUnderlyingCodeThrows safety(runner.get());
+
+                BSONObj obj;
+                while (Runner::RUNNER_ADVANCED == runner->getNext(&obj, NULL)) {
+                    BSONObj key = obj.extractFields( keyPattern , true ).getOwned();
+                    count++;
+
+                    int& n = map[key];
+                    if ( n == 0 ) {
+                        BSONObjIterator it(key);
+                        while (it.more()) {
+                            if (!roundTrips(it.next()))
+                                return false;
+                        }
+                        n = map.size();
+                        uassert(17319, "group() can't handle more than 20000 unique keys",
+                                n <= 20000 );
+                        keys.push_back(key);
+                        values.push_back(reduce.initialValues());
+                    }
+
+                    if (!reduce.reduce(obj, &values[n - 1]))
+                        return false;
+                }
+            }
+
+            BSONArrayBuilder arr(result.subarrayStart("retval"));
+            for (size_t i = 0; i < keys.size(); i++)
+                reduce.appendResult(keys[i], values[i], &arr);
+            arr.done();
+            result.append( "count" , static_cast<double>(count) );
+            result.append( "keys" , (int)(map.size()) );
+            return true;
+        }
+
         bool group( const std::string& realdbname,
                     const std::string& ns,
                     const BSONObj& query,
@@ -103,6 +475,13 @@ namespace mongo {
                     string& errmsg,
                     BSONObjBuilder& result ) {
 
+            if (nativeGroupReduce && newGroup && keyFunctionCode.empty() && finalize.empty()) {
+                SimpleReduce simple;
+                if (simple.parse(reduceCode, initial) &&
+                    groupWithoutJavaScript(ns, query, keyPattern, simple, result))
+                    return true;
+            }
+
             const string userToken = ClientBasic::getCurrent()->getAuthorizationSession()
                                                               ->getAuthenticatedUserNamesToken();
             auto_ptr<Scope> s = globalScriptEngine->getPooledScope(realdbname, "group" + userToken);
@@ -144,19 +523,7 @@ namespace mongo {
                 // no-op, not an error, just no results
             }
             else if (newGroup) {
-                CanonicalQuery* cq;
-                if (!CanonicalQuery::canonicalize(ns, query, &cq).isOK()) {
-                    uasserted(17212, "Can't canonicalize query " + query.toString());
-                    return 0;
-                }
-
-                Runner* rawRunner;
-                if (!getRunner(cq, &rawRunner).isOK()) {
-                    uasserted(17213, "Can't get runner for query " + query.toString());
-                    return 0;
-                }
-
-                auto_ptr<Runner> runner(rawRunner);
+                auto_ptr<Runner> runner(getGroupRunner(ns, query));
                 auto_ptr<DeregisterEvenIfUnderlyingCodeThrows> safety;
                 ClientCursor::registerRunner(runner.get());
                 runner->setYieldPolicy(Runner::YIELD_AUTO);
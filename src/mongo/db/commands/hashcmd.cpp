@@ -62,8 +62,9 @@ namespace mongo {
 
         /* CmdObj has the form {"hash" : <thingToHash>}
          * or {"hash" : <thingToHash>, "seed" : <number> }
+         * or {"hash" : <thingToHash>, "seed" : <number>, "hashVersion" : <number> }
          * Result has the form
-         * {"key" : <thingTohash>, "seed" : <int>, "out": NumberLong(<hash>)}
+         * {"key" : <thingTohash>, "seed" : <int>, "hashVersion" : <int>, "out": NumberLong(<hash>)}
          *
          * Example use in the shell:
          *> db.runCommand({hash: "hashthis", seed: 1})
@@ -89,7 +90,19 @@ namespace mongo {
             }
             result.append( "seed" , seed );
 
-            result.append( "out" , BSONElementHasher::hash64( cmdObj.firstElement() , seed ) );
+            int hashVersion = HASH_VERSION_MD5;
+            if (cmdObj.hasField("hashVersion")){
+                hashVersion = cmdObj["hashVersion"].numberInt();
+                if (! cmdObj["hashVersion"].isNumber() ||
+                    ! HasherFactory::isValidHashVersion(hashVersion)) {
+                    errmsg += "hashVersion must be 0 or 1";
+                    return false;
+                }
+            }
+            result.append( "hashVersion" , hashVersion );
+
+            result.append( "out" , BSONElementHasher::hash64( cmdObj.firstElement() , seed ,
+                                                              hashVersion ) );
             return true;
         }
     };
@@ -379,6 +379,7 @@ namespace mongo {
 
         scoped_ptr<BtreeInspector> inspector(NULL);
         switch (details->version()) {
+          case 2:
           case 1: inspector.reset(new BtreeInspectorV1(params.expandNodes)); break;
           case 0: inspector.reset(new BtreeInspectorV0(params.expandNodes)); break;
           default:
@@ -32,6 +32,9 @@
 
 #include "mongo/db/commands/mr.h"
 
+#include <boost/function.hpp>
+
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/parallel.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -41,17 +44,21 @@
 #include "mongo/db/instance.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/matcher.h"
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/value.h"
 #include "mongo/db/query_optimizer.h"
 #include "mongo/db/query/new_find.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/range_preserver.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/s/collection_metadata.h"
 #include "mongo/s/d_logic.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/stale_exception.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -237,6 +244,125 @@ namespace mongo {
             _reduce( x , key , endSizeEstimate );
         }
 
+        namespace {
+
+            NativeReducer::Factory nativeReduceFactory( const BSONElement& e ) {
+                uassert( 17303 , str::stream() << "native reduce operator " << e.fieldName()
+                                               << " takes 1" ,
+                         e.isNumber() && e.number() == 1 );
+
+                if ( str::equals( e.fieldName() , "$sum" ) )
+                    return AccumulatorSum::create;
+                if ( str::equals( e.fieldName() , "$min" ) )
+                    return AccumulatorMinMax::createMin;
+                if ( str::equals( e.fieldName() , "$max" ) )
+                    return AccumulatorMinMax::createMax;
+
+                uasserted( 17304 , str::stream() << "unsupported native reduce operator: "
+                                                 << e.fieldName() );
+                return NULL;
+            }
+
+            void appendReduced( BSONObjBuilder& b , const StringData& fieldName ,
+                                const Value& value ) {
+                if ( value.missing() )
+                    b.appendNull( fieldName );
+                else
+                    value.addToBsonObj( &b , fieldName );
+            }
+
+            /** the value of a tuple (key, value) */
+            BSONElement tupleValue( const BSONObj& tuple ) {
+                BSONObjIterator it( tuple );
+                it.next();
+                return it.next();
+            }
+
+        } // namespace
+
+        NativeReducer::NativeReducer( const BSONObj& spec ) : _valueFactory( NULL ) {
+            uassert( 17305 , "native reduce has no operator" , !spec.isEmpty() );
+
+            if ( spec.firstElementFieldName()[0] == '$' ) {
+                uassert( 17306 , "native reduce of the whole value takes one operator" ,
+                         spec.nFields() == 1 );
+                _valueFactory = nativeReduceFactory( spec.firstElement() );
+                return;
+            }
+
+            BSONObjIterator it( spec );
+            while ( it.more() ) {
+                BSONElement field = it.next();
+                uassert( 17307 , str::stream() << "native reduce of field " << field.fieldName()
+                                               << " takes one operator" ,
+                         field.type() == Object && field.Obj().nFields() == 1 );
+                _fieldFactories.push_back( std::make_pair( string( field.fieldName() ) ,
+                                           nativeReduceFactory( field.Obj().firstElement() ) ) );
+            }
+        }
+
+        /**
+         * Reduces a list of tuple objects (key, value) to a single tuple {"0": key, "1": value}
+         */
+        BSONObj NativeReducer::reduce( const BSONList& tuples ) {
+            uassert( 10074 ,  "need values" , tuples.size() );
+            if ( tuples.size() == 1 )
+                return tuples[0];
+
+            BSONObjBuilder b;
+            b.appendAs( tuples[0].firstElement() , "0" );
+            _reduce( tuples , b , "1" );
+            return b.obj();
+        }
+
+        /**
+         * Reduces a list of tuple object (key, value) to a single tuple {_id: key, value: val}
+         * Also applies a finalizer method if present.
+         */
+        BSONObj NativeReducer::finalReduce( const BSONList& tuples , Finalizer * finalizer ) {
+            uassert( 10074 ,  "need values" , tuples.size() );
+
+            BSONObjBuilder b;
+            b.appendAs( tuples[0].firstElement() , "_id" );
+            if ( tuples.size() == 1 )
+                b.appendAs( tupleValue( tuples[0] ) , "value" );
+            else
+                _reduce( tuples , b , "value" );
+            BSONObj res = b.obj();
+
+            if ( finalizer ) {
+                res = finalizer->finalize( res );
+            }
+
+            return res;
+        }
+
+        void NativeReducer::_reduce( const BSONList& tuples , BSONObjBuilder& b ,
+                                     const StringData& fieldName ) {
+            ++numReduces;
+
+            if ( _valueFactory ) {
+                intrusive_ptr<Accumulator> acc = _valueFactory();
+                for ( BSONList::const_iterator i = tuples.begin(); i != tuples.end(); ++i )
+                    acc->process( Value( tupleValue( *i ) ) , false );
+                appendReduced( b , fieldName , acc->getValue( false ) );
+                return;
+            }
+
+            BSONObjBuilder sub( b.subobjStart( fieldName ) );
+            for ( size_t f = 0; f < _fieldFactories.size(); f++ ) {
+                const string& name = _fieldFactories[f].first;
+                intrusive_ptr<Accumulator> acc = _fieldFactories[f].second();
+                for ( BSONList::const_iterator i = tuples.begin(); i != tuples.end(); ++i ) {
+                    BSONElement value = tupleValue( *i );
+                    if ( value.type() == Object )
+                        acc->process( Value( value.Obj()[name] ) , false );
+                }
+                appendReduced( sub , name , acc->getValue( false ) );
+            }
+            sub.done();
+        }
+
         Config::Config( const string& _dbname , const BSONObj& cmdObj )
         {
             dbname = _dbname;
@@ -281,7 +407,14 @@ namespace mongo {
                     scopeSetup = cmdObj["scope"].embeddedObjectUserCheck();
 
                 mapper.reset( new JSMapper( cmdObj["map"] ) );
-                reducer.reset( new JSReducer( cmdObj["reduce"] ) );
+                if ( cmdObj["reduce"].type() == Object ) {
+                    reducer.reset( new NativeReducer( cmdObj["reduce"].Obj() ) );
+                    // the reduce isn't a function that JS mode could call
+                    jsMode = false;
+                }
+                else {
+                    reducer.reset( new JSReducer( cmdObj["reduce"] ) );
+                }
                 if ( cmdObj["finalize"].type() && cmdObj["finalize"].trueValue() )
                     finalizer.reset( new JSFinalizer( cmdObj["finalize"] ) );
 
@@ -1020,9 +1153,45 @@ namespace mongo {
          */
         void State::emit( const BSONObj& a ) {
             _numEmits++;
+
+            // A native reduce is cheap enough to keep one tuple per key as we go
+            if ( _config.reducer->isNative() ) {
+                InMemory::iterator i = _temp->find( a );
+                if ( i != _temp->end() ) {
+                    BSONList& all = i->second;
+                    long oldSize = 0;
+                    for ( BSONList::iterator j=all.begin(); j!=all.end(); j++ )
+                        oldSize += j->objsize() + 16;
+                    all.push_back( a );
+                    BSONObj res = _config.reducer->reduce( all );
+                    all.clear();
+                    all.push_back( res );
+                    _size += res.objsize() + 16 - oldSize;
+                    return;
+                }
+            }
+
             _add( _temp.get() , a , _size );
         }
 
+        void State::absorb( State& other ) {
+            if ( _jsMode )
+                switchMode( false );
+            if ( other._jsMode )
+                other.bailFromJS();
+
+            _numEmits += other.numEmits();
+            _config.reducer->numReduces += other.numReduces();
+
+            for ( InMemory::iterator i=other._temp->begin(); i!=other._temp->end(); ++i ) {
+                BSONList& all = i->second;
+                for ( BSONList::iterator j=all.begin(); j!=all.end(); j++ )
+                    _add( _temp.get() , *j , _size );
+            }
+            other._temp->clear();
+            other._size = 0;
+        }
+
         void State::_add( InMemory* im, const BSONObj& a , long& size ) {
             BSONList& all = (*im)[a];
             all.push_back( a );
@@ -1108,6 +1277,239 @@ namespace mongo {
             return BSONObj();
         }
 
+        // If greater than one, the number of threads the map phase of a mapReduce runs on.  Each
+        // has its own JS scope and in-memory tuples, which are merged before the final reduce.
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(mapReduceMapThreads, int, 0);
+
+        // How many documents the map phase hands one of its threads at a time.
+        static const size_t kMapBatchSize = 100;
+
+        namespace {
+
+            mongo::mutex mapPoolMutex("mapReduce map pool");
+            ThreadPool* mapPool = NULL;
+
+            ThreadPool* getMapPool() {
+                scoped_lock lk(mapPoolMutex);
+                if (NULL == mapPool) {
+                    // Lives as long as the process.
+                    mapPool = new ThreadPool(mapReduceMapThreads);
+                }
+                return mapPool;
+            }
+
+            /**
+             * Maps the documents it is handed on the map pool, a batch at a time.  Each batch
+             * goes to whichever of its States is idle, one per pool thread.  Each State has its
+             * own scope, map and reduce functions and in-memory tuples, so the threads share
+             * nothing but the batches.  They don't touch the database: the thread reading the
+             * input holds its lock throughout.
+             */
+            class ParallelMap : boost::noncopyable {
+            public:
+                ParallelMap( const string& dbname , const BSONObj& cmd , int numThreads )
+                    : _mutex( "ParallelMap" ),
+                      _batch( new BSONList() ),
+                      _batchesInFlight( 0 ),
+                      _mapMicros( 0 ),
+                      _failed( false ),
+                      _errorCode( 0 ),
+                      _tasks( *getMapPool() ) {
+                    for ( int i = 0; i < numThreads; i++ ) {
+                        Config* config = new Config( dbname , cmd );
+                        _configs.mutableVector().push_back( config );
+
+                        // What the thread emits stays in memory until it is merged
+                        config->outputOptions.outType = Config::INMEMORY;
+                        _states.mutableVector().push_back( new State( *config ) );
+                    }
+                }
+
+                ~ParallelMap() {
+                    {
+                        scoped_lock lk( _mutex );
+                        _failed = true;
+                    }
+                    _tasks.wait();
+                    for ( size_t i = 0; i < _idle.size(); i++ ) {
+                        _idle[i]->scope()->rename( "____db____" , "db" );
+                    }
+                }
+
+                /**
+                 * Sets up the States' scopes, on the thread running the command.
+                 */
+                void init() {
+                    for ( size_t i = 0; i < _states.size(); i++ ) {
+                        State* state = _states.vector()[i];
+                        state->init();
+                        _idle.push_back( state );
+
+                        // The thread calling map functions holds no lock
+                        state->scope()->rename( "db" , "____db____" );
+                    }
+                }
+
+                /**
+                 * Maps 'doc' with the rest of its batch, waiting if the threads are behind.
+                 */
+                void map( const BSONObj& doc ) {
+                    _batch->push_back( doc.getOwned() );
+                    if ( _batch->size() >= kMapBatchSize )
+                        flush();
+                }
+
+                /**
+                 * Waits for the threads to map everything, then hands what they emitted to
+                 * 'state' to reduce.
+                 */
+                void finish( State* state ) {
+                    if ( !_batch->empty() )
+                        flush();
+                    _tasks.wait();
+                    checkFailed();
+
+                    // Each State gets its JS tuples out and reduces them on a thread of its own
+                    for ( size_t i = 0; i < _states.size(); i++ ) {
+                        _tasks.schedule( &ParallelMap::reduceState , this , _states.vector()[i] );
+                    }
+                    _tasks.wait();
+                    checkFailed();
+
+                    for ( size_t i = 0; i < _states.size(); i++ ) {
+                        state->absorb( *_states.vector()[i] );
+                    }
+                }
+
+                /** Time spent in map functions, across the threads */
+                long long mapMicros() {
+                    scoped_lock lk( _mutex );
+                    return _mapMicros;
+                }
+
+            private:
+                void flush() {
+                    {
+                        scoped_lock lk( _mutex );
+                        while ( _batchesInFlight >= static_cast<int>( 2 * _states.size() )
+                                && !_failed ) {
+                            _progress.wait( lk.boost() );
+                        }
+                        _batchesInFlight++;
+                    }
+                    checkFailed();
+                    _tasks.schedule( &ParallelMap::mapBatch , this , _batch.release() );
+                    _batch.reset( new BSONList() );
+                }
+
+                void checkFailed() {
+                    scoped_lock lk( _mutex );
+                    if ( _failed )
+                        uasserted( _errorCode , _errorMessage );
+                }
+
+                State* takeIdle() {
+                    scoped_lock lk( _mutex );
+                    if ( _failed )
+                        return NULL;
+                    // No more of our tasks run at once than there are pool threads, and States
+                    verify( !_idle.empty() );
+                    State* state = _idle.back();
+                    _idle.pop_back();
+                    return state;
+                }
+
+                void fail( int code , const string& message ) {
+                    if ( !_failed ) {
+                        _failed = true;
+                        _errorCode = code;
+                        _errorMessage = message;
+                    }
+                }
+
+                static void mapBatch( ParallelMap* self , BSONList* batch ) {
+                    // Scopes find the op to interrupt through the thread's Client
+                    Client::initThreadIfNotAlready( "mapReduce map worker" );
+
+                    boost::scoped_ptr<BSONList> ownedBatch( batch );
+                    long long micros = 0;
+                    State* state = self->takeIdle();
+                    if ( state ) {
+                        Timer t;
+                        self->run( state , boost::bind( &ParallelMap::mapDocuments ,
+                                                       state , ownedBatch.get() ) );
+                        micros = t.micros();
+                    }
+
+                    {
+                        scoped_lock lk( self->_mutex );
+                        if ( state )
+                            self->_idle.push_back( state );
+                        self->_batchesInFlight--;
+                        self->_mapMicros += micros;
+                    }
+                    self->_progress.notify_all();
+                }
+
+                static void mapDocuments( State* state , const BSONList* batch ) {
+                    for ( BSONList::const_iterator i = batch->begin(); i != batch->end(); ++i ) {
+                        state->config().mapper->map( *i );
+                    }
+                    // In JS mode, reduce or switch to mixed mode as the command's own State
+                    // would.  A mixed mode State keeps its tuples until they are merged.
+                    if ( state->jsMode() )
+                        state->checkSize();
+                }
+
+                static void reduceState( ParallelMap* self , State* state ) {
+                    Client::initThreadIfNotAlready( "mapReduce map worker" );
+                    self->run( state , boost::bind( &ParallelMap::bailAndReduce , state ) );
+                }
+
+                static void bailAndReduce( State* state ) {
+                    if ( state->jsMode() )
+                        state->bailFromJS();
+                    state->reduceInMemory();
+                }
+
+                void run( State* state , const boost::function<void()>& work ) {
+                    try {
+                        work();
+                    }
+                    catch ( const DBException& e ) {
+                        scoped_lock lk( _mutex );
+                        fail( e.getCode() , e.what() );
+                    }
+                    catch ( const std::exception& e ) {
+                        scoped_lock lk( _mutex );
+                        fail( 17302 , str::stream() << "map thread failed: " << e.what() );
+                    }
+                    _progress.notify_all();
+                }
+
+                OwnedPointerVector<Config> _configs;
+                OwnedPointerVector<State> _states;
+
+                mongo::mutex _mutex;
+                boost::condition _progress;     // a batch was mapped, or the map failed
+                std::vector<State*> _idle;      // guarded by _mutex
+
+                // Filled by the thread reading the input.
+                std::auto_ptr<BSONList> _batch;
+
+                // All guarded by _mutex.
+                int _batchesInFlight;
+                long long _mapMicros;
+                bool _failed;
+                int _errorCode;
+                string _errorMessage;
+
+                // Last, so that its tasks are done with everything above before it goes away.
+                TaskGroup _tasks;
+            };
+
+        } // namespace
+
         /**
          * This class represents a map/reduce command executed on a single server
          */
@@ -1208,6 +1610,13 @@ namespace mongo {
 
                     wassert( config.limit < 0x4000000 ); // see case on next line to 32 bit unsigned
                     long long mapTime = 0;
+
+                    // Map on several threads if the server is set up to
+                    boost::scoped_ptr<ParallelMap> parallelMap;
+                    if ( mapReduceMapThreads > 1 ) {
+                        parallelMap.reset( new ParallelMap( dbname , cmd , mapReduceMapThreads ) );
+                        parallelMap->init();
+                    }
                     {
                         // We've got a cursor preventing migrations off, now re-establish our useful cursor
 
@@ -1250,9 +1659,14 @@ namespace mongo {
                             }
 
                             // do map
-                            if ( config.verbose ) mt.reset();
-                            config.mapper->map( o );
-                            if ( config.verbose ) mapTime += mt.micros();
+                            if ( parallelMap ) {
+                                parallelMap->map( o );
+                            }
+                            else {
+                                if ( config.verbose ) mt.reset();
+                                config.mapper->map( o );
+                                if ( config.verbose ) mapTime += mt.micros();
+                            }
 
                             num++;
                             if ( num % 100 == 0 ) {
@@ -1264,6 +1678,10 @@ namespace mongo {
                                 break;
                         }
                     }
+                    if ( parallelMap ) {
+                        parallelMap->finish( &state );
+                        mapTime = parallelMap->mapMicros();
+                    }
                     pm.finished();
 
                     killCurrentOp.checkForInterrupt();
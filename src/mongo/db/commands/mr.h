@@ -30,8 +30,10 @@
 
 #pragma once
 
+#include <boost/intrusive_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "mongo/db/auth/privilege.h"
@@ -42,6 +44,8 @@
 
 namespace mongo {
 
+    class Accumulator;
+
     namespace mr {
 
         typedef vector<BSONObj> BSONList;
@@ -79,6 +83,9 @@ namespace mongo {
             /** this means its a final reduce, even if there is no finalizer */
             virtual BSONObj finalReduce( const BSONList& tuples , Finalizer * finalizer ) = 0;
 
+            /** true if reducing doesn't call into JS, so it's cheap enough to do on each emit */
+            virtual bool isNative() const { return false; }
+
             long long numReduces;
         };
 
@@ -141,6 +148,33 @@ namespace mongo {
             JSFunction _func;
         };
 
+        /**
+         * A reduce given as accumulators rather than as a function: {$sum: 1} adds up the
+         * values, and {count: {$sum: 1}, top: {$max: 1}} reduces each of those fields of values
+         * that are objects.  $sum, $min and $max are supported, since reducing what they reduced
+         * gives the same result.
+         */
+        class NativeReducer : public Reducer {
+        public:
+            NativeReducer( const BSONObj& spec );
+            virtual void init( State * state ) {}
+
+            virtual BSONObj reduce( const BSONList& tuples );
+            virtual BSONObj finalReduce( const BSONList& tuples , Finalizer * finalizer );
+
+            virtual bool isNative() const { return true; }
+
+            typedef boost::intrusive_ptr<Accumulator> (*Factory)();
+
+        private:
+            /** appends the reduction of the values of 'tuples' as 'fieldName' */
+            void _reduce( const BSONList& tuples , BSONObjBuilder& b , const StringData& fieldName );
+
+            // the accumulator for the whole value, or else for each of its fields
+            Factory _valueFactory;
+            std::vector< std::pair<string, Factory> > _fieldFactories;
+        };
+
         class JSFinalizer : public Finalizer  {
         public:
             JSFinalizer( const BSONElement& code ) : _func( "_finalize" , code ) {}
@@ -320,6 +354,12 @@ namespace mongo {
             void switchMode(bool jsMode);
             void bailFromJS();
 
+            /**
+             * Takes over the tuples another State emitted, and its counts, to be reduced with
+             * ours.  Both are left in mixed mode.
+             */
+            void absorb( State& other );
+
             const Config& _config;
             DBDirectClient _db;
             bool _useIncremental;   // use an incremental collection
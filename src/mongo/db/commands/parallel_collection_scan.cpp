@@ -0,0 +1,186 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/clientcursor.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/database.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_details.h"
+#include "mongo/db/query/internal_runner.h"
+#include "mongo/db/storage/extent.h"
+#include "mongo/db/storage/extent_manager.h"
+#include "mongo/db/structure/collection.h"
+
+namespace mongo {
+
+    /**
+     * Splits a collection's extents into contiguous ranges of about the same size and returns a
+     * cursor per range.  Each cursor is a collection scan of its range, so clients can drain them
+     * in parallel on separate connections.
+     *
+     * { parallelCollectionScan: <collection>, numCursors: <n> }
+     */
+    class ParallelCollectionScanCmd : public Command {
+    public:
+        // Returning more cursors than this isn't going to make reading any faster.
+        static const int kMaxCursors = 10000;
+
+        ParallelCollectionScanCmd() : Command("parallelCollectionScan") { }
+
+        virtual bool slaveOk() const { return false; }
+        virtual bool slaveOverrideOk() const { return true; }
+        virtual LockType locktype() const { return READ; }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::find);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        virtual void help(stringstream& help) const {
+            help << "{ parallelCollectionScan : 'collection name', numCursors : <n> }\n"
+                 << "returns up to n cursors which together scan the whole collection";
+        }
+
+        bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg,
+                 BSONObjBuilder& result, bool fromRepl) {
+
+            const string ns = parseNs(dbname, cmdObj);
+
+            BSONElement numCursorsElt = cmdObj["numCursors"];
+            if (!numCursorsElt.isNumber()) {
+                errmsg = "numCursors must be a number";
+                return false;
+            }
+
+            const int numCursors = numCursorsElt.numberInt();
+            if (numCursors < 1 || numCursors > kMaxCursors) {
+                errmsg = str::stream() << "numCursors must be between 1 and " << kMaxCursors;
+                return false;
+            }
+
+            Collection* collection = cc().database()->getCollection(ns);
+            if (NULL == collection) {
+                errmsg = "ns does not exist";
+                return false;
+            }
+
+            if (collection->details()->isCapped()) {
+                errmsg = "parallelCollectionScan doesn't support capped collections";
+                return false;
+            }
+
+            vector<DiskLoc> rangeStarts;
+            splitExtents(cc().database()->getExtentManager(), collection, numCursors,
+                         &rangeStarts);
+
+            BSONArrayBuilder cursors(result.subarrayStart("cursors"));
+            for (size_t i = 0; i < rangeStarts.size(); ++i) {
+                CollectionScanParams params;
+                params.ns = ns;
+                params.extentRangeStart = rangeStarts[i];
+                if (i + 1 < rangeStarts.size()) {
+                    params.extentRangeEnd = rangeStarts[i + 1];
+                }
+
+                WorkingSet* ws = new WorkingSet();
+                CollectionScan* scan = new CollectionScan(params, ws, NULL);
+
+                // Takes ownership of 'ws' and 'scan'.
+                auto_ptr<InternalRunner> runner(new InternalRunner(ns, scan, ws));
+                runner->setYieldPolicy(Runner::YIELD_AUTO);
+
+                // We won't use the runner until it's getMore'd.
+                runner->saveState();
+
+                // The ClientCursor takes ownership of the runner and is put into a global map by
+                // its ctor.
+                ClientCursor* clientCursor = new ClientCursor(runner.release(), 0, BSONObj());
+
+                BSONObjBuilder cursorResult(cursors.subobjStart());
+                BSONObjBuilder cursorObj(cursorResult.subobjStart("cursor"));
+                cursorObj.append("id", clientCursor->cursorid());
+                cursorObj.append("ns", ns);
+                cursorObj.appendArray("firstBatch", BSONObj());
+                cursorObj.done();
+                cursorResult.append("ok", 1);
+                cursorResult.done();
+            }
+            cursors.done();
+
+            return true;
+        }
+
+    private:
+        /**
+         * Fills out 'rangeStarts' with the first extent of each of at most 'numRanges' ranges.
+         * A range runs up to the start of the next one, and the last one to the end of the
+         * collection.  The ranges hold about the same number of bytes.
+         */
+        static void splitExtents(const ExtentManager& em,
+                                 const Collection* collection,
+                                 int numRanges,
+                                 vector<DiskLoc>* rangeStarts) {
+
+            const DiskLoc& firstExtent = collection->details()->firstExtent();
+            if (firstExtent.isNull()) {
+                return;
+            }
+
+            long long totalBytes = 0;
+            for (Extent* e = em.getExtent(firstExtent); NULL != e; e = em.getNextExtent(e)) {
+                totalBytes += e->length;
+            }
+
+            // Start a new range once the ones before it hold their share of the bytes.
+            long long bytesSoFar = 0;
+            for (Extent* e = em.getExtent(firstExtent); NULL != e; e = em.getNextExtent(e)) {
+                const long long rangeNum = rangeStarts->size();
+                if (rangeStarts->empty() || bytesSoFar * numRanges >= rangeNum * totalBytes) {
+                    rangeStarts->push_back(e->myLoc);
+                    if (static_cast<int>(rangeStarts->size()) == numRanges) {
+                        return;
+                    }
+                }
+                bytesSoFar += e->length;
+            }
+        }
+
+    } parallelCollectionScanCmd;
+
+}  // namespace mongo
@@ -0,0 +1,506 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/init.h"
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/database.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/query_settings.h"
+#include "mongo/db/query/query_shape_stats.h"
+#include "mongo/db/structure/collection.h"
+
+namespace mongo {
+
+    /**
+     * Base class for the commands that inspect and manipulate the plan cache and the index
+     * filters of a collection:
+     * { <command name>: <collection name>, ... }
+     *
+     * Subclasses implement runPlanCacheCommand, which is handed the CollectionInfoCache that
+     * owns both.
+     */
+    class PlanCacheCommand : public Command {
+    public:
+        PlanCacheCommand(const std::string& name, const std::string& helpText,
+                         ActionType actionType)
+            : Command(name),
+              _helpText(helpText),
+              _actionType(actionType) { }
+
+        virtual bool slaveOk() const { return true; }
+
+        virtual LockType locktype() const { return READ; }
+
+        virtual void help(stringstream& h) const { h << _helpText; }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(_actionType);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg,
+                 BSONObjBuilder& result, bool fromRepl) {
+            string ns = parseNs(dbname, cmdObj);
+
+            Database* db = cc().database();
+            Collection* collection = (NULL == db) ? NULL : db->getCollection(ns);
+            if (NULL == collection) {
+                errmsg = "ns not found";
+                return false;
+            }
+
+            Status status = runPlanCacheCommand(ns, cmdObj, collection->infoCache(), &result);
+            if (!status.isOK()) {
+                errmsg = status.reason();
+                return false;
+            }
+            return true;
+        }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) = 0;
+
+        /**
+         * Canonicalizes the { query: ..., sort: ..., projection: ... } fields of 'cmdObj'.  The
+         * query is required.  Caller owns '*queryOut'.
+         */
+        static Status canonicalize(const string& ns, const BSONObj& cmdObj,
+                                   CanonicalQuery** queryOut) {
+            BSONElement queryElt = cmdObj["query"];
+            if (queryElt.eoo()) {
+                return Status(ErrorCodes::BadValue, "required field query missing");
+            }
+            if (!queryElt.isABSONObj()) {
+                return Status(ErrorCodes::BadValue, "required field query must be an object");
+            }
+
+            BSONObj sort;
+            BSONElement sortElt = cmdObj["sort"];
+            if (!sortElt.eoo()) {
+                if (!sortElt.isABSONObj()) {
+                    return Status(ErrorCodes::BadValue, "optional field sort must be an object");
+                }
+                sort = sortElt.Obj();
+            }
+
+            BSONObj projection;
+            BSONElement projElt = cmdObj["projection"];
+            if (!projElt.eoo()) {
+                if (!projElt.isABSONObj()) {
+                    return Status(ErrorCodes::BadValue,
+                                  "optional field projection must be an object");
+                }
+                projection = projElt.Obj();
+            }
+
+            return CanonicalQuery::canonicalize(ns, queryElt.Obj(), sort, projection, queryOut);
+        }
+
+    private:
+        std::string _helpText;
+        ActionType _actionType;
+    };
+
+    /**
+     * { planCacheListShapes: <collection> }
+     *
+     * Lists the query shapes in the plan cache, most recently used first.  Each shape is shown
+     * as the query, sort and projection of the query that created the entry.
+     */
+    class PlanCacheListShapes : public PlanCacheCommand {
+    public:
+        PlanCacheListShapes()
+            : PlanCacheCommand("planCacheListShapes",
+                               "Displays all query shapes in a collection's plan cache. "
+                               "Example: {planCacheListShapes: 'collection'}",
+                               ActionType::planCacheRead) { }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) {
+            PlanCache* planCache = infoCache->getPlanCache();
+            OwnedPointerVector<CachedSolution> solutions;
+            planCache->getAll(&solutions.mutableVector());
+
+            BSONArrayBuilder shapesBuilder(bob->subarrayStart("shapes"));
+            for (size_t i = 0; i < solutions.size(); ++i) {
+                const CachedSolution* cs = solutions.vector()[i];
+                BSONObjBuilder shapeBob(shapesBuilder.subobjStart());
+                shapeBob.append("query", cs->query);
+                shapeBob.append("sort", cs->sort);
+                shapeBob.append("projection", cs->projection);
+                shapeBob.appendNumber("hits", static_cast<long long>(cs->numHits));
+                shapeBob.doneFast();
+            }
+            shapesBuilder.doneFast();
+            return Status::OK();
+        }
+    };
+
+    /**
+     * { planCacheListPlans: <collection>, query: <query>, sort: <sort>, projection: <proj> }
+     *
+     * Shows the cached solution for the shape of the query, why it was picked and how it has
+     * performed since.
+     */
+    class PlanCacheListPlans : public PlanCacheCommand {
+    public:
+        PlanCacheListPlans()
+            : PlanCacheCommand("planCacheListPlans",
+                               "Displays the cached plan for a query shape. Example: "
+                               "{planCacheListPlans: 'collection', query: {a: 1}, "
+                               "sort: {b: 1}, projection: {_id: 0}}",
+                               ActionType::planCacheRead) { }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) {
+            PlanCache* planCache = infoCache->getPlanCache();
+            CanonicalQuery* cqRaw;
+            Status status = canonicalize(ns, cmdObj, &cqRaw);
+            if (!status.isOK()) {
+                return status;
+            }
+            scoped_ptr<CanonicalQuery> cq(cqRaw);
+
+            scoped_ptr<CachedSolution> cs(planCache->peek(*cq));
+            if (NULL == cs) {
+                return Status(ErrorCodes::BadValue, "no such query shape in plan cache");
+            }
+
+            BSONArrayBuilder plansBuilder(bob->subarrayStart("plans"));
+            BSONObjBuilder planBob(plansBuilder.subobjStart());
+            planBob.append("details", cs->solutionString);
+            planBob.append("shape", cs->solutionShape);
+            planBob.appendNumber("hits", static_cast<long long>(cs->numHits));
+
+            if (NULL != cs->decision) {
+                const PlanRankingDecision& why = *cs->decision;
+                BSONObjBuilder reasonBob(planBob.subobjStart("reason"));
+                reasonBob.append("score", why.score);
+                reasonBob.appendNumber("numCandidates", static_cast<long long>(why.numCandidates));
+                reasonBob.appendNumber("works", static_cast<long long>(why.trialWorks));
+                reasonBob.appendNumber("advanced", static_cast<long long>(why.trialAdvanced));
+                reasonBob.doneFast();
+            }
+
+            BSONObjBuilder feedbackBob(planBob.subobjStart("feedback"));
+            feedbackBob.appendNumber("runs", static_cast<long long>(cs->numFeedback));
+            feedbackBob.appendNumber("works", static_cast<long long>(cs->feedbackWorks));
+            feedbackBob.appendNumber("advanced", static_cast<long long>(cs->feedbackAdvanced));
+            feedbackBob.doneFast();
+
+            planBob.doneFast();
+            plansBuilder.doneFast();
+            return Status::OK();
+        }
+    };
+
+    /**
+     * { planCacheClear: <collection> }
+     * { planCacheClear: <collection>, query: <query>, sort: <sort>, projection: <proj> }
+     *
+     * Removes the entry for one query shape, or every entry, from the plan cache.
+     */
+    class PlanCacheClear : public PlanCacheCommand {
+    public:
+        PlanCacheClear()
+            : PlanCacheCommand("planCacheClear",
+                               "Drops one or all cached query shapes in a collection. "
+                               "Example: {planCacheClear: 'collection', query: {a: 1}}",
+                               ActionType::planCacheWrite) { }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) {
+            PlanCache* planCache = infoCache->getPlanCache();
+            if (cmdObj["query"].eoo()) {
+                planCache->clear();
+                return Status::OK();
+            }
+
+            CanonicalQuery* cqRaw;
+            Status status = canonicalize(ns, cmdObj, &cqRaw);
+            if (!status.isOK()) {
+                return status;
+            }
+            scoped_ptr<CanonicalQuery> cq(cqRaw);
+
+            if (!planCache->remove(*cq)) {
+                return Status(ErrorCodes::BadValue, "no such query shape in plan cache");
+            }
+            return Status::OK();
+        }
+    };
+
+    /**
+     * { planCacheListFilters: <collection> }
+     *
+     * Lists the index filters of a collection.
+     */
+    class PlanCacheListFilters : public PlanCacheCommand {
+    public:
+        PlanCacheListFilters()
+            : PlanCacheCommand("planCacheListFilters",
+                               "Displays the index filters of a collection. "
+                               "Example: {planCacheListFilters: 'collection'}",
+                               ActionType::planCacheRead) { }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) {
+            std::vector<AllowedIndexEntry> entries;
+            infoCache->getQuerySettings()->getAllAllowedIndices(&entries);
+
+            BSONArrayBuilder filtersBuilder(bob->subarrayStart("filters"));
+            for (size_t i = 0; i < entries.size(); ++i) {
+                const AllowedIndexEntry& entry = entries[i];
+                BSONObjBuilder filterBob(filtersBuilder.subobjStart());
+                filterBob.append("query", entry.query);
+                filterBob.append("sort", entry.sort);
+                filterBob.append("projection", entry.projection);
+                BSONArrayBuilder indexesBuilder(filterBob.subarrayStart("indexes"));
+                for (size_t j = 0; j < entry.indexKeyPatterns.size(); ++j) {
+                    indexesBuilder.append(entry.indexKeyPatterns[j]);
+                }
+                indexesBuilder.doneFast();
+                filterBob.doneFast();
+            }
+            filtersBuilder.doneFast();
+            return Status::OK();
+        }
+    };
+
+    /**
+     * { planCacheSetFilter: <collection>, query: <query>, sort: <sort>, projection: <proj>,
+     *   indexes: [<key pattern>, ...] }
+     *
+     * Restricts the planner to the given indices for queries of the shape of the query.
+     * Drops the cached plan of that shape.
+     */
+    class PlanCacheSetFilter : public PlanCacheCommand {
+    public:
+        PlanCacheSetFilter()
+            : PlanCacheCommand("planCacheSetFilter",
+                               "Sets the indices the planner may use for a query shape. "
+                               "Example: {planCacheSetFilter: 'collection', query: {a: 1, b: 1}, "
+                               "indexes: [{a: 1}]}",
+                               ActionType::planCacheWrite) { }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) {
+            BSONElement indexesElt = cmdObj["indexes"];
+            if (indexesElt.eoo()) {
+                return Status(ErrorCodes::BadValue, "required field indexes missing");
+            }
+            if (indexesElt.type() != mongo::Array) {
+                return Status(ErrorCodes::BadValue, "required field indexes must be an array");
+            }
+
+            std::vector<BSONObj> indexKeyPatterns;
+            BSONObjIterator it(indexesElt.Obj());
+            while (it.more()) {
+                BSONElement elt = it.next();
+                if (!elt.isABSONObj() || elt.Obj().isEmpty()) {
+                    return Status(ErrorCodes::BadValue,
+                                  "each item in indexes must be an index key pattern");
+                }
+                indexKeyPatterns.push_back(elt.Obj());
+            }
+            if (indexKeyPatterns.empty()) {
+                return Status(ErrorCodes::BadValue, "indexes must not be empty");
+            }
+
+            CanonicalQuery* cqRaw;
+            Status status = canonicalize(ns, cmdObj, &cqRaw);
+            if (!status.isOK()) {
+                return status;
+            }
+            scoped_ptr<CanonicalQuery> cq(cqRaw);
+
+            infoCache->getQuerySettings()->setAllowedIndices(*cq, indexKeyPatterns);
+
+            // The cached plan may use an index the filter doesn't allow.
+            infoCache->getPlanCache()->remove(*cq);
+            return Status::OK();
+        }
+    };
+
+    /**
+     * { planCacheClearFilters: <collection> }
+     * { planCacheClearFilters: <collection>, query: <query>, sort: <sort>, projection: <proj> }
+     *
+     * Removes the index filter for one query shape, or every index filter.  The affected
+     * cached plans are dropped.
+     */
+    class PlanCacheClearFilters : public PlanCacheCommand {
+    public:
+        PlanCacheClearFilters()
+            : PlanCacheCommand("planCacheClearFilters",
+                               "Drops one or all index filters of a collection. "
+                               "Example: {planCacheClearFilters: 'collection', query: {a: 1}}",
+                               ActionType::planCacheWrite) { }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) {
+            QuerySettings* querySettings = infoCache->getQuerySettings();
+
+            if (cmdObj["query"].eoo()) {
+                querySettings->clearAllowedIndices();
+                infoCache->getPlanCache()->clear();
+                return Status::OK();
+            }
+
+            CanonicalQuery* cqRaw;
+            Status status = canonicalize(ns, cmdObj, &cqRaw);
+            if (!status.isOK()) {
+                return status;
+            }
+            scoped_ptr<CanonicalQuery> cq(cqRaw);
+
+            if (!querySettings->removeAllowedIndices(*cq)) {
+                return Status(ErrorCodes::BadValue, "no index filter for query shape");
+            }
+            infoCache->getPlanCache()->remove(*cq);
+            return Status::OK();
+        }
+    };
+
+    /**
+     * { queryShapeStats: <collection> }
+     * { queryShapeStats: <collection>, limit: <n> }
+     *
+     * Lists what the queries of each shape run against the collection have cost, the shapes
+     * with the most total time first.  Shapes examining many documents or keys for each one
+     * they return are the ones an index would help.
+     */
+    class QueryShapeStatsList : public PlanCacheCommand {
+    public:
+        QueryShapeStatsList()
+            : PlanCacheCommand("queryShapeStats",
+                               "Displays the count, time and documents examined and returned "
+                               "of each query shape run against a collection. "
+                               "Example: {queryShapeStats: 'collection', limit: 10}",
+                               ActionType::planCacheRead) { }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) {
+            long long limit = 0;
+            BSONElement limitElt = cmdObj["limit"];
+            if (!limitElt.eoo()) {
+                if (!limitElt.isNumber() || limitElt.numberLong() < 0) {
+                    return Status(ErrorCodes::BadValue,
+                                  "optional field limit must be a non-negative number");
+                }
+                limit = limitElt.numberLong();
+            }
+
+            std::vector<QueryShapeStatsEntry> entries;
+            infoCache->getQueryShapeStats()->getAll(&entries);
+
+            BSONArrayBuilder shapesBuilder(bob->subarrayStart("shapes"));
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (limit && static_cast<long long>(i) >= limit) {
+                    break;
+                }
+                const QueryShapeStatsEntry& e = entries[i];
+                // Per returned document, counting a query returning nothing as returning one.
+                const double perReturned = static_cast<double>(std::max(1LL, e.nreturned));
+
+                BSONObjBuilder shapeBob(shapesBuilder.subobjStart());
+                shapeBob.append("query", e.query);
+                shapeBob.append("sort", e.sort);
+                shapeBob.append("projection", e.projection);
+                shapeBob.appendNumber("count", e.count);
+                shapeBob.appendNumber("totalMicros", e.totalMicros);
+                shapeBob.appendNumber("avgMicros", e.totalMicros / std::max(1LL, e.count));
+                shapeBob.appendNumber("maxMicros", e.maxMicros);
+                shapeBob.appendNumber("keysExamined", e.keysExamined);
+                shapeBob.appendNumber("docsExamined", e.docsExamined);
+                shapeBob.appendNumber("nreturned", e.nreturned);
+                shapeBob.append("keysExaminedPerReturned", e.keysExamined / perReturned);
+                shapeBob.append("docsExaminedPerReturned", e.docsExamined / perReturned);
+                shapeBob.doneFast();
+            }
+            shapesBuilder.doneFast();
+            return Status::OK();
+        }
+    };
+
+    /**
+     * { queryShapeStatsClear: <collection> }
+     *
+     * Forgets the query shape statistics of the collection.
+     */
+    class QueryShapeStatsClear : public PlanCacheCommand {
+    public:
+        QueryShapeStatsClear()
+            : PlanCacheCommand("queryShapeStatsClear",
+                               "Resets the query shape statistics of a collection. "
+                               "Example: {queryShapeStatsClear: 'collection'}",
+                               ActionType::planCacheWrite) { }
+
+        virtual Status runPlanCacheCommand(const string& ns, const BSONObj& cmdObj,
+                                           CollectionInfoCache* infoCache,
+                                           BSONObjBuilder* bob) {
+            infoCache->getQueryShapeStats()->clear();
+            return Status::OK();
+        }
+    };
+
+    MONGO_INITIALIZER(PlanCacheCommands)(InitializerContext* context) {
+        // Leaked intentionally: a Command registers itself when constructed.
+        new PlanCacheListShapes();
+        new PlanCacheListPlans();
+        new PlanCacheClear();
+        new PlanCacheListFilters();
+        new PlanCacheSetFilter();
+        new PlanCacheClearFilters();
+        new QueryShapeStatsList();
+        new QueryShapeStatsClear();
+        return Status::OK();
+    }
+
+}  // namespace mongo
@@ -41,6 +41,8 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/util/net/listen.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
 #include "mongo/util/version.h"
@@ -64,6 +66,69 @@ namespace mongo {
         };
         
         MetricTree* MetricTree::theMetricTree = NULL;
+
+        /**
+         * The results of serverStatus last returned for a few deltaToken's, for the next
+         * serverStatus with the token to return just what has changed since.
+         */
+        class DeltaTokens {
+        public:
+            DeltaTokens() : _m( "serverStatusDeltaTokens" ), _next( curTimeMillis64() << 16 ) {}
+
+            /** remembers result under a new token, forgetting the oldest if there are many */
+            long long remember( const BSONObj& result ) {
+                scoped_lock lk( _m );
+                if ( _results.size() >= kMaxTokens ) {
+                    _results.erase( _results.begin() );
+                }
+                long long token = ++_next;
+                _results[token] = result;
+                return token;
+            }
+
+            /** the result remembered for token, forgotten; empty if there is none */
+            BSONObj take( long long token ) {
+                scoped_lock lk( _m );
+                map<long long, BSONObj>::iterator i = _results.find( token );
+                if ( i == _results.end() ) {
+                    return BSONObj();
+                }
+                BSONObj result = i->second;
+                _results.erase( i );
+                return result;
+            }
+
+        private:
+            // about one for each program polling the server, like mongostat
+            static const size_t kMaxTokens = 64;
+
+            mongo::mutex _m;
+            long long _next;
+            map<long long, BSONObj> _results;
+        } deltaTokens;
+
+        /**
+         * Appends the fields of now whose values are not those in before, and of the objects in
+         * both, just the fields that have changed.  Fields that are gone are not noted.
+         */
+        void appendChanged( const BSONObj& now, const BSONObj& before, BSONObjBuilder* b ) {
+            BSONObjIterator i( now );
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                BSONElement old = before[e.fieldName()];
+                if ( e.type() == Object && old.type() == Object ) {
+                    BSONObjBuilder sub;
+                    appendChanged( e.Obj(), old.Obj(), &sub );
+                    BSONObj changed = sub.obj();
+                    if ( !changed.isEmpty() ) {
+                        b->append( e.fieldName(), changed );
+                    }
+                }
+                else if ( old.eoo() || !e.valuesEqual( old ) || e.type() != old.type() ) {
+                    b->append( e );
+                }
+            }
+        }
     }
 
     class CmdServerStatus : public Command {
@@ -92,6 +157,16 @@ namespace mongo {
             
             _runCalled = true;
 
+            // With a deltaToken the status is built apart, for just what has changed since the
+            // status last returned for the token to go in the result.
+            const bool delta = cmdObj.hasField( "deltaToken" );
+            BSONObjBuilder status;
+            BSONObjBuilder& b = delta ? status : result;
+
+            // With defaultSections: false, just the sections asked for by name.
+            const bool defaultSections = cmdObj["defaultSections"].eoo() ||
+                cmdObj["defaultSections"].trueValue();
+
             long long start = Listener::getElapsedTimeMillis();
             BSONObjBuilder timeBuilder(256);
 
@@ -100,14 +175,14 @@ namespace mongo {
             
             // --- basic fields that are global
 
-            result.append("host", prettyHostName() );
-            result.append("version", versionString);
-            result.append("process", serverGlobalParams.binaryName);
-            result.append("pid", ProcessId::getCurrent().asLongLong());
-            result.append("uptime", (double) (time(0) - serverGlobalParams.started));
-            result.append("uptimeMillis", (long long)(curTimeMillis64()-_started));
-            result.append("uptimeEstimate",(double) (start/1000));
-            result.appendDate( "localTime" , jsTime() );
+            b.append("host", prettyHostName() );
+            b.append("version", versionString);
+            b.append("process", serverGlobalParams.binaryName);
+            b.append("pid", ProcessId::getCurrent().asLongLong());
+            b.append("uptime", (double) (time(0) - serverGlobalParams.started));
+            b.append("uptimeMillis", (long long)(curTimeMillis64()-_started));
+            b.append("uptimeEstimate",(double) (start/1000));
+            b.appendDate( "localTime" , jsTime() );
 
             timeBuilder.appendNumber( "after basic" , Listener::getElapsedTimeMillis() - start );
             
@@ -121,7 +196,7 @@ namespace mongo {
                 if (!authSession->isAuthorizedForPrivileges(requiredPrivileges))
                     continue;
 
-                bool include = section->includeByDefault();
+                bool include = defaultSections && section->includeByDefault();
                 
                 BSONElement e = cmdObj[section->getSectionName()];
                 if ( e.type() ) {
@@ -135,18 +210,18 @@ namespace mongo {
                 if ( data.isEmpty() )
                     continue;
 
-                result.append( section->getSectionName(), data );
+                b.append( section->getSectionName(), data );
                 timeBuilder.appendNumber( static_cast<string>(str::stream() << "after " << section->getSectionName()), 
                                           Listener::getElapsedTimeMillis() - start );
             }
 
             // --- counters
             bool includeMetricTree = MetricTree::theMetricTree != NULL;
-            if ( cmdObj["metrics"].type() && !cmdObj["metrics"].trueValue() )
+            if ( cmdObj["metrics"].type() ? !cmdObj["metrics"].trueValue() : !defaultSections )
                 includeMetricTree = false;
 
             if ( includeMetricTree ) {
-                MetricTree::theMetricTree->appendTo( result );
+                MetricTree::theMetricTree->appendTo( b );
             }
 
             // --- some hard coded global things hard to pull out
@@ -154,7 +229,7 @@ namespace mongo {
             {
                 RamLog::LineIterator rl(RamLog::get("warnings"));
                 if (rl.lastWrite() >= time(0)-(10*60)){  // only show warnings from last 10 minutes
-                    BSONArrayBuilder arr(result.subarrayStart("warnings"));
+                    BSONArrayBuilder arr(b.subarrayStart("warnings"));
                     while (rl.more()) {
                         arr.append(rl.next());
                     }
@@ -166,7 +241,21 @@ namespace mongo {
             if ( Listener::getElapsedTimeMillis() - start > 1000 ) {
                 BSONObj t = timeBuilder.obj();
                 log() << "serverStatus was very slow: " << t << endl;
-                result.append( "timing" , t );
+                b.append( "timing" , t );
+            }
+
+            if ( delta ) {
+                BSONObj now = status.obj();
+                const long long since = cmdObj["deltaToken"].numberLong();
+                BSONObj before = since ? deltaTokens.take( since ) : BSONObj();
+                if ( before.isEmpty() ) {
+                    result.appendElements( now );
+                }
+                else {
+                    appendChanged( now, before, &result );
+                    result.append( "deltaSince", since );
+                }
+                result.append( "deltaToken", deltaTokens.remember( now ) );
             }
 
             return true;
@@ -324,6 +413,18 @@ namespace mongo {
             BSONObj generateSection(const BSONElement& configElement) const {
                 BSONObjBuilder b;
                 networkCounter.append( b );
+                BSONObjBuilder buffers( b.subobjStart( "receiveBuffers" ) );
+                buffers.appendNumber( "reused" , MessageBufferPool::reused() );
+                buffers.appendNumber( "allocated" , MessageBufferPool::allocated() );
+                buffers.done();
+#ifdef MONGO_SSL
+                SSLManagerInterface* ssl = getSSLManager();
+                if ( ssl ) {
+                    BSONObjBuilder sslStats( b.subobjStart( "ssl" ) );
+                    ssl->appendHandshakeStats( &sslStats );
+                    sslStats.done();
+                }
+#endif
                 return b.obj();
             }
                 
@@ -0,0 +1,174 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/**
+ * Turning tracing on and off, and the traceDump command, which returns the trace events the
+ * threads have buffered in the Chrome trace event format:
+ *
+ *     { traceDump: 1 }
+ *     { traceDump: 1, clear: true }  // and drops the events returned
+ *
+ * Saving the traceEvents field of the result as JSON gives a file that chrome://tracing loads.
+ */
+
+#include "mongo/pch.h"
+
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/process_id.h"
+#include "mongo/util/trace_points.h"
+
+namespace mongo {
+
+    namespace {
+
+        class TraceEnabledParameter : public ExportedServerParameter<bool> {
+        public:
+            TraceEnabledParameter( bool* value ) :
+                ExportedServerParameter<bool>( ServerParameterSet::getGlobal(),
+                                               "traceEnabled", value, true, true ) {}
+
+            virtual Status set( const bool& newValue ) {
+                Status status = ExportedServerParameter<bool>::set( newValue );
+                if ( status.isOK() )
+                    TracePoints::setEnabled( newValue );
+                return status;
+            }
+        };
+
+        bool traceEnabled = false;
+        TraceEnabledParameter traceEnabledParam( &traceEnabled );
+
+        /**
+         * How many events each thread keeps; the ones that don't fit replace the oldest.
+         */
+        class TraceEventsPerThreadParameter : public ExportedServerParameter<int> {
+        public:
+            TraceEventsPerThreadParameter( int* value ) :
+                ExportedServerParameter<int>( ServerParameterSet::getGlobal(),
+                                              "traceEventsPerThread", value, true, false ) {}
+
+            virtual Status validate( const int& potentialNewValue ) {
+                if ( potentialNewValue < 1 || potentialNewValue > 1024 * 1024 ) {
+                    return Status( ErrorCodes::BadValue,
+                                   "traceEventsPerThread must be between 1 and 1048576" );
+                }
+                return Status::OK();
+            }
+
+            virtual Status set( const int& newValue ) {
+                Status status = ExportedServerParameter<int>::set( newValue );
+                if ( status.isOK() )
+                    TracePoints::setEventsPerThread( newValue );
+                return status;
+            }
+        };
+
+        int traceEventsPerThread = 16384;
+        TraceEventsPerThreadParameter traceEventsPerThreadParam( &traceEventsPerThread );
+
+        class TraceDumpCmd : public Command {
+        public:
+            TraceDumpCmd() : Command( "traceDump" ) {}
+
+            virtual bool slaveOk() const { return true; }
+            virtual bool adminOnly() const { return true; }
+            virtual LockType locktype() const { return NONE; }
+
+            virtual void addRequiredPrivileges( const std::string& dbname,
+                                                const BSONObj& cmdObj,
+                                                std::vector<Privilege>* out ) {
+                ActionSet actions;
+                actions.addAction( ActionType::serverStatus );
+                out->push_back( Privilege( ResourcePattern::forClusterResource(), actions ) );
+            }
+
+            virtual void help( stringstream& h ) const {
+                h << "returns the buffered trace events in the Chrome trace event format\n"
+                  << "{ traceDump: 1, clear: <bool> }";
+            }
+
+            bool run( const string& dbname, BSONObj& cmdObj, int, string& errmsg,
+                      BSONObjBuilder& result, bool fromRepl ) {
+                std::vector<TracePoints::ThreadEvents> all;
+                TracePoints::getAll( &all );
+                if ( cmdObj["clear"].trueValue() )
+                    TracePoints::clear();
+
+                const long long pid = ProcessId::getCurrent().asLongLong();
+                // Leave room for the rest of the reply.
+                const int maxBytes = BSONObjMaxUserSize - 64 * 1024;
+                bool truncated = false;
+
+                BSONArrayBuilder events( result.subarrayStart( "traceEvents" ) );
+                for ( size_t i = 0; i < all.size() && !truncated; ++i ) {
+                    const TracePoints::ThreadEvents& t = all[i];
+                    const long long tid = static_cast<long long>( t.threadId );
+
+                    events.append( BSON( "name" << "thread_name" << "ph" << "M" <<
+                                         "pid" << pid << "tid" << tid <<
+                                         "args" << BSON( "name" << t.threadName ) ) );
+
+                    for ( size_t j = 0; j < t.events.size(); ++j ) {
+                        if ( events.len() > maxBytes ) {
+                            truncated = true;
+                            break;
+                        }
+                        const TracePoints::Event& e = t.events[j];
+                        BSONObjBuilder b( events.subobjStart() );
+                        b.append( "name", e.name );
+                        b.append( "cat", e.category );
+                        b.append( "ph", StringData( &e.phase, 1 ) );
+                        b.append( "ts", e.startMicros );
+                        if ( e.phase == 'X' )
+                            b.append( "dur", e.durationMicros );
+                        else
+                            b.append( "s", "t" );  // an instant of the thread alone
+                        b.append( "pid", pid );
+                        b.append( "tid", tid );
+                        b.doneFast();
+                    }
+                }
+                events.doneFast();
+
+                result.append( "displayTimeUnit", "ms" );
+                result.appendBool( "enabled", TracePoints::enabled() );
+                result.appendBool( "truncated", truncated );
+                return true;
+            }
+        } traceDumpCmd;
+
+    } // namespace
+
+} // namespace mongo
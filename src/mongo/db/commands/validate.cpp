@@ -28,17 +28,97 @@
  *    it in the license file.
  */
 
+#include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/namespace_details.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/new_find.h"
 #include "mongo/db/query/runner.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/extent.h"
 #include "mongo/db/structure/collection.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
 
+    // Indexes one validate checks at once.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(validateIndexThreads, int, 4);
+
+namespace {
+
+    struct IndexValidation {
+        IndexValidation() : iam( NULL ), keys( 0 ), threw( false ) {}
+
+        IndexAccessMethod* iam;
+        long long keys;
+        bool threw;
+    };
+
+    void validateIndex( IndexValidation* validation ) {
+        // The Client of a pool thread holds no lock; the thread that scheduled us holds the read
+        // lock until we are done.
+        Client::initThreadIfNotAlready( "validate worker" );
+
+        try {
+            int64_t keys;
+            validation->iam->validate( &keys );
+            validation->keys = keys;
+        }
+        catch (...) {
+            validation->threw = true;
+        }
+    }
+
+    mongo::mutex validatePoolMutex( "validate pool" );
+    ThreadPool* validatePool = NULL;
+
+    ThreadPool* getValidatePool() {
+        scoped_lock lk( validatePoolMutex );
+        if ( NULL == validatePool ) {
+            // Lives as long as the process.
+            validatePool = new ThreadPool( validateIndexThreads );
+        }
+        return validatePool;
+    }
+
+    /**
+     * Counts the keys of the index 'indexName' of 'ns' with a scan that yields.  Returns false
+     * if the collection or the index went away meanwhile.
+     */
+    bool countIndexKeysYielding( const string& ns, const string& indexName, long long* keys ) {
+        Collection* collection = cc().database()->getCollection( ns );
+        if ( !collection )
+            return false;
+        IndexDescriptor* descriptor = collection->getIndexCatalog()->findIndexByName( indexName );
+        if ( !descriptor )
+            return false;
+
+        IndexScanParams params;
+        params.descriptor = descriptor;
+        params.bounds.isSimpleRange = true;
+        params.bounds.endKeyInclusive = false;
+        params.forceBtreeAccessMethod = true;
+        // every key, not every document
+        params.doNotDedup = true;
+
+        WorkingSet* ws = new WorkingSet();
+        auto_ptr<Runner> runner( new InternalRunner( ns, new IndexScan( params, ws, NULL ), ws ) );
+        ClientCursor::registerRunner( runner.get() );
+        DeregisterEvenIfUnderlyingCodeThrows safety( runner.get() );
+        runner->setYieldPolicy( Runner::YIELD_AUTO );
+
+        *keys = 0;
+        Runner::RunnerState state;
+        while ( Runner::RUNNER_ADVANCED == ( state = runner->getNext( NULL, NULL ) ) ) {
+            ++*keys;
+        }
+        return Runner::RUNNER_EOF == state;
+    }
+
+} // namespace
+
     class ValidateCmd : public Command {
     public:
         ValidateCmd() : Command( "validate" ) {}
@@ -48,7 +128,8 @@ namespace mongo {
         }
 
         virtual void help(stringstream& h) const { h << "Validate contents of a namespace by scanning its data structures for correctness.  Slow.\n"
-                                                        "Add full:true option to do a more thorough check"; }
+                                                        "Add full:true option to do a more thorough check.\n"
+                                                        "Add background:true to yield to other operations, which checks less"; }
 
         virtual LockType locktype() const { return READ; }
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -58,7 +139,7 @@ namespace mongo {
             actions.addAction(ActionType::validate);
             out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
         }
-        //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool> } */
+        //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool>] [, background: <bool>] } */
 
         bool run(const string& dbname , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
             string ns = dbname + "." + cmdObj.firstElement().valuestrsafe();
@@ -92,6 +173,10 @@ namespace mongo {
 
             const bool full = cmdObj["full"].trueValue();
             const bool scanData = full || cmdObj["scandata"].trueValue();
+            // Yields while scanning the documents and the indexes, like a collection scan.  The
+            // collection may change meanwhile, so the checks that compare the documents with the
+            // deleted lists are skipped and the indexes are only walked, not validated.
+            const bool background = cmdObj["background"].trueValue();
 
             NamespaceDetails* nsd = collection->details();
 
@@ -230,6 +315,12 @@ namespace mongo {
                     DiskLoc cl;
                     Runner::RunnerState state;
                     auto_ptr<Runner> runner(InternalPlanner::collectionScan(ns));
+                    scoped_ptr<DeregisterEvenIfUnderlyingCodeThrows> safety;
+                    if ( background ) {
+                        ClientCursor::registerRunner(runner.get());
+                        safety.reset(new DeregisterEvenIfUnderlyingCodeThrows(runner.get()));
+                        runner->setYieldPolicy(Runner::YIELD_AUTO);
+                    }
                     while (Runner::RUNNER_ADVANCED == (state = runner->getNext(NULL, &cl))) {
                         n++;
 
@@ -294,6 +385,18 @@ namespace mongo {
                         // TODO: more descriptive logging.
                         warning() << "Internal error while reading collection " << ns << endl;
                     }
+                    if ( background ) {
+                        safety.reset();
+                        runner.reset();
+                        collection = cc().database()->getCollection( ns );
+                        if ( Runner::RUNNER_DEAD == state || !collection ) {
+                            errors << "collection dropped during background validate";
+                            result.appendBool("valid", false);
+                            result.append("errors", errors.arr());
+                            return;
+                        }
+                        nsd = collection->details();
+                    }
                     if ( nsd->isCapped() && !nsd->capLooped() ) {
                         result.append("cappedOutOfOrder", outOfOrder);
                         if ( outOfOrder > 1 ) {
@@ -371,38 +474,75 @@ namespace mongo {
                     result << "delBucketSizes" << delBucketSizes.arr();
                 }
 
-                if ( incorrect ) {
+                // the records we saw may have been deleted since
+                if ( incorrect && !background ) {
                     errors << (BSONObjBuilder::numStr(incorrect) + " records from datafile are in deleted list");
                     valid = false;
                 }
 
-                int idxn = 0;
-                try  {
-                    IndexCatalog* indexCatalog = collection->getIndexCatalog();
+                IndexCatalog* indexCatalog = collection->getIndexCatalog();
+                result.append("nIndexes", nsd->getCompletedIndexCount());
+                BSONObjBuilder indexes; // not using subObjStart to be exception safe
 
-                    result.append("nIndexes", nsd->getCompletedIndexCount());
-                    BSONObjBuilder indexes; // not using subObjStart to be exception safe
+                if ( background ) {
+                    vector<string> indexNames;
+                    for ( int idxn = 0; idxn < nsd->getCompletedIndexCount(); idxn++ ) {
+                        indexNames.push_back( indexCatalog->getDescriptor( idxn )->indexName() );
+                    }
+                    for ( size_t idxn = 0; idxn < indexNames.size(); idxn++ ) {
+                        const string indexNamespace = ns + ".$" + indexNames[idxn];
+                        log() << "walking index " << idxn << ": " << indexNamespace << endl;
+
+                        long long keys;
+                        if ( !countIndexKeysYielding( ns, indexNames[idxn], &keys ) ) {
+                            errors << ( "index " + indexNamespace +
+                                        " dropped during background validate" );
+                            valid = false;
+                            continue;
+                        }
+                        indexes.appendNumber(indexNamespace, keys);
+                    }
+                }
+                else {
+                    // The indexes are checked on several threads while we hold the read lock.
+                    vector<IndexValidation> validations( nsd->getCompletedIndexCount() );
+                    vector<string> indexNamespaces;
                     NamespaceDetails::IndexIterator i = nsd->ii();
-                    while( i.more() ) {
+                    for ( size_t idxn = 0; i.more(); idxn++ ) {
                         IndexDetails& id = i.next();
                         log() << "validating index " << idxn << ": " << id.indexNamespace() << endl;
+                        indexNamespaces.push_back( id.indexNamespace() );
 
                         IndexDescriptor* descriptor = indexCatalog->getDescriptor( idxn );
                         verify( descriptor );
-                        IndexAccessMethod* iam = indexCatalog->getIndex( descriptor );
-                        verify( iam );
+                        validations[idxn].iam = indexCatalog->getIndex( descriptor );
+                        verify( validations[idxn].iam );
+                    }
 
-                        int64_t keys;
-                        iam->validate(&keys);
-                        indexes.appendNumber(id.indexNamespace(), static_cast<long long>(keys));
-                        idxn++;
+                    if ( validateIndexThreads > 1 && validations.size() > 1 ) {
+                        TaskGroup group( *getValidatePool() );
+                        for ( size_t idxn = 0; idxn < validations.size(); idxn++ ) {
+                            group.schedule( &validateIndex, &validations[idxn] );
+                        }
+                        group.wait();
+                    }
+                    else {
+                        for ( size_t idxn = 0; idxn < validations.size(); idxn++ ) {
+                            validateIndex( &validations[idxn] );
+                        }
+                    }
+
+                    for ( size_t idxn = 0; idxn < validations.size(); idxn++ ) {
+                        if ( validations[idxn].threw ) {
+                            errors << ( "exception during index validate idxn " +
+                                        BSONObjBuilder::numStr( idxn ) );
+                            valid = false;
+                            continue;
+                        }
+                        indexes.appendNumber(indexNamespaces[idxn], validations[idxn].keys);
                     }
-                    result.append("keysPerIndex", indexes.done());
-                }
-                catch (...) {
-                    errors << ("exception during index validate idxn " + BSONObjBuilder::numStr(idxn));
-                    valid=false;
                 }
+                result.append("keysPerIndex", indexes.done());
 
             }
             catch (AssertionException) {
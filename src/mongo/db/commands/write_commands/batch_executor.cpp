@@ -31,10 +31,12 @@
 #include <memory>
 
 #include "mongo/base/error_codes.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/introspect.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/ops/update.h"
 #include "mongo/db/ops/update_lifecycle_impl.h"
@@ -52,6 +54,9 @@ namespace mongo {
 
     using mongoutils::str::stream;
 
+    // How many insert items of a batch are issued together.
+    static const size_t kMaxInsertGroupSize = 64;
+
     WriteBatchExecutor::WriteBatchExecutor( const BSONObj& wc,
                                             Client* client,
                                             OpCounters* opCounters,
@@ -97,49 +102,77 @@ namespace mongo {
         size_t numBatchItems = request.sizeWriteOps();
         size_t numItemErrors = 0;
         bool staleBatch = false;
-        for ( size_t i = 0; i < numBatchItems; i++ ) {
-
-            BSONObj upsertedID = BSONObj();
-            if ( applyWriteItem( BatchItemRef( &request, i ),
-                                 &stats,
-                                 &upsertedID,
-                                 error.get() ) ) {
-
-                // In case updates turned out to be upserts, the callers may be interested
-                // in learning what _id was used for that document.
-                if ( !upsertedID.isEmpty() ) {
-                    if ( numBatchItems == 1 ) {
-                        response->setSingleUpserted(upsertedID);
-                    }
-                    else if ( verbose ) {
-                        std::auto_ptr<BatchedUpsertDetail> upsertDetail(new BatchedUpsertDetail);
-                        upsertDetail->setIndex(i);
-                        upsertDetail->setUpsertedID(upsertedID);
-                        response->addToUpsertDetails(upsertDetail.release());
+
+        // Inserts into a user collection are issued a group at a time, under one lock and with
+        // one pass over each index for all of the group's documents.
+        const bool groupInserts =
+            request.getBatchType() == BatchedCommandRequest::BatchType_Insert
+            && numBatchItems > 1
+            && !request.isUniqueIndexRequest()
+            && !NamespaceString( request.getNS() ).isSystem();
+
+        for ( size_t i = 0; i < numBatchItems; ) {
+
+            size_t end = i + 1;
+            OwnedPointerVector<BatchedErrorDetail> itemErrors;
+            if ( groupInserts ) {
+                end = std::min( numBatchItems, i + kMaxInsertGroupSize );
+                applyInsertGroup( request, i, end, &stats, &itemErrors.mutableVector() );
+            }
+            else {
+                BSONObj upsertedID = BSONObj();
+                if ( applyWriteItem( BatchItemRef( &request, i ),
+                                     &stats,
+                                     &upsertedID,
+                                     error.get() ) ) {
+
+                    // In case updates turned out to be upserts, the callers may be interested
+                    // in learning what _id was used for that document.
+                    if ( !upsertedID.isEmpty() ) {
+                        if ( numBatchItems == 1 ) {
+                            response->setSingleUpserted(upsertedID);
+                        }
+                        else if ( verbose ) {
+                            std::auto_ptr<BatchedUpsertDetail> upsertDetail(new BatchedUpsertDetail);
+                            upsertDetail->setIndex(i);
+                            upsertDetail->setUpsertedID(upsertedID);
+                            response->addToUpsertDetails(upsertDetail.release());
+                        }
                     }
+                    itemErrors.mutableVector().push_back( NULL );
+                }
+                else {
+                    itemErrors.mutableVector().push_back( error.release() );
+                    error.reset( new BatchedErrorDetail );
                 }
             }
-            else {
+
+            bool stopped = false;
+            for ( size_t j = i; j < end && !stopped; j++ ) {
+                std::auto_ptr<BatchedErrorDetail> itemError( itemErrors.vector()[j - i] );
+                itemErrors.mutableVector()[j - i] = NULL;
+                if ( !itemError.get() ) continue;
 
                 // The applyWriteItem did not go thgrou
                 // If the error is sharding related, we'll have to investigate whether we
                 // have a stale view of sharding state.
-                if ( error->getErrCode() == ErrorCodes::StaleShardVersion ) staleBatch = true;
+                if ( itemError->getErrCode() == ErrorCodes::StaleShardVersion ) staleBatch = true;
 
                 // Don't bother recording if the user doesn't want a verbose answer. We want to
                 // keep the error if this is a one-item batch, since we already compact the
                 // response for those.
                 if (verbose || numBatchItems == 1) {
-                    error->setIndex( static_cast<int>( i ) );
-                    response->addToErrDetails( error.release() );
+                    itemError->setIndex( static_cast<int>( j ) );
+                    response->addToErrDetails( itemError.release() );
                 }
 
                 ++numItemErrors;
 
-                if ( request.getOrdered() ) break;
-
-                error.reset( new BatchedErrorDetail );
+                if ( request.getOrdered() ) stopped = true;
             }
+            if ( stopped ) break;
+
+            i = end;
         }
 
         // So far, we may have failed some of the batch's items. So we record
@@ -315,6 +348,103 @@ namespace mongo {
         error->setErrMessage( ex.what() );
     }
 
+    static bool checkShardVersion( const BatchedCommandRequest& request,
+                                   CollectionMetadataPtr* metadata,
+                                   BatchedErrorDetail* error );
+
+    void WriteBatchExecutor::applyInsertGroup( const BatchedCommandRequest& request,
+                                               size_t begin,
+                                               size_t end,
+                                               WriteStats* stats,
+                                               vector<BatchedErrorDetail*>* errors ) {
+        const string& ns = request.getNS();
+        const bool ordered = request.getOrdered();
+        errors->assign( end - begin, NULL );
+
+        _le->reset( true );
+
+        // The group is one operation, like a legacy insert of several documents.  It is not
+        // retried on page faults, since it would insert its first documents again.
+        CurOp childOp( _client, _client->curop() );
+
+        HostAndPort remote =
+            _client->hasRemote() ? _client->getRemote() : HostAndPort( "0.0.0.0", 0 );
+        childOp.reset( remote, dbInsert );
+        childOp.ensureStarted();
+        OpDebug& opDebug = childOp.debug();
+        opDebug.ns = ns;
+        opDebug.op = dbInsert;
+
+        int numInserted = 0;
+        {
+            Lock::DBWrite dbLock( ns );
+            Client::Context ctx( ns,
+                                 storageGlobalParams.dbpath, // TODO: better constructor?
+                                 false /* don't check version here */);
+
+            CollectionMetadataPtr metadata;
+            BatchedErrorDetail staleError;
+            if ( !checkShardVersion( request, &metadata, &staleError ) ) {
+                for ( size_t i = begin; i < end; i++ ) {
+                    (*errors)[i - begin] = new BatchedErrorDetail;
+                    staleError.cloneTo( (*errors)[i - begin] );
+                    if ( ordered ) break;
+                }
+            }
+            else {
+                vector<BSONObj> docs;
+                for ( size_t i = begin; i < end; i++ ) {
+                    docs.push_back( request.getInsertRequest()->getDocumentsAt( i ) );
+                }
+
+                vector<bool> inserted;
+                checkAndInsertBatch( ns.c_str(), docs, ordered, &inserted );
+
+                // The documents that couldn't go in with the rest go in one at a time, which
+                // says why they can't.
+                for ( size_t k = 0; k < docs.size(); k++ ) {
+                    _opCounters->gotInsert();
+                    if ( inserted[k] ) {
+                        numInserted++;
+                        continue;
+                    }
+                    try {
+                        checkAndInsert( ns.c_str(), docs[k] );
+                        getDur().commitIfNeeded();
+                        numInserted++;
+                    }
+                    catch ( const UserException& ex ) {
+                        opDebug.exceptionInfo = ex.getInfo();
+                        (*errors)[k] = new BatchedErrorDetail;
+                        toBatchedError( ex, (*errors)[k] );
+                        if ( ordered ) break;
+                    }
+                }
+            }
+        }
+        childOp.done();
+
+        _le->nObjects = numInserted; // TODO Replace after implementing LastError::recordInsert().
+        opDebug.ninserted = numInserted;
+        stats->numInserted += numInserted;
+
+        opDebug.executionTime = childOp.totalTimeMillis();
+        opDebug.recordStats();
+
+        // Log operation if running with at least "-v", or if exceeds slow threshold.
+        if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1))
+             || opDebug.executionTime >
+                serverGlobalParams.slowMS + childOp.getExpectedLatencyMs()) {
+
+            MONGO_TLOG(1) << opDebug.report( childOp ) << endl;
+        }
+
+        // Save operation to system.profile if shouldDBProfile().
+        if ( childOp.shouldDBProfile( opDebug.executionTime ) ) {
+            profile( *_client, dbInsert, childOp );
+        }
+    }
+
     static void buildStaleError( const ChunkVersion& shardVersionRecvd,
                                  const ChunkVersion& shardVersionWanted,
                                  BatchedErrorDetail* error ) {
@@ -341,33 +471,21 @@ namespace mongo {
         error->setErrMessage( errMsg );
     }
 
-    bool WriteBatchExecutor::doWrite( const string& ns,
-                                      const BatchItemRef& itemRef,
-                                      CurOp* currentOp,
-                                      WriteStats* stats,
-                                      BSONObj* upsertedID,
-                                      BatchedErrorDetail* error ) {
-
-        const BatchedCommandRequest& request = *itemRef.getRequest();
-        int index = itemRef.getItemIndex();
-
-        //
-        // Check our shard version if we need to (must be in the write lock)
-        //
-
-        CollectionMetadataPtr metadata;
+    static bool checkShardVersion( const BatchedCommandRequest& request,
+                                   CollectionMetadataPtr* metadata,
+                                   BatchedErrorDetail* error ) {
         if ( shardingState.enabled() ) {
 
             // Index inserts make the namespace nontrivial for versioning
-            string targetingNS = itemRef.getRequest()->getTargetingNS();
+            string targetingNS = request.getTargetingNS();
             Lock::assertWriteLocked( targetingNS );
-            metadata = shardingState.getCollectionMetadata( targetingNS );
+            *metadata = shardingState.getCollectionMetadata( targetingNS );
 
             if ( request.isShardVersionSet()
                  && !ChunkVersion::isIgnoredVersion( request.getShardVersion() ) ) {
 
                 ChunkVersion shardVersion =
-                    metadata ? metadata->getShardVersion() : ChunkVersion::UNSHARDED();
+                    *metadata ? (*metadata)->getShardVersion() : ChunkVersion::UNSHARDED();
 
                 if ( !request.getShardVersion() //
                     .isWriteCompatibleWith( shardVersion ) ) {
@@ -377,6 +495,27 @@ namespace mongo {
                 }
             }
         }
+        return true;
+    }
+
+    bool WriteBatchExecutor::doWrite( const string& ns,
+                                      const BatchItemRef& itemRef,
+                                      CurOp* currentOp,
+                                      WriteStats* stats,
+                                      BSONObj* upsertedID,
+                                      BatchedErrorDetail* error ) {
+
+        const BatchedCommandRequest& request = *itemRef.getRequest();
+        int index = itemRef.getItemIndex();
+
+        //
+        // Check our shard version if we need to (must be in the write lock)
+        //
+
+        CollectionMetadataPtr metadata;
+        if ( !checkShardVersion( request, &metadata, error ) ) {
+            return false;
+        }
 
         //
         // Not stale, do the actual write
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/s/write_ops/batched_command_request.h"
@@ -88,6 +89,18 @@ namespace mongo {
                              BSONObj* upsertedID,
                              BatchedErrorDetail* error );
 
+        /**
+         * Issues the insert items [begin, end) of 'request' as one operation, inserting as many
+         * of their documents together as it can (see checkAndInsertBatch()).  Increments
+         * 'stats', and sets errors[i - begin] to the error of each item i that failed, or NULL.
+         * With an ordered request, the items after the first that failed are not issued.
+         */
+        void applyInsertGroup( const BatchedCommandRequest& request,
+                               size_t begin,
+                               size_t end,
+                               WriteStats* stats,
+                               std::vector<BatchedErrorDetail*>* errors );
+
         //
         // Helpers to issue underlying write.
         // Returns true iff write item was issued sucessfully and increments stats, populates error
@@ -48,6 +48,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/storage/extent_manager.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/timer.h"
@@ -296,6 +297,165 @@ namespace mongo {
         return true;
     }
 
+    // An online compaction only empties extents that are at most this full: moving the records
+    // out of a fuller extent costs more than the space it gives back.
+    const double onlineCompactMaxExtentFill = 0.5;
+
+    // Records an online compaction moves each time it holds the database write lock.
+    const int onlineCompactBatchSize = 100;
+
+    /** @return true if 'extentLoc' is still one of the extents of 'd' */
+    static bool isExtentOf(NamespaceDetails *d, const DiskLoc& extentLoc) {
+        for( DiskLoc L = d->firstExtent(); !L.isNull(); L = L.ext()->xnext ) {
+            if( L == extentLoc )
+                return true;
+        }
+        return false;
+    }
+
+    /** @return the space taken by the records in the extent at 'extentLoc' */
+    static long long extentRecordBytes(const DiskLoc& extentLoc) {
+        ExtentManager& em = cc().database()->getExtentManager();
+        long long bytes = 0;
+        for( DiskLoc L = extentLoc.ext()->firstRecord; !L.isNull();
+             L = em.getNextRecordInExtent(L) ) {
+            bytes += L.rec()->lengthWithHeaders();
+        }
+        return bytes;
+    }
+
+    /** unlinks the deleted records inside the extent at 'extentLoc' so nothing is allocated there */
+    static void orphanDeletedRecordsInExtent(NamespaceDetails *d, const DiskLoc& extentLoc) {
+        for( int b = 0; b < Buckets; b++ ) {
+            DiskLoc *prev = &d->deletedListEntry(b);
+            DiskLoc cur = *prev;
+            while( !cur.isNull() ) {
+                DeletedRecord *r = cur.drec();
+                if( r->myExtentLoc(cur) == extentLoc )
+                    getDur().writingDiskLoc(*prev) = r->nextDeleted();
+                else
+                    prev = &r->nextDeleted();
+                cur = r->nextDeleted();
+            }
+        }
+    }
+
+    /** moves the record at 'loc' out of the extent being emptied, updating the indexes */
+    static void moveRecordOutOfExtent(Collection* collection, const DiskLoc& loc) {
+        NamespaceDetails *d = collection->details();
+        BSONObj obj = collection->docFor(loc).getOwned();
+        int lenWHdr = loc.rec()->lengthWithHeaders();
+
+        collection->deleteDocument(loc, false, true);
+
+        // the freed space is now the head of its deleted list; take it off so the record is not
+        // put straight back where it was
+        DiskLoc& head = d->deletedListEntry(NamespaceDetails::bucket(lenWHdr));
+        verify( head == loc );
+        getDur().writingDiskLoc(head) = loc.drec()->nextDeleted();
+
+        uassertStatusOK(collection->insertDocument(obj, false).getStatus());
+    }
+
+    /**
+     * Empties the sparse extents of 'ns' a batch of records at a time, releasing the database
+     * lock between batches, and returns each emptied extent to the free list.  Records are moved
+     * the way an update that outgrows its record moves them, so indexes and cursors stay valid
+     * and the collection can be used throughout.
+     */
+    bool _compactOnline(const string& ns, string& errmsg, BSONObjBuilder& result) {
+        list<DiskLoc> extents;
+        {
+            Lock::DBWrite lk(ns);
+            Client::Context ctx(ns);
+            NamespaceDetails *d = nsdetails(ns);
+            massert( 17281, str::stream() << "namespace " << ns << " does not exist", d );
+            // the last extent is where new records go, so it is never emptied
+            for( DiskLoc L = d->firstExtent(); !L.isNull() && L != d->lastExtent();
+                 L = L.ext()->xnext ) {
+                extents.push_back(L);
+            }
+        }
+        log() << "compact online " << extents.size() << " candidate extents" << endl;
+
+        ProgressMeterHolder pm(cc().curop()->setMessage("compact online extent",
+                                                        "Online Extent Compacting Progress",
+                                                        extents.size()));
+
+        long long recordsMoved = 0;
+        int extentsFreed = 0;
+        long long bytesFreed = 0;
+
+        for( list<DiskLoc>::iterator i = extents.begin(); i != extents.end(); i++ ) {
+            const DiskLoc extentLoc = *i;
+            bool sparse = false;
+            while( 1 ) {
+                killCurrentOp.checkForInterrupt(false);
+
+                Lock::DBWrite lk(ns);
+                BackgroundOperation::assertNoBgOpInProgForNs(ns.c_str());
+                Client::Context ctx(ns);
+                Collection* collection = cc().database()->getCollection( ns );
+                if( !collection ) {
+                    errmsg = "collection dropped during online compact";
+                    return false;
+                }
+                NamespaceDetails *d = collection->details();
+
+                // other writers run between batches and may have changed the extent list
+                if( !isExtentOf(d, extentLoc) || extentLoc == d->lastExtent() )
+                    break;
+
+                Extent *e = extentLoc.ext();
+                if( !sparse ) {
+                    if( extentRecordBytes(extentLoc) > onlineCompactMaxExtentFill * e->length )
+                        break;
+                    sparse = true;
+                }
+
+                orphanDeletedRecordsInExtent(d, extentLoc);
+
+                ExtentManager& em = cc().database()->getExtentManager();
+                DiskLoc L = e->firstRecord;
+                for( int n = 0; n < onlineCompactBatchSize && !L.isNull(); n++ ) {
+                    DiskLoc next = em.getNextRecordInExtent(L);
+                    moveRecordOutOfExtent(collection, L);
+                    recordsMoved++;
+                    L = next;
+                }
+
+                if( !e->firstRecord.isNull() ) {
+                    getDur().commitIfNeeded();
+                    continue;
+                }
+
+                // the extent is empty and none of its space is on the deleted lists: unlink it
+                DiskLoc prev = e->xprev;
+                DiskLoc next = e->xnext;
+                if( prev.isNull() )
+                    d->firstExtent().writing() = next;
+                else
+                    prev.ext()->xnext.writing() = next;
+                next.ext()->xprev.writing() = prev;
+                bytesFreed += e->length;
+                getDur().writing(e)->markEmpty();
+                em.freeExtents(extentLoc, extentLoc);
+                extentsFreed++;
+                getDur().commitIfNeeded();
+                break;
+            }
+            pm.hit();
+        }
+        pm.finished();
+
+        log() << "compact online moved " << recordsMoved << " records and freed "
+              << extentsFreed << " extents (" << bytesFreed/1000000.0 << "MB)" << endl;
+        result.append("recordsMoved", recordsMoved);
+        result.append("extentsFreed", extentsFreed);
+        result.append("bytesFreed", bytesFreed);
+        return true;
+    }
+
     bool isCurrentlyAReplSetPrimary();
 
     class CompactCmd : public Command {
@@ -316,8 +476,10 @@ namespace mongo {
             help << "compact collection\n"
                 "warning: this operation blocks the server and is slow. you can cancel with cancelOp()\n"
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
-                "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
+                "  [paddingFactor:<num>], [paddingBytes:<num>], [online:<bool>] }\n"
                 "  force - allows to run on a replica set primary\n"
+                "  online - only empty sparse extents, moving records in small batches and yielding the\n"
+                "           lock between them; indexes are kept, and it may run on a primary without force\n"
                 "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n";
         }
         CompactCmd() : Command("compact") { }
@@ -339,7 +501,8 @@ namespace mongo {
                 return false;
             }
 
-            if( isCurrentlyAReplSetPrimary() && !cmdObj["force"].trueValue() ) { 
+            bool online = cmdObj["online"].trueValue();
+            if( !online && isCurrentlyAReplSetPrimary() && !cmdObj["force"].trueValue() ) { 
                 errmsg = "will not run compact on an active replica set primary as this is a slow blocking operation. use force:true to force";
                 return false;
             }
@@ -371,6 +534,15 @@ namespace mongo {
                 }
             }
 
+            if( online ) {
+                if( cmdObj.hasElement("paddingFactor") || cmdObj.hasElement("paddingBytes") ||
+                    cmdObj.hasElement("preservePadding") ) {
+                    errmsg = "online compact keeps the collection's padding";
+                    return false;
+                }
+                return _compactOnline(ns, errmsg, result);
+            }
+
 
             double pf = 1.0;
             int pb = 0;
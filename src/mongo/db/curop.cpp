@@ -33,6 +33,7 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/database.h"
 #include "mongo/db/kill_current_op.h"
+#include "mongo/db/stats/op_latency_stats.h"
 #include "mongo/util/fail_point_service.h"
 
 namespace mongo {
@@ -81,6 +82,9 @@ namespace mongo {
         _killPending.store(0);
         killCurrentOp.notifyAllWaiters();
         _numYields = 0;
+        _yieldMicros = 0;
+        _accessesNotInMemory = 0;
+        _pageFaultExceptions = 0;
         _expectedLatencyMs = 0;
         _lockStat.reset();
     }
@@ -205,7 +209,13 @@ namespace mongo {
         if ( _client ) {
             const LockState& ls = _client->lockState();
             verify( ls.threadState() );
-            Top::global.record( _ns , _op , ls.hasAnyWriteLock() ? 1 : -1 , micros , _command );
+            long long lockWaitMicros = _lockStat.getTimeAcquiring( 'R' ) +
+                                       _lockStat.getTimeAcquiring( 'W' ) +
+                                       _lockStat.getTimeAcquiring( 'r' ) +
+                                       _lockStat.getTimeAcquiring( 'w' );
+            Top::global.record( _ns , _op , ls.hasAnyWriteLock() ? 1 : -1 , micros ,
+                                lockWaitMicros , _command );
+            OpLatencyStats::global.record( _ns , _op , _command , micros );
         }
     }
 
@@ -262,6 +272,9 @@ namespace mongo {
             b.append("killPending", true);
 
         b.append( "numYields" , _numYields );
+        b.append( "yieldMicros" , _yieldMicros );
+        b.append( "accessesNotInMemory" , _accessesNotInMemory );
+        b.append( "pageFaultExceptions" , _pageFaultExceptions );
         b.append( "lockStats" , _lockStat.report() );
 
         return b.obj();
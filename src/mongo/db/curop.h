@@ -289,6 +289,14 @@ namespace mongo {
         bool killPending() const { return _killPending.loadRelaxed(); }
         void yielded() { _numYields++; }
         int numYields() const { return _numYields; }
+        /** the time from giving the lock up in a yield to having it back */
+        void yieldedFor( long long micros ) { _yieldMicros += micros; }
+        long long yieldMicros() const { return _yieldMicros; }
+        /** a record the operation used wasn't in physical memory, and maybe had to be read in */
+        void accessedNotInMemory() { _accessesNotInMemory++; }
+        long long accessesNotInMemory() const { return _accessesNotInMemory; }
+        void threwPageFaultException() { _pageFaultExceptions++; }
+        int pageFaultExceptions() const { return _pageFaultExceptions; }
         void suppressFromCurop() { _suppressFromCurop = true; }
         
         long long getExpectedLatencyMs() const { return _expectedLatencyMs; }
@@ -339,6 +347,9 @@ namespace mongo {
         ProgressMeter _progressMeter;
         AtomicInt32 _killPending;
         int _numYields;
+        long long _yieldMicros;
+        long long _accessesNotInMemory;
+        int _pageFaultExceptions;
         LockStat _lockStat;
         // _notifyList is protected by the global killCurrentOp's mtx.
         std::vector<bool*> _notifyList;
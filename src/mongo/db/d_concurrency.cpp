@@ -46,6 +46,7 @@
 #include "mongo/util/concurrency/rwlock.h"
 #include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/stacktrace.h"
+#include "mongo/util/trace_points.h"
 
 // oplog locking
 // no top level read locks
@@ -125,6 +126,7 @@ namespace mongo {
         void lock_r() { 
             verify( threadState() == 0 );
             lockState().lockedStart( 'r' );
+            MONGO_TRACE_SCOPE( "lock", "acquire r" );
             q.lock_r(); 
         }
         
@@ -132,6 +134,7 @@ namespace mongo {
             verify( threadState() == 0 );
             getDur().commitIfNeeded();
             lockState().lockedStart( 'w' );
+            MONGO_TRACE_SCOPE( "lock", "acquire w" );
             q.lock_w(); 
         }
         
@@ -139,6 +142,7 @@ namespace mongo {
             LockState& ls = lockState();
             massert(16103, str::stream() << "can't lock_R, threadState=" << (int) ls.threadState(), ls.threadState() == 0);
             ls.lockedStart( 'R' );
+            MONGO_TRACE_SCOPE( "lock", "acquire R" );
             q.lock_R(); 
         }
 
@@ -151,6 +155,7 @@ namespace mongo {
             getDur().commitIfNeeded(); // check before locking - will use an R lock for the commit if need to do one, which is better than W
             ls.lockedStart( 'W' );
             {
+                MONGO_TRACE_SCOPE( "lock", "acquire W" );
                 q.lock_W();
             }
             locked_W();
@@ -179,6 +184,7 @@ namespace mongo {
             wassert( threadState() == 'r' );
             lockState().unlocked();
             q.unlock_r(); 
+            MONGO_TRACE_INSTANT( "lock", "release r" );
         }
 
         void unlock_w() {
@@ -186,6 +192,7 @@ namespace mongo {
             wassert( threadState() == 'w' );
             lockState().unlocked();
             q.unlock_w(); 
+            MONGO_TRACE_INSTANT( "lock", "release w" );
         }
 
         void unlock_R() { _unlock_R(); }
@@ -195,6 +202,7 @@ namespace mongo {
             unlocking_W();
             lockState().unlocked();
             q.unlock_W(); 
+            MONGO_TRACE_INSTANT( "lock", "release W" );
         }
 
         // todo timing stats? : 
@@ -208,6 +216,7 @@ namespace mongo {
             wassert( threadState() == 'R' );
             lockState().unlocked();
             q.unlock_R(); 
+            MONGO_TRACE_INSTANT( "lock", "release R" );
         }
     };
 
@@ -565,6 +574,7 @@ namespace mongo {
 
     void Lock::DBWrite::lockDB(const string& ns) {
         fassert( 16253, !ns.empty() );
+        MONGO_TRACE_SCOPE( "lock", "acquire DBWrite" );
         LockState& ls = lockState();
         
         Acquiring a(this,ls);
@@ -600,6 +610,7 @@ namespace mongo {
 
     void Lock::DBRead::lockDB(const string& ns) {
         fassert( 16254, !ns.empty() );
+        MONGO_TRACE_SCOPE( "lock", "acquire DBRead" );
         LockState& ls = lockState();
         
         Acquiring a(this,ls);
@@ -650,6 +661,7 @@ namespace mongo {
                 lockState().unlockedOther();
     
             _weLocked->unlock();
+            MONGO_TRACE_INSTANT( "lock", "release DBWrite" );
         }
 
         if( _locked_w ) {
@@ -675,6 +687,7 @@ namespace mongo {
                 lockState().unlockedOther();
 
             _weLocked->unlock_shared();
+            MONGO_TRACE_INSTANT( "lock", "release DBRead" );
         }
 
         if( _locked_r ) {
@@ -46,6 +46,7 @@
 #include "mongo/db/pdfile.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/ops/delete.h"
+#include "mongo/db/stats/op_latency_stats.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/structure/collection.h"
 
@@ -317,6 +318,7 @@ namespace mongo {
 
         ClientCursor::invalidate( fullns );
         Top::global.collectionDropped( fullns );
+        OpLatencyStats::global.collectionDropped( fullns );
 
         Status s = _dropNS( fullns );
 
@@ -445,6 +447,7 @@ namespace mongo {
         }
 
         Top::global.collectionDropped( fromNS.toString() );
+        OpLatencyStats::global.collectionDropped( fromNS );
 
         return Status::OK();
     }
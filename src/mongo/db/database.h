@@ -35,6 +35,7 @@
 #include "mongo/db/storage/extent_manager.h"
 #include "mongo/db/storage/record.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
@@ -215,11 +216,10 @@ namespace mongo {
 
         int _magic; // used for making sure the object is still loaded in memory
 
-        // TODO: probably shouldn't be a std::map
         // TODO: make sure deletes go through
         // this in some ways is a dupe of _namespaceIndex
         // but it points to a much more useful data structure
-        typedef std::map< std::string, Collection* > CollectionMap;
+        typedef unordered_map< std::string, Collection* > CollectionMap;
         CollectionMap _collections;
         mutex _collectionLock;
 
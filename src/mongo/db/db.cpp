@@ -65,12 +65,14 @@
 #include "mongo/db/repl/replication_server_status.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/restapi.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/startup_warnings.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/snapshots.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/ttl.h"
 #include "mongo/platform/process_id.h"
+#include "mongo/s/d_logic.h"
 #include "mongo/s/d_writeback.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/background.h"
@@ -212,13 +214,17 @@ namespace mongo {
                         if( cursorid ) {
                             verify( dbresponse.exhaustNS.size() && dbresponse.exhaustNS[0] );
                             string ns = dbresponse.exhaustNS; // before reset() free's it...
+                            // the options of a query or getMore come first; keep asking for
+                            // oplog replies compressed if it did
+                            int options = DbMessage(m).reservedField() &
+                                QueryOption_CompressedOplogReplies;
                             m.reset();
                             BufBuilder b(512);
                             b.appendNum((int) 0 /*size set later in appendData()*/);
                             b.appendNum(header->id);
                             b.appendNum(header->responseTo);
                             b.appendNum((int) dbGetMore);
-                            b.appendNum((int) 0);
+                            b.appendNum(options);
                             b.appendStr(ns);
                             b.appendNum((int) 0); // ntoreturn
                             b.appendNum(cursorid);
@@ -239,6 +245,46 @@ namespace mongo {
             if( c ) c->shutdown();
         }
 
+        virtual bool canDetach() const { return true; }
+
+        virtual DetachedConnectionState* detach( AbstractMessagingPort* p ) {
+            return new ConnectionState();
+        }
+
+        virtual void attach( AbstractMessagingPort* p, DetachedConnectionState* state ) {
+            scoped_ptr<ConnectionState> s( static_cast<ConnectionState*>( state ) );
+            s->attachToThread();
+        }
+
+    private:
+        /**
+         * The thread locals of a connection between its messages.  Everything else a connection
+         * keeps across messages hangs off its Client.
+         */
+        class ConnectionState : public DetachedConnectionState {
+        public:
+            ConnectionState() :
+                _client( currentClient.release() ),
+                _shardInfo( ShardedConnectionInfo::detachFromThread() ) {
+            }
+
+            virtual ~ConnectionState() {
+                delete _shardInfo;
+                delete _client;
+            }
+
+            void attachToThread() {
+                verify( ! currentClient.get() );
+                currentClient.reset( _client );
+                _client = NULL;
+                ShardedConnectionInfo::attachToThread( _shardInfo );
+                _shardInfo = NULL;
+            }
+
+        private:
+            Client* _client;
+            ShardedConnectionInfo* _shardInfo;
+        };
     };
 
     void logStartup() {
@@ -320,38 +366,25 @@ namespace mongo {
         return repairDatabase( dbName.c_str(), errmsg );
     }
 
-    void checkForIdIndexes( Database* db ) {
-
-        if ( db->name() == "local") {
-            // we do not need an _id index on anything in the local database
-            return;
-        }
-
-        list<string> collections;
-        db->namespaceIndex().getNamespaces( collections );
-
-        // for each collection, ensure there is a $_id_ index
-        for (list<string>::iterator i = collections.begin(); i != collections.end(); ++i) {
-            const string& collectionName = *i;
-            NamespaceString ns( collectionName );
-            if ( ns.isSystem() )
-                continue;
-
-            Collection* coll = db->getCollection( collectionName );
-            if ( !coll )
-                continue;
-
-            if ( coll->getIndexCatalog()->findIdIndex() )
-                continue;
-
-            log() << "WARNING: the collection '" << *i
-                  << "' lacks a unique index on _id."
-                  << " This index is needed for replication to function properly"
-                  << startupWarningsLog;
-            log() << "\t To fix this, on the primary run 'db." << i->substr(i->find('.')+1)
-                  << ".createIndex({_id: 1}, {unique: true})'"
-                  << startupWarningsLog;
-        }
+    /**
+     * Reads the pdfile version of dbName from the header of its first data file, without
+     * opening the database.
+     *
+     * @return false if the header couldn't be read.
+     */
+    static bool readDataFileVersion( const string& dbName, int* version, int* versionMinor ) {
+        boost::filesystem::path path( storageGlobalParams.dbpath );
+        if ( storageGlobalParams.directoryperdb )
+            path /= dbName;
+        path /= dbName + ".0";
+
+        std::ifstream f( path.string().c_str(), std::ios::in | std::ios::binary );
+        int header[2];
+        if ( !f.read( reinterpret_cast<char*>( header ), sizeof( header ) ) )
+            return false;
+        *version = header[0];
+        *versionMinor = header[1];
+        return true;
     }
 
     // ran at startup.
@@ -366,15 +399,23 @@ namespace mongo {
             string dbName = *i;
             LOG(1) << "\t" << dbName << endl;
 
+            // Most databases only need their version checked, which their first data file's
+            // header tells without opening them.  The others are opened, and closed again.
+            // (Replica set members check for _id indexes in the IndexRebuilder.)
+            int version = 0;
+            int versionMinor = 0;
+            if ( !mongodGlobalParams.repair &&
+                 !shouldClearNonLocalTmpCollections && dbName != "local" &&
+                 readDataFileVersion( dbName, &version, &versionMinor ) &&
+                 version == PDFILE_VERSION &&
+                 versionMinor == PDFILE_VERSION_MINOR_24_AND_NEWER ) {
+                continue;
+            }
+
             Client::Context ctx( dbName );
             DataFile *p = ctx.db()->getFile( 0 );
             DataFileHeader *h = p->getHeader();
 
-            if ( replSettings.usingReplSets() ) {
-                // we only care about the _id index if we are in a replset
-                checkForIdIndexes(ctx.db());
-            }
-
             if (shouldClearNonLocalTmpCollections || dbName == "local")
                 ctx.db()->clearTmpCollections();
 
@@ -473,6 +514,10 @@ namespace mongo {
         return 0;
     }
 
+    // spread each syncdelay flush of the data files over the whole interval instead of flushing
+    // everything at once every syncdelay seconds
+    MONGO_EXPORT_SERVER_PARAMETER(pacedDataFileFlushes, bool, true);
+
     /**
      * does background async flushes of mmapped files
      */
@@ -482,6 +527,10 @@ namespace mongo {
             : ServerStatusSection( "backgroundFlushing" ),
               _total_time( 0 ),
               _flushes( 0 ),
+              _last_time( 0 ),
+              _chunks( 0 ),
+              _last_pass_time( 0 ),
+              _last_max_chunk_time( 0 ),
               _last() {
         }
 
@@ -509,6 +558,26 @@ namespace mongo {
                     continue;
                 }
 
+                if ( pacedDataFileFlushes ) {
+                    Date_t start = jsTime();
+                    long long passMillis = (long long) (storageGlobalParams.syncdelay * 1000);
+                    MongoFile::PacedFlushStats stats;
+                    int numFiles = MemoryMappedFile::flushAllPaced( passMillis, &stats );
+                    if ( inShutdown() )
+                        break;
+                    int passTime = (int) (jsTime() - start);
+                    _flushedPaced( stats, passTime );
+
+                    if( logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1)) || stats.maxChunkMicros >= 10000000 ) {
+                        log() << "flushing mmaps took " << stats.flushingMicros / 1000 << "ms over " << passTime << "ms "
+                              << " for " << numFiles << " files, slowest range " << stats.maxChunkMicros / 1000 << "ms" << endl;
+                    }
+
+                    // nothing to pace against when there was little or nothing to flush
+                    sleepmillis( std::max( 0LL, passMillis - passTime ) );
+                    continue;
+                }
+
                 sleepmillis((long long) std::max(0.0, (storageGlobalParams.syncdelay * 1000) - time_flushing));
 
                 if ( inShutdown() ) {
@@ -535,6 +604,12 @@ namespace mongo {
             b.appendNumber( "average_ms" , (_flushes ? (_total_time / double(_flushes)) : 0.0) );
             b.appendNumber( "last_ms" , _last_time );
             b.append("last_finished", _last);
+            if ( pacedDataFileFlushes ) {
+                // with paced flushes the *_ms times above leave out the pauses between ranges
+                b.appendNumber( "chunks" , _chunks );
+                b.appendNumber( "last_pass_ms" , _last_pass_time );
+                b.appendNumber( "last_max_chunk_ms" , _last_max_chunk_time );
+            }
             return b.obj();
         }
 
@@ -547,9 +622,19 @@ namespace mongo {
             _last = jsTime();
         }
 
+        void _flushedPaced(const MongoFile::PacedFlushStats& stats, int passMs) {
+            _flushed( (int) (stats.flushingMicros / 1000) );
+            _chunks += stats.chunks;
+            _last_pass_time = passMs;
+            _last_max_chunk_time = (int) (stats.maxChunkMicros / 1000);
+        }
+
         long long _total_time;
         long long _flushes;
         int _last_time;
+        long long _chunks;
+        int _last_pass_time;
+        int _last_max_chunk_time;
         Date_t _last;
 
 
@@ -684,7 +769,10 @@ namespace mongo {
 
         MONGO_ASSERT_ON_EXCEPTION_WITH_MSG( clearTmpFiles(), "clear tmp files" );
 
+        // Where startup time goes, for the log.
+        Timer phaseTimer;
         dur::startup();
+        const int journalRecoveryMillis = phaseTimer.millis();
 
         if (storageGlobalParams.durOptions & StorageGlobalParams::DurRecoverOnly)
             return;
@@ -713,18 +801,23 @@ namespace mongo {
         const bool shouldClearNonLocalTmpCollections = !(missingRepl
                                                          || replSettings.usingReplSets()
                                                          || replSettings.slave == SimpleSlave);
+        phaseTimer.reset();
         repairDatabasesAndCheckVersion(shouldClearNonLocalTmpCollections);
+        const int checkDatabasesMillis = phaseTimer.millis();
 
         if (mongodGlobalParams.upgrade)
             return;
 
+        phaseTimer.reset();
         uassertStatusOK(getGlobalAuthorizationManager()->initialize());
+        const int authInitMillis = phaseTimer.millis();
 
         /* this is for security on certain platforms (nonce generation) */
         srand((unsigned) (curTimeMicros() ^ startupSrandTimer.micros()));
 
         snapshotThread.go();
         d.clientCursorMonitor.go();
+        startProfileWriter();
         PeriodicTask::startRunningPeriodicTasks();
         if (missingRepl) {
             // a warning was logged earlier
@@ -748,6 +841,11 @@ namespace mongo {
         // Starts a background thread that rebuilds all incomplete indices. 
         indexRebuilder.go(); 
 
+        log() << "startup phases: journal recovery " << journalRecoveryMillis << "ms"
+              << ", checking databases " << checkDatabasesMillis << "ms"
+              << ", authorization " << authInitMillis << "ms"
+              << ", total " << startupSrandTimer.millis() << "ms" << endl;
+
         listen(listenPort);
 
         // listen() will return when exit code closes its socket.
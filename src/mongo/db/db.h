@@ -35,6 +35,7 @@
 #include "mongo/db/database_holder.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -57,12 +58,15 @@ namespace mongo {
             tr.reset(new Lock::TempRelease);
             verify( c.curop() );
             c.curop()->yielded();
+            _yieldTimer.reset();
         }
         ~dbtemprelease() {
             tr.reset();
+            cc().curop()->yieldedFor( _yieldTimer.micros() );
             if ( _context ) 
                 _context->relocked();
         }
+        Timer _yieldTimer;
     };
 
     /** must be write locked
@@ -84,12 +88,17 @@ namespace mongo {
             tr.reset(new Lock::TempRelease);
             verify( c.curop() );
             c.curop()->yielded();            
+            _yieldTimer.reset();
         }
         ~dbtempreleasewritelock() {
-            tr.reset();
+            if ( tr ) {
+                tr.reset();
+                cc().curop()->yieldedFor( _yieldTimer.micros() );
+            }
             if ( _context ) 
                 _context->relocked();
         }
+        Timer _yieldTimer;
     };
 
     /**
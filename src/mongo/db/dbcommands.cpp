@@ -1070,6 +1070,53 @@ namespace mongo {
             }
             return totalSize;
         }
+
+        /**
+         * appends how many of the pages of the extents of 'nsd' are among the recently touched
+         * 'pages', out of how many pages those extents take
+         */
+        void appendWorkingSetPages( BSONObjBuilder& b, NamespaceDetails* nsd,
+                                    const vector<size_t>& pages ) {
+            long long inMemory = 0;
+            long long total = 0;
+            for ( DiskLoc L = nsd->firstExtent(); !L.isNull(); L = L.ext()->xnext ) {
+                Extent* e = L.ext();
+                size_t first = reinterpret_cast<size_t>( e ) >> 12;
+                size_t last = ( reinterpret_cast<size_t>( e ) + e->length - 1 ) >> 12;
+                total += last - first + 1;
+                inMemory += std::upper_bound( pages.begin(), pages.end(), last ) -
+                            std::lower_bound( pages.begin(), pages.end(), first );
+            }
+            b.appendNumber( "pagesInMemory", inMemory );
+            b.appendNumber( "pages", total );
+            b.append( "fractionInMemory", total ? double( inMemory ) / total : 0.0 );
+        }
+
+        /** appends the working set estimate for the collection 'ns' and each of its indexes */
+        void appendCollectionWorkingSet( BSONObjBuilder& b, const string& ns ) {
+            vector<size_t> pages;
+            if ( ! Record::workingSetPages( &pages ) ) {
+                b.append( "info", "not supported" );
+                return;
+            }
+
+            NamespaceDetails* nsd = nsdetails( ns );
+            b.append( "note", "thisIsAnEstimate" );
+            appendWorkingSetPages( b, nsd, pages );
+
+            BSONObjBuilder indexes( b.subobjStart( "indexes" ) );
+            NamespaceDetails::IndexIterator ii = nsd->ii();
+            while ( ii.more() ) {
+                IndexDetails& d = ii.next();
+                NamespaceDetails* mine = nsdetails( d.indexNamespace() );
+                if ( ! mine )
+                    continue;
+                BSONObjBuilder index( indexes.subobjStart( d.indexName() ) );
+                appendWorkingSetPages( index, mine, pages );
+                index.done();
+            }
+            indexes.done();
+        }
     }
 
     class CollectionStats : public Command {
@@ -1079,7 +1126,8 @@ namespace mongo {
         virtual LockType locktype() const { return READ; }
         virtual void help( stringstream &help ) const {
             help << "{ collStats:\"blog.posts\" , scale : 1 } scale divides sizes e.g. for KB use 1024\n"
-                    "    avgObjSize - in bytes";
+                    "    avgObjSize - in bytes\n"
+                    "    workingSet:true - also estimate how much of the collection and its indexes was touched recently";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -1146,6 +1194,12 @@ namespace mongo {
             if ( verbose )
                 result.appendArray( "extents" , extents.arr() );
 
+            if ( jsobj["workingSet"].trueValue() ) {
+                BSONObjBuilder workingSet( result.subobjStart( "workingSet" ) );
+                appendCollectionWorkingSet( workingSet, ns );
+                workingSet.done();
+            }
+
             return true;
         }
     } cmdCollectionStats;
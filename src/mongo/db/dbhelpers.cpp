@@ -52,6 +52,7 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/s/d_logic.h"
@@ -60,6 +61,12 @@ namespace mongo {
 
     const BSONObj reverseNaturalObj = BSON( "$natural" << -1 );
 
+    // Most documents removeRange deletes under one acquisition of the write lock.
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 128);
+
+    // A secondaryThrottle wait longer than this halves removeRange's batch size.
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterReplLagMillis, int, 100);
+
     void Helpers::ensureIndex(const char *ns, BSONObj keyPattern, bool unique, const char *name) {
         Database* db = cc().database();
         verify(db);
@@ -341,7 +348,16 @@ namespace mongo {
         
         long long millisWaitingForReplication = 0;
 
-        while ( 1 ) {
+        // The number of documents removed per write lock acquisition.  It halves whenever the
+        // secondaries fall behind or other operations queue for the lock and doubles back up to
+        // rangeDeleterBatchSize while neither happens.
+        const int maxBatchSize = std::max( 1, rangeDeleterBatchSize );
+        int batchSize = maxBatchSize;
+
+        bool done = false;
+        while ( !done ) {
+            int batchDeleted = 0;
+
             // Scoping for write lock.
             {
                 Client::WriteContext ctx(ns);
@@ -358,14 +374,33 @@ namespace mongo {
 
                 runner->setYieldPolicy(Runner::YIELD_AUTO);
 
+                // Collect the batch before deleting anything, so the scan is never positioned on
+                // a record we removed.  Only the first document may yield: once we hold locations
+                // the lock must stay held until they are deleted.
+                vector<pair<BSONObj, DiskLoc> > batch;
                 DiskLoc rloc;
                 BSONObj obj;
                 Runner::RunnerState state;
                 // This may yield so we cannot touch nsd after this.
                 state = runner->getNext(&obj, &rloc);
-                runner.reset();
                 if (Runner::RUNNER_EOF == state) { break; }
+                if (Runner::RUNNER_ADVANCED == state) {
+                    runner->setYieldPolicy(Runner::YIELD_MANUAL);
+                    batch.push_back( make_pair( obj.getOwned(), rloc ) );
+                    while ( static_cast<int>( batch.size() ) < batchSize ) {
+                        state = runner->getNext(&obj, &rloc);
+                        if ( Runner::RUNNER_ADVANCED != state ) break;
+                        batch.push_back( make_pair( obj.getOwned(), rloc ) );
+                    }
+                }
+                runner.reset();
+                if ( batch.empty() ) { break; }
 
+                // The scan may have yielded before the first document.
+                collection = c.database()->getCollection( ns );
+                if ( !collection ) break;
+
+                CollectionMetadataPtr metadataNow;
                 if ( onlyRemoveOrphanedDocs ) {
                     // Do a final check in the write lock to make absolutely sure that our
                     // collection hasn't been modified in a way that invalidates our migration
@@ -376,51 +411,71 @@ namespace mongo {
                     verify(shardingState.enabled());
 
                     // In write lock, so will be the most up-to-date version
-                    CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
-
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        KeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractSingleKey( obj );
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
-                    }
-                    else {
-                        docIsOrphan = false;
-                    }
+                    metadataNow = shardingState.getCollectionMetadata( ns );
+                }
 
-                    if ( !docIsOrphan ) {
-                        warning() << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
+                for ( size_t i = 0; i < batch.size(); ++i ) {
+                    const BSONObj& doc = batch[i].first;
+
+                    if ( onlyRemoveOrphanedDocs ) {
+                        bool docIsOrphan;
+                        if ( metadataNow ) {
+                            KeyPattern kp( metadataNow->getKeyPattern() );
+                            BSONObj key = kp.extractSingleKey( doc );
+                            docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                && !metadataNow->keyIsPending( key );
+                        }
+                        else {
+                            docIsOrphan = false;
+                        }
+
+                        if ( !docIsOrphan ) {
+                            warning() << "aborting migration cleanup for chunk " << min << " to " << max
+                                      << ( metadataNow ? (string) " at document " + doc.toString() : "" )
+                                      << ", collection " << ns << " has changed " << endl;
+                            done = true;
+                            break;
+                        }
                     }
-                }
 
-                if ( callback )
-                    callback->goingToDelete( obj );
+                    if ( callback )
+                        callback->goingToDelete( doc );
 
-                logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
-                c.database()->getCollection( ns )->deleteDocument( rloc );
-                numDeleted++;
+                    logOp("d", ns.c_str(), doc["_id"].wrap(), 0, 0, fromMigrate);
+                    collection->deleteDocument( batch[i].second );
+                    numDeleted++;
+                    batchDeleted++;
+                }
             }
 
             Timer secondaryThrottleTime;
 
-            if ( secondaryThrottle && numDeleted > 0 ) {
+            bool throttled = false;
+            if ( secondaryThrottle && batchDeleted > 0 ) {
                 if ( ! waitForReplication( c.getLastOp(), 2, 60 /* seconds to wait */ ) ) {
                     warning() << "replication to secondaries for removeRange at least 60 seconds behind" << endl;
                 }
                 millisWaitingForReplication += secondaryThrottleTime.millis();
+                // Secondaries that did not keep up with the last batch will not keep up with a
+                // larger one.
+                throttled = secondaryThrottleTime.millis() > rangeDeleterReplLagMillis;
             }
             
             if ( ! Lock::isLocked() ) {
-                int micros = ( 2 * Client::recommendedYieldMicros() ) - secondaryThrottleTime.micros();
+                int yieldMicros = Client::recommendedYieldMicros();
+                throttled = throttled || yieldMicros > 0;
+
+                int micros = ( 2 * yieldMicros ) - secondaryThrottleTime.micros();
                 if ( micros > 0 ) {
                     LOG(1) << "Helpers::removeRangeUnlocked going to sleep for " << micros << " micros" << endl;
                     sleepmicros( micros );
                 }
             }
+
+            if ( throttled )
+                batchSize = std::max( 1, batchSize / 2 );
+            else
+                batchSize = std::min( maxBatchSize, batchSize * 2 );
         }
         
         if ( secondaryThrottle )
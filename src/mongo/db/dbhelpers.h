@@ -146,7 +146,9 @@ namespace mongo {
          *
          * Returns -1 when no usable index exists
          *
-         * Does oplog the individual document deletions.
+         * Does oplog the individual document deletions.  Deletes up to rangeDeleterBatchSize
+         * documents per write lock acquisition, fewer while secondaries or lock waiters fall
+         * behind.
          * // TODO: Refactor this mechanism, it is growing too large
          */
         static long long removeRange( const KeyRange& range,
@@ -122,7 +122,7 @@ namespace mongo {
     */
     class DbMessage {
     public:
-        DbMessage(const Message& _m) : m(_m) , mark(0) {
+        DbMessage(const Message& _m) : m(_m) , mark(0) , validate(serverGlobalParams.objcheck) {
             // for received messages, Message has only one buffer
             theEnd = _m.singleData()->_data + _m.header()->dataLen();
             char *r = _m.singleData()->_data;
@@ -209,7 +209,7 @@ namespace mongo {
                      "Client Error: Remaining data too small for BSON object",
                      theEnd - nextjsobj >= 5 );
 
-            if (serverGlobalParams.objcheck) {
+            if (validate) {
                 Status status = validateBSON( nextjsobj, theEnd - nextjsobj );
                 massert( 10307,
                          str::stream() << "Client Error: bad object in message: " << status.reason(),
@@ -226,6 +226,12 @@ namespace mongo {
             return js;
         }
 
+        /**
+         * Don't validate the objects read after this, for messages from a peer that has
+         * already validated them itself, such as a mongos.
+         */
+        void skipObjectValidation() { validate = false; }
+
         const Message& msg() const { return m; }
 
         const char * markGet() {
@@ -250,6 +256,7 @@ namespace mongo {
         const char *theEnd;
 
         const char * mark;
+        bool validate;
     };
 
 
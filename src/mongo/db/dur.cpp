@@ -86,6 +86,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/stacktrace.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/trace_points.h"
 
 using namespace mongoutils;
 
@@ -109,6 +110,32 @@ namespace mongo {
 
         Stats stats;
 
+        // lets a getlasterror j:true cut the journal thread's sleep short, so it waits for one
+        // commit rather than for the rest of the commit interval as well
+        static mongo::mutex journalWakeupMutex("journalWakeup");
+        static boost::condition journalWakeup;
+        static bool journalWakeupRequested = false; // guarded by journalWakeupMutex
+
+        static void wakeJournalThread() {
+            mutex::scoped_lock lk(journalWakeupMutex);
+            journalWakeupRequested = true;
+            journalWakeup.notify_one();
+        }
+
+        /** sleeps for up to 'ms' millis.  @return true if woken early by wakeJournalThread() */
+        static bool journalSleep(unsigned ms) {
+            boost::system_time deadline = boost::get_system_time() +
+                                          boost::posix_time::milliseconds(ms);
+            mutex::scoped_lock lk(journalWakeupMutex);
+            while( !journalWakeupRequested ) {
+                if( !journalWakeup.timed_wait(lk.boost(), deadline) )
+                    break;
+            }
+            bool woken = journalWakeupRequested;
+            journalWakeupRequested = false;
+            return woken;
+        }
+
         void Stats::S::reset() {
             memset(this, 0, sizeof(*this));
         }
@@ -152,6 +179,7 @@ namespace mongo {
                        "commits" << _commits <<
                        "journaledMB" << _journaledBytes / 1000000.0 <<
                        "writeToDataFilesMB" << _writeToDataFilesBytes / 1000000.0 <<
+                       "remapPrivateViewMB" << _remapPrivateViewBytes / 1000000.0 <<
                        "compression" << _journaledBytes / (_uncompressedBytes+1.0) <<
                        "commitsInWriteLock" << _commitsInWriteLock <<
                        "earlyCommits" << _earlyCommits << 
@@ -159,6 +187,7 @@ namespace mongo {
                        BSON( "dt" << _dtMillis <<
                              "prepLogBuffer" << (unsigned) (_prepLogBufferMicros/1000) <<
                              "writeToJournal" << (unsigned) (_writeToJournalMicros/1000) <<
+                             "compress" << (unsigned) (_compressMicros/1000) <<
                              "writeToDataFiles" << (unsigned) (_writeToDataFilesMicros/1000) <<
                              "remapPrivateView" << (unsigned) (_remapPrivateViewMicros/1000)
                            );
@@ -216,7 +245,21 @@ namespace mongo {
         }
 
         bool DurableImpl::awaitCommit() {
-            commitJob._notify.awaitBeyondNow();
+            NotifyAll::When commitBegun;
+            if( myLastWriteAfterCommit(&commitBegun) ) {
+                // the first commit begun after our last write has it; if that commit is already
+                // in the journal there is nothing to wait for.
+                if( commitJob._notify.lastDone() > commitBegun )
+                    return true;
+                wakeJournalThread();
+                commitJob._notify.waitFor(commitBegun + 1);
+                return true;
+            }
+
+            // take our place before waking the journal thread, so the commit it starts counts
+            NotifyAll::When when = commitJob._notify.now();
+            wakeJournalThread();
+            commitJob._notify.waitFor(when + 1);
             return true;
         }
 
@@ -531,8 +574,7 @@ namespace mongo {
                     DurableMappedFile *mmf = (DurableMappedFile*) *i;
                     verify(mmf);
                     if( mmf->willNeedRemap() ) {
-                        mmf->willNeedRemap() = false;
-                        mmf->remapThePrivateView();
+                        stats.curr->_remapPrivateViewBytes += mmf->remapThePrivateView();
                     }
                     i++;
                     if( i == e ) i = b;
@@ -545,6 +587,7 @@ namespace mongo {
             Call within write lock.  See top of file for more commentary.
         */
         void REMAPPRIVATEVIEW() {
+            MONGO_TRACE_SCOPE( "journal", "REMAPPRIVATEVIEW" );
             Timer t;
             _REMAPPRIVATEVIEW();
             stats.curr->_remapPrivateViewMicros += t.micros();
@@ -556,6 +599,7 @@ namespace mongo {
         static AlignedBuilder __theBuilder(4 * 1024 * 1024);
 
         static bool _groupCommitWithLimitedLocks() {
+            MONGO_TRACE_SCOPE( "journal", "groupCommit" );
             unspoolWriteIntents(); // in case we were doing some writing ourself (likely impossible with limitedlocks version)
             AlignedBuilder &ab = __theBuilder;
 
@@ -638,6 +682,7 @@ namespace mongo {
 
         static void _groupCommit(Lock::GlobalWrite *lgw) {
             LOG(4) << "_groupCommit " << endl;
+            MONGO_TRACE_SCOPE( "journal", "groupCommit" );
 
             // We are 'R' or 'W'
             assertLockedForCommitting();
@@ -813,13 +858,11 @@ namespace mongo {
                     stats.rotate();
 
                     // commit sooner if one or more getLastError j:true is pending
-                    sleepmillis(oneThird);
-                    for( unsigned i = 1; i <= 2; i++ ) {
-                        if( commitJob._notify.nWaiting() )
+                    for( unsigned i = 1; i <= 3; i++ ) {
+                        if( journalSleep(oneThird) || commitJob._notify.nWaiting() )
                             break;
                         if( commitJob.bytes() > UncommittedBytesLimit / 2  )
                             break;
-                        sleepmillis(oneThird);
                     }
                                         
                     //DEV log() << "privateMapBytes=" << privateMapBytes << endl;
@@ -54,9 +54,16 @@ namespace mongo {
             if( !commitJob._hasWritten )
                 commitJob._hasWritten = true;
 
-            if( intents.size() == N ) {
-                if ( !condense() ) {
-                    unspool();
+            if( intents.size() >= _limit ) {
+                condense();
+                if( intents.size() > _limit / 2 ) {
+                    if( _limit < MaxN ) {
+                        _limit *= 2;
+                        intents.reserve(_limit);
+                    }
+                    else {
+                        unspool();
+                    }
                 }
             }
 
@@ -72,6 +79,7 @@ namespace mongo {
             for( unsigned j = 0; j < intents.size(); j++ ) {
                 commitJob.note(intents[j].start(), intents[j].length());
             }
+            noteSpooled_inlock();
 
 #if( CHECK_SPOOLING )
             nSpooled.signedAdd( -1 * static_cast<int>(intents.size()) );
@@ -80,32 +88,53 @@ namespace mongo {
             intents.clear();
         }
 
-        bool ThreadLocalIntents::condense() {
-            std::sort( intents.begin(), intents.end() );
+        /** sort and merge overlapping or adjacent intents in place */
+        void ThreadLocalIntents::condense() {
+            if ( intents.size() < 2 )
+                return;
 
-            bool didAnything = false;
+            std::sort( intents.begin(), intents.end() );
 
-            for ( unsigned x = 0; x < intents.size() - 1 ; x++ ) {
-                if ( intents[x].overlaps( intents[x+1] ) ) {
-                    intents[x].absorb( intents[x+1] );
-                    intents.erase( intents.begin() + x + 1 );
-                    x--;
-                    didAnything = true;
-#if( CHECK_SPOOLING )
-                    nSpooled.signedAdd(-1);
-#endif
+            // intents are sorted by end, so an intent can also overlap ones before the last kept
+            // one; those are journaled twice, which is harmless.
+            unsigned kept = 0;
+            for ( unsigned x = 1; x < intents.size(); x++ ) {
+                if ( intents[kept].overlaps( intents[x] ) ) {
+                    intents[kept].absorb( intents[x] );
+                }
+                else {
+                    intents[++kept] = intents[x];
                 }
             }
+            kept++;
 
-            return didAnything;
+#if( CHECK_SPOOLING )
+            nSpooled.signedAdd( -1 * static_cast<int>(intents.size() - kept) );
+#endif
+            intents.resize( kept );
         }
 
         void ThreadLocalIntents::unspool() {
             if ( intents.size() ) {
+                // merge outside the mutex so it is held for as few notes as possible
+                condense();
                 SimpleMutex::scoped_lock lk(commitJob.groupCommitMutex);
                 _unspool();
             }
         }
+        void ThreadLocalIntents::noteSpooled_inlock() {
+            commitJob.groupCommitMutex.dassertLocked();
+            _hasSpooled = true;
+            _commitBegunAtLastSpool = commitJob._commitNumber;
+        }
+
+        bool ThreadLocalIntents::lastWriteAfter(NotifyAll::When *commitBegun) const {
+            if( !_hasSpooled )
+                return false;
+            *commitBegun = _commitBegunAtLastSpool;
+            return true;
+        }
+
         AtomicUInt ThreadLocalIntents::nSpooled;
     }
 
@@ -133,6 +162,11 @@ namespace mongo {
                 t->unspool();
         }
 
+        bool myLastWriteAfterCommit(NotifyAll::When *commitBegun) {
+            ThreadLocalIntents *t = tlIntents.get();
+            return t && t->lastWriteAfter(commitBegun);
+        }
+
         /** base declare write intent function that all the helpers call. */
         /** we batch up our write intents so that we do not have to synchronize too often */
         void DurableImpl::declareWriteIntent(void *p, unsigned len) {
@@ -185,6 +219,7 @@ namespace mongo {
             cc().writeHappened();
             _hasWritten = true;
             _intentsAndDurOps._durOps.push_back(p);
+            tlIntents.getMake()->noteSpooled_inlock();
         }
 
         size_t privateMapBytes = 0; // used by _REMAPPRIVATEVIEW to track how much / how fast to remap
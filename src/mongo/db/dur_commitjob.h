@@ -116,21 +116,46 @@ namespace mongo {
             #endif
         };
 
-        /** so we don't have to lock the groupCommitMutex too often */
+        /** so we don't have to lock the groupCommitMutex too often.  the buffer starts small and
+            doubles, up to MaxN, whenever condensing it does not free at least half of it; so a
+            thread doing many scattered writes under one lock spools them in a few batches.
+        */
         class ThreadLocalIntents {
-            enum { N = 21 };
+            enum { N = 21, MaxN = 512 };
             std::vector<dur::WriteIntent> intents;
-            bool condense();
+            unsigned _limit;
+            bool _hasSpooled;
+            NotifyAll::When _commitBegunAtLastSpool;
+            void condense();
         public:
-            ThreadLocalIntents() : intents(N) { intents.clear(); }
+            ThreadLocalIntents() : _limit(N), _hasSpooled(false), _commitBegunAtLastSpool(0) {
+                intents.reserve(N);
+            }
             ~ThreadLocalIntents();
             void _unspool();
             void unspool();
             void push(const WriteIntent& i);
             int n_informational() const { return intents.size(); }
+
+            /** note that this thread handed the commit job a write.  groupCommitMutex must be
+                held, so the write is part of the first group commit begun after this.
+            */
+            void noteSpooled_inlock();
+
+            /** @return false if this thread has not written.  otherwise sets commitBegun to the
+                last group commit number begun before its last write; the commits after that one
+                include all of this thread's writes.
+            */
+            bool lastWriteAfter(NotifyAll::When *commitBegun) const;
+
             static AtomicUInt nSpooled;
         };
 
+        /** for getlasterror j:true: sets commitBegun as ThreadLocalIntents::lastWriteAfter() does
+            for the calling thread.  @return false if it has not written.
+        */
+        bool myLastWriteAfterCommit(NotifyAll::When *commitBegun);
+
         /** A commit job object for a group commit.  Currently there is one instance of this object.
 
             concurrency: assumption is caller is appropriately locking.
@@ -55,6 +55,7 @@
 #include "mongo/util/net/listen.h" // getelapsedtimemillis
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/trace_points.h"
 
 using namespace mongoutils;
 
@@ -162,7 +163,7 @@ namespace mongo {
 
         JHeader::JHeader(string fname) {
             magic[0] = 'j'; magic[1] = '\n';
-            _version = CurrentVersion;
+            _version = storageGlobalParams.journalCompression ? CurrentVersion : UncompressedVersion;
             memset(ts, 0, sizeof(ts));
             time_t t = time(0);
             strncpy(ts, time_t_to_String_short(t).c_str(), sizeof(ts)-1);
@@ -723,6 +724,7 @@ namespace mongo {
             will not return until on disk
         */
         void WRITETOJOURNAL(JSectHeader h, AlignedBuilder& uncompressed) {
+            MONGO_TRACE_SCOPE( "journal", "WRITETOJOURNAL" );
             Timer t;
             j.journal(h, uncompressed);
             stats.curr->_writeToJournalMicros += t.micros();
@@ -736,7 +738,9 @@ namespace mongo {
                JSectFooter
             */
             const unsigned headTailSize = sizeof(JSectHeader) + sizeof(JSectFooter);
-            const unsigned max = maxCompressedLength(uncompressed.len()) + headTailSize;
+            const bool compress = storageGlobalParams.journalCompression;
+            const unsigned max = (compress ? maxCompressedLength(uncompressed.len()) : uncompressed.len())
+                                 + headTailSize;
             b.reset(max);
 
             {
@@ -744,11 +748,18 @@ namespace mongo {
                 b.appendStruct(h);
             }
 
-            size_t compressedLength = 0;
-            rawCompress(uncompressed.buf(), uncompressed.len(), b.cur(), &compressedLength);
-            verify( compressedLength < 0xffffffff );
-            verify( compressedLength < max );
-            b.skip(compressedLength);
+            if( compress ) {
+                Timer t;
+                size_t compressedLength = 0;
+                rawCompress(uncompressed.buf(), uncompressed.len(), b.cur(), &compressedLength);
+                verify( compressedLength < 0xffffffff );
+                verify( compressedLength < max );
+                b.skip(compressedLength);
+                stats.curr->_compressMicros += t.micros();
+            }
+            else {
+                b.appendBuf(uncompressed.buf(), uncompressed.len());
+            }
 
             // footer
             unsigned L = 0xffffffff;
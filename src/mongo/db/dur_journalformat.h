@@ -53,6 +53,9 @@ namespace mongo {
 #else
             enum { CurrentVersion = 0x4149 };
 #endif
+            // sections of the file are not compressed (--journalCompressor none).  a version of
+            // its own so older versions refuse the file instead of failing to uncompress it.
+            enum { UncompressedVersion = 0x414a };
             unsigned short _version;
 
             // these are just for diagnostic ease (make header more useful as plain text)
@@ -67,7 +70,8 @@ namespace mongo {
             char reserved3[8026]; // 8KB total for the file header
             char txt2[2];         // "\n\n" at the end
 
-            bool versionOk() const { return _version == CurrentVersion; }
+            bool versionOk() const { return _version == CurrentVersion || _version == UncompressedVersion; }
+            bool compressed() const { return _version != UncompressedVersion; }
             bool valid() const { return magic[0] == 'j' && txt2[1] == '\n' && fileId; }
         };
 
@@ -49,6 +49,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/stacktrace.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/trace_points.h"
 
 using namespace mongoutils;
 
@@ -76,12 +77,8 @@ namespace mongo {
             size_t ofs = 1;
             DurableMappedFile *mmf = findMMF_inlock(i->start(), /*out*/ofs);
 
-            if( unlikely(!mmf->willNeedRemap()) ) {
-                // tag this mmf as needed a remap of its private view later.
-                // usually it will already be dirty/already set, so we do the if above first
-                // to avoid possibility of cpu cache line contention
-                mmf->willNeedRemap() = true;
-            }
+            // tag the written part of this mmf as needing a remap of its private view later.
+            mmf->wroteRange(ofs, i->length());
 
             // since we have already looked up the mmf, we go ahead and remember the write view location
             // so we don't have to find the DurableMappedFile again later in WRITETODATAFILES()
@@ -145,8 +142,8 @@ namespace mongo {
 
             WriteIntent last;
             for( vector<WriteIntent>::const_iterator i = _intents.begin(); i != _intents.end(); i++ ) { 
-                if( i->start() < last.end() ) { 
-                    // overlaps
+                if( i->start() <= last.end() && i != _intents.begin() ) { 
+                    // overlaps or is adjacent; one JEntry covers both
                     last.absorb(*i);
                 }
                 else { 
@@ -191,6 +188,7 @@ namespace mongo {
         }
         void PREPLOGBUFFER(/*out*/ JSectHeader& h, AlignedBuilder& ab) {
             assertLockedForCommitting();
+            MONGO_TRACE_SCOPE( "journal", "PREPLOGBUFFER" );
             Timer t;
             j.assureLogFileOpen(); // so fileId is set
             _PREPLOGBUFFER(h, ab);
@@ -48,6 +48,7 @@
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/storage/durable_mapped_file.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/checksum.h"
@@ -115,12 +116,18 @@ namespace mongo {
             const bool _doDurOps;
             string _uncompressed;
         public:
-            JournalSectionIterator(const JSectHeader& h, const void *compressed, unsigned compressedLen, bool doDurOpsRecovering) :
+            JournalSectionIterator(const JSectHeader& h, const void *compressed, unsigned compressedLen, bool doDurOpsRecovering, bool isCompressed) :
                 _h(h),
                 _lastDbName(0)
                 , _doDurOps(doDurOpsRecovering)
             {
                 verify( doDurOpsRecovering );
+                verify( compressedLen == _h.sectionLen() - sizeof(JSectFooter) - sizeof(JSectHeader) );
+                if( !isCompressed ) {
+                    // --journalCompressor none
+                    _entries = auto_ptr<BufReader>( new BufReader(compressed, compressedLen) );
+                    return;
+                }
                 bool ok = uncompress((const char *)compressed, compressedLen, &_uncompressed);
                 if( !ok ) { 
                     // it should always be ok (i think?) as there is a previous check to see that the JSectFooter is ok
@@ -128,7 +135,6 @@ namespace mongo {
                     msgasserted(15874, "couldn't uncompress journal section");
                 }
                 const char *p = _uncompressed.c_str();
-                verify( compressedLen == _h.sectionLen() - sizeof(JSectFooter) - sizeof(JSectHeader) );
                 _entries = auto_ptr<BufReader>( new BufReader(p, _uncompressed.size()) );
             }
 
@@ -348,6 +354,105 @@ namespace mongo {
             return mmf;
         }
 
+        // number of threads that apply the basic writes of a section during recovery.  1 applies
+        // them all on the recovering thread.
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalRecoveryThreads, int, 4);
+
+        // number of threads that WRITETODATAFILES uses to apply a commit's writes to the data
+        // files.  1 applies them on the committing thread.
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalWriteToDataFilesThreads, int, 2);
+
+        namespace {
+            // below this many bytes in a run of writes, handing them to other threads costs more
+            // than it saves
+            const unsigned long long MinParallelRecoveryBytes = 1024 * 1024;
+
+            struct ResolvedWrite {
+                char *dest;
+                const char *src;
+                unsigned len;
+            };
+
+            void applyResolvedWrites(const vector<ResolvedWrite> *writes) {
+                for( vector<ResolvedWrite>::const_iterator i = writes->begin(); i != writes->end(); ++i ) {
+                    memcpy(i->dest, i->src, i->len);
+                }
+            }
+
+            bool fewerBytes(const pair<unsigned long long, DurableMappedFile*>& a,
+                            const pair<unsigned long long, DurableMappedFile*>& b) {
+                return a.first > b.first;
+            }
+        }
+
+        /** apply a run of basic writes (no DurOp's in between) on several threads, for recovery
+            and for WRITETODATAFILES.  each data file is written by a single thread, so the writes to
+            one file keep their journal order; writes to different files are independent.
+        */
+        void RecoveryJob::applyWritesInParallel(const ParsedJournalEntry *begin,
+                                                const ParsedJournalEntry *end) {
+            // open the files and work out where each write goes on this thread, as opening files
+            // isn't thread safe
+            Last last;
+            map<DurableMappedFile*, vector<ResolvedWrite> > byFile;
+            map<DurableMappedFile*, unsigned long long> bytesByFile;
+            unsigned long long bytes = 0;
+            for( const ParsedJournalEntry *i = begin; i != end; ++i ) {
+                verify(i->dbName);
+                verify((size_t)strnlen(i->dbName, MaxDatabaseNameLen) < MaxDatabaseNameLen);
+                DurableMappedFile *mmf = last.newEntry(*i, *this);
+                if ((i->e->ofs + i->e->len) > mmf->length()) {
+                    // as in write(): while recovering the file may have been truncated later on
+                    massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
+                    continue;
+                }
+                verify(mmf->view_write());
+                ResolvedWrite w;
+                w.dest = (char*)mmf->view_write() + i->e->ofs;
+                w.src = i->e->srcData();
+                w.len = i->e->len;
+                byFile[mmf].push_back(w);
+                bytesByFile[mmf] += w.len;
+                bytes += w.len;
+            }
+            stats.curr->_writeToDataFilesBytes += bytes;
+
+            if( byFile.empty() )
+                return;
+
+            if( byFile.size() == 1 || bytes < MinParallelRecoveryBytes ) {
+                for( map<DurableMappedFile*, vector<ResolvedWrite> >::const_iterator i = byFile.begin();
+                     i != byFile.end(); ++i ) {
+                    applyResolvedWrites(&i->second);
+                }
+                return;
+            }
+
+            // hand out the files biggest first, each to the thread with the least to do so far
+            vector< pair<unsigned long long, DurableMappedFile*> > files;
+            for( map<DurableMappedFile*, unsigned long long>::const_iterator i = bytesByFile.begin();
+                 i != bytesByFile.end(); ++i ) {
+                files.push_back(make_pair(i->second, i->first));
+            }
+            sort(files.begin(), files.end(), fewerBytes);
+
+            const unsigned nThreads = std::min(files.size(), (size_t) journalRecoveryThreads);
+            vector< vector<ResolvedWrite> > perThread(nThreads);
+            vector<unsigned long long> perThreadBytes(nThreads, 0);
+            for( unsigned i = 0; i < files.size(); i++ ) {
+                unsigned t = min_element(perThreadBytes.begin(), perThreadBytes.end()) -
+                             perThreadBytes.begin();
+                const vector<ResolvedWrite>& w = byFile[files[i].second];
+                perThread[t].insert(perThread[t].end(), w.begin(), w.end());
+                perThreadBytes[t] += files[i].first;
+            }
+
+            for( unsigned t = 0; t < nThreads; t++ ) {
+                _writerPool->schedule(applyResolvedWrites, &perThread[t]);
+            }
+            _writerPool->join();
+        }
+
         void RecoveryJob::applyEntries(const vector<ParsedJournalEntry> &entries) {
             bool apply = (storageGlobalParams.durOptions &
                           StorageGlobalParams::DurScanOnly) == 0;
@@ -356,9 +461,34 @@ namespace mongo {
             if( dump )
                 log() << "BEGIN section" << endl;
 
-            Last last;
-            for( vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i ) {
-                applyEntry(last, *i, apply, dump);
+            if( !_recovering && !_writerPool && journalWriteToDataFilesThreads > 1 ) {
+                // WRITETODATAFILES; processSection holds _mx, so only one commit gets here
+                _writerPool.reset(new ThreadPool(journalWriteToDataFilesThreads));
+            }
+
+            if( _writerPool && apply && !dump ) {
+                const ParsedJournalEntry *i = entries.empty() ? 0 : &entries[0];
+                const ParsedJournalEntry *end = i + entries.size();
+                while( i != end ) {
+                    if( !i->e ) {
+                        // a DurOp; it may close the files, so runs of writes don't span it
+                        Last last;
+                        applyEntry(last, *i, apply, dump);
+                        ++i;
+                        continue;
+                    }
+                    const ParsedJournalEntry *runEnd = i;
+                    while( runEnd != end && runEnd->e )
+                        ++runEnd;
+                    applyWritesInParallel(i, runEnd);
+                    i = runEnd;
+                }
+            }
+            else {
+                Last last;
+                for( vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i ) {
+                    applyEntry(last, *i, apply, dump);
+                }
             }
 
             if( dump )
@@ -390,7 +520,7 @@ namespace mongo {
 
             auto_ptr<JournalSectionIterator> i;
             if( _recovering ) {
-                i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, p, len, _recovering));
+                i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, p, len, _recovering, _compressedSections));
             }
             else { 
                 i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, /*after header*/p, /*w/out header*/len));
@@ -459,6 +589,7 @@ namespace mongo {
                         uasserted(13536, str::stream() << "journal version number mismatch " << h._version);
                     }
                     fileId = h.fileId;
+                    _compressedSections = h.compressed();
                     if (storageGlobalParams.durOptions &
                         StorageGlobalParams::DurDumpJournal) {
                         log() << "JHeader::fileId=" << fileId << endl;
@@ -527,6 +658,9 @@ namespace mongo {
             _lastDataSyncedFromLastRun = journalReadLSN();
             log() << "recover lsn: " << _lastDataSyncedFromLastRun << endl;
 
+            if( journalRecoveryThreads > 1 )
+                _writerPool.reset(new ThreadPool(journalRecoveryThreads));
+
             for( unsigned i = 0; i != files.size(); ++i ) {
                 bool abruptEnd = processFile(files[i]);
                 if( abruptEnd && i+1 < files.size() ) {
@@ -537,6 +671,7 @@ namespace mongo {
             }
 
             close();
+            _writerPool.reset();
 
             if (storageGlobalParams.durOptions & StorageGlobalParams::DurScanOnly) {
                 uasserted(13545, str::stream() << "--durOptions "
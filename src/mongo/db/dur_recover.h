@@ -31,10 +31,12 @@
 #pragma once
 
 #include <boost/filesystem/operations.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <list>
 
 #include "mongo/db/dur_journalformat.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/file.h"
 
 namespace mongo {
@@ -57,7 +59,7 @@ namespace mongo {
             } last;        
         public:
             RecoveryJob() : _lastDataSyncedFromLastRun(0), 
-                _mx("recovery"), _recovering(false) { _lastSeqMentionedInConsoleLog = 1; }
+                _mx("recovery"), _recovering(false), _compressedSections(true) { _lastSeqMentionedInConsoleLog = 1; }
             void go(vector<boost::filesystem::path>& files);
             ~RecoveryJob();
 
@@ -71,6 +73,7 @@ namespace mongo {
             void write(Last& last, const ParsedJournalEntry& entry); // actually writes to the file
             void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
             void applyEntries(const vector<ParsedJournalEntry> &entries);
+            void applyWritesInParallel(const ParsedJournalEntry *begin, const ParsedJournalEntry *end);
             bool processFileBuffer(const void *, unsigned len);
             bool processFile(boost::filesystem::path journalfile);
             void _close(); // doesn't lock
@@ -78,12 +81,17 @@ namespace mongo {
 
             list<boost::shared_ptr<DurableMappedFile> > _mmfs;
 
+            // applies basic writes on several threads.  one with journalRecoveryThreads during
+            // go(), then one with journalWriteToDataFilesThreads made on the first commit.
+            boost::scoped_ptr<ThreadPool> _writerPool;
+
             unsigned long long _lastDataSyncedFromLastRun;
             unsigned long long _lastSeqMentionedInConsoleLog;
         public:
             mongo::mutex _mx; // protects _mmfs
         private:
             bool _recovering; // are we in recovery or WRITETODATAFILES
+            bool _compressedSections; // sections of the journal file being recovered are compressed
 
             static RecoveryJob &_instance;
         };
@@ -50,9 +50,11 @@ namespace mongo {
                 unsigned long long _journaledBytes;
                 unsigned long long _uncompressedBytes;
                 unsigned long long _writeToDataFilesBytes;
+                unsigned long long _remapPrivateViewBytes;
 
                 unsigned long long _prepLogBufferMicros;
-                unsigned long long _writeToJournalMicros;
+                unsigned long long _writeToJournalMicros; // includes _compressMicros
+                unsigned long long _compressMicros;
                 unsigned long long _writeToDataFilesMicros;
                 unsigned long long _remapPrivateViewMicros;
 
@@ -35,6 +35,7 @@
 #include "mongo/db/dur_stats.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/trace_points.h"
 
 namespace mongo {
 #ifdef _WIN32
@@ -84,7 +85,8 @@ namespace mongo {
             that which is going to be a remapped on its private view - but that might not be all
             views.
 
-            (2) todo should we do this using N threads?  would be quite easy
+            (2) larger commits touching several files are applied using journalWriteToDataFilesThreads
+                threads (default 2), one per file; see RecoveryJob::applyWritesInParallel().
                 see Hackenberg paper table 5 and 6.  2 threads might be a good balance.
 
             (3) with enough work, we could do this outside the read lock.  it's a bit tricky though.
@@ -102,6 +104,7 @@ namespace mongo {
 #ifdef _WIN32
             SimpleMutex::scoped_lock _globalFlushMutex(globalFlushMutex);
 #endif
+            MONGO_TRACE_SCOPE( "journal", "WRITETODATAFILES" );
             Timer t;
             WRITETODATAFILES_Impl1(h, uncompressed);
             unsigned long long m = t.micros();
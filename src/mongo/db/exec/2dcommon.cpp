@@ -27,6 +27,8 @@
  */
 
 #include "mongo/db/exec/2dcommon.h"
+
+#include "mongo/db/exec/filter.h"
 #include "mongo/db/query/index_bounds_builder.h"
 
 namespace mongo {
@@ -36,6 +38,39 @@ namespace twod_exec {
     // GeoAccumulator
     //
 
+    /**
+     * Returns true if "expr" can be matched against a key of the index with pattern "keyPattern":
+     * every path it looks at is one of the non-geo fields of the key, and it only uses
+     * operators that match a missing field the same way as the null the key holds for it.
+     */
+    static bool canMatchOnKey(const MatchExpression* expr, const BSONObj& keyPattern) {
+        switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR:
+        case MatchExpression::NOT:
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                if (!canMatchOnKey(expr->getChild(i), keyPattern)) { return false; }
+            }
+            return true;
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::EQ:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::MATCH_IN:
+        case MatchExpression::NIN: {
+            BSONElement keyElt = keyPattern.getField(expr->path());
+            // The geo field of the key is a geohash, not the document's value.
+            return !keyElt.eoo() && String != keyElt.type();
+        }
+        default:
+            return false;
+        }
+    }
+
     GeoAccumulator::GeoAccumulator(TwoDAccessMethod* accessMethod, MatchExpression* filter, bool uniqueDocs,
             bool needDistance)
         : _accessMethod(accessMethod), _converter(accessMethod->getParams().geoHashConverter),
@@ -43,6 +78,13 @@ namespace twod_exec {
         _uniqueDocs(uniqueDocs), _needDistance(needDistance) {
 
             _filter = filter;
+
+            // A multikey index has a key for each array element, which can match where the
+            // document wouldn't, as with $nin.
+            IndexDescriptor* descriptor = accessMethod->getDescriptor();
+            _filterOnKey = NULL != _filter
+                           && !descriptor->isMultikey()
+                           && canMatchOnKey(_filter, descriptor->keyPattern());
         }
 
     GeoAccumulator::~GeoAccumulator() { }
@@ -60,29 +102,36 @@ namespace twod_exec {
 
         // Check for match using other key (and potentially doc) criteria
         // Remember match results for each object
-        map<DiskLoc, bool>::iterator match = _matched.find(node.recordLoc);
-        bool newDoc = match == _matched.end();
+        if (_notMatched.count(node.recordLoc)) {
+            return;
+        }
+        bool newDoc = !_matched.count(node.recordLoc);
 
         //cout << "newDoc: " << newDoc << endl;
         if(newDoc) {
             if (NULL != _filter) {
-                // XXX: use key information to match...shove in WSM, try loc_and_idx, then fetch obj
-                // and try that.
-                BSONObj obj = node.recordLoc.obj();
-                bool good = _filter->matchesBSON(obj, NULL);
+                bool good;
+                if (_filterOnKey) {
+                    WorkingSetMember member;
+                    member.state = WorkingSetMember::LOC_AND_IDX;
+                    member.loc = node.recordLoc;
+                    member.keyData.push_back(IndexKeyDatum(_accessMethod->getDescriptor()->keyPattern(),
+                                                           node._key));
+                    good = Filter::passes(&member, _filter);
+                }
+                else {
+                    BSONObj obj = node.recordLoc.obj();
+                    good = _filter->matchesBSON(obj, NULL);
+                    _objectsLoaded++;
+                }
                 _matchesPerfd++;
 
-                //if (details.hasLoadedRecord())
-                //_objectsLoaded++;
-
                 if (! good) {
-                    _matched[ node.recordLoc ] = false;
+                    _notMatched.insert(node.recordLoc);
                     return;
                 }
             }
-            _matched[ node.recordLoc ] = true;
-        } else if(!((*match).second)) {
-            return;
+            _matched.insert(node.recordLoc);
         }
 
         // Exact check with particular data fields
@@ -34,6 +34,7 @@
 #include "mongo/db/pdfile.h"
 
 #include "mongo/db/index/2d_access_method.h"
+#include "mongo/util/flat_hash_set.h"
 
 #pragma once
 
@@ -163,10 +164,17 @@ namespace twod_exec {
 
         TwoDAccessMethod* _accessMethod;
         shared_ptr<GeoHashConverter> _converter;
-        map<DiskLoc, bool> _matched;
+
+        // Documents that passed, and that failed, the filter.
+        FlatHashSet<DiskLoc, DiskLoc::Hasher> _matched;
+        FlatHashSet<DiskLoc, DiskLoc::Hasher> _notMatched;
 
         MatchExpression* _filter;
 
+        // True if the filter can be matched on the index key alone, so that documents it rejects
+        // are never fetched.
+        bool _filterOnKey;
+
         long long _lookedAt;
         long long _matchesPerfd;
         long long _objectsLoaded;
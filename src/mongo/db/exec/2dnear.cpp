@@ -28,6 +28,7 @@
 
 #include "mongo/db/exec/2dnear.h"
 
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/structure/collection.h"
@@ -48,6 +49,7 @@ namespace mongo {
 
     PlanStage::StageState TwoDNear::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
         if (!_initted) {
             _initted = true;
 
@@ -30,13 +30,14 @@
 
 #include "mongo/db/exec/and_common-inl.h"
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 
 namespace mongo {
 
     AndHashStage::AndHashStage(WorkingSet* ws, const MatchExpression* filter)
         : _ws(ws), _filter(filter), _resultIterator(_dataMap.end()),
-          _shouldScanChildren(true), _currentChild(0) {}
+          _shouldScanChildren(true), _currentChild(0), _memUsage(&queryExecMemoryUse) {}
 
     AndHashStage::~AndHashStage() {
         for (size_t i = 0; i < _children.size(); ++i) { delete _children[i]; }
@@ -51,6 +52,7 @@ namespace mongo {
 
     PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -77,6 +79,7 @@ namespace mongo {
         WorkingSetID idToReturn = returnedIt->second;
         _dataMap.erase(returnedIt);
         WorkingSetMember* member = _ws->get(idToReturn);
+        _memUsage -= memUsage(member);
 
         // We should check for matching at the end so the matcher can use information in the
         // indices of all our children.
@@ -106,6 +109,7 @@ namespace mongo {
             verify(_dataMap.end() == _dataMap.find(member->loc));
 
             _dataMap[member->loc] = id;
+            addMemUsage(memUsage(member));
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
@@ -153,7 +157,9 @@ namespace mongo {
                 // We have a hit.  Copy data into the WSM we already have.
                 _seenMap.insert(member->loc);
                 WorkingSetMember* olderMember = _ws->get(_dataMap[member->loc]);
+                _memUsage -= memUsage(olderMember);
                 AndCommon::mergeFrom(olderMember, member);
+                addMemUsage(memUsage(olderMember));
             }
             _ws->free(id);
             ++_commonStats.needTime;
@@ -169,6 +175,7 @@ namespace mongo {
                 if (_seenMap.end() == _seenMap.find(it->first)) {
                     DataMap::iterator toErase = it;
                     ++it;
+                    _memUsage -= memUsage(_ws->get(toErase->second));
                     _ws->free(toErase->second);
                     _dataMap.erase(toErase);
                 }
@@ -254,6 +261,9 @@ namespace mongo {
                 ++_specificStats.flaggedButPassed;
             }
 
+            // It's leaving _dataMap below.
+            _memUsage -= memUsage(member);
+
             // The loc is about to be invalidated.  Fetch it and clear the loc.
             WorkingSetCommon::fetchAndInvalidateLoc(member);
 
@@ -265,6 +275,22 @@ namespace mongo {
         }
     }
 
+    // static
+    size_t AndHashStage::memUsage(const WorkingSetMember* member) {
+        size_t bytes = sizeof(DiskLoc) + sizeof(WorkingSetID);
+        for (size_t i = 0; i < member->keyData.size(); ++i) {
+            bytes += member->keyData[i].keyData.objsize();
+        }
+        return bytes;
+    }
+
+    void AndHashStage::addMemUsage(size_t bytes) {
+        _memUsage += bytes;
+        if (_memUsage > _specificStats.memUsage) {
+            _specificStats.memUsage = _memUsage;
+        }
+    }
+
     PlanStageStats* AndHashStage::getStats() {
         _commonStats.isEOF = isEOF();
 
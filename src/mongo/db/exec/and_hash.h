@@ -36,6 +36,8 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/platform/unordered_set.h"
+#include "mongo/util/flat_hash_set.h"
+#include "mongo/util/memory_use.h"
 
 namespace mongo {
 
@@ -70,6 +72,13 @@ namespace mongo {
         StageState readFirstChild(WorkingSetID* out);
         StageState hashOtherChildren(WorkingSetID* out);
 
+        /**
+         * Roughly how many bytes keeping 'member' in _dataMap costs us.
+         */
+        static size_t memUsage(const WorkingSetMember* member);
+
+        void addMemUsage(size_t bytes);
+
         // Not owned by us.
         WorkingSet* _ws;
 
@@ -84,7 +93,7 @@ namespace mongo {
         DataMap _dataMap;
 
         // Keeps track of what elements from _dataMap subsequent children have seen.
-        typedef unordered_set<DiskLoc, DiskLoc::Hasher> SeenMap;
+        typedef FlatHashSet<DiskLoc, DiskLoc::Hasher> SeenMap;
         SeenMap _seenMap;
 
         // Iterator over the members of _dataMap that survive.
@@ -96,6 +105,9 @@ namespace mongo {
         // Which child are we currently working on?
         size_t _currentChild;
 
+        // How many bytes the members of _dataMap are using.  See memUsage(...).
+        TrackedBytes _memUsage;
+
         // Stats
         CommonStats _commonStats;
         AndHashStats _specificStats;
@@ -31,22 +31,45 @@
 #include "mongo/db/database.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/db/structure/collection_iterator.h"
+#include "mongo/util/fail_point_service.h"
 
 #include "mongo/db/client.h" // XXX-ERH
 #include "mongo/db/pdfile.h" // XXX-ERH/ACM
 
 namespace mongo {
 
+    // Some fail points for testing.
+    MONGO_FP_DECLARE(collscanInMemoryFail);
+    MONGO_FP_DECLARE(collscanInMemorySucceed);
+
+    static bool recordInMemory(const DiskLoc& loc) {
+        if (MONGO_FAIL_POINT(collscanInMemoryFail)) {
+            return false;
+        }
+
+        if (MONGO_FAIL_POINT(collscanInMemorySucceed)) {
+            return true;
+        }
+
+        return Record::likelyInPhysicalMemory(loc.rec()->dataNoThrowing());
+    }
+
     CollectionScan::CollectionScan(const CollectionScanParams& params,
                                    WorkingSet* workingSet,
                                    const MatchExpression* filter)
-        : _workingSet(workingSet), _filter(filter), _params(params), _nsDropped(false) { }
+        : _workingSet(workingSet),
+          _filter(filter),
+          _params(params),
+          _nsDropped(false),
+          _idBeingPagedIn(WorkingSet::INVALID_ID) { }
 
     PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
         if (_nsDropped) { return PlanStage::DEAD; }
 
         if (NULL == _iter) {
@@ -56,14 +79,30 @@ namespace mongo {
                 return PlanStage::DEAD;
             }
 
-            _iter.reset( collection->getIterator( _params.start,
-                                                  _params.tailable,
-                                                  _params.direction ) );
+            if (_params.extentRangeStart.isNull()) {
+                _iter.reset( collection->getIterator( _params.start,
+                                                      _params.tailable,
+                                                      _params.direction ) );
+            }
+            else {
+                _iter.reset( collection->getExtentRangeIterator( _params.extentRangeStart,
+                                                                 _params.extentRangeEnd ) );
+            }
 
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
 
+        if (WorkingSet::INVALID_ID != _idBeingPagedIn) {
+            // The runner has paged in the record we asked for.
+            WorkingSetID id = _idBeingPagedIn;
+            _idBeingPagedIn = WorkingSet::INVALID_ID;
+            WorkingSetMember* member = _workingSet->get(id);
+            member->obj = member->loc.obj();
+            member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+            return returnIfMatches(member, id, out);
+        }
+
         DiskLoc nextLoc;
 
         // Should we try getNext() on the underlying _iter if we're EOF?  Yes, if we're tailable.
@@ -87,18 +126,35 @@ namespace mongo {
         WorkingSetID id = _workingSet->allocate();
         WorkingSetMember* member = _workingSet->get(id);
         member->loc = nextLoc;
+
+        if (!recordInMemory(nextLoc)) {
+            // Have the runner page the record in, outside the lock if it can, rather than fault
+            // on it here.  The iterator has already moved past it, so we pick up from it next.
+            // The member has a loc and no index data, as an index scan's does before a fetch.
+            member->state = WorkingSetMember::LOC_AND_IDX;
+            _idBeingPagedIn = id;
+            *out = id;
+            ++_commonStats.needFetch;
+            return PlanStage::NEED_FETCH;
+        }
+
         member->obj = member->loc.obj();
         member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+        return returnIfMatches(member, id, out);
+    }
 
+    PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
+                                                          WorkingSetID memberID,
+                                                          WorkingSetID* out) {
         ++_specificStats.docsTested;
 
         if (Filter::passes(member, _filter)) {
-            *out = id;
+            *out = memberID;
             ++_commonStats.advanced;
             return PlanStage::ADVANCED;
         }
         else {
-            _workingSet->free(id);
+            _workingSet->free(memberID);
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
@@ -106,6 +162,8 @@ namespace mongo {
 
     bool CollectionScan::isEOF() {
         if (_nsDropped) { return true; }
+        // We still owe our parent the record it paged in for us.
+        if (WorkingSet::INVALID_ID != _idBeingPagedIn) { return false; }
         if (NULL == _iter) { return false; }
         return _iter->isEOF();
     }
@@ -115,6 +173,13 @@ namespace mongo {
         if (NULL != _iter) {
             _iter->invalidate(dl);
         }
+
+        // The record being paged in is going away; skip it.
+        if (WorkingSet::INVALID_ID != _idBeingPagedIn
+            && _workingSet->get(_idBeingPagedIn)->loc == dl) {
+            _workingSet->free(_idBeingPagedIn);
+            _idBeingPagedIn = WorkingSet::INVALID_ID;
+        }
     }
 
     void CollectionScan::prepareToYield() {
@@ -31,13 +31,12 @@
 #include "mongo/db/diskloc.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/working_set.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/structure/collection_iterator.h"
 
 namespace mongo {
 
-    class WorkingSet;
-
     /**
      * Scans over a collection, starting at the DiskLoc provided in params and continuing until
      * there are no more records in the collection.
@@ -59,6 +58,13 @@ namespace mongo {
         virtual PlanStageStats* getStats();
 
     private:
+        /**
+         * Returns ADVANCED with "memberID" if the member passes the filter, else frees it and
+         * returns NEED_TIME.
+         */
+        StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID,
+                                   WorkingSetID* out);
+
         // WorkingSet is not owned by us.
         WorkingSet* _workingSet;
 
@@ -72,6 +78,10 @@ namespace mongo {
         // True if nsdetails(_ns) == NULL on our first call to work.
         bool _nsDropped;
 
+        // The record we asked the runner to page in with NEED_FETCH, if any.  Its member has the
+        // loc but no obj yet.
+        WorkingSetID _idBeingPagedIn;
+
         // Stats
         CommonStats _commonStats;
         CollectionScanStats _specificStats;
@@ -53,6 +53,13 @@ namespace mongo {
 
         // Do we want the scan to be 'tailable'?  Only meaningful if the collection is capped.
         bool tailable;
+
+        // If extentRangeStart is not null, we only scan the records in the extents from
+        // extentRangeStart up to but not including extentRangeEnd, or to the end of the collection
+        // if extentRangeEnd is null.  Only for forward scans over non-capped collections.  Unlike
+        // 'start', an extent isn't invalidated when its records are deleted.
+        DiskLoc extentRangeStart;
+        DiskLoc extentRangeEnd;
     };
 
 }  // namespace mongo
@@ -0,0 +1,193 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/db/exec/count.h"
+
+#include "mongo/db/exec/scoped_timer.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_cursor.h"
+#include "mongo/db/index/index_descriptor.h"
+
+namespace mongo {
+
+    Count::Count(const CountParams& params, WorkingSet* workingSet)
+        : _workingSet(workingSet),
+          _descriptor(params.descriptor),
+          _iam(params.descriptor->getIndexCatalog()->getBtreeIndex(params.descriptor)),
+          _hitEnd(false),
+          _shouldDedup(params.descriptor->isMultikey()),
+          _yieldMovedCursor(false),
+          _params(params) {
+
+        _specificStats.indexName = _descriptor->indexName();
+        _specificStats.isMultiKey = _descriptor->isMultikey();
+        _specificStats.keyPattern = _descriptor->keyPattern();
+    }
+
+    void Count::initIndexCursor() {
+        CursorOptions cursorOptions;
+        cursorOptions.direction = CursorOptions::INCREASING;
+
+        IndexCursor *cursor;
+        Status s = _iam->newCursor(&cursor);
+        verify(s.isOK());
+        verify(cursor);
+        _cursor.reset(cursor);
+        _cursor->setOptions(cursorOptions);
+
+        // The cursor lands on the first key >= startKey.
+        _cursor->seek(_params.startKey);
+
+        // Step over the keys equal to an exclusive startKey.
+        if (!_params.startKeyInclusive) {
+            while (!_cursor->isEOF()
+                   && 0 == _params.startKey.woCompare(_cursor->getKey(),
+                                                      _descriptor->keyPattern(), false)) {
+                ++_specificStats.keysExamined;
+                _cursor->next();
+            }
+        }
+
+        checkEnd();
+    }
+
+    PlanStage::StageState Count::work(WorkingSetID* out) {
+        ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
+
+        if (NULL == _cursor.get()) {
+            // First call to work().  Perform cursor init.
+            initIndexCursor();
+        }
+        else if (_yieldMovedCursor) {
+            _yieldMovedCursor = false;
+            // Note that we're not calling next() here.  We got the next thing when we recovered
+            // from yielding.
+        }
+        else if (!isEOF()) {
+            _cursor->next();
+            checkEnd();
+        }
+
+        if (isEOF()) { return PlanStage::IS_EOF; }
+
+        if (_shouldDedup) {
+            DiskLoc loc = _cursor->getValue();
+            ++_specificStats.dupsTested;
+            if (_returned.end() != _returned.find(loc)) {
+                ++_specificStats.dupsDropped;
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+            _returned.insert(loc);
+        }
+
+        // There is nothing for the caller to look at: every ADVANCED is one more to count.
+        *out = WorkingSet::INVALID_ID;
+        ++_commonStats.advanced;
+        return PlanStage::ADVANCED;
+    }
+
+    bool Count::isEOF() {
+        if (NULL == _cursor.get()) {
+            // Have to call work() at least once.
+            return false;
+        }
+
+        return _hitEnd || _cursor->isEOF();
+    }
+
+    void Count::prepareToYield() {
+        ++_commonStats.yields;
+
+        if (isEOF() || (NULL == _cursor.get())) { return; }
+        _savedKey = _cursor->getKey().getOwned();
+        _savedLoc = _cursor->getValue();
+        _cursor->savePosition();
+    }
+
+    void Count::recoverFromYield() {
+        ++_commonStats.unyields;
+
+        if (isEOF() || (NULL == _cursor.get())) { return; }
+
+        if (!_cursor->restorePosition().isOK() || _cursor->isEOF()) {
+            _hitEnd = true;
+            return;
+        }
+
+        if (!_savedKey.binaryEqual(_cursor->getKey()) || _savedLoc != _cursor->getValue()) {
+            // Our restored position isn't the same as the saved position.  When we call work()
+            // again we want to count where we currently point, not past it.
+            _yieldMovedCursor = true;
+
+            ++_specificStats.yieldMovedCursor;
+
+            // Our restored position might be past endKey, see if we've hit the end.
+            checkEnd();
+        }
+    }
+
+    void Count::invalidate(const DiskLoc& dl) {
+        ++_commonStats.invalidates;
+
+        // If we see this DiskLoc again, it may not be the same doc. it was before, so we want to
+        // count it.
+        FlatHashSet<DiskLoc, DiskLoc::Hasher>::const_iterator it = _returned.find(dl);
+        if (it != _returned.end()) {
+            ++_specificStats.seenInvalidated;
+            _returned.erase(it);
+        }
+    }
+
+    void Count::checkEnd() {
+        if (isEOF()) {
+            _commonStats.isEOF = true;
+            return;
+        }
+
+        int cmp = _params.endKey.woCompare(_cursor->getKey(), _descriptor->keyPattern(), false);
+
+        if (cmp < 0 || (0 == cmp && !_params.endKeyInclusive)) {
+            _hitEnd = true;
+            _commonStats.isEOF = true;
+            return;
+        }
+
+        ++_specificStats.keysExamined;
+    }
+
+    PlanStageStats* Count::getStats() {
+        _commonStats.isEOF = isEOF();
+        auto_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_COUNT));
+        ret->specific.reset(new CountStats(_specificStats));
+        return ret.release();
+    }
+
+}  // namespace mongo
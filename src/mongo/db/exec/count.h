@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include "mongo/db/diskloc.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/flat_hash_set.h"
+
+namespace mongo {
+
+    class IndexAccessMethod;
+    class IndexCursor;
+    class IndexDescriptor;
+    class WorkingSet;
+
+    struct CountParams {
+        CountParams() : descriptor(NULL), startKeyInclusive(true), endKeyInclusive(true) { }
+
+        // What index are we traversing?
+        IndexDescriptor* descriptor;
+
+        // The keys the scan runs between, in index order.  Field names are ignored.
+        BSONObj startKey;
+        bool startKeyInclusive;
+
+        BSONObj endKey;
+        bool endKeyInclusive;
+    };
+
+    /**
+     * Used by the count command.  Scans an index from a start key to an end key.  Does not create
+     * any WorkingSetMember(s) for any of the data, instead returning ADVANCED to indicate to the
+     * caller that another result should be counted.
+     *
+     * Only dedups on DiskLoc if the index is multikey.
+     *
+     * Sub-stage preconditions: None.  Is a leaf and consumes no stage data.
+     */
+    class Count : public PlanStage {
+    public:
+        Count(const CountParams& params, WorkingSet* workingSet);
+        virtual ~Count() { }
+
+        virtual StageState work(WorkingSetID* out);
+        virtual bool isEOF();
+        virtual void prepareToYield();
+        virtual void recoverFromYield();
+        virtual void invalidate(const DiskLoc& dl);
+
+        virtual PlanStageStats* getStats();
+
+    private:
+        /**
+         * Initialize the underlying IndexCursor and position it at the first key in range.
+         */
+        void initIndexCursor();
+
+        /** See if the cursor is pointing at or past _endKey. */
+        void checkEnd();
+
+        // The WorkingSet we annotate with results.  Not owned by us.  We never allocate from it.
+        WorkingSet* _workingSet;
+
+        // Index access.  Both pointers below are owned by Collection -> IndexCatalog.
+        IndexDescriptor* _descriptor;
+        IndexAccessMethod* _iam;
+
+        scoped_ptr<IndexCursor> _cursor;
+
+        // Have we hit the end of the index scan?
+        bool _hitEnd;
+
+        // Could our index have duplicates?  If so, we use _returned to dedup.
+        bool _shouldDedup;
+        FlatHashSet<DiskLoc, DiskLoc::Hasher> _returned;
+
+        // For yielding.
+        BSONObj _savedKey;
+        DiskLoc _savedLoc;
+
+        // True if there was a yield and the yield changed the cursor position.
+        bool _yieldMovedCursor;
+
+        CountParams _params;
+
+        // Stats
+        CommonStats _commonStats;
+        CountStats _specificStats;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,268 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/db/exec/distinct_scan.h"
+
+#include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scoped_timer.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_cursor.h"
+#include "mongo/db/index/index_descriptor.h"
+
+namespace mongo {
+
+    DistinctScan::DistinctScan(const DistinctParams& params, WorkingSet* workingSet,
+                               const MatchExpression* filter)
+        : _workingSet(workingSet),
+          _descriptor(params.descriptor),
+          _iam(params.descriptor->getIndexCatalog()->getBtreeIndex(params.descriptor)),
+          _btreeCursor(NULL),
+          _hitEnd(false),
+          _filter(filter),
+          _skipLastPrefix(false),
+          _yieldMovedCursor(false),
+          _params(params) {
+
+        verify(!_params.bounds.isSimpleRange);
+        verify(_params.fieldNo < _descriptor->keyPattern().nFields());
+
+        _specificStats.indexName = _descriptor->indexName();
+        _specificStats.indexBounds = _params.bounds.toBSON();
+        _specificStats.direction = _params.direction;
+        _specificStats.isMultiKey = _descriptor->isMultikey();
+        _specificStats.keyPattern = _descriptor->keyPattern();
+    }
+
+    void DistinctScan::initIndexCursor() {
+        CursorOptions cursorOptions;
+        if (1 == _params.direction) {
+            cursorOptions.direction = CursorOptions::INCREASING;
+        }
+        else {
+            cursorOptions.direction = CursorOptions::DECREASING;
+        }
+
+        IndexCursor *cursor;
+        Status s = _iam->newCursor(&cursor);
+        verify(s.isOK());
+        _cursor.reset(cursor);
+        _cursor->setOptions(cursorOptions);
+        _btreeCursor = static_cast<BtreeIndexCursor*>(_cursor.get());
+
+        _checker.reset(new IndexBoundsChecker(&_params.bounds,
+                                              _descriptor->keyPattern(),
+                                              _params.direction));
+
+        int nFields = _descriptor->keyPattern().nFields();
+        vector<const BSONElement*> key;
+        vector<bool> inc;
+        key.resize(nFields);
+        inc.resize(nFields);
+        _keyElts.resize(nFields);
+        _keyEltsInc.resize(nFields);
+        if (_checker->getStartKey(&key, &inc)) {
+            _btreeCursor->seek(key, inc);
+            checkEnd();
+        }
+        else {
+            _hitEnd = true;
+        }
+    }
+
+    PlanStage::StageState DistinctScan::work(WorkingSetID* out) {
+        ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
+
+        if (NULL == _cursor.get()) {
+            // First call to work().  Perform cursor init.
+            initIndexCursor();
+        }
+        else if (_yieldMovedCursor) {
+            _yieldMovedCursor = false;
+            // Note that we're not calling advance() here.
+        }
+        else if (!isEOF()) {
+            advance();
+        }
+
+        if (isEOF()) { return PlanStage::IS_EOF; }
+
+        // A yield can leave us on a key whose prefix we've already returned.
+        if (_skipLastPrefix && samePrefix(_cursor->getKey(), _lastReturnedKey)) {
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        member->loc = _cursor->getValue();
+        member->keyData.push_back(IndexKeyDatum(_descriptor->keyPattern(),
+                                                _cursor->getKey().getOwned()));
+        member->state = WorkingSetMember::LOC_AND_IDX;
+
+        if (!Filter::passes(member, _filter)) {
+            _workingSet->free(id);
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
+        _lastReturnedKey = member->keyData[0].keyData;
+
+        BSONObjIterator it(_lastReturnedKey);
+        for (int i = 0; i < _params.fieldNo; ++i) {
+            it.next();
+        }
+        BSONType lastPrefixType = it.next().type();
+        _skipLastPrefix = (jstNULL != lastPrefixType && Undefined != lastPrefixType);
+
+        *out = id;
+        ++_commonStats.advanced;
+        return PlanStage::ADVANCED;
+    }
+
+    void DistinctScan::advance() {
+        BSONObj key = _cursor->getKey();
+        if (_skipLastPrefix && samePrefix(key, _lastReturnedKey)) {
+            // Land after every key with the current prefix, whatever its remaining fields.
+            _btreeCursor->skip(key, _params.fieldNo + 1, true, _keyElts, _keyEltsInc);
+        }
+        else {
+            _cursor->next();
+        }
+        checkEnd();
+    }
+
+    bool DistinctScan::samePrefix(const BSONObj& lhs, const BSONObj& rhs) const {
+        BSONObjIterator lhsIt(lhs);
+        BSONObjIterator rhsIt(rhs);
+        for (int i = 0; i <= _params.fieldNo; ++i) {
+            if (!lhsIt.more() || !rhsIt.more()) { return false; }
+            if (0 != lhsIt.next().woCompare(rhsIt.next(), false)) { return false; }
+        }
+        return true;
+    }
+
+    bool DistinctScan::isEOF() {
+        if (NULL == _cursor.get()) {
+            // Have to call work() at least once.
+            return false;
+        }
+
+        return _hitEnd || _cursor->isEOF();
+    }
+
+    void DistinctScan::prepareToYield() {
+        ++_commonStats.yields;
+
+        if (isEOF() || (NULL == _cursor.get())) { return; }
+        _savedKey = _cursor->getKey().getOwned();
+        _savedLoc = _cursor->getValue();
+        _cursor->savePosition();
+    }
+
+    void DistinctScan::recoverFromYield() {
+        ++_commonStats.unyields;
+
+        if (isEOF() || (NULL == _cursor.get())) { return; }
+
+        // We can have a valid position before we check isEOF(), restore the position, and then be
+        // EOF upon restore.
+        if (!_cursor->restorePosition().isOK() || _cursor->isEOF()) {
+            _hitEnd = true;
+            return;
+        }
+
+        if (!_savedKey.binaryEqual(_cursor->getKey()) || _savedLoc != _cursor->getValue()) {
+            // Our restored position isn't the same as the saved position.  When we call work()
+            // again we want to look at where we currently point, not past it.
+            _yieldMovedCursor = true;
+
+            ++_specificStats.yieldMovedCursor;
+
+            // Our restored position might be past the bounds, see if we've hit the end.
+            checkEnd();
+        }
+    }
+
+    void DistinctScan::invalidate(const DiskLoc& dl) {
+        ++_commonStats.invalidates;
+        // We don't keep any DiskLocs around, so there's nothing to do.
+    }
+
+    void DistinctScan::checkEnd() {
+        if (isEOF()) {
+            _commonStats.isEOF = true;
+            return;
+        }
+
+        // Use _checker to see how things are.
+        for (;;) {
+            IndexBoundsChecker::KeyState keyState;
+            keyState = _checker->checkKey(_cursor->getKey(),
+                                          &_keyEltsToUse,
+                                          &_movePastKeyElts,
+                                          &_keyElts,
+                                          &_keyEltsInc);
+
+            if (IndexBoundsChecker::DONE == keyState) {
+                _hitEnd = true;
+                break;
+            }
+
+            ++_specificStats.keysExamined;
+
+            if (IndexBoundsChecker::VALID == keyState) {
+                break;
+            }
+
+            verify(IndexBoundsChecker::MUST_ADVANCE == keyState);
+            _btreeCursor->skip(_cursor->getKey(), _keyEltsToUse, _movePastKeyElts,
+                               _keyElts, _keyEltsInc);
+
+            // Must check underlying cursor EOF after every cursor movement.
+            if (_btreeCursor->isEOF()) {
+                _hitEnd = true;
+                break;
+            }
+        }
+
+        if (_hitEnd) {
+            _commonStats.isEOF = true;
+        }
+    }
+
+    PlanStageStats* DistinctScan::getStats() {
+        _commonStats.isEOF = isEOF();
+        auto_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_DISTINCT));
+        ret->specific.reset(new DistinctScanStats(_specificStats));
+        return ret.release();
+    }
+
+}  // namespace mongo
@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include "mongo/db/diskloc.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/index/btree_index_cursor.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/query/index_bounds.h"
+
+namespace mongo {
+
+    class IndexAccessMethod;
+    class IndexDescriptor;
+    class WorkingSet;
+
+    struct DistinctParams {
+        DistinctParams() : descriptor(NULL), direction(1), fieldNo(0) { }
+
+        // What index are we traversing?
+        IndexDescriptor* descriptor;
+
+        // And in what direction?
+        int direction;
+
+        // What are the bounds?  They must be btree (not simple range) bounds.
+        IndexBounds bounds;
+
+        // The index fields [0, fieldNo] form the prefix we want one key per value of.
+        int fieldNo;
+    };
+
+    /**
+     * Used by the distinct command.  Returns one index key for each distinct value of a prefix of
+     * the index key within the provided bounds: once a key is returned, the underlying Btree
+     * cursor is moved straight past every other key sharing its prefix.  Finding n distinct
+     * values therefore costs O(n log(index size)) rather than a scan of the whole index.
+     *
+     * A btree key can't tell a null from a missing field, so keys whose last prefix field is null
+     * or undefined are all returned: the caller may need to fetch them to find out.
+     *
+     * Results are LOC_AND_IDX WorkingSetMembers that pass the provided filter, which may only
+     * refer to fields in the index key.  A key that fails the filter doesn't end its prefix.
+     *
+     * Sub-stage preconditions: None.  Is a leaf and consumes no stage data.
+     */
+    class DistinctScan : public PlanStage {
+    public:
+        DistinctScan(const DistinctParams& params, WorkingSet* workingSet,
+                     const MatchExpression* filter);
+        virtual ~DistinctScan() { }
+
+        virtual StageState work(WorkingSetID* out);
+        virtual bool isEOF();
+        virtual void prepareToYield();
+        virtual void recoverFromYield();
+        virtual void invalidate(const DiskLoc& dl);
+
+        virtual PlanStageStats* getStats();
+
+    private:
+        /** Open the cursor and position it at the first key in bounds. */
+        void initIndexCursor();
+
+        /**
+         * Move the cursor to the next key we might return: past the current prefix if we just
+         * returned a key with it, otherwise just to the next key.
+         */
+        void advance();
+
+        /** See if the cursor is out of bounds, skipping ahead to the bounds if it's between them. */
+        void checkEnd();
+
+        /** Do the first fieldNo + 1 fields of 'lhs' and 'rhs' match? */
+        bool samePrefix(const BSONObj& lhs, const BSONObj& rhs) const;
+
+        // The WorkingSet we annotate with results.  Not owned by us.
+        WorkingSet* _workingSet;
+
+        // Index access.  Both pointers below are owned by Collection -> IndexCatalog.
+        IndexDescriptor* _descriptor;
+        IndexAccessMethod* _iam;
+
+        // Owned by us.  The cursor is really a BtreeIndexCursor.
+        scoped_ptr<IndexCursor> _cursor;
+        BtreeIndexCursor* _btreeCursor;
+
+        // Have we hit the end of the index scan?
+        bool _hitEnd;
+
+        // Contains expressions only over fields in the index key.  Not owned by us.
+        const MatchExpression* _filter;
+
+        // The last key we returned, and whether we skip the other keys with the same prefix.
+        BSONObj _lastReturnedKey;
+        bool _skipLastPrefix;
+
+        // For yielding.
+        BSONObj _savedKey;
+        DiskLoc _savedLoc;
+
+        // True if there was a yield and the yield changed the cursor position.
+        bool _yieldMovedCursor;
+
+        DistinctParams _params;
+
+        // For checking the bounds, and skipping ahead to them.
+        scoped_ptr<IndexBoundsChecker> _checker;
+        int _keyEltsToUse;
+        bool _movePastKeyElts;
+        vector<const BSONElement*> _keyElts;
+        vector<bool> _keyEltsInc;
+
+        // Stats
+        CommonStats _commonStats;
+        DistinctScanStats _specificStats;
+    };
+
+}  // namespace mongo
@@ -29,6 +29,7 @@
 #include "mongo/db/exec/fetch.h"
 
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/util/fail_point_service.h"
@@ -68,6 +69,7 @@ namespace mongo {
 
     PlanStage::StageState FetchStage::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
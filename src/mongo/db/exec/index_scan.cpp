@@ -29,6 +29,7 @@
 #include "mongo/db/exec/index_scan.h"
 
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/index/catalog_hack.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_cursor.h"
@@ -50,7 +51,8 @@ namespace mongo {
     IndexScan::IndexScan(const IndexScanParams& params, WorkingSet* workingSet,
                          const MatchExpression* filter)
         : _workingSet(workingSet), _descriptor(params.descriptor), _hitEnd(false), _filter(filter), 
-          _shouldDedup(params.descriptor->isMultikey()), _yieldMovedCursor(false), _params(params),
+          _shouldDedup(params.descriptor->isMultikey()), _returnedMemUsage(&queryExecMemoryUse),
+          _yieldMovedCursor(false), _params(params),
           _btreeCursor(NULL) {
 
         string amName;
@@ -86,6 +88,7 @@ namespace mongo {
 
     PlanStage::StageState IndexScan::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
 
         if (NULL == _indexCursor.get()) {
             // First call to work().  Perform cursor init.
@@ -167,13 +170,17 @@ namespace mongo {
 
         if (_shouldDedup) {
             ++_specificStats.dupsTested;
-            if (_returned.end() != _returned.find(loc)) {
+            if (!_returned.insert(loc)) {
                 ++_specificStats.dupsDropped;
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
             }
-            else {
-                _returned.insert(loc);
+
+            // The set only grows, a doubling at a time.
+            const size_t memUsage = _returned.memUsage();
+            if (memUsage != _returnedMemUsage) {
+                _returnedMemUsage = memUsage;
+                _specificStats.dedupMemUsage = memUsage;
             }
         }
 
@@ -246,7 +253,7 @@ namespace mongo {
 
         // If we see this DiskLoc again, it may not be the same doc. it was before, so we want to
         // return it.
-        unordered_set<DiskLoc, DiskLoc::Hasher>::iterator it = _returned.find(dl);
+        FlatHashSet<DiskLoc, DiskLoc::Hasher>::const_iterator it = _returned.find(dl);
         if (it != _returned.end()) {
             ++_specificStats.seenInvalidated;
             _returned.erase(it);
@@ -35,7 +35,8 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/index_bounds.h"
-#include "mongo/platform/unordered_set.h"
+#include "mongo/util/flat_hash_set.h"
+#include "mongo/util/memory_use.h"
 
 namespace mongo {
 
@@ -106,7 +107,8 @@ namespace mongo {
 
         // Could our index have duplicates?  If so, we use _returned to dedup.
         bool _shouldDedup;
-        unordered_set<DiskLoc, DiskLoc::Hasher> _returned;
+        FlatHashSet<DiskLoc, DiskLoc::Hasher> _returned;
+        TrackedBytes _returnedMemUsage;
 
         // For yielding.
         BSONObj _savedKey;
@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/limit.h"
 
+#include "mongo/db/exec/scoped_timer.h"
+
 namespace mongo {
 
     LimitStage::LimitStage(int limit, WorkingSet* ws, PlanStage* child)
@@ -39,6 +41,7 @@ namespace mongo {
 
     PlanStage::StageState LimitStage::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
 
         // If we've returned as many results as we're limited to, isEOF will be true.
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -36,6 +36,7 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/util/flat_hash_set.h"
 
 namespace mongo {
 
@@ -80,7 +81,7 @@ namespace mongo {
         bool _dedup;
 
         // Which DiskLocs have we seen?
-        unordered_set<DiskLoc, DiskLoc::Hasher> _seen;
+        FlatHashSet<DiskLoc, DiskLoc::Hasher> _seen;
 
         // Owned by us.  All the children we're reading from.
         vector<PlanStage*> _children;
@@ -35,9 +35,11 @@ namespace mongo {
 
     // Does not take ownership.
     OplogStart::OplogStart(const string& ns, MatchExpression* filter, WorkingSet* ws)
-        : _needInit(true),
+        : _low(0),
+          _high(0),
+          _needInit(true),
+          _searching(false),
           _backwardsScanning(false),
-          _extentHopping(false),
           _done(false),
           _workingSet(ws),
           _ns(ns),
@@ -48,76 +50,89 @@ namespace mongo {
     PlanStage::StageState OplogStart::work(WorkingSetID* out) {
         // We do our (heavy) init in a work(), where work is expected.
         if (_needInit) {
-            CollectionScanParams params;
-            params.ns = _ns;
-            params.direction = CollectionScanParams::BACKWARD;
-            _cs.reset(new CollectionScan(params, _workingSet, NULL));
             _nsd = nsdetails(_ns.c_str());
+            extentsInInsertionOrder(_nsd, &_extents);
+            _low = 0;
+            _high = _extents.size();
             _needInit = false;
-            _backwardsScanning = true;
-            _timer.reset();
+            _searching = true;
+        }
+
+        if (_searching) {
+            return workBinarySearch(out);
         }
 
         // How long will we look record by record backwards?
         static const int backwardsScanTime = 5;
 
-        // If we're reading backwards, try again.
-        if (_backwardsScanning) {
-            // Still have time to succeed with reading backwards.
-            if (_timer.seconds() < backwardsScanTime) {
-                return workBackwardsScan(out);
-            }
-            switchToExtentHopping();
+        verify(_backwardsScanning);
+        // Still have time to succeed with reading backwards.
+        if (_timer.seconds() < backwardsScanTime) {
+            return workBackwardsScan(out);
         }
 
-        // Don't find it in time?  Swing from extent to extent like tarzan.com.
-        verify(_extentHopping);
-        return workExtentHopping(out);
+        // Don't find it in time?  Start from the beginning of the newest extent.
+        _backwardsScanning = false;
+        _cs.reset();
+        return returnLoc(extentFirstLoc(_extents.size() - 1), out);
     }
 
-    PlanStage::StageState OplogStart::workExtentHopping(WorkingSetID* out) {
-        if (_curloc.isNull()) {
+    PlanStage::StageState OplogStart::workBinarySearch(WorkingSetID* out) {
+        if (_low < _high) {
+            // One probe per work(), so that we may yield between them.
+            const size_t mid = _low + (_high - _low) / 2;
+            const DiskLoc loc = extentFirstLoc(mid);
+
+            // An extent emptied since we looked is taken as matching, which only makes us
+            // start earlier than we need to.
+            if (loc.isNull() || _filter->matchesBSON(loc.obj())) {
+                _high = mid;
+            }
+            else {
+                _low = mid + 1;
+            }
+            return PlanStage::NEED_TIME;
+        }
+
+        _searching = false;
+
+        // Every extent starts with a match, so start from the beginning.
+        if (0 == _low) {
             _done = true;
             return PlanStage::IS_EOF;
         }
 
-        if (!_filter->matchesBSON(_curloc.obj())) {
-            _done = true;
-            WorkingSetID id = _workingSet->allocate();
-            WorkingSetMember* member = _workingSet->get(id);
-            member->loc = _curloc;
-            member->obj = member->loc.obj();
-            member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
-            *out = id;
-            return PlanStage::ADVANCED;
+        // We start in the extent being inserted into: likely near its end.
+        if (_low == _extents.size()) {
+            switchToBackwardsScan();
+            return PlanStage::NEED_TIME;
         }
 
-        _curloc = prevExtentFirstLoc(_nsd, _curloc);
-        return PlanStage::NEED_TIME;
+        return returnLoc(extentFirstLoc(_low - 1), out);
     }
 
-    void OplogStart::switchToExtentHopping() {
-        // Transition from backwards scanning to extent hopping.
-        _backwardsScanning = false;
-        _extentHopping = true;
+    PlanStage::StageState OplogStart::returnLoc(const DiskLoc& loc, WorkingSetID* out) {
+        _done = true;
+        if (loc.isNull()) {
+            return PlanStage::IS_EOF;
+        }
 
-        // Toss the collection scan we were using.
-        _cs.reset();
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        member->loc = loc;
+        member->obj = member->loc.obj();
+        member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+        *out = id;
+        return PlanStage::ADVANCED;
+    }
 
-        // Set up our extent hopping state.  Get the start of the extent that we were collection
-        // scanning.
-        Extent* e = _curloc.rec()->myExtent(_curloc);
-        if (!_nsd->capLooped() || (e->myLoc != _nsd->capExtent())) {
-            _curloc = e->firstRecord;
-        }
-        else {
-            // Direct quote:
-            // Likely we are on the fresh side of capExtent, so return first fresh
-            // record.  If we are on the stale side of capExtent, then the collection is
-            // small and it doesn't matter if we start the extent scan with
-            // capFirstNewRecord.
-            _curloc = _nsd->capFirstNewRecord();
-        }
+    void OplogStart::switchToBackwardsScan() {
+        CollectionScanParams params;
+        params.ns = _ns;
+        params.direction = CollectionScanParams::BACKWARD;
+        _cs.reset(new CollectionScan(params, _workingSet, NULL));
+        _backwardsScanning = true;
+        _timer.reset();
     }
 
     PlanStage::StageState OplogStart::workBackwardsScan(WorkingSetID* out) {
@@ -141,7 +156,6 @@ namespace mongo {
             return PlanStage::ADVANCED;
         }
         else {
-            _curloc = member->loc;
             _workingSet->free(*out);
             return PlanStage::NEED_TIME;
         }
@@ -150,16 +164,10 @@ namespace mongo {
     bool OplogStart::isEOF() { return _done; }
 
     void OplogStart::invalidate(const DiskLoc& dl) {
-        if (_needInit) { return; }
+        // The binary search holds only extents.
         if (_backwardsScanning) {
             _cs->invalidate(dl);
         }
-        else {
-            verify(_extentHopping);
-            if (dl == _curloc) {
-                _curloc = DiskLoc();
-            }
-        }
     }
 
     void OplogStart::prepareToYield() {
@@ -174,41 +182,46 @@ namespace mongo {
         }
     }
 
+    DiskLoc OplogStart::extentFirstLoc(size_t i) const {
+        const DiskLoc& ext = _extents[i];
+        if (_nsd->capLooped() && ext == _nsd->capExtent()) {
+            // The fresh side of capExtent; its stale side is the oldest data in the collection,
+            // older than the extent after it, and we don't search it.
+            const DiskLoc& fresh = _nsd->capFirstNewRecord();
+            return fresh.isValid() ? fresh : DiskLoc();
+        }
+        return ext.ext()->firstRecord;
+    }
+
     // static
-    DiskLoc OplogStart::prevExtentFirstLoc(NamespaceDetails* nsd, const DiskLoc& rec ) {
-        Extent *e = rec.rec()->myExtent( rec );
-        if (nsd->capLooped() ) {
-            while( true ) {
-                // Advance e to preceding extent (looping to lastExtent if necessary).
-                if ( e->xprev.isNull() ) {
-                    e = nsd->lastExtent().ext();
-                }
-                else {
-                    e = e->xprev.ext();
-                }
-                if ( e->myLoc == nsd->capExtent() ) {
-                    // Reached the extent containing the oldest data in the collection.
-                    return DiskLoc();
-                }
-                if ( !e->firstRecord.isNull() ) {
-                    // Return the first record of the first non empty extent encountered.
-                    return e->firstRecord;
+    void OplogStart::extentsInInsertionOrder(NamespaceDetails* nsd, vector<DiskLoc>* extents) {
+        extents->clear();
+        if (!nsd->capLooped()) {
+            for (DiskLoc ext = nsd->firstExtent(); !ext.isNull(); ext = ext.ext()->xnext) {
+                if (!ext.ext()->firstRecord.isNull()) {
+                    extents->push_back(ext);
                 }
             }
+            return;
         }
-        else {
-            while( true ) {
-                if ( e->xprev.isNull() ) {
-                    // Reached the beginning of the collection.
-                    return DiskLoc();
-                }
-                e = e->xprev.ext();
-                if ( !e->firstRecord.isNull() ) {
-                    // Return the first record of the first non empty extent encountered.
-                    return e->firstRecord;
-                }
+
+        // From the extent after capExtent, looping to firstExtent if necessary, round to
+        // capExtent.
+        const DiskLoc capExtent = nsd->capExtent();
+        DiskLoc ext = capExtent.ext()->xnext;
+        while (true) {
+            if (ext.isNull()) {
+                ext = nsd->firstExtent();
+            }
+            if (ext == capExtent) {
+                break;
+            }
+            if (!ext.ext()->firstRecord.isNull()) {
+                extents->push_back(ext);
             }
+            ext = ext.ext()->xnext;
         }
+        extents->push_back(capExtent);
     }
 
 }  // namespace mongo
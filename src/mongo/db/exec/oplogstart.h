@@ -37,21 +37,23 @@
 namespace mongo {
 
     /**
-     * OplogStart walks a collection backwards to find the first object in the collection that
-     * matches the query.  It's used by replication to efficiently find where the oplog should be
-     * replayed from.
+     * OplogStart finds where in a collection to start scanning for the objects that match the
+     * query.  It's used by replication to efficiently find where the oplog should be replayed
+     * from.
      *
      * The oplog is always a capped collection.  In capped collections, documents are oriented on
      * disk according to insertion order.  The oplog inserts documents with increasing timestamps.
-     * Queries on the oplog look for entries that are after a certain time.  Therefore if we
-     * navigate backwards, the last document we encounter that satisfies our query (over the
-     * timestamp) is the first document we must scan from to answer the query.
+     * Queries on the oplog look for entries that are after a certain time.  Therefore the last
+     * document in insertion order that doesn't satisfy our query (over the timestamp) is where
+     * we must scan from to answer the query.
      *
-     * Why isn't this a normal reverse table scan, you may ask?  We could be correct if we used a
-     * normal reverse collection scan.  However, that's not fast enough.  Since we know all
-     * documents are oriented on disk in insertion order, we know all documents in one extent were
-     * inserted before documents in a subsequent extent.  As such we can skip through entire extents
-     * looking only at the first document.
+     * Why isn't this a normal collection scan, you may ask?  We could be correct if we used one.
+     * However, that's not fast enough for a big oplog.  Since we know all documents are oriented
+     * on disk in insertion order, we know all documents in one extent were inserted before
+     * documents in a subsequent extent.  As such we binary search the extents, put in insertion
+     * order, looking only at the first document of each, for the last extent starting before the
+     * time we want.  If that's the extent being inserted into, we scan it backwards from the end
+     * a while, as the start is then likely near the end; otherwise we start from its beginning.
      *
      * Why is this a stage?  Because we want to yield, and we want to be notified of DiskLoc
      * invalidations.  :(
@@ -72,37 +74,49 @@ namespace mongo {
         // PS. don't call this.
         virtual PlanStageStats* getStats() { return NULL; }
     private:
-        // Copied verbatim.
-        static DiskLoc prevExtentFirstLoc(NamespaceDetails* nsd, const DiskLoc& rec);
+        /**
+         * The extents of nsd that hold documents, oldest first.  Once the collection has looped,
+         * the extent inserted into is last, and its stale documents are left out.
+         */
+        static void extentsInInsertionOrder(NamespaceDetails* nsd, vector<DiskLoc>* extents);
+
+        /** the oldest document of the extent _extents[i], or null if it has none */
+        DiskLoc extentFirstLoc(size_t i) const;
 
         StageState workBackwardsScan(WorkingSetID* out);
 
-        void switchToExtentHopping();
+        void switchToBackwardsScan();
+
+        StageState workBinarySearch(WorkingSetID* out);
 
-        StageState workExtentHopping(WorkingSetID* out);
+        StageState returnLoc(const DiskLoc& loc, WorkingSetID* out);
 
         // If we're backwards scanning we just punt to a collscan.
         scoped_ptr<CollectionScan> _cs;
 
-        // What's our current DiskLoc?  Set by both collscan and extent hopping.
-        // Only written by collscan, read and written by extent hopping.
-        DiskLoc _curloc;
+        // The extents we binary search, and the range [_low, _high) of them, in which is the
+        // first one whose first document matches; _low - 1 is the one to start from.  Extents
+        // don't move, so these survive a yield; their first documents are read as we go.
+        vector<DiskLoc> _extents;
+        size_t _low;
+        size_t _high;
 
         // Have we done our heavy init yet?
         bool _needInit;
 
-        // Our first state: going backwards via a collscan.
-        bool _backwardsScanning;
+        // Our first state: binary searching the extents.
+        bool _searching;
 
-        // Our second state: hopping backwards extent by extent.
-        bool _extentHopping;
+        // When the start is in the newest extent: going backwards via a collscan.
+        bool _backwardsScanning;
 
         // Our final state: done.
         bool _done;
 
         NamespaceDetails* _nsd;
 
-        // We only go backwards via a collscan for a few seconds.
+        // We only go backwards via a collscan for a few seconds, then start from the beginning
+        // of the newest extent.
         Timer _timer;
 
         // WorkingSet is not owned by us.
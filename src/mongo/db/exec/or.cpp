@@ -28,6 +28,7 @@
 
 #include "mongo/db/exec/or.h"
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scoped_timer.h"
 
 namespace mongo {
 
@@ -46,6 +47,7 @@ namespace mongo {
 
     PlanStage::StageState OrStage::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -147,7 +149,7 @@ namespace mongo {
         // If we see DL again it is not the same record as it once was so we still want to
         // return it.
         if (_dedup) {
-            unordered_set<DiskLoc, DiskLoc::Hasher>::iterator it = _seen.find(dl);
+            FlatHashSet<DiskLoc, DiskLoc::Hasher>::const_iterator it = _seen.find(dl);
             if (_seen.end() != it) {
                 ++_specificStats.locsForgotten;
                 _seen.erase(dl);
@@ -32,7 +32,7 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
-#include "mongo/platform/unordered_set.h"
+#include "mongo/util/flat_hash_set.h"
 
 namespace mongo {
 
@@ -77,7 +77,7 @@ namespace mongo {
         bool _dedup;
 
         // Which DiskLocs have we returned?
-        unordered_set<DiskLoc, DiskLoc::Hasher> _seen;
+        FlatHashSet<DiskLoc, DiskLoc::Hasher> _seen;
 
         // Stats
         CommonStats _commonStats;
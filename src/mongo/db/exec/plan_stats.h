@@ -51,6 +51,7 @@ namespace mongo {
                         advanced(0),
                         needTime(0),
                         needFetch(0),
+                        executionTimeMicros(0),
                         isEOF(false) { }
 
         // Count calls into the stage.
@@ -67,8 +68,8 @@ namespace mongo {
         // TODO: have some way of tracking WSM sizes (or really any series of #s).  We can measure
         // the size of our inputs and the size of our outputs.  We can do a lot with the WS here.
 
-        // TODO: once we've picked a plan, collect different (or additional) stats for display to
-        // the user, eg. time_t totalTimeSpent;
+        // An estimate of the time spent in work(), children included.  See exec/scoped_timer.h.
+        uint64_t executionTimeMicros;
 
         // TODO: keep track of total yield time / fetch time for a plan (done by runner)
 
@@ -117,7 +118,8 @@ namespace mongo {
 
     struct AndHashStats : public SpecificStats {
         AndHashStats() : flaggedButPassed(0),
-                         flaggedInProgress(0) { }
+                         flaggedInProgress(0),
+                         memUsage(0) { }
 
         virtual ~AndHashStats() { }
 
@@ -135,6 +137,10 @@ namespace mongo {
 
         // mapAfterChild[mapAfterChild.size() - 1] WSMswere match tested.
         // commonstats.advanced is how many passed.
+
+        // The most bytes the hash table held on to at once, counting the index keys of its
+        // results.
+        uint64_t memUsage;
     };
 
     struct AndSortedStats : public SpecificStats {
@@ -174,6 +180,61 @@ namespace mongo {
         uint64_t matchTested;
     };
 
+    struct CountStats : public SpecificStats {
+        CountStats() : isMultiKey(false),
+                       yieldMovedCursor(0),
+                       dupsTested(0),
+                       dupsDropped(0),
+                       seenInvalidated(0),
+                       keysExamined(0) { }
+
+        virtual ~CountStats() { }
+
+        // name of the index being used
+        std::string indexName;
+
+        BSONObj keyPattern;
+
+        // Whether this index is over a field that contain array values.
+        bool isMultiKey;
+
+        uint64_t yieldMovedCursor;
+        uint64_t dupsTested;
+        uint64_t dupsDropped;
+
+        uint64_t seenInvalidated;
+
+        // Number of entries retrieved from the index during the scan.
+        uint64_t keysExamined;
+    };
+
+    struct DistinctScanStats : public SpecificStats {
+        DistinctScanStats() : isMultiKey(false), yieldMovedCursor(0), keysExamined(0) { }
+
+        virtual ~DistinctScanStats() { }
+
+        // name of the index being used
+        std::string indexName;
+
+        BSONObj keyPattern;
+
+        // A BSON (opaque, ie. hands off other than toString() it) representation of the bounds
+        // used.
+        BSONObj indexBounds;
+
+        // >1 if we're traversing the index along with its order. <1 if we're traversing it
+        // against the order.
+        int direction;
+
+        // Whether this index is over a field that contain array values.
+        bool isMultiKey;
+
+        uint64_t yieldMovedCursor;
+
+        // Number of entries retrieved from the index during the scan.
+        uint64_t keysExamined;
+    };
+
     struct IndexScanStats : public SpecificStats {
         IndexScanStats() : isMultiKey(false),
                            yieldMovedCursor(0),
@@ -181,7 +242,8 @@ namespace mongo {
                            dupsDropped(0),
                            seenInvalidated(0),
                            matchTested(0),
-                           keysExamined(0) { }
+                           keysExamined(0),
+                           dedupMemUsage(0) { }
 
         virtual ~IndexScanStats() { }
 
@@ -217,6 +279,9 @@ namespace mongo {
         // Number of entries retrieved from the index during the scan.
         uint64_t keysExamined;
 
+        // Bytes of the set of DiskLocs returned, kept to drop duplicates from a multikey index.
+        uint64_t dedupMemUsage;
+
     };
 
     struct OrStats : public SpecificStats {
@@ -237,12 +302,19 @@ namespace mongo {
     };
 
     struct SortStats : public SpecificStats {
-        SortStats() : forcedFetches(0) { }
+        SortStats() : forcedFetches(0), usedDisk(false), memUsage(0), memLimit(0) { }
 
         virtual ~SortStats() { }
 
         // How many records were we forced to fetch as the result of an invalidation?
         uint64_t forcedFetches;
+
+        // Did we spill to disk because the data didn't fit in memory?
+        bool usedDisk;
+
+        // The most bytes of data we held in memory at once, and how many we're allowed to.
+        uint64_t memUsage;
+        uint64_t memLimit;
     };
 
     struct MergeSortStats : public SpecificStats {
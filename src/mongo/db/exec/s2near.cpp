@@ -28,12 +28,15 @@
 
 #include "mongo/db/exec/s2near.h"
 
-#include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/index_scan.h"
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/geo/geoconstants.h"
 #include "mongo/db/index/catalog_hack.h"
 #include "mongo/db/index/expression_index.h"
+#include "third_party/s2/s2cell.h"
+#include "third_party/s2/s2cellid.h"
 #include "third_party/s2/s2regionintersection.h"
 
 namespace mongo {
@@ -49,6 +52,7 @@ namespace mongo {
         _filter = filter;
         _worked = false;
         _failed = false;
+        _resultsInAnnulus = 0;
 
         // The field we're near-ing from is the n-th field.  Figure out what that 'n' is.  We
         // put the cover for the search annulus in this spot in the bounds.
@@ -94,6 +98,7 @@ namespace mongo {
         if (_failed) { return PlanStage::FAILURE; }
         if (isEOF()) { return PlanStage::IS_EOF; }
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
 
         // If we haven't opened up our very first ixscan+fetch children, do it.  This is kind of
         // heavy so we don't want to do it in the ctor.
@@ -107,8 +112,9 @@ namespace mongo {
             return addResultToQueue(out);
         }
 
-        // Not reading results.  Perhaps we're returning buffered results.
-        if (!_results.empty()) {
+        // Not reading results.  Perhaps we're returning buffered results.  Only those nearer
+        // than the outside of the annulus searched are certain to be next.
+        if (!_results.empty() && _results.top().distance < _outerRadius) {
             Result result = _results.top();
             _results.pop();
             *out = result.id;
@@ -187,10 +193,29 @@ namespace mongo {
         }
         params.bounds = _baseBounds;
         params.direction = 1;
-        IndexScan* scan = new IndexScan(params, _ws, NULL);
+        params.doNotDedup = true;
+        _child.reset(new IndexScan(params, _ws, NULL));
+    }
+
+    bool S2NearStage::keyMayBeInAnnulus(const WorkingSetMember& member) const {
+        if (member.keyData.empty()) { return true; }
 
-        // Owns 'scan'.
-        _child.reset(new FetchStage(_ws, scan, _filter));
+        BSONObjIterator keyIt(member.keyData[0].keyData);
+        for (int i = 0; i < _nearFieldIndex && keyIt.more(); ++i) {
+            keyIt.next();
+        }
+        if (!keyIt.more()) { return true; }
+
+        // The keys of geo fields are the ids of the cells covering the geometry.  Anything else,
+        // such as the null of a missing field, we can't rule out.
+        BSONElement cell = keyIt.next();
+        if (String != cell.type()) { return true; }
+        const int level = cell.valuestrsize() - 1 - 2;
+        if (level < 0 || level > S2CellId::kMaxLevel) { return true; }
+        S2CellId id = S2CellId::FromString(cell.String());
+        if (!id.is_valid()) { return true; }
+
+        return _annulus.MayIntersect(S2Cell(id));
     }
 
     PlanStage::StageState S2NearStage::addResultToQueue(WorkingSetID* out) {
@@ -201,13 +226,12 @@ namespace mongo {
             _child.reset();
 
             // Adjust the annulus size depending on how many results we got.
-            if (_results.empty()) {
+            if (_resultsInAnnulus < 300) {
                 _radiusIncrement *= 2;
-            } else if (_results.size() < 300) {
-                _radiusIncrement *= 2;
-            } else if (_results.size() > 600) {
+            } else if (_resultsInAnnulus > 600) {
                 _radiusIncrement /= 2;
             }
+            _resultsInAnnulus = 0;
 
             // Make a new ixscan next time.
             return PlanStage::NEED_TIME;
@@ -216,22 +240,34 @@ namespace mongo {
         // Nothing to do unless we advance.
         if (PlanStage::ADVANCED != state) { return state; }
 
-        // TODO Speed improvements:
-        //
-        // 0. Modify fetch to preserve key data and test for intersection w/annulus.
-        //
-        // 1. keep track of what we've seen in this scan and possibly ignore it.
-        //
-        // 2. keep track of results we've returned before and ignore them.
-
         WorkingSetMember* member = _ws->get(*out);
-        // Must have an object in order to get geometry out of it.
-        verify(member->hasObj());
+        verify(member->hasLoc());
+
+        // A document we fetched before has its distance worked out already.  One not fetched yet
+        // whose key cell is outside the annulus is fetched through another key or annulus if it
+        // is in one.
+        if (_seen.end() != _seen.find(member->loc) || !keyMayBeInAnnulus(*member)) {
+            _ws->free(*out);
+            return PlanStage::NEED_TIME;
+        }
+        _seen.insert(member->loc);
+
+        member->obj = member->loc.obj();
+        member->keyData.clear();
+        member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+
+        if (!Filter::passes(member, _filter)) {
+            _ws->free(*out);
+            return PlanStage::NEED_TIME;
+        }
 
         // Get all the fields with that name from the document.
         BSONElementSet geom;
         member->obj.getFieldsDotted(_nearQuery.field, geom, false);
-        if (geom.empty()) {return PlanStage::NEED_TIME; }
+        if (geom.empty()) {
+            _ws->free(*out);
+            return PlanStage::NEED_TIME;
+        }
 
         // Some value that any distance we can calculate will be less than.
         double minDistance = numeric_limits<double>::max();
@@ -248,13 +284,18 @@ namespace mongo {
             }
         }
 
-        // If the distance to the doc satisfies our distance criteria,
-        if (minDistance >= _innerRadius && minDistance < _outerRadius) {
+        // If the distance to the doc satisfies our distance criteria, keep it.  Documents beyond
+        // the annulus wait in the queue until the annulus they are in has been searched.
+        if (minDistance >= _innerRadius && minDistance < _maxDistance) {
             _results.push(Result(*out, minDistance));
-            if (member->hasLoc()) {
-                _invalidationMap[member->loc] = *out;
+            _invalidationMap[member->loc] = *out;
+            if (minDistance < _outerRadius) {
+                ++_resultsInAnnulus;
             }
         }
+        else {
+            _ws->free(*out);
+        }
 
         return PlanStage::NEED_TIME;
     }
@@ -276,6 +317,9 @@ namespace mongo {
             _child->invalidate(dl);
         }
 
+        // A new document may take the place of this one.
+        _seen.erase(dl);
+
         unordered_map<DiskLoc, WorkingSetID, DiskLoc::Hasher>::iterator it
             = _invalidationMap.find(dl);
 
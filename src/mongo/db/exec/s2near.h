@@ -37,6 +37,7 @@
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/platform/unordered_set.h"
+#include "mongo/util/flat_hash_set.h"
 #include "third_party/s2/s2cap.h"
 #include "third_party/s2/s2regionintersection.h"
 
@@ -44,6 +45,10 @@ namespace mongo {
 
     /**
      * Executes a geoNear search.  Is a leaf node.  Output type is LOC_AND_UNOWNED_OBJ.
+     *
+     * Searches annuli of growing radius around the near point.  Each document is fetched at most
+     * once, from the first index key whose cell may be in the annulus being searched, and a
+     * document nearer than the annulus searched is returned as soon as it is found to be.
      */
     class S2NearStage : public PlanStage {
     public:
@@ -70,6 +75,9 @@ namespace mongo {
         StageState addResultToQueue(WorkingSetID* out);
         void nextAnnulus();
 
+        // Whether the cell of the near field in the key of 'member' may be in the annulus.
+        bool keyMayBeInAnnulus(const WorkingSetMember& member) const;
+
         bool _worked;
 
         WorkingSet* _ws;
@@ -98,8 +106,8 @@ namespace mongo {
         S2Cap _outerCap;
         S2RegionIntersection _annulus;
 
-        // We use this to hold on to the results in an annulus.  Results are sorted to have
-        // decreasing distance.
+        // We use this to hold on to the results whose distance we know, including those beyond
+        // the annulus.  Results are sorted to have increasing distance.
         struct Result {
             Result(WorkingSetID wsid, double dist) : id(wsid), distance(dist) { }
 
@@ -115,6 +123,13 @@ namespace mongo {
         // We compute an annulus of results and cache it here.
         priority_queue<Result> _results;
 
+        // How many of the results in the annulus last searched were found by searching it.
+        size_t _resultsInAnnulus;
+
+        // The documents fetched.  The index scans do not dedup, as every key of a document must
+        // be looked at to know whether it may be in an annulus.
+        FlatHashSet<DiskLoc, DiskLoc::Hasher> _seen;
+
         // For fast invalidation.  Perhaps not worth it.
         unordered_map<DiskLoc, WorkingSetID, DiskLoc::Hasher> _invalidationMap;
 
@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    /**
+     * Adds an estimate of the time spent in a call to PlanStage::work() to the stage's
+     * CommonStats::executionTimeMicros.  Declare one at the top of work(), right after the call
+     * is counted in CommonStats::works.
+     *
+     * Reading the clock costs about as much as a cheap call to work(), so only some calls are
+     * timed: each of the first kSampleRate calls, then one call in every kSampleRate, which
+     * stands in for the kSampleRate calls leading up to it.
+     */
+    class ScopedTimer {
+    public:
+        static const uint64_t kSampleRate = 16;
+
+        explicit ScopedTimer(CommonStats* stats) : _stats(stats), _weight(0), _start(0) {
+            if (stats->works <= kSampleRate) {
+                _weight = 1;
+            }
+            else if (0 == stats->works % kSampleRate) {
+                _weight = kSampleRate;
+            }
+
+            if (0 != _weight) {
+                _start = curTimeMicros64();
+            }
+        }
+
+        ~ScopedTimer() {
+            if (0 != _weight) {
+                _stats->executionTimeMicros += _weight * (curTimeMicros64() - _start);
+            }
+        }
+
+    private:
+        MONGO_DISALLOW_COPYING(ScopedTimer);
+
+        CommonStats* _stats;
+
+        // How many calls this one stands in for.  0 if we're not timing it.
+        uint64_t _weight;
+
+        unsigned long long _start;
+    };
+
+}  // namespace mongo
@@ -28,12 +28,13 @@
 
 #include "mongo/db/exec/shard_filter.h"
 
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/keypattern.h"
 
 namespace mongo {
 
     ShardFilterStage::ShardFilterStage(const string& ns, WorkingSet* ws, PlanStage* child)
-        : _ws(ws), _child(child), _ns(ns), _initted(false) { }
+        : _ws(ws), _child(child), _ns(ns), _initted(false), _lastRange(0) { }
 
     ShardFilterStage::~ShardFilterStage() { }
 
@@ -41,6 +42,7 @@ namespace mongo {
 
     PlanStage::StageState ShardFilterStage::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
         if (!_initted) {
             _metadata = shardingState.getCollectionMetadata(_ns);
             _initted = true;
@@ -55,12 +57,29 @@ namespace mongo {
             // If we're sharded make sure that we don't return any data that hasn't been migrated
             // off of our shared yet.
             if (_metadata) {
-                KeyPattern kp(_metadata->getKeyPattern());
-
                 WorkingSetMember* member = _ws->get(*out);
 
                 // This performs excessive BSONObj creation but that's OK for now.
-                if (!_metadata->keyBelongsToMe(kp.extractSingleKey(member->obj))) {
+                BSONObj key;
+                if (member->hasObj()) {
+                    KeyPattern kp(_metadata->getKeyPattern());
+                    key = kp.extractSingleKey(member->obj);
+                }
+                else {
+                    // The planner only puts us over an unfetched child when its index keys hold
+                    // the whole (non-hashed) shard key.
+                    BSONObjBuilder keyBuilder;
+                    BSONObjIterator it(_metadata->getKeyPattern());
+                    while (it.more()) {
+                        BSONElement elt;
+                        const char* field = it.next().fieldName();
+                        verify(member->getFieldDotted(field, &elt));
+                        keyBuilder.appendAs(elt, field);
+                    }
+                    key = keyBuilder.obj();
+                }
+
+                if (!_metadata->keyBelongsToMe(key, &_lastRange)) {
                     _ws->free(*out);
                     ++_specificStats.chunkSkips;
                     return PlanStage::NEED_TIME;
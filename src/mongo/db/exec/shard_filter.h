@@ -40,8 +40,8 @@ namespace mongo {
     /**
      * This stage drops documents that don't belong to the shard we're executing on.
      *
-     * Preconditions: Child must be fetched.  TODO XXX: when covering analysis is in just build doc
-     * and check that against shard key.
+     * Preconditions: Child must be fetched, or its index keys must hold every field of the shard
+     * key, in which case orphans are dropped before anything fetches them.
      */
     class ShardFilterStage : public PlanStage {
     public:
@@ -68,6 +68,10 @@ namespace mongo {
 
         bool _initted;
         CollectionMetadataPtr _metadata;
+
+        // The owned range the last key fell in.  Index scans return keys in order, so the next
+        // key usually falls in the same one.
+        size_t _lastRange;
     };
 
 }  // namespace mongo
@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/skip.h"
 
+#include "mongo/db/exec/scoped_timer.h"
+
 namespace mongo {
 
     SkipStage::SkipStage(int toSkip, WorkingSet* ws, PlanStage* child)
@@ -39,6 +41,7 @@ namespace mongo {
 
     PlanStage::StageState SkipStage::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
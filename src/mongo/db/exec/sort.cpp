@@ -30,8 +30,10 @@
 
 #include <algorithm>
 
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/index/btree_key_generator.h"
+#include "mongo/db/storage_options.h"
 
 namespace mongo {
 
@@ -59,6 +61,28 @@ namespace mongo {
         BSONObj pattern;
     };
 
+    namespace {
+        // Orders the data of the external sorter the same way WorkingSetComparator orders the
+        // data we sort in memory.
+        class SpilledDocComparator {
+        public:
+            typedef std::pair<BSONObj, SortStageSpilledDoc> Data;
+
+            explicit SpilledDocComparator(BSONObj p) : _pattern(p) { }
+
+            int operator()(const Data& lhs, const Data& rhs) const {
+                int result = lhs.first.woCompare(rhs.first, _pattern, false /* ignore names */);
+                if (0 != result) {
+                    return result;
+                }
+                return lhs.second.loc.compare(rhs.second.loc);
+            }
+
+        private:
+            BSONObj _pattern;
+        };
+    }  // namespace
+
     SortStage::SortStage(const SortStageParams& params, WorkingSet* ws, PlanStage* child)
         : _ws(ws),
           _child(child),
@@ -67,9 +91,12 @@ namespace mongo {
           _resultIterator(_data.end()),
           _bounds(params.bounds),
           _hasBounds(params.hasBounds),
-          _memUsage(0) {
+          _allowDiskUse(params.allowDiskUse),
+          _limit(params.limit),
+          _memUsage(&queryExecMemoryUse) {
 
         _cmp.reset(new WorkingSetComparator(_pattern));
+        _specificStats.memLimit = kMaxBytes;
 
         // We'll need to treat arrays as if we were to create an index over them. that is,
         // we may need to unnest the first level and consider each array element to decide
@@ -94,14 +121,63 @@ namespace mongo {
     bool SortStage::isEOF() {
         // We're done when our child has no more results, we've sorted the child's results, and
         // we've returned all sorted results.
-        return _child->isEOF() && _sorted && (_data.end() == _resultIterator);
+        if (!_child->isEOF() || !_sorted) { return false; }
+        if (NULL != _externalIterator.get()) { return !_externalIterator->more(); }
+        return _data.end() == _resultIterator;
+    }
+
+    void SortStage::spill() {
+        verify(NULL == _externalSorter.get());
+        _externalSorter.reset(ExternalSorter::make(
+            SortOptions().TempDir(storageGlobalParams.dbpath + "/_tmp")
+                         .ExtSortAllowed()
+                         .MaxMemoryUsageBytes(kMaxBytes)
+                         .Limit(_limit),
+            SpilledDocComparator(_pattern)));
+        _specificStats.usedDisk = true;
+
+        for (size_t i = 0; i < _data.size(); ++i) {
+            WorkingSetID id = _data[i].wsid;
+            // A flagged member was invalidated.  We drop those when returning them anyway.
+            if (!_ws->isFlagged(id)) {
+                addToExternalSorter(_data[i].sortKey, _ws->get(id));
+            }
+            _ws->free(id);
+        }
+
+        _data.clear();
+        _wsidByDiskLoc.clear();
+        _memUsage = 0;
+    }
+
+    void SortStage::addToExternalSorter(const BSONObj& sortKey, const WorkingSetMember* member) {
+        SortStageSpilledDoc doc;
+        doc.obj = member->obj;
+        if (member->hasLoc()) {
+            doc.loc = member->loc;
+        }
+        // The sorter makes owned copies of what it keeps in memory.
+        _externalSorter->add(sortKey, doc);
+    }
+
+    void SortStage::dropItem(const SortableDataItem& item) {
+        WorkingSetMember* member = _ws->get(item.wsid);
+        if (member->hasLoc()) {
+            _wsidByDiskLoc.erase(member->loc);
+        }
+        _ws->free(item.wsid);
+        _memUsage -= item.memUsage;
     }
 
     PlanStage::StageState SortStage::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
 
-        if (_memUsage > kMaxBytes) {
-            return PlanStage::FAILURE;
+        if (NULL == _externalSorter.get() && _memUsage > kMaxBytes) {
+            if (!_allowDiskUse) {
+                return PlanStage::FAILURE;
+            }
+            spill();
         }
 
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -121,15 +197,20 @@ namespace mongo {
                 }
 
                 // Do some accounting to make sure we're not using too much memory.
+                size_t itemMemUsage = 0;
                 if (member->hasLoc()) {
-                    _memUsage += sizeof(DiskLoc);
+                    itemMemUsage += sizeof(DiskLoc);
                 }
 
                 // We are not supposed (yet) to sort over anything other than objects.  In other
                 // words, the query planner wouldn't put a sort atop anything that wouldn't have a
                 // collection scan as a leaf.
                 verify(member->hasObj());
-                _memUsage += member->obj.objsize();
+                itemMemUsage += member->obj.objsize();
+                _memUsage += itemMemUsage;
+                if (_memUsage > _specificStats.memUsage) {
+                    _specificStats.memUsage = _memUsage;
+                }
 
                 // We will sort '_data' in the same order an index over '_pattern' would
                 // have. This has very nuanced implications. Consider the sort pattern {a:1}
@@ -170,6 +251,17 @@ namespace mongo {
                     verify(0);
                 }
 
+                // Once we've spilled, the external sorter takes everything.
+                if (NULL != _externalSorter.get()) {
+                    addToExternalSorter(sortKey, member);
+                    if (member->hasLoc()) {
+                        _wsidByDiskLoc.erase(member->loc);
+                    }
+                    _ws->free(id);
+                    ++_commonStats.needTime;
+                    return PlanStage::NEED_TIME;
+                }
+
                 // We let the data stay in the WorkingSet and sort using the selected portion
                 // of the object in that working set member.
                 SortableDataItem item;
@@ -178,16 +270,33 @@ namespace mongo {
                 if (member->hasLoc()) {
                     item.loc = member->loc;
                 }
+                item.memUsage = itemMemUsage;
                 _data.push_back(item);
 
+                // With a limit, '_data' is a heap whose top is the worst result we keep.  Once
+                // we have more than 'limit' results the worst can't be returned, so we drop it.
+                if (_limit > 0) {
+                    std::push_heap(_data.begin(), _data.end(), *_cmp);
+                    if (_data.size() > _limit) {
+                        std::pop_heap(_data.begin(), _data.end(), *_cmp);
+                        dropItem(_data.back());
+                        _data.pop_back();
+                    }
+                }
+
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
             }
             else if (PlanStage::IS_EOF == code) {
                 // TODO: We don't need the lock for this.  We could ask for a yield and do this work
                 // unlocked.  Also, this is performing a lot of work for one call to work(...)
-                std::sort(_data.begin(), _data.end(), *_cmp);
-                _resultIterator = _data.begin();
+                if (NULL != _externalSorter.get()) {
+                    _externalIterator.reset(_externalSorter->done());
+                }
+                else {
+                    std::sort(_data.begin(), _data.end(), *_cmp);
+                    _resultIterator = _data.begin();
+                }
                 _sorted = true;
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
@@ -204,6 +313,22 @@ namespace mongo {
             }
         }
 
+        // Returning results from disk.  They're owned copies of the documents we spilled.
+        if (NULL != _externalIterator.get()) {
+            verify(_sorted);
+            verify(_externalIterator->more());
+            ExternalSorter::Data data = _externalIterator->next();
+
+            WorkingSetID id = _ws->allocate();
+            WorkingSetMember* member = _ws->get(id);
+            member->obj = data.second.obj.getOwned();
+            member->state = WorkingSetMember::OWNED_OBJ;
+
+            *out = id;
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
         // Returning results.
         verify(_resultIterator != _data.end());
         verify(_sorted);
@@ -273,3 +398,6 @@ namespace mongo {
     }
 
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+MONGO_CREATE_SORTER(mongo::BSONObj, mongo::SortStageSpilledDoc, mongo::SpilledDocComparator);
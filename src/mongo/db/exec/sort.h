@@ -37,7 +37,9 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/query/index_bounds.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
+#include "mongo/util/memory_use.h"
 
 namespace mongo {
 
@@ -46,9 +48,50 @@ namespace mongo {
     // External params for the sort stage.  Declared below.
     class SortStageParams;
 
+    /**
+     * A document that the sort stage handed to the external sorter.  The DiskLoc breaks ties
+     * between equal sort keys.  Provides the members the Sorter requires of its values.
+     */
+    struct SortStageSpilledDoc {
+        struct SorterDeserializeSettings {}; // unused
+
+        void serializeForSorter(BufBuilder& buf) const {
+            loc.serializeForSorter(buf);
+            obj.serializeForSorter(buf);
+        }
+
+        static SortStageSpilledDoc deserializeForSorter(BufReader& buf,
+                                                        const SorterDeserializeSettings&) {
+            SortStageSpilledDoc doc;
+            doc.loc = DiskLoc::deserializeForSorter(buf, DiskLoc::SorterDeserializeSettings());
+            doc.obj = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+            return doc;
+        }
+
+        int memUsageForSorter() const { return sizeof(DiskLoc) + obj.memUsageForSorter(); }
+
+        SortStageSpilledDoc getOwned() const {
+            SortStageSpilledDoc doc;
+            doc.obj = obj.getOwned();
+            doc.loc = loc;
+            return doc;
+        }
+
+        BSONObj obj;
+        DiskLoc loc;
+    };
+
     /**
      * Sorts the input received from the child according to the sort pattern provided.
      *
+     * With a limit, only the best 'limit' results are kept while reading the input, in a heap
+     * whose top is the worst result kept.
+     *
+     * If the buffered data outgrows the memory limit the stage fails, unless it is allowed to
+     * use disk.  Then it hands all its data to an external Sorter, which spills sorted runs to
+     * files and merges them.  Documents returned from disk are owned copies without a DiskLoc,
+     * as if they had been invalidated while we held them.
+     *
      * Preconditions: For each field in 'pattern', all inputs in the child must handle a
      * getFieldDotted for that field.
      */
@@ -68,6 +111,28 @@ namespace mongo {
         PlanStageStats* getStats();
 
     private:
+        typedef Sorter<BSONObj, SortStageSpilledDoc> ExternalSorter;
+
+        // Declared below.
+        struct SortableDataItem;
+
+        /**
+         * Moves the buffered data out of the working set and into the external sorter.  All
+         * later input goes directly to the external sorter.
+         */
+        void spill();
+
+        /**
+         * Adds the document in 'member' to the external sorter under 'sortKey'.
+         */
+        void addToExternalSorter(const BSONObj& sortKey, const WorkingSetMember* member);
+
+        /**
+         * Frees the working set member of an item we no longer want.  Used when the limit
+         * pushes the item out of our results.
+         */
+        void dropItem(const SortableDataItem& item);
+
         // Not owned by us.
         WorkingSet* _ws;
 
@@ -89,6 +154,8 @@ namespace mongo {
             // DiskLoc to break sortKey ties.
             // See sorta.js.
             DiskLoc loc;
+            // How much of _memUsage is due to this item.
+            size_t memUsage;
         };
         vector<SortableDataItem> _data;
 
@@ -120,6 +187,22 @@ namespace mongo {
         // _keyGen.
         boost::scoped_ptr<IndexBoundsChecker> _boundsChecker;
 
+        //
+        // External sort
+        //
+
+        // May we spill to disk instead of failing when we buffer too much data?
+        bool _allowDiskUse;
+
+        // How many results we keep.  0 for all of them.
+        size_t _limit;
+
+        // Non-NULL once we spilled.  From then on it holds all the data to sort.
+        boost::scoped_ptr<ExternalSorter> _externalSorter;
+
+        // Iterates through the output of the external sorter post-sort.
+        boost::scoped_ptr<ExternalSorter::Iterator> _externalIterator;
+
         //
         // Stats
         //
@@ -128,13 +211,13 @@ namespace mongo {
         SortStats _specificStats;
 
         // The usage in bytes of all bufered data that we're sorting.
-        size_t _memUsage;
+        TrackedBytes _memUsage;
     };
 
     // Parameters that must be provided to a SortStage
     class SortStageParams {
     public:
-        SortStageParams() : hasBounds(false) { }
+        SortStageParams() : hasBounds(false), allowDiskUse(false), limit(0) { }
 
         // How we're sorting.
         BSONObj pattern;
@@ -143,9 +226,11 @@ namespace mongo {
 
         bool hasBounds;
 
-        // TODO: Implement this.
-        // Must be >= 0.  Equal to 0 for no limit.
-        // int limit;
+        // Spill to disk rather than fail when the data doesn't fit in memory.
+        bool allowDiskUse;
+
+        // The most results the caller wants.  Equal to 0 for no limit.
+        size_t limit;
     };
 
 }  // namespace mongo
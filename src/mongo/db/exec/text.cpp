@@ -27,7 +27,11 @@
  */
 
 #include "mongo/db/exec/text.h"
+
+#include <algorithm>
+
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/jsobj.h"
@@ -35,6 +39,9 @@
 
 namespace mongo {
 
+    // static
+    const size_t TextStage::kMaxTermsToStopEarly = 64;
+
     TextStage::TextStage(const TextStageParams& params, WorkingSet* ws,
                          const MatchExpression* filter)
         : _params(params), _ftsMatcher(params.query, params.spec), _ws(ws), _filter(filter),
@@ -53,6 +60,7 @@ namespace mongo {
 
     PlanStage::StageState TextStage::work(WorkingSetID* out) {
         ++_commonStats.works;
+        ScopedTimer timer(&_commonStats);
         if (isEOF()) { return PlanStage::IS_EOF; }
 
         // Fill out our result queue.
@@ -128,8 +136,10 @@ namespace mongo {
             const string& term = _params.query.getTerms()[i];
             IndexScanParams params;
             params.bounds.startKey = FTSIndexFormat::getIndexKey(MAX_WEIGHT, term,
-                                                                 _params.indexPrefix);
-            params.bounds.endKey = FTSIndexFormat::getIndexKey(0, term, _params.indexPrefix);
+                                                                 _params.indexPrefix,
+                                                                 _params.spec.textIndexVersion());
+            params.bounds.endKey = FTSIndexFormat::getIndexKey(0, term, _params.indexPrefix,
+                                                               _params.spec.textIndexVersion());
             params.bounds.endKeyInclusive = true;
             params.bounds.isSimpleRange = true;
             params.descriptor = collection->getIndexCatalog()->getDescriptor(idxMatches[0]);
@@ -139,11 +149,38 @@ namespace mongo {
             scanners.push_back(ixscan);
         }
 
-        // For each index scan, read all results and store scores.
+        // We read the index scans a key at a time, round robin.  Each one returns its keys in
+        // decreasing order of score, so the last score read from a scan bounds what its term can
+        // add to a document that we haven't yet seen for that term.  That lets us stop once
+        // nothing outside the best _params.limit documents can catch up with them, without looking
+        // at the rest of the keys or fetching their documents.
+        //
+        // Phrases and negated terms can reject any of the top documents after the fact, so with
+        // them we read everything.  We also need a bit per term to keep track of which terms
+        // we've seen a document for.
+        const bool canStopEarly = !_params.query.hasNonTermPieces()
+                                  && scanners.size() <= kMaxTermsToStopEarly
+                                  && _params.limit > 0;
+
+        vector<double> termBounds(scanners.size(), MAX_WEIGHT);
+        unsigned long long liveTerms = 0;
+        for (size_t i = 0; i < scanners.size() && canStopEarly; ++i) {
+            liveTerms |= (1ULL << i);
+        }
+
+        // Looking at every document scored so far is expensive, so we only check whether we can
+        // stop after reading about as many keys as there are such documents.
+        size_t keysUntilCheck = _params.limit;
+        bool stoppedEarly = false;
+
+        vector<bool> scanDone(scanners.size(), false);
+        size_t numScansLeft = scanners.size();
         size_t currentIndexScanner = 0;
-        while (currentIndexScanner < scanners.size()) {
-            BSONObj keyObj;
-            DiskLoc loc;
+        while (numScansLeft > 0) {
+            if (scanDone[currentIndexScanner]) {
+                currentIndexScanner = (currentIndexScanner + 1) % scanners.size();
+                continue;
+            }
 
             WorkingSetID id;
             PlanStage::StageState state = scanners[currentIndexScanner]->work(&id);
@@ -151,12 +188,19 @@ namespace mongo {
             if (PlanStage::ADVANCED == state) {
                 WorkingSetMember* wsm = _ws->get(id);
                 IndexKeyDatum& keyDatum = wsm->keyData.back();
-                filterAndScore(keyDatum.keyData, wsm->loc);
+                termBounds[currentIndexScanner] = filterAndScore(keyDatum.keyData, wsm->loc,
+                                                                 currentIndexScanner);
                 _ws->free(id);
+                if (keysUntilCheck > 0) {
+                    --keysUntilCheck;
+                }
             }
             else if (PlanStage::IS_EOF == state) {
                 // Done with this scan.
-                ++currentIndexScanner;
+                scanDone[currentIndexScanner] = true;
+                termBounds[currentIndexScanner] = 0;
+                liveTerms &= ~(1ULL << currentIndexScanner);
+                --numScansLeft;
             }
             else if (PlanStage::NEED_FETCH == state) {
                 // We're calling work() on ixscans and they have no way to return a fetch.
@@ -171,14 +215,25 @@ namespace mongo {
                 for (size_t i=0; i<scanners.size(); ++i) { delete scanners[i]; }
                 return PlanStage::FAILURE;
             }
+
+            currentIndexScanner = (currentIndexScanner + 1) % scanners.size();
+
+            if (canStopEarly && 0 == keysUntilCheck && numScansLeft > 0) {
+                if (getFinalTopResults(termBounds, liveTerms, &_results)) {
+                    stoppedEarly = true;
+                    break;
+                }
+                keysUntilCheck = std::max(_scores.size(), _params.limit);
+            }
         }
 
         for (size_t i=0; i<scanners.size(); ++i) { delete scanners[i]; }
 
-        // Filter for phrases and negative terms, score and truncate.
-        for (ScoreMap::iterator i = _scores.begin(); i != _scores.end(); ++i) {
+        // Filter for phrases and negative terms, score and truncate.  If we stopped early,
+        // _results already holds the final top results.
+        for (ScoreMap::iterator i = _scores.begin(); i != _scores.end() && !stoppedEarly; ++i) {
             DiskLoc loc = i->first;
-            double score = i->second;
+            double score = i->second.score;
 
             // Ignore non-matched documents.
             if (score < 0) {
@@ -210,7 +265,79 @@ namespace mongo {
         return PlanStage::NEED_TIME;
     }
 
-    void TextStage::filterAndScore(BSONObj key, DiskLoc loc) {
+    bool TextStage::getFinalTopResults(const vector<double>& termBounds,
+                                       unsigned long long liveTerms,
+                                       vector<ScoredLocation>* top) const {
+        // What the terms still being scanned can add to a document we've seen for none of them.
+        double unseenBound = 0;
+        for (size_t i = 0; i < termBounds.size(); ++i) {
+            if (liveTerms & (1ULL << i)) {
+                unseenBound += termBounds[i];
+            }
+        }
+
+        vector<ScoredLocation> candidates;
+        for (ScoreMap::const_iterator it = _scores.begin(); it != _scores.end(); ++it) {
+            if (it->second.score >= 0) {
+                candidates.push_back(ScoredLocation(it->first, it->second.score));
+            }
+        }
+
+        const size_t k = _params.limit;
+        if (candidates.size() < k) {
+            return false;
+        }
+
+        // Put the best k scores so far at the front, with the k-th best at k - 1.
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end());
+        const double threshold = candidates[k - 1].score;
+
+        // Ties can go either way, so we want everything else strictly below the threshold.
+        if (unseenBound >= threshold) {
+            return false;
+        }
+
+        for (size_t i = k; i < candidates.size(); ++i) {
+            const DocScore& docScore = _scores.find(candidates[i].loc)->second;
+            double bound = docScore.score;
+            for (size_t t = 0; t < termBounds.size(); ++t) {
+                if ((liveTerms & (1ULL << t)) && !(docScore.termsSeen & (1ULL << t))) {
+                    bound += termBounds[t];
+                }
+            }
+            if (bound >= threshold) {
+                return false;
+            }
+        }
+
+        // The top k are final, but their scores may be missing terms that are still being scanned.
+        // Score those terms from the documents.
+        candidates.resize(k);
+        const vector<string>& terms = _params.query.getTerms();
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            const DocScore& docScore = _scores.find(candidates[i].loc)->second;
+            if (0 == (liveTerms & ~docScore.termsSeen)) {
+                continue;
+            }
+
+            fts::TermFrequencyMap termFreqs;
+            _params.spec.scoreDocument(candidates[i].loc.obj(), _params.spec.defaultLanguage(),
+                                       "", false, &termFreqs);
+            for (size_t t = 0; t < terms.size(); ++t) {
+                if ((liveTerms & (1ULL << t)) && !(docScore.termsSeen & (1ULL << t))) {
+                    fts::TermFrequencyMap::const_iterator freq = termFreqs.find(terms[t]);
+                    if (termFreqs.end() != freq) {
+                        candidates[i].score += freq->second;
+                    }
+                }
+            }
+        }
+
+        top->swap(candidates);
+        return true;
+    }
+
+    double TextStage::filterAndScore(BSONObj key, DiskLoc loc, size_t termIndex) {
         // Locate score within possibly compound key: {prefix,term,score,suffix}.
         BSONObjIterator keyIt(key);
         for (unsigned i = 0; i < _params.spec.numExtraBefore(); i++) {
@@ -220,13 +347,14 @@ namespace mongo {
         keyIt.next(); // Skip past 'term'.
 
         BSONElement scoreElement = keyIt.next();
-        double documentTermScore = scoreElement.number();
-        double& documentAggregateScore = _scores[loc];
+        double documentTermScore = FTSIndexFormat::getWeight(scoreElement);
+        DocScore& docScore = _scores[loc];
+        double& documentAggregateScore = docScore.score;
         
         // Handle filtering.
         if (documentAggregateScore < 0) {
             // We have already rejected this document.
-            return;
+            return documentTermScore;
         }
         if (documentAggregateScore == 0 && _filter) {
             // We have not seen this document before and need to apply a filter.
@@ -236,12 +364,16 @@ namespace mongo {
             // TODO: Covered index matching logic here.
             if (!_filter->matchesBSON(doc)) {
                 documentAggregateScore = -1;
-                return;
+                return documentTermScore;
             }
         }
 
         // Aggregate relevance score, term keys.
         documentAggregateScore += documentTermScore;
+        if (termIndex < kMaxTermsToStopEarly) {
+            docScore.termsSeen |= (1ULL << termIndex);
+        }
+        return documentTermScore;
     }
 
 }  // namespace mongo
@@ -95,6 +95,9 @@ namespace mongo {
         PlanStageStats* getStats();
 
     private:
+        // We can only stop reading the index early for queries with at most this many terms.
+        static const size_t kMaxTermsToStopEarly;
+
         // A helper class used for sorting results by score.
         struct ScoredLocation {
             DiskLoc loc;
@@ -118,8 +121,20 @@ namespace mongo {
         StageState fillOutResults();
 
         // Helper to update _scores with a new-found (term, score) pair for this document.  Also
-        // rejects documents that don't match this stage's filter.
-        void filterAndScore(BSONObj key, DiskLoc loc);
+        // rejects documents that don't match this stage's filter.  'termIndex' is which of the
+        // query's terms the key is for.  Returns the score in the key.
+        double filterAndScore(BSONObj key, DiskLoc loc, size_t termIndex);
+
+        // Checks whether we can stop reading the term index scans early.  'termBounds[i]' is the
+        // most term i can add to the score of a document we haven't yet seen it for, and
+        // 'liveTerms' has bit i set if term i's scan isn't EOF.
+        //
+        // If no document outside of the _params.limit best scored so far can end up scoring at
+        // least as high as them, fills out 'top' with their final scores and returns true.
+        // Otherwise returns false.
+        bool getFinalTopResults(const vector<double>& termBounds,
+                                unsigned long long liveTerms,
+                                vector<ScoredLocation>* top) const;
 
         // Parameters of this text stage.
         TextStageParams _params;
@@ -139,8 +154,21 @@ namespace mongo {
         // State bit for work().  True if results have been buffered.
         bool _filledOutResults;
 
-        // Map: diskloc -> aggregate score for doc.
-        typedef unordered_map<DiskLoc, double, DiskLoc::Hasher> ScoreMap;
+        // What we know about a document's score so far.
+        struct DocScore {
+            DocScore() : score(0), termsSeen(0) { }
+
+            // Aggregate score of the terms we've seen the document for.  -1 if the document was
+            // rejected by the filter.
+            double score;
+
+            // Bit i set if we've seen the document in the scan for term i.  Only kept when the
+            // query has few enough terms to fit.
+            unsigned long long termsSeen;
+        };
+
+        // Map: diskloc -> score so far for doc.
+        typedef unordered_map<DiskLoc, DocScore, DiskLoc::Hasher> ScoreMap;
         ScoreMap _scores;
 
         // Score-ordered result set of documents (as DiskLoc's).
@@ -34,31 +34,45 @@ namespace mongo {
 
     const WorkingSetID WorkingSet::INVALID_ID = -1;
 
-    WorkingSet::WorkingSet() : _nextId(0) { }
+    WorkingSet::WorkingSet() { }
 
     WorkingSet::~WorkingSet() {
-        for (DataMap::const_iterator i = _data.begin(); i != _data.end(); ++i) {
-            delete i->second;
+        for (size_t i = 0; i < _data.size(); ++i) {
+            delete _data[i].member;
         }
     }
 
     WorkingSetID WorkingSet::allocate() {
-        verify(_data.end() == _data.find(_nextId));
-        _data[_nextId] = new WorkingSetMember();
-        return _nextId++;
+        WorkingSetID id;
+        if (_freeList.empty()) {
+            id = _data.size();
+            _data.push_back(MemberHolder());
+            _data.back().member = new WorkingSetMember();
+        }
+        else {
+            id = _freeList.back();
+            _freeList.pop_back();
+        }
+
+        MemberHolder& holder = _data[id];
+        verify(!holder.inUse);
+        holder.inUse = true;
+        return id;
     }
 
     WorkingSetMember* WorkingSet::get(const WorkingSetID& i) {
-        DataMap::iterator it = _data.find(i);
-        verify(_data.end() != it);
-        return it->second;
+        verify(i >= 0 && static_cast<size_t>(i) < _data.size());
+        verify(_data[i].inUse);
+        return _data[i].member;
     }
 
     void WorkingSet::free(const WorkingSetID& i) {
-        DataMap::iterator it = _data.find(i);
-        verify(_data.end() != it);
-        delete it->second;
-        _data.erase(it);
+        verify(i >= 0 && static_cast<size_t>(i) < _data.size());
+        MemberHolder& holder = _data[i];
+        verify(holder.inUse);
+        holder.member->clear();
+        holder.inUse = false;
+        _freeList.push_back(i);
 
         unordered_set<WorkingSetID>::iterator flagIt = _flagged.find(i);
         if (_flagged.end() != flagIt) {
@@ -83,10 +97,21 @@ namespace mongo {
     WorkingSetMember::WorkingSetMember() : state(WorkingSetMember::INVALID) { }
 
     WorkingSetMember::~WorkingSetMember() {
+        clear();
+    }
+
+    void WorkingSetMember::clear() {
         unordered_map<size_t, WorkingSetComputedData*>::const_iterator it;
         for (it = _computed.begin(); it != _computed.end(); it++) {
             delete it->second;
         }
+        _computed.clear();
+
+        // Keeps keyData's storage for the next use of this member.
+        keyData.clear();
+        obj = BSONObj();
+        loc = DiskLoc();
+        state = WorkingSetMember::INVALID;
     }
 
     bool WorkingSetMember::hasLoc() const {
@@ -86,14 +86,28 @@ namespace mongo {
          */
         bool isFlagged(WorkingSetID id) const;
 
+        /**
+         * The most members that were allocated at any one time.  Freed members are recycled by
+         * later calls to allocate(), so this is also how many members we've created.
+         */
+        size_t getPeakMembers() const { return _data.size(); }
+
     private:
-        typedef unordered_map<WorkingSetID, WorkingSetMember*> DataMap;
+        struct MemberHolder {
+            MemberHolder() : member(NULL), inUse(false) { }
 
-        DataMap _data;
+            // Owned by us.  Kept around after it's freed so that allocate() can reuse it.
+            WorkingSetMember* member;
+
+            // Has this been allocated and not freed?
+            bool inUse;
+        };
 
-        // The WorkingSetID returned by the next call to allocate().  Should refer to the next valid
-        // ID.  IDs allocated contiguously.  Should never point at an in-use ID.  
-        WorkingSetID _nextId;
+        // A WorkingSetID is the index of its member in here.
+        vector<MemberHolder> _data;
+
+        // IDs of members which were freed and can be handed out again by allocate().
+        vector<WorkingSetID> _freeList;
 
         // All WSIDs invalidated during evaluation of a predicate (AND).
         unordered_set<WorkingSetID> _flagged;
@@ -200,6 +214,12 @@ namespace mongo {
          */
         bool getFieldDotted(const string& field, BSONElement* out) const;
 
+        /**
+         * Drop all data and go back to the INVALID state.  Used by the WorkingSet to recycle
+         * freed members.
+         */
+        void clear();
+
     private:
         unordered_map<size_t, WorkingSetComputedData*> _computed;
     };
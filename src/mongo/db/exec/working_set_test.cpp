@@ -144,4 +144,33 @@ namespace {
         ASSERT_FALSE(member->getFieldDotted("y", &elt));
     }
 
+    TEST_F(WorkingSetFixture, freedMembersAreRecycled) {
+        // The fixture allocated one member.
+        ASSERT_EQUALS(1U, ws.getPeakMembers());
+
+        WorkingSetID second = ws.allocate();
+        WorkingSetMember* secondMember = ws.get(second);
+        secondMember->obj = BSON("x" << 5);
+        secondMember->state = WorkingSetMember::OWNED_OBJ;
+        secondMember->keyData.push_back(IndexKeyDatum(BSON("x" << 1), BSON("" << 5)));
+        ws.flagForReview(second);
+        ASSERT_EQUALS(2U, ws.getPeakMembers());
+
+        // Freeing and allocating again reuses the member, which starts out empty and unflagged.
+        ws.free(second);
+        WorkingSetID third = ws.allocate();
+        ASSERT_EQUALS(second, third);
+        ASSERT_EQUALS(secondMember, ws.get(third));
+        ASSERT_EQUALS(WorkingSetMember::INVALID, secondMember->state);
+        ASSERT_TRUE(secondMember->obj.isEmpty());
+        ASSERT_TRUE(secondMember->keyData.empty());
+        ASSERT_FALSE(ws.isFlagged(third));
+        ASSERT_EQUALS(2U, ws.getPeakMembers());
+
+        // Only when nothing is free do we make a new member.
+        WorkingSetID fourth = ws.allocate();
+        ASSERT_NOT_EQUALS(third, fourth);
+        ASSERT_EQUALS(3U, ws.getPeakMembers());
+    }
+
 }  // namespace
@@ -32,7 +32,9 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/fts/fts_index_format.h"
+#include "mongo/util/hex.h"
 #include "mongo/util/mongoutils/str.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
@@ -41,6 +43,17 @@ namespace mongo {
         namespace {
             BSONObj nullObj;
             BSONElement nullElt;
+
+            // TEXT_INDEX_VERSION_3 keeps the first kTermPrefixLength bytes of a term longer than
+            // kMaxTermLength, and a hash of all of it in hex after them.
+            const size_t kMaxTermLength = 64;
+            const size_t kTermHashLength = 16;
+            const size_t kTermPrefixLength = kMaxTermLength - kTermHashLength;
+
+            // TEXT_INDEX_VERSION_3 weights are floats, stored big endian in BinData so that keys
+            // compare in the order of the weights.  Compact btree keys hold them in 6 bytes
+            // rather than the 9 of a double.
+            const int kWeightLength = 4;
         }
 
         MONGO_INITIALIZER( FTSIndexFormat )( InitializerContext* context ) {
@@ -102,7 +115,7 @@ namespace mongo {
                 // guess the total size of the btree entry based on the size of the weight, term tuple
                 int guess =
                     5 /* bson overhead */ +
-                    10 /* weight */ +
+                    11 /* weight */ +
                     8 /* term overhead */ +
                     term.size() +
                     extraSize;
@@ -110,7 +123,7 @@ namespace mongo {
                 BSONObjBuilder b(guess); // builds a BSON object with guess length.
                 for ( unsigned k = 0; k < extrasBefore.size(); k++ )
                     b.appendAs( extrasBefore[k], "" );
-                _appendIndexKey( b, weight, term );
+                _appendIndexKey( b, weight, term, spec.textIndexVersion() );
                 for ( unsigned k = 0; k < extrasAfter.size(); k++ )
                     b.appendAs( extrasAfter[k], "" );
                 BSONObj res = b.obj();
@@ -132,21 +145,67 @@ namespace mongo {
 
         BSONObj FTSIndexFormat::getIndexKey( double weight,
                                              const string& term,
-                                             const BSONObj& indexPrefix ) {
+                                             const BSONObj& indexPrefix,
+                                             TextIndexVersion textIndexVersion ) {
             BSONObjBuilder b;
 
             BSONObjIterator i( indexPrefix );
             while ( i.more() )
                 b.appendAs( i.next(), "" );
 
-            _appendIndexKey( b, weight, term );
+            _appendIndexKey( b, weight, term, textIndexVersion );
             return b.obj();
         }
 
-        void FTSIndexFormat::_appendIndexKey( BSONObjBuilder& b, double weight, const string& term ) {
+        double FTSIndexFormat::getWeight( const BSONElement& weightElement ) {
+            if ( weightElement.type() != BinData )
+                return weightElement.number();
+
+            int len;
+            const unsigned char* data =
+                reinterpret_cast<const unsigned char*>( weightElement.binData( len ) );
+            verify( len == kWeightLength );
+            union {
+                float f;
+                unsigned int bits;
+            } w;
+            w.bits = ( static_cast<unsigned int>( data[0] ) << 24 ) |
+                     ( static_cast<unsigned int>( data[1] ) << 16 ) |
+                     ( static_cast<unsigned int>( data[2] ) << 8 ) |
+                     static_cast<unsigned int>( data[3] );
+            return w.f;
+        }
+
+        void FTSIndexFormat::_appendIndexKey( BSONObjBuilder& b, double weight, const string& term,
+                                              TextIndexVersion textIndexVersion ) {
             verify( weight >= 0 && weight <= MAX_WEIGHT ); // FTSmaxweight =  defined in fts_header
-            b.append( "", term );
-            b.append( "", weight );
+            if ( textIndexVersion == TEXT_INDEX_VERSION_2 ) {
+                b.append( "", term );
+                b.append( "", weight );
+                return;
+            }
+
+            if ( term.size() <= kMaxTermLength ) {
+                b.append( "", term );
+            }
+            else {
+                unsigned long long hash[2];
+                MurmurHash3_x64_128( term.data(), term.size(), 0, hash );
+                b.append( "", term.substr( 0, kTermPrefixLength ) +
+                              toHex( &hash[0], kTermHashLength / 2 ) );
+            }
+
+            // positive floats order as their bits do
+            union {
+                float f;
+                unsigned int bits;
+            } w;
+            w.f = static_cast<float>( weight );
+            const char data[kWeightLength] = { static_cast<char>( w.bits >> 24 ),
+                                               static_cast<char>( w.bits >> 16 ),
+                                               static_cast<char>( w.bits >> 8 ),
+                                               static_cast<char>( w.bits ) };
+            b.appendBinData( "", kWeightLength, BinDataGeneral, data );
         }
     }
 }
@@ -48,10 +48,17 @@ namespace mongo {
              * @param weight, the weight of the term in the entry
              * @param term, the string term in the entry
              * @param indexPrefix, the fields that go in the index first
+             * @param textIndexVersion, the format of the index's keys
              */
             static BSONObj getIndexKey( double weight,
                                         const string& term,
-                                        const BSONObj& indexPrefix );
+                                        const BSONObj& indexPrefix,
+                                        TextIndexVersion textIndexVersion );
+
+            /*
+             * the weight held in the element of an index key after its term
+             */
+            static double getWeight( const BSONElement& weightElement );
 
         private:
             /*
@@ -59,8 +66,10 @@ namespace mongo {
              * @param b, reference to the BSONOBjBuilder
              * @param weight, the weight of the term in the entry
              * @param term, the string term in the entry
+             * @param textIndexVersion, the format of the index's keys
              */
-            static void _appendIndexKey( BSONObjBuilder& b, double weight, const string& term );
+            static void _appendIndexKey( BSONObjBuilder& b, double weight, const string& term,
+                                         TextIndexVersion textIndexVersion );
         };
 
     }
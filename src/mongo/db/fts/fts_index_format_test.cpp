@@ -115,6 +115,66 @@ namespace mongo {
             ASSERT_EQUALS( 1U, keys2.size() );
         }
 
+        TEST( FTSIndexFormat, Version3Weight ) {
+            FTSSpec spec( FTSSpec::fixSpec( BSON( "key" << BSON( "data" << "text" ) <<
+                                                  "textIndexVersion" << 3 ) ) );
+            ASSERT_EQUALS( TEXT_INDEX_VERSION_3, spec.textIndexVersion() );
+            BSONObjSet keys;
+            FTSIndexFormat::getKeys( spec, BSON( "data" << "cat sat" ), &keys );
+
+            ASSERT_EQUALS( 2U, keys.size() );
+            for ( BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i ) {
+                BSONObjIterator j( *i );
+                ASSERT_EQUALS( String, j.next().type() );
+                BSONElement weight = j.next();
+                ASSERT_EQUALS( BinData, weight.type() );
+                int len;
+                weight.binData( len );
+                ASSERT_EQUALS( 4, len );
+                ASSERT( FTSIndexFormat::getWeight( weight ) > 0 );
+            }
+        }
+
+        TEST( FTSIndexFormat, Version3WeightOrder ) {
+            double weights[] = { 0, 0.25, 0.5, 1, 1.1, 3, 1000, MAX_WEIGHT };
+            for ( size_t i = 0; i < sizeof( weights ) / sizeof( weights[0] ); i++ ) {
+                BSONObj key = FTSIndexFormat::getIndexKey( weights[i], "cat", BSONObj(),
+                                                           TEXT_INDEX_VERSION_3 );
+                BSONObjIterator j( key );
+                j.next();
+                ASSERT_APPROX_EQUAL( weights[i], FTSIndexFormat::getWeight( j.next() ),
+                                     weights[i] * 1e-6 );
+                if ( i > 0 ) {
+                    BSONObj prev = FTSIndexFormat::getIndexKey( weights[i - 1], "cat", BSONObj(),
+                                                                TEXT_INDEX_VERSION_3 );
+                    ASSERT_LESS_THAN( prev.woCompare( key ), 0 );
+                }
+            }
+        }
+
+        TEST( FTSIndexFormat, Version3LongTerm ) {
+            string term( 100, 'a' );
+            string other = term;
+            other[99] = 'b';
+
+            BSONObj key = FTSIndexFormat::getIndexKey( 1, term, BSONObj(), TEXT_INDEX_VERSION_3 );
+            BSONObj otherKey = FTSIndexFormat::getIndexKey( 1, other, BSONObj(),
+                                                            TEXT_INDEX_VERSION_3 );
+            ASSERT_EQUALS( 64U, key.firstElement().String().size() );
+            ASSERT_EQUALS( term.substr( 0, 48 ), key.firstElement().String().substr( 0, 48 ) );
+            ASSERT_NOT_EQUALS( key.firstElement().String(), otherKey.firstElement().String() );
+            ASSERT_EQUALS( key, FTSIndexFormat::getIndexKey( 1, term, BSONObj(),
+                                                             TEXT_INDEX_VERSION_3 ) );
+
+            // short terms, and any term in version 2, are kept whole
+            ASSERT_EQUALS( "cat", FTSIndexFormat::getIndexKey( 1, "cat", BSONObj(),
+                                                               TEXT_INDEX_VERSION_3 )
+                                  .firstElement().String() );
+            ASSERT_EQUALS( term, FTSIndexFormat::getIndexKey( 1, term, BSONObj(),
+                                                              TEXT_INDEX_VERSION_2 )
+                                 .firstElement().String() );
+        }
+
 
     }
 }
@@ -84,8 +84,10 @@ namespace mongo {
 
             for ( unsigned i = 0; i < _query.getTerms().size(); i++ ) {
                 const string& term = _query.getTerms()[i];
-                BSONObj min = FTSIndexFormat::getIndexKey( MAX_WEIGHT, term, _indexPrefix );
-                BSONObj max = FTSIndexFormat::getIndexKey( 0, term, _indexPrefix );
+                BSONObj min = FTSIndexFormat::getIndexKey( MAX_WEIGHT, term, _indexPrefix,
+                                                           _ftsSpec.textIndexVersion() );
+                BSONObj max = FTSIndexFormat::getIndexKey( 0, term, _indexPrefix,
+                                                           _ftsSpec.textIndexVersion() );
 
                 shared_ptr<BtreeCursor> c( BtreeCursor::make(
                     nsdetails(_descriptor->parentNS().c_str()),
@@ -158,7 +160,7 @@ namespace mongo {
             i.next(); // move past indexToken
             BSONElement scoreElement = i.next();
 
-            double score = scoreElement.number();
+            double score = FTSIndexFormat::getWeight( scoreElement );
 
             double& cur = _scores[(cursor->currLoc()).rec()];
 
@@ -54,6 +54,9 @@ namespace mongo {
             massert( 16739, "found invalid spec for text index",
                      indexInfo["weights"].isABSONObj() );
 
+            _textIndexVersion = TEXT_INDEX_VERSION_3 == indexInfo["textIndexVersion"].numberInt() ?
+                TEXT_INDEX_VERSION_3 : TEXT_INDEX_VERSION_2;
+
             Status status = _defaultLanguage.init( indexInfo["default_language"].String() );
             verify( status.isOK() );
 
@@ -143,8 +146,9 @@ namespace mongo {
                                      bool isArray,
                                      TermFrequencyMap* term_freqs ) const {
             const FTSLanguage language = getLanguageToUse( obj, parentLanguage );
-            Stemmer stemmer( language );
-            Tools tools( language, &stemmer, StopWords::getStopWords( language ) );
+            Tools tools( language,
+                         &Stemmer::forThisThread( language ),
+                         StopWords::getStopWords( language ) );
 
             // Perform a depth-first traversal of obj, skipping fields not touched by this spec.
             BSONObjIterator j( obj );
@@ -243,19 +247,21 @@ namespace mongo {
 
             unsigned numTokens = 0;
 
+            // reused for each token
+            string term;
+
             Tokenizer i( tools.language, raw );
             while ( i.more() ) {
                 Token t = i.next();
                 if ( t.type != Token::TEXT )
                     continue;
 
-                string term = t.data.toString();
+                term.assign( t.data.rawData(), t.data.size() );
                 makeLower( &term );
                 if ( tools.stopwords->isStopWord( term ) )
                     continue;
-                term = tools.stemmer->stem( term );
 
-                ScoreHelperStruct& data = terms[term];
+                ScoreHelperStruct& data = terms[tools.stemmer->cachedStem( term )];
 
                 if ( data.exp )
                     data.exp *= 2;
@@ -402,7 +408,7 @@ namespace mongo {
                 language_override = "language";
 
             int version = -1;
-            int textIndexVersion = 2;
+            int textIndexVersion = TEXT_INDEX_VERSION_2;
 
             BSONObjBuilder b;
             BSONObjIterator i( spec );
@@ -430,7 +436,8 @@ namespace mongo {
                     textIndexVersion = e.numberInt();
                     uassert( 16730,
                              str::stream() << "bad textIndexVersion: " << textIndexVersion,
-                             textIndexVersion == 2 );
+                             textIndexVersion == TEXT_INDEX_VERSION_2 ||
+                             textIndexVersion == TEXT_INDEX_VERSION_3 );
                 }
                 else {
                     b.append( e );
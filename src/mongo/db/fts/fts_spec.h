@@ -51,6 +51,12 @@ namespace mongo {
 
         typedef unordered_map<string,double> TermFrequencyMap;
 
+        // The formats of a text index's keys; see FTSIndexFormat.
+        enum TextIndexVersion {
+            TEXT_INDEX_VERSION_2 = 2, // the term and its weight as a double
+            TEXT_INDEX_VERSION_3 = 3  // long terms cut short with a hash, weights in 4 bytes
+        };
+
 
         class FTSSpec {
 
@@ -71,6 +77,7 @@ namespace mongo {
             FTSSpec( const BSONObj& indexInfo );
 
             bool wildcard() const { return _wildcard; }
+            TextIndexVersion textIndexVersion() const { return _textIndexVersion; }
             const FTSLanguage defaultLanguage() const { return _defaultLanguage; }
             const string& languageOverrideField() const { return _languageOverrideField; }
 
@@ -115,6 +122,7 @@ namespace mongo {
                                TermFrequencyMap* term_freqs,
                                double weight ) const;
 
+            TextIndexVersion _textIndexVersion;
             FTSLanguage _defaultLanguage;
             string _languageOverrideField;
             bool _wildcard;
@@ -70,6 +70,20 @@ namespace mongo {
             catch ( UserException& e ) {}
         }
 
+        TEST( FTSSpec, TextIndexVersion1 ) {
+            BSONObj user = BSON( "key" << BSON( "text" << "fts" ) );
+            FTSSpec spec( FTSSpec::fixSpec( user ) );
+            ASSERT_EQUALS( TEXT_INDEX_VERSION_2, spec.textIndexVersion() );
+
+            FTSSpec spec3( FTSSpec::fixSpec( BSON( "key" << BSON( "text" << "fts" ) <<
+                                                   "textIndexVersion" << 3 ) ) );
+            ASSERT_EQUALS( TEXT_INDEX_VERSION_3, spec3.textIndexVersion() );
+
+            ASSERT_THROWS( FTSSpec::fixSpec( BSON( "key" << BSON( "text" << "fts" ) <<
+                                                   "textIndexVersion" << 4 ) ),
+                           UserException );
+        }
+
         TEST( FTSSpec, ScoreSingleField1 ) {
             BSONObj user = BSON( "key" << BSON( "title" << "fts" <<
                                                 "text" << "fts" ) <<
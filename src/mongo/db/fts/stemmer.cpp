@@ -32,9 +32,31 @@
 #include <string>
 
 #include "mongo/db/fts/stemmer.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/threadlocal.h"
 
 namespace mongo {
 
+    namespace fts {
+
+        namespace {
+            struct ThreadStemmers {
+                ~ThreadStemmers() {
+                    for ( unordered_map<string,Stemmer*>::iterator i = byLanguage.begin();
+                          i != byLanguage.end();
+                          ++i )
+                        delete i->second;
+                }
+
+                unordered_map<string,Stemmer*> byLanguage;
+            };
+        }
+
+    }
+
+    TSP_DECLARE(fts::ThreadStemmers, threadStemmers)
+    TSP_DEFINE(fts::ThreadStemmers, threadStemmers)
+
     namespace fts {
 
         Stemmer::Stemmer( const FTSLanguage language ) {
@@ -66,6 +88,31 @@ namespace mongo {
             return string( (const char*)(sb_sym), sb_stemmer_length( _stemmer ) );
         }
 
+        const string& Stemmer::cachedStem( const string& word ) const {
+            StemMap::const_iterator i = _recent.find( word );
+            if ( i != _recent.end() )
+                return i->second;
+
+            i = _older.find( word );
+            string stemmed = i != _older.end() ? i->second : stem( word );
+
+            if ( _recent.size() >= kMaxCachedStems ) {
+                _older.swap( _recent );
+                _recent.clear();
+            }
+
+            string& cached = _recent[word];
+            cached.swap( stemmed );
+            return cached;
+        }
+
+        const Stemmer& Stemmer::forThisThread( const FTSLanguage language ) {
+            Stemmer*& stemmer = threadStemmers.getMake()->byLanguage[language.str()];
+            if ( !stemmer )
+                stemmer = new Stemmer( language );
+            return *stemmer;
+        }
+
     }
 
 }
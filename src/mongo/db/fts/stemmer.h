@@ -35,6 +35,7 @@
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/fts/fts_language.h"
+#include "mongo/platform/unordered_map.h"
 #include "third_party/libstemmer_c/include/libstemmer.h"
 
 namespace mongo {
@@ -52,8 +53,31 @@ namespace mongo {
             ~Stemmer();
 
             std::string stem( const StringData& word ) const;
+
+            /**
+             * as stem, for words seen lately without running the stemmer again
+             * the result is good until the next call
+             */
+            const std::string& cachedStem( const std::string& word ) const;
+
+            /**
+             * the calling thread's Stemmer for language, whose cache lives as long as the thread
+             * text index keys are made by stemming the same words over and over
+             */
+            static const Stemmer& forThisThread( const FTSLanguage language );
+
+            // the stems of up to twice as many words are kept
+            static const size_t kMaxCachedStems = 1000;
+
         private:
+            typedef unordered_map<std::string,std::string> StemMap;
+
             struct sb_stemmer* _stemmer;
+
+            // Recently stemmed words.  When _recent fills it replaces _older, so the words in use
+            // stay cached and the rest age out.
+            mutable StemMap _recent;
+            mutable StemMap _older;
         };
     }
 }
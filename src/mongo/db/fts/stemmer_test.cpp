@@ -32,6 +32,7 @@
 #include "mongo/unittest/unittest.h"
 
 #include "mongo/db/fts/stemmer.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
     namespace fts {
@@ -42,5 +43,30 @@ namespace mongo {
             ASSERT_EQUALS( "Run", s.stem( "Running" ) );
         }
 
+        TEST( English, CachedStem ) {
+            Stemmer s( FTSLanguage::makeFTSLanguage( "english" ).getValue() );
+            ASSERT_EQUALS( "run", s.cachedStem( "running" ) );
+            ASSERT_EQUALS( "run", s.cachedStem( "running" ) );
+
+            // more words than are kept, twice over
+            for ( int pass = 0; pass < 2; pass++ ) {
+                for ( size_t i = 0; i < 3 * Stemmer::kMaxCachedStems; i++ ) {
+                    string word = mongoutils::str::stream() << "word" << i << "ing";
+                    ASSERT_EQUALS( s.stem( word ), s.cachedStem( word ) );
+                }
+            }
+            ASSERT_EQUALS( "Run", s.cachedStem( "Running" ) );
+        }
+
+        TEST( English, ForThisThread ) {
+            const FTSLanguage english = FTSLanguage::makeFTSLanguage( "english" ).getValue();
+            const FTSLanguage none = FTSLanguage::makeFTSLanguage( "none" ).getValue();
+            const Stemmer& s = Stemmer::forThisThread( english );
+            ASSERT_EQUALS( &s, &Stemmer::forThisThread( english ) );
+            ASSERT_NOT_EQUALS( &s, &Stemmer::forThisThread( none ) );
+            ASSERT_EQUALS( "run", s.cachedStem( "running" ) );
+            ASSERT_EQUALS( "running", Stemmer::forThisThread( none ).cachedStem( "running" ) );
+        }
+
     }
 }
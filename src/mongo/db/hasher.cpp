@@ -33,32 +33,72 @@
 */
 
 #include "mongo/db/hasher.h"
+
+#include <third_party/murmurhash3/MurmurHash3.h>
+
 #include "mongo/db/jsobj.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/startup_test.h"
 
 namespace mongo {
 
-    Hasher::Hasher( HashSeed seed ) : _seed( seed ) {
+    MD5Hasher::MD5Hasher( HashSeed seed ) : _seed( seed ) {
         md5_init( &_md5State );
         md5_append( &_md5State , reinterpret_cast< const md5_byte_t * >( & _seed ) , sizeof( _seed ) );
     }
 
-    void Hasher::addData( const void * keyData , size_t numBytes ) {
+    void MD5Hasher::addData( const void * keyData , size_t numBytes ) {
         md5_append( &_md5State , static_cast< const md5_byte_t * >( keyData ), numBytes );
     }
 
-    void Hasher::finish( HashDigest out ) {
+    void MD5Hasher::finish( HashDigest out ) {
         md5_finish( &_md5State , out );
     }
 
+    void Murmur3Hasher::addData( const void * keyData , size_t numBytes ) {
+        _data.appendBuf( keyData , numBytes );
+    }
+
+    void Murmur3Hasher::finish( HashDigest out ) {
+        MurmurHash3_x64_128( _data.buf() , _data.len() , _seed , out );
+    }
+
+    Hasher* HasherFactory::createHasher( HashSeed seed , int hashVersion ) {
+        massert( 17282 , mongoutils::str::stream() << "unknown hash version " << hashVersion ,
+                 isValidHashVersion( hashVersion ) );
+        if ( hashVersion == HASH_VERSION_MURMUR3 ) {
+            return new Murmur3Hasher( seed );
+        }
+        return new MD5Hasher( seed );
+    }
+
+    namespace {
+        long long int finishHash64( Hasher* h ) {
+            HashDigest d;
+            h->finish(d);
+            //HashDigest is actually 16 bytes, but we just get 8 via truncation
+            // NOTE: assumes little-endian
+            return *reinterpret_cast< long long int * >( d );
+        }
+    }
+
     long long int BSONElementHasher::hash64( const BSONElement& e , HashSeed seed ){
-        scoped_ptr<Hasher> h( HasherFactory::createHasher( seed ) );
-        recursiveHash( h.get() , e , false );
-        HashDigest d;
-        h->finish(d);
-        //HashDigest is actually 16 bytes, but we just get 8 via truncation
-        // NOTE: assumes little-endian
-        return *reinterpret_cast< long long int * >( d );
+        MD5Hasher h( seed );
+        recursiveHash( &h , e , false );
+        return finishHash64( &h );
+    }
+
+    long long int BSONElementHasher::hash64( const BSONElement& e , HashSeed seed ,
+                                             int hashVersion ) {
+        // on the stack, as this is done for every key of a hashed index
+        if ( hashVersion == HASH_VERSION_MURMUR3 ) {
+            Murmur3Hasher h( seed );
+            recursiveHash( &h , e , false );
+            return finishHash64( &h );
+        }
+        massert( 17283 , mongoutils::str::stream() << "unknown hash version " << hashVersion ,
+                 hashVersion == HASH_VERSION_MD5 );
+        return hash64( e , seed );
     }
 
     void BSONElementHasher::recursiveHash( Hasher* h ,
@@ -109,6 +149,8 @@ namespace mongo {
             // Hard-coded check to ensure the hash function is consistent across platforms
             BSONObj o = BSON( "check" << 42 );
             verify( BSONElementHasher::hash64( o.firstElement(), 0 ) == -944302157085130861LL );
+            verify( BSONElementHasher::hash64( o.firstElement(), 0, HASH_VERSION_MURMUR3 ) ==
+                    8715208212397937794LL );
         }
     } hasherUnitTest;
 }
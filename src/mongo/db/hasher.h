@@ -43,31 +43,63 @@ namespace mongo {
     typedef int HashSeed;
     typedef unsigned char HashDigest[16];
 
+    /* The hash functions of hashed indexes, chosen by the "hashVersion" of the index spec.
+     *
+     * WARNING: never change what an existing version computes.  Hashed indexes and
+     * hash-based sharding clusters store the hashes.
+     */
+    enum HashVersion {
+        HASH_VERSION_MD5 = 0,      // the default
+        HASH_VERSION_MURMUR3 = 1,  // MurmurHash3_x64_128, several times cheaper than MD5
+    };
+
     class Hasher : private boost::noncopyable {
     public:
-
-        explicit Hasher( HashSeed seed );
-        ~Hasher() { };
+        virtual ~Hasher() { };
 
         //pointer to next part of input key, length in bytes to read
-        void addData( const void * keyData , size_t numBytes );
+        virtual void addData( const void * keyData , size_t numBytes ) = 0;
 
         //finish computing the hash, put the result in the digest
         //only call this once per Hasher
-        void finish( HashDigest out );
+        virtual void finish( HashDigest out ) = 0;
+    };
+
+    class MD5Hasher : public Hasher {
+    public:
+        explicit MD5Hasher( HashSeed seed );
+
+        virtual void addData( const void * keyData , size_t numBytes );
+        virtual void finish( HashDigest out );
 
     private:
         md5_state_t _md5State;
         HashSeed _seed;
     };
 
+    /* MurmurHash3 has no incremental form, so the input is gathered and hashed by finish().
+     * The seed is MurmurHash3's own.
+     */
+    class Murmur3Hasher : public Hasher {
+    public:
+        explicit Murmur3Hasher( HashSeed seed ) : _seed( seed ) { }
+
+        virtual void addData( const void * keyData , size_t numBytes );
+        virtual void finish( HashDigest out );
+
+    private:
+        StackBufBuilder _data;
+        HashSeed _seed;
+    };
+
     class HasherFactory : private boost::noncopyable  {
     public:
-        /* Eventually this may be a more sophisticated factory
-         * for creating other hashers, but for now use MD5.
-         */
-        static Hasher* createHasher( HashSeed seed ) {
-            return new Hasher( seed );
+        /* @param hashVersion one of HashVersion; MD5 if not given. */
+        static Hasher* createHasher( HashSeed seed , int hashVersion = HASH_VERSION_MD5 );
+
+        /* @return true if hashVersion is one of HashVersion. */
+        static bool isValidHashVersion( int hashVersion ) {
+            return hashVersion == HASH_VERSION_MD5 || hashVersion == HASH_VERSION_MURMUR3;
         }
 
     private:
@@ -100,6 +132,11 @@ namespace mongo {
          */
         static long long int hash64( const BSONElement& e , HashSeed seed );
 
+        /* Same as above with the hash function of hashVersion, which must be one of
+         * HashVersion.
+         */
+        static long long int hash64( const BSONElement& e , HashSeed seed , int hashVersion );
+
     private:
         BSONElementHasher();
 
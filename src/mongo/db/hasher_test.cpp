@@ -381,5 +381,30 @@ namespace {
         ASSERT_EQUALS( hashIt( o ), 501342939894575968LL );
     }
 
+    long long murmurHashIt( const BSONObj& object, int seed = 0 ) {
+        return BSONElementHasher::hash64( object.firstElement(), seed, HASH_VERSION_MURMUR3 );
+    }
+
+    TEST( BSONElementHasher, Murmur3HashVersion ) {
+        ASSERT_EQUALS( murmurHashIt( BSON( "check" << 42 ) ), 8715208212397937794LL );
+        ASSERT_EQUALS( murmurHashIt( BSON( "check" << "hashthis" ) ), 8836086163715609865LL );
+        ASSERT_NOT_EQUALS( murmurHashIt( BSON( "check" << 42 ) ), hashIt( BSON( "check" << 42 ) ) );
+    }
+
+    TEST( BSONElementHasher, Murmur3SquashesLikeMD5 ) {
+        ASSERT_EQUALS( murmurHashIt( BSON( "a" << 3 ) ), murmurHashIt( BSON( "a" << 3LL ) ) );
+        ASSERT_EQUALS( murmurHashIt( BSON( "a" << 3 ) ), murmurHashIt( BSON( "a" << 3.1 ) ) );
+        ASSERT_EQUALS( murmurHashIt( BSON( "a" << BSON( "b" << 4 ) ) ),
+                       murmurHashIt( BSON( "a" << BSON( "b" << 4.1 ) ) ) );
+        ASSERT_NOT_EQUALS( murmurHashIt( BSON( "a" << 3 ) ), murmurHashIt( BSON( "a" << "3" ) ) );
+        ASSERT_NOT_EQUALS( murmurHashIt( BSON( "a" << 4 ), 0 ), murmurHashIt( BSON( "a" << 4 ), 1 ) );
+    }
+
+    TEST( BSONElementHasher, UnknownHashVersion ) {
+        ASSERT_FALSE( HasherFactory::isValidHashVersion( 2 ) );
+        ASSERT_THROWS( BSONElementHasher::hash64( BSON( "a" << 1 ).firstElement(), 0, 2 ),
+                       MsgAssertionException );
+    }
+
 } // namespace
 } // namespace mongo
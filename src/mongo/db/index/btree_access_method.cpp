@@ -28,6 +28,7 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/base/status.h"
@@ -37,13 +38,14 @@
 #include "mongo/db/keypattern.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/db/pdfile_private.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
     BtreeBasedAccessMethod::BtreeBasedAccessMethod(IndexDescriptor *descriptor)
         : _descriptor(descriptor), _ordering(Ordering::make(_descriptor->keyPattern())) {
 
-        verify(0 == descriptor->version() || 1 == descriptor->version());
+        verify(0 <= descriptor->version() && descriptor->version() <= 2);
         _interface = BtreeInterface::interfaces[descriptor->version()];
     }
 
@@ -92,6 +94,84 @@ namespace mongo {
         return ret;
     }
 
+    namespace {
+        // A key of one of the documents of an insertBulk().
+        struct BulkKey {
+            BulkKey(const BSONObj& k, size_t d) : key(k), doc(d) { }
+            BSONObj key;
+            size_t doc;
+        };
+
+        class BulkKeyLess {
+        public:
+            BulkKeyLess(const Ordering& ordering) : _ordering(ordering) { }
+            bool operator()(const BulkKey& l, const BulkKey& r) const {
+                int x = l.key.woCompare(r.key, _ordering, false);
+                return x < 0 || (x == 0 && l.doc < r.doc);
+            }
+        private:
+            const Ordering& _ordering;
+        };
+    }
+
+    Status BtreeBasedAccessMethod::insertBulk(const vector<BSONObj>& objs,
+                                              const vector<DiskLoc>& locs,
+                                              const InsertDeleteOptions& options,
+                                              vector<bool>* failed,
+                                              int64_t* numInserted) {
+        *numInserted = 0;
+
+        // Gather the keys of all the documents and insert them in index order, so the inserts
+        // move through the btree from one end to the other rather than jumping about it.
+        vector<BulkKey> keys;
+        vector<size_t> numKeys(objs.size(), 0);
+        for (size_t i = 0; i < objs.size(); ++i) {
+            if ((*failed)[i]) {
+                continue;
+            }
+            BSONObjSet docKeys;
+            try {
+                getKeys(objs[i], &docKeys);
+            } catch (DBException&) {
+                (*failed)[i] = true;
+                continue;
+            }
+            numKeys[i] = docKeys.size();
+            for (BSONObjSet::const_iterator j = docKeys.begin(); j != docKeys.end(); ++j) {
+                keys.push_back(BulkKey(*j, i));
+            }
+        }
+        std::sort(keys.begin(), keys.end(), BulkKeyLess(_ordering));
+
+        for (vector<BulkKey>::const_iterator i = keys.begin(); i != keys.end(); ++i) {
+            if ((*failed)[i->doc]) {
+                continue;
+            }
+            try {
+                _interface->bt_insert(_descriptor->getHead(), locs[i->doc], i->key, _ordering,
+                                      options.dupsAllowed, _descriptor->getOnDisk(), true);
+                ++*numInserted;
+            } catch (AssertionException& e) {
+                if (10287 == e.getCode() && _descriptor->isBackgroundIndex()) {
+                    // This is the duplicate key exception.  We ignore it for some reason in BG
+                    // indexing.
+                    DEV log() << "info: key already in index during bg indexing (ok)\n";
+                } else {
+                    (*failed)[i->doc] = true;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < objs.size(); ++i) {
+            if (!(*failed)[i] && numKeys[i] > 1) {
+                _descriptor->setMultikey();
+                break;
+            }
+        }
+
+        return Status::OK();
+    }
+
     bool BtreeBasedAccessMethod::removeOneKey(const BSONObj& key, const DiskLoc& loc) {
         bool ret = false;
 
@@ -172,6 +252,28 @@ namespace mongo {
         return Status::OK();
     }
 
+    bool BtreeBasedAccessMethod::keysMayChange(const BSONObj& from, const BSONObj& to) const {
+        if (_topLevelKeyFields.empty()) {
+            return true;
+        }
+
+        for (size_t i = 0; i < _topLevelKeyFields.size(); ++i) {
+            BSONElement a = from[_topLevelKeyFields[i]];
+            BSONElement b = to[_topLevelKeyFields[i]];
+            if (a.eoo() || b.eoo()) {
+                if (a.eoo() != b.eoo()) {
+                    return true;
+                }
+                continue;
+            }
+            if (a.type() != b.type() || a.valuesize() != b.valuesize()
+                || memcmp(a.value(), b.value(), a.valuesize())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     Status BtreeBasedAccessMethod::validateUpdate(
         const BSONObj &from, const BSONObj &to, const DiskLoc &record,
         const InsertDeleteOptions &options, UpdateTicket* status) {
@@ -179,10 +281,19 @@ namespace mongo {
         BtreeBasedPrivateUpdateData *data = new BtreeBasedPrivateUpdateData();
         status->_indexSpecificUpdateData.reset(data);
 
-        getKeys(from, &data->oldKeys);
-        getKeys(to, &data->newKeys);
         data->loc = record;
         data->dupsAllowed = options.dupsAllowed;
+        data->from = from;
+
+        // Nothing to add or remove, however large the arrays indexed.
+        if (!keysMayChange(from, to)) {
+            data->keysUnchanged = true;
+            status->_isValid = true;
+            return Status::OK();
+        }
+
+        getKeys(from, &data->oldKeys);
+        getKeys(to, &data->newKeys);
 
         setDifference(data->oldKeys, data->newKeys, &data->removed);
         setDifference(data->newKeys, data->oldKeys, &data->added);
@@ -236,6 +347,55 @@ namespace mongo {
         return Status::OK();
     }
 
+    Status BtreeBasedAccessMethod::updateMoved(const UpdateTicket& ticket,
+                                               const DiskLoc& newLoc,
+                                               int64_t* numUpdated) {
+        if (!ticket._isValid) {
+            return Status(ErrorCodes::InternalError, "Invalid updateticket in updateMoved");
+        }
+
+        BtreeBasedPrivateUpdateData* data =
+            static_cast<BtreeBasedPrivateUpdateData*>(ticket._indexSpecificUpdateData.get());
+
+        // Keys that can't have changed weren't got, but they all point at the old location.
+        BSONObjSet unchangedKeys;
+        if (data->keysUnchanged) {
+            getKeys(data->from, &unchangedKeys);
+        }
+        const BSONObjSet& newKeys = data->keysUnchanged ? unchangedKeys : data->newKeys;
+
+        if (newKeys.size() > 1) {
+            _descriptor->setMultikey();
+        }
+
+        for (size_t i = 0; i < data->removed.size(); ++i) {
+            _interface->unindex(_descriptor->getHead(), _descriptor->getOnDisk(), *data->removed[i],
+                                data->loc);
+        }
+
+        for (BSONObjSet::const_iterator i = newKeys.begin(); i != newKeys.end(); ++i) {
+            if (!data->keysUnchanged && data->oldKeys.count(*i) == 0) {
+                continue;
+            }
+            if (_interface->moveRecordLoc(_descriptor->getHead(), _descriptor->getOnDisk(), *i,
+                                          data->loc, newLoc)) {
+                continue;
+            }
+            _interface->unindex(_descriptor->getHead(), _descriptor->getOnDisk(), *i, data->loc);
+            _interface->bt_insert(_descriptor->getHead(), newLoc, *i, _ordering,
+                                  data->dupsAllowed, _descriptor->getOnDisk(), true);
+        }
+
+        for (size_t i = 0; i < data->added.size(); ++i) {
+            _interface->bt_insert(_descriptor->getHead(), newLoc, *data->added[i], _ordering,
+                                  data->dupsAllowed, _descriptor->getOnDisk(), true);
+        }
+
+        *numUpdated = data->added.size();
+
+        return Status::OK();
+    }
+
     // Standard Btree implementation below.
     BtreeAccessMethod::BtreeAccessMethod(IndexDescriptor* descriptor)
         : BtreeBasedAccessMethod(descriptor) {
@@ -249,12 +409,18 @@ namespace mongo {
             BSONElement elt = it.next();
             fieldNames.push_back(elt.fieldName());
             fixed.push_back(BSONElement());
+
+            string topLevelField = mongoutils::str::before(elt.fieldName(), '.');
+            if (std::find(_topLevelKeyFields.begin(), _topLevelKeyFields.end(), topLevelField)
+                == _topLevelKeyFields.end()) {
+                _topLevelKeyFields.push_back(topLevelField);
+            }
         }
 
         if (0 == descriptor->version()) {
             _keyGenerator.reset(new BtreeKeyGeneratorV0(fieldNames, fixed,
                 _descriptor->isSparse()));
-        } else if (1 == descriptor->version()) {
+        } else if (1 == descriptor->version() || 2 == descriptor->version()) {
             _keyGenerator.reset(new BtreeKeyGeneratorV1(fieldNames, fixed,
                 _descriptor->isSparse()));
         } else {
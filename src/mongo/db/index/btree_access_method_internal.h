@@ -62,6 +62,12 @@ namespace mongo {
                               const InsertDeleteOptions& options,
                               int64_t* numDeleted);
 
+        virtual Status insertBulk(const vector<BSONObj>& objs,
+                                  const vector<DiskLoc>& locs,
+                                  const InsertDeleteOptions& options,
+                                  vector<bool>* failed,
+                                  int64_t* numInserted);
+
         virtual Status validateUpdate(const BSONObj& from,
                                       const BSONObj& to,
                                       const DiskLoc& loc,
@@ -70,6 +76,10 @@ namespace mongo {
 
         virtual Status update(const UpdateTicket& ticket, int64_t* numUpdated);
 
+        virtual Status updateMoved(const UpdateTicket& ticket,
+                                   const DiskLoc& newLoc,
+                                   int64_t* numUpdated);
+
         virtual Status newCursor(IndexCursor **out) = 0;
 
         virtual Status touch(const BSONObj& obj);
@@ -79,6 +89,7 @@ namespace mongo {
     protected:
         // Friends who need getKeys.
         friend class BtreeBasedBuilder;
+        friend class BackgroundIndexBuildJob;
 
         // See below for body.
         class BtreeBasedPrivateUpdateData;
@@ -91,8 +102,16 @@ namespace mongo {
         // There are 2 types of Btree disk formats.  We put them both behind one interface.
         BtreeInterface* _interface;
 
+        // The top level fields of the documents that all the keys are got from, if a subclass
+        // knows them.  An update that leaves these alone leaves the keys alone, so
+        // validateUpdate() gets no keys for it.
+        vector<string> _topLevelKeyFields;
+
     private:
         bool removeOneKey(const BSONObj& key, const DiskLoc& loc);
+
+        /** whether the keys of 'to' may differ from those of 'from' */
+        bool keysMayChange(const BSONObj& from, const BSONObj& to) const;
     };
 
     /**
@@ -101,8 +120,13 @@ namespace mongo {
     class BtreeBasedAccessMethod::BtreeBasedPrivateUpdateData
         : public UpdateTicket::PrivateUpdateData {
     public:
+        BtreeBasedPrivateUpdateData() : keysUnchanged(false) { }
         virtual ~BtreeBasedPrivateUpdateData() { }
 
+        // The document updated.  Its keys are only got if they may have changed.
+        BSONObj from;
+        bool keysUnchanged;
+
         BSONObjSet oldKeys, newKeys;
 
         // These point into the sets oldKeys and newKeys.
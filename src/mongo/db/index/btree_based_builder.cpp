@@ -38,13 +38,27 @@
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/sort_phase_one.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/processinfo.h"
 
 namespace mongo {
 
     int oldCompare(const BSONObj& l,const BSONObj& r, const Ordering &o); // key.cpp
 
+    // threads getting the keys of documents for a foreground build of a plain btree index.  1
+    // gets them on the building thread.
+    MONGO_EXPORT_SERVER_PARAMETER(indexBuildKeyGenerationThreads, int, 4);
+
+    // keys a foreground build holds in memory before spilling a sorted run to dbpath/_tmp
+    MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildMemoryUsageMegabytes, int, 100);
+
+    namespace {
+        // documents handed to the key generation threads at a time
+        const size_t keyGenerationBatchSize = 4096;
+    }
+
     class ExternalSortComparisonV0 : public ExternalSortComparison {
     public:
         ExternalSortComparisonV0(const BSONObj& ordering) : _ordering(Ordering::make(ordering)) { }
@@ -83,8 +97,10 @@ namespace mongo {
                                    SortPhaseOne* phase1,
                                    ProgressMeterHolder& pm,
                                    Timer& t,
-                                   bool mayInterrupt ) {
+                                   bool mayInterrupt,
+                                   const set<DiskLoc>* skipLocs ) {
         BtreeBuilder<V> btBuilder(dupsAllowed, idx->getOnDisk());
+        unsigned long long nSkipped = 0;
         BSONObj keyLast;
         auto_ptr<BSONObjExternalSorter::Iterator> i = sorter.iterator();
         // verifies that pm and op refer to the same ProgressMeter
@@ -95,6 +111,11 @@ namespace mongo {
         while( i->more() ) {
             RARELY killCurrentOp.checkForInterrupt( !mayInterrupt );
             ExternalSortDatum d = i->next();
+            if ( skipLocs && skipLocs->count( d.second ) ) {
+                nSkipped++;
+                pm.hit();
+                continue;
+            }
 
             try {
                 if ( !dupsAllowed && dropDups ) {
@@ -130,7 +151,7 @@ namespace mongo {
         op->setMessage("index: (3/3) btree-middle", "Index: (3/3) BTree Middle Progress");
         LOG(t.seconds() > 10 ? 0 : 1 ) << "\t done building bottom layer, going to commit" << endl;
         btBuilder.commit( mayInterrupt );
-        if ( btBuilder.getn() != phase1->nkeys && ! dropDups ) {
+        if ( btBuilder.getn() + nSkipped != phase1->nkeys && ! dropDups ) {
             warning() << "not all entries were added to the index, probably some "
                          "keys were too large" << endl;
         }
@@ -144,16 +165,40 @@ namespace mongo {
         }
     }
 
+    void BtreeBasedBuilder::deallocTree(IndexDetails& idx) {
+        if (idx.head.isNull())
+            return;
+        if (0 == idx.version()) {
+            BtreeBucket<V0>::deallocTree(idx.head, idx);
+        } else {
+            BtreeBucket<V1>::deallocTree(idx.head, idx);
+        }
+        getDur().writingDiskLoc(idx.head).Null();
+    }
+
     ExternalSortComparison* BtreeBasedBuilder::getComparison(int version,
                                                              const BSONObj& keyPattern) {
         if (0 == version) {
             return new ExternalSortComparisonV0(keyPattern);
         } else {
-            verify(1 == version);
+            verify(1 == version || 2 == version);
             return new ExternalSortComparisonV1(keyPattern);
         }
     }
 
+    void BtreeBasedBuilder::initPhaseOne(Collection* collection,
+                                         IndexDescriptor* idx,
+                                         SortPhaseOne* phaseOne,
+                                         int budgetShares) {
+        phaseOne->sortCmp.reset(getComparison(idx->version(), idx->keyPattern()));
+        const long maxMemoryUsageBytes =
+            std::max(1, maxIndexBuildMemoryUsageMegabytes) * 1024L * 1024 /
+            std::max(1, budgetShares);
+        phaseOne->sorter.reset(new BSONObjExternalSorter(phaseOne->sortCmp.get(),
+                                                         maxMemoryUsageBytes));
+        phaseOne->sorter->hintNumObjects( collection->numRecords() );
+    }
+
     void BtreeBasedBuilder::addKeysToPhaseOne(Collection* collection,
                                               IndexDescriptor* idx,
                                               const BSONObj& order,
@@ -162,12 +207,20 @@ namespace mongo {
                                               bool mayInterrupt ) {
 
 
-        phaseOne->sortCmp.reset(getComparison(idx->version(), idx->keyPattern()));
-        phaseOne->sorter.reset(new BSONObjExternalSorter(phaseOne->sortCmp.get()));
-        phaseOne->sorter->hintNumObjects( collection->numRecords() );
+        initPhaseOne(collection, idx, phaseOne);
 
         BtreeBasedAccessMethod* iam =collection->getIndexCatalog()->getBtreeBasedIndex( idx );
 
+        // other index types may keep state in their key generation (text stemmers, geo
+        // parameters), so only plain btree keys are got on several threads.
+        const int nThreads = indexBuildKeyGenerationThreads;
+        if ( nThreads > 1 &&
+             CatalogHack::getAccessMethodName(idx->keyPattern()).empty() ) {
+            addKeysToPhaseOneParallel(collection, iam, phaseOne, progressMeter, mayInterrupt,
+                                      nThreads);
+            return;
+        }
+
         auto_ptr<Runner> runner(InternalPlanner::collectionScan(collection->ns().ns()));
         BSONObj o;
         DiskLoc loc;
@@ -188,6 +241,83 @@ namespace mongo {
 
     }
 
+    void BtreeBasedBuilder::getKeysInRange(BtreeBasedAccessMethod* iam,
+                                           const vector<BSONObj>* docs,
+                                           vector<BSONObjSet>* keys,
+                                           pair<size_t, size_t> range,
+                                           Status* status) {
+        try {
+            for (size_t i = range.first; i < range.second; ++i) {
+                iam->getKeys((*docs)[i], &(*keys)[i]);
+            }
+        }
+        catch (DBException& e) {
+            *status = e.toStatus();
+        }
+    }
+
+    void BtreeBasedBuilder::addKeysToPhaseOneParallel(Collection* collection,
+                                                      BtreeBasedAccessMethod* iam,
+                                                      SortPhaseOne* phaseOne,
+                                                      ProgressMeter* progressMeter,
+                                                      bool mayInterrupt,
+                                                      int nThreads) {
+        // the documents point into the data files, which stay put as the build holds the write
+        // lock throughout.  the threads only get keys; the sorter is fed here in scan order.
+        ThreadPool pool(nThreads);
+        vector<BSONObj> docs;
+        vector<DiskLoc> locs;
+        vector<BSONObjSet> keys;
+        vector<Status> statuses(nThreads, Status::OK());
+        docs.reserve(keyGenerationBatchSize);
+        locs.reserve(keyGenerationBatchSize);
+
+        auto_ptr<Runner> runner(InternalPlanner::collectionScan(collection->ns().ns()));
+        BSONObj o;
+        DiskLoc loc;
+        Runner::RunnerState state = Runner::RUNNER_ADVANCED;
+        while (state == Runner::RUNNER_ADVANCED) {
+            docs.clear();
+            locs.clear();
+            while (docs.size() < keyGenerationBatchSize &&
+                   Runner::RUNNER_ADVANCED == (state = runner->getNext(&o, &loc))) {
+                RARELY killCurrentOp.checkForInterrupt( !mayInterrupt );
+                docs.push_back(o);
+                locs.push_back(loc);
+            }
+            if (docs.empty())
+                break;
+
+            keys.clear();
+            keys.resize(docs.size());
+            const size_t perThread = (docs.size() + nThreads - 1) / nThreads;
+            for (int t = 0; t < nThreads; ++t) {
+                size_t begin = t * perThread;
+                size_t end = std::min(docs.size(), begin + perThread);
+                if (begin >= end)
+                    break;
+                pool.schedule(getKeysInRange, iam, &docs, &keys, make_pair(begin, end),
+                              &statuses[t]);
+            }
+            pool.join();
+
+            // report the error of the earliest document, as a single thread would have
+            for (int t = 0; t < nThreads; ++t) {
+                uassertStatusOK(statuses[t]);
+            }
+
+            for (size_t i = 0; i < docs.size(); ++i) {
+                phaseOne->addKeys(keys[i], locs[i], mayInterrupt);
+                progressMeter->hit();
+            }
+            if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(2))) {
+                printMemInfo( "\t iterating objects" );
+            }
+        }
+
+        uassert(17050, "Internal error reading docs from collection", Runner::RUNNER_EOF == state);
+    }
+
     uint64_t BtreeBasedBuilder::fastBuildIndex( Collection* collection,
                                                 IndexDescriptor* idx,
                                                 bool mayInterrupt ) {
@@ -197,8 +327,6 @@ namespace mongo {
 
         MONGO_TLOG(1) << "fastBuildIndex " << collection->ns() << ' ' << idx->toString() << endl;
 
-        bool dupsAllowed = !idx->unique() || ignoreUniqueIndex(idx->getOnDisk());
-        bool dropDups = idx->dropDups() || inDBRepair;
         BSONObj order = idx->keyPattern();
 
         getDur().writingDiskLoc(idx->getOnDisk().head).Null();
@@ -215,6 +343,71 @@ namespace mongo {
         addKeysToPhaseOne(collection, idx, order, &phase1, pm.get(), mayInterrupt );
         pm.finished();
 
+        buildFromPhaseOne(collection, idx, &phase1, NULL, pm, t, mayInterrupt);
+        return phase1.n;
+    }
+
+    uint64_t BtreeBasedBuilder::fastBuildIndexes(Collection* collection,
+                                                 const vector<IndexDescriptor*>& idxs,
+                                                 bool mayInterrupt) {
+        CurOp * op = cc().curop();
+
+        Timer t;
+
+        const int nIndexes = idxs.size();
+        vector<BtreeBasedAccessMethod*> iams(nIndexes);
+        vector<SortPhaseOne> phases(nIndexes);
+        for (int i = 0; i < nIndexes; ++i) {
+            MONGO_TLOG(1) << "fastBuildIndexes " << collection->ns() << ' '
+                          << idxs[i]->toString() << endl;
+            verify(!idxs[i]->dropDups());
+            getDur().writingDiskLoc(idxs[i]->getOnDisk().head).Null();
+            initPhaseOne(collection, idxs[i], &phases[i], nIndexes);
+            iams[i] = collection->getIndexCatalog()->getBtreeBasedIndex(idxs[i]);
+        }
+
+        /* get and sort the keys of every index ----- */
+        ProgressMeterHolder pm(op->setMessage("index: (1/3) external sort",
+                                              "Index: (1/3) External Sort Progress",
+                                              collection->numRecords(),
+                                              10));
+        uint64_t n = 0;
+        auto_ptr<Runner> runner(InternalPlanner::collectionScan(collection->ns().ns()));
+        BSONObj o;
+        DiskLoc loc;
+        Runner::RunnerState state;
+        while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&o, &loc))) {
+            RARELY killCurrentOp.checkForInterrupt( !mayInterrupt );
+            for (int i = 0; i < nIndexes; ++i) {
+                BSONObjSet keys;
+                iams[i]->getKeys(o, &keys);
+                phases[i].addKeys(keys, loc, mayInterrupt);
+            }
+            pm.hit();
+            ++n;
+        }
+        uassert(17308, "Internal error reading docs from collection", Runner::RUNNER_EOF == state);
+        pm.finished();
+
+        for (int i = 0; i < nIndexes; ++i) {
+            buildFromPhaseOne(collection, idxs[i], &phases[i], NULL, pm, t, mayInterrupt);
+        }
+        return n;
+    }
+
+    void BtreeBasedBuilder::buildFromPhaseOne(Collection* collection,
+                                              IndexDescriptor* idx,
+                                              SortPhaseOne* phaseOne,
+                                              const set<DiskLoc>* skipLocs,
+                                              ProgressMeterHolder& pm,
+                                              Timer& t,
+                                              bool mayInterrupt) {
+        CurOp * op = cc().curop();
+
+        bool dupsAllowed = !idx->unique() || ignoreUniqueIndex(idx->getOnDisk());
+        bool dropDups = idx->dropDups() || inDBRepair;
+
+        SortPhaseOne& phase1 = *phaseOne;
         BSONObjExternalSorter& sorter = *(phase1.sorter);
 
         if( phase1.multi ) {
@@ -243,8 +436,9 @@ namespace mongo {
                                          &phase1,
                                          pm,
                                          t,
-                                         mayInterrupt);
-        else if( idx->version() == 1 )
+                                         mayInterrupt,
+                                         skipLocs);
+        else if( idx->version() == 1 || idx->version() == 2 )
             buildBottomUpPhases2And3<V1>(dupsAllowed,
                                          idx,
                                          sorter,
@@ -254,7 +448,8 @@ namespace mongo {
                                          &phase1,
                                          pm,
                                          t,
-                                         mayInterrupt);
+                                         mayInterrupt,
+                                         skipLocs);
         else
             verify(false);
 
@@ -262,8 +457,6 @@ namespace mongo {
             log() << "\t fastBuildIndex dupsToDrop:" << dupsToDrop.size() << endl;
 
         doDropDups(collection, dupsToDrop, mayInterrupt);
-
-        return phase1.n;
     }
 
     void BtreeBasedBuilder::doDropDups(Collection* collection,
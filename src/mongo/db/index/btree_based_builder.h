@@ -29,6 +29,7 @@
 #pragma once
 
 #include <set>
+#include <vector>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pdfile.h"
@@ -36,6 +37,7 @@
 namespace IndexUpdateTests {
     class AddKeysToPhaseOne;
     class InterruptAddKeysToPhaseOne;
+    class ParallelAddKeysToPhaseOne;
     class DoDropDups;
     class InterruptDoDropDups;
 }
@@ -44,6 +46,7 @@ namespace mongo {
 
     class Collection;
     class BSONObjExternalSorter;
+    class BtreeBasedAccessMethod;
     class ExternalSortComparison;
     class IndexDescriptor;
     class IndexDetails;
@@ -59,12 +62,42 @@ namespace mongo {
          */
         static uint64_t fastBuildIndex(Collection* collection, IndexDescriptor* descriptor,
                                        bool mayInterrupt);
+
+        /**
+         * Builds the indexes idxs of collection from a single scan of it, the keys of each
+         * document going to the sorter of every index.  The indexes share the index build memory
+         * budget.  None may drop dups, as that deletes documents the other indexes have keys of.
+         * Throws DBException.  Returns the number of documents scanned.
+         */
+        static uint64_t fastBuildIndexes(Collection* collection,
+                                         const std::vector<IndexDescriptor*>& idxs,
+                                         bool mayInterrupt);
+
         static DiskLoc makeEmptyIndex(const IndexDetails& idx);
+        /** deallocates all the buckets of the tree of idx and nulls its head */
+        static void deallocTree(IndexDetails& idx);
         static ExternalSortComparison* getComparison(int version, const BSONObj& keyPattern);
 
+        /**
+         * sets up phaseOne to sort the keys of idx within the index build memory budget, or
+         * within 1/budgetShares of it when several sorters are fed at once
+         */
+        static void initPhaseOne(Collection* collection, IndexDescriptor* idx,
+                                 SortPhaseOne* phaseOne, int budgetShares = 1);
+
+        /**
+         * Sorts the keys added to phaseOne, builds the tree of idx bottom up from them and drops
+         * the duplicates if dropDups.  The keys of the documents at skipLocs, if given, are left
+         * out.  Throws DBException.
+         */
+        static void buildFromPhaseOne(Collection* collection, IndexDescriptor* idx,
+                                      SortPhaseOne* phaseOne, const set<DiskLoc>* skipLocs,
+                                      ProgressMeterHolder& pm, Timer& t, bool mayInterrupt);
+
     private:
         friend class IndexUpdateTests::AddKeysToPhaseOne;
         friend class IndexUpdateTests::InterruptAddKeysToPhaseOne;
+        friend class IndexUpdateTests::ParallelAddKeysToPhaseOne;
         friend class IndexUpdateTests::DoDropDups;
         friend class IndexUpdateTests::InterruptDoDropDups;
 
@@ -73,6 +106,20 @@ namespace mongo {
                                       const BSONObj& order, SortPhaseOne* phaseOne,
                                       ProgressMeter* progressMeter, bool mayInterrupt );
 
+        /** addKeysToPhaseOne() getting the keys of documents on nThreads threads */
+        static void addKeysToPhaseOneParallel(Collection* collection, BtreeBasedAccessMethod* iam,
+                                              SortPhaseOne* phaseOne,
+                                              ProgressMeter* progressMeter, bool mayInterrupt,
+                                              int nThreads);
+
+        /** gets the keys of docs[range.first, range.second) into the same positions of keys.
+            run on the key generation threads of addKeysToPhaseOne(); an exception is returned in
+            status.
+        */
+        static void getKeysInRange(BtreeBasedAccessMethod* iam, const std::vector<BSONObj>* docs,
+                                   std::vector<BSONObjSet>* keys,
+                                   std::pair<size_t, size_t> range, Status* status);
+
         static void doDropDups(Collection* collection, const set<DiskLoc>& dupsToDrop,
                                bool mayInterrupt );
     };
@@ -88,6 +135,7 @@ namespace mongo {
                                    SortPhaseOne* phase1,
                                    ProgressMeterHolder& pm,
                                    Timer& t,
-                                   bool mayInterrupt );
+                                   bool mayInterrupt,
+                                   const set<DiskLoc>* skipLocs = NULL );
 
 }  // namespace mongo
@@ -64,6 +64,14 @@ namespace mongo {
             return thisLoc.btree<Version>()->unindex(thisLoc, id, key, recordLoc);
         }
 
+        virtual bool moveRecordLoc(const DiskLoc thisLoc,
+                                   const IndexDetails& id,
+                                   const BSONObj& key,
+                                   const DiskLoc oldLoc,
+                                   const DiskLoc newLoc) const {
+            return thisLoc.btree<Version>()->moveRecordLoc(thisLoc, id, key, oldLoc, newLoc);
+        }
+
         virtual DiskLoc locate(const IndexDetails& idx,
                                const DiskLoc& thisLoc,
                                const BSONObj& key,
@@ -202,6 +210,7 @@ namespace mongo {
 
     BtreeInterfaceImpl<V0> interface_v0;
     BtreeInterfaceImpl<V1> interface_v1;
-    BtreeInterface* BtreeInterface::interfaces[] = { &interface_v0, &interface_v1 };
+    // v2 indexes use the v1 bucket layout, with shared key data (see BucketBasics::Flags)
+    BtreeInterface* BtreeInterface::interfaces[] = { &interface_v0, &interface_v1, &interface_v1 };
 
 }  // namespace mongo
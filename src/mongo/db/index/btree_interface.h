@@ -63,6 +63,12 @@ namespace mongo {
                              const BSONObj& key,
                              const DiskLoc recordLoc) const = 0;
 
+        virtual bool moveRecordLoc(const DiskLoc thisLoc,
+                                   const IndexDetails& id,
+                                   const BSONObj& key,
+                                   const DiskLoc oldLoc,
+                                   const DiskLoc newLoc) const = 0;
+
         virtual DiskLoc locate(const IndexDetails& idx,
                                const DiskLoc& thisLoc,
                                const BSONObj& key,
@@ -36,8 +36,9 @@
 namespace mongo {
 
     long long int HashAccessMethod::makeSingleKey(const BSONElement& e, HashSeed seed, int v) {
-        massert(16767, "Only HashVersion 0 has been defined" , v == 0 );
-        return BSONElementHasher::hash64(e, seed);
+        massert(16767, "Only HashVersion 0 and 1 have been defined" ,
+                HasherFactory::isValidHashVersion(v) );
+        return BSONElementHasher::hash64(e, seed, v);
     }
 
     HashAccessMethod::HashAccessMethod(IndexDescriptor* descriptor)
@@ -71,6 +72,9 @@ namespace mongo {
         //Defaults to 0 if "hashVersion" is not included in the index spec
         //or if the value of "hashversion" is not a number
         _hashVersion = descriptor->getInfoElement("hashVersion").numberInt();
+        uassert(17284, str::stream() << "hashVersion must be " << HASH_VERSION_MD5
+                                     << " (md5) or " << HASH_VERSION_MURMUR3 << " (murmur3)",
+                HasherFactory::isValidHashVersion(_hashVersion));
 
         //Get the hashfield name
         BSONElement firstElt = descriptor->keyPattern().firstElement();
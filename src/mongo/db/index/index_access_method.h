@@ -105,6 +105,16 @@ namespace mongo {
          */
         virtual Status update(const UpdateTicket& ticket, int64_t* numUpdated) = 0;
 
+        /**
+         * Perform a validated update of a document that has been copied to 'newLoc'.  Every key
+         * of 'to' ends up pointing at 'newLoc'; keys 'from' and 'to' share are pointed there in
+         * place where the index allows, rather than removed and inserted again.  The old copy of
+         * the document must still be in place.  Otherwise as update().
+         */
+        virtual Status updateMoved(const UpdateTicket& ticket,
+                                   const DiskLoc& newLoc,
+                                   int64_t* numUpdated) = 0;
+
         /**
          * Fills in '*out' with an IndexCursor.  Return a status indicating success or reason of
          * failure. If the latter, '*out' contains NULL.  See index_cursor.h for IndexCursor usage.
@@ -131,10 +141,21 @@ namespace mongo {
         virtual Status validate(int64_t* numKeys) = 0;
 
         //
-        // Bulk operations support (TODO)
+        // Bulk operations support
         //
 
-        // virtual Status insertBulk(BulkDocs arg) = 0;
+        /**
+         * Insert the keys of each of 'objs', pointing at the matching one of 'locs', in the
+         * order the index keeps them across all of the documents.  Documents marked in 'failed'
+         * are skipped, and those some of whose keys couldn't be inserted are marked there.  Any
+         * keys of a document marked failed may be in the index: the caller removes them.
+         * Equal keys are inserted in the order of their documents in 'objs'.
+         */
+        virtual Status insertBulk(const vector<BSONObj>& objs,
+                                  const vector<DiskLoc>& locs,
+                                  const InsertDeleteOptions& options,
+                                  vector<bool>* failed,
+                                  int64_t* numInserted) = 0;
 
         // virtual Status removeBulk(BulkDocs arg) = 0;
     };
@@ -51,7 +51,7 @@ namespace mongo {
         // Set up basic params.
         _params.maxKeysPerInsert = 200;
         // This is advisory.
-        _params.maxCellsInCovering = 50;
+        _params.maxCellsInCovering = configValueWithDefault(descriptor, "maxCellsInCovering", 50);
         // Near distances are specified in meters...sometimes.
         _params.radius = kRadiusOfEarthInMeters;
         // These are not advisory.
@@ -63,6 +63,7 @@ namespace mongo {
         uassert(16748, "finestIndexedLevel must be <= 30", _params.finestIndexedLevel <= 30);
         uassert(16749, "finestIndexedLevel must be >= coarsestIndexedLevel",
                 _params.finestIndexedLevel >= _params.coarsestIndexedLevel);
+        uassert(17286, "maxCellsInCovering must be >= 1", _params.maxCellsInCovering >= 1);
 
         int geoFields = 0;
 
@@ -28,19 +28,129 @@
 
 #include "mongo/db/index_rebuilder.h"
 
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
 #include "mongo/db/client.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/repl/replication_server_status.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
     IndexRebuilder indexRebuilder;
 
+namespace {
+
+    // At most this many threads scan the databases at startup.
+    const size_t maxScanThreads = 8;
+
+    void checkForIdIndexes( Database* db ) {
+
+        if ( db->name() == "local") {
+            // we do not need an _id index on anything in the local database
+            return;
+        }
+
+        list<string> collections;
+        db->namespaceIndex().getNamespaces( collections );
+
+        // for each collection, ensure there is a $_id_ index
+        for (list<string>::iterator i = collections.begin(); i != collections.end(); ++i) {
+            const string& collectionName = *i;
+            NamespaceString ns( collectionName );
+            if ( ns.isSystem() )
+                continue;
+
+            Collection* coll = db->getCollection( collectionName );
+            if ( !coll )
+                continue;
+
+            if ( coll->getIndexCatalog()->findIdIndex() )
+                continue;
+
+            log() << "WARNING: the collection '" << *i
+                  << "' lacks a unique index on _id."
+                  << " This index is needed for replication to function properly"
+                  << startupWarningsLog;
+            log() << "\t To fix this, on the primary run 'db." << i->substr(i->find('.')+1)
+                  << ".createIndex({_id: 1}, {unique: true})'"
+                  << startupWarningsLog;
+        }
+    }
+
+    /**
+     * The work shared by the scanning threads: the databases, the next one to take, and the
+     * collections found to have in-progress index builds.
+     */
+    struct ScanState {
+        ScanState(const std::vector<std::string>& names) : dbNames(names), next(0), failed(false) {}
+
+        const std::vector<std::string>& dbNames;
+        boost::mutex mutex;
+        size_t next;
+        std::list<std::string> nsToCheck;
+        bool failed;
+    };
+
+    void scanThread(ScanState* state) {
+        Client::initThread("IndexRebuilderScan");
+        ON_BLOCK_EXIT_OBJ(cc(), &Client::shutdown);
+        cc().getAuthorizationSession()->grantInternalAuthorization();
+
+        try {
+            while (true) {
+                std::string dbName;
+                {
+                    boost::lock_guard<boost::mutex> lk(state->mutex);
+                    if (state->next == state->dbNames.size())
+                        return;
+                    dbName = state->dbNames[state->next++];
+                }
+
+                std::list<std::string> inProgress;
+                {
+                    Client::ReadContext ctx(dbName);
+                    Database* db = cc().database();
+                    if (replSettings.usingReplSets()) {
+                        // we only care about the _id index if we are in a replset
+                        checkForIdIndexes(db);
+                    }
+
+                    std::list<std::string> collNames;
+                    db->namespaceIndex().getNamespaces(collNames, /* onlyCollections */ true);
+                    for (std::list<std::string>::const_iterator it = collNames.begin();
+                         it != collNames.end();
+                         ++it) {
+                        Collection* collection = db->getCollection(*it);
+                        if (collection &&
+                            collection->getIndexCatalog()->numIndexesInProgress() > 0) {
+                            inProgress.push_back(*it);
+                        }
+                    }
+                }
+
+                boost::lock_guard<boost::mutex> lk(state->mutex);
+                state->nsToCheck.splice(state->nsToCheck.end(), inProgress);
+            }
+        }
+        catch (const DBException& e) {
+            warning() << "scanning for interrupted index builds failed: " << e.toString() << endl;
+            boost::lock_guard<boost::mutex> lk(state->mutex);
+            state->failed = true;
+        }
+    }
+
+}  // namespace
+
     IndexRebuilder::IndexRebuilder() {}
 
     std::string IndexRebuilder::name() const {
@@ -52,18 +162,16 @@ namespace mongo {
         ON_BLOCK_EXIT_OBJ(cc(), &Client::shutdown);
         cc().getAuthorizationSession()->grantInternalAuthorization();
 
+        Timer timer;
         std::vector<std::string> dbNames;
         getDatabaseNames(dbNames);
 
         try {
             std::list<std::string> collNames;
-            for (std::vector<std::string>::const_iterator dbName = dbNames.begin();
-                 dbName < dbNames.end();
-                 dbName++) {
-                Client::ReadContext ctx(*dbName);
-                Database* db = cc().database();
-                db->namespaceIndex().getNamespaces(collNames, /* onlyCollections */ true);
-            }
+            scanDatabases(dbNames, &collNames);
+            log() << "scanned " << dbNames.size() << " databases for interrupted index builds in "
+                  << timer.millis() << "ms, found " << collNames.size() << " collection(s)"
+                  << endl;
             {
                 boost::unique_lock<boost::mutex> lk(ReplSet::rss.mtx);
                 ReplSet::rss.indexRebuildDone = true;
@@ -82,6 +190,21 @@ namespace mongo {
         LOG(1) << "checking complete" << endl;
     }
 
+    void IndexRebuilder::scanDatabases(const std::vector<std::string>& dbNames,
+                                       std::list<std::string>* nsToCheck) {
+        ScanState state(dbNames);
+        const size_t numThreads = std::min(maxScanThreads, dbNames.size());
+
+        boost::thread_group threads;
+        for (size_t i = 0; i < numThreads; i++) {
+            threads.create_thread(boost::bind(&scanThread, &state));
+        }
+        threads.join_all();
+
+        uassert(17317, "scanning for interrupted index builds failed", !state.failed);
+        nsToCheck->swap(state.nsToCheck);
+    }
+
     void IndexRebuilder::checkNS(const std::list<std::string>& nsToCheck) {
         bool firstTime = true;
         for (std::list<std::string>::const_iterator it = nsToCheck.begin();
@@ -28,6 +28,10 @@
 
 #pragma once
 
+#include <list>
+#include <string>
+#include <vector>
+
 #include "mongo/db/namespace_details.h"
 #include "mongo/util/background.h"
 
@@ -43,6 +47,14 @@ namespace mongo {
         void run();
 
     private:
+        /**
+         * Lists the collections of dbNames with in-progress index builds into nsToCheck, and on
+         * replica set members warns about collections without an _id index.  The databases
+         * are scanned by several threads, each under a read lock.
+         */
+        void scanDatabases(const std::vector<std::string>& dbNames,
+                           std::list<std::string>* nsToCheck);
+
         /**
          * Check each collection in the passed in list to see if it has any in-progress index
          * builds that need to be retried.  If so, calls retryIndexBuild.
@@ -43,11 +43,19 @@ namespace mongo {
         }
     }
 
+    void IndexPathSet::allPathsIndexed() {
+        _allPathsIndexed = true;
+    }
+
     void IndexPathSet::clear() {
         _canonical.clear();
+        _allPathsIndexed = false;
     }
 
     bool IndexPathSet::mightBeIndexed( const StringData& path ) const {
+        if ( _allPathsIndexed )
+            return true;
+
         StringData use = path;
         string x;
         if ( getCanonicalIndexField( path, &x ) )
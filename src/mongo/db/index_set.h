@@ -44,8 +44,15 @@ namespace mongo {
 
     class IndexPathSet {
     public:
+        IndexPathSet() : _allPathsIndexed( false ) {}
+
         void addPath( const StringData& path );
 
+        /**
+         * every path might be indexed, as with a text index over all string fields
+         */
+        void allPathsIndexed();
+
         void clear();
 
         bool mightBeIndexed( const StringData& path ) const;
@@ -55,6 +62,8 @@ namespace mongo {
         bool _startsWith( const StringData& a, const StringData& b ) const;
 
         std::set<std::string> _canonical;
+
+        bool _allPathsIndexed;
     };
 
 }
@@ -39,6 +39,17 @@ namespace mongo {
         ASSERT_FALSE( a.mightBeIndexed( "a" ) );
     }
 
+    TEST( IndexPathSetTest, AllPaths ) {
+        IndexPathSet a;
+        a.addPath( "a" );
+        a.allPathsIndexed();
+        ASSERT_TRUE( a.mightBeIndexed( "b" ) );
+        ASSERT_TRUE( a.mightBeIndexed( "c.d" ) );
+
+        a.clear();
+        ASSERT_FALSE( a.mightBeIndexed( "b" ) );
+    }
+
 
     TEST( IndexPathSetTest, getCanonicalIndexField1 ) {
         string x;
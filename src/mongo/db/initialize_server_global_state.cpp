@@ -44,6 +44,10 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/security_key.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/logger/async_log_appender.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logger/console_appender.h"
 #include "mongo/logger/message_event.h"
@@ -63,6 +67,25 @@ namespace fs = boost::filesystem;
 
 namespace mongo {
 
+    // With a logpath, bytes of log lines buffered for a background thread to write, so that
+    // logging never waits on the log file.  Lines that don't fit are dropped.  0 writes each line
+    // on the thread logging it.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(logBufferBytes, int, 0);
+
+namespace {
+    logger::AsyncLogWriter* asyncLogWriter = NULL;
+
+    class LogDroppedLinesMetric : public ServerStatusMetric {
+    public:
+        LogDroppedLinesMetric() : ServerStatusMetric("log.droppedLines") {}
+
+        virtual void appendAtLeaf(BSONObjBuilder& b) const {
+            b.appendNumber(_leafName, asyncLogWriter ?
+                           static_cast<long long>(asyncLogWriter->droppedLines()) : 0LL);
+        }
+    } logDroppedLinesMetric;
+}  // namespace
+
 #ifndef _WIN32
     // support for exit value propagation with fork
     void launchSignal( int sig ) {
@@ -271,14 +294,29 @@ namespace mongo {
 
             LogManager* manager = logger::globalLogManager();
             manager->getGlobalDomain()->clearAppenders();
-            manager->getGlobalDomain()->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
-            manager->getNamedDomain("javascriptOutput")->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
+            if (logBufferBytes > 0) {
+                using logger::AsyncLogAppender;
+
+                asyncLogWriter = new logger::AsyncLogWriter(writer.getValue(), logBufferBytes);
+                manager->getGlobalDomain()->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new AsyncLogAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, asyncLogWriter)));
+                manager->getNamedDomain("javascriptOutput")->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new AsyncLogAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, asyncLogWriter)));
+            }
+            else {
+                manager->getGlobalDomain()->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new RotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, writer.getValue())));
+                manager->getNamedDomain("javascriptOutput")->attachAppender(
+                        MessageLogDomain::AppenderAutoPtr(
+                                new RotatableFileAppender<MessageEventEphemeral>(
+                                        new MessageEventDetailsEncoder, writer.getValue())));
+            }
 
             if (serverGlobalParams.logAppend && exists) {
                 log() << "***** SERVER RESTARTED *****" << endl;
@@ -41,9 +41,11 @@
 
 #include "mongo/base/status.h"
 #include "mongo/bson/util/atomic_int.h"
+#include "mongo/db/admission_control.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
+#include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/background.h"
 #include "mongo/db/clientcursor.h"
@@ -72,9 +74,12 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/d_logic.h"
 #include "mongo/s/stale_exception.h" // for SendStaleConfigException
+#include "mongo/util/compress.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/file_allocator.h"
 #include "mongo/util/gcov.h"
@@ -438,6 +443,9 @@ namespace mongo {
         long long logThreshold = serverGlobalParams.slowMS;
         bool shouldLog = logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1));
 
+        // Queue here rather than on the locks when too many operations are running.
+        AdmissionTicket admissionTicket( c, m, isCommand, nestedOp.get() != NULL );
+
         if ( op == dbQuery ) {
             if ( handlePossibleShardedMessage( m , &dbresponse ) )
                 return;
@@ -724,6 +732,34 @@ namespace mongo {
 
     QueryResult* emptyMoreResult(long long);
 
+    /**
+     * Compresses the documents of a getMore reply and marks it ResultFlag_Compressed, unless that
+     * would not make it smaller.  Takes ownership of qr.
+     */
+    static QueryResult* compressGetMoreReply(QueryResult* qr) {
+        const int headerLen = qr->data() - reinterpret_cast<const char*>(qr);
+        const int dataLen = qr->len - headerLen;
+        if (qr->nReturned == 0) {
+            return qr;
+        }
+
+        string compressed;
+        compress(qr->data(), dataLen, &compressed);
+        if (compressed.size() >= static_cast<size_t>(dataLen)) {
+            return qr;
+        }
+
+        BufBuilder b(headerLen + compressed.size());
+        b.appendBuf(qr, headerLen);
+        b.appendBuf(compressed.data(), compressed.size());
+        QueryResult* out = reinterpret_cast<QueryResult*>(b.buf());
+        out->len = b.len();
+        out->_resultFlags() |= ResultFlag_Compressed;
+        b.decouple();
+        free(qr);
+        return out;
+    }
+
     bool receivedGetMore(DbResponse& dbresponse, Message& m, CurOp& curop ) {
         bool ok = true;
 
@@ -743,6 +779,7 @@ namespace mongo {
         bool exhaust = false;
         QueryResult* msgdata = 0;
         OpTime last;
+        unsigned long long cappedInserts = 0;
         while( 1 ) {
             bool isCursorAuthorized = false;
             try {
@@ -767,6 +804,10 @@ namespace mongo {
                         last.waitForDifferent(1000/*ms*/);
                     }
                 }
+                else {
+                    // read before looking for data, so an insert made while we look wakes us
+                    cappedInserts = NamespaceDetails::cappedInsertCount();
+                }
 
                 msgdata = processGetMore(ns,
                                          ntoreturn,
@@ -805,10 +846,15 @@ namespace mongo {
                     }
                 }
                 pass++;
-                if (debug)
-                    sleepmillis(20);
-                else
-                    sleepmillis(2);
+                if (str::startsWith(ns, "local.oplog.")) {
+                    if (debug)
+                        sleepmillis(20);
+                    else
+                        sleepmillis(2);
+                }
+                else {
+                    NamespaceDetails::waitForCappedInsert(cappedInserts, 1000/*ms*/);
+                }
                 
                 // note: the 1100 is beacuse of the waitForDifferent above
                 // should eventually clean this up a bit
@@ -832,6 +878,12 @@ namespace mongo {
             return ok;
         }
 
+        if ((d.reservedField() & QueryOption_CompressedOplogReplies) &&
+            str::startsWith(ns, "local.oplog.")) {
+            // the reserved field of a getMore holds the options of the cursor's query
+            msgdata = compressGetMoreReply(msgdata);
+        }
+
         Message *resp = new Message();
         resp->setData(msgdata, true);
         curop.debug().responseLength = resp->header()->dataLen();
@@ -848,7 +900,7 @@ namespace mongo {
         return ok;
     }
 
-    void checkAndInsert(const char *ns, /*modifies*/BSONObj& js) {
+    static void checkObjectForInsert(const BSONObj& js) {
         uassert( 10059 , "object to insert too large", js.objsize() <= BSONObjMaxUserSize);
         {
             BSONObjIterator i( js );
@@ -871,6 +923,10 @@ namespace mongo {
                 }
             }
         }
+    }
+
+    void checkAndInsert(const char *ns, /*modifies*/BSONObj& js) {
+        checkObjectForInsert(js);
 
         theDataFileMgr.insertWithObjMod(ns,
                                         // May be modified in the call to add an _id field.
@@ -884,9 +940,125 @@ namespace mongo {
         logOp("i", ns, js);
     }
 
+    // How many objects go into the indexes together, between opportunities to commit.
+    static const size_t kMaxInsertBatchSize = 64;
+
+    void checkAndInsertBatch(const char *ns,
+                             /*modifies*/vector<BSONObj>& objs,
+                             bool ordered,
+                             vector<bool>* inserted) {
+        inserted->assign(objs.size(), false);
+
+        const NamespaceString nsString(ns);
+        Collection* collection = cc().database()->getCollection(ns);
+        if (objs.size() < 2 ||
+                !collection ||
+                collection->details()->isCapped() ||
+                !NamespaceString::normal(ns) ||
+                nsString.isSystem()) {
+            return;
+        }
+
+        // The objects checkAndInsert() would refuse are left to it to refuse.
+        vector<size_t> which;
+        for (size_t i = 0; i < objs.size(); i++) {
+            try {
+                checkObjectForInsert(objs[i]);
+            }
+            catch (const UserException&) {
+                if (ordered)
+                    break;
+                continue;
+            }
+            which.push_back(i);
+        }
+
+        for (size_t begin = 0; begin < which.size(); begin += kMaxInsertBatchSize) {
+            const size_t end = std::min(which.size(), begin + kMaxInsertBatchSize);
+            vector<BSONObj> batch;
+            for (size_t k = begin; k < end; k++) {
+                batch.push_back(objs[which[k]]);
+            }
+
+            vector<bool> batchInserted;
+            theDataFileMgr.insertBatchWithObjMod(ns, batch, ordered, &batchInserted);
+
+            bool allInserted = true;
+            for (size_t k = 0; k < batch.size(); k++) {
+                if (!batchInserted[k]) {
+                    allInserted = false;
+                    continue;
+                }
+                objs[which[begin + k]] = batch[k];
+                (*inserted)[which[begin + k]] = true;
+                logOp("i", ns, batch[k]);
+            }
+            getDur().commitIfNeeded();
+
+            if (ordered && !allInserted)
+                break;
+        }
+    }
+
+    /**
+     * builds the indexes of the specs objs inserted into a system.indexes, the ones for the same
+     * collection with one scan of it.  like checkAndInsertBatch(), marks the ones it created in
+     * inserted and leaves the rest, and the specs of a collection it couldn't build, to
+     * checkAndInsert(), which creates the collection or says what is wrong.
+     */
+    void checkAndCreateIndexes(const char *ns,
+                               const vector<BSONObj>& objs,
+                               bool ordered,
+                               vector<bool>* inserted) {
+        inserted->assign(objs.size(), false);
+
+        Database* db = cc().database();
+        for (size_t begin = 0; begin < objs.size(); ) {
+            // a run of specs for the same collection
+            const StringData indexNs = objs[begin].getStringField("ns");
+            size_t end = begin;
+            vector<BSONObj> specs;
+            for (; end < objs.size() && indexNs == objs[end].getStringField("ns"); end++) {
+                try {
+                    checkObjectForInsert(objs[end]);
+                }
+                catch (const UserException&) {
+                    break;
+                }
+                specs.push_back(objs[end]);
+            }
+
+            Collection* collection =
+                db->ownsNS(indexNs.toString()) ? db->getCollection(indexNs) : NULL;
+            if (specs.size() < 2 || !collection ||
+                    !collection->getIndexCatalog()->createIndexes(
+                        specs, cc().curop()->parent() == NULL).isOK()) {
+                if (ordered)
+                    return;
+                begin = std::max(end, begin + 1);
+                continue;
+            }
+
+            for (size_t i = begin; i < end; i++) {
+                (*inserted)[i] = true;
+                logOp("i", ns, objs[i]);
+            }
+            getDur().commitIfNeeded();
+            begin = end;
+        }
+    }
+
     NOINLINE_DECL void insertMulti(bool keepGoing, const char *ns, vector<BSONObj>& objs, CurOp& op) {
+        vector<bool> inserted;
+        if (nsToCollectionSubstring(ns) == "system.indexes")
+            checkAndCreateIndexes(ns, objs, !keepGoing, &inserted);
+        else
+            checkAndInsertBatch(ns, objs, !keepGoing, &inserted);
+
         size_t i;
         for (i=0; i<objs.size(); i++){
+            if (inserted[i])
+                continue;
             try {
                 checkAndInsert(ns, objs[i]);
                 getDur().commitIfNeeded();
@@ -913,6 +1085,15 @@ namespace mongo {
             return;
         }
 
+        // Connections authenticated as the internal user (mongos, and the other members) have
+        // already checked the objects they send us
+        if (serverGlobalParams.objcheck &&
+                getGlobalAuthorizationManager()->isAuthEnabled() &&
+                cc().getAuthorizationSession()->isAuthorizedForActionsOnResource(
+                        ResourcePattern::forAnyResource(), ActionType::anyAction)) {
+            d.skipObjectValidation();
+        }
+
         vector<BSONObj> multi;
         while (d.moreJSObjs()){
             BSONObj obj = d.nextJsObj();
@@ -1236,6 +1417,7 @@ namespace {
         }
 #endif
         tryToOutputFatal( "dbexit: really exiting now" );
+        logger::AsyncLogWriter::flushAll();
         if ( c ) c->shutdown();
         ::_exit(rc);
     }
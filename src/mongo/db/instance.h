@@ -139,4 +139,15 @@ namespace mongo {
 
     void checkAndInsert(const char *ns, BSONObj& js);
 
+    /**
+     * Inserts and logs objs as checkAndInsert() would one after another, putting the keys of
+     * several of them into each index together.  Sets (*inserted)[i] for each of objs it
+     * inserted.  The rest, and when ordered, those after the first of them, are left for the
+     * caller to checkAndInsert() in turn, which says why they can't be inserted.
+     */
+    void checkAndInsertBatch(const char *ns,
+                             vector<BSONObj>& objs,
+                             bool ordered,
+                             vector<bool>* inserted);
+
 } // namespace mongo
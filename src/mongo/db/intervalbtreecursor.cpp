@@ -61,8 +61,8 @@ namespace mongo {
                                                     bool lowerBoundInclusive,
                                                     const BSONObj& upperBound,
                                                     bool upperBoundInclusive ) {
-        if ( indexDetails.version() != 1 ) {
-            // Only v1 indexes are supported.
+        if ( indexDetails.version() != 1 && indexDetails.version() != 2 ) {
+            // Only v1 and v2 indexes, which share the v1 bucket layout, are supported.
             return NULL;
         }
         auto_ptr<IntervalBtreeCursor> ret( new IntervalBtreeCursor( namespaceDetails,
@@ -30,24 +30,61 @@
 
 #include "mongo/pch.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_set.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/database_holder.h"
 #include "mongo/db/introspect.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/goodies.h"
+#include "mongo/util/queue.h"
 
 namespace {
     const size_t MAX_PROFILE_DOC_SIZE_BYTES = 100*1024;
+
+    // Most bytes of profile entries waiting for the writer thread; past it entries are dropped.
+    const size_t MAX_PROFILE_QUEUE_BYTES = 16*1024*1024;
+
+    // Most entries the writer thread inserts under one acquisition of a database's write lock.
+    const size_t MAX_PROFILE_BATCH = 100;
 }
 
 namespace mongo {
 
+    // Fraction of the operations the profiling level selects that are written to system.profile.
+    MONGO_EXPORT_SERVER_PARAMETER( profileSampleRate, double, 1.0 );
+
+    // When set, operations hand their profile entries to a background writer thread instead of
+    // taking the database write lock to insert them.
+    MONGO_EXPORT_SERVER_PARAMETER( profileAsync, bool, false );
+
+    static Counter64 profileSampledOut;
+    static Counter64 profileDropped;
+    static Counter64 profileWritten;
+
+    static ServerStatusMetricField<Counter64> displaySampledOut( "profile.sampledOut",
+                                                                 &profileSampledOut );
+    static ServerStatusMetricField<Counter64> displayDropped( "profile.dropped", &profileDropped );
+    static ServerStatusMetricField<Counter64> displayWritten( "profile.written", &profileWritten );
+
+    struct ProfileSampleRandom {
+        ProfileSampleRandom() : random( static_cast<int64_t>( curTimeMicros64() ) ^
+                                        reinterpret_cast<intptr_t>( this ) ) {}
+        PseudoRandom random;
+    };
+    TSP_DECLARE(ProfileSampleRandom, profileSampleRandom)
+    TSP_DEFINE(ProfileSampleRandom, profileSampleRandom)
+
 namespace {
     void _appendUserInfo(const Client& c,
                          BSONObjBuilder& builder,
@@ -78,11 +115,8 @@ namespace {
     }
 } // namespace
 
-    static void _profile(const Client& c, CurOp& currentOp, BufBuilder& profileBufBuilder) {
-        Database *db = c.database();
-        DEV verify( db );
-        const char *ns = db->getProfilingNS();
-
+    static BSONObj _buildProfileObject(const Client& c, CurOp& currentOp,
+                                       BufBuilder& profileBufBuilder) {
         // build object
         BSONObjBuilder b(profileBufBuilder);
 
@@ -117,22 +151,132 @@ namespace {
 
             p = b.done();
         }
+        return p;
+    }
 
+    static void _insertProfileObject(Database* db, const BSONObj& p) {
         // write: not replicated
         // get or create the profiling collection
         NamespaceDetails *details = getOrCreateProfileCollection(db);
         if (details) {
             int len = p.objsize();
-            Record *r = theDataFileMgr.fast_oplog_insert(details, ns, len);
+            Record *r = theDataFileMgr.fast_oplog_insert(details, db->getProfilingNS(), len);
             memcpy(getDur().writingPtr(r->data(), len), p.objdata(), len);
+            profileWritten.increment();
+        }
+    }
+
+    static void _profile(const Client& c, CurOp& currentOp, BufBuilder& profileBufBuilder) {
+        Database *db = c.database();
+        DEV verify( db );
+        _insertProfileObject(db, _buildProfileObject(c, currentOp, profileBufBuilder));
+    }
+
+namespace {
+
+    struct ProfileEntry {
+        string ns;      // of the operation; the entry goes to its database's system.profile
+        BSONObj obj;
+    };
+
+    size_t profileEntrySize(const ProfileEntry& entry) {
+        return entry.obj.objsize();
+    }
+
+    BlockingQueue<ProfileEntry> profileQueue(MAX_PROFILE_QUEUE_BYTES, &profileEntrySize);
+
+    /**
+     * Inserts the entries operations queue with profileAsync set, a batch for a database at a time.
+     */
+    class ProfileWriter : public BackgroundJob {
+    public:
+        virtual string name() const { return "ProfileWriter"; }
+
+        virtual void run() {
+            Client::initThread( name().c_str() );
+            cc().getAuthorizationSession()->grantInternalAuthorization();
+
+            vector<ProfileEntry> batch;
+            while ( ! inShutdown() ) {
+                ProfileEntry entry;
+                if ( ! profileQueue.blockingPop( entry, 1 ) )
+                    continue;
+
+                batch.clear();
+                batch.push_back( entry );
+                while ( batch.size() < MAX_PROFILE_BATCH && profileQueue.tryPop( entry ) )
+                    batch.push_back( entry );
+
+                for ( size_t i = 0; i < batch.size(); ) {
+                    StringData dbName = nsToDatabaseSubstring( batch[i].ns );
+                    size_t end = i + 1;
+                    while ( end < batch.size() &&
+                            nsToDatabaseSubstring( batch[end].ns ) == dbName )
+                        ++end;
+                    write( batch, i, end );
+                    i = end;
+                }
+            }
+        }
+
+    private:
+        /** Inserts batch[begin, end), which are all for one database. */
+        void write( const vector<ProfileEntry>& batch, size_t begin, size_t end ) {
+            const string& ns = batch[begin].ns;
+            try {
+                Lock::DBWrite lk( ns );
+                if ( ! dbHolder()._isLoaded( nsToDatabase( ns ), storageGlobalParams.dbpath ) ) {
+                    LOG(1) << "note: not profiling because db went away - probably a close on: "
+                           << ns << endl;
+                    return;
+                }
+                Client::Context cx( ns, storageGlobalParams.dbpath );
+                for ( size_t i = begin; i < end; ++i )
+                    _insertProfileObject( cx.db(), batch[i].obj );
+            }
+            catch ( const AssertionException& assertionEx ) {
+                warning() << "Caught Assertion while trying to write profile entries for " << ns
+                          << ": " << assertionEx.toString() << endl;
+            }
         }
+    };
+
+    bool sampled() {
+        const double rate = profileSampleRate;
+        if ( rate >= 1.0 )
+            return true;
+        if ( rate <= 0.0 )
+            return false;
+
+        ProfileSampleRandom* r = profileSampleRandom.get();
+        if ( ! r ) {
+            r = new ProfileSampleRandom();
+            profileSampleRandom.reset( r );
+        }
+        return ( r->random.nextInt64() & 0xffffffff ) < rate * 4294967296.0;
     }
 
+} // namespace
+
     void profile(const Client& c, int op, CurOp& currentOp) {
+        if (!sampled()) {
+            profileSampledOut.increment();
+            return;
+        }
+
         // initialize with 1kb to start, to avoid realloc later
         // doing this outside the dblock to improve performance
         BufBuilder profileBufBuilder(1024);
 
+        if (profileAsync) {
+            ProfileEntry entry;
+            entry.ns = currentOp.getNS();
+            entry.obj = _buildProfileObject(c, currentOp, profileBufBuilder).getOwned();
+            if (!profileQueue.tryPush(entry))
+                profileDropped.increment();
+            return;
+        }
+
         try {
             Lock::DBWrite lk( currentOp.getNS() );
             if (dbHolder()._isLoaded(nsToDatabase(currentOp.getNS()), storageGlobalParams.dbpath)) {
@@ -151,6 +295,11 @@ namespace {
         }
     }
 
+    void startProfileWriter() {
+        ProfileWriter* writer = new ProfileWriter();
+        writer->go();
+    }
+
     NamespaceDetails* getOrCreateProfileCollection(Database *db, bool force, string* errmsg ) {
         fassert(16372, db);
         const char* profileName = db->getProfilingNS();
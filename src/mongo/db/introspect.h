@@ -43,6 +43,11 @@ namespace mongo {
 
     void profile(const Client& c, int op, CurOp& currentOp);
 
+    /**
+     * Starts the thread that writes the profile entries of operations run with profileAsync set.
+     */
+    void startProfileWriter();
+
     /**
      * Get (or create) the profile collection
      *
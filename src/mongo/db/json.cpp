@@ -41,8 +41,6 @@ namespace mongo {
         ID_RESERVE_SIZE = 64,
         PAT_RESERVE_SIZE = 4096,
         OPT_RESERVE_SIZE = 64,
-        FIELD_RESERVE_SIZE = 4096,
-        STRINGVAL_RESERVE_SIZE = 4096,
         BINDATA_RESERVE_SIZE = 4096,
         BINDATATYPE_RESERVE_SIZE = 4096,
         NS_RESERVE_SIZE = 64,
@@ -76,7 +74,23 @@ namespace mongo {
 
     Status JParse::value(const StringData& fieldName, BSONObjBuilder& builder) {
         MONGO_JSON_DEBUG("fieldName: " << fieldName);
-        if (peekToken(LBRACE)) {
+        // Strings and numbers come first, as they are most of the values in any document
+        if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
+            std::string scratch;
+            StringData valueString;
+            Status ret = quotedString(&valueString, &scratch);
+            if (ret != Status::OK()) {
+                return ret;
+            }
+            builder.append(fieldName, valueString);
+        }
+        else if (peekNumber()) {
+            Status ret = number(fieldName, builder);
+            if (ret != Status::OK()) {
+                return ret;
+            }
+        }
+        else if (peekToken(LBRACE)) {
             Status ret = object(fieldName, builder);
             if (ret != Status::OK()) {
                 return ret;
@@ -136,15 +150,6 @@ namespace mongo {
                 return ret;
             }
         }
-        else if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
-            std::string valueString;
-            valueString.reserve(STRINGVAL_RESERVE_SIZE);
-            Status ret = quotedString(&valueString);
-            if (ret != Status::OK()) {
-                return ret;
-            }
-            builder.append(fieldName, valueString);
-        }
         else if (readToken("true")) {
             builder.append(fieldName, true);
         }
@@ -191,9 +196,9 @@ namespace mongo {
         }
 
         // Special object
-        std::string firstField;
-        firstField.reserve(FIELD_RESERVE_SIZE);
-        Status ret = field(&firstField);
+        std::string firstFieldScratch;
+        StringData firstField;
+        Status ret = field(&firstField, &firstFieldScratch);
         if (ret != Status::OK()) {
             return ret;
         }
@@ -280,9 +285,9 @@ namespace mongo {
                 return valueRet;
             }
             while (readToken(COMMA)) {
-                std::string fieldName;
-                fieldName.reserve(FIELD_RESERVE_SIZE);
-                Status fieldRet = field(&fieldName);
+                std::string fieldNameScratch;
+                StringData fieldName;
+                Status fieldRet = field(&fieldName, &fieldNameScratch);
                 if (fieldRet != Status::OK()) {
                     return fieldRet;
                 }
@@ -799,6 +804,38 @@ namespace mongo {
     }
 
     Status JParse::number(const StringData& fieldName, BSONObjBuilder& builder) {
+        // Most numbers are short integers: read those without strtod and strtoll.  Anything
+        // else, including integers of more than 18 digits, goes the slow way.
+        const char* p = _input;
+        while (p < _input_end && isspace(*reinterpret_cast<const unsigned char*>(p))) {
+            ++p;
+        }
+        const bool negative = (p < _input_end && *p == '-');
+        if (negative) {
+            ++p;
+        }
+        const char* digits = p;
+        long long fast = 0;
+        while (p < _input_end && isdigit(*reinterpret_cast<const unsigned char*>(p)) &&
+               p - digits < 18) {
+            fast = fast * 10 + (*p - '0');
+            ++p;
+        }
+        if (p > digits && p < _input_end && !isdigit(*reinterpret_cast<const unsigned char*>(p)) &&
+            !match(*p, ".eExX")) {
+            if (negative) {
+                fast = -fast;
+            }
+            if (fast == static_cast<int>(fast)) {
+                builder.append(fieldName, static_cast<int>(fast));
+            }
+            else {
+                builder.append(fieldName, fast);
+            }
+            _input = p;
+            return Status::OK();
+        }
+
         char* endptrll;
         char* endptrd;
         long long retll;
@@ -841,11 +878,20 @@ namespace mongo {
     }
 
     Status JParse::field(std::string* result) {
+        StringData name;
+        Status ret = field(&name, result);
+        if (ret == Status::OK() && name.rawData() != result->data()) {
+            result->assign(name.rawData(), name.size());
+        }
+        return ret;
+    }
+
+    Status JParse::field(StringData* result, std::string* scratch) {
         MONGO_JSON_DEBUG("");
         if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
             // Quoted key
             // TODO: make sure quoted field names cannot contain null characters
-            return quotedString(result);
+            return quotedString(result, scratch);
         }
         else {
             // Unquoted key
@@ -862,14 +908,23 @@ namespace mongo {
             if (!match(*_input, ALPHA "_$")) {
                 return parseError("First character in field must be [A-Za-z$_]");
             }
-            return chars(result, "", ALPHA DIGIT "_$");
+            return chars(result, scratch, "", ALPHA DIGIT "_$");
         }
     }
 
     Status JParse::quotedString(std::string* result) {
+        StringData str;
+        Status ret = quotedString(&str, result);
+        if (ret == Status::OK() && str.rawData() != result->data()) {
+            result->assign(str.rawData(), str.size());
+        }
+        return ret;
+    }
+
+    Status JParse::quotedString(StringData* result, std::string* scratch) {
         MONGO_JSON_DEBUG("");
         if (readToken(DOUBLEQUOTE)) {
-            Status ret = chars(result, "\"");
+            Status ret = chars(result, scratch, "\"");
             if (ret != Status::OK()) {
                 return ret;
             }
@@ -878,7 +933,7 @@ namespace mongo {
             }
         }
         else if (readToken(SINGLEQUOTE)) {
-            Status ret = chars(result, "'");
+            Status ret = chars(result, scratch, "'");
             if (ret != Status::OK()) {
                 return ret;
             }
@@ -892,6 +947,46 @@ namespace mongo {
         return Status::OK();
     }
 
+    Status JParse::chars(StringData* result, std::string* scratch, const char* terminalSet,
+            const char* allowedSet) {
+        MONGO_JSON_DEBUG("terminalSet: " << terminalSet);
+        if (_input >= _input_end) {
+            return parseError("Unexpected end of input");
+        }
+        const char* q = _input;
+        if (allowedSet == NULL && terminalSet[0] != '\0' && terminalSet[1] == '\0') {
+            // A quoted string: skip the plain characters without looking them up in a set
+            const char quote = terminalSet[0];
+            while (q < _input_end && *q != quote && *q != '\\' &&
+                   static_cast<unsigned char>(*q) > 0x1F) {
+                ++q;
+            }
+        }
+        while (q < _input_end && !match(*q, terminalSet)) {
+            if (allowedSet != NULL && !match(*q, allowedSet)) {
+                break;
+            }
+            if (*q == '\\') {
+                // Unescape from here on into scratch
+                scratch->assign(_input, q - _input);
+                _input = q;
+                Status ret = chars(scratch, terminalSet, allowedSet);
+                *result = *scratch;
+                return ret;
+            }
+            if (0x00 <= *q && *q <= 0x1F) {
+                return parseError("Invalid control character");
+            }
+            ++q;
+        }
+        if (q < _input_end) {
+            *result = StringData(_input, q - _input);
+            _input = q;
+            return Status::OK();
+        }
+        return parseError("Unexpected end of input");
+    }
+
     /*
      * terminalSet are characters that signal end of string (e.g.) [ :\0]
      * allowedSet are the characters that are allowed, if this is set
@@ -1023,11 +1118,22 @@ namespace mongo {
         return true;
     }
 
+    bool JParse::peekNumber() const {
+        const char* check = _input;
+        while (check < _input_end && isspace(*reinterpret_cast<const unsigned char*>(check))) {
+            ++check;
+        }
+        if (check < _input_end && *check == '-') {
+            ++check;
+        }
+        return check < _input_end && isdigit(*reinterpret_cast<const unsigned char*>(check));
+    }
+
     bool JParse::readField(const StringData& expectedField) {
         MONGO_JSON_DEBUG("expectedField: " << expectedField);
-        std::string nextField;
-        nextField.reserve(FIELD_RESERVE_SIZE);
-        Status ret = field(&nextField);
+        std::string scratch;
+        StringData nextField;
+        Status ret = field(&nextField, &scratch);
         if (ret != Status::OK()) {
             return false;
         }
@@ -295,6 +295,12 @@ namespace mongo {
              */
             Status field(std::string* result);
 
+            /**
+             * Same as above, without copying the name out of the input unless it has escapes.
+             * 'result' then points either into the input or into 'scratch'.
+             */
+            Status field(StringData* result, std::string* scratch);
+
             /*
              * STRING :
              *     " "
@@ -303,6 +309,7 @@ namespace mongo {
              *   | ' CHARS '
              */
             Status quotedString(std::string* result);
+            Status quotedString(StringData* result, std::string* scratch);
 
             /*
              * CHARS :
@@ -340,6 +347,13 @@ namespace mongo {
              */
             Status chars(std::string* result, const char* terminalSet, const char* allowedSet=NULL);
 
+            /**
+             * Same as above, pointing 'result' into the input when there is nothing to unescape,
+             * and decoding into 'scratch' otherwise.
+             */
+            Status chars(StringData* result, std::string* scratch, const char* terminalSet,
+                         const char* allowedSet=NULL);
+
             /**
              * Converts the two byte Unicode code point to its UTF8 character
              * encoding representation.  This function returns a string because
@@ -372,6 +386,13 @@ namespace mongo {
              */
             bool readTokenImpl(const char* token, bool advance=true);
 
+            /**
+             * @return true if the next non whitespace sequence in our buffer is
+             * a decimal number: a digit, or a minus sign and a digit.  Does not
+             * update the pointer to our buffer.
+             */
+            bool peekNumber() const;
+
             /**
              * @return true if the next field in our stream matches field.
              * Handles single quoted, double quoted, and unquoted field names
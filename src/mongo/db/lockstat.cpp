@@ -64,7 +64,19 @@ namespace mongo {
 
             builder << ' ' << nameFor( i ) << ':' << timeLocked[i].load();
         }
-        
+
+        prefixPrinted = false;
+        for ( int i=0; i < N; i++ ) {
+            if ( timeAcquiring[i].load() == 0 )
+                continue;
+
+            if ( ! prefixPrinted ) {
+                builder << " acquireWait(micros)";
+                prefixPrinted = true;
+            }
+
+            builder << ' ' << nameFor( i ) << ':' << timeAcquiring[i].load();
+        }
     }
 
     void LockStat::_append( BSONObjBuilder& builder, const AtomicInt64* data ) {
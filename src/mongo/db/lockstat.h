@@ -50,6 +50,7 @@ namespace mongo {
         void report( StringBuilder& builder ) const;
 
         long long getTimeLocked( char type ) const { return timeLocked[mapNo(type)].load(); }
+        long long getTimeAcquiring( char type ) const { return timeAcquiring[mapNo(type)].load(); }
     private:
         static void _append( BSONObjBuilder& builder, const AtomicInt64* data );
         
@@ -36,6 +36,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/expression_where_native.h"
 #include "mongo/scripting/engine.h"
 
 namespace mongo {
@@ -75,6 +76,9 @@ namespace mongo {
 
         auto_ptr<Scope> _scope;
         ScriptingFunction _func;
+
+        // Set when the code is simple enough to evaluate without JavaScript.
+        scoped_ptr<WhereNativePredicate> _native;
     };
 
     Status WhereMatchExpression::init( const StringData& ns,
@@ -97,10 +101,15 @@ namespace mongo {
         _scope = globalScriptEngine->getPooledScope( nswrapper.db().toString(),
                                                      "where" + userToken );
         _func = _scope->createFunction( _code.c_str() );
+        _scope->setBoolean( "fullObject" , true ); // this is a hack b/c fullObject used to be relevant
 
         if ( !_func )
             return Status( ErrorCodes::BadValue, "$where compile error" );
 
+        // A scope can redefine anything the code refers to.
+        if ( _userScope.isEmpty() )
+            _native.reset( WhereNativePredicate::parse( _code ) );
+
         return Status::OK();
     }
 
@@ -108,11 +117,16 @@ namespace mongo {
         verify( _func );
         BSONObj obj = doc->toBSON();
 
+        if ( _native ) {
+            WhereNativePredicate::Result result = _native->evaluate( obj );
+            if ( result != WhereNativePredicate::Unknown )
+                return result == WhereNativePredicate::True;
+        }
+
         if ( ! _userScope.isEmpty() ) {
             _scope->init( &_userScope );
         }
         _scope->setObject( "obj", const_cast< BSONObj & >( obj ) );
-        _scope->setBoolean( "fullObject" , true ); // this is a hack b/c fullObject used to be relevant
 
         int err = _scope->invoke( _func, 0, &obj, 1000 * 60, false );
         if ( err == -3 ) { // INVOKE_ERROR
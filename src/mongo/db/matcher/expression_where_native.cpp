@@ -0,0 +1,428 @@
+// expression_where_native.cpp
+
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+#include "mongo/db/matcher/expression_where_native.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace mongo {
+
+namespace {
+
+    bool isIdentifierStart( char c ) {
+        return isalpha( static_cast<unsigned char>( c ) ) || c == '_' || c == '$';
+    }
+
+    bool isIdentifierChar( char c ) {
+        return isIdentifierStart( c ) || isdigit( static_cast<unsigned char>( c ) );
+    }
+
+    // Properties every JavaScript object has, whatever the document holds.  Also rejected are
+    // names starting with '_', which the BSON wrapper objects use for their own properties.
+    const char* const inheritedProperties[] = {
+        "constructor", "hasOwnProperty", "isPrototypeOf", "propertyIsEnumerable",
+        "toLocaleString", "toString", "valueOf", "tojson", "toSource", "watch", "unwatch"
+    };
+
+    bool isInheritedProperty( const std::string& name ) {
+        if ( name[0] == '_' )
+            return true;
+        for ( size_t i = 0; i < sizeof( inheritedProperties ) / sizeof( inheritedProperties[0] );
+              ++i ) {
+            if ( name == inheritedProperties[i] )
+                return true;
+        }
+        return false;
+    }
+
+    bool isAscii( const StringData& s ) {
+        for ( size_t i = 0; i < s.size(); ++i ) {
+            if ( static_cast<unsigned char>( s[i] ) >= 0x80 )
+                return false;
+        }
+        return true;
+    }
+
+    // How a BSON value looks to a $where function, as far as comparisons go.
+    enum JsKind { JS_UNDEFINED, JS_NULL, JS_BOOLEAN, JS_NUMBER, JS_STRING, JS_OTHER };
+
+    JsKind jsKind( const BSONElement& e ) {
+        switch ( e.type() ) {
+        case EOO:
+        case Undefined:
+            return JS_UNDEFINED;
+        case jstNULL:
+            return JS_NULL;
+        case Bool:
+            return JS_BOOLEAN;
+        case NumberInt:
+        case NumberDouble:
+            return JS_NUMBER;
+        case String:
+            return JS_STRING;
+        default:
+            // NumberLong is an object in the shell's JavaScript, and so are dates, arrays...
+            return JS_OTHER;
+        }
+    }
+
+}  // namespace
+
+    /**
+     * Recursive descent over the few forms WhereNativePredicate takes.  Anything else, including
+     * comments, escapes in strings and line breaks that JavaScript's semicolon insertion could
+     * act on, fails to parse.
+     */
+    class WhereNativeParser {
+    public:
+        explicit WhereNativeParser( const StringData& code ) : _code( code ), _pos( 0 ) {}
+
+        bool parse( WhereNativePredicate* out ) {
+            if ( keyword( "function" ) ) {
+                std::string name;
+                identifier( &name ); // optional
+                if ( !punct( "(" ) || !punct( ")" ) || !punct( "{" ) || !keyword( "return" ) )
+                    return false;
+                if ( lineBreakAhead() || !conjunction( &out->_comparisons ) )
+                    return false;
+                punct( ";" );
+                if ( !punct( "}" ) )
+                    return false;
+                punct( ";" );
+                return atEnd();
+            }
+
+            // The body of a function that the engine wraps around it, adding "return" when the
+            // code has no ';' but a trailing one and fits on a line.
+            if ( _code.find( '\n' ) != string::npos || _code.find( '\r' ) != string::npos )
+                return false;
+            keyword( "return" );
+            if ( !conjunction( &out->_comparisons ) )
+                return false;
+            punct( ";" );
+            return atEnd();
+        }
+
+    private:
+        void skipSpace() {
+            while ( _pos < _code.size() && isspace( static_cast<unsigned char>( _code[_pos] ) ) )
+                ++_pos;
+        }
+
+        bool atEnd() {
+            skipSpace();
+            return _pos == _code.size();
+        }
+
+        bool lineBreakAhead() const {
+            for ( size_t i = _pos; i < _code.size(); ++i ) {
+                if ( _code[i] == '\n' || _code[i] == '\r' )
+                    return true;
+                if ( !isspace( static_cast<unsigned char>( _code[i] ) ) )
+                    return false;
+            }
+            return false;
+        }
+
+        bool startsWithHere( const char* token ) {
+            skipSpace();
+            return _code.substr( _pos ).startsWith( token );
+        }
+
+        bool punct( const char* token ) {
+            if ( !startsWithHere( token ) )
+                return false;
+            _pos += strlen( token );
+            return true;
+        }
+
+        bool keyword( const char* word ) {
+            if ( !startsWithHere( word ) )
+                return false;
+            const size_t end = _pos + strlen( word );
+            if ( end < _code.size() && isIdentifierChar( _code[end] ) )
+                return false;
+            _pos = end;
+            return true;
+        }
+
+        bool identifier( std::string* out ) {
+            skipSpace();
+            if ( _pos == _code.size() || !isIdentifierStart( _code[_pos] ) )
+                return false;
+            const size_t start = _pos;
+            while ( _pos < _code.size() && isIdentifierChar( _code[_pos] ) )
+                ++_pos;
+            *out = _code.substr( start, _pos - start ).toString();
+            return true;
+        }
+
+        bool number( WhereNativePredicate::Operand* out ) {
+            skipSpace();
+            size_t p = _pos;
+            const bool negative = p < _code.size() && _code[p] == '-';
+            if ( negative ) {
+                ++p;
+                while ( p < _code.size() && isspace( static_cast<unsigned char>( _code[p] ) ) )
+                    ++p;
+            }
+
+            const size_t start = p;
+            while ( p < _code.size() && ( isdigit( static_cast<unsigned char>( _code[p] ) ) ||
+                                          _code[p] == '.' ) )
+                ++p;
+            if ( p < _code.size() && ( _code[p] == 'e' || _code[p] == 'E' ) ) {
+                ++p;
+                if ( p < _code.size() && ( _code[p] == '+' || _code[p] == '-' ) )
+                    ++p;
+                while ( p < _code.size() && isdigit( static_cast<unsigned char>( _code[p] ) ) )
+                    ++p;
+            }
+            if ( p == start || ( p < _code.size() && isIdentifierChar( _code[p] ) ) )
+                return false;
+
+            const std::string text = _code.substr( start, p - start ).toString();
+            // No octal literals ("012").
+            if ( text.size() > 1 && text[0] == '0' && isdigit( static_cast<unsigned char>( text[1] ) ) )
+                return false;
+
+            char* end;
+            const double value = strtod( text.c_str(), &end );
+            if ( *end != '\0' )
+                return false;
+
+            out->literal = BSON( "" << ( negative ? -value : value ) );
+            _pos = p;
+            return true;
+        }
+
+        bool stringLiteral( WhereNativePredicate::Operand* out ) {
+            skipSpace();
+            if ( _pos == _code.size() || ( _code[_pos] != '\'' && _code[_pos] != '"' ) )
+                return false;
+            const char quote = _code[_pos];
+            const size_t start = _pos + 1;
+            size_t p = start;
+            while ( p < _code.size() && _code[p] != quote ) {
+                if ( _code[p] == '\\' || _code[p] == '\n' || _code[p] == '\r' )
+                    return false;
+                ++p;
+            }
+            if ( p == _code.size() )
+                return false;
+
+            out->literal = BSON( "" << _code.substr( start, p - start ) );
+            _pos = p + 1;
+            return true;
+        }
+
+        bool operand( WhereNativePredicate::Operand* out ) {
+            if ( keyword( "this" ) || keyword( "obj" ) ) {
+                if ( !punct( "." ) || !identifier( &out->field ) ||
+                     isInheritedProperty( out->field ) )
+                    return false;
+                // No "this.a.b" or "this.a()", whose failures JavaScript reports.
+                if ( startsWithHere( "." ) || startsWithHere( "(" ) || startsWithHere( "[" ) )
+                    return false;
+                out->isField = true;
+                return true;
+            }
+            if ( keyword( "true" ) ) {
+                out->literal = BSON( "" << true );
+                return true;
+            }
+            if ( keyword( "false" ) ) {
+                out->literal = BSON( "" << false );
+                return true;
+            }
+            if ( keyword( "null" ) ) {
+                BSONObjBuilder b;
+                b.appendNull( "" );
+                out->literal = b.obj();
+                return true;
+            }
+            return number( out ) || stringLiteral( out );
+        }
+
+        bool comparisonOp( WhereNativePredicate::Op* op ) {
+            // longest first
+            if ( punct( "===" ) ) { *op = WhereNativePredicate::STRICT_EQ; return true; }
+            if ( punct( "!==" ) ) { *op = WhereNativePredicate::STRICT_NE; return true; }
+            if ( punct( "==" ) ) { *op = WhereNativePredicate::EQ; return true; }
+            if ( punct( "!=" ) ) { *op = WhereNativePredicate::NE; return true; }
+            if ( punct( "<=" ) ) { *op = WhereNativePredicate::LTE; return true; }
+            if ( punct( ">=" ) ) { *op = WhereNativePredicate::GTE; return true; }
+            if ( punct( "<" ) ) { *op = WhereNativePredicate::LT; return true; }
+            if ( punct( ">" ) ) { *op = WhereNativePredicate::GT; return true; }
+            return false;
+        }
+
+        bool comparison( WhereNativePredicate::Comparison* out ) {
+            if ( punct( "(" ) ) {
+                return comparison( out ) && punct( ")" );
+            }
+            return operand( &out->lhs ) && comparisonOp( &out->op ) && operand( &out->rhs ) &&
+                ( out->lhs.isField || out->rhs.isField );
+        }
+
+        bool conjunction( std::vector<WhereNativePredicate::Comparison>* out ) {
+            do {
+                out->push_back( WhereNativePredicate::Comparison() );
+                if ( !comparison( &out->back() ) )
+                    return false;
+            } while ( punct( "&&" ) );
+            return true;
+        }
+
+        StringData _code;
+        size_t _pos;
+    };
+
+    WhereNativePredicate* WhereNativePredicate::parse( const StringData& code ) {
+        std::auto_ptr<WhereNativePredicate> predicate( new WhereNativePredicate() );
+        WhereNativeParser parser( code );
+        if ( !parser.parse( predicate.get() ) )
+            return NULL;
+        return predicate.release();
+    }
+
+    WhereNativePredicate::Result WhereNativePredicate::evaluate( const BSONObj& doc ) const {
+        Result result = True;
+        for ( std::vector<Comparison>::const_iterator it = _comparisons.begin();
+              it != _comparisons.end(); ++it ) {
+            const BSONElement lhs =
+                it->lhs.isField ? doc[it->lhs.field] : it->lhs.literal.firstElement();
+            const BSONElement rhs =
+                it->rhs.isField ? doc[it->rhs.field] : it->rhs.literal.firstElement();
+
+            // && stops at the first false; without side effects, an earlier Unknown can't
+            // change that.
+            const Result r = compare( it->op, lhs, rhs );
+            if ( r == False )
+                return False;
+            if ( r == Unknown )
+                result = Unknown;
+        }
+        return result;
+    }
+
+    WhereNativePredicate::Result WhereNativePredicate::compare( Op op,
+                                                                 const BSONElement& lhs,
+                                                                 const BSONElement& rhs ) {
+        const JsKind l = jsKind( lhs );
+        const JsKind r = jsKind( rhs );
+        if ( l == JS_OTHER || r == JS_OTHER )
+            return Unknown;
+
+        switch ( op ) {
+        case EQ:
+        case NE:
+        case STRICT_EQ:
+        case STRICT_NE: {
+            const bool strict = ( op == STRICT_EQ || op == STRICT_NE );
+            const bool negate = ( op == NE || op == STRICT_NE );
+            bool equal;
+            if ( l != r ) {
+                const bool lNullish = ( l == JS_UNDEFINED || l == JS_NULL );
+                const bool rNullish = ( r == JS_UNDEFINED || r == JS_NULL );
+                if ( strict || lNullish || rNullish ) {
+                    // null == undefined, and neither equals anything else
+                    equal = !strict && lNullish && rNullish;
+                }
+                else {
+                    // "5" == 5, true == 1: left to JavaScript's conversions
+                    return Unknown;
+                }
+            }
+            else if ( l == JS_UNDEFINED || l == JS_NULL ) {
+                equal = true;
+            }
+            else if ( l == JS_BOOLEAN ) {
+                equal = lhs.boolean() == rhs.boolean();
+            }
+            else if ( l == JS_NUMBER ) {
+                equal = lhs.number() == rhs.number(); // false for NaN, as in JavaScript
+            }
+            else {
+                const StringData ls( lhs.valuestr(), lhs.valuestrsize() - 1 );
+                const StringData rs( rhs.valuestr(), rhs.valuestrsize() - 1 );
+                if ( ls == rs ) {
+                    equal = true;
+                }
+                else if ( isAscii( ls ) && isAscii( rs ) ) {
+                    equal = false;
+                }
+                else {
+                    // bad UTF-8 can decode to equal JavaScript strings
+                    return Unknown;
+                }
+            }
+            return ( equal != negate ) ? True : False;
+        }
+        case LT:
+        case LTE:
+        case GT:
+        case GTE: {
+            int cmp;
+            if ( l == JS_NUMBER && r == JS_NUMBER ) {
+                const double a = lhs.number();
+                const double b = rhs.number();
+                if ( a != a || b != b )
+                    return False; // NaN compares false either way
+                cmp = a < b ? -1 : ( a > b ? 1 : 0 );
+            }
+            else if ( l == JS_STRING && r == JS_STRING ) {
+                const StringData ls( lhs.valuestr(), lhs.valuestrsize() - 1 );
+                const StringData rs( rhs.valuestr(), rhs.valuestrsize() - 1 );
+                // ASCII orders the same by bytes as by JavaScript's UTF-16 code units
+                if ( !isAscii( ls ) || !isAscii( rs ) )
+                    return Unknown;
+                cmp = ls.compare( rs );
+            }
+            else {
+                return Unknown;
+            }
+
+            bool holds;
+            switch ( op ) {
+            case LT: holds = cmp < 0; break;
+            case LTE: holds = cmp <= 0; break;
+            case GT: holds = cmp > 0; break;
+            default: holds = cmp >= 0; break;
+            }
+            return holds ? True : False;
+        }
+        }
+        return Unknown;
+    }
+
+}  // namespace mongo
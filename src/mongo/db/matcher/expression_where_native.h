@@ -0,0 +1,93 @@
+// expression_where_native.h
+
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * A $where function simple enough to evaluate without JavaScript: a comparison, or a chain of
+     * comparisons joined by &&, between top level fields of the document ("this.a" or "obj.a")
+     * and number, string, boolean or null literals.  For example "this.a > this.b", or
+     * "function() { return this.x == 5 && this.y != 'z'; }".
+     *
+     * The values compared must be ones whose JavaScript comparison is plain (numbers with
+     * numbers, ASCII strings with strings, and equality with null, missing fields and booleans);
+     * for any others evaluate() says Unknown, and the caller runs the function in JavaScript.
+     */
+    class WhereNativePredicate {
+        MONGO_DISALLOW_COPYING(WhereNativePredicate);
+    public:
+        enum Result { False, True, Unknown };
+
+        /**
+         * @return the predicate 'code' is, or NULL if it isn't one this class can evaluate.
+         *         Owned by the caller.
+         */
+        static WhereNativePredicate* parse( const StringData& code );
+
+        /**
+         * @return what the function returns for 'doc' as 'this', or Unknown if the values it
+         *         compares need JavaScript's type conversions.
+         */
+        Result evaluate( const BSONObj& doc ) const;
+
+    private:
+        enum Op { EQ, NE, STRICT_EQ, STRICT_NE, LT, LTE, GT, GTE };
+
+        struct Operand {
+            Operand() : isField( false ) {}
+            bool isField;
+            std::string field;
+            BSONObj literal; // holds the literal as its only element
+        };
+
+        struct Comparison {
+            Operand lhs;
+            Op op;
+            Operand rhs;
+        };
+
+        WhereNativePredicate() {}
+
+        static Result compare( Op op, const BSONElement& lhs, const BSONElement& rhs );
+
+        std::vector<Comparison> _comparisons;
+
+        friend class WhereNativeParser;
+    };
+
+}  // namespace mongo
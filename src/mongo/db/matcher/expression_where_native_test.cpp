@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/** Unit tests for WhereNativePredicate, in expression_where_native.{h,cpp}. */
+
+#include "mongo/unittest/unittest.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <limits>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_where_native.h"
+
+namespace mongo {
+
+    namespace {
+        WhereNativePredicate::Result evaluate( const char* code, const char* doc ) {
+            boost::scoped_ptr<WhereNativePredicate> predicate( WhereNativePredicate::parse( code ) );
+            ASSERT( predicate );
+            return predicate->evaluate( fromjson( doc ) );
+        }
+
+        bool parses( const char* code ) {
+            boost::scoped_ptr<WhereNativePredicate> predicate( WhereNativePredicate::parse( code ) );
+            return predicate.get() != NULL;
+        }
+    }
+
+    TEST( WhereNativePredicate, ParsesSimpleForms ) {
+        ASSERT( parses( "this.a > this.b" ) );
+        ASSERT( parses( "this.a == 5;" ) );
+        ASSERT( parses( "return obj.a == 'x'" ) );
+        ASSERT( parses( "function() { return this.x == 5 && this.y != \"z\"; }" ) );
+        ASSERT( parses( "function f(){return (this.a<=-1.5e3)}" ) );
+        ASSERT( parses( "function() {\n    return this.a === null;\n}" ) );
+        ASSERT( parses( "this.$a === true && false !== this.b" ) );
+    }
+
+    TEST( WhereNativePredicate, RejectsOtherCode ) {
+        ASSERT( !parses( "" ) );
+        ASSERT( !parses( "5 == 5" ) );
+        ASSERT( !parses( "this.a.b == 1" ) );
+        ASSERT( !parses( "this.a() == 1" ) );
+        ASSERT( !parses( "this['a'] == 1" ) );
+        ASSERT( !parses( "this.a == 1 || this.b == 2" ) );
+        ASSERT( !parses( "this.a + 1 == 2" ) );
+        ASSERT( !parses( "this.a == x" ) );
+        ASSERT( !parses( "this.a == 010" ) );
+        ASSERT( !parses( "this.a == 0x10" ) );
+        ASSERT( !parses( "this.a == 'it\\'s'" ) );
+        ASSERT( !parses( "this.a == 1; this.b == 2" ) );
+        ASSERT( !parses( "this.constructor == 1" ) );
+        ASSERT( !parses( "this._id == 1" ) );
+        ASSERT( !parses( "this.a /* c */ == 1" ) );
+        // Two lines aren't wrapped in a function that returns them.
+        ASSERT( !parses( "this.a ==\n1" ) );
+        // "return" followed by a line break returns undefined.
+        ASSERT( !parses( "function() { return\nthis.a == 1 }" ) );
+        ASSERT( !parses( "function(x) { return this.a == 1 }" ) );
+        ASSERT( !parses( "function() { return this.a == 1 } foo" ) );
+        ASSERT( !parses( "functional.a == 1" ) );
+    }
+
+    TEST( WhereNativePredicate, Numbers ) {
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a > this.b", "{a:2,b:1}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, evaluate( "this.a > this.b", "{a:1,b:1}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a >= this.b", "{a:1,b:1.0}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a == 5", "{a:5.0}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a === -2.5", "{a:-2.5}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "3 < this.a", "{a:4}" ) );
+    }
+
+    TEST( WhereNativePredicate, NaN ) {
+        BSONObj doc = BSON( "a" << std::numeric_limits<double>::quiet_NaN() );
+        boost::scoped_ptr<WhereNativePredicate> lt( WhereNativePredicate::parse( "this.a < 1" ) );
+        boost::scoped_ptr<WhereNativePredicate> ge( WhereNativePredicate::parse( "this.a >= 1" ) );
+        boost::scoped_ptr<WhereNativePredicate> ne( WhereNativePredicate::parse( "this.a != this.a" ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, lt->evaluate( doc ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, ge->evaluate( doc ) );
+        ASSERT_EQUALS( WhereNativePredicate::True, ne->evaluate( doc ) );
+    }
+
+    TEST( WhereNativePredicate, Strings ) {
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a == 'abc'", "{a:'abc'}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, evaluate( "this.a == 'abc'", "{a:'abd'}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a < this.b", "{a:'B',b:'a'}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::Unknown,
+                       evaluate( "this.a < this.b", "{a:'\\u00e9',b:'a'}" ) );
+    }
+
+    TEST( WhereNativePredicate, NullAndMissing ) {
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a == null", "{}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, evaluate( "this.a === null", "{}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a === null", "{a:null}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, evaluate( "this.a == null", "{a:0}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( "this.a != null", "{a:false}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, evaluate( "this.a == this.b", "{a:1}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::Unknown, evaluate( "this.a < 1", "{}" ) );
+    }
+
+    TEST( WhereNativePredicate, LeavesConversionsToJavaScript ) {
+        ASSERT_EQUALS( WhereNativePredicate::Unknown, evaluate( "this.a == 5", "{a:'5'}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::Unknown, evaluate( "this.a == 1", "{a:true}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, evaluate( "this.a === 1", "{a:true}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::Unknown,
+                       evaluate( "this.a == 5", "{a:{$numberLong:'5'}}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::Unknown, evaluate( "this.a == 5", "{a:[5]}" ) );
+    }
+
+    TEST( WhereNativePredicate, Conjunction ) {
+        const char* code = "this.a == 1 && this.b == 2";
+        ASSERT_EQUALS( WhereNativePredicate::True, evaluate( code, "{a:1,b:2}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::False, evaluate( code, "{a:'x',b:3}" ) );
+        ASSERT_EQUALS( WhereNativePredicate::Unknown, evaluate( code, "{a:'1',b:2}" ) );
+    }
+
+}  // namespace mongo
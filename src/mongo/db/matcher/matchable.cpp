@@ -38,7 +38,7 @@ namespace mongo {
     }
 
     BSONMatchableDocument::BSONMatchableDocument( const BSONObj& obj )
-        : _obj( obj ) {
+        : _obj( obj ), _fields( obj ) {
         _iteratorUsed = false;
     }
 
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include "mongo/bson/bson_field_index.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/matcher/path.h"
@@ -80,9 +81,9 @@ namespace mongo {
 
         virtual ElementIterator* allocateIterator( const ElementPath* path ) const {
             if ( _iteratorUsed )
-                return new BSONElementIterator( path, _obj );
+                return new BSONElementIterator( path, &_fields );
             _iteratorUsed = true;
-            _iterator.reset( path, _obj );
+            _iterator.reset( path, &_fields );
             return &_iterator;
         }
 
@@ -97,6 +98,8 @@ namespace mongo {
 
     private:
         BSONObj _obj;
+        // Shared by the iterators of every predicate matched against _obj.
+        BSONFieldIndex _fields;
         mutable BSONElementIterator _iterator;
         mutable bool _iteratorUsed;
     };
@@ -87,31 +87,54 @@ namespace mongo {
     // ------
     BSONElementIterator::BSONElementIterator() {
         _path = NULL;
+        _fields = NULL;
     }
 
     BSONElementIterator::BSONElementIterator( const ElementPath* path, const BSONObj& context )
-        : _path( path ), _context( context ) {
+        : _path( path ), _pathStart( 0 ), _context( context ), _fields( NULL ) {
         _state = BEGIN;
         //log() << "path: " << path.fieldRef().dottedField() << " context: " << context << endl;
     }
 
+    BSONElementIterator::BSONElementIterator( const ElementPath* path,
+                                              const BSONFieldIndex* fields )
+        : _path( path ), _pathStart( 0 ), _context( fields->obj() ), _fields( fields ) {
+        _state = BEGIN;
+    }
+
+    BSONElementIterator::BSONElementIterator( const ElementPath* path,
+                                              size_t pathStart,
+                                              const BSONObj& context )
+        : _path( path ), _pathStart( pathStart ), _context( context ), _fields( NULL ) {
+        _state = BEGIN;
+    }
+
     BSONElementIterator::~BSONElementIterator() {
     }
 
     void BSONElementIterator::reset( const ElementPath* path, const BSONObj& context ) {
         _path = path;
+        _pathStart = 0;
         _context = context;
+        _fields = NULL;
         _state = BEGIN;
         _next.reset();
 
         _subCursor.reset();
-        _subCursorPath.reset();
+    }
+
+    void BSONElementIterator::reset( const ElementPath* path, const BSONFieldIndex* fields ) {
+        reset( path, fields->obj() );
+        _fields = fields;
     }
 
 
-    void BSONElementIterator::ArrayIterationState::reset( const FieldRef& ref, int start ) {
-        restOfPath = ref.dottedField( start ).toString();
-        hasMore = restOfPath.size() > 0;
+    void BSONElementIterator::ArrayIterationState::reset( const FieldRef& ref, size_t start ) {
+        restStart = start;
+        numParts = ref.numParts();
+        // The rest of the path is empty if there are no parts left, or if all that's left is an
+        // empty trailing part.
+        hasMore = start < numParts && !( start + 1 == numParts && ref.getPart( start ).empty() );
         if ( hasMore ) {
             nextPieceOfPath = ref.getPart( start );
             nextPieceOfPathIsNumber = isAllDigits( nextPieceOfPath );
@@ -158,10 +181,9 @@ namespace mongo {
                     return true;
                 }
 
-                _subCursorPath.reset( new ElementPath() );
-                _subCursorPath->init( _arrayIterationState.restOfPath.substr( _arrayIterationState.nextPieceOfPath.size() + 1 ) );
-                _subCursorPath->setTraverseLeafArray( _path->shouldTraverseLeafArray() );
-                _subCursor.reset( new BSONElementIterator( _subCursorPath.get(), _arrayIterationState._current.Obj() ) );
+                _subCursor.reset( new BSONElementIterator( _path,
+                                                           _arrayIterationState.restStart + 1,
+                                                           _arrayIterationState._current.Obj() ) );
                 _arrayIterationState._current = BSONElement();
                 return more();
             }
@@ -177,7 +199,9 @@ namespace mongo {
 
         if ( _state == BEGIN ) {
             size_t idxPath = 0;
-            BSONElement e = getFieldDottedOrArray( _context, _path->fieldRef(), &idxPath );
+            BSONElement e = _fields ?
+                getFieldDottedOrArray( *_fields, _path->fieldRef(), &idxPath ) :
+                getFieldDottedOrArray( _context, _path->fieldRef(), _pathStart, &idxPath );
 
             if ( e.type() != Array ) {
                 _next.reset( e, BSONElement(), false );
@@ -213,11 +237,9 @@ namespace mongo {
                 // i have deeper to go
 
                 if ( x.type() == Object ) {
-                    _subCursorPath.reset( new ElementPath() );
-                    _subCursorPath->init( _arrayIterationState.restOfPath );
-                    _subCursorPath->setTraverseLeafArray( _path->shouldTraverseLeafArray() );
-
-                    _subCursor.reset( new BSONElementIterator( _subCursorPath.get(), x.Obj() ) );
+                    _subCursor.reset( new BSONElementIterator( _path,
+                                                               _arrayIterationState.restStart,
+                                                               x.Obj() ) );
                     return more();
                 }
 
@@ -230,12 +252,12 @@ namespace mongo {
                     }
 
                     if ( x.isABSONObj() ) {
-                        _subCursorPath.reset( new ElementPath() );
-                        _subCursorPath->init( _arrayIterationState.restOfPath.substr( _arrayIterationState.nextPieceOfPath.size() + 1 ) );
-                        _subCursorPath->setTraverseLeafArray( _path->shouldTraverseLeafArray() );
-                        BSONElementIterator* real = new BSONElementIterator( _subCursorPath.get(), _arrayIterationState._current.Obj() );
+                        const size_t subStart = _arrayIterationState.restStart + 1;
+                        BSONElementIterator* real =
+                            new BSONElementIterator( _path, subStart,
+                                                     _arrayIterationState._current.Obj() );
                         _subCursor.reset( real );
-                        real->_arrayIterationState.reset( _subCursorPath->fieldRef(), 0 );
+                        real->_arrayIterationState.reset( _path->fieldRef(), subStart );
                         real->_arrayIterationState.startIterator( x );
                         real->_state = IN_ARRAY;
                         _arrayIterationState._current = BSONElement();
@@ -40,6 +40,8 @@
 
 namespace mongo {
 
+    class BSONFieldIndex;
+
     class ElementPath {
     public:
         Status init( const StringData& path );
@@ -113,37 +115,57 @@ namespace mongo {
         BSONObjIterator _iterator;
     };
 
+    /**
+     * Iterates over the elements of a document that a path may refer to, descending into
+     * arrays and the documents in them.
+     *
+     * The iterators we use to descend share the path of their parent and start further along it,
+     * so that no path is split or copied while matching a document.
+     */
     class BSONElementIterator : public ElementIterator {
     public:
         BSONElementIterator();
         BSONElementIterator( const ElementPath* path, const BSONObj& context );
 
+        // Looks up the first part of 'path' in 'fields', which must outlive the iterator.
+        BSONElementIterator( const ElementPath* path, const BSONFieldIndex* fields );
+
         virtual ~BSONElementIterator();
 
         void reset( const ElementPath* path, const BSONObj& context );
+        void reset( const ElementPath* path, const BSONFieldIndex* fields );
 
         bool more();
         Context next();
 
     private:
+        // Iterates over what the parts of 'path' from 'pathStart' on refer to in 'context'.
+        BSONElementIterator( const ElementPath* path, size_t pathStart, const BSONObj& context );
+
         const ElementPath* _path;
+        // The first part of _path that this iterator resolves.
+        size_t _pathStart;
         BSONObj _context;
+        // When set, the index of _context's fields.  Only for iterators starting at the root.
+        const BSONFieldIndex* _fields;
 
         enum State { BEGIN, IN_ARRAY, DONE } _state;
         Context _next;
 
         struct ArrayIterationState {
 
-            void reset( const FieldRef& ref, int start );
+            void reset( const FieldRef& ref, size_t start );
             void startIterator( BSONElement theArray );
 
             bool more();
             BSONElement next();
 
             bool isArrayOffsetMatch( const StringData& fieldName ) const;
-            bool nextEntireRest() const { return nextPieceOfPath.size() == restOfPath.size(); }
+            bool nextEntireRest() const { return restStart + 1 == numParts; }
 
-            string restOfPath;
+            // The rest of the path is made of the parts from 'restStart' to 'numParts' - 1.
+            size_t restStart;
+            size_t numParts;
             bool hasMore;
             StringData nextPieceOfPath;
             bool nextPieceOfPathIsNumber;
@@ -156,7 +178,6 @@ namespace mongo {
         ArrayIterationState _arrayIterationState;
 
         boost::scoped_ptr<ElementIterator> _subCursor;
-        boost::scoped_ptr<ElementPath> _subCursorPath;
     };
 
 }
@@ -43,14 +43,23 @@ namespace mongo {
     BSONElement getFieldDottedOrArray( const BSONObj& doc,
                                        const FieldRef& path,
                                        size_t* idxPath ) {
-        if ( path.numParts() == 0 )
+        return getFieldDottedOrArray( doc, path, 0, idxPath );
+    }
+
+    BSONElement getFieldDottedOrArray( const BSONObj& doc,
+                                       const FieldRef& path,
+                                       size_t startPart,
+                                       size_t* idxPath ) {
+        if ( path.numParts() <= startPart ) {
+            *idxPath = startPart;
             return doc.getField( "" );
+        }
 
         BSONElement res;
 
         BSONObj curr = doc;
         bool stop = false;
-        size_t partNum = 0;
+        size_t partNum = startPart;
         while ( partNum < path.numParts() && !stop ) {
 
             res = curr.getField( path.getPart( partNum ) );
@@ -83,5 +92,28 @@ namespace mongo {
         return res;
     }
 
+    BSONElement getFieldDottedOrArray( const BSONFieldIndex& fields,
+                                       const FieldRef& path,
+                                       size_t* idxPath ) {
+        if ( path.numParts() == 0 ) {
+            *idxPath = 0;
+            return fields.getField( "" );
+        }
+
+        BSONElement res = fields.getField( path.getPart( 0 ) );
+        if ( res.type() == Object && path.numParts() > 1 )
+            return getFieldDottedOrArray( res.Obj(), path, 1, idxPath );
+
+        if ( res.type() == Object ) {
+            *idxPath = 1;
+            return res;
+        }
+
+        *idxPath = 0;
+        if ( res.type() != EOO && res.type() != Array && path.numParts() > 1 )
+            return BSONElement();
+        return res;
+    }
+
 
 }  // namespace mongo
@@ -31,6 +31,7 @@
 #pragma once
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bson_field_index.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/cstdint.h"
@@ -45,4 +46,16 @@ namespace mongo {
                                        const FieldRef& path,
                                        size_t* idxPath );
 
+    // Same as above, but only considers the parts of 'path' from 'startPart' on, as if 'path'
+    // was the dotted field made of those parts.
+    BSONElement getFieldDottedOrArray( const BSONObj& doc,
+                                       const FieldRef& path,
+                                       size_t startPart,
+                                       size_t* idxPath );
+
+    // Same as the first version, with the first part of 'path' looked up in 'fields'.
+    BSONElement getFieldDottedOrArray( const BSONFieldIndex& fields,
+                                       const FieldRef& path,
+                                       size_t* idxPath );
+
 }  // namespace mongo
@@ -32,6 +32,8 @@
 #include "mongo/unittest/unittest.h"
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/bson/bson_field_index.h"
 #include "mongo/db/matcher/path.h"
 
 namespace mongo {
@@ -260,6 +262,61 @@ namespace mongo {
         ASSERT( !cursor.more() );
     }
 
+    TEST( Path, NestedArraysDeepPath ) {
+        ElementPath p;
+        ASSERT( p.init( "a.b.c" ).isOK() );
+        p.setTraverseLeafArray( false );
+
+        BSONObj doc = fromjson( "{a: [{b: [{c: 1}, {c: 2}]}, {b: {c: 3}}, {b: [{d: 1}]}]}" );
+
+        BSONElementIterator cursor( &p, doc );
+
+        ASSERT( cursor.more() );
+        ASSERT_EQUALS( 1, cursor.next().element().numberInt() );
+        ASSERT( cursor.more() );
+        ASSERT_EQUALS( 2, cursor.next().element().numberInt() );
+        ASSERT( cursor.more() );
+        ASSERT_EQUALS( 3, cursor.next().element().numberInt() );
+        ASSERT( cursor.more() );
+        ASSERT( cursor.next().element().eoo() );
+        ASSERT( !cursor.more() );
+
+        // The iterator can be reset to another path and document.
+        ElementPath q;
+        ASSERT( q.init( "x.y" ).isOK() );
+        cursor.reset( &q, fromjson( "{x: [{y: 7}]}" ) );
+        ASSERT( cursor.more() );
+        ASSERT_EQUALS( 7, cursor.next().element().numberInt() );
+        ASSERT( !cursor.more() );
+    }
+
+    TEST( Path, FieldIndexMatchesDocument ) {
+        BSONObjBuilder b;
+        for ( int i = 0; i < 50; i++ )
+            b.append( std::string( mongoutils::str::stream() << "f" << i ), i );
+        b.appendElements( fromjson( "{a: [{b: 1}, {b: 2}], x: {y: {z: 3}}, s: 4}" ) );
+        BSONObj doc = b.obj();
+        BSONFieldIndex fields( doc );
+
+        const char* paths[] = { "a.b", "a", "x.y.z", "x.y", "x.q", "s", "s.t", "f49", "nope.q" };
+        for ( size_t i = 0; i < sizeof( paths ) / sizeof( paths[0] ); i++ ) {
+            ElementPath p;
+            ASSERT( p.init( paths[i] ).isOK() );
+
+            BSONElementIterator plain( &p, doc );
+            BSONElementIterator indexed( &p, &fields );
+            while ( plain.more() ) {
+                ASSERT( indexed.more() );
+                ElementIterator::Context x = plain.next();
+                ElementIterator::Context y = indexed.next();
+                ASSERT_EQUALS( x.element(), y.element() );
+                ASSERT_EQUALS( x.outerArray(), y.outerArray() );
+            }
+            ASSERT( !indexed.more() );
+        }
+        ASSERT( fields.isIndexed() );
+    }
+
     TEST( SimpleArrayElementIterator, SimpleNoArrayLast1 ) {
         BSONObj obj = BSON( "a" << BSON_ARRAY( 5 << BSON( "x" << 6 ) << BSON_ARRAY( 7 << 9 ) << 11 ) );
         SimpleArrayElementIterator i( obj["a"], false );
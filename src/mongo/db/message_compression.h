@@ -0,0 +1,51 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    class BSONObj;
+    class BSONObjBuilder;
+
+    /**
+     * Whether this server takes part in compressing the messages on its connections, set with
+     * the networkMessageCompression startup parameter.  mongos then also asks for it on the
+     * connections it makes to the shards.
+     */
+    bool messageCompressionEnabled();
+
+    /**
+     * Handles the "compression" field of isMaster, which lists the compressors a client can use.
+     * When compression is enabled here and "snappy" is among them, names it in the reply and
+     * compresses the large messages sent on the connection from then on.  A client that gets
+     * the reply compresses its own.
+     */
+    void negotiateMessageCompression( const BSONObj& cmdObj, BSONObjBuilder* result );
+
+} // namespace mongo
@@ -113,6 +113,9 @@ namespace mongo {
         general_options.addOptionChaining("journalCommitInterval", "journalCommitInterval",
                 moe::Unsigned, "how often to group/batch commit (ms)");
 
+        general_options.addOptionChaining("journalCompressor", "journalCompressor", moe::String,
+                "compression of journal sections: snappy (default) or none");
+
         general_options.addOptionChaining("journalOptions", "journalOptions", moe::Int,
                 "journal diagnostic options");
 
@@ -409,6 +412,19 @@ namespace mongo {
                               "--journalCommitInterval out of allowed range (0-300ms)");
             }
         }
+        if (params.count("journalCompressor")) {
+            const string compressor = params["journalCompressor"].as<string>();
+            if (compressor == "snappy") {
+                storageGlobalParams.journalCompression = true;
+            }
+            else if (compressor == "none") {
+                storageGlobalParams.journalCompression = false;
+            }
+            else {
+                return Status(ErrorCodes::BadValue,
+                              "--journalCompressor must be snappy or none");
+            }
+        }
         if (params.count("journalOptions")) {
             storageGlobalParams.durOptions = params["journalOptions"].as<int>();
         }
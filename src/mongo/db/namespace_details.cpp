@@ -33,7 +33,9 @@
 #include <algorithm>
 #include <list>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/db.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/index_legacy.h"
@@ -258,6 +260,16 @@ namespace mongo {
         return loc;
     }
 
+    // Allocations served from the deleted lists, and the deleted records __stdAlloc examined
+    // to find space.  A high ratio of probes to allocations means the deleted lists are
+    // fragmented and inserts are walking long chains.
+    Counter64 stdAllocCounter;
+    Counter64 stdAllocProbesCounter;
+    ServerStatusMetricField<Counter64> stdAllocCounterDisplay( "record.alloc.count",
+                                                               &stdAllocCounter );
+    ServerStatusMetricField<Counter64> stdAllocProbesCounterDisplay( "record.alloc.probes",
+                                                                     &stdAllocProbesCounter );
+
     /* for non-capped collections.
        @param peekOnly just look up where and don't reserve
        returned item is out of the deleted list upon return
@@ -272,6 +284,7 @@ namespace mongo {
         prev = &_deletedList[b];
         int extra = 5; // look for a better fit, a little.
         int chain = 0;
+        int probes = 0;
         while ( 1 ) {
             { // defensive check
                 int fileNumber = cur.a();
@@ -293,6 +306,8 @@ namespace mongo {
                 b++;
                 if ( b > MaxBucket ) {
                     // out of space. alloc a new extent.
+                    if ( !peekOnly )
+                        stdAllocProbesCounter.increment( probes );
                     return DiskLoc();
                 }
                 cur = _deletedList[b];
@@ -300,6 +315,7 @@ namespace mongo {
                 continue;
             }
             DeletedRecord *r = cur.drec();
+            ++probes;
             if ( r->lengthWithHeaders() >= len &&
                  r->lengthWithHeaders() < bestmatchlen ) {
                 bestmatchlen = r->lengthWithHeaders();
@@ -331,6 +347,8 @@ namespace mongo {
 
         /* unlink ourself from the deleted list */
         if( !peekOnly ) {
+            stdAllocCounter.increment();
+            stdAllocProbesCounter.increment( probes );
             DeletedRecord *bmr = bestmatch.drec();
             *getDur().writing(bestprev) = bmr->nextDeleted();
             bmr->nextDeleted().writing().setInvalid(); // defensive.
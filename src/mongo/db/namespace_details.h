@@ -180,6 +180,15 @@ namespace mongo {
 
     public:
 
+        /** @return a count of allocations in all capped collections, for waitForCappedInsert */
+        static unsigned long long cappedInsertCount();
+
+        /**
+         * waits up to 'millis' for an allocation in any capped collection after 'lastSeen', a
+         * value of cappedInsertCount().  lets tailable cursors awaiting data sleep rather than poll
+         */
+        static void waitForCappedInsert( unsigned long long lastSeen, unsigned millis );
+
         const DiskLoc& firstExtent() const { return _firstExtent; }
         const DiskLoc& lastExtent() const { return _lastExtent; }
 
@@ -34,6 +34,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"   // XXX old sys
 #include "mongo/db/query/new_find.h"
+#include "mongo/db/query/query_planner.h"
 #include "mongo/db/query_optimizer.h"   // XXX old sys
 #include "mongo/db/queryutil.h"   // XXX old sys
 #include "mongo/db/server_options.h"
@@ -103,7 +104,7 @@ namespace mongo {
             }
 
             Runner* rawRunner;
-            if (!getRunner(cq, &rawRunner).isOK()) {
+            if (!getRunner(cq, &rawRunner, QueryPlannerParams::PRIVATE_IS_COUNT).isOK()) {
                 uasserted(17221, "could not get runner " + query.toString());
                 return -2;
             }
@@ -581,6 +581,23 @@ namespace mongo {
         if (_eachMode || _pushMode == PUSH_ALL) {
             BSONObjIterator itEach(_eachElem.embeddedObject());
 
+            // Appending without a $sort, we know which items a $slice would trim right after
+            // adding them: a negative one keeps the last of the $each items, a positive one
+            // the first, if any.  Those are never added.
+            int64_t numToSkip = 0;
+            int64_t numToAdd = std::numeric_limits<int64_t>::max();
+            if (_slicePresent && !_sortPresent &&
+                _startPosition >= _preparedState->arrayPreModSize) {
+                const int64_t arraySize = _preparedState->arrayPreModSize;
+                if (_slice < 0) {
+                    numToSkip = std::max(static_cast<int64_t>(0),
+                                         _eachElem.embeddedObject().nFields() + _slice);
+                }
+                else {
+                    numToAdd = std::max(static_cast<int64_t>(0), _slice - arraySize);
+                }
+            }
+
             // When adding more than one element we keep track of the previous one
             // so we can add right siblings to it.
             mutablebson::Element prevElem = _preparedState->doc.end();
@@ -588,8 +605,14 @@ namespace mongo {
             // The first element is special below
             bool first = true;
 
-            while (itEach.more()) {
+            while (itEach.more() && numToAdd > 0) {
                 BSONElement eachItem = itEach.next();
+                if (numToSkip > 0) {
+                    numToSkip--;
+                    continue;
+                }
+                numToAdd--;
+
                 mutablebson::Element elem =
                     _preparedState->doc.makeElementWithNewFieldName(StringData(), eachItem);
 
@@ -891,8 +891,9 @@ namespace {
         ASSERT_EQUALS(execInfo.fieldRef[0]->dottedField(), "a");
         ASSERT_FALSE(execInfo.noOp);
 
+        // The items pushed would be trimmed right away, so the array is left alone.
         ASSERT_OK(pushMod.apply());
-        ASSERT_FALSE(doc.isInPlaceModeEnabled());
+        ASSERT_TRUE(doc.isInPlaceModeEnabled());
         ASSERT_EQUALS(fromjson("{a: [3]}"), doc);
 
         Document logDoc;
@@ -902,6 +903,52 @@ namespace {
         ASSERT_EQUALS(fromjson("{$set: {a: [3]}}"), logDoc);
     }
 
+    TEST(SlicePushEach, LastOfManyItems) {
+        Document doc(fromjson("{a: [1, 2]}"));
+        Mod pushMod(fromjson("{$push: {a: {$each: [3, 4, 5, 6], $slice: -3}}}"));
+
+        ModifierInterface::ExecInfo execInfo;
+        ASSERT_OK(pushMod.prepare(doc.root(), "", &execInfo));
+        ASSERT_FALSE(execInfo.noOp);
+
+        ASSERT_OK(pushMod.apply());
+        ASSERT_EQUALS(fromjson("{a: [4, 5, 6]}"), doc);
+
+        Document logDoc;
+        LogBuilder logBuilder(logDoc.root());
+        ASSERT_OK(pushMod.log(&logBuilder));
+        ASSERT_EQUALS(fromjson("{$set: {a: [4, 5, 6]}}"), logDoc);
+    }
+
+    TEST(SlicePushEach, FirstItemsThatFit) {
+        Document doc(fromjson("{a: [1, 2]}"));
+        Mod pushMod(fromjson("{$push: {a: {$each: [3, 4, 5], $slice: 3}}}"));
+
+        ModifierInterface::ExecInfo execInfo;
+        ASSERT_OK(pushMod.prepare(doc.root(), "", &execInfo));
+        ASSERT_FALSE(execInfo.noOp);
+
+        ASSERT_OK(pushMod.apply());
+        ASSERT_EQUALS(fromjson("{a: [1, 2, 3]}"), doc);
+
+        Document logDoc;
+        LogBuilder logBuilder(logDoc.root());
+        ASSERT_OK(pushMod.log(&logBuilder));
+        ASSERT_EQUALS(fromjson("{$set: {a: [1, 2, 3]}}"), logDoc);
+    }
+
+    TEST(SortPushEach, AppendToSorted) {
+        Document doc(fromjson("{a: [{t: 1}, {t: 2}, {t: 3}]}"));
+        Mod pushMod(fromjson("{$push: {a: {$each: [{t: 4}], $sort: {t: 1}, $slice: -3}}}"));
+
+        ModifierInterface::ExecInfo execInfo;
+        ASSERT_OK(pushMod.prepare(doc.root(), "", &execInfo));
+        ASSERT_FALSE(execInfo.noOp);
+
+        ASSERT_OK(pushMod.apply());
+        ASSERT_EQUALS(fromjson("{a: [{t: 2}, {t: 3}, {t: 4}]}"), doc);
+    }
+
     /**
      * Sort for scalar (whole) array elements
      */
@@ -1131,8 +1178,9 @@ namespace {
             ASSERT_EQUALS(execInfo.fieldRef[0]->dottedField(), "a");
             ASSERT_FALSE(execInfo.noOp);
 
+            // A $slice of 0 leaves nothing to add.
             ASSERT_OK(mod().apply());
-            ASSERT_FALSE(doc.isInPlaceModeEnabled());
+            ASSERT_EQUALS(slice == 0, doc.isInPlaceModeEnabled());
 
             vector<int> combinedVec;
             combineVec(docArray,   /* a: []  */
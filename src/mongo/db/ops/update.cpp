@@ -357,6 +357,59 @@ namespace mongo {
             return Status::OK();
         }
 
+        // Damages that are at most this many bytes apart are declared to durability as one
+        // write intent.  Journaling the few unchanged bytes between them (typically a type byte
+        // and a field name) is cheaper than the per-intent bookkeeping.
+        const size_t kMaxDamageGapToCoalesce = 64;
+
+        /**
+         * Applies 'damages' from 'source' to the record data at 'target', declaring a single
+         * write intent for each run of nearby damages rather than one per damage.
+         */
+        void applyDamages(const char* source, char* target, const mb::DamageVector& damages) {
+            mb::DamageVector::const_iterator where = damages.begin();
+            const mb::DamageVector::const_iterator end = damages.end();
+            while (where != end) {
+                const size_t runStart = where->targetOffset;
+                size_t runEnd = runStart + where->size;
+                mb::DamageVector::const_iterator runLast = where + 1;
+                while (runLast != end &&
+                       runLast->targetOffset >= runEnd &&
+                       runLast->targetOffset - runEnd <= kMaxDamageGapToCoalesce) {
+                    runEnd = runLast->targetOffset + runLast->size;
+                    ++runLast;
+                }
+
+                char* const runPtr = static_cast<char*>(
+                    getDur().writingPtr(target + runStart, runEnd - runStart));
+                for ( ; where != runLast; ++where) {
+                    std::memcpy(runPtr + (where->targetOffset - runStart),
+                                source + where->sourceOffset,
+                                where->size);
+                }
+            }
+        }
+
+        /**
+         * Moves on to the next document to update: the next one 'runner' returns, or without a
+         * runner, the one at 'targetLoc' if it's the 'first'.  Returns false when there is none.
+         */
+        bool getNextDocument(Runner* runner,
+                             const DiskLoc& targetLoc,
+                             bool first,
+                             BSONObj* obj,
+                             DiskLoc* loc) {
+            if (runner) {
+                return Runner::RUNNER_ADVANCED == runner->getNext(obj, loc);
+            }
+            if (!first) {
+                return false;
+            }
+            *loc = targetLoc;
+            *obj = targetLoc.obj();
+            return true;
+        }
+
     } // namespace
 
     UpdateResult update(const UpdateRequest& request, OpDebug* opDebug) {
@@ -409,12 +462,21 @@ namespace mongo {
             uasserted(17242, "could not canonicalize query " + request.getQuery().toString());
         }
 
-        Runner* rawRunner;
-        if (!getRunner(cq, &rawRunner).isOK()) {
-            uasserted(17243, "could not get runner " + request.getQuery().toString());
+        // A caller that already found the one document to update hands us its record, which
+        // is all there is to update. There's no need for a runner to find it again.
+        const DiskLoc& targetLoc = request.getLoc();
+        auto_ptr<Runner> runner;
+        auto_ptr<CanonicalQuery> targetQuery;
+        if (targetLoc.isNull()) {
+            Runner* rawRunner;
+            if (!getRunner(cq, &rawRunner).isOK()) {
+                uasserted(17243, "could not get runner " + request.getQuery().toString());
+            }
+            runner.reset(rawRunner);
+        }
+        else {
+            targetQuery.reset(cq);
         }
-
-        auto_ptr<Runner> runner(rawRunner);
         RunnerYieldPolicy yieldPolicy;
 
         // If the update was marked with '$isolated' (a.k.a '$atomic'), we are not allowed to
@@ -440,13 +502,24 @@ namespace mongo {
         opDebug->nscanned = 0;
         opDebug->nupdateNoops = 0;
 
+        // The document and damage buffers are reused from one matched document to the next, as
+        // is everything below that only depends on the statement and the collection.
         mutablebson::Document doc;
         mutablebson::DamageVector damages;
 
+        const bool needMatchDetails = driver->needMatchDetails();
+        const UpdateLifecycle* lifecycle = request.getLifecycle();
+        const bool checkImmutableFields = !(request.isFromReplication() ||
+                                            request.isFromMigration());
+        const std::vector<FieldRef*>* immutableFields =
+            lifecycle ? lifecycle->getImmutableFields() : NULL;
+        // There is nothing to match in a collection that doesn't exist yet.
+        bool idRequired = collection && collection->details()->haveIdIndex();
+
+        BSONObj resultDoc;
         BSONObj oldObj;
         DiskLoc loc;
-        Runner::RunnerState state;
-        while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&oldObj, &loc))) {
+        while (getNextDocument(runner.get(), targetLoc, numMatched == 0, &oldObj, &loc)) {
             if (!isolated && opDebug->nscanned != 0) {
                 if (yieldPolicy.shouldYield()) {
                     if (!yieldPolicy.yieldAndCheckIfOK(runner.get())) {
@@ -459,7 +532,6 @@ namespace mongo {
                     // them here. If we can't do so, escape the update loop. Otherwise, refresh
                     // the driver so that it knows about what is currently indexed.
 
-                    const UpdateLifecycle* lifecycle = request.getLifecycle();
                     collection = cc().database()->getCollection(nsString.ns());
                     if (!collection || (lifecycle && !lifecycle->canContinue())) {
                         uasserted(17270,
@@ -470,7 +542,9 @@ namespace mongo {
                         IndexPathSet indexes;
                         lifecycle->getIndexKeys(&indexes);
                         driver->refreshIndexKeys(indexes);
+                        immutableFields = lifecycle->getImmutableFields();
                     }
+                    idRequired = collection->details()->haveIdIndex();
                 }
             }
 
@@ -495,16 +569,17 @@ namespace mongo {
             doc.reset(oldObj, mutablebson::Document::kInPlaceEnabled);
             BSONObj logObj;
 
-            // If there was a matched field, obtain it.
-            // TODO: Only do this when needed (need requirements from update_driver/mods)
-            MatchDetails matchDetails;
-            matchDetails.requestElemMatchKey();
+            // If there was a matched field, obtain it. Only positional mods need it, so only
+            // they pay for matching the document a second time.
             // TODO: Find out if can move this to the query side so we don't need to double match
-            verify(cq->root()->matchesBSON(oldObj, &matchDetails));
-
             string matchedField;
-            if (matchDetails.hasElemMatchKey())
-                matchedField = matchDetails.elemMatchKey();
+            if (needMatchDetails) {
+                MatchDetails matchDetails;
+                matchDetails.requestElemMatchKey();
+                verify(cq->root()->matchesBSON(oldObj, &matchDetails));
+                if (matchDetails.hasElemMatchKey())
+                    matchedField = matchDetails.elemMatchKey();
+            }
 
             FieldRefSet updatedFields;
             Status status = driver->update(matchedField, &doc, &logObj, &updatedFields);
@@ -512,9 +587,6 @@ namespace mongo {
                 uasserted(16837, status.reason());
             }
 
-            dassert(collection->details());
-            const bool idRequired = collection->details()->haveIdIndex();
-
             // Move _id as first element
             mb::Element idElem = mb::findFirstChildNamed(doc.root(), idFieldName);
             if (idElem.ok()) {
@@ -543,11 +615,7 @@ namespace mongo {
             // If something changed in the document, verify that no immutable fields were changed
             // and data is valid for storage.
             if ((!inPlace || !damages.empty()) ) {
-                if (!(request.isFromReplication() || request.isFromMigration())) {
-                    const std::vector<FieldRef*>* immutableFields = NULL;
-                    if (const UpdateLifecycle* lifecycle = request.getLifecycle())
-                        immutableFields = lifecycle->getImmutableFields();
-
+                if (checkImmutableFields) {
                     uassertStatusOK(validate(idRequired,
                                              oldObj,
                                              updatedFields,
@@ -557,7 +625,9 @@ namespace mongo {
                 }
             }
 
-            runner->saveState();
+            if (runner.get()) {
+                runner->saveState();
+            }
 
             if (inPlace && !driver->modsAffectIndices()) {
 
@@ -567,16 +637,10 @@ namespace mongo {
 
                     collection->details()->paddingFits();
 
+                    collection->hashCache()->notifyOfWrite(oldObj);
+
                     // All updates were in place. Apply them via durability and writing pointer.
-                    mutablebson::DamageVector::const_iterator where = damages.begin();
-                    const mutablebson::DamageVector::const_iterator end = damages.end();
-                    for( ; where != end; ++where ) {
-                        const char* sourcePtr = source + where->sourceOffset;
-                        void* targetPtr = getDur().writingPtr(
-                            const_cast<char*>(oldObj.objdata()) + where->targetOffset,
-                            where->size);
-                        std::memcpy(targetPtr, sourcePtr, where->size);
-                    }
+                    applyDamages(source, const_cast<char*>(oldObj.objdata()), damages);
                     objectWasChanged = true;
                     opDebug->fastmod = true;
                 }
@@ -585,11 +649,17 @@ namespace mongo {
             else {
 
                 // The updates were not in place. Apply them through the file manager.
+                // The driver only knows which fields are indexed when it has a lifecycle to
+                // ask, and a replacement changes every field.
                 newObj = doc.getObject();
+                const bool indexesAffected = !lifecycle ||
+                                             driver->isDocReplacement() ||
+                                             driver->modsAffectIndices();
                 StatusWith<DiskLoc> res = collection->updateDocument(loc,
                                                                      newObj,
                                                                      true,
-                                                                     opDebug);
+                                                                     opDebug,
+                                                                     indexesAffected);
                 uassertStatusOK(res.getStatus());
                 DiskLoc newLoc = res.getValue();
 
@@ -619,13 +689,18 @@ namespace mongo {
             if (!objectWasChanged)
                 opDebug->nupdateNoops++;
 
+            // The new document is at hand, whether it was changed in place or written anew.
+            if (request.shouldStoreResultDoc()) {
+                resultDoc = newObj.getOwned();
+            }
+
             if (!request.isMulti()) {
                 break;
             }
 
             getDur().commitIfNeeded();
 
-            if (!runner->restoreState()) {
+            if (runner.get() && !runner->restoreState()) {
                 break;
             }
         }
@@ -633,10 +708,12 @@ namespace mongo {
         // TODO: Can this be simplified?
         if ((numMatched > 0) || (numMatched == 0 && !request.isUpsert()) ) {
             opDebug->nupdated = numMatched;
-            return UpdateResult(numMatched > 0 /* updated existing object(s) */,
+            UpdateResult result(numMatched > 0 /* updated existing object(s) */,
                                 !driver->isDocReplacement() /* $mod or obj replacement */,
                                 numMatched /* # of docments update, even no-ops */,
                                 BSONObj());
+            result.newObj = resultDoc;
+            return result;
         }
 
         //
@@ -684,7 +761,7 @@ namespace mongo {
         }
 
         dassert(collection->details());
-        const bool idRequired = collection->details()->haveIdIndex();
+        idRequired = collection->details()->haveIdIndex();
 
         mb::Element idElem = mb::findFirstChildNamed(doc.root(), idFieldName);
 
@@ -711,11 +788,7 @@ namespace mongo {
 
         // Validate that the object replacement or modifiers resulted in a document
         // that contains all the immutable keys and can be stored.
-        if (!(request.isFromReplication() || request.isFromMigration())){
-            const std::vector<FieldRef*>* immutableFields = NULL;
-            if (const UpdateLifecycle* lifecycle = request.getLifecycle())
-                immutableFields = lifecycle->getImmutableFields();
-
+        if (checkImmutableFields) {
             uassertStatusOK(validate(idRequired,
                                      original,
                                      updatedFields,
@@ -735,10 +808,14 @@ namespace mongo {
         }
 
         opDebug->nupdated = 1;
-        return UpdateResult(false /* updated a non existing document */,
+        UpdateResult result(false /* updated a non existing document */,
                             !driver->isDocReplacement() /* $mod or obj replacement? */,
                             1 /* count of updated documents */,
                             newObj /* object that was upserted */ );
+        if (request.shouldStoreResultDoc()) {
+            result.newObj = newObj;
+        }
+        return result;
     }
 
     BSONObj applyUpdateOperators(const BSONObj& from, const BSONObj& operators) {
@@ -33,6 +33,7 @@
 #include "mongo/bson/mutable/algorithm.h"
 #include "mongo/bson/mutable/document.h"
 #include "mongo/db/field_ref.h"
+#include "mongo/db/ops/field_checker.h"
 #include "mongo/db/ops/log_builder.h"
 #include "mongo/db/ops/modifier_object_replace.h"
 #include "mongo/db/ops/modifier_table.h"
@@ -47,6 +48,7 @@ namespace mongo {
 
     UpdateDriver::UpdateDriver(const Options& opts)
         : _replacementMode(false)
+        , _positional(false)
         , _multi(opts.multi)
         , _upsert(opts.upsert)
         , _logOp(opts.logOp)
@@ -152,6 +154,13 @@ namespace mongo {
             return status;
         }
 
+        FieldRef fieldRef;
+        fieldRef.parse(elem.fieldNameStringData());
+        size_t posDollar;
+        if (fieldchecker::isPositional(fieldRef, &posDollar)) {
+            _positional = true;
+        }
+
         _mods.push_back(mod.release());
 
         return Status::OK();
@@ -332,6 +341,10 @@ namespace mongo {
         return _replacementMode;
     }
 
+    bool UpdateDriver::needMatchDetails() const {
+        return _positional;
+    }
+
     bool UpdateDriver::modsAffectIndices() const {
         return _affectIndices;
     }
@@ -403,8 +416,10 @@ namespace mongo {
         for (vector<ModifierInterface*>::iterator it = _mods.begin(); it != _mods.end(); ++it) {
             delete *it;
         }
+        _mods.clear();
         _indexedFields.clear();
         _replacementMode = false;
+        _positional = false;
     }
 
 } // namespace mongo
@@ -101,6 +101,12 @@ namespace mongo {
 
         bool isDocReplacement() const;
 
+        /**
+         * Returns true if a mod targets a positional ($) field, and so needs the array
+         * element the query matched in each document ('matchedField' in update()).
+         */
+        bool needMatchDetails() const;
+
         bool modsAffectIndices() const;
         void refreshIndexKeys(const IndexPathSet& indexedFields);
 
@@ -135,6 +141,9 @@ namespace mongo {
         // Is there a list of $mod's on '_mods' or is it just full object replacement?
         bool _replacementMode;
 
+        // Does any of the '_mods' target a positional field?
+        bool _positional;
+
         // Collection of update mod instances. Owned here.
         vector<ModifierInterface*> _mods;
 
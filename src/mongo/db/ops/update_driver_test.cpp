@@ -115,6 +115,24 @@ namespace {
         ASSERT_FALSE(driver.isDocReplacement());
     }
 
+    TEST(Parse, Positional) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(fromjson("{$set:{a:1}, $inc:{b:1}}")));
+        ASSERT_FALSE(driver.needMatchDetails());
+
+        ASSERT_OK(driver.parse(fromjson("{$set:{a:1}, $inc:{'b.$.c':1}}")));
+        ASSERT_TRUE(driver.needMatchDetails());
+
+        ASSERT_OK(driver.parse(fromjson("{$push:{'a.$':1}}")));
+        ASSERT_TRUE(driver.needMatchDetails());
+
+        // Parsing again starts over
+        ASSERT_OK(driver.parse(fromjson("{$set:{'a.b':1}}")));
+        ASSERT_FALSE(driver.needMatchDetails());
+        ASSERT_EQUALS(driver.numMods(), 1U);
+    }
+
 
     // Test the upsert case where we copy the query parts into the new doc
     TEST(CreateFromQuery, Basic) {
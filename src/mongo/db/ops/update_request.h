@@ -30,6 +30,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/diskloc.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query_plan_selection_policy.h"
 #include "mongo/util/mongoutils/str.h"
@@ -54,6 +55,7 @@ namespace mongo {
             , _callLogOp(false)
             , _fromMigration(false)
             , _fromReplication(false)
+            , _storeResultDoc(false)
             , _lifecycle(NULL) {}
 
         const NamespaceString& getNamespaceString() const {
@@ -131,6 +133,22 @@ namespace mongo {
             return _fromReplication;
         }
 
+        inline void setStoreResultDoc(bool value = true) {
+            _storeResultDoc = value;
+        }
+
+        bool shouldStoreResultDoc() const {
+            return _storeResultDoc;
+        }
+
+        inline void setLoc(const DiskLoc& loc) {
+            _loc = loc;
+        }
+
+        inline const DiskLoc& getLoc() const {
+            return _loc;
+        }
+
         inline void setLifecycle(const UpdateLifecycle* value) {
             _lifecycle = value;
         }
@@ -148,7 +166,9 @@ namespace mongo {
                         << " multi: " << _multi
                         << " callLogOp: " << _callLogOp
                         << " fromMigration: " << _fromMigration
-                        << " fromReplications: " << _fromReplication;
+                        << " fromReplications: " << _fromReplication
+                        << " storeResultDoc: " << _storeResultDoc
+                        << " loc: " << _loc.toString();
         }
     private:
 
@@ -182,6 +202,14 @@ namespace mongo {
         // True if this update is being applied during the application for the oplog.
         bool _fromReplication;
 
+        // True if the update should return the document it updated or inserted, as it is after
+        // the update, in UpdateResult::newObj.
+        bool _storeResultDoc;
+
+        // If set, the record of the one document matching the query, which the caller found
+        // under the same lock. The update applies to it without running the query again.
+        DiskLoc _loc;
+
         // The lifecycle data, and events used during the update request.
         const UpdateLifecycle* _lifecycle;
     };
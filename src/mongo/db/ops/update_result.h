@@ -67,6 +67,9 @@ namespace mongo {
         // if something was upserted, the new _id of the object
         BSONObj upserted;
 
+        // the updated or upserted document, if the request asked for it
+        BSONObj newObj;
+
         const std::string toString() const {
             return str::stream()
                         << " upserted: " << upserted
@@ -541,6 +541,66 @@ namespace mongo {
         return loc;
     }
 
+    void DataFileMgr::insertBatchWithObjMod(const char* ns,
+                                            vector<BSONObj>& objs,
+                                            bool ordered,
+                                            vector<bool>* inserted) {
+        inserted->assign( objs.size(), false );
+
+        Collection* collection = cc().database()->getCollection( ns );
+        verify( collection );
+        NamespaceDetails* d = collection->details();
+        verify( !d->isCapped() );
+
+        // write the records first, and index them after
+        vector<BSONObj> docs;
+        vector<DiskLoc> locs;
+        vector<size_t> which;
+        size_t firstFailed = objs.size();
+        for ( size_t i = 0; i < objs.size() && ( !ordered || i < firstFailed ); i++ ) {
+            DiskLoc loc;
+            try {
+                bool addedID = false;
+                loc = insert( ns, objs[i].objdata(), objs[i].objsize(), false, false, false,
+                              &addedID, false );
+                if ( addedID && !loc.isNull() )
+                    objs[i] = BSONObj::make( loc.rec() );
+            }
+            catch ( DBException& e ) {
+                LOG(2) << "DataFileMgr::insertBatchWithObjMod insert failed: " << e;
+            }
+
+            if ( loc.isNull() ) {
+                firstFailed = std::min( firstFailed, i );
+                continue;
+            }
+            docs.push_back( objs[i] );
+            locs.push_back( loc );
+            which.push_back( i );
+        }
+
+        vector<bool> failed( docs.size(), false );
+        collection->getIndexCatalog()->indexRecords( docs, locs, &failed );
+        for ( size_t k = 0; k < docs.size(); k++ ) {
+            if ( failed[k] )
+                firstFailed = std::min( firstFailed, which[k] );
+        }
+
+        // take back the ones that didn't make it, and when ordered, the ones after them
+        for ( size_t k = 0; k < docs.size(); k++ ) {
+            const size_t i = which[k];
+            if ( !failed[k] && ( !ordered || i < firstFailed ) ) {
+                (*inserted)[i] = true;
+                continue;
+            }
+
+            // an _id we added lives in the record
+            objs[i] = objs[i].getOwned();
+            collection->getIndexCatalog()->unindexRecord( docs[k], locs[k], true );
+            _deleteRecord( d, ns, locs[k].rec(), locs[k] );
+        }
+    }
+
     /** add a record to the end of the linked list chain within this extent. 
         require: you must have already declared write intent for the record header.        
     */
@@ -636,7 +696,8 @@ namespace mongo {
                                 bool mayInterrupt,
                                 bool god,
                                 bool mayAddIndex,
-                                bool* addedID) {
+                                bool* addedID,
+                                bool addToIndexes) {
 
         Database* database = cc().database();
 
@@ -767,8 +828,12 @@ namespace mongo {
         if ( !god )
             collection->infoCache()->notifyOfWriteOp();
 
+        // btree buckets are no documents
+        if ( !god || NamespaceString::normal( ns ) )
+            collection->hashCache()->notifyOfWrite( BSONObj( r->data() ) );
+
         /* add this record to our indexes */
-        if ( d->getTotalIndexCount() > 0 ) {
+        if ( addToIndexes && d->getTotalIndexCount() > 0 ) {
             try {
                 BSONObj obj(r->data());
                 collection->getIndexCatalog()->indexRecord(obj, loc);
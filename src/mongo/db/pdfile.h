@@ -101,6 +101,7 @@ namespace mongo {
          *     command.
          * @param addedID if not null, set to true if adding _id element.  You must assure false
          *     before calling if using.
+         * @param addToIndexes if false, the record is not indexed: the caller indexes it.
          */
         DiskLoc insert(const char* ns,
                        const void* buf,
@@ -108,7 +109,22 @@ namespace mongo {
                        bool mayInterrupt = false,
                        bool god = false,
                        bool mayAddIndex = true,
-                       bool* addedID = 0);
+                       bool* addedID = 0,
+                       bool addToIndexes = true);
+
+        /**
+         * Inserts each of objs as insertWithObjMod() would, but indexes them together: the keys
+         * of all of them go into each index at once, in the index's order.
+         * Sets (*inserted)[i] to whether objs[i] went in.  One that didn't was left out
+         * entirely, and when ordered, so was every one after it; insert those with
+         * insertWithObjMod() to see why.
+         * ns must be an existing collection that is neither capped nor a system collection.
+         * note: does NOT put on oplog
+         */
+        void insertBatchWithObjMod(const char* ns,
+                                   vector<BSONObj>& /*out*/objs,
+                                   bool ordered,
+                                   vector<bool>* inserted);
         static shared_ptr<Cursor> findAll(const StringData& ns, const DiskLoc &startLoc = DiskLoc());
 
         /* special version of insert for transaction logging -- streamlined a bit.
@@ -243,6 +259,13 @@ namespace mongo {
         static void appendStats( BSONObjBuilder& b );
 
         static void appendWorkingSetInfo( BSONObjBuilder& b );
+
+        /**
+         * fills 'pages' with the sorted page numbers (address >> 12) appendWorkingSetInfo counts,
+         * so they can be attributed to the extents of a collection or index
+         * @return false if the working set estimate isn't supported
+         */
+        static bool workingSetPages( std::vector<size_t>* pages );
     private:
         
         int _netLength() const { return _lengthWithHeaders - HeaderSize; }
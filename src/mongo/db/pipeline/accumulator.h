@@ -33,6 +33,7 @@
 #include <boost/unordered_set.hpp>
 
 #include "mongo/bson/bsontypes.h"
+#include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/value.h"
 
 namespace mongo {
@@ -45,6 +46,13 @@ namespace mongo {
             processInternal(input, merging);
         }
 
+        /** Process the 'n' inputs starting at 'inputs', in order, as if each
+         *  were passed to process() in turn.
+         */
+        void processBatch(const Value* inputs, size_t n, bool merging) {
+            processBatchInternal(inputs, n, merging);
+        }
+
         /** Marks the end of the evaluate() phase and return accumulated result.
          *  toBeMerged should be true when the outputs will be merged by process().
          */
@@ -67,6 +75,14 @@ namespace mongo {
         /// Update subclass's internal state based on input
         virtual void processInternal(const Value& input, bool merging) = 0;
 
+        /// Update subclass's internal state based on a run of inputs.
+        /// Subclasses with cheap per-input work override this with a tighter loop.
+        virtual void processBatchInternal(const Value* inputs, size_t n, bool merging) {
+            for (size_t i = 0; i < n; i++) {
+                processInternal(inputs[i], merging);
+            }
+        }
+
         /// subclasses are expected to update this as necessary
         int _memUsageBytes;
     };
@@ -83,8 +99,14 @@ namespace mongo {
 
     private:
         AccumulatorAddToSet();
+
+        // Adds 'value' to the set if it isn't there yet.
+        void insert(const Value& value);
+        void updateMemUsage();
+
         typedef boost::unordered_set<Value, Value::Hash> SetType;
         SetType set;
+        size_t _valuesBytes; // what the values in the set and their nodes use
     };
 
 
@@ -123,6 +145,7 @@ namespace mongo {
     class AccumulatorSum : public Accumulator {
     public:
         virtual void processInternal(const Value& input, bool merging);
+        virtual void processBatchInternal(const Value* inputs, size_t n, bool merging);
         virtual Value getValue(bool toBeMerged) const;
         virtual const char* getOpName() const;
         virtual void reset();
@@ -141,6 +164,7 @@ namespace mongo {
     class AccumulatorMinMax : public Accumulator {
     public:
         virtual void processInternal(const Value& input, bool merging);
+        virtual void processBatchInternal(const Value* inputs, size_t n, bool merging);
         virtual Value getValue(bool toBeMerged) const;
         virtual const char* getOpName() const;
         virtual void reset();
@@ -168,13 +192,20 @@ namespace mongo {
     private:
         AccumulatorPush();
 
-        vector<Value> vpValue;
+        void append(const Value& value);
+
+        // The values pushed so far, as the elements of a BSON array.  This is smaller than a
+        // vector<Value>, and keeps nothing else alive, such as the rest of the documents the
+        // values were taken from.
+        scoped_ptr<BSONObjBuilder> _values;
+        int _numValues;
     };
 
 
     class AccumulatorAvg : public Accumulator {
     public:
         virtual void processInternal(const Value& input, bool merging);
+        virtual void processBatchInternal(const Value* inputs, size_t n, bool merging);
         virtual Value getValue(bool toBeMerged) const;
         virtual const char* getOpName() const;
         virtual void reset();
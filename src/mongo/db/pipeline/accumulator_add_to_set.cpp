@@ -33,13 +33,48 @@
 #include "mongo/db/pipeline/value.h"
 
 namespace mongo {
+    namespace {
+        // What the set allocates for each value besides the Value itself: its node's link to the
+        // next node and its cached hash.
+        const size_t nodeOverheadBytes = 2 * sizeof(void*);
+
+        // A copy of 'value' that holds on to nothing but itself.  Documents and arrays taken from
+        // a larger document would otherwise keep all of that document in memory.
+        Value compactCopy(const Value& value) {
+            if (value.getType() != Object && value.getType() != Array)
+                return value;
+
+            BSONObjBuilder builder;
+            value.addToBsonObj(&builder, "");
+            return Value(builder.done().firstElement());
+        }
+    }
+
+    void AccumulatorAddToSet::insert(const Value& value) {
+        bool inserted;
+        if (value.getType() != Object && value.getType() != Array) {
+            inserted = set.insert(value).second;
+        }
+        else {
+            // Only pay for the copy when the value is new.
+            inserted = !set.count(value);
+            if (inserted)
+                set.insert(compactCopy(value));
+        }
+
+        if (inserted) {
+            _valuesBytes += value.getApproximateSize() + nodeOverheadBytes;
+        }
+    }
+
+    void AccumulatorAddToSet::updateMemUsage() {
+        _memUsageBytes = sizeof(*this) + _valuesBytes + set.bucket_count() * sizeof(void*);
+    }
+
     void AccumulatorAddToSet::processInternal(const Value& input, bool merging) {
         if (!merging) {
             if (!input.missing()) {
-                bool inserted = set.insert(input).second;
-                if (inserted) {
-                    _memUsageBytes += input.getApproximateSize();
-                }
+                insert(input);
             }
         }
         else {
@@ -51,12 +86,11 @@ namespace mongo {
             
             const vector<Value>& array = input.getArray();
             for (size_t i=0; i < array.size(); i++) {
-                bool inserted = set.insert(array[i]).second;
-                if (inserted) {
-                    _memUsageBytes += array[i].getApproximateSize();
-                }
+                insert(array[i]);
             }
         }
+
+        updateMemUsage();
     }
 
     Value AccumulatorAddToSet::getValue(bool toBeMerged) const {
@@ -65,12 +99,13 @@ namespace mongo {
     }
 
     AccumulatorAddToSet::AccumulatorAddToSet() {
-        _memUsageBytes = sizeof(*this);
+        reset();
     }
 
     void AccumulatorAddToSet::reset() {
         SetType().swap(set);
-        _memUsageBytes = sizeof(*this);
+        _valuesBytes = 0;
+        updateMemUsage();
     }
 
     intrusive_ptr<Accumulator> AccumulatorAddToSet::create() {
@@ -58,6 +58,29 @@ namespace {
         }
     }
 
+    void AccumulatorAvg::processBatchInternal(const Value* inputs, size_t n, bool merging) {
+        if (merging) {
+            for (size_t i = 0; i < n; i++) {
+                processInternal(inputs[i], merging);
+            }
+            return;
+        }
+
+        // Same as calling processInternal() on each input, but with the totals in locals.
+        double total = _total;
+        long long count = _count;
+        for (size_t i = 0; i < n; i++) {
+            // non numeric types have no impact on average
+            if (inputs[i].numeric()) {
+                total += inputs[i].getDouble();
+                count += 1;
+            }
+        }
+
+        _total = total;
+        _count = count;
+    }
+
     intrusive_ptr<Accumulator> AccumulatorAvg::create() {
         return new AccumulatorAvg();
     }
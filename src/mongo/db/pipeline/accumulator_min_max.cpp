@@ -45,6 +45,24 @@ namespace mongo {
         }
     }
 
+    void AccumulatorMinMax::processBatchInternal(const Value* inputs, size_t n, bool merging) {
+        // Find the best input first so that we only copy it, and size it, once.
+        const Value* best = _val.missing() ? NULL : &_val;
+        for (size_t i = 0; i < n; i++) {
+            // nullish values should have no impact on result
+            if (inputs[i].nullish())
+                continue;
+
+            if (!best || Value::compare(*best, inputs[i]) * _sense > 0)
+                best = &inputs[i];
+        }
+
+        if (best && best != &_val) {
+            _val = *best;
+            _memUsageBytes = sizeof(*this) + _val.getApproximateSize() - sizeof(Value);
+        }
+    }
+
     Value AccumulatorMinMax::getValue(bool toBeMerged) const {
         return _val;
     }
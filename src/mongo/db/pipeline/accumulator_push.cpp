@@ -33,11 +33,19 @@
 #include "mongo/db/pipeline/value.h"
 
 namespace mongo {
+    namespace {
+        // Most groups only push a few values, so start small.
+        const int initialBufferBytes = 64;
+    }
+
+    void AccumulatorPush::append(const Value& value) {
+        value.addToBsonObj(_values.get(), BSONObjBuilder::numStr(_numValues++));
+    }
+
     void AccumulatorPush::processInternal(const Value& input, bool merging) {
         if (!merging) {
             if (!input.missing()) {
-                vpValue.push_back(input);
-                _memUsageBytes += input.getApproximateSize();
+                append(input);
             }
         }
         else {
@@ -48,25 +56,27 @@ namespace mongo {
             verify(input.getType() == Array);
             
             const vector<Value>& vec = input.getArray();
-            vpValue.insert(vpValue.end(), vec.begin(), vec.end());
-
             for (size_t i=0; i < vec.size(); i++) {
-                _memUsageBytes += vec[i].getApproximateSize();
+                append(vec[i]);
             }
         }
+
+        _memUsageBytes = sizeof(*this) + sizeof(BSONObjBuilder) + _values->bb().getSize();
     }
 
     Value AccumulatorPush::getValue(bool toBeMerged) const {
-        return Value(vpValue);
+        // The Value copies what it needs out of the array, so more values may still be appended.
+        return Value(BSONArray(_values->asTempObj()));
     }
 
     AccumulatorPush::AccumulatorPush() {
-        _memUsageBytes = sizeof(*this);
+        reset();
     }
 
     void AccumulatorPush::reset() {
-        vector<Value>().swap(vpValue);
-        _memUsageBytes = sizeof(*this);
+        _values.reset(new BSONObjBuilder(initialBufferBytes));
+        _numValues = 0;
+        _memUsageBytes = sizeof(*this) + sizeof(BSONObjBuilder) + _values->bb().getSize();
     }
 
     intrusive_ptr<Accumulator> AccumulatorPush::create() {
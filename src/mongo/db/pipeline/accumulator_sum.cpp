@@ -56,6 +56,41 @@ namespace mongo {
         }
     }
 
+    void AccumulatorSum::processBatchInternal(const Value* inputs, size_t n, bool merging) {
+        // Same as calling processInternal() on each input, but with the totals in locals.
+        BSONType type = totalType;
+        long long longSum = longTotal;
+        double doubleSum = doubleTotal;
+
+        for (size_t i = 0; i < n; i++) {
+            const Value& input = inputs[i];
+            switch (input.getType()) {
+            case NumberInt:
+            case NumberLong: {
+                long long v = input.coerceToLong();
+                if (type != NumberDouble) {
+                    if (input.getType() == NumberLong)
+                        type = NumberLong;
+                    longSum += v;
+                }
+                doubleSum += v;
+                break;
+            }
+            case NumberDouble:
+                type = NumberDouble;
+                doubleSum += input.getDouble();
+                break;
+            default:
+                // do nothing with non numeric types
+                break;
+            }
+        }
+
+        totalType = type;
+        longTotal = longSum;
+        doubleTotal = doubleSum;
+    }
+
     intrusive_ptr<Accumulator> AccumulatorSum::create() {
         return new AccumulatorSum();
     }
@@ -58,7 +58,7 @@ namespace mongo {
             }
         }
         else { // linear scan
-            for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
+            for (DocumentStorageIterator it = loadedFields(); !it.atEnd(); it.advance()) {
                 if (it->nameLen == reqSize
                     && memcmp(requested.rawData(), it->_name, reqSize) == 0) {
                     return it.position();
@@ -66,10 +66,74 @@ namespace mongo {
             }
         }
 
+        // the field may be one we haven't loaded yet
+        while (_bsonNext) {
+            const Position pos = loadNextField();
+            const ValueElement& elem = getField(pos);
+            if (elem.nameLen == reqSize
+                && memcmp(requested.rawData(), elem._name, reqSize) == 0) {
+                return pos;
+            }
+        }
+
         // if we got here, there's no such field
         return Position();
     }
 
+    DocumentStorage::DocumentStorage(const BSONObj& bson, const BSONObj& owner)
+        : _buffer(NULL)
+        , _bufferEnd(NULL)
+        , _usedBytes(0)
+        , _numFields(0)
+        , _hashTabMask(0)
+        , _bson(bson)
+        , _bsonOwner(owner)
+        , _bsonNext(bson.isEmpty() ? NULL : bson.firstElement().rawdata())
+        , _bsonValid(true)
+    {}
+
+    Position DocumentStorage::loadNextField() const {
+        dassert(_bsonNext);
+
+        // Loading a field doesn't change what the document holds, so it is allowed even
+        // through a const reference.
+        DocumentStorage* self = const_cast<DocumentStorage*>(this);
+
+        const BSONElement elem(_bsonNext);
+        const char* next = _bsonNext + elem.size();
+        self->_bsonNext = (*next == EOO) ? NULL : next;
+
+        const Value val = valueFromBson(elem);
+        const Position pos = getNextPosition();
+        self->appendField(elem.fieldNameStringData()) = val;
+        return pos;
+    }
+
+    Value DocumentStorage::valueFromBson(const BSONElement& elem) const {
+        switch (elem.type()) {
+        case Object:
+            return Value(Document(new DocumentStorage(elem.embeddedObject(), _bsonOwner)));
+
+        case Array: {
+            vector<Value> values;
+            BSONForEach(sub, elem.embeddedObject()) {
+                values.push_back(valueFromBson(sub));
+            }
+            return Value::consume(values);
+        }
+
+        default:
+            return Value(elem);
+        }
+    }
+
+    void DocumentStorage::dropBson() {
+        loadAllFields();
+        _bson = BSONObj();
+        _bsonOwner = BSONObj();
+        _bsonValid = false;
+    }
+
     Value& DocumentStorage::appendField(StringData name) {
         Position pos = getNextPosition();
         const int nameSize = name.size();
@@ -129,6 +193,7 @@ namespace mongo {
         const bool firstAlloc = !_buffer;
         const bool doingRehash = needRehash();
         const size_t oldCapacity = _bufferEnd - _buffer;
+        const size_t oldBufferBytes = allocatedBytes();
 
         // make new bucket count big enough
         while (needRehash() || hashTabBuckets() < HASH_TAB_INIT_SIZE)
@@ -142,13 +207,13 @@ namespace mongo {
         uassert(16490, "Tried to make oversized document",
                 capacity <= size_t(BufferMaxSize));
 
-        boost::scoped_array<char> oldBuf(_buffer);
-        _buffer = new char[capacity];
+        char* const oldBuf = _buffer;
+        _buffer = static_cast<char*>(SmallBlockPool::allocate(capacity));
         _bufferEnd = _buffer + capacity - hashTabBytes();
 
         if (!firstAlloc) {
             // This just copies the elements
-            memcpy(_buffer, oldBuf.get(), _usedBytes);
+            memcpy(_buffer, oldBuf, _usedBytes);
 
             if (_numFields >= HASH_TAB_MIN) {
                 // if we were hashing, deal with the hash table
@@ -157,9 +222,11 @@ namespace mongo {
                 }
                 else {
                     // no rehash needed so just slide table down to new position
-                    memcpy(_hashTab, oldBuf.get() + oldCapacity, hashTabBytes());
+                    memcpy(_hashTab, oldBuf + oldCapacity, hashTabBytes());
                 }
             }
+
+            SmallBlockPool::release(oldBuf, oldBufferBytes);
         }
     }
 
@@ -177,27 +244,34 @@ namespace mongo {
         uassert(16491, "Tried to make oversized document",
                 newSize <= size_t(BufferMaxSize));
 
-        _buffer = new char[newSize + hashTabBytes()];
+        _buffer = static_cast<char*>(SmallBlockPool::allocate(newSize + hashTabBytes()));
         _bufferEnd = _buffer + newSize;
     }
 
     intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
         intrusive_ptr<DocumentStorage> out (new DocumentStorage());
 
-        // Make a copy of the buffer.
+        // Make a copy of the buffer, if there is one yet (there may not be if we came from
+        // BSON and nothing has been loaded).
         // It is very important that the positions of each field are the same after cloning.
-        const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
-        out->_buffer = new char[bufferBytes];
-        out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
-        memcpy(out->_buffer, _buffer, bufferBytes);
+        if (_buffer) {
+            const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
+            out->_buffer = static_cast<char*>(SmallBlockPool::allocate(bufferBytes));
+            out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
+            memcpy(out->_buffer, _buffer, bufferBytes);
+        }
 
         // Copy remaining fields
         out->_usedBytes = _usedBytes;
         out->_numFields = _numFields;
         out->_hashTabMask = _hashTabMask;
+        out->_bson = _bson;
+        out->_bsonOwner = _bsonOwner;
+        out->_bsonNext = _bsonNext;
+        out->_bsonValid = _bsonValid;
 
         // Tell values that they have been memcpyed (updates ref counts)
-        for (DocumentStorageIterator it = out->iteratorAll(); !it.atEnd(); it.advance()) {
+        for (DocumentStorageIterator it = out->loadedFields(); !it.atEnd(); it.advance()) {
             it->val.memcpyed();
         }
 
@@ -205,23 +279,19 @@ namespace mongo {
     }
 
     DocumentStorage::~DocumentStorage() {
-        boost::scoped_array<char> deleteBufferAtScopeEnd (_buffer);
-
-        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
+        for (DocumentStorageIterator it = loadedFields(); !it.atEnd(); it.advance()) {
             it->val.~Value(); // explicit destructor call
         }
+
+        SmallBlockPool::release(_buffer, allocatedBytes());
     }
 
     Document::Document(const BSONObj& bson) {
-        MutableDocument md(bson.nFields());
-
-        BSONObjIterator it(bson);
-        while(it.more()) {
-            BSONElement bsonElement(it.next());
-            md.addField(bsonElement.fieldNameStringData(), Value(bsonElement));
-        }
+        if (bson.isEmpty())
+            return;
 
-        *this = md.freeze();
+        const BSONObj owned = bson.getOwned();
+        _storage = new DocumentStorage(owned, owned);
     }
 
     BSONObjBuilder& operator << (BSONObjBuilderValueStream& builder, const Document& doc) {
@@ -232,12 +302,21 @@ namespace mongo {
     }
 
     void Document::toBson(BSONObjBuilder* pBuilder) const {
+        if (storage().hasBson()) {
+            // nothing has changed since we came from BSON, so just copy it
+            pBuilder->appendElements(storage().bson());
+            return;
+        }
+
         for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
             *pBuilder << it->nameSD() << it->val;
         }
     }
 
     BSONObj Document::toBson() const {
+        if (storage().hasBson())
+            return storage().bson().getOwned();
+
         BSONObjBuilder bb;
         toBson(&bb);
         return bb.obj();
@@ -322,6 +401,12 @@ namespace mongo {
         size_t size = sizeof(DocumentStorage);
         size += storage().allocatedBytes();
 
+        if (storage().hasBson()) {
+            // Don't load fields just to see how big they are.  Fields that already have
+            // been loaded are covered by the BSON's size.
+            return size + storage().bson().objsize();
+        }
+
         for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
             size += it->val.getApproximateSize();
             size -= sizeof(Value); // already accounted for above
@@ -68,7 +68,12 @@ namespace mongo {
         /// Empty Document (does no allocation)
         Document() {}
 
-        /// Create a new Document deep-converted from the given BSONObj.
+        /** Create a new Document from the given BSONObj.
+         *
+         *  The BSONObj is copied if it isn't owned, but nothing is converted up front.  Each
+         *  field becomes a Value the first time it is used, and as long as the Document is
+         *  not changed, converting it back to BSON just copies the original.
+         */
         explicit Document(const BSONObj& bson);
 
         void swap(Document& rhs) { _storage.swap(rhs._storage); }
@@ -94,7 +99,7 @@ namespace mongo {
         size_t size() const { return storage().size(); }
 
         /// True if this document has no fields.
-        bool empty() const { return !_storage || storage().iterator().atEnd(); }
+        bool empty() const { return !_storage || storage().empty(); }
 
         /// Create a new FieldIterator that can be used to examine the Document's fields in order.
         FieldIterator fieldIterator() const;
@@ -168,6 +173,7 @@ namespace mongo {
     private:
         friend class FieldIterator;
         friend class ValueStorage;
+        friend class DocumentStorage;
         friend class MutableDocument;
         friend class MutableValue;
 
@@ -392,7 +398,13 @@ namespace mongo {
                 return clonedStorage();
 
             // This function exists to ensure this is safe
-            return const_cast<DocumentStorage&>(*storagePtr());
+            DocumentStorage& ds = const_cast<DocumentStorage&>(*storagePtr());
+
+            // Once changed, a Document can't stand in for the BSON it came from.
+            if (MONGO_unlikely( ds.hasBson() ))
+                ds.dropBson();
+
+            return ds;
         }
         DocumentStorage& newStorage() {
             reset(new DocumentStorage);
@@ -400,7 +412,10 @@ namespace mongo {
         }
         DocumentStorage& clonedStorage() {
             reset(storagePtr()->clone().get());
-            return const_cast<DocumentStorage&>(*storagePtr());
+            DocumentStorage& ds = const_cast<DocumentStorage&>(*storagePtr());
+            if (ds.hasBson())
+                ds.dropBson();
+            return ds;
         }
 
         // recursive helpers for same-named public methods
@@ -166,9 +166,23 @@ namespace mongo {
                           , _usedBytes(0)
                           , _numFields(0)
                           , _hashTabMask(0)
+                          , _bsonNext(NULL)
+                          , _bsonValid(false)
         {}
+
+        /** Storage for the fields of 'bson', which are only converted to Values as they are
+         *  looked up.  'owner' must own the buffer 'bson' is in, which may be 'bson' itself.
+         */
+        DocumentStorage(const BSONObj& bson, const BSONObj& owner);
+
         ~DocumentStorage();
 
+        // Like small buffers, DocumentStorage objects are recycled through SmallBlockPool.
+        static void* operator new(size_t bytes) { return SmallBlockPool::allocate(bytes); }
+        static void operator delete(void* ptr, size_t bytes) {
+            SmallBlockPool::release(ptr, bytes);
+        }
+
         static const DocumentStorage& emptyDoc() {
             static const char emptyBytes[sizeof(DocumentStorage)] = {0};
             return *reinterpret_cast<const DocumentStorage*>(emptyBytes);
@@ -176,6 +190,7 @@ namespace mongo {
 
         size_t size() const {
             // can't use _numFields because it includes removed Fields
+            // (iterator() loads any fields still only in _bson)
             size_t count = 0;
             for (DocumentStorageIterator it = iterator(); !it.atEnd(); it.advance())
                 count++;
@@ -215,6 +230,22 @@ namespace mongo {
         /// Adds a new field with missing Value at the end of the document
         Value& appendField(StringData name);
 
+        /// True if this has no fields. Unlike size(), doesn't load fields from _bson.
+        bool empty() const {
+            return _bsonValid ? _bson.isEmpty() : iterator().atEnd();
+        }
+
+        /** True if the fields are still exactly those of the BSONObj this was created from, in
+         *  which case bson() can be used in place of converting the fields back to BSON.
+         */
+        bool hasBson() const { return _bsonValid; }
+        const BSONObj& bson() const { dassert(_bsonValid); return _bson; }
+
+        /** Loads any fields not yet converted and forgets the BSONObj this was created from.
+         *  MutableDocument calls this before making any change.
+         */
+        void dropBson();
+
         /** Preallocates space for fields. Use this to attempt to prevent buffer growth.
          *  This is only valid to call before anything is added to the document.
          */
@@ -222,11 +253,13 @@ namespace mongo {
 
         /// This skips missing values
         DocumentStorageIterator iterator() const {
+            loadAllFields();
             return DocumentStorageIterator(_firstElement, end(), false);
         }
 
         /// This includes missing values
         DocumentStorageIterator iteratorAll() const {
+            loadAllFields();
             return DocumentStorageIterator(_firstElement, end(), true);
         }
 
@@ -248,6 +281,18 @@ namespace mongo {
         /// Call after adding field to _buffer and increasing _numFields
         void addFieldToHashTable(Position pos);
 
+        /** Converts the next field of _bson that hasn't been yet, and returns its Position.
+         *  This is const because it doesn't change the logical contents of the document.
+         */
+        Position loadNextField() const;
+        void loadAllFields() const {
+            while (MONGO_unlikely(_bsonNext != NULL))
+                loadNextField();
+        }
+
+        /// Like Value(elem), but sub-documents are converted lazily and share _bsonOwner.
+        Value valueFromBson(const BSONElement& elem) const;
+
         // assumes _hashTabMask is (power of two) - 1
         unsigned hashTabBuckets() const { return _hashTabMask + 1; }
         unsigned hashTabBytes() const { return hashTabBuckets() * sizeof(Position); }
@@ -272,10 +317,15 @@ namespace mongo {
         /// Adds all fields to the hash table
         void rehash() {
             hashTabInit();
-            for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance())
+            for (DocumentStorageIterator it = loadedFields(); !it.atEnd(); it.advance())
                 addFieldToHashTable(it.position());
         }
 
+        /// Like iteratorAll(), but only over fields already loaded from _bson
+        DocumentStorageIterator loadedFields() const {
+            return DocumentStorageIterator(_firstElement, end(), true);
+        }
+
         enum {
             HASH_TAB_INIT_SIZE = 8, // must be power of 2
             HASH_TAB_MIN = 4, // don't hash fields for docs smaller than this
@@ -305,6 +355,17 @@ namespace mongo {
         unsigned _usedBytes; // position where next field would start
         unsigned _numFields; // this includes removed fields
         unsigned _hashTabMask; // equal to hashTabBuckets()-1 but used more often
+
+        // A Document created from a BSONObj starts out with no fields loaded.  Each field is
+        // converted to a Value the first time it is looked up, or when the fields are
+        // iterated, and appended to _buffer as if added in order.  Until something changes
+        // the document, _bson is also its exact BSON representation.
+        //
+        // These are only meaningful if _bsonValid.  Note that emptyDoc() is all zero bytes.
+        BSONObj _bson; // may point into _bsonOwner's buffer
+        BSONObj _bsonOwner;
+        const char* _bsonNext; // next element of _bson to load, or NULL if all are loaded
+        bool _bsonValid;
         // When adding a field, make sure to update clone() method
     };
 }
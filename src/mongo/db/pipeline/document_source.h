@@ -31,6 +31,7 @@
 #include "mongo/pch.h"
 
 #include <boost/optional.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/unordered_map.hpp>
 #include <deque>
 
@@ -46,6 +47,7 @@
 #include "mongo/s/shard.h"
 #include "mongo/s/strategy.h"
 #include "mongo/util/intrusive_counter.h"
+#include "mongo/util/queue.h"
 
 namespace mongo {
     class Accumulator;
@@ -54,6 +56,7 @@ namespace mongo {
     class Expression;
     class ExpressionFieldPath;
     class ExpressionObject;
+    class Pipeline;
     class DocumentSourceLimit;
 
     class DocumentSource : public IntrusiveCounterUnsigned {
@@ -417,9 +420,12 @@ namespace mongo {
 
         void setProjection(const BSONObj& projection, const ParsedDeps& deps);
 
-        /// returns -1 for no limit
+        /// returns -1 for no limit.  Documents dropped by the skip count toward the limit.
         long long getLimit() const;
 
+        /// How many documents are read and dropped before any are returned.
+        long long getSkip() const { return _skip; }
+
     private:
         DocumentSourceCursor(
             const string& ns,
@@ -436,7 +442,12 @@ namespace mongo {
         shared_ptr<Projection> _projection; // shared with pClientCursor
         ParsedDeps _dependencies;
         intrusive_ptr<DocumentSourceLimit> _limit;
-        long long _docsAddedToBatches; // for _limit enforcement
+        long long _docsAddedToBatches; // for _limit enforcement, including skipped documents
+        long long _skip;
+        long long _docsSkipped;
+
+        /// Counts the current document toward _skip, and returns whether it is to be dropped.
+        bool skipCurrent();
 
         string ns; // namespace
         CursorId _cursorId;
@@ -506,6 +517,26 @@ namespace mongo {
         /// Tell this source if it is doing a merge from shards. Defaults to false.
         void setDoingMerge(bool doingMerge) { _doingMerge = doingMerge; }
 
+        /**
+          Tell this source that all documents with the same _id arrive
+          together, so each group can be output as soon as the next one
+          starts instead of after the whole input is read.  Defaults to false.
+         */
+        void setStreaming(bool streaming) { _streaming = streaming; }
+
+        /**
+          Whether input sorted by 'sortPattern', a $sort specification, keeps
+          documents with the same _id together.  That is the case when the _id
+          is a field path, or an object of field paths, naming exactly the
+          leading fields of the sort.
+
+          If 'indexOrder', the documents come in the order of a single-key
+          index on the sort's fields rather than from a $sort.  Missing fields
+          then sort interleaved with nulls, so only a single field path _id,
+          which treats the two alike, qualifies.
+         */
+        bool isGroupedBy(const BSONObj& sortPattern, bool indexOrder = false) const;
+
         /**
           Create a grouping DocumentSource from BSON.
 
@@ -536,6 +567,36 @@ namespace mongo {
         // Only used by spill. Would be function-local if that were legal in C++03.
         class SpillSTLComparator;
 
+        /*
+          The partitioned alternative to spill().  Groups are written to one
+          of a number of files according to a hash of their _id, so every
+          state of a given group lands in the same partition.  Partitions are
+          then read back and aggregated one at a time.
+         */
+        class SpillPartitioner;
+
+        /// A finished partition, and how many times its groups were re-partitioned.
+        typedef pair<shared_ptr<Sorter<Value, Value>::Iterator>, int> Partition;
+
+        /// Write the groups map to 'partitioner' and clear it.
+        void spillToPartitions(SpillPartitioner* partitioner);
+
+        /// spill() or spillToPartitions(), as _partitionedSpill says.  Creates
+        /// '*partitioner' the first time it is needed.
+        void spillGroups(vector<shared_ptr<Sorter<Value, Value>::Iterator> >* sortedFiles,
+                         scoped_ptr<SpillPartitioner>* partitioner);
+
+        /**
+          Aggregate the last of _partitions into the groups map, and remove it
+          from _partitions.  If that partition alone goes over the memory
+          limit, it is split into further partitions instead, and the groups
+          map is left empty.
+         */
+        void loadNextPartition();
+
+        /// getNext() when _streaming.
+        boost::optional<Document> getNextStreaming();
+
         /*
           Before returning anything, this source must fetch everything from
           the underlying source and group it.  populate() is used to do that
@@ -568,22 +629,42 @@ namespace mongo {
         vector<intrusive_ptr<Expression> > vpExpression;
 
 
+        /// Evaluate the _id of the document _variables is set to.
+        Value computeId();
+
         Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
+        /// Serialize 'accums' for the Sorter.  The inverse of mergeAccumulators().
+        Value serializeAccumulators(const Accumulators& accums) const;
+
+        /// Merge the output of serializeAccumulators() into 'accums'.
+        void mergeAccumulators(const Value& state, Accumulators* accums) const;
+
         bool _doingMerge;
+        bool _streaming;
         bool _spilled;
         const bool _extSortAllowed;
         const int _maxMemoryUsageBytes;
+        const bool _partitionedSpill;
         boost::scoped_ptr<Variables> _variables;
 
         // only used when !_spilled
         GroupsMap::iterator groupsIterator;
 
-        // only used when _spilled
+        // only used when _spilled and _partitionedSpill, in which case
+        // groupsIterator walks the groups of the partition we last loaded.
+        vector<Partition> _partitions;
+
+        // only used when _spilled and !_partitionedSpill
         scoped_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
         pair<Value, Value> _firstPartOfNextGroup;
+
+        // used when _spilled and !_partitionedSpill, and when _streaming
         Value _currentId;
         Accumulators _currentAccumulators;
+
+        // only used when _streaming
+        boost::optional<Document> _firstDocOfNextGroup;
     };
 
 
@@ -658,6 +739,8 @@ namespace mongo {
          */
         vector<DBClientCursor*> getCursors();
 
+        ~DocumentSourceMergeCursors();
+
     private:
 
         struct CursorAndConnection {
@@ -669,6 +752,15 @@ namespace mongo {
         // using list to enable removing arbitrary elements
         typedef list<boost::shared_ptr<CursorAndConnection> > Cursors;
 
+        /* Documents read by a fetching thread from one cursor.  A Batch without documents is the
+         * last one from its cursor, and has errmsg set if reading the cursor failed.
+         */
+        struct Batch {
+            vector<BSONObj> docs;
+            string errmsg;
+        };
+        typedef boost::shared_ptr<Batch> BatchPtr;
+
         DocumentSourceMergeCursors(
             const CursorIds& cursorIds,
             const intrusive_ptr<ExpressionContext> &pExpCtx);
@@ -676,6 +768,19 @@ namespace mongo {
         // Converts _cursorIds into active _cursors.
         void start();
 
+        // Starts a thread per cursor that reads the cursor's batches into _batches, so that the
+        // shards are all read from at once rather than waiting on each other in turn.
+        void startFetching();
+
+        // Run by each fetching thread.
+        void fetchBatches(CursorAndConnection* cursor);
+
+        // Tells the fetching threads to stop and waits until they have.
+        void stopFetching();
+
+        // getNext() when reading from the fetching threads.
+        boost::optional<Document> getNextFetched();
+
         // This is the description of cursors to merge.
         const CursorIds _cursorIds;
 
@@ -684,6 +789,95 @@ namespace mongo {
         Cursors::iterator _currentCursor;
 
         bool _unstarted;
+
+        // Set while there are fetching threads that have not sent their last Batch.
+        bool _fetching;
+        AtomicUInt32 _stopFetching;
+        size_t _cursorsFetching;
+        boost::scoped_ptr<BlockingQueue<BatchPtr> > _batches;
+        boost::thread_group _fetchers;
+
+        // The Batch getNextFetched() is returning documents from.
+        BatchPtr _currentBatch;
+        size_t _currentBatchPos;
+    };
+
+    /**
+     * Runs copies of a pipeline on several threads, handing each one part of its own source's
+     * Documents, and returns all of their results.  PipelineD uses this to group a collection on
+     * several cores, with the workers' partial groups merged by a $group after this stage just as
+     * the groups from shards are.
+     *
+     * The source is only read from the thread calling getNext(), so it may take locks as usual.
+     */
+    class DocumentSourceParallel :
+        public DocumentSource {
+    public:
+        // virtuals from DocumentSource
+        virtual ~DocumentSourceParallel();
+        virtual boost::optional<Document> getNext();
+        virtual const char *getSourceName() const;
+        virtual void dispose();
+        virtual Value serialize(bool explain = false) const;
+
+        /**
+         * @param workerPipeline the serialized pipeline each worker runs, as sent to shards
+         * @param numWorkers how many threads to run it on
+         */
+        static intrusive_ptr<DocumentSourceParallel> create(
+            const BSONObj& workerPipeline,
+            size_t numWorkers,
+            const intrusive_ptr<ExpressionContext> &pExpCtx);
+
+        static const char name[];
+
+    private:
+        DocumentSourceParallel(const BSONObj& workerPipeline,
+                               size_t numWorkers,
+                               const intrusive_ptr<ExpressionContext> &pExpCtx);
+
+        // The source at the start of each worker's pipeline.
+        class WorkerSource;
+
+        // Parses the worker pipelines and starts their threads.
+        void start();
+
+        // Run by each worker thread.
+        void runWorker(DocumentSource* output);
+
+        // Called by WorkerSources: swaps the next batch of input into 'batch', returning false at
+        // the end of the input.
+        bool getInput(vector<Document>* batch);
+
+        // Called by workers: hands 'docs' to getNext() and clears it.
+        void putOutput(vector<BSONObj>* docs);
+
+        // Tells the workers to stop and waits until they have.
+        void stopWorkers();
+
+        const BSONObj _workerPipeline;
+        const size_t _numWorkers;
+        bool _unstarted;
+
+        vector<intrusive_ptr<Pipeline> > _workers;
+        boost::thread_group _threads;
+
+        // Everything below is shared with the worker threads, and guarded by _mutex.
+        mongo::mutex _mutex;
+        boost::condition _inputOrStop; // workers wait on this for input, or room for output
+        boost::condition _outputOrRoom; // getNext() waits on this for output, or room for input
+        deque<vector<Document> > _input;
+        bool _inputDone;
+        deque<vector<BSONObj> > _output;
+        size_t _workersRunning;
+        bool _stopping;
+        bool _workerFailed; // the first failure's message and code are kept
+        string _workerErrmsg;
+        int _workerErrcode;
+
+        // The results getNext() is returning.
+        vector<BSONObj> _currentOutput;
+        size_t _currentOutputPos;
     };
 
     class DocumentSourceOut : public DocumentSource
@@ -764,6 +958,18 @@ namespace mongo {
         /** projection as specified by the user */
         BSONObj getRaw() const { return _raw; }
 
+        /**
+          Rewrite 'query', a $match on the output of this projection, as the
+          same $match on its input, so that it can run before the projection.
+
+          This is only possible when every field the query names is a whole
+          top-level field of the input that was included or renamed, as in
+          {a: true} or {x: "$a"}.
+
+          @returns true and sets *inputQuery if the query could be rewritten
+         */
+        bool matchOnInput(const BSONObj& query, BSONObj* inputQuery) const;
+
     private:
         DocumentSourceProject(const intrusive_ptr<ExpressionContext>& pExpCtx,
                               const intrusive_ptr<ExpressionObject>& exprObj);
@@ -132,8 +132,12 @@ namespace mongo {
             // grab the matching document
             if (canUseCoveredIndex(cursor)) {
                 // Can't have collection metadata if we are here
-                BSONObj indexKey = cursor->currKey();
-                _currentBatch.push_back(Document(cursor->c()->keyFieldsOnly()->hydrate(indexKey)));
+                if (!skipCurrent()) {
+                    BSONObj indexKey = cursor->currKey();
+                    _currentBatch.push_back(
+                        Document(cursor->c()->keyFieldsOnly()->hydrate(indexKey)));
+                    memUsageBytes += _currentBatch.back().getApproximateSize();
+                }
             }
             else {
                 BSONObj next = cursor->current();
@@ -145,9 +149,12 @@ namespace mongo {
                     if ( !_collMetadata->keyBelongsToMe( kp.extractSingleKey( next ) ) ) continue;
                 }
 
-                _currentBatch.push_back(_projection
-                                            ? documentFromBsonWithDeps(next, _dependencies)
-                                            : Document(next));
+                if (!skipCurrent()) {
+                    _currentBatch.push_back(_projection
+                                                ? documentFromBsonWithDeps(next, _dependencies)
+                                                : Document(next));
+                    memUsageBytes += _currentBatch.back().getApproximateSize();
+                }
             }
 
             if (_limit) {
@@ -157,8 +164,6 @@ namespace mongo {
                 verify(_docsAddedToBatches < _limit->getLimit());
             }
 
-            memUsageBytes += _currentBatch.back().getApproximateSize();
-
             if (memUsageBytes > MaxBytesToReturnToClientAtOnce) {
                 // End this batch and prepare cursor for yielding.
                 cursor->advance();
@@ -187,24 +192,44 @@ namespace mongo {
         verify(false);
     }
 
+    bool DocumentSourceCursor::skipCurrent() {
+        if (_docsSkipped == _skip)
+            return false;
+
+        _docsSkipped++;
+        return true;
+    }
+
     long long DocumentSourceCursor::getLimit() const {
         return _limit ? _limit->getLimit() : -1;
     }
 
     bool DocumentSourceCursor::coalesce(const intrusive_ptr<DocumentSource>& nextSource) {
-        // Note: Currently we assume the $limit is logically after any $sort or
-        // $match. If we ever pull in $match or $sort using this method, we
-        // will need to keep track of the order of the sub-stages.
+        // Note: Currently we assume the $limit and $skip are logically after
+        // any $sort or $match. If we ever pull in $match or $sort using this
+        // method, we will need to keep track of the order of the sub-stages.
+
+        // Both are kept in terms of the documents the cursor returns, so a
+        // $limit after a $skip lets through that many more of them.
+        if (DocumentSourceSkip* skip = dynamic_cast<DocumentSourceSkip*>(nextSource.get())) {
+            _skip += skip->getSkip();
+            return true;
+        }
+
+        DocumentSourceLimit* limit = dynamic_cast<DocumentSourceLimit*>(nextSource.get());
+        if (!limit)
+            return false;
 
+        const long long newLimit = _skip + limit->getLimit();
         if (!_limit) {
-            _limit = dynamic_cast<DocumentSourceLimit*>(nextSource.get());
-            return _limit; // false if next is not a $limit
+            _limit = limit;
+            _limit->setLimit(newLimit);
         }
         else {
-            return _limit->coalesce(nextSource);
+            _limit->setLimit(min(_limit->getLimit(), newLimit));
         }
 
-        return false;
+        return true;
     }
 
     Value DocumentSourceCursor::serialize(bool explain) const {
@@ -227,6 +252,7 @@ namespace mongo {
             DOC("query" << Value(_query)
              << "sort" << (!_sort.isEmpty() ? Value(_sort) : Value())
              << "limit" << (_limit ? Value(_limit->getLimit()) : Value())
+             << "skip" << (_skip ? Value(_skip) : Value())
              << "fields" << (_projection ? Value(_projection->getSpec()) : Value())
              << "indexOnly" << canUseCoveredIndex(cursor)
              << "cursorType" << cursor->c()->toString()
@@ -238,6 +264,8 @@ namespace mongo {
                                                const intrusive_ptr<ExpressionContext> &pCtx)
         : DocumentSource(pCtx)
         , _docsAddedToBatches(0)
+        , _skip(0)
+        , _docsSkipped(0)
         , ns(ns)
         , _cursorId(cursorId)
         , _collMetadata(shardingState.needCollectionMetadata( ns )
@@ -36,10 +36,28 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
     const char DocumentSourceGroup::groupName[] = "$group";
 
+    // How many bytes of groups $group may hold in memory before it spills them to disk.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupMaxMemoryBytes, int,
+                                  100 * 1024 * 1024);
+
+    // If true, $group spills its groups to files partitioned on a hash of their _id rather than
+    // to sorted runs that are merged at the end.  The groups then come out in no particular order.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupPartitionedSpill, bool, false);
+
+    namespace {
+        // How many partitions a partitioned spill writes to.
+        const size_t numSpillPartitions = 16;
+
+        // How many times a partition that doesn't fit in memory may be split further.  One that
+        // is still too big after that is aggregated in memory anyway.
+        const int maxSpillPartitionLevel = 3;
+    }
+
     const char *DocumentSourceGroup::getSourceName() const {
         return groupName;
     }
@@ -47,9 +65,30 @@ namespace mongo {
     boost::optional<Document> DocumentSourceGroup::getNext() {
         pExpCtx->checkForInterrupt();
 
+        if (_streaming)
+            return getNextStreaming();
+
         if (!populated)
             populate();
 
+        if (_spilled && _partitionedSpill) {
+            while (groupsIterator == groups.end()) {
+                if (_partitions.empty())
+                    return boost::none;
+
+                loadNextPartition();
+            }
+
+            Document out = makeDocument(groupsIterator->first,
+                                        groupsIterator->second,
+                                        pExpCtx->inShard);
+
+            if (++groupsIterator == groups.end() && _partitions.empty())
+                dispose();
+
+            return out;
+        }
+
         if (_spilled) {
             if (!_sorterIterator)
                 return boost::none;
@@ -63,26 +102,7 @@ namespace mongo {
             while (_currentId == _firstPartOfNextGroup.first) {
                 // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
                 // At loop exit, it is the first value to be processed in the next group.
-
-                switch (numAccumulators) { // mirrors switch in spill()
-                case 0: // no Accumulators so no Values
-                    break;
-
-                case 1: // single accumulators serialize as a single Value
-                    _currentAccumulators[0]->process(_firstPartOfNextGroup.second,
-                                                     /*merging=*/true);
-                    break;
-
-                default: { // multiple accumulators serialize as an array
-                    const vector<Value>& accumulatorStates =
-                        _firstPartOfNextGroup.second.getArray();
-                    for (size_t i=0; i < numAccumulators; i++) {
-                        _currentAccumulators[i]->process(accumulatorStates[i],
-                                                         /*merging=*/true);
-                    }
-                    break;
-                }
-                }
+                mergeAccumulators(_firstPartOfNextGroup.second, &_currentAccumulators);
 
                 if (!_sorterIterator->more()) {
                     dispose();
@@ -109,10 +129,59 @@ namespace mongo {
         }
     }
 
+    boost::optional<Document> DocumentSourceGroup::getNextStreaming() {
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+
+        if (!populated) {
+            _currentAccumulators.reserve(numAccumulators);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _currentAccumulators.push_back(vpAccumulatorFactory[i]());
+            }
+
+            _firstDocOfNextGroup = pSource->getNext();
+            populated = true;
+        }
+
+        if (!_firstDocOfNextGroup)
+            return boost::none;
+
+        for (size_t i = 0; i < numAccumulators; i++) {
+            _currentAccumulators[i]->reset(); // prep accumulators for a new group
+        }
+
+        _variables->setRoot(*_firstDocOfNextGroup);
+        _currentId = computeId();
+        while (true) {
+            // Inside of this loop, _variables is set to the current document of the group.
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _currentAccumulators[i]->process(vpExpression[i]->evaluate(_variables.get()),
+                                                 _doingMerge);
+            }
+            _variables->clearRoot();
+
+            _firstDocOfNextGroup = pSource->getNext();
+            if (!_firstDocOfNextGroup) {
+                dispose();
+                break;
+            }
+
+            _variables->setRoot(*_firstDocOfNextGroup);
+            if (Value::compare(computeId(), _currentId) != 0) {
+                // This document starts the next group.
+                _variables->clearRoot();
+                break;
+            }
+        }
+
+        return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
+    }
+
     void DocumentSourceGroup::dispose() {
         // free our resources
         GroupsMap().swap(groups);
         _sorterIterator.reset();
+        _partitions.clear();
+        _firstDocOfNextGroup = boost::none;
 
         // make us look done
         groupsIterator = groups.end();
@@ -127,6 +196,13 @@ namespace mongo {
         for (size_t i = 0; i < vFieldName.size(); i++) {
              vpExpression[i] = vpExpression[i]->optimize();
         }
+
+        // The _id and the accumulators' arguments are evaluated for the same document.
+        vector<intrusive_ptr<Expression>*> expressions(1, &pIdExpression);
+        for (size_t i = 0; i < vpExpression.size(); i++) {
+            expressions.push_back(&vpExpression[i]);
+        }
+        _variables->setNumSharedValues(Expression::shareCommonSubexpressions(expressions));
     }
 
     Value DocumentSourceGroup::serialize(bool explain) const {
@@ -177,9 +253,11 @@ namespace mongo {
         : DocumentSource(pExpCtx)
         , populated(false)
         , _doingMerge(false)
+        , _streaming(false)
         , _spilled(false)
         , _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter)
-        , _maxMemoryUsageBytes(100*1024*1024)
+        , _maxMemoryUsageBytes(internalDocumentSourceGroupMaxMemoryBytes)
+        , _partitionedSpill(internalDocumentSourceGroupPartitionedSpill)
     {}
 
     void DocumentSourceGroup::addAccumulator(
@@ -351,79 +429,292 @@ namespace mongo {
         };
     }
 
-    void DocumentSourceGroup::populate() {
-        const size_t numAccumulators = vpAccumulatorFactory.size();
-        dassert(numAccumulators == vpExpression.size());
+    class DocumentSourceGroup::SpillPartitioner {
+    public:
+        SpillPartitioner(const string& tempDir, int level) : _level(level) {
+            for (size_t i = 0; i < numSpillPartitions; i++) {
+                _writers.push_back(
+                    shared_ptr<Writer>(new Writer(SortOptions().TempDir(tempDir))));
+                _counts.push_back(0);
+            }
+        }
 
-        // pushed to on spill()
-        vector<shared_ptr<Sorter<Value, Value>::Iterator> > sortedFiles;
-        int memoryUsageBytes = 0;
+        void add(const Value& id, const Value& state) {
+            const size_t i = partitionOf(Value::Hash()(id));
+            _writers[i]->addAlreadySorted(id, state);
+            _counts[i]++;
+        }
 
-        // This loop consumes all input from pSource and buckets it based on pIdExpression.
-        while (boost::optional<Document> input = pSource->getNext()) {
-            if (memoryUsageBytes > _maxMemoryUsageBytes) {
-                uassert(16945, "Exceeded memory limit for $group, but didn't allow external sort",
-                        _extSortAllowed);
-                sortedFiles.push_back(spill());
-                memoryUsageBytes = 0;
+        /// Finish writing, and append the partitions that got any groups to 'out'.
+        void done(vector<Partition>* out) {
+            for (size_t i = 0; i < _writers.size(); i++) {
+                if (_counts[i] != 0) {
+                    out->push_back(Partition(shared_ptr<Sorter<Value, Value>::Iterator>(
+                                                 _writers[i]->done()),
+                                             _level));
+                }
             }
+            _writers.clear();
+        }
 
-            _variables->setRoot(*input);
+    private:
+        typedef SortedFileWriter<Value, Value> Writer;
+
+        /*
+          Scramble the hash differently at each level, so that the groups of
+          a partition that is split again are spread over all the new ones.
+          The mixing steps are MurmurHash3's 64-bit finalizer.
+         */
+        size_t partitionOf(size_t hash) const {
+            unsigned long long h = hash + 0x9e3779b97f4a7c15ULL * (_level + 1);
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h % _writers.size();
+        }
 
-            /* get the _id value */
-            Value id = pIdExpression->evaluate(_variables.get());
+        const int _level;
+        vector<shared_ptr<Writer> > _writers;
+        vector<size_t> _counts;
+    };
 
-            /* treat missing values the same as NULL SERVER-4674 */
-            if (id.missing())
-                id = Value(BSONNULL);
+    void DocumentSourceGroup::spillToPartitions(SpillPartitioner* partitioner) {
+        for (GroupsMap::const_iterator it=groups.begin(), end=groups.end(); it != end; ++it) {
+            partitioner->add(it->first, serializeAccumulators(it->second));
+        }
 
-            /*
-              Look for the _id value in the map; if it's not there, add a
-              new entry with a blank accumulator.
-            */
-            const size_t oldSize = groups.size();
-            vector<intrusive_ptr<Accumulator> >& group = groups[id];
-            const bool inserted = groups.size() != oldSize;
+        groups.clear();
+    }
 
-            if (inserted) {
-                memoryUsageBytes += id.getApproximateSize();
+    void DocumentSourceGroup::loadNextPartition() {
+        verify(!_partitions.empty());
+        const Partition partition = _partitions.back();
+        _partitions.pop_back();
 
-                // Add the accumulators
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+        Sorter<Value, Value>::Iterator* it = partition.first.get();
+        GroupsMap().swap(groups);
+        int memoryUsageBytes = 0;
+        while (it->more()) {
+            if (memoryUsageBytes > _maxMemoryUsageBytes
+                    && partition.second < maxSpillPartitionLevel) {
+                // This partition doesn't fit either, so split it up.
+                SpillPartitioner partitioner(pExpCtx->tempDir, partition.second + 1);
+                spillToPartitions(&partitioner);
+                while (it->more()) {
+                    const pair<Value, Value> data = it->next();
+                    partitioner.add(data.first, data.second);
+                }
+                partitioner.done(&_partitions);
+                break;
+            }
+
+            const pair<Value, Value> data = it->next();
+            const size_t oldSize = groups.size();
+            Accumulators& group = groups[data.first];
+            if (groups.size() != oldSize) {
+                memoryUsageBytes += data.first.getApproximateSize();
                 group.reserve(numAccumulators);
                 for (size_t i = 0; i < numAccumulators; i++) {
                     group.push_back(vpAccumulatorFactory[i]());
                 }
             } else {
                 for (size_t i = 0; i < numAccumulators; i++) {
-                    // subtract old mem usage. New usage added back after processing.
                     memoryUsageBytes -= group[i]->memUsageForSorter();
                 }
             }
 
-            /* tickle all the accumulators for the group we found */
-            dassert(numAccumulators == group.size());
+            mergeAccumulators(data.second, &group);
             for (size_t i = 0; i < numAccumulators; i++) {
-                group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
                 memoryUsageBytes += group[i]->memUsageForSorter();
             }
+        }
 
-            // We are done with the ROOT document so release it.
-            _variables->clearRoot();
+        groupsIterator = groups.begin();
+    }
 
-            DEV {
-                // In debug mode, spill every time we have a duplicate id to stress merge logic.
-                if (!inserted // is a dup
-                        && !pExpCtx->inRouter // can't spill to disk in router
-                        && !_extSortAllowed // don't change behavior when testing external sort
-                        && sortedFiles.size() < 20 // don't open too many FDs
-                        ) {
-                    sortedFiles.push_back(spill());
+    Value DocumentSourceGroup::computeId() {
+        Value id = pIdExpression->evaluate(_variables.get());
+
+        /* treat missing values the same as NULL SERVER-4674 */
+        if (id.missing())
+            return Value(BSONNULL);
+
+        return id;
+    }
+
+    bool DocumentSourceGroup::isGroupedBy(const BSONObj& sortPattern, bool indexOrder) const {
+        // The paths the _id is made of, as $sort would name them.
+        set<string> idPaths;
+        const Value idSpec = pIdExpression->serialize(false);
+        if (idSpec.getType() == String) {
+            idPaths.insert(idSpec.getString());
+        }
+        else if (idSpec.getType() == Object && !indexOrder) {
+            FieldIterator fields(idSpec.getDocument());
+            while (fields.more()) {
+                const Value field = fields.next().second;
+                if (field.getType() != String)
+                    return false;
+                idPaths.insert(field.getString());
+            }
+        }
+        else {
+            return false;
+        }
+
+        for (set<string>::const_iterator it = idPaths.begin(); it != idPaths.end(); ++it) {
+            // "$$ROOT", "$$CURRENT" and variables aren't fields of the input
+            if (it->size() < 2 || (*it)[0] != '$' || (*it)[1] == '$')
+                return false;
+        }
+
+        // The _id's fields must be the first idPaths.size() fields of the sort, in any order.
+        BSONObjIterator sortFields(sortPattern);
+        for (size_t i = 0; i < idPaths.size(); i++) {
+            if (!sortFields.more())
+                return false;
+            if (!idPaths.count(string("$") + sortFields.next().fieldName()))
+                return false;
+        }
+
+        return true;
+    }
+
+    void DocumentSourceGroup::populate() {
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+        dassert(numAccumulators == vpExpression.size());
+
+        // pushed to on spill()
+        vector<shared_ptr<Sorter<Value, Value>::Iterator> > sortedFiles;
+        int memoryUsageBytes = 0;
+
+        // only used if _partitionedSpill, once we first run out of memory
+        scoped_ptr<SpillPartitioner> partitioner;
+        size_t numSpills = 0;
+
+        /*
+          Input is consumed in batches.  For each batch we first evaluate the
+          _id and the accumulated expressions of every document, giving a
+          column of Values per expression.  Then each run of consecutive
+          documents with the same _id costs one lookup in the groups map, and
+          each accumulator processes the run's slice of its column in one
+          call.  Input sorted on the group key, as in time-bucketed rollups,
+          makes for long runs.
+        */
+        const size_t batchSize = 1024;
+        vector<Value> ids;
+        vector<vector<Value> > columns(numAccumulators);
+        ids.reserve(batchSize);
+        for (size_t i = 0; i < numAccumulators; i++) {
+            columns[i].reserve(batchSize);
+        }
+
+        // This loop consumes all input from pSource and buckets it based on pIdExpression.
+        bool sourceExhausted = false;
+        while (!sourceExhausted) {
+            ids.clear();
+            for (size_t i = 0; i < numAccumulators; i++) {
+                columns[i].clear();
+            }
+
+            while (ids.size() < batchSize) {
+                boost::optional<Document> input = pSource->getNext();
+                if (!input) {
+                    sourceExhausted = true;
+                    break;
+                }
+
+                _variables->setRoot(*input);
+
+                /* get the _id value */
+                ids.push_back(computeId());
+
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    columns[i].push_back(vpExpression[i]->evaluate(_variables.get()));
+                }
+
+                // We are done with the ROOT document so release it.
+                _variables->clearRoot();
+            }
+
+            const size_t batchLen = ids.size();
+            size_t runStart = 0;
+            while (runStart < batchLen) {
+                const Value& id = ids[runStart];
+                size_t runEnd = runStart + 1;
+                while (runEnd < batchLen && Value::compare(ids[runEnd], id) == 0)
+                    runEnd++;
+
+                if (memoryUsageBytes > _maxMemoryUsageBytes) {
+                    uassert(16945,
+                            "Exceeded memory limit for $group, but didn't allow external sort",
+                            _extSortAllowed);
+                    spillGroups(&sortedFiles, &partitioner);
+                    numSpills++;
+                    memoryUsageBytes = 0;
+                }
+
+                /*
+                  Look for the _id value in the map; if it's not there, add a
+                  new entry with a blank accumulator.
+                */
+                const size_t oldSize = groups.size();
+                vector<intrusive_ptr<Accumulator> >& group = groups[id];
+                const bool inserted = groups.size() != oldSize;
+
+                if (inserted) {
+                    memoryUsageBytes += id.getApproximateSize();
+
+                    // Add the accumulators
+                    group.reserve(numAccumulators);
+                    for (size_t i = 0; i < numAccumulators; i++) {
+                        group.push_back(vpAccumulatorFactory[i]());
+                    }
+                } else {
+                    for (size_t i = 0; i < numAccumulators; i++) {
+                        // subtract old mem usage. New usage added back after processing.
+                        memoryUsageBytes -= group[i]->memUsageForSorter();
+                    }
                 }
+
+                /* tickle all the accumulators for the group we found */
+                dassert(numAccumulators == group.size());
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    group[i]->processBatch(&columns[i][runStart], runEnd - runStart, _doingMerge);
+                    memoryUsageBytes += group[i]->memUsageForSorter();
+                }
+
+                DEV {
+                    // In debug mode, spill every time we have a duplicate id to stress merge logic.
+                    if ((!inserted || runEnd - runStart > 1) // is a dup
+                            && !pExpCtx->inRouter // can't spill to disk in router
+                            && !_extSortAllowed // don't change behavior when testing external sort
+                            && numSpills < 20 // don't open too many FDs
+                            ) {
+                        spillGroups(&sortedFiles, &partitioner);
+                        numSpills++;
+                    }
+                }
+
+                runStart = runEnd;
             }
         }
 
         // These blocks do any final steps necessary to prepare to output results.
-        if (!sortedFiles.empty()) {
+        if (partitioner) {
+            _spilled = true;
+            if (!groups.empty()) {
+                spillToPartitions(partitioner.get());
+            }
+
+            // Groups will be loaded a partition at a time by getNext().
+            GroupsMap().swap(groups);
+            partitioner->done(&_partitions);
+            groupsIterator = groups.end();
+        } else if (!sortedFiles.empty()) {
             _spilled = true;
             if (!groups.empty()) {
                 sortedFiles.push_back(spill());
@@ -469,34 +760,65 @@ namespace mongo {
         stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator());
 
         SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-        switch (vpAccumulatorFactory.size()) { // same as ptrs[i]->second.size() for all i.
+        for (size_t i=0; i < ptrs.size(); i++) {
+            writer.addAlreadySorted(ptrs[i]->first, serializeAccumulators(ptrs[i]->second));
+        }
+
+        groups.clear();
+
+        return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+    }
+
+    void DocumentSourceGroup::spillGroups(
+            vector<shared_ptr<Sorter<Value, Value>::Iterator> >* sortedFiles,
+            scoped_ptr<SpillPartitioner>* partitioner) {
+        if (!_partitionedSpill) {
+            sortedFiles->push_back(spill());
+            return;
+        }
+
+        if (!*partitioner) {
+            partitioner->reset(new SpillPartitioner(pExpCtx->tempDir, 0));
+        }
+        spillToPartitions(partitioner->get());
+    }
+
+    Value DocumentSourceGroup::serializeAccumulators(const Accumulators& accums) const {
+        switch (accums.size()) {
         case 0: // no values, essentially a distinct
-            for (size_t i=0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
-            break;
+            return Value();
 
         case 1: // just one value, use optimized serialization as single Value
-            for (size_t i=0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+            return accums[0]->getValue(/*toBeMerged=*/true);
+
+        default: { // multiple values, serialize as array-typed Value
+            vector<Value> states;
+            states.reserve(accums.size());
+            for (size_t i=0; i < accums.size(); i++) {
+                states.push_back(accums[i]->getValue(/*toBeMerged=*/true));
             }
+            return Value::consume(states);
+        }
+        }
+    }
+
+    void DocumentSourceGroup::mergeAccumulators(const Value& state, Accumulators* accums) const {
+        switch (accums->size()) { // mirrors switch in serializeAccumulators()
+        case 0: // no Accumulators so no Values
             break;
 
-        default: // multiple values, serialize as array-typed Value
-            for (size_t i=0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j=0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
-                }
-                writer.addAlreadySorted(ptrs[i]->first, Value::consume(accums));
+        case 1: // single accumulators serialize as a single Value
+            (*accums)[0]->process(state, /*merging=*/true);
+            break;
+
+        default: { // multiple accumulators serialize as an array
+            const vector<Value>& accumulatorStates = state.getArray();
+            for (size_t i=0; i < accums->size(); i++) {
+                (*accums)[i]->process(accumulatorStates[i], /*merging=*/true);
             }
             break;
         }
-
-        groups.clear();
-
-        return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+        }
     }
 
     Document DocumentSourceGroup::makeDocument(const Value& id,
@@ -30,11 +30,21 @@
 
 #include "mongo/db/pipeline/document_source.h"
 
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
     const char DocumentSourceMergeCursors::name[] = "$mergeCursors";
 
+    // If true, $mergeCursors reads each shard's cursor on its own thread, so a slow getMore to one
+    // shard doesn't hold up the documents already sent by the others.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceMergeCursorsParallelFetch, bool, true);
+
+    namespace {
+        // How many Batches each fetching thread may get ahead of getNext().
+        const size_t batchesAheadPerCursor = 1;
+    }
+
     const char* DocumentSourceMergeCursors::getSourceName() const {
         return name;
     }
@@ -50,8 +60,16 @@ namespace mongo {
         : DocumentSource(pExpCtx)
         , _cursorIds(cursorIds)
         , _unstarted(true)
+        , _fetching(false)
+        , _cursorsFetching(0)
+        , _currentBatchPos(0)
     {}
 
+    DocumentSourceMergeCursors::~DocumentSourceMergeCursors() {
+        // The fetching threads use this object so they must be finished before it goes away.
+        stopFetching();
+    }
+
     intrusive_ptr<DocumentSource> DocumentSourceMergeCursors::create(
             const CursorIds& cursorIds,
             const intrusive_ptr<ExpressionContext> &pExpCtx) {
@@ -132,9 +150,98 @@ namespace mongo {
         _currentCursor = _cursors.begin();
     }
 
+    void DocumentSourceMergeCursors::startFetching() {
+        // Each thread has at most one Batch waiting to be pushed beyond those the queue holds.
+        _batches.reset(new BlockingQueue<BatchPtr>(_cursors.size() * batchesAheadPerCursor + 1));
+        _fetching = true;
+        for (Cursors::const_iterator it = _cursors.begin(); it != _cursors.end(); ++it) {
+            _fetchers.create_thread(boost::bind(&DocumentSourceMergeCursors::fetchBatches,
+                                                this, it->get()));
+            _cursorsFetching++;
+        }
+    }
+
+    void DocumentSourceMergeCursors::fetchBatches(CursorAndConnection* cursor) {
+        BatchPtr last = boost::make_shared<Batch>();
+        try {
+            while (!_stopFetching.load() && cursor->cursor.more()) {
+                BatchPtr batch = boost::make_shared<Batch>();
+                do {
+                    BSONObj next = cursor->cursor.next();
+                    if (next.hasField("$err")) {
+                        last->errmsg = str::stream() << "Received error in response from "
+                                                     << cursor->connection->toString()
+                                                     << ": " << next;
+                        break;
+                    }
+                    batch->docs.push_back(next.getOwned());
+                } while (cursor->cursor.moreInCurrentBatch());
+
+                if (!batch->docs.empty())
+                    _batches->push(batch);
+                if (!last->errmsg.empty())
+                    break;
+            }
+
+            if (!_stopFetching.load() && last->errmsg.empty())
+                cursor->connection.done();
+        }
+        catch (const std::exception& e) {
+            last->errmsg = str::stream() << "error reading response from "
+                                         << cursor->connection->toString() << ": " << e.what();
+        }
+
+        _batches->push(last);
+    }
+
+    void DocumentSourceMergeCursors::stopFetching() {
+        if (!_fetching)
+            return;
+
+        // Every thread sends a last Batch once it sees _stopFetching, which it can only do while
+        // we are taking Batches off the queue.
+        _stopFetching.store(1);
+        while (_cursorsFetching) {
+            if (_batches->blockingPop()->docs.empty())
+                _cursorsFetching--;
+        }
+        _fetchers.join_all();
+
+        _fetching = false;
+        _currentBatch.reset();
+    }
+
+    boost::optional<Document> DocumentSourceMergeCursors::getNextFetched() {
+        while (!_currentBatch || _currentBatchPos == _currentBatch->docs.size()) {
+            if (!_cursorsFetching)
+                return boost::none;
+
+            BatchPtr batch;
+            while (!_batches->blockingPop(batch, 1)) {
+                pExpCtx->checkForInterrupt();
+            }
+
+            if (batch->docs.empty()) {
+                _cursorsFetching--;
+                uassert(17278, batch->errmsg, batch->errmsg.empty());
+            }
+
+            _currentBatch = batch;
+            _currentBatchPos = 0;
+        }
+
+        return Document(_currentBatch->docs[_currentBatchPos++]);
+    }
+
     boost::optional<Document> DocumentSourceMergeCursors::getNext() {
-        if (_unstarted)
+        if (_unstarted) {
             start();
+            if (internalDocumentSourceMergeCursorsParallelFetch)
+                startFetching();
+        }
+
+        if (_fetching)
+            return getNextFetched();
 
         // purge eof cursors and release their connections
         while (!_cursors.empty() && !(*_currentCursor)->cursor.more()) {
@@ -160,6 +267,7 @@ namespace mongo {
     }
 
     void DocumentSourceMergeCursors::dispose() {
+        stopFetching();
         _cursors.clear();
         _currentCursor = _cursors.end();
     }
@@ -0,0 +1,313 @@
+/**
+ * Copyright 2013 (c) 10gen Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects for
+ * all of the code used other than as permitted herein. If you modify file(s)
+ * with this exception, you may extend this exception to your version of the
+ * file(s), but you are not obligated to do so. If you do not wish to do so,
+ * delete this exception statement from your version. If you delete this
+ * exception statement from all source files in the program, then also delete
+ * it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/db/pipeline/document_source.h"
+
+#include "mongo/db/pipeline/pipeline.h"
+
+namespace mongo {
+
+    const char DocumentSourceParallel::name[] = "$parallel";
+
+    namespace {
+        // How many Documents are handed to a worker at a time.
+        const size_t inputBatchSize = 128;
+
+        // How many results a worker sends back at a time.
+        const size_t outputBatchSize = 128;
+
+        // How many batches of input or output may wait for each worker.
+        const size_t batchesPerWorker = 2;
+
+        /**
+         * The workers' pipelines don't check for interrupts themselves: getNext() does while it
+         * waits for them, and stops them if the operation is killed.
+         */
+        class InterruptStatusWorker : public InterruptStatus {
+        public:
+            virtual void checkForInterrupt() const {}
+            virtual const char *checkForInterruptNoAssert() const { return ""; }
+        };
+
+        const InterruptStatusWorker interruptStatusWorker;
+    }
+
+    class DocumentSourceParallel::WorkerSource : public DocumentSource {
+    public:
+        WorkerSource(DocumentSourceParallel* parallel,
+                     const intrusive_ptr<ExpressionContext>& pExpCtx)
+            : DocumentSource(pExpCtx)
+            , _parallel(parallel)
+            , _pos(0)
+        {}
+
+        virtual boost::optional<Document> getNext() {
+            if (_pos == _batch.size()) {
+                _pos = 0;
+                if (!_parallel->getInput(&_batch))
+                    return boost::none;
+            }
+
+            // Not keeping a reference lets later stages modify the Document in place.
+            Document next = _batch[_pos];
+            _batch[_pos++] = Document();
+            return next;
+        }
+
+        virtual void setSource(DocumentSource *pSource) {
+            /* this doesn't take a source */
+            verify(false);
+        }
+
+        virtual bool isValidInitialSource() const { return true; }
+
+    private:
+        virtual Value serialize(bool explain = false) const {
+            return Value();
+        }
+
+        DocumentSourceParallel* const _parallel;
+        vector<Document> _batch;
+        size_t _pos;
+    };
+
+    DocumentSourceParallel::DocumentSourceParallel(
+            const BSONObj& workerPipeline,
+            size_t numWorkers,
+            const intrusive_ptr<ExpressionContext> &pExpCtx)
+        : DocumentSource(pExpCtx)
+        , _workerPipeline(workerPipeline.getOwned())
+        , _numWorkers(numWorkers)
+        , _unstarted(true)
+        , _mutex("DocumentSourceParallel")
+        , _inputDone(false)
+        , _workersRunning(0)
+        , _stopping(false)
+        , _workerFailed(false)
+        , _workerErrcode(0)
+        , _currentOutputPos(0)
+    {}
+
+    DocumentSourceParallel::~DocumentSourceParallel() {
+        // The worker threads use this object so they must be finished before it goes away.
+        stopWorkers();
+    }
+
+    intrusive_ptr<DocumentSourceParallel> DocumentSourceParallel::create(
+            const BSONObj& workerPipeline,
+            size_t numWorkers,
+            const intrusive_ptr<ExpressionContext> &pExpCtx) {
+        verify(numWorkers > 0);
+        return new DocumentSourceParallel(workerPipeline, numWorkers, pExpCtx);
+    }
+
+    const char *DocumentSourceParallel::getSourceName() const {
+        return name;
+    }
+
+    Value DocumentSourceParallel::serialize(bool explain) const {
+        return Value(DOC(getSourceName() <<
+                         DOC("workers" << static_cast<long long>(_numWorkers)
+                          << "pipeline" << Value(_workerPipeline["pipeline"]))));
+    }
+
+    void DocumentSourceParallel::start() {
+        _unstarted = false;
+
+        // Each worker gets its own copy of everything, parsed here since the parts of a pipeline
+        // aren't safe to share between threads.
+        for (size_t i = 0; i < _numWorkers; i++) {
+            intrusive_ptr<ExpressionContext> workerCtx =
+                new ExpressionContext(interruptStatusWorker, pExpCtx->ns);
+            workerCtx->tempDir = pExpCtx->tempDir;
+
+            string errmsg;
+            intrusive_ptr<Pipeline> worker =
+                Pipeline::parseCommand(errmsg, _workerPipeline, workerCtx);
+            massert(17279, "failed to parse a parallel aggregation pipeline: " + errmsg, worker);
+
+            worker->addInitialSource(new WorkerSource(this, workerCtx));
+            worker->stitch();
+            _workers.push_back(worker);
+        }
+
+        scoped_lock lk(_mutex);
+        for (size_t i = 0; i < _workers.size(); i++) {
+            _threads.create_thread(boost::bind(&DocumentSourceParallel::runWorker,
+                                               this, _workers[i]->output()));
+            _workersRunning++;
+        }
+    }
+
+    void DocumentSourceParallel::runWorker(DocumentSource* output) {
+        bool failed = false;
+        string errmsg;
+        int errcode = 0;
+        try {
+            vector<BSONObj> docs;
+            while (boost::optional<Document> next = output->getNext()) {
+                // Passed on as BSON so the merging thread shares nothing with this one.
+                docs.push_back(next->toBson());
+                if (docs.size() == outputBatchSize)
+                    putOutput(&docs);
+            }
+            if (!docs.empty())
+                putOutput(&docs);
+            output->dispose();
+        }
+        catch (const DBException& e) {
+            failed = true;
+            errmsg = e.what();
+            errcode = e.getCode();
+        }
+        catch (const std::exception& e) {
+            failed = true;
+            errmsg = e.what();
+            errcode = 17280;
+        }
+
+        scoped_lock lk(_mutex);
+        if (failed && !_workerFailed) {
+            _workerFailed = true;
+            _workerErrmsg = errmsg;
+            _workerErrcode = errcode;
+        }
+        _workersRunning--;
+        _outputOrRoom.notify_all();
+    }
+
+    bool DocumentSourceParallel::getInput(vector<Document>* batch) {
+        scoped_lock lk(_mutex);
+        while (_input.empty() && !_inputDone && !_stopping)
+            _inputOrStop.wait(lk.boost());
+
+        batch->clear();
+        if (_stopping || _input.empty())
+            return false;
+
+        batch->swap(_input.front());
+        _input.pop_front();
+        _outputOrRoom.notify_all();
+        return true;
+    }
+
+    void DocumentSourceParallel::putOutput(vector<BSONObj>* docs) {
+        scoped_lock lk(_mutex);
+        while (_output.size() >= _numWorkers * batchesPerWorker && !_stopping)
+            _inputOrStop.wait(lk.boost());
+
+        if (!_stopping) {
+            _output.push_back(vector<BSONObj>());
+            _output.back().swap(*docs);
+            _outputOrRoom.notify_all();
+        }
+        docs->clear();
+    }
+
+    boost::optional<Document> DocumentSourceParallel::getNext() {
+        pExpCtx->checkForInterrupt();
+
+        if (_unstarted)
+            start();
+
+        while (_currentOutputPos == _currentOutput.size()) {
+            // Read more input if the workers could use it.  This is done without holding
+            // _mutex so they can carry on in the meantime.
+            bool readInput = false;
+            {
+                scoped_lock lk(_mutex);
+                uassert(_workerErrcode, _workerErrmsg, !_workerFailed);
+
+                if (!_output.empty()) {
+                    _currentOutput.swap(_output.front());
+                    _output.pop_front();
+                    _currentOutputPos = 0;
+                    _inputOrStop.notify_all();
+                    continue;
+                }
+
+                if (!_workersRunning || _stopping)
+                    return boost::none;
+
+                if (!_inputDone && _input.size() < _numWorkers * batchesPerWorker) {
+                    readInput = true;
+                }
+                else {
+                    _outputOrRoom.timed_wait(lk.boost(), boost::posix_time::seconds(1));
+                }
+            }
+
+            if (!readInput) {
+                pExpCtx->checkForInterrupt();
+                continue;
+            }
+
+            vector<Document> batch;
+            boost::optional<Document> next;
+            while (batch.size() < inputBatchSize && (next = pSource->getNext())) {
+                batch.push_back(*next);
+            }
+
+            scoped_lock lk(_mutex);
+            if (!batch.empty()) {
+                _input.push_back(vector<Document>());
+                _input.back().swap(batch);
+            }
+            if (!next) {
+                _inputDone = true;
+                pSource->dispose();
+            }
+            _inputOrStop.notify_all();
+        }
+
+        return Document(_currentOutput[_currentOutputPos++]);
+    }
+
+    void DocumentSourceParallel::stopWorkers() {
+        {
+            scoped_lock lk(_mutex);
+            _stopping = true;
+            _inputOrStop.notify_all();
+        }
+        _threads.join_all();
+
+        // Only now that their threads are gone are the workers' pipelines safe to release.
+        _workers.clear();
+        _input.clear();
+        _output.clear();
+        _currentOutput.clear();
+        _currentOutputPos = 0;
+    }
+
+    void DocumentSourceParallel::dispose() {
+        stopWorkers();
+        DocumentSource::dispose();
+    }
+}
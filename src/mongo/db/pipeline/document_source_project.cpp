@@ -93,6 +93,10 @@ namespace mongo {
 
     void DocumentSourceProject::optimize() {
         intrusive_ptr<Expression> pE(pEO->optimize());
+
+        vector<intrusive_ptr<Expression>*> expressions(1, &pE);
+        _variables->setNumSharedValues(Expression::shareCommonSubexpressions(expressions));
+
         pEO = dynamic_pointer_cast<ExpressionObject>(pE);
     }
 
@@ -140,6 +144,79 @@ namespace mongo {
         return pProject;
     }
 
+    namespace {
+        /**
+         * Copy 'query' to 'out' with the first part of each field name replaced according to
+         * 'renames'.  Returns false if some field isn't in 'renames', or the query uses an
+         * operator other than $and, $or and $nor at the top level.
+         */
+        bool renameQueryFields(const BSONObj& query,
+                               const map<string, string>& renames,
+                               BSONObjBuilder* out) {
+            BSONForEach(elem, query) {
+                const string name = elem.fieldName();
+                if (name == "$and" || name == "$or" || name == "$nor") {
+                    if (elem.type() != Array)
+                        return false;
+
+                    BSONArrayBuilder clauses(out->subarrayStart(name));
+                    BSONForEach(clause, elem.Obj()) {
+                        if (clause.type() != Object)
+                            return false;
+
+                        BSONObjBuilder renamed(clauses.subobjStart());
+                        if (!renameQueryFields(clause.Obj(), renames, &renamed))
+                            return false;
+                    }
+                    continue;
+                }
+
+                // $where and the like can see fields that aren't named
+                if (name[0] == '$')
+                    return false;
+
+                const size_t dot = name.find('.');
+                map<string, string>::const_iterator it = renames.find(name.substr(0, dot));
+                if (it == renames.end())
+                    return false;
+
+                out->appendAs(elem, dot == string::npos ? it->second
+                                                        : it->second + name.substr(dot));
+            }
+            return true;
+        }
+    }
+
+    bool DocumentSourceProject::matchOnInput(const BSONObj& query, BSONObj* inputQuery) const {
+        // The input field each whole top-level output field is a copy of.
+        map<string, string> renames;
+        renames["_id"] = "_id";
+        BSONForEach(field, _raw) {
+            const string name = field.fieldName();
+            renames.erase(name);
+            if (str::contains(name, '.'))
+                continue;
+
+            if (field.type() == String) {
+                const string path = field.str();
+                if (path.size() > 1 && path[0] == '$' && !str::contains(path, '.')
+                        && path[1] != '$') {
+                    renames[name] = path.substr(1);
+                }
+            }
+            else if ((field.isBoolean() || field.isNumber()) && field.trueValue()) {
+                renames[name] = name;
+            }
+        }
+
+        BSONObjBuilder out;
+        if (!renameQueryFields(query, renames, &out))
+            return false;
+
+        *inputQuery = out.obj();
+        return true;
+    }
+
     DocumentSource::GetDepsReturn DocumentSourceProject::getDependencies(set<string>& deps) const {
         vector<string> path; // empty == top-level
         pEO->addDependencies(deps, &path);
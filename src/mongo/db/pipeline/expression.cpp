@@ -138,6 +138,26 @@ namespace mongo {
         return Document();
     }
 
+    void Variables::setNumSharedValues(size_t numShared) {
+        _shared.reset(numShared == 0 ? NULL : new SharedValue[numShared]);
+        _numShared = numShared;
+    }
+
+    const Value* Variables::getSharedValue(size_t slot) const {
+        if (slot >= _numShared || _shared[slot].generation != _rootGeneration)
+            return NULL;
+
+        return &_shared[slot].value;
+    }
+
+    void Variables::setSharedValue(size_t slot, const Value& value) {
+        if (slot >= _numShared)
+            return; // evaluated without room for shared values, so just don't keep it
+
+        _shared[slot].generation = _rootGeneration;
+        _shared[slot].value = value;
+    }
+
     Variables::Id VariablesParseState::defineVariable(const StringData& name) {
         // caller should have validated before hand by using Variables::uassertValidNameForUserWrite
         massert(17275, "Can't redefine ROOT",
@@ -189,6 +209,99 @@ namespace mongo {
         return string(pPrefixedField + 1);
     }
 
+    namespace {
+        /**
+         * Records the serialized form of each subexpression that could be shared.  Two with the
+         * same serialization compute the same thing as long as they only read ROOT, since
+         * serialize() round-trips through parseOperand().
+         */
+        class SubexpressionCounter : public Expression::SubexpressionVisitor {
+        public:
+            SubexpressionCounter() :_rootOnly(true) {}
+
+            virtual void visit(intrusive_ptr<Expression>* subexpression) {
+                Expression* expr = subexpression->get();
+                const bool siblingsRootOnly = _rootOnly;
+
+                _rootOnly = true;
+                if (ExpressionFieldPath* fieldPath = dynamic_cast<ExpressionFieldPath*>(expr))
+                    _rootOnly = fieldPath->getVariableId() == Variables::ROOT_ID;
+                expr->visitSubexpressions(this);
+
+                // Leaves are as cheap to evaluate as to look up, and ExpressionObject::
+                // addToDocument() treats ExpressionObjects specially, so neither is shared.
+                if (_rootOnly
+                        && !dynamic_cast<ExpressionConstant*>(expr)
+                        && !dynamic_cast<ExpressionFieldPath*>(expr)
+                        && !dynamic_cast<ExpressionObject*>(expr)
+                        && !dynamic_cast<ExpressionShared*>(expr)) {
+                    BSONObjBuilder key;
+                    expr->serialize(false).addToBsonObj(&key, "");
+                    const BSONObj keyObj = key.done();
+                    const string keyString(keyObj.objdata(), keyObj.objsize());
+
+                    keys[expr] = keyString;
+                    counts[keyString]++;
+                }
+
+                _rootOnly = siblingsRootOnly && _rootOnly;
+            }
+
+            map<const Expression*, string> keys;
+            map<string, int> counts;
+
+        private:
+            bool _rootOnly; // true if nothing visited since it was reset reads a variable
+        };
+
+        /// Replaces the subexpressions SubexpressionCounter found more than once.
+        class SubexpressionSharer : public Expression::SubexpressionVisitor {
+        public:
+            explicit SubexpressionSharer(const SubexpressionCounter& counter)
+                : numShared(0)
+                , _counter(counter)
+            {}
+
+            virtual void visit(intrusive_ptr<Expression>* subexpression) {
+                Expression* expr = subexpression->get();
+                map<const Expression*, string>::const_iterator key = _counter.keys.find(expr);
+                if (key == _counter.keys.end() || _counter.counts.find(key->second)->second < 2) {
+                    expr->visitSubexpressions(this);
+                    return;
+                }
+
+                intrusive_ptr<ExpressionShared>& shared = _shared[key->second];
+                if (!shared) {
+                    // The first occurrence is the one that is kept, so share within it as well.
+                    expr->visitSubexpressions(this);
+                    shared = ExpressionShared::create(*subexpression, numShared++);
+                }
+                *subexpression = shared;
+            }
+
+            size_t numShared;
+
+        private:
+            const SubexpressionCounter& _counter;
+            map<string, intrusive_ptr<ExpressionShared> > _shared;
+        };
+    }
+
+    size_t Expression::shareCommonSubexpressions(
+            const vector<intrusive_ptr<Expression>*>& expressions) {
+        SubexpressionCounter counter;
+        for (size_t i = 0; i < expressions.size(); i++) {
+            counter.visit(expressions[i]);
+        }
+
+        SubexpressionSharer sharer(counter);
+        for (size_t i = 0; i < expressions.size(); i++) {
+            sharer.visit(expressions[i]);
+        }
+
+        return sharer.numShared;
+    }
+
     intrusive_ptr<Expression> Expression::parseObject(
             BSONObj obj,
             ObjectCtx* pCtx,
@@ -599,6 +712,10 @@ namespace {
         return Value(false);
     }
 
+    void ExpressionCoerceToBool::visitSubexpressions(SubexpressionVisitor* visitor) {
+        visitor->visit(&pExpression);
+    }
+
     Value ExpressionCoerceToBool::serialize(bool explain) const {
         // When not explaining, serialize to an $and expression. When parsed, the $and expression
         // will be optimized back into a ExpressionCoerceToBool.
@@ -713,6 +830,23 @@ namespace {
 
     /* ----------------------- ExpressionCond ------------------------------ */
 
+    intrusive_ptr<Expression> ExpressionCond::optimize() {
+        intrusive_ptr<Expression> optimized = Base::optimize();
+        if (optimized.get() != this)
+            return optimized;
+
+        // A constant condition always picks the same branch.  An ExpressionObject can't stand
+        // in for the $cond, since in a $project it would be applied to the input's subdocument.
+        if (ExpressionConstant* cond = dynamic_cast<ExpressionConstant*>(vpOperand[0].get())) {
+            const intrusive_ptr<Expression>& branch = vpOperand[cond->getValue().coerceToBool()
+                                                                ? 1 : 2];
+            if (!dynamic_cast<ExpressionObject*>(branch.get()))
+                return branch;
+        }
+
+        return this;
+    }
+
     Value ExpressionCond::evaluateInternal(Variables* vars) const {
         Value pCond(vpOperand[0]->evaluateInternal(vars));
         int idx = pCond.coerceToBool() ? 1 : 2;
@@ -1145,6 +1279,13 @@ namespace {
         addField(theFieldPath, NULL);
     }
 
+    void ExpressionObject::visitSubexpressions(SubexpressionVisitor* visitor) {
+        for (FieldMap::iterator it = _expressions.begin(); it != _expressions.end(); ++it) {
+            if (it->second) // NULL is an inclusion
+                visitor->visit(&it->second);
+        }
+    }
+
     Value ExpressionObject::serialize(bool explain) const {
         MutableDocument valBuilder;
         if (_excludeId)
@@ -1383,6 +1524,14 @@ namespace {
         return _subExpression->evaluateInternal(vars);
     }
 
+    void ExpressionLet::visitSubexpressions(SubexpressionVisitor* visitor) {
+        for (VariableMap::iterator it=_variables.begin(), end=_variables.end(); it != end; ++it) {
+            visitor->visit(&it->second.expression);
+        }
+
+        visitor->visit(&_subExpression);
+    }
+
     void ExpressionLet::addDependencies(set<string>& deps, vector<string>* path) const {
         for (VariableMap::const_iterator it=_variables.begin(), end=_variables.end();
                 it != end; ++it) {
@@ -1505,6 +1654,11 @@ namespace {
         _each->addDependencies(deps);
     }
 
+    void ExpressionMap::visitSubexpressions(SubexpressionVisitor* visitor) {
+        visitor->visit(&_input);
+        visitor->visit(&_each);
+    }
+
     /* ------------------------- ExpressionMillisecond ----------------------------- */
 
     Value ExpressionMillisecond::evaluateInternal(Variables* vars) const {
@@ -1660,6 +1814,24 @@ namespace {
 
     /* ----------------------- ExpressionIfNull ---------------------------- */
 
+    intrusive_ptr<Expression> ExpressionIfNull::optimize() {
+        intrusive_ptr<Expression> optimized = ExpressionNary::optimize();
+        if (optimized.get() != this)
+            return optimized;
+
+        // A constant first operand decides which operand the result always comes from.  As with
+        // $cond, an ExpressionObject can't replace the $ifNull.
+        if (ExpressionConstant* left = dynamic_cast<ExpressionConstant*>(vpOperand[0].get())) {
+            if (!left->getValue().nullish())
+                return vpOperand[0];
+
+            if (!dynamic_cast<ExpressionObject*>(vpOperand[1].get()))
+                return vpOperand[1];
+        }
+
+        return this;
+    }
+
     Value ExpressionIfNull::evaluateInternal(Variables* vars) const {
         Value pLeft(vpOperand[0]->evaluateInternal(vars));
         if (!pLeft.nullish())
@@ -1773,6 +1945,12 @@ namespace {
         return Value(DOC(getOpName() << array));
     }
 
+    void ExpressionNary::visitSubexpressions(SubexpressionVisitor* visitor) {
+        for (size_t i = 0; i < vpOperand.size(); ++i) {
+            visitor->visit(&vpOperand[i]);
+        }
+    }
+
     /* ------------------------- ExpressionNot ----------------------------- */
 
     Value ExpressionNot::evaluateInternal(Variables* vars) const {
@@ -1858,6 +2036,41 @@ namespace {
         return "$or";
     }
 
+    /* ------------------------- ExpressionShared ----------------------------- */
+
+    intrusive_ptr<ExpressionShared> ExpressionShared::create(
+            const intrusive_ptr<Expression>& expression,
+            size_t slot) {
+        return new ExpressionShared(expression, slot);
+    }
+
+    ExpressionShared::ExpressionShared(const intrusive_ptr<Expression>& expression, size_t slot)
+        : _expression(expression)
+        , _slot(slot)
+    {}
+
+    intrusive_ptr<Expression> ExpressionShared::optimize() {
+        // Unshare so that optimizations see the real expression.  The caller can share again.
+        return _expression->optimize();
+    }
+
+    void ExpressionShared::addDependencies(set<string>& deps, vector<string>* path) const {
+        _expression->addDependencies(deps, path);
+    }
+
+    Value ExpressionShared::evaluateInternal(Variables* vars) const {
+        if (const Value* cached = vars->getSharedValue(_slot))
+            return *cached;
+
+        const Value result = _expression->evaluateInternal(vars);
+        vars->setSharedValue(_slot, result);
+        return result;
+    }
+
+    Value ExpressionShared::serialize(bool explain) const {
+        return _expression->serialize(explain);
+    }
+
     /* ------------------------- ExpressionSecond ----------------------------- */
 
     Value ExpressionSecond::evaluateInternal(Variables* vars) const {
@@ -55,12 +55,14 @@ namespace mongo {
         typedef size_t Id;
 
         // This is only for expressions that use no variables (even ROOT).
-        Variables() :_numVars(0) {}
+        Variables() :_numVars(0), _rootGeneration(1), _numShared(0) {}
     
         explicit Variables(size_t numVars, const Document& root = Document())
             : _root(root)
             , _rest(numVars == 0 ? NULL : new Value[numVars])
             , _numVars(numVars)
+            , _rootGeneration(1)
+            , _numShared(0)
         {}
 
         static void uassertValidNameForUserWrite(StringData varName);
@@ -71,8 +73,8 @@ namespace mongo {
         /**
          * Use this instead of setValue for setting ROOT
          */
-        void setRoot(const Document& root) { _root = root; }
-        void clearRoot() { _root = Document(); }
+        void setRoot(const Document& root) { _root = root; _rootGeneration++; }
+        void clearRoot() { _root = Document(); _rootGeneration++; }
         const Document& getRoot() const { return _root; }
 
         void setValue(Id id, const Value& value);
@@ -83,10 +85,30 @@ namespace mongo {
          */
         Document getDocument(Id id) const;
 
+        /**
+         * Makes room for the values of numShared ExpressionShared subexpressions.  Each is kept
+         * until ROOT next changes.  See Expression::shareCommonSubexpressions().
+         */
+        void setNumSharedValues(size_t numShared);
+
+        /// Returns NULL if the value for slot hasn't been computed since ROOT was last set.
+        const Value* getSharedValue(size_t slot) const;
+        void setSharedValue(size_t slot, const Value& value);
+
     private:
+        struct SharedValue {
+            SharedValue() :generation(0) {}
+            unsigned long long generation; // _rootGeneration when value was computed
+            Value value;
+        };
+
         Document _root;
         const boost::scoped_array<Value> _rest;
         const size_t _numVars;
+
+        unsigned long long _rootGeneration;
+        boost::scoped_array<SharedValue> _shared;
+        size_t _numShared;
     };
 
     /**
@@ -188,6 +210,30 @@ namespace mongo {
          */
         virtual Value serialize(bool explain) const = 0;
 
+        /// Visitor for the direct subexpressions of an Expression.  See visitSubexpressions().
+        class SubexpressionVisitor {
+        public:
+            virtual ~SubexpressionVisitor() {}
+
+            /// May replace *subexpression with an equivalent Expression.
+            virtual void visit(intrusive_ptr<Expression>* subexpression) = 0;
+        };
+
+        /// Calls visitor->visit() on each direct subexpression.  Leaves have none.
+        virtual void visitSubexpressions(SubexpressionVisitor* visitor) {}
+
+        /**
+         * Replaces each subexpression that appears more than once among expressions with an
+         * ExpressionShared, so that it is only evaluated once per document.  Only subexpressions
+         * that depend on nothing but ROOT are shared, and constants, field paths and Document
+         * expressions are never shared.  The expressions should already be optimized.
+         *
+         * @returns the number of shared values that the Variables the expressions are evaluated
+         *          with must make room for with setNumSharedValues().
+         */
+        static size_t shareCommonSubexpressions(
+            const vector<intrusive_ptr<Expression>*>& expressions);
+
         /// Evaluate expression with specified inputs and return result. (only used by tests)
         Value evaluate(const Document& root) const {
             Variables vars(0, root);
@@ -293,6 +339,7 @@ namespace mongo {
         virtual intrusive_ptr<Expression> optimize();
         virtual Value serialize(bool explain) const;
         virtual void addDependencies(set<string>& deps, vector<string>* path=NULL) const;
+        virtual void visitSubexpressions(SubexpressionVisitor* visitor);
 
         /*
           Add an operand to the n-ary expression.
@@ -401,6 +448,7 @@ namespace mongo {
         virtual void addDependencies(set<string>& deps, vector<string>* path=NULL) const;
         virtual Value evaluateInternal(Variables* vars) const;
         virtual Value serialize(bool explain) const;
+        virtual void visitSubexpressions(SubexpressionVisitor* visitor);
 
         static intrusive_ptr<ExpressionCoerceToBool> create(
             const intrusive_ptr<Expression> &pExpression);
@@ -457,6 +505,7 @@ namespace mongo {
         typedef ExpressionFixedArity<ExpressionCond, 3> Base;
     public:
         // virtuals from ExpressionNary
+        virtual intrusive_ptr<Expression> optimize();
         virtual Value evaluateInternal(Variables* vars) const;
         virtual const char *getOpName() const;
 
@@ -556,6 +605,9 @@ namespace mongo {
 
         const FieldPath& getFieldPath() const { return _fieldPath; }
 
+        /// The variable the path starts from; ROOT_ID for plain "$a.b" paths.
+        Variables::Id getVariableId() const { return _variable; }
+
     private:
         ExpressionFieldPath(const string& fieldPath, Variables::Id variable);
 
@@ -601,6 +653,7 @@ namespace mongo {
     class ExpressionIfNull : public ExpressionFixedArity<ExpressionIfNull, 2> {
     public:
         // virtuals from ExpressionNary
+        virtual intrusive_ptr<Expression> optimize();
         virtual Value evaluateInternal(Variables* vars) const;
         virtual const char *getOpName() const;
     };
@@ -613,6 +666,7 @@ namespace mongo {
         virtual Value serialize(bool explain) const;
         virtual Value evaluateInternal(Variables* vars) const;
         virtual void addDependencies(set<string>& deps, vector<string>* path=NULL) const;
+        virtual void visitSubexpressions(SubexpressionVisitor* visitor);
 
         static intrusive_ptr<Expression> parse(
             BSONElement expr,
@@ -646,6 +700,7 @@ namespace mongo {
         virtual Value serialize(bool explain) const;
         virtual Value evaluateInternal(Variables* vars) const;
         virtual void addDependencies(set<string>& deps, vector<string>* path=NULL) const;
+        virtual void visitSubexpressions(SubexpressionVisitor* visitor);
 
         static intrusive_ptr<Expression> parse(
             BSONElement expr,
@@ -721,6 +776,7 @@ namespace mongo {
         /** Only evaluates non inclusion expressions.  For inclusions, use addToDocument(). */
         virtual Value evaluateInternal(Variables* vars) const;
         virtual Value serialize(bool explain) const;
+        virtual void visitSubexpressions(SubexpressionVisitor* visitor);
 
         /// like evaluate(), but return a Document instead of a Value-wrapped Document.
         Document evaluateDocument(Variables* vars) const;
@@ -832,6 +888,32 @@ namespace mongo {
     };
 
 
+    /**
+     * A subexpression that appears more than once among a stage's expressions.  The first place
+     * that needs it for a document evaluates it and keeps the result in the Variables, and the
+     * other places reuse it.  It serializes as the wrapped expression.
+     *
+     * Only created by Expression::shareCommonSubexpressions().
+     */
+    class ExpressionShared : public Expression {
+    public:
+        // virtuals from Expression
+        virtual intrusive_ptr<Expression> optimize();
+        virtual void addDependencies(set<string>& deps, vector<string>* path=NULL) const;
+        virtual Value evaluateInternal(Variables* vars) const;
+        virtual Value serialize(bool explain) const;
+
+        static intrusive_ptr<ExpressionShared> create(const intrusive_ptr<Expression>& expression,
+                                                      size_t slot);
+
+    private:
+        ExpressionShared(const intrusive_ptr<Expression>& expression, size_t slot);
+
+        const intrusive_ptr<Expression> _expression;
+        const size_t _slot; // in Variables' shared values
+    };
+
+
     class ExpressionSecond : public ExpressionFixedArity<ExpressionSecond, 1> {
     public:
         // virtuals from ExpressionNary
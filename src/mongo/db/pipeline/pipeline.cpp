@@ -208,11 +208,13 @@ namespace mongo {
 
         // The order in which optimizations are applied can have significant impact on the
         // efficiency of the final pipeline. Be Careful!
+        Optimizations::Local::moveMatchBeforeProject(pPipeline.get());
         Optimizations::Local::moveMatchBeforeSort(pPipeline.get());
         Optimizations::Local::moveLimitBeforeSkip(pPipeline.get());
         Optimizations::Local::coalesceAdjacent(pPipeline.get());
         Optimizations::Local::optimizeEachDocumentSource(pPipeline.get());
         Optimizations::Local::duplicateMatchBeforeInitalRedact(pPipeline.get());
+        Optimizations::Local::streamGroupsAfterSort(pPipeline.get());
 
         return pPipeline;
     }
@@ -233,6 +235,26 @@ namespace mongo {
         }
     }
 
+    void Pipeline::Optimizations::Local::moveMatchBeforeProject(Pipeline* pipeline) {
+        SourceContainer& sources = pipeline->sources;
+        for (size_t srci = 1; srci < sources.size(); ++srci) {
+            DocumentSourceMatch* match = dynamic_cast<DocumentSourceMatch*>(sources[srci].get());
+            DocumentSourceProject* project =
+                dynamic_cast<DocumentSourceProject*>(sources[srci - 1].get());
+            BSONObj inputQuery;
+            if (match && project && project->matchOnInput(match->getQuery(), &inputQuery)) {
+                sources[srci] = sources[srci - 1];
+                sources[srci - 1] = DocumentSourceMatch::createFromBson(
+                                        BSON("$match" << inputQuery).firstElement(),
+                                        pipeline->pCtx);
+
+                // check the moved match against whatever is before it now
+                if (srci >= 2)
+                    srci -= 2;
+            }
+        }
+    }
+
     void Pipeline::Optimizations::Local::moveLimitBeforeSkip(Pipeline* pipeline) {
         SourceContainer& sources = pipeline->sources;
         if (sources.empty())
@@ -313,6 +335,17 @@ namespace mongo {
         }
     }
 
+    void Pipeline::Optimizations::Local::streamGroupsAfterSort(Pipeline* pipeline) {
+        SourceContainer& sources = pipeline->sources;
+        for (size_t srcn = sources.size(), srci = 1; srci < srcn; ++srci) {
+            DocumentSourceGroup* group = dynamic_cast<DocumentSourceGroup*>(sources[srci].get());
+            DocumentSourceSort* sort = dynamic_cast<DocumentSourceSort*>(sources[srci - 1].get());
+            if (group && sort && group->isGroupedBy(sort->serializeSortKey().toBson())) {
+                group->setStreaming(true);
+            }
+        }
+    }
+
     void Pipeline::addRequiredPrivileges(Command* commandTemplate,
                                          const string& db,
                                          BSONObj cmdObj,
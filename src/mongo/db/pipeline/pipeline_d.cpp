@@ -37,11 +37,15 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query_optimizer.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/d_logic.h"
 
 
 namespace mongo {
 
+    // How many threads an unsharded aggregation may group its input on.  See below.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceParallelWorkers, int, 1);
+
 namespace {
     class MongodImplementation : public DocumentSourceNeedsMongod::MongodInterface {
     public:
@@ -206,6 +210,19 @@ namespace {
 
                 pCursor = pSortedCursor;
                 initSort = true;
+
+                // A $group that streamed after the $sort can only keep doing
+                // so if the index order keeps its groups together too.
+                for (size_t i = 0; i < sources.size(); i++) {
+                    if (dynamic_cast<DocumentSourceLimit*>(sources[i].get()))
+                        continue;
+
+                    DocumentSourceGroup* group =
+                        dynamic_cast<DocumentSourceGroup*>(sources[i].get());
+                    if (group && (pCursor->isMultiKey() || !group->isGroupedBy(sortObj, true)))
+                        group->setStreaming(false);
+                    break;
+                }
             }
         }
 
@@ -270,6 +287,30 @@ namespace {
             sources.pop_front();
         }
 
+        // Unless the documents have to stay in order, everything up to the first $group can run
+        // on several threads, each grouping part of the input.  The rest of the pipeline then
+        // starts with a $group merging theirs, just as it would merge groups from shards.
+        const int numWorkers = internalDocumentSourceParallelWorkers;
+        if (numWorkers > 1 && !initSort && !pExpCtx->inShard) {
+            DocumentSourceGroup* group = NULL;
+            for (size_t i = 0; i < sources.size(); i++) {
+                if (dynamic_cast<SplittableDocumentSource*>(sources[i].get())) {
+                    group = dynamic_cast<DocumentSourceGroup*>(sources[i].get());
+                    break;
+                }
+            }
+
+            if (group) {
+                intrusive_ptr<Pipeline> workerPipeline = pPipeline->splitForSharded();
+                MutableDocument workerSpec(workerPipeline->serialize());
+                workerSpec[Pipeline::fromRouterName] = Value(true);
+                pPipeline->addInitialSource(
+                    DocumentSourceParallel::create(workerSpec.freeze().toBson(),
+                                                   numWorkers,
+                                                   pExpCtx));
+            }
+        }
+
         pPipeline->addInitialSource(pSource);
     }
 
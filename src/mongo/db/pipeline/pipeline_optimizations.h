@@ -51,6 +51,16 @@ namespace mongo {
          */
         static void moveMatchBeforeSort(Pipeline* pipeline);
 
+        /**
+         * Moves matches before any adjacent projects that only include or
+         * rename the fields the match uses, rewriting the match in terms of
+         * the original field names.
+         *
+         * This lets a match written against renamed fields become the query,
+         * and means the projection is done for fewer documents.
+         */
+        static void moveMatchBeforeProject(Pipeline* pipeline);
+
         /**
          * Moves limits before any adjacent skip phases.
          *
@@ -86,6 +96,16 @@ namespace mongo {
          * BSONObjs converted to Documents.
          */
         static void duplicateMatchBeforeInitalRedact(Pipeline* pipeline);
+
+        /**
+         * Tells each $group directly after a $sort on its _id's fields that
+         * its input comes grouped.
+         *
+         * Such a $group outputs each group as soon as the next starts, rather
+         * than holding every group in memory until its input is exhausted.
+         * Must run after any optimizations that reorder stages.
+         */
+        static void streamGroupsAfterSort(Pipeline* pipeline);
     };
 
     /**
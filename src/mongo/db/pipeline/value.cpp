@@ -34,11 +34,90 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/document.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
     using namespace mongoutils;
 
+    namespace {
+        // SmallBlockPool keeps blocks in size classes of this many bytes.
+        const size_t blockGranularity = 16;
+        const size_t numBlockSizes = SmallBlockPool::MaxBlockBytes / blockGranularity;
+
+        // Bounds the memory an idle thread holds on to.
+        const size_t maxFreeBlocksPerSize = 64;
+
+        size_t blockSizeIndex(size_t bytes) {
+            return bytes == 0 ? 0 : (bytes - 1) / blockGranularity;
+        }
+
+        // Set during static destruction, once the main thread's free lists have been deleted.
+        bool smallBlockPoolShutDown = false;
+    }
+
+    /// The blocks a thread has released to SmallBlockPool.  Freed when the thread exits.
+    struct SmallBlockFreeLists {
+        SmallBlockFreeLists() {
+            // So that release() never allocates
+            for (size_t i = 0; i < numBlockSizes; i++) {
+                lists[i].reserve(maxFreeBlocksPerSize);
+            }
+        }
+
+        ~SmallBlockFreeLists() {
+            for (size_t i = 0; i < numBlockSizes; i++) {
+                for (size_t j = 0; j < lists[i].size(); j++) {
+                    ::operator delete(lists[i][j]);
+                }
+            }
+        }
+
+        vector<void*> lists[numBlockSizes];
+    };
+
+    TSP_DECLARE(SmallBlockFreeLists, smallBlockFreeLists)
+    TSP_DEFINE(SmallBlockFreeLists, smallBlockFreeLists)
+
+    namespace {
+        // Destroyed before smallBlockFreeLists since it is defined after it.
+        struct SmallBlockPoolShutDown {
+            ~SmallBlockPoolShutDown() { smallBlockPoolShutDown = true; }
+        } smallBlockPoolShutDownOnExit;
+    }
+
+    void* SmallBlockPool::allocate(size_t bytes) {
+        if (bytes > MaxBlockBytes || smallBlockPoolShutDown)
+            return ::operator new(bytes);
+
+        const size_t index = blockSizeIndex(bytes);
+        vector<void*>& freeList = smallBlockFreeLists.getMake()->lists[index];
+        if (freeList.empty())
+            return ::operator new((index + 1) * blockGranularity); // room for the whole class
+
+        void* block = freeList.back();
+        freeList.pop_back();
+        return block;
+    }
+
+    void SmallBlockPool::release(void* block, size_t bytes) {
+        if (!block)
+            return;
+
+        if (bytes <= MaxBlockBytes && !smallBlockPoolShutDown) {
+            // Threads that never allocated from the pool don't keep blocks.
+            if (SmallBlockFreeLists* freeLists = smallBlockFreeLists.get()) {
+                vector<void*>& freeList = freeLists->lists[blockSizeIndex(bytes)];
+                if (freeList.size() < maxFreeBlocksPerSize) {
+                    freeList.push_back(block);
+                    return;
+                }
+            }
+        }
+
+        ::operator delete(block);
+    }
+
     void ValueStorage::verifyRefCountingIfShould() const {
         switch (type) {
         case MinKey:
@@ -158,6 +237,7 @@ namespace mongo {
 
         case Array: {
             intrusive_ptr<RCVector> vec (new RCVector);
+            vec->vec.reserve(elem.embeddedObject().nFields());
             BSONForEach(sub, elem.embeddedObject()) {
                 vec->vec.push_back(Value(sub));
             }
@@ -218,6 +298,7 @@ namespace mongo {
 
     Value::Value(const BSONArray& arr) : _storage(Array) {
         intrusive_ptr<RCVector> vec (new RCVector);
+        vec->vec.reserve(arr.nFields());
         BSONForEach(sub, arr) {
             vec->vec.push_back(Value(sub));
         }
@@ -42,6 +42,21 @@ namespace mongo {
     class DocumentStorage;
     class Value;
 
+    /**
+     * Recycles small allocations on each thread.  A pipeline frees about as many Documents and
+     * arrays as it creates, so most of their storage can come from blocks freed earlier instead
+     * of from malloc.  Blocks may be released on a different thread than allocated them.
+     */
+    class SmallBlockPool {
+    public:
+        enum { MaxBlockBytes = 128 }; // bigger allocations use operator new directly
+
+        static void* allocate(size_t bytes);
+
+        /// bytes must be what was passed to allocate().
+        static void release(void* block, size_t bytes);
+    };
+
     //TODO: a MutableVector, similar to MutableDocument
     /// A heap-allocated reference-counted std::vector
     class RCVector : public RefCountable {
@@ -49,6 +64,11 @@ namespace mongo {
         RCVector() {}
         RCVector(const vector<Value>& v) :vec(v) {}
         vector<Value> vec;
+
+        static void* operator new(size_t bytes) { return SmallBlockPool::allocate(bytes); }
+        static void operator delete(void* ptr, size_t bytes) {
+            SmallBlockPool::release(ptr, bytes);
+        }
     };
 
     class RCCodeWScope : public RefCountable {
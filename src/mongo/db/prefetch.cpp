@@ -30,6 +30,7 @@
 
 #include "mongo/db/prefetch.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/diskloc.h"
 #include "mongo/db/index/index_access_method.h"
@@ -37,6 +38,7 @@
 #include "mongo/db/structure/collection.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_details.h"
+#include "mongo/db/pdfile.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/commands/server_status.h"
@@ -57,6 +59,17 @@ namespace mongo {
                                                     "repl.preload.docs",
                                                     &prefetchDocStats );
 
+    // The documents updates were for that were already in memory, so were not touched, and
+    // those that were paged in
+    static Counter64 prefetchDocHitStats;
+    static ServerStatusMetricField<Counter64> displayPrefetchDocHits(
+                                                    "repl.preload.docHits",
+                                                    &prefetchDocHitStats );
+    static Counter64 prefetchDocMissStats;
+    static ServerStatusMetricField<Counter64> displayPrefetchDocMisses(
+                                                    "repl.preload.docMisses",
+                                                    &prefetchDocMissStats );
+
     // prefetch for an oplog operation
     void prefetchPagesForReplicatedOp(const BSONObj& op) {
         const char *opField;
@@ -184,21 +197,41 @@ namespace mongo {
             TimerHolder timer(&prefetchDocStats);
             BSONObjBuilder builder;
             builder.append(_id);
-            BSONObj result;
             try {
                 // we can probably use Client::Context here instead of ReadContext as we
                 // have locked higher up the call stack already
                 Client::ReadContext ctx( ns );
-                if( Helpers::findById(cc(), ns, builder.done(), result) ) {
-                    // do we want to use Record::touch() here?  it's pretty similar.
-                    volatile char _dummy_char = '\0';
-                    // Touch the first word on every page in order to fault it into memory
-                    for (int i = 0; i < result.objsize(); i += g_minOSPageSizeBytes) {                        
-                        _dummy_char += *(result.objdata() + i); 
+                NamespaceDetails* d = nsdetails( ns );
+                if ( !d || d->findIdIndex() < 0 )
+                    return;
+                DiskLoc loc = Helpers::findById( d, builder.done() );
+                if ( loc.isNull() )
+                    return;
+
+                // Fault in the pages of the record that are not in memory already; the first
+                // holds the header, which has the length of the rest
+                const Record* record = loc.rec();
+                const char* data = record->dataNoThrowing();
+                bool faulted = !Record::likelyInPhysicalMemory( data );
+                const char* end = data + record->netLength() - 1;
+                volatile char _dummy_char = '\0';
+                for ( const char* page = data + g_minOSPageSizeBytes; page <= end;
+                      page += g_minOSPageSizeBytes ) {
+                    if ( !Record::likelyInPhysicalMemory( page ) ) {
+                        _dummy_char += *page;
+                        faulted = true;
                     }
-                    // hit the last page, in case we missed it above
-                    _dummy_char += *(result.objdata() + result.objsize() - 1);
                 }
+                if ( !Record::likelyInPhysicalMemory( end ) ) {
+                    // the last page, in case the loop missed it
+                    _dummy_char += *end;
+                    faulted = true;
+                }
+
+                if ( faulted )
+                    prefetchDocMissStats.increment();
+                else
+                    prefetchDocHitStats.increment();
             }
             catch(const DBException& e) {
                 LOG(2) << "ignoring exception in prefetchRecordPages(): " << e.what() << endl;
@@ -28,6 +28,8 @@
 
 #include "mongo/db/query/cached_plan_runner.h"
 
+#include "mongo/db/client.h"
+#include "mongo/db/database.h"
 #include "mongo/db/diskloc.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/exec/plan_stage.h"
@@ -36,18 +38,23 @@
 #include "mongo/db/query/explain_plan.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/type_explain.h"
+#include "mongo/db/structure/collection.h"
 
 namespace mongo {
 
     CachedPlanRunner::CachedPlanRunner(CanonicalQuery* canonicalQuery,
                                        CachedSolution* cached,
+                                       QuerySolution* solution,
                                        PlanStage* root,
                                        WorkingSet* ws)
         : _canonicalQuery(canonicalQuery),
           _cachedQuery(cached),
+          _solution(solution),
           _exec(new PlanExecutor(ws, root)),
-          _updatedCache(false) {
+          _updatedCache(false),
+          _numSaves(0) {
     }
 
     CachedPlanRunner::~CachedPlanRunner() {
@@ -66,6 +73,11 @@ namespace mongo {
     }
 
     void CachedPlanRunner::saveState() {
+        // We save state between batches and when yielding, with the collection still locked.
+        // This is our chance to notice a cached plan that has gone bad before EOF.
+        if (!_updatedCache) {
+            checkCachedPlanPerformance();
+        }
         _exec->saveState();
     }
 
@@ -110,34 +122,43 @@ namespace mongo {
         }
         (*explain)->setNScannedObjectsAllPlans((*explain)->getNScannedObjects());
         (*explain)->setNScannedAllPlans((*explain)->getNScanned());
+        (*explain)->setPeakWorkingSetMembers(_exec->getWorkingSet()->getPeakMembers());
 
         return Status::OK();
     }
 
-    void CachedPlanRunner::updateCache() {
-        _updatedCache = true;
-
-        // We're done.  Update the cache.
-        PlanCache* cache = PlanCache::get(_canonicalQuery->ns());
+    void CachedPlanRunner::checkCachedPlanPerformance() {
+        // Collecting stats allocates a tree, so only look at saves 1, 2, 4, 8, ...
+        ++_numSaves;
+        if (0 != (_numSaves & (_numSaves - 1))) { return; }
 
-        // TODO: Is this an error?
-        if (NULL == cache) { return; }
+        if (NULL == _cachedQuery->decision) { return; }
 
-        // TODO: How do we decide this?
-        bool shouldRemovePlan = false;
+        scoped_ptr<PlanStageStats> stats(_exec->getStats());
+        if (NULL == stats.get()) { return; }
 
-        if (shouldRemovePlan) {
-            if (!cache->remove(*_canonicalQuery, *_cachedQuery->solution)) {
-                warning() << "Cached plan runner couldn't remove plan from cache.  Maybe"
-                    " somebody else did already?";
-                return;
-            }
+        if (PlanCache::hasPlanDegraded(*_cachedQuery->decision, *stats)) {
+            // Tell the cache now rather than at EOF, so that other queries of this shape stop
+            // using the plan while we're still running it.
+            updateCache();
         }
+    }
+
+    void CachedPlanRunner::updateCache() {
+        _updatedCache = true;
+
+        // We're done.  Update the cache.  If the collection went away, so did its cache.
+        Database* db = cc().database();
+        if (NULL == db) { return; }
+        Collection* collection = db->getCollection(_canonicalQuery->ns());
+        if (NULL == collection) { return; }
+        PlanCache* cache = collection->infoCache()->getPlanCache();
 
-        // We're done running.  Update cache.
+        // We're done running.  Update cache.  The cache evicts the plan if it degraded.
         auto_ptr<CachedSolutionFeedback> feedback(new CachedSolutionFeedback());
         feedback->stats = _exec->getStats();
-        cache->feedback(*_canonicalQuery, *_cachedQuery->solution, feedback.release());
+        if (NULL == feedback->stats) { return; }
+        cache->feedback(*_canonicalQuery, *_cachedQuery, feedback.release());
     }
 
 } // namespace mongo
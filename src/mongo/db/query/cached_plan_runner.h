@@ -33,6 +33,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/db/query/runner.h"
+#include "mongo/platform/cstdint.h"
 
 namespace mongo {
 
@@ -42,6 +43,7 @@ namespace mongo {
     class DiskLoc;
     class PlanExecutor;
     class PlanStage;
+    struct QuerySolution;
     class TypeExplain;
     class WorkingSet;
 
@@ -56,9 +58,14 @@ namespace mongo {
     class CachedPlanRunner : public Runner {
     public:
 
-        /**  Takes ownership of all arguments. */
+        /**
+         * Takes ownership of all arguments.
+         *
+         * 'solution' is the solution to 'canonicalQuery' with the shape recorded in 'cached'.
+         * 'root' and 'ws' are built from 'solution'.
+         */
         CachedPlanRunner(CanonicalQuery* canonicalQuery, CachedSolution* cached,
-                         PlanStage* root, WorkingSet* ws);
+                         QuerySolution* solution, PlanStage* root, WorkingSet* ws);
 
         virtual ~CachedPlanRunner();
 
@@ -86,14 +93,27 @@ namespace mongo {
         virtual Status getExplainPlan(TypeExplain** explain) const;
 
     private:
+        /**
+         * Send feedback about the performance of the cached plan to the cache.  Done once.
+         */
         void updateCache();
 
+        /**
+         * If the cached plan performs much worse than it did when it was picked, update the cache
+         * (which evicts the plan) without waiting for EOF.
+         */
+        void checkCachedPlanPerformance();
+
         boost::scoped_ptr<CanonicalQuery> _canonicalQuery;
         boost::scoped_ptr<CachedSolution> _cachedQuery;
+        boost::scoped_ptr<QuerySolution> _solution;
         boost::scoped_ptr<PlanExecutor> _exec;
 
         // Have we updated the cache with our plan stats yet?
         bool _updatedCache;
+
+        // How many times were we asked to save state?
+        uint64_t _numSaves;
     };
 
 }  // namespace mongo
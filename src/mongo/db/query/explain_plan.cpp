@@ -35,6 +35,100 @@ namespace mongo {
 
     namespace {
 
+        const char* stageTypeString(StageType stageType) {
+            switch (stageType) {
+            case STAGE_AND_HASH: return "AND_HASH";
+            case STAGE_AND_SORTED: return "AND_SORTED";
+            case STAGE_COLLSCAN: return "COLLSCAN";
+            case STAGE_COUNT: return "COUNT";
+            case STAGE_DISTINCT: return "DISTINCT";
+            case STAGE_FETCH: return "FETCH";
+            case STAGE_GEO_2D: return "GEO_2D";
+            case STAGE_GEO_NEAR_2D: return "GEO_NEAR_2D";
+            case STAGE_GEO_NEAR_2DSPHERE: return "GEO_NEAR_2DSPHERE";
+            case STAGE_IXSCAN: return "IXSCAN";
+            case STAGE_LIMIT: return "LIMIT";
+            case STAGE_OR: return "OR";
+            case STAGE_PROJECTION: return "PROJECTION";
+            case STAGE_SHARDING_FILTER: return "SHARDING_FILTER";
+            case STAGE_SKIP: return "SKIP";
+            case STAGE_SORT: return "SORT";
+            case STAGE_SORT_MERGE: return "SORT_MERGE";
+            case STAGE_TEXT: return "TEXT";
+            default: return "UNKNOWN";
+            }
+        }
+
+        /**
+         * Writes what each stage of the tree rooted at 'stats' did, and how long it took, into
+         * 'bob'.  The children of a stage are in its "inputStages" array.
+         */
+        void statsToBSON(const PlanStageStats& stats, BSONObjBuilder* bob) {
+            const CommonStats& common = stats.common;
+            bob->append("stage", stageTypeString(stats.stageType));
+            bob->appendNumber("works", static_cast<long long>(common.works));
+            bob->appendNumber("advanced", static_cast<long long>(common.advanced));
+            bob->appendNumber("needTime", static_cast<long long>(common.needTime));
+            bob->appendNumber("needFetch", static_cast<long long>(common.needFetch));
+            bob->appendNumber("yields", static_cast<long long>(common.yields));
+            bob->appendNumber("unyields", static_cast<long long>(common.unyields));
+            bob->appendNumber("invalidates", static_cast<long long>(common.invalidates));
+            bob->appendBool("isEOF", common.isEOF);
+            bob->appendNumber("executionTimeMicros",
+                              static_cast<long long>(common.executionTimeMicros));
+
+            const SpecificStats* specific = stats.specific.get();
+            if (STAGE_IXSCAN == stats.stageType) {
+                const IndexScanStats* spec = static_cast<const IndexScanStats*>(specific);
+                bob->append("indexName", spec->indexName);
+                bob->appendNumber("keysExamined", static_cast<long long>(spec->keysExamined));
+                bob->appendNumber("dupsDropped", static_cast<long long>(spec->dupsDropped));
+                bob->appendNumber("dedupMemUsage", static_cast<long long>(spec->dedupMemUsage));
+            }
+            else if (STAGE_COUNT == stats.stageType) {
+                const CountStats* spec = static_cast<const CountStats*>(specific);
+                bob->append("indexName", spec->indexName);
+                bob->appendNumber("keysExamined", static_cast<long long>(spec->keysExamined));
+            }
+            else if (STAGE_DISTINCT == stats.stageType) {
+                const DistinctScanStats* spec = static_cast<const DistinctScanStats*>(specific);
+                bob->append("indexName", spec->indexName);
+                bob->appendNumber("keysExamined", static_cast<long long>(spec->keysExamined));
+            }
+            else if (STAGE_COLLSCAN == stats.stageType) {
+                const CollectionScanStats* spec = static_cast<const CollectionScanStats*>(specific);
+                bob->appendNumber("docsExamined", static_cast<long long>(spec->docsTested));
+            }
+            else if (STAGE_FETCH == stats.stageType && 1 == stats.children.size()) {
+                // Everything our child gave us was fetched unless it came with the object.
+                const FetchStats* spec = static_cast<const FetchStats*>(specific);
+                uint64_t docsExamined = stats.children[0]->common.advanced - spec->alreadyHasObj;
+                bob->appendNumber("docsExamined", static_cast<long long>(docsExamined));
+            }
+            else if (STAGE_SORT == stats.stageType) {
+                const SortStats* spec = static_cast<const SortStats*>(specific);
+                bob->appendNumber("memUsage", static_cast<long long>(spec->memUsage));
+                bob->appendNumber("memLimit", static_cast<long long>(spec->memLimit));
+                bob->appendBool("usedDisk", spec->usedDisk);
+            }
+            else if (STAGE_AND_HASH == stats.stageType) {
+                const AndHashStats* spec = static_cast<const AndHashStats*>(specific);
+                bob->appendNumber("memUsage", static_cast<long long>(spec->memUsage));
+            }
+
+            if (stats.children.empty()) {
+                return;
+            }
+
+            BSONArrayBuilder childrenBob(bob->subarrayStart("inputStages"));
+            for (size_t i = 0; i < stats.children.size(); ++i) {
+                BSONObjBuilder childBob(childrenBob.subobjStart());
+                statsToBSON(*stats.children[i], &childBob);
+                childBob.doneFast();
+            }
+            childrenBob.doneFast();
+        }
+
         bool isLogicalStage(StageType stageType) {
             switch (stageType) {
             // case STAGE_AND_HASH:
@@ -53,6 +147,11 @@ namespace mongo {
     Status explainPlan(const PlanStageStats& stats, TypeExplain** explain, bool fullDetails) {
         auto_ptr<TypeExplain> res(new TypeExplain);
 
+        // What each stage did.  The shell only shows this for a verbose explain.
+        BSONObjBuilder executionStatsBob;
+        statsToBSON(stats, &executionStatsBob);
+        res->setExecutionStats(executionStatsBob.obj());
+
         // Descend the plan looking for structural properties:
         // + is there any 'or's (TODO ands)? if so, prepare to explain each branch recursively
         // + is is a collection scan or a an index scan?
@@ -127,6 +226,8 @@ namespace mongo {
                 TypeExplain* childExplain = NULL;
                 explainPlan(**it, &childExplain, false /* no full details */);
                 if (childExplain) {
+                    // The branch is already part of our own execution stats.
+                    childExplain->unsetExecutionStats();
                     res->addToClauses(childExplain);
                     nScanned += childExplain->getNScanned();
 
@@ -184,6 +285,26 @@ namespace mongo {
             res->setIsMultiKey(indexStats->isMultiKey);
             res->setIndexOnly(covered);
         }
+        else if (leaf->stageType == STAGE_DISTINCT) {
+            DistinctScanStats* dss = static_cast<DistinctScanStats*>(leaf->specific.get());
+            dassert(dss);
+            string direction = dss->direction > 0 ? "" : " reverse";
+            res->setCursor("BtreeCursor " + dss->indexName + direction);
+            res->setNScanned(dss->keysExamined);
+            res->setNScannedObjects(covered ? 0 : leaf->common.advanced);
+            res->setIndexBounds(dss->indexBounds);
+            res->setIsMultiKey(dss->isMultiKey);
+            res->setIndexOnly(covered);
+        }
+        else if (leaf->stageType == STAGE_COUNT) {
+            CountStats* countStats = static_cast<CountStats*>(leaf->specific.get());
+            dassert(countStats);
+            res->setCursor("BtreeCursor " + countStats->indexName);
+            res->setNScanned(countStats->keysExamined);
+            res->setNScannedObjects(0);
+            res->setIsMultiKey(countStats->isMultiKey);
+            res->setIndexOnly(true);
+        }
         else {
             return Status(ErrorCodes::InternalError, "cannot interpret execution plan");
         }
@@ -46,6 +46,9 @@ namespace mongo {
      * 'nscannedObjectsAllPlans', 'nscannedAllPlans', 'scanAndOrder', 'indexOnly', 'nYields',
      * 'nChunkSkips', 'millis', 'allPlans', and 'oldPlan'.
      *
+     * Either way, 'executionStats' holds the work, timing and memory figures of every stage in
+     * 'stats'.
+     *
      * All these fields are documented in type_explain.h
      *
      * TODO: Currently, only working for single-leaf plans.
@@ -33,7 +33,10 @@
 #include "mongo/db/index/expression_index.h"
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/query/indexability.h"
+#include "mongo/db/query/lru_key_value.h"
 #include "mongo/db/query/qlog.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/mongoutils/str.h"
 #include "third_party/s2/s2.h"
 #include "third_party/s2/s2cell.h"
@@ -41,6 +44,46 @@
 
 namespace mongo {
 
+    // 2dsphere query regions whose index intervals are kept.  0 computes the covering of every
+    // region.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(internalGeoQueryCoveringCacheSize, int, 2048);
+
+    namespace {
+        // The index intervals covering recent 2dsphere query regions, keyed on the BSON of the
+        // geo predicate, so that queries repeating a $geoWithin polygon skip covering it.
+        // Created on first use, once internalGeoQueryCoveringCacheSize is set.
+        SimpleMutex geoCoveringCacheMutex("geoCoveringCache");
+        LRUKeyValue<string, vector<Interval> >* geoCoveringCache = NULL;
+
+        void coverGeoPredicate(const GeoMatchExpression* gme, OrderedIntervalList* oilOut) {
+            const size_t cacheSize = std::max(0, internalGeoQueryCoveringCacheSize);
+            const BSONObj& rawObj = gme->getRawObj();
+            const string key(rawObj.objdata(), rawObj.objsize());
+
+            if (cacheSize) {
+                SimpleMutex::scoped_lock lk(geoCoveringCacheMutex);
+                if (NULL == geoCoveringCache) {
+                    geoCoveringCache = new LRUKeyValue<string, vector<Interval> >(cacheSize);
+                }
+                vector<Interval>* cached;
+                if (geoCoveringCache->get(key, &cached).isOK()) {
+                    oilOut->intervals.insert(oilOut->intervals.end(), cached->begin(),
+                                             cached->end());
+                    return;
+                }
+            }
+
+            const size_t firstNew = oilOut->intervals.size();
+            ExpressionMapping::cover2dsphere(gme->getGeoQuery().getRegion(), oilOut);
+
+            if (cacheSize) {
+                SimpleMutex::scoped_lock lk(geoCoveringCacheMutex);
+                geoCoveringCache->add(key, new vector<Interval>(oilOut->intervals.begin() + firstNew,
+                                                                oilOut->intervals.end()));
+            }
+        }
+    }
+
     string IndexBoundsBuilder::simpleRegex(const char* regex, const char* flags, bool* exact) {
         string r = "";
         *exact = false;
@@ -389,8 +432,7 @@ namespace mongo {
                 verify(0);
             }
 
-            const S2Region& region = gme->getGeoQuery().getRegion();
-            ExpressionMapping::cover2dsphere(region, oilOut);
+            coverGeoPredicate(gme, oilOut);
             *exactOut = false;
         }
         else {
@@ -563,6 +605,67 @@ namespace mongo {
         return bob.obj();
     }
 
+    // static
+    bool IndexBoundsBuilder::isSingleInterval(const IndexBounds& bounds,
+                                              BSONObj* startKey, bool* startKeyInclusive,
+                                              BSONObj* endKey, bool* endKeyInclusive) {
+        if (bounds.isSimpleRange || bounds.fields.empty()) { return false; }
+
+        // We build our start/end keys as we go.
+        BSONObjBuilder startBob;
+        BSONObjBuilder endBob;
+
+        // The start and end keys are inclusive unless we have a non-point interval, in which case
+        // we take the inclusivity from there.
+        *startKeyInclusive = true;
+        *endKeyInclusive = true;
+
+        size_t fieldNo = 0;
+
+        // First, we skip over point intervals.
+        for (; fieldNo < bounds.fields.size(); ++fieldNo) {
+            const OrderedIntervalList& oil = bounds.fields[fieldNo];
+            if (1 != oil.intervals.size() || !oil.intervals[0].isPoint()) { break; }
+            // Since it's a point, start == end.
+            startBob.appendAs(oil.intervals[0].start, "");
+            endBob.appendAs(oil.intervals[0].end, "");
+        }
+
+        if (fieldNo < bounds.fields.size()) {
+            // After the point intervals we can have exactly one non-point interval.
+            const OrderedIntervalList& oil = bounds.fields[fieldNo];
+            if (1 != oil.intervals.size()) { return false; }
+            const Interval& range = oil.intervals[0];
+            startBob.appendAs(range.start, "");
+            endBob.appendAs(range.end, "");
+            *startKeyInclusive = range.startInclusive;
+            *endKeyInclusive = range.endInclusive;
+            ++fieldNo;
+        }
+
+        // And after the non-point interval we can have any number of "all values" intervals.
+        for (; fieldNo < bounds.fields.size(); ++fieldNo) {
+            const OrderedIntervalList& oil = bounds.fields[fieldNo];
+            if (1 != oil.intervals.size()) { return false; }
+            const Interval& ival = oil.intervals[0];
+            // An "all values" interval goes from MinKey to MaxKey, or the reverse on a descending
+            // field.
+            bool isAllValues = ival.startInclusive && ival.endInclusive
+                && ((MinKey == ival.start.type() && MaxKey == ival.end.type())
+                    || (MaxKey == ival.start.type() && MinKey == ival.end.type()));
+            if (!isAllValues) { return false; }
+
+            // Pad the keys so that an exclusive end of the range also excludes every key that
+            // shares its prefix.
+            startBob.appendAs(*startKeyInclusive ? ival.start : ival.end, "");
+            endBob.appendAs(*endKeyInclusive ? ival.end : ival.start, "");
+        }
+
+        *startKey = startBob.obj();
+        *endKey = endBob.obj();
+        return true;
+    }
+
     // static
     void IndexBoundsBuilder::reverseInterval(Interval* ival) {
         BSONElement tmp = ival->start;
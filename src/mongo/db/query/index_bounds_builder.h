@@ -97,6 +97,16 @@ namespace mongo {
          */
         static BSONObj objFromElement(const BSONElement& elt);
 
+        /**
+         * Returns true if the btree bounds 'bounds' describe one contiguous range of keys: zero
+         * or more point intervals, then at most one non-point interval, then all-values intervals.
+         * If so, fills out the end keys of that range (with empty field names) and whether they
+         * are themselves included.  The bounds must be aligned to a forward scan.
+         */
+        static bool isSingleInterval(const IndexBounds& bounds,
+                                     BSONObj* startKey, bool* startKeyInclusive,
+                                     BSONObj* endKey, bool* endKeyInclusive);
+
         /**
          * Swap start/end in the provided interval.
          */
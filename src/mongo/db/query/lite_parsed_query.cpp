@@ -85,8 +85,8 @@ namespace mongo {
     }
 
     LiteParsedQuery::LiteParsedQuery() : _wantMore(true), _explain(false), _snapshot(false),
-                                         _returnKey(false), _showDiskLoc(false), _maxScan(0),
-                                         _maxTimeMS(0) { }
+                                         _returnKey(false), _showDiskLoc(false),
+                                         _allowDiskUse(false), _maxScan(0), _maxTimeMS(0) { }
 
     Status LiteParsedQuery::init(const string& ns, int ntoskip, int ntoreturn, int queryOptions,
                                  const BSONObj& queryObj, const BSONObj& proj,
@@ -221,6 +221,10 @@ namespace mongo {
                     // Won't throw.
                     _showDiskLoc = e.trueValue();
                 }
+                else if (str::equals("allowDiskUse", name)) {
+                    // Won't throw.
+                    _allowDiskUse = e.trueValue();
+                }
                 else if (str::equals("maxTimeMS", name)) {
                     StatusWith<int> maxTimeMS = parseMaxTimeMS(e);
                     if (!maxTimeMS.isOK()) {
@@ -58,7 +58,9 @@ namespace mongo {
           _limit(-1),
           _arrayOpType(ARRAY_OP_NORMAL),
           _hasNonSimple(false),
-          _hasDottedField(false) { }
+          _hasDottedField(false),
+          _isSimpleInclusion(false),
+          _numSimpleIncludedFields(0) { }
 
     LiteProjection::~LiteProjection() {
         for (FieldMap::const_iterator it = _fields.begin(); it != _fields.end(); ++it) {
@@ -210,6 +212,16 @@ namespace mongo {
             }
         }
 
+        // $slice, $elemMatch and $textScore are all non-simple.  Positional projections are over
+        // dotted fields.
+        _isSimpleInclusion = !_include && !_hasNonSimple && !_hasDottedField;
+        if (_isSimpleInclusion) {
+            _numSimpleIncludedFields = _fields.size();
+            if (_includeID && _fields.end() == _fields.find("_id")) {
+                ++_numSimpleIncludedFields;
+            }
+        }
+
         if (ARRAY_OP_POSITIONAL != _arrayOpType) {
             return Status::OK();
         }
@@ -313,6 +325,11 @@ namespace mongo {
                                      BSONObjBuilder* bob,
                                      const MatchDetails* details) const {
 
+        if (_isSimpleInclusion) {
+            transformSimpleInclusion(in, bob);
+            return Status::OK();
+        }
+
         const ArrayOpType& arrayOpType = _arrayOpType;
 
         BSONObjIterator it(in);
@@ -376,6 +393,44 @@ namespace mongo {
         return Status::OK();
     }
 
+    void LiteProjection::transformSimpleInclusion(const BSONObj& in, BSONObjBuilder* bob) const {
+        size_t remaining = _numSimpleIncludedFields;
+
+        // [runStart, runEnd) is the raw data of included elements not yet copied into 'bob'.
+        const char* runStart = NULL;
+        const char* runEnd = NULL;
+
+        BSONObjIterator it(in);
+        while (remaining > 0 && it.more()) {
+            BSONElement elt = it.next();
+
+            bool included;
+            if (mongoutils::str::equals("_id", elt.fieldName())) {
+                included = _includeID;
+            }
+            else {
+                included = (_fields.end() != _fields.find(elt.fieldName()));
+            }
+
+            if (!included) {
+                continue;
+            }
+            --remaining;
+
+            if (elt.rawdata() != runEnd) {
+                if (NULL != runStart) {
+                    bob->bb().appendBuf(runStart, runEnd - runStart);
+                }
+                runStart = elt.rawdata();
+            }
+            runEnd = elt.rawdata() + elt.size();
+        }
+
+        if (NULL != runStart) {
+            bob->bb().appendBuf(runStart, runEnd - runStart);
+        }
+    }
+
     void LiteProjection::appendArray(BSONObjBuilder* bob, const BSONObj& array, bool nested) const {
         int skip  = nested ?  0 : _skip;
         int limit = nested ? -1 : _limit;
@@ -153,6 +153,13 @@ namespace mongo {
         // XXX document
         void appendArray(BSONObjBuilder* bob, const BSONObj& array, bool nested = false) const;
 
+        /**
+         * transform(...) for a projection that only includes top-level fields.  Makes one pass
+         * over 'in', stops once every included field has been seen, and copies runs of adjacent
+         * included elements into 'bob' in one go.
+         */
+        void transformSimpleInclusion(const BSONObj& in, BSONObjBuilder* bob) const;
+
         // True if default at this level is to include.
         bool _include;
 
@@ -187,6 +194,13 @@ namespace mongo {
         // Is there a projection over a dotted field?
         bool _hasDottedField;
 
+        // Is this only an inclusion of top-level fields?  If so, transform(...) takes the
+        // transformSimpleInclusion(...) path.
+        bool _isSimpleInclusion;
+
+        // How many top-level fields (counting _id) a simple inclusion outputs at most.
+        size_t _numSimpleIncludedFields;
+
         // The field name for a $textScore projection
         StringData _textScoreFieldName;
     };
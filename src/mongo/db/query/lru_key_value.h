@@ -0,0 +1,204 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <list>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/unordered_map.h"
+
+namespace mongo {
+
+    /**
+     * A key-value store structure with a least recently used (LRU) replacement
+     * policy.  The number of entries allowed in the kv-store is set as a constructor
+     * argument.
+     *
+     * Caller must provide a hash function for the key type via unordered_map.
+     *
+     * The kv-store owns its values: a value is deleted when it is evicted, removed,
+     * replaced or when the kv-store is cleared or destroyed.
+     *
+     * Not thread safe.  Callers must provide their own synchronization.
+     */
+    template<class K, class V>
+    class LRUKeyValue {
+        MONGO_DISALLOW_COPYING(LRUKeyValue);
+    public:
+        typedef std::pair<K, V*> KVListEntry;
+        typedef std::list<KVListEntry> KVList;
+        typedef typename KVList::iterator KVListIt;
+        typedef typename KVList::const_iterator KVListConstIt;
+
+        typedef unordered_map<K, KVListIt> KVMap;
+        typedef typename KVMap::const_iterator KVMapConstIt;
+
+        LRUKeyValue(size_t maxSize) : _maxSize(maxSize), _currentSize(0) { }
+
+        ~LRUKeyValue() {
+            clear();
+        }
+
+        /**
+         * Add an (K, V*) pair to the store, where 'key' can be used to retrieve value 'entry'
+         * from the store.  Takes ownership of 'entry'.
+         *
+         * If 'key' already exists in the kv-store, 'entry' replaces the old value, which is
+         * deleted.
+         *
+         * If the size of the kv-store exceeds the maximum after adding 'entry', the least
+         * recently used entry is evicted and deleted.  Returns true if an entry was evicted.
+         */
+        bool add(const K& key, V* entry) {
+            // If the key already exists, delete it first.
+            KVMapConstIt i = _kvMap.find(key);
+            if (i != _kvMap.end()) {
+                KVListIt found = i->second;
+                delete found->second;
+                _kvMap.erase(i);
+                _kvList.erase(found);
+                _currentSize--;
+            }
+
+            _kvList.push_front(std::make_pair(key, entry));
+            _kvMap[key] = _kvList.begin();
+            _currentSize++;
+
+            if (_currentSize <= _maxSize) {
+                return false;
+            }
+
+            // Evict the least recently used entry.
+            KVListIt last = _kvList.end();
+            --last;
+            _kvMap.erase(last->first);
+            delete last->second;
+            _kvList.erase(last);
+            _currentSize--;
+            return true;
+        }
+
+        /**
+         * Retrieve the value associated with 'key' from the kv-store.  The value is still
+         * owned by the kv-store.  Marks the entry as most recently used.
+         */
+        Status get(const K& key, V** entryOut) {
+            KVMapConstIt i = _kvMap.find(key);
+            if (i == _kvMap.end()) {
+                return Status(ErrorCodes::NoSuchKey, "no such key in LRU key-value store");
+            }
+            KVListIt found = i->second;
+            V* foundEntry = found->second;
+
+            // Promote the kv-store entry to the front of the list.  It is now the most
+            // recently used.
+            _kvList.splice(_kvList.begin(), _kvList, found);
+
+            *entryOut = foundEntry;
+            return Status::OK();
+        }
+
+        /**
+         * Like get, but does not change the order of the entries.  Used to inspect the
+         * kv-store.
+         */
+        Status peek(const K& key, V** entryOut) const {
+            KVMapConstIt i = _kvMap.find(key);
+            if (i == _kvMap.end()) {
+                return Status(ErrorCodes::NoSuchKey, "no such key in LRU key-value store");
+            }
+            *entryOut = i->second->second;
+            return Status::OK();
+        }
+
+        /**
+         * Remove the kv-store entry keyed by 'key'.  Deletes its value.
+         */
+        Status remove(const K& key) {
+            KVMapConstIt i = _kvMap.find(key);
+            if (i == _kvMap.end()) {
+                return Status(ErrorCodes::NoSuchKey, "no such key in LRU key-value store");
+            }
+            KVListIt found = i->second;
+            delete found->second;
+            _kvMap.erase(i);
+            _kvList.erase(found);
+            _currentSize--;
+            return Status::OK();
+        }
+
+        /**
+         * Deletes all entries in the kv-store.
+         */
+        void clear() {
+            for (KVListIt i = _kvList.begin(); i != _kvList.end(); ++i) {
+                delete i->second;
+            }
+            _kvList.clear();
+            _kvMap.clear();
+            _currentSize = 0;
+        }
+
+        /**
+         * Returns true if entry is found in the kv-store.  Does not affect recency.
+         */
+        bool hasKey(const K& key) const {
+            return _kvMap.find(key) != _kvMap.end();
+        }
+
+        /**
+         * Returns the number of entries currently in the kv-store.
+         */
+        size_t size() const { return _currentSize; }
+
+        /**
+         * Iteration from most recently used to least recently used.  Iterating does not
+         * affect recency.
+         */
+        KVListConstIt begin() const { return _kvList.begin(); }
+
+        KVListConstIt end() const { return _kvList.end(); }
+
+    private:
+        // The maximum allowable number of entries in the kv-store.
+        const size_t _maxSize;
+
+        // The number of entries currently in the kv-store.
+        size_t _currentSize;
+
+        // (K, V*) pairs are stored in this std::list.  They are sorted in order of use, where
+        // the front is the most recently used and the back is the least recently used.
+        KVList _kvList;
+
+        // Maps from a key to the corresponding std::list entry.
+        KVMap _kvMap;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,197 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/lru_key_value.h
+ */
+
+#include "mongo/db/query/lru_key_value.h"
+
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    //
+    // Convenience functions
+    //
+
+    void assertInKVStore(LRUKeyValue<int, int>& cache, int key, int value) {
+        int* cachedValue = NULL;
+        ASSERT_TRUE(cache.hasKey(key));
+        Status s = cache.get(key, &cachedValue);
+        ASSERT_OK(s);
+        ASSERT_EQUALS(*cachedValue, value);
+    }
+
+    void assertNotInKVStore(LRUKeyValue<int, int>& cache, int key) {
+        int* cachedValue = NULL;
+        ASSERT_FALSE(cache.hasKey(key));
+        Status s = cache.get(key, &cachedValue);
+        ASSERT_NOT_OK(s);
+    }
+
+    /**
+     * Test that we can add an entry and get it back out.
+     */
+    TEST(LRUKeyValueTest, BasicAddGet) {
+        LRUKeyValue<int, int> cache(100);
+        cache.add(1, new int(2));
+        assertInKVStore(cache, 1, 2);
+    }
+
+    /**
+     * A kv-store with a max size of 0 isn't too useful, but test
+     * that at the very least we don't blow up.
+     */
+    TEST(LRUKeyValueTest, SizeZeroCache) {
+        LRUKeyValue<int, int> cache(0);
+        cache.add(1, new int(2));
+        assertNotInKVStore(cache, 1);
+    }
+
+    /**
+     * Make sure eviction and promotion work properly with
+     * a kv-store of size 1.
+     */
+    TEST(LRUKeyValueTest, SizeOneCache) {
+        LRUKeyValue<int, int> cache(1);
+        cache.add(0, new int(0));
+        assertInKVStore(cache, 0, 0);
+
+        // Second entry should immediately evict the first.
+        ASSERT_TRUE(cache.add(1, new int(1)));
+        assertNotInKVStore(cache, 0);
+        assertInKVStore(cache, 1, 1);
+    }
+
+    /**
+     * Fill up a size 10 kv-store with 10 entries. Call get()
+     * on every entry except for one. Then call add() and
+     * make sure that the proper entry got evicted.
+     */
+    TEST(LRUKeyValueTest, EvictionTest) {
+        int maxSize = 10;
+        LRUKeyValue<int, int> cache(maxSize);
+        for (int i = 0; i < maxSize; ++i) {
+            ASSERT_FALSE(cache.add(i, new int(i)));
+        }
+        ASSERT_EQUALS(cache.size(), (size_t)maxSize);
+
+        // Call get() on all but one key.
+        int evictKey = 5;
+        for (int i = 0; i < maxSize; ++i) {
+            if (i == evictKey) { continue; }
+            assertInKVStore(cache, i, i);
+        }
+
+        // Adding another entry causes an eviction.
+        ASSERT_TRUE(cache.add(maxSize + 1, new int(maxSize + 1)));
+        ASSERT_EQUALS(cache.size(), (size_t)maxSize);
+
+        // Check that the least recently accessed has been evicted.
+        for (int i = 0; i < maxSize; ++i) {
+            if (i == evictKey) {
+                assertNotInKVStore(cache, evictKey);
+            }
+            else {
+                assertInKVStore(cache, i, i);
+            }
+        }
+    }
+
+    /**
+     * Adding an existing key replaces the old value without growing
+     * the kv-store.
+     */
+    TEST(LRUKeyValueTest, ReplaceKeyTest) {
+        LRUKeyValue<int, int> cache(10);
+        cache.add(4, new int(4));
+        assertInKVStore(cache, 4, 4);
+        cache.add(4, new int(5));
+        assertInKVStore(cache, 4, 5);
+        ASSERT_EQUALS(cache.size(), 1U);
+    }
+
+    /**
+     * Test iteration over the kv-store, from most to least recently used.
+     */
+    TEST(LRUKeyValueTest, IterationTest) {
+        LRUKeyValue<int, int> cache(2);
+        cache.add(1, new int(1));
+        cache.add(2, new int(2));
+
+        typedef std::list< std::pair<int, int*> >::const_iterator CacheIterator;
+        CacheIterator i = cache.begin();
+        ASSERT_EQUALS(i->first, 2);
+        ++i;
+        ASSERT_EQUALS(i->first, 1);
+        ++i;
+        ASSERT(i == cache.end());
+    }
+
+    /**
+     * Test removal and clearing.
+     */
+    TEST(LRUKeyValueTest, RemoveAndClearTest) {
+        LRUKeyValue<int, int> cache(10);
+        cache.add(1, new int(1));
+        cache.add(2, new int(2));
+        cache.add(3, new int(3));
+
+        ASSERT_OK(cache.remove(2));
+        ASSERT_NOT_OK(cache.remove(2));
+        assertNotInKVStore(cache, 2);
+        ASSERT_EQUALS(cache.size(), 2U);
+
+        cache.clear();
+        ASSERT_EQUALS(cache.size(), 0U);
+        assertNotInKVStore(cache, 1);
+        assertNotInKVStore(cache, 3);
+    }
+
+    /**
+     * Peeking finds an entry without promoting it.
+     */
+    TEST(LRUKeyValueTest, PeekDoesNotPromote) {
+        LRUKeyValue<int, int> cache(2);
+        cache.add(1, new int(1));
+        cache.add(2, new int(2));
+
+        int* value;
+        ASSERT_OK(cache.peek(1, &value));
+        ASSERT_EQUALS(*value, 1);
+        ASSERT_NOT_OK(cache.peek(3, &value));
+
+        // 1 is still the least recently used entry and gets evicted.
+        ASSERT_TRUE(cache.add(3, new int(3)));
+        assertNotInKVStore(cache, 1);
+    }
+
+}  // namespace
@@ -28,19 +28,131 @@
 
 #include "mongo/db/query/multi_plan_runner.h"
 
+#include "mongo/db/client.h"
+#include "mongo/db/d_concurrency.h"
+#include "mongo/db/database.h"
 #include "mongo/db/diskloc.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/explain_plan.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/qlog.h"
+#include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/type_explain.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/trace_points.h"
 
 namespace mongo {
 
+    // The plan competition works each candidate this fraction of the number of documents in
+    // the collection, but at least internalQueryPlanEvaluationMinWorks and at most
+    // internalQueryPlanEvaluationMaxWorks times.  The works are a shared budget: the works not
+    // spent on an abandoned candidate go to the others.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationCollFraction, double, 0.3);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMinWorks, int, 100);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxWorks, int, 10000);
+
+    // The competition stops as soon as a candidate has produced this many results, or the
+    // number of results the query asked for, whichever is smaller.  These are returned as the
+    // first batch.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
+
+    // A candidate is abandoned when the leader has produced this many times more results than
+    // it.  Zero disables abandoning.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationAbandonRatio, int, 10);
+
+    // How many rounds of work we do between looking for candidates to abandon.
+    static const size_t kRoundsBetweenAbandonChecks = 10;
+
+    // If greater than one, the number of threads that may work the candidates of one query at
+    // the same time.  Only queries run under a read lock are worked in parallel.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(internalQueryPlanEvaluationThreads, int, 0);
+
+    // How many times each candidate is worked by a pool thread before the pool hands the
+    // plans back to us, so that we can fetch, yield and abandon plans.
+    static const size_t kWorksPerParallelSlice = 100;
+
+    namespace {
+
+        /**
+         * One candidate's share of a parallel round: at most 'maxWorks' works, on a pool thread.
+         */
+        struct TrialSlice {
+            TrialSlice(CandidatePlan* c, size_t w, size_t r)
+                : candidate(c), maxWorks(w), maxResults(r), works(0),
+                  state(PlanStage::NEED_TIME), id(WorkingSet::INVALID_ID) { }
+
+            CandidatePlan* candidate;
+            size_t maxWorks;
+            size_t maxResults;
+
+            // Filled out by the pool thread.  The slice ends early with a NEED_FETCH, EOF or
+            // failure, which the thread that owns the plans handles.
+            size_t works;
+            PlanStage::StageState state;
+            WorkingSetID id;
+        };
+
+        void runTrialSlice(TrialSlice* slice) {
+            // Stages may need a Client, eg. to account for records that are not in memory.  The
+            // Client of a pool thread holds no lock; the thread that scheduled us holds the read
+            // lock until we are done.
+            Client::initThreadIfNotAlready("plan evaluation worker");
+
+            CandidatePlan* candidate = slice->candidate;
+            try {
+                while (slice->works < slice->maxWorks) {
+                    slice->state = candidate->root->work(&slice->id);
+                    ++slice->works;
+
+                    if (PlanStage::ADVANCED == slice->state) {
+                        candidate->results.push_back(slice->id);
+                        if (candidate->results.size() >= slice->maxResults) { break; }
+                    }
+                    else if (PlanStage::NEED_TIME != slice->state) {
+                        break;
+                    }
+                }
+            }
+            catch (const std::exception& e) {
+                warning() << "candidate plan failed on plan evaluation thread: " << e.what()
+                          << endl;
+                slice->state = PlanStage::FAILURE;
+            }
+        }
+
+        mongo::mutex trialPoolMutex("MultiPlanRunner trial pool");
+        ThreadPool* trialPool = NULL;
+
+        ThreadPool* getTrialPool() {
+            scoped_lock lk(trialPoolMutex);
+            if (NULL == trialPool) {
+                // Lives as long as the process.
+                trialPool = new ThreadPool(internalQueryPlanEvaluationThreads);
+            }
+            return trialPool;
+        }
+
+        /**
+         * Runs every slice on the pool and waits for them to finish.
+         */
+        void runTrialSlices(std::vector<TrialSlice>* slices) {
+            // Other queries share the pool, so wait for our own slices only.
+            TaskGroup slicesGroup(*getTrialPool());
+            for (size_t i = 0; i < slices->size(); ++i) {
+                slicesGroup.schedule(&runTrialSlice, &(*slices)[i]);
+            }
+            slicesGroup.wait();
+        }
+
+    }  // namespace
+
     MultiPlanRunner::MultiPlanRunner(CanonicalQuery* query)
         : _killed(false),
           _failure(false),
@@ -281,17 +393,46 @@ namespace mongo {
     }
 
     bool MultiPlanRunner::pickBestPlan(size_t* out) {
-        static const int timesEachPlanIsWorked = 100;
+        const size_t worksBudget = trialWorksPerCandidate() * _candidates.size();
+        const size_t maxResults = trialMaxResults();
+        QLOG() << "Running " << _candidates.size() << " candidates with a budget of "
+               << worksBudget << " works" << endl;
+
+        // Work the plans round-robin until one of them hits EOF or produces a full first batch,
+        // or until the budget is spent.
+        const bool parallel = shouldWorkPlansInParallel(worksBudget / _candidates.size());
+        size_t worksDone = 0;
+        for (size_t round = 1; worksDone < worksBudget; ++round) {
+            bool moreToDo;
+            bool checkAbandon;
+
+            // The first round is always ours: stages look up their collection through the
+            // Client of this thread on their first work.
+            if (parallel && round > 1) {
+                const size_t liveCandidates = _candidates.size() - _failureCount;
+                const size_t sliceWorks = std::max(static_cast<size_t>(1),
+                    std::min(kWorksPerParallelSlice,
+                             (worksBudget - worksDone) / std::max(liveCandidates,
+                                                                  static_cast<size_t>(1))));
+                moreToDo = workAllPlansInParallel(sliceWorks, maxResults, &worksDone);
+                checkAbandon = true;
+            }
+            else {
+                moreToDo = workAllPlans(maxResults, &worksDone);
+                checkAbandon = (0 == round % kRoundsBetweenAbandonChecks);
+            }
 
-        // Run each plan some number of times.
-        for (int i = 0; i < timesEachPlanIsWorked; ++i) {
-            bool moreToDo = workAllPlans();
             if (!moreToDo) { break; }
+
+            if (checkAbandon) {
+                abandonHopelessPlans();
+            }
         }
 
         if (_failure || _killed) { return false; }
 
-        size_t bestChild = PlanRanker::pickBestPlan(_candidates, NULL);
+        auto_ptr<PlanRankingDecision> decision(new PlanRankingDecision());
+        size_t bestChild = PlanRanker::pickBestPlan(_candidates, decision.get());
 
         // Run the best plan.  Store it.
         _bestPlan.reset(new PlanExecutor(_candidates[bestChild].ws,
@@ -318,11 +459,11 @@ namespace mongo {
             }
         }
 
-        // TODO:
-        // Store the choice we just made in the cache.
-        // QueryPlanCache* cache = PlanCache::get(somenamespace);
-        // cache->add(_query, *_candidates[bestChild]->solution, decision->bestPlanStats);
-        // delete decision;
+        // Store the choice we just made in the cache.  If the winner has a blocked sort we may
+        // end up running the backup plan instead, so we don't know what to cache yet.
+        if (NULL == _backupSolution) {
+            cacheBestPlan(decision.release());
+        }
 
         // Clear out the candidate plans, leaving only stats as we're all done w/them.
         for (size_t i = 0; i < _candidates.size(); ++i) {
@@ -349,12 +490,76 @@ namespace mongo {
         return true;
     }
 
-    bool MultiPlanRunner::workAllPlans() {
+    void MultiPlanRunner::cacheBestPlan(PlanRankingDecision* why) {
+        auto_ptr<PlanRankingDecision> autoWhy(why);
+        if (!PlanCache::shouldCacheQuery(*_query)) { return; }
+
+        Database* db = cc().database();
+        if (NULL == db) { return; }
+        Collection* collection = db->getCollection(_query->ns());
+        if (NULL == collection) { return; }
+
+        PlanCache* cache = collection->infoCache()->getPlanCache();
+        cache->add(*_query, *_bestSolution, autoWhy.release());
+    }
+
+    size_t MultiPlanRunner::trialWorksPerCandidate() const {
+        const size_t minWorks = std::max(1, internalQueryPlanEvaluationMinWorks);
+        const size_t maxWorks = std::max(static_cast<size_t>(internalQueryPlanEvaluationMaxWorks),
+                                         minWorks);
+
+        size_t works = minWorks;
+        Database* db = cc().database();
+        Collection* collection = (NULL == db) ? NULL : db->getCollection(_query->ns());
+        if (NULL != collection) {
+            const double fraction = internalQueryPlanEvaluationCollFraction;
+            works = std::max(works, static_cast<size_t>(fraction * collection->numRecords()));
+        }
+        return std::min(works, maxWorks);
+    }
+
+    size_t MultiPlanRunner::trialMaxResults() const {
+        size_t maxResults = std::max(1, internalQueryPlanEvaluationMaxResults);
+        const int numToReturn = _query->getParsed().getNumToReturn();
+        if (numToReturn > 0) {
+            maxResults = std::min(maxResults, static_cast<size_t>(numToReturn));
+        }
+        return maxResults;
+    }
+
+    void MultiPlanRunner::abandonHopelessPlans() {
+        const int ratio = internalQueryPlanEvaluationAbandonRatio;
+        if (ratio <= 0) { return; }
+
+        size_t leaderResults = 0;
+        for (size_t i = 0; i < _candidates.size(); ++i) {
+            const CandidatePlan& candidate = _candidates[i];
+            if (candidate.failed || candidate.abandoned) { continue; }
+            leaderResults = std::max(leaderResults, candidate.results.size());
+        }
+
+        // Too few results to tell the candidates apart.  The leader itself is never abandoned.
+        if (leaderResults < static_cast<size_t>(ratio)) { return; }
+
+        for (size_t i = 0; i < _candidates.size(); ++i) {
+            CandidatePlan& candidate = _candidates[i];
+            if (candidate.failed || candidate.abandoned) { continue; }
+            if (candidate.results.size() * ratio < leaderResults) {
+                QLOG() << "Abandoning candidate " << i << " with " << candidate.results.size()
+                       << " results, the leader has " << leaderResults << endl;
+                candidate.abandoned = true;
+            }
+        }
+    }
+
+    bool MultiPlanRunner::workAllPlans(size_t maxResults, size_t* worksDone) {
         bool planHitEOF = false;
+        bool planFilledBatch = false;
+        size_t numWorked = 0;
 
         for (size_t i = 0; i < _candidates.size(); ++i) {
             CandidatePlan& candidate = _candidates[i];
-            if (candidate.failed) { continue; }
+            if (candidate.failed || candidate.abandoned) { continue; }
 
             // Yield, if we can yield ourselves.
             if (NULL != _yieldPolicy.get() && _yieldPolicy->shouldYield()) {
@@ -365,48 +570,26 @@ namespace mongo {
             }
 
             WorkingSetID id;
-            PlanStage::StageState state = candidate.root->work(&id);
+            PlanStage::StageState state;
+            {
+                MONGO_TRACE_SCOPE("query", "work (plan ranking)");
+                state = candidate.root->work(&id);
+            }
+            ++*worksDone;
+            ++numWorked;
 
             if (PlanStage::ADVANCED == state) {
-                // Save result for later.
+                // Save result for later.  They make up the first batch if this plan wins.
                 candidate.results.push_back(id);
+                if (candidate.results.size() >= maxResults) {
+                    planFilledBatch = true;
+                }
             }
             else if (PlanStage::NEED_TIME == state) {
                 // Fall through to yield check at end of large conditional.
             }
             else if (PlanStage::NEED_FETCH == state) {
-                // id has a loc and refers to an obj we need to fetch.
-                WorkingSetMember* member = candidate.ws->get(id);
-
-                // This must be true for somebody to request a fetch and can only change when an
-                // invalidation happens, which is when we give up a lock.  Don't give up the
-                // lock between receiving the NEED_FETCH and actually fetching(?).
-                verify(member->hasLoc());
-
-                // Actually bring record into memory.
-                Record* record = member->loc.rec();
-
-                // If we're allowed to, go to disk outside of the lock.
-                if (NULL != _yieldPolicy.get()) {
-                    saveState();
-                    _yieldPolicy->yield(record);
-                    if (_failure || _killed) { return false; }
-                    restoreState();
-                }
-                else {
-                    // We're set to manually yield.  We go to disk in the lock.
-                    record->touch();
-                }
-
-                // Record should be in memory now.  Log if it's not.
-                if (!Record::likelyInPhysicalMemory(record->dataNoThrowing())) {
-                    OCCASIONALLY {
-                        warning() << "Record wasn't in memory immediately after fetch: "
-                            << member->loc.toString() << endl;
-                    }
-                }
-
-                // Note that we're not freeing id.  Fetch semantics say that we shouldn't.
+                if (!fetchForCandidate(candidate, id)) { return false; }
             }
             else if (PlanStage::IS_EOF == state) {
                 // First plan to hit EOF wins automatically.  Stop evaluating other plans.
@@ -427,7 +610,123 @@ namespace mongo {
             }
         }
 
-        return !planHitEOF;
+        // Every plan left to run was abandoned or failed.
+        if (0 == numWorked) { return false; }
+
+        return !planHitEOF && !planFilledBatch;
+    }
+
+    bool MultiPlanRunner::fetchForCandidate(const CandidatePlan& candidate, WorkingSetID id) {
+        // id has a loc and refers to an obj we need to fetch.
+        WorkingSetMember* member = candidate.ws->get(id);
+
+        // This must be true for somebody to request a fetch and can only change when an
+        // invalidation happens, which is when we give up a lock.  Don't give up the
+        // lock between receiving the NEED_FETCH and actually fetching(?).
+        verify(member->hasLoc());
+
+        // Actually bring record into memory.
+        Record* record = member->loc.rec();
+
+        // If we're allowed to, go to disk outside of the lock.
+        if (NULL != _yieldPolicy.get()) {
+            saveState();
+            _yieldPolicy->yield(record);
+            if (_failure || _killed) { return false; }
+            restoreState();
+        }
+        else {
+            // We're set to manually yield.  We go to disk in the lock.
+            record->touch();
+        }
+
+        // Record should be in memory now.  Log if it's not.
+        if (!Record::likelyInPhysicalMemory(record->dataNoThrowing())) {
+            OCCASIONALLY {
+                warning() << "Record wasn't in memory immediately after fetch: "
+                    << member->loc.toString() << endl;
+            }
+        }
+
+        // Note that we're not freeing id.  Fetch semantics say that we shouldn't.
+        return true;
+    }
+
+    bool MultiPlanRunner::shouldWorkPlansInParallel(size_t worksPerCandidate) const {
+        if (internalQueryPlanEvaluationThreads <= 1) { return false; }
+        if (_candidates.size() < 2) { return false; }
+
+        // A short competition isn't worth handing the plans to other threads.
+        if (worksPerCandidate <= kWorksPerParallelSlice) { return false; }
+
+        // The pool threads don't take the lock.  They may only read, under the read lock that
+        // we hold for them.
+        if (!Lock::isReadLocked()) { return false; }
+
+        // These stages need the Client of the thread that holds the lock while they run.
+        MatchExpression* root = _query->root();
+        if (QueryPlannerCommon::hasNode(root, MatchExpression::WHERE)
+            || QueryPlannerCommon::hasNode(root, MatchExpression::GEO)
+            || QueryPlannerCommon::hasNode(root, MatchExpression::GEO_NEAR)
+            || QueryPlannerCommon::hasNode(root, MatchExpression::TEXT)) {
+            return false;
+        }
+
+        return true;
+    }
+
+    bool MultiPlanRunner::workAllPlansInParallel(size_t maxWorks, size_t maxResults,
+                                                 size_t* worksDone) {
+        vector<TrialSlice> slices;
+        for (size_t i = 0; i < _candidates.size(); ++i) {
+            CandidatePlan& candidate = _candidates[i];
+            if (candidate.failed || candidate.abandoned) { continue; }
+            slices.push_back(TrialSlice(&candidate, maxWorks, maxResults));
+        }
+
+        // Every plan left to run was abandoned or failed.
+        if (slices.empty()) { return false; }
+
+        runTrialSlices(&slices);
+
+        bool planHitEOF = false;
+        bool planFilledBatch = false;
+        for (size_t i = 0; i < slices.size(); ++i) {
+            const TrialSlice& slice = slices[i];
+            CandidatePlan& candidate = *slice.candidate;
+            *worksDone += slice.works;
+
+            if (candidate.results.size() >= maxResults) {
+                planFilledBatch = true;
+            }
+
+            if (PlanStage::NEED_FETCH == slice.state) {
+                // The pool threads leave fetching to us, as we may have to yield for it.
+                if (!fetchForCandidate(candidate, slice.id)) { return false; }
+            }
+            else if (PlanStage::IS_EOF == slice.state) {
+                planHitEOF = true;
+            }
+            else if (PlanStage::FAILURE == slice.state || PlanStage::DEAD == slice.state) {
+                candidate.failed = true;
+                ++_failureCount;
+
+                if (_failureCount == _candidates.size()) {
+                    _failure = true;
+                    return false;
+                }
+            }
+        }
+
+        // The pool threads are done with the plans, so we may yield.
+        if (NULL != _yieldPolicy.get() && _yieldPolicy->shouldYield()) {
+            saveState();
+            _yieldPolicy->yield();
+            if (_failure || _killed) { return false; }
+            restoreState();
+        }
+
+        return !planHitEOF && !planFilledBatch;
     }
 
     void MultiPlanRunner::allPlansSaveState() {
@@ -500,6 +799,7 @@ namespace mongo {
 
         (*explain)->setNScannedObjectsAllPlans(nScannedObjectsAllPlans);
         (*explain)->setNScannedAllPlans(nScannedAllPlans);
+        (*explain)->setPeakWorkingSetMembers(_bestPlan->getWorkingSet()->getPeakMembers());
 
         return Status::OK();
     }
@@ -104,9 +104,54 @@ namespace mongo {
 
     private:
         /**
-         * Have all our candidate plans do something.
+         * Have all our candidate plans do something.  Adds the number of works done to
+         * '*worksDone'.  Returns false if the competition is over: a plan hit EOF or produced
+         * 'maxResults' results, or every plan failed.
          */
-        bool workAllPlans();
+        bool workAllPlans(size_t maxResults, size_t* worksDone);
+
+        /**
+         * Like workAllPlans, but works each candidate up to 'maxWorks' times on the threads of
+         * the plan evaluation pool, all at once.  Fetches and yields happen on this thread
+         * between such rounds, when no plan is running.
+         */
+        bool workAllPlansInParallel(size_t maxWorks, size_t maxResults, size_t* worksDone);
+
+        /**
+         * Returns true if the candidates may be worked on the plan evaluation pool.  See
+         * internalQueryPlanEvaluationThreads.
+         */
+        bool shouldWorkPlansInParallel(size_t worksPerCandidate) const;
+
+        /**
+         * Bring the record that 'candidate' asked for with a NEED_FETCH for 'id' into memory,
+         * yielding if we may.  Returns false if we were killed or failed while yielding.
+         */
+        bool fetchForCandidate(const CandidatePlan& candidate, WorkingSetID id);
+
+        /**
+         * Stop working the candidates whose productivity is hopeless compared to that of the
+         * leader.  See internalQueryPlanEvaluationAbandonRatio.
+         */
+        void abandonHopelessPlans();
+
+        /**
+         * How many times each candidate may be worked in the competition.  Grows with the size
+         * of the collection.
+         */
+        size_t trialWorksPerCandidate() const;
+
+        /**
+         * How many results a candidate produces before it wins the competition outright.
+         */
+        size_t trialMaxResults() const;
+
+        /**
+         * Record _bestSolution as the winner for our query's shape in the plan cache of the
+         * collection.  Takes ownership of 'why'.
+         */
+        void cacheBestPlan(PlanRankingDecision* why);
+
         void allPlansSaveState();
         void allPlansRestoreState();
 
@@ -42,12 +42,14 @@
 #include "mongo/db/query/cached_plan_runner.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/eof_runner.h"
+#include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/multi_plan_runner.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/qlog.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/query/query_settings.h"
 #include "mongo/db/query/single_solution_runner.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/db/query/type_explain.h"
@@ -135,6 +137,99 @@ namespace mongo {
         return true;
     }
 
+    /**
+     * If 'soln' is an index scan, possibly under a fetch, with no filters and bounds that are a
+     * single btree interval, replace the plan with a COUNT over that interval.  The count
+     * compares keys only and never materializes a WorkingSetMember.
+     *
+     * Returns true if 'soln' was rewritten.
+     */
+    static bool turnIxscanIntoCount(QuerySolution* soln) {
+        QuerySolutionNode* root = soln->root.get();
+
+        // The fetch, if any, must not be filtering anything either.
+        if (STAGE_FETCH == root->getType()) {
+            if (NULL != root->filter.get()) { return false; }
+            root = root->children[0];
+        }
+
+        if (STAGE_IXSCAN != root->getType() || NULL != root->filter.get()) { return false; }
+
+        const IndexScanNode* isn = static_cast<const IndexScanNode*>(root);
+
+        // The bounds have to be aligned to a forward scan for the end keys to make sense.
+        if (1 != isn->direction) { return false; }
+
+        BSONObj startKey;
+        bool startKeyInclusive;
+        BSONObj endKey;
+        bool endKeyInclusive;
+        if (!IndexBoundsBuilder::isSingleInterval(isn->bounds, &startKey, &startKeyInclusive,
+                                                  &endKey, &endKeyInclusive)) {
+            return false;
+        }
+
+        CountNode* cn = new CountNode();
+        cn->indexKeyPattern = isn->indexKeyPattern;
+        cn->startKey = startKey;
+        cn->startKeyInclusive = startKeyInclusive;
+        cn->endKey = endKey;
+        cn->endKeyInclusive = endKeyInclusive;
+
+        // Deletes the old tree.
+        soln->root.reset(cn);
+        return true;
+    }
+
+    /**
+     * Is 'keyPattern' a plain btree index (no "2d", "hashed", ...) that starts with 'field'?
+     */
+    static bool isBtreeIndexStartingWith(const BSONObj& keyPattern, const string& field) {
+        if (field != keyPattern.firstElement().fieldName()) { return false; }
+
+        BSONObjIterator it(keyPattern);
+        while (it.more()) {
+            if (!it.next().isNumber()) { return false; }
+        }
+        return true;
+    }
+
+    /**
+     * If 'soln' is an index scan, possibly under an unfiltered fetch, over a non-multikey btree
+     * index starting with 'field', replace the plan with a DISTINCT over the same bounds.
+     *
+     * Returns true if 'soln' was rewritten.
+     */
+    static bool turnIxscanIntoDistinct(QuerySolution* soln, const string& field) {
+        QuerySolutionNode* root = soln->root.get();
+
+        if (STAGE_FETCH == root->getType()) {
+            if (NULL != root->filter.get()) { return false; }
+            root = root->children[0];
+        }
+
+        if (STAGE_IXSCAN != root->getType()) { return false; }
+
+        IndexScanNode* isn = static_cast<IndexScanNode*>(root);
+        if (isn->indexIsMultiKey || isn->bounds.isSimpleRange
+            || !isBtreeIndexStartingWith(isn->indexKeyPattern, field)) {
+            return false;
+        }
+
+        DistinctNode* dn = new DistinctNode();
+        dn->indexKeyPattern = isn->indexKeyPattern;
+        dn->direction = isn->direction;
+        dn->bounds = isn->bounds;
+        dn->fieldNo = 0;
+        // The filter only refers to fields in the index key, so the DISTINCT can apply it.  It
+        // points into soln->filterData, which stays put.
+        dn->filter.swap(isn->filter);
+
+        // Deletes the old tree.
+        soln->root.reset(dn);
+        return true;
+    }
+
     /**
      * For a given query, get a runner.  The runner could be a SingleSolutionRunner, a
      * CachedQueryRunner, or a MultiPlanRunner, depending on the cache/query solver/etc.
@@ -143,24 +238,6 @@ namespace mongo {
         verify(rawCanonicalQuery);
         auto_ptr<CanonicalQuery> canonicalQuery(rawCanonicalQuery);
 
-        // Try to look up a cached solution for the query.
-        // TODO: Can the cache have negative data about a solution?
-        PlanCache* localCache = PlanCache::get(canonicalQuery->ns());
-        if (NULL != localCache) {
-            CachedSolution* cs = localCache->get(*canonicalQuery);
-            if (NULL != cs) {
-                // We have a cached solution.  Hand the canonical query and cached solution off to
-                // the cached plan runner, which takes ownership of both.
-                WorkingSet* ws;
-                PlanStage* root;
-                verify(StageBuilder::build(*cs->solution, &root, &ws));
-                *out = new CachedPlanRunner(canonicalQuery.release(), cs, root, ws);
-                return Status::OK();
-            }
-        }
-
-        // No entry in cache for the query.  We have to solve the query ourself.
-
         // Get the indices that we could possibly use.
         Database* db = cc().database();
         verify( db );
@@ -231,6 +308,12 @@ namespace mongo {
             }
         }
 
+        // If an index filter is set for the shape of the query, only consider its indices.
+        QuerySettings* querySettings = collection->infoCache()->getQuerySettings();
+        if (querySettings->getAllowedIndices(*canonicalQuery, &plannerParams.allowedIndices)) {
+            QLOG() << "index filter for " << canonicalQuery->toString() << endl;
+        }
+
         vector<QuerySolution*> solutions;
         QueryPlanner::plan(*canonicalQuery, plannerParams, &solutions);
 
@@ -245,6 +328,64 @@ namespace mongo {
             return Status(ErrorCodes::BadValue, "No query solutions");
         }
 
+        // A count that some plan can answer by walking one range of index keys doesn't need a
+        // plan competition (or the plan cache): nothing else does less work.
+        if (plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT) {
+            for (size_t i = 0; i < solutions.size(); ++i) {
+                if (turnIxscanIntoCount(solutions[i])) {
+                    for (size_t j = 0; j < solutions.size(); ++j) {
+                        if (j != i) { delete solutions[j]; }
+                    }
+
+                    WorkingSet* ws;
+                    PlanStage* root;
+                    verify(StageBuilder::build(*solutions[i], &root, &ws));
+                    *out = new SingleSolutionRunner(canonicalQuery.release(), solutions[i], root,
+                                                    ws);
+                    return Status::OK();
+                }
+            }
+        }
+
+        // Try to look up a cached solution for the query.  The cache remembers the shape of the
+        // solution that won the plan competition for a query with the same shape as ours.  If
+        // the planner produced a solution with that shape, we run it without a competition.
+        // TODO: Can the cache have negative data about a solution?
+        if (1 < solutions.size()) {
+            PlanCache* planCache = collection->infoCache()->getPlanCache();
+            CachedSolution* rawCS = planCache->get(*canonicalQuery);
+            if (NULL != rawCS) {
+                auto_ptr<CachedSolution> cs(rawCS);
+                size_t cachedChild = solutions.size();
+                for (size_t i = 0; i < solutions.size(); ++i) {
+                    if (PlanCache::getSolutionShape(*solutions[i]) == cs->solutionShape) {
+                        cachedChild = i;
+                        break;
+                    }
+                }
+
+                if (cachedChild < solutions.size()) {
+                    for (size_t i = 0; i < solutions.size(); ++i) {
+                        if (i != cachedChild) { delete solutions[i]; }
+                    }
+
+                    // Hand the canonical query and cached solution off to the cached plan
+                    // runner, which takes ownership of both.
+                    WorkingSet* ws;
+                    PlanStage* root;
+                    verify(StageBuilder::build(*solutions[cachedChild], &root, &ws));
+                    *out = new CachedPlanRunner(canonicalQuery.release(), cs.release(),
+                                                solutions[cachedChild], root, ws);
+                    return Status::OK();
+                }
+
+                // The cached solution isn't a candidate anymore.  Drop it and re-rank.
+                QLOG() << "Cached solution not produced by planner, removing from cache:\n"
+                       << cs->solutionString << endl;
+                planCache->remove(*canonicalQuery, *cs);
+            }
+        }
+
         if (1 == solutions.size()) {
             // Only one possible plan.  Run it.  Build the stages from the solution.
             WorkingSet* ws;
@@ -270,6 +411,96 @@ namespace mongo {
         }
     }
 
+    Status getRunnerDistinct(CanonicalQuery* rawCanonicalQuery, const string& field, Runner** out,
+                             bool* isIndexKeysOut) {
+        verify(rawCanonicalQuery);
+        auto_ptr<CanonicalQuery> canonicalQuery(rawCanonicalQuery);
+        *isIndexKeysOut = false;
+
+        Database* db = cc().database();
+        verify(db);
+        Collection* collection = db->getCollection(canonicalQuery->ns());
+        if (NULL == collection) {
+            return getRunner(canonicalQuery.release(), out);
+        }
+
+        NamespaceDetails* nsd = collection->details();
+        QueryPlannerParams plannerParams;
+        for (int i = 0; i < nsd->getCompletedIndexCount(); ++i) {
+            IndexDescriptor* desc = collection->getIndexCatalog()->getDescriptor(i);
+            plannerParams.indices.push_back(IndexEntry(desc->keyPattern(), desc->isMultikey(),
+                                                       desc->isSparse(), desc->indexName()));
+        }
+
+        auto_ptr<QuerySolution> soln;
+
+        if (canonicalQuery->getQueryObj().isEmpty()) {
+            // The planner won't use an index without a predicate, so pick one ourselves: the
+            // smallest index that can provide the values.
+            const IndexEntry* best = NULL;
+            for (size_t i = 0; i < plannerParams.indices.size(); ++i) {
+                const IndexEntry& entry = plannerParams.indices[i];
+                if (entry.multikey || !isBtreeIndexStartingWith(entry.keyPattern, field)) {
+                    continue;
+                }
+                if (NULL == best || entry.keyPattern.nFields() < best->keyPattern.nFields()) {
+                    best = &entry;
+                }
+            }
+
+            if (NULL != best) {
+                DistinctNode* dn = new DistinctNode();
+                dn->indexKeyPattern = best->keyPattern;
+                dn->direction = 1;
+                dn->fieldNo = 0;
+                dn->bounds.isSimpleRange = false;
+                BSONObjIterator it(best->keyPattern);
+                while (it.more()) {
+                    BSONElement elt = it.next();
+                    OrderedIntervalList oil;
+                    IndexBoundsBuilder::allValuesForField(elt, &oil);
+                    // Align the interval with the direction the field is indexed in.
+                    if (elt.number() < 0) {
+                        oil.intervals[0].reverse();
+                    }
+                    dn->bounds.fields.push_back(oil);
+                }
+
+                soln.reset(new QuerySolution());
+                soln->ns = canonicalQuery->ns();
+                soln->root.reset(dn);
+            }
+        }
+        else {
+            // Only indexed plans could possibly be rewritten.
+            plannerParams.options = QueryPlannerParams::NO_TABLE_SCAN;
+
+            vector<QuerySolution*> solutions;
+            QueryPlanner::plan(*canonicalQuery, plannerParams, &solutions);
+
+            for (size_t i = 0; i < solutions.size(); ++i) {
+                if (NULL == soln.get() && turnIxscanIntoDistinct(solutions[i], field)) {
+                    soln.reset(solutions[i]);
+                }
+                else {
+                    delete solutions[i];
+                }
+            }
+        }
+
+        if (NULL == soln.get()) {
+            // No index can give us the values.  Look at every matching document.
+            return getRunner(canonicalQuery.release(), out);
+        }
+
+        WorkingSet* ws;
+        PlanStage* root;
+        verify(StageBuilder::build(*soln, &root, &ws));
+        *out = new SingleSolutionRunner(canonicalQuery.release(), soln.release(), root, ws);
+        *isIndexKeysOut = true;
+        return Status::OK();
+    }
+
     /**
      * Also called by db/ops/query.cpp.  This is the new getMore entry point.
      */
@@ -559,8 +790,7 @@ namespace mongo {
         // bb is used to hold query results
         // this buffer should contain either requested documents per query or
         // explain information, but not both
-        BufBuilder bb(32768);
-        bb.skip(sizeof(QueryResult));
+        ChunkedMessageBuilder bb(sizeof(QueryResult));
 
         // How many results have we obtained from the runner?
         int numResults = 0;
@@ -705,6 +935,24 @@ namespace mongo {
                 numResults = 1;
             }
         }
+        else if (Collection* collection = ctx.ctx().db()->getCollection(cq->ns())) {
+            // Add the query to its shape's statistics.  The runner's explain has what the plan
+            // examined.
+            long long keysExamined = 0;
+            long long docsExamined = 0;
+            TypeExplain* bareExplain;
+            if (runner->getExplainPlan(&bareExplain).isOK()) {
+                boost::scoped_ptr<TypeExplain> explain(bareExplain);
+                if (explain->isNScannedSet()) {
+                    keysExamined = explain->getNScanned();
+                }
+                if (explain->isNScannedObjectsSet()) {
+                    docsExamined = explain->getNScannedObjects();
+                }
+            }
+            collection->infoCache()->getQueryShapeStats()->record(
+                *cq, curop.elapsedMicros(), keysExamined, docsExamined, numResults);
+        }
 
         long long ccId = 0;
         if (saveClientCursor) {
@@ -745,9 +993,8 @@ namespace mongo {
             QLOG() << "not caching runner but returning " << numResults << " results\n";
         }
 
-        // Add the results from the query into the output buffer.
-        result.appendData(bb.buf(), bb.len());
-        bb.decouple();
+        // Hand the results to the output message without copying them again.
+        bb.appendTo(result);
 
         // Fill out the output buffer's header.
         QueryResult* qr = static_cast<QueryResult*>(result.header());
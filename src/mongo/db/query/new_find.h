@@ -50,6 +50,18 @@ namespace mongo {
      */
     Status getRunner(CanonicalQuery* rawCanonicalQuery, Runner** out, size_t plannerOptions = 0);
 
+    /**
+     * Get a runner for the distinct values of 'field' in the documents matching the query.  Takes
+     * ownership of rawCanonicalQuery.
+     *
+     * If a non-multikey btree index that starts with 'field' can answer the query by itself, the
+     * runner skip-scans it and *isIndexKeysOut is set to true: every result is then an index key
+     * (with empty field names) whose first element is a value of 'field', and the DiskLoc it
+     * indexes.  Otherwise the runner is the one getRunner() would give, returning documents.
+     */
+    Status getRunnerDistinct(CanonicalQuery* rawCanonicalQuery, const string& field, Runner** out,
+                             bool* isIndexKeysOut);
+
     /**
      * A switch to choose between old Cursor-based code and new Runner-based code.
      */
@@ -0,0 +1,392 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/plan_cache.h"
+
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/query/qlog.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+
+    using namespace mongo;
+
+    /**
+     * Two character code for each type of MatchExpression node.  Used in the cache key.
+     */
+    const char* encodeMatchType(MatchExpression::MatchType mt) {
+        switch (mt) {
+        case MatchExpression::AND: return "an";
+        case MatchExpression::OR: return "or";
+        case MatchExpression::NOR: return "nr";
+        case MatchExpression::NOT: return "nt";
+        case MatchExpression::ALL: return "al";
+        case MatchExpression::ELEM_MATCH_OBJECT: return "eo";
+        case MatchExpression::ELEM_MATCH_VALUE: return "ev";
+        case MatchExpression::SIZE: return "sz";
+        case MatchExpression::LTE: return "le";
+        case MatchExpression::LT: return "lt";
+        case MatchExpression::EQ: return "eq";
+        case MatchExpression::GT: return "gt";
+        case MatchExpression::GTE: return "ge";
+        case MatchExpression::REGEX: return "re";
+        case MatchExpression::MOD: return "mo";
+        case MatchExpression::EXISTS: return "ex";
+        case MatchExpression::MATCH_IN: return "in";
+        case MatchExpression::NIN: return "ni";
+        case MatchExpression::TYPE_OPERATOR: return "ty";
+        case MatchExpression::GEO: return "go";
+        case MatchExpression::WHERE: return "wh";
+        case MatchExpression::ATOMIC: return "at";
+        case MatchExpression::ALWAYS_FALSE: return "af";
+        case MatchExpression::GEO_NEAR: return "gn";
+        case MatchExpression::TEXT: return "te";
+        }
+        // All cases are handled above.
+        verify(0);
+        return "";
+    }
+
+    /**
+     * Appends the structure of the tree rooted at 'tree' to 'ss'.  Constants are left out.
+     */
+    void encodeKeyForMatch(const MatchExpression* tree, mongoutils::str::stream* ss) {
+        *ss << encodeMatchType(tree->matchType());
+        const StringData path = tree->path();
+        if (!path.empty()) {
+            *ss << path;
+        }
+
+        if (0 == tree->numChildren()) {
+            return;
+        }
+
+        *ss << '[';
+        for (size_t i = 0; i < tree->numChildren(); ++i) {
+            if (i > 0) {
+                *ss << ',';
+            }
+            encodeKeyForMatch(tree->getChild(i), ss);
+        }
+        *ss << ']';
+    }
+
+    /**
+     * Appends the index choices made in the tree rooted at 'node' to 'ss'.
+     *
+     * Skip and limit are left out as they carry constants and do not affect which indices we
+     * use.
+     */
+    void encodeSolutionShape(const QuerySolutionNode* node, mongoutils::str::stream* ss) {
+        const StageType type = node->getType();
+
+        if (STAGE_SKIP == type || STAGE_LIMIT == type) {
+            encodeSolutionShape(node->children[0], ss);
+            return;
+        }
+
+        *ss << static_cast<int>(type);
+
+        if (STAGE_IXSCAN == type) {
+            const IndexScanNode* ixn = static_cast<const IndexScanNode*>(node);
+            *ss << ixn->indexKeyPattern.toString() << ixn->direction;
+        }
+        else if (STAGE_COLLSCAN == type) {
+            const CollectionScanNode* csn = static_cast<const CollectionScanNode*>(node);
+            *ss << csn->direction;
+        }
+        else if (STAGE_SORT == type) {
+            const SortNode* sn = static_cast<const SortNode*>(node);
+            *ss << sn->pattern.toString();
+        }
+        else if (STAGE_GEO_2D == type) {
+            *ss << static_cast<const Geo2DNode*>(node)->indexKeyPattern.toString();
+        }
+        else if (STAGE_GEO_NEAR_2D == type) {
+            *ss << static_cast<const GeoNear2DNode*>(node)->indexKeyPattern.toString();
+        }
+        else if (STAGE_GEO_NEAR_2DSPHERE == type) {
+            *ss << static_cast<const GeoNear2DSphereNode*>(node)->indexKeyPattern.toString();
+        }
+        else if (STAGE_TEXT == type) {
+            *ss << static_cast<const TextNode*>(node)->_indexKeyPattern.toString();
+        }
+
+        if (NULL != node->filter) {
+            *ss << 'f';
+        }
+
+        if (0 == node->children.size()) {
+            return;
+        }
+
+        *ss << '[';
+        for (size_t i = 0; i < node->children.size(); ++i) {
+            if (i > 0) {
+                *ss << ',';
+            }
+            encodeSolutionShape(node->children[i], ss);
+        }
+        *ss << ']';
+    }
+
+}  // namespace
+
+namespace mongo {
+
+    // The maximum number of query shapes cached per collection.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(planCacheMaxEntriesPerCollection, int, 5000);
+
+    // How much worse than during the plan competition a cached plan may perform before it is
+    // evicted.  See PlanCache::hasPlanDegraded.
+    MONGO_EXPORT_SERVER_PARAMETER(planCacheEvictionRatio, int, 10);
+
+    //
+    // PlanCacheEntry
+    //
+
+    const size_t PlanCacheEntry::kMaxFeedback = 20;
+
+    PlanCacheEntry::PlanCacheEntry(const CanonicalQuery& query, const QuerySolution& soln,
+                                   PlanRankingDecision* why)
+        : query(query.getQueryObj().getOwned()),
+          sort(query.getParsed().getSort().getOwned()),
+          projection(query.getParsed().getProj().getOwned()),
+          solutionShape(PlanCache::getSolutionShape(soln)),
+          numHits(0),
+          decision(why) {
+        // QuerySolution::toString isn't const.
+        solutionString = const_cast<QuerySolution&>(soln).toString();
+    }
+
+    PlanCacheEntry::~PlanCacheEntry() {
+        for (size_t i = 0; i < feedback.size(); ++i) {
+            delete feedback[i];
+        }
+    }
+
+    CachedSolution* PlanCacheEntry::makeCachedSolution(const PlanCacheKey& key) const {
+        auto_ptr<CachedSolution> cs(new CachedSolution());
+        cs->key = key;
+        cs->query = query;
+        cs->sort = sort;
+        cs->projection = projection;
+        cs->solutionShape = solutionShape;
+        cs->solutionString = solutionString;
+        if (NULL != decision) {
+            cs->decision.reset(decision->cloneWithoutStats());
+        }
+        cs->numHits = numHits;
+        cs->numFeedback = feedback.size();
+        for (size_t i = 0; i < feedback.size(); ++i) {
+            cs->feedbackWorks += feedback[i]->stats->common.works;
+            cs->feedbackAdvanced += feedback[i]->stats->common.advanced;
+        }
+        return cs.release();
+    }
+
+    //
+    // PlanCache
+    //
+
+    PlanCache::PlanCache()
+        : _cacheMutex("PlanCache"),
+          _cache(static_cast<size_t>(std::max(1, planCacheMaxEntriesPerCollection))) { }
+
+    PlanCache::PlanCache(size_t maxSize)
+        : _cacheMutex("PlanCache"),
+          _cache(maxSize) { }
+
+    PlanCache::~PlanCache() { }
+
+    // static
+    bool PlanCache::shouldCacheQuery(const CanonicalQuery& query) {
+        const LiteParsedQuery& pq = query.getParsed();
+
+        // Explain must show every plan that was considered.
+        if (pq.isExplain()) { return false; }
+
+        // These restrict the plans that the planner outputs.
+        if (!pq.getHint().isEmpty() || pq.isSnapshot()) { return false; }
+        if (!pq.getMin().isEmpty() || !pq.getMax().isEmpty()) { return false; }
+
+        return true;
+    }
+
+    // static
+    PlanCacheKey PlanCache::getPlanCacheKey(const CanonicalQuery& query) {
+        mongoutils::str::stream ss;
+        encodeKeyForMatch(query.root(), &ss);
+        ss << "|s" << query.getParsed().getSort().toString();
+        ss << "|p" << query.getParsed().getProj().toString();
+        return ss;
+    }
+
+    // static
+    std::string PlanCache::getSolutionShape(const QuerySolution& soln) {
+        mongoutils::str::stream ss;
+        if (NULL != soln.root) {
+            encodeSolutionShape(soln.root.get(), &ss);
+        }
+        return ss;
+    }
+
+    bool PlanCache::add(const CanonicalQuery& query, const QuerySolution& solution,
+                        PlanRankingDecision* why) {
+        auto_ptr<PlanRankingDecision> autoWhy(why);
+        if (!shouldCacheQuery(query)) { return false; }
+
+        PlanCacheKey key = getPlanCacheKey(query);
+        PlanCacheEntry* entry = new PlanCacheEntry(query, solution, autoWhy.release());
+
+        scoped_lock lk(_cacheMutex);
+        if (_cache.add(key, entry)) {
+            QLOG() << "PlanCache: evicted least recently used entry to make room for "
+                   << key << endl;
+        }
+        return true;
+    }
+
+    CachedSolution* PlanCache::get(const CanonicalQuery& query) {
+        if (!shouldCacheQuery(query)) { return NULL; }
+
+        PlanCacheKey key = getPlanCacheKey(query);
+
+        scoped_lock lk(_cacheMutex);
+        PlanCacheEntry* entry;
+        if (!_cache.get(key, &entry).isOK()) {
+            return NULL;
+        }
+
+        ++entry->numHits;
+        return entry->makeCachedSolution(key);
+    }
+
+    // static
+    bool PlanCache::hasPlanDegraded(const PlanRankingDecision& why,
+                                    const PlanStageStats& stats) {
+        const double ratio = std::max(1, planCacheEvictionRatio);
+
+        // Don't judge a plan until it has had a fair chance: as much work as the winner did in
+        // the competition, times the ratio.
+        const double trialWorks = std::max(why.trialWorks, static_cast<uint64_t>(1));
+        const double works = stats.common.works;
+        if (works < trialWorks * ratio) {
+            return false;
+        }
+
+        // trialAdvanced / trialWorks > ratio * (advanced / works)
+        const double trialAdvanced = why.trialAdvanced;
+        const double advanced = stats.common.advanced;
+        return trialAdvanced * works > ratio * advanced * trialWorks;
+    }
+
+    bool PlanCache::feedback(const CanonicalQuery& query, const CachedSolution& solution,
+                             CachedSolutionFeedback* feedback) {
+        auto_ptr<CachedSolutionFeedback> autoFeedback(feedback);
+        verify(NULL != feedback->stats);
+
+        scoped_lock lk(_cacheMutex);
+        PlanCacheEntry* entry;
+        if (!_cache.get(solution.key, &entry).isOK()) {
+            return false;
+        }
+
+        // The entry may have been replaced since 'solution' was handed out.
+        if (entry->solutionShape != solution.solutionShape) {
+            return false;
+        }
+
+        if (NULL != entry->decision && hasPlanDegraded(*entry->decision, *feedback->stats)) {
+            QLOG() << "PlanCache: cached plan degraded (" << feedback->stats->common.advanced
+                   << " results in " << feedback->stats->common.works << " works), evicting "
+                   << solution.key << endl;
+            _cache.remove(solution.key);
+            return true;
+        }
+
+        if (entry->feedback.size() >= PlanCacheEntry::kMaxFeedback) {
+            delete entry->feedback.front();
+            entry->feedback.erase(entry->feedback.begin());
+        }
+        entry->feedback.push_back(autoFeedback.release());
+        return true;
+    }
+
+    bool PlanCache::remove(const CanonicalQuery& query, const CachedSolution& solution) {
+        scoped_lock lk(_cacheMutex);
+        PlanCacheEntry* entry;
+        if (!_cache.get(solution.key, &entry).isOK()) {
+            return false;
+        }
+
+        // Don't remove a newer entry that somebody else added for this shape.
+        if (entry->solutionShape != solution.solutionShape) {
+            return false;
+        }
+
+        return _cache.remove(solution.key).isOK();
+    }
+
+    bool PlanCache::remove(const CanonicalQuery& query) {
+        PlanCacheKey key = getPlanCacheKey(query);
+        scoped_lock lk(_cacheMutex);
+        return _cache.remove(key).isOK();
+    }
+
+    CachedSolution* PlanCache::peek(const CanonicalQuery& query) const {
+        PlanCacheKey key = getPlanCacheKey(query);
+        scoped_lock lk(_cacheMutex);
+        PlanCacheEntry* entry;
+        if (!_cache.peek(key, &entry).isOK()) {
+            return NULL;
+        }
+        return entry->makeCachedSolution(key);
+    }
+
+    void PlanCache::getAll(std::vector<CachedSolution*>* solutionsOut) const {
+        scoped_lock lk(_cacheMutex);
+        typedef LRUKeyValue<PlanCacheKey, PlanCacheEntry>::KVListConstIt EntryIt;
+        for (EntryIt it = _cache.begin(); it != _cache.end(); ++it) {
+            solutionsOut->push_back(it->second->makeCachedSolution(it->first));
+        }
+    }
+
+    void PlanCache::clear() {
+        scoped_lock lk(_cacheMutex);
+        _cache.clear();
+    }
+
+    size_t PlanCache::size() const {
+        scoped_lock lk(_cacheMutex);
+        return _cache.size();
+    }
+
+}  // namespace mongo
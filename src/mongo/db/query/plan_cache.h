@@ -28,106 +28,245 @@
 
 #pragma once
 
+#include <boost/scoped_ptr.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
 #include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/lru_key_value.h"
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
     /**
-     * TODO: Debug commands:
-     * 1. show canonical form of query
-     * 2. show plans generated for query without (and with) cache
-     * 3. print out cache.
-     * 4. clear all elements from cache / otherwise manipulate cache.
+     * The shape of a query: the structure of its predicate tree, its sort and its projection,
+     * with all predicate constants removed.  Queries with the same shape share a cache entry.
      */
+    typedef std::string PlanCacheKey;
 
     /**
      * When the CachedPlanRunner runs a cached query, it can provide feedback to the cache.  This
      * feedback is available to anyone who retrieves that query in the future.
      */
     struct CachedSolutionFeedback {
+        CachedSolutionFeedback() : stats(NULL) { }
+        ~CachedSolutionFeedback() { delete stats; }
+
+        // Owned here.
         PlanStageStats* stats;
     };
 
     /**
-     * A cached solution to a query.
+     * A cached solution to a query.  This is a snapshot of a PlanCacheEntry handed out to
+     * callers of PlanCache::get.
+     *
+     * Index bounds depend on the constants of a query, so a QuerySolution cannot be run for
+     * another query of the same shape.  Instead we cache the shape of the winning solution (see
+     * PlanCache::getSolutionShape).  The caller re-runs the planner, which is cheap compared to
+     * the plan competition, and runs the solution with the same shape as the cached one.
      */
     struct CachedSolution {
-        ~CachedSolution() {
-            for (size_t i = 0; i < feedback.size(); ++i) {
-                delete feedback[i];
-            }
-        }
+        CachedSolution() : numHits(0), numFeedback(0), feedbackWorks(0), feedbackAdvanced(0) { }
+
+        // Key used to look up the cache entry.
+        PlanCacheKey key;
+
+        // The query, sort and projection of the query that created the entry.  Used by the
+        // plan cache commands to show the shape.
+        BSONObj query;
+        BSONObj sort;
+        BSONObj projection;
 
-        // The best solution for the CanonicalQuery.
-        scoped_ptr<QuerySolution> solution;
+        // Identifies the winning solution among the outputs of the planner.
+        std::string solutionShape;
 
-        // Why the best solution was picked.
+        // Human readable form of the winning solution, at the time it was cached.
+        std::string solutionString;
+
+        // Why the best solution was picked.  Does not include the stats of the winner.
         scoped_ptr<PlanRankingDecision> decision;
 
-        // Annotations from cached runs.
-        // TODO: How many of these do we really want to keep?
-        vector<CachedSolutionFeedback*> feedback;
+        // How many times the entry was handed out by PlanCache::get.
+        size_t numHits;
+
+        // Summary of the feedback currently held by the entry: the number of runs reported and
+        // the total work done and results produced by those runs.
+        size_t numFeedback;
+        uint64_t feedbackWorks;
+        uint64_t feedbackAdvanced;
+
     private:
         MONGO_DISALLOW_COPYING(CachedSolution);
     };
 
+    /**
+     * Used internally by the cache to track a cached solution and its performance.
+     */
+    class PlanCacheEntry {
+    private:
+        MONGO_DISALLOW_COPYING(PlanCacheEntry);
+    public:
+        /**
+         * Takes ownership of 'why'.
+         */
+        PlanCacheEntry(const CanonicalQuery& query, const QuerySolution& soln,
+                       PlanRankingDecision* why);
+
+        ~PlanCacheEntry();
+
+        /**
+         * Returns a snapshot of this entry, stored under 'key'.  Caller owns the result.
+         */
+        CachedSolution* makeCachedSolution(const PlanCacheKey& key) const;
+
+        // See CachedSolution.  The BSON objects are owned copies.
+        BSONObj query;
+        BSONObj sort;
+        BSONObj projection;
+        std::string solutionShape;
+        std::string solutionString;
+        size_t numHits;
+
+        // Why the best solution was picked.  Owned here.
+        scoped_ptr<PlanRankingDecision> decision;
+
+        // Annotations from cached runs, oldest first.  Owned here.  At most
+        // kMaxFeedback are kept.
+        std::vector<CachedSolutionFeedback*> feedback;
+
+        static const size_t kMaxFeedback;
+    };
+
     /**
      * Caches the best solution to a query.  Aside from the (CanonicalQuery -> QuerySolution)
      * mapping, the cache contains information on why that mapping was made, and statistics on the
      * cache entry's actual performance on subsequent runs.
+     *
+     * There is one cache per collection, owned by its CollectionInfoCache.  The cache is bounded;
+     * once it is full, the least recently used entry is evicted.  The whole cache is cleared when
+     * an index is built or dropped, and goes away with the collection.
+     *
+     * Thread safe: many readers may use the cache of a collection under a read lock.
      */
     class PlanCache {
+    private:
+        MONGO_DISALLOW_COPYING(PlanCache);
     public:
+        PlanCache();
+
+        /**
+         * Create a cache holding at most 'maxSize' entries.
+         */
+        PlanCache(size_t maxSize);
+
+        ~PlanCache();
+
+        /**
+         * Returns true if the winning plan of 'query' may be cached.  Queries that restrict
+         * the plans we consider (hint, snapshot, min/max) or that must show all of their
+         * plans (explain) are not cached.
+         */
+        static bool shouldCacheQuery(const CanonicalQuery& query);
+
         /**
-         * Get the (global) cache for the provided namespace.  Must not be held across yields.
-         * As such, there is no locking required.
+         * Returns the shape of 'query'.  See PlanCacheKey.
          */
-        static PlanCache* get(const string& ns) { return NULL; }
+        static PlanCacheKey getPlanCacheKey(const CanonicalQuery& query);
+
+        /**
+         * Returns a string identifying the index choices of 'soln', independent of the
+         * constants in its index bounds.  Two solutions to queries of the same shape that use
+         * the same indices in the same way have the same solution shape.
+         */
+        static std::string getSolutionShape(const QuerySolution& soln);
 
         /**
          * Record 'solution' as the best plan for 'query' which was picked for reasons detailed in
-         * 'why'.
+         * 'why'.  Replaces any existing entry for the shape of 'query'.
          *
-         * Takes ownership of all arguments.
+         * Takes ownership of 'why'.
          *
          * If the mapping was added successfully, returns true.
-         * If the mapping already existed or some other error occurred, returns false;
+         * If the query should not be cached, deletes 'why' and returns false.
          */
-        bool add(CanonicalQuery* query, QuerySolution* solution, PlanRankingDecision* why) {
-            return false;
-        }
+        bool add(const CanonicalQuery& query, const QuerySolution& solution,
+                 PlanRankingDecision* why);
 
         /**
          * Look up the cached solution for the provided query.  If a cached solution exists, return
          * a copy of it which the caller then owns.  If no cached solution exists, returns NULL.
+         */
+        CachedSolution* get(const CanonicalQuery& query);
+
+        /**
+         * Returns true if 'stats', collected while running a cached solution which won the plan
+         * competition for reasons 'why', show that the solution performs much worse than it did
+         * during the competition.
          *
-         * TODO: Allow querying for exact query and querying for the shape of the query.
+         * The winner produced results at some rate during the competition.  Once a run has done
+         * planCacheEvictionRatio times as much work as the winner did in its trial, the solution
+         * has degraded if it produces results at less than 1/planCacheEvictionRatio of that rate.
+         * This happens when the data distribution changes, eg. after a bulk load.
          */
-        CachedSolution* get(const CanonicalQuery& query) {
-            return NULL;
-        }
+        static bool hasPlanDegraded(const PlanRankingDecision& why, const PlanStageStats& stats);
 
         /**
          * When the CachedPlanRunner runs a plan out of the cache, we want to record data about the
          * plan's performance.  Cache takes ownership of 'feedback'.
          *
+         * If the feedback shows that the plan has degraded (see hasPlanDegraded), the entry is
+         * evicted and the next query of this shape picks a plan anew.
+         *
          * If the (query, solution) pair isn't in the cache, the cache deletes feedback and returns
          * false.  Otherwise, returns true.
          */
-        bool feedback(const CanonicalQuery& query, const QuerySolution& solution,
-                      const CachedSolutionFeedback* feedback) {
-            return false;
-        }
+        bool feedback(const CanonicalQuery& query, const CachedSolution& solution,
+                      CachedSolutionFeedback* feedback);
 
         /**
          * Remove the (query, solution) pair from our cache.  Returns true if the plan was removed,
          * false if it wasn't found.
          */
-        bool remove(const CanonicalQuery& query, const QuerySolution& solution) {
-            return false;
-        }
+        bool remove(const CanonicalQuery& query, const CachedSolution& solution);
+
+        /**
+         * Remove the entry for the shape of 'query', whatever its solution.  Returns true if an
+         * entry was removed.
+         */
+        bool remove(const CanonicalQuery& query);
+
+        /**
+         * Look up the cached solution for the shape of 'query' without counting a hit.  Used to
+         * inspect the cache.  Caller owns the result.  Returns NULL if there is no entry.
+         */
+        CachedSolution* peek(const CanonicalQuery& query) const;
+
+        /**
+         * Appends a snapshot of every entry, most recently used first, to 'solutionsOut'.
+         * Hits are not counted.  Caller owns the snapshots.
+         */
+        void getAll(std::vector<CachedSolution*>* solutionsOut) const;
+
+        /**
+         * Remove all entries from the cache.
+         */
+        void clear();
+
+        /**
+         * Returns the number of entries in the cache.
+         */
+        size_t size() const;
+
+    private:
+        // Guards _cache.  Readers of a collection share the cache.
+        mutable mongo::mutex _cacheMutex;
+
+        LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
     };
 
 }  // namespace mongo
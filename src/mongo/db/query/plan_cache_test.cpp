@@ -0,0 +1,341 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/plan_cache.h
+ */
+
+#include "mongo/db/query/plan_cache.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    static const char* ns = "somebogusns";
+
+    /**
+     * Utility functions to create a CanonicalQuery
+     */
+    CanonicalQuery* canonicalize(const BSONObj& queryObj) {
+        CanonicalQuery* cq;
+        Status result = CanonicalQuery::canonicalize(ns, queryObj, &cq);
+        ASSERT_OK(result);
+        return cq;
+    }
+
+    CanonicalQuery* canonicalize(const char* queryStr, const char* sortStr, const char* projStr) {
+        BSONObj queryObj = fromjson(queryStr);
+        BSONObj sortObj = fromjson(sortStr);
+        BSONObj projObj = fromjson(projStr);
+        CanonicalQuery* cq;
+        Status result = CanonicalQuery::canonicalize(ns, queryObj, sortObj, projObj, &cq);
+        ASSERT_OK(result);
+        return cq;
+    }
+
+    /**
+     * Plans 'cq' over indices {a: 1} and {b: 1}.  Caller owns the solutions.
+     */
+    void planOverAB(const CanonicalQuery& cq, vector<QuerySolution*>* solns) {
+        QueryPlannerParams params;
+        params.options = QueryPlannerParams::INCLUDE_COLLSCAN;
+        params.indices.push_back(IndexEntry(BSON("a" << 1), false, false, "a_1"));
+        params.indices.push_back(IndexEntry(BSON("b" << 1), false, false, "b_1"));
+        QueryPlanner::plan(cq, params, solns);
+    }
+
+    /**
+     * Feedback from a run of a cached plan that did 'works' works and produced 'advanced'
+     * results.  Caller owns the feedback.
+     */
+    CachedSolutionFeedback* makeFeedback(uint64_t works, uint64_t advanced) {
+        CommonStats common;
+        common.works = works;
+        common.advanced = advanced;
+        CachedSolutionFeedback* feedback = new CachedSolutionFeedback();
+        feedback->stats = new PlanStageStats(common, STAGE_COLLSCAN);
+        return feedback;
+    }
+
+    /**
+     * A decision for a winner that did 'works' works and produced 'advanced' results.
+     */
+    PlanRankingDecision* makeDecision(uint64_t works, uint64_t advanced) {
+        PlanRankingDecision* why = new PlanRankingDecision();
+        why->trialWorks = works;
+        why->trialAdvanced = advanced;
+        return why;
+    }
+
+    void deleteSolutions(vector<QuerySolution*>* solns) {
+        for (size_t i = 0; i < solns->size(); ++i) {
+            delete (*solns)[i];
+        }
+        solns->clear();
+    }
+
+    //
+    // Cache key
+    //
+
+    TEST(PlanCacheTest, KeyIgnoresConstants) {
+        auto_ptr<CanonicalQuery> cq1(canonicalize(fromjson("{a: 1, b: {$gt: 5}}")));
+        auto_ptr<CanonicalQuery> cq2(canonicalize(fromjson("{a: 'foo', b: {$gt: 99}}")));
+        ASSERT_EQUALS(PlanCache::getPlanCacheKey(*cq1), PlanCache::getPlanCacheKey(*cq2));
+    }
+
+    TEST(PlanCacheTest, KeyDependsOnStructure) {
+        auto_ptr<CanonicalQuery> cq1(canonicalize(fromjson("{a: 1, b: {$gt: 5}}")));
+        auto_ptr<CanonicalQuery> cq2(canonicalize(fromjson("{a: 1, b: {$lt: 5}}")));
+        auto_ptr<CanonicalQuery> cq3(canonicalize(fromjson("{a: 1, c: {$gt: 5}}")));
+        auto_ptr<CanonicalQuery> cq4(canonicalize(fromjson("{$or: [{a: 1}, {b: {$gt: 5}}]}")));
+        ASSERT_NOT_EQUALS(PlanCache::getPlanCacheKey(*cq1), PlanCache::getPlanCacheKey(*cq2));
+        ASSERT_NOT_EQUALS(PlanCache::getPlanCacheKey(*cq1), PlanCache::getPlanCacheKey(*cq3));
+        ASSERT_NOT_EQUALS(PlanCache::getPlanCacheKey(*cq1), PlanCache::getPlanCacheKey(*cq4));
+    }
+
+    TEST(PlanCacheTest, KeyDependsOnSortAndProjection) {
+        auto_ptr<CanonicalQuery> cq1(canonicalize("{a: 1}", "{}", "{}"));
+        auto_ptr<CanonicalQuery> cq2(canonicalize("{a: 1}", "{b: 1}", "{}"));
+        auto_ptr<CanonicalQuery> cq3(canonicalize("{a: 1}", "{b: -1}", "{}"));
+        auto_ptr<CanonicalQuery> cq4(canonicalize("{a: 1}", "{}", "{a: 1}"));
+        ASSERT_NOT_EQUALS(PlanCache::getPlanCacheKey(*cq1), PlanCache::getPlanCacheKey(*cq2));
+        ASSERT_NOT_EQUALS(PlanCache::getPlanCacheKey(*cq2), PlanCache::getPlanCacheKey(*cq3));
+        ASSERT_NOT_EQUALS(PlanCache::getPlanCacheKey(*cq1), PlanCache::getPlanCacheKey(*cq4));
+    }
+
+    //
+    // Solution shape
+    //
+
+    TEST(PlanCacheTest, SolutionShapeIgnoresBounds) {
+        auto_ptr<CanonicalQuery> cq1(canonicalize(fromjson("{a: 1, b: 2}")));
+        auto_ptr<CanonicalQuery> cq2(canonicalize(fromjson("{a: 7, b: 8}")));
+        vector<QuerySolution*> solns1;
+        vector<QuerySolution*> solns2;
+        planOverAB(*cq1, &solns1);
+        planOverAB(*cq2, &solns2);
+
+        // An ixscan on a, an ixscan on b, and a collscan.
+        ASSERT_GREATER_THAN(solns1.size(), 1U);
+        ASSERT_EQUALS(solns1.size(), solns2.size());
+        for (size_t i = 0; i < solns1.size(); ++i) {
+            ASSERT_EQUALS(PlanCache::getSolutionShape(*solns1[i]),
+                          PlanCache::getSolutionShape(*solns2[i]));
+            for (size_t j = i + 1; j < solns1.size(); ++j) {
+                ASSERT_NOT_EQUALS(PlanCache::getSolutionShape(*solns1[i]),
+                                  PlanCache::getSolutionShape(*solns1[j]));
+            }
+        }
+
+        deleteSolutions(&solns1);
+        deleteSolutions(&solns2);
+    }
+
+    //
+    // Cache operations
+    //
+
+    TEST(PlanCacheTest, AddGetRemove) {
+        PlanCache planCache;
+        auto_ptr<CanonicalQuery> cq1(canonicalize(fromjson("{a: 1, b: 2}")));
+        auto_ptr<CanonicalQuery> cq2(canonicalize(fromjson("{a: 3, b: 4}")));
+        vector<QuerySolution*> solns;
+        planOverAB(*cq1, &solns);
+        ASSERT_GREATER_THAN(solns.size(), 1U);
+
+        ASSERT(NULL == planCache.get(*cq2));
+        ASSERT_TRUE(planCache.add(*cq1, *solns[1], new PlanRankingDecision()));
+        ASSERT_EQUALS(planCache.size(), 1U);
+
+        // A query of the same shape finds the entry.
+        auto_ptr<CachedSolution> cs(planCache.get(*cq2));
+        ASSERT(NULL != cs.get());
+        ASSERT_EQUALS(cs->solutionShape, PlanCache::getSolutionShape(*solns[1]));
+        ASSERT(NULL != cs->decision.get());
+
+        // Feedback sticks to the entry.
+        ASSERT_TRUE(planCache.feedback(*cq2, *cs, makeFeedback(10, 5)));
+
+        ASSERT_TRUE(planCache.remove(*cq2, *cs));
+        ASSERT_FALSE(planCache.remove(*cq2, *cs));
+        ASSERT(NULL == planCache.get(*cq1));
+        ASSERT_FALSE(planCache.feedback(*cq2, *cs, makeFeedback(10, 5)));
+
+        deleteSolutions(&solns);
+    }
+
+    TEST(PlanCacheTest, InspectEntries) {
+        PlanCache planCache;
+        auto_ptr<CanonicalQuery> cq1(canonicalize(fromjson("{a: 1, b: 2}")));
+        auto_ptr<CanonicalQuery> cq2(canonicalize(fromjson("{a: 3, b: 4}")));
+        vector<QuerySolution*> solns;
+        planOverAB(*cq1, &solns);
+        ASSERT_GREATER_THAN(solns.size(), 1U);
+
+        ASSERT(NULL == planCache.peek(*cq1));
+        ASSERT_TRUE(planCache.add(*cq1, *solns[0], new PlanRankingDecision()));
+
+        // Only get counts as a hit.
+        delete planCache.get(*cq2);
+        delete planCache.get(*cq2);
+        auto_ptr<CachedSolution> cs(planCache.peek(*cq2));
+        ASSERT(NULL != cs.get());
+        ASSERT_EQUALS(cs->numHits, 2U);
+
+        // The entry remembers the query that created it.
+        ASSERT_EQUALS(cs->query, fromjson("{a: 1, b: 2}"));
+
+        ASSERT_TRUE(planCache.feedback(*cq2, *cs, makeFeedback(10, 5)));
+        ASSERT_TRUE(planCache.feedback(*cq2, *cs, makeFeedback(20, 5)));
+        cs.reset(planCache.peek(*cq2));
+        ASSERT_EQUALS(cs->numFeedback, 2U);
+        ASSERT_EQUALS(cs->feedbackWorks, 30U);
+        ASSERT_EQUALS(cs->feedbackAdvanced, 10U);
+
+        vector<CachedSolution*> all;
+        planCache.getAll(&all);
+        ASSERT_EQUALS(all.size(), 1U);
+        ASSERT_EQUALS(all[0]->key, PlanCache::getPlanCacheKey(*cq1));
+        delete all[0];
+
+        // Removing by shape doesn't need the solution.
+        ASSERT_TRUE(planCache.remove(*cq2));
+        ASSERT_FALSE(planCache.remove(*cq2));
+        ASSERT_EQUALS(planCache.size(), 0U);
+
+        deleteSolutions(&solns);
+    }
+
+    TEST(PlanCacheTest, RemoveOnlyMatchingSolution) {
+        PlanCache planCache;
+        auto_ptr<CanonicalQuery> cq(canonicalize(fromjson("{a: 1, b: 2}")));
+        vector<QuerySolution*> solns;
+        planOverAB(*cq, &solns);
+        ASSERT_GREATER_THAN(solns.size(), 1U);
+
+        ASSERT_TRUE(planCache.add(*cq, *solns[0], new PlanRankingDecision()));
+        auto_ptr<CachedSolution> stale(planCache.get(*cq));
+        ASSERT(NULL != stale.get());
+
+        // Somebody else replaces the entry.  The stale copy can no longer remove it.
+        ASSERT_TRUE(planCache.add(*cq, *solns[1], new PlanRankingDecision()));
+        ASSERT_FALSE(planCache.remove(*cq, *stale));
+        ASSERT_EQUALS(planCache.size(), 1U);
+
+        planCache.clear();
+        ASSERT_EQUALS(planCache.size(), 0U);
+
+        deleteSolutions(&solns);
+    }
+
+    TEST(PlanCacheTest, BoundedSize) {
+        PlanCache planCache(1);
+        auto_ptr<CanonicalQuery> cq1(canonicalize(fromjson("{a: 1, b: 2}")));
+        auto_ptr<CanonicalQuery> cq2(canonicalize(fromjson("{a: 1, b: {$gt: 2}}")));
+        vector<QuerySolution*> solns;
+        planOverAB(*cq1, &solns);
+        ASSERT_GREATER_THAN(solns.size(), 0U);
+
+        ASSERT_TRUE(planCache.add(*cq1, *solns[0], new PlanRankingDecision()));
+        ASSERT_TRUE(planCache.add(*cq2, *solns[0], new PlanRankingDecision()));
+        ASSERT_EQUALS(planCache.size(), 1U);
+        ASSERT(NULL == planCache.get(*cq1));
+
+        auto_ptr<CachedSolution> cs(planCache.get(*cq2));
+        ASSERT(NULL != cs.get());
+
+        deleteSolutions(&solns);
+    }
+
+    //
+    // Feedback and eviction
+    //
+
+    TEST(PlanCacheTest, DegradedPlan) {
+        // The winner produced 100 results in 101 works.
+        auto_ptr<PlanRankingDecision> why(makeDecision(101, 100));
+
+        // Too little work done to judge.
+        auto_ptr<CachedSolutionFeedback> fb(makeFeedback(200, 0));
+        ASSERT_FALSE(PlanCache::hasPlanDegraded(*why, *fb->stats));
+
+        // Just as productive as in the competition.
+        fb.reset(makeFeedback(100000, 99000));
+        ASSERT_FALSE(PlanCache::hasPlanDegraded(*why, *fb->stats));
+
+        // A bit less productive, which is expected for other constants.
+        fb.reset(makeFeedback(100000, 20000));
+        ASSERT_FALSE(PlanCache::hasPlanDegraded(*why, *fb->stats));
+
+        // Hardly produces anything anymore.
+        fb.reset(makeFeedback(100000, 10));
+        ASSERT_TRUE(PlanCache::hasPlanDegraded(*why, *fb->stats));
+        fb.reset(makeFeedback(100000, 0));
+        ASSERT_TRUE(PlanCache::hasPlanDegraded(*why, *fb->stats));
+    }
+
+    TEST(PlanCacheTest, UnproductiveWinnerNeverDegrades) {
+        // The winner hit EOF without producing anything.
+        auto_ptr<PlanRankingDecision> why(makeDecision(5, 0));
+        auto_ptr<CachedSolutionFeedback> fb(makeFeedback(100000, 0));
+        ASSERT_FALSE(PlanCache::hasPlanDegraded(*why, *fb->stats));
+    }
+
+    TEST(PlanCacheTest, FeedbackEvictsDegradedPlan) {
+        PlanCache planCache;
+        auto_ptr<CanonicalQuery> cq(canonicalize(fromjson("{a: 1, b: 2}")));
+        vector<QuerySolution*> solns;
+        planOverAB(*cq, &solns);
+        ASSERT_GREATER_THAN(solns.size(), 0U);
+
+        ASSERT_TRUE(planCache.add(*cq, *solns[0], makeDecision(101, 100)));
+        auto_ptr<CachedSolution> cs(planCache.get(*cq));
+        ASSERT(NULL != cs.get());
+
+        // Good runs keep the entry, even more of them than we keep feedback for.
+        for (size_t i = 0; i < 2 * PlanCacheEntry::kMaxFeedback; ++i) {
+            ASSERT_TRUE(planCache.feedback(*cq, *cs, makeFeedback(1000, 900)));
+        }
+        ASSERT_EQUALS(planCache.size(), 1U);
+
+        // A bad run evicts it.
+        ASSERT_TRUE(planCache.feedback(*cq, *cs, makeFeedback(1000000, 1)));
+        ASSERT_EQUALS(planCache.size(), 0U);
+        ASSERT(NULL == planCache.get(*cq));
+
+        deleteSolutions(&solns);
+    }
+
+}  // namespace
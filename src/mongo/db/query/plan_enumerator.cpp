@@ -16,14 +16,23 @@
 
 #include "mongo/db/query/plan_enumerator.h"
 
+#include <algorithm>
 #include <set>
 
 #include "mongo/db/query/indexability.h"
 #include "mongo/db/query/index_tag.h"
 #include "mongo/db/query/qlog.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
+    // If true, the enumerator outputs plans that intersect two indices for a conjunction over
+    // separately indexed fields.  The plans compete with the single index plans.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableIndexIntersection, bool, true);
+
+    // The most intersection plans we output for one AND.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxIntersectPerAnd, int, 3);
+
     PlanEnumerator::PlanEnumerator(MatchExpression* root, const vector<IndexEntry>* indices)
         : _root(root), _indices(indices) { }
 
@@ -41,7 +50,7 @@ namespace mongo {
         QLOG() << "enumerator received root:\n" << _root->toString() << endl;
 
         // Fill out our memo structure from the tagged _root.
-        _done = !prepMemo(_root);
+        _done = !prepMemo(_root, false);
 
         // Dump the tags.  We replace them with IndexTag instances.
         _root->resetTag();
@@ -82,6 +91,9 @@ namespace mongo {
             else if (AndAssignment::PRED_CHOICES == newAnd->state) {
                 ss << "pred_choices";
             }
+            else if (AndAssignment::INTERSECTIONS == newAnd->state) {
+                ss << "intersections";
+            }
             else {
                 verify(AndAssignment::SUBNODES == newAnd->state);
                 ss << "subnodes";
@@ -102,6 +114,13 @@ namespace mongo {
                     ss << "\t" << oie.preds[j]->toString();
                 }
             }
+            for (size_t i = 0; i < newAnd->intersectChoices.size(); ++i) {
+                ss << "intersect pred choices:";
+                for (size_t j = 0; j < newAnd->intersectChoices[i].size(); ++j) {
+                    ss << " " << newAnd->intersectChoices[i][j];
+                }
+                ss << "\n";
+            }
             return ss.str();
         }
         else {
@@ -147,7 +166,7 @@ namespace mongo {
         *id = newID;
     }
 
-    bool PlanEnumerator::prepMemo(MatchExpression* node) {
+    bool PlanEnumerator::prepMemo(MatchExpression* node, bool inArrayOperator) {
         if (Indexability::nodeCanUseIndexOnOwnField(node)) {
             // We only get here if our parent is an OR, an array operator, or we're the root.
 
@@ -174,7 +193,7 @@ namespace mongo {
         else if (MatchExpression::OR == node->matchType()) {
             // For an OR to be indexed, all its children must be indexed.
             for (size_t i = 0; i < node->numChildren(); ++i) {
-                if (!prepMemo(node->getChild(i))) {
+                if (!prepMemo(node->getChild(i), inArrayOperator)) {
                     return false;
                 }
             }
@@ -211,7 +230,9 @@ namespace mongo {
                     }
                 }
                 else {
-                    if (prepMemo(child)) {
+                    bool childInArrayOperator = inArrayOperator
+                                                || Indexability::arrayUsesIndexOnChildren(node);
+                    if (prepMemo(child, childInArrayOperator)) {
                         verify(_nodeToId.end() != _nodeToId.find(child));
                         size_t childID = _nodeToId[child];
                         subnodes.push_back(childID);
@@ -323,6 +344,14 @@ namespace mongo {
                 }
             }
 
+            // If any index is mandatory we only ever assign the mandatory indices.  We don't
+            // intersect indices under an array operator, where the FETCH above us re-checks the
+            // whole operator anyway.
+            if (MatchExpression::AND == node->matchType() && !inArrayOperator
+                && newAndAssignment->mandatory.empty()) {
+                prepIntersections(newAndAssignment);
+            }
+
             newAndAssignment->resetEnumeration();
 
             size_t myMemoID;
@@ -337,6 +366,38 @@ namespace mongo {
         return false;
     }
 
+    void PlanEnumerator::prepIntersections(AndAssignment* aa) {
+        if (!internalQueryPlannerEnableIndexIntersection) { return; }
+
+        const size_t maxIntersections =
+            static_cast<size_t>(std::max(0, internalQueryEnumerationMaxIntersectPerAnd));
+
+        for (size_t i = 0; i < aa->predChoices.size(); ++i) {
+            for (size_t j = i + 1; j < aa->predChoices.size(); ++j) {
+                if (aa->intersectChoices.size() >= maxIntersections) { return; }
+
+                const OneIndexAssignment& left = aa->predChoices[i];
+                const OneIndexAssignment& right = aa->predChoices[j];
+
+                // A predicate can only be tagged with one index.  Two indices with the same
+                // leading field both want the same predicates, so we can't intersect them.
+                bool disjoint = true;
+                for (size_t k = 0; disjoint && k < left.preds.size(); ++k) {
+                    if (right.preds.end() != std::find(right.preds.begin(), right.preds.end(),
+                                                       left.preds[k])) {
+                        disjoint = false;
+                    }
+                }
+                if (!disjoint) { continue; }
+
+                vector<size_t> choice;
+                choice.push_back(i);
+                choice.push_back(j);
+                aa->intersectChoices.push_back(choice);
+            }
+        }
+    }
+
     void PlanEnumerator::tagMemo(size_t id) {
         QLOG() << "Tagging memoID " << id << endl;
         NodeAssignment* assign = _memo[id];
@@ -375,6 +436,18 @@ namespace mongo {
                     pred->setTag(new IndexTag(assign.index, assign.positions[i]));
                 }
             }
+            else if (AndAssignment::INTERSECTIONS == aa->state) {
+                verify(aa->counter < aa->intersectChoices.size());
+                const vector<size_t>& choice = aa->intersectChoices[aa->counter];
+                for (size_t i = 0; i < choice.size(); ++i) {
+                    const OneIndexAssignment& assign = aa->predChoices[choice[i]];
+                    for (size_t j = 0; j < assign.preds.size(); ++j) {
+                        MatchExpression* pred = assign.preds[j];
+                        verify(NULL == pred->getTag());
+                        pred->setTag(new IndexTag(assign.index, assign.positions[j]));
+                    }
+                }
+            }
             else {
                 verify(AndAssignment::SUBNODES == aa->state);
                 verify(aa->counter < aa->subnodes.size());
@@ -441,7 +514,27 @@ namespace mongo {
                     return false;
                 }
 
-                // We (may) move to outputting PRED_CHOICES.
+                // Next output is the first intersection, if we have any.
+                if (aa->intersectChoices.size() > 0) {
+                    aa->counter = 0;
+                    aa->state = AndAssignment::INTERSECTIONS;
+                    return false;
+                }
+            }
+
+            if (AndAssignment::INTERSECTIONS == aa->state) {
+                verify(aa->intersectChoices.size() > 0);
+                ++aa->counter;
+
+                // Still have an intersection to output.
+                if (aa->counter < aa->intersectChoices.size()) {
+                    return false;
+                }
+            }
+
+            if (AndAssignment::PRED_CHOICES == aa->state
+                || AndAssignment::INTERSECTIONS == aa->state) {
+                // We (may) move to outputting SUBNODES.
                 if (0 == aa->subnodes.size()) {
                     aa->resetEnumeration();
                     return true;
@@ -83,8 +83,10 @@ namespace mongo {
         /**
          * Traverses the match expression and generates the memo structure from it.
          * Returns true if the provided node uses an index, false otherwise.
+         *
+         * 'inArrayOperator' is true if 'node' is below an array operator such as $elemMatch.
          */
-        bool prepMemo(MatchExpression* node);
+        bool prepMemo(MatchExpression* node, bool inArrayOperator);
 
         /**
          * Returns true if index #idx is compound, false otherwise.
@@ -179,6 +181,8 @@ namespace mongo {
                 // Then this
                 PRED_CHOICES,
                 // Then this
+                INTERSECTIONS,
+                // Then this
                 SUBNODES,
                 // Then we have a carry and back to MANDATORY.
             };
@@ -189,6 +193,9 @@ namespace mongo {
             vector<OneIndexAssignment> mandatory;
             // TODO: We really want to consider the power set of the union of predChoices, subnodes.
             vector<OneIndexAssignment> predChoices;
+            // Each entry lists the members of 'predChoices' that we assign together in order to
+            // intersect the indices they use.
+            vector<vector<size_t> > intersectChoices;
             vector<MemoID> subnodes;
 
             // In the simplest case, an AndAssignment picks indices like a PredicateAssignment.  To
@@ -223,9 +230,11 @@ namespace mongo {
             // If there are any mandatory indices, we assign them one at a time.  After we have
             // assigned all of them, we stop assigning indices.
             //
-            // Otherwise: We assign each index in predChoice.  When those are exhausted, we have
-            // each subtree enumerate its choices one at a time.  When the last subtree has
-            // enumerated its last choices, we are done.
+            // Otherwise: We assign each index in predChoice.  When those are exhausted, we output
+            // each intersection in intersectChoices, which assigns the indices of two disjoint
+            // predChoices at once.  The planner answers those with an AND_HASH or AND_SORTED of
+            // the two scans.  Then we have each subtree enumerate its choices one at a time.  When
+            // the last subtree has enumerated its last choices, we are done.
             //
             void resetEnumeration() {
                 if (mandatory.size() > 0) {
@@ -264,6 +273,12 @@ namespace mongo {
          */
         void allocateAssignment(MatchExpression* expr, NodeAssignment** slot, MemoID* id);
 
+        /**
+         * Fills out 'aa->intersectChoices' with the pairs of members of 'aa->predChoices' that
+         * don't share a predicate.
+         */
+        void prepIntersections(AndAssignment* aa);
+
         void dumpMemo();
 
         // Used to label nodes in the order in which we visit in a post-order traversal.
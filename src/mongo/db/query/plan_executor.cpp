@@ -33,6 +33,7 @@
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/util/trace_points.h"
 
 namespace mongo {
 
@@ -88,9 +89,20 @@ namespace mongo {
             }
 
             WorkingSetID id;
-            PlanStage::StageState code = _root->work(&id);
+            PlanStage::StageState code;
+            {
+                MONGO_TRACE_SCOPE("query", "work");
+                code = _root->work(&id);
+            }
 
             if (PlanStage::ADVANCED == code) {
+                // Some stages (e.g. COUNT) just return ADVANCED with no data.  That's only OK if
+                // the caller isn't asking for any.
+                if (WorkingSet::INVALID_ID == id) {
+                    if (NULL != objOut || NULL != dlOut) { return Runner::RUNNER_ERROR; }
+                    return Runner::RUNNER_ADVANCED;
+                }
+
                 WorkingSetMember* member = _workingSet->get(id);
 
                 if (NULL != objOut) {
@@ -52,6 +52,10 @@ namespace mongo {
         double maxScore = 0;
         size_t bestChild = numeric_limits<size_t>::max();
         for (size_t i = 0; i < statTrees.size(); ++i) {
+            if (candidates[i].abandoned) {
+                QLOG() << "not scoring abandoned plan " << i << endl;
+                continue;
+            }
             QLOG() << "scoring plan " << i << ":\n" << candidates[i].solution->toString();
             double score = scoreTree(statTrees[i]);
             QLOG() << "score = " << score << endl;
@@ -67,6 +71,10 @@ namespace mongo {
         if (NULL != why) {
             // Record the stats of the winner.
             why->statsOfWinner = statTrees[bestChild];
+            why->score = maxScore;
+            why->numCandidates = candidates.size();
+            why->trialWorks = statTrees[bestChild]->common.works;
+            why->trialAdvanced = statTrees[bestChild]->common.advanced;
         }
 
         // Clean up stats of losers.
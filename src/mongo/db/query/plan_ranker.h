@@ -65,7 +65,7 @@ namespace mongo {
      */
     struct CandidatePlan {
         CandidatePlan(QuerySolution* s, PlanStage* r, WorkingSet* w)
-            : solution(s), root(r), ws(w), failed(false) { }
+            : solution(s), root(r), ws(w), failed(false), abandoned(false) { }
 
         QuerySolution* solution;
         PlanStage* root;
@@ -75,6 +75,10 @@ namespace mongo {
         std::list<WorkingSetID> results;
 
         bool failed;
+
+        // Set when the plan was stopped early for performing much worse than the leader.  An
+        // abandoned plan is not picked.
+        bool abandoned;
     };
 
     /**
@@ -82,15 +86,50 @@ namespace mongo {
      * and used by the CachedPlanRunner to compare expected performance with actual.
      */
     struct PlanRankingDecision {
-        PlanRankingDecision() : statsOfWinner(NULL), onlyOneSolution(false) { }
+        PlanRankingDecision() : statsOfWinner(NULL),
+                                onlyOneSolution(false),
+                                score(0),
+                                numCandidates(0),
+                                trialWorks(0),
+                                trialAdvanced(0) { }
+
+        ~PlanRankingDecision() {
+            delete statsOfWinner;
+        }
+
+        /**
+         * Returns a copy of this decision without 'statsOfWinner'.  Caller owns the copy.
+         */
+        PlanRankingDecision* cloneWithoutStats() const {
+            PlanRankingDecision* ret = new PlanRankingDecision();
+            ret->onlyOneSolution = onlyOneSolution;
+            ret->score = score;
+            ret->numCandidates = numCandidates;
+            ret->trialWorks = trialWorks;
+            ret->trialAdvanced = trialAdvanced;
+            return ret;
+        }
 
         // Owned by us.
         PlanStageStats* statsOfWinner;
 
         bool onlyOneSolution;
 
+        // The score PlanRanker gave the winner.
+        double score;
+
+        // How many plans competed.
+        size_t numCandidates;
+
+        // How much work the winner did, and how many results it produced, during the
+        // competition.  Compared against later runs of the plan out of the cache.
+        uint64_t trialWorks;
+        uint64_t trialAdvanced;
+
         // TODO: We can place anything we want here.  What's useful to the cache?  What's useful to
         // planning and optimization?
+    private:
+        MONGO_DISALLOW_COPYING(PlanRankingDecision);
     };
 
 }  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/db/geo/core.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/matcher/expression_text.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/query/canonical_query.h"
@@ -49,9 +50,14 @@
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/qlog.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
+    // The most index scans we'll merge to get a sort out of an index that's bounded by several
+    // points on its leading fields.  Past that we sort the results instead.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
+
     // static
     void QueryPlanner::getFields(MatchExpression* node, string prefix, unordered_set<string>* out) {
         // Leaf nodes with a path and some array operators.
@@ -486,6 +492,50 @@ namespace mongo {
         alignBounds(bounds, index.keyPattern);
     }
 
+    // static
+    bool QueryPlanner::canFilterOnIndexKeys(const MatchExpression* expr,
+                                            const QuerySolutionNode* node) {
+        if (STAGE_IXSCAN != node->getType()) { return false; }
+        const IndexScanNode* ixn = static_cast<const IndexScanNode*>(node);
+
+        // A multikey index has one key per array element, so a key isn't the field's value.
+        if (ixn->indexIsMultiKey) { return false; }
+
+        // Only plain Btree keys hold the indexed values themselves.
+        BSONObjIterator kpIt(ixn->indexKeyPattern);
+        while (kpIt.more()) {
+            if (!kpIt.next().isNumber()) { return false; }
+        }
+
+        if (MatchExpression::AND == expr->matchType()) {
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                if (!canFilterOnIndexKeys(expr->getChild(i), node)) { return false; }
+            }
+            return true;
+        }
+
+        switch (expr->matchType()) {
+            case MatchExpression::REGEX:
+            case MatchExpression::MOD:
+                break;
+            case MatchExpression::LTE:
+            case MatchExpression::LT:
+            case MatchExpression::EQ:
+            case MatchExpression::GT:
+            case MatchExpression::GTE: {
+                // A missing field is indexed as null, so the key can't tell null from missing.
+                const ComparisonMatchExpression* cmp =
+                    static_cast<const ComparisonMatchExpression*>(expr);
+                if (jstNULL == cmp->getData().type()) { return false; }
+                break;
+            }
+            default:
+                return false;
+        }
+
+        return ixn->hasField(expr->path().toString());
+    }
+
     // static
     bool QueryPlanner::processIndexScans(const CanonicalQuery& query,
                                          MatchExpression* root,
@@ -712,9 +762,15 @@ namespace mongo {
             return andResult;
         }
 
-        // If there are any nodes still attached to the AND, we can't answer them using the
-        // index, so we put a fetch with filter.
-        if (root->numChildren() > 0) {
+        // If there are any nodes still attached to the AND, the index bounds don't answer them.
+        // If the scan's keys can, we filter on the keys so the plan can still be covered.
+        // Otherwise we put a fetch with filter.
+        if (root->numChildren() > 0 && canFilterOnIndexKeys(root, andResult)) {
+            verify(NULL != autoRoot.get());
+            // Takes ownership.
+            andResult->filter.reset(autoRoot.release());
+        }
+        else if (root->numChildren() > 0) {
             FetchNode* fetch = new FetchNode();
             verify(NULL != autoRoot.get());
             // Takes ownership.
@@ -873,6 +929,13 @@ namespace mongo {
                     return soln;
                 }
 
+                // The index keys may still hold everything needed to check the predicate.
+                if (canFilterOnIndexKeys(root, soln)) {
+                    verify(NULL != autoRoot.get());
+                    soln->filter.reset(autoRoot.release());
+                    return soln;
+                }
+
                 FetchNode* fetch = new FetchNode();
                 verify(NULL != autoRoot.get());
                 fetch->filter.reset(autoRoot.release());
@@ -1032,6 +1095,163 @@ namespace mongo {
 
     }
 
+    // static
+    bool QueryPlanner::explodeForSort(const CanonicalQuery& query,
+                                      QuerySolutionNode** solnRoot) {
+        // We can explode an index scan whose results are fetched, but nothing fancier.
+        FetchNode* fetch = NULL;
+        QuerySolutionNode* node = *solnRoot;
+        if (STAGE_FETCH == node->getType() && 1 == node->children.size()) {
+            fetch = static_cast<FetchNode*>(node);
+            node = node->children[0];
+        }
+
+        if (STAGE_IXSCAN != node->getType()) {
+            return false;
+        }
+
+        IndexScanNode* isn = static_cast<IndexScanNode*>(node);
+        if (isn->bounds.isSimpleRange || isn->bounds.fields.empty()) {
+            return false;
+        }
+
+        // Only a btree orders its keys by the values of its fields.
+        BSONObjIterator kpIt(isn->indexKeyPattern);
+        while (kpIt.more()) {
+            if (!kpIt.next().isNumber()) {
+                return false;
+            }
+        }
+
+        const BSONObj& sortObj = query.getParsed().getSort();
+        const BSONObj reverseSort = reverseSortObj(sortObj);
+        const size_t maxScans = static_cast<size_t>(internalQueryMaxScansToExplode);
+
+        // Find the shortest prefix of leading fields bounded by points that, once each
+        // combination of points is scanned on its own, gives us the sort.
+        size_t prefixLen = 0;
+        bool reverse = false;
+        size_t numScans = 1;
+        for (size_t i = 0; i < isn->bounds.fields.size(); ++i) {
+            const vector<Interval>& intervals = isn->bounds.fields[i].intervals;
+            if (intervals.empty()) {
+                return false;
+            }
+            for (size_t j = 0; j < intervals.size(); ++j) {
+                if (!intervals[j].isPoint()) {
+                    return false;
+                }
+            }
+
+            numScans *= intervals.size();
+            if (numScans > maxScans) {
+                QLOG() << "Not exploding ixscan for sort, would need more than " << maxScans
+                       << " scans" << endl;
+                return false;
+            }
+
+            // What sorts does a scan over one combination of points provide?
+            IndexScanNode probe;
+            probe.indexKeyPattern = isn->indexKeyPattern;
+            probe.direction = isn->direction;
+            probe.bounds = isn->bounds;
+            for (size_t j = 0; j <= i; ++j) {
+                probe.bounds.fields[j].intervals.resize(1);
+            }
+            probe.computeProperties();
+
+            const BSONObjSet& sorts = probe.getSort();
+            if (sorts.end() != sorts.find(sortObj)) {
+                prefixLen = i + 1;
+                break;
+            }
+            if (sorts.end() != sorts.find(reverseSort)) {
+                prefixLen = i + 1;
+                reverse = true;
+                break;
+            }
+        }
+
+        if (0 == prefixLen) {
+            return false;
+        }
+
+        // Scan each combination of the points in the prefix.  'pos' is an odometer over them.
+        MergeSortNode* msn = new MergeSortNode();
+        msn->sort = sortObj;
+        vector<size_t> pos(prefixLen, 0);
+        while (true) {
+            IndexScanNode* child = new IndexScanNode();
+            child->indexKeyPattern = isn->indexKeyPattern;
+            child->indexIsMultiKey = isn->indexIsMultiKey;
+            child->direction = isn->direction;
+            child->bounds = isn->bounds;
+            for (size_t i = 0; i < prefixLen; ++i) {
+                vector<Interval>& intervals = child->bounds.fields[i].intervals;
+                Interval point = intervals[pos[i]];
+                intervals.clear();
+                intervals.push_back(point);
+            }
+            if (NULL != isn->filter) {
+                child->filter.reset(isn->filter->shallowClone());
+            }
+            if (reverse) {
+                reverseScans(child);
+            }
+            msn->children.push_back(child);
+
+            // Advance to the next combination.
+            size_t i = prefixLen;
+            while (i > 0) {
+                --i;
+                if (++pos[i] < isn->bounds.fields[i].intervals.size()) {
+                    break;
+                }
+                pos[i] = 0;
+            }
+            if (0 == i && 0 == pos[0]) {
+                break;
+            }
+        }
+
+        msn->computeProperties();
+
+        if (NULL != fetch) {
+            delete fetch->children[0];
+            fetch->children[0] = msn;
+        }
+        else {
+            delete isn;
+            *solnRoot = msn;
+        }
+
+        return true;
+    }
+
+    // static
+    bool QueryPlanner::indexProvidesShardKey(const QuerySolutionNode* solnRoot,
+                                             const BSONObj& shardKey) {
+        if (STAGE_IXSCAN != solnRoot->getType() || shardKey.isEmpty()) {
+            return false;
+        }
+
+        const IndexScanNode* isn = static_cast<const IndexScanNode*>(solnRoot);
+        BSONObjIterator it(shardKey);
+        while (it.more()) {
+            BSONElement shardKeyElt = it.next();
+            // A hashed shard key is checked on the hash of the document's value, which only a
+            // hashed index with the same seed holds.  We leave that to the fetched document.
+            if (!shardKeyElt.isNumber()) {
+                return false;
+            }
+            BSONElement indexElt = isn->indexKeyPattern[shardKeyElt.fieldName()];
+            if (!indexElt.isNumber()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     // static
     QuerySolution* QueryPlanner::analyzeDataAccess(const CanonicalQuery& query,
                                                    const QueryPlannerParams& params,
@@ -1049,8 +1269,9 @@ namespace mongo {
         // If we're answering a query on a sharded system, we need to drop documents that aren't
         // logically part of our shard (XXX GREG elaborate more precisely)
         if (params.options & QueryPlannerParams::INCLUDE_SHARD_FILTER) {
-            // XXX TODO: use params.shardKey to do fetch analysis instead of always fetching.
-            if (!solnRoot->fetched()) {
+            // If the index scan provides the shard key the filter can run on the index keys, and
+            // documents that don't belong to us are dropped without being fetched.
+            if (!solnRoot->fetched() && !indexProvidesShardKey(solnRoot, params.shardKey)) {
                 FetchNode* fetch = new FetchNode();
                 fetch->children.push_back(solnRoot);
                 solnRoot = fetch;
@@ -1081,6 +1302,10 @@ namespace mongo {
                         QLOG() << "Reversing ixscan to provide sort.  Result: "
                                << solnRoot->toString() << endl;
                     }
+                    else if (explodeForSort(query, &solnRoot)) {
+                        QLOG() << "Exploded ixscan into point scans to provide sort.  Result: "
+                               << solnRoot->toString() << endl;
+                    }
                     else {
                         // XXX TODO: Can we pull values out of the key and if so in what
                         // cases?  (covered_index_sort_3.js)
@@ -1094,6 +1319,13 @@ namespace mongo {
                         soln->hasSortStage = true;
                         SortNode* sort = new SortNode();
                         sort->pattern = sortObj;
+                        sort->allowDiskUse = query.getParsed().allowDiskUse();
+                        // The skip and limit we add below are applied to the sorted results,
+                        // so the sort only has to keep the first skip + limit of them.
+                        if (0 != query.getParsed().getNumToReturn()) {
+                            sort->limit = query.getParsed().getNumToReturn()
+                                        + query.getParsed().getSkip();
+                        }
                         getBoundsForSort(query, sort);
                         sort->children.push_back(solnRoot);
                         solnRoot = sort;
@@ -1309,6 +1541,27 @@ namespace mongo {
                << "============================="
                << endl;
 
+        // An index filter restricts the indices we consider before we look at the query.
+        if (!params.allowedIndices.empty()) {
+            QueryPlannerParams filteredParams = params;
+            filteredParams.allowedIndices.clear();
+            filteredParams.indexFiltersApplied = true;
+            filteredParams.indices.clear();
+            for (size_t i = 0; i < params.indices.size(); ++i) {
+                const IndexEntry& index = params.indices[i];
+                for (size_t j = 0; j < params.allowedIndices.size(); ++j) {
+                    if (0 == index.keyPattern.woCompare(params.allowedIndices[j])) {
+                        filteredParams.indices.push_back(index);
+                        break;
+                    }
+                }
+            }
+            QLOG() << "index filter applied, " << filteredParams.indices.size() << " of "
+                   << params.indices.size() << " indices allowed" << endl;
+            plan(query, filteredParams, out);
+            return;
+        }
+
         // The shortcut formerly known as IDHACK.  See if it's a simple _id query.  If so we might
         // just make an ixscan over the _id index and bypass the rest of planning entirely.
         if (!query.getParsed().isExplain() && !query.getParsed().showDiskLoc()
@@ -1359,10 +1612,14 @@ namespace mongo {
             return;
         }
 
+        // An index filter overrides the hint.
+        const BSONObj hintObj = params.indexFiltersApplied ? BSONObj()
+                                                           : query.getParsed().getHint();
+
         // The hint can be $natural: 1.  If this happens, output a collscan.  It's a weird way of
         // saying "table scan for two, please."
-        if (!query.getParsed().getHint().isEmpty()) {
-            BSONElement natural = query.getParsed().getHint().getFieldDotted("$natural");
+        if (!hintObj.isEmpty()) {
+            BSONElement natural = hintObj.getFieldDotted("$natural");
             if (!natural.eoo()) {
                 QLOG() << "forcing a table scan due to hinted $natural\n";
                 if (canTableScan) {
@@ -1402,7 +1659,7 @@ namespace mongo {
         vector<IndexEntry> relevantIndices;
 
         // Hints require us to only consider the hinted index.
-        BSONObj hintIndex = query.getParsed().getHint();
+        BSONObj hintIndex = hintObj;
 
         // Snapshot is a form of a hint.  If snapshot is set, try to use _id index to make a real
         // plan.  If that fails, just scan the _id index.
@@ -35,6 +35,8 @@
 namespace mongo {
 
     struct QueryPlannerParams {
+        QueryPlannerParams() : options(DEFAULT), indexFiltersApplied(false) { }
+
         enum Options {
             // You probably want to set this.
             DEFAULT = 0,
@@ -53,6 +55,10 @@ namespace mongo {
             // shardingState.needCollectionMetadata(current_namespace) in the same lock that you use
             // to build the query runner.
             INCLUDE_SHARD_FILTER = 4,
+
+            // Set this if you're only going to count the results.  The planner ignores it, but
+            // getRunner() may then answer the query by counting index keys.
+            PRIVATE_IS_COUNT = 8,
         };
 
         // See Options enum above.
@@ -65,6 +71,13 @@ namespace mongo {
         // stage.  If we know the shard key, we can perform covering analysis instead of always
         // forcing a fetch.
         BSONObj shardKey;
+
+        // Key patterns of the indices that the index filter for the shape of the query allows
+        // (see QuerySettings).  If not empty, every other index is ignored, and so is any hint.
+        vector<BSONObj> allowedIndices;
+
+        // Set by the planner once 'indices' has been restricted to 'allowedIndices'.
+        bool indexFiltersApplied;
     };
 
     /**
@@ -235,6 +248,15 @@ namespace mongo {
          */
         static void finishLeafNode(QuerySolutionNode* node, const IndexEntry& index);
 
+        /**
+         * Returns true if the predicates in 'expr' that the index bounds don't answer exactly can
+         * be evaluated against the key data produced by the leaf 'node' instead of the fetched
+         * document.  If so, 'expr' can be hung off the index scan as a filter and the query may
+         * still be covered.
+         */
+        static bool canFilterOnIndexKeys(const MatchExpression* expr,
+                                         const QuerySolutionNode* node);
+
         //
         // Analysis of Data Access
         //
@@ -257,6 +279,13 @@ namespace mongo {
                                                 const QueryPlannerParams& params,
                                                 QuerySolutionNode* solnRoot);
 
+        /**
+         * Returns true if 'solnRoot' is an index scan whose keys hold every field of the
+         * non-hashed 'shardKey', so that shard filtering can be done before fetching.
+         */
+        static bool indexProvidesShardKey(const QuerySolutionNode* solnRoot,
+                                          const BSONObj& shardKey);
+
         /**
          * Return a plan that uses the provided index as a proxy for a collection scan.
          */
@@ -265,6 +294,17 @@ namespace mongo {
                                              const QueryPlannerParams& params,
                                              int direction = 1);
 
+        /**
+         * If '*solnRoot' is an index scan, possibly under a fetch, that doesn't provide the sort
+         * the query wants but would if a few point bounds on its leading fields were each scanned
+         * by themselves, replaces the scan with a merge sort of those point scans and returns
+         * true.  Leaves '*solnRoot' alone and returns false otherwise.
+         *
+         * For example, {a: {$in: [1, 2]}} sorted by {b: 1} on the index {a: 1, b: 1} becomes a
+         * merge of the scans over [[1, 1], [MinKey, MaxKey]] and [[2, 2], [MinKey, MaxKey]].
+         */
+        static bool explodeForSort(const CanonicalQuery& query, QuerySolutionNode** solnRoot);
+
         /**
          * Traverse the tree rooted at 'root' reversing ixscans and other sorts.
          */
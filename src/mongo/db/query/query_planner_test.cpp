@@ -33,6 +33,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/qlog.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_solution.h"
@@ -82,6 +83,16 @@ namespace {
             QueryPlanner::plan(*cq, params, &solns);
         }
 
+        void runShardedQuery(BSONObj query, BSONObj shardKey) {
+            solns.clear();
+            queryObj = query.getOwned();
+            ASSERT_OK(CanonicalQuery::canonicalize(ns, queryObj, &cq));
+            params.options = QueryPlannerParams::INCLUDE_COLLSCAN |
+                             QueryPlannerParams::INCLUDE_SHARD_FILTER;
+            params.shardKey = shardKey;
+            QueryPlanner::plan(*cq, params, &solns);
+        }
+
         void runDetailedQuery(const BSONObj& query, const BSONObj& sort, const BSONObj& proj) {
             solns.clear();
             ASSERT_OK(CanonicalQuery::canonicalize(ns, query, sort, proj, &cq));
@@ -360,6 +371,63 @@ namespace {
         cout << indexedSolution->toString() << endl;
     }
 
+    //
+    // Index intersection
+    //
+
+    TEST_F(IndexAssignmentTest, IntersectRangesWithAndHash) {
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("b" << 1));
+        runQuery(fromjson("{a: {$gt: 1}, b: {$lt: 5}}"));
+        // Collscan, one plan per index, and the intersection.
+        ASSERT_EQUALS(getNumSolutions(), 4U);
+
+        vector<QuerySolution*> fetches;
+        getAllPlans(STAGE_FETCH, &fetches);
+        ASSERT_EQUALS(fetches.size(), 3U);
+
+        size_t numIntersections = 0;
+        for (size_t i = 0; i < fetches.size(); ++i) {
+            QuerySolutionNode* child = fetches[i]->root->children[0];
+            if (STAGE_AND_HASH == child->getType()) {
+                ASSERT_EQUALS(child->children.size(), 2U);
+                ASSERT_EQUALS(STAGE_IXSCAN, child->children[0]->getType());
+                ASSERT_EQUALS(STAGE_IXSCAN, child->children[1]->getType());
+                ++numIntersections;
+            }
+        }
+        ASSERT_EQUALS(numIntersections, 1U);
+    }
+
+    TEST_F(IndexAssignmentTest, IntersectPointsWithAndSorted) {
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("b" << 1));
+        runQuery(fromjson("{a: 1, b: 2}"));
+        ASSERT_EQUALS(getNumSolutions(), 4U);
+
+        vector<QuerySolution*> fetches;
+        getAllPlans(STAGE_FETCH, &fetches);
+        ASSERT_EQUALS(fetches.size(), 3U);
+
+        size_t numIntersections = 0;
+        for (size_t i = 0; i < fetches.size(); ++i) {
+            QuerySolutionNode* child = fetches[i]->root->children[0];
+            if (STAGE_AND_SORTED == child->getType()) {
+                ASSERT_EQUALS(child->children.size(), 2U);
+                ++numIntersections;
+            }
+        }
+        ASSERT_EQUALS(numIntersections, 1U);
+    }
+
+    TEST_F(IndexAssignmentTest, NoIntersectionOfIndicesOnSameField) {
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runQuery(fromjson("{a: 1, b: 2}"));
+        // Both indices want the predicate over 'a', so we can't intersect them.
+        ASSERT_EQUALS(getNumSolutions(), 3U);
+    }
+
     //
     // Tree operations that require simple tree rewriting.
     //
@@ -408,6 +476,74 @@ namespace {
         }
     }
 
+    TEST_F(IndexAssignmentTest, CoveredInexactPredicateFiltersOnKeys) {
+        addIndex(BSON("x" << 1));
+        runDetailedQuery(fromjson("{x: /foo/}"), BSONObj(), fromjson("{_id: 0, x: 1}"));
+        ASSERT_EQUALS(getNumSolutions(), 2U);
+
+        vector<QuerySolution*> solns;
+        getAllPlans(STAGE_PROJECTION, &solns);
+        ASSERT_EQUALS(solns.size(), 2U);
+
+        size_t numIxscans = 0;
+        for (size_t i = 0; i < solns.size(); ++i) {
+            ProjectionNode* pn = static_cast<ProjectionNode*>(solns[i]->root.get());
+            QuerySolutionNode* child = pn->children[0];
+            ASSERT_NOT_EQUALS(STAGE_FETCH, child->getType());
+            if (STAGE_IXSCAN == child->getType()) {
+                // The regex is checked against the index key.
+                ASSERT(NULL != child->filter.get());
+                ++numIxscans;
+            }
+        }
+        ASSERT_EQUALS(numIxscans, 1U);
+    }
+
+    TEST_F(IndexAssignmentTest, CoveredCompoundResidualFiltersOnKeys) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runDetailedQuery(fromjson("{a: 1, b: /foo/}"), BSONObj(), fromjson("{_id: 0, a: 1, b: 1}"));
+
+        vector<QuerySolution*> solns;
+        getAllPlans(STAGE_PROJECTION, &solns);
+        ASSERT_EQUALS(solns.size(), getNumSolutions());
+
+        size_t numIxscans = 0;
+        for (size_t i = 0; i < solns.size(); ++i) {
+            ProjectionNode* pn = static_cast<ProjectionNode*>(solns[i]->root.get());
+            QuerySolutionNode* child = pn->children[0];
+            ASSERT_NOT_EQUALS(STAGE_FETCH, child->getType());
+            if (STAGE_IXSCAN == child->getType()) {
+                ASSERT(NULL != child->filter.get());
+                ++numIxscans;
+            }
+        }
+        ASSERT_EQUALS(numIxscans, 1U);
+    }
+
+    TEST_F(IndexAssignmentTest, MultikeyInexactPredicateFetches) {
+        // true means multikey, false means not sparse.
+        addIndex(BSON("x" << 1), true, false);
+        runDetailedQuery(fromjson("{x: /foo/}"), BSONObj(), fromjson("{_id: 0, x: 1}"));
+        ASSERT_EQUALS(getNumSolutions(), 2U);
+
+        vector<QuerySolution*> solns;
+        getAllPlans(STAGE_PROJECTION, &solns);
+        ASSERT_EQUALS(solns.size(), 2U);
+
+        size_t numFetches = 0;
+        for (size_t i = 0; i < solns.size(); ++i) {
+            ProjectionNode* pn = static_cast<ProjectionNode*>(solns[i]->root.get());
+            QuerySolutionNode* child = pn->children[0];
+            if (STAGE_FETCH == child->getType()) {
+                ASSERT(NULL != child->filter.get());
+                ASSERT_EQUALS(STAGE_IXSCAN, child->children[0]->getType());
+                ASSERT(NULL == child->children[0]->filter.get());
+                ++numFetches;
+            }
+        }
+        ASSERT_EQUALS(numFetches, 1U);
+    }
+
     //
     // Basic sort elimination
     //
@@ -654,6 +790,37 @@ namespace {
         ASSERT_EQUALS(getNumSolutions(), 3U);
     }
 
+    //
+    // Index filters
+    //
+
+    TEST_F(IndexAssignmentTest, IndexFilterRestrictsIndices) {
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("a" << 1 << "b" << 1));
+        params.allowedIndices.push_back(BSON("a" << 1 << "b" << 1));
+
+        runQuery(fromjson("{a:1, b:{$gt:2,$lt:2}}"));
+
+        // One indexed soln over the allowed index and one non-indexed.
+        ASSERT_EQUALS(getNumSolutions(), 2U);
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        IndexScanNode* ixNode = static_cast<IndexScanNode*>(indexedSolution->root->children[0]);
+        ASSERT_EQUALS(ixNode->indexKeyPattern, BSON("a" << 1 << "b" << 1));
+    }
+
+    TEST_F(IndexAssignmentTest, IndexFilterWithoutUsableIndex) {
+        addIndex(BSON("a" << 1));
+        params.allowedIndices.push_back(BSON("b" << 1));
+
+        runQuery(fromjson("{a: 1}"));
+
+        // The filter allows no existing index.
+        ASSERT_EQUALS(getNumSolutions(), 1U);
+        QuerySolution* collScanSolution;
+        getPlanByType(STAGE_COLLSCAN, &collScanSolution);
+    }
+
     //
     // Sort orders
     //
@@ -704,6 +871,182 @@ namespace {
         dumpSolutions();
     }
 
+    TEST_F(IndexAssignmentTest, ExplodeInForSort) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runDetailedQuery(fromjson("{a: {$in: [1, 2, 3]}}"), fromjson("{b: 1}"), BSONObj());
+
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        ASSERT_FALSE(indexedSolution->hasSortStage);
+        QuerySolutionNode* msn = indexedSolution->root->children[0];
+        ASSERT_EQUALS(STAGE_SORT_MERGE, msn->getType());
+        ASSERT_EQUALS(3U, msn->children.size());
+        for (size_t i = 0; i < msn->children.size(); ++i) {
+            ASSERT_EQUALS(STAGE_IXSCAN, msn->children[i]->getType());
+            IndexScanNode* ixNode = static_cast<IndexScanNode*>(msn->children[i]);
+            ASSERT_EQUALS(1, ixNode->direction);
+            ASSERT_EQUALS(1U, ixNode->bounds.fields[0].intervals.size());
+            ASSERT(ixNode->bounds.fields[0].intervals[0].isPoint());
+            ASSERT_EQUALS(static_cast<int>(i + 1),
+                          ixNode->bounds.fields[0].intervals[0].start.numberInt());
+        }
+    }
+
+    TEST_F(IndexAssignmentTest, ExplodeInForReverseSort) {
+        addIndex(BSON("a" << 1 << "b" << -1));
+        runDetailedQuery(fromjson("{a: {$in: [1, 2]}, b: {$gt: 5}}"), fromjson("{b: 1}"),
+                         BSONObj());
+
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        QuerySolutionNode* msn = indexedSolution->root->children[0];
+        ASSERT_EQUALS(STAGE_SORT_MERGE, msn->getType());
+        ASSERT_EQUALS(2U, msn->children.size());
+        for (size_t i = 0; i < msn->children.size(); ++i) {
+            IndexScanNode* ixNode = static_cast<IndexScanNode*>(msn->children[i]);
+            ASSERT_EQUALS(-1, ixNode->direction);
+        }
+    }
+
+    TEST_F(IndexAssignmentTest, ExplodeTwoInsForSort) {
+        addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+        runDetailedQuery(fromjson("{a: {$in: [1, 2]}, b: {$in: [3, 4, 5]}}"), fromjson("{c: 1}"),
+                         BSONObj());
+
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        QuerySolutionNode* msn = indexedSolution->root->children[0];
+        ASSERT_EQUALS(STAGE_SORT_MERGE, msn->getType());
+        ASSERT_EQUALS(6U, msn->children.size());
+    }
+
+    TEST_F(IndexAssignmentTest, NoExplodeForSortAfterRange) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runDetailedQuery(fromjson("{a: {$gt: 1}}"), fromjson("{b: 1}"), BSONObj());
+
+        vector<QuerySolution*> sortedSolutions;
+        getAllPlans(STAGE_SORT, &sortedSolutions);
+        ASSERT_EQUALS(2U, sortedSolutions.size());
+        ASSERT_EQUALS(2U, getNumSolutions());
+    }
+
+    //
+    // Single interval bounds, used to count keys without fetching
+    //
+
+    TEST_F(IndexAssignmentTest, SingleIntervalRange) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runQuery(fromjson("{a: {$gt: 3, $lte: 7}}"));
+
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        IndexScanNode* ixNode = static_cast<IndexScanNode*>(indexedSolution->root->children[0]);
+
+        BSONObj startKey, endKey;
+        bool startKeyInclusive, endKeyInclusive;
+        ASSERT(IndexBoundsBuilder::isSingleInterval(ixNode->bounds, &startKey, &startKeyInclusive,
+                                                    &endKey, &endKeyInclusive));
+        ASSERT_EQUALS(startKey, BSON("" << 3 << "" << MAXKEY));
+        ASSERT_FALSE(startKeyInclusive);
+        ASSERT_EQUALS(endKey, BSON("" << 7 << "" << MAXKEY));
+        ASSERT(endKeyInclusive);
+    }
+
+    TEST_F(IndexAssignmentTest, SingleIntervalPointThenRange) {
+        addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+        runQuery(fromjson("{a: 5, b: {$gte: 1, $lt: 3}}"));
+
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        IndexScanNode* ixNode = static_cast<IndexScanNode*>(indexedSolution->root->children[0]);
+
+        BSONObj startKey, endKey;
+        bool startKeyInclusive, endKeyInclusive;
+        ASSERT(IndexBoundsBuilder::isSingleInterval(ixNode->bounds, &startKey, &startKeyInclusive,
+                                                    &endKey, &endKeyInclusive));
+        ASSERT_EQUALS(startKey, BSON("" << 5 << "" << 1 << "" << MINKEY));
+        ASSERT(startKeyInclusive);
+        ASSERT_EQUALS(endKey, BSON("" << 5 << "" << 3 << "" << MINKEY));
+        ASSERT_FALSE(endKeyInclusive);
+    }
+
+    TEST_F(IndexAssignmentTest, SingleIntervalDescendingTrailingField) {
+        addIndex(BSON("a" << 1 << "b" << -1));
+        runQuery(fromjson("{a: 5}"));
+
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        IndexScanNode* ixNode = static_cast<IndexScanNode*>(indexedSolution->root->children[0]);
+
+        BSONObj startKey, endKey;
+        bool startKeyInclusive, endKeyInclusive;
+        ASSERT(IndexBoundsBuilder::isSingleInterval(ixNode->bounds, &startKey, &startKeyInclusive,
+                                                    &endKey, &endKeyInclusive));
+        ASSERT_EQUALS(startKey, BSON("" << 5 << "" << MAXKEY));
+        ASSERT(startKeyInclusive);
+        ASSERT_EQUALS(endKey, BSON("" << 5 << "" << MINKEY));
+        ASSERT(endKeyInclusive);
+    }
+
+    TEST_F(IndexAssignmentTest, NotSingleInterval) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runQuery(fromjson("{a: {$in: [1, 2]}}"));
+
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        IndexScanNode* ixNode = static_cast<IndexScanNode*>(indexedSolution->root->children[0]);
+
+        BSONObj startKey, endKey;
+        bool startKeyInclusive, endKeyInclusive;
+        ASSERT_FALSE(IndexBoundsBuilder::isSingleInterval(ixNode->bounds, &startKey,
+                                                          &startKeyInclusive, &endKey,
+                                                          &endKeyInclusive));
+    }
+
+    //
+    // Shard filtering
+    //
+
+    TEST_F(IndexAssignmentTest, ShardFilterBeforeFetch) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runShardedQuery(fromjson("{a: {$gt: 5}}"), BSON("a" << 1));
+
+        ASSERT_EQUALS(getNumSolutions(), 2U);
+
+        // The index keys hold the shard key, so orphans are dropped before the fetch.
+        QuerySolution* indexedSolution;
+        getPlanByType(STAGE_FETCH, &indexedSolution);
+        QuerySolutionNode* filterNode = indexedSolution->root->children[0];
+        ASSERT_EQUALS(filterNode->getType(), STAGE_SHARDING_FILTER);
+        ASSERT_EQUALS(filterNode->children[0]->getType(), STAGE_IXSCAN);
+
+        QuerySolution* collScanSolution;
+        getPlanByType(STAGE_SHARDING_FILTER, &collScanSolution);
+        ASSERT_EQUALS(collScanSolution->root->children[0]->getType(), STAGE_COLLSCAN);
+    }
+
+    TEST_F(IndexAssignmentTest, ShardFilterAfterFetch) {
+        addIndex(BSON("a" << 1));
+        runShardedQuery(fromjson("{a: {$gt: 5}}"), BSON("a" << 1 << "b" << 1));
+
+        // The index doesn't hold all of the shard key.
+        vector<QuerySolution*> filtered;
+        getAllPlans(STAGE_SHARDING_FILTER, &filtered);
+        ASSERT_EQUALS(filtered.size(), 2U);
+        ASSERT_EQUALS(getNumSolutions(), 2U);
+    }
+
+    TEST_F(IndexAssignmentTest, ShardFilterHashedAfterFetch) {
+        addIndex(BSON("a" << 1));
+        runShardedQuery(fromjson("{a: {$gt: 5}}"), BSON("a" << "hashed"));
+
+        // A hashed shard key is checked on the document.
+        vector<QuerySolution*> filtered;
+        getAllPlans(STAGE_SHARDING_FILTER, &filtered);
+        ASSERT_EQUALS(filtered.size(), 2U);
+        ASSERT_EQUALS(getNumSolutions(), 2U);
+    }
+
     // STOPPED HERE - need to hook up machinery for multiple indexed predicates
     //                second is not working (until the machinery is in place)
     //
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/query_settings.h"
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    //
+    // AllowedIndexEntry
+    //
+
+    AllowedIndexEntry::AllowedIndexEntry(const CanonicalQuery& query,
+                                         const std::vector<BSONObj>& indexKeyPatterns)
+        : query(query.getQueryObj().getOwned()),
+          sort(query.getParsed().getSort().getOwned()),
+          projection(query.getParsed().getProj().getOwned()) {
+        for (std::vector<BSONObj>::const_iterator i = indexKeyPatterns.begin();
+             i != indexKeyPatterns.end(); ++i) {
+            this->indexKeyPatterns.push_back(i->getOwned());
+        }
+    }
+
+    //
+    // QuerySettings
+    //
+
+    QuerySettings::QuerySettings() : _mutex("QuerySettings") { }
+
+    QuerySettings::~QuerySettings() { }
+
+    bool QuerySettings::getAllowedIndices(const CanonicalQuery& query,
+                                          std::vector<BSONObj>* indexKeyPatternsOut) const {
+        PlanCacheKey key = PlanCache::getPlanCacheKey(query);
+
+        scoped_lock lk(_mutex);
+        AllowedIndexEntryMap::const_iterator i = _allowedIndexEntryMap.find(key);
+        if (i == _allowedIndexEntryMap.end()) {
+            return false;
+        }
+        *indexKeyPatternsOut = i->second.indexKeyPatterns;
+        return true;
+    }
+
+    void QuerySettings::setAllowedIndices(const CanonicalQuery& query,
+                                          const std::vector<BSONObj>& indexKeyPatterns) {
+        // An empty filter would mean "no filter" to the planner.
+        verify(!indexKeyPatterns.empty());
+
+        PlanCacheKey key = PlanCache::getPlanCacheKey(query);
+        AllowedIndexEntry entry(query, indexKeyPatterns);
+
+        scoped_lock lk(_mutex);
+        _allowedIndexEntryMap[key] = entry;
+    }
+
+    bool QuerySettings::removeAllowedIndices(const CanonicalQuery& query) {
+        PlanCacheKey key = PlanCache::getPlanCacheKey(query);
+
+        scoped_lock lk(_mutex);
+        return _allowedIndexEntryMap.erase(key) > 0;
+    }
+
+    void QuerySettings::clearAllowedIndices() {
+        scoped_lock lk(_mutex);
+        _allowedIndexEntryMap.clear();
+    }
+
+    void QuerySettings::getAllAllowedIndices(std::vector<AllowedIndexEntry>* entriesOut) const {
+        scoped_lock lk(_mutex);
+        for (AllowedIndexEntryMap::const_iterator i = _allowedIndexEntryMap.begin();
+             i != _allowedIndexEntryMap.end(); ++i) {
+            entriesOut->push_back(i->second);
+        }
+    }
+
+}  // namespace mongo
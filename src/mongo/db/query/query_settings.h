@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * An index filter: the indices the planner may consider for a query shape.  Also holds the
+     * query, sort and projection that the filter was set with, for display.
+     */
+    struct AllowedIndexEntry {
+        AllowedIndexEntry() { }
+        AllowedIndexEntry(const CanonicalQuery& query,
+                          const std::vector<BSONObj>& indexKeyPatterns);
+
+        BSONObj query;
+        BSONObj sort;
+        BSONObj projection;
+
+        // Key patterns of the allowed indices.  Owned copies.
+        std::vector<BSONObj> indexKeyPatterns;
+    };
+
+    /**
+     * Holds the index filters of a collection, keyed on the shape of the query (see
+     * PlanCacheKey).  When a query has a filter, QueryPlanner::plan only considers the
+     * filter's indices (see QueryPlannerParams::allowedIndices).  This lets an operator keep
+     * the planner away from a bad index without changing the hints sent by applications.
+     *
+     * There is one QuerySettings per collection, owned by its CollectionInfoCache.  Filters are
+     * not persisted and are lost on restart.  Unlike the plan cache, filters survive index
+     * builds and drops; a filter whose indices are all gone leaves only a collection scan.
+     *
+     * Thread safe.
+     */
+    class QuerySettings {
+    private:
+        MONGO_DISALLOW_COPYING(QuerySettings);
+    public:
+        QuerySettings();
+
+        ~QuerySettings();
+
+        /**
+         * If 'query' has an index filter, copies the allowed key patterns into
+         * 'indexKeyPatternsOut' and returns true.  Otherwise returns false.
+         */
+        bool getAllowedIndices(const CanonicalQuery& query,
+                               std::vector<BSONObj>* indexKeyPatternsOut) const;
+
+        /**
+         * Restrict queries of the shape of 'query' to the indices in 'indexKeyPatterns', which
+         * must not be empty.  Replaces any existing filter for the shape.
+         */
+        void setAllowedIndices(const CanonicalQuery& query,
+                               const std::vector<BSONObj>& indexKeyPatterns);
+
+        /**
+         * Remove the filter for the shape of 'query'.  Returns true if there was one.
+         */
+        bool removeAllowedIndices(const CanonicalQuery& query);
+
+        /**
+         * Remove all filters.
+         */
+        void clearAllowedIndices();
+
+        /**
+         * Appends a copy of every filter to 'entriesOut'.
+         */
+        void getAllAllowedIndices(std::vector<AllowedIndexEntry>* entriesOut) const;
+
+    private:
+        typedef unordered_map<PlanCacheKey, AllowedIndexEntry> AllowedIndexEntryMap;
+
+        // Guards _allowedIndexEntryMap.
+        mutable mongo::mutex _mutex;
+
+        AllowedIndexEntryMap _allowedIndexEntryMap;
+    };
+
+}  // namespace mongo
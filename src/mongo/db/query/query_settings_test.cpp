@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/query_settings.h
+ */
+
+#include "mongo/db/query/query_settings.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    static const char* ns = "somebogusns";
+
+    CanonicalQuery* canonicalize(const char* queryStr, const char* sortStr) {
+        CanonicalQuery* cq;
+        Status result = CanonicalQuery::canonicalize(ns, fromjson(queryStr), fromjson(sortStr),
+                                                     BSONObj(), &cq);
+        ASSERT_OK(result);
+        return cq;
+    }
+
+    TEST(QuerySettingsTest, SetGetRemove) {
+        QuerySettings settings;
+        auto_ptr<CanonicalQuery> cq1(canonicalize("{a: 1, b: 2}", "{}"));
+        auto_ptr<CanonicalQuery> cq2(canonicalize("{a: 3, b: 4}", "{}"));
+        auto_ptr<CanonicalQuery> sorted(canonicalize("{a: 3, b: 4}", "{c: 1}"));
+
+        vector<BSONObj> allowed;
+        ASSERT_FALSE(settings.getAllowedIndices(*cq1, &allowed));
+
+        vector<BSONObj> keyPatterns;
+        keyPatterns.push_back(fromjson("{b: 1}"));
+        settings.setAllowedIndices(*cq1, keyPatterns);
+
+        // The filter applies to every query of the same shape, and only to those.
+        ASSERT_TRUE(settings.getAllowedIndices(*cq2, &allowed));
+        ASSERT_EQUALS(allowed.size(), 1U);
+        ASSERT_EQUALS(allowed[0], fromjson("{b: 1}"));
+        ASSERT_FALSE(settings.getAllowedIndices(*sorted, &allowed));
+
+        // Setting the filter again replaces it.
+        keyPatterns.push_back(fromjson("{a: 1}"));
+        settings.setAllowedIndices(*cq2, keyPatterns);
+        allowed.clear();
+        ASSERT_TRUE(settings.getAllowedIndices(*cq1, &allowed));
+        ASSERT_EQUALS(allowed.size(), 2U);
+
+        vector<AllowedIndexEntry> entries;
+        settings.getAllAllowedIndices(&entries);
+        ASSERT_EQUALS(entries.size(), 1U);
+        ASSERT_EQUALS(entries[0].query, fromjson("{a: 3, b: 4}"));
+
+        ASSERT_TRUE(settings.removeAllowedIndices(*cq1));
+        ASSERT_FALSE(settings.removeAllowedIndices(*cq1));
+        ASSERT_FALSE(settings.getAllowedIndices(*cq2, &allowed));
+    }
+
+    TEST(QuerySettingsTest, Clear) {
+        QuerySettings settings;
+        auto_ptr<CanonicalQuery> cq1(canonicalize("{a: 1}", "{}"));
+        auto_ptr<CanonicalQuery> cq2(canonicalize("{b: 1}", "{}"));
+
+        vector<BSONObj> keyPatterns;
+        keyPatterns.push_back(fromjson("{a: 1}"));
+        settings.setAllowedIndices(*cq1, keyPatterns);
+        settings.setAllowedIndices(*cq2, keyPatterns);
+
+        settings.clearAllowedIndices();
+        vector<BSONObj> allowed;
+        ASSERT_FALSE(settings.getAllowedIndices(*cq1, &allowed));
+        ASSERT_FALSE(settings.getAllowedIndices(*cq2, &allowed));
+
+        vector<AllowedIndexEntry> entries;
+        settings.getAllAllowedIndices(&entries);
+        ASSERT_EQUALS(entries.size(), 0U);
+    }
+
+}  // namespace
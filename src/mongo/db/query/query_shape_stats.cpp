@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <algorithm>
+
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(queryShapeStatsMaxEntriesPerCollection, int, 1000);
+
+namespace {
+
+    bool moreTotalTime(const QueryShapeStatsEntry& a, const QueryShapeStatsEntry& b) {
+        return a.totalMicros > b.totalMicros;
+    }
+
+}  // namespace
+
+    QueryShapeStatsEntry::QueryShapeStatsEntry(const CanonicalQuery& cq)
+        : query(cq.getQueryObj().getOwned()),
+          sort(cq.getParsed().getSort().getOwned()),
+          projection(cq.getParsed().getProj().getOwned()),
+          count(0),
+          totalMicros(0),
+          maxMicros(0),
+          keysExamined(0),
+          docsExamined(0),
+          nreturned(0) { }
+
+    QueryShapeStats::QueryShapeStats()
+        : _mutex("QueryShapeStats"),
+          _shapes(static_cast<size_t>(std::max(1, queryShapeStatsMaxEntriesPerCollection))) { }
+
+    QueryShapeStats::QueryShapeStats(size_t maxSize)
+        : _mutex("QueryShapeStats"),
+          _shapes(maxSize) { }
+
+    void QueryShapeStats::record(const CanonicalQuery& query, long long micros,
+                                 long long keysExamined, long long docsExamined,
+                                 long long nreturned) {
+        PlanCacheKey key = PlanCache::getPlanCacheKey(query);
+
+        scoped_lock lk(_mutex);
+        QueryShapeStatsEntry* entry;
+        if (!_shapes.get(key, &entry).isOK()) {
+            entry = new QueryShapeStatsEntry(query);
+            _shapes.add(key, entry);
+        }
+
+        ++entry->count;
+        entry->totalMicros += micros;
+        entry->maxMicros = std::max(entry->maxMicros, micros);
+        entry->keysExamined += keysExamined;
+        entry->docsExamined += docsExamined;
+        entry->nreturned += nreturned;
+    }
+
+    void QueryShapeStats::getAll(std::vector<QueryShapeStatsEntry>* entriesOut) const {
+        {
+            scoped_lock lk(_mutex);
+            typedef LRUKeyValue<PlanCacheKey, QueryShapeStatsEntry>::KVListConstIt It;
+            for (It i = _shapes.begin(); i != _shapes.end(); ++i) {
+                entriesOut->push_back(*i->second);
+            }
+        }
+        std::stable_sort(entriesOut->begin(), entriesOut->end(), moreTotalTime);
+    }
+
+    void QueryShapeStats::clear() {
+        scoped_lock lk(_mutex);
+        _shapes.clear();
+    }
+
+    size_t QueryShapeStats::size() const {
+        scoped_lock lk(_mutex);
+        return _shapes.size();
+    }
+
+}  // namespace mongo
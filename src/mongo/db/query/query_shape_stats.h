@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * What the queries of one shape have cost since the shape was first seen.
+     */
+    struct QueryShapeStatsEntry {
+        QueryShapeStatsEntry(const CanonicalQuery& query);
+
+        // The query, sort and projection of the first query of the shape.
+        BSONObj query;
+        BSONObj sort;
+        BSONObj projection;
+
+        long long count;
+        long long totalMicros;
+        long long maxMicros;
+        long long keysExamined;
+        long long docsExamined;
+        long long nreturned;
+    };
+
+    /**
+     * Statistics of the queries run against a collection, added up by query shape (see
+     * PlanCacheKey), so that the shapes costing the most, or examining many documents for each
+     * one they return, stand out without post-processing the logs.
+     *
+     * There is one per collection, owned by its CollectionInfoCache.  It holds at most
+     * queryShapeStatsMaxEntriesPerCollection shapes; past that, the least recently run shape is
+     * forgotten.
+     *
+     * Thread safe.
+     */
+    class QueryShapeStats {
+    private:
+        MONGO_DISALLOW_COPYING(QueryShapeStats);
+    public:
+        QueryShapeStats();
+
+        /**
+         * Holding at most 'maxSize' shapes.
+         */
+        QueryShapeStats(size_t maxSize);
+
+        /**
+         * Adds a run of 'query' that took 'micros' micros, examined 'keysExamined' index keys and
+         * 'docsExamined' documents, and returned 'nreturned' documents.
+         */
+        void record(const CanonicalQuery& query, long long micros, long long keysExamined,
+                    long long docsExamined, long long nreturned);
+
+        /**
+         * Copies every shape's statistics to 'entriesOut', the most total time first.
+         */
+        void getAll(std::vector<QueryShapeStatsEntry>* entriesOut) const;
+
+        /**
+         * Forgets every shape.
+         */
+        void clear();
+
+        size_t size() const;
+
+    private:
+        mutable mongo::mutex _mutex;
+
+        LRUKeyValue<PlanCacheKey, QueryShapeStatsEntry> _shapes;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/query_shape_stats.h
+ */
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <memory>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    static const char* ns = "somebogusns";
+
+    CanonicalQuery* canonicalize(const char* queryStr, const char* sortStr = "{}") {
+        CanonicalQuery* cq;
+        Status result = CanonicalQuery::canonicalize(ns, fromjson(queryStr), fromjson(sortStr),
+                                                     BSONObj(), &cq);
+        ASSERT_OK(result);
+        return cq;
+    }
+
+    TEST(QueryShapeStatsTest, SameShapeAddsUp) {
+        QueryShapeStats stats(10);
+        auto_ptr<CanonicalQuery> cq1(canonicalize("{a: 1}"));
+        auto_ptr<CanonicalQuery> cq2(canonicalize("{a: 5}"));
+        stats.record(*cq1, 100, 10, 10, 1);
+        stats.record(*cq2, 300, 20, 5, 2);
+
+        std::vector<QueryShapeStatsEntry> entries;
+        stats.getAll(&entries);
+        ASSERT_EQUALS(1U, entries.size());
+        const QueryShapeStatsEntry& e = entries[0];
+        ASSERT_EQUALS(fromjson("{a: 1}"), e.query);
+        ASSERT_EQUALS(2, e.count);
+        ASSERT_EQUALS(400, e.totalMicros);
+        ASSERT_EQUALS(300, e.maxMicros);
+        ASSERT_EQUALS(30, e.keysExamined);
+        ASSERT_EQUALS(15, e.docsExamined);
+        ASSERT_EQUALS(3, e.nreturned);
+    }
+
+    TEST(QueryShapeStatsTest, MostTotalTimeFirst) {
+        QueryShapeStats stats(10);
+        auto_ptr<CanonicalQuery> a(canonicalize("{a: 1}"));
+        auto_ptr<CanonicalQuery> b(canonicalize("{b: 1}"));
+        auto_ptr<CanonicalQuery> aSorted(canonicalize("{a: 1}", "{c: 1}"));
+        stats.record(*a, 10, 0, 0, 0);
+        stats.record(*b, 50, 0, 0, 0);
+        stats.record(*aSorted, 20, 0, 0, 0);
+        stats.record(*a, 15, 0, 0, 0);
+
+        std::vector<QueryShapeStatsEntry> entries;
+        stats.getAll(&entries);
+        ASSERT_EQUALS(3U, entries.size());
+        ASSERT_EQUALS(fromjson("{b: 1}"), entries[0].query);
+        ASSERT_EQUALS(fromjson("{a: 1}"), entries[1].query);
+        ASSERT_EQUALS(BSONObj(), entries[1].sort);
+        ASSERT_EQUALS(fromjson("{c: 1}"), entries[2].sort);
+    }
+
+    TEST(QueryShapeStatsTest, BoundedAndClearable) {
+        QueryShapeStats stats(2);
+        auto_ptr<CanonicalQuery> a(canonicalize("{a: 1}"));
+        auto_ptr<CanonicalQuery> b(canonicalize("{b: 1}"));
+        auto_ptr<CanonicalQuery> c(canonicalize("{c: 1}"));
+        stats.record(*a, 1, 0, 0, 0);
+        stats.record(*b, 1, 0, 0, 0);
+        stats.record(*a, 1, 0, 0, 0);
+        // b was run least recently.
+        stats.record(*c, 1, 0, 0, 0);
+        ASSERT_EQUALS(2U, stats.size());
+
+        std::vector<QueryShapeStatsEntry> entries;
+        stats.getAll(&entries);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            ASSERT_NOT_EQUALS(fromjson("{b: 1}"), entries[i].query);
+        }
+
+        stats.clear();
+        ASSERT_EQUALS(0U, stats.size());
+    }
+
+}  // namespace
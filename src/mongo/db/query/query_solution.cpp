@@ -482,6 +482,8 @@ namespace mongo {
         *ss << "SORT\n";
         addIndent(ss, indent + 1);
         *ss << "pattern = " << pattern.toString() << endl;
+        addIndent(ss, indent + 1);
+        *ss << "limit = " << limit << endl;
         addCommon(ss, indent);
         *ss << "Child:" << endl;
         children[0]->appendToString(ss, indent + 2);
@@ -595,4 +597,42 @@ namespace mongo {
         children[0]->appendToString(ss, indent + 2);
     }
 
+    //
+    // DistinctNode
+    //
+
+    void DistinctNode::appendToString(stringstream* ss, int indent) const {
+        addIndent(ss, indent);
+        *ss << "DISTINCT\n";
+        addIndent(ss, indent + 1);
+        *ss << "keyPattern = " << indexKeyPattern << endl;
+        if (NULL != filter) {
+            addIndent(ss, indent + 1);
+            *ss << " filter= " << filter->toString() << endl;
+        }
+        addIndent(ss, indent + 1);
+        *ss << "direction = " << direction << endl;
+        addIndent(ss, indent + 1);
+        *ss << "bounds = " << bounds.toString() << endl;
+        addIndent(ss, indent + 1);
+        *ss << "fieldNo = " << fieldNo << endl;
+        addCommon(ss, indent);
+    }
+
+    //
+    // CountNode
+    //
+
+    void CountNode::appendToString(stringstream* ss, int indent) const {
+        addIndent(ss, indent);
+        *ss << "COUNT\n";
+        addIndent(ss, indent + 1);
+        *ss << "keyPattern = " << indexKeyPattern << endl;
+        addIndent(ss, indent + 1);
+        *ss << "startKey = " << startKey << (startKeyInclusive ? " inclusive" : "") << endl;
+        addIndent(ss, indent + 1);
+        *ss << "endKey = " << endKey << (endKeyInclusive ? " inclusive" : "") << endl;
+        addCommon(ss, indent);
+    }
+
 }  // namespace mongo
@@ -403,7 +403,7 @@ namespace mongo {
     };
 
     struct SortNode : public QuerySolutionNode {
-        SortNode() : hasBounds(false) { }
+        SortNode() : hasBounds(false), allowDiskUse(false), limit(0) { }
         virtual ~SortNode() { }
 
         virtual StageType getType() const { return STAGE_SORT; }
@@ -432,6 +432,12 @@ namespace mongo {
 
         // XXX
         IndexBounds bounds;
+
+        // May the sort spill to disk?
+        bool allowDiskUse;
+
+        // The sort only needs to keep this many results.  0 for all of them.
+        size_t limit;
     };
 
     struct LimitNode : public QuerySolutionNode {
@@ -551,4 +557,59 @@ namespace mongo {
         const BSONObjSet& getSort() const { return children[0]->getSort(); }
     };
 
+    /**
+     * Used by the distinct command.  Like an IXSCAN, but only outputs one key for each value of
+     * the first fieldNo + 1 fields of the index.
+     */
+    struct DistinctNode : public QuerySolutionNode {
+        DistinctNode() : direction(1), fieldNo(0) { }
+        virtual ~DistinctNode() { }
+
+        virtual StageType getType() const { return STAGE_DISTINCT; }
+        virtual void appendToString(stringstream* ss, int indent) const;
+
+        // This stage is created "on top" of normal planning and as such the properties
+        // below don't really matter.
+        bool fetched() const { return false; }
+        bool hasField(const string& field) const { return !indexKeyPattern[field].eoo(); }
+        bool sortedByDiskLoc() const { return false; }
+        const BSONObjSet& getSort() const { return sorts; }
+
+        BSONObjSet sorts;
+
+        BSONObj indexKeyPattern;
+        int direction;
+        IndexBounds bounds;
+
+        // We only care about the first fieldNo + 1 fields of the index key.
+        int fieldNo;
+    };
+
+    /**
+     * If all we're doing is counting the results of a query over a single btree interval, we
+     * don't need to produce any results, just walk the keys between the two ends.
+     */
+    struct CountNode : public QuerySolutionNode {
+        CountNode() : startKeyInclusive(true), endKeyInclusive(true) { }
+        virtual ~CountNode() { }
+
+        virtual StageType getType() const { return STAGE_COUNT; }
+        virtual void appendToString(stringstream* ss, int indent) const;
+
+        bool fetched() const { return true; }
+        bool hasField(const string& field) const { return true; }
+        bool sortedByDiskLoc() const { return false; }
+        const BSONObjSet& getSort() const { return sorts; }
+
+        BSONObjSet sorts;
+
+        BSONObj indexKeyPattern;
+
+        BSONObj startKey;
+        bool startKeyInclusive;
+
+        BSONObj endKey;
+        bool endKeyInclusive;
+    };
+
 }  // namespace mongo
@@ -80,7 +80,12 @@ namespace mongo {
          */
         void yield(Record* rec = NULL) {
             int micros = ClientCursor::suggestYieldMicros();
-            if (micros > 0) {
+            // A record to page in is reason enough to give up the lock, even if no one is
+            // waiting for it: otherwise the stage that asked for the fetch faults on it locked.
+            if (NULL != rec && micros < 0) {
+                micros = 0;
+            }
+            if (micros > 0 || NULL != rec) {
                 staticYield(micros, rec);
                 _elapsedTracker.resetLastTime();
             }
@@ -109,6 +109,7 @@ namespace mongo {
         }
         (*explain)->setNScannedObjectsAllPlans((*explain)->getNScannedObjects());
         (*explain)->setNScannedAllPlans((*explain)->getNScanned());
+        (*explain)->setPeakWorkingSetMembers(_exec->getWorkingSet()->getPeakMembers());
 
         return Status::OK();
     }
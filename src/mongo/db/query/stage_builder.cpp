@@ -33,6 +33,8 @@
 #include "mongo/db/exec/and_hash.h"
 #include "mongo/db/exec/and_sorted.h"
 #include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/count.h"
+#include "mongo/db/exec/distinct_scan.h"
 #include "mongo/db/exec/fetch.h"
 #include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/limit.h"
@@ -103,6 +105,8 @@ namespace mongo {
             params.pattern = sn->pattern;
             params.bounds = sn->bounds;
             params.hasBounds = sn->hasBounds;
+            params.allowDiskUse = sn->allowDiskUse;
+            params.limit = sn->limit;
             return new SortStage(params, ws, childStage);
         }
         else if (STAGE_PROJECTION == root->getType()) {
@@ -231,6 +235,51 @@ namespace mongo {
             if (NULL == childStage) { return NULL; }
             return new ShardFilterStage(ns, ws, childStage);
         }
+        else if (STAGE_DISTINCT == root->getType()) {
+            const DistinctNode* dn = static_cast<const DistinctNode*>(root);
+            Database* db = cc().database();
+            Collection* collection = db ? db->getCollection( ns ) : NULL;
+            if (NULL == collection) {
+                warning() << "Can't distinct-scan null ns " << ns << endl;
+                return NULL;
+            }
+            NamespaceDetails* nsd = collection->details();
+            int idxNo = nsd->findIndexByKeyPattern(dn->indexKeyPattern);
+            if (-1 == idxNo) {
+                warning() << "Can't find idx " << dn->indexKeyPattern.toString()
+                          << "in ns " << ns << endl;
+                return NULL;
+            }
+            DistinctParams params;
+            params.descriptor = collection->getIndexCatalog()->getDescriptor( idxNo );
+            params.direction = dn->direction;
+            params.bounds = dn->bounds;
+            params.fieldNo = dn->fieldNo;
+            return new DistinctScan(params, ws, dn->filter.get());
+        }
+        else if (STAGE_COUNT == root->getType()) {
+            const CountNode* cn = static_cast<const CountNode*>(root);
+            Database* db = cc().database();
+            Collection* collection = db ? db->getCollection( ns ) : NULL;
+            if (NULL == collection) {
+                warning() << "Can't count null ns " << ns << endl;
+                return NULL;
+            }
+            NamespaceDetails* nsd = collection->details();
+            int idxNo = nsd->findIndexByKeyPattern(cn->indexKeyPattern);
+            if (-1 == idxNo) {
+                warning() << "Can't find idx " << cn->indexKeyPattern.toString()
+                          << "in ns " << ns << endl;
+                return NULL;
+            }
+            CountParams params;
+            params.descriptor = collection->getIndexCatalog()->getDescriptor( idxNo );
+            params.startKey = cn->startKey;
+            params.startKeyInclusive = cn->startKeyInclusive;
+            params.endKey = cn->endKey;
+            params.endKeyInclusive = cn->endKeyInclusive;
+            return new Count(params, ws);
+        }
         else {
             stringstream ss;
             root->appendToString(&ss, 0);
@@ -37,6 +37,13 @@ namespace mongo {
         STAGE_AND_HASH,
         STAGE_AND_SORTED,
         STAGE_COLLSCAN,
+
+        // Counts the keys of a single btree interval.  Only used by the count command.
+        STAGE_COUNT,
+
+        // Skips over the index keys that share a prefix with the last one returned.
+        STAGE_DISTINCT,
+
         STAGE_FETCH,
 
         // TODO: This is probably an expression index, but would take even more time than
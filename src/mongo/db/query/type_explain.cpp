@@ -35,8 +35,10 @@ namespace mongo {
     const BSONField<bool> TypeExplain::indexOnly("indexOnly");
     const BSONField<long long> TypeExplain::nYields("nYields");
     const BSONField<long long> TypeExplain::nChunkSkips("nChunkSkips");
+    const BSONField<long long> TypeExplain::peakWorkingSetMembers("peakWorkingSetMembers");
     const BSONField<long long> TypeExplain::millis("millis");
     const BSONField<BSONObj> TypeExplain::indexBounds("indexBounds");
+    const BSONField<BSONObj> TypeExplain::executionStats("executionStats");
     const BSONField<std::vector<TypeExplain*> > TypeExplain::allPlans("allPlans");
     const BSONField<TypeExplain*> TypeExplain::oldPlan("oldPlan");
     const BSONField<std::string> TypeExplain::server("server");
@@ -127,10 +129,16 @@ namespace mongo {
 
         if (_isNChunkSkipsSet) builder.appendNumber(nChunkSkips(), _nChunkSkips);
 
+        if (_isPeakWorkingSetMembersSet) {
+            builder.appendNumber(peakWorkingSetMembers(), _peakWorkingSetMembers);
+        }
+
         if (_isMillisSet) builder.appendNumber(millis(), _millis);
 
         if (_isIndexBoundsSet) builder.append(indexBounds(), _indexBounds);
 
+        if (_isExecutionStatsSet) builder.append(executionStats(), _executionStats);
+
         if (_allPlans.get()) {
             BSONArrayBuilder allPlansBuilder(builder.subarrayStart(allPlans()));
             for (std::vector<TypeExplain*>::const_iterator it = _allPlans->begin();
@@ -209,6 +217,11 @@ namespace mongo {
         if (fieldState == FieldParser::FIELD_INVALID) return false;
         _isNChunkSkipsSet = fieldState == FieldParser::FIELD_SET;
 
+        fieldState = FieldParser::extract(source, peakWorkingSetMembers, &_peakWorkingSetMembers,
+                                          errMsg);
+        if (fieldState == FieldParser::FIELD_INVALID) return false;
+        _isPeakWorkingSetMembersSet = fieldState == FieldParser::FIELD_SET;
+
         fieldState = FieldParser::extract(source, millis, &_millis, errMsg);
         if (fieldState == FieldParser::FIELD_INVALID) return false;
         _isMillisSet = fieldState == FieldParser::FIELD_SET;
@@ -217,6 +230,10 @@ namespace mongo {
         if (fieldState == FieldParser::FIELD_INVALID) return false;
         _isIndexBoundsSet = fieldState == FieldParser::FIELD_SET;
 
+        fieldState = FieldParser::extract(source, executionStats, &_executionStats, errMsg);
+        if (fieldState == FieldParser::FIELD_INVALID) return false;
+        _isExecutionStatsSet = fieldState == FieldParser::FIELD_SET;
+
         std::vector<TypeExplain*>* bareAllPlans = NULL;
         fieldState = FieldParser::extract(source, allPlans, &bareAllPlans, errMsg);
         if (fieldState == FieldParser::FIELD_INVALID) return false;
@@ -270,12 +287,18 @@ namespace mongo {
         _nChunkSkips = 0;
         _isNChunkSkipsSet = false;
 
+        _peakWorkingSetMembers = 0;
+        _isPeakWorkingSetMembersSet = false;
+
         _millis = 0;
         _isMillisSet = false;
 
         _indexBounds = BSONObj();
         _isIndexBoundsSet = false;
 
+        _executionStats = BSONObj();
+        _isExecutionStatsSet = false;
+
         unsetAllPlans();
 
         unsetOldPlan();
@@ -332,12 +355,18 @@ namespace mongo {
         other->_nChunkSkips = _nChunkSkips;
         other->_isNChunkSkipsSet = _isNChunkSkipsSet;
 
+        other->_peakWorkingSetMembers = _peakWorkingSetMembers;
+        other->_isPeakWorkingSetMembersSet = _isPeakWorkingSetMembersSet;
+
         other->_millis = _millis;
         other->_isMillisSet = _isMillisSet;
 
         other->_indexBounds = _indexBounds;
         other->_isIndexBoundsSet = _isIndexBoundsSet;
 
+        other->_executionStats = _executionStats;
+        other->_isExecutionStatsSet = _isExecutionStatsSet;
+
         other->unsetAllPlans();
         if (_allPlans.get()) {
             for(std::vector<TypeExplain*>::const_iterator it = _allPlans->begin();
@@ -611,6 +640,24 @@ namespace mongo {
         return _nChunkSkips;
     }
 
+    void TypeExplain::setPeakWorkingSetMembers(long long peakWorkingSetMembers) {
+        _peakWorkingSetMembers = peakWorkingSetMembers;
+        _isPeakWorkingSetMembersSet = true;
+    }
+
+    void TypeExplain::unsetPeakWorkingSetMembers() {
+         _isPeakWorkingSetMembersSet = false;
+     }
+
+    bool TypeExplain::isPeakWorkingSetMembersSet() const {
+         return _isPeakWorkingSetMembersSet;
+    }
+
+    long long TypeExplain::getPeakWorkingSetMembers() const {
+        dassert(_isPeakWorkingSetMembersSet);
+        return _peakWorkingSetMembers;
+    }
+
     void TypeExplain::setMillis(long long millis) {
         _millis = millis;
         _isMillisSet = true;
@@ -647,6 +694,24 @@ namespace mongo {
         return _indexBounds;
     }
 
+    void TypeExplain::setExecutionStats(const BSONObj& executionStats) {
+        _executionStats = executionStats.getOwned();
+        _isExecutionStatsSet = true;
+    }
+
+    void TypeExplain::unsetExecutionStats() {
+         _isExecutionStatsSet = false;
+     }
+
+    bool TypeExplain::isExecutionStatsSet() const {
+         return _isExecutionStatsSet;
+    }
+
+    const BSONObj& TypeExplain::getExecutionStats() const {
+        dassert(_isExecutionStatsSet);
+        return _executionStats;
+    }
+
     void TypeExplain::setAllPlans(const std::vector<TypeExplain*>& allPlans) {
         unsetAllPlans();
         for (std::vector<TypeExplain*>::const_iterator it = allPlans.begin();
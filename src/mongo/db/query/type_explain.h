@@ -47,8 +47,10 @@ namespace mongo {
         static const BSONField<bool> indexOnly;
         static const BSONField<long long> nYields;
         static const BSONField<long long> nChunkSkips;
+        static const BSONField<long long> peakWorkingSetMembers;
         static const BSONField<long long> millis;
         static const BSONField<BSONObj> indexBounds;
+        static const BSONField<BSONObj> executionStats;
         static const BSONField<std::vector<TypeExplain*> > allPlans;
         static const BSONField<TypeExplain*> oldPlan;
         static const BSONField<std::string> server;
@@ -140,6 +142,11 @@ namespace mongo {
         bool isNChunkSkipsSet() const;
         long long getNChunkSkips() const;
 
+        void setPeakWorkingSetMembers(long long peakWorkingSetMembers);
+        void unsetPeakWorkingSetMembers();
+        bool isPeakWorkingSetMembersSet() const;
+        long long getPeakWorkingSetMembers() const;
+
         void setMillis(long long millis);
         void unsetMillis();
         bool isMillisSet() const;
@@ -150,6 +157,11 @@ namespace mongo {
         bool isIndexBoundsSet() const;
         const BSONObj& getIndexBounds() const;
 
+        void setExecutionStats(const BSONObj& executionStats);
+        void unsetExecutionStats();
+        bool isExecutionStatsSet() const;
+        const BSONObj& getExecutionStats() const;
+
         void setAllPlans(const std::vector<TypeExplain*>& allPlans);
         void addToAllPlans(TypeExplain* allPlans);
         void unsetAllPlans();
@@ -218,6 +230,10 @@ namespace mongo {
         long long _nChunkSkips;
         bool _isNChunkSkipsSet;
 
+        // (O)  most query results this plan's working set held at once
+        long long _peakWorkingSetMembers;
+        bool _isPeakWorkingSetMembersSet;
+
         // (O)  elapsed time this plan took running, in milliseconds
         long long _millis;
         bool _isMillisSet;
@@ -226,6 +242,10 @@ namespace mongo {
         BSONObj _indexBounds;
         bool _isIndexBoundsSet;
 
+        // (O)  per-stage work, timing and memory figures for the plan's stage tree
+        BSONObj _executionStats;
+        bool _isExecutionStatsSet;
+
         // (O)  alternative plans considered
         boost::scoped_ptr<std::vector<TypeExplain*> > _allPlans;
 
@@ -41,7 +41,7 @@ namespace mongo {
         if (0 == version) {
             return indexdetails.head.btree<V0>()->findSingle(indexdetails, indexdetails.head, key);
         } else {
-            verify(1 == version);
+            verify(1 == version || 2 == version);
             return indexdetails.head.btree<V1>()->findSingle(indexdetails, indexdetails.head, key);
         }
     }
@@ -35,6 +35,7 @@
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/rs_sync.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/base/counter.h"
 #include "mongo/db/stats/timer_stats.h"
@@ -45,6 +46,11 @@ namespace replset {
     int SleepToAllowBatchingMillis = 2;
     const int BatchIsSmallish = 40000; // bytes
 
+    // Tail the sync source's oplog with an exhaust cursor, whose batches the source sends as
+    // they are ready instead of waiting for a getMore for each.  It sends no faster than we
+    // read, and we stop reading while the buffer is full.
+    MONGO_EXPORT_SERVER_PARAMETER(replOplogExhaust, bool, true);
+
     MONGO_FP_DECLARE(rsBgSyncProduce);
 
     BackgroundSync* BackgroundSync::s_instance = 0;
@@ -335,6 +341,9 @@ namespace replset {
             lastOpTimeFetched = _lastOpTimeFetched;
         }
 
+        if (replOplogExhaust) {
+            r.setTailingQueryOptions(r.getTailingQueryOptions() | QueryOption_Exhaust);
+        }
         r.tailingQueryGTE(rsoplog, lastOpTimeFetched);
 
         // if target cut connections between connecting and querying (for
@@ -385,6 +394,7 @@ namespace replset {
                 }
 
 
+                Timer fetchTimer;
                 {
                     //record time for each getmore
                     TimerHolder batchTimer(&getmoreReplStats);
@@ -395,6 +405,15 @@ namespace replset {
                 }
                 networkByteStats.increment(r.currentBatchMessageSize());
 
+                // a batch that isn't small means the source had a backlog for us, so how long
+                // it took says how fast we can fetch from it, which sync source selection weighs
+                long long fetchMicros = fetchTimer.micros();
+                if (r.currentBatchMessageSize() >= BatchIsSmallish && fetchMicros > 0) {
+                    theReplSet->noteSyncSourceThroughput(
+                        r.conn()->getServerAddress(),
+                        r.currentBatchMessageSize() * 1000000.0 / fetchMicros);
+                }
+
                 if (!r.moreInCurrentBatch()) {
                     // If there is still no data from upstream, check a few more things
                     // and then loop back for another pass at getting more data
@@ -573,6 +592,11 @@ namespace replset {
 
         if (!r.more()) {
             try {
+                if (!r.endExhaust()) {
+                    log() << "replSet error reconnecting to " << hn << rsLog;
+                    sleepsecs(2);
+                    return true;
+                }
                 BSONObj theirLastOp = r.getLastOp(rsoplog);
                 if (theirLastOp.isEmpty()) {
                     log() << "replSet error empty query result from " << hn << " oplog" << rsLog;
@@ -603,6 +627,11 @@ namespace replset {
         if( ts != _lastOpTimeFetched || h != _lastH ) {
             log() << "replSet our last op time fetched: " << _lastOpTimeFetched.toStringPretty() << rsLog;
             log() << "replset source's GTE: " << ts.toStringPretty() << rsLog;
+            if (!r.endExhaust()) {
+                log() << "replSet error reconnecting to " << hn << rsLog;
+                sleepsecs(2);
+                return true;
+            }
             theReplSet->syncRollback(r);
             return true;
         }
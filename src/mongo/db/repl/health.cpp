@@ -438,6 +438,11 @@ namespace mongo {
                 bb.appendDate("optimeDate", lastOpTimeWritten.getSecs() * 1000LL);
             }
 
+            long long compressionBytesSaved = oplogCompressionBytesSaved();
+            if (compressionBytesSaved) {
+                bb.append("oplogCompressionBytesSaved", compressionBytesSaved);
+            }
+
             int maintenance = _maintenanceMode;
             if (maintenance) {
                 bb.append("maintenanceMode", maintenance);
@@ -500,6 +505,9 @@ namespace mongo {
             (myState != MemberState::RS_PRIMARY) &&
             (myState != MemberState::RS_SHUNNED) ) {
             b.append("syncingTo", syncTarget->fullName());
+            string reason = syncSourceReason();
+            if (!reason.empty())
+                b.append("syncSourceReason", reason);
         }
         b.append("members", v);
         if( replSetBlind )
@@ -39,10 +39,14 @@
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/auth/security_key.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/rs.h"  // theReplSet
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/compress.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -54,6 +58,89 @@ namespace mongo {
                                                     &readersCreatedStats );
 
 
+    // oplog getMore replies received compressed, as sent and as uncompressed
+    static Counter64 compressedBytesStats;
+    static ServerStatusMetricField<Counter64> displayCompressedBytes(
+                                                    "repl.network.compressedBytes",
+                                                    &compressedBytesStats );
+    static Counter64 compressionBytesSavedStats;
+    static ServerStatusMetricField<Counter64> displayCompressionBytesSaved(
+                                                    "repl.network.compressionBytesSaved",
+                                                    &compressionBytesSavedStats );
+
+    // Ask sync sources to compress the oplog they send.  Sources that do not know how send it
+    // as before.
+    MONGO_EXPORT_SERVER_PARAMETER(replOplogCompression, bool, false);
+
+    long long oplogCompressionBytesSaved() {
+        return compressionBytesSavedStats.get();
+    }
+
+    namespace {
+        /**
+         * A connection that asks for the documents of its queries and getMores on the oplog to
+         * be compressed, and uncompresses the replies before the cursor reads them.
+         */
+        class CompressedOplogConnection : public DBClientConnection {
+        public:
+            CompressedOplogConnection(double soTimeout) :
+                DBClientConnection(false, 0, soTimeout) {
+            }
+
+            virtual bool call(Message& toSend, Message& response, bool assertOk = true,
+                              string* actualServer = 0) {
+                if ((toSend.operation() == dbQuery || toSend.operation() == dbGetMore) &&
+                    str::startsWith(DbMessage(toSend).getns(), "local.oplog.")) {
+                    // both start with the options of the cursor's query.  the query's own reply
+                    // is not compressed, but the batches an exhaust cursor goes on to send are
+                    *reinterpret_cast<int*>(toSend.singleData()->_data) |=
+                        QueryOption_CompressedOplogReplies;
+                }
+
+                if (!DBClientConnection::call(toSend, response, assertOk, actualServer)) {
+                    return false;
+                }
+                uncompressReply(response);
+                return true;
+            }
+
+            virtual bool recv(Message& m) {
+                if (!DBClientConnection::recv(m)) {
+                    return false;
+                }
+                uncompressReply(m);
+                return true;
+            }
+
+        private:
+            static void uncompressReply(Message& response) {
+                QueryResult* qr = reinterpret_cast<QueryResult*>(response.singleData());
+                if (response.operation() != opReply ||
+                    !(qr->resultFlags() & ResultFlag_Compressed)) {
+                    return;
+                }
+
+                const int headerLen = qr->data() - reinterpret_cast<const char*>(qr);
+                string docs;
+                uassert(17287, "could not uncompress oplog received from sync source",
+                        uncompress(qr->data(), qr->len - headerLen, &docs));
+
+                BufBuilder b(headerLen + docs.size());
+                b.appendBuf(qr, headerLen);
+                b.appendBuf(docs.data(), docs.size());
+                QueryResult* out = reinterpret_cast<QueryResult*>(b.buf());
+                out->len = b.len();
+                out->_resultFlags() &= ~ResultFlag_Compressed;
+                b.decouple();
+
+                compressedBytesStats.increment(qr->len);
+                compressionBytesSavedStats.increment(out->len - qr->len);
+                response.reset();
+                response.setData(out, true);
+            }
+        };
+    }
+
     static const BSONObj userReplQuery = fromjson("{\"user\":\"repl\"}");
 
     bool replAuthenticate(DBClientBase *conn) {
@@ -94,9 +181,9 @@ namespace mongo {
 
     bool OplogReader::commonConnect(const string& hostName) {
         if( conn() == 0 ) {
-            _conn = shared_ptr<DBClientConnection>(new DBClientConnection(false,
-                                                                          0,
-                                                                          tcp_timeout));
+            _conn = shared_ptr<DBClientConnection>(
+                    replOplogCompression ? new CompressedOplogConnection(tcp_timeout) :
+                                           new DBClientConnection(false, 0, tcp_timeout));
             string errmsg;
             if ( !_conn->connect(hostName.c_str(), errmsg) ||
                  (getGlobalAuthorizationManager()->isAuthEnabled() &&
@@ -110,6 +197,18 @@ namespace mongo {
         return true;
     }
 
+    bool OplogReader::endExhaust() {
+        if (!cursor.get() || !cursor->exhaust() || cursor->isDead()) {
+            return true;
+        }
+
+        // the source sends batches on this connection until it closes
+        const string hostName = _conn->getServerAddress();
+        cursor->decouple();
+        resetConnection();
+        return connect(hostName);
+    }
+
     bool OplogReader::connect(const std::string& hostName) {
         if (conn()) {
             return true;
@@ -44,6 +44,11 @@ namespace mongo {
      */
     bool replAuthenticate(DBClientBase* conn);
 
+    /**
+     * The bytes of oplog that sync sources compressed away before sending it to this member.
+     */
+    long long oplogCompressionBytesSaved();
+
     /* started abstracting out the querying of the primary/master's oplog
        still fairly awkward but a start.
     */
@@ -87,6 +92,13 @@ namespace mongo {
 
         bool haveCursor() { return cursor.get() != 0; }
 
+        /**
+         * Drops a live exhaust cursor, whose batches keep arriving on the connection, and
+         * connects to the same host again so the connection can be queried.
+         * @return false if the connection could not be made again
+         */
+        bool endExhaust();
+
         /** this is ok but commented out as when used one should consider if QueryOption_OplogReplay
            is needed; if not fine, but if so, need to change.
         *//*
@@ -35,6 +35,7 @@
 #include "mongo/client/connpool.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/message_compression.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/master_slave.h"
@@ -181,6 +182,7 @@ namespace mongo {
             result.appendDate("localTime", jsTime());
             result.append("maxWireVersion", maxWireVersion);
             result.append("minWireVersion", minWireVersion);
+            negotiateMessageCompression(cmdObj, &result);
             return true;
         }
     } cmdismaster;
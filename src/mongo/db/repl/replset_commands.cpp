@@ -28,18 +28,26 @@
 
 #include "mongo/pch.h"
 
+#include <boost/filesystem/operations.hpp>
+
 #include "mongo/base/init.h"
 #include "mongo/base/status.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/health.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_server_status.h"  // replSettings
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/rs_config.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/file.h"
 
 using namespace bson;
 
@@ -410,6 +418,152 @@ namespace mongo {
         }
     } cmdReplSetSyncFrom;
 
+    std::string replDataFilePath(const std::string& db, const std::string& file) {
+        boost::filesystem::path p(storageGlobalParams.dbpath);
+        if (storageGlobalParams.directoryperdb)
+            p /= db;
+        p /= file;
+        return p.string();
+    }
+
+    namespace {
+        /** the files of db are db.ns and db.0, db.1, ... */
+        bool isDataFileOf(const string& db, const string& file) {
+            if (file.size() <= db.size() + 1 || file.compare(0, db.size() + 1, db + ".") != 0)
+                return false;
+            string suffix = file.substr(db.size() + 1);
+            if (suffix == "ns")
+                return true;
+            for (size_t i = 0; i < suffix.size(); i++) {
+                if (!isdigit(suffix[i]))
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    /** lists the data files of every database but local, for a member copying them in initial
+        sync.  the files are only consistent while this server is fsync locked, so we insist.
+        @see replSetCopyDataFile
+    */
+    class CmdReplSetListDataFiles : public ReplSetCommand {
+    public:
+        virtual void help( stringstream &help ) const {
+            help << "internal";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::replSetCopyDataFiles);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        CmdReplSetListDataFiles() : ReplSetCommand("replSetListDataFiles") { }
+        virtual bool run(const string& , BSONObj& cmdObj, int, string& errmsg,
+                         BSONObjBuilder& result, bool fromRepl) {
+            if (!check(errmsg, result))
+                return false;
+            if (!lockedForWriting()) {
+                errmsg = "server must be fsync locked to list its data files";
+                return false;
+            }
+
+            vector<string> dbNames;
+            getDatabaseNames(dbNames);
+
+            BSONArrayBuilder files(result.subarrayStart("files"));
+            for (vector<string>::const_iterator i = dbNames.begin(); i != dbNames.end(); ++i) {
+                if (*i == "local")
+                    continue;
+                string ns = *i + ".ns";
+                files.append(BSON("db" << *i << "file" << ns << "size" <<
+                                  static_cast<long long>(
+                                      boost::filesystem::file_size(replDataFilePath(*i, ns)))));
+                for (int n = 0; ; n++) {
+                    string file = str::stream() << *i << '.' << n;
+                    string path = replDataFilePath(*i, file);
+                    if (!boost::filesystem::exists(path))
+                        break;
+                    files.append(BSON("db" << *i << "file" << file << "size" <<
+                                      static_cast<long long>(boost::filesystem::file_size(path))));
+                }
+            }
+            files.done();
+            return true;
+        }
+    } cmdReplSetListDataFiles;
+
+    /** reads a piece of a data file listed by replSetListDataFiles, snappy compressed:
+          { replSetCopyDataFile : <db>, file : <file>, offset : <bytes>, length : <bytes> }
+        returns { data : <BinData>, length : <bytes read> }, where a short read is the end of
+        the file.
+    */
+    class CmdReplSetCopyDataFile : public ReplSetCommand {
+    public:
+        static const int MaxLength = 8 * 1024 * 1024;
+
+        virtual void help( stringstream &help ) const {
+            help << "internal";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::replSetCopyDataFiles);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        CmdReplSetCopyDataFile() : ReplSetCommand("replSetCopyDataFile") { }
+        virtual bool run(const string& , BSONObj& cmdObj, int, string& errmsg,
+                         BSONObjBuilder& result, bool fromRepl) {
+            if (!check(errmsg, result))
+                return false;
+            if (!lockedForWriting()) {
+                errmsg = "server must be fsync locked to copy its data files";
+                return false;
+            }
+
+            string db = cmdObj["replSetCopyDataFile"].valuestrsafe();
+            string file = cmdObj["file"].valuestrsafe();
+            if (db == "local" || !NamespaceString::validDBName(db) || !isDataFileOf(db, file)) {
+                errmsg = str::stream() << "not a data file: " << db << ' ' << file;
+                return false;
+            }
+            long long offset = cmdObj["offset"].numberLong();
+            long long length = cmdObj["length"].numberLong();
+            if (offset < 0 || length <= 0 || length > MaxLength) {
+                errmsg = str::stream() << "bad offset or length, length can be at most "
+                                       << MaxLength;
+                return false;
+            }
+
+            string path = replDataFilePath(db, file);
+            File f;
+            f.open(path.c_str(), true);
+            if (!f.is_open() || f.bad()) {
+                errmsg = str::stream() << "couldn't open " << path;
+                return false;
+            }
+            fileofs len = f.len();
+            unsigned n = 0;
+            if (static_cast<fileofs>(offset) < len)
+                n = static_cast<unsigned>(std::min<fileofs>(length, len - offset));
+
+            scoped_array<char> buf(new char[n + 1]);
+            if (n > 0)
+                f.read(offset, buf.get(), n);
+            if (f.bad()) {
+                errmsg = str::stream() << "couldn't read " << path;
+                return false;
+            }
+
+            string compressed;
+            compress(buf.get(), n, &compressed);
+            result.appendBinData("data", compressed.size(), BinDataGeneral, compressed.data());
+            result.append("length", static_cast<int>(n));
+            return true;
+        }
+    } cmdReplSetCopyDataFile;
+
     class CmdReplSetUpdatePosition: public ReplSetCommand {
     public:
         virtual void help( stringstream &help ) const {
@@ -485,6 +485,7 @@ namespace {
         _maintenanceMode(0),
         mgr(0),
         ghost(0),
+        _syncSourceStatsMutex("syncSourceStats"),
         _writerPool(replWriterThreadCount),
         _prefetcherPool(replPrefetcherThreadCount),
         oplogVersion(0),
@@ -374,9 +374,15 @@ namespace mongo {
         bool shouldChangeSyncTarget(const OpTime& target) const;
 
         /**
-         * Find the closest member (using ping time) with a higher latest optime.
+         * Find the best member with a higher latest optime, by ping time, how far behind the
+         * freshest member it is and how fast we fetched its oplog last time.  Sticks with the
+         * member it chose last time unless another is clearly better.
          */
         const Member* getMemberToSyncTo();
+        /** notes the rate we fetched host's oplog at while there was a backlog to fetch */
+        void noteSyncSourceThroughput(const string& host, double bytesPerSec);
+        /** why getMemberToSyncTo chose the member it last chose, for replSetGetStatus */
+        string syncSourceReason() const;
         void veto(const string& host, unsigned secs=10);
         bool gotForceSync();
         void goStale(const Member* m, const BSONObj& o);
@@ -551,6 +557,7 @@ namespace mongo {
     private:
         bool _syncDoInitialSync_clone(Cloner &cloner, const char *master,
                                       const list<string>& dbs, bool dataPass);
+        bool _syncDoInitialSync_copyDataFiles(OplogReader& r, BSONObj& lastOpOut);
         bool _syncDoInitialSync_applyToHead( replset::SyncTail& syncer, OplogReader* r ,
                                              const Member* source, const BSONObj& lastOp,
                                              BSONObj& minValidOut);
@@ -561,8 +568,18 @@ namespace mongo {
         unsigned _syncRollback(OplogReader& r);
         void syncFixUp(HowToFixUp& h, OplogReader& r);
 
+        double syncSourceScore(const Member* m, const OpTime& freshest) const;
+        void noteSyncSourceChoice(const string& host, const string& reason);
+
         // keep a list of hosts that we've tried recently that didn't work
         map<string,time_t> _veto;
+        // guards the three below, which getMemberToSyncTo scores candidates with and explains
+        // its choice by
+        mutable mongo::mutex _syncSourceStatsMutex;
+        // recent oplog fetch rate from each member we've synced from, in bytes per second
+        map<string,double> _syncSourceThroughput;
+        string _lastSyncSource;
+        string _syncSourceReason;
         // persistent pool of worker threads for writing ops to the databases
         threadpool::ThreadPool _writerPool;
         // persistent pool of worker threads for prefetching
@@ -729,6 +746,9 @@ namespace mongo {
      */
     void replLocalAuth();
 
+    /** where the data file named file of database db lives under the dbpath */
+    std::string replDataFilePath(const std::string& db, const std::string& file);
+
     /** inlines ----------------- */
 
     inline Member::Member(HostAndPort h, unsigned ord, const ReplSetConfig::MemberCfg *c, bool self) :
@@ -28,6 +28,8 @@
 
 #include "mongo/pch.h"
 
+#include <boost/filesystem/operations.hpp>
+
 #include "mongo/db/repl/rs.h"
 
 #include "mongo/db/auth/authorization_manager.h"
@@ -41,6 +43,9 @@
 #include "mongo/bson/optime.h"
 #include "mongo/db/repl/replication_server_status.h"  // replSettings
 #include "mongo/db/repl/rs_sync.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/file.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -50,6 +55,21 @@ namespace mongo {
 
     void dropAllDatabasesExceptLocal();
 
+    // The collections of a database initial sync clones at once, each over its own connection
+    // to the sync source.  Their _id indexes are built while the others are still copying.
+    MONGO_EXPORT_SERVER_PARAMETER(initialSyncCloneThreads, int, 4);
+
+    // Copy the data files of a secondary sync source while it is fsync locked, instead of
+    // cloning its documents and rebuilding their indexes.  The source takes no writes, and so
+    // falls behind, until the copy is done.
+    MONGO_EXPORT_SERVER_PARAMETER(initialSyncCopyDataFiles, bool, false);
+
+    // How getMemberToSyncTo weighs a candidate sync source's lag behind the freshest member, in
+    // milliseconds of ping per second of lag, and how much better, in percent, another candidate
+    // must score than the member we chose last time for us to switch to it.
+    MONGO_EXPORT_SERVER_PARAMETER(syncSourceLagPenaltyMillis, int, 50);
+    MONGO_EXPORT_SERVER_PARAMETER(syncSourceChangeMarginPercent, int, 20);
+
     // add try/catch with sleep
 
     void isyncassert(const string& msg, bool expr) {
@@ -108,6 +128,7 @@ namespace mongo {
             options.mayBeInterrupted = false;
             options.syncData = dataPass;
             options.syncIndexes = ! dataPass;
+            options.cloneThreads = initialSyncCloneThreads;
 
             if (!cloner.go(master, options, err, &errCode)) {
                 sethbmsg(str::stream() << "initial sync: error while "
@@ -149,6 +170,7 @@ namespace mongo {
             Member* target = _forceSyncTarget;
             _forceSyncTarget = 0;
             sethbmsg( str::stream() << "syncing to: " << target->fullName() << " by request", 0);
+            noteSyncSourceChoice(target->fullName(), "by request");
             return target;
         }
 
@@ -165,12 +187,14 @@ namespace mongo {
 
             // If we are only allowed to sync from the primary, return that
             if (!_cfg->chainingAllowed()) {
+                if (primary)
+                    noteSyncSourceChoice(primary->fullName(), "primary, chaining is not allowed");
                 // Returns NULL if we cannot reach the primary
                 return primary;
             }
         }
 
-        // find the member with the lowest ping time that has more data than me
+        // find the member with the lowest score that has more data than me
 
         // Find primary's oplog time. Reject sync candidates that are more than
         // maxSyncSourceLagSecs seconds behind.
@@ -189,8 +213,23 @@ namespace mongo {
 
         OpTime oldestSyncOpTime(primaryOpTime.getSecs() - maxSyncSourceLagSecs, 0);
 
+        // the freshest member, that the score charges the others for lagging behind
+        OpTime freshest;
+        for (Member *m = _members.head(); m; m = m->next()) {
+            if (m->syncable() && m->hbinfo().opTime > freshest)
+                freshest = m->hbinfo().opTime;
+        }
+
         Member *closest = 0;
+        double closestScore = 0;
+        Member *previous = 0;
+        double previousScore = 0;
         time_t now = 0;
+        string lastSyncSource;
+        {
+            mongo::mutex::scoped_lock lk(_syncSourceStatsMutex);
+            lastSyncSource = _lastSyncSource;
+        }
 
         // Make two attempts.  The first attempt, we ignore those nodes with
         // slave delay higher than our own.  The second attempt includes such
@@ -211,11 +250,6 @@ namespace mongo {
                         continue;
                 }
 
-                // omit nodes that are more latent than anything we've already considered
-                if (closest &&
-                    (m->hbinfo().ping > closest->hbinfo().ping))
-                    continue;
-
                 if (attempts == 0 &&
                     (myConfig().slaveDelay < m->config().slaveDelay || m->config().hidden)) {
                     continue; // skip this one in the first attempt
@@ -240,8 +274,16 @@ namespace mongo {
                     _veto.erase(vetoed);
                     // fall through, this is a valid candidate now
                 }
-                // This candidate has passed all tests; set 'closest'
-                closest = m;
+                // This candidate has passed all tests; set 'closest' if it scores best
+                double score = syncSourceScore(m, freshest);
+                if (m->fullName() == lastSyncSource) {
+                    previous = m;
+                    previousScore = score;
+                }
+                if (!closest || score < closestScore) {
+                    closest = m;
+                    closestScore = score;
+                }
             }
             if (closest) break; // no need for second attempt
         }
@@ -250,16 +292,184 @@ namespace mongo {
             return NULL;
         }
 
+        // don't hop between members that score about the same, allowing a few milliseconds for
+        // pings jittering on a fast network
+        const Member* best = closest;
+        const double bestScore = closestScore;
+        if (previous && previous != closest &&
+            previousScore <= std::max(closestScore * (100 + syncSourceChangeMarginPercent) / 100,
+                                      closestScore + 5)) {
+            closest = previous;
+            closestScore = previousScore;
+        }
+
+        unsigned lagSecs = freshest.getSecs() -
+                           std::min(freshest.getSecs(), closest->hbinfo().opTime.getSecs());
+        str::stream reason;
+        reason << "score " << closestScore << " (ping " << closest->hbinfo().ping << "ms, "
+               << lagSecs << "s behind)";
+        if (closest != best) {
+            reason << ", kept as within " << syncSourceChangeMarginPercent << "% of "
+                   << best->fullName() << "'s " << bestScore;
+        }
+
         sethbmsg( str::stream() << "syncing to: " << closest->fullName(), 0);
+        noteSyncSourceChoice(closest->fullName(), reason);
 
         return closest;
     }
 
+    double ReplSetImpl::syncSourceScore(const Member* m, const OpTime& freshest) const {
+        double score = m->hbinfo().ping;
+
+        unsigned secs = m->hbinfo().opTime.getSecs();
+        if (secs < freshest.getSecs())
+            score += static_cast<double>(freshest.getSecs() - secs) * syncSourceLagPenaltyMillis;
+
+        // the milliseconds a megabyte of oplog took to fetch from it, if we've synced from it
+        mongo::mutex::scoped_lock lk(_syncSourceStatsMutex);
+        map<string,double>::const_iterator i = _syncSourceThroughput.find(m->fullName());
+        if (i != _syncSourceThroughput.end() && i->second > 0)
+            score += 1000.0 * 1024 * 1024 / i->second;
+        return score;
+    }
+
+    void ReplSetImpl::noteSyncSourceChoice(const string& host, const string& reason) {
+        mongo::mutex::scoped_lock lk(_syncSourceStatsMutex);
+        _lastSyncSource = host;
+        _syncSourceReason = reason;
+    }
+
+    void ReplSetImpl::noteSyncSourceThroughput(const string& host, double bytesPerSec) {
+        mongo::mutex::scoped_lock lk(_syncSourceStatsMutex);
+        map<string,double>::iterator i = _syncSourceThroughput.find(host);
+        if (i == _syncSourceThroughput.end())
+            _syncSourceThroughput[host] = bytesPerSec;
+        else
+            i->second = 0.75 * i->second + 0.25 * bytesPerSec;
+    }
+
+    string ReplSetImpl::syncSourceReason() const {
+        mongo::mutex::scoped_lock lk(_syncSourceStatsMutex);
+        return _syncSourceReason;
+    }
+
     void ReplSetImpl::veto(const string& host, const unsigned secs) {
         lock lk(this);
         _veto[host] = time(0)+secs;
     }
 
+    namespace {
+        /** unlocks the sync source we fsync locked to copy its files, however the copy ends */
+        class FsyncUnlocker {
+        public:
+            explicit FsyncUnlocker(DBClientBase* conn) : _conn(conn) { }
+            ~FsyncUnlocker() {
+                try {
+                    _conn->findOne("admin.$cmd.sys.unlock", BSONObj());
+                }
+                catch (const DBException& e) {
+                    warning() << "replSet initial sync couldn't fsync unlock the sync source: "
+                              << e.toString() << rsLog;
+                }
+            }
+        private:
+            DBClientBase* _conn;
+        };
+
+        const int copyDataFileChunk = 8 * 1024 * 1024;
+
+        void copyDataFile(DBClientBase* conn, const string& db, const string& file,
+                          long long size) {
+            string path = replDataFilePath(db, file);
+            boost::filesystem::create_directories(boost::filesystem::path(path).parent_path());
+
+            File f;
+            f.open(path.c_str());
+            uassert(17290, str::stream() << "couldn't open " << path, f.is_open() && !f.bad());
+
+            long long offset = 0;
+            while (offset < size) {
+                BSONObj res;
+                uassert(17291, str::stream() << "couldn't copy " << file << ": " << res,
+                        conn->runCommand("admin",
+                                         BSON("replSetCopyDataFile" << db << "file" << file <<
+                                              "offset" << offset <<
+                                              "length" << copyDataFileChunk),
+                                         res));
+                int n = res["length"].numberInt();
+                if (n <= 0)
+                    break;
+
+                int compressedLen;
+                const char* compressed = res["data"].binData(compressedLen);
+                string data;
+                uassert(17292, str::stream() << "couldn't uncompress a piece of " << file,
+                        uncompress(compressed, compressedLen, &data) &&
+                        data.size() == static_cast<size_t>(n));
+
+                f.write(offset, data.data(), n);
+                uassert(17293, str::stream() << "couldn't write " << path, !f.bad());
+                offset += n;
+            }
+            f.fsync();
+        }
+    }
+
+    /**
+     * Copies the data files of every database but local from the sync source, which we hold
+     * fsync locked for the duration so that the files are consistent with some point of its
+     * oplog.  The databases here must already be dropped.
+     *
+     * @param lastOpOut populated by this function. The sync source's last op while locked; the
+     *                  copy holds every op up to it, so oplog application starts there.
+     * @return if the copy succeeded.  If it didn't, nothing is left behind.
+     */
+    bool ReplSetImpl::_syncDoInitialSync_copyDataFiles(OplogReader& r, BSONObj& lastOpOut) {
+        DBClientBase* conn = r.conn();
+
+        BSONObj info;
+        if (!conn->runCommand("admin", BSON("fsync" << 1 << "lock" << true), info)) {
+            sethbmsg(str::stream() << "initial sync couldn't fsync lock the sync source: "
+                                   << info, 0);
+            return false;
+        }
+
+        vector<string> copied;
+        try {
+            FsyncUnlocker unlocker(conn);
+
+            lastOpOut = r.getLastOp(rsoplog);
+            isyncassert("getLastOp is empty ", !lastOpOut.isEmpty());
+
+            BSONObj res;
+            uassert(17294, str::stream() << "couldn't list the sync source's data files: " << res,
+                    conn->runCommand("admin", BSON("replSetListDataFiles" << 1), res));
+
+            BSONObjIterator i(res["files"].Obj());
+            while (i.more()) {
+                BSONObj file = i.next().Obj();
+                string db = file["db"].String();
+                string name = file["file"].String();
+                long long size = file["size"].numberLong();
+
+                log() << "replSet initial sync copying " << name << ' ' << size / (1024 * 1024)
+                      << "MB" << rsLog;
+                copied.push_back(replDataFilePath(db, name));
+                copyDataFile(conn, db, name, size);
+            }
+        }
+        catch (const DBException& e) {
+            log() << "replSet initial sync failed copying data files: " << e.toString() << rsLog;
+            for (vector<string>::const_iterator i = copied.begin(); i != copied.end(); ++i) {
+                boost::system::error_code ec;
+                boost::filesystem::remove(*i, ec);
+            }
+            return false;
+        }
+        return true;
+    }
+
     /**
      * Replays the sync target's oplog from lastOp to the latest op on the sync target.
      *
@@ -354,6 +564,10 @@ namespace mongo {
      * three times: step 4, 6, and 8.  4 may involve refetching, 6 should not.  By the end of 6,
      * this member should have consistent data.  8 is "cosmetic," it is only to get this member
      * closer to the latest op time before it can transition to secondary state.
+     *
+     * With initialSyncCopyDataFiles set and a secondary to sync from, steps 2 through 7 are
+     * instead a copy of the source's data files, while it is fsync locked, and one application
+     * of the oplog from the op the source was locked at.
      */
     void ReplSetImpl::_syncDoInitialSync() {
         replset::InitialSync init(replset::BackgroundSync::get());
@@ -399,6 +613,31 @@ namespace mongo {
             init.oplogApplication(lastOp, lastOp);
             return;
         }
+        else if (initialSyncCopyDataFiles && source->state().secondary()) {
+            // Add field to minvalid document to tell us to restart initial sync if we crash
+            theReplSet->setInitialSyncFlag();
+
+            sethbmsg("initial sync drop all databases", 0);
+            dropAllDatabasesExceptLocal();
+
+            sethbmsg("initial sync copy data files", 0);
+            if (!_syncDoInitialSync_copyDataFiles(r, lastOp)) {
+                veto(source->fullName(), 600);
+                sleepsecs(300);
+                return;
+            }
+
+            // The files come with their indexes built and hold every op up to lastOp, so one
+            // pass over the oplog since makes the data consistent.
+            sethbmsg("initial sync data copy, starting syncup",0);
+
+            log() << "oplog sync from the copied data files" << endl;
+            if (!_syncDoInitialSync_applyToHead(init, &r, source, lastOp, minValid)) {
+                return;
+            }
+
+            lastOp = minValid;
+        }
         else {
             // Add field to minvalid document to tell us to restart initial sync if we crash
             theReplSet->setInitialSyncFlag();
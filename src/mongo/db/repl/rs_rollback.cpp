@@ -29,6 +29,8 @@
 
 #include "mongo/pch.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/client.h"
@@ -38,7 +40,10 @@
 #include "mongo/db/ops/update_lifecycle_impl.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/thread_name.h"
 
 /* Scenarios
 
@@ -320,37 +325,169 @@ namespace mongo {
         bson::bo goodVersionOfObject;
     };
 
+    // The documents rollback asks the sync source for in one query, and the collections it
+    // refetches documents from at once, each but the first over a connection of its own.
+    MONGO_EXPORT_SERVER_PARAMETER(rollbackRefetchBatchSize, int, 1000);
+    MONGO_EXPORT_SERVER_PARAMETER(rollbackRefetchThreads, int, 4);
+
+    typedef list< pair<DocID,bo> > GoodVersions;
+
+    /** the documents of one collection to refetch, and the sync source's versions of them */
+    struct RefetchColl {
+        vector<DocID> docs;
+        GoodVersions goodVersions;
+    };
+
+    /** shared by the threads refetching, each taking the next collection not yet taken */
+    struct Refetch {
+        Refetch() : m("rollbackRefetch"), next(0), total(0), fetched(0), totSize(0), errCode(0) { }
+        mongo::mutex m;
+        vector<RefetchColl> colls;
+        size_t next;
+        unsigned long long total;
+        unsigned long long fetched;
+        unsigned long long totSize;
+        string errmsg;
+        int errCode;
+    };
+
+    /** refetches a batch of documents of one collection with a single $in query on _id.  the
+        documents the sync source doesn't have get an empty good version, to be deleted.
+        @return the size of the documents fetched
+    */
+    static unsigned long long refetchBatch(DBClientBase* conn, const vector<DocID>& batch,
+                                           GoodVersions& goodVersions) {
+        const char* ns = batch.front().ns;
+        BSONArrayBuilder ids;
+        for( vector<DocID>::const_iterator i = batch.begin(); i != batch.end(); i++ ) {
+            verify( !i->_id.eoo() );
+            ids.append(i->_id);
+        }
+
+        auto_ptr<DBClientCursor> c = conn->query(ns, BSON("_id" << BSON("$in" << ids.arr())),
+                                                 0, 0, NULL, QueryOption_SlaveOk);
+        uassert(17295, str::stream() << "replSet rollback couldn't query " << ns, c.get());
+
+        unsigned long long size = 0;
+        map<BSONObj, BSONObj, BSONObjCmp> found;
+        while( c->more() ) {
+            bo good = c->nextSafe().getOwned();
+            size += good.objsize();
+            found[good["_id"].wrap()] = good;
+        }
+
+        for( vector<DocID>::const_iterator i = batch.begin(); i != batch.end(); i++ ) {
+            map<BSONObj, BSONObj, BSONObjCmp>::const_iterator f = found.find(i->_id.wrap());
+            goodVersions.push_back(pair<DocID,bo>(*i, f == found.end() ? bo() : f->second));
+        }
+        return size;
+    }
+
+    static void refetchColls(DBClientBase* conn, Refetch* state, bool reportProgress) {
+        const size_t batchSize = std::max(rollbackRefetchBatchSize, 1);
+        while( true ) {
+            RefetchColl* coll;
+            {
+                mongo::mutex::scoped_lock lk(state->m);
+                if( state->next == state->colls.size() || !state->errmsg.empty() )
+                    return;
+                coll = &state->colls[state->next++];
+            }
+
+            const vector<DocID>& docs = coll->docs;
+            for( size_t i = 0; i < docs.size(); i += batchSize ) {
+                vector<DocID> batch(docs.begin() + i,
+                                    docs.begin() + std::min(i + batchSize, docs.size()));
+                unsigned long long size = refetchBatch(conn, batch, coll->goodVersions);
+
+                unsigned long long fetched;
+                {
+                    mongo::mutex::scoped_lock lk(state->m);
+                    state->totSize += size;
+                    uassert( 13410, "replSet too much data to roll back",
+                             state->totSize < 300 * 1024 * 1024 );
+                    if( !state->errmsg.empty() )
+                        return;
+                    state->fetched += batch.size();
+                    fetched = state->fetched;
+                }
+                if( reportProgress ) {
+                    theReplSet->sethbmsg(str::stream() << "rollback 3 refetched " << fetched
+                                                       << '/' << state->total, 1);
+                }
+            }
+            log() << "replSet rollback refetched " << docs.size() << " documents of "
+                  << docs.front().ns << rsLog;
+        }
+    }
+
+    static void refetchThread(const string& host, Refetch* state) {
+        setThreadName("rollbackRefetch");
+        try {
+            DBClientConnection conn;
+            string errmsg;
+            uassert(17296, str::stream() << "replSet rollback couldn't connect to " << host
+                                         << ": " << errmsg,
+                    conn.connect(host, errmsg));
+            uassert(17297, str::stream() << "replSet rollback couldn't authenticate to " << host,
+                    replAuthenticate(&conn));
+            refetchColls(&conn, state, false);
+        }
+        catch(DBException& e) {
+            mongo::mutex::scoped_lock lk(state->m);
+            if( state->errmsg.empty() ) {
+                state->errmsg = e.toString();
+                state->errCode = e.getCode();
+            }
+        }
+    }
+
     void ReplSetImpl::syncFixUp(HowToFixUp& h, OplogReader& r) {
         DBClientConnection *them = r.conn();
 
         // fetch all first so we needn't handle interruption in a fancy way
 
-        unsigned long long totSize = 0;
-
-        list< pair<DocID,bo> > goodVersions;
+        GoodVersions goodVersions;
 
         bo newMinValid;
 
-        /* fetch all the goodVersions of each document from current primary */
-        DocID d;
-        unsigned long long n = 0;
-        try {
-            for( set<DocID>::iterator i = h.toRefetch.begin(); i != h.toRefetch.end(); i++ ) {
-                d = *i;
-
-                verify( !d._id.eoo() );
+        /* fetch all the goodVersions of each document from current primary, in batches a
+           collection at a time, several collections at once */
+        Refetch state;
+        state.total = h.toRefetch.size();
+        for( set<DocID>::iterator i = h.toRefetch.begin(); i != h.toRefetch.end(); i++ ) {
+            if( state.colls.empty() || strcmp(state.colls.back().docs.front().ns, i->ns) != 0 )
+                state.colls.push_back(RefetchColl());
+            state.colls.back().docs.push_back(*i);
+        }
 
-                {
-                    /* TODO : slow.  lots of round trips. */
-                    n++;
-                    bo good= them->findOne(d.ns, d._id.wrap(), NULL, QueryOption_SlaveOk).getOwned();
-                    totSize += good.objsize();
-                    uassert( 13410, "replSet too much data to roll back", totSize < 300 * 1024 * 1024 );
-
-                    // note good might be eoo, indicating we should delete it
-                    goodVersions.push_back(pair<DocID,bo>(d,good));
+        try {
+            const size_t nThreads =
+                std::min(static_cast<size_t>(std::max(rollbackRefetchThreads, 1)),
+                         state.colls.size());
+            boost::thread_group threads;
+            for( size_t i = 1; i < nThreads; i++ ) {
+                threads.create_thread(boost::bind(&refetchThread, them->getServerAddress(),
+                                                  &state));
+            }
+            try {
+                refetchColls(them, &state, true);
+            }
+            catch(DBException& e) {
+                mongo::mutex::scoped_lock lk(state.m);
+                if( state.errmsg.empty() ) {
+                    state.errmsg = e.toString();
+                    state.errCode = e.getCode();
                 }
             }
+            threads.join_all();
+            if( !state.errmsg.empty() )
+                uasserted(state.errCode, state.errmsg);
+
+            // note a good version might be eoo, indicating we should delete it
+            for( vector<RefetchColl>::iterator i = state.colls.begin(); i != state.colls.end(); i++ )
+                goodVersions.splice(goodVersions.end(), i->goodVersions);
+
             newMinValid = r.getLastOp(rsoplog);
             if( newMinValid.isEmpty() ) {
                 sethbmsg("rollback error newMinValid empty?");
@@ -359,7 +496,7 @@ namespace mongo {
         }
         catch(DBException& e) {
             sethbmsg(str::stream() << "rollback re-get objects: " << e.toString(),0);
-            log() << "rollback couldn't re-get ns:" << d.ns << " _id:" << d._id << ' ' << n << '/' << h.toRefetch.size() << rsLog;
+            log() << "rollback couldn't re-get objects " << state.fetched << '/' << state.total << rsLog;
             throw e;
         }
 
@@ -459,7 +596,7 @@ namespace mongo {
         map<string,shared_ptr<Helpers::RemoveSaver> > removeSavers;
 
         unsigned deletes = 0, updates = 0;
-        for( list<pair<DocID,bo> >::iterator i = goodVersions.begin(); i != goodVersions.end(); i++ ) {
+        for( GoodVersions::iterator i = goodVersions.begin(); i != goodVersions.end(); i++ ) {
             const DocID& d = i->first;
             bo pattern = d._id.wrap(); // { _id : ... }
             try {
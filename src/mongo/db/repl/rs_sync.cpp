@@ -37,14 +37,19 @@
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync.h"
 #include "mongo/db/d_concurrency.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/keypattern.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/prefetch.h"
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/rs_sync.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/db/structure/collection.h"
 #include "mongo/util/fail_point_service.h"
+#include "mongo/util/trace_points.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/base/counter.h"
@@ -78,6 +83,63 @@ namespace replset {
                                                                 &opsAppliedStats );
 
 
+    // Spread the inserts, updates and deletes on a collection across the writer threads by the
+    // _id of the document, rather than giving all the ops on a collection to one writer.
+    MONGO_EXPORT_SERVER_PARAMETER(replWriterPartitionById, bool, true);
+
+    // The most ops in a batch.  Readers wait for the whole of a batch to be applied, so a lower
+    // limit bounds their wait at the cost of fewer ops for the writers to share.
+    MONGO_EXPORT_SERVER_PARAMETER(replBatchLimitOperations, int, 5000);
+
+    namespace {
+        /**
+         * Whether the ops on ns can be given to writers by _id.  The ops on a document stay in
+         * order, but those on different documents may then be applied in any order.  That is
+         * not so for a capped collection, whose natural order is its insertion order, or with a
+         * unique index other than _id, where a key may move from one document to another.
+         * Indexes are built and collections created by commands in batches of their own, so
+         * they do not change during the batch.
+         */
+        bool canPartitionById(const char* ns) {
+            try {
+                Client::ReadContext ctx(ns);
+                Collection* collection = ctx.ctx().db()->getCollection(ns);
+                if (!collection) {
+                    // Created by an insert of this batch, with just the _id index.
+                    return true;
+                }
+                if (collection->details()->isCapped()) {
+                    return false;
+                }
+                IndexCatalog* indexCatalog = collection->getIndexCatalog();
+                for (int i = 0; i < indexCatalog->numIndexesTotal(); ++i) {
+                    IndexDescriptor* desc = indexCatalog->getDescriptor(i);
+                    if (desc->unique() && !KeyPattern::isIdKeyPattern(desc->keyPattern())) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            catch (const DBException& e) {
+                LOG(2) << "not partitioning the ops on " << ns << " by _id: " << e.what() << endl;
+                return false;
+            }
+        }
+
+        /** the _id of the document an insert, update or delete is on; EOO otherwise */
+        BSONElement idOfOp(const BSONObj& op) {
+            switch (op["op"].valuestrsafe()[0]) {
+            case 'i':
+            case 'd':
+                return op["o"]["_id"];
+            case 'u':
+                return op["o2"]["_id"];
+            default:
+                return BSONElement();
+            }
+        }
+    }
+
     SyncTail::SyncTail(BackgroundSyncInterface *q) :
         Sync(""), oplogVersion(0), _networkQueue(q)
     {}
@@ -150,6 +212,7 @@ namespace replset {
     // This free function is used by the writer threads to apply each op
     void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
         initializeWriterThread();
+        MONGO_TRACE_SCOPE("repl", "apply writer ops");
 
         // convert update operations only for 2.2.1 or greater, because we need guaranteed
         // idempotent operations for this to work.  See SERVER-6825
@@ -173,6 +236,7 @@ namespace replset {
     // This free function is used by the initial sync writer threads to apply each op
     void multiInitialSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
         initializeWriterThread();
+        MONGO_TRACE_SCOPE("repl", "apply writer ops");
         for (std::vector<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
@@ -224,15 +288,10 @@ namespace replset {
         }
     }
 
-    // Doles out all the work to the reader pool threads and waits for them to complete
-    void SyncTail::prefetchOps(const std::deque<BSONObj>& ops) {
-        threadpool::ThreadPool& prefetcherPool = theReplSet->getPrefetchPool();
-        for (std::deque<BSONObj>::const_iterator it = ops.begin();
-             it != ops.end();
-             ++it) {
-            prefetcherPool.schedule(&prefetchOp, *it);
-        }
-        prefetcherPool.join();
+    // Gives an op to the reader pool threads as soon as it is added to a batch, so the pages it
+    // needs are read while the rest of the batch is still arriving
+    void SyncTail::prefetchOpAsync(const BSONObj& op) {
+        theReplSet->getPrefetchPool().schedule(&prefetchOp, op);
     }
     
     // Doles out all the work to the writer pool threads and waits for them to complete
@@ -240,21 +299,28 @@ namespace replset {
                                      MultiSyncApplyFunc applyFunc) {
         ThreadPool& writerPool = theReplSet->getWriterPool();
         TimerHolder timer(&applyBatchStats);
+        std::vector<threadpool::Task> tasks;
         for (std::vector< std::vector<BSONObj> >::const_iterator it = writerVectors.begin();
              it != writerVectors.end();
              ++it) {
             if (!it->empty()) {
-                writerPool.schedule(applyFunc, boost::cref(*it), this);
+                tasks.push_back(boost::bind(applyFunc, boost::cref(*it), this));
             }
         }
+        writerPool.scheduleBatch(tasks);
         writerPool.join();
     }
 
     // Doles out all the work to the writer pool threads and waits for them to complete
     void SyncTail::multiApply( std::deque<BSONObj>& ops, MultiSyncApplyFunc applyFunc ) {
+        MONGO_TRACE_SCOPE("repl", "apply batch");
 
-        // Use a ThreadPool to prefetch all the operations in a batch.
-        prefetchOps(ops);
+        // Wait for the reader pool threads to finish prefetching the ops of the batch, which
+        // they were given as the batch was filled.
+        {
+            MONGO_TRACE_SCOPE("repl", "wait for prefetch");
+            theReplSet->getPrefetchPool().join();
+        }
         
         std::vector< std::vector<BSONObj> > writerVectors(theReplSet->replWriterThreadCount);
         fillWriterVectors(ops, &writerVectors);
@@ -273,6 +339,10 @@ namespace replset {
 
     void SyncTail::fillWriterVectors(const std::deque<BSONObj>& ops, 
                                               std::vector< std::vector<BSONObj> >* writerVectors) {
+        const bool partitionById = replWriterPartitionById;
+        // ns -> whether its ops are given to writers by _id
+        std::map<std::string, bool> partitionedNamespaces;
+
         for (std::deque<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
@@ -283,6 +353,19 @@ namespace replset {
             uint32_t hash = 0;
             MurmurHash3_x86_32( ns, len, 0, &hash);
 
+            const BSONElement id = partitionById ? idOfOp(*it) : BSONElement();
+            if (!id.eoo()) {
+                std::map<std::string, bool>::iterator partitioned =
+                    partitionedNamespaces.find(ns);
+                if (partitioned == partitionedNamespaces.end()) {
+                    partitioned = partitionedNamespaces.insert(
+                        std::make_pair(std::string(ns), canPartitionById(ns))).first;
+                }
+                if (partitioned->second) {
+                    MurmurHash3_x86_32(id.value(), id.valuesize(), hash, &hash);
+                }
+            }
+
             (*writerVectors)[hash % writerVectors->size()].push_back(*it);
         }
     }
@@ -322,7 +405,7 @@ namespace replset {
                 if (!ops.empty()) {
                     if (now > replBatchLimitSeconds)
                         break;
-                    if (ops.getDeque().size() > replBatchLimitOperations)
+                    if (ops.getDeque().size() > static_cast<size_t>(replBatchLimitOperations))
                         break;
                 }
             }
@@ -408,7 +491,7 @@ namespace replset {
                 if (!ops.empty()) {
                     if (now > replBatchLimitSeconds)
                         break;
-                    if (ops.getDeque().size() > replBatchLimitOperations)
+                    if (ops.getDeque().size() > static_cast<size_t>(replBatchLimitOperations))
                         break;
                 }
                 // occasionally check some things
@@ -530,6 +613,7 @@ namespace replset {
                 // apply commands one-at-a-time
                 ops->push_back(op);
                 _networkQueue->consume();
+                prefetchOpAsync(op);
             }
 
             // otherwise, apply what we have so far and come back for the command
@@ -561,12 +645,14 @@ namespace replset {
         // Copy the op to the deque and remove it from the bgsync queue.
         ops->push_back(op);
         _networkQueue->consume();
+        prefetchOpAsync(op);
 
         // Go back for more ops
         return false;
     }
 
     void SyncTail::applyOpsToOplog(std::deque<BSONObj>* ops) {
+        MONGO_TRACE_SCOPE("repl", "write batch to oplog");
         {
             Lock::DBWrite lk("local");
             while (!ops->empty()) {
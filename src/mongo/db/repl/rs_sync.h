@@ -111,9 +111,9 @@ namespace replset {
         // This works out to be 100 MB (64 bit) or 50 MB (32 bit)
         static const unsigned int replBatchLimitBytes = dur::UncommittedBytesLimit;
         static const int replBatchLimitSeconds = 1;
-        static const unsigned int replBatchLimitOperations = 5000;
 
-        // Prefetch and write a deque of operations, using the supplied function.
+        // Write a deque of operations, using the supplied function, once the ops filled in by
+        // tryPopAndWaitForMore are prefetched.
         // Initial Sync and Sync Tail each use a different function.
         void multiApply(std::deque<BSONObj>& ops, MultiSyncApplyFunc applyFunc);
 
@@ -123,8 +123,8 @@ namespace replset {
     private:
         BackgroundSyncInterface* _networkQueue;
 
-        // Doles out all the work to the reader pool threads and waits for them to complete
-        void prefetchOps(const std::deque<BSONObj>& ops);
+        // Gives an op to the reader pool threads to prefetch; multiApply waits for them
+        void prefetchOpAsync(const BSONObj& op);
         // Used by the thread pool readers to prefetch an op
         static void prefetchOp(const BSONObj& op);
 
@@ -73,6 +73,18 @@ namespace mongo {
             BSONObj obj;
         };
 
+        /** enters an op a thread waits for in _waitingFor for as long as it waits, which must
+            be with _mutex held */
+        class WaitingFor : boost::noncopyable {
+        public:
+            WaitingFor( multiset<OpTime>& waitingFor, const OpTime& op ) :
+                _waitingFor( waitingFor ), _i( waitingFor.insert( op ) ) { }
+            ~WaitingFor() { _waitingFor.erase( _i ); }
+        private:
+            multiset<OpTime>& _waitingFor;
+            multiset<OpTime>::iterator _i;
+        };
+
         SlaveTracking() : _mutex("SlaveTracking") {
             _dirty = false;
             _started = false;
@@ -153,18 +165,47 @@ namespace mongo {
                     go();
                 }
 
-                _threadsWaitingForReplication.notify_all();
+                // only wake the waiters if this could satisfy one of them, the oldest at least
+                if ( !_waitingFor.empty() && *_waitingFor.begin() <= last )
+                    _threadsWaitingForReplication.notify_all();
             }
             return true;
         }
 
         bool opReplicatedEnough( OpTime op , BSONElement w ) {
+            scoped_lock mylk(_mutex);
+            return _opReplicatedEnough_locked( op, w );
+        }
+
+        /**
+         * Waits up to millis for op to replicate enough for w, waking whenever a slave's
+         * position moves to or past the oldest op waited for.
+         * @return true if op has made it
+         */
+        bool waitForOpReplicatedEnough( OpTime op , BSONElement w , int millis ) {
+            scoped_lock mylk(_mutex);
+            if ( _opReplicatedEnough_locked( op, w ) )
+                return true;
+
+            WaitingFor waiting( _waitingFor, op );
+            Date_t deadline = jsTime() + millis;
+            while ( !_opReplicatedEnough_locked( op, w ) ) {
+                Date_t now = jsTime();
+                if ( now >= deadline )
+                    return false;
+                _threadsWaitingForReplication.timed_wait(
+                        mylk.boost(), boost::posix_time::milliseconds( deadline - now ) );
+            }
+            return true;
+        }
+
+        bool _opReplicatedEnough_locked( OpTime op , BSONElement w ) {
             RARELY {
                 REPLDEBUG( "looking for : " << op << " w=" << w );
             }
 
             if (w.isNumber()) {
-                return replicatedToNum(op, w.numberInt());
+                return _replicatedToNum_locked(op, w.numberInt());
             }
 
             uassert( 16250 , "w has to be a string or a number" , w.type() == String );
@@ -177,7 +218,7 @@ namespace mongo {
             if (wStr == "majority") {
                 // use the entire set, including arbiters, to prevent writing
                 // to a majority of the set but not a majority of voters
-                return replicatedToNum(op, theReplSet->config().getMajority());
+                return _replicatedToNum_locked(op, theReplSet->config().getMajority());
             }
 
             map<string,ReplSetConfig::TagRule*>::const_iterator it = theReplSet->config().rules.find(wStr);
@@ -188,13 +229,17 @@ namespace mongo {
         }
 
         bool replicatedToNum(OpTime& op, int w) {
+            scoped_lock mylk(_mutex);
+            return _replicatedToNum_locked( op, w );
+        }
+
+        bool _replicatedToNum_locked(OpTime& op, int w) {
             massert( 16805, "replicatedToNum called but not master anymore", _isMaster() );
 
             if ( w <= 1 )
                 return true;
 
             w--; // now this is the # of slaves i need
-            scoped_lock mylk(_mutex);
             return _replicatedToNum_slaves_locked( op, w );
         }
 
@@ -213,6 +258,7 @@ namespace mongo {
             xt.sec += maxSecondsToWait;
             
             scoped_lock mylk(_mutex);
+            WaitingFor waiting( _waitingFor, op );
             while ( ! _replicatedToNum_slaves_locked( op, w ) ) {
                 if ( ! _threadsWaitingForReplication.timed_wait( mylk.boost() , xt ) ) {
                     massert(noLongerMasterAssertCode,
@@ -268,6 +314,7 @@ namespace mongo {
         bool _dirty;
         bool _started;
         bool _currentlyUpdatingCache; // this is not thread safe, but ok for our purposes
+        multiset<OpTime> _waitingFor; // the ops threads in waitForOpReplicatedEnough wait for
 
     } slaveTracking;
 
@@ -337,6 +384,10 @@ namespace mongo {
         return slaveTracking.replicatedToNum( op , w );
     }
 
+    bool waitForOpReplicatedEnough( OpTime op , BSONElement w , int millis ) {
+        return slaveTracking.waitForOpReplicatedEnough( op , w , millis );
+    }
+
     bool waitForReplication( OpTime op , int w , int maxSecondsToWait ) {
         return slaveTracking.waitForReplication( op, w, maxSecondsToWait );
     }
@@ -49,6 +49,10 @@ namespace mongo {
     bool opReplicatedEnough( OpTime op , int w );
     bool opReplicatedEnough( OpTime op , BSONElement w );
 
+    /** waits up to millis for op to make it to w servers, waking as soon as it has
+        @return true if it has */
+    bool waitForOpReplicatedEnough( OpTime op , BSONElement w , int millis );
+
     bool waitForReplication( OpTime op , int w , int maxSecondsToWait );
 
     std::vector<BSONObj> getHostsWrittenTo(OpTime& op);
@@ -58,6 +58,7 @@
 #include "mongo/util/bufreader.h"
 #include "mongo/util/goodies.h"
 #include "mongo/util/log.h"
+#include "mongo/util/memory_use.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -396,7 +397,7 @@ namespace mongo {
                 : _comp(comp)
                 , _settings(settings)
                 , _opts(opts)
-                , _memUsed(0)
+                , _memUsed(&sorterMemoryUse)
             { verify(_opts.limit == 0); }
 
             void add(const Key& key, const Value& val) {
@@ -469,7 +470,7 @@ namespace mongo {
             const Comparator _comp;
             const Settings _settings;
             SortOptions _opts;
-            size_t _memUsed;
+            TrackedBytes _memUsed;
             std::deque<Data> _data; // the "current" data
             std::vector<boost::shared_ptr<Iterator> > _iters; // data that has already been spilled
         };
@@ -535,7 +536,7 @@ namespace mongo {
                 : _comp(comp)
                 , _settings(settings)
                 , _opts(opts)
-                , _memUsed(0)
+                , _memUsed(&sorterMemoryUse)
                 , _haveCutoff(false)
                 , _worstCount(0)
                 , _medianCount(0)
@@ -738,7 +739,7 @@ namespace mongo {
             const Comparator _comp;
             const Settings _settings;
             SortOptions _opts;
-            size_t _memUsed;
+            TrackedBytes _memUsed;
             std::vector<Data> _data; // the "current" data. Organized as max-heap if size == limit.
             std::vector<boost::shared_ptr<Iterator> > _iters; // data that has already been spilled
 
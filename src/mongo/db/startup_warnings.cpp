@@ -162,6 +162,30 @@ namespace mongo {
                       << startupWarningsLog;
             }
         }
+
+        // Data files are shared file mappings, which the kernel never backs with huge pages, but
+        // the journal's private view is copy-on-write anonymous memory, which it does.  With
+        // "always", the kernel stalls writers to collapse and defragment those pages.
+        const char* const transparentHugePageFiles[] = {
+            "/sys/kernel/mm/transparent_hugepage/enabled",
+            "/sys/kernel/mm/transparent_hugepage/defrag"
+        };
+        for (size_t i = 0; i < sizeof(transparentHugePageFiles) / sizeof(char*); i++) {
+            std::ifstream f(transparentHugePageFiles[i], std::ifstream::in);
+            if (!f.is_open())
+                continue;
+
+            // the selected value is in brackets, e.g. "[always] madvise never"
+            std::string line;
+            std::getline(f, line);
+            if (line.find("[always]") != std::string::npos) {
+                log() << startupWarningsLog;
+                log() << "** WARNING: " << transparentHugePageFiles[i] << " is 'always'."
+                      << startupWarningsLog;
+                log() << "**          We suggest setting it to 'never'" << startupWarningsLog;
+                warned = true;
+            }
+        }
 #endif
 
 #if defined(RLIMIT_NPROC) && defined(RLIMIT_NOFILE)
@@ -114,11 +114,32 @@ namespace mongo {
         }
     }
 
+    void NetworkCounter::hitCompressed( long long compressedBytesIn,
+                                        long long uncompressedBytesIn,
+                                        long long compressedBytesOut,
+                                        long long uncompressedBytesOut ) {
+        if ( !compressedBytesIn && !compressedBytesOut )
+            return;
+
+        _lock.lock();
+        _compressedBytesIn += compressedBytesIn;
+        _uncompressedBytesIn += uncompressedBytesIn;
+        _compressedBytesOut += compressedBytesOut;
+        _uncompressedBytesOut += uncompressedBytesOut;
+        _lock.unlock();
+    }
+
     void NetworkCounter::append( BSONObjBuilder& b ) {
         _lock.lock();
         b.appendNumber( "bytesIn" , _bytesIn );
         b.appendNumber( "bytesOut" , _bytesOut );
         b.appendNumber( "numRequests" , _requests );
+        BSONObjBuilder compression( b.subobjStart( "compression" ) );
+        compression.appendNumber( "compressedBytesIn" , _compressedBytesIn );
+        compression.appendNumber( "uncompressedBytesIn" , _uncompressedBytesIn );
+        compression.appendNumber( "compressedBytesOut" , _compressedBytesOut );
+        compression.appendNumber( "uncompressedBytesOut" , _uncompressedBytesOut );
+        compression.done();
         _lock.unlock();
     }
 
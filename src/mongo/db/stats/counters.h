@@ -85,14 +85,24 @@ namespace mongo {
 
     class NetworkCounter {
     public:
-        NetworkCounter() : _bytesIn(0), _bytesOut(0), _requests(0), _overflows(0) {}
+        NetworkCounter() : _bytesIn(0), _bytesOut(0), _requests(0), _compressedBytesIn(0),
+            _uncompressedBytesIn(0), _compressedBytesOut(0), _uncompressedBytesOut(0),
+            _overflows(0) {}
         void hit( long long bytesIn , long long bytesOut );
+        /** bytes of compressed messages on the wire, and what they came to uncompressed */
+        void hitCompressed( long long compressedBytesIn, long long uncompressedBytesIn,
+                            long long compressedBytesOut, long long uncompressedBytesOut );
         void append( BSONObjBuilder& b );
     private:
         long long _bytesIn;
         long long _bytesOut;
         long long _requests;
 
+        long long _compressedBytesIn;
+        long long _uncompressedBytesIn;
+        long long _compressedBytesOut;
+        long long _uncompressedBytesOut;
+
         long long _overflows;
 
         SpinLock _lock;
@@ -0,0 +1,65 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include <vector>
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/memory_use.h"
+
+namespace mongo {
+
+    namespace {
+
+        /**
+         * The "memoryUse" serverStatus section: bytes held by each subsystem that counts them
+         * (see MemoryUse).
+         */
+        class MemoryUseSection : public ServerStatusSection {
+        public:
+            MemoryUseSection() : ServerStatusSection( "memoryUse" ) {}
+
+            virtual bool includeByDefault() const { return true; }
+
+            virtual BSONObj generateSection( const BSONElement& configElement ) const {
+                std::vector<const MemoryUse*> all;
+                MemoryUse::getAll( &all );
+
+                BSONObjBuilder b;
+                for ( size_t i = 0; i < all.size(); i++ ) {
+                    b.appendNumber( all[i]->name(), all[i]->bytes() );
+                }
+                return b.obj();
+            }
+        } memoryUseSection;
+
+    }  // namespace
+
+}  // namespace mongo
@@ -0,0 +1,93 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include <vector>
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/mutex_stats.h"
+
+namespace mongo {
+
+    namespace {
+
+        /**
+         * Turns contention profiling of the named internal mutexes on and off.
+         */
+        class MutexProfilingParameter : public ExportedServerParameter<bool> {
+        public:
+            MutexProfilingParameter( bool* value ) :
+                ExportedServerParameter<bool>( ServerParameterSet::getGlobal(),
+                                               "mutexContentionProfiling", value, true, true ) {}
+
+            virtual Status set( const bool& newValue ) {
+                Status status = ExportedServerParameter<bool>::set( newValue );
+                if ( status.isOK() )
+                    MutexStats::setEnabled( newValue );
+                return status;
+            }
+        };
+
+        bool mutexContentionProfiling = false;
+        MutexProfilingParameter mutexContentionProfilingParam( &mutexContentionProfiling );
+
+        /**
+         * Reports, for every mutex name locked while profiling was on, the acquisitions, the
+         * ones that had to wait and for how long, and the time the mutexes were held.
+         */
+        class MutexesSection : public ServerStatusSection {
+        public:
+            MutexesSection() : ServerStatusSection( "mutexes" ) {}
+            virtual bool includeByDefault() const { return false; }
+
+            BSONObj generateSection( const BSONElement& configElement ) const {
+                std::vector<MutexStats::Snapshot> all;
+                MutexStats::getAll( &all );
+
+                BSONObjBuilder b;
+                b.appendBool( "profiling", MutexStats::enabled() );
+                BSONObjBuilder byName( b.subobjStart( "byName" ) );
+                for ( size_t i = 0; i < all.size(); i++ ) {
+                    BSONObjBuilder m( byName.subobjStart( all[i].name ) );
+                    m.appendNumber( "acquired", static_cast<long long>( all[i].acquired ) );
+                    m.appendNumber( "contended", static_cast<long long>( all[i].contended ) );
+                    m.appendNumber( "waitMicros", static_cast<long long>( all[i].waitMicros ) );
+                    m.appendNumber( "heldMicros", static_cast<long long>( all[i].heldMicros ) );
+                    m.done();
+                }
+                byName.done();
+                return b.obj();
+            }
+        } mutexesSection;
+
+    } // namespace
+
+} // namespace mongo
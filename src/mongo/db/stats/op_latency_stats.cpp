@@ -0,0 +1,222 @@
+// op_latency_stats.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/db/stats/op_latency_stats.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+    namespace {
+        const char* const opTypeNames[] = { "query", "getmore", "insert", "update", "delete",
+                                            "command" };
+
+        int opType( int op , bool command ) {
+            switch ( op ) {
+            case dbQuery: return command ? OpLatencyStats::COMMAND : OpLatencyStats::QUERY;
+            case dbGetMore: return OpLatencyStats::GETMORE;
+            case dbInsert: return OpLatencyStats::INSERT;
+            case dbUpdate: return OpLatencyStats::UPDATE;
+            case dbDelete: return OpLatencyStats::REMOVE;
+            default: return -1;
+            }
+        }
+    }
+
+    OpLatencyStats OpLatencyStats::global;
+    int OpLatencyStats::maxNamespaces = 0;
+
+    ExportedServerParameter<int> opLatencyNamespacesParam( ServerParameterSet::getGlobal(),
+                                                          "opLatencyNamespaces",
+                                                          &OpLatencyStats::maxNamespaces,
+                                                          true, true );
+
+    OpLatencyStats::Histograms::Histograms( int stripes ) {
+        for ( int i = 0; i < NUM_OP_TYPES; i++ )
+            ops[i] = new LatencyHistogram( stripes );
+    }
+
+    OpLatencyStats::Histograms::~Histograms() {
+        for ( int i = 0; i < NUM_OP_TYPES; i++ )
+            delete ops[i];
+    }
+
+    OpLatencyStats::OpLatencyStats()
+        : _totals( LatencyHistogram::kDefaultStripes ), _lock( "OpLatencyStats" ) {
+    }
+
+    void OpLatencyStats::record( const StringData& ns , int op , bool command , long long micros ) {
+        int type = opType( op , command );
+        if ( type < 0 || micros < 0 )
+            return;
+
+        _totals.ops[type]->record( micros );
+
+        if ( maxNamespaces <= 0 || ns.empty() || ns[0] == '?' )
+            return;
+
+        // The namespace histograms have one stripe each, as any one of them is seldom
+        // recorded into by many threads at once, and there can be many.
+        boost::shared_ptr<Histograms> h;
+        {
+            SimpleMutex::scoped_lock lk( _lock );
+            // the drop itself finishes after collectionDropped(), as Top sees too
+            if ( ( command || op == dbQuery ) && ns == _lastDropped ) {
+                _lastDropped = "";
+                return;
+            }
+            StringMap< boost::shared_ptr<Histograms> >::const_iterator i = _byNs.find( ns );
+            if ( i != _byNs.end() ) {
+                h = i->second;
+            }
+            else if ( _byNs.size() < static_cast<size_t>( maxNamespaces ) ) {
+                h.reset( new Histograms( 1 ) );
+                _byNs[ns] = h;
+            }
+        }
+        if ( h )
+            h->ops[type]->record( micros );
+    }
+
+    void OpLatencyStats::collectionDropped( const StringData& ns ) {
+        SimpleMutex::scoped_lock lk( _lock );
+        _byNs.erase( ns );
+        _lastDropped = ns.toString();
+    }
+
+    void OpLatencyStats::_append( BSONObjBuilder& b , const Histograms& h , bool withBuckets ,
+                                  bool skipEmpty ) {
+        for ( int i = 0; i < NUM_OP_TYPES; i++ ) {
+            LatencyHistogram::Snapshot s;
+            h.ops[i]->snapshot( &s );
+            if ( skipEmpty && s.count == 0 )
+                continue;
+
+            BSONObjBuilder bb( b.subobjStart( opTypeNames[i] ) );
+            bb.appendNumber( "count" , static_cast<long long>( s.count ) );
+            bb.appendNumber( "totalMicros" , static_cast<long long>( s.totalMicros ) );
+            bb.appendNumber( "p50" , static_cast<long long>( s.percentile( 50 ) ) );
+            bb.appendNumber( "p95" , static_cast<long long>( s.percentile( 95 ) ) );
+            bb.appendNumber( "p99" , static_cast<long long>( s.percentile( 99 ) ) );
+            bb.appendNumber( "p999" , static_cast<long long>( s.percentile( 99.9 ) ) );
+            if ( withBuckets ) {
+                BSONArrayBuilder buckets( bb.subarrayStart( "buckets" ) );
+                for ( int j = 0; j < LatencyHistogram::kNumBuckets; j++ ) {
+                    if ( s.buckets[j] == 0 )
+                        continue;
+                    buckets.append( BSON( "micros" << static_cast<long long>(
+                                              LatencyHistogram::bucketMaxMicros( j ) ) <<
+                                          "count" << static_cast<long long>( s.buckets[j] ) ) );
+                }
+                buckets.done();
+            }
+            bb.done();
+        }
+    }
+
+    void OpLatencyStats::appendTotals( BSONObjBuilder& b , bool withBuckets ) const {
+        _append( b , _totals , withBuckets , false );
+    }
+
+    void OpLatencyStats::appendNamespaces( BSONObjBuilder& b , bool withBuckets ) const {
+        std::vector< std::pair< string, boost::shared_ptr<Histograms> > > all;
+        {
+            SimpleMutex::scoped_lock lk( _lock );
+            for ( StringMap< boost::shared_ptr<Histograms> >::const_iterator i = _byNs.begin();
+                  i != _byNs.end(); ++i ) {
+                all.push_back( std::make_pair( i->first, i->second ) );
+            }
+        }
+        std::sort( all.begin(), all.end() );
+
+        for ( size_t i = 0; i < all.size(); i++ ) {
+            BSONObjBuilder bb( b.subobjStart( all[i].first ) );
+            _append( bb , *all[i].second , withBuckets , true );
+            bb.done();
+        }
+    }
+
+    namespace {
+
+        /**
+         * The percentiles of each type of operation; serverStatus( { opLatencies :
+         * { buckets : true } } ) adds the buckets.
+         */
+        class OpLatenciesSection : public ServerStatusSection {
+        public:
+            OpLatenciesSection() : ServerStatusSection( "opLatencies" ) {}
+            virtual bool includeByDefault() const { return true; }
+
+            BSONObj generateSection( const BSONElement& configElement ) const {
+                bool withBuckets = configElement.isABSONObj() &&
+                                   configElement.Obj()["buckets"].trueValue();
+                BSONObjBuilder b;
+                OpLatencyStats::global.appendTotals( b , withBuckets );
+                return b.obj();
+            }
+        } opLatenciesSection;
+
+        class OpLatenciesCmd : public Command {
+        public:
+            OpLatenciesCmd() : Command( "opLatencies" ) {}
+
+            virtual bool slaveOk() const { return true; }
+            virtual bool adminOnly() const { return true; }
+            virtual LockType locktype() const { return NONE; }
+            virtual void help( stringstream& help ) const {
+                help << "latency histograms by operation type, and by namespace for up to "
+                        "the opLatencyNamespaces parameter's namespaces, in micros; "
+                        "{ opLatencies : 1, buckets : false } for percentiles only";
+            }
+            virtual void addRequiredPrivileges(const std::string& dbname,
+                                               const BSONObj& cmdObj,
+                                               std::vector<Privilege>* out) {
+                ActionSet actions;
+                actions.addAction(ActionType::top);
+                out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+            }
+            virtual bool run(const string& , BSONObj& cmdObj, int, string& errmsg,
+                             BSONObjBuilder& result, bool fromRepl) {
+                bool withBuckets = cmdObj["buckets"].eoo() || cmdObj["buckets"].trueValue();
+                {
+                    BSONObjBuilder b( result.subobjStart( "totals" ) );
+                    OpLatencyStats::global.appendTotals( b , withBuckets );
+                    b.done();
+                }
+                {
+                    BSONObjBuilder b( result.subobjStart( "namespaces" ) );
+                    OpLatencyStats::global.appendNamespaces( b , withBuckets );
+                    b.done();
+                }
+                return true;
+            }
+        } opLatenciesCmd;
+
+    } // namespace
+
+} // namespace mongo
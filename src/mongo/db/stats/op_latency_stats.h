@@ -0,0 +1,78 @@
+// op_latency_stats.h : latency distributions of the operations run
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/latency_histogram.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+    /**
+     * Latency histograms of the operations run, by type, and for up to opLatencyNamespaces
+     * namespaces (none by default) by namespace as well.  Namespaces get histograms in the
+     * order they are first used, and give them up when dropped.  CurOp records each operation
+     * as it finishes.
+     */
+    class OpLatencyStats {
+    public:
+        enum OpType { QUERY, GETMORE, INSERT, UPDATE, REMOVE, COMMAND, NUM_OP_TYPES };
+
+        OpLatencyStats();
+
+        void record( const StringData& ns , int op , bool command , long long micros );
+
+        void collectionDropped( const StringData& ns );
+
+        /**
+         * Appends the count, total and percentiles of each op type, and with withBuckets the
+         * non-empty buckets as well, as [ { micros: <largest latency in the bucket>,
+         * count: <n> }, ... ], so that histograms from several servers can be added up.
+         */
+        void appendTotals( BSONObjBuilder& b , bool withBuckets ) const;
+
+        /** Appends the same for each namespace that has histograms, by namespace. */
+        void appendNamespaces( BSONObjBuilder& b , bool withBuckets ) const;
+
+        static OpLatencyStats global;
+
+        /** the opLatencyNamespaces parameter */
+        static int maxNamespaces;
+
+    private:
+        struct Histograms {
+            explicit Histograms( int stripes );
+            ~Histograms();
+            LatencyHistogram* ops[NUM_OP_TYPES];
+        };
+
+        static void _append( BSONObjBuilder& b , const Histograms& h , bool withBuckets ,
+                             bool skipEmpty );
+
+        Histograms _totals;
+
+        // guards _byNs
+        mutable SimpleMutex _lock;
+        StringMap< boost::shared_ptr<Histograms> > _byNs;
+        string _lastDropped;
+    };
+
+} // namespace mongo
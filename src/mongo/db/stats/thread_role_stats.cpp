@@ -0,0 +1,215 @@
+// thread_role_stats.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * The "threadRoles" serverStatus section: CPU time and page faults of the server's threads, added
+ * up by what the threads do, for the threads running and the ones that have exited.
+ */
+
+#include "mongo/pch.h"
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "mongo/base/init.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/thread_name.h"
+
+namespace mongo {
+
+namespace {
+
+    // Roles, and the thread name prefixes that give them away.  Names are matched on at most 15
+    // characters, which is all the kernel keeps of them.
+    const char* const roleNames[] = { "connection", "replWriter", "replPrefetch", "journal", "ttl",
+                                      "rangeDeleter", "dataFileSync", "other" };
+    const int numRoles = sizeof( roleNames ) / sizeof( roleNames[0] );
+    const int otherRole = numRoles - 1;
+
+    struct RolePrefix {
+        const char* prefix;
+        int role;
+    };
+    const RolePrefix rolePrefixes[] = { { "conn", 0 }, { "repl writer", 1 },
+                                        { "repl prefetch", 2 }, { "journal", 3 },
+                                        { "TTLMonitor", 4 }, { "RangeDeleter", 5 },
+                                        { "DataFileSync", 6 } };
+
+    int roleFor( const StringData& threadName ) {
+        for ( size_t i = 0; i < sizeof( rolePrefixes ) / sizeof( rolePrefixes[0] ); i++ ) {
+            if ( threadName.startsWith( rolePrefixes[i].prefix ) )
+                return rolePrefixes[i].role;
+        }
+        return otherRole;
+    }
+
+    struct ThreadUsage {
+        ThreadUsage() : threads( 0 ), userMicros( 0 ), systemMicros( 0 ), minorFaults( 0 ),
+                        majorFaults( 0 ) {}
+
+        void add( const ThreadUsage& other ) {
+            threads += other.threads;
+            userMicros += other.userMicros;
+            systemMicros += other.systemMicros;
+            minorFaults += other.minorFaults;
+            majorFaults += other.majorFaults;
+        }
+
+        long long threads;
+        long long userMicros;
+        long long systemMicros;
+        long long minorFaults;
+        long long majorFaults;
+    };
+
+    // Usage of the threads that have exited, by role.
+    SimpleMutex exitedMutex( "threadRoleStats" );
+    ThreadUsage exited[numRoles];
+
+#if defined(__linux__)
+    void threadExited( const std::string& name ) {
+        ThreadUsage usage;
+#if defined(RUSAGE_THREAD)
+        struct rusage ru;
+        if ( getrusage( RUSAGE_THREAD, &ru ) != 0 )
+            return;
+        usage.threads = 1;
+        usage.userMicros = ru.ru_utime.tv_sec * 1000000LL + ru.ru_utime.tv_usec;
+        usage.systemMicros = ru.ru_stime.tv_sec * 1000000LL + ru.ru_stime.tv_usec;
+        usage.minorFaults = ru.ru_minflt;
+        usage.majorFaults = ru.ru_majflt;
+#endif
+        SimpleMutex::scoped_lock lk( exitedMutex );
+        exited[roleFor( name )].add( usage );
+    }
+
+    string readFile( const string& path ) {
+        string contents;
+        FILE* f = fopen( path.c_str(), "r" );
+        if ( !f )
+            return contents;
+        char buf[1024];
+        size_t n = fread( buf, 1, sizeof( buf ), f );
+        contents.assign( buf, n );
+        fclose( f );
+        return contents;
+    }
+
+    /**
+     * Reads /proc/self/task/<tid>/stat into "usage", returning false if the thread has gone.
+     */
+    bool readTaskStat( const string& tid, ThreadUsage* usage ) {
+        string stat = readFile( "/proc/self/task/" + tid + "/stat" );
+        // The name in parentheses can hold anything; the fields after it are numbers.
+        size_t paren = stat.rfind( ')' );
+        if ( paren == string::npos )
+            return false;
+
+        unsigned long minflt, majflt, utime, stime;
+        if ( sscanf( stat.c_str() + paren + 1,
+                     " %*c %*d %*d %*d %*d %*d %*u %lu %*u %lu %*u %lu %lu",
+                     &minflt, &majflt, &utime, &stime ) != 4 )
+            return false;
+
+        static const long long microsPerTick = 1000000LL / sysconf( _SC_CLK_TCK );
+        usage->threads = 1;
+        usage->userMicros = utime * microsPerTick;
+        usage->systemMicros = stime * microsPerTick;
+        usage->minorFaults = minflt;
+        usage->majorFaults = majflt;
+        return true;
+    }
+
+    void addRunning( ThreadUsage* running ) {
+        DIR* dir = opendir( "/proc/self/task" );
+        if ( !dir )
+            return;
+        while ( struct dirent* entry = readdir( dir ) ) {
+            if ( entry->d_name[0] == '.' )
+                continue;
+            const string tid = entry->d_name;
+
+            string name = readFile( "/proc/self/task/" + tid + "/comm" );
+            if ( !name.empty() && name[name.size() - 1] == '\n' )
+                name.erase( name.size() - 1 );
+
+            ThreadUsage usage;
+            if ( readTaskStat( tid, &usage ) )
+                running[roleFor( name )].add( usage );
+        }
+        closedir( dir );
+    }
+#endif
+
+    MONGO_INITIALIZER(ThreadRoleStats)(InitializerContext* context) {
+#if defined(__linux__)
+        setThreadExitHook( &threadExited );
+#endif
+        return Status::OK();
+    }
+
+    void appendUsage( BSONObjBuilder& b, const ThreadUsage& usage ) {
+        b.appendNumber( "threads", usage.threads );
+        b.appendNumber( "userMicros", usage.userMicros );
+        b.appendNumber( "systemMicros", usage.systemMicros );
+        b.appendNumber( "minorFaults", usage.minorFaults );
+        b.appendNumber( "majorFaults", usage.majorFaults );
+    }
+
+    class ThreadRolesSection : public ServerStatusSection {
+    public:
+        ThreadRolesSection() : ServerStatusSection( "threadRoles" ) {}
+
+        // Reads two files per thread, too many to do on every serverStatus.
+        virtual bool includeByDefault() const { return false; }
+
+        BSONObj generateSection( const BSONElement& configElement ) const {
+            BSONObjBuilder b;
+#if defined(__linux__)
+            ThreadUsage running[numRoles];
+            addRunning( running );
+
+            ThreadUsage exitedCopy[numRoles];
+            {
+                SimpleMutex::scoped_lock lk( exitedMutex );
+                std::copy( exited, exited + numRoles, exitedCopy );
+            }
+
+            for ( int i = 0; i < numRoles; i++ ) {
+                BSONObjBuilder role( b.subobjStart( roleNames[i] ) );
+                BSONObjBuilder r( role.subobjStart( "running" ) );
+                appendUsage( r, running[i] );
+                r.done();
+                BSONObjBuilder e( role.subobjStart( "exited" ) );
+                appendUsage( e, exitedCopy[i] );
+                e.done();
+                role.done();
+            }
+#else
+            b.append( "note", "not supported on this platform" );
+#endif
+            return b.obj();
+        }
+    } threadRolesSection;
+
+}  // namespace
+
+}  // namespace mongo
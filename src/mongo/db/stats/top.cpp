@@ -51,6 +51,8 @@ namespace mongo {
         : total( older.total , newer.total ) ,
           readLock( older.readLock , newer.readLock ) ,
           writeLock( older.writeLock , newer.writeLock ) ,
+          readLockWait( older.readLockWait , newer.readLockWait ) ,
+          writeLockWait( older.writeLockWait , newer.writeLockWait ) ,
           queries( older.queries , newer.queries ) ,
           getmore( older.getmore , newer.getmore ) ,
           insert( older.insert , newer.insert ) ,
@@ -60,7 +62,8 @@ namespace mongo {
 
     }
 
-    void Top::record( const StringData& ns , int op , int lockType , long long micros , bool command ) {
+    void Top::record( const StringData& ns , int op , int lockType , long long micros ,
+                      long long lockWaitMicros , bool command ) {
         if ( ns[0] == '?' )
             return;
 
@@ -73,17 +76,22 @@ namespace mongo {
         }
 
         CollectionData& coll = _usage[ns];
-        _record( coll , op , lockType , micros , command );
-        _record( _global , op , lockType , micros , command );
+        _record( coll , op , lockType , micros , lockWaitMicros , command );
+        _record( _global , op , lockType , micros , lockWaitMicros , command );
     }
 
-    void Top::_record( CollectionData& c , int op , int lockType , long long micros , bool command ) {
+    void Top::_record( CollectionData& c , int op , int lockType , long long micros ,
+                       long long lockWaitMicros , bool command ) {
         c.total.inc( micros );
 
-        if ( lockType > 0 )
+        if ( lockType > 0 ) {
             c.writeLock.inc( micros );
-        else if ( lockType < 0 )
+            c.writeLockWait.inc( lockWaitMicros );
+        }
+        else if ( lockType < 0 ) {
             c.readLock.inc( micros );
+            c.readLockWait.inc( lockWaitMicros );
+        }
 
         switch ( op ) {
         case 0:
@@ -154,6 +162,8 @@ namespace mongo {
 
             _appendStatsEntry( b , "readLock" , coll.readLock );
             _appendStatsEntry( b , "writeLock" , coll.writeLock );
+            _appendStatsEntry( b , "readLockWait" , coll.readLockWait );
+            _appendStatsEntry( b , "writeLockWait" , coll.writeLockWait );
 
             _appendStatsEntry( b , "queries" , coll.queries );
             _appendStatsEntry( b , "getmore" , coll.getmore );
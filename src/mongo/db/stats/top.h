@@ -56,6 +56,10 @@ namespace mongo {
             UsageData readLock;
             UsageData writeLock;
 
+            // time spent waiting to acquire the read or write lock, before the op could run
+            UsageData readLockWait;
+            UsageData writeLockWait;
+
             UsageData queries;
             UsageData getmore;
             UsageData insert;
@@ -67,7 +71,8 @@ namespace mongo {
         typedef StringMap<CollectionData> UsageMap;
 
     public:
-        void record( const StringData& ns , int op , int lockType , long long micros , bool command );
+        void record( const StringData& ns , int op , int lockType , long long micros ,
+                     long long lockWaitMicros , bool command );
         void append( BSONObjBuilder& b );
         void cloneMap(UsageMap& out) const;
         CollectionData getGlobalData() const { return _global; }
@@ -79,7 +84,8 @@ namespace mongo {
     private:
         void _appendToUsageMap( BSONObjBuilder& b , const UsageMap& map ) const;
         void _appendStatsEntry( BSONObjBuilder& b , const char * statsName , const UsageData& map ) const;
-        void _record( CollectionData& c , int op , int lockType , long long micros , bool command );
+        void _record( CollectionData& c , int op , int lockType , long long micros ,
+                      long long lockWaitMicros , bool command );
 
         mutable SimpleMutex _lock;
         CollectionData _global;
@@ -47,9 +47,13 @@ using namespace mongoutils;
 
 namespace mongo {
 
-    void DurableMappedFile::remapThePrivateView() {
+    unsigned long long DurableMappedFile::remapThePrivateView() {
         verify(storageGlobalParams.dur);
 
+        const unsigned long long dirty = _dirtyChunks;
+        _dirtyChunks = 0;
+
+#if defined(_WIN32) || defined(__sunos__)
         // todo 1.9 : it turns out we require that we always remap to the same address.
         // so the remove / add isn't necessary and can be removed?
         void *old = _view_private;
@@ -57,6 +61,32 @@ namespace mongo {
         _view_private = remapPrivateView(_view_private);
         //privateViews.add(_view_private, this);
         fassert( 16112, _view_private == old );
+        return length();
+#else
+        // remap each run of dirty chunks; the clean ones have no copied pages to give back
+        unsigned long long remapped = 0;
+        for( unsigned chunk = 0; chunk < 64; ) {
+            if( !( dirty & ( 1ULL << chunk ) ) ) {
+                chunk++;
+                continue;
+            }
+            unsigned end = chunk + 1;
+            while( end < 64 && ( dirty & ( 1ULL << end ) ) )
+                end++;
+
+            unsigned long long ofs = chunk * RemapChunkSize;
+            // the last chunk covers the rest of the file
+            unsigned long long endOfs = end < 64 ? end * RemapChunkSize : length();
+            if( endOfs > length() )
+                endOfs = length();
+            if( ofs < endOfs ) {
+                remapPrivateViewRange(_view_private, ofs, endOfs - ofs);
+                remapped += endOfs - ofs;
+            }
+            chunk = end;
+        }
+        return remapped;
+#endif
     }
 
     /** register view. threadsafe */
@@ -170,7 +200,7 @@ namespace mongo {
         return false;
     }
 
-    DurableMappedFile::DurableMappedFile() : _willNeedRemap(false) {
+    DurableMappedFile::DurableMappedFile() : _dirtyChunks(0) {
         _view_write = _view_private = 0;
     }
 
@@ -89,13 +89,33 @@ namespace mongo {
         int fileSuffixNo() const { return _fileSuffixNo; }
         HANDLE getFd() { return MemoryMappedFile::getFd(); }
 
+        /** the private view is remapped in chunks of this size; only the chunks written since
+            the last remap are remapped.  64 of them cover the largest data file.
+        */
+        static const unsigned long long RemapChunkSize = 32 * 1024 * 1024;
+
         /** true if we have written.
             set in PREPLOGBUFFER, it is NOT set immediately on write intent declaration.
             reset to false in REMAPPRIVATEVIEW
         */
-        bool& willNeedRemap() { return _willNeedRemap; }
+        bool willNeedRemap() const { return _dirtyChunks != 0; }
+
+        /** notes a write of 'len' bytes at offset 'ofs', so the chunks it touched get remapped.
+            called in PREPLOGBUFFER.
+        */
+        void wroteRange(unsigned long long ofs, unsigned len) {
+            unsigned long long first = chunkBit(ofs);
+            unsigned long long last = chunkBit(ofs + (len ? len - 1 : 0));
+            unsigned long long chunks = (last << 1) - first; // first through last
+            // usually already dirty, so test first to avoid cpu cache line contention
+            if( (_dirtyChunks & chunks) != chunks )
+                _dirtyChunks |= chunks;
+        }
 
-        void remapThePrivateView();
+        /** remaps the chunks of the private view written since the last remap.
+            @return the number of bytes remapped
+        */
+        unsigned long long remapThePrivateView();
 
         virtual bool isDurableMappedFile() { return true; }
 
@@ -103,10 +123,15 @@ namespace mongo {
 
         void *_view_write;
         void *_view_private;
-        bool _willNeedRemap;
+        unsigned long long _dirtyChunks; // bit n set if chunk n was written since the last remap
         RelativePath _p;   // e.g. "somepath/dbname"
         int _fileSuffixNo;  // e.g. 3.  -1="ns"
 
+        static unsigned long long chunkBit(unsigned long long ofs) {
+            unsigned long long chunk = ofs / RemapChunkSize;
+            return 1ULL << ( chunk < 63 ? chunk : 63 );
+        }
+
         void setPath(const std::string& pathAndFileName);
         bool finishOpening();
     };
@@ -33,12 +33,14 @@
 #include <boost/filesystem/operations.hpp>
 
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/d_concurrency.h"
 #include "mongo/db/memconcept.h"
 #include "mongo/db/namespace_details.h"
 #include "mongo/db/storage/data_file.h"
 #include "mongo/db/storage/extent.h"
 #include "mongo/db/storage/extent_manager.h"
+#include "mongo/db/stats/timer_stats.h"
 
 #include "mongo/db/pdfile.h"
 
@@ -114,6 +116,13 @@ namespace mongo {
     }
 
 
+    // Data files a writer had to create while holding the write lock, and how long that took.
+    // The time is short when the file was preallocated in the background, and long when it
+    // had to be allocated on the spot.
+    static TimerStats fileCreationStats;
+    static ServerStatusMetricField<TimerStats> displayFileCreation( "storage.fileCreation",
+                                                                    &fileCreationStats );
+
     // todo: this is called a lot. streamline the common case
     DataFile* ExtentManager::getFile( int n, int sizeNeeded , bool preallocateOnly) {
         verify(this);
@@ -153,7 +162,13 @@ namespace mongo {
             if ( sizeNeeded + DataFileHeader::HeaderSize > minSize )
                 minSize = sizeNeeded + DataFileHeader::HeaderSize;
             try {
-                p->open( fullNameString.c_str(), minSize, preallocateOnly );
+                if ( preallocateOnly ) {
+                    p->open( fullNameString.c_str(), minSize, preallocateOnly );
+                }
+                else {
+                    TimerHolder timer( &fileCreationStats );
+                    p->open( fullNameString.c_str(), minSize, preallocateOnly );
+                }
             }
             catch ( AssertionException& ) {
                 delete p;
@@ -372,9 +387,11 @@ namespace mongo {
 
 
         // no space in an existing file
-        // allocate files until we either get one big enough or hit maxSize
+        // allocate files until we either get one big enough or hit maxSize.  each new file
+        // queues the one after it with the FileAllocator, so the next time we get here the file
+        // is already there and we don't wait for it in the write lock
         for ( int i = 0; i < 8; i++ ) {
-            DataFile* f = addAFile( size, false );
+            DataFile* f = addAFile( size, true );
 
             if ( f->getHeader()->unusedLength >= size ) {
                 return _createExtentInFile( numFiles() - 1, f, size, maxFileNoForQuota );
@@ -371,18 +371,24 @@ namespace mongo {
 
         };
      
-        void appendWorkingSetInfo( BSONObjBuilder& b ) {
+        /** @return the time the oldest slice still counted was started */
+        time_t addAllPages( unordered_set<size_t>* pages ) {
             boost::scoped_array<Slice> mySlices( new Slice[NumSlices] );
 
-            unordered_set<size_t> totalPages;
-            Timer t;
-
             time_t timestamp = 0;
 
             for ( int i = 0; i < BigHashSize; i++ ) {
-                time_t myOldestTimestamp = rolling[i].addPages( &totalPages, mySlices.get() );
+                time_t myOldestTimestamp = rolling[i].addPages( pages, mySlices.get() );
                 timestamp = std::max( timestamp, myOldestTimestamp );
             }
+            return timestamp;
+        }
+
+        void appendWorkingSetInfo( BSONObjBuilder& b ) {
+            unordered_set<size_t> totalPages;
+            Timer t;
+
+            time_t timestamp = addAllPages( &totalPages );
 
             b.append( "note", "thisIsAnEstimate" );
             b.appendNumber( "pagesInMemory", totalPages.size() );
@@ -452,6 +458,17 @@ namespace mongo {
         ps::appendWorkingSetInfo( b );
     }
 
+    bool Record::workingSetPages( std::vector<size_t>* pages ) {
+        if ( ! blockSupported )
+            return false;
+
+        unordered_set<size_t> pageSet;
+        ps::addAllPages( &pageSet );
+        pages->assign( pageSet.begin(), pageSet.end() );
+        std::sort( pages->begin(), pages->end() );
+        return true;
+    }
+
     bool Record::likelyInPhysicalMemory() const {
         return likelyInPhysicalMemory( _data );
     }
@@ -539,6 +556,8 @@ namespace mongo {
         recordStats.accessesNotInMemory.fetchAndAdd(1);
         if ( db )
             db->recordStats().accessesNotInMemory.fetchAndAdd(1);
+        if ( client.curop() )
+            client.curop()->accessedNotInMemory();
         
         if ( ! client.allowedToThrowPageFaultException() )
             return;
@@ -552,6 +571,8 @@ namespace mongo {
         recordStats.pageFaultExceptionsThrown.fetchAndAdd(1);
         if ( db )
             db->recordStats().pageFaultExceptionsThrown.fetchAndAdd(1);
+        if ( client.curop() )
+            client.curop()->threwPageFaultException();
 
         DEV fassert( 16236 , ! inConstructorChain(true) );
         throw PageFaultException(this);
@@ -51,6 +51,7 @@ namespace mongo {
             lenForNewNsFiles(16 * 1024 * 1024),
             preallocj(true),
             journalCommitInterval(0), // 0 means use default
+            journalCompression(true),
             quota(false), quotaFiles(8),
             syncdelay(60),
             useHints(true)
@@ -79,6 +80,7 @@ namespace mongo {
 
         bool dur;                       // --dur durability (now --journal)
         unsigned journalCommitInterval; // group/batch commit interval ms
+        bool journalCompression;        // --journalCompressor none writes sections uncompressed
 
         /** --durOptions 7      dump journal and terminate without doing anything further
             --durOptions 4      recover and terminate without listening
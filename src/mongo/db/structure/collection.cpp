@@ -31,6 +31,7 @@
 #include "mongo/db/structure/collection.h"
 
 #include "mongo/base/counter.h"
+#include "mongo/db/catalog/index_create.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/database.h"
@@ -102,6 +103,13 @@ namespace mongo {
         return new FlatIterator( this, start, dir );
     }
 
+    CollectionIterator* Collection::getExtentRangeIterator( const DiskLoc& firstExtent,
+                                                            const DiskLoc& stopExtent ) const {
+        verify( ok() );
+        verify( !_details->isCapped() );
+        return new FlatIterator( this, firstExtent, stopExtent );
+    }
+
     BSONObj Collection::docFor( const DiskLoc& loc ) {
         Record* rec = getExtentManager()->recordFor( loc );
         return BSONObj::make( rec->accessed() );
@@ -116,9 +124,6 @@ namespace mongo {
             }
         }
 
-        int lenWHdr = _details->getRecordAllocationSize( docToInsert.objsize() + Record::HeaderSize );
-        fassert( 17208, lenWHdr >= ( docToInsert.objsize() + Record::HeaderSize ) );
-
         if ( _details->isCapped() ) {
             // TOOD: old god not done
             Status ret = _indexCatalog.checkNoIndexConflicts( docToInsert );
@@ -126,27 +131,13 @@ namespace mongo {
                 return StatusWith<DiskLoc>( ret );
         }
 
-        // TODO: for now, capped logic lives inside NamespaceDetails, which is hidden
-        //       under the RecordStore, this feels broken since that should be a
-        //       collection access method probably
-        StatusWith<DiskLoc> loc = _recordStore.allocRecord( lenWHdr,
-                                                            enforceQuota ? largestFileNumberInQuota() : 0 );
+        StatusWith<DiskLoc> loc = _insertRecord( docToInsert, enforceQuota );
         if ( !loc.isOK() )
             return loc;
 
-        Record *r = loc.getValue().rec();
-        fassert( 17210, r->lengthWithHeaders() >= lenWHdr );
-
-        // copy the data
-        r = reinterpret_cast<Record*>( getDur().writingPtr(r, lenWHdr) );
-        memcpy( r->data(), docToInsert.objdata(), docToInsert.objsize() );
-
-        addRecordToRecListInExtent(r, loc.getValue()); // XXX move down into record store
-
-        _details->incrementStats( r->netLength(), 1 );
-
         // TOOD: old god not done
         _infoCache.notifyOfWriteOp();
+        _hashCache.notifyOfWrite( docToInsert );
 
         try {
             _indexCatalog.indexRecord( docToInsert, loc.getValue() );
@@ -171,6 +162,32 @@ namespace mongo {
 
     }
 
+    StatusWith<DiskLoc> Collection::_insertRecord( const BSONObj& doc, bool enforceQuota ) {
+        int lenWHdr = _details->getRecordAllocationSize( doc.objsize() + Record::HeaderSize );
+        fassert( 17208, lenWHdr >= ( doc.objsize() + Record::HeaderSize ) );
+
+        // TODO: for now, capped logic lives inside NamespaceDetails, which is hidden
+        //       under the RecordStore, this feels broken since that should be a
+        //       collection access method probably
+        StatusWith<DiskLoc> loc = _recordStore.allocRecord( lenWHdr,
+                                                            enforceQuota ? largestFileNumberInQuota() : 0 );
+        if ( !loc.isOK() )
+            return loc;
+
+        Record *r = loc.getValue().rec();
+        fassert( 17210, r->lengthWithHeaders() >= lenWHdr );
+
+        // copy the data
+        r = reinterpret_cast<Record*>( getDur().writingPtr(r, lenWHdr) );
+        memcpy( r->data(), doc.objdata(), doc.objsize() );
+
+        addRecordToRecListInExtent(r, loc.getValue()); // XXX move down into record store
+
+        _details->incrementStats( r->netLength(), 1 );
+
+        return loc;
+    }
+
     void Collection::deleteDocument( const DiskLoc& loc, bool cappedOK, bool noWarn,
                                      BSONObj* deletedId ) {
         if ( _details->isCapped() && !cappedOK ) {
@@ -188,6 +205,8 @@ namespace mongo {
             }
         }
 
+        _hashCache.notifyOfWrite( doc );
+
         /* check if any cursors point to us.  if so, advance them. */
         ClientCursor::aboutToDelete(_ns.ns(), _details, loc);
 
@@ -206,7 +225,8 @@ namespace mongo {
     StatusWith<DiskLoc> Collection::updateDocument( const DiskLoc& oldLocation,
                                                     const BSONObj& objNew,
                                                     bool enforceQuota,
-                                                    OpDebug* debug ) {
+                                                    OpDebug* debug,
+                                                    bool indexesAffected ) {
 
         Record* oldRecord = getExtentManager()->recordFor( oldLocation );
         BSONObj objOld = BSONObj::make( oldRecord );
@@ -220,6 +240,8 @@ namespace mongo {
                                             13596 );
         }
 
+        _hashCache.notifyOfWrite( objOld );
+
         if ( ns().coll() == "system.users" ) {
             // XXX - andy and spencer think this should go away now
             V2UserDocumentParser parser;
@@ -228,12 +250,19 @@ namespace mongo {
                 return StatusWith<DiskLoc>( s );
         }
 
+        const bool fits = oldRecord->netLength() >= objNew.objsize();
+
+        // a document that stays where it is and keeps its indexed fields keeps its keys.  an
+        // index being built may not be among those the caller checked, so it is always updated.
+        const bool updateIndexes =
+            indexesAffected || !fits || _indexCatalog.numIndexesInProgress();
+
         /* duplicate key check. we descend the btree twice - once for this check, and once for the actual inserts, further
            below.  that is suboptimal, but it's pretty complicated to do it the other way without rollbacks...
         */
         OwnedPointerVector<UpdateTicket> updateTickets;
         updateTickets.mutableVector().resize(_indexCatalog.numIndexesTotal());
-        for (int i = 0; i < _indexCatalog.numIndexesTotal(); ++i) {
+        for (int i = 0; updateIndexes && i < _indexCatalog.numIndexesTotal(); ++i) {
             IndexDescriptor* descriptor = _indexCatalog.getDescriptor( i );
             IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
 
@@ -250,7 +279,7 @@ namespace mongo {
             }
         }
 
-        if ( oldRecord->netLength() < objNew.objsize() ) {
+        if ( !fits ) {
             // doesn't fit.  reallocate -----------------------------------------------------
 
             if ( _details->isCapped() )
@@ -260,7 +289,6 @@ namespace mongo {
 
             moveCounter.increment();
             _details->paddingTooSmall();
-            deleteDocument( oldLocation );
 
             if ( debug ) {
                 if (debug->nmoved == -1) // default of -1 rather than 0
@@ -269,7 +297,45 @@ namespace mongo {
                     debug->nmoved += 1;
             }
 
-            return insertDocument( objNew, enforceQuota );
+            if ( _indexCatalog.numIndexesInProgress() ) {
+                // a background build tracks documents by location, so it sees the move as a
+                // delete and an insert
+                deleteDocument( oldLocation );
+                return insertDocument( objNew, enforceQuota );
+            }
+
+            // copy the document over first, then point its keys at the copy: ones the update
+            // kept are moved in place rather than removed and inserted again
+            StatusWith<DiskLoc> newLocation = _insertRecord( objNew, enforceQuota );
+            if ( !newLocation.isOK() )
+                return newLocation;
+
+            /* check if any cursors point to us.  if so, advance them. */
+            ClientCursor::aboutToDelete(_ns.ns(), _details, oldLocation);
+
+            if ( debug )
+                debug->keyUpdates = 0;
+
+            for (int i = 0; i < _indexCatalog.numIndexesTotal(); ++i) {
+                IndexDescriptor* descriptor = _indexCatalog.getDescriptor( i );
+                IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
+
+                int64_t updatedKeys;
+                Status ret = iam->updateMoved(*updateTickets.vector()[i], newLocation.getValue(),
+                                              &updatedKeys);
+                if ( !ret.isOK() )
+                    return StatusWith<DiskLoc>( ret );
+                if ( debug )
+                    debug->keyUpdates += updatedKeys;
+            }
+
+            _recordStore.deallocRecord( oldLocation, oldRecord );
+            _infoCache.notifyOfWriteOp();
+
+            // TODO: this is what the old code did, but is it correct?
+            _details->paddingFits();
+
+            return newLocation;
         }
 
         _infoCache.notifyOfWriteOp();
@@ -278,7 +344,7 @@ namespace mongo {
         if ( debug )
             debug->keyUpdates = 0;
 
-        for (int i = 0; i < _indexCatalog.numIndexesTotal(); ++i) {
+        for (int i = 0; updateIndexes && i < _indexCatalog.numIndexesTotal(); ++i) {
             IndexDescriptor* descriptor = _indexCatalog.getDescriptor( i );
             IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
 
@@ -290,9 +356,27 @@ namespace mongo {
                 debug->keyUpdates += updatedKeys;
         }
 
-        //  update in place
-        int sz = objNew.objsize();
-        memcpy(getDur().writingPtr(oldRecord->data(), sz), objNew.objdata(), sz);
+        if ( _indexCatalog.numIndexesInProgress() )
+            BackgroundIndexSideTable::noteWrite( _ns.ns(), oldLocation, false );
+
+        //  update in place, journaling only the bytes that change.  the size at the front changes
+        //  whenever the document grows, so it is written on its own rather than widening the range
+        //  to everything before the first changed element.
+        const int sz = objNew.objsize();
+        char* data = oldRecord->data();
+        const char* newData = objNew.objdata();
+        if ( memcmp( data, newData, 4 ) != 0 )
+            memcpy( getDur().writingPtr( data, 4 ), newData, 4 );
+
+        int begin = 4;
+        int end = sz;
+        while ( begin < end && data[begin] == newData[begin] )
+            ++begin;
+        while ( end > begin && data[end - 1] == newData[end - 1] )
+            --end;
+        if ( begin < end )
+            memcpy( getDur().writingPtr( data + begin, end - begin ), newData + begin, end - begin );
+
         return StatusWith<DiskLoc>( oldLocation );
     }
 
@@ -38,6 +38,7 @@
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/db/structure/collection_hash_cache.h"
 #include "mongo/db/structure/collection_info_cache.h"
 #include "mongo/platform/cstdint.h"
 
@@ -74,6 +75,8 @@ namespace mongo {
         CollectionInfoCache* infoCache() { return &_infoCache; }
         const CollectionInfoCache* infoCache() const { return &_infoCache; }
 
+        CollectionHashCache* hashCache() { return &_hashCache; }
+
         const NamespaceString& ns() const { return _ns; }
 
         const IndexCatalog* getIndexCatalog() const { return &_indexCatalog; }
@@ -88,6 +91,14 @@ namespace mongo {
         CollectionIterator* getIterator( const DiskLoc& start, bool tailable,
                                          const CollectionScanParams::Direction& dir) const;
 
+        /**
+         * Returns an iterator over the records in the extents from 'firstExtent' up to but not
+         * including 'stopExtent', in that order.  A null 'stopExtent' means the end of the
+         * collection.  The collection must not be capped.
+         */
+        CollectionIterator* getExtentRangeIterator( const DiskLoc& firstExtent,
+                                                    const DiskLoc& stopExtent ) const;
+
         void deleteDocument( const DiskLoc& loc,
                              bool cappedOK = false,
                              bool noWarn = false,
@@ -103,12 +114,16 @@ namespace mongo {
          * updates the document @ oldLocation with newDoc
          * if the document fits in the old space, it is put there
          * if not, it is moved
+         * only the bytes that differ from the old document are written in place, and when
+         * indexesAffected is false the caller knows no indexed field changed, so a document that
+         * stays put keeps its index keys untouched
          * @return the post update location of the doc (may or may not be the same as oldLocation)
          */
         StatusWith<DiskLoc> updateDocument( const DiskLoc& oldLocation,
                                             const BSONObj& newDoc,
                                             bool enforceQuota,
-                                            OpDebug* debug );
+                                            OpDebug* debug,
+                                            bool indexesAffected = true );
 
         int64_t storageSize( int* numExtents = NULL, BSONArrayBuilder* extentInfo = NULL ) const;
 
@@ -137,6 +152,11 @@ namespace mongo {
 
     private:
 
+        /**
+         * allocates a record for doc and copies it there, without indexing it
+         */
+        StatusWith<DiskLoc> _insertRecord( const BSONObj& doc, bool enforceQuota );
+
         // @return 0 for inf., otherwise a number of files
         int largestFileNumberInQuota() const;
 
@@ -150,6 +170,7 @@ namespace mongo {
         Database* _database;
         RecordStore _recordStore;
         CollectionInfoCache _infoCache;
+        CollectionHashCache _hashCache;
         IndexCatalog _indexCatalog;
 
         friend class Database;
@@ -0,0 +1,71 @@
+// collection_hash_cache.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/db/structure/collection_hash_cache.h"
+
+#include "mongo/db/hasher.h"
+
+namespace mongo {
+
+    CollectionHashCache::CollectionHashCache()
+        : _mutex( "CollectionHashCache" ) {
+    }
+
+    bool CollectionHashCache::isBoundary( const BSONElement& id ) {
+        return BSONElementHasher::hash64( id, 0, HASH_VERSION_MURMUR3 ) % kAverageRangeDocs == 0;
+    }
+
+    BSONObj CollectionHashCache::rangeKey( const BSONElement& id ) {
+        BSONObjBuilder b;
+        b.appendAs( id, "" );
+        return b.obj();
+    }
+
+    void CollectionHashCache::notifyOfWrite( const BSONObj& doc ) {
+        // nothing to do for the collections dbHash never kept ranges for, and the write lock
+        // keeps dbHash from filling the cache meanwhile
+        if ( _ranges.empty() )
+            return;
+
+        scoped_lock lk( _mutex );
+        BSONElement id = doc["_id"];
+        if ( id.eoo() ) {
+            _ranges.clear();
+            return;
+        }
+
+        // the first range starts at MinKey, so some range holds every _id
+        RangeMap::iterator i = _ranges.upper_bound( rangeKey( id ) );
+        verify( i != _ranges.begin() );
+        --i;
+        i->second.clear();
+    }
+
+}
@@ -0,0 +1,85 @@
+// collection_hash_cache.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * The digests dbHash keeps for ranges of a collection's _id index, so that hashing the
+     * collection again rereads only the ranges written to since.  A range starts at MinKey or at
+     * a boundary _id and runs up to the next boundary.  Whether an _id is a boundary depends on
+     * nothing but the _id, so collections holding the same documents are cut the same way.
+     *
+     * Writers hold the database write lock.  dbHash holds the read lock and getMutex().  The
+     * cache lives and dies with its Collection, so a dropped or renamed collection forgets it.
+     */
+    class CollectionHashCache {
+    public:
+        // Start of a range, as { "" : _id } or { "" : MinKey }, to the digest of its documents.
+        // An empty digest is a range written to since it was hashed.
+        typedef std::map<BSONObj, std::string, BSONObjCmp> RangeMap;
+
+        // About one _id in this many is a boundary.
+        static const int kAverageRangeDocs = 1024;
+
+        CollectionHashCache();
+
+        /** True if a range starts at 'id'. */
+        static bool isBoundary( const BSONElement& id );
+
+        /** The key ranges are found under for 'id'. */
+        static BSONObj rangeKey( const BSONElement& id );
+
+        /* you must notify the cache of every document you insert, update or delete */
+        void notifyOfWrite( const BSONObj& doc );
+
+        mutex& getMutex() { return _mutex; }
+
+        /* the hash the digests are of, empty before dbHash filled the cache */
+        const std::string& getHashType() const { return _hashType; }
+        void setHashType( const std::string& hashType ) { _hashType = hashType; }
+
+        /* every range of the collection once dbHash filled the cache, none before */
+        RangeMap& ranges() { return _ranges; }
+
+    private:
+        mutex _mutex;
+        std::string _hashType;
+        RangeMap _ranges;
+    };
+
+}
@@ -31,6 +31,8 @@
 #include "mongo/db/structure/collection_info_cache.h"
 
 #include "mongo/db/d_concurrency.h"
+#include "mongo/db/fts/fts_spec.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/namespace_details.h"
 #include "mongo/db/namespace_details-inl.h"
 #include "mongo/db/structure/collection.h"
@@ -60,7 +62,25 @@ namespace mongo {
 
         NamespaceDetails::IndexIterator i = _collection->details()->ii( true );
         while( i.more() ) {
-            BSONObj key = i.next().keyPattern();
+            IndexDetails& index = i.next();
+            BSONObj key = index.keyPattern();
+
+            // a text index's key pattern names its own key fields, not the fields it indexes
+            if ( IndexNames::findPluginName( key ) == IndexNames::TEXT ) {
+                fts::FTSSpec spec( index.info.obj() );
+                if ( spec.wildcard() ) {
+                    _indexedPaths.allPathsIndexed();
+                }
+                else {
+                    for ( fts::Weights::const_iterator w = spec.weights().begin();
+                          w != spec.weights().end();
+                          ++w ) {
+                        _indexedPaths.addPath( w->first );
+                    }
+                }
+                _indexedPaths.addPath( spec.languageOverrideField() );
+            }
+
             BSONObjIterator j( key );
             while ( j.more() ) {
                 BSONElement e = j.next();
@@ -81,8 +101,11 @@ namespace mongo {
     }
 
     void CollectionInfoCache::clearQueryCache() {
-        scoped_lock lk( _qcCacheMutex );
-        _clearQueryCache_inlock();
+        {
+            scoped_lock lk( _qcCacheMutex );
+            _clearQueryCache_inlock();
+        }
+        _planCache.clear();
     }
 
     void CollectionInfoCache::_clearQueryCache_inlock() {
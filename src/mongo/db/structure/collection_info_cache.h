@@ -31,6 +31,9 @@
 #pragma once
 
 #include "mongo/db/index_set.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/query_settings.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/querypattern.h"
 
 
@@ -67,8 +70,20 @@ namespace mongo {
 
         void addedIndex() { reset(); }
 
+        /* clears both the old query optimizer's cache and the plan cache */
         void clearQueryCache();
 
+        /* the plan cache of the new query framework.  see db/query/plan_cache.h */
+        PlanCache* getPlanCache() { return &_planCache; }
+
+        /* the index filters of the new query framework.  not cleared by reset().
+           see db/query/query_settings.h */
+        QuerySettings* getQuerySettings() { return &_querySettings; }
+
+        /* what the queries of each shape have cost.  not cleared by reset().
+           see db/query/query_shape_stats.h */
+        QueryShapeStats* getQueryShapeStats() { return &_queryShapeStats; }
+
         /* you must notify the cache if you are doing writes, as query plan utility will change */
         void notifyOfWriteOp();
 
@@ -95,6 +110,14 @@ namespace mongo {
         int _qcWriteCount;
         std::map<QueryPattern,CachedQueryPlan> _qcCache;
 
+        // --- for new query framework
+
+        PlanCache _planCache;
+
+        QuerySettings _querySettings;
+
+        QueryShapeStats _queryShapeStats;
+
     };
 
 }
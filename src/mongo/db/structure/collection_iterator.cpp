@@ -29,12 +29,19 @@
 #include "mongo/db/structure/collection_iterator.h"
 
 #include "mongo/db/namespace_details.h"
+#include "mongo/db/pdfile.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/extent.h"
 #include "mongo/db/storage/extent_manager.h"
 #include "mongo/db/structure/collection.h"
+#include "mongo/util/mmap.h"
 
 namespace mongo {
 
+    // How many extents past the current one a collection scan asks the OS to read in.  0 turns
+    // read-ahead off.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCollScanReadAheadExtents, int, 2);
+
     //
     // Regular / non-capped collection traversal
     //
@@ -83,6 +90,27 @@ namespace mongo {
         }
     }
 
+    FlatIterator::FlatIterator(const Collection* collection,
+                               const DiskLoc& firstExtent,
+                               const DiskLoc& stopExtent)
+        : _collection(collection),
+          _direction(CollectionScanParams::FORWARD),
+          _stopExtent(stopExtent) {
+
+        verify(!firstExtent.isNull());
+        const ExtentManager* em = _collection->getExtentManager();
+
+        // Start with the first record in the first non-empty extent of the range.
+        Extent* e = em->getExtent(firstExtent);
+        while (NULL != e && e->myLoc != _stopExtent && e->firstRecord.isNull()) {
+            e = em->getNextExtent(e);
+        }
+
+        if (NULL != e && e->myLoc != _stopExtent) {
+            _curr = e->firstRecord;
+        }
+    }
+
     bool FlatIterator::isEOF() {
         return _curr.isNull();
     }
@@ -98,11 +126,64 @@ namespace mongo {
             else {
                 _curr = _collection->getExtentManager()->getPrevRecord( _curr );
             }
+
+            if (!_curr.isNull() && !_stopExtent.isNull() && extentOfCurr() == _stopExtent) {
+                _curr = DiskLoc();
+            }
+
+            if (!_curr.isNull() && internalQueryCollScanReadAheadExtents > 0) {
+                readAhead();
+            }
         }
 
         return ret;
     }
 
+    void FlatIterator::readAhead() {
+        const ExtentManager* em = _collection->getExtentManager();
+
+        // Most calls are for a record in the same extent as the last one.
+        DiskLoc extentLoc = extentOfCurr();
+        if (extentLoc == _currExtent) {
+            return;
+        }
+        _currExtent = extentLoc;
+
+        // Find the extents in the read-ahead window.  Those up to _readAheadThrough were advised
+        // when we entered an earlier extent.  If we don't come across _readAheadThrough, we
+        // skipped past the window and advise the whole thing.
+        vector<Extent*> window;
+        size_t firstNew = 0;
+        Extent* e = em->getExtent(extentLoc);
+        for (int i = 0; i < internalQueryCollScanReadAheadExtents; ++i) {
+            if (CollectionScanParams::FORWARD == _direction) {
+                e = em->getNextExtent(e);
+            }
+            else {
+                e = em->getPrevExtent(e);
+            }
+            if (NULL == e || e->myLoc == _stopExtent) { break; }
+
+            window.push_back(e);
+            if (e->myLoc == _readAheadThrough) {
+                firstNew = window.size();
+            }
+        }
+
+        for (size_t i = firstNew; i < window.size(); ++i) {
+            MAdvise::willNeed(window[i], window[i]->length);
+        }
+
+        if (!window.empty()) {
+            _readAheadThrough = window.back()->myLoc;
+        }
+    }
+
+    DiskLoc FlatIterator::extentOfCurr() const {
+        const ExtentManager* em = _collection->getExtentManager();
+        return DiskLoc(_curr.a(), em->recordFor(_curr)->extentOfs());
+    }
+
     void FlatIterator::invalidate(const DiskLoc& dl) {
         verify( _collection->ok() );
 
@@ -72,6 +72,13 @@ namespace mongo {
     public:
         FlatIterator(const Collection* collection, const DiskLoc& start,
                      const CollectionScanParams::Direction& dir);
+
+        /**
+         * Iterates forward over the records in the extents from 'firstExtent' up to but not
+         * including 'stopExtent'.  If 'stopExtent' is null we go to the end of the collection.
+         */
+        FlatIterator(const Collection* collection, const DiskLoc& firstExtent,
+                     const DiskLoc& stopExtent);
         virtual ~FlatIterator() { }
 
         virtual bool isEOF();
@@ -82,12 +89,31 @@ namespace mongo {
         virtual bool recoverFromYield();
 
     private:
+        /**
+         * If _curr is in a different extent than the last record we returned, asks the OS to
+         * start reading in the next few extents in our direction.  A cold scan then reads the
+         * files sequentially rather than taking a page fault at a time.
+         */
+        void readAhead();
+
+        // The extent that the record _curr is in.  _curr must not be null.
+        DiskLoc extentOfCurr() const;
+
         // The result returned on the next call to getNext().
         DiskLoc _curr;
 
         const Collection* _collection;
 
         CollectionScanParams::Direction _direction;
+
+        // The extent _curr was in the last time we called readAhead().
+        DiskLoc _currExtent;
+
+        // The furthest extent we've asked the OS to read in.
+        DiskLoc _readAheadThrough;
+
+        // If not null, we're EOF when we reach a record in this extent.
+        DiskLoc _stopExtent;
     };
 
     /**
@@ -35,15 +35,19 @@
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/database_holder.h"
 #include "mongo/db/instance.h"
-#include "mongo/db/ops/delete.h"
+#include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/is_master.h"
+#include "mongo/db/repl/oplog.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/structure/collection.h"
 #include "mongo/util/background.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -54,10 +58,64 @@ namespace mongo {
     ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocuments", &ttlDeletedDocuments);
 
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorEnabled, bool, true );
-    
+
+    // Most expired documents deleted under one acquisition of the write lock.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlDeleteBatchSize, int, 1000 );
+
+    // Most expired documents a pass deletes per second, across all TTL indexes.  0 is no limit.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlDeletesPerSecond, int, 0 );
+
+namespace {
+
+    struct TTLIndexStats {
+        TTLIndexStats() : pass( 0 ), deletedLastPass( 0 ), deletedTotal( 0 ), lagMillis( 0 ),
+                          passMillis( 0 ) {}
+
+        long long pass;             // the last pass that visited the index
+        long long deletedLastPass;
+        long long deletedTotal;
+        long long lagMillis;        // how long the oldest expired document waited for the pass
+        long long passMillis;       // time the last pass spent on the index, sleeps included
+    };
+
+    // Keyed by "<ns>.$<index name>", like the index namespaces.
+    typedef map<string, TTLIndexStats> TTLIndexStatsMap;
+
+    mongo::mutex ttlStatsMutex( "ttlStats" );
+    TTLIndexStatsMap ttlStats;
+
+    class TTLServerStatusSection : public ServerStatusSection {
+    public:
+        TTLServerStatusSection() : ServerStatusSection( "ttlIndexes" ) {}
+
+        virtual bool includeByDefault() const { return false; }
+
+        BSONObj generateSection( const BSONElement& configElement ) const {
+            BSONObjBuilder b;
+            scoped_lock lk( ttlStatsMutex );
+            for ( TTLIndexStatsMap::const_iterator i = ttlStats.begin(); i != ttlStats.end(); ++i ) {
+                const TTLIndexStats& stats = i->second;
+                BSONObjBuilder sub( b.subobjStart( i->first ) );
+                sub.appendNumber( "deletedLastPass", stats.deletedLastPass );
+                sub.appendNumber( "deletedTotal", stats.deletedTotal );
+                sub.appendNumber( "lagSecs", stats.lagMillis / 1000 );
+                sub.appendNumber( "passMillis", stats.passMillis );
+                sub.append( "deletesPerSec",
+                            stats.passMillis ?
+                            stats.deletedLastPass * 1000.0 / stats.passMillis :
+                            static_cast<double>( stats.deletedLastPass ) );
+                sub.done();
+            }
+            return b.obj();
+        }
+
+    } ttlServerStatusSection;
+
+} // namespace
+
     class TTLMonitor : public BackgroundJob {
     public:
-        TTLMonitor(){}
+        TTLMonitor() : _pass( 0 ), _passDeleted( 0 ) {}
         virtual ~TTLMonitor(){}
 
         virtual string name() const { return "TTLMonitor"; }
@@ -99,40 +157,148 @@ namespace mongo {
                     continue;
                 }
 
-                BSONObj query;
-                {
-                    BSONObjBuilder b;
-                    b.appendDate( "$lt" , curTimeMillis64() - ( 1000 * idx[secondsExpireField].numberLong() ) );
-                    query = BSON( key.firstElement().fieldName() << b.obj() );
-                }
-                
-                LOG(1) << "TTL: " << key << " \t " << query << endl;
-                
+                const string ns = idx["ns"].String();
+                const string indexName = idx["name"].String();
+                const long long expireMillis = 1000 * idx[secondsExpireField].numberLong();
+                const Date_t cutoff = curTimeMillis64() - expireMillis;
+
+                LOG(1) << "TTL: " << ns << " " << key << " expiring before " << cutoff.toString()
+                       << endl;
+
+                Timer indexTimer;
+                long long lagMillis = 0;
                 long long n = 0;
-                {
-                    string ns = idx["ns"].String();
-                    Client::WriteContext ctx( ns );
-                    NamespaceDetails* nsd = nsdetails( ns );
-                    if ( ! nsd ) {
-                        // collection was dropped
-                        continue;
-                    }
-                    if ( nsd->setUserFlag( NamespaceDetails::Flag_UsePowerOf2Sizes ) ) {
-                        nsd->syncUserFlags( ns );
-                    }
-                    // only do deletes if on master
-                    if ( ! isMaster ) {
-                        continue;
+                bool done = false;
+                while ( !done && !inShutdown() && ttlMonitorEnabled ) {
+                    long long batchDeleted = 0;
+                    long long firstExpiry = 0;
+                    done = !deleteExpiredBatch( ns, indexName, key, cutoff, isMaster,
+                                                &batchDeleted, &firstExpiry );
+                    if ( n == 0 && batchDeleted > 0 ) {
+                        lagMillis = curTimeMillis64() - ( firstExpiry + expireMillis );
                     }
+                    n += batchDeleted;
+                    ttlDeletedDocuments.increment( batchDeleted );
+                    _passDeleted += batchDeleted;
+                    if ( !done )
+                        throttle();
+                }
 
-                    n = deleteObjects( ns , query , false , true );
-                    ttlDeletedDocuments.increment( n );
+                {
+                    scoped_lock lk( ttlStatsMutex );
+                    TTLIndexStats& stats = ttlStats[ ns + ".$" + indexName ];
+                    stats.pass = _pass;
+                    stats.deletedLastPass = n;
+                    stats.deletedTotal += n;
+                    stats.lagMillis = std::max( 0LL, lagMillis );
+                    stats.passMillis = indexTimer.millis();
                 }
 
                 LOG(1) << "\tTTL deleted: " << n << endl;
             }
-            
-            
+        }
+
+        /**
+         * Deletes up to a batch of the documents in 'ns' whose TTL index 'indexName' holds dates
+         * before 'cutoff', oldest first, under one write lock.  Sets '*firstExpiry' to the date
+         * of the first one.  Returns false once nothing expired is left, or nothing should be
+         * deleted: the collection or index went away, or the node is not master.
+         */
+        bool deleteExpiredBatch( const string& ns, const string& indexName, const BSONObj& key,
+                                 const Date_t& cutoff, bool wasMaster,
+                                 long long* deleted, long long* firstExpiry ) {
+            Client::WriteContext ctx( ns );
+            Collection* collection = ctx.ctx().db()->getCollection( ns );
+            if ( !collection ) {
+                // collection was dropped
+                return false;
+            }
+            NamespaceDetails* nsd = collection->details();
+            if ( nsd->setUserFlag( NamespaceDetails::Flag_UsePowerOf2Sizes ) ) {
+                nsd->syncUserFlags( ns );
+            }
+            // only do deletes if on master, and stop if we stepped down between batches
+            if ( !wasMaster || !isMasterNs( ns.c_str() ) ) {
+                return false;
+            }
+
+            IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByName( indexName );
+            if ( !desc ) {
+                return false;
+            }
+
+            // Dates sort right after booleans, so the scan starts at the largest boolean and
+            // skips it, and ends before the cutoff.  A descending index is walked backwards so
+            // the oldest documents still come first.
+            BSONObjBuilder start;
+            start.appendMinForType( "", Date );
+            BSONObjBuilder end;
+            end.appendDate( "", cutoff );
+            const InternalPlanner::Direction direction =
+                key.firstElement().number() < 0 ? InternalPlanner::BACKWARD :
+                                                  InternalPlanner::FORWARD;
+            auto_ptr<Runner> runner( InternalPlanner::indexScan( desc, start.obj(), end.obj(),
+                                                                 false, direction ) );
+
+            // Collect the batch before deleting anything, so the scan is never positioned on a
+            // record we removed.
+            const int batchSize = std::max( 1, ttlDeleteBatchSize );
+            vector<DiskLoc> batch;
+            BSONObj indexKey;
+            DiskLoc loc;
+            Runner::RunnerState state;
+            while ( static_cast<int>( batch.size() ) < batchSize &&
+                    Runner::RUNNER_ADVANCED == ( state = runner->getNext( &indexKey, &loc ) ) ) {
+                BSONElement e = indexKey.firstElement();
+                if ( e.type() != Date )
+                    continue;
+                if ( batch.empty() )
+                    *firstExpiry = e.date().millis;
+                batch.push_back( loc );
+            }
+            const bool more = static_cast<int>( batch.size() ) == batchSize;
+            runner.reset();
+
+            for ( size_t i = 0; i < batch.size(); ++i ) {
+                BSONObj deletedId;
+                collection->deleteDocument( batch[i], false, true, &deletedId );
+                if ( !deletedId.isEmpty() ) {
+                    logOp( "d", ns.c_str(), deletedId );
+                }
+                else {
+                    problem() << "TTL deleted object without id, not logging" << endl;
+                }
+                ++*deleted;
+            }
+            return more;
+        }
+
+        /**
+         * Sleeps between batches, with the write lock released, for as long as keeps this pass
+         * within ttlDeletesPerSecond, and for a while when other operations wait for the lock.
+         */
+        void throttle() {
+            long long micros = 2 * Client::recommendedYieldMicros();
+            const int deletesPerSecond = ttlDeletesPerSecond;
+            if ( deletesPerSecond > 0 ) {
+                long long due = _passDeleted * 1000000 / deletesPerSecond;
+                micros = std::max( micros, due - static_cast<long long>( _passTimer.micros() ) );
+            }
+            if ( micros > 0 ) {
+                LOG(2) << "TTL going to sleep for " << micros << " micros" << endl;
+                sleepmicros( micros );
+            }
+        }
+
+        /** Forgets the stats of indexes the last pass did not visit: they were dropped. */
+        void pruneStats() {
+            scoped_lock lk( ttlStatsMutex );
+            for ( TTLIndexStatsMap::iterator i = ttlStats.begin(); i != ttlStats.end(); ) {
+                if ( i->second.pass != _pass )
+                    ttlStats.erase( i++ );
+                else
+                    ++i;
+            }
         }
 
         virtual void run() {
@@ -167,6 +333,9 @@ namespace mongo {
                 }
                 
                 ttlPasses.increment();
+                ++_pass;
+                _passDeleted = 0;
+                _passTimer.reset();
 
                 for ( set<string>::const_iterator i=dbs.begin(); i!=dbs.end(); ++i ) {
                     string db = *i;
@@ -178,10 +347,16 @@ namespace mongo {
                     }
                 }
 
+                pruneStats();
             }
         }
 
         DBDirectClient db;
+
+    private:
+        long long _pass;
+        long long _passDeleted;
+        Timer _passTimer;
     };
 
     void startTTLBackgroundJob() {
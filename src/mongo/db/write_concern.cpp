@@ -183,7 +183,13 @@ namespace mongo {
 
                 verify( sprintf( buf , "w block pass: %lld" , ++passes ) < 30 );
                 c.curop()->setMessage( buf );
-                sleepmillis(1);
+
+                // woken by the slaves' position updates, but no longer than it takes to notice
+                // a timeout, an interruption or a step down
+                int waitMillis = 100;
+                if ( timeout > 0 )
+                    waitMillis = std::min( waitMillis, timeout - gleTimerHolder->millis() );
+                waitForOpReplicatedEnough( op, e, waitMillis );
                 killCurrentOp.checkForInterrupt();
             }
 
@@ -541,6 +541,126 @@ namespace AccumulatorTests {
         
     } // namespace Max
 
+    namespace Push {
+
+        class Base : public AccumulatorTests::Base {
+        protected:
+            void createAccumulator() {
+                _accumulator = AccumulatorPush::create();
+                ASSERT_EQUALS(string("$push"), _accumulator->getOpName());
+            }
+            Accumulator *accumulator() { return _accumulator.get(); }
+        private:
+            intrusive_ptr<Accumulator> _accumulator;
+        };
+
+        /** No values gives an empty array. */
+        class None : public Base {
+        public:
+            void run() {
+                createAccumulator();
+                assertBinaryEqual( BSON( "" << BSONArray() ),
+                                   fromValue( accumulator()->getValue(false) ) );
+            }
+        };
+
+        /** Values of each kind come back unchanged and in order, and missing ones are skipped. */
+        class Values : public Base {
+        public:
+            void run() {
+                createAccumulator();
+                BSONObj input = fromjson( "{a:[1, 'x', {b:2.5, c:[null, {d:4}]}, [5], {}]}" );
+                const Document doc (input);
+                const vector<Value>& values = doc["a"].getArray();
+                for (size_t i = 0; i < values.size(); i++) {
+                    accumulator()->process(values[i], false);
+                    accumulator()->process(Value(), false);
+                }
+                assertBinaryEqual( input.replaceFieldNames( BSON( "" << 1 ) ),
+                                   fromValue( accumulator()->getValue(false) ) );
+
+                // More values can be pushed after getValue(), and merged arrays are flattened.
+                accumulator()->process(Value(6LL), false);
+                accumulator()->process(Value(doc["a"]), true);
+                Value result = accumulator()->getValue(false);
+                ASSERT_EQUALS( 11U, result.getArrayLength() );
+                ASSERT_EQUALS( Value(6LL), result[5] );
+                ASSERT_EQUALS( values[2], result[8] );
+            }
+        };
+
+        /** Memory use grows with the values pushed, and reset() returns to the start. */
+        class MemUsage : public Base {
+        public:
+            void run() {
+                createAccumulator();
+                const int empty = accumulator()->memUsageForSorter();
+                const string big (10000, 'x');
+                accumulator()->process(Value(big), false);
+                ASSERT_GREATER_THAN_OR_EQUALS( accumulator()->memUsageForSorter(),
+                                               empty + static_cast<int>(big.size()) );
+                accumulator()->reset();
+                ASSERT_EQUALS( empty, accumulator()->memUsageForSorter() );
+                ASSERT_EQUALS( 0U, accumulator()->getValue(false).getArrayLength() );
+            }
+        };
+
+    } // namespace Push
+
+    namespace AddToSet {
+
+        class Base : public AccumulatorTests::Base {
+        protected:
+            void createAccumulator() {
+                _accumulator = AccumulatorAddToSet::create();
+                ASSERT_EQUALS(string("$addToSet"), _accumulator->getOpName());
+            }
+            Accumulator *accumulator() { return _accumulator.get(); }
+        private:
+            intrusive_ptr<Accumulator> _accumulator;
+        };
+
+        /** Each distinct value is kept once, including documents and arrays. */
+        class Distinct : public Base {
+        public:
+            void run() {
+                createAccumulator();
+                const Document doc (fromjson( "{a:[1, {b:2}, [3], 1.0, {b:2}, [3], 'x']}" ));
+                const vector<Value>& values = doc["a"].getArray();
+                for (size_t i = 0; i < values.size(); i++) {
+                    accumulator()->process(values[i], false);
+                }
+                accumulator()->process(Value(), false);
+
+                Value result = accumulator()->getValue(false);
+                ASSERT_EQUALS( 4U, result.getArrayLength() );
+                ValueSet set (result.getArray().begin(), result.getArray().end());
+                ASSERT_EQUALS( 1U, set.count( Value(1) ) );
+                ASSERT_EQUALS( 1U, set.count( values[1] ) );
+                ASSERT_EQUALS( 1U, set.count( values[2] ) );
+                ASSERT_EQUALS( 1U, set.count( Value("x") ) );
+            }
+        };
+
+        /** Memory use only grows when a new value is added. */
+        class MemUsage : public Base {
+        public:
+            void run() {
+                createAccumulator();
+                const string big (10000, 'x');
+                accumulator()->process(Value(big), false);
+                const int one = accumulator()->memUsageForSorter();
+                ASSERT_GREATER_THAN( one, static_cast<int>(big.size()) );
+                accumulator()->process(Value(big), false);
+                ASSERT_EQUALS( one, accumulator()->memUsageForSorter() );
+                accumulator()->process(Value(string(big + "y")), false);
+                ASSERT_GREATER_THAN( accumulator()->memUsageForSorter(),
+                                     one + static_cast<int>(big.size()) );
+            }
+        };
+
+    } // namespace AddToSet
+
     namespace Sum {
 
         class Base : public AccumulatorTests::Base {
@@ -826,6 +946,83 @@ namespace AccumulatorTests {
         
     } // namespace Sum
 
+    namespace Batch {
+
+        /** processBatch() gives the same result as process() on each input in turn. */
+        class Base : public AccumulatorTests::Base {
+        public:
+            virtual ~Base() {
+            }
+            void run() {
+                vector<Value> inputs = getInputs();
+
+                intrusive_ptr<Accumulator> oneByOne = create();
+                for (size_t i = 0; i < inputs.size(); ++i) {
+                    oneByOne->process(inputs[i], false);
+                }
+
+                // Split the inputs over two batches.
+                intrusive_ptr<Accumulator> batched = create();
+                const size_t half = inputs.size() / 2;
+                batched->processBatch(&inputs[0], half, false);
+                batched->processBatch(&inputs[half], inputs.size() - half, false);
+
+                assertBinaryEqual(fromValue(oneByOne->getValue(false)),
+                                  fromValue(batched->getValue(false)));
+                assertBinaryEqual(fromValue(oneByOne->getValue(true)),
+                                  fromValue(batched->getValue(true)));
+                ASSERT_EQUALS(oneByOne->memUsageForSorter(), batched->memUsageForSorter());
+            }
+        protected:
+            virtual intrusive_ptr<Accumulator> create() = 0;
+            virtual vector<Value> getInputs() {
+                vector<Value> inputs;
+                inputs.push_back(Value(5));
+                inputs.push_back(Value(BSONNULL));
+                inputs.push_back(Value(60000000000LL));
+                inputs.push_back(Value(-3));
+                inputs.push_back(Value(StringData("x")));
+                inputs.push_back(Value());
+                inputs.push_back(Value(2.5));
+                inputs.push_back(Value(7));
+                return inputs;
+            }
+        };
+
+        /** Ints only, so the sum stays an int. */
+        class SumInts : public Base {
+            intrusive_ptr<Accumulator> create() { return AccumulatorSum::create(); }
+            vector<Value> getInputs() {
+                vector<Value> inputs;
+                for (int i = 0; i < 10; ++i) {
+                    inputs.push_back(Value(i * 3));
+                }
+                return inputs;
+            }
+        };
+
+        class SumMixed : public Base {
+            intrusive_ptr<Accumulator> create() { return AccumulatorSum::create(); }
+        };
+
+        class AvgMixed : public Base {
+            intrusive_ptr<Accumulator> create() { return AccumulatorAvg::create(); }
+        };
+
+        class MinMixed : public Base {
+            intrusive_ptr<Accumulator> create() { return AccumulatorMinMax::createMin(); }
+        };
+
+        class MaxMixed : public Base {
+            intrusive_ptr<Accumulator> create() { return AccumulatorMinMax::createMax(); }
+        };
+
+        class PushMixed : public Base {
+            intrusive_ptr<Accumulator> create() { return AccumulatorPush::create(); }
+        };
+
+    } // namespace Batch
+
     class All : public Suite {
     public:
         All() : Suite( "accumulator" ) {
@@ -874,6 +1071,13 @@ namespace AccumulatorTests {
             add<Max::Two>();
             add<Max::LastMissing>();
 
+            add<Push::None>();
+            add<Push::Values>();
+            add<Push::MemUsage>();
+
+            add<AddToSet::Distinct>();
+            add<AddToSet::MemUsage>();
+
             add<Sum::None>();
             add<Sum::OneInt>();
             add<Sum::OneLong>();
@@ -902,6 +1106,13 @@ namespace AccumulatorTests {
             add<Sum::IntNull>();
             add<Sum::IntUndefined>();
             add<Sum::NoOverflowBeforeDouble>();
+
+            add<Batch::SumInts>();
+            add<Batch::SumMixed>();
+            add<Batch::AvgMixed>();
+            add<Batch::MinMixed>();
+            add<Batch::MaxMixed>();
+            add<Batch::PushMixed>();
         }
     } myall;
 
@@ -502,6 +502,19 @@ namespace BasicTests {
         }
     };
 
+    class QueueTryPushTest {
+    public:
+        void run() {
+            BlockingQueue<int> q( 3 );
+            ASSERT( q.tryPush( 1 ) );
+            ASSERT( q.tryPush( 2 ) );
+            ASSERT( ! q.tryPush( 3 ) );
+            ASSERT_EQUALS( 2 , q.count() );
+            ASSERT_EQUALS( 1 , q.blockingPop() );
+            ASSERT( q.tryPush( 3 ) );
+        }
+    };
+
     class StrTests {
     public:
 
@@ -587,6 +600,7 @@ namespace BasicTests {
             add< IsValidUTF8Test >();
 
             add< QueueTest >();
+            add< QueueTryPushTest >();
 
             add< StrTests >();
 
@@ -153,6 +153,42 @@
         }
     };
 
+    class MoveRecordLoc : public Base {
+    public:
+        void run() {
+            BSONObj key = simpleKey( 'b' );
+            for ( int i = 1; i <= 3; ++i ) {
+                bt()->bt_insert( dl(), DiskLoc( 0, 100 * i ), key, Ordering::make( order() ),
+                                 true, id(), true );
+            }
+            BSONObj other = simpleKey( 'c' );
+            insert( other );
+
+            // Between its equal neighbors, or with none, a key is pointed at its new record.
+            ASSERT( bt()->moveRecordLoc( dl(), id(), key, DiskLoc( 0, 200 ), DiskLoc( 0, 250 ) ) );
+            ASSERT( bt()->moveRecordLoc( dl(), id(), other, recordLoc(), DiskLoc( 0, 1000 ) ) );
+            ASSERT( found( key, DiskLoc( 0, 250 ) ) );
+            ASSERT( !found( key, DiskLoc( 0, 200 ) ) );
+            ASSERT( found( other, DiskLoc( 0, 1000 ) ) );
+
+            // Past a neighbor, or missing, it is left alone.
+            ASSERT( !bt()->moveRecordLoc( dl(), id(), key, DiskLoc( 0, 250 ), DiskLoc( 0, 350 ) ) );
+            ASSERT( !bt()->moveRecordLoc( dl(), id(), key, DiskLoc( 0, 100 ), DiskLoc( 0, 300 ) ) );
+            ASSERT( !bt()->moveRecordLoc( dl(), id(), key, DiskLoc( 0, 200 ), DiskLoc( 0, 220 ) ) );
+            ASSERT( found( key, DiskLoc( 0, 250 ) ) );
+            ASSERT( found( key, DiskLoc( 0, 100 ) ) );
+
+            checkValid( 4 );
+        }
+    private:
+        bool found( const BSONObj& key, const DiskLoc& loc ) {
+            int pos;
+            bool isFound;
+            bt()->locate( id(), dl(), key, Ordering::make( order() ), pos, isFound, loc, 1 );
+            return isFound;
+        }
+    };
+
     class SplitUnevenBucketBase : public Base {
     public:
         virtual ~SplitUnevenBucketBase() {}
@@ -1636,6 +1672,7 @@
         void setupTests() {
             add< Create >();
             add< SimpleInsertDelete >();
+            add< MoveRecordLoc >();
             add< SplitRightHeavyBucket >();
             add< SplitLeftHeavyBucket >();
             add< MissingLocate >();
@@ -32,6 +32,7 @@ namespace mongo {
         void setSingleChunkForShards( const vector<BSONObj> &splitPoints ) {
             ChunkMap &chunkMap = const_cast<ChunkMap&>( _chunkMap );
             ChunkRangeManager &chunkRanges = const_cast<ChunkRangeManager&>( _chunkRanges );
+            ChunkRoutingTable &routingTable = const_cast<ChunkRoutingTable&>( _routingTable );
             set<Shard> &shards = const_cast<set<Shard>&>( _shards );
             
             vector<BSONObj> mySplitPoints( splitPoints );
@@ -49,6 +50,7 @@ namespace mongo {
             }
             
             chunkRanges.reloadAll( chunkMap );
+            routingTable.reloadAll( chunkMap );
         }
     };
     
@@ -235,6 +237,73 @@ namespace ChunkTests {
             }
         };
 
+        /** findIntersectingChunk() finds the chunk of each point, bounds included */
+        class FindIntersectingChunkBase {
+        public:
+            virtual ~FindIntersectingChunkBase() {}
+            void run() {
+                ChunkManager chunkManager;
+                chunkManager.setShardKey( shardKey() );
+                chunkManager.setSingleChunkForShards( splitPoints() );
+
+                BSONObjIterator i( points() );
+                while( i.more() ) {
+                    BSONObj pointAndShard = i.next().Obj();
+                    BSONObj point = pointAndShard["point"].wrap( shardKey().firstElementFieldName() );
+                    ASSERT_EQUALS( pointAndShard["shard"].String(),
+                                   chunkManager.findIntersectingChunk( point )->getShard().getName() );
+                }
+            }
+        protected:
+            virtual BSONObj shardKey() const = 0;
+            virtual vector<BSONObj> splitPoints() const = 0;
+            virtual BSONArray points() const = 0;
+        };
+
+        class FindIntersectingChunkBSON : public FindIntersectingChunkBase {
+            virtual BSONObj shardKey() const { return BSON( "a" << 1 ); }
+            virtual vector<BSONObj> splitPoints() const {
+                vector<BSONObj> ret;
+                ret.push_back( BSON( "a" << 10 ) );
+                ret.push_back( BSON( "a" << "x" ) );
+                return ret;
+            }
+            virtual BSONArray points() const {
+                return BSON_ARRAY( BSON( "point" << MINKEY << "shard" << "0" ) <<
+                                   BSON( "point" << -5 << "shard" << "0" ) <<
+                                   BSON( "point" << 10 << "shard" << "1" ) <<
+                                   BSON( "point" << 10.5 << "shard" << "1" ) <<
+                                   BSON( "point" << "a" << "shard" << "1" ) <<
+                                   BSON( "point" << "x" << "shard" << "2" ) <<
+                                   BSON( "point" << BSON( "b" << 1 ) << "shard" << "2" ) );
+            }
+        };
+
+        /** chunks of a hashed shard key, bounded by NumberLongs, route NumberLongs as int64s */
+        class FindIntersectingChunkInt64 : public FindIntersectingChunkBase {
+            virtual BSONObj shardKey() const { return BSON( "a" << "hashed" ); }
+            virtual vector<BSONObj> splitPoints() const {
+                vector<BSONObj> ret;
+                ret.push_back( BSON( "a" << -1000LL ) );
+                ret.push_back( BSON( "a" << 0LL ) );
+                ret.push_back( BSON( "a" << 1000LL ) );
+                return ret;
+            }
+            virtual BSONArray points() const {
+                return BSON_ARRAY( BSON( "point" << std::numeric_limits<long long>::min() <<
+                                         "shard" << "0" ) <<
+                                   BSON( "point" << -1001LL << "shard" << "0" ) <<
+                                   BSON( "point" << -1000LL << "shard" << "1" ) <<
+                                   BSON( "point" << -1LL << "shard" << "1" ) <<
+                                   BSON( "point" << 0LL << "shard" << "2" ) <<
+                                   BSON( "point" << 0 << "shard" << "2" ) <<
+                                   BSON( "point" << 999.5 << "shard" << "2" ) <<
+                                   BSON( "point" << 1000LL << "shard" << "3" ) <<
+                                   BSON( "point" << std::numeric_limits<long long>::max() <<
+                                         "shard" << "3" ) );
+            }
+        };
+
     } // namespace ChunkManagerTests
     
     class All : public Suite {
@@ -263,6 +332,8 @@ namespace ChunkTests {
             add<ChunkManagerTests::InequalityThenUnsatisfiable>();
             add<ChunkManagerTests::OrEqualityUnsatisfiableInequality>();
             add<ChunkManagerTests::InMultiShard>();
+            add<ChunkManagerTests::FindIntersectingChunkBSON>();
+            add<ChunkManagerTests::FindIntersectingChunkInt64>();
         }
     } myall;
     
@@ -697,6 +697,51 @@ namespace CursorTests {
             }
         };
 
+        /** invalidate() destroys the cursors over the namespace, and only those. */
+        class InvalidateNamespace : public Base {
+        public:
+            virtual ~InvalidateNamespace() {
+                client.dropCollection( subNs() );
+                client.dropCollection( siblingNs() );
+            }
+            void run() {
+                client.insert( ns(), BSON( "a" << 1 ) );
+                client.insert( subNs(), BSON( "a" << 1 ) );
+                client.insert( siblingNs(), BSON( "a" << 1 ) );
+
+                Client::WriteContext ctx( ns() );
+                ClientCursorHolder cursor( newCursor( ns() ) );
+                ClientCursorHolder subCursor( newCursor( subNs() ) );
+                ClientCursorHolder siblingCursor( newCursor( siblingNs() ) );
+                CursorId id = cursor->cursorid();
+
+                ClientCursor::invalidate( ns() );
+                ASSERT( !ClientCursor::find( id, false ) );
+                assertCursors( subNs(), 1 );
+                assertCursors( siblingNs(), 1 );
+                ASSERT( subCursor.get() );
+                ASSERT( siblingCursor.get() );
+
+                // Invalidating the db gets the rest.
+                ClientCursor::invalidate( "unittests." );
+                assertCursors( subNs(), 0 );
+                assertCursors( siblingNs(), 0 );
+            }
+        private:
+            static string subNs() { return string( ns() ) + ".sub"; }
+            static string siblingNs() { return string( ns() ) + "X"; }
+            static ClientCursor* newCursor( const string& ns ) {
+                boost::shared_ptr<Cursor> c = theDataFileMgr.findAll( ns );
+                ASSERT( c );
+                return new ClientCursor( QueryOption_NoCursorTimeout, c, ns );
+            }
+            static void assertCursors( const string& ns, size_t expected ) {
+                set<CursorId> ids;
+                ClientCursor::find( ns, ids );
+                ASSERT_EQUALS( expected, ids.size() );
+            }
+        };
+
         namespace Pin {
 
             class Base {
@@ -794,6 +839,7 @@ namespace CursorTests {
             add<ClientCursor::AboutToDelete>();
             add<ClientCursor::AboutToDeleteDuplicate>();
             add<ClientCursor::AboutToDeleteDuplicateNextClause>();
+            add<ClientCursor::InvalidateNamespace>();
             add<ClientCursor::Pin::PinCursor>();
             add<ClientCursor::Pin::PinTwice>();
             add<ClientCursor::Pin::CursorDeleted>();
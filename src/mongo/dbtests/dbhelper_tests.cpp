@@ -21,6 +21,8 @@
 
 namespace mongo {
 
+    extern int rangeDeleterBatchSize;
+
     /**
      * Unit tests related to DBHelpers
      */
@@ -79,6 +81,38 @@ namespace mongo {
         int _max;
     };
 
+    /** Helpers::RemoveRange over more documents than fit in one batch. */
+    class RemoveRangeBatches {
+    public:
+        void run() {
+            client.dropCollection( ns );
+            for ( int i = 0; i < 1000; ++i ) {
+                client.insert( ns, BSON( "_id" << i ) );
+            }
+
+            int oldBatchSize = rangeDeleterBatchSize;
+            rangeDeleterBatchSize = 7;
+            long long numDeleted;
+            {
+                // Remove _id range [100, 900].
+                Lock::DBWrite lk( ns );
+                Client::Context ctx( ns );
+                KeyRange range( ns,
+                                BSON( "_id" << 100 ),
+                                BSON( "_id" << 900 ),
+                                BSON( "_id" << 1 ) );
+                numDeleted = Helpers::removeRange( range, true );
+            }
+            rangeDeleterBatchSize = oldBatchSize;
+
+            ASSERT_EQUALS( 801, numDeleted );
+            ASSERT_EQUALS( 199U, client.count( ns ) );
+            ASSERT_EQUALS( 0U, client.count( ns, BSON( "_id" << GTE << 100 << LTE << 900 ) ) );
+            ASSERT_EQUALS( 99, client.findOne( ns, Query( BSON( "_id" << LT << 100 ) )
+                                                       .sort( BSON( "_id" << -1 ) ) )["_id"].numberInt() );
+        }
+    };
+
     class All: public Suite {
     public:
         All() :
@@ -87,6 +121,7 @@ namespace mongo {
         }
         void setupTests() {
             add<RemoveRange>();
+            add<RemoveRangeBatches>();
         }
     } myall;
 
@@ -316,6 +316,41 @@ namespace DocumentSourceTests {
             }
         };
 
+        class SkipCoalesce : public Base {
+        public:
+            void run() {
+                for (int i = 0; i < 5; i++) {
+                    client.insert( ns, BSON( "a" << i ) );
+                }
+                createSource();
+
+                ASSERT(source()->coalesce(DocumentSourceSkip::create(ctx())));
+                ASSERT_EQUALS(source()->getSkip(), 0);
+
+                // a limit after a skip also counts the skipped documents
+                intrusive_ptr<DocumentSourceSkip> skip = DocumentSourceSkip::create(ctx());
+                skip->setSkip(1);
+                ASSERT(source()->coalesce(skip));
+                ASSERT(source()->coalesce(DocumentSourceLimit::create(ctx(), 3)));
+                ASSERT_EQUALS(source()->getSkip(), 1);
+                ASSERT_EQUALS(source()->getLimit(), 4);
+
+                // skips add up
+                ASSERT(source()->coalesce(skip));
+                ASSERT_EQUALS(source()->getSkip(), 2);
+                ASSERT_EQUALS(source()->getLimit(), 4);
+
+                // The cursor lets through the third and fourth documents
+                boost::optional<Document> next = source()->getNext();
+                ASSERT(bool(next));
+                ASSERT_EQUALS(2, next->getField("a").getInt());
+                next = source()->getNext();
+                ASSERT(bool(next));
+                ASSERT_EQUALS(3, next->getField("a").getInt());
+                ASSERT(!source()->getNext());
+            }
+        };
+
 
     } // namespace DocumentSourceCursor
 
@@ -851,6 +886,64 @@ namespace DocumentSourceTests {
             }
         };
 
+        /** Whether a sort keeps documents with the same _id together. */
+        class GroupedBySort : public Base {
+        public:
+            void run() {
+                createGroup( fromjson( "{_id:'$x',a:{$sum:'$y'}}" ) );
+                ASSERT( groupedBy( "{x:1}" ) );
+                ASSERT( groupedBy( "{x:-1,y:1}" ) );
+                ASSERT( groupedBy( "{x:1}", true ) );
+                ASSERT( !groupedBy( "{y:1,x:1}" ) );
+                ASSERT( !groupedBy( "{'x.z':1}" ) );
+
+                createGroup( fromjson( "{_id:{a:'$x',b:'$y.z'},c:{$sum:1}}" ) );
+                ASSERT( groupedBy( "{'y.z':1,x:-1}" ) );
+                ASSERT( groupedBy( "{x:1,'y.z':1,w:1}" ) );
+                ASSERT( !groupedBy( "{x:1}" ) );
+                ASSERT( !groupedBy( "{x:1,w:1,'y.z':1}" ) );
+                // Missing fields are indexed as null, which this _id tells apart.
+                ASSERT( !groupedBy( "{x:1,'y.z':1}", true ) );
+
+                createGroup( fromjson( "{_id:{a:'$x',b:{$add:['$y',1]}},c:{$sum:1}}" ) );
+                ASSERT( !groupedBy( "{x:1,y:1}" ) );
+
+                createGroup( fromjson( "{_id:'$$ROOT',c:{$sum:1}}" ) );
+                ASSERT( !groupedBy( "{x:1}" ) );
+            }
+        private:
+            bool groupedBy( const char* sortPattern, bool indexOrder = false ) {
+                return static_cast<DocumentSourceGroup*>( group() )->isGroupedBy(
+                        fromjson( sortPattern ), indexOrder );
+            }
+        };
+
+        /** A streaming group outputs a group each time the _id changes. */
+        class Streaming : public Base {
+        public:
+            void run() {
+                BSONObj sourceData =
+                        fromjson( "{'':[{x:1,y:1},{x:1,y:2},{y:3},{x:null,y:4},{x:3,y:5}]}" );
+                intrusive_ptr<DocumentSourceBsonArray> source =
+                        DocumentSourceBsonArray::create( sourceData.firstElement().Obj(), ctx() );
+                createGroup( fromjson( "{_id:'$x',y:{$push:'$y'}}" ) );
+                static_cast<DocumentSourceGroup*>( group() )->setStreaming( true );
+                group()->setSource( source.get() );
+
+                boost::optional<Document> next = group()->getNext();
+                ASSERT( bool( next ) );
+                ASSERT_EQUALS( fromjson( "{_id:1,y:[1,2]}" ), next->toBson() );
+                next = group()->getNext();
+                ASSERT( bool( next ) );
+                // A missing _id is the same as null.
+                ASSERT_EQUALS( fromjson( "{_id:null,y:[3,4]}" ), next->toBson() );
+                next = group()->getNext();
+                ASSERT( bool( next ) );
+                ASSERT_EQUALS( fromjson( "{_id:3,y:[5]}" ), next->toBson() );
+                assertExhausted( group() );
+            }
+        };
+
         /**
          * A string constant (not a field path) as an _id expression and passed to an accumulator.
          * SERVER-6766
@@ -1869,6 +1962,7 @@ namespace DocumentSourceTests {
             add<DocumentSourceCursor::IterateDispose>();
             add<DocumentSourceCursor::Yield>();
             add<DocumentSourceCursor::LimitCoalesce>();
+            add<DocumentSourceCursor::SkipCoalesce>();
 
             add<DocumentSourceLimit::DisposeSource>();
             add<DocumentSourceLimit::DisposeSourceCascade>();
@@ -1907,6 +2001,8 @@ namespace DocumentSourceTests {
             add<DocumentSourceGroup::UndefinedAccumulatorValue>();
             add<DocumentSourceGroup::RouterMerger>();
             add<DocumentSourceGroup::Dependencies>();
+            add<DocumentSourceGroup::GroupedBySort>();
+            add<DocumentSourceGroup::Streaming>();
             add<DocumentSourceGroup::StringConstantIdAndAccumulatorExpressions>();
             add<DocumentSourceGroup::ArrayConstantAccumulatorExpression>();
 
@@ -18,6 +18,8 @@
 
 #include "mongo/pch.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/value.h"
@@ -75,7 +77,74 @@ namespace DocumentTests {
                 ASSERT_EQUALS( "b", getNthField(document, 1).first.toString() );
                 ASSERT_EQUALS( "q", getNthField(document, 1).second.getString() );
                 assertRoundTrips( document );
-            }            
+            }
+        };
+
+        /** A Document from a BSONObj reads its fields as they are needed. */
+        class CreateFromBsonObjLazily {
+        public:
+            void run() {
+                BSONObj obj = fromjson( "{a:1, b:{c:'x', d:[{e:2}, 3]}, f:4}" );
+                const Document document = fromBson( obj );
+
+                // The last field is found before the others are iterated.
+                ASSERT_EQUALS( Value(4), document["f"] );
+                ASSERT_EQUALS( Value(2), document.getNestedField(FieldPath("b.d")).getArray()[0]
+                                                 .getDocument()["e"] );
+                ASSERT( document["z"].missing() );
+                ASSERT_EQUALS( 3U, document.size() );
+                ASSERT_EQUALS( "b", getNthField(document, 1).first.toString() );
+                ASSERT_EQUALS( obj, toBson( document ) );
+
+                // Changing a copy leaves the original and its BSON alone.
+                MutableDocument md (document);
+                md.setField( "a", Value(5) );
+                md.setNestedField( FieldPath("b.c"), Value(6) );
+                const Document changed = md.freeze();
+                ASSERT_EQUALS( obj, toBson( document ) );
+                ASSERT_EQUALS( fromjson( "{a:5, b:{c:6, d:[{e:2}, 3]}, f:4}" ), toBson( changed ) );
+                ASSERT_EQUALS( Value(1), document["a"] );
+                ASSERT_EQUALS( Value("x"), document.getNestedField(FieldPath("b.c")) );
+                assertRoundTrips( changed );
+            }
+        };
+
+        void makeDocuments( vector<Document>* documents ) {
+            for ( int i = 0; i < 100; ++i ) {
+                documents->push_back( DOC( "a" << i << "b" << DOC_ARRAY( i << "x" ) ) );
+            }
+        }
+
+        /** The storage of released Documents and arrays is reused, also across threads. */
+        class RecycledStorage {
+        public:
+            void run() {
+                // Use up any storage released by earlier tests, so there is room for more.
+                vector<Document> documents;
+                makeDocuments( &documents );
+
+                const void* released;
+                {
+                    const Document document = DOC( "a" << 1 );
+                    released = document.getPtr();
+                }
+                const Document reused = DOC( "b" << DOC_ARRAY( 2 ) );
+                ASSERT_EQUALS( released, reused.getPtr() );
+                ASSERT_EQUALS( fromjson( "{b:[2]}" ), toBson( reused ) );
+                documents.clear();
+
+                boost::thread maker( boost::bind( makeDocuments, &documents ) );
+                maker.join();
+                ASSERT_EQUALS( 100U, documents.size() );
+                ASSERT_EQUALS( fromjson( "{a:99, b:[99, 'x']}" ), toBson( documents.back() ) );
+                documents.clear();
+
+                makeDocuments( &documents );
+                for ( int i = 0; i < 100; ++i ) {
+                    ASSERT_EQUALS( BSON( "a" << i << "b" << BSON_ARRAY( i << "x" ) ),
+                                   toBson( documents[i] ) );
+                }
+            }
         };
 
         /** Add Document fields. */
@@ -1405,6 +1474,8 @@ namespace DocumentTests {
         void setupTests() {
             add<Document::Create>();
             add<Document::CreateFromBsonObj>();
+            add<Document::CreateFromBsonObjLazily>();
+            add<Document::RecycledStorage>();
             add<Document::AddField>();
             add<Document::GetValue>();
             add<Document::SetField>();
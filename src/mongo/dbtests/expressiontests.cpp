@@ -867,6 +867,71 @@ namespace ExpressionTests {
         
     } // namespace Compare
     
+    namespace Cond {
+
+        class OptimizeBase {
+        public:
+            virtual ~OptimizeBase() {
+            }
+            void run() {
+                BSONObj specObject = BSON( "" << spec() );
+                BSONElement specElement = specObject.firstElement();
+                VariablesIdGenerator idGenerator;
+                VariablesParseState vps(&idGenerator);
+                intrusive_ptr<Expression> expression = Expression::parseOperand(specElement, vps);
+                ASSERT_EQUALS( constify( spec() ), expressionToBson( expression ) );
+                intrusive_ptr<Expression> optimized = expression->optimize();
+                ASSERT_EQUALS( expectedOptimized(), expressionToBson( optimized ) );
+            }
+        protected:
+            virtual BSONObj spec() = 0;
+            virtual BSONObj expectedOptimized() = 0;
+        };
+
+        class NoOptimizeBase : public OptimizeBase {
+            BSONObj expectedOptimized() { return constify( spec() ); }
+        };
+
+        /** A true constant condition is replaced by the 'then' branch. */
+        class OptimizeTrueCondition : public OptimizeBase {
+            BSONObj spec() {
+                return BSON( "$cond" << BSON_ARRAY( true << BSON( "$add" << BSON_ARRAY( "$a" << 1 ) )
+                                                         << BSON( "$add" << BSON_ARRAY( "$b" << 1 ) ) ) );
+            }
+            BSONObj expectedOptimized() {
+                return BSON( "$add" << BSON_ARRAY( "$a" << BSON( "$const" << 1 ) ) );
+            }
+        };
+
+        /** A false constant condition is replaced by the 'else' branch. */
+        class OptimizeFalseCondition : public OptimizeBase {
+            BSONObj spec() {
+                return BSON( "$cond" << BSON_ARRAY( BSON( "$eq" << BSON_ARRAY( 1 << 2 ) )
+                                                    << BSON( "$add" << BSON_ARRAY( "$a" << 1 ) )
+                                                    << BSON( "$add" << BSON_ARRAY( "$b" << 1 ) ) ) );
+            }
+            BSONObj expectedOptimized() {
+                return BSON( "$add" << BSON_ARRAY( "$b" << BSON( "$const" << 1 ) ) );
+            }
+        };
+
+        /** A condition that depends on the document is kept. */
+        class NonConstantCondition : public NoOptimizeBase {
+            BSONObj spec() {
+                return BSON( "$cond" << BSON_ARRAY( "$a" << BSON( "$add" << BSON_ARRAY( "$b" << 1 ) )
+                                                         << "$c" ) );
+            }
+        };
+
+        /** A Document expression doesn't replace the $cond. */
+        class ObjectBranch : public NoOptimizeBase {
+            BSONObj spec() {
+                return BSON( "$cond" << BSON_ARRAY( true << BSON( "x" << "$a" ) << "$b" ) );
+            }
+        };
+
+    } // namespace Cond
+
     namespace Constant {
 
         /** Create an ExpressionConstant from a Value. */
@@ -1180,6 +1245,55 @@ namespace ExpressionTests {
         
     } // namespace FieldPath
 
+    namespace IfNull {
+
+        class OptimizeBase {
+        public:
+            virtual ~OptimizeBase() {
+            }
+            void run() {
+                BSONObj specObject = BSON( "" << spec() );
+                BSONElement specElement = specObject.firstElement();
+                VariablesIdGenerator idGenerator;
+                VariablesParseState vps(&idGenerator);
+                intrusive_ptr<Expression> expression = Expression::parseOperand(specElement, vps);
+                ASSERT_EQUALS( constify( spec() ), expressionToBson( expression ) );
+                intrusive_ptr<Expression> optimized = expression->optimize();
+                ASSERT_EQUALS( expectedOptimized(), expressionToBson( optimized ) );
+            }
+        protected:
+            virtual BSONObj spec() = 0;
+            virtual BSONObj expectedOptimized() = 0;
+        };
+
+        class NoOptimizeBase : public OptimizeBase {
+            BSONObj expectedOptimized() { return constify( spec() ); }
+        };
+
+        /** A non null constant first operand is the result. */
+        class OptimizeNonNull : public OptimizeBase {
+            BSONObj spec() { return BSON( "$ifNull" << BSON_ARRAY( "x" << "$a" ) ); }
+            BSONObj expectedOptimized() { return BSON( "$const" << "x" ); }
+        };
+
+        /** A null constant first operand is replaced by the second operand. */
+        class OptimizeNull : public OptimizeBase {
+            BSONObj spec() {
+                return BSON( "$ifNull" << BSON_ARRAY( BSONNULL
+                                                      << BSON( "$add" << BSON_ARRAY( "$a" << 1 ) ) ) );
+            }
+            BSONObj expectedOptimized() {
+                return BSON( "$add" << BSON_ARRAY( "$a" << BSON( "$const" << 1 ) ) );
+            }
+        };
+
+        /** A first operand that depends on the document is kept. */
+        class NonConstant : public NoOptimizeBase {
+            BSONObj spec() { return BSON( "$ifNull" << BSON_ARRAY( "$a" << 1 ) ); }
+        };
+
+    } // namespace IfNull
+
 
     namespace Nary {
 
@@ -3084,6 +3198,127 @@ namespace ExpressionTests {
         };
     } // namespace Set
 
+    namespace Shared {
+
+        /**
+         * Shares the common subexpressions of the optimized expressions in spec(), then checks
+         * their values for each of the documents in inputs().
+         */
+        class Base {
+        public:
+            virtual ~Base() {
+            }
+            void run() {
+                VariablesIdGenerator idGenerator;
+                VariablesParseState vps(&idGenerator);
+                vector<intrusive_ptr<Expression> > expressions;
+                const BSONArray specs = spec();
+                BSONForEach(specElement, specs) {
+                    expressions.push_back(Expression::parseOperand(specElement, vps)->optimize());
+                }
+
+                BSONArrayBuilder unshared;
+                vector<intrusive_ptr<Expression>*> toShare;
+                for (size_t i = 0; i < expressions.size(); i++) {
+                    expressions[i]->serialize(false).addToBsonArray(&unshared);
+                    toShare.push_back(&expressions[i]);
+                }
+
+                const size_t numShared = Expression::shareCommonSubexpressions(toShare);
+                ASSERT_EQUALS( expectedNumShared(), numShared );
+
+                // Sharing doesn't show in the serialized expressions.
+                BSONArrayBuilder serialized;
+                for (size_t i = 0; i < expressions.size(); i++) {
+                    expressions[i]->serialize(false).addToBsonArray(&serialized);
+                }
+                ASSERT_EQUALS( unshared.arr(), serialized.arr() );
+
+                Variables vars(idGenerator.getIdCount());
+                vars.setNumSharedValues(numShared);
+                const BSONArray documents = inputs();
+                BSONForEach(inputElement, documents) {
+                    const BSONObj input = inputElement.Obj();
+                    vars.setRoot(fromBson(input["root"].Obj()));
+                    BSONArrayBuilder results;
+                    for (size_t i = 0; i < expressions.size(); i++) {
+                        expressions[i]->evaluate(&vars).addToBsonArray(&results);
+                    }
+                    ASSERT_EQUALS( input["expected"].Obj(), results.arr() );
+                    vars.clearRoot();
+                }
+            }
+        protected:
+            virtual BSONArray spec() = 0;
+            virtual size_t expectedNumShared() = 0;
+            virtual BSONArray inputs() = 0;
+        };
+
+        /** A subexpression of two expressions is shared. */
+        class AcrossExpressions : public Base {
+            BSONArray spec() {
+                return BSON_ARRAY( BSON( "$add" << BSON_ARRAY( "$a" << "$b" ) )
+                                   << BSON( "$multiply" << BSON_ARRAY(
+                                                BSON( "$add" << BSON_ARRAY( "$a" << "$b" ) )
+                                                << 2 ) ) );
+            }
+            size_t expectedNumShared() { return 1; }
+            BSONArray inputs() {
+                return BSON_ARRAY( BSON( "root" << BSON( "a" << 1 << "b" << 2 )
+                                         << "expected" << BSON_ARRAY( 3 << 6 ) )
+                                   << BSON( "root" << BSON( "a" << 5 << "b" << 5 )
+                                            << "expected" << BSON_ARRAY( 10 << 20 ) ) );
+            }
+        };
+
+        /** A subexpression repeated within one expression is shared, including in a branch. */
+        class WithinExpression : public Base {
+            BSONArray spec() {
+                BSONObj added = BSON( "$add" << BSON_ARRAY( "$a" << 1 ) );
+                return BSON_ARRAY( BSON( "$cond" << BSON_ARRAY(
+                                                BSON( "$gt" << BSON_ARRAY( added << 5 ) )
+                                                << added << 0 ) ) );
+            }
+            size_t expectedNumShared() { return 1; }
+            BSONArray inputs() {
+                return BSON_ARRAY( BSON( "root" << BSON( "a" << 10 )
+                                         << "expected" << BSON_ARRAY( 11 ) )
+                                   << BSON( "root" << BSON( "a" << 1 )
+                                            << "expected" << BSON_ARRAY( 0 ) ) );
+            }
+        };
+
+        /** Field paths, constants and expressions of different types aren't shared. */
+        class NothingShared : public Base {
+            BSONArray spec() {
+                return BSON_ARRAY( "$a" << "$a"
+                                   << BSON( "$add" << BSON_ARRAY( "$a" << 1 ) )
+                                   << BSON( "$add" << BSON_ARRAY( "$a" << 1.0 ) ) );
+            }
+            size_t expectedNumShared() { return 0; }
+            BSONArray inputs() {
+                return BSON_ARRAY( BSON( "root" << BSON( "a" << 1 )
+                                         << "expected" << BSON_ARRAY( 1 << 1 << 2 << 2.0 ) ) );
+            }
+        };
+
+        /** A subexpression that reads a variable besides ROOT isn't shared. */
+        class UserVariable : public Base {
+            BSONArray spec() {
+                BSONObj let = BSON( "$let" << BSON( "vars" << BSON( "x" << "$a" )
+                                                    << "in" << BSON( "$add" << BSON_ARRAY( "$$x"
+                                                                                           << 1 ) ) ) );
+                return BSON_ARRAY( let << let );
+            }
+            size_t expectedNumShared() { return 0; }
+            BSONArray inputs() {
+                return BSON_ARRAY( BSON( "root" << BSON( "a" << 1 )
+                                         << "expected" << BSON_ARRAY( 2 << 2 ) ) );
+            }
+        };
+
+    } // namespace Shared
+
     namespace Strcasecmp {
 
         class ExpectedResultBase {
@@ -3512,6 +3747,10 @@ namespace ExpressionTests {
             add<Compare::OptimizeGtReverse>();
             add<Compare::OptimizeGte>();
             add<Compare::OptimizeGteReverse>();
+            add<Cond::OptimizeTrueCondition>();
+            add<Cond::OptimizeFalseCondition>();
+            add<Cond::NonConstantCondition>();
+            add<Cond::ObjectBranch>();
 
             add<Constant::Create>();
             add<Constant::CreateFromBsonElement>();
@@ -3541,6 +3780,9 @@ namespace ExpressionTests {
             add<FieldPath::ExpandNestedArrays>();
             add<FieldPath::AddToBsonObj>();
             add<FieldPath::AddToBsonArray>();
+            add<IfNull::OptimizeNonNull>();
+            add<IfNull::OptimizeNull>();
+            add<IfNull::NonConstant>();
 
             add<Nary::AddOperand>();
             add<Nary::Dependencies>();
@@ -3707,6 +3949,10 @@ namespace ExpressionTests {
             add<Set::RightArgEmpty>();
             add<Set::ManyArgs>();
             add<Set::ManyArgsEqual>();
+            add<Shared::AcrossExpressions>();
+            add<Shared::WithinExpression>();
+            add<Shared::NothingShared>();
+            add<Shared::UserVariable>();
 
             add<AllAnyElements::JustFalse>();
             add<AllAnyElements::JustTrue>();
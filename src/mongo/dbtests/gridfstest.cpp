@@ -21,6 +21,7 @@
 #include "mongo/util/assert_util.h"
 
 using mongo::DBDirectClient;
+using mongo::GridFile;
 using mongo::GridFS;
 using mongo::MsgAssertionException;
 
@@ -41,6 +42,44 @@ namespace {
         virtual ~SetChunkSizeTest() {}
     };
 
+    class RangeReadTest {
+    public:
+        virtual void run() {
+            GridFS grid( _client, "gridtest" );
+            grid.setChunkSize( 5 );
+            const std::string data = "abcdefghijklmnopqrstuvw";
+            grid.storeFile( data.c_str(), data.size(), "rangeRead" );
+
+            GridFile file = grid.findFile( "rangeRead" );
+            ASSERT( file.exists() );
+            ASSERT_EQUALS( 5, file.getNumChunks() );
+
+            std::ostringstream all;
+            ASSERT_EQUALS( data.size(), file.write( all ) );
+            ASSERT_EQUALS( data, all.str() );
+
+            // Within a chunk, across chunks, and past the end.
+            std::ostringstream within;
+            ASSERT_EQUALS( 2U, file.writeRange( within, 6, 8 ) );
+            ASSERT_EQUALS( "gh", within.str() );
+
+            std::ostringstream across;
+            ASSERT_EQUALS( 10U, file.writeRange( across, 3, 13 ) );
+            ASSERT_EQUALS( data.substr( 3, 10 ), across.str() );
+
+            std::ostringstream tail;
+            ASSERT_EQUALS( 3U, file.writeRange( tail, 20, 100 ) );
+            ASSERT_EQUALS( "uvw", tail.str() );
+
+            std::ostringstream none;
+            ASSERT_EQUALS( 0U, file.writeRange( none, 30, 40 ) );
+
+            grid.removeFile( "rangeRead" );
+        }
+
+        virtual ~RangeReadTest() {}
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "gridfs" ) {
@@ -48,6 +87,7 @@ namespace {
 
         void setupTests() {
             add< SetChunkSizeTest >();
+            add< RangeReadTest >();
         }
     } myall;
 }
@@ -29,6 +29,10 @@
 
 #include "mongo/dbtests/dbtests.h"
 
+namespace mongo {
+    extern int indexBuildKeyGenerationThreads;
+} // namespace mongo
+
 namespace IndexUpdateTests {
 
     static const char* const _ns = "unittests.indexupdate";
@@ -159,6 +163,40 @@ namespace IndexUpdateTests {
         bool _mayInterrupt;
     };
 
+    /** addKeysToPhaseOne() gets keys on several threads, in batches, for a btree index. */
+    class ParallelAddKeysToPhaseOne : public IndexBuildBase {
+    public:
+        ParallelAddKeysToPhaseOne() : _oldThreads( indexBuildKeyGenerationThreads ) {
+            indexBuildKeyGenerationThreads = 4;
+        }
+        ~ParallelAddKeysToPhaseOne() {
+            indexBuildKeyGenerationThreads = _oldThreads;
+        }
+        void run() {
+            // More documents than fit in one batch, with two keys each.
+            int32_t nDocs = 10000;
+            for( int32_t i = 0; i < nDocs; ++i ) {
+                _client.insert( _ns, BSON( "a" << BSON_ARRAY( i << -i - 1 ) ) );
+            }
+            IndexDescriptor* id = addIndexWithInfo();
+            SortPhaseOne phaseOne;
+            ProgressMeterHolder pm (cc().curop()->setMessage("ParallelAddKeysToPhaseOne",
+                                                             "ParallelAddKeysToPhaseOne Progress",
+                                                             nDocs,
+                                                             nDocs));
+            BtreeBasedBuilder::addKeysToPhaseOne( collection(),
+                                                  id,
+                                                  BSON( "a" << 1 ),
+                                                  &phaseOne,
+                                                  pm.get(), true );
+            ASSERT_EQUALS( static_cast<uint64_t>( nDocs ), phaseOne.n );
+            ASSERT_EQUALS( static_cast<uint64_t>( 2 * nDocs ), phaseOne.nkeys );
+            ASSERT( phaseOne.multi );
+        }
+    private:
+        int _oldThreads;
+    };
+
     /** buildBottomUpPhases2And3() builds a btree from the keys in an external sorter. */
     class BuildBottomUp : public IndexBuildBase {
     public:
@@ -582,6 +620,68 @@ namespace IndexUpdateTests {
         }
     };
 
+    /** createIndexes() builds several indexes with one scan of the collection. */
+    class CreateIndexes : public IndexBuildBase {
+    public:
+        void run() {
+            for ( int32_t i = 0; i < 200; ++i ) {
+                _client.insert( _ns, BSON( "a" << i << "b" << BSON_ARRAY( i << -i ) <<
+                                           "c" << i % 7 ) );
+            }
+            vector<BSONObj> specs;
+            specs.push_back( spec( BSON( "a" << 1 ), "a_1", BSON( "unique" << true ) ) );
+            specs.push_back( spec( BSON( "b" << -1 ), "b_-1", BSONObj() ) );
+            specs.push_back( spec( BSON( "c" << 1 << "a" << 1 ), "c_1_a_1", BSONObj() ) );
+            specs.push_back( spec( BSON( "c" << 1 ), "c_1", BSON( "dropDups" << true ) ) );
+            // Already built.
+            specs.push_back( spec( BSON( "_id" << 1 ), "_id_", BSONObj() ) );
+            // Twice.
+            specs.push_back( spec( BSON( "b" << -1 ), "b_-1", BSONObj() ) );
+
+            IndexCatalog* catalog = collection()->getIndexCatalog();
+            ASSERT_OK( catalog->createIndexes( specs, true ) );
+            ASSERT_EQUALS( 5, catalog->numIndexesReady() );
+            ASSERT_EQUALS( 0, catalog->numIndexesInProgress() );
+            ASSERT_EQUALS( 5U, _client.count( "unittests.system.indexes", BSON( "ns" << _ns ) ) );
+
+            ASSERT_EQUALS( 1U, _client.query( _ns, QUERY( "a" << 17 ).hint( BSON( "a" << 1 ) ) )
+                                   ->itcount() );
+            ASSERT_EQUALS( 1U, _client.query( _ns, QUERY( "b" << -3 ).hint( BSON( "b" << -1 ) ) )
+                                   ->itcount() );
+            ASSERT( catalog->findIndexByName( "b_-1" )->isMultikey() );
+            ASSERT_EQUALS( 29U, _client.query( _ns, QUERY( "c" << 3 ).hint( BSON( "c" << 1 <<
+                                                                                   "a" << 1 ) ) )
+                                    ->itcount() );
+        }
+    private:
+        BSONObj spec( const BSONObj& key, const string& name, const BSONObj& options ) {
+            BSONObjBuilder b;
+            b << "ns" << _ns << "key" << key << "name" << name;
+            b.appendElements( options );
+            return b.obj();
+        }
+    };
+
+    /** If one of the indexes createIndexes() builds together fails, none of them is kept. */
+    class CreateIndexesDuplicateKey : public IndexBuildBase {
+    public:
+        void run() {
+            for ( int32_t i = 0; i < 100; ++i ) {
+                _client.insert( _ns, BSON( "a" << i << "b" << i % 10 ) );
+            }
+            vector<BSONObj> specs;
+            specs.push_back( BSON( "ns" << _ns << "key" << BSON( "a" << 1 ) << "name" << "a_1" ) );
+            specs.push_back( BSON( "ns" << _ns << "key" << BSON( "b" << 1 ) << "name" << "b_1" <<
+                                   "unique" << true ) );
+
+            IndexCatalog* catalog = collection()->getIndexCatalog();
+            ASSERT_NOT_OK( catalog->createIndexes( specs, true ) );
+            ASSERT_EQUALS( 1, catalog->numIndexesReady() );
+            ASSERT_EQUALS( 0, catalog->numIndexesInProgress() );
+            ASSERT_EQUALS( 1U, _client.count( "unittests.system.indexes", BSON( "ns" << _ns ) ) );
+        }
+    };
+
     /**
      * Fixture class that has a basic compound index.
      */
@@ -754,6 +854,7 @@ namespace IndexUpdateTests {
         void setupTests() {
             add<AddKeysToPhaseOne>();
             add<InterruptAddKeysToPhaseOne>( false );
+            add<ParallelAddKeysToPhaseOne>();
             add<InterruptAddKeysToPhaseOne>( true );
             add<BuildBottomUp>();
             add<InterruptBuildBottomUp>( false );
@@ -768,6 +869,8 @@ namespace IndexUpdateTests {
             add<DirectClientEnsureIndexInterruptDisallowed>();
             add<HelpersEnsureIndexInterruptDisallowed>();
             add<IndexBuildInProgressTest>();
+            add<CreateIndexes>();
+            add<CreateIndexesDuplicateKey>();
             add<SameSpecDifferentOption>();
             add<SameSpecSameOptions>();
             add<DifferentSpecSameName>();
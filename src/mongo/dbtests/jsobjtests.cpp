@@ -1279,6 +1279,27 @@ namespace JsobjTests {
                 }
             }
         };
+
+        class GenBatch {
+        public:
+            void run() {
+                // Both fit in a thread's block of counter values, and the second doesn't.
+                check( 10 );
+                check( 10 );
+                check( 1000 );
+            }
+        private:
+            void check( size_t n ) {
+                vector<OID> oids( n );
+                OID::gen( &oids[0], n );
+                for ( size_t i = 1; i < n; i++ ) {
+                    ASSERT_EQUALS( oids[0].asTimeT(), oids[i].asTimeT() );
+                    ASSERT( oids[i - 1] < oids[i] || oids[i].toIncString() == "000000" );
+                }
+                OID next = OID::gen();
+                ASSERT( oids[n - 1] != next );
+            }
+        };
     } // namespace OIDTests
 
 
@@ -2221,6 +2242,7 @@ namespace JsobjTests {
             add< OIDTests::ToDate >();
             add< OIDTests::FromDate >();
             add< OIDTests::Seq >();
+            add< OIDTests::GenBatch >();
             add< ValueStreamTests::LabelBasic >();
             add< ValueStreamTests::LabelShares >();
             add< ValueStreamTests::LabelDouble >();
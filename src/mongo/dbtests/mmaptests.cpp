@@ -106,11 +106,64 @@ namespace MMapTests {
         }
     };
 
+    /** only the chunks of the private view noted as written are remapped */
+    class RemapWrittenChunks {
+        const string fn;
+    public:
+        RemapWrittenChunks() :
+            fn((boost::filesystem::path(storageGlobalParams.dbpath) / "testfile.remap").string()) {
+        }
+        ~RemapWrittenChunks() {
+            try { boost::filesystem::remove(fn); }
+            catch(...) { }
+        }
+        void run() {
+            if (!storageGlobalParams.dur)
+                return;
+
+            try { boost::filesystem::remove(fn); }
+            catch(...) { }
+
+            Lock::GlobalWrite lk;
+
+            DurableMappedFile f;
+            unsigned long long len = 4 * DurableMappedFile::RemapChunkSize;
+            verify( f.create(fn, len, /*sequential*/false) );
+            ASSERT( !f.willNeedRemap() );
+
+            const unsigned long long written = 2 * DurableMappedFile::RemapChunkSize + 100;
+            char *p = (char *) f.getView();
+            char *w = (char *) f.view_write();
+            MemoryMappedFile::makeWritable(p, 1);
+            MemoryMappedFile::makeWritable(p + written, 1);
+            p[0] = 'a';
+            p[written] = 'b';
+            w[written] = 'c';
+
+            f.wroteRange(written, 1);
+            ASSERT( f.willNeedRemap() );
+            ASSERT_EQUALS( DurableMappedFile::RemapChunkSize, f.remapThePrivateView() );
+            ASSERT( !f.willNeedRemap() );
+
+            // the written chunk shows the file again; the others keep their private copies
+            ASSERT_EQUALS( 'c', p[written] );
+            ASSERT_EQUALS( 'a', p[0] );
+
+            // a write spanning a chunk boundary dirties both chunks
+            f.wroteRange(DurableMappedFile::RemapChunkSize - 1, 2);
+            ASSERT_EQUALS( 2 * DurableMappedFile::RemapChunkSize, f.remapThePrivateView() );
+            ASSERT_EQUALS( 'a', p[0] );
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "mmap" ) {}
         void setupTests() {
             add< LeakTest >();
+#if !defined(_WIN32) && !defined(__sunos__)
+            add< RemapWrittenChunks >();
+#endif
         }
     } myall;
 
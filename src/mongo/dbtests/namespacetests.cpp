@@ -28,6 +28,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/queryutil.h"
 #include "mongo/db/catalog/ondisk/namespace.h"
+#include "mongo/db/catalog/ondisk/namespace_index.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/dbtests/dbtests.h"
 
@@ -2331,6 +2332,34 @@ namespace NamespaceTests {
 
     } // namespace CollectionInfoCacheTests
 
+    namespace NamespaceIndexTests {
+
+        /** details() finds what add_ns() adds, whichever way it is looked up, until kill_ns(). */
+        class AddKill {
+        public:
+            void run() {
+                const char* ns = "unittests.namespaceindex.addkill";
+                Client::WriteContext ctx( ns );
+                NamespaceIndex* ni = nsindex( ns );
+
+                ASSERT( !ni->details( ns ) );
+                ni->add_ns( ns, DiskLoc(), false );
+                NamespaceDetails* details = ni->details( ns );
+                ASSERT( details );
+                ASSERT_EQUALS( details, ni->details( Namespace( ns ) ) );
+
+                list<string> names;
+                ni->getNamespaces( names );
+                ASSERT( std::find( names.begin(), names.end(), ns ) != names.end() );
+
+                ni->kill_ns( ns );
+                ASSERT( !ni->details( ns ) );
+                ASSERT( !ni->details( Namespace( ns ) ) );
+            }
+        };
+
+    } // namespace NamespaceIndexTests
+
     class All : public Suite {
     public:
         All() : Suite( "namespace" ) {
@@ -2445,6 +2474,7 @@ namespace NamespaceTests {
             add< NamespaceDetailsTests::Size >();
             add< NamespaceDetailsTests::SetIndexIsMultikey >();
             add< CollectionInfoCacheTests::ClearQueryCache >();
+            add< NamespaceIndexTests::AddKill >();
             add< MissingFieldTests::BtreeIndexMissingField >();
             add< MissingFieldTests::TwoDIndexMissingField >();
             add< MissingFieldTests::HashedIndexMissingField >();
@@ -23,12 +23,29 @@
 
 #include "mongo/base/initializer.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/db/exec/and_hash.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/index_scan.h"
+#include "mongo/db/exec/mock_stage.h"
+#include "mongo/db/exec/projection.h"
+#include "mongo/db/exec/sort.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/json.h"
+#include "mongo/db/interrupt_status_mongod.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/pipeline/pipeline_d.h"
+#include "mongo/db/query/lite_projection.h"
+#include "mongo/db/query/multi_plan_runner.h"
+#include "mongo/db/query/query_solution.h"
 #include "mongo/db/query_optimizer_internal.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework.h"
 #include "mongo/util/file_allocator.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -731,6 +748,515 @@ namespace Plan {
     } all;
 } // namespace Plan
 
+namespace Stages {
+
+    // The stage tests time one query stage, or a few, over a synthetic collection, and report
+    // nanoseconds per document the root of the plan returns rather than the total time.
+    const int numDocs = 100000;
+
+    template <class T>
+    class StageRunner {
+    public:
+        void run() {
+            T test;
+            string name = testDb( &test );
+            boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+            long long docs = test.run();
+            boost::posix_time::ptime end = boost::posix_time::microsec_clock::universal_time();
+            long long nanos = ( end - start ).total_microseconds() * 1000;
+            cout << "{'" << name << "_nsPerDoc': " << ( docs ? nanos / docs : 0 ) << "}" << endl;
+        }
+        ~StageRunner() {
+            FileAllocator::get()->waitUntilFinished();
+            client_->dropDatabase( testDb< T >().c_str() );
+        }
+    };
+
+    /** Works "root" to EOF, returning how many results it gave. */
+    long long drain( WorkingSet* ws, PlanStage* root ) {
+        long long results = 0;
+        while( !root->isEOF() ) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if ( root->work( &id ) == PlanStage::ADVANCED ) {
+                ++results;
+                ws->free( id );
+            }
+        }
+        return results;
+    }
+
+    /**
+     * Fills the collection with { _id: i, a: i % 100, b: <a permutation of i>, c: <a string> },
+     * indexed on a and on b.
+     */
+    class StageBase {
+    public:
+        StageBase( const string& ns ) : ns_( ns ) {
+            for( int i = 0; i < numDocs; ++i )
+                client_->insert( ns_, BSON( "_id" << i << "a" << i % 100
+                                            << "b" << ( i * 7919 ) % numDocs
+                                            << "c" << "abcdefghijklmnopqrstuvwxyz" ) );
+            client_->ensureIndex( ns_, BSON( "a" << 1 ) );
+            client_->ensureIndex( ns_, BSON( "b" << 1 ) );
+        }
+
+    protected:
+        IndexDescriptor* index( const BSONObj& keyPattern ) {
+            Collection* collection = cc().database()->getCollection( ns_ );
+            int idxNo = collection->details()->findIndexByKeyPattern( keyPattern );
+            return collection->getIndexCatalog()->getDescriptor( idxNo );
+        }
+
+        IndexScan* indexScan( WorkingSet* ws, const BSONObj& keyPattern, int start, int end ) {
+            IndexScanParams params;
+            params.descriptor = index( keyPattern );
+            params.bounds.isSimpleRange = true;
+            params.bounds.startKey = BSON( "" << start );
+            params.bounds.endKey = BSON( "" << end );
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            return new IndexScan( params, ws, NULL );
+        }
+
+        CollectionScan* collectionScan( WorkingSet* ws, const MatchExpression* filter ) {
+            CollectionScanParams params;
+            params.ns = ns_;
+            params.direction = CollectionScanParams::FORWARD;
+            return new CollectionScan( params, ws, filter );
+        }
+
+        string ns_;
+    };
+
+    class CollScan : public StageBase {
+    public:
+        CollScan() : StageBase( testNs( this ) ) {}
+        long long run() {
+            Client::WriteContext ctx( ns_ );
+            WorkingSet ws;
+            scoped_ptr<PlanStage> root( collectionScan( &ws, NULL ) );
+            return drain( &ws, root.get() );
+        }
+    };
+
+    class CollScanFilter : public StageBase {
+    public:
+        CollScanFilter() : StageBase( testNs( this ) ) {}
+        long long run() {
+            Client::WriteContext ctx( ns_ );
+            StatusWithMatchExpression swme = MatchExpressionParser::parse( BSON( "a" << 7 ) );
+            verify( swme.isOK() );
+            scoped_ptr<MatchExpression> filter( swme.getValue() );
+            WorkingSet ws;
+            scoped_ptr<PlanStage> root( collectionScan( &ws, filter.get() ) );
+            return drain( &ws, root.get() );
+        }
+    };
+
+    class IxScan : public StageBase {
+    public:
+        IxScan() : StageBase( testNs( this ) ) {}
+        long long run() {
+            Client::WriteContext ctx( ns_ );
+            WorkingSet ws;
+            scoped_ptr<PlanStage> root( indexScan( &ws, BSON( "b" << 1 ), 0, numDocs ) );
+            return drain( &ws, root.get() );
+        }
+    };
+
+    class Fetch : public StageBase {
+    public:
+        Fetch() : StageBase( testNs( this ) ) {}
+        long long run() {
+            Client::WriteContext ctx( ns_ );
+            WorkingSet ws;
+            scoped_ptr<PlanStage> root(
+                    new FetchStage( &ws, indexScan( &ws, BSON( "b" << 1 ), 0, numDocs ), NULL ) );
+            return drain( &ws, root.get() );
+        }
+    };
+
+    class AndHash : public StageBase {
+    public:
+        AndHash() : StageBase( testNs( this ) ) {}
+        long long run() {
+            Client::WriteContext ctx( ns_ );
+            WorkingSet ws;
+            // a in [0, 49] is half the collection, b in [0, 9999] a tenth of it.
+            auto_ptr<AndHashStage> and_( new AndHashStage( &ws, NULL ) );
+            and_->addChild( indexScan( &ws, BSON( "a" << 1 ), 0, 49 ) );
+            and_->addChild( indexScan( &ws, BSON( "b" << 1 ), 0, numDocs / 10 - 1 ) );
+            scoped_ptr<PlanStage> root( new FetchStage( &ws, and_.release(), NULL ) );
+            return drain( &ws, root.get() );
+        }
+    };
+
+    // Sorts documents from a MockStage, so that only the sort itself is timed.
+    class Sort {
+    public:
+        Sort() : ws_( new WorkingSet ), mock_( new MockStage( ws_.get() ) ) {
+            for( int i = 0; i < numDocs; ++i ) {
+                WorkingSetMember member;
+                member.state = WorkingSetMember::OWNED_OBJ;
+                member.obj = BSON( "_id" << i << "b" << ( i * 7919 ) % numDocs );
+                mock_->pushBack( member );
+            }
+        }
+        long long run() {
+            SortStageParams params;
+            params.pattern = BSON( "b" << 1 );
+            scoped_ptr<PlanStage> root( new SortStage( params, ws_.get(), mock_.release() ) );
+            return drain( ws_.get(), root.get() );
+        }
+        scoped_ptr<WorkingSet> ws_;
+        auto_ptr<MockStage> mock_;
+    };
+
+    class Projection : public StageBase {
+    public:
+        Projection() : StageBase( testNs( this ) ) {}
+        long long run() {
+            Client::WriteContext ctx( ns_ );
+            LiteProjection* rawProj;
+            verify( LiteProjection::make( BSONObj(), BSON( "a" << 1 ), &rawProj ).isOK() );
+            scoped_ptr<LiteProjection> proj( rawProj );
+            WorkingSet ws;
+            scoped_ptr<PlanStage> root( new ProjectionStage( proj.get(), false, NULL, &ws,
+                                                             collectionScan( &ws, NULL ), NULL ) );
+            return drain( &ws, root.get() );
+        }
+    };
+
+    // Plan selection between an index scan and a filtered collection scan, then the results.
+    class MultiPlan : public StageBase {
+    public:
+        MultiPlan() : StageBase( testNs( this ) ) {}
+        long long run() {
+            Client::WriteContext ctx( ns_ );
+            BSONObj query = BSON( "a" << 7 );
+            StatusWithMatchExpression swme = MatchExpressionParser::parse( query );
+            verify( swme.isOK() );
+            scoped_ptr<MatchExpression> filter( swme.getValue() );
+
+            CanonicalQuery* cq = NULL;
+            verify( CanonicalQuery::canonicalize( ns_, query, &cq ).isOK() );
+            MultiPlanRunner mpr( cq );
+
+            auto_ptr<WorkingSet> ixWs( new WorkingSet );
+            auto_ptr<PlanStage> ixRoot(
+                    new FetchStage( ixWs.get(), indexScan( ixWs.get(), BSON( "a" << 1 ), 7, 7 ),
+                                    NULL ) );
+            mpr.addPlan( new QuerySolution(), ixRoot.release(), ixWs.release() );
+
+            auto_ptr<WorkingSet> collWs( new WorkingSet );
+            auto_ptr<PlanStage> collRoot( collectionScan( collWs.get(), filter.get() ) );
+            mpr.addPlan( new QuerySolution(), collRoot.release(), collWs.release() );
+
+            size_t best;
+            verify( mpr.pickBestPlan( &best ) );
+            long long results = 0;
+            BSONObj obj;
+            while( Runner::RUNNER_ADVANCED == mpr.getNext( &obj, NULL ) )
+                ++results;
+            return results;
+        }
+    };
+
+    class All : public RunnerSuite {
+    public:
+        All() : RunnerSuite( "stages" ) {}
+        void setupTests() {
+            addStage< CollScan >();
+            addStage< CollScanFilter >();
+            addStage< IxScan >();
+            addStage< Fetch >();
+            addStage< AndHash >();
+            addStage< Sort >();
+            addStage< Projection >();
+            addStage< MultiPlan >();
+        }
+    private:
+        template< class T >
+        void addStage() {
+            Suite::add< StageRunner< T > >();
+        }
+    } all;
+
+} // namespace Stages
+
+namespace Aggregation {
+
+    // The aggregation tests run a pipeline over an in memory array of documents, or over a
+    // collection, and report the input documents handled per second and how much the resident
+    // size of the process grew while the pipeline ran.  The memory is per pipeline: the
+    // document sources don't account for what they hold.
+    template <class T>
+    class PipelineRunner {
+    public:
+        void run() {
+            T test;
+            string name = testDb( &test );
+            ProcessInfo p;
+            int residentBefore = p.getResidentSize();
+            boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+            long long docs = test.run();
+            boost::posix_time::ptime end = boost::posix_time::microsec_clock::universal_time();
+            int residentGrowth = p.getResidentSize() - residentBefore;
+            long long micros = ( end - start ).total_microseconds();
+            cout << "{'" << name << "_docsPerSec': " << ( micros ? docs * 1000000 / micros : 0 )
+                 << ", '" << name << "_residentGrowthMB': " << residentGrowth << "}" << endl;
+        }
+        ~PipelineRunner() {
+            FileAllocator::get()->waitUntilFinished();
+            client_->dropDatabase( testDb< T >().c_str() );
+        }
+    };
+
+    /**
+     * A document with _id i, a: i % cardinality, b: a permutation of i, c: a three element
+     * array, and "extraFields" more numeric fields to make it wider.
+     */
+    BSONObj makeDoc( int i, int n, int cardinality, int extraFields ) {
+        BSONObjBuilder b;
+        b.append( "_id", i );
+        b.append( "a", i % cardinality );
+        b.append( "b", (int)( ( i * 7919LL ) % n ) );
+        b.append( "c", BSON_ARRAY( 1 << 2 << 3 ) );
+        for( int f = 0; f < extraFields; ++f )
+            b.append( string( str::stream() << "f" << f ), i + f );
+        return b.obj();
+    }
+
+    /** Drains the output of a stitched pipeline, returning how many documents came out. */
+    long long drain( const intrusive_ptr<mongo::Pipeline>& pipeline ) {
+        long long results = 0;
+        while( pipeline->output()->getNext() )
+            ++results;
+        return results;
+    }
+
+    intrusive_ptr<mongo::Pipeline> parse( const string& ns, const BSONObj& stages,
+                                          intrusive_ptr<ExpressionContext>* ctx ) {
+        *ctx = new ExpressionContext( InterruptStatusMongod::status, NamespaceString( ns ) );
+        string errmsg;
+        intrusive_ptr<mongo::Pipeline> pipeline = mongo::Pipeline::parseCommand(
+                errmsg, BSON( "aggregate" << nsToCollectionSubstring( ns ) << "pipeline" << stages ),
+                *ctx );
+        verify( pipeline.get() );
+        return pipeline;
+    }
+
+    /** A pipeline over a DocumentSourceBsonArray of "n" documents. */
+    class ArrayBase {
+    public:
+        ArrayBase( int n, int cardinality, int extraFields ) : n_( n ) {
+            BSONArrayBuilder docs;
+            for( int i = 0; i < n; ++i )
+                docs.append( makeDoc( i, n, cardinality, extraFields ) );
+            docs_ = docs.arr();
+        }
+        long long run() {
+            intrusive_ptr<ExpressionContext> ctx;
+            intrusive_ptr<mongo::Pipeline> pipeline = parse( "perftest.array", stages(), &ctx );
+            pipeline->addInitialSource( DocumentSourceBsonArray::create( docs_, ctx ) );
+            pipeline->stitch();
+            drain( pipeline );
+            return n_;
+        }
+        virtual ~ArrayBase() {}
+    protected:
+        virtual BSONObj stages() = 0;
+    private:
+        int n_;
+        BSONObj docs_;
+    };
+
+    /** A pipeline over the documents of a collection. */
+    class CollectionBase {
+    public:
+        CollectionBase( const string& ns, int n, int cardinality, int extraFields ) :
+            ns_( ns ), n_( n ) {
+            for( int i = 0; i < n; ++i )
+                client_->insert( ns_, makeDoc( i, n, cardinality, extraFields ) );
+            client_->ensureIndex( ns_, BSON( "a" << 1 ) );
+        }
+        long long run() {
+            intrusive_ptr<ExpressionContext> ctx;
+            intrusive_ptr<mongo::Pipeline> pipeline = parse( ns_, stages(), &ctx );
+            PipelineD::prepareCursorSource( pipeline, ctx );
+            pipeline->stitch();
+            drain( pipeline );
+            return n_;
+        }
+        virtual ~CollectionBase() {}
+    protected:
+        virtual BSONObj stages() = 0;
+    private:
+        string ns_;
+        int n_;
+    };
+
+    // Narrow documents are about 70 bytes, wide ones about 400.
+    const int narrowDocs = 100000;
+    const int wideDocs = 20000;
+    const int wideFields = 32;
+
+    class Match : public ArrayBase {
+    public:
+        Match() : ArrayBase( narrowDocs, 100, 0 ) {}
+        BSONObj stages() { return BSON_ARRAY( BSON( "$match" << BSON( "a" << 7 ) ) ); }
+    };
+
+    class Project : public ArrayBase {
+    public:
+        Project() : ArrayBase( narrowDocs, 100, 0 ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$project" << BSON( "a" << 1 << "b" << 1 ) ) );
+        }
+    };
+
+    class ProjectWide : public ArrayBase {
+    public:
+        ProjectWide() : ArrayBase( wideDocs, 100, wideFields ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$project" << BSON( "a" << 1 << "b" << 1 ) ) );
+        }
+    };
+
+    class GroupFewKeys : public ArrayBase {
+    public:
+        GroupFewKeys() : ArrayBase( narrowDocs, 10, 0 ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$group" << BSON( "_id" << "$a"
+                                                       << "n" << BSON( "$sum" << 1 )
+                                                       << "t" << BSON( "$sum" << "$b" ) ) ) );
+        }
+    };
+
+    class GroupManyKeys : public ArrayBase {
+    public:
+        GroupManyKeys() : ArrayBase( narrowDocs, narrowDocs, 0 ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$group" << BSON( "_id" << "$a"
+                                                       << "n" << BSON( "$sum" << 1 )
+                                                       << "t" << BSON( "$sum" << "$b" ) ) ) );
+        }
+    };
+
+    class GroupWide : public ArrayBase {
+    public:
+        GroupWide() : ArrayBase( wideDocs, 100, wideFields ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$group" << BSON( "_id" << "$a"
+                                                       << "last" << BSON( "$last" << "$$ROOT" ) ) ) );
+        }
+    };
+
+    class Sort : public ArrayBase {
+    public:
+        Sort() : ArrayBase( narrowDocs, 100, 0 ) {}
+        BSONObj stages() { return BSON_ARRAY( BSON( "$sort" << BSON( "b" << 1 ) ) ); }
+    };
+
+    class SortWide : public ArrayBase {
+    public:
+        SortWide() : ArrayBase( wideDocs, 100, wideFields ) {}
+        BSONObj stages() { return BSON_ARRAY( BSON( "$sort" << BSON( "b" << 1 ) ) ); }
+    };
+
+    class Unwind : public ArrayBase {
+    public:
+        Unwind() : ArrayBase( narrowDocs, 100, 0 ) {}
+        BSONObj stages() { return BSON_ARRAY( BSON( "$unwind" << "$c" ) ); }
+    };
+
+    class Redact : public ArrayBase {
+    public:
+        Redact() : ArrayBase( narrowDocs, 100, 0 ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$redact" << BSON( "$cond" << BSON_ARRAY(
+                    BSON( "$eq" << BSON_ARRAY( "$a" << 7 ) ) << "$$PRUNE" << "$$DESCEND" ) ) ) );
+        }
+    };
+
+    class MatchProjectGroupSort : public ArrayBase {
+    public:
+        MatchProjectGroupSort() : ArrayBase( narrowDocs, 1000, 0 ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$match" << BSON( "b" << GTE << narrowDocs / 2 ) )
+                               << BSON( "$project" << BSON( "a" << 1 << "b" << 1 ) )
+                               << BSON( "$group" << BSON( "_id" << "$a"
+                                                          << "t" << BSON( "$sum" << "$b" ) ) )
+                               << BSON( "$sort" << BSON( "t" << -1 ) ) );
+        }
+    };
+
+    class UnwindGroup : public ArrayBase {
+    public:
+        UnwindGroup() : ArrayBase( narrowDocs, 100, 0 ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$unwind" << "$c" )
+                               << BSON( "$group" << BSON( "_id" << "$c"
+                                                          << "n" << BSON( "$sum" << 1 ) ) ) );
+        }
+    };
+
+    class CollectionGroup : public CollectionBase {
+    public:
+        CollectionGroup() : CollectionBase( testNs( this ), narrowDocs, 100, 0 ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$group" << BSON( "_id" << "$a"
+                                                       << "t" << BSON( "$sum" << "$b" ) ) ) );
+        }
+    };
+
+    // The $match is pushed down to an index scan on a.
+    class CollectionMatchSort : public CollectionBase {
+    public:
+        CollectionMatchSort() : CollectionBase( testNs( this ), narrowDocs, 100, 0 ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$match" << BSON( "a" << LT << 50 ) )
+                               << BSON( "$sort" << BSON( "b" << 1 ) ) );
+        }
+    };
+
+    class CollectionProjectWide : public CollectionBase {
+    public:
+        CollectionProjectWide() : CollectionBase( testNs( this ), wideDocs, 100, wideFields ) {}
+        BSONObj stages() {
+            return BSON_ARRAY( BSON( "$project" << BSON( "a" << 1 << "b" << 1 ) ) );
+        }
+    };
+
+    class All : public RunnerSuite {
+    public:
+        All() : RunnerSuite( "aggregation" ) {}
+        void setupTests() {
+            addPipeline< Match >();
+            addPipeline< Project >();
+            addPipeline< ProjectWide >();
+            addPipeline< GroupFewKeys >();
+            addPipeline< GroupManyKeys >();
+            addPipeline< GroupWide >();
+            addPipeline< Sort >();
+            addPipeline< SortWide >();
+            addPipeline< Unwind >();
+            addPipeline< Redact >();
+            addPipeline< MatchProjectGroupSort >();
+            addPipeline< UnwindGroup >();
+            addPipeline< CollectionGroup >();
+            addPipeline< CollectionMatchSort >();
+            addPipeline< CollectionProjectWide >();
+        }
+    private:
+        template< class T >
+        void addPipeline() {
+            Suite::add< PipelineRunner< T > >();
+        }
+    } all;
+
+} // namespace Aggregation
+
 namespace Misc {
     class TimeMicros64 {
     public:
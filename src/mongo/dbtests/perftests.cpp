@@ -30,10 +30,12 @@
 
 #include "mongo/db/db.h"
 #include "mongo/db/dur_stats.h"
+#include "mongo/db/fts/fts_index_format.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/json.h"
 #include "mongo/db/key.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/pipeline/document.h"
 #include "mongo/db/taskqueue.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
@@ -41,6 +43,7 @@
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/qlock.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/flat_hash_set.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
 
@@ -295,10 +298,12 @@ namespace PerfTests {
             }
         }
 
-        /** if true runs timed2() again with several threads (8 at time of this writing).
+        /** if true runs timed2() again with several threads (threads() of them).
         */
         virtual bool testThreaded() { return false; }
 
+        virtual int threads() { return 8; }
+
         int howLong() { 
             int hlm = howLongMillis();
             DEV {
@@ -362,7 +367,7 @@ namespace PerfTests {
             }
 
             if( testThreaded() ) {
-                const int nThreads = 8;
+                const int nThreads = threads();
                 //cout << "testThreaded nThreads:" << nThreads << endl;
                 mongo::Timer t;
                 const unsigned long long result = launchThreads(nThreads);
@@ -473,6 +478,43 @@ namespace PerfTests {
         }
     };
 
+    /** The small Documents and arrays that $unwind and $project make a lot of. */
+    class DocumentCreate : public NonDurTest {
+    public:
+        bo b;
+        string name() { return "DocumentCreate"; }
+        DocumentCreate() {
+            b = BSON( "_id" << 1 << "x" << BSON_ARRAY( 1 << 2 << 3 ) << "s" << "a string" );
+        }
+        void timed() {
+            const Document fromBson(b);
+            MutableDocument md;
+            md.addField("x", fromBson["x"]);
+            md.addField("y", Value(BSON_ARRAY( fromBson["_id"] )));
+            md.addField("z", Value(DOC( "s" << fromBson["s"] )));
+            if (md.freeze().size() != 3)
+                dontOptimizeOutHopefully++;
+        }
+    };
+
+    /** A line of mongoimport input, as mongoexport writes it. */
+    class FromJson : public NonDurTest {
+    public:
+        string json;
+        string name() { return "fromjson"; }
+        FromJson() {
+            json = "{ \"_id\" : { \"$oid\" : \"52715ea6b1ae0e6fea5d4d01\" }, "
+                   "\"name\" : \"user1234\", \"email\" : \"user1234@example.com\", "
+                   "\"age\" : 42, \"score\" : 81.25, \"tags\" : [ \"a\", \"bb\", \"ccc\" ], "
+                   "\"address\" : { \"street\" : \"1234 Main St\", \"zip\" : \"01234\" }, "
+                   "\"note\" : \"quoted \\\"text\\\"\", \"active\" : true, \"n\" : null }";
+        }
+        void timed() {
+            if (fromjson(json).nFields() != 10)
+                dontOptimizeOutHopefully++;
+        }
+    };
+
     class KeyTest : public B {
     public:
         KeyV1Owned a,b,c;
@@ -490,6 +532,57 @@ namespace PerfTests {
         }
     };
 
+    /** dedup of 1000 record locations, as an IndexScan over a multikey index does it */
+    template< class Set >
+    class DiskLocDedup : public B {
+    public:
+        virtual int howLongMillis() { return 3000; }
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            Set seen;
+            for ( int i = 0; i < 1000; i++ ) {
+                // each location twice
+                DiskLoc loc( i % 4, ( i / 2 ) * 512 );
+                if ( seen.end() == seen.find( loc ) )
+                    seen.insert( loc );
+            }
+            dontOptimizeOutHopefully += seen.size();
+        }
+    };
+
+    class DiskLocDedupUnordered : public DiskLocDedup< unordered_set<DiskLoc, DiskLoc::Hasher> > {
+    public:
+        string name() { return "diskloc-dedup-unordered_set"; }
+    };
+
+    class DiskLocDedupFlat : public DiskLocDedup< FlatHashSet<DiskLoc, DiskLoc::Hasher> > {
+    public:
+        string name() { return "diskloc-dedup-FlatHashSet"; }
+    };
+
+    /** text index keys for a document of about 1KB of words, many of them repeated */
+    class FTSKeys : public B {
+    public:
+        fts::FTSSpec spec;
+        BSONObj doc;
+        string name() { return "fts-getKeys"; }
+        virtual int howLongMillis() { return 3000; }
+        FTSKeys() : spec( fts::FTSSpec::fixSpec( BSON( "key" << BSON( "body" << "text" ) ) ) ) {
+            const char* words[] = { "the", "running", "indexes", "quickly", "documents",
+                                    "searching", "terms", "stemmed", "and", "collections" };
+            StringBuilder body;
+            for ( int i = 0; i < 150; i++ )
+                body << words[( i * 7 ) % 10] << ( i % 3 ? " " : ". " );
+            doc = BSON( "body" << body.str() );
+        }
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            BSONObjSet keys;
+            fts::FTSIndexFormat::getKeys( spec, doc, &keys );
+            dontOptimizeOutHopefully += keys.size();
+        }
+    };
+
     unsigned long long aaa;
 
     class Timer : public B {
@@ -1135,6 +1228,92 @@ namespace PerfTests {
         }
     };
 
+    /** prints the group commit rates of a durability test, from the dur stats of its run */
+    static void sayDurRates(const string& test, unsigned long long ops, int ms) {
+        if( !storageGlobalParams.dur || ms <= 0 )
+            return;
+        const dur::Stats::S& s = *dur::stats.curr;
+        cout << "stats " << setw(42) << left << test + "-dur" << right << fixed << setprecision(2)
+             << " commits/s:" << s._commits * 1000.0 / ms
+             << " journalMB/s:" << s._journaledBytes / 1000.0 / ms
+             << " journalBytes/op:" << (ops ? s._journaledBytes / ops : 0)
+             << " remapMs/commit:" << (s._commits ? s._remapPrivateViewMicros / 1000.0 / s._commits : 0.0)
+             << endl;
+    }
+
+    /** declares write intents on regions of Len bytes of one large record with getDur().writingPtr(),
+        the way in place updates do, and times group commit of them.  working set is one record,
+        so what is measured is the journaling and not the data file writes.
+    */
+    template <int Len, int Threads>
+    class DurWriting : public B {
+        enum { BinLen = 1024 * 1024 };
+        unsigned long long _n;
+        mongo::Timer _t;
+    public:
+        DurWriting() : _n(0) { }
+        string name() { return str::stream() << "dur-writing-" << Len; }
+        string name2() { return str::stream() << "dur-writing-" << Len << "-" << Threads << "thr"; }
+        virtual bool testThreaded() { return true; }
+        virtual int threads() { return Threads; }
+        void prep() {
+            scoped_array<char> buf(new char[BinLen]);
+            memset(buf.get(), 0, BinLen);
+            BSONObjBuilder b;
+            b.appendBinData("bin", BinLen, BinDataGeneral, buf.get());
+            client().insert(ns(), b.obj());
+            _t.reset();
+        }
+        void write() {
+            Lock::DBWrite lk(ns());
+            Client::Context ctx(ns());
+            DiskLoc loc = nsdetails(ns())->firstExtent().ext()->firstRecord;
+            // land inside the bindata payload, past the BSON and bindata headers
+            char *p = loc.rec()->data() + 64;
+            unsigned ofs = (unsigned) std::rand() % (BinLen - Len - 64);
+            memset(getDur().writingPtr(p + ofs, Len), (char) ofs, Len);
+        }
+        void timed() {
+            write();
+            _n++;
+        }
+        void timed2(DBClientBase&) {
+            write();
+        }
+        void post() {
+            sayDurRates(name(), _n, _t.millis());
+        }
+    };
+
+    /** latency of getLastError j:true after a small insert, as percentiles */
+    class DurJournalAck : public B {
+        unsigned _i;
+        vector<unsigned long long> _micros;
+    public:
+        DurJournalAck() : _i(0) { }
+        string name() { return "dur-insert-j-ack"; }
+        virtual int howLongMillis() { return 5000; }
+        virtual unsigned batchSize() { return 1; }
+        void timed() {
+            mongo::Timer t;
+            client().insert(ns(), BSON("_id" << _i++ << "x" << 1));
+            client().getLastError(/*fsync*/false, /*j*/true);
+            _micros.push_back(t.micros());
+        }
+        void post() {
+            if( _micros.empty() )
+                return;
+            sort(_micros.begin(), _micros.end());
+            cout << "stats " << setw(42) << left << name() + "-latency" << right << fixed << setprecision(2);
+            const double pct[] = { 50, 90, 99, 100 };
+            for( unsigned i = 0; i < sizeof(pct) / sizeof(pct[0]); i++ ) {
+                size_t k = std::min(_micros.size() - 1, (size_t) (_micros.size() * pct[i] / 100));
+                cout << " p" << pct[i] << "ms:" << _micros[k] / 1000.0;
+            }
+            cout << endl;
+        }
+    };
+
     // Tests what the worst case is for the overhead of enabling a fail point. If 'fpInjected'
     // is false, then the fail point will be compiled out. If 'fpInjected' is true, then the
     // fail point will be compiled in. Since the conditioned block is more or less trivial, any
@@ -1405,11 +1584,16 @@ namespace PerfTests {
                 add< CTM >();
                 add< CTMicros >();
                 add< KeyTest >();
+                add< DiskLocDedupUnordered >();
+                add< DiskLocDedupFlat >();
+                add< FTSKeys >();
                 add< Bldr >();
                 add< StkBldr >();
                 add< BSONIter >();
                 add< BSONGetFields1 >();
                 add< BSONGetFields2 >();
+                add< DocumentCreate >();
+                add< FromJson >();
                 //add< TaskQueueTest >();
                 add< InsertDup >();
                 add< Insert1 >();
@@ -1418,6 +1602,10 @@ namespace PerfTests {
                 add< Update1 >();
                 add< MoreIndexes<Update1> >();
                 add< InsertBig >();
+                add< DurWriting<64, 1> >();
+                add< DurWriting<64, 8> >();
+                add< DurWriting<16 * 1024, 8> >();
+                add< DurJournalAck >();
                 add< FailPointTest<false, false> >();
                 add< FailPointTest<true, false> >();
                 add< FailPointTest<true, true> >();
@@ -23,9 +23,17 @@
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/query/multi_plan_runner.h"
+#include "mongo/db/query/type_explain.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/dbtests/dbtests.h"
 
+namespace mongo {
+
+    // How many threads may work the candidates of a query.  Declared in multi_plan_runner.cpp.
+    extern int internalQueryPlanEvaluationThreads;
+
+}  // namespace mongo
+
 namespace QueryMultiPlanRunner {
 
     class MultiPlanRunnerBase {
@@ -130,12 +138,146 @@ namespace QueryMultiPlanRunner {
         }
     };
 
+    // A collection scan that finds nothing for a long time is abandoned early instead of being
+    // worked for as long as the index scan that wins.
+    class MPRAbandonsHopelessPlan : public MultiPlanRunnerBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            // The documents matching foo == 7 are in the second half of the collection.
+            const int N = 5000;
+            for (int i = 0; i < N; ++i) {
+                insert(BSON("foo" << (i < N / 2 ? 0 : 7)));
+            }
+
+            addIndex(BSON("foo" << 1));
+
+            // Plan 0: IXScan over foo == 7.
+            IndexScanParams ixparams;
+            ixparams.descriptor = getIndex(BSON("foo" << 1));
+            ixparams.bounds.isSimpleRange = true;
+            ixparams.bounds.startKey = BSON("" << 7);
+            ixparams.bounds.endKey = BSON("" << 7);
+            ixparams.bounds.endKeyInclusive = true;
+            ixparams.direction = 1;
+            auto_ptr<WorkingSet> firstWs(new WorkingSet());
+            IndexScan* ix = new IndexScan(ixparams, firstWs.get(), NULL);
+            auto_ptr<PlanStage> firstRoot(new FetchStage(firstWs.get(), ix, NULL));
+
+            // Plan 1: CollScan with matcher.  Produces nothing for the first N / 2 works.
+            CollectionScanParams csparams;
+            csparams.ns = ns();
+            csparams.direction = CollectionScanParams::FORWARD;
+            auto_ptr<WorkingSet> secondWs(new WorkingSet());
+            BSONObj filterObj = BSON("foo" << 7);
+            StatusWithMatchExpression swme = MatchExpressionParser::parse(filterObj);
+            verify(swme.isOK());
+            auto_ptr<MatchExpression> filter(swme.getValue());
+            auto_ptr<PlanStage> secondRoot(new CollectionScan(csparams, secondWs.get(),
+                                                              filter.get()));
+
+            CanonicalQuery* cq = NULL;
+            verify(CanonicalQuery::canonicalize(ns(), BSON("foo" << 7), &cq).isOK());
+            verify(NULL != cq);
+            MultiPlanRunner mpr(cq);
+            mpr.addPlan(new QuerySolution(), firstRoot.release(), firstWs.release());
+            mpr.addPlan(new QuerySolution(), secondRoot.release(), secondWs.release());
+
+            size_t best;
+            ASSERT(mpr.pickBestPlan(&best));
+            ASSERT_EQUALS(size_t(0), best);
+
+            // The collection scan was stopped well before the index scan was.
+            TypeExplain* rawExplain;
+            ASSERT_OK(mpr.getExplainPlan(&rawExplain));
+            scoped_ptr<TypeExplain> explain(rawExplain);
+            ASSERT_EQUALS(size_t(2), explain->sizeAllPlans());
+            ASSERT_LESS_THAN(explain->getAllPlansAt(1)->getNScanned(),
+                             explain->getAllPlansAt(0)->getNScanned());
+
+            // The results of the competition are not lost.
+            int results = 0;
+            BSONObj obj;
+            while (Runner::RUNNER_ADVANCED == mpr.getNext(&obj, NULL)) {
+                ASSERT_EQUALS(obj["foo"].numberInt(), 7);
+                ++results;
+            }
+            ASSERT_EQUALS(results, N / 2);
+        }
+    };
+
+    // The candidates are worked on the plan evaluation pool when the query runs under a read
+    // lock.  The outcome is the same as when they are worked in turn.
+    class MPRParallelTrial : public MultiPlanRunnerBase {
+    public:
+        void run() {
+            const int N = 5000;
+            {
+                Client::WriteContext ctx(ns());
+                for (int i = 0; i < N; ++i) {
+                    insert(BSON("foo" << (i % 10)));
+                }
+                addIndex(BSON("foo" << 1));
+            }
+
+            Client::ReadContext ctx(ns());
+            const int oldThreads = internalQueryPlanEvaluationThreads;
+            internalQueryPlanEvaluationThreads = 4;
+
+            IndexScanParams ixparams;
+            ixparams.descriptor = getIndex(BSON("foo" << 1));
+            ixparams.bounds.isSimpleRange = true;
+            ixparams.bounds.startKey = BSON("" << 7);
+            ixparams.bounds.endKey = BSON("" << 7);
+            ixparams.bounds.endKeyInclusive = true;
+            ixparams.direction = 1;
+            auto_ptr<WorkingSet> firstWs(new WorkingSet());
+            IndexScan* ix = new IndexScan(ixparams, firstWs.get(), NULL);
+            auto_ptr<PlanStage> firstRoot(new FetchStage(firstWs.get(), ix, NULL));
+
+            CollectionScanParams csparams;
+            csparams.ns = ns();
+            csparams.direction = CollectionScanParams::FORWARD;
+            auto_ptr<WorkingSet> secondWs(new WorkingSet());
+            BSONObj filterObj = BSON("foo" << 7);
+            StatusWithMatchExpression swme = MatchExpressionParser::parse(filterObj);
+            verify(swme.isOK());
+            auto_ptr<MatchExpression> filter(swme.getValue());
+            auto_ptr<PlanStage> secondRoot(new CollectionScan(csparams, secondWs.get(),
+                                                              filter.get()));
+
+            CanonicalQuery* cq = NULL;
+            verify(CanonicalQuery::canonicalize(ns(), BSON("foo" << 7), &cq).isOK());
+            verify(NULL != cq);
+            MultiPlanRunner mpr(cq);
+            mpr.addPlan(new QuerySolution(), firstRoot.release(), firstWs.release());
+            mpr.addPlan(new QuerySolution(), secondRoot.release(), secondWs.release());
+
+            size_t best;
+            bool picked = mpr.pickBestPlan(&best);
+            internalQueryPlanEvaluationThreads = oldThreads;
+            ASSERT(picked);
+            ASSERT_EQUALS(size_t(0), best);
+
+            int results = 0;
+            BSONObj obj;
+            while (Runner::RUNNER_ADVANCED == mpr.getNext(&obj, NULL)) {
+                ASSERT_EQUALS(obj["foo"].numberInt(), 7);
+                ++results;
+            }
+            ASSERT_EQUALS(results, N / 10);
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "query_multi_plan_runner" ) { }
 
         void setupTests() {
             add<MPRCollectionScanVsHighlySelectiveIXScan>();
+            add<MPRAbandonsHopelessPlan>();
+            add<MPRParallelTrial>();
         }
     }  queryMultiPlanRunnerAll;
 
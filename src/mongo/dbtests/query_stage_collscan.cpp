@@ -27,6 +27,7 @@
 #include "mongo/db/pdfile.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/fail_point_service.h"
 
 namespace QueryStageCollectionScan {
 
@@ -578,6 +579,128 @@ namespace QueryStageCollectionScan {
         }
     };
 
+    //
+    // Records that aren't in memory are handed up with NEED_FETCH, and come back on the next call
+    // to work() once paged in.
+    //
+
+    class QueryStageCollscanNeedFetch : public QueryStageCollectionScanBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            vector<DiskLoc> locs;
+            getLocs(CollectionScanParams::FORWARD, &locs);
+
+            CollectionScanParams params;
+            params.ns = ns();
+            params.direction = CollectionScanParams::FORWARD;
+            params.tailable = false;
+
+            WorkingSet ws;
+            scoped_ptr<CollectionScan> scan(new CollectionScan(params, &ws, NULL));
+
+            FailPoint* collscanInMemoryFail =
+                getGlobalFailPointRegistry()->getFailPoint("collscanInMemoryFail");
+            collscanInMemoryFail->setMode(FailPoint::alwaysOn);
+
+            int fetches = 0;
+            int count = 0;
+            while (!scan->isEOF()) {
+                WorkingSetID id;
+                PlanStage::StageState state = scan->work(&id);
+                if (PlanStage::NEED_FETCH == state) {
+                    WorkingSetMember* member = ws.get(id);
+                    ASSERT(member->hasLoc());
+                    ASSERT(!member->hasObj());
+                    ASSERT_EQUALS(locs[count], member->loc);
+                    ++fetches;
+
+                    // The next result is the record that was fetched.
+                    ASSERT_EQUALS(PlanStage::ADVANCED, scan->work(&id));
+                    ASSERT_EQUALS(locs[count].obj()["foo"].numberInt(),
+                                  ws.get(id)->obj["foo"].numberInt());
+                    ++count;
+                }
+                else {
+                    ASSERT_NOT_EQUALS(PlanStage::ADVANCED, state);
+                }
+            }
+
+            collscanInMemoryFail->setMode(FailPoint::off);
+
+            ASSERT_EQUALS(numObj(), fetches);
+            ASSERT_EQUALS(numObj(), count);
+        }
+    };
+
+    //
+    // Delete the record the scan is waiting to have paged in, and expect the scan to go on to the
+    // next one.
+    //
+
+    class QueryStageCollscanInvalidateNeedFetch : public QueryStageCollectionScanBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            vector<DiskLoc> locs;
+            getLocs(CollectionScanParams::FORWARD, &locs);
+
+            CollectionScanParams params;
+            params.ns = ns();
+            params.direction = CollectionScanParams::FORWARD;
+            params.tailable = false;
+
+            WorkingSet ws;
+            scoped_ptr<CollectionScan> scan(new CollectionScan(params, &ws, NULL));
+
+            FailPointRegistry* reg = getGlobalFailPointRegistry();
+            FailPoint* collscanInMemorySucceed = reg->getFailPoint("collscanInMemorySucceed");
+            FailPoint* collscanInMemoryFail = reg->getFailPoint("collscanInMemoryFail");
+            collscanInMemorySucceed->setMode(FailPoint::alwaysOn);
+
+            int count = 0;
+            while (count < 10) {
+                WorkingSetID id;
+                if (PlanStage::ADVANCED == scan->work(&id)) {
+                    ++count;
+                }
+            }
+
+            // Ask for locs[count] to be paged in, and delete it while "yielding" for the fetch.
+            collscanInMemorySucceed->setMode(FailPoint::off);
+            collscanInMemoryFail->setMode(FailPoint::alwaysOn);
+            WorkingSetID id;
+            ASSERT_EQUALS(PlanStage::NEED_FETCH, scan->work(&id));
+            ASSERT_EQUALS(locs[count], ws.get(id)->loc);
+            collscanInMemoryFail->setMode(FailPoint::off);
+            collscanInMemorySucceed->setMode(FailPoint::alwaysOn);
+
+            scan->prepareToYield();
+            scan->invalidate(locs[count]);
+            remove(locs[count].obj());
+            scan->recoverFromYield();
+
+            // Skip over locs[count].
+            ++count;
+
+            while (!scan->isEOF()) {
+                PlanStage::StageState state = scan->work(&id);
+                if (PlanStage::ADVANCED == state) {
+                    WorkingSetMember* member = ws.get(id);
+                    ASSERT_EQUALS(locs[count].obj()["foo"].numberInt(),
+                                  member->obj["foo"].numberInt());
+                    ++count;
+                }
+            }
+
+            collscanInMemorySucceed->setMode(FailPoint::off);
+
+            ASSERT_EQUALS(numObj(), count);
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "QueryStageCollectionScan" ) {}
@@ -606,6 +729,8 @@ namespace QueryStageCollectionScan {
             add<QueryStageCollscanObjectsInOrderBackward>();
             add<QueryStageCollscanInvalidateUpcomingObject>();
             add<QueryStageCollscanInvalidateUpcomingObjectBackward>();
+            add<QueryStageCollscanNeedFetch>();
+            add<QueryStageCollscanInvalidateNeedFetch>();
         }
     } all;
 
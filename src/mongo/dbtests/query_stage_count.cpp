@@ -0,0 +1,250 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/exec/index_scan.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/index/catalog_hack.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/dbtests/dbtests.h"
+
+
+/**
+ * This file tests db/exec/count.cpp
+ */
+
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/exec/count.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/json.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/dbtests/dbtests.h"
+
+namespace QueryStageCount {
+
+    class CountBase {
+    public:
+        CountBase() { }
+
+        virtual ~CountBase() {
+            Client::WriteContext ctx(ns());
+            _client.dropCollection(ns());
+        }
+
+        void addIndex(const BSONObj& obj) {
+            _client.ensureIndex(ns(), obj);
+        }
+
+        void insert(const BSONObj& obj) {
+            _client.insert(ns(), obj);
+        }
+
+        IndexDescriptor* getIndex(const BSONObj& obj) {
+            Collection* collection = cc().database()->getCollection(ns());
+            NamespaceDetails* nsd = collection->details();
+            int idxNo = nsd->findIndexByKeyPattern(obj);
+            return collection->getIndexCatalog()->getDescriptor(idxNo);
+        }
+
+        // The caller must hold a lock on ns().
+        int runCount(const CountParams& params) {
+            WorkingSet* ws = new WorkingSet();
+            PlanExecutor runner(ws, new Count(params, ws));
+
+            int count = 0;
+            while (Runner::RUNNER_ADVANCED == runner.getNext(NULL, NULL)) {
+                ++count;
+            }
+
+            // Nothing was ever put in the working set.
+            ASSERT_EQUALS(ws->getPeakMembers(), 0U);
+            return count;
+        }
+
+        static const char* ns() { return "unittests.QueryStageCount"; }
+
+    protected:
+        static DBDirectClient _client;
+    };
+
+    DBDirectClient CountBase::_client;
+
+    /**
+     * Count with inclusive and exclusive ends of a range.
+     */
+    class QueryStageCountInclusiveExclusive : public CountBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("a" << i));
+            }
+            addIndex(BSON("a" << 1));
+
+            CountParams params;
+            params.descriptor = getIndex(BSON("a" << 1));
+            params.startKey = BSON("" << 10);
+            params.startKeyInclusive = true;
+            params.endKey = BSON("" << 20);
+            params.endKeyInclusive = true;
+            ASSERT_EQUALS(runCount(params), 11);
+
+            params.startKeyInclusive = false;
+            ASSERT_EQUALS(runCount(params), 10);
+
+            params.endKeyInclusive = false;
+            ASSERT_EQUALS(runCount(params), 9);
+
+            // An empty range.
+            params.startKey = BSON("" << 20);
+            params.startKeyInclusive = true;
+            ASSERT_EQUALS(runCount(params), 0);
+        }
+    };
+
+    /**
+     * Keys equal to an exclusive start key are skipped even when there are many of them.
+     */
+    class QueryStageCountExclusiveDuplicateStart : public CountBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 100; ++i) {
+                insert(BSON("a" << (i < 80 ? 1 : 2)));
+            }
+            addIndex(BSON("a" << 1));
+
+            CountParams params;
+            params.descriptor = getIndex(BSON("a" << 1));
+            params.startKey = BSON("" << 1);
+            params.startKeyInclusive = false;
+            params.endKey = BSON("" << MAXKEY);
+            params.endKeyInclusive = true;
+            ASSERT_EQUALS(runCount(params), 20);
+        }
+    };
+
+    /**
+     * A compound index with a descending trailing field, counting one value of the leading field.
+     */
+    class QueryStageCountCompoundDescending : public CountBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 30; ++i) {
+                insert(BSON("a" << i % 3 << "b" << i));
+            }
+            addIndex(BSON("a" << 1 << "b" << -1));
+
+            CountParams params;
+            params.descriptor = getIndex(BSON("a" << 1 << "b" << -1));
+            params.startKey = BSON("" << 1 << "" << MAXKEY);
+            params.startKeyInclusive = true;
+            params.endKey = BSON("" << 1 << "" << MINKEY);
+            params.endKeyInclusive = true;
+            ASSERT_EQUALS(runCount(params), 10);
+        }
+    };
+
+    /**
+     * Each document is counted once, even if several of its keys are in range of a multikey
+     * index.
+     */
+    class QueryStageCountMultiKey : public CountBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 20; ++i) {
+                insert(BSON("a" << BSON_ARRAY(i << i + 1 << i + 2)));
+            }
+            addIndex(BSON("a" << 1));
+
+            CountParams params;
+            params.descriptor = getIndex(BSON("a" << 1));
+            ASSERT(params.descriptor->isMultikey());
+            params.startKey = BSON("" << 5);
+            params.startKeyInclusive = true;
+            params.endKey = BSON("" << 10);
+            params.endKeyInclusive = true;
+
+            // Documents 3 through 10 have a key in [5, 10].
+            ASSERT_EQUALS(runCount(params), 8);
+        }
+    };
+
+    /**
+     * Yielding in the middle of the scan doesn't change the count.
+     */
+    class QueryStageCountYield : public CountBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("a" << i));
+            }
+            addIndex(BSON("a" << 1));
+
+            CountParams params;
+            params.descriptor = getIndex(BSON("a" << 1));
+            params.startKey = BSON("" << 0);
+            params.startKeyInclusive = true;
+            params.endKey = BSON("" << 40);
+            params.endKeyInclusive = false;
+
+            WorkingSet ws;
+            Count count(params, &ws);
+
+            int n = 0;
+            while (!count.isEOF()) {
+                WorkingSetID id;
+                PlanStage::StageState state = count.work(&id);
+                if (PlanStage::ADVANCED == state) {
+                    ASSERT_EQUALS(id, WorkingSet::INVALID_ID);
+                    ++n;
+                }
+                count.prepareToYield();
+                count.recoverFromYield();
+            }
+            ASSERT_EQUALS(n, 40);
+        }
+    };
+
+    class All : public Suite {
+    public:
+        All() : Suite("query_stage_count") { }
+
+        void setupTests() {
+            add<QueryStageCountInclusiveExclusive>();
+            add<QueryStageCountExclusiveDuplicateStart>();
+            add<QueryStageCountCompoundDescending>();
+            add<QueryStageCountMultiKey>();
+            add<QueryStageCountYield>();
+        }
+    } queryStageCountAll;
+
+}  // namespace QueryStageCount
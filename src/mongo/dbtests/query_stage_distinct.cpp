@@ -0,0 +1,259 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/exec/index_scan.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/index/catalog_hack.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/dbtests/dbtests.h"
+
+
+/**
+ * This file tests db/exec/distinct_scan.cpp
+ */
+
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/exec/distinct_scan.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/json.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/dbtests/dbtests.h"
+
+namespace QueryStageDistinct {
+
+    class DistinctBase {
+    public:
+        DistinctBase() { }
+
+        virtual ~DistinctBase() {
+            Client::WriteContext ctx(ns());
+            _client.dropCollection(ns());
+        }
+
+        void addIndex(const BSONObj& obj) {
+            _client.ensureIndex(ns(), obj);
+        }
+
+        void insert(const BSONObj& obj) {
+            _client.insert(ns(), obj);
+        }
+
+        IndexDescriptor* getIndex(const BSONObj& obj) {
+            Collection* collection = cc().database()->getCollection(ns());
+            NamespaceDetails* nsd = collection->details();
+            int idxNo = nsd->findIndexByKeyPattern(obj);
+            return collection->getIndexCatalog()->getDescriptor(idxNo);
+        }
+
+        /**
+         * Bounds over every value of every field in 'keyPattern'.
+         */
+        static IndexBounds allValues(const BSONObj& keyPattern) {
+            IndexBounds bounds;
+            bounds.isSimpleRange = false;
+            BSONObjIterator it(keyPattern);
+            while (it.more()) {
+                BSONElement elt = it.next();
+                OrderedIntervalList oil;
+                IndexBoundsBuilder::allValuesForField(elt, &oil);
+                if (elt.number() < 0) {
+                    oil.intervals[0].reverse();
+                }
+                bounds.fields.push_back(oil);
+            }
+            return bounds;
+        }
+
+        /**
+         * Runs the stage and returns the element at position fieldNo of each key returned.
+         * The caller must hold a lock on ns().
+         */
+        vector<BSONObj> runDistinct(const DistinctParams& params) {
+            WorkingSet* ws = new WorkingSet();
+            PlanExecutor runner(ws, new DistinctScan(params, ws, NULL));
+
+            vector<BSONObj> out;
+            BSONObj key;
+            while (Runner::RUNNER_ADVANCED == runner.getNext(&key, NULL)) {
+                BSONObjIterator it(key);
+                for (int i = 0; i < params.fieldNo; ++i) {
+                    it.next();
+                }
+                BSONObjBuilder bob;
+                bob.appendAs(it.next(), "");
+                out.push_back(bob.obj());
+            }
+            return out;
+        }
+
+        static const char* ns() { return "unittests.QueryStageDistinct"; }
+
+    protected:
+        static DBDirectClient _client;
+    };
+
+    DBDirectClient DistinctBase::_client;
+
+    /**
+     * One key per value of the leading field of the index.
+     */
+    class QueryStageDistinctBasic : public DistinctBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 100; ++i) {
+                insert(BSON("a" << i % 10 << "b" << i));
+            }
+            addIndex(BSON("a" << 1 << "b" << 1));
+
+            DistinctParams params;
+            params.descriptor = getIndex(BSON("a" << 1 << "b" << 1));
+            params.bounds = allValues(BSON("a" << 1 << "b" << 1));
+            params.fieldNo = 0;
+
+            vector<BSONObj> values = runDistinct(params);
+            ASSERT_EQUALS(values.size(), 10U);
+            for (size_t i = 0; i < values.size(); ++i) {
+                ASSERT_EQUALS(values[i], BSON("" << static_cast<int>(i)));
+            }
+
+            // Backwards.
+            params.direction = -1;
+            params.bounds.fields[0].intervals[0].reverse();
+            params.bounds.fields[1].intervals[0].reverse();
+            values = runDistinct(params);
+            ASSERT_EQUALS(values.size(), 10U);
+            ASSERT_EQUALS(values[0], BSON("" << 9));
+            ASSERT_EQUALS(values[9], BSON("" << 0));
+        }
+    };
+
+    /**
+     * A point on the leading field, distinct values of the second.
+     */
+    class QueryStageDistinctSecondField : public DistinctBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 200; ++i) {
+                insert(BSON("a" << i % 2 << "b" << i % 5 << "c" << i));
+            }
+            addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+
+            DistinctParams params;
+            params.descriptor = getIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+            params.bounds = allValues(BSON("a" << 1 << "b" << 1 << "c" << 1));
+            params.bounds.fields[0].intervals[0] =
+                IndexBoundsBuilder::makePointInterval(BSON("" << 1));
+            params.fieldNo = 1;
+
+            vector<BSONObj> values = runDistinct(params);
+            ASSERT_EQUALS(values.size(), 5U);
+            for (size_t i = 0; i < values.size(); ++i) {
+                ASSERT_EQUALS(values[i], BSON("" << static_cast<int>(i)));
+            }
+        }
+    };
+
+    /**
+     * Null keys may stand for missing fields, so all of them are returned.
+     */
+    class QueryStageDistinctNulls : public DistinctBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("a" << i % 5));
+            }
+            insert(BSON("b" << 1));
+            insert(BSON("b" << 2));
+            insert(BSON("a" << BSONNULL));
+            addIndex(BSON("a" << 1));
+
+            DistinctParams params;
+            params.descriptor = getIndex(BSON("a" << 1));
+            params.bounds = allValues(BSON("a" << 1));
+            params.fieldNo = 0;
+
+            vector<BSONObj> values = runDistinct(params);
+            ASSERT_EQUALS(values.size(), 8U);
+            for (size_t i = 0; i < 3; ++i) {
+                ASSERT_EQUALS(values[i], BSON("" << BSONNULL));
+            }
+        }
+    };
+
+    /**
+     * Yielding before each key doesn't make us return a value twice.
+     */
+    class QueryStageDistinctYield : public DistinctBase {
+    public:
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            for (int i = 0; i < 100; ++i) {
+                insert(BSON("a" << i % 10));
+            }
+            addIndex(BSON("a" << 1));
+
+            DistinctParams params;
+            params.descriptor = getIndex(BSON("a" << 1));
+            params.bounds = allValues(BSON("a" << 1));
+            params.fieldNo = 0;
+
+            WorkingSet ws;
+            DistinctScan distinct(params, &ws, NULL);
+
+            int n = 0;
+            while (!distinct.isEOF()) {
+                WorkingSetID id;
+                PlanStage::StageState state = distinct.work(&id);
+                if (PlanStage::ADVANCED == state) {
+                    ++n;
+                    ws.free(id);
+                }
+                distinct.prepareToYield();
+                distinct.recoverFromYield();
+            }
+            ASSERT_EQUALS(n, 10);
+        }
+    };
+
+    class All : public Suite {
+    public:
+        All() : Suite("query_stage_distinct") { }
+
+        void setupTests() {
+            add<QueryStageDistinctBasic>();
+            add<QueryStageDistinctSecondField>();
+            add<QueryStageDistinctNulls>();
+            add<QueryStageDistinctYield>();
+        }
+    } queryStageDistinctAll;
+
+}  // namespace QueryStageDistinct
@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * This file tests db/exec/oplogstart.cpp.
+ */
+
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/oplogstart.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pdfile.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/storage/extent.h"
+#include "mongo/dbtests/dbtests.h"
+
+namespace QueryStageOplogStart {
+
+    /**
+     * A capped collection of ten small extents, into which documents go with increasing ts, as
+     * they do into the oplog.
+     */
+    class OplogStartBase {
+    public:
+        OplogStartBase() : _context(ns()), _nextTs(1) {
+            string err;
+            ASSERT( userCreateNS( ns(),
+                                  fromjson( "{capped:true,size:8192,$nExtents:10}" ),
+                                  err,
+                                  false ) );
+        }
+
+        virtual ~OplogStartBase() {
+            _context.db()->dropCollection( ns() );
+        }
+
+    protected:
+        void insert( int n ) {
+            for ( int i = 0; i < n; ++i ) {
+                BSONObj o = BSON( "ts" << _nextTs++ << "pad" << string( 100, 'x' ) );
+                theDataFileMgr.insertWithObjMod( ns(), o );
+            }
+        }
+
+        /** where OplogStart says to scan from for {ts: {$gte: ts}} */
+        DiskLoc findStart( int ts ) {
+            auto_ptr<MatchExpression> filter( parse( ts ) );
+            WorkingSet ws;
+            OplogStart stage( ns(), filter.get(), &ws );
+            while ( !stage.isEOF() ) {
+                WorkingSetID id;
+                if ( PlanStage::ADVANCED == stage.work( &id ) ) {
+                    return ws.get( id )->loc;
+                }
+            }
+            return DiskLoc();
+        }
+
+        /** the documents with ts >= ts a forward scan from start finds */
+        int countFrom( const DiskLoc& start, int ts ) {
+            auto_ptr<MatchExpression> filter( parse( ts ) );
+            CollectionScanParams params;
+            params.ns = ns();
+            params.start = start;
+            WorkingSet* ws = new WorkingSet();
+            PlanExecutor runner( ws, new CollectionScan( params, ws, filter.get() ) );
+            int count = 0;
+            for ( BSONObj obj; Runner::RUNNER_ADVANCED == runner.getNext( &obj, NULL ); ) {
+                ++count;
+            }
+            return count;
+        }
+
+        /**
+         * OplogStart starts from before the first match, and no further back than the start of
+         * its extent, unless the first match is in the extent inserted into.
+         */
+        void checkStart( int ts ) {
+            const DiskLoc start = findStart( ts );
+            ASSERT_EQUALS( countFrom( DiskLoc(), ts ), countFrom( start, ts ) );
+            if ( start.isNull() ) {
+                return;
+            }
+            ASSERT_LESS_THAN( start.obj()["ts"].numberInt(), ts );
+            Extent* e = start.rec()->myExtent( start );
+            if ( e->myLoc != nsd()->capExtent() ) {
+                ASSERT_EQUALS( e->firstRecord, start );
+            }
+        }
+
+        int nextTs() const { return _nextTs; }
+
+        static const char* ns() { return "unittests.QueryStageOplogStart"; }
+
+        static NamespaceDetails* nsd() { return nsdetails( ns() ); }
+
+    private:
+        static MatchExpression* parse( int ts ) {
+            StatusWithMatchExpression swme =
+                MatchExpressionParser::parse( BSON( "ts" << BSON( "$gte" << ts ) ) );
+            verify( swme.isOK() );
+            return swme.getValue();
+        }
+
+        Lock::GlobalWrite _lk;
+        Client::Context _context;
+        int _nextTs;
+    };
+
+    /** An empty collection is scanned from its beginning. */
+    class Empty : public OplogStartBase {
+    public:
+        void run() {
+            ASSERT( findStart( 5 ).isNull() );
+        }
+    };
+
+    /** Some of the extents filled, none reused. */
+    class NotLooped : public OplogStartBase {
+    public:
+        void run() {
+            insert( 200 );
+            ASSERT( !nsd()->capLooped() );
+            for ( int ts = 1; ts <= nextTs(); ts += 7 ) {
+                checkStart( ts );
+            }
+            // Every document matches: the beginning.
+            ASSERT( findStart( 1 ).isNull() );
+            // Only the newest does.
+            ASSERT( !findStart( nextTs() - 1 ).isNull() );
+            checkStart( nextTs() - 1 );
+        }
+    };
+
+    /** The collection has wrapped around, some times. */
+    class Looped : public OplogStartBase {
+    public:
+        void run() {
+            insert( 2500 );
+            ASSERT( nsd()->capLooped() );
+            for ( int ts = 1; ts <= nextTs(); ts += 13 ) {
+                checkStart( ts );
+            }
+            checkStart( nextTs() - 1 );
+
+            // Stopping part of the way into an extent.
+            insert( 20 );
+            for ( int ts = nextTs() - 1000; ts <= nextTs(); ts += 3 ) {
+                checkStart( ts );
+            }
+        }
+    };
+
+    class All : public Suite {
+    public:
+        All() : Suite( "QueryStageOplogStart" ) {}
+
+        void setupTests() {
+            add<Empty>();
+            add<NotLooped>();
+            add<Looped>();
+        }
+    } all;
+
+}  // namespace QueryStageOplogStart
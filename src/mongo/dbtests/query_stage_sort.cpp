@@ -241,6 +241,109 @@ namespace QueryStageSortTests {
         }
     };
 
+    // With a limit, only the best results come out.
+    class QueryStageSortLimit : public QueryStageSortTestBase {
+    public:
+        virtual int numObj() { return 10000; }
+
+        void run() {
+            Client::WriteContext ctx(ns());
+            fillData();
+
+            WorkingSet* ws = new WorkingSet();
+            MockStage* ms = new MockStage(ws);
+            insertVarietyOfObjects(ms);
+
+            SortStageParams params;
+            params.pattern = BSON("foo" << -1);
+            params.limit = 10;
+
+            PlanExecutor runner(ws, new FetchStage(ws, new SortStage(params, ws, ms), NULL));
+
+            int count = 0;
+            BSONObj current;
+            while (Runner::RUNNER_ADVANCED == runner.getNext(&current, NULL)) {
+                ASSERT_EQUALS(numObj() - 1 - count, current["foo"].numberInt());
+                ++count;
+            }
+            ASSERT_EQUALS(10, count);
+        }
+    };
+
+    // Sort more data than fits in memory, spilling to disk.
+    class QueryStageSortSpill : public QueryStageSortTestBase {
+    public:
+        virtual int numObj() { return 400; }
+
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            // 400 documents of ~100KB don't fit in the sort stage's 32MB.
+            const string pad(100 * 1024, 'x');
+            WorkingSet ws;
+            auto_ptr<MockStage> ms(new MockStage(&ws));
+            for (int i = 0; i < numObj(); ++i) {
+                WorkingSetMember member;
+                member.state = WorkingSetMember::OWNED_OBJ;
+                member.obj = BSON("foo" << (i * 7) % numObj() << "pad" << pad);
+                ms->pushBack(member);
+            }
+
+            SortStageParams params;
+            params.pattern = BSON("foo" << 1);
+            params.allowDiskUse = true;
+            auto_ptr<SortStage> ss(new SortStage(params, &ws, ms.release()));
+
+            int count = 0;
+            while (!ss->isEOF()) {
+                WorkingSetID id;
+                PlanStage::StageState status = ss->work(&id);
+                ASSERT_NOT_EQUALS(PlanStage::FAILURE, status);
+                if (PlanStage::ADVANCED != status) { continue; }
+                WorkingSetMember* member = ws.get(id);
+                ASSERT(member->hasObj());
+                ASSERT_EQUALS(count, member->obj["foo"].numberInt());
+                ws.free(id);
+                ++count;
+            }
+            ASSERT_EQUALS(numObj(), count);
+
+            auto_ptr<PlanStageStats> stats(ss->getStats());
+            ASSERT(static_cast<SortStats*>(stats->specific.get())->usedDisk);
+        }
+    };
+
+    // Without allowDiskUse, the same data fails the sort.
+    class QueryStageSortTooBig : public QueryStageSortTestBase {
+    public:
+        virtual int numObj() { return 400; }
+
+        void run() {
+            Client::WriteContext ctx(ns());
+
+            const string pad(100 * 1024, 'x');
+            WorkingSet ws;
+            MockStage* ms = new MockStage(&ws);
+            for (int i = 0; i < numObj(); ++i) {
+                WorkingSetMember member;
+                member.state = WorkingSetMember::OWNED_OBJ;
+                member.obj = BSON("foo" << i << "pad" << pad);
+                ms->pushBack(member);
+            }
+
+            SortStageParams params;
+            params.pattern = BSON("foo" << 1);
+            SortStage ss(params, &ws, ms);
+
+            PlanStage::StageState status = PlanStage::NEED_TIME;
+            while (PlanStage::NEED_TIME == status) {
+                WorkingSetID id;
+                status = ss.work(&id);
+            }
+            ASSERT_EQUALS(PlanStage::FAILURE, status);
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "query_stage_sort_test" ) { }
@@ -250,6 +353,9 @@ namespace QueryStageSortTests {
             add<QueryStageSortDec>();
             add<QueryStageSortExt>();
             add<QueryStageSortInvalidation>();
+            add<QueryStageSortLimit>();
+            add<QueryStageSortSpill>();
+            add<QueryStageSortTooBig>();
         }
     }  queryStageSortTest;
 
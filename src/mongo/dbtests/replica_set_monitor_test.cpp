@@ -584,6 +584,67 @@ namespace mongo_test {
         ASSERT(!host.empty());
     }
 
+    TEST(ReplSetMonitorReadPref, NearestRelativeWindow) {
+        vector<ReplicaSetMonitor::Node> nodes =
+                NodeSetFixtures::getThreeMemberWithTags();
+        TagSet tags(TagSetFixtures::getDefaultSet());
+        HostAndPort lastHost = nodes[0].addr;
+
+        // Only the fastest node is within 3ms of the fastest.
+        nodes[0].pingTimeMillis = 40;
+        nodes[1].pingTimeMillis = 20;
+        nodes[2].pingTimeMillis = 30;
+
+        bool isPrimarySelected = false;
+        HostAndPort host = ReplicaSetMonitor::selectNode(nodes,
+            mongo::ReadPreference_Nearest, &tags, 3, &lastHost,
+            &isPrimarySelected);
+
+        ASSERT(isPrimarySelected);
+        ASSERT_EQUALS("b", host.host());
+    }
+
+    TEST(ReplSetMonitorReadPref, NearestUsesOpLatency) {
+        vector<ReplicaSetMonitor::Node> nodes =
+                NodeSetFixtures::getThreeMemberWithTags();
+        TagSet tags(TagSetFixtures::getDefaultSet());
+        HostAndPort lastHost = nodes[0].addr;
+
+        nodes[0].pingTimeMillis = 1;
+        nodes[1].pingTimeMillis = 1;
+        nodes[2].pingTimeMillis = 1;
+
+        // Pings well, but its operations are slow.
+        nodes[1].noteOpLatency(50 * 1000);
+        ASSERT_EQUALS(50, nodes[1].latencyMillis());
+
+        bool isPrimarySelected = false;
+        HostAndPort host = ReplicaSetMonitor::selectNode(nodes,
+            mongo::ReadPreference_Nearest, &tags, 15, &lastHost,
+            &isPrimarySelected);
+
+        ASSERT(!isPrimarySelected);
+        ASSERT_EQUALS("c", host.host());
+    }
+
+    TEST(ReplSetMonitorNode, OpLatencyMovingAverage) {
+        vector<ReplicaSetMonitor::Node> nodes =
+                NodeSetFixtures::getThreeMemberWithTags();
+        ReplicaSetMonitor::Node& node = nodes[0];
+
+        ASSERT_EQUALS(0, node.slowOpMicros());
+
+        node.noteOpLatency(8000);
+        ASSERT_EQUALS(8, node.latencyMillis());
+
+        // A single slow operation moves the average an eighth of the way...
+        node.noteOpLatency(16000);
+        ASSERT_EQUALS(9, node.latencyMillis());
+
+        // ...but widens the spread a lot more.
+        ASSERT_GREATER_THAN(node.slowOpMicros(), 9000 + 2 * 3000);
+    }
+
     TEST(ReplSetMonitorReadPref, PriOnlyWithTagsNoMatch) {
         vector<ReplicaSetMonitor::Node> nodes =
                 NodeSetFixtures::getThreeMemberWithTags();
@@ -373,6 +373,74 @@ namespace ThreadedTests {
         }
     };
 
+    class ThreadPoolNestedAndBatched {
+        static const unsigned nThreads = 4;
+
+        ThreadPool* _tp;
+        AtomicUInt32 counter;
+        void increment() {
+            counter.fetchAndAdd(1);
+        }
+        void spawn(unsigned n) {
+            for (unsigned i=0; i<n; i++) {
+                _tp->schedule(&ThreadPoolNestedAndBatched::increment, this);
+            }
+        }
+
+    public:
+        void run() {
+            ThreadPool tp(nThreads);
+            _tp = &tp;
+
+            // tasks scheduling more tasks, which join() waits for too
+            for (unsigned i=0; i < 100; i++) {
+                tp.schedule(&ThreadPoolNestedAndBatched::spawn, this, 10);
+            }
+            tp.join();
+            ASSERT_EQUALS(counter.load(), 1000U);
+
+            vector<threadpool::Task> batch;
+            for (unsigned i=0; i < 1001; i++) {
+                batch.push_back(boost::bind(&ThreadPoolNestedAndBatched::increment, this));
+            }
+            tp.scheduleBatch(batch);
+            tp.join();
+            ASSERT_EQUALS(counter.load(), 2001U);
+            ASSERT_EQUALS(tp.tasks_remaining(), 0);
+        }
+    };
+
+    class ThreadPoolTaskGroup {
+        AtomicUInt32 counter;
+        void increment() {
+            counter.fetchAndAdd(1);
+        }
+        void slowIncrement() {
+            sleepmillis(500);
+            counter.fetchAndAdd(1000);
+        }
+
+    public:
+        void run() {
+            ThreadPool tp(4);
+            tp.schedule(&ThreadPoolTaskGroup::slowIncrement, this);
+
+            {
+                TaskGroup group(tp);
+                for (unsigned i=0; i < 100; i++) {
+                    group.schedule(&ThreadPoolTaskGroup::increment, this);
+                }
+                group.wait();
+
+                // only the group's tasks were waited for
+                ASSERT_EQUALS(counter.load(), 100U);
+            }
+
+            tp.join();
+            ASSERT_EQUALS(counter.load(), 1100U);
+        }
+    };
+
     class LockTest {
     public:
         void run() {
@@ -995,6 +1063,8 @@ namespace ThreadedTests {
             add< IsAtomicWordAtomic<AtomicUInt64> >();
             add< MVarTest >();
             add< ThreadPoolTest >();
+            add< ThreadPoolNestedAndBatched >();
+            add< ThreadPoolTaskGroup >();
             add< LockTest >();
 
 
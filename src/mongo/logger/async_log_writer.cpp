@@ -0,0 +1,139 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_log_writer.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <cstring>
+#include <set>
+
+#include "mongo/util/concurrency/thread_name.h"
+
+namespace mongo {
+namespace logger {
+
+namespace {
+    // Every live AsyncLogWriter, for flushAll().  The set is allocated, and never freed, so that
+    // it outlives the writers destroyed at exit.
+    boost::mutex* liveWritersMutex = new boost::mutex;
+    std::set<AsyncLogWriter*>* liveWriters = new std::set<AsyncLogWriter*>;
+}  // namespace
+
+    AsyncLogWriter::AsyncLogWriter(RotatableFileWriter* writer, size_t bufferBytes) :
+        _writer(writer),
+        _capacity(bufferBytes),
+        _buffer(new char[bufferBytes]),
+        _begin(0),
+        _size(0),
+        _writing(false),
+        _stopping(false),
+        _droppedLines(0),
+        _thread(boost::bind(&AsyncLogWriter::_run, this)) {
+
+        boost::lock_guard<boost::mutex> lk(*liveWritersMutex);
+        liveWriters->insert(this);
+    }
+
+    AsyncLogWriter::~AsyncLogWriter() {
+        {
+            boost::lock_guard<boost::mutex> lk(*liveWritersMutex);
+            liveWriters->erase(this);
+        }
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _stopping = true;
+            _notEmpty.notify_one();
+        }
+        _thread.join();
+    }
+
+    bool AsyncLogWriter::write(const StringData& line) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (line.size() > _capacity - _size) {
+            ++_droppedLines;
+            return false;
+        }
+
+        const size_t end = (_begin + _size) % _capacity;
+        const size_t first = std::min(line.size(), _capacity - end);
+        memcpy(_buffer.get() + end, line.rawData(), first);
+        memcpy(_buffer.get(), line.rawData() + first, line.size() - first);
+        _size += line.size();
+        _notEmpty.notify_one();
+        return true;
+    }
+
+    void AsyncLogWriter::flush() {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (_size > 0 || _writing)
+            _drained.wait(lk);
+    }
+
+    uint64_t AsyncLogWriter::droppedLines() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _droppedLines;
+    }
+
+    void AsyncLogWriter::flushAll() {
+        boost::lock_guard<boost::mutex> lk(*liveWritersMutex);
+        for (std::set<AsyncLogWriter*>::const_iterator it = liveWriters->begin();
+             it != liveWriters->end(); ++it) {
+            (*it)->flush();
+        }
+    }
+
+    void AsyncLogWriter::_run() {
+        setThreadName("logWriter");
+
+        // Bytes are copied out of the ring so that loggers can fill it again during the write.
+        boost::scoped_array<char> out(new char[_capacity]);
+
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (true) {
+            while (_size == 0 && !_stopping)
+                _notEmpty.wait(lk);
+            if (_size == 0)
+                break;
+
+            const size_t n = _size;
+            const size_t first = std::min(n, _capacity - _begin);
+            memcpy(out.get(), _buffer.get() + _begin, first);
+            memcpy(out.get() + first, _buffer.get(), n - first);
+            _begin = (_begin + n) % _capacity;
+            _size = 0;
+            _writing = true;
+            lk.unlock();
+
+            {
+                RotatableFileWriter::Use useWriter(_writer);
+                if (useWriter.status().isOK()) {
+                    useWriter.stream().write(out.get(), n);
+                    useWriter.stream().flush();
+                }
+            }
+
+            lk.lock();
+            _writing = false;
+            if (_size == 0)
+                _drained.notify_all();
+        }
+        _drained.notify_all();
+    }
+
+}  // namespace logger
+}  // namespace mongo
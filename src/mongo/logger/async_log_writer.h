@@ -0,0 +1,93 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/scoped_array.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <cstddef>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/logger/rotatable_file_writer.h"
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+namespace logger {
+
+    /**
+     * Writes lines to a RotatableFileWriter from a thread of its own, so that the threads logging
+     * never wait on the file.
+     *
+     * Lines are copied into a ring buffer of a fixed size, and the writer thread takes everything
+     * buffered out at once.  A line that doesn't fit in the room left is dropped, and counted,
+     * rather than making its caller wait for the file to catch up.
+     */
+    class AsyncLogWriter {
+        MONGO_DISALLOW_COPYING(AsyncLogWriter);
+    public:
+        /**
+         * Constructs a writer for "writer", which the caller must keep in scope at least as long
+         * as the constructed instance, buffering at most "bufferBytes" bytes.
+         */
+        AsyncLogWriter(RotatableFileWriter* writer, size_t bufferBytes);
+
+        /**
+         * Writes out whatever is buffered, and stops the writer thread.
+         */
+        ~AsyncLogWriter();
+
+        /**
+         * Buffers "line" to be written, or returns false, and counts it dropped, if there isn't
+         * room for all of it.
+         */
+        bool write(const StringData& line);
+
+        /**
+         * Waits for everything written so far to reach the file.
+         */
+        void flush();
+
+        uint64_t droppedLines() const;
+
+        /**
+         * Flushes every AsyncLogWriter in the process, for use before exiting without running
+         * destructors.
+         */
+        static void flushAll();
+
+    private:
+        void _run();
+
+        RotatableFileWriter* const _writer;
+        const size_t _capacity;
+        boost::scoped_array<char> _buffer;
+
+        mutable boost::mutex _mutex;
+        boost::condition_variable _notEmpty;    // signaled when bytes are buffered, or stopping
+        boost::condition_variable _drained;     // signaled when the writer thread goes idle
+        size_t _begin;                          // offset in _buffer of the oldest byte buffered
+        size_t _size;                           // number of bytes buffered
+        bool _writing;                          // the writer thread has bytes not yet written
+        bool _stopping;
+        uint64_t _droppedLines;
+
+        boost::thread _thread;                  // last, so it starts after the rest is set up
+    };
+
+}  // namespace logger
+}  // namespace mongo
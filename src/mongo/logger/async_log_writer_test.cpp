@@ -0,0 +1,118 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mongo/logger/async_log_appender.h"
+#include "mongo/logger/async_log_writer.h"
+#include "mongo/logger/message_event_utf8_encoder.h"
+#include "mongo/logger/message_log_domain.h"
+#include "mongo/logger/rotatable_file_writer.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+    using namespace mongo::logger;
+
+    const std::string logFileName("LogTest_AsyncLogWriter.txt");
+
+    class AsyncLogWriterTest : public mongo::unittest::Test {
+    public:
+        AsyncLogWriterTest() {
+            unlink(logFileName.c_str());
+            RotatableFileWriter::Use writerUse(&_fileWriter);
+            ASSERT_OK(writerUse.setFileName(logFileName, false));
+        }
+
+        virtual ~AsyncLogWriterTest() {
+            unlink(logFileName.c_str());
+        }
+
+    protected:
+        std::vector<std::string> readLines() {
+            std::vector<std::string> lines;
+            std::ifstream ifs(logFileName.c_str());
+            std::string line;
+            while (std::getline(ifs, line))
+                lines.push_back(line);
+            return lines;
+        }
+
+        RotatableFileWriter _fileWriter;
+    };
+
+    TEST_F(AsyncLogWriterTest, WritesInOrder) {
+        AsyncLogWriter writer(&_fileWriter, 64);
+        for (int i = 0; i < 1000; ++i) {
+            std::string line = std::string("line ") + char('a' + i % 26) + "\n";
+            // Room frees up as the writer thread catches up.
+            while (!writer.write(line))
+                writer.flush();
+        }
+        writer.flush();
+
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(1000U, lines.size());
+        for (int i = 0; i < 1000; ++i)
+            ASSERT_EQUALS(std::string("line ") + char('a' + i % 26), lines[i]);
+    }
+
+    TEST_F(AsyncLogWriterTest, DropsLinesThatDontFit) {
+        AsyncLogWriter writer(&_fileWriter, 8);
+        ASSERT_FALSE(writer.write("much too long\n"));
+        ASSERT_FALSE(writer.write("longer still, too\n"));
+        ASSERT_EQUALS(2U, writer.droppedLines());
+
+        ASSERT_TRUE(writer.write("fits\n"));
+        writer.flush();
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(1U, lines.size());
+        ASSERT_EQUALS("fits", lines[0]);
+        ASSERT_EQUALS(2U, writer.droppedLines());
+    }
+
+    TEST_F(AsyncLogWriterTest, DestructorWritesWhatIsBuffered) {
+        {
+            AsyncLogWriter writer(&_fileWriter, 1024);
+            ASSERT_TRUE(writer.write("first\n"));
+            ASSERT_TRUE(writer.write("second\n"));
+        }
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(2U, lines.size());
+        ASSERT_EQUALS("first", lines[0]);
+        ASSERT_EQUALS("second", lines[1]);
+    }
+
+    TEST_F(AsyncLogWriterTest, AppenderInLogDomain) {
+        AsyncLogWriter writer(&_fileWriter, 1024);
+        MessageLogDomain domain;
+        domain.attachAppender(MessageLogDomain::AppenderAutoPtr(
+                new AsyncLogAppender<MessageEventEphemeral>(new MessageEventUnadornedEncoder,
+                                                            &writer)));
+        domain.append(MessageEventEphemeral(0ULL, LogSeverity::Log(), "", "hello\n"));
+        domain.append(MessageEventEphemeral(0ULL, LogSeverity::Log(), "", "world\n"));
+        writer.flush();
+
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(2U, lines.size());
+        ASSERT_EQUALS("hello", lines[0]);
+        ASSERT_EQUALS("world", lines[1]);
+    }
+
+}  // namespace
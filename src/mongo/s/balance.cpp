@@ -30,6 +30,9 @@
 
 #include "mongo/s/balance.h"
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/distlock.h"
 #include "mongo/db/jsobj.h"
@@ -55,80 +58,127 @@ namespace mongo {
     Balancer::~Balancer() {
     }
 
-    int Balancer::_moveChunks(const vector<CandidateChunkPtr>* candidateChunks,
+    int Balancer::_moveChunk( const CandidateChunk& chunkInfo,
                               bool secondaryThrottle,
-                              bool waitForDelete)
-    {
-        int movedCount = 0;
+                              bool waitForDelete ) {
 
-        for ( vector<CandidateChunkPtr>::const_iterator it = candidateChunks->begin(); it != candidateChunks->end(); ++it ) {
-            const CandidateChunk& chunkInfo = *it->get();
+        // Changes to metadata, borked metadata, and connectivity problems should cause us to
+        // abort this chunk move, but shouldn't cause us to abort the entire round of chunks.
+        // TODO: Handle all these things more cleanly, since they're expected problems
+        try {
 
-            // Changes to metadata, borked metadata, and connectivity problems should cause us to
-            // abort this chunk move, but shouldn't cause us to abort the entire round of chunks.
-            // TODO: Handle all these things more cleanly, since they're expected problems
-            try {
+            DBConfigPtr cfg = grid.getDBConfig( chunkInfo.ns );
+            verify( cfg );
 
-                DBConfigPtr cfg = grid.getDBConfig( chunkInfo.ns );
-                verify( cfg );
+            // NOTE: We purposely do not reload metadata here, since _doBalanceRound already
+            // tried to do so once.
+            ChunkManagerPtr cm = cfg->getChunkManager( chunkInfo.ns );
+            verify( cm );
 
-                // NOTE: We purposely do not reload metadata here, since _doBalanceRound already
-                // tried to do so once.
-                ChunkManagerPtr cm = cfg->getChunkManager( chunkInfo.ns );
+            ChunkPtr c = cm->findIntersectingChunk( chunkInfo.chunk.min );
+            if ( c->getMin().woCompare( chunkInfo.chunk.min ) || c->getMax().woCompare( chunkInfo.chunk.max ) ) {
+                // likely a split happened somewhere
+                cm = cfg->getChunkManager( chunkInfo.ns , true /* reload */);
                 verify( cm );
 
-                ChunkPtr c = cm->findIntersectingChunk( chunkInfo.chunk.min );
+                c = cm->findIntersectingChunk( chunkInfo.chunk.min );
                 if ( c->getMin().woCompare( chunkInfo.chunk.min ) || c->getMax().woCompare( chunkInfo.chunk.max ) ) {
-                    // likely a split happened somewhere
-                    cm = cfg->getChunkManager( chunkInfo.ns , true /* reload */);
-                    verify( cm );
-
-                    c = cm->findIntersectingChunk( chunkInfo.chunk.min );
-                    if ( c->getMin().woCompare( chunkInfo.chunk.min ) || c->getMax().woCompare( chunkInfo.chunk.max ) ) {
-                        log() << "chunk mismatch after reload, ignoring will retry issue " << chunkInfo.chunk.toString() << endl;
-                        continue;
-                    }
+                    log() << "chunk mismatch after reload, ignoring will retry issue " << chunkInfo.chunk.toString() << endl;
+                    return 0;
                 }
+            }
 
-                BSONObj res;
-                if (c->moveAndCommit(Shard::make(chunkInfo.to),
-                                     Chunk::MaxChunkSize,
-                                     secondaryThrottle,
-                                     waitForDelete,
-                                     0, /* maxTimeMS */
-                                     res)) {
-                    movedCount++;
-                    continue;
+            BSONObj res;
+            if (c->moveAndCommit(Shard::make(chunkInfo.to),
+                                 Chunk::MaxChunkSize,
+                                 secondaryThrottle,
+                                 waitForDelete,
+                                 0, /* maxTimeMS */
+                                 res)) {
+                return 1;
+            }
+
+            // the move requires acquiring the collection metadata's lock, which can fail
+            log() << "balancer move failed: " << res << " from: " << chunkInfo.from << " to: " << chunkInfo.to
+                  << " chunk: " << chunkInfo.chunk << endl;
+
+            if ( res["chunkTooBig"].trueValue() ) {
+                // reload just to be safe
+                cm = cfg->getChunkManager( chunkInfo.ns );
+                verify( cm );
+                c = cm->findIntersectingChunk( chunkInfo.chunk.min );
+
+                log() << "forcing a split because migrate failed for size reasons" << endl;
+
+                res = BSONObj();
+                c->singleSplit( true , res );
+                log() << "forced split results: " << res << endl;
+
+                if ( ! res["ok"].trueValue() ) {
+                    log() << "marking chunk as jumbo: " << c->toString() << endl;
+                    c->markAsJumbo();
+                    // we increment moveCount so we do another round right away
+                    return 1;
                 }
 
-                // the move requires acquiring the collection metadata's lock, which can fail
-                log() << "balancer move failed: " << res << " from: " << chunkInfo.from << " to: " << chunkInfo.to
-                      << " chunk: " << chunkInfo.chunk << endl;
+            }
+        }
+        catch( const std::exception& ex ) {
+            warning() << "could not move chunk " << chunkInfo.chunk.toString()
+                      << ", continuing balancing round" << causedBy( ex ) << endl;
+        }
 
-                if ( res["chunkTooBig"].trueValue() ) {
-                    // reload just to be safe
-                    cm = cfg->getChunkManager( chunkInfo.ns );
-                    verify( cm );
-                    c = cm->findIntersectingChunk( chunkInfo.chunk.min );
+        return 0;
+    }
 
-                    log() << "forcing a split because migrate failed for size reasons" << endl;
+    void Balancer::_moveChunkThread( const CandidateChunk* chunkInfo,
+                                     bool secondaryThrottle,
+                                     bool waitForDelete,
+                                     int* moved ) {
+        setThreadName( "BalancerMigration" );
+        *moved = _moveChunk( *chunkInfo, secondaryThrottle, waitForDelete );
+    }
 
-                    res = BSONObj();
-                    c->singleSplit( true , res );
-                    log() << "forced split results: " << res << endl;
+    int Balancer::_moveChunks(const vector<CandidateChunkPtr>* candidateChunks,
+                              bool secondaryThrottle,
+                              bool waitForDelete,
+                              int maxConcurrentMigrations)
+    {
+        vector<const MigrateInfo*> migrations;
+        for ( vector<CandidateChunkPtr>::const_iterator it = candidateChunks->begin(); it != candidateChunks->end(); ++it ) {
+            migrations.push_back( it->get() );
+        }
 
-                    if ( ! res["ok"].trueValue() ) {
-                        log() << "marking chunk as jumbo: " << c->toString() << endl;
-                        c->markAsJumbo();
-                        // we increment moveCount so we do another round right away
-                        movedCount++;
-                    }
+        vector< vector<size_t> > rounds =
+            BalancerPolicy::scheduleMigrations( migrations, maxConcurrentMigrations );
 
-                }
+        int movedCount = 0;
+
+        for ( size_t r = 0; r < rounds.size(); r++ ) {
+            const vector<size_t>& round = rounds[r];
+
+            if ( round.size() == 1 ) {
+                movedCount += _moveChunk( *migrations[round[0]], secondaryThrottle, waitForDelete );
+                continue;
             }
-            catch( const DBException& ex ) {
-                warning() << "could not move chunk " << chunkInfo.chunk.toString()
-                          << ", continuing balancing round" << causedBy( ex ) << endl;
+
+            // No shard takes part in more than one of these, so they don't wait on each other
+            LOG(1) << "moving " << round.size() << " chunks at once" << endl;
+
+            vector<int> moved( round.size(), 0 );
+            boost::thread_group threads;
+            for ( size_t i = 0; i < round.size(); i++ ) {
+                threads.create_thread( boost::bind( &Balancer::_moveChunkThread,
+                                                    this,
+                                                    migrations[round[i]],
+                                                    secondaryThrottle,
+                                                    waitForDelete,
+                                                    &moved[i] ) );
+            }
+            threads.join_all();
+
+            for ( size_t i = 0; i < moved.size(); i++ ) {
+                movedCount += moved[i];
             }
         }
 
@@ -201,7 +251,37 @@ namespace mongo {
         }        
     }
 
-    void Balancer::_doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks ) {
+    /**
+     * Asks the shards holding chunks of 'ns' for the recent load on each of them.  Shards that
+     * don't answer are left out.
+     */
+    static void loadChunkLoads( const string& ns,
+                                const vector<Shard>& allShards,
+                                const ShardToChunksMap& shardToChunksMap,
+                                DistributionStatus* status ) {
+        for ( vector<Shard>::const_iterator it = allShards.begin(); it != allShards.end(); ++it ) {
+            ShardToChunksMap::const_iterator chunks = shardToChunksMap.find( it->getName() );
+            if ( chunks == shardToChunksMap.end() || chunks->second.empty() )
+                continue;
+
+            try {
+                BSONObj res = it->runCommand( "admin", BSON( "getChunkLoad" << ns ) );
+                BSONObjIterator i( res["chunks"].Obj() );
+                while ( i.more() ) {
+                    BSONObj chunk = i.next().Obj();
+                    status->addChunkLoad( chunk["min"].Obj(), chunk["ops"].numberLong() );
+                }
+            }
+            catch ( const DBException& e ) {
+                LOG(1) << "could not get chunk load for " << ns << " from " << it->getName()
+                       << causedBy( e ) << endl;
+            }
+        }
+    }
+
+    void Balancer::_doBalanceRound( DBClientBase& conn,
+                                    bool balanceOnLoad,
+                                    vector<CandidateChunkPtr>* candidateChunks ) {
         verify( candidateChunks );
 
         //
@@ -368,6 +448,28 @@ namespace mongo {
                 continue;
             }
 
+            if ( balanceOnLoad ) {
+                loadChunkLoads( ns, allShards, shardToChunksMap, &status );
+
+                // a chunk taking most of the load can't be spread until it is split
+                BSONObj hotMin = BalancerPolicy::findHotChunk( status );
+                if ( ! hotMin.isEmpty() ) {
+                    ChunkPtr c = cm->findIntersectingChunk( hotMin );
+                    log() << "ns: " << ns << " splitting " << c->toString()
+                          << " because it takes most of the load" << endl;
+
+                    BSONObj res;
+                    c->singleSplit( true /* force */, res );
+                    if ( ! res["ok"].trueValue() ) {
+                        LOG(1) << "split of hot chunk failed: " << res << endl;
+                    }
+                    else {
+                        // state change, just wait till next round
+                        continue;
+                    }
+                }
+            }
+
             CandidateChunk* p = _policy->balance( ns, status, _balancedLastTime );
             if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
         }
@@ -492,11 +594,24 @@ namespace mongo {
                         secondaryThrottle = balancerConfig[SettingsType::secondaryThrottle()].trueValue();
                     }
 
+                    // how many chunks may be moving at once, each between a different pair of
+                    // shards; limits how much of the cluster's bandwidth balancing takes
+                    int maxConcurrentMigrations = 1;
+                    if ( balancerConfig["_maxConcurrentMigrations"].isNumber() ) {
+                        maxConcurrentMigrations =
+                            std::max( 1, balancerConfig["_maxConcurrentMigrations"].numberInt() );
+                    }
+
                     LOG(1) << "waitForDelete: " << waitForDelete << endl;
                     LOG(1) << "secondaryThrottle: " << secondaryThrottle << endl;
+                    LOG(1) << "maxConcurrentMigrations: " << maxConcurrentMigrations << endl;
+
+                    // also spread the load the shards report for their chunks
+                    bool balanceOnLoad = balancerConfig["_balanceOnLoad"].trueValue();
+                    LOG(1) << "balanceOnLoad: " << balanceOnLoad << endl;
 
                     vector<CandidateChunkPtr> candidateChunks;
-                    _doBalanceRound( conn.conn() , &candidateChunks );
+                    _doBalanceRound( conn.conn() , balanceOnLoad, &candidateChunks );
                     if ( candidateChunks.size() == 0 ) {
                         LOG(1) << "no need to move any chunk" << endl;
                         _balancedLastTime = 0;
@@ -504,7 +619,8 @@ namespace mongo {
                     else {
                         _balancedLastTime = _moveChunks(&candidateChunks,
                                                         secondaryThrottle,
-                                                        waitForDelete );
+                                                        waitForDelete,
+                                                        maxConcurrentMigrations );
                     }
 
                     LOG(1) << "*** end of balancing round" << endl;
@@ -88,21 +88,42 @@ namespace mongo {
          * be moved.
          *
          * @param conn is the connection with the config server(s)
+         * @param balanceOnLoad whether to ask the shards for the load on their chunks, and spread
+         *        and split by it
          * @param candidateChunks (IN/OUT) filled with candidate chunks, one per collection, that could possibly be moved
          */
-        void _doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks );
+        void _doBalanceRound( DBClientBase& conn,
+                              bool balanceOnLoad,
+                              vector<CandidateChunkPtr>* candidateChunks );
 
         /**
-         * Issues chunk migration request, one at a time.
+         * Issues chunk migration requests, several at once as long as no shard takes part in
+         * more than one of them.
          *
          * @param candidateChunks possible chunks to move
          * @param secondaryThrottle wait for secondaries to catch up before pushing more deletes
          * @param waitForDelete wait for deletes to complete after each chunk move
+         * @param maxConcurrentMigrations most chunks to be moving at any time
          * @return number of chunks effectively moved
          */
         int _moveChunks(const vector<CandidateChunkPtr>* candidateChunks,
                         bool secondaryThrottle,
-                        bool waitForDelete);
+                        bool waitForDelete,
+                        int maxConcurrentMigrations);
+
+        /**
+         * Moves one chunk, splitting it or marking it jumbo if it is too big to move.
+         *
+         * @return 1 if the chunk was moved or marked jumbo, 0 otherwise
+         */
+        int _moveChunk(const CandidateChunk& chunkInfo,
+                       bool secondaryThrottle,
+                       bool waitForDelete);
+
+        void _moveChunkThread(const CandidateChunk* chunkInfo,
+                              bool secondaryThrottle,
+                              bool waitForDelete,
+                              int* moved);
 
         /**
          * Marks this balancer as being live on the config server(s).
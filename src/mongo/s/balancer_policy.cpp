@@ -145,6 +145,41 @@ namespace mongo {
         return worst;
     }
 
+    void DistributionStatus::addChunkLoad( const BSONObj& chunkMin, long long ops ) {
+        _chunkLoads[chunkMin.getOwned()] += ops;
+    }
+
+    long long DistributionStatus::getChunkLoad( const BSONObj& chunk ) const {
+        map<BSONObj,long long>::const_iterator i =
+            _chunkLoads.find( chunk[ChunkType::min()].Obj() );
+        if ( i == _chunkLoads.end() )
+            return 0;
+        return i->second;
+    }
+
+    long long DistributionStatus::shardLoad( const string& shard, const string& tag ) const {
+        ShardToChunksMap::const_iterator i = _shardChunks.find( shard );
+        if ( _chunkLoads.empty() || i == _shardChunks.end() )
+            return 0;
+
+        long long total = 0;
+        const vector<BSONObj>& chunks = i->second;
+        for ( unsigned j = 0; j < chunks.size(); j++ ) {
+            if ( getTagForChunk( chunks[j] ) != tag )
+                continue;
+            total += getChunkLoad( chunks[j] );
+        }
+        return total;
+    }
+
+    long long DistributionStatus::totalLoad() const {
+        long long total = 0;
+        for ( map<BSONObj,long long>::const_iterator i = _chunkLoads.begin();
+              i != _chunkLoads.end(); ++i )
+            total += i->second;
+        return total;
+    }
+
     const vector<BSONObj>& DistributionStatus::getChunks( const string& shard ) const {
         ShardToChunksMap::const_iterator i = _shardChunks.find(shard);
         verify( i != _shardChunks.end() );
@@ -224,6 +259,41 @@ namespace mongo {
         }
     }
 
+    vector< vector<size_t> > BalancerPolicy::scheduleMigrations(
+            const vector<const MigrateInfo*>& migrations, size_t maxConcurrent ) {
+
+        if ( maxConcurrent < 1 )
+            maxConcurrent = 1;
+
+        vector< vector<size_t> > rounds;
+        vector<bool> scheduled( migrations.size(), false );
+        size_t numScheduled = 0;
+
+        while ( numScheduled < migrations.size() ) {
+            vector<size_t> round;
+            set<string> busy;
+
+            for ( size_t i = 0; i < migrations.size() && round.size() < maxConcurrent; i++ ) {
+                if ( scheduled[i] )
+                    continue;
+
+                const MigrateInfo* m = migrations[i];
+                if ( busy.count( m->from ) || busy.count( m->to ) )
+                    continue;
+
+                busy.insert( m->from );
+                busy.insert( m->to );
+                round.push_back( i );
+                scheduled[i] = true;
+                numScheduled++;
+            }
+
+            rounds.push_back( round );
+        }
+
+        return rounds;
+    }
+
     bool BalancerPolicy::_isJumbo( const BSONObj& chunk ) {
         if ( chunk[ChunkType::jumbo()].trueValue() ) {
             LOG(1) << "chunk: " << chunk << "is marked as jumbo" << endl;
@@ -410,10 +480,121 @@ namespace mongo {
             verify( false ); // should be impossible
         }
 
+        // 4) with the loads of the chunks known, spread the load as well
+        if ( distribution.hasChunkLoads() ) {
+            MigrateInfo* m = _balanceLoad( ns, distribution, tags, threshold );
+            if ( m )
+                return m;
+        }
+
         // Everything is balanced here!
         return NULL;
     }
 
+    const long long BalancerPolicy::kMinLoadToBalance = 1000;
+
+    MigrateInfo* BalancerPolicy::_balanceLoad( const string& ns,
+                                               const DistributionStatus& distribution,
+                                               const vector<string>& tags,
+                                               int threshold ) {
+
+        for ( unsigned i = 0; i < tags.size(); i++ ) {
+            const string& tag = tags[i];
+
+            string from;
+            string to;
+            long long maxLoad = -1;
+            long long minLoad = numeric_limits<long long>::max();
+
+            const set<string>& shards = distribution.shards();
+            for ( set<string>::const_iterator s = shards.begin(); s != shards.end(); ++s ) {
+                const ShardInfo& info = distribution.shardInfo( *s );
+                if ( info.hasOpsQueued() )
+                    continue;
+
+                long long load = distribution.shardLoad( *s, tag );
+                if ( load > maxLoad ) {
+                    maxLoad = load;
+                    from = *s;
+                }
+
+                if ( info.isSizeMaxed() || info.isDraining() || ! info.hasTag( tag ) )
+                    continue;
+
+                if ( load < minLoad ) {
+                    minLoad = load;
+                    to = *s;
+                }
+            }
+
+            if ( from.empty() || to.empty() || from == to )
+                continue;
+
+            if ( maxLoad < kMinLoadToBalance || maxLoad <= 2 * minLoad )
+                continue;
+
+            // don't make the chunk counts so uneven that we'd move a chunk straight back
+            int fromChunks = distribution.numberOfChunksInShardWithTag( from, tag );
+            int toChunks = distribution.numberOfChunksInShardWithTag( to, tag );
+            if ( ( toChunks + 1 ) - ( fromChunks - 1 ) >= threshold )
+                continue;
+
+            // the chunk that best evens the two out, without making 'to' the busier
+            const long long diff = maxLoad - minLoad;
+            const vector<BSONObj>& chunks = distribution.getChunks( from );
+            BSONObj best;
+            long long bestDistance = numeric_limits<long long>::max();
+            for ( unsigned j = 0; j < chunks.size(); j++ ) {
+                if ( distribution.getTagForChunk( chunks[j] ) != tag )
+                    continue;
+                if ( _isJumbo( chunks[j] ) )
+                    continue;
+
+                long long load = distribution.getChunkLoad( chunks[j] );
+                if ( load <= 0 || load >= diff )
+                    continue;
+
+                long long distance = diff - 2 * load;
+                if ( distance < 0 )
+                    distance = -distance;
+                if ( distance < bestDistance ) {
+                    bestDistance = distance;
+                    best = chunks[j];
+                }
+            }
+
+            if ( best.isEmpty() )
+                continue;
+
+            log() << " ns: " << ns << " going to move " << best
+                  << " from: " << from << " (load " << maxLoad << ")"
+                  << " to: " << to << " (load " << minLoad << ")"
+                  << " tag [" << tag << "]" << endl;
+            return new MigrateInfo( ns, to, from, best );
+        }
+
+        return NULL;
+    }
+
+    BSONObj BalancerPolicy::findHotChunk( const DistributionStatus& distribution ) {
+        long long total = distribution.totalLoad();
+        if ( total < kMinLoadToBalance )
+            return BSONObj();
+
+        const set<string>& shards = distribution.shards();
+        for ( set<string>::const_iterator s = shards.begin(); s != shards.end(); ++s ) {
+            const vector<BSONObj>& chunks = distribution.getChunks( *s );
+            for ( unsigned i = 0; i < chunks.size(); i++ ) {
+                if ( _isJumbo( chunks[i] ) )
+                    continue;
+                if ( 2 * distribution.getChunkLoad( chunks[i] ) > total )
+                    return chunks[i][ChunkType::min()].Obj();
+            }
+        }
+
+        return BSONObj();
+    }
+
 
     ShardInfo::ShardInfo( long long maxSize, long long currSize,
                           bool draining, bool opsQueued,
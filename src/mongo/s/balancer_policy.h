@@ -139,6 +139,11 @@ namespace mongo {
          */
         bool addTagRange( const TagRange& range );
 
+        /**
+         * Records the recent load on a chunk, as estimated by its shard.
+         */
+        void addChunkLoad( const BSONObj& chunkMin, long long ops );
+
         // ---- these methods might be better suiting in BalancerPolicy
         
         /**
@@ -179,6 +184,18 @@ namespace mongo {
 
         /** @return the ShardInfo for the shard */
         const ShardInfo& shardInfo( const string& shard ) const;
+
+        /** @return true if any chunk has a load recorded */
+        bool hasChunkLoads() const { return ! _chunkLoads.empty(); }
+
+        /** @return the recorded load of the chunk, 0 if none */
+        long long getChunkLoad( const BSONObj& chunk ) const;
+
+        /** @return the total load of the chunks on this shard with the given tag */
+        long long shardLoad( const string& shard, const string& tag ) const;
+
+        /** @return the total load of all the chunks */
+        long long totalLoad() const;
         
         /** writes all state to log() */
         void dump() const;
@@ -187,6 +204,7 @@ namespace mongo {
         const ShardInfoMap& _shardInfo;
         const ShardToChunksMap& _shardChunks;
         map<BSONObj,TagRange> _tagRanges;
+        map<BSONObj,long long> _chunkLoads; // by chunk min
         set<string> _allTags;
         set<string> _shards;
     };
@@ -209,8 +227,38 @@ namespace mongo {
                                      const DistributionStatus& distribution,
                                      int balancedLastTime );
 
+        /**
+         * Splits migrations into rounds that can run at the same time: a round has at most
+         * maxConcurrent migrations and no shard is the donor or the recipient of more than one
+         * of them.  Each migration goes in the first round it fits in, in the order given.
+         *
+         * @returns the rounds, as indexes into migrations
+         */
+        /**
+         * Returns the min of a chunk that takes so much of the collection's load that it should
+         * be split, so that its parts can go to different shards; an empty object if there is
+         * no such chunk.
+         */
+        static BSONObj findHotChunk( const DistributionStatus& distribution );
+
+        static vector< vector<size_t> > scheduleMigrations( const vector<const MigrateInfo*>& migrations,
+                                                            size_t maxConcurrent );
+
+        // least total load, in estimated writes, for the load of a collection to be balanced
+        static const long long kMinLoadToBalance;
+
     private:
         static bool _isJumbo( const BSONObj& chunk );
+
+        /**
+         * Moves a chunk from the shard with the most load to the one with the least, if one
+         * has more than twice the load of the other and the move keeps the chunk counts within
+         * 'threshold'.
+         */
+        static MigrateInfo* _balanceLoad( const string& ns,
+                                          const DistributionStatus& distribution,
+                                          const vector<string>& tags,
+                                          int threshold );
     };
 
 
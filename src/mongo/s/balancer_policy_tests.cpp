@@ -13,6 +13,7 @@
  *    limitations under the License.
  */
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/balancer_policy.h"
 #include "mongo/s/config.h"
@@ -507,5 +508,113 @@ namespace mongo {
                 }
             }
         }
+
+        TEST( BalancerPolicyTests, ScheduleMigrations ) {
+            BSONObj chunk = BSON(ChunkType::min(BSON("x" << 0)) << ChunkType::max(BSON("x" << 1)));
+
+            OwnedPointerVector<MigrateInfo> owned;
+            owned.mutableVector().push_back( new MigrateInfo( "a", "shard1", "shard0", chunk ) );
+            owned.mutableVector().push_back( new MigrateInfo( "b", "shard2", "shard0", chunk ) );
+            owned.mutableVector().push_back( new MigrateInfo( "c", "shard3", "shard4", chunk ) );
+            owned.mutableVector().push_back( new MigrateInfo( "d", "shard1", "shard5", chunk ) );
+            owned.mutableVector().push_back( new MigrateInfo( "e", "shard6", "shard7", chunk ) );
+
+            vector<const MigrateInfo*> migrations( owned.vector().begin(), owned.vector().end() );
+
+            // one at a time, in order
+            vector< vector<size_t> > rounds = BalancerPolicy::scheduleMigrations( migrations, 1 );
+            ASSERT_EQUALS( 5U, rounds.size() );
+            for ( size_t i = 0; i < rounds.size(); i++ ) {
+                ASSERT_EQUALS( 1U, rounds[i].size() );
+                ASSERT_EQUALS( i, rounds[i][0] );
+            }
+
+            // no shard twice in a round
+            rounds = BalancerPolicy::scheduleMigrations( migrations, 10 );
+            ASSERT_EQUALS( 2U, rounds.size() );
+            ASSERT_EQUALS( 3U, rounds[0].size() );
+            ASSERT_EQUALS( 0U, rounds[0][0] );
+            ASSERT_EQUALS( 2U, rounds[0][1] );
+            ASSERT_EQUALS( 4U, rounds[0][2] );
+            ASSERT_EQUALS( 2U, rounds[1].size() );
+            ASSERT_EQUALS( 1U, rounds[1][0] );
+            ASSERT_EQUALS( 3U, rounds[1][1] );
+
+            // at most two in a round
+            rounds = BalancerPolicy::scheduleMigrations( migrations, 2 );
+            ASSERT_EQUALS( 3U, rounds.size() );
+            ASSERT_EQUALS( 2U, rounds[0].size() );
+            ASSERT_EQUALS( 2U, rounds[1].size() );
+            ASSERT_EQUALS( 1U, rounds[2].size() );
+            ASSERT_EQUALS( 4U, rounds[2][0] );
+
+            ASSERT( BalancerPolicy::scheduleMigrations( vector<const MigrateInfo*>(), 4 ).empty() );
+        }
+
+        // 10 chunks on each of two shards, with the given loads on the first few of shard0's
+        void addLoadTestChunks( ShardToChunksMap* chunkMap, ShardInfoMap* info ) {
+            for ( int i = 0; i < 20; i++ ) {
+                (*chunkMap)[i < 10 ? "shard0" : "shard1"].push_back(
+                        BSON(ChunkType::min(BSON("x" << i)) << ChunkType::max(BSON("x" << i + 1))) );
+            }
+            (*info)["shard0"] = ShardInfo( 0, 10, false, false );
+            (*info)["shard1"] = ShardInfo( 0, 10, false, false );
+        }
+
+        TEST( BalancerPolicyTests, BalanceLoad ) {
+            ShardToChunksMap chunkMap;
+            ShardInfoMap info;
+            addLoadTestChunks( &chunkMap, &info );
+
+            // even counts and no loads: nothing to do
+            {
+                DistributionStatus status( info, chunkMap );
+                ASSERT( ! BalancerPolicy::balance( "ns", status, 0 ) );
+            }
+
+            DistributionStatus status( info, chunkMap );
+            status.addChunkLoad( BSON( "x" << 0 ), 1000 );
+            status.addChunkLoad( BSON( "x" << 1 ), 600 );
+            status.addChunkLoad( BSON( "x" << 2 ), 300 );
+            status.addChunkLoad( BSON( "x" << 3 ), 100 );
+            status.addChunkLoad( BSON( "x" << 15 ), 200 );
+
+            ASSERT_EQUALS( 2000, status.shardLoad( "shard0", "" ) );
+            ASSERT_EQUALS( 200, status.shardLoad( "shard1", "" ) );
+            ASSERT( BalancerPolicy::findHotChunk( status ).isEmpty() );
+
+            // the chunk that evens out the load best
+            scoped_ptr<MigrateInfo> m( BalancerPolicy::balance( "ns", status, 0 ) );
+            ASSERT( m );
+            ASSERT_EQUALS( "shard0", m->from );
+            ASSERT_EQUALS( "shard1", m->to );
+            ASSERT_EQUALS( BSON( "x" << 0 ), m->chunk.min );
+        }
+
+        TEST( BalancerPolicyTests, BalanceLoadTooLittle ) {
+            ShardToChunksMap chunkMap;
+            ShardInfoMap info;
+            addLoadTestChunks( &chunkMap, &info );
+
+            DistributionStatus status( info, chunkMap );
+            status.addChunkLoad( BSON( "x" << 0 ), 300 );
+            status.addChunkLoad( BSON( "x" << 1 ), 300 );
+            ASSERT( ! BalancerPolicy::balance( "ns", status, 0 ) );
+        }
+
+        TEST( BalancerPolicyTests, FindHotChunk ) {
+            ShardToChunksMap chunkMap;
+            ShardInfoMap info;
+            addLoadTestChunks( &chunkMap, &info );
+
+            DistributionStatus status( info, chunkMap );
+            status.addChunkLoad( BSON( "x" << 12 ), 5000 );
+            status.addChunkLoad( BSON( "x" << 3 ), 1000 );
+            ASSERT_EQUALS( BSON( "x" << 12 ), BalancerPolicy::findHotChunk( status ) );
+
+            // a single chunk with all the load can't be spread by moving it
+            scoped_ptr<MigrateInfo> m( BalancerPolicy::balance( "ns", status, 0 ) );
+            ASSERT( ! m || m->chunk.min.woCompare( BSON( "x" << 12 ) ) != 0 );
+        }
     }
 }
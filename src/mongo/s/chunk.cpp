@@ -34,6 +34,7 @@
 
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/queryutil.h"
 #include "mongo/platform/random.h"
@@ -43,6 +44,7 @@
 #include "mongo/s/config.h"
 #include "mongo/s/cursors.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/shard_key_pattern.h"
 #include "mongo/s/strategy.h"
 #include "mongo/s/type_collection.h"
 #include "mongo/s/type_settings.h"
@@ -603,6 +605,57 @@ namespace mongo {
 
     AtomicUInt ChunkManager::NextSequenceNumber = 1;
 
+    namespace {
+        /** how often and how long each collection's ChunkManager took to load */
+        struct RefreshStats {
+            RefreshStats() : refreshes( 0 ), incremental( 0 ), totalMillis( 0 ), lastMillis( 0 ),
+                             chunks( 0 ) { }
+            long long refreshes;
+            long long incremental; // of refreshes, those based on an older manager
+            long long totalMillis;
+            int lastMillis;
+            size_t chunks;
+        };
+
+        SimpleMutex refreshStatsMutex( "chunkManagerRefreshStats" );
+        map<string,RefreshStats> refreshStats;
+
+        void noteChunkManagerRefresh( const string& ns, bool incremental, int millis,
+                                      size_t chunks ) {
+            SimpleMutex::scoped_lock lk( refreshStatsMutex );
+            RefreshStats& stats = refreshStats[ns];
+            stats.refreshes++;
+            if ( incremental )
+                stats.incremental++;
+            stats.totalMillis += millis;
+            stats.lastMillis = millis;
+            stats.chunks = chunks;
+        }
+
+        /** serverStatus( { chunkManagerRefreshes : 1 } ), one entry per collection */
+        class ChunkManagerRefreshSSS : public ServerStatusSection {
+        public:
+            ChunkManagerRefreshSSS() : ServerStatusSection( "chunkManagerRefreshes" ) { }
+            virtual bool includeByDefault() const { return false; }
+
+            BSONObj generateSection( const BSONElement& configElement ) const {
+                BSONObjBuilder b;
+                SimpleMutex::scoped_lock lk( refreshStatsMutex );
+                for ( map<string,RefreshStats>::const_iterator i = refreshStats.begin();
+                      i != refreshStats.end(); ++i ) {
+                    BSONObjBuilder bb( b.subobjStart( i->first ) );
+                    bb.appendNumber( "refreshes", i->second.refreshes );
+                    bb.appendNumber( "incremental", i->second.incremental );
+                    bb.appendNumber( "totalMillis", i->second.totalMillis );
+                    bb.append( "lastMillis", i->second.lastMillis );
+                    bb.appendNumber( "chunks", static_cast<long long>( i->second.chunks ) );
+                    bb.done();
+                }
+                return b.obj();
+            }
+        } chunkManagerRefreshSSS;
+    }
+
     ChunkManager::ChunkManager( const string& ns, const ShardKeyPattern& pattern , bool unique ) :
         _ns( ns ),
         _key( pattern ),
@@ -673,6 +726,7 @@ namespace mongo {
             if( success ){
                 {
                     int ms = t.millis();
+                    noteChunkManagerRefresh( _ns, _oldManager.get() != NULL, ms, chunkMap.size() );
                     log() << "ChunkManager: time to load chunks for " << _ns << ": " << ms << "ms"
                           << " sequenceNumber: " << _sequenceNumber
                           << " version: " << _version.toString()
@@ -690,6 +744,7 @@ namespace mongo {
                     const_cast<set<Shard>&>(_shards).swap(shards);
                     const_cast<ShardVersionMap&>(_shardVersions).swap(shardVersions);
                     const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(_chunkMap);
+                    const_cast<ChunkRoutingTable&>(_routingTable).reloadAll(_chunkMap);
 
                     // Once we load data, clear reference to old manager
                     _oldManager.reset();
@@ -771,8 +826,9 @@ namespace mongo {
             // Load a copy of the old versions
             shardVersions = oldManager->_shardVersions;
 
-            // Load a copy of the chunk map, replacing the chunk manager with our own
-            const ChunkMap& oldChunkMap = oldManager->getChunkMap();
+            // Load a copy of the chunk map, replacing the chunk manager with our own.  The old
+            // map is const and so safe to read in place, rather than through getChunkMap()'s copy
+            const ChunkMap& oldChunkMap = oldManager->_chunkMap;
 
             // Could be v.expensive
             // TODO: If chunks were immutable and didn't reference the manager, we could do more
@@ -787,7 +843,8 @@ namespace mongo {
 
                 c->setBytesWritten( oldC->getBytesWritten() );
 
-                chunkMap.insert( make_pair( oldC->getMax(), c ) );
+                // in order, so each goes at the end
+                chunkMap.insert( chunkMap.end(), make_pair( oldC->getMax(), c ) );
             }
 
             // Also get any minor versions stored for reload
@@ -950,6 +1007,10 @@ namespace mongo {
         return _key.hasShardKey( obj );
     }
 
+    bool ChunkManager::hasShardKey( const BSONFieldIndex& doc ) const {
+        return mongo::hasShardKey( _key.key(), doc );
+    }
+
     void ChunkManager::calcInitSplitsAndShards( const Shard& primary,
                                                 const vector<BSONObj>* initPoints,
                                                 const vector<Shard>* initShards,
@@ -1062,15 +1123,7 @@ namespace mongo {
 
     ChunkPtr ChunkManager::findIntersectingChunk( const BSONObj& point ) const {
         {
-            BSONObj foo;
-            ChunkPtr c;
-            {
-                ChunkMap::const_iterator it = _chunkMap.upper_bound( point );
-                if (it != _chunkMap.end()) {
-                    foo = it->first;
-                    c = it->second;
-                }
-            }
+            ChunkPtr c = _routingTable.upperBound( point );
 
             if ( c ) {
                 if ( c->containsPoint( point ) ){
@@ -1078,7 +1131,6 @@ namespace mongo {
                     return c;
                 }
 
-                PRINT(foo);
                 PRINT(*c);
                 PRINT( point );
 
@@ -1099,6 +1151,12 @@ namespace mongo {
         return findIntersectingChunk( key );
     }
 
+    ChunkPtr ChunkManager::findChunkForDoc( const BSONFieldIndex& doc ) const {
+        BSONObj key = extractShardKeyFromDoc( _key.key(), doc );
+        uassert( 13334, "Shard Key must be less than 512 bytes", key.objsize() < 512 );
+        return findIntersectingChunk( key );
+    }
+
     ChunkPtr ChunkManager::findChunkOnServer( const Shard& shard ) const {
         for ( ChunkMap::const_iterator i=_chunkMap.begin(); i!=_chunkMap.end(); ++i ) {
             ChunkPtr c = i->second;
@@ -1406,6 +1464,45 @@ namespace mongo {
         }
     }
 
+    void ChunkRoutingTable::reloadAll(const ChunkMap& chunks) {
+        _maxes.clear();
+        _chunks.clear();
+        _int64s.clear();
+        _maxes.reserve(chunks.size());
+        _chunks.reserve(chunks.size());
+
+        _int64Maxes = !chunks.empty() && chunks.rbegin()->first.nFields() == 1 &&
+                      chunks.rbegin()->first.firstElement().type() == MaxKey;
+        for (ChunkMap::const_iterator i = chunks.begin(); i != chunks.end(); ++i) {
+            _maxes.push_back(i->first);
+            _chunks.push_back(i->second);
+
+            if (_int64Maxes && boost::next(i) != chunks.end()) {
+                BSONElement max = i->first.firstElement();
+                if (max.type() == NumberLong)
+                    _int64s.push_back(max._numberLong());
+                else
+                    _int64Maxes = false;
+            }
+        }
+        if (!_int64Maxes)
+            _int64s.clear();
+    }
+
+    ChunkPtr ChunkRoutingTable::upperBound(const BSONObj& point) const {
+        size_t i;
+        if (_int64Maxes && point.firstElement().type() == NumberLong) {
+            // every chunk but the last ends at a NumberLong, the last at MaxKey above them all
+            i = std::upper_bound(_int64s.begin(), _int64s.end(),
+                                 point.firstElement()._numberLong()) - _int64s.begin();
+        }
+        else {
+            i = std::upper_bound(_maxes.begin(), _maxes.end(), point, BSONObjCmp()) -
+                _maxes.begin();
+        }
+        return i == _chunks.size() ? ChunkPtr() : _chunks[i];
+    }
+
     int ChunkManager::getCurrentDesiredChunkSize() const {
         // split faster in early chunks helps spread out an initial load better
         const int minChunkSize = 1 << 20;  // 1 MBytes
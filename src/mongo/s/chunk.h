@@ -40,6 +40,7 @@
 
 namespace mongo {
 
+    class BSONFieldIndex;
     class DBConfig;
     class Chunk;
     class ChunkRange;
@@ -338,6 +339,30 @@ namespace mongo {
         ChunkRangeMap _ranges;
     };
 
+    /**
+     * The maxes of a manager's chunks in sorted arrays, for findIntersectingChunk to binary
+     * search instead of walking ChunkMap's tree.  When every chunk but the last ends at a
+     * NumberLong, and the last at MaxKey, as with hashed shard keys, the maxes are also kept as
+     * int64s, so that routing a NumberLong compares no BSON at all.
+     */
+    class ChunkRoutingTable {
+    public:
+        ChunkRoutingTable() : _int64Maxes( false ) { }
+
+        void reloadAll(const ChunkMap& chunks);
+
+        /** @return the first chunk whose max is above point, if any */
+        ChunkPtr upperBound(const BSONObj& point) const;
+
+    private:
+        vector<BSONObj> _maxes;
+        vector<ChunkPtr> _chunks;
+
+        // the maxes of all the chunks but the last, when _int64Maxes
+        bool _int64Maxes;
+        vector<long long> _int64s;
+    };
+
     /* config.sharding
          { ns: 'alleyinsider.fs.chunks' ,
            key: { ts : 1 } ,
@@ -362,6 +387,7 @@ namespace mongo {
         const ShardKeyPattern& getShardKey() const {  return _key; }
 
         bool hasShardKey( const BSONObj& obj ) const;
+        bool hasShardKey( const BSONFieldIndex& doc ) const;
 
         bool isUnique() const { return _unique; }
 
@@ -406,6 +432,9 @@ namespace mongo {
          */
         ChunkPtr findChunkForDoc( const BSONObj& doc ) const;
 
+        /** Same as above, for a document whose fields are also looked up elsewhere. */
+        ChunkPtr findChunkForDoc( const BSONFieldIndex& doc ) const;
+
         /** Given a key that has been extracted from a document, returns the
          *  chunk that contains that key.
          *
@@ -475,6 +504,7 @@ namespace mongo {
 
         const ChunkMap _chunkMap;
         const ChunkRangeManager _chunkRanges;
+        const ChunkRoutingTable _routingTable;
 
         const set<Shard> _shards;
 
@@ -30,6 +30,7 @@
 
 #include "mongo/s/config.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -97,14 +98,16 @@ namespace mongo {
             // Inserts must contain the exact shard key.
             //
 
-            if ( !_manager->hasShardKey( doc ) ) {
+            // Both checking and extracting the shard key look up its fields
+            BSONFieldIndex fields( doc );
+            if ( !_manager->hasShardKey( fields ) ) {
                 return Status( ErrorCodes::ShardKeyNotFound,
                                stream() << "document " << doc
                                         << " does not contain shard key for pattern "
                                         << _manager->getShardKey().key() );
             }
 
-            ChunkPtr chunk = _manager->findChunkForDoc( doc );
+            ChunkPtr chunk = _manager->findChunkForDoc( fields );
             *endpoint = new ShardEndpoint( chunk->getShard().getName(),
                                            _manager->getVersion( chunk->getShard() ) );
 
@@ -116,6 +116,15 @@ namespace mongo {
         return info;
     }
 
+    ClientInfo* ClientInfo::detachFromThread() {
+        return _tlInfo.release();
+    }
+
+    void ClientInfo::attachToThread(ClientInfo* info) {
+        massert(17300, "A ClientInfo already exists for this thread", !_tlInfo.get());
+        _tlInfo.reset(info);
+    }
+
     bool ClientInfo::exists() {
         return _tlInfo.get();
     }
@@ -120,6 +120,10 @@ namespace mongo {
         static ClientInfo * get(AbstractMessagingPort* messagingPort = NULL);
         // Creates a ClientInfo and stores it in _tlInfo
         static ClientInfo* create(AbstractMessagingPort* messagingPort);
+        // Removes the ClientInfo from _tlInfo without deleting it, so that another thread can
+        // serve the client's next request after attachToThread.
+        static ClientInfo* detachFromThread();
+        static void attachToThread(ClientInfo* info);
 
     private:
         struct WBInfo {
@@ -28,6 +28,8 @@
 
 #include "mongo/s/collection_metadata.h"
 
+#include <algorithm>
+
 #include "mongo/bson/util/builder.h" // for StringBuilder
 #include "mongo/util/mongoutils/str.h"
 
@@ -196,6 +198,7 @@ namespace mongo {
         metadata->_pendingMap.erase( pending.getMin() );
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_rangesVector = this->_rangesVector;
         metadata->_shardVersion = _shardVersion;
         metadata->_collVersion = _collVersion;
 
@@ -231,6 +234,7 @@ namespace mongo {
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_rangesVector = this->_rangesVector;
         metadata->_shardVersion = _shardVersion;
         metadata->_collVersion = _collVersion;
 
@@ -420,6 +424,7 @@ namespace mongo {
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_rangesVector = this->_rangesVector;
         metadata->_shardVersion = newShardVersion;
         metadata->_collVersion =
                 newShardVersion > _collVersion ? newShardVersion : this->_collVersion;
@@ -434,21 +439,47 @@ namespace mongo {
         return metadata.release();
     }
 
+    namespace {
+        // Orders a key against the min of a range, for searching a sorted RangeVector.
+        struct KeyBeforeRangeMin {
+            bool operator()( const BSONObj& key, const pair<BSONObj, BSONObj>& range ) const {
+                return key.woCompare( range.first ) < 0;
+            }
+        };
+    }
+
     bool CollectionMetadata::keyBelongsToMe( const BSONObj& key ) const {
+        return keyBelongsToMe( key, NULL );
+    }
+
+    bool CollectionMetadata::keyBelongsToMe( const BSONObj& key, size_t* lastRange ) const {
         // For now, collections don't move. So if the collection is not sharded, assume
         // the document with the given key can be accessed.
         if ( _keyPattern.isEmpty() ) {
             return true;
         }
 
-        if ( _rangesMap.size() <= 0 ) {
+        if ( _rangesVector.empty() ) {
             return false;
         }
 
-        RangeMap::const_iterator it = _rangesMap.upper_bound( key );
-        if ( it != _rangesMap.begin() ) it--;
+        if ( lastRange && *lastRange < _rangesVector.size() ) {
+            const pair<BSONObj, BSONObj>& range = _rangesVector[*lastRange];
+            if ( rangeContains( range.first, range.second, key ) ) {
+                return true;
+            }
+        }
+
+        RangeVector::const_iterator it = std::upper_bound( _rangesVector.begin(),
+                                                           _rangesVector.end(),
+                                                           key,
+                                                           KeyBeforeRangeMin() );
+        if ( it != _rangesVector.begin() ) it--;
 
         bool good = rangeContains( it->first, it->second, key );
+        if ( good && lastRange ) {
+            *lastRange = it - _rangesVector.begin();
+        }
 
 #if 0
         // DISABLED because of SERVER-11175 - huge amount of logging
@@ -702,6 +733,7 @@ namespace mongo {
             }
 
             _rangesMap.insert(make_pair(min, max));
+            _rangesVector.push_back(make_pair(min, max));
 
             min = currMin;
             max = currMax;
@@ -709,6 +741,7 @@ namespace mongo {
         dassert(!min.isEmpty());
 
         _rangesMap.insert(make_pair(min, max));
+        _rangesVector.push_back(make_pair(min, max));
     }
 
     void CollectionMetadata::fillKeyPatternFields() {
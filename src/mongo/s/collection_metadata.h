@@ -144,6 +144,12 @@ namespace mongo {
          */
         bool keyBelongsToMe( const BSONObj& key ) const;
 
+        /**
+         * As above, but first tries the owned range at index '*lastRange', which is updated to
+         * the range 'key' fell in.  Callers checking keys in order keep one of these per scan.
+         */
+        bool keyBelongsToMe( const BSONObj& key, size_t* lastRange ) const;
+
         /**
          * Returns true if the document key 'key' is or has been migrated to this shard, and may
          * belong to us after a subsequent config reload.  Key must be the full shard key.
@@ -296,6 +302,9 @@ namespace mongo {
         // installations.
         RangeMap _rangesMap;
 
+        // The same ranges as _rangesMap in a sorted array, searched by keyBelongsToMe.
+        RangeVector _rangesVector;
+
         /**
          * Returns true if this metadata was loaded with all necessary information.
          */
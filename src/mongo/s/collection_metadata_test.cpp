@@ -1131,6 +1131,24 @@ namespace {
         ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << MAXKEY)) );
     }
 
+    TEST_F(ThreeChunkWithRangeGapFixture, ShardOwnsDocLastRange) {
+        // The owned ranges are [min->20) and [30->max)
+        size_t lastRange = 0;
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 5), &lastRange) );
+        ASSERT_EQUALS( 0U, lastRange );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 35), &lastRange) );
+        ASSERT_EQUALS( 1U, lastRange );
+        ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << 25), &lastRange) );
+        ASSERT_EQUALS( 1U, lastRange );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 15), &lastRange) );
+        ASSERT_EQUALS( 0U, lastRange );
+
+        // An out of date hint is ignored.
+        lastRange = 7;
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 40), &lastRange) );
+        ASSERT_EQUALS( 1U, lastRange );
+    }
+
     TEST_F(ThreeChunkWithRangeGapFixture, GetNextFromEmpty) {
         ChunkType nextChunk;
         ASSERT( getCollMetadata().getNextChunk( getCollMetadata().getMinKey(), &nextChunk ) );
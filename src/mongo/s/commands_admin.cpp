@@ -43,6 +43,7 @@
 #include "mongo/db/field_parser.h"
 #include "mongo/db/hasher.h"
 #include "mongo/db/index_names.h"
+#include "mongo/db/message_compression.h"
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/wire_version.h"
@@ -612,6 +613,18 @@ namespace mongo {
                             return false;
                         }
 
+                        // The shard key is hashed by mongos and on the shards with the
+                        // default (md5) hash, so the index must use the same one.
+                        if ( isHashedShardKey && idx["hashVersion"].numberInt() != 0 ) {
+                            errmsg = str::stream()
+                                    << "can't shard collection " << ns << " with hashed shard key "
+                                    << proposedKey
+                                    << " because the hashed index uses hashVersion "
+                                    << idx["hashVersion"].numberInt();
+                            conn.done();
+                            return false;
+                        }
+
                         hasUsefulIndexForKey = true;
                     }
                 }
@@ -1432,6 +1445,7 @@ namespace mongo {
                 // compiled for.
                 result.append("maxWireVersion", maxWireVersion);
                 result.append("minWireVersion", minWireVersion);
+                negotiateMessageCompression(cmdObj, &result);
 
                 return true;
             }
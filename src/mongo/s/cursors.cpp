@@ -45,12 +45,17 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/max_time.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/net/listen.h"
 
 namespace mongo {
     const int ShardedClientCursor::INIT_REPLY_BUFFER_SIZE = 32768;
 
+    // Whether a sharded cursor sends the shards its getMores as soon as it has replied to the
+    // client, rather than when the client asks for the next batch.
+    MONGO_EXPORT_SERVER_PARAMETER(shardedCursorPrefetch, bool, true);
+
     // --------  ShardedCursor -----------
 
     ShardedClientCursor::ShardedClientCursor( QueryMessage& q , ClusteredCursor * cursor ) {
@@ -161,6 +166,13 @@ namespace mongo {
         _totalSent += docCount;
         _done = ! hasMore;
 
+        if ( hasMore && shardedCursorPrefetch ) {
+            // have the shards work on their next batches while the client reads this one.  At
+            // most one batch per shard cursor is outstanding, and it waits in the socket until
+            // the next getMore from the client reads it.
+            _cursor->requestMoreLazy();
+        }
+
         return hasMore;
     }
 
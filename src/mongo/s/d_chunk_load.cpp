@@ -0,0 +1,207 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include <map>
+#include <string>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/keypattern.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/s/d_logic.h"
+#include "mongo/s/range_arithmetic.h"
+#include "mongo/s/type_chunk.h"
+
+namespace mongo {
+
+    // One in this many writes to a sharded collection is counted against its chunk, as that many
+    // writes.  0 turns the counting off.
+    MONGO_EXPORT_SERVER_PARAMETER(chunkLoadSampleRate, int, 16);
+
+    // The counts are halved this often, so that they follow recent load.
+    MONGO_EXPORT_SERVER_PARAMETER(chunkLoadHalfLifeSecs, int, 300);
+
+    namespace {
+
+        struct ChunkLoad {
+            ChunkLoad() : ops( 0 ), bytes( 0 ) { }
+            BSONObj max;
+            long long ops;
+            long long bytes;
+        };
+
+        struct CollectionLoad {
+            CollectionLoad() : lastDecay( time( 0 ) ) { }
+            map<BSONObj, ChunkLoad> chunks; // by chunk min
+            time_t lastDecay;
+        };
+
+        mongo::mutex loadMutex( "chunkLoad" );
+        map<string, CollectionLoad> loads;
+        AtomicUInt32 numWrites;
+
+        void decay( CollectionLoad* coll ) {
+            int halfLife = std::max( 1, static_cast<int>( chunkLoadHalfLifeSecs ) );
+            time_t now = time( 0 );
+            long long halvings = ( now - coll->lastDecay ) / halfLife;
+            if ( halvings <= 0 )
+                return;
+
+            coll->lastDecay += halvings * halfLife;
+            for ( map<BSONObj, ChunkLoad>::iterator it = coll->chunks.begin();
+                  it != coll->chunks.end(); ) {
+                if ( halvings >= 62 ) {
+                    it->second.ops = 0;
+                    it->second.bytes = 0;
+                }
+                else {
+                    it->second.ops >>= halvings;
+                    it->second.bytes >>= halvings;
+                }
+
+                if ( it->second.ops == 0 )
+                    coll->chunks.erase( it++ );
+                else
+                    ++it;
+            }
+        }
+    }
+
+    void noteWriteForChunkLoad( const StringData& ns, const BSONObj& doc ) {
+        int rate = chunkLoadSampleRate;
+        if ( rate <= 0 || numWrites.addAndFetch( 1 ) % rate != 0 )
+            return;
+
+        if ( ! shardingState.enabled() )
+            return;
+
+        CollectionMetadataPtr metadata = shardingState.getCollectionMetadata( ns.toString() );
+        if ( ! metadata || metadata->getKeyPattern().isEmpty() )
+            return;
+
+        BSONObj key = KeyPattern( metadata->getKeyPattern() ).extractSingleKey( doc );
+        if ( key.isEmpty() )
+            return;
+
+        ChunkType chunk;
+        if ( ! metadata->getNextChunk( key, &chunk ) ||
+             ! rangeContains( chunk.getMin(), chunk.getMax(), key ) )
+            return;
+
+        scoped_lock lk( loadMutex );
+        CollectionLoad& coll = loads[ns.toString()];
+        decay( &coll );
+
+        ChunkLoad& load = coll.chunks[chunk.getMin()];
+        if ( load.max.woCompare( chunk.getMax() ) != 0 ) {
+            // new, or the chunk was split since
+            load = ChunkLoad();
+            load.max = chunk.getMax().getOwned();
+        }
+        load.ops += rate;
+        load.bytes += static_cast<long long>( rate ) * doc.objsize();
+    }
+
+    /**
+     * Reports the estimated recent writes to each of the chunks of a collection this shard
+     * owns, for the balancer.
+     */
+    class GetChunkLoadCmd : public Command {
+    public:
+        GetChunkLoadCmd() : Command( "getChunkLoad" ) { }
+
+        virtual bool slaveOk() const { return false; }
+        virtual bool adminOnly() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+
+        virtual void help( stringstream& help ) const {
+            help << "internal, { getChunkLoad : <ns> }";
+        }
+
+        virtual void addRequiredPrivileges( const std::string& dbname,
+                                            const BSONObj& cmdObj,
+                                            std::vector<Privilege>* out ) {
+            ActionSet actions;
+            actions.addAction( ActionType::shardingState );
+            out->push_back( Privilege( ResourcePattern::forClusterResource(), actions ) );
+        }
+
+        bool run( const string& , BSONObj& cmdObj, int, string& errmsg,
+                  BSONObjBuilder& result, bool ) {
+            string ns = cmdObj.firstElement().str();
+            if ( ns.empty() ) {
+                errmsg = "need a collection";
+                return false;
+            }
+
+            CollectionMetadataPtr metadata;
+            if ( shardingState.enabled() )
+                metadata = shardingState.getCollectionMetadata( ns );
+
+            BSONArrayBuilder chunks( result.subarrayStart( "chunks" ) );
+            if ( metadata ) {
+                scoped_lock lk( loadMutex );
+                map<string, CollectionLoad>::iterator coll = loads.find( ns );
+                if ( coll != loads.end() ) {
+                    decay( &coll->second );
+
+                    for ( map<BSONObj, ChunkLoad>::iterator it = coll->second.chunks.begin();
+                          it != coll->second.chunks.end(); ) {
+
+                        // leave out the chunks we no longer own as they were counted
+                        ChunkType chunk;
+                        if ( ! metadata->getNextChunk( it->first, &chunk ) ||
+                             chunk.getMin().woCompare( it->first ) != 0 ||
+                             chunk.getMax().woCompare( it->second.max ) != 0 ) {
+                            coll->second.chunks.erase( it++ );
+                            continue;
+                        }
+
+                        chunks.append( BSON( "min" << it->first <<
+                                             "max" << it->second.max <<
+                                             "ops" << it->second.ops <<
+                                             "bytes" << it->second.bytes ) );
+                        ++it;
+                    }
+                }
+            }
+            chunks.done();
+
+            result.append( "sampleRate", static_cast<int>( chunkLoadSampleRate ) );
+            return true;
+        }
+
+    } getChunkLoadCmd;
+
+}
@@ -33,6 +33,7 @@
 #include "mongo/pch.h"
 
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/collection_metadata.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/util/concurrency/ticketholder.h"
@@ -74,6 +75,18 @@ namespace mongo {
         bool hasVersion( const string& ns , ChunkVersion& version );
         const ChunkVersion getVersion( const string& ns ) const;
 
+        /**
+         * Like getVersion, also filling in "generation" with the metadata generation the version
+         * was read at.
+         */
+        const ChunkVersion getVersion( const string& ns, unsigned long long* generation ) const;
+
+        /**
+         * Goes up every time the metadata of any collection changes, so a version read at the
+         * current generation is still current.  Read without taking the mutex.
+         */
+        unsigned long long getMetadataGeneration() const { return _metadataGeneration.load(); }
+
         /**
          * If the metadata for 'ns' at this shard is at or above the requested version,
          * 'reqShardVersion', returns OK and fills in 'latestShardVersion' with the latest shard
@@ -255,6 +268,9 @@ namespace mongo {
                                   bool useRequestedVersion,
                                   ChunkVersion* latestShardVersion );
 
+        /** Called with _mutex held, after any change to _collMetadata. */
+        void _metadataChanged() { _metadataGeneration.fetchAndAdd( 1 ); }
+
         bool _enabled;
 
         string _configServer;
@@ -270,6 +286,8 @@ namespace mongo {
         // Map from a namespace into the metadata we need for each collection on this shard
         typedef map<string,CollectionMetadataPtr> CollectionMetadataMap;
         CollectionMetadataMap _collMetadata;
+
+        AtomicUInt64 _metadataGeneration;
     };
 
     extern ShardingState shardingState;
@@ -289,10 +307,29 @@ namespace mongo {
         const ChunkVersion getVersion( const string& ns ) const;
         void setVersion( const string& ns , const ChunkVersion& version );
 
+        /**
+         * The shard's version of "ns", as last looked up by this connection, if it was looked up
+         * at metadata generation "generation".  Saves shardVersionOk taking the ShardingState
+         * mutex for a connection that keeps working on the same collection.
+         */
+        bool getCachedShardVersion( const string& ns,
+                                    unsigned long long generation,
+                                    ChunkVersion* version ) const;
+        void cacheShardVersion( const string& ns,
+                                unsigned long long generation,
+                                const ChunkVersion& version );
+
         static ShardedConnectionInfo* get( bool create );
         static void reset();
         static void addHook();
 
+        /**
+         * Removes this thread's info, if any, without deleting it, so that whichever thread
+         * serves the connection's next message can take it with attachToThread.
+         */
+        static ShardedConnectionInfo* detachFromThread();
+        static void attachToThread( ShardedConnectionInfo* info );
+
         bool inForceVersionOkMode() const {
             return _forceVersionOk;
         }
@@ -308,6 +345,11 @@ namespace mongo {
         typedef map<string,ChunkVersion> NSVersionMap;
         NSVersionMap _versions;
 
+        // The last shard version looked up by shardVersionOk.
+        string _cachedNS;
+        unsigned long long _cachedGeneration;
+        ChunkVersion _cachedShardVersion;
+
         static boost::thread_specific_ptr<ShardedConnectionInfo> _tl;
     };
 
@@ -372,6 +414,12 @@ namespace mongo {
                            const BSONObj* fullObj,
                            bool forMigrateCleanup );
 
+    /**
+     * Counts a sample of the writes to each chunk of the sharded collections, so that the
+     * balancer can spread load and not just chunks.  'doc' is the document as written.
+     */
+    void noteWriteForChunkLoad( const StringData& ns, const BSONObj& doc );
+
     void aboutToDeleteForSharding( const StringData& ns, const Database* db , const DiskLoc& dl );
 
 }
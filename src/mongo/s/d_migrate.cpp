@@ -76,6 +76,7 @@
 #include "mongo/s/type_chunk.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/elapsed_tracker.h"
+#include "mongo/util/flat_sorted_set.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/queue.h"
 #include "mongo/util/startup_test.h"
@@ -494,7 +495,7 @@ namespace mongo {
                 {
                     Client::ReadContext ctx( _ns );
                     scoped_spinlock lk( _trackerLocks );
-                    set<DiskLoc>::iterator i = _cloneLocs.begin();
+                    FlatSortedSet<DiskLoc>::const_iterator i = _cloneLocs.begin();
                     for ( ; i!=_cloneLocs.end(); ++i ) {
                         if (tracker.intervalHasElapsed()) // should I yield?
                             break;
@@ -618,7 +619,7 @@ namespace mongo {
         // no locking needed because built initially by 1 thread in a read lock
         // emptied by 1 thread in a read lock
         // updates applied by 1 thread in a write lock
-        set<DiskLoc> _cloneLocs;
+        FlatSortedSet<DiskLoc> _cloneLocs;
 
         list<BSONObj> _reload; // objects that were modified that must be recloned
         list<BSONObj> _deleted; // objects deleted during clone that should be deleted later
@@ -658,6 +659,13 @@ namespace mongo {
                           bool notInActiveChunk) {
         // TODO: include fullObj?
         migrateFromStatus.logOp(opstr, ns, obj, patt, notInActiveChunk);
+
+        if ( ! notInActiveChunk ) {
+            if ( opstr[0] == 'i' && opstr[1] == '\0' )
+                noteWriteForChunkLoad( ns, obj );
+            else if ( opstr[0] == 'u' && fullObj )
+                noteWriteForChunkLoad( ns, *fullObj );
+        }
     }
 
     void aboutToDeleteForSharding( const StringData& ns,
@@ -1508,6 +1516,26 @@ namespace mongo {
     MONGO_FP_DECLARE(migrateThreadHangAtStep4);
     MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+    /**
+     * Sends a _migrateClone to the donor without waiting for the reply, which
+     * receiveCloneBatch() reads.
+     */
+    static DBClientCursor* requestCloneBatch( DBClientBase* conn ) {
+        auto_ptr<DBClientCursor> cursor( new DBClientCursor( conn, "admin.$cmd",
+                                                             BSON( "_migrateClone" << 1 ),
+                                                             -1, 0, NULL, 0, 0 ) );
+        cursor->initLazy();
+        return cursor.release();
+    }
+
+    static bool receiveCloneBatch( DBClientCursor* cursor, BSONObj* res ) {
+        bool retry = false;
+        if ( ! cursor->initLazyFinish( retry ) || ! cursor->more() )
+            return false;
+        *res = cursor->nextSafe();
+        return res->getField( "ok" ).trueValue();
+    }
+
     class MigrateStatus {
     public:
         
@@ -1689,9 +1717,14 @@ namespace mongo {
                 // 3. initial bulk clone
                 state = CLONE;
 
+                // Ask for the next batch before inserting the current one, so the donor reads
+                // its documents while we write ours
+                auto_ptr<DBClientCursor> nextBatch( requestCloneBatch( conn.get() ) );
+
                 while ( true ) {
+                    auto_ptr<DBClientCursor> thisBatch( nextBatch );
                     BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    if ( ! receiveCloneBatch( thisBatch.get(), &res ) ) {  // gets array of objects to copy, in disk order
                         state = FAIL;
                         errmsg = "_migrateClone failed: ";
                         errmsg += res.toString();
@@ -1701,16 +1734,29 @@ namespace mongo {
                     }
 
                     BSONObj arr = res["objects"].Obj();
-                    int thisTime = 0;
+                    if ( arr.isEmpty() )
+                        break;
 
+                    nextBatch.reset( requestCloneBatch( conn.get() ) );
+
+                    vector<BSONObj> docs;
                     BSONObjIterator i( arr );
                     while( i.more() ) {
-                        BSONObj o = i.next().Obj();
-                        {
-                            PageFaultRetryableSection pgrs;
-                            while ( 1 ) {
-                                try {
-                                    Client::WriteContext cx( ns );
+                        docs.push_back( i.next().Obj() );
+                    }
+
+                    // insert as many documents as we can under one lock, letting others in
+                    // every so often
+                    size_t pos = 0;
+                    while ( pos < docs.size() ) {
+                        PageFaultRetryableSection pgrs;
+                        ElapsedTracker tracker( 128, 10 );
+                        while ( 1 ) {
+                            try {
+                                Client::WriteContext cx( ns );
+
+                                for ( ; pos < docs.size(); pos++ ) {
+                                    const BSONObj& o = docs[pos];
 
                                     BSONObj localDoc;
                                     if ( willOverrideLocalId( o, &localDoc ) ) {
@@ -1727,26 +1773,28 @@ namespace mongo {
                                     }
 
                                     Helpers::upsert( ns, o, true );
-                                    break;
-                                }
-                                catch ( PageFaultException& e ) {
-                                    e.touch();
+                                    numCloned++;
+                                    clonedBytes += o.objsize();
+
+                                    if ( tracker.intervalHasElapsed() ) {
+                                        pos++;
+                                        break;
+                                    }
                                 }
+                                break;
+                            }
+                            catch ( PageFaultException& e ) {
+                                // the documents before pos are in, retry from the one that faulted
+                                e.touch();
                             }
                         }
-                        thisTime++;
-                        numCloned++;
-                        clonedBytes += o.objsize();
 
-                        if ( secondaryThrottle && thisTime > 0 ) {
+                        if ( secondaryThrottle ) {
                             if ( ! waitForReplication( cc().getLastOp(), 2, 60 /* seconds to wait */ ) ) {
                                 warning() << "secondaryThrottle on, but doc insert timed out after 60 seconds, continuing" << endl;
                             }
                         }
                     }
-
-                    if ( thisTime == 0 )
-                        break;
                 }
 
                 timing.done(3);
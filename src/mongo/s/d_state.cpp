@@ -122,6 +122,7 @@ namespace mongo {
         _configServer.clear();
         _shardName.clear();
         _collMetadata.clear();
+        _metadataChanged();
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
@@ -157,6 +158,20 @@ namespace mongo {
         }
     }
 
+    const ChunkVersion ShardingState::getVersion( const string& ns,
+                                                  unsigned long long* generation ) const {
+        scoped_lock lk(_mutex);
+
+        *generation = _metadataGeneration.load();
+        CollectionMetadataMap::const_iterator it = _collMetadata.find( ns );
+        if ( it != _collMetadata.end() ) {
+            return it->second->getShardVersion();
+        }
+        else {
+            return ChunkVersion( 0, OID() );
+        }
+    }
+
     void ShardingState::donateChunk( const string& ns , const BSONObj& min , const BSONObj& max , ChunkVersion version ) {
         scoped_lock lk( _mutex );
 
@@ -181,6 +196,7 @@ namespace mongo {
         // TODO: a bit dangerous to have two different zero-version states - no-metadata and
         // no-version
         _collMetadata[ns] = cloned;
+        _metadataChanged();
     }
 
     void ShardingState::undoDonateChunk( const string& ns, CollectionMetadataPtr prevMetadata ) {
@@ -190,6 +206,7 @@ namespace mongo {
         CollectionMetadataMap::iterator it = _collMetadata.find( ns );
         verify( it != _collMetadata.end() );
         it->second = prevMetadata;
+        _metadataChanged();
     }
 
     bool ShardingState::notePending( const string& ns,
@@ -231,6 +248,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _metadataChanged();
         return true;
     }
 
@@ -273,6 +291,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _metadataChanged();
         return true;
     }
 
@@ -297,6 +316,7 @@ namespace mongo {
         uassert( 16857, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _metadataChanged();
     }
 
     void ShardingState::mergeChunks( const string& ns,
@@ -319,6 +339,7 @@ namespace mongo {
         uassert( 17004, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _metadataChanged();
     }
 
     void ShardingState::resetMetadata( const string& ns ) {
@@ -328,6 +349,7 @@ namespace mongo {
                   << endl;
 
         _collMetadata.erase( ns );
+        _metadataChanged();
     }
 
     Status ShardingState::refreshMetadataIfNeeded( const string& ns,
@@ -571,6 +593,7 @@ namespace mongo {
                     installType = InstallType_New;
                     dassert( it == _collMetadata.end() );
                     _collMetadata.insert( make_pair( ns, remoteMetadata ) );
+                    _metadataChanged();
                 }
                 else if ( remoteCollVersion.epoch().isSet() &&
                           remoteCollVersion.epoch() == afterCollVersion.epoch() ) {
@@ -581,6 +604,7 @@ namespace mongo {
                     // Invariant: If CollMetadata was not found, version should be have been 0.
                     dassert( it != _collMetadata.end() );
                     it->second = remoteMetadata;
+                    _metadataChanged();
                 }
                 else if ( remoteCollVersion.epoch().isSet() ) {
 
@@ -590,6 +614,7 @@ namespace mongo {
                     // Invariant: If CollMetadata was not found, version should be have been 0.
                     dassert( it != _collMetadata.end() );
                     it->second = remoteMetadata;
+                    _metadataChanged();
                 }
                 else {
                     dassert( !remoteCollVersion.epoch().isSet() );
@@ -597,6 +622,7 @@ namespace mongo {
                     // Drop detected
                     installType = InstallType_Drop;
                     _collMetadata.erase( it );
+                    _metadataChanged();
                 }
 
                 *latestShardVersion = remoteShardVersion;
@@ -712,6 +738,7 @@ namespace mongo {
     ShardedConnectionInfo::ShardedConnectionInfo() {
         _forceVersionOk = false;
         _id.clear();
+        _cachedGeneration = 0;
     }
 
     ShardedConnectionInfo* ShardedConnectionInfo::get( bool create ) {
@@ -728,6 +755,15 @@ namespace mongo {
         _tl.reset();
     }
 
+    ShardedConnectionInfo* ShardedConnectionInfo::detachFromThread() {
+        return _tl.release();
+    }
+
+    void ShardedConnectionInfo::attachToThread( ShardedConnectionInfo* info ) {
+        verify( ! _tl.get() );
+        _tl.reset( info );
+    }
+
     const ChunkVersion ShardedConnectionInfo::getVersion( const string& ns ) const {
         NSVersionMap::const_iterator it = _versions.find( ns );
         if ( it != _versions.end() ) {
@@ -742,6 +778,23 @@ namespace mongo {
         _versions[ns] = version;
     }
 
+    bool ShardedConnectionInfo::getCachedShardVersion( const string& ns,
+                                                       unsigned long long generation,
+                                                       ChunkVersion* version ) const {
+        if ( generation != _cachedGeneration || ns != _cachedNS )
+            return false;
+        *version = _cachedShardVersion;
+        return true;
+    }
+
+    void ShardedConnectionInfo::cacheShardVersion( const string& ns,
+                                                   unsigned long long generation,
+                                                   const ChunkVersion& version ) {
+        _cachedNS = ns;
+        _cachedGeneration = generation;
+        _cachedShardVersion = version;
+    }
+
     void ShardedConnectionInfo::addHook() {
         static mongo::mutex lock("ShardedConnectionInfo::addHook mutex");
         static bool done = false;
@@ -1228,7 +1281,14 @@ namespace mongo {
         // TODO : all collections at some point, be sharded or not, will have a version
         //  (and a CollectionMetadata)
         received = info->getVersion( ns );
-        wanted = shardingState.getVersion( ns );
+
+        // Only take the ShardingState mutex if some metadata changed since this connection last
+        // looked the version up.
+        unsigned long long generation = shardingState.getMetadataGeneration();
+        if ( ! info->getCachedShardVersion( ns, generation, &wanted ) ) {
+            wanted = shardingState.getVersion( ns, &generation );
+            info->cacheShardVersion( ns, generation, wanted );
+        }
 
         if( received.isWriteCompatibleWith( wanted ) ) return true;
 
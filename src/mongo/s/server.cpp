@@ -49,6 +49,8 @@
 #include "mongo/db/instance.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/log_process_details.h"
+#include "mongo/db/message_compression.h"
+#include "mongo/logger/async_log_writer.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/balance.h"
 #include "mongo/s/chunk.h"
@@ -60,6 +62,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/mongos_options.h"
 #include "mongo/s/request.h"
+#include "mongo/s/shard.h"
 #include "mongo/s/version_mongos.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/admin_access.h"
@@ -171,6 +174,43 @@ namespace mongo {
         virtual void disconnected( AbstractMessagingPort* p ) {
             // all things are thread local
         }
+
+        virtual bool canDetach() const { return true; }
+
+        virtual DetachedConnectionState* detach( AbstractMessagingPort* p ) {
+            return new ConnectionState();
+        }
+
+        virtual void attach( AbstractMessagingPort* p, DetachedConnectionState* state ) {
+            scoped_ptr<ConnectionState> s( static_cast<ConnectionState*>( state ) );
+            s->attachToThread();
+        }
+
+    private:
+        /** The thread locals of a client connection between its requests. */
+        class ConnectionState : public DetachedConnectionState {
+        public:
+            ConnectionState() :
+                _info( ClientInfo::detachFromThread() ),
+                _conns( ShardConnection::detachThreadConnections() ) {
+            }
+
+            virtual ~ConnectionState() {
+                ShardConnection::destroyThreadConnections( _conns );
+                delete _info;
+            }
+
+            void attachToThread() {
+                ClientInfo::attachToThread( _info );
+                _info = NULL;
+                ShardConnection::attachThreadConnections( _conns );
+                _conns = NULL;
+            }
+
+        private:
+            ClientInfo* _info;
+            ClientConnections* _conns;
+        };
     };
 
     void sighandler(int sig) {
@@ -246,6 +286,25 @@ namespace mongo {
         serverID.init();
     }
 
+    /**
+     * Opens the connections to every shard that connPoolMinIdleShardedConnsPerHost asks for,
+     * rather than leaving the first requests after startup to pay for them.
+     */
+    static void warmUpShardConnections() {
+        setThreadName( "shardConnectionWarmUp" );
+        try {
+            Shard::reloadShardInfo();
+            vector<Shard> shards;
+            Shard::getAllShards( shards );
+            for ( size_t i = 0; i < shards.size(); i++ ) {
+                shardConnectionPool.warmUp( shards[i].getConnString() );
+            }
+        }
+        catch ( const DBException& e ) {
+            warning() << "failed to warm up shard connections" << causedBy( e ) << endl;
+        }
+    }
+
     void start( const MessageServer::Options& opts ) {
         balancer.go();
         cursorCache.startTimeoutThread();
@@ -254,6 +313,9 @@ namespace mongo {
 
         PeriodicTask::startRunningPeriodicTasks();
 
+        if ( shardConnectionPool.getMinIdlePerHost() > 0 )
+            boost::thread warmUp( warmUpShardConnections );
+
         ShardedMessageHandler handler;
         MessageServer * server = createServer( opts , &handler );
         server->setAsTimeTracker();
@@ -285,6 +347,7 @@ static bool runMongosServer( bool doUpgrade ) {
 
     // Mongos shouldn't lazily kill cursors, otherwise we can end up with extras from migration
     DBClientConnection::setLazyKillCursor( false );
+    DBClientConnection::setMessageCompression( messageCompressionEnabled() );
 
     ReplicaSetMonitor::setConfigChangeHook( boost::bind( &ConfigServer::replicaSetChange , &configServer , _1 ) );
 
@@ -509,6 +572,7 @@ void mongo::dbexit( ExitCode rc, const char *why ) {
           << " rc:" << rc
           << " " << ( why ? why : "" )
           << endl;
+    logger::AsyncLogWriter::flushAll();
     flushForGcov();
     ::_exit(rc);
 }
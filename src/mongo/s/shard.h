@@ -36,6 +36,7 @@
 
 namespace mongo {
 
+    class ClientConnections;
     class ShardConnection;
     class ShardStatus;
 
@@ -321,6 +322,15 @@ namespace mongo {
          */
         static void clearPool();
 
+        /**
+         * Removes the current thread's cached connections from it, for a client whose next
+         * request another thread may serve.  The result goes back to a thread with
+         * attachThreadConnections, or is freed with destroyThreadConnections.
+         */
+        static ClientConnections* detachThreadConnections();
+        static void attachThreadConnections( ClientConnections* conns );
+        static void destroyThreadConnections( ClientConnections* conns );
+
         /**
          * Forgets a namespace to prevent future versioning.
          */
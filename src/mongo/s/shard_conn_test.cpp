@@ -299,4 +299,27 @@ namespace mongo_test {
         checkNewConns(assertNotEqual, conn2CreationTime, 10);
         conn1Again.done();
     }
+
+    TEST_F(ShardConnFixture, WarmUpOpensMinIdleConnections) {
+        const uint64_t beforeWarmUp = mongo::curTimeMicros64();
+        mongo::shardConnectionPool.setMinIdlePerHost(3);
+        mongo::shardConnectionPool.warmUp(TARGET_HOST);
+        mongo::shardConnectionPool.setMinIdlePerHost(0);
+        const uint64_t afterWarmUp = mongo::curTimeMicros64();
+
+        ShardConnection conn1(TARGET_HOST, "test.user");
+        ShardConnection conn2(TARGET_HOST, "test.user");
+        ShardConnection conn3(TARGET_HOST, "test.user");
+
+        ASSERT_GREATER_THAN_OR_EQUALS(conn1.get()->getSockCreationMicroSec(), beforeWarmUp);
+        ASSERT_LESS_THAN_OR_EQUALS(conn1.get()->getSockCreationMicroSec(), afterWarmUp);
+        ASSERT_GREATER_THAN_OR_EQUALS(conn2.get()->getSockCreationMicroSec(), beforeWarmUp);
+        ASSERT_LESS_THAN_OR_EQUALS(conn2.get()->getSockCreationMicroSec(), afterWarmUp);
+        ASSERT_GREATER_THAN_OR_EQUALS(conn3.get()->getSockCreationMicroSec(), beforeWarmUp);
+        ASSERT_LESS_THAN_OR_EQUALS(conn3.get()->getSockCreationMicroSec(), afterWarmUp);
+
+        conn1.done();
+        conn2.done();
+        conn3.done();
+    }
 }
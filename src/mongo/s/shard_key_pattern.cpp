@@ -28,6 +28,9 @@
 
 #include "mongo/s/shard_key_pattern.h"
 
+#include "mongo/db/hasher.h"
+#include "mongo/util/mongoutils/str.h"
+
 namespace mongo {
 
     bool isUniqueIndexCompatible( const BSONObj shardKeyPattern,
@@ -40,4 +43,37 @@ namespace mongo {
 
         return shardKeyPattern.isFieldNamePrefixOf( uIndexKeyPattern );
     }
+
+    bool hasShardKey( const BSONObj& shardKeyPattern, const BSONFieldIndex& doc ) {
+        BSONForEach( patternElt, shardKeyPattern ) {
+            BSONElement e = doc.getFieldDotted( patternElt.fieldNameStringData() );
+            if ( e.eoo() ||
+                 e.type() == Array ||
+                 ( e.type() == Object && !e.embeddedObject().okForStorage() ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    BSONObj extractShardKeyFromDoc( const BSONObj& shardKeyPattern, const BSONFieldIndex& doc ) {
+        if ( shardKeyPattern.isEmpty() )
+            return BSONObj();
+
+        BSONElement first = shardKeyPattern.firstElement();
+        if ( mongoutils::str::equals( first.valuestrsafe(), "hashed" ) ) {
+            BSONElement fieldVal = doc.getFieldDotted( first.fieldNameStringData() );
+            return BSON( first.fieldName() <<
+                         BSONElementHasher::hash64( fieldVal,
+                                                    BSONElementHasher::DEFAULT_HASH_SEED ) );
+        }
+
+        BSONObjBuilder b( 32 );
+        BSONForEach( patternElt, shardKeyPattern ) {
+            BSONElement e = doc.getFieldDotted( patternElt.fieldNameStringData() );
+            if ( !e.eoo() )
+                b.appendAs( e, patternElt.fieldName() );
+        }
+        return b.obj();
+    }
 }
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include "mongo/bson/bson_field_index.h"
 #include "mongo/db/jsobj.h"
 
 namespace mongo {
@@ -40,4 +41,17 @@ namespace mongo {
      */
 
     bool isUniqueIndexCompatible( const BSONObj shardKeyPattern, const BSONObj uIndexKeyPattern );
+
+    /**
+     * Returns true if 'doc' has a value for every field in 'shardKeyPattern', each one a value a
+     * shard key can hold (not an array, nor an object with $-prefixed fields).  Same as
+     * ShardKeyPattern::hasShardKey, sharing lookups into 'doc' with the other users of its index.
+     */
+    bool hasShardKey( const BSONObj& shardKeyPattern, const BSONFieldIndex& doc );
+
+    /**
+     * Returns the shard key of 'doc', hashing the field of a hashed pattern, as
+     * ShardKeyPattern::extractKey does.
+     */
+    BSONObj extractShardKeyFromDoc( const BSONObj& shardKeyPattern, const BSONFieldIndex& doc );
 }
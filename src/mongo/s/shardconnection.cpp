@@ -49,6 +49,67 @@ namespace mongo {
 
     DBConnectionPool shardConnectionPool;
 
+    namespace {
+
+        /**
+         * Sizes a connection pool: the most idle connections it keeps per host, or the fewest
+         * it keeps open ahead of requests.
+         */
+        class PoolSizeParameter : public ExportedServerParameter<int> {
+        public:
+            enum Limit { MAX_IDLE, MIN_IDLE };
+
+            PoolSizeParameter( const std::string& name, int* value,
+                               DBConnectionPool* pool, Limit limit ) :
+                ExportedServerParameter<int>( ServerParameterSet::getGlobal(), name, value,
+                                              true, true ),
+                _pool( pool ),
+                _limit( limit ) {}
+
+            virtual Status validate( const int& potentialNewValue ) {
+                if ( _limit == MAX_IDLE && potentialNewValue < 1 )
+                    return Status( ErrorCodes::BadValue, name() + " must be at least 1" );
+                if ( potentialNewValue < 0 )
+                    return Status( ErrorCodes::BadValue, name() + " must be at least 0" );
+                return Status::OK();
+            }
+
+            virtual Status set( const int& newValue ) {
+                Status status = ExportedServerParameter<int>::set( newValue );
+                if ( !status.isOK() )
+                    return status;
+                if ( _limit == MAX_IDLE )
+                    _pool->setMaxPoolSize( newValue );
+                else
+                    _pool->setMinIdlePerHost( newValue );
+                return status;
+            }
+
+        private:
+            DBConnectionPool* _pool;
+            Limit _limit;
+        };
+
+        int connPoolMaxConnsPerHost = PoolForHost::getMaxPerHost();
+        int connPoolMaxShardedConnsPerHost = PoolForHost::getMaxPerHost();
+        int connPoolMinIdleConnsPerHost = 0;
+        int connPoolMinIdleShardedConnsPerHost = 0;
+
+        PoolSizeParameter connPoolMaxConnsPerHostParam(
+            "connPoolMaxConnsPerHost", &connPoolMaxConnsPerHost,
+            &pool, PoolSizeParameter::MAX_IDLE );
+        PoolSizeParameter connPoolMaxShardedConnsPerHostParam(
+            "connPoolMaxShardedConnsPerHost", &connPoolMaxShardedConnsPerHost,
+            &shardConnectionPool, PoolSizeParameter::MAX_IDLE );
+        PoolSizeParameter connPoolMinIdleConnsPerHostParam(
+            "connPoolMinIdleConnsPerHost", &connPoolMinIdleConnsPerHost,
+            &pool, PoolSizeParameter::MIN_IDLE );
+        PoolSizeParameter connPoolMinIdleShardedConnsPerHostParam(
+            "connPoolMinIdleShardedConnsPerHost", &connPoolMinIdleShardedConnsPerHost,
+            &shardConnectionPool, PoolSizeParameter::MIN_IDLE );
+
+    } // namespace
+
     class ClientConnections;
 
     /**
@@ -507,6 +568,19 @@ namespace mongo {
         ClientConnections::threadInstance()->clearPool();
     }
 
+    ClientConnections* ShardConnection::detachThreadConnections() {
+        return ClientConnections::_perThread.release();
+    }
+
+    void ShardConnection::attachThreadConnections( ClientConnections* conns ) {
+        verify( ! ClientConnections::_perThread.get() );
+        ClientConnections::_perThread.reset( conns );
+    }
+
+    void ShardConnection::destroyThreadConnections( ClientConnections* conns ) {
+        delete conns;
+    }
+
     void ShardConnection::forgetNS( const string& ns ) {
         ClientConnections::threadInstance()->forgetNS( ns );
     }
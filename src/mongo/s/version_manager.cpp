@@ -48,30 +48,45 @@ namespace mongo {
 
         typedef unsigned long long S;
 
-        ConnectionShardStatus()
-            : _mutex( "ConnectionShardStatus" ) {
-        }
-
         S getSequence( DBClientBase * conn , const string& ns ) {
-            scoped_lock lk( _mutex );
-            return _map[conn->getConnectionId()][ns];
+            Stripe& stripe = stripeFor( conn );
+            scoped_lock lk( stripe.sequencesMutex );
+            return stripe.sequences[conn->getConnectionId()][ns];
         }
 
         void setSequence( DBClientBase * conn , const string& ns , const S& s ) {
-            scoped_lock lk( _mutex );
-            _map[conn->getConnectionId()][ns] = s;
+            Stripe& stripe = stripeFor( conn );
+            scoped_lock lk( stripe.sequencesMutex );
+            stripe.sequences[conn->getConnectionId()][ns] = s;
         }
 
         void reset( DBClientBase * conn ) {
-            scoped_lock lk( _mutex );
-            _map.erase( conn->getConnectionId() );
+            Stripe& stripe = stripeFor( conn );
+            scoped_lock lk( stripe.sequencesMutex );
+            stripe.sequences.erase( conn->getConnectionId() );
         }
 
-        // protects _map
-        mongo::mutex _mutex;
+    private:
+        // Every request through a versioned connection looks up its sequence number, so the
+        // connections are spread over several maps, each with its own mutex, rather than all
+        // contending for one.
+        struct Stripe {
+            Stripe() : sequencesMutex( "ConnectionShardStatus" ) {}
+
+            // protects sequences
+            mongo::mutex sequencesMutex;
+
+            // a map from a connection into ChunkManager's sequence number for each namespace
+            map<unsigned long long, map<string,unsigned long long> > sequences;
+        };
+
+        static const int numStripes = 16;
+
+        Stripe& stripeFor( DBClientBase* conn ) {
+            return _stripes[conn->getConnectionId() % numStripes];
+        }
 
-        // a map from a connection into ChunkManager's sequence number for each namespace
-        map<unsigned long long, map<string,unsigned long long> > _map;
+        Stripe _stripes[numStripes];
 
     } connectionShardStatus;
 
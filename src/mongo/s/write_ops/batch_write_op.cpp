@@ -130,11 +130,12 @@ namespace mongo {
 
         TargetedBatchMap batchMap;
 
+        bool ordered = _clientRequest->getOrdered();
         size_t numWriteOps = _clientRequest->sizeWriteOps();
         for ( size_t i = 0; i < numWriteOps; ++i ) {
 
-            // Only do one-at-a-time ops if COE is false
-            if ( _clientRequest->getOrdered() && !batchMap.empty() ) break;
+            // Ordered ops that go to more than one shard are sent on their own
+            if ( ordered && batchMap.size() > 1u ) break;
 
             WriteOp& writeOp = _writeOps[i];
 
@@ -163,6 +164,8 @@ namespace mongo {
 
                 if ( recordTargetErrors ) {
                     writeOp.setOpError( targetError );
+                    // Ordered ops stop at the first error
+                    if ( ordered ) break;
                     continue;
                 }
                 else {
@@ -173,6 +176,18 @@ namespace mongo {
                 }
             }
 
+            //
+            // If COE is false, a run of ops going to the same single shard goes out as one
+            // ordered child batch, and the first op going anywhere else waits for the next round
+            //
+
+            if ( ordered && !batchMap.empty()
+                 && ( writes.size() != 1u
+                      || batchMap.find( &writes.front()->endpoint ) == batchMap.end() ) ) {
+                writeOp.cancelWrites( NULL );
+                break;
+            }
+
             //
             // Targeting went ok, add to appropriate TargetedBatch
             //
@@ -400,6 +415,8 @@ namespace mongo {
         //
 
         vector<BatchedErrorDetail*>::iterator itemErrorIt = itemErrors.begin();
+        bool ordered = _clientRequest->getOrdered();
+        bool stopped = false;
         int index = 0;
         for ( vector<TargetedWrite*>::const_iterator it = targetedBatch.getWrites().begin();
             it != targetedBatch.getWrites().end(); ++it, ++index ) {
@@ -409,6 +426,13 @@ namespace mongo {
 
             dassert( writeOp.getWriteState() == WriteOpState_Pending );
 
+            if ( stopped ) {
+                // An ordered child batch stops at its first error, so the writes after it never
+                // ran and are targeted again (or not at all, if that error ends the batch)
+                writeOp.cancelWrites( NULL );
+                continue;
+            }
+
             // See if we have an error for the write
             BatchedErrorDetail* writeError = NULL;
 
@@ -428,6 +452,7 @@ namespace mongo {
             }
             else {
                 writeOp.noteWriteError( *write, *writeError );
+                if ( ordered && !batchError ) stopped = true;
             }
         }
 
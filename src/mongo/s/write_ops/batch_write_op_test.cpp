@@ -589,4 +589,132 @@ namespace {
         ASSERT( batchOp.isFinished() );
     }
 
+    TEST(WriteOpTests, OrderedRunsSameShard) {
+
+        //
+        // Ordered ops going to the same shard are batched, up to the first op going elsewhere
+        //
+
+        NamespaceString nss( "foo.bar" );
+
+        ShardEndpoint endpointA( "shardA", ChunkVersion::IGNORED() );
+        ShardEndpoint endpointB( "shardB", ChunkVersion::IGNORED() );
+
+        vector<MockRange*> mockRanges;
+        mockRanges.push_back( new MockRange( endpointA,
+                                             nss,
+                                             BSON( "x" << MINKEY ),
+                                             BSON( "x" << 0 ) ) );
+        mockRanges.push_back( new MockRange( endpointB,
+                                             nss,
+                                             BSON( "x" << 0 ),
+                                             BSON( "x" << MAXKEY ) ) );
+
+        BatchedCommandRequest request( BatchedCommandRequest::BatchType_Insert );
+        request.setNS( nss.ns() );
+        request.setOrdered( true );
+        request.setWriteConcern( BSONObj() );
+
+        request.getInsertRequest()->addToDocuments( BSON( "x" << -1 ) );
+        request.getInsertRequest()->addToDocuments( BSON( "x" << -2 ) );
+        request.getInsertRequest()->addToDocuments( BSON( "x" << 1 ) );
+        request.getInsertRequest()->addToDocuments( BSON( "x" << 2 ) );
+        request.getInsertRequest()->addToDocuments( BSON( "x" << -3 ) );
+
+        BatchWriteOp batchOp;
+        batchOp.initClientRequest( &request );
+
+        MockNSTargeter targeter;
+        targeter.init( mockRanges );
+
+        BatchedCommandResponse response;
+        response.setOk( true );
+        response.setN( 0 );
+        ASSERT( response.isValid( NULL ) );
+
+        const char* shards[] = { "shardA", "shardB", "shardA" };
+        size_t sizes[] = { 2u, 2u, 1u };
+
+        for ( int round = 0; round < 3; round++ ) {
+
+            ASSERT( !batchOp.isFinished() );
+
+            OwnedPointerVector<TargetedWriteBatch> targetedOwned;
+            vector<TargetedWriteBatch*>& targeted = targetedOwned.mutableVector();
+
+            ASSERT( batchOp.targetBatch( targeter, false, &targeted ).isOK() );
+            ASSERT_EQUALS( targeted.size(), 1u );
+            ASSERT_EQUALS( targeted.front()->getEndpoint().shardName, shards[round] );
+            ASSERT_EQUALS( targeted.front()->getWrites().size(), sizes[round] );
+
+            batchOp.noteBatchResponse( *targeted.front(), response, NULL );
+        }
+
+        ASSERT( batchOp.isFinished() );
+
+        BatchedCommandResponse clientResponse;
+        batchOp.buildClientResponse( &clientResponse );
+        ASSERT( clientResponse.getOk() );
+    }
+
+    TEST(WriteOpTests, OrderedItemErrorStops) {
+
+        //
+        // An item error in an ordered child batch ends the batch, and the writes after it are
+        // not reported complete
+        //
+
+        NamespaceString nss( "foo.bar" );
+
+        ShardEndpoint endpoint( "shard", ChunkVersion::IGNORED() );
+
+        vector<MockRange*> mockRanges;
+        mockRanges.push_back( new MockRange( endpoint,
+                                             nss,
+                                             BSON( "x" << MINKEY ),
+                                             BSON( "x" << MAXKEY ) ) );
+
+        BatchedCommandRequest request( BatchedCommandRequest::BatchType_Insert );
+        request.setNS( nss.ns() );
+        request.setOrdered( true );
+        request.setWriteConcern( BSONObj() );
+
+        request.getInsertRequest()->addToDocuments( BSON( "x" << 1 ) );
+        request.getInsertRequest()->addToDocuments( BSON( "x" << 2 ) );
+        request.getInsertRequest()->addToDocuments( BSON( "x" << 3 ) );
+
+        BatchWriteOp batchOp;
+        batchOp.initClientRequest( &request );
+
+        MockNSTargeter targeter;
+        targeter.init( mockRanges );
+
+        OwnedPointerVector<TargetedWriteBatch> targetedOwned;
+        vector<TargetedWriteBatch*>& targeted = targetedOwned.mutableVector();
+
+        ASSERT( batchOp.targetBatch( targeter, false, &targeted ).isOK() );
+        ASSERT_EQUALS( targeted.size(), 1u );
+        ASSERT_EQUALS( targeted.front()->getWrites().size(), 3u );
+
+        BatchedCommandResponse response;
+        response.setOk( false );
+        response.setN( 1 );
+        response.setErrCode( ErrorCodes::UnknownError );
+        response.setErrMessage( "mock error" );
+        BatchedErrorDetail* error = buildError( ErrorCodes::UnknownError,
+                                                BSONObj(),
+                                                "mock error" );
+        error->setIndex( 1 );
+        response.addToErrDetails( error );
+        ASSERT( response.isValid( NULL ) );
+
+        batchOp.noteBatchResponse( *targeted.front(), response, NULL );
+        ASSERT( batchOp.isFinished() );
+
+        BatchedCommandResponse clientResponse;
+        batchOp.buildClientResponse( &clientResponse );
+        ASSERT( !clientResponse.getOk() );
+        ASSERT_EQUALS( clientResponse.getErrCode(), ErrorCodes::UnknownError );
+    }
+
 } // unnamed namespace
@@ -25,6 +25,7 @@
 #include <boost/thread/thread.hpp>
 
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/scripting/bson_template_evaluator.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/md5.h"
@@ -65,11 +66,49 @@ namespace mongo {
     void BenchRunEventCounter::reset() {
         _numEvents = 0;
         _totalTimeMicros = 0;
+        _maxTimeMicros = 0;
+        memset(_histogram, 0, sizeof(_histogram));
     }
 
     void BenchRunEventCounter::updateFrom(const BenchRunEventCounter &other) {
         _numEvents += other._numEvents;
         _totalTimeMicros += other._totalTimeMicros;
+        _maxTimeMicros = std::max(_maxTimeMicros, other._maxTimeMicros);
+        for (int i = 0; i < kNumBuckets; ++i)
+            _histogram[i] += other._histogram[i];
+    }
+
+    int BenchRunEventCounter::bucketFor(unsigned long long timeMicros) {
+        if (timeMicros < kSubBuckets)
+            return static_cast<int>(timeMicros);
+        int exponent = 4;
+        while (exponent < 63 && (timeMicros >> (exponent + 1)))
+            ++exponent;
+        return (exponent - 3) * kSubBuckets + ((timeMicros >> (exponent - 4)) & (kSubBuckets - 1));
+    }
+
+    unsigned long long BenchRunEventCounter::bucketMaxMicros(int bucket) {
+        if (bucket < kSubBuckets)
+            return bucket;
+        int shift = bucket / kSubBuckets - 1;
+        unsigned long long lowest =
+            static_cast<unsigned long long>(kSubBuckets + bucket % kSubBuckets) << shift;
+        return lowest + (1ULL << shift) - 1;
+    }
+
+    unsigned long long BenchRunEventCounter::getPercentileMicros(double percentile) const {
+        if (_numEvents == 0)
+            return 0;
+        unsigned long long rank =
+            static_cast<unsigned long long>(ceil(_numEvents * percentile / 100));
+        rank = std::max(rank, 1ULL);
+        unsigned long long seen = 0;
+        for (int i = 0; i < kNumBuckets; ++i) {
+            seen += _histogram[i];
+            if (seen >= rank)
+                return std::min(bucketMaxMicros(i), _maxTimeMicros);
+        }
+        return _maxTimeMicros;
     }
 
     BenchRunStats::BenchRunStats() {
@@ -87,8 +126,14 @@ namespace mongo {
         insertCounter.reset();
         deleteCounter.reset();
         queryCounter.reset();
+        commandCounter.reset();
+        aggregateCounter.reset();
 
         trappedErrors.clear();
+
+        targetedQueries = 0;
+        scatterQueries = 0;
+        shardCounters.clear();
     }
 
     void BenchRunStats::updateFrom(const BenchRunStats &other) {
@@ -101,9 +146,21 @@ namespace mongo {
         insertCounter.updateFrom(other.insertCounter);
         deleteCounter.updateFrom(other.deleteCounter);
         queryCounter.updateFrom(other.queryCounter);
+        commandCounter.updateFrom(other.commandCounter);
+        aggregateCounter.updateFrom(other.aggregateCounter);
 
         for (size_t i = 0; i < other.trappedErrors.size(); ++i)
             trappedErrors.push_back(other.trappedErrors[i]);
+
+        targetedQueries += other.targetedQueries;
+        scatterQueries += other.scatterQueries;
+        for (std::map<std::string, boost::shared_ptr<BenchRunEventCounter> >::const_iterator i =
+                 other.shardCounters.begin(); i != other.shardCounters.end(); ++i) {
+            boost::shared_ptr<BenchRunEventCounter> &counter = shardCounters[i->first];
+            if (!counter)
+                counter.reset(new BenchRunEventCounter());
+            counter->updateFrom(*i->second);
+        }
     }
 
     BenchRunConfig::BenchRunConfig() {
@@ -118,6 +175,8 @@ namespace mongo {
 
         parallel = 1;
         seconds = 1;
+        opsPerSecond = 0;
+        shardStats = 0;
         hideResults = true;
         handleErrors = false;
         hideErrors = false;
@@ -155,6 +214,12 @@ namespace mongo {
             this->parallel = args["parallel"].numberInt();
         if ( args["seconds"].isNumber() )
             this->seconds = args["seconds"].number();
+        if ( args["opsPerSecond"].isNumber() )
+            this->opsPerSecond = args["opsPerSecond"].number();
+        if ( args["shardStats"].isNumber() )
+            this->shardStats = args["shardStats"].numberInt();
+        else if ( args["shardStats"].trueValue() )
+            this->shardStats = 1;
         if ( ! args["hideResults"].eoo() )
             this->hideResults = args["hideResults"].trueValue();
         if ( ! args["handleErrors"].eoo() )
@@ -295,6 +360,38 @@ namespace mongo {
         return b.obj();
     }
 
+    /**
+     * Runs a write command, with the op's "writeConcern" and "ordered" if it has them, and
+     * returns the response with the first error it reports appended as "err" and "code", the
+     * way getLastError would report it.
+     */
+    static BSONObj runWriteCommand( DBClientBase* conn, const string& ns, const BSONObj& cmd,
+                                    const BSONElement& op ) {
+        BSONObjBuilder b;
+        b.appendElements( cmd );
+        if ( op["writeConcern"].isABSONObj() )
+            b.append( "writeConcern", op["writeConcern"].Obj() );
+        if ( ! op["ordered"].eoo() )
+            b.append( "ordered", op["ordered"].trueValue() );
+
+        BSONObj result;
+        conn->runCommand( nsToDatabase( ns ), b.obj(), result );
+
+        BSONObj error;
+        if ( ! result["ok"].trueValue() )
+            error = result;
+        else if ( result["errDetails"].type() == Array && ! result["errDetails"].Obj().isEmpty() )
+            error = result["errDetails"].Obj().firstElement().Obj();
+        if ( error.isEmpty() )
+            return result;
+
+        BSONObjBuilder withError;
+        withError.appendElements( result );
+        withError.append( "err", error["errmsg"].str() );
+        withError.append( "code", error["code"].numberInt() );
+        return withError.obj();
+    }
+
     BenchRunWorker::BenchRunWorker(const BenchRunConfig *config, BenchRunState *brState)
         : _config(config), _brState(brState) {
     }
@@ -305,6 +402,33 @@ namespace mongo {
         boost::thread(boost::bind(&BenchRunWorker::run, this));
     }
 
+    void BenchRunWorker::countShards( DBClientBase *conn, const string &ns, const BSONObj &query ) {
+        BSONObj explain = conn->findOne( ns, Query( query ).explain() );
+
+        map< string, vector< long long > > shardMillis;
+        if ( explain["shards"].isABSONObj() ) {
+            // mongos, for a query that went to more than one shard: each shard's explains
+            BSONForEach( shard, explain["shards"].Obj() ) {
+                BSONForEach( shardExplain, shard.Obj() ) {
+                    shardMillis[ shard.fieldName() ].push_back( shardExplain["millis"].numberLong() );
+                }
+            }
+        }
+        else {
+            shardMillis[ explain["server"].str() ].push_back( explain["millis"].numberLong() );
+        }
+
+        ( shardMillis.size() > 1 ? _stats.scatterQueries : _stats.targetedQueries )++;
+        for ( map< string, vector< long long > >::iterator i = shardMillis.begin();
+              i != shardMillis.end(); ++i ) {
+            boost::shared_ptr<BenchRunEventCounter> &counter = _stats.shardCounters[ i->first ];
+            if ( !counter )
+                counter.reset( new BenchRunEventCounter() );
+            for ( size_t j = 0; j < i->second.size(); ++j )
+                counter->countOne( i->second[j] * 1000 );
+        }
+    }
+
     bool BenchRunWorker::shouldStop() const {
         return _brState->shouldWorkerFinish();
     }
@@ -318,6 +442,13 @@ namespace mongo {
 
         BsonTemplateEvaluator bsonTemplateEvaluator;
 
+        // With opsPerSecond, op n is due n / rate seconds after the start, whether or not the
+        // ones before it have finished on time.
+        const double opsPerSecond = _config->opsPerSecond / _config->parallel;
+        const unsigned long long startMicros = curTimeMicros64();
+        unsigned long long opsScheduled = 0;
+        unsigned long long queriesRun = 0;
+
         while ( !shouldStop() ) {
             BSONObjIterator i( _config->ops );
             while ( i.more() ) {
@@ -344,6 +475,8 @@ namespace mongo {
                     }
                 }
 
+                bool writeCmd = e["writeCmd"].trueValue();
+
                 bool check = ! e["check"].eoo();
                 if( check ){
                     if ( e["check"].type() == CodeWScope || e["check"].type() == Code || e["check"].type() == String ) {
@@ -367,16 +500,30 @@ namespace mongo {
                     }
                 }
 
+                unsigned long long lateMicros = 0;
+                if ( opsPerSecond > 0 ) {
+                    unsigned long long due = startMicros +
+                        static_cast<unsigned long long>( opsScheduled++ * 1000000 / opsPerSecond );
+                    unsigned long long now;
+                    while ( ( now = curTimeMicros64() ) < due && ! shouldStop() )
+                        sleepmicros( std::min( due - now, 100000ULL ) );
+                    if ( shouldStop() ) break;
+                    lateMicros = now - due;
+                }
+
                 try {
                     if ( op == "findOne" ) {
 
                         BSONObj result;
+                        BSONObj fixedQuery = fixQuery( e["query"].Obj(), bsonTemplateEvaluator );
                         {
-                            BenchRunEventTrace _bret(&_stats.findOneCounter);
-                            result = conn->findOne( ns , fixQuery( e["query"].Obj(),
-                                                                   bsonTemplateEvaluator ) );
+                            BenchRunEventTrace _bret(&_stats.findOneCounter, lateMicros);
+                            result = conn->findOne( ns , fixedQuery );
                         }
 
+                        if ( _config->shardStats && ++queriesRun % _config->shardStats == 0 )
+                            countShards( conn, ns, fixedQuery );
+
                         if( check ){
                             int err = scope->invoke( scopeFunc , 0 , &result,  1000 * 60 , false );
                             if( err ){
@@ -394,8 +541,12 @@ namespace mongo {
                     else if ( op == "command" ) {
 
                         BSONObj result;
-                        conn->runCommand( ns, fixQuery( e["command"].Obj(), bsonTemplateEvaluator ),
-                                          result, e["options"].numberInt() );
+                        {
+                            BenchRunEventTrace _bret(&_stats.commandCounter, lateMicros);
+                            conn->runCommand( ns,
+                                              fixQuery( e["command"].Obj(), bsonTemplateEvaluator ),
+                                              result, e["options"].numberInt() );
+                        }
 
                         if( check ){
                             int err = scope->invoke( scopeFunc , 0 , &result,  1000 * 60 , false );
@@ -410,6 +561,36 @@ namespace mongo {
 
                         if( ! _config->hideResults || e["showResult"].trueValue() ) log() << "Result from benchRun thread [command] : " << result << endl;
 
+                    }
+                    else if ( op == "aggregate" ) {
+
+                        BSONObjBuilder cmd;
+                        cmd.append( "aggregate", nsToCollectionSubstring( ns ) );
+                        cmd.append( e["pipeline"] );
+                        BSONObj result;
+                        {
+                            BenchRunEventTrace _bret(&_stats.aggregateCounter, lateMicros);
+                            conn->runCommand( nsToDatabase( ns ), cmd.obj(), result,
+                                              e["options"].numberInt() );
+                        }
+
+                        if ( ! result["ok"].trueValue() )
+                            throw DBException( (string)"From benchRun aggregate" + causedBy( result["errmsg"].str() ),
+                                               result["code"].numberInt() );
+
+                        if( check ){
+                            int err = scope->invoke( scopeFunc , 0 , &result,  1000 * 60 , false );
+                            if( err ){
+                                log() << "Error checking in benchRun thread [aggregate]" << causedBy( scope->getError() ) << endl;
+
+                                _stats.errCount++;
+
+                                return;
+                            }
+                        }
+
+                        if( ! _config->hideResults || e["showResult"].trueValue() ) log() << "Result from benchRun thread [aggregate] : " << result << endl;
+
                     }
                     else if( op == "find" || op == "query" ) {
 
@@ -427,17 +608,20 @@ namespace mongo {
 
                         // use special query function for exhaust query option
                         if (options & QueryOption_Exhaust) {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, lateMicros);
                             boost::function<void (const BSONObj&)> castedDoNothing(doNothing);
                             count =  conn->query(castedDoNothing, ns, fixedQuery, &filter, options);
                         }
                         else {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, lateMicros);
                             cursor = conn->query(ns, fixedQuery, limit, skip, &filter, options,
                                                  batchSize);
                             count = cursor->itcount();
                         }
 
+                        if ( _config->shardStats && ++queriesRun % _config->shardStats == 0 )
+                            countShards( conn, ns, fixedQuery );
+
                         if ( expected >= 0 &&  count != expected ) {
                             cout << "bench query on: " << ns << " expected: " << expected << " got: " << count << endl;
                             verify(false);
@@ -468,14 +652,26 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
 
                         {
-                            BenchRunEventTrace _bret(&_stats.updateCounter);
-                            conn->update( ns, fixQuery( query, bsonTemplateEvaluator ), update,
-                                          upsert , multi );
-                            if (safe)
-                                result = conn->getLastErrorDetailed();
+                            BenchRunEventTrace _bret(&_stats.updateCounter, lateMicros);
+                            if ( writeCmd ) {
+                                BSONArrayBuilder updates;
+                                updates.append( BSON( "q" << fixQuery( query, bsonTemplateEvaluator ) <<
+                                                      "u" << update <<
+                                                      "multi" << multi <<
+                                                      "upsert" << upsert ) );
+                                result = runWriteCommand( conn, ns,
+                                                          BSON( "update" << nsToCollectionSubstring( ns ) <<
+                                                                "updates" << updates.arr() ), e );
+                            }
+                            else {
+                                conn->update( ns, fixQuery( query, bsonTemplateEvaluator ), update,
+                                              upsert , multi );
+                                if (safe)
+                                    result = conn->getLastErrorDetailed();
+                            }
                         }
 
-                        if( safe ){
+                        if( safe || writeCmd ){
                             if( check ){
                                 int err = scope->invoke( scopeFunc , 0 , &result, 1000 * 60 , false );
                                 if( err ){
@@ -498,13 +694,22 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.insertCounter);
-                            conn->insert( ns, fixQuery( e["doc"].Obj(), bsonTemplateEvaluator ) );
-                            if (safe)
-                                result = conn->getLastErrorDetailed();
+                            BenchRunEventTrace _bret(&_stats.insertCounter, lateMicros);
+                            if ( writeCmd ) {
+                                BSONArrayBuilder documents;
+                                documents.append( fixQuery( e["doc"].Obj(), bsonTemplateEvaluator ) );
+                                result = runWriteCommand( conn, ns,
+                                                          BSON( "insert" << nsToCollectionSubstring( ns ) <<
+                                                                "documents" << documents.arr() ), e );
+                            }
+                            else {
+                                conn->insert( ns, fixQuery( e["doc"].Obj(), bsonTemplateEvaluator ) );
+                                if (safe)
+                                    result = conn->getLastErrorDetailed();
+                            }
                         }
 
-                        if( safe ){
+                        if( safe || writeCmd ){
                             if( check ){
                                 int err = scope->invoke( scopeFunc , 0 , &result, 1000 * 60 , false );
                                 if( err ){
@@ -531,13 +736,23 @@ namespace mongo {
                         BSONObj result;
 
                         {
-                            BenchRunEventTrace _bret(&_stats.deleteCounter);
-                            conn->remove( ns, fixQuery( query, bsonTemplateEvaluator ), ! multi );
-                            if (safe)
-                                result = conn->getLastErrorDetailed();
+                            BenchRunEventTrace _bret(&_stats.deleteCounter, lateMicros);
+                            if ( writeCmd ) {
+                                BSONArrayBuilder deletes;
+                                deletes.append( BSON( "q" << fixQuery( query, bsonTemplateEvaluator ) <<
+                                                      "limit" << ( multi ? 0 : 1 ) ) );
+                                result = runWriteCommand( conn, ns,
+                                                          BSON( "delete" << nsToCollectionSubstring( ns ) <<
+                                                                "deletes" << deletes.arr() ), e );
+                            }
+                            else {
+                                conn->remove( ns, fixQuery( query, bsonTemplateEvaluator ), ! multi );
+                                if (safe)
+                                    result = conn->getLastErrorDetailed();
+                            }
                         }
 
-                        if( safe ){
+                        if( safe || writeCmd ){
                             if( check ){
                                 int err = scope->invoke( scopeFunc , 0 , &result, 1000 * 60 , false );
                                 if( err ){
@@ -761,6 +976,21 @@ namespace mongo {
                         static_cast<double>(counter.getTotalTimeMicros()) / counter.getNumEvents());
      }
 
+     static void appendPercentilesIfAvailable(
+             BSONObjBuilder &buf, const std::string &name, const BenchRunEventCounter &counter) {
+
+         if (counter.getNumEvents() > 0) {
+             BSONObjBuilder percentiles(buf.subobjStart(name));
+             percentiles.append("n", static_cast<long long>(counter.getNumEvents()));
+             percentiles.append("p50", static_cast<long long>(counter.getPercentileMicros(50)));
+             percentiles.append("p95", static_cast<long long>(counter.getPercentileMicros(95)));
+             percentiles.append("p99", static_cast<long long>(counter.getPercentileMicros(99)));
+             percentiles.append("p999", static_cast<long long>(counter.getPercentileMicros(99.9)));
+             percentiles.append("max", static_cast<long long>(counter.getMaxTimeMicros()));
+             percentiles.done();
+         }
+     }
+
      BSONObj BenchRunner::finish( BenchRunner* runner ) {
 
          runner->stop();
@@ -787,6 +1017,28 @@ namespace mongo {
          appendAverageMicrosIfAvailable(buf, "deleteLatencyAverageMicros", stats.deleteCounter);
          appendAverageMicrosIfAvailable(buf, "updateLatencyAverageMicros", stats.updateCounter);
          appendAverageMicrosIfAvailable(buf, "queryLatencyAverageMicros", stats.queryCounter);
+         appendAverageMicrosIfAvailable(buf, "commandLatencyAverageMicros", stats.commandCounter);
+         appendAverageMicrosIfAvailable(buf, "aggregateLatencyAverageMicros", stats.aggregateCounter);
+         appendPercentilesIfAvailable(buf, "findOneLatencyPercentilesMicros", stats.findOneCounter);
+         appendPercentilesIfAvailable(buf, "insertLatencyPercentilesMicros", stats.insertCounter);
+         appendPercentilesIfAvailable(buf, "deleteLatencyPercentilesMicros", stats.deleteCounter);
+         appendPercentilesIfAvailable(buf, "updateLatencyPercentilesMicros", stats.updateCounter);
+         appendPercentilesIfAvailable(buf, "queryLatencyPercentilesMicros", stats.queryCounter);
+         appendPercentilesIfAvailable(buf, "commandLatencyPercentilesMicros", stats.commandCounter);
+         appendPercentilesIfAvailable(buf, "aggregateLatencyPercentilesMicros", stats.aggregateCounter);
+
+         if ( stats.targetedQueries + stats.scatterQueries > 0 ) {
+             BSONObjBuilder shardStats( buf.subobjStart( "shardStats" ) );
+             shardStats.append( "targeted", (long long) stats.targetedQueries );
+             shardStats.append( "scatter", (long long) stats.scatterQueries );
+             BSONObjBuilder shards( shardStats.subobjStart( "shardLatencyPercentilesMicros" ) );
+             for ( std::map<std::string, boost::shared_ptr<BenchRunEventCounter> >::iterator i =
+                       stats.shardCounters.begin(); i != stats.shardCounters.end(); ++i ) {
+                 appendPercentilesIfAvailable( shards, i->first, *i->second );
+             }
+             shards.done();
+             shardStats.done();
+         }
 
          {
              BSONObjIterator i( after );
@@ -85,6 +85,25 @@ namespace mongo {
          */
         double seconds;
 
+        /**
+         * Desired rate of operations per second, across all threads.  When non-zero, each
+         * thread issues its operations on a fixed schedule instead of each as soon as the last
+         * has finished, and counts their latency from when they were due to start, so that a
+         * server that falls behind shows in the latencies rather than only in a lower rate.
+         *
+         * Zero, the default, runs each thread as fast as it can.
+         */
+        double opsPerSecond;
+
+        /**
+         * When non-zero, every shardStats'th query a thread runs is run again with explain, to
+         * learn how many shards it went to and how long each of them took.  Through mongos this
+         * tells targeted queries from scatter-gather ones.
+         *
+         * Zero, the default, doesn't explain any.
+         */
+        unsigned shardStats;
+
         bool hideResults;
         bool handleErrors;
         bool hideErrors;
@@ -101,7 +120,9 @@ namespace mongo {
          * Every thread in a benchRun job will perform these operations in sequence, restarting at
          * the beginning when the end is reached, until the job is stopped.
          *
-         * TODO: Document the operation objects.
+         * TODO: Document the operation objects.  Of the ops, "insert", "update" and "delete"
+         * take "writeCmd: true" to use the write commands, with the op's "writeConcern", and
+         * "aggregate" runs the op's "pipeline" on the collection in "ns".
          *
          * TODO: Introduce support for performing each operation exactly N times.
          */
@@ -142,6 +163,9 @@ namespace mongo {
         void countOne(unsigned long long timeMicros) {
             ++_numEvents;
             _totalTimeMicros += timeMicros;
+            ++_histogram[bucketFor(timeMicros)];
+            if (timeMicros > _maxTimeMicros)
+                _maxTimeMicros = timeMicros;
         }
 
         /**
@@ -154,9 +178,32 @@ namespace mongo {
          */
         unsigned long long getNumEvents() const { return _numEvents; }
 
+        /**
+         * Get the number of microseconds that "percentile" percent of the observed events took
+         * no longer than, overestimated by no more than 1/16th.
+         */
+        unsigned long long getPercentileMicros(double percentile) const;
+
+        /**
+         * Get the number of microseconds the longest observed event took.
+         */
+        unsigned long long getMaxTimeMicros() const { return _maxTimeMicros; }
+
     private:
+        /**
+         * Events are counted in buckets a sixteenth of a power of two wide, one microsecond wide
+         * below 16 microseconds, so that any spread of latencies fits in a fixed histogram.
+         */
+        static const int kSubBuckets = 16;
+        static const int kNumBuckets = (64 - 3) * kSubBuckets;
+
+        static int bucketFor(unsigned long long timeMicros);
+        static unsigned long long bucketMaxMicros(int bucket);
+
         unsigned long long _numEvents;
         unsigned long long _totalTimeMicros;
+        unsigned long long _maxTimeMicros;
+        unsigned long long _histogram[kNumBuckets];
     };
 
     /**
@@ -174,18 +221,25 @@ namespace mongo {
      */
     class BenchRunEventTrace : private boost::noncopyable {
     public:
-        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter) {
+        /**
+         * "lateMicros" is how long after it was due the event began, counted in with its
+         * duration.
+         */
+        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter,
+                                    unsigned long long lateMicros=0) {
             initialize(eventCounter, eventCounter, false);
+            _lateMicros = lateMicros;
         }
 
         BenchRunEventTrace(BenchRunEventCounter *successCounter,
                            BenchRunEventCounter *failCounter,
                            bool defaultToFailure=true) {
             initialize(successCounter, failCounter, defaultToFailure);
+            _lateMicros = 0;
         }
 
         ~BenchRunEventTrace() {
-            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros());
+            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros() + _lateMicros);
         }
 
         void succeed() { _succeeded = true; }
@@ -204,6 +258,7 @@ namespace mongo {
         BenchRunEventCounter *_successCounter;
         BenchRunEventCounter *_failCounter;
         bool _succeeded;
+        unsigned long long _lateMicros;
     };
 
     /**
@@ -226,9 +281,19 @@ namespace mongo {
         BenchRunEventCounter insertCounter;
         BenchRunEventCounter deleteCounter;
         BenchRunEventCounter queryCounter;
+        BenchRunEventCounter commandCounter;
+        BenchRunEventCounter aggregateCounter;
 
         std::map<std::string, long long> opcounters;
         std::vector<BSONObj> trappedErrors;
+
+        /**
+         * With shardStats, the explained queries that went to one shard and to more than one,
+         * and the time each shard spent on them, by shard.
+         */
+        unsigned long long targetedQueries;
+        unsigned long long scatterQueries;
+        std::map<std::string, boost::shared_ptr<BenchRunEventCounter> > shardCounters;
     };
 
     /**
@@ -329,6 +394,9 @@ namespace mongo {
         /// The function that actually sets about generating the load described in "_config".
         void generateLoadOnConnection( DBClientBase *conn );
 
+        /// Explain "query" on "ns", and count the shards it went to into the shard stats.
+        void countShards( DBClientBase *conn, const std::string &ns, const BSONObj &query );
+
         /// Predicate, used to decide whether or not it's time to terminate the worker.
         bool shouldStop() const;
 
@@ -27,6 +27,7 @@
 #include "mongo/platform/unordered_set.h"
 #include "mongo/scripting/bench.h"
 #include "mongo/util/file.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/text.h"
 
 namespace mongo {
@@ -289,7 +290,7 @@ namespace {
             if (!scope->getError().empty())
                 return; // not saving errored scopes
 
-            if (_pools.size() >= kMaxPoolSize) {
+            if (_pools.size() >= maxPoolSize()) {
                 // prefer to keep recently-used scopes
                 _pools.pop_back();
             }
@@ -320,8 +321,18 @@ namespace {
             string poolName;
         };
 
+        /**
+         * Idle scopes kept: enough for every core to be running a $where or mapReduce on each of
+         * a couple of pools, so that busy pools don't evict each other's compiled functions.
+         */
+        static size_t maxPoolSize() {
+            static const size_t size =
+                std::max(kMinPoolSize, 2 * static_cast<size_t>(ProcessInfo().getNumCores()));
+            return size;
+        }
+
         // Note: if these numbers change, reconsider choice of datastructure for _pools
-        static const unsigned kMaxPoolSize = 10;
+        static const size_t kMinPoolSize = 10;
         static const int kMaxScopeReuse = 10;
 
         typedef deque<ScopeAndPool> Pools; // More-recently used Scopes are kept at the front.
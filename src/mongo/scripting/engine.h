@@ -18,11 +18,13 @@
 #pragma once
 
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
     typedef unsigned long long ScriptingFunction;
     typedef BSONObj (*NativeFunction)(const BSONObj& args, void* data);
-    typedef map<string, ScriptingFunction> FunctionCacheMap;
+    // Compiled functions by source, so a pooled scope compiles each function once.
+    typedef unordered_map<string, ScriptingFunction> FunctionCacheMap;
 
     class DBClientWithCommands;
 
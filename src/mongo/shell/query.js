@@ -30,7 +30,7 @@ DBQuery.prototype.help = function () {
     print("\t.skip( n )")
     print("\t.count(applySkipLimit) - total # of objects matching query. by default ignores skip,limit")
     print("\t.size() - total # of objects cursor would return, honors skip,limit")
-    print("\t.explain([verbose])")
+    print("\t.explain([verbose]) - verbose includes all candidate plans and per-stage execution stats")
     print("\t.hint(...)")
     print("\t.addOption(n) - adds op_query options -- see wire protocol")
     print("\t._addSpecial(name, value) - http://dochub.mongodb.org/core/advancedqueries#AdvancedQueries-Metaqueryoperators")
@@ -292,7 +292,7 @@ DBQuery.prototype.comment = function (comment) {
 }
 
 DBQuery.prototype.explain = function (verbose) {
-    /* verbose=true --> include allPlans, oldPlan fields */
+    /* verbose=true or "executionStats" --> include allPlans, oldPlan, executionStats fields */
     var n = this.clone();
     n._addSpecial( "$explain", true );
     n._limit = Math.abs(n._limit) * -1;
@@ -305,6 +305,7 @@ DBQuery.prototype.explain = function (verbose) {
 
         delete obj.allPlans;
         delete obj.oldPlan;
+        delete obj.executionStats;
 
         if (typeof(obj.length) == 'number'){
             for (var i=0; i < obj.length; i++){
@@ -18,10 +18,12 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/convenience.hpp>
+#include <boost/thread/thread.hpp>
 #include <fcntl.h>
 #include <fstream>
 #include <map>
 
+#include "mongo/client/dbclient_rs.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/db.h"
 #include "mongo/db/namespace_string.h"
@@ -73,7 +75,104 @@ public:
         ProgressMeter* _m;
     };
 
-    void doCollection( const string coll , FILE* out , ProgressMeter *m ) {
+    /**
+     * The cursors of a parallelCollectionScan of one collection, drained at once into one file.
+     */
+    struct ParallelScan {
+        ParallelScan( const string& ns, Writer* writer )
+            : ns( ns ), writer( writer ), m( "dumpParallelScan" ), errCode( 0 ) {}
+
+        const string ns;
+        Writer* writer;
+        mongo::mutex m; // guards writer and the error
+        string errmsg;
+        int errCode;
+    };
+
+    void drainCursor( DBClientBase& connBase, long long cursorId, ParallelScan* scan ) {
+        try {
+            DBClientCursor cursor( &connBase, scan->ns, cursorId, 0,
+                                   QueryOption_SlaveOk | QueryOption_NoCursorTimeout );
+            while ( cursor.more() ) {
+                // a batch at a time, so the threads don't wait on each other for every object
+                mongo::mutex::scoped_lock lk( scan->m );
+                if ( !scan->errmsg.empty() ) {
+                    return;
+                }
+                while ( cursor.moreInCurrentBatch() ) {
+                    (*scan->writer)( cursor.nextSafe() );
+                }
+            }
+        }
+        catch ( DBException& e ) {
+            mongo::mutex::scoped_lock lk( scan->m );
+            if ( scan->errmsg.empty() ) {
+                scan->errmsg = e.toString();
+                scan->errCode = e.getCode();
+            }
+        }
+    }
+
+    void drainCursorThread( long long cursorId, ParallelScan* scan ) {
+        scoped_ptr<DBClientBase> c;
+        try {
+            c.reset( newConnection() );
+        }
+        catch ( DBException& e ) {
+            mongo::mutex::scoped_lock lk( scan->m );
+            if ( scan->errmsg.empty() ) {
+                scan->errmsg = e.toString();
+                scan->errCode = e.getCode();
+            }
+            return;
+        }
+        drainCursor( *c, cursorId, scan );
+    }
+
+    /**
+     * Dumps coll with numCursorsPerCollection cursors over parts of it, each read on a
+     * connection of its own.  Returns false, having written nothing, if the server can't split
+     * the collection, as for a capped one or a server without parallelCollectionScan.
+     */
+    bool doParallelScan( DBClientBase& connBase, const string& coll, Writer& writer ) {
+        const NamespaceString nss( coll );
+        BSONObj res;
+        if ( !connBase.runCommand( nss.db().toString(),
+                                   BSON( "parallelCollectionScan" << nss.coll() <<
+                                         "numCursors" <<
+                                         mongoDumpGlobalParams.numCursorsPerCollection ),
+                                   res,
+                                   QueryOption_SlaveOk ) ) {
+            if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1))) {
+                toolInfoLog() << "	can't split " << coll << ": " << res << std::endl;
+            }
+            return false;
+        }
+
+        vector<long long> cursorIds;
+        BSONObjIterator i( res.getObjectField( "cursors" ) );
+        while ( i.more() ) {
+            cursorIds.push_back( i.next().Obj()["cursor"]["id"].numberLong() );
+        }
+
+        ParallelScan scan( coll, &writer );
+        boost::thread_group threads;
+        for ( size_t j = 1; j < cursorIds.size(); j++ ) {
+            threads.create_thread( boost::bind( &Dump::drainCursorThread, this, cursorIds[j],
+                                                &scan ) );
+        }
+        if ( !cursorIds.empty() ) {
+            drainCursor( connBase, cursorIds[0], &scan );
+        }
+        threads.join_all();
+        if ( !scan.errmsg.empty() ) {
+            uasserted( scan.errCode, scan.errmsg );
+        }
+        return true;
+    }
+
+    void doCollection( DBClientBase& connBase, const string coll , FILE* out ,
+                       ProgressMeter *m ) {
         Query q = _query;
 
         int queryOptions = QueryOption_SlaveOk | QueryOption_NoCursorTimeout;
@@ -83,9 +182,19 @@ public:
             q.snapshot();
         }
         
-        DBClientBase& connBase = conn(true);
         Writer writer(out, m);
 
+        // Each cursor of a parallel scan is read on a new connection, which has to be to the
+        // server the scan was started on.
+        if (mongoDumpGlobalParams.numCursorsPerCollection > 1 &&
+            !(queryOptions & QueryOption_OplogReplay) &&
+            !toolGlobalParams.useDirectClient &&
+            !_usingMongos &&
+            _conn->type() == ConnectionString::MASTER &&
+            doParallelScan(connBase, coll, writer)) {
+            return;
+        }
+
         // use low-latency "exhaust" mode if going over the network
         if (!_usingMongos && typeid(connBase) == typeid(DBClientConnection&)) {
             DBClientConnection& conn = static_cast<DBClientConnection&>(connBase);
@@ -95,29 +204,32 @@ public:
         else {
             //This branch should only be taken with DBDirectClient or mongos which doesn't support exhaust mode
             scoped_ptr<DBClientCursor> cursor(connBase.query( coll.c_str() , q , 0 , 0 , 0 , queryOptions ));
+            cursor->setPrefetch( true ); // nothing else uses the connection until we're done
             while ( cursor->more() ) {
                 writer(cursor->next());
             }
         }
     }
 
-    void writeCollectionFile( const string coll , boost::filesystem::path outputFile ) {
+    void writeCollectionFile( DBClientBase& connBase, const string coll ,
+                              boost::filesystem::path outputFile ) {
         toolInfoLog() << "\t" << coll << " to " << outputFile.string() << std::endl;
 
         FilePtr f (fopen(outputFile.string().c_str(), "wb"));
         uassert(10262, errnoWithPrefix("couldn't open file"), f);
 
-        ProgressMeter m(conn(true).count(coll.c_str(), BSONObj(), QueryOption_SlaveOk));
+        ProgressMeter m(connBase.count(coll.c_str(), BSONObj(), QueryOption_SlaveOk));
         m.setName("Collection File Writing Progress");
         m.setUnits("objects");
 
-        doCollection(coll, f, &m);
+        doCollection(connBase, coll, f, &m);
 
         toolInfoLog() << "\t\t " << m.done() << " objects" << std::endl;
     }
 
     void writeMetadataFile( const string coll, boost::filesystem::path outputFile, 
-                            map<string, BSONObj> options, multimap<string, BSONObj> indexes ) {
+                            const map<string, BSONObj>& options,
+                            const multimap<string, BSONObj>& indexes ) {
         toolInfoLog() << "\tMetadata for " << coll << " to " << outputFile.string() << std::endl;
 
         bool hasOptions = options.count(coll) > 0;
@@ -133,10 +245,12 @@ public:
             BSONArrayBuilder indexesOutput (metadata.subarrayStart("indexes"));
 
             // I'd kill for C++11 auto here...
-            const pair<multimap<string, BSONObj>::iterator, multimap<string, BSONObj>::iterator>
+            const pair<multimap<string, BSONObj>::const_iterator,
+                       multimap<string, BSONObj>::const_iterator>
                 range = indexes.equal_range(coll);
 
-            for (multimap<string, BSONObj>::iterator it=range.first; it!=range.second; ++it) {
+            for (multimap<string, BSONObj>::const_iterator it=range.first; it!=range.second;
+                 ++it) {
                  indexesOutput << it->second;
             }
 
@@ -151,7 +265,79 @@ public:
 
 
     void writeCollectionStdout( const string coll ) {
-        doCollection(coll, stdout, NULL);
+        doCollection(conn(true), coll, stdout, NULL);
+    }
+
+    /** The collections of a database, dumped by several threads at once. */
+    struct DumpState {
+        DumpState( const string& db,
+                   const boost::filesystem::path& outdir,
+                   const map<string, BSONObj>& options,
+                   const multimap<string, BSONObj>& indexes )
+            : db( db ), outdir( outdir ), options( options ), indexes( indexes ),
+              m( "dumpState" ), next( 0 ), errCode( 0 ) {}
+
+        const string db;
+        const boost::filesystem::path outdir;
+        const map<string, BSONObj>& options;
+        const multimap<string, BSONObj>& indexes;
+        vector<string> collections;
+
+        mongo::mutex m; // guards the rest
+        size_t next;
+        string errmsg;
+        int errCode;
+    };
+
+    void dumpCollections( DBClientBase& connBase, DumpState* state ) {
+        while ( true ) {
+            string name;
+            {
+                mongo::mutex::scoped_lock lk( state->m );
+                if ( state->next == state->collections.size() || !state->errmsg.empty() ) {
+                    return;
+                }
+                name = state->collections[state->next++];
+            }
+
+            try {
+                const string filename = name.substr( state->db.size() + 1 );
+                writeCollectionFile( connBase, name, state->outdir / ( filename + ".bson" ) );
+                writeMetadataFile( name, state->outdir / ( filename + ".metadata.json" ),
+                                   state->options, state->indexes );
+            }
+            catch ( DBException& e ) {
+                mongo::mutex::scoped_lock lk( state->m );
+                if ( state->errmsg.empty() ) {
+                    state->errmsg = e.toString();
+                    state->errCode = e.getCode();
+                }
+                return;
+            }
+        }
+    }
+
+    void dumpCollectionsThread( DumpState* state ) {
+        scoped_ptr<DBClientBase> c;
+        try {
+            c.reset( newConnection() );
+        }
+        catch ( DBException& e ) {
+            mongo::mutex::scoped_lock lk( state->m );
+            if ( state->errmsg.empty() ) {
+                state->errmsg = e.toString();
+                state->errCode = e.getCode();
+            }
+            return;
+        }
+
+        // read from a secondary, as conn(true) does
+        if ( c->type() == ConnectionString::SET ) {
+            dumpCollections( static_cast<DBClientReplicaSet*>( c.get() )->slaveConn(), state );
+        }
+        else {
+            dumpCollections( *c, state );
+        }
     }
 
     void go( const string db , const boost::filesystem::path outdir ) {
@@ -161,7 +347,8 @@ public:
 
         map <string, BSONObj> collectionOptions;
         multimap <string, BSONObj> indexes;
-        vector <string> collections;
+        DumpState state( db, outdir, collectionOptions, indexes );
+        vector <string>& collections = state.collections;
 
         // Save indexes for database
         string ins = db + ".system.indexes";
@@ -209,7 +396,7 @@ public:
             if (nsToCollectionSubstring(name) == "system.indexes") {
               // Create system.indexes.bson for compatibility with pre 2.2 mongorestore
               const string filename = name.substr( db.size() + 1 );
-              writeCollectionFile( name.c_str() , outdir / ( filename + ".bson" ) );
+              writeCollectionFile( conn( true ), name.c_str() , outdir / ( filename + ".bson" ) );
               // Don't dump indexes as *.metadata.json
               continue;
             }
@@ -217,11 +404,18 @@ public:
             collections.push_back(name);
         }
         
-        for (vector<string>::iterator it = collections.begin(); it != collections.end(); ++it) {
-            string name = *it;
-            const string filename = name.substr( db.size() + 1 );
-            writeCollectionFile( name , outdir / ( filename + ".bson" ) );
-            writeMetadataFile( name, outdir / (filename + ".metadata.json"), collectionOptions, indexes);
+        // each thread besides this one has a connection of its own
+        const size_t numThreads = toolGlobalParams.useDirectClient ? 1 :
+            std::min( static_cast<size_t>( mongoDumpGlobalParams.numParallelCollections ),
+                      collections.size() );
+        boost::thread_group threads;
+        for ( size_t i = 1; i < numThreads; i++ ) {
+            threads.create_thread( boost::bind( &Dump::dumpCollectionsThread, this, &state ) );
+        }
+        dumpCollections( conn( true ), &state );
+        threads.join_all();
+        if ( !state.errmsg.empty() ) {
+            uasserted( state.errCode, state.errmsg );
         }
 
     }
@@ -506,7 +700,7 @@ public:
 
             _query = BSON("ts" << b.obj());
 
-            writeCollectionFile( opLogName , root / "oplog.bson" );
+            writeCollectionFile( conn( true ), opLogName , root / "oplog.bson" );
         }
 
         return 0;
@@ -18,11 +18,13 @@
 
 #include <boost/filesystem/convenience.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/thread/thread.hpp>
 #include <fstream>
 #include <iostream>
 
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/json.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/tools/mongoexport_options.h"
 #include "mongo/tools/tool.h"
 #include "mongo/tools/tool_logger.h"
@@ -105,6 +107,141 @@ public:
         return "";
     }
 
+    /** Writes obj as a line of csv, or as json, following another document unless first. */
+    void writeDocument(ostream& out, const BSONObj& obj, bool first) {
+        if (mongoExportGlobalParams.csv) {
+            for (std::vector<std::string>::iterator i = toolGlobalParams.fields.begin();
+                 i != toolGlobalParams.fields.end(); i++) {
+                if (i != toolGlobalParams.fields.begin())
+                    out << ",";
+                const BSONElement & e = obj.getFieldDotted(i->c_str());
+                if ( ! e.eoo() ) {
+                    out << csvString(e);
+                }
+            }
+            out << endl;
+        }
+        else {
+            if (mongoExportGlobalParams.jsonArray && !first)
+                out << ',';
+
+            out << obj.jsonString();
+
+            if (!mongoExportGlobalParams.jsonArray)
+                out << endl;
+        }
+    }
+
+    /**
+     * The cursors of a parallelCollectionScan, each formatting its documents on a thread of its
+     * own into the one output.
+     */
+    struct ParallelScan {
+        ParallelScan( const string& ns, ostream* out )
+            : ns( ns ), out( out ), m( "exportParallelScan" ), num( 0 ), errCode( 0 ) {}
+
+        const string ns;
+        ostream* out;
+        mongo::mutex m; // guards out, num and the error
+        long long num;
+        string errmsg;
+        int errCode;
+    };
+
+    void drainCursor( DBClientBase& connBase, long long cursorId, ParallelScan* scan ) {
+        try {
+            DBClientCursor cursor( &connBase, scan->ns, cursorId, 0,
+                                   QueryOption_SlaveOk | QueryOption_NoCursorTimeout );
+            while ( cursor.more() ) {
+                // a batch is formatted without the lock, and written with it
+                stringstream batch;
+                long long n = 0;
+                while ( cursor.moreInCurrentBatch() ) {
+                    // the comma before the first document of a batch is written with the batch
+                    writeDocument( batch, cursor.nextSafe(), n++ == 0 );
+                }
+                if ( n == 0 ) {
+                    continue;
+                }
+
+                mongo::mutex::scoped_lock lk( scan->m );
+                if ( !scan->errmsg.empty() ) {
+                    return;
+                }
+                if ( mongoExportGlobalParams.jsonArray && scan->num != 0 ) {
+                    *scan->out << ',';
+                }
+                *scan->out << batch.rdbuf();
+                scan->num += n;
+            }
+        }
+        catch ( DBException& e ) {
+            mongo::mutex::scoped_lock lk( scan->m );
+            if ( scan->errmsg.empty() ) {
+                scan->errmsg = e.toString();
+                scan->errCode = e.getCode();
+            }
+        }
+    }
+
+    void drainCursorThread( long long cursorId, ParallelScan* scan ) {
+        scoped_ptr<DBClientBase> c;
+        try {
+            c.reset( newConnection() );
+        }
+        catch ( DBException& e ) {
+            mongo::mutex::scoped_lock lk( scan->m );
+            if ( scan->errmsg.empty() ) {
+                scan->errmsg = e.toString();
+                scan->errCode = e.getCode();
+            }
+            return;
+        }
+        drainCursor( *c, cursorId, scan );
+    }
+
+    /**
+     * Exports ns with numCursors cursors over parts of it, each read on a connection of its own,
+     * in no particular order.  Returns false, having written nothing, if the server can't split
+     * the collection, as for a capped one or a server without parallelCollectionScan.
+     */
+    bool doParallelScan( const string& ns, ostream& out, long long* num ) {
+        const NamespaceString nss( ns );
+        BSONObj res;
+        if ( !conn().runCommand( nss.db().toString(),
+                                 BSON( "parallelCollectionScan" << nss.coll() <<
+                                       "numCursors" << mongoExportGlobalParams.numCursors ),
+                                 res,
+                                 mongoExportGlobalParams.slaveOk ? QueryOption_SlaveOk : 0 ) ) {
+            if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1))) {
+                toolInfoLog() << "can't split " << ns << ": " << res << std::endl;
+            }
+            return false;
+        }
+
+        vector<long long> cursorIds;
+        BSONObjIterator i( res.getObjectField( "cursors" ) );
+        while ( i.more() ) {
+            cursorIds.push_back( i.next().Obj()["cursor"]["id"].numberLong() );
+        }
+
+        ParallelScan scan( ns, &out );
+        boost::thread_group threads;
+        for ( size_t j = 1; j < cursorIds.size(); j++ ) {
+            threads.create_thread( boost::bind( &Export::drainCursorThread, this, cursorIds[j],
+                                                &scan ) );
+        }
+        if ( !cursorIds.empty() ) {
+            drainCursor( conn(), cursorIds[0], &scan );
+        }
+        threads.join_all();
+        if ( !scan.errmsg.empty() ) {
+            uasserted( scan.errCode, scan.errmsg );
+        }
+        *num = scan.num;
+        return true;
+    }
+
     int run() {
         string ns;
         ostream *outPtr = &cout;
@@ -161,17 +298,6 @@ public:
             return -1;
         }
 
-        Query q(mongoExportGlobalParams.query);
-
-        if (mongoExportGlobalParams.snapShotQuery) {
-            q.snapshot();
-        }
-
-        auto_ptr<DBClientCursor> cursor = conn().query(ns.c_str(), q,
-                mongoExportGlobalParams.limit, mongoExportGlobalParams.skip, fieldsToReturn,
-                (mongoExportGlobalParams.slaveOk ? QueryOption_SlaveOk : 0) |
-                QueryOption_NoCursorTimeout);
-
         if (mongoExportGlobalParams.csv) {
             for (std::vector<std::string>::iterator i = toolGlobalParams.fields.begin();
                  i != toolGlobalParams.fields.end(); i++) {
@@ -186,29 +312,33 @@ public:
             out << '[';
 
         long long num = 0;
-        while ( cursor->more() ) {
-            num++;
-            BSONObj obj = cursor->next();
-            if (mongoExportGlobalParams.csv) {
-                for (std::vector<std::string>::iterator i = toolGlobalParams.fields.begin();
-                     i != toolGlobalParams.fields.end(); i++) {
-                    if (i != toolGlobalParams.fields.begin())
-                        out << ",";
-                    const BSONElement & e = obj.getFieldDotted(i->c_str());
-                    if ( ! e.eoo() ) {
-                        out << csvString(e);
-                    }
-                }
-                out << endl;
+
+        // The cursors of a parallel scan are read on new connections, which have to be to the
+        // server the scan was started on.  They return whole documents, so json with a field
+        // list is exported through the one cursor.
+        bool scanned = false;
+        if (mongoExportGlobalParams.numCursors > 1 &&
+            (mongoExportGlobalParams.csv || !toolGlobalParams.fieldsSpecified) &&
+            !toolGlobalParams.useDirectClient &&
+            _conn->type() == ConnectionString::MASTER &&
+            !isMongos()) {
+            scanned = doParallelScan(ns, out, &num);
+        }
+
+        if (!scanned) {
+            Query q(mongoExportGlobalParams.query);
+
+            if (mongoExportGlobalParams.snapShotQuery) {
+                q.snapshot();
             }
-            else {
-                if (mongoExportGlobalParams.jsonArray && num != 1)
-                    out << ',';
 
-                out << obj.jsonString();
+            auto_ptr<DBClientCursor> cursor = conn().query(ns.c_str(), q,
+                    mongoExportGlobalParams.limit, mongoExportGlobalParams.skip, fieldsToReturn,
+                    (mongoExportGlobalParams.slaveOk ? QueryOption_SlaveOk : 0) |
+                    QueryOption_NoCursorTimeout);
 
-                if (!mongoExportGlobalParams.jsonArray)
-                    out << endl;
+            while ( cursor->more() ) {
+                writeDocument(out, cursor->next(), num++ == 0);
             }
         }
 
@@ -18,14 +18,17 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/thread/thread.hpp>
 #include <fstream>
 #include <iostream>
+#include <map>
 
 #include "mongo/base/initializer.h"
 #include "mongo/db/json.h"
 #include "mongo/tools/mongoimport_options.h"
 #include "mongo/tools/tool.h"
 #include "mongo/util/options_parser/option_section.h"
+#include "mongo/util/queue.h"
 #include "mongo/util/text.h"
 
 using namespace mongo;
@@ -171,14 +174,12 @@ class Import : public Tool {
     }
 
     /*
-     * Parses one object from the input file.  This usually corresponds to one line in the input
-     * file, unless the file is a CSV and contains a newline within a quoted string entry.
-     * Returns a true if a BSONObj was successfully created and false if not.
+     * Reads the text of one object from the input file into row.  This usually corresponds to
+     * one line in the input file, unless the file is a CSV and contains a newline within a
+     * quoted string entry.  line is a buffer of BUF_SIZE+2 bytes to read into.
+     * Returns false if there was no object on the line.
      */
-    bool parseRow(istream* in, BSONObj& o, int& numBytesRead) {
-        boost::scoped_array<char> buffer(new char[BUF_SIZE+2]);
-        char* line = buffer.get();
-
+    bool readRow(istream* in, char* line, string* row, int& numBytesRead) {
         numBytesRead = getLine(in, line);
         line += numBytesRead;
 
@@ -194,17 +195,12 @@ class Import : public Tool {
                 *end = 0;
                 end--;
             }
-            try {
-                o = fromjson( line );
-            } catch ( MsgAssertionException& e ) {
-                uasserted(13504, string("BSON representation of supplied JSON is too large: ") + e.what());
-            }
+            row->assign(line);
             return true;
         }
 
-        vector<string> tokens;
         if (_type == CSV) {
-            string row;
+            row->clear();
             bool inside_quotes = false;
             size_t last_quote = 0;
             while (true) {
@@ -216,10 +212,10 @@ class Import : public Tool {
                     last_quote = lineStr.find_first_of('"', last_quote+1);
                 }
 
-                row.append(lineStr);
+                row->append(lineStr);
 
                 if (inside_quotes) {
-                    row.append("\n");
+                    row->append("\n");
                     int num = getLine(in, line);
                     line += num;
                     numBytesRead += num;
@@ -232,14 +228,37 @@ class Import : public Tool {
             }
             // now 'row' is string corresponding to one row of the CSV file
             // (which may span multiple lines) and represents one BSONObj
-            csvTokenizeRow(row, tokens);
+            return true;
         }
-        else {  // _type == TSV
-            while (line[0] != '\t' && isspace(line[0])) { // Strip leading whitespace, but not tabs
-                line++;
+
+        // _type == TSV
+        while (line[0] != '\t' && isspace(line[0])) { // Strip leading whitespace, but not tabs
+            line++;
+        }
+        row->assign(line);
+        return true;
+    }
+
+    /*
+     * Parses one object from the text readRow() read for it.  A header line sets the fields for
+     * the rows after it.  Safe to call from several threads at once, other than for the header.
+     */
+    void parseRow(const string& row, BSONObj& o) {
+        if (_type == JSON) {
+            try {
+                o = fromjson( row );
+            } catch ( MsgAssertionException& e ) {
+                uasserted(13504, string("BSON representation of supplied JSON is too large: ") + e.what());
             }
+            return;
+        }
 
-            boost::split(tokens, line, boost::is_any_of(_sep));
+        vector<string> tokens;
+        if (_type == CSV) {
+            csvTokenizeRow(row, tokens);
+        }
+        else {  // _type == TSV
+            boost::split(tokens, row, boost::is_any_of(_sep));
         }
 
         // Now that the row is tokenized, create a BSONObj out of it.
@@ -266,7 +285,253 @@ class Import : public Tool {
             }
         }
         o = b.obj();
-        return true;
+    }
+
+    /**
+     * Rows of the input, read by one thread, parsed by another and inserted by a third.
+     */
+    struct Chunk {
+        Chunk() : seq(0), bytes(0), endsInError(false) {}
+
+        size_t seq;
+        vector<string> rows;
+        long long bytes; // of input read for the rows
+        vector<BSONObj> docs;
+        // with --stopOnError, the import stops after the docs of this chunk
+        bool endsInError;
+    };
+
+    /** The queues between the threads of a line by line import, and their results. */
+    struct Pipeline {
+        Pipeline(const string& ns, size_t numParsers)
+            : ns(ns),
+              toParse(2 * numParsers + 1),
+              toInsert(2 * numParsers + 1),
+              m("importPipeline"),
+              stop(false),
+              parsersLeft(numParsers),
+              num(0),
+              errors(0) {}
+
+        const string ns;
+        // a NULL chunk at the end of each queue for each of the threads reading it
+        BlockingQueue<Chunk*> toParse;
+        BlockingQueue<Chunk*> toInsert;
+
+        mongo::mutex m; // guards the rest
+        bool stop;
+        size_t parsersLeft;
+        long long num;
+        int errors;
+    };
+
+    // Rows are parsed, and documents inserted, this many at a time.
+    static const size_t kChunkRows = 1000;
+
+    // Documents are inserted in batches of about this many bytes.
+    static const int kInsertBatchBytes = 8 * 1024 * 1024;
+
+    /** for all the threads to stop at the next chunk */
+    static void stopPipeline(Pipeline* pipeline) {
+        mongo::mutex::scoped_lock lk(pipeline->m);
+        pipeline->stop = true;
+    }
+
+    static bool stopped(Pipeline* pipeline) {
+        mongo::mutex::scoped_lock lk(pipeline->m);
+        return pipeline->stop;
+    }
+
+    static void countError(Pipeline* pipeline) {
+        mongo::mutex::scoped_lock lk(pipeline->m);
+        pipeline->errors++;
+    }
+
+    void readChunks(istream* in, size_t numParsers, Pipeline* pipeline) {
+        boost::scoped_array<char> buffer(new char[BUF_SIZE+2]);
+        size_t seq = 0;
+        auto_ptr<Chunk> chunk(new Chunk());
+        while (in->rdstate() == 0 && !stopped(pipeline)) {
+            try {
+                string row;
+                int len = 0;
+                bool gotRow = readRow(in, buffer.get(), &row, len);
+                chunk->bytes += len + 1;
+                if (!gotRow) {
+                    continue;
+                }
+                chunk->rows.push_back(row);
+            }
+            catch ( const std::exception& e ) {
+                toolError() << "exception:" << e.what() << std::endl;
+                countError(pipeline);
+
+                if (mongoImportGlobalParams.stopOnError) {
+                    chunk->endsInError = true;
+                    break;
+                }
+            }
+
+            if (chunk->rows.size() == kChunkRows) {
+                chunk->seq = seq++;
+                pipeline->toParse.push(chunk.release());
+                chunk.reset(new Chunk());
+            }
+        }
+
+        chunk->seq = seq++;
+        pipeline->toParse.push(chunk.release());
+        for (size_t i = 0; i < numParsers; i++) {
+            pipeline->toParse.push(NULL);
+        }
+    }
+
+    void readChunksThread(istream* in, size_t numParsers, Pipeline* pipeline) {
+        try {
+            readChunks(in, numParsers, pipeline);
+        }
+        catch ( const std::exception& e ) {
+            // only out of memory, really; let the other threads finish
+            toolError() << "exception:" << e.what() << std::endl;
+            countError(pipeline);
+            stopPipeline(pipeline);
+            for (size_t i = 0; i < numParsers; i++) {
+                pipeline->toParse.push(NULL);
+            }
+        }
+    }
+
+    void parseChunksThread(size_t numInserters, Pipeline* pipeline) {
+        while (Chunk* chunk = pipeline->toParse.blockingPop()) {
+            if (stopped(pipeline)) {
+                delete chunk;
+                continue;
+            }
+
+            for (vector<string>::const_iterator it = chunk->rows.begin();
+                 it != chunk->rows.end(); ++it) {
+                try {
+                    BSONObj o;
+                    parseRow(*it, o);
+                    chunk->docs.push_back(o);
+                }
+                catch ( const std::exception& e ) {
+                    toolError() << "exception:" << e.what() << std::endl;
+                    countError(pipeline);
+
+                    if (mongoImportGlobalParams.stopOnError) {
+                        chunk->endsInError = true;
+                        break;
+                    }
+                }
+            }
+            chunk->rows.clear();
+            pipeline->toInsert.push(chunk);
+        }
+
+        // the last parser to finish lets the inserters know
+        bool last;
+        {
+            mongo::mutex::scoped_lock lk(pipeline->m);
+            last = --pipeline->parsersLeft == 0;
+        }
+        if (last) {
+            for (size_t i = 0; i < numInserters; i++) {
+                pipeline->toInsert.push(NULL);
+            }
+        }
+    }
+
+    void insertChunk(DBClientBase& c, Pipeline* pipeline, Chunk* chunk) {
+        if (mongoImportGlobalParams.doimport) {
+            try {
+                importDocuments(c, pipeline->ns, chunk->docs);
+                if (!checkLastError(c) && mongoImportGlobalParams.stopOnError) {
+                    chunk->endsInError = true;
+                }
+            }
+            catch ( const DBException& e ) {
+                toolError() << "exception:" << e.what() << std::endl;
+                countError(pipeline);
+                chunk->endsInError = true;
+            }
+        }
+
+        mongo::mutex::scoped_lock lk(pipeline->m);
+        pipeline->num += chunk->docs.size();
+        if (chunk->endsInError) {
+            pipeline->stop = true;
+        }
+    }
+
+    static void showProgress(ProgressMeter* pm, time_t start, Pipeline* pipeline,
+                             long long bytes) {
+        if (!pm || !pm->hit(bytes)) {
+            return;
+        }
+        long long num;
+        {
+            mongo::mutex::scoped_lock lk(pipeline->m);
+            num = pipeline->num;
+        }
+        log() << "\t\t\t" << num << "\t" << (num / (time(0) - start)) << "/second" << std::endl;
+    }
+
+    /**
+     * Inserts chunks as they're parsed.  If inOrder they go in the order of the input, and
+     * there can be no other thread inserting.
+     */
+    void insertChunks(DBClientBase& c, bool inOrder, ProgressMeter* pm, time_t start,
+                      Pipeline* pipeline) {
+        map<size_t, Chunk*> waiting;
+        size_t nextSeq = 0;
+        while (Chunk* chunk = pipeline->toInsert.blockingPop()) {
+            if (!inOrder) {
+                scoped_ptr<Chunk> next(chunk);
+                if (!stopped(pipeline)) {
+                    insertChunk(c, pipeline, next.get());
+                    showProgress(pm, start, pipeline, next->bytes);
+                }
+                continue;
+            }
+
+            waiting[chunk->seq] = chunk;
+            for (map<size_t, Chunk*>::iterator it = waiting.begin();
+                 it != waiting.end() && it->first == nextSeq;
+                 waiting.erase(it++), nextSeq++) {
+                scoped_ptr<Chunk> next(it->second);
+                if (!stopped(pipeline)) {
+                    insertChunk(c, pipeline, next.get());
+                    showProgress(pm, start, pipeline, next->bytes);
+                }
+            }
+        }
+
+        for (map<size_t, Chunk*>::iterator it = waiting.begin(); it != waiting.end(); ++it) {
+            delete it->second;
+        }
+    }
+
+    void insertChunksThread(Pipeline* pipeline) {
+        scoped_ptr<DBClientBase> c;
+        try {
+            c.reset(newConnection());
+        }
+        catch ( const DBException& e ) {
+            toolError() << "exception:" << e.what() << std::endl;
+            countError(pipeline);
+            stopPipeline(pipeline);
+        }
+
+        if (c) {
+            insertChunks(*c, false, NULL, 0, pipeline);
+        }
+        else {
+            // keep the parsers from waiting on a full queue
+            while (Chunk* chunk = pipeline->toInsert.blockingPop()) {
+                delete chunk;
+            }
+        }
     }
 
 public:
@@ -278,11 +543,11 @@ public:
         printMongoImportHelp(&out);
     }
 
-    unsigned long long lastErrorFailures;
+    AtomicUInt lastErrorFailures;
 
     /** @return true if ok */
-    bool checkLastError() { 
-        string s = conn().getLastError();
+    bool checkLastError(DBClientBase& c) {
+        string s = c.getLastError();
         if( !s.empty() ) { 
             if( str::contains(s,"uplicate") ) {
                 // we don't want to return an error from the mongoimport process for
@@ -298,32 +563,70 @@ public:
         return true;
     }
 
-    void importDocument (const std::string &ns, const BSONObj& o) {
-        bool doUpsert = mongoImportGlobalParams.upsert;
+    bool checkLastError() {
+        return checkLastError(conn());
+    }
+
+    /** @return false if o has one of the --upsertFields missing, and so is just inserted */
+    bool upsertQuery(const BSONObj& o, BSONObj* query) {
         BSONObjBuilder b;
-        if (mongoImportGlobalParams.upsert) {
-            for (vector<string>::const_iterator it = mongoImportGlobalParams.upsertFields.begin(),
-                 end = mongoImportGlobalParams.upsertFields.end(); it != end; ++it) {
-                BSONElement e = o.getFieldDotted(it->c_str());
-                if (e.eoo()) {
-                    doUpsert = false;
-                    break;
-                }
-                b.appendAs(e, *it);
+        for (vector<string>::const_iterator it = mongoImportGlobalParams.upsertFields.begin(),
+             end = mongoImportGlobalParams.upsertFields.end(); it != end; ++it) {
+            BSONElement e = o.getFieldDotted(it->c_str());
+            if (e.eoo()) {
+                return false;
             }
+            b.appendAs(e, *it);
         }
+        *query = b.obj();
+        return true;
+    }
 
-        if (doUpsert) {
-            conn().update(ns, Query(b.obj()), o, true);
+    void importDocument (const std::string &ns, const BSONObj& o) {
+        BSONObj query;
+        if (mongoImportGlobalParams.upsert && upsertQuery(o, &query)) {
+            conn().update(ns, Query(query), o, true);
         }
         else {
             conn().insert(ns.c_str(), o);
         }
     }
 
+    /**
+     * Imports docs in order, inserting as many at once as there are between upserts.  Without
+     * --stopOnError the documents after one that fails to insert are still inserted.
+     */
+    void importDocuments(DBClientBase& c, const string& ns, const vector<BSONObj>& docs) {
+        const int flags = mongoImportGlobalParams.stopOnError ? 0 : InsertOption_ContinueOnError;
+        vector<BSONObj> batch;
+        int batchBytes = 0;
+        for (vector<BSONObj>::const_iterator it = docs.begin(); it != docs.end(); ++it) {
+            BSONObj query;
+            if (mongoImportGlobalParams.upsert && upsertQuery(*it, &query)) {
+                if (!batch.empty()) {
+                    c.insert(ns, batch, flags);
+                    batch.clear();
+                    batchBytes = 0;
+                }
+                c.update(ns, Query(query), *it, true);
+                continue;
+            }
+
+            batch.push_back(*it);
+            batchBytes += it->objsize();
+            if (batchBytes >= kInsertBatchBytes) {
+                c.insert(ns, batch, flags);
+                batch.clear();
+                batchBytes = 0;
+            }
+        }
+        if (!batch.empty()) {
+            c.insert(ns, batch, flags);
+        }
+    }
+
     int run() {
         long long fileSize = 0;
-        int headerRows = 0;
 
         istream * in = &cin;
 
@@ -395,10 +698,7 @@ public:
         }
 
         if (_type == CSV || _type == TSV) {
-            if (mongoImportGlobalParams.headerLine) {
-                headerRows = 1;
-            }
-            else {
+            if (!mongoImportGlobalParams.headerLine) {
                 if (!toolGlobalParams.fieldsSpecified) {
                     throw UserException(9998, "You need to specify fields or have a headerline to "
                                               "import this file type");
@@ -507,45 +807,53 @@ public:
             }
         }
         else {
-            while (in->rdstate() == 0) {
+            // The rows go from a thread reading them to threads parsing them, and from those to
+            // this thread and any others inserting them, a chunk at a time.
+            if (mongoImportGlobalParams.headerLine) {
                 try {
-                    BSONObj o;
-
-                    if (!parseRow(in, o, len)) {
-                        continue;
+                    boost::scoped_array<char> buffer(new char[BUF_SIZE+2]);
+                    string row;
+                    while (in->rdstate() == 0 && !readRow(in, buffer.get(), &row, len)) {
                     }
-
-                    if (mongoImportGlobalParams.headerLine) {
-                        mongoImportGlobalParams.headerLine = false;
+                    BSONObj header;
+                    parseRow(row, header);
+                    if (!toolGlobalParams.quiet) {
+                        pm.hit(len + 1);
                     }
-                    else if (mongoImportGlobalParams.doimport) {
-                        importDocument(ns, o);
-
-                        if (num < 10) {
-                            // we absolutely want to check the first and last op of the batch. we do
-                            // a few more as that won't be too time expensive.
-                            checkLastError();
-                            lastNumChecked = num;
-                        }
-                    }
-
-                    num++;
                 }
                 catch ( const std::exception& e ) {
                     toolError() << "exception:" << e.what() << std::endl;
                     errors++;
-
-                    if (mongoImportGlobalParams.stopOnError)
-                        break;
                 }
+                mongoImportGlobalParams.headerLine = false;
+            }
 
-                if (!toolGlobalParams.quiet) {
-                    if (pm.hit(len + 1)) {
-                        log() << "\t\t\t" << num << "\t" << (num / (time(0) - start)) << "/second"
-                              << std::endl;
-                    }
-                }
+            const size_t numParsers = mongoImportGlobalParams.numParsingThreads;
+            // with --stopOnError there is a single inserter, so that documents go in the order of
+            // the input and none go in after the first error
+            const size_t numInserters =
+                mongoImportGlobalParams.stopOnError || toolGlobalParams.useDirectClient ?
+                1 : mongoImportGlobalParams.numInsertionWorkers;
+
+            Pipeline pipeline(ns, numParsers);
+            boost::thread_group threads;
+            threads.create_thread(boost::bind(&Import::readChunksThread, this, in, numParsers,
+                                              &pipeline));
+            for (size_t i = 0; i < numParsers; i++) {
+                threads.create_thread(boost::bind(&Import::parseChunksThread, this,
+                                                  numInserters, &pipeline));
             }
+            for (size_t i = 1; i < numInserters; i++) {
+                threads.create_thread(boost::bind(&Import::insertChunksThread, this,
+                                                  &pipeline));
+            }
+            insertChunks(conn(), numInserters == 1, toolGlobalParams.quiet ? NULL : &pm, start,
+                         &pipeline);
+            threads.join_all();
+
+            num = pipeline.num;
+            lastNumChecked = num - 1; // checked after every chunk
+            errors += pipeline.errors;
         }
 
         // this is for two reasons: to wait for all operations to reach the server and be processed, and this will wait until all data reaches the server,
@@ -555,19 +863,20 @@ public:
             checkLastError();
         }
 
-        bool hadErrors = lastErrorFailures || errors;
+        bool hadErrors = lastErrorFailures.get() || errors;
 
         // the message is vague on lastErrorFailures as we don't call it on every single operation. 
         // so if we have a lastErrorFailure there might be more than just what has been counted.
-        toolInfoLog() << (lastErrorFailures ? "tried to import " : "imported ")
-                      << (num - headerRows) << " objects" << std::endl;
+        toolInfoLog() << (lastErrorFailures.get() ? "tried to import " : "imported ")
+                      << num << " objects" << std::endl;
 
         if ( !hadErrors )
             return 0;
 
-        toolError() << "encountered " << (lastErrorFailures?"at least ":"")
-                  << lastErrorFailures+errors <<  " error(s)"
-                  << (lastErrorFailures+errors == 1 ? "" : "s") << std::endl;
+        const unsigned totalErrors = lastErrorFailures.get() + errors;
+        toolError() << "encountered " << (lastErrorFailures.get()?"at least ":"")
+                  << totalErrors <<  " error(s)"
+                  << (totalErrors == 1 ? "" : "s") << std::endl;
         return -1;
     }
 };
@@ -60,6 +60,14 @@ namespace mongo {
         options->addOptionChaining("forceTableScan", "forceTableScan", moe::Switch,
                 "force a table scan (do not use $snapshot)");
 
+        options->addOptionChaining("numParallelCollections", "numParallelCollections,j",
+                moe::Int, "number of collections to dump at once, default 1")
+                                  .setDefault(moe::Value(1));
+
+        options->addOptionChaining("numCursorsPerCollection", "numCursorsPerCollection",
+                moe::Int, "split each collection among this many cursors read at once, "
+                "with --forceTableScan, default 1")
+                                  .setDefault(moe::Value(1));
 
         return Status::OK();
     }
@@ -112,6 +120,19 @@ namespace mongo {
             mongoDumpGlobalParams.snapShotQuery = true;
         }
 
+        mongoDumpGlobalParams.numParallelCollections = getParam("numParallelCollections", 1);
+        mongoDumpGlobalParams.numCursorsPerCollection = getParam("numCursorsPerCollection", 1);
+        if (mongoDumpGlobalParams.numParallelCollections < 1 ||
+            mongoDumpGlobalParams.numCursorsPerCollection < 1) {
+            return Status(ErrorCodes::BadValue,
+                          "numParallelCollections and numCursorsPerCollection must be positive");
+        }
+        if (mongoDumpGlobalParams.numCursorsPerCollection > 1 &&
+            (hasParam("query") || mongoDumpGlobalParams.snapShotQuery)) {
+            return Status(ErrorCodes::BadValue,
+                          "numCursorsPerCollection needs --forceTableScan and no --query");
+        }
+
         // Make the default db "" if it was not explicitly set
         if (!params.count("db")) {
             toolGlobalParams.db = "";
@@ -31,6 +31,8 @@ namespace mongo {
         bool useOplog;
         bool repair;
         bool snapShotQuery;
+        int numParallelCollections;
+        int numCursorsPerCollection;
     };
 
     extern MongoDumpGlobalParams mongoDumpGlobalParams;
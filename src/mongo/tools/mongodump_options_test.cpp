@@ -400,6 +400,35 @@ namespace {
                 ASSERT_EQUALS(iterator->_positionalStart, -1);
                 ASSERT_EQUALS(iterator->_positionalEnd, -1);
             }
+            else if (iterator->_dottedName == "numParallelCollections") {
+                ASSERT_EQUALS(iterator->_singleName, "numParallelCollections,j");
+                ASSERT_EQUALS(iterator->_type, moe::Int);
+                ASSERT_EQUALS(iterator->_description,
+                              "number of collections to dump at once, default 1");
+                ASSERT_EQUALS(iterator->_isVisible, true);
+                moe::Value defaultVal(1);
+                ASSERT_TRUE(iterator->_default.equal(defaultVal));
+                ASSERT_TRUE(iterator->_implicit.isEmpty());
+                ASSERT_EQUALS(iterator->_isComposing, false);
+                ASSERT_EQUALS(iterator->_sources, moe::SourceAll);
+                ASSERT_EQUALS(iterator->_positionalStart, -1);
+                ASSERT_EQUALS(iterator->_positionalEnd, -1);
+            }
+            else if (iterator->_dottedName == "numCursorsPerCollection") {
+                ASSERT_EQUALS(iterator->_singleName, "numCursorsPerCollection");
+                ASSERT_EQUALS(iterator->_type, moe::Int);
+                ASSERT_EQUALS(iterator->_description,
+                              "split each collection among this many cursors read at once, "
+                              "with --forceTableScan, default 1");
+                ASSERT_EQUALS(iterator->_isVisible, true);
+                moe::Value defaultVal(1);
+                ASSERT_TRUE(iterator->_default.equal(defaultVal));
+                ASSERT_TRUE(iterator->_implicit.isEmpty());
+                ASSERT_EQUALS(iterator->_isComposing, false);
+                ASSERT_EQUALS(iterator->_sources, moe::SourceAll);
+                ASSERT_EQUALS(iterator->_positionalStart, -1);
+                ASSERT_EQUALS(iterator->_positionalEnd, -1);
+            }
 #ifdef MONGO_SSL
             else if (iterator->_dottedName == "ssl") {
                 ASSERT_EQUALS(iterator->_singleName, "ssl");
@@ -74,6 +74,11 @@ namespace mongo {
                 "limit the numbers of documents returned, default all")
                                   .setDefault(moe::Value(0));
 
+        options->addOptionChaining("numCursors", "numCursors", moe::Int,
+                "split the collection among this many cursors read at once, with "
+                "--forceTableScan; documents come out in no particular order, default 1")
+                                  .setDefault(moe::Value(1));
+
 
         return Status::OK();
     }
@@ -119,6 +124,16 @@ namespace mongo {
         mongoExportGlobalParams.slaveOk = params["slaveOk"].as<bool>();
         mongoExportGlobalParams.limit = getParam("limit", 0);
         mongoExportGlobalParams.skip = getParam("skip", 0);
+        mongoExportGlobalParams.numCursors = getParam("numCursors", 1);
+        if (mongoExportGlobalParams.numCursors < 1) {
+            return Status(ErrorCodes::BadValue, "numCursors must be positive");
+        }
+        if (mongoExportGlobalParams.numCursors > 1 &&
+            (hasParam("query") || mongoExportGlobalParams.snapShotQuery ||
+             mongoExportGlobalParams.skip || mongoExportGlobalParams.limit)) {
+            return Status(ErrorCodes::BadValue,
+                          "numCursors needs --forceTableScan and no --query, --skip or --limit");
+        }
 
         // we write output to standard error by default to avoid mangling output, but we don't need
         // to do this if an output file was specified
@@ -35,6 +35,7 @@ namespace mongo {
         bool snapShotQuery;
         unsigned int skip;
         unsigned int limit;
+        int numCursors;
     };
 
     extern MongoExportGlobalParams mongoExportGlobalParams;
@@ -462,6 +462,22 @@ namespace {
                 ASSERT_EQUALS(iterator->_positionalStart, -1);
                 ASSERT_EQUALS(iterator->_positionalEnd, -1);
             }
+            else if (iterator->_dottedName == "numCursors") {
+                ASSERT_EQUALS(iterator->_singleName, "numCursors");
+                ASSERT_EQUALS(iterator->_type, moe::Int);
+                ASSERT_EQUALS(iterator->_description,
+                              "split the collection among this many cursors read at once, with "
+                              "--forceTableScan; documents come out in no particular order, "
+                              "default 1");
+                ASSERT_EQUALS(iterator->_isVisible, true);
+                moe::Value defaultVal(1);
+                ASSERT_TRUE(iterator->_default.equal(defaultVal));
+                ASSERT_TRUE(iterator->_implicit.isEmpty());
+                ASSERT_EQUALS(iterator->_isComposing, false);
+                ASSERT_EQUALS(iterator->_sources, moe::SourceAll);
+                ASSERT_EQUALS(iterator->_positionalStart, -1);
+                ASSERT_EQUALS(iterator->_positionalEnd, -1);
+            }
 #ifdef MONGO_SSL
             else if (iterator->_dottedName == "ssl") {
                 ASSERT_EQUALS(iterator->_singleName, "ssl");
@@ -78,6 +78,13 @@ namespace mongo {
         options->addOptionChaining("jsonArray", "jsonArray", moe::Switch,
                 "load a json array, not one item per line. Currently limited to 16MB.");
 
+        options->addOptionChaining("numParsingThreads", "numParsingThreads", moe::Int,
+                "number of threads to parse the input with, default 1")
+                                  .setDefault(moe::Value(1));
+
+        options->addOptionChaining("numInsertionWorkers", "numInsertionWorkers", moe::Int,
+                "number of connections to insert with, default 1 (1 with --stopOnError)")
+                                  .setDefault(moe::Value(1));
 
         options->addOptionChaining("noimport", "noimport", moe::Switch,
                 "don't actually import. useful for benchmarking parser")
@@ -143,6 +150,14 @@ namespace mongo {
         mongoImportGlobalParams.jsonArray = hasParam("jsonArray");
         mongoImportGlobalParams.headerLine = hasParam("headerline");
         mongoImportGlobalParams.stopOnError = hasParam("stopOnError");
+        mongoImportGlobalParams.numParsingThreads = getParam("numParsingThreads", 1);
+        if (mongoImportGlobalParams.numParsingThreads < 1) {
+            return Status(ErrorCodes::BadValue, "numParsingThreads must be positive");
+        }
+        mongoImportGlobalParams.numInsertionWorkers = getParam("numInsertionWorkers", 1);
+        if (mongoImportGlobalParams.numInsertionWorkers < 1) {
+            return Status(ErrorCodes::BadValue, "numInsertionWorkers must be positive");
+        }
 
         return Status::OK();
     }
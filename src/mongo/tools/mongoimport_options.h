@@ -36,6 +36,8 @@ namespace mongo {
         bool stopOnError;
         bool jsonArray;
         bool doimport;
+        int numParsingThreads;
+        int numInsertionWorkers;
     };
 
     extern MongoImportGlobalParams mongoImportGlobalParams;
@@ -447,6 +447,34 @@ namespace {
                 ASSERT_EQUALS(iterator->_positionalStart, -1);
                 ASSERT_EQUALS(iterator->_positionalEnd, -1);
             }
+            else if (iterator->_dottedName == "numParsingThreads") {
+                ASSERT_EQUALS(iterator->_singleName, "numParsingThreads");
+                ASSERT_EQUALS(iterator->_type, moe::Int);
+                ASSERT_EQUALS(iterator->_description,
+                              "number of threads to parse the input with, default 1");
+                ASSERT_EQUALS(iterator->_isVisible, true);
+                moe::Value defaultVal(1);
+                ASSERT_TRUE(iterator->_default.equal(defaultVal));
+                ASSERT_TRUE(iterator->_implicit.isEmpty());
+                ASSERT_EQUALS(iterator->_isComposing, false);
+                ASSERT_EQUALS(iterator->_sources, moe::SourceAll);
+                ASSERT_EQUALS(iterator->_positionalStart, -1);
+                ASSERT_EQUALS(iterator->_positionalEnd, -1);
+            }
+            else if (iterator->_dottedName == "numInsertionWorkers") {
+                ASSERT_EQUALS(iterator->_singleName, "numInsertionWorkers");
+                ASSERT_EQUALS(iterator->_type, moe::Int);
+                ASSERT_EQUALS(iterator->_description,
+                              "number of connections to insert with, default 1 (1 with --stopOnError)");
+                ASSERT_EQUALS(iterator->_isVisible, true);
+                moe::Value defaultVal(1);
+                ASSERT_TRUE(iterator->_default.equal(defaultVal));
+                ASSERT_TRUE(iterator->_implicit.isEmpty());
+                ASSERT_EQUALS(iterator->_isComposing, false);
+                ASSERT_EQUALS(iterator->_sources, moe::SourceAll);
+                ASSERT_EQUALS(iterator->_positionalStart, -1);
+                ASSERT_EQUALS(iterator->_positionalEnd, -1);
+            }
             else if (iterator->_dottedName == "stopOnError") {
                 ASSERT_EQUALS(iterator->_singleName, "stopOnError");
                 ASSERT_EQUALS(iterator->_type, moe::Switch);
@@ -53,6 +53,10 @@ namespace mongo {
         options->addOptionChaining("oplogns", "oplogns", moe::String, "ns to pull from")
                                   .setDefault(moe::Value(std::string("local.oplog.rs")));
 
+        options->addOptionChaining("numWriterThreads", "numWriterThreads", moe::Int,
+                "number of connections to apply ops with at once, default 1")
+                                  .setDefault(moe::Value(1));
+
 
         return Status::OK();
     }
@@ -90,6 +94,10 @@ namespace mongo {
 
         mongoOplogGlobalParams.seconds = getParam("seconds", 86400);
         mongoOplogGlobalParams.ns = getParam("oplogns");
+        mongoOplogGlobalParams.numWriterThreads = getParam("numWriterThreads", 1);
+        if (mongoOplogGlobalParams.numWriterThreads < 1) {
+            return Status(ErrorCodes::BadValue, "numWriterThreads must be positive");
+        }
 
         return Status::OK();
     }
@@ -376,6 +376,20 @@ namespace {
                 ASSERT_EQUALS(iterator->_positionalStart, -1);
                 ASSERT_EQUALS(iterator->_positionalEnd, -1);
             }
+            else if (iterator->_dottedName == "numWriterThreads") {
+                ASSERT_EQUALS(iterator->_singleName, "numWriterThreads");
+                ASSERT_EQUALS(iterator->_type, moe::Int);
+                ASSERT_EQUALS(iterator->_description,
+                              "number of connections to apply ops with at once, default 1");
+                ASSERT_EQUALS(iterator->_isVisible, true);
+                moe::Value defaultVal(1);
+                ASSERT_TRUE(iterator->_default.equal(defaultVal));
+                ASSERT_TRUE(iterator->_implicit.isEmpty());
+                ASSERT_EQUALS(iterator->_isComposing, false);
+                ASSERT_EQUALS(iterator->_sources, moe::SourceAll);
+                ASSERT_EQUALS(iterator->_positionalStart, -1);
+                ASSERT_EQUALS(iterator->_positionalEnd, -1);
+            }
 #ifdef MONGO_SSL
             else if (iterator->_dottedName == "ssl") {
                 ASSERT_EQUALS(iterator->_singleName, "ssl");
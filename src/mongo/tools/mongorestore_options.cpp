@@ -72,6 +72,10 @@ namespace mongo {
         options->addOptionChaining("w", "w", moe::Int, "minimum number of replicas per write")
                                   .setDefault(moe::Value(0));
 
+        options->addOptionChaining("numParallelCollections", "numParallelCollections,j",
+                moe::Int, "number of collections to restore at once, default 1")
+                                  .setDefault(moe::Value(1));
+
         options->addOptionChaining("dir", "dir", moe::String, "directory to restore from")
                                   .hidden()
                                   .setDefault(moe::Value(std::string("dump")))
@@ -124,6 +128,10 @@ namespace mongo {
         mongoRestoreGlobalParams.restoreOptions = !hasParam("noOptionsRestore");
         mongoRestoreGlobalParams.restoreIndexes = !hasParam("noIndexRestore");
         mongoRestoreGlobalParams.w = getParam( "w" , 0 );
+        mongoRestoreGlobalParams.numParallelCollections = getParam("numParallelCollections", 1);
+        if (mongoRestoreGlobalParams.numParallelCollections < 1) {
+            return Status(ErrorCodes::BadValue, "numParallelCollections must be positive");
+        }
         mongoRestoreGlobalParams.oplogReplay = hasParam("oplogReplay");
         mongoRestoreGlobalParams.oplogLimit = getParam("oplogLimit", "");
 
@@ -33,6 +33,7 @@ namespace mongo {
         bool restoreOptions;
         bool restoreIndexes;
         int w;
+        int numParallelCollections;
         std::string restoreDirectory;
     };
 
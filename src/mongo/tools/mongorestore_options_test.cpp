@@ -460,6 +460,20 @@ namespace {
                 ASSERT_EQUALS(iterator->_positionalStart, -1);
                 ASSERT_EQUALS(iterator->_positionalEnd, -1);
             }
+            else if (iterator->_dottedName == "numParallelCollections") {
+                ASSERT_EQUALS(iterator->_singleName, "numParallelCollections,j");
+                ASSERT_EQUALS(iterator->_type, moe::Int);
+                ASSERT_EQUALS(iterator->_description,
+                              "number of collections to restore at once, default 1");
+                ASSERT_EQUALS(iterator->_isVisible, true);
+                moe::Value defaultVal(1);
+                ASSERT_TRUE(iterator->_default.equal(defaultVal));
+                ASSERT_TRUE(iterator->_implicit.isEmpty());
+                ASSERT_EQUALS(iterator->_isComposing, false);
+                ASSERT_EQUALS(iterator->_sources, moe::SourceAll);
+                ASSERT_EQUALS(iterator->_positionalStart, -1);
+                ASSERT_EQUALS(iterator->_positionalEnd, -1);
+            }
             else if (iterator->_dottedName == "dir") {
                 ASSERT_EQUALS(iterator->_singleName, "dir");
                 ASSERT_EQUALS(iterator->_type, moe::String);
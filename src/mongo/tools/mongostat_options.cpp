@@ -54,6 +54,8 @@ namespace mongo {
                                   .setSources(moe::SourceCommandLine)
                                   .positional(1, 1);
 
+        options->addOptionChaining("sleepMillis", "sleepMillis", moe::Int,
+                "milliseconds to sleep between samples, instead of the sleep time");
 
         return Status::OK();
     }
@@ -130,6 +132,8 @@ namespace mongo {
         mongoStatGlobalParams.showHeaders = !hasParam("noheaders");
         mongoStatGlobalParams.rowCount = getParam("rowcount", 0);
         mongoStatGlobalParams.sleep = getParam("sleep", 1);
+        mongoStatGlobalParams.sleepMillis = getParam("sleepMillis",
+                                                     mongoStatGlobalParams.sleep * 1000);
         mongoStatGlobalParams.allFields = hasParam("all");
 
         // Make the default db "admin" if it was not explicitly set
@@ -144,6 +148,11 @@ namespace mongo {
                           "Error parsing command line: --sleep must be greater than 0");
         }
 
+        if (mongoStatGlobalParams.sleepMillis <= 0) {
+            return Status(ErrorCodes::BadValue,
+                          "Error parsing command line: --sleepMillis must be greater than 0");
+        }
+
         if (mongoStatGlobalParams.rowCount < 0) {
             return Status(ErrorCodes::BadValue,
                           "Error parsing command line: --rowcount (-n) can't be negative");
@@ -33,6 +33,7 @@ namespace mongo {
         bool many;
         bool allFields;
         int sleep;
+        int sleepMillis; // between samples, from --sleepMillis or the sleep time
         std::string url;
     };
 
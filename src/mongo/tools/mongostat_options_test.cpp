@@ -352,6 +352,19 @@ namespace {
                 ASSERT_EQUALS(iterator->_positionalStart, 1);
                 ASSERT_EQUALS(iterator->_positionalEnd, 1);
             }
+            else if (iterator->_dottedName == "sleepMillis") {
+                ASSERT_EQUALS(iterator->_singleName, "sleepMillis");
+                ASSERT_EQUALS(iterator->_type, moe::Int);
+                ASSERT_EQUALS(iterator->_description,
+                              "milliseconds to sleep between samples, instead of the sleep time");
+                ASSERT_EQUALS(iterator->_isVisible, true);
+                ASSERT_TRUE(iterator->_default.isEmpty());
+                ASSERT_TRUE(iterator->_implicit.isEmpty());
+                ASSERT_EQUALS(iterator->_isComposing, false);
+                ASSERT_EQUALS(iterator->_sources, moe::SourceAll);
+                ASSERT_EQUALS(iterator->_positionalStart, -1);
+                ASSERT_EQUALS(iterator->_positionalEnd, -1);
+            }
 #ifdef MONGO_SSL
             else if (iterator->_dottedName == "ssl") {
                 ASSERT_EQUALS(iterator->_singleName, "ssl");
@@ -16,14 +16,20 @@
 
 #include "mongo/pch.h"
 
+#include <boost/thread/thread.hpp>
 #include <fstream>
 #include <iostream>
+#include <map>
 
 #include "mongo/db/json.h"
+#include "mongo/db/keypattern.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/oplogreader.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/tools/mongooplog_options.h"
 #include "mongo/tools/tool.h"
 #include "mongo/util/options_parser/option_section.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 using namespace mongo;
 
@@ -35,6 +41,156 @@ public:
         printMongoOplogHelp(&out);
     }
 
+    // The most ops, and about the most bytes of them, applied in a batch.  The ops a writer
+    // gets go in one applyOps, which has to fit in a command.
+    static const size_t kBatchLimitOperations = 5000;
+    static const int kBatchLimitBytes = 8 * 1024 * 1024;
+
+    /**
+     * Whether the ops on ns can be given to writers by _id, as a secondary does: not so for a
+     * capped collection, or one with a unique index other than _id.  Looked at on the server
+     * applied to, and remembered until the next command or index build.
+     */
+    bool canPartitionById(const string& ns) {
+        map<string, bool>::const_iterator it = _partitionById.find(ns);
+        if (it != _partitionById.end()) {
+            return it->second;
+        }
+
+        bool can = true;
+        try {
+            const NamespaceString nss(ns);
+            BSONObj info = conn().findOne(nss.db().toString() + ".system.namespaces",
+                                          BSON("name" << ns));
+            if (info["options"]["capped"].trueValue()) {
+                can = false;
+            }
+            auto_ptr<DBClientCursor> indexes = conn().getIndexes(ns);
+            while (can && indexes->more()) {
+                BSONObj index = indexes->next();
+                if (index["unique"].trueValue() &&
+                    !KeyPattern::isIdKeyPattern(index["key"].Obj())) {
+                    can = false;
+                }
+            }
+        }
+        catch (const DBException& e) {
+            if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(2))) {
+                toolInfoLog() << "not partitioning the ops on " << ns << " by _id: " << e.what()
+                              << std::endl;
+            }
+            can = false;
+        }
+        _partitionById[ns] = can;
+        return can;
+    }
+
+    /** the _id of the document an insert, update or delete is on; EOO otherwise */
+    static BSONElement idOfOp(const BSONObj& op) {
+        switch (op["op"].valuestrsafe()[0]) {
+        case 'i':
+        case 'd':
+            return op["o"]["_id"];
+        case 'u':
+            return op["o2"]["_id"];
+        default:
+            return BSONElement();
+        }
+    }
+
+    /**
+     * Commands and index builds are applied in batches of their own, after the ops before them
+     * and before the ops after them.
+     */
+    static bool isBarrier(const BSONObj& op) {
+        return op["op"].String() == "c" ||
+            NamespaceString(op["ns"].String()).coll() == "system.indexes";
+    }
+
+    /** Applies ops in order, with one applyOps; returns the number of them that failed. */
+    int applyOps(DBClientBase& c, const vector<BSONObj>& ops, bool print) {
+        if (ops.empty()) {
+            return 0;
+        }
+
+        BSONObjBuilder b;
+        BSONArrayBuilder updates(b.subarrayStart("applyOps"));
+        for (vector<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+            updates.append(*it);
+        }
+        updates.done();
+
+        BSONObj res;
+        bool ok = c.runCommand("admin", b.obj(), res);
+        if (!ok) {
+            toolError() << res << std::endl;
+            if (res["results"].type() != Array) {
+                return ops.size();
+            }
+            int failed = 0;
+            BSONObjIterator i(res["results"].Obj());
+            while (i.more()) {
+                if (!i.next().trueValue()) {
+                    failed++;
+                }
+            }
+            return failed;
+        }
+        if (print) {
+            toolInfoLog() << res << std::endl;
+        }
+        return 0;
+    }
+
+    void applyOpsThread(DBClientBase* c, const vector<BSONObj>* ops, AtomicUInt32* failures) {
+        try {
+            failures->fetchAndAdd(applyOps(*c, *ops, false));
+        }
+        catch (const DBException& e) {
+            toolError() << "error applying ops: " << e.what() << std::endl;
+            failures->fetchAndAdd(ops->size());
+        }
+    }
+
+    /**
+     * Applies a batch of ops, those on one document in the order they came in.  With several
+     * writers the ops on different documents, or on different collections, may go in in any
+     * order.  Returns the number of ops that failed.
+     */
+    int applyBatch(const vector<BSONObj>& batch, bool print) {
+        if (_writers.size() == 1 || batch.size() == 1) {
+            return applyOps(conn(), batch, print);
+        }
+
+        vector< vector<BSONObj> > writerVectors(_writers.size() + 1);
+        for (vector<BSONObj>::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+            const BSONElement e = it->getField("ns");
+            const char* ns = e.valuestr();
+            uint32_t hash = 0;
+            MurmurHash3_x86_32(ns, e.valuestrsize(), 0, &hash);
+
+            const BSONElement id = idOfOp(*it);
+            if (!id.eoo() && canPartitionById(ns)) {
+                MurmurHash3_x86_32(id.value(), id.valuesize(), hash, &hash);
+            }
+            writerVectors[hash % (_writers.size() + 1)].push_back(*it);
+        }
+
+        // the main thread applies the ops of writerVectors[0] on conn()
+        AtomicUInt32 failures;
+        boost::thread_group threads;
+        for (size_t i = 0; i < _writers.size(); i++) {
+            if (!writerVectors[i + 1].empty()) {
+                threads.create_thread(boost::bind(&OplogTool::applyOpsThread, this,
+                                                  _writers[i].get(), &writerVectors[i + 1],
+                                                  &failures));
+            }
+        }
+        applyOpsThread(&conn(), &writerVectors[0], &failures);
+        threads.join_all();
+        return failures.load();
+    }
+
     int run() {
 
         Client::initThread( "oplogreplay" );
@@ -47,12 +203,24 @@ public:
 
         toolInfoLog() << "connected" << std::endl;
 
+        // The ops are applied over --numWriterThreads connections, conn() and these.
+        const int numWriters =
+            toolGlobalParams.useDirectClient ? 1 : mongoOplogGlobalParams.numWriterThreads;
+        for (int i = 1; i < numWriters; i++) {
+            _writers.push_back(boost::shared_ptr<DBClientBase>(newConnection()));
+        }
+
         OpTime start(time(0) - mongoOplogGlobalParams.seconds, 0);
         toolInfoLog() << "starting from " << start.toStringPretty() << std::endl;
 
         r.tailingQueryGTE(mongoOplogGlobalParams.ns.c_str(), start);
 
         int num = 0;
+        long long failures = 0;
+        time_t lastReport = time(0);
+        vector<BSONObj> batch;
+        int batchBytes = 0;
+        bool print = false;
         while ( r.more() ) {
             BSONObj o = r.next();
             if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(2))) {
@@ -66,32 +234,55 @@ public:
             }
                 
 
-            bool print = ++num % 100000 == 0;
-            if (print) {
+            if (++num % 100000 == 0) {
+                print = true;
                 toolInfoLog() << num << "\t" << o << std::endl;
             }
             
-            if ( o["op"].String() == "n" )
+            if ( o["op"].String() != "n" ) {
+                if (isBarrier(o)) {
+                    failures += applyBatch(batch, print);
+                    batch.clear();
+                    batchBytes = 0;
+
+                    batch.push_back(o.getOwned());
+                    failures += applyBatch(batch, print);
+                    batch.clear();
+                    _partitionById.clear();
+                }
+                else {
+                    batch.push_back(o.getOwned());
+                    batchBytes += o.objsize();
+                }
+            }
+
+            // Whatever the cursor has read is applied together, so long as it isn't too much.
+            if (r.moreInCurrentBatch() && batch.size() < kBatchLimitOperations &&
+                batchBytes < kBatchLimitBytes) {
                 continue;
+            }
 
-            BSONObjBuilder b( o.objsize() + 32 );
-            BSONArrayBuilder updates( b.subarrayStart( "applyOps" ) );
-            updates.append( o );
-            updates.done();
+            failures += applyBatch(batch, print);
+            batch.clear();
+            batchBytes = 0;
+            print = false;
 
-            BSONObj c = b.obj();
-            
-            BSONObj res;
-            bool ok = conn().runCommand( "admin" , c , res );
-            if (!ok) {
-                toolError() << res << std::endl;
-            } else if (print) {
-                toolInfoLog() << res << std::endl;
+            if (time(0) - lastReport >= 10) {
+                lastReport = time(0);
+                const unsigned behind = lastReport - o["ts"]._opTime().getSecs();
+                toolInfoLog() << "read " << num << " ops, " << failures << " failed, "
+                              << behind << " seconds behind" << std::endl;
             }
         }
 
+        failures += applyBatch(batch, print);
+
         return 0;
     }
+
+private:
+    vector< boost::shared_ptr<DBClientBase> > _writers;
+    map<string, bool> _partitionById;
 };
 
 REGISTER_MONGO_TOOL(OplogTool);
@@ -20,6 +20,7 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include <fcntl.h>
 #include <fstream>
 #include <set>
@@ -37,6 +38,9 @@ using namespace mongo;
 
 namespace {
     const char* OPLOG_SENTINEL = "$oplog";  // compare by ptr not strcmp
+
+    // Documents are inserted in batches of about this many bytes.
+    const int kInsertBatchBytes = 8 * 1024 * 1024;
 }
 
 class Restore : public BSONTool {
@@ -50,7 +54,9 @@ public:
     scoped_ptr<OpTime> _oplogLimitTS; // for oplog replay (limit)
     int _oplogEntrySkips; // oplog entries skipped
     int _oplogEntryApplies; // oplog entries applied
-    Restore() : BSONTool() { }
+    vector<BSONObj> _batch; // documents not yet inserted into _curns
+    int _batchBytes;
+    Restore() : BSONTool(), _batchBytes(0) { }
 
     virtual void printHelp(ostream& out) {
         printMongoRestoreHelp(&out);
@@ -169,6 +175,7 @@ public:
          */
         drillDown(root, toolGlobalParams.db != "", toolGlobalParams.coll != "",
                   !(_oplogLimitTS.get() == NULL), true);
+        restoreQueuedCollections();
 
         // should this happen for oplog replay as well?
         string err = conn().getLastError(toolGlobalParams.db == "" ? "admin" : toolGlobalParams.db);
@@ -302,6 +309,19 @@ public:
             exit(EXIT_FAILURE);
         }
 
+        // System collections wait for the ones before them, as system.indexes.bson has to.
+        if (mongoRestoreGlobalParams.numParallelCollections > 1 &&
+            !startsWith(oldCollName, "system.")) {
+            _queued.push_back(QueuedCollection(root, ns, oldCollName));
+            return;
+        }
+        restoreQueuedCollections();
+        restoreCollection(root, ns, oldCollName);
+    }
+
+    void restoreCollection( const boost::filesystem::path& root,
+                            const string& ns,
+                            const string& oldCollName ) {
         toolInfoLog() << "\tgoing into namespace [" << ns << "]" << std::endl;
 
         if (mongoRestoreGlobalParams.drop) {
@@ -355,6 +375,7 @@ public:
         }
 
         processFile( root );
+        flushInserts();
         if (mongoRestoreGlobalParams.drop && root.leaf() == "system.users.bson") {
             // Delete any users that used to exist but weren't in the dump file
             for (set<string>::iterator it = _users.begin(); it != _users.end(); ++it) {
@@ -365,10 +386,13 @@ public:
         }
 
         if (mongoRestoreGlobalParams.restoreIndexes && metadataObject.hasField("indexes")) {
+            // all in one insert, which the server builds with a single scan of the collection
             vector<BSONElement> indexes = metadataObject["indexes"].Array();
+            vector<BSONObj> indexObjs;
             for (vector<BSONElement>::iterator it = indexes.begin(); it != indexes.end(); ++it) {
-                createIndex((*it).Obj(), false);
+                indexObjs.push_back((*it).Obj());
             }
+            createIndexes(indexObjs, false);
         }
     }
 
@@ -412,19 +436,130 @@ public:
             _users.erase(obj["user"].String());
         }
         else {
-            conn().insert( _curns , obj );
+            _batch.push_back( obj.getOwned() );
+            _batchBytes += obj.objsize();
+            if (_batchBytes >= kInsertBatchBytes) {
+                flushInserts();
+            }
+        }
+    }
 
-            // wait for insert to propagate to "w" nodes (doesn't warn if w used without replset)
-            if (mongoRestoreGlobalParams.w > 0) {
-                string err = conn().getLastError(_curdb, false, false, mongoRestoreGlobalParams.w);
-                if (!err.empty()) {
-                    toolError() << err << std::endl;
+private:
+
+    /** A collection file left to restore, with others, on several threads at once. */
+    struct QueuedCollection {
+        QueuedCollection( const boost::filesystem::path& root,
+                          const string& ns,
+                          const string& oldCollName )
+            : root( root ), ns( ns ), oldCollName( oldCollName ) {}
+
+        boost::filesystem::path root;
+        string ns;
+        string oldCollName;
+    };
+
+    /** The queued collections being restored, shared among the threads restoring them. */
+    struct RestoreState {
+        explicit RestoreState( const vector<QueuedCollection>& queued )
+            : queued( queued ), m( "restoreState" ), next( 0 ), errCode( 0 ) {}
+
+        const vector<QueuedCollection>& queued;
+        mongo::mutex m; // guards the rest
+        size_t next;
+        string errmsg;
+        int errCode;
+    };
+
+    vector<QueuedCollection> _queued;
+
+    /**
+     * Inserts the batched documents, carrying on past any that fail, as inserting them one at
+     * a time did, and waits just once for the write concern.
+     */
+    void flushInserts() {
+        if (_batch.empty()) {
+            return;
+        }
+
+        conn().insert( _curns , _batch , InsertOption_ContinueOnError );
+        _batch.clear();
+        _batchBytes = 0;
+
+        // wait for inserts to propagate to "w" nodes (doesn't warn if w used without replset)
+        if (mongoRestoreGlobalParams.w > 0) {
+            string err = conn().getLastError(_curdb, false, false, mongoRestoreGlobalParams.w);
+            if (!err.empty()) {
+                toolError() << err << std::endl;
+            }
+        }
+    }
+
+    static void recordError( RestoreState* state, const DBException& e ) {
+        mongo::mutex::scoped_lock lk( state->m );
+        if ( state->errmsg.empty() ) {
+            state->errmsg = e.toString();
+            state->errCode = e.getCode();
+        }
+    }
+
+    static void restoreCollections( Restore* restore, RestoreState* state ) {
+        while ( true ) {
+            size_t i;
+            {
+                mongo::mutex::scoped_lock lk( state->m );
+                if ( state->next == state->queued.size() || !state->errmsg.empty() ) {
+                    return;
                 }
+                i = state->next++;
+            }
+
+            const QueuedCollection& q = state->queued[i];
+            try {
+                restore->restoreCollection( q.root, q.ns, q.oldCollName );
+            }
+            catch ( DBException& e ) {
+                recordError( state, e );
+                return;
             }
         }
     }
 
-private:
+    void restoreCollectionsThread( RestoreState* state ) {
+        // a Restore of its own, for the collection being restored and the connection
+        Restore restore;
+        try {
+            restore._conn = newConnection();
+        }
+        catch ( DBException& e ) {
+            recordError( state, e );
+            return;
+        }
+        restore.initFilter();
+        restoreCollections( &restore, state );
+    }
+
+    /** Restores the queued collections, numParallelCollections at once. */
+    void restoreQueuedCollections() {
+        if (_queued.empty()) {
+            return;
+        }
+
+        RestoreState state( _queued );
+        const size_t numThreads = toolGlobalParams.useDirectClient ? 1 :
+            std::min( static_cast<size_t>( mongoRestoreGlobalParams.numParallelCollections ),
+                      _queued.size() );
+        boost::thread_group threads;
+        for ( size_t i = 1; i < numThreads; i++ ) {
+            threads.create_thread( boost::bind( &Restore::restoreCollectionsThread, this,
+                                                &state ) );
+        }
+        restoreCollections( this, &state );
+        threads.join_all();
+        _queued.clear();
+        if ( !state.errmsg.empty() ) {
+            uasserted( state.errCode, state.errmsg );
+        }
+    }
 
     BSONObj parseMetadataFile(string filePath) {
         long long fileSize = boost::filesystem::file_size(filePath);
@@ -522,25 +657,37 @@ private:
        If keepCollName is true, however, we keep the same collection name that's in the index object.
      */
     void createIndex(BSONObj indexObj, bool keepCollName) {
-        BSONObjBuilder bo;
-        BSONObjIterator i(indexObj);
-        while ( i.more() ) {
-            BSONElement e = i.next();
-            if (strcmp(e.fieldName(), "ns") == 0) {
-                NamespaceString n(e.String());
-                string s = _curdb + "." + (keepCollName ? n.coll().toString() : _curcoll);
-                bo.append("ns", s);
+        createIndexes(vector<BSONObj>(1, indexObj), keepCollName);
+    }
+
+    void createIndexes(const vector<BSONObj>& indexObjs, bool keepCollName) {
+        if (indexObjs.empty()) {
+            return;
+        }
+
+        vector<BSONObj> specs;
+        for (vector<BSONObj>::const_iterator it = indexObjs.begin(); it != indexObjs.end(); ++it) {
+            BSONObjBuilder bo;
+            BSONObjIterator i(*it);
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                if (strcmp(e.fieldName(), "ns") == 0) {
+                    NamespaceString n(e.String());
+                    string s = _curdb + "." + (keepCollName ? n.coll().toString() : _curcoll);
+                    bo.append("ns", s);
+                }
+                // Remove index version number
+                else if (strcmp(e.fieldName(), "v") != 0 || mongoRestoreGlobalParams.keepIndexVersion) {
+                    bo.append(e);
+                }
             }
-            // Remove index version number
-            else if (strcmp(e.fieldName(), "v") != 0 || mongoRestoreGlobalParams.keepIndexVersion) {
-                bo.append(e);
+            BSONObj o = bo.obj();
+            if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(0))) {
+                toolInfoLog() << "\tCreating index: " << o << std::endl;
             }
+            specs.push_back(o);
         }
-        BSONObj o = bo.obj();
-        if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(0))) {
-            toolInfoLog() << "\tCreating index: " << o << std::endl;
-        }
-        conn().insert( _curdb + ".system.indexes" ,  o );
+        conn().insert( _curdb + ".system.indexes" ,  specs );
 
         // We're stricter about errors for indexes than for regular data
         BSONObj err = conn().getLastErrorDetailed(_curdb, false, false, mongoRestoreGlobalParams.w);
@@ -556,7 +703,7 @@ private:
                     errCode = str::stream() << err["code"].numberInt();
                 }
 
-                toolError() << "Error creating index " << o["ns"].String() << ": "
+                toolError() << "Error creating index " << specs[0]["ns"].String() << ": "
                           << errCode << " " << err["err"] << std::endl;
             }
 
@@ -31,9 +31,12 @@
 #undef max
 #endif
 
+#include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include <ctype.h>
 #include <errno.h>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <pcap.h>
@@ -55,7 +58,10 @@
 #include "mongo/db/dbmessage.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/mmap.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/queue.h"
 #include "mongo/util/text.h"
+#include "mongo/util/time_support.h"
 
 using namespace std;
 using mongo::Message;
@@ -66,6 +72,8 @@ using mongo::BufBuilder;
 using mongo::DBClientConnection;
 using mongo::QueryResult;
 using mongo::MemoryMappedFile;
+using mongo::BlockingQueue;
+using mongo::curTimeMicros64;
 
 #define SNAP_LEN 65535
 
@@ -156,6 +164,12 @@ map< Connection, boost::shared_ptr<DBClientConnection> > forwarder;
 map< Connection, long long > lastCursor;
 map< Connection, map< long long, long long > > mapCursor;
 
+/* --record: the operations seen, with when they were seen, as a stream of BSON objects */
+ofstream recordFile;
+long long packetMicros = 0;
+long long firstRecordedMicros = -1;
+map< Connection, int > recordedConnection;
+
 void processMessage( Connection& c , Message& d );
 
 void got_packet(u_char *args, const struct pcap_pkthdr *header, const u_char *packet) {
@@ -206,6 +220,7 @@ void got_packet(u_char *args, const struct pcap_pkthdr *header, const u_char *pa
     }
 
     expectedSeq[ c ] = ntohl( tcp->th_seq ) + size_payload;
+    packetMicros = header->ts.tv_sec * 1000000LL + header->ts.tv_usec;
 
     Message m;
 
@@ -267,9 +282,47 @@ public:
     }
 };
 
+/**
+ * Appends a request to the --record file, with the microseconds since the first one recorded
+ * and a number for the client connection it came over.  Of the replies only the cursors they
+ * open are kept, so a replay can tell which cursor a later getMore means.
+ */
+void recordMessage( Connection& c , Message& m ) {
+    bool reply = ( m.operation() == mongo::opReply );
+    mongo::BSONObjBuilder b;
+    if ( reply ) {
+        QueryResult *qr = (QueryResult *) m.singleData();
+        if ( qr->cursorId == 0 || ( qr->resultFlags() & mongo::ResultFlag_CursorNotFound ) )
+            return;
+    }
+    Connection client = reply ? c.reverse() : c;
+    map< Connection, int >::iterator i = recordedConnection.find( client );
+    if ( i == recordedConnection.end() ) {
+        int id = recordedConnection.size();
+        i = recordedConnection.insert( make_pair( client, id ) ).first;
+    }
+    if ( firstRecordedMicros < 0 )
+        firstRecordedMicros = packetMicros;
+    b.append( "t", packetMicros - firstRecordedMicros );
+    b.append( "c", i->second );
+    if ( reply ) {
+        QueryResult *qr = (QueryResult *) m.singleData();
+        b.append( "reply", m.header()->responseTo );
+        b.append( "cursor", qr->cursorId );
+    }
+    else {
+        b.appendBinData( "m", m.header()->len, mongo::BinDataGeneral, m.singleData() );
+    }
+    BSONObj o = b.done();
+    recordFile.write( o.objdata(), o.objsize() );
+}
+
 void processMessage( Connection& c , Message& m ) {
     AuditingDbMessage d(m);
 
+    if ( recordFile.is_open() )
+        recordMessage( c , m );
+
     if ( m.operation() == mongo::opReply )
         out() << " - " << (unsigned)m.header()->responseTo;
     out() << '\n';
@@ -420,11 +473,218 @@ void processDiagLog( const char * file ) {
     f.close();
 }
 
+/* what one replay thread saw: microseconds per operation, by type */
+struct ReplayStats {
+    ReplayStats() : errors( 0 ) {}
+    map< string, vector< long long > > micros;
+    long long errors;
+};
+
+string replayOpType( Message& m ) {
+    switch( m.operation() ) {
+    case mongo::dbQuery: {
+        DbMessage d( m );
+        return mongoutils::str::endsWith( d.getns(), ".$cmd" ) ? "command" : "query";
+    }
+    case mongo::dbGetMore: return "getmore";
+    case mongo::dbInsert: return "insert";
+    case mongo::dbUpdate: return "update";
+    case mongo::dbDelete: return "delete";
+    case mongo::dbKillCursors: return "killcursors";
+    default: return "other";
+    }
+}
+
+/**
+ * Issues the operations of the recorded connections given to this thread, each over a
+ * connection of its own, in their order and no sooner than --speed allows.  Cursor ids in
+ * getMores and killCursors are mapped from the recorded server's to the target's.
+ */
+void replayThread( BlockingQueue< BSONObj >* queue, double speed, unsigned long long start,
+                   ReplayStats* stats ) {
+    map< int, boost::shared_ptr< DBClientConnection > > conns;
+    map< int, map< int, long long > > opened;             // request id -> target cursor
+    map< int, map< long long, long long > > cursors;      // recorded cursor -> target cursor
+    while( true ) {
+        BSONObj r = queue->blockingPop();
+        if ( r.isEmpty() )
+            break;
+        int c = r[ "c" ].numberInt();
+
+        if ( r.hasField( "reply" ) ) {
+            map< int, long long >::iterator i = opened[ c ].find( r[ "reply" ].numberInt() );
+            if ( i != opened[ c ].end() ) {
+                cursors[ c ][ r[ "cursor" ].numberLong() ] = i->second;
+                opened[ c ].erase( i );
+            }
+            continue;
+        }
+
+        if ( speed > 0 ) {
+            unsigned long long due = start + (unsigned long long)( r[ "t" ].numberLong() / speed );
+            unsigned long long now = curTimeMicros64();
+            if ( due > now )
+                mongo::sleepmicros( due - now );
+        }
+
+        int len;
+        const char *data = r[ "m" ].binData( len );
+        char *buf = (char *) malloc( len );
+        memcpy( buf, data, len );
+        Message m( buf, true );
+        int requestId = m.header()->id;
+        long long recordedCursor = 0;
+        if ( m.operation() == mongo::dbGetMore ) {
+            DbMessage d( m );
+            d.pullInt();
+            long long &cId = d.pullInt64();
+            recordedCursor = cId;
+            cId = cursors[ c ][ cId ];
+        }
+        else if ( m.operation() == mongo::dbKillCursors ) {
+            int *x = (int *) m.singleData()->_data;
+            x++; // reserved
+            int n = *x++;
+            long long *ids = (long long *) x;
+            for ( int i = 0; i < n; ++i ) {
+                long long recorded = ids[ i ];
+                ids[ i ] = cursors[ c ][ recorded ];
+                cursors[ c ].erase( recorded );
+            }
+        }
+
+        string type = replayOpType( m );
+        try {
+            boost::shared_ptr< DBClientConnection > &conn = conns[ c ];
+            if ( !conn ) {
+                conn.reset( new DBClientConnection( true ) );
+                conn->connect( forwardAddress );
+            }
+            unsigned long long before = curTimeMicros64();
+            if ( m.operation() == mongo::dbQuery || m.operation() == mongo::dbGetMore ) {
+                Message response;
+                if ( !conn->port().call( m, response ) ) {
+                    stats->errors++;
+                    conn.reset();
+                    continue;
+                }
+                QueryResult *qr = (QueryResult *) response.singleData();
+                long long cursorId = qr->cursorId;
+                if ( qr->resultFlags() & ( mongo::ResultFlag_CursorNotFound |
+                                           mongo::ResultFlag_ErrSet ) ) {
+                    stats->errors++;
+                    cursorId = 0;
+                }
+                if ( m.operation() == mongo::dbQuery && cursorId )
+                    opened[ c ][ requestId ] = cursorId;
+                else if ( m.operation() == mongo::dbGetMore && !cursorId )
+                    cursors[ c ].erase( recordedCursor );
+            }
+            else {
+                conn->port().say( m );
+            }
+            stats->micros[ type ].push_back( curTimeMicros64() - before );
+        }
+        catch ( mongo::DBException &e ) {
+            cerr << "error replaying " << type << ": " << e.what() << endl;
+            stats->errors++;
+            conns[ c ].reset();
+        }
+    }
+}
+
+long long percentile( const vector< long long > &sorted, int p ) {
+    return sorted[ min( sorted.size() - 1, sorted.size() * p / 100 ) ];
+}
+
+/**
+ * Re-issues what --record captured against --forward, the recorded connections spread over
+ * 'threads' threads, and prints the latency of each type of operation.
+ */
+int replayRecording( const char *file, double speed, int threads ) {
+    ifstream in( file, ios_base::in | ios_base::binary );
+    if ( !in ) {
+        cerr << "error opening recording: " << file << endl;
+        return -1;
+    }
+
+    vector< boost::shared_ptr< BlockingQueue< BSONObj > > > queues;
+    vector< ReplayStats > stats( threads );
+    boost::thread_group workers;
+    unsigned long long start = curTimeMicros64();
+    for ( int i = 0; i < threads; ++i ) {
+        queues.push_back( boost::shared_ptr< BlockingQueue< BSONObj > >(
+                              new BlockingQueue< BSONObj >( 1000 ) ) );
+        workers.create_thread( boost::bind( replayThread, queues.back().get(), speed, start,
+                                            &stats[ i ] ) );
+    }
+
+    long long n = 0;
+    vector< char > buf;
+    int size;
+    while ( in.read( (char *) &size, sizeof( size ) ) ) {
+        if ( size < 5 || size > mongo::BufferMaxSize ) {
+            cerr << "invalid object size " << size << " after " << n << " operations" << endl;
+            break;
+        }
+        buf.resize( size );
+        memcpy( &buf[ 0 ], &size, sizeof( size ) );
+        if ( !in.read( &buf[ sizeof( size ) ], size - sizeof( size ) ) ) {
+            cerr << "recording ends part way through an operation" << endl;
+            break;
+        }
+        BSONObj r = BSONObj( &buf[ 0 ] ).getOwned();
+        queues[ r[ "c" ].numberInt() % threads ]->push( r );
+        if ( !r.hasField( "reply" ) )
+            ++n;
+    }
+    for ( int i = 0; i < threads; ++i )
+        queues[ i ]->push( BSONObj() );
+    workers.join_all();
+
+    double secs = ( curTimeMicros64() - start ) / 1000000.0;
+    map< string, vector< long long > > micros;
+    long long errors = 0;
+    for ( int i = 0; i < threads; ++i ) {
+        for ( map< string, vector< long long > >::iterator j = stats[ i ].micros.begin();
+              j != stats[ i ].micros.end(); ++j ) {
+            micros[ j->first ].insert( micros[ j->first ].end(), j->second.begin(), j->second.end() );
+        }
+        errors += stats[ i ].errors;
+    }
+
+    cout << "replayed " << n << " operations in " << secs << " seconds, " << errors
+         << " errors" << endl;
+    cout << "latency in microseconds:" << endl;
+    for ( map< string, vector< long long > >::iterator i = micros.begin(); i != micros.end(); ++i ) {
+        vector< long long > &v = i->second;
+        sort( v.begin(), v.end() );
+        cout << "\t" << i->first << "  n: " << v.size() << "  p50: " << percentile( v, 50 )
+             << "  p95: " << percentile( v, 95 ) << "  p99: " << percentile( v, 99 )
+             << "  max: " << v.back() << endl;
+    }
+    return errors ? -1 : 0;
+}
+
 void usage() {
     cout <<
-         "Usage: mongosniff [--help] [--forward host:port] [--source (NET <interface> | (FILE | DIAGLOG) <filename>)] [<port0> <port1> ... ]\n"
+         "Usage: mongosniff [--help] [--forward host:port] [--source (NET <interface> | (FILE | DIAGLOG) <filename>)] [--record <filename>] [<port0> <port1> ... ]\n"
+         "       mongosniff --replay <filename> --forward host:port [--speed <x>] [--threads <n>]\n"
          "--forward       Forward all parsed request messages to mongod instance at \n"
          "                specified host:port\n"
+         "--record        Write the request messages seen, and when they were seen, to\n"
+         "                the named file, for --replay.  Messages from a diaglog have\n"
+         "                no times, and replay as fast as they can.\n"
+         "--replay        Issue the requests in a --record file against the --forward\n"
+         "                host, with the timing they were recorded with, and print the\n"
+         "                latency percentiles of each type of operation.  Writes are\n"
+         "                timed as far as sending them; the getLastError commands that\n"
+         "                follow them are timed as commands.\n"
+         "--speed         With --replay, run this many times faster than recorded; 0\n"
+         "                issues each request as soon as the one before it finishes.\n"
+         "                Default 1.\n"
+         "--threads       With --replay, issue requests from this many threads, the\n"
+         "                recorded connections spread among them.  Default 1.\n"
          "--source        Source of traffic to sniff, either a network interface or a\n"
          "                file containing previously captured packets in pcap format,\n"
          "                or a file containing output from mongod's --diaglog option.\n"
@@ -463,6 +723,9 @@ int toolMain(int argc, char **argv, char** envp) {
     bool replay = false;
     bool diaglog = false;
     const char *file = 0;
+    const char *replayFile = 0;
+    double speed = 1;
+    int threads = 1;
 
     vector< const char * > args;
     for( int i = 1; i < argc; ++i )
@@ -489,6 +752,26 @@ int toolMain(int argc, char **argv, char** envp) {
                 else
                     dev = args[ ++i ];
             }
+            else if ( arg == string( "--record" ) ) {
+                uassert( 17313 ,  "record needs a file" , args.size() > i + 1 );
+                recordFile.open( args[ ++i ], ios_base::out | ios_base::binary | ios_base::trunc );
+                if ( !recordFile ) {
+                    cerr << "error opening record file: " << args[ i ] << endl;
+                    return -1;
+                }
+            }
+            else if ( arg == string( "--replay" ) ) {
+                uassert( 17314 ,  "replay needs a file" , args.size() > i + 1 );
+                replayFile = args[ ++i ];
+            }
+            else if ( arg == string( "--speed" ) ) {
+                uassert( 17315 ,  "speed needs a value" , args.size() > i + 1 );
+                speed = atof( args[ ++i ] );
+            }
+            else if ( arg == string( "--threads" ) ) {
+                uassert( 17316 ,  "threads needs a value" , args.size() > i + 1 );
+                threads = atoi( args[ ++i ] );
+            }
             else if ( arg == string( "--objcheck" ) ) {
                 objcheck = true;
                 outPtr = &nullStream;
@@ -503,6 +786,14 @@ int toolMain(int argc, char **argv, char** envp) {
         return -1;
     }
 
+    if ( replayFile ) {
+        if ( forwardAddress.empty() || recordFile.is_open() || threads < 1 || speed < 0 ) {
+            usage();
+            return -1;
+        }
+        return replayRecording( replayFile, speed, threads );
+    }
+
     if ( !serverPorts.size() )
         serverPorts.insert( 27017 );
 
@@ -75,16 +75,25 @@ namespace mongo {
                 return e.embeddedObjectUserCheck();
             }
             BSONObj out;
-            if (!conn().simpleCommand(toolGlobalParams.db, &out, "serverStatus")) {
+            if (!_poller.poll(conn(), &out)) {
                 toolError() << "error: " << out << std::endl;
                 return BSONObj();
             }
-            return out.getOwned();
+            return out;
+        }
+
+        /** the time between two statuses by the server's clock, else the time slept */
+        static double secondsBetween( const BSONObj& prev , const BSONObj& now ) {
+            long long millis =
+                now["uptimeMillis"].numberLong() - prev["uptimeMillis"].numberLong();
+            if ( millis <= 0 )
+                millis = mongoStatGlobalParams.sleepMillis;
+            return millis / 1000.0;
         }
 
         int run() {
             _statUtil.setAll(mongoStatGlobalParams.allFields);
-            _statUtil.setSeconds(mongoStatGlobalParams.sleep);
+            _statUtil.setSeconds(mongoStatGlobalParams.sleepMillis / 1000.0);
             if (mongoStatGlobalParams.many)
                 return runMany();
             return runNormal();
@@ -142,7 +151,7 @@ namespace mongo {
 
             while (mongoStatGlobalParams.rowCount == 0 ||
                    rowNum < mongoStatGlobalParams.rowCount) {
-                sleepsecs((int)ceil(_statUtil.getSeconds()));
+                sleepmillis(mongoStatGlobalParams.sleepMillis);
                 BSONObj now;
                 try {
                     now = stats();
@@ -157,6 +166,7 @@ namespace mongo {
 
                 try {
 
+                    _statUtil.setSeconds( secondsBetween( prev , now ) );
                     BSONObj out = _statUtil.doRow( prev , now );
 
                     // adjust width up as longer 'locked db' values appear
@@ -216,7 +226,7 @@ namespace mongo {
             BSONObj authParams;
         };
 
-        static void serverThread( shared_ptr<ServerState> state , int sleepTime) {
+        static void serverThread( shared_ptr<ServerState> state , int sleepMillis ) {
             try {
                 DBClientConnection conn( true );
                 conn._logLevel = logger::LogSeverity::Debug(1);
@@ -224,6 +234,7 @@ namespace mongo {
                 if ( ! conn.connect( state->host , errmsg ) )
                     state->error = errmsg;
                 long long cycleNumber = 0;
+                ServerStatusPoller poller;
 
                 if (! (state->authParams["user"].str().empty()) )
                     conn.auth(state->authParams);
@@ -231,12 +242,12 @@ namespace mongo {
                 while ( ++cycleNumber ) {
                     try {
                         BSONObj out;
-                        if ( conn.simpleCommand( "admin" , &out , "serverStatus" ) ) {
+                        if ( poller.poll( conn , &out ) ) {
                             scoped_lock lk( state->lock );
                             state->error = "";
                             state->lastUpdate = time(0);
                             state->prev = state->now;
-                            state->now = out.getOwned();
+                            state->now = out;
                         }
                         else {
                             str::stream errorStream;
@@ -268,7 +279,7 @@ namespace mongo {
                         state->error = e.what();
                     }
 
-                    sleepsecs( sleepTime );
+                    sleepmillis( sleepMillis );
                 }
 
 
@@ -294,7 +305,7 @@ namespace mongo {
             /* For each new thread, pass in a thread state object and the delta between samples */
             state->thr.reset( new boost::thread( boost::bind( serverThread,
                                                               state,
-                                                              (int)ceil(_statUtil.getSeconds()) ) ) );
+                                                              mongoStatGlobalParams.sleepMillis ) ) );
             state->authParams = BSON(saslCommandUserFieldName << toolGlobalParams.username
                                   << saslCommandPasswordFieldName << toolGlobalParams.password
                                   << saslCommandUserDBFieldName << getAuthenticationDatabase()
@@ -387,7 +398,7 @@ namespace mongo {
             int maxLockedDbWidth = 0;
 
             while (mongoStatGlobalParams.rowCount == 0 || row < mongoStatGlobalParams.rowCount) {
-                sleepsecs( (int)ceil(_statUtil.getSeconds()) );
+                sleepmillis( mongoStatGlobalParams.sleepMillis );
 
                 // collect data
                 vector<Row> rows;
@@ -401,6 +412,7 @@ namespace mongo {
                         rows.push_back( Row( i->first ) );
                     }
                     else {
+                        _statUtil.setSeconds( secondsBetween( i->second->prev , i->second->now ) );
                         BSONObj out = _statUtil.doRow( i->second->prev , i->second->now );
                         rows.push_back( Row( i->first , out ) );
                     }
@@ -488,6 +500,7 @@ namespace mongo {
         }
 
         StatUtil _statUtil;
+        ServerStatusPoller _poller;
 
         struct Row {
             Row( string h , string e ) {
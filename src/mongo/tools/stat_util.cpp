@@ -19,6 +19,7 @@
 #include <iomanip>
 
 #include "stat_util.h"
+#include "mongo/client/dbclientinterface.h"
 #include "mongo/util/mongoutils/str.h"
 
 using namespace mongoutils;
@@ -349,5 +350,58 @@ namespace mongo {
 
         return data;
     }
-}
 
+    bool ServerStatusPoller::poll( DBClientBase& conn , BSONObj* out ) {
+        // What doRow() and the discovery of other hosts read.  A server that can't send deltas,
+        // or has forgotten the token, sends all of it.
+        BSONObj cmd = BSON( "serverStatus" << 1 <<
+                            "defaultSections" << false <<
+                            "metrics" << 1 <<
+                            "backgroundFlushing" << 1 <<
+                            "connections" << 1 <<
+                            "extra_info" << 1 <<
+                            "globalLock" << 1 <<
+                            "indexCounters" << 1 <<
+                            "locks" << 1 <<
+                            "network" << 1 <<
+                            "opcounters" << 1 <<
+                            "opcountersRepl" << 1 <<
+                            "repl" << 1 <<
+                            "deltaToken" << _token );
+        BSONObj res;
+        if ( !conn.runCommand( "admin" , cmd , res ) ) {
+            *out = res;
+            _token = 0;
+            return false;
+        }
+
+        if ( _token && res["deltaSince"].numberLong() == _token ) {
+            _last = applyDelta( _last , res );
+        }
+        else {
+            _last = res.getOwned();
+        }
+        _token = res["deltaToken"].numberLong();
+        *out = _last;
+        return true;
+    }
+
+    BSONObj ServerStatusPoller::applyDelta( const BSONObj& last , const BSONObj& delta ) {
+        BSONObjBuilder b;
+        BSONForEach( e , last ) {
+            BSONElement d = delta[e.fieldName()];
+            if ( d.eoo() )
+                b.append( e );
+            else if ( d.type() == Object && e.type() == Object )
+                b.append( e.fieldName() , applyDelta( e.Obj() , d.Obj() ) );
+            else
+                b.append( d );
+        }
+        BSONForEach( d , delta ) {
+            if ( last[d.fieldName()].eoo() )
+                b.append( d );
+        }
+        return b.obj();
+    }
+
+}
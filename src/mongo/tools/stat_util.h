@@ -23,6 +23,7 @@
 
 namespace mongo {
 
+    class DBClientBase;
 
     struct NamespaceInfo {
         string ns;
@@ -112,5 +113,24 @@ namespace mongo {
         bool _all;
         
     };
+
+    /**
+     * Polls a server for the serverStatus sections mongostat shows.  After the first time the
+     * server sends just what has changed, which is merged into the last status here.
+     */
+    class ServerStatusPoller {
+    public:
+        ServerStatusPoller() : _token( 0 ) {}
+
+        /** @return false, with the response in out, if serverStatus failed */
+        bool poll( DBClientBase& conn , BSONObj* out );
+
+        /** last with the fields of delta in place of its own, recursing into objects */
+        static BSONObj applyDelta( const BSONObj& last , const BSONObj& delta );
+
+    private:
+        long long _token;
+        BSONObj _last;
+    };
 }
 
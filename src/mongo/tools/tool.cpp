@@ -21,6 +21,9 @@
 #include <boost/filesystem/operations.hpp>
 #include <fstream>
 #include <iostream>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
 
 #include "mongo/base/initializer.h"
 #include "mongo/client/dbclient_rs.h"
@@ -232,22 +235,155 @@ namespace mongo {
             return;
         }
 
-        _conn->auth(BSON(saslCommandUserDBFieldName << getAuthenticationDatabase() <<
-                         saslCommandUserFieldName << toolGlobalParams.username <<
-                         saslCommandPasswordFieldName << toolGlobalParams.password  <<
-                         saslCommandMechanismFieldName <<
-                         toolGlobalParams.authenticationMechanism));
+        authConnection(_conn);
+    }
+
+    void Tool::authConnection( DBClientBase* c ) {
+        c->auth(BSON(saslCommandUserDBFieldName << getAuthenticationDatabase() <<
+                     saslCommandUserFieldName << toolGlobalParams.username <<
+                     saslCommandPasswordFieldName << toolGlobalParams.password  <<
+                     saslCommandMechanismFieldName <<
+                     toolGlobalParams.authenticationMechanism));
+    }
+
+    DBClientBase* Tool::newConnection() {
+        verify( !toolGlobalParams.useDirectClient );
+
+        string errmsg;
+        ConnectionString cs = ConnectionString::parse(toolGlobalParams.connectionString, errmsg);
+        uassert( 17309, str::stream() << "invalid hostname [" << toolGlobalParams.connectionString
+                                      << "] " << errmsg,
+                 cs.isValid() );
+
+        auto_ptr<DBClientBase> c( cs.connect( errmsg ) );
+        uassert( 17310, str::stream() << "couldn't connect to ["
+                                      << toolGlobalParams.connectionString << "] " << errmsg,
+                 c.get() );
+
+        if (!toolGlobalParams.username.empty()) {
+            authConnection(c.get());
+        }
+        return c.release();
     }
 
     BSONTool::BSONTool() : Tool() { }
 
     int BSONTool::run() {
+        initFilter();
+        return doRun();
+    }
 
+    void BSONTool::initFilter() {
         if (bsonToolGlobalParams.hasFilter) {
             _matcher.reset(new Matcher(fromjson(bsonToolGlobalParams.filter)));
         }
+    }
 
-        return doRun();
+    namespace {
+        /**
+         * A file mapped read only, for reading through from the start; the pages behind the
+         * reader are let go as it goes.  Not on Windows, nor for a file that can't be mapped.
+         */
+        class SequentialFileMap : boost::noncopyable {
+        public:
+            SequentialFileMap() : _data(NULL), _length(0), _released(0) {}
+
+            ~SequentialFileMap() {
+#if !defined(_WIN32)
+                if (_data) {
+                    munmap(const_cast<char*>(_data), _length);
+                }
+#endif
+            }
+
+            /** @return false if the file can't be mapped, having logged why at debug level */
+            bool map(FILE* file, unsigned long long length) {
+#if defined(_WIN32)
+                return false;
+#else
+                if (length != static_cast<size_t>(length)) {
+                    return false;
+                }
+                void* view = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+                if (view == MAP_FAILED) {
+                    if (logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1))) {
+                        toolInfoLog() << "\t can't map file, reading it instead: "
+                                      << errnoWithDescription() << std::endl;
+                    }
+                    return false;
+                }
+#if !defined(__sunos__)
+                // only a hint
+                madvise(view, length, MADV_SEQUENTIAL);
+#endif
+                _data = static_cast<const char*>(view);
+                _length = length;
+                return true;
+#endif
+            }
+
+            const char* data() const { return _data; }
+
+            /** the reader has got as far as offset, and doesn't need what's before it */
+            void readTo(unsigned long long offset) {
+#if !defined(_WIN32) && !defined(__sunos__)
+                const unsigned long long releaseTo = offset & ~(kReleaseBytes - 1);
+                if (releaseTo > _released) {
+                    madvise(const_cast<char*>(_data) + _released, releaseTo - _released,
+                            MADV_DONTNEED);
+                    _released = releaseTo;
+                }
+#endif
+            }
+
+        private:
+            // released in pieces of this many bytes, a multiple of the page size
+            static const unsigned long long kReleaseBytes = 64 * 1024 * 1024;
+
+            const char* _data;
+            size_t _length;
+            unsigned long long _released;
+        };
+
+        /**
+         * Whether a file starts with the signature of gzip, bzip2, xz or zip.  Only asked of a
+         * file that doesn't start with a valid object size, as a signature can be one.
+         */
+        bool isCompressed(const char* start, unsigned long long length) {
+            if (length < 4) {
+                return false;
+            }
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(start);
+            return (p[0] == 0x1f && p[1] == 0x8b) ||
+                (p[0] == 'B' && p[1] == 'Z' && p[2] == 'h') ||
+                (p[0] == 0xfd && p[1] == '7' && p[2] == 'z' && p[3] == 'X') ||
+                (p[0] == 'P' && p[1] == 'K' && p[2] == 3 && p[3] == 4);
+        }
+    }
+
+    void BSONTool::processObject( const BSONObj& o, unsigned long long* processed ) {
+        if (bsonToolGlobalParams.objcheck && !o.valid()) {
+            toolError() << "INVALID OBJECT - going to try and print out " << std::endl;
+            toolError() << "size: " << o.objsize() << std::endl;
+            BSONObjIterator i(o);
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                try {
+                    e.validate();
+                }
+                catch ( ... ) {
+                    toolError() << "\t\t NEXT ONE IS INVALID" << std::endl;
+                }
+                toolError() << "\t name : " << e.fieldName() << " " << typeName(e.type())
+                            << std::endl;
+                toolError() << "\t " << e << std::endl;
+            }
+        }
+
+        if (!bsonToolGlobalParams.hasFilter || _matcher->matches(o)) {
+            gotObject( o );
+            (*processed)++;
+        }
     }
 
     long long BSONTool::processFile( const boost::filesystem::path& root ) {
@@ -267,6 +403,7 @@ namespace mongo {
                       << std::endl;
             return 0;
         }
+        boost::shared_ptr<FILE> fileCloser(file, fclose);
 
 #ifdef POSIX_FADV_SEQUENTIAL
         posix_fadvise(fileno(file), 0, fileLength, POSIX_FADV_SEQUENTIAL);
@@ -281,57 +418,75 @@ namespace mongo {
         unsigned long long processed = 0;
 
         const int BUF_SIZE = BSONObjMaxUserSize + ( 1024 * 1024 );
-        boost::scoped_array<char> buf_holder(new char[BUF_SIZE]);
-        char * buf = buf_holder.get();
 
         ProgressMeter m(fileLength);
         if (!toolGlobalParams.quiet) {
             m.setUnits( "bytes" );
         }
 
-        while ( read < fileLength ) {
-            size_t amt = fread(buf, 1, 4, file);
-            verify( amt == 4 );
-
-            int size = ((int*)buf)[0];
-            uassert( 10264 , str::stream() << "invalid object size: " << size , size < BUF_SIZE );
-
-            amt = fread(buf+4, 1, size-4, file);
-            verify( amt == (size_t)( size - 4 ) );
-
-            BSONObj o( buf );
-            if (bsonToolGlobalParams.objcheck && !o.valid()) {
-                toolError() << "INVALID OBJECT - going to try and print out " << std::endl;
-                toolError() << "size: " << size << std::endl;
-                BSONObjIterator i(o);
-                while ( i.more() ) {
-                    BSONElement e = i.next();
-                    try {
-                        e.validate();
-                    }
-                    catch ( ... ) {
-                        toolError() << "\t\t NEXT ONE IS INVALID" << std::endl;
-                    }
-                    toolError() << "\t name : " << e.fieldName() << " " << typeName(e.type())
-                                << std::endl;
-                    toolError() << "\t " << e << std::endl;
+        // The objects of a mapped file are handed to gotObject() where they are in the mapping,
+        // rather than copied out of it; only until gotObject() returns, as before.
+        SequentialFileMap map;
+        if ( map.map( file, fileLength ) ) {
+            const char* data = map.data();
+            while ( read < fileLength ) {
+                int size = 0;
+                if ( fileLength - read >= 4 ) {
+                    memcpy( &size, data + read, 4 );
                 }
-            }
+                if ( read == 0 && ( size < 5 || size >= BUF_SIZE ) ) {
+                    uassert( 17311, str::stream() << "file " << fileName << " is compressed; "
+                                                  << "decompress it first",
+                             !isCompressed( data, fileLength ) );
+                }
+                uassert( 10264 , str::stream() << "invalid object size: " << size ,
+                         size >= 5 && size < BUF_SIZE );
+                uassert( 17312, str::stream() << "object of size " << size << " at offset "
+                                              << read << " runs past the end of the file",
+                         static_cast<unsigned long long>(size) <= fileLength - read );
 
-            if (!bsonToolGlobalParams.hasFilter || _matcher->matches(o)) {
-                gotObject( o );
-                processed++;
-            }
+                BSONObj o( data + read );
+                processObject( o, &processed );
 
-            read += o.objsize();
-            num++;
+                read += size;
+                num++;
+                map.readTo( read );
 
-            if (!toolGlobalParams.quiet) {
-                m.hit(o.objsize());
+                if (!toolGlobalParams.quiet) {
+                    m.hit(size);
+                }
             }
         }
+        else {
+            boost::scoped_array<char> buf_holder(new char[BUF_SIZE]);
+            char * buf = buf_holder.get();
+
+            while ( read < fileLength ) {
+                size_t amt = fread(buf, 1, 4, file);
+                verify( amt == 4 );
+
+                int size = ((int*)buf)[0];
+                if ( read == 0 && ( size < 5 || size >= BUF_SIZE ) ) {
+                    uassert( 17311, str::stream() << "file " << fileName << " is compressed; "
+                                                  << "decompress it first",
+                             !isCompressed( buf, fileLength ) );
+                }
+                uassert( 10264 , str::stream() << "invalid object size: " << size , size < BUF_SIZE );
 
-        fclose( file );
+                amt = fread(buf+4, 1, size-4, file);
+                verify( amt == (size_t)( size - 4 ) );
+
+                BSONObj o( buf );
+                processObject( o, &processed );
+
+                read += o.objsize();
+                num++;
+
+                if (!toolGlobalParams.quiet) {
+                    m.hit(o.objsize());
+                }
+            }
+        }
 
         uassert(10265, "counts don't match", read == fileLength);
         toolInfoOutput() << num << " objects found" << std::endl;
@@ -64,6 +64,12 @@ namespace mongo {
 
         mongo::DBClientBase &conn( bool slaveIfPaired = false );
 
+        /**
+         * Opens another connection to the server conn() is to, authenticated as conn() is, for
+         * tools that work on several threads.  The caller owns it.  Not for --dbpath.
+         */
+        mongo::DBClientBase* newConnection();
+
         bool _autoreconnect;
 
     protected:
@@ -73,6 +79,7 @@ namespace mongo {
 
     private:
         void auth();
+        void authConnection( DBClientBase* c );
     };
 
     class BSONTool : public Tool {
@@ -88,6 +95,14 @@ namespace mongo {
 
         long long processFile( const boost::filesystem::path& file );
 
+    protected:
+        /** the --filter each object processed has to match, set up by run() */
+        void initFilter();
+
+    private:
+        /** checks o if --objcheck, and hands it to gotObject() if it matches the --filter */
+        void processObject( const BSONObj& o, unsigned long long* processed );
+
     };
 
 }
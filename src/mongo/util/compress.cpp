@@ -54,4 +54,17 @@ namespace mongo {
         return snappy::Uncompress(compressed, compressed_length, uncompressed);
     }
 
+    bool rawUncompress(const char* compressed,
+        size_t compressed_length,
+        char* uncompressed,
+        size_t uncompressed_length)
+    {
+        size_t length;
+        if (!snappy::GetUncompressedLength(compressed, compressed_length, &length) ||
+                length != uncompressed_length) {
+            return false;
+        }
+        return snappy::RawUncompress(compressed, compressed_length, uncompressed);
+    }
+
 }
@@ -38,6 +38,15 @@ namespace mongo {
 
     bool uncompress(const char* compressed, size_t compressed_length, std::string* uncompressed);
 
+    /**
+     * Uncompresses into a buffer of uncompressed_length bytes, failing unless the input comes to
+     * exactly that many.
+     */
+    bool rawUncompress(const char* compressed,
+        size_t compressed_length,
+        char* uncompressed,
+        size_t uncompressed_length);
+
     size_t maxCompressedLength(size_t source_len);
     void rawCompress(const char* input,
         size_t input_length,
@@ -25,8 +25,10 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/xtime.hpp>
 
+#include "mongo/platform/compiler.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/heapcheck.h"
+#include "mongo/util/concurrency/mutex_stats.h"
 #include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/time_support.h"
 
@@ -74,7 +76,7 @@ namespace mongo {
     class mutex : boost::noncopyable {
     public:
         const char * const _name;
-        mutex(const char *name) : _name(name)
+        mutex(const char *name) : _name(name), _stats(NULL)
         {
             _m = new boost::timed_mutex();
             IGNORE_OBJECT( _m  );   // Turn-off heap checking on _m
@@ -110,7 +112,13 @@ namespace mongo {
 #if defined(_DEBUG)
             _mut(&m),
 #endif
-            _l( m.boost() ) {
+            _l( m.boost() , boost::defer_lock ),
+            _stats( NULL ),
+            _lockedAt( 0 ) {
+                if ( MONGO_likely( !MutexStats::enabled() ) )
+                    _l.lock();
+                else
+                    _profiledLock( m );
 #if defined(_DEBUG)
                 mutexDebugger.entering(_mut->_name);
 #endif
@@ -119,14 +127,33 @@ namespace mongo {
 #if defined(_DEBUG)
                 mutexDebugger.leaving(_mut->_name);
 #endif
+                if ( _lockedAt )
+                    _stats->noteReleased( curTimeMicros64() - _lockedAt );
             }
             boost::timed_mutex::scoped_lock &boost() { return _l; }
         private:
+            void _profiledLock( mongo::mutex &m ) {
+                const bool contended = !_l.try_lock();
+                unsigned long long waitStart = 0;
+                if ( contended ) {
+                    waitStart = curTimeMicros64();
+                    _l.lock();
+                }
+                _lockedAt = curTimeMicros64();
+                if ( !m._stats )
+                    m._stats = MutexStats::get( m._name );
+                _stats = m._stats;
+                _stats->noteAcquired( contended, contended ? _lockedAt - waitStart : 0 );
+            }
+
             boost::timed_mutex::scoped_lock _l;
+            MutexStats* _stats;
+            unsigned long long _lockedAt;
         };
     private:
         boost::timed_mutex &boost() { return *_m; }
         boost::timed_mutex *_m;
+        MutexStats* _stats; // set on first lock while profiling, guarded by _m
     };
 
     typedef mongo::mutex::scoped_lock scoped_lock;
@@ -158,15 +185,37 @@ namespace mongo {
     class SimpleMutex : boost::noncopyable {
     public:
         void dassertLocked() const { }
-        SimpleMutex(const char* name) { verify( pthread_mutex_init(&_lock,0) == 0 ); }
+        SimpleMutex(const char* name) : _name(name), _stats(NULL), _lockedAt(0) {
+            pthread_mutexattr_t attrs;
+            verify( pthread_mutexattr_init(&attrs) == 0 );
+#if defined(PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP)
+            // spin for a while on a contended lock before sleeping in the kernel
+            verify( pthread_mutexattr_settype(&attrs, PTHREAD_MUTEX_ADAPTIVE_NP) == 0 );
+#endif
+            verify( pthread_mutex_init(&_lock,&attrs) == 0 );
+            pthread_mutexattr_destroy(&attrs);
+        }
         ~SimpleMutex(){ 
             if ( ! StaticObserver::_destroyingStatics ) { 
                 verify( pthread_mutex_destroy(&_lock) == 0 ); 
             }
         }
 
-        void lock() { verify( pthread_mutex_lock(&_lock) == 0 ); }
-        void unlock() { verify( pthread_mutex_unlock(&_lock) == 0 ); }
+        void lock() {
+            if ( MONGO_likely( !MutexStats::enabled() ) ) {
+                verify( pthread_mutex_lock(&_lock) == 0 );
+                return;
+            }
+            _profiledLock();
+        }
+        void unlock() {
+            if ( _lockedAt ) {
+                unsigned long long lockedAt = _lockedAt;
+                _lockedAt = 0;
+                _stats->noteReleased( curTimeMicros64() - lockedAt );
+            }
+            verify( pthread_mutex_unlock(&_lock) == 0 );
+        }
     public:
         class scoped_lock : boost::noncopyable {
             SimpleMutex& _m;
@@ -177,7 +226,23 @@ namespace mongo {
         };
 
     private:
+        void _profiledLock() {
+            const bool contended = pthread_mutex_trylock(&_lock) != 0;
+            unsigned long long waitStart = 0;
+            if ( contended ) {
+                waitStart = curTimeMicros64();
+                verify( pthread_mutex_lock(&_lock) == 0 );
+            }
+            _lockedAt = curTimeMicros64();
+            if ( !_stats )
+                _stats = MutexStats::get( _name );
+            _stats->noteAcquired( contended, contended ? _lockedAt - waitStart : 0 );
+        }
+
         pthread_mutex_t _lock;
+        const char* const _name;
+        MutexStats* _stats;                 // set on first lock while profiling
+        unsigned long long _lockedAt;       // while profiling, guarded by _lock
     };
 #endif
 
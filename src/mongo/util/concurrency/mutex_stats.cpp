@@ -0,0 +1,58 @@
+// @file mutex_stats.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/util/concurrency/mutex_stats.h"
+
+#include <boost/thread/mutex.hpp>
+#include <map>
+
+namespace mongo {
+
+    volatile bool MutexStats::_enabled = false;
+
+    namespace {
+        typedef std::map<std::string, MutexStats*> StatsMap;
+
+        // intentional leaks, mutexes are still locked while statics are destroyed
+        boost::mutex& statsMutex = *(new boost::mutex());
+        StatsMap& statsByName = *(new StatsMap());
+    }
+
+    MutexStats* MutexStats::get( const char* name ) {
+        boost::mutex::scoped_lock lk( statsMutex );
+        MutexStats*& stats = statsByName[name ? name : ""];
+        if ( !stats )
+            stats = new MutexStats();
+        return stats;
+    }
+
+    void MutexStats::getAll( std::vector<Snapshot>* all ) {
+        boost::mutex::scoped_lock lk( statsMutex );
+        for ( StatsMap::const_iterator i = statsByName.begin(); i != statsByName.end(); ++i ) {
+            Snapshot s;
+            s.name = i->first;
+            s.acquired = i->second->_acquired.load();
+            s.contended = i->second->_contended.load();
+            s.waitMicros = i->second->_waitMicros.load();
+            s.heldMicros = i->second->_heldMicros.load();
+            all->push_back( s );
+        }
+    }
+
+} // namespace mongo
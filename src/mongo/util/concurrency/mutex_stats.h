@@ -0,0 +1,82 @@
+// @file mutex_stats.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * Contention profile of the mutexes of one name: how often they were taken, how often a
+     * thread had to wait for one and for how long, and how long they were held.  SimpleMutex
+     * and mongo::mutex fill these in while profiling is enabled; it is off by default as it
+     * reads the clock on every lock and unlock.
+     *
+     * The held time of a mongo::mutex waited on with a condition variable includes the waits.
+     */
+    class MutexStats {
+    public:
+        struct Snapshot {
+            std::string name;
+            unsigned long long acquired;
+            unsigned long long contended;
+            unsigned long long waitMicros;
+            unsigned long long heldMicros;
+        };
+
+        static bool enabled() { return _enabled; }
+        static void setEnabled( bool enabled ) { _enabled = enabled; }
+
+        /**
+         * @return the counters shared by the mutexes named name, created on first use.
+         * The returned object lives until the process exits.
+         */
+        static MutexStats* get( const char* name );
+
+        /**
+         * Fills all with the counters of every name locked while profiling was enabled.
+         */
+        static void getAll( std::vector<Snapshot>* all );
+
+        void noteAcquired( bool contended, unsigned long long waitMicros ) {
+            _acquired.fetchAndAdd( 1 );
+            if ( contended ) {
+                _contended.fetchAndAdd( 1 );
+                _waitMicros.fetchAndAdd( waitMicros );
+            }
+        }
+
+        void noteReleased( unsigned long long heldMicros ) {
+            _heldMicros.fetchAndAdd( heldMicros );
+        }
+
+    private:
+        MutexStats() {}
+
+        static volatile bool _enabled;
+
+        AtomicUInt64 _acquired;
+        AtomicUInt64 _contended;
+        AtomicUInt64 _waitMicros;
+        AtomicUInt64 _heldMicros;
+    };
+
+} // namespace mongo
@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/mutex_stats.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using mongo::MutexStats;
+    using mongo::SimpleMutex;
+
+    MutexStats::Snapshot findStats( const std::string& name ) {
+        std::vector<MutexStats::Snapshot> all;
+        MutexStats::getAll( &all );
+        for ( size_t i = 0; i < all.size(); i++ ) {
+            if ( all[i].name == name )
+                return all[i];
+        }
+        MutexStats::Snapshot none = { name, 0, 0, 0, 0 };
+        return none;
+    }
+
+    void holdFor( SimpleMutex* m, int millis ) {
+        SimpleMutex::scoped_lock lk( *m );
+        mongo::sleepmillis( millis );
+    }
+
+    TEST(MutexStats, NotCountedWhileDisabled) {
+        SimpleMutex m( "MutexStatsTest::disabled" );
+        m.lock();
+        m.unlock();
+        ASSERT_EQUALS( 0U, findStats( "MutexStatsTest::disabled" ).acquired );
+    }
+
+    TEST(MutexStats, CountsAcquisitionsAndWaits) {
+        MutexStats::setEnabled( true );
+
+        SimpleMutex m( "MutexStatsTest::simple" );
+        for ( int i = 0; i < 10; i++ ) {
+            SimpleMutex::scoped_lock lk( m );
+        }
+
+        boost::thread holder( boost::bind( holdFor, &m, 100 ) );
+        mongo::sleepmillis( 20 );
+        {
+            SimpleMutex::scoped_lock lk( m );
+        }
+        holder.join();
+
+        MutexStats::setEnabled( false );
+
+        MutexStats::Snapshot s = findStats( "MutexStatsTest::simple" );
+        ASSERT_EQUALS( 12U, s.acquired );
+        ASSERT_EQUALS( 1U, s.contended );
+        ASSERT_GREATER_THAN( s.waitMicros, 0U );
+        ASSERT_GREATER_THAN_OR_EQUALS( s.heldMicros, 100 * 1000U );
+    }
+
+    TEST(MutexStats, SharedByName) {
+        MutexStats::setEnabled( true );
+        {
+            mongo::mutex a( "MutexStatsTest::shared" );
+            mongo::mutex b( "MutexStatsTest::shared" );
+            mongo::mutex::scoped_lock la( a );
+            mongo::mutex::scoped_lock lb( b );
+        }
+        MutexStats::setEnabled( false );
+
+        ASSERT_EQUALS( 2U, findStats( "MutexStatsTest::shared" ).acquired );
+    }
+
+} // namespace
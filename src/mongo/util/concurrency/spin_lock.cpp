@@ -21,12 +21,24 @@
 
 #include <time.h>
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if !defined(FUTEX_WAIT_PRIVATE)
+#define FUTEX_WAIT_PRIVATE FUTEX_WAIT
+#define FUTEX_WAKE_PRIVATE FUTEX_WAKE
+#endif
+#endif
+
 
 namespace mongo {
 
     SpinLock::~SpinLock() {
 #if defined(_WIN32)
         DeleteCriticalSection(&_cs);
+#elif defined(__linux__)
 #elif defined(__USE_XOPEN2K)
         pthread_spin_destroy(&_lock);
 #endif
@@ -35,6 +47,8 @@ namespace mongo {
     SpinLock::SpinLock()
 #if defined(_WIN32)
     { InitializeCriticalSectionAndSpinCount(&_cs, 4000); }
+#elif defined(__linux__)
+    : _state( 0 ) { }
 #elif defined(__USE_XOPEN2K)
     { pthread_spin_init( &_lock , 0 ); }
 #elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
@@ -43,7 +57,28 @@ namespace mongo {
     : _mutex( "SpinLock" ) { }
 #endif
 
-#if defined(__USE_XOPEN2K)
+#if defined(__linux__)
+    NOINLINE_DECL void SpinLock::_lk() {
+        // spin while the holder is likely to be about to let go
+        for ( int i=0; i<1000; i++ ) {
+            if ( _state == 0 && __sync_bool_compare_and_swap( &_state, 0, 1 ) )
+                return;
+#if defined(__i386__) || defined(__x86_64__)
+            asm volatile ( "pause" ) ;
+#endif
+        }
+
+        // then mark the lock as having a waiter, so unlock() wakes us, and sleep until it does
+        while ( __sync_lock_test_and_set( &_state, 2 ) != 0 ) {
+            syscall( SYS_futex, &_state, FUTEX_WAIT_PRIVATE, 2, NULL, NULL, 0 );
+        }
+    }
+
+    NOINLINE_DECL void SpinLock::_wake() {
+        __sync_lock_release( &_state );
+        syscall( SYS_futex, &_state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0 );
+    }
+#elif defined(__USE_XOPEN2K)
     NOINLINE_DECL void SpinLock::_lk() {
         /**
          * this is designed to perform close to the default spin lock
@@ -102,7 +137,8 @@ namespace mongo {
 #endif
 
     bool SpinLock::isfast() {
-#if defined(_WIN32) || defined(__USE_XOPEN2K) || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+#if defined(_WIN32) || defined(__linux__) || defined(__USE_XOPEN2K) || \
+    defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
         return true;
 #else
         return false;
@@ -41,6 +41,9 @@ namespace mongo {
     /**
      * The spinlock currently requires late GCC support routines to be efficient.
      * Other platforms default to a mutex implemenation.
+     *
+     * On Linux a contended lock spins for a while, then sleeps on a futex until the
+     * holder wakes it, rather than polling.
      */
     class SpinLock : boost::noncopyable {
     public:
@@ -55,6 +58,21 @@ namespace mongo {
     public:
         void lock() {EnterCriticalSection(&_cs); }
         void unlock() { LeaveCriticalSection(&_cs); }
+#elif defined(__linux__)
+        // 0: unlocked, 1: locked, 2: locked and another thread may be sleeping on it
+        volatile int _state;
+        void _lk();
+        void _wake();
+    public:
+        void unlock() {
+            if ( MONGO_unlikely( __sync_fetch_and_sub( &_state, 1 ) != 1 ) )
+                _wake();
+        }
+        void lock() {
+            if ( MONGO_likely( __sync_bool_compare_and_swap( &_state, 0, 1 ) ) )
+                return;
+            _lk();
+        }
 #elif defined(__USE_XOPEN2K)
         pthread_spinlock_t _lock;
         void _lk();
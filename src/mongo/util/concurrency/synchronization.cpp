@@ -70,6 +70,11 @@ namespace mongo {
         }
     }
 
+    NotifyAll::When NotifyAll::lastDone() {
+        scoped_lock lock( _mutex );
+        return _lastDone;
+    }
+
     void NotifyAll::notifyAll(When e) {
         scoped_lock lock( _mutex );
         _lastDone = e;
@@ -71,6 +71,9 @@ namespace mongo {
         /** may be called multiple times. notifies all waiters */
         void notifyAll(When);
 
+        /** the When of the last notifyAll() call; waitFor() of it or anything before returns at once */
+        When lastDone();
+
         /** indicates how many threads are waiting for a notify. */
         unsigned nWaiting() const { return _nWaiting; }
 
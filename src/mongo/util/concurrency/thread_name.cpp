@@ -20,10 +20,24 @@
 
 #include <boost/thread/tss.hpp>
 
+#if defined(__linux__)
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace mongo {
 
 namespace {
-    boost::thread_specific_ptr<std::string> _threadName;
+    void (*_threadExitHook)(const std::string& name) = NULL;
+
+    void _threadExited(std::string* name) {
+        if (_threadExitHook)
+            _threadExitHook(*name);
+        delete name;
+    }
+
+    boost::thread_specific_ptr<std::string> _threadName(&_threadExited);
 
 #if defined(_WIN32)
 
@@ -57,7 +71,18 @@ namespace {
 }  // namespace
 
     void setThreadName(StringData name) {
-        _threadName.reset(new string(name.rawData(), name.size()));
+        // Renames assign rather than reset, which would report the thread exited.
+        if (std::string* s = _threadName.get())
+            s->assign(name.rawData(), name.size());
+        else
+            _threadName.reset(new string(name.rawData(), name.size()));
+
+#if defined(__linux__)
+        // So that /proc/self/task/<tid>/comm, top and gdb name the thread too; the kernel keeps 15
+        // characters of it.  Not the main thread, whose name is the one ps and killall go by.
+        if (!name.empty() && syscall(SYS_gettid) != getpid())
+            prctl(PR_SET_NAME, _threadName.get()->substr(0, 15).c_str(), 0, 0, 0);
+#endif
 
 #if defined( DEBUG ) && defined( _WIN32 )
         // naming might be expensive so don't do "conn*" over and over
@@ -74,4 +99,8 @@ namespace {
         return *s;
     }
 
+    void setThreadExitHook(void (*hook)(const std::string& name)) {
+        _threadExitHook = hook;
+    }
+
 }  // namespace mongo
@@ -32,4 +32,10 @@ namespace mongo {
      */
     const std::string& getThreadName();
 
+    /**
+     * Sets a function to be called on each named thread as it exits, with the thread's name.
+     * Threads that neither set nor got a name aren't reported.
+     */
+    void setThreadExitHook(void (*hook)(const std::string& name));
+
 }  // namespace mongo
@@ -20,9 +20,12 @@
 
 #include "mongo/util/concurrency/thread_pool.h"
 
+#include <deque>
+
 #include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
 
-#include "mongo/util/concurrency/mvar.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
     namespace threadpool {
@@ -30,118 +33,247 @@ namespace mongo {
         // Worker thread
         class Worker : boost::noncopyable {
         public:
-            explicit Worker(ThreadPool& owner)
+            Worker(ThreadPool& owner, size_t index)
                 : _owner(owner)
-                , _is_done(true)
-                , _thread(boost::bind(&Worker::loop, this))
+                , _index(index)
+                , _mutex("ThreadPool::Worker")
+                , _thread(NULL)
             {}
 
-            // destructor will block until current operation is completed
+            // destructor will block until the thread has exited
             // Acts as a "join" on this thread
             ~Worker() {
-                _task.put(Task());
-                _thread.join();
+                if (_thread) {
+                    _thread->join();
+                    delete _thread;
+                }
             }
 
-            void set_task(Task& func) {
-                verify(!func.empty());
-                verify(_is_done);
-                _is_done = false;
-
-                _task.put(func);
+            void start() {
+                _thread = new boost::thread(boost::bind(&ThreadPool::loop, &_owner, this));
             }
 
-        private:
             ThreadPool& _owner;
-            MVar<Task> _task;
-            bool _is_done; // only used for error detection
-            boost::thread _thread;
-
-            void loop() {
-                while (true) {
-                    Task task = _task.take();
-                    if (task.empty())
-                        break; // ends the thread
-
-                    try {
-                        task();
-                    }
-                    catch (DBException& e) {
-                        log() << "Unhandled DBException: " << e.toString() << endl;
-                    }
-                    catch (std::exception& e) {
-                        log() << "Unhandled std::exception in worker thread: " << e.what() << endl;;
-                    }
-                    catch (...) {
-                        log() << "Unhandled non-exception in worker thread" << endl;
-                    }
-                    _is_done = true;
-                    _owner.task_done(this);
+            const size_t _index;
+
+            SimpleMutex _mutex;
+            std::deque<Task> _tasks; // guarded by _mutex
+
+        private:
+            boost::thread* _thread;
+        };
+
+        namespace {
+            // the worker running on this thread, so the tasks it schedules stay in its queue
+            void noCleanup(Worker*) {}
+            boost::thread_specific_ptr<Worker> currentWorker(noCleanup);
+
+            void runTask(Task& task) {
+                try {
+                    task();
+                }
+                catch (DBException& e) {
+                    log() << "Unhandled DBException: " << e.toString() << endl;
+                }
+                catch (std::exception& e) {
+                    log() << "Unhandled std::exception in worker thread: " << e.what() << endl;;
+                }
+                catch (...) {
+                    log() << "Unhandled non-exception in worker thread" << endl;
                 }
             }
-        };
+        }
 
         ThreadPool::ThreadPool(int nThreads)
-            : _mutex("ThreadPool"), _tasksRemaining(0)
-            , _nThreads(nThreads) {
-            scoped_lock lock(_mutex);
-            while (nThreads-- > 0) {
-                Worker* worker = new Worker(*this);
-                _freeWorkers.push_front(worker);
+            : _sleepMutex("ThreadPool"), _shutdown(false)
+            , _joinMutex("ThreadPool::join") {
+            verify(nThreads > 0);
+            // all the queues must exist before any worker looks for one to steal from
+            for (int i = 0; i < nThreads; i++) {
+                _workers.push_back(new Worker(*this, i));
+            }
+            for (int i = 0; i < nThreads; i++) {
+                _workers[i]->start();
             }
         }
 
         ThreadPool::~ThreadPool() {
             join();
 
-            verify(_tasks.empty());
-
-            // O(n) but n should be small
-            verify(_freeWorkers.size() == (unsigned)_nThreads);
+            {
+                scoped_lock lock(_sleepMutex);
+                _shutdown = true;
+                _workAvailable.notify_all();
+            }
 
-            while(!_freeWorkers.empty()) {
-                delete _freeWorkers.front();
-                _freeWorkers.pop_front();
+            for (size_t i = 0; i < _workers.size(); i++) {
+                delete _workers[i];
             }
         }
 
         void ThreadPool::join() {
-            scoped_lock lock(_mutex);
-            while(_tasksRemaining) {
-                _condition.wait(lock.boost());
+            scoped_lock lock(_joinMutex);
+            while(_tasksRemaining.load()) {
+                _allDone.wait(lock.boost());
             }
         }
 
+        Worker* ThreadPool::_workerForNewTask() {
+            Worker* worker = currentWorker.get();
+            if (worker && &worker->_owner == this)
+                return worker;
+            return _workers[_nextWorker.fetchAndAdd(1) % _workers.size()];
+        }
+
+        void ThreadPool::_wakeWorkers(int n) {
+            // A worker going to sleep counts itself in _sleepers before it looks at
+            // _tasksQueued, and the tasks were counted in _tasksQueued before this looks at
+            // _sleepers, so either it sees the tasks or it is woken here.
+            if (_sleepers.load() == 0)
+                return;
+
+            scoped_lock lock(_sleepMutex);
+            if (n == 1)
+                _workAvailable.notify_one();
+            else
+                _workAvailable.notify_all();
+        }
+
         void ThreadPool::schedule(Task task) {
-            scoped_lock lock(_mutex);
+            _tasksRemaining.fetchAndAdd(1);
+
+            Worker* worker = _workerForNewTask();
+            {
+                SimpleMutex::scoped_lock lock(worker->_mutex);
+                worker->_tasks.push_back(task);
+            }
+            _tasksQueued.fetchAndAdd(1);
+
+            _wakeWorkers(1);
+        }
+
+        void ThreadPool::scheduleBatch(const std::vector<Task>& tasks) {
+            if (tasks.empty())
+                return;
 
-            _tasksRemaining++;
+            const int n = tasks.size();
+            _tasksRemaining.fetchAndAdd(n);
 
-            if (!_freeWorkers.empty()) {
-                _freeWorkers.front()->set_task(task);
-                _freeWorkers.pop_front();
+            // contiguous shares, so that neighbouring tasks run on the same worker
+            const size_t nWorkers = _workers.size();
+            const size_t perWorker = (tasks.size() + nWorkers - 1) / nWorkers;
+            const size_t first = _nextWorker.fetchAndAdd(nWorkers);
+            for (size_t share = 0; share * perWorker < tasks.size(); share++) {
+                Worker* worker = _workers[(first + share) % nWorkers];
+                const size_t end = std::min(tasks.size(), (share + 1) * perWorker);
+
+                SimpleMutex::scoped_lock lock(worker->_mutex);
+                worker->_tasks.insert(worker->_tasks.end(),
+                                      tasks.begin() + share * perWorker,
+                                      tasks.begin() + end);
             }
-            else {
-                _tasks.push_back(task);
+            _tasksQueued.fetchAndAdd(n);
+
+            _wakeWorkers(n);
+        }
+
+        // should only be called by a worker from the worker thread
+        bool ThreadPool::getTask(Worker* self, Task* task) {
+            if (_tasksQueued.load() <= 0)
+                return false;
+
+            {
+                SimpleMutex::scoped_lock lock(self->_mutex);
+                if (!self->_tasks.empty()) {
+                    task->swap(self->_tasks.front());
+                    self->_tasks.pop_front();
+                    _tasksQueued.fetchAndSubtract(1);
+                    return true;
+                }
+            }
+
+            for (size_t i = 1; i < _workers.size(); i++) {
+                Worker* victim = _workers[(self->_index + i) % _workers.size()];
+                SimpleMutex::scoped_lock lock(victim->_mutex);
+                if (!victim->_tasks.empty()) {
+                    task->swap(victim->_tasks.back());
+                    victim->_tasks.pop_back();
+                    _tasksQueued.fetchAndSubtract(1);
+                    return true;
+                }
             }
+
+            return false;
         }
 
         // should only be called by a worker from the worker thread
-        void ThreadPool::task_done(Worker* worker) {
-            scoped_lock lock(_mutex);
+        void ThreadPool::loop(Worker* self) {
+            currentWorker.reset(self);
+
+            Task task;
+            while (true) {
+                if (getTask(self, &task)) {
+                    runTask(task);
+                    task.clear();
+                    task_done();
+                    continue;
+                }
+
+                scoped_lock lock(_sleepMutex);
+                _sleepers.fetchAndAdd(1);
+                if (_tasksQueued.load() <= 0 && !_shutdown)
+                    _workAvailable.wait(lock.boost());
+                _sleepers.fetchAndSubtract(1);
+
+                if (_shutdown && _tasksQueued.load() <= 0)
+                    break; // ends the thread
+            }
+
+            currentWorker.release();
+        }
+
+        // should only be called by a worker from the worker thread
+        void ThreadPool::task_done() {
+            if (_tasksRemaining.subtractAndFetch(1) == 0) {
+                scoped_lock lock(_joinMutex);
+                _allDone.notify_all();
+            }
+        }
+
+        // ------ TaskGroup ------
+
+        TaskGroup::TaskGroup(ThreadPool& pool)
+            : _pool(pool), _mutex("TaskGroup"), _tasksRemaining(0) {
+        }
 
-            if (!_tasks.empty()) {
-                worker->set_task(_tasks.front());
-                _tasks.pop_front();
+        TaskGroup::~TaskGroup() {
+            wait();
+        }
+
+        void TaskGroup::schedule(Task task) {
+            {
+                scoped_lock lock(_mutex);
+                _tasksRemaining++;
             }
-            else {
-                _freeWorkers.push_front(worker);
+            _pool.schedule(boost::bind(&TaskGroup::run, this, task));
+        }
+
+        void TaskGroup::wait() {
+            scoped_lock lock(_mutex);
+            while (_tasksRemaining) {
+                _done.wait(lock.boost());
             }
+        }
 
-            _tasksRemaining--;
+        void TaskGroup::run(const Task& task) {
+            ON_BLOCK_EXIT_OBJ(*this, &TaskGroup::task_done);
+            task();
+        }
 
-            if(_tasksRemaining == 0)
-                _condition.notify_all();
+        void TaskGroup::task_done() {
+            scoped_lock lock(_mutex);
+            if (--_tasksRemaining == 0)
+                _done.notify_all();
         }
 
     } //namespace threadpool
@@ -17,12 +17,13 @@
 
 #pragma once
 
-#include <list>
+#include <vector>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 #include <boost/thread/condition.hpp>
 
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
@@ -32,6 +33,14 @@ namespace mongo {
 
         typedef boost::function<void(void)> Task; //nullary function or functor
 
+        /**
+         * Each worker has its own queue of tasks.  Tasks scheduled from outside the pool are
+         * dealt to the workers in turn, and tasks scheduled by a task go to the queue of the
+         * worker running it.  A worker runs the tasks of its own queue in order, and when it
+         * has none left takes the newest task of another worker's queue, so that no one queue
+         * is a point of contention and a worker stuck on a long task doesn't hold up the
+         * rest of its queue.
+         */
         // exported to the mongo namespace
         class ThreadPool : boost::noncopyable {
         public:
@@ -44,11 +53,15 @@ namespace mongo {
             // blocks until all tasks are complete (tasks_remaining() == 0)
             // does not prevent new tasks from being scheduled so could wait forever.
             // Also, new tasks could be scheduled after this returns.
+            // To wait for some of the tasks only, schedule them through a TaskGroup.
             void join();
 
             // task will be copied a few times so make sure it's relatively cheap
             void schedule(Task task);
 
+            // Schedules all of tasks, handing each worker its share of them at once.
+            void scheduleBatch(const std::vector<Task>& tasks);
+
             // Helpers that wrap schedule and boost::bind.
             // Functor and args will be copied a few times so make sure it's relatively cheap
             template<typename F, typename A>
@@ -62,24 +75,71 @@ namespace mongo {
             template<typename F, typename A, typename B, typename C, typename D, typename E>
             void schedule(F f, A a, B b, C c, D d, E e) { schedule(boost::bind(f,a,b,c,d,e)); }
 
-            int tasks_remaining() { return _tasksRemaining; }
+            int tasks_remaining() { return _tasksRemaining.load(); }
 
         private:
-            mongo::mutex _mutex;
-            boost::condition _condition;
+            std::vector<Worker*> _workers;
+            AtomicUInt32 _nextWorker; // deals out the tasks scheduled from outside the pool
+
+            AtomicInt32 _tasksQueued; // in the workers' queues, not yet started
+            AtomicInt32 _tasksRemaining; // in queue + currently processing
 
-            std::list<Worker*> _freeWorkers; //used as LIFO stack (always front)
-            std::list<Task> _tasks; //used as FIFO queue (push_back, pop_front)
-            int _tasksRemaining; // in queue + currently processing
-            int _nThreads; // only used for sanity checking. could be removed in the future.
+            // workers with nothing to run or steal wait here
+            mongo::mutex _sleepMutex;
+            boost::condition _workAvailable;
+            AtomicInt32 _sleepers;
+            bool _shutdown; // guarded by _sleepMutex
+
+            // join() waits here
+            mongo::mutex _joinMutex;
+            boost::condition _allDone;
+
+            Worker* _workerForNewTask();
+            void _wakeWorkers(int n);
 
             // should only be called by a worker from the worker's thread
-            void task_done(Worker* worker);
+            void loop(Worker* self);
+            bool getTask(Worker* self, Task* task);
+            void task_done();
             friend class Worker;
         };
 
+        /**
+         * Schedules tasks on a ThreadPool and waits for just those to finish, so that users
+         * sharing a pool don't wait on each other's tasks as with ThreadPool::join().
+         */
+        class TaskGroup : boost::noncopyable {
+        public:
+            explicit TaskGroup(ThreadPool& pool);
+
+            // blocks until the group's tasks are complete
+            ~TaskGroup();
+
+            void schedule(Task task);
+
+            template<typename F, typename A>
+            void schedule(F f, A a) { schedule(boost::bind(f,a)); }
+            template<typename F, typename A, typename B>
+            void schedule(F f, A a, B b) { schedule(boost::bind(f,a,b)); }
+            template<typename F, typename A, typename B, typename C>
+            void schedule(F f, A a, B b, C c) { schedule(boost::bind(f,a,b,c)); }
+
+            // blocks until all the tasks scheduled through this group are complete
+            void wait();
+
+        private:
+            ThreadPool& _pool;
+            mongo::mutex _mutex;
+            boost::condition _done;
+            int _tasksRemaining; // guarded by _mutex
+
+            void run(const Task& task);
+            void task_done();
+        };
+
     } //namespace threadpool
 
     using threadpool::ThreadPool;
+    using threadpool::TaskGroup;
 
 } //namespace mongo
@@ -94,6 +94,7 @@ namespace mongo {
     public:
         T* get() const;
         void reset(T* v);
+        T* release();
         T* getMake() { 
             T *t = get();
             if( t == 0 )
@@ -112,7 +113,11 @@ namespace mongo {
     void TSP<T>::reset(T* v) { \
         tsp.reset(v); \
         _ ## p = v; \
-    } 
+    } \
+    template<> T* TSP<T>::release() { \
+        _ ## p = 0; \
+        return tsp.release(); \
+    }
 # else
 
 #  define TSP_DECLARE(T,p) \
@@ -126,6 +131,10 @@ namespace mongo {
         tsp.reset(v); \
         _ ## p = v; \
     } \
+    template<> T* TSP<T>::release() { \
+        _ ## p = 0; \
+        return tsp.release(); \
+    } \
     TSP<T> p;
 # endif
 
@@ -157,6 +166,13 @@ namespace mongo {
             verify( pthread_setspecific( _key, v ) == 0 ); 
         }
 
+        /** Clears this thread's value without deleting it, and returns it. */
+        T* release() {
+            T* t = get();
+            verify( pthread_setspecific( _key, NULL ) == 0 );
+            return t;
+        }
+
         T* getMake() { 
             T *t = get();
             if( t == 0 ) {
@@ -179,6 +195,7 @@ namespace mongo {
     public:
         T* get() const { return tsp.get(); }
         void reset(T* v) { tsp.reset(v); }
+        T* release() { return tsp.release(); }
         T* getMake() { 
             T *t = get();
             if( t == 0 )
@@ -18,6 +18,7 @@
 #include <iostream>
 
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -96,6 +97,105 @@ namespace mongo {
         boost::condition_variable_any _newTicket;
     };
 
+    /**
+     * Like TicketHolder, but waiters are served by priority, highest first, and the time they
+     * spend waiting is kept.  Within a priority, arrivals queue behind the waiters.  A size of 0
+     * means unlimited.
+     */
+    class PriorityTicketHolder {
+    public:
+        enum { kNumPriorities = 2 };
+
+        PriorityTicketHolder( int num ) :
+            _outof( num ), _used( 0 ), _admitted( 0 ), _queued( 0 ), _queuedMicros( 0 ),
+            _mutex( "PriorityTicketHolder" ) {
+            for ( int i = 0; i < kNumPriorities; i++ ) {
+                _waiting[i] = 0;
+            }
+        }
+
+        /** Returns microseconds spent waiting. */
+        long long waitForTicket( int priority ) {
+            scoped_lock lk( _mutex );
+            _admitted++;
+
+            if ( _free() && _waitingAtOrAbove( priority ) == 0 ) {
+                _used++;
+                return 0;
+            }
+
+            _queued++;
+            unsigned long long start = curTimeMicros64();
+            _waiting[priority]++;
+            while ( ! _free() || _waitingAtOrAbove( priority + 1 ) > 0 ) {
+                _newTicket[priority].wait( lk.boost() );
+            }
+            _waiting[priority]--;
+            _used++;
+
+            // Tickets may remain that only waiters below us could take.
+            if ( _free() )
+                _wakeNext();
+
+            long long waited = curTimeMicros64() - start;
+            _queuedMicros += waited;
+            return waited;
+        }
+
+        void release() {
+            scoped_lock lk( _mutex );
+            _used--;
+            _wakeNext();
+        }
+
+        /** Unlike TicketHolder::resize, may shrink below the number in use. */
+        void resize( int newSize ) {
+            scoped_lock lk( _mutex );
+            _outof = newSize;
+            for ( int i = 0; i < kNumPriorities; i++ ) {
+                _newTicket[i].notify_all();
+            }
+        }
+
+        int used() const { return _used; }
+        int outof() const { return _outof; }
+        int waiting( int priority ) const { return _waiting[priority]; }
+
+        /** Number of tickets given out, and how many and how long of those had to wait. */
+        long long admitted() const { return _admitted; }
+        long long queued() const { return _queued; }
+        long long queuedMicros() const { return _queuedMicros; }
+
+    private:
+        bool _free() const { return _outof <= 0 || _used < _outof; }
+
+        int _waitingAtOrAbove( int priority ) const {
+            int n = 0;
+            for ( int i = priority; i < kNumPriorities; i++ ) {
+                n += _waiting[i];
+            }
+            return n;
+        }
+
+        void _wakeNext() {
+            for ( int i = kNumPriorities - 1; i >= 0; i-- ) {
+                if ( _waiting[i] > 0 ) {
+                    _newTicket[i].notify_one();
+                    return;
+                }
+            }
+        }
+
+        int _outof;
+        int _used;
+        int _waiting[kNumPriorities];
+        long long _admitted;
+        long long _queued;
+        long long _queuedMicros;
+        mongo::mutex _mutex;
+        boost::condition_variable_any _newTicket[kNumPriorities];
+    };
+
     class ScopedTicket {
     public:
 
@@ -0,0 +1,217 @@
+// flat_hash_set.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    /**
+     * A hash set kept in one array, for small keys that are cheap to copy (DiskLoc, ids).
+     * Unlike unordered_set, it allocates nothing per key: inserting is a probe into the array,
+     * and the array is reallocated only when it doubles.
+     *
+     * Collisions are resolved by linear probing, and erase shifts the following keys back, so
+     * there are no tombstones and lookups stay short after many erases.  The hasher's result is
+     * mixed before use, so weak hashers (identity hashes of ints) work well.
+     *
+     * Any insert or erase invalidates iterators.  K needs a default constructor.
+     */
+    template< typename K, typename H, typename E = std::equal_to<K> >
+    class FlatHashSet {
+    public:
+        typedef K key_type;
+        typedef K value_type;
+
+        FlatHashSet() : _size( 0 ) {}
+
+        size_t size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        /** Bytes taken by the set's arrays, which hold about 1.5 to 3 slots per key. */
+        size_t memUsage() const {
+            return _keys.capacity() * sizeof( K ) + _used.capacity() * sizeof( char );
+        }
+
+        /**
+         * @return true if 'key' was added, false if it was there already
+         */
+        bool insert( const K& key ) {
+            if ( ( _size + 1 ) * 2 > _keys.size() )
+                _grow();
+            size_t pos = _home( key );
+            while ( _used[pos] ) {
+                if ( _equals( _keys[pos], key ) )
+                    return false;
+                pos = ( pos + 1 ) & _mask();
+            }
+            _keys[pos] = key;
+            _used[pos] = true;
+            _size++;
+            return true;
+        }
+
+        size_t count( const K& key ) const { return _find( key ) < 0 ? 0 : 1; }
+
+        /**
+         * @return number of keys removed
+         */
+        size_t erase( const K& key ) {
+            const long long pos = _find( key );
+            if ( pos < 0 )
+                return 0;
+            _erasePos( pos );
+            return 1;
+        }
+
+        void clear() {
+            _keys.clear();
+            _used.clear();
+            _size = 0;
+        }
+
+        class const_iterator {
+        public:
+            const_iterator() : _set( NULL ), _pos( 0 ) {}
+
+            const K& operator*() const { return _set->_keys[_pos]; }
+            const K* operator->() const { return &_set->_keys[_pos]; }
+
+            const_iterator& operator++() {
+                _pos++;
+                _skip();
+                return *this;
+            }
+
+            bool operator==( const const_iterator& other ) const { return _pos == other._pos; }
+            bool operator!=( const const_iterator& other ) const { return _pos != other._pos; }
+
+        private:
+            friend class FlatHashSet;
+
+            const_iterator( const FlatHashSet* set, size_t pos ) : _set( set ), _pos( pos ) {}
+
+            void _skip() {
+                while ( _pos < _set->_used.size() && ! _set->_used[_pos] )
+                    _pos++;
+            }
+
+            const FlatHashSet* _set;
+            size_t _pos; // _used.size() at the end
+        };
+        typedef const_iterator iterator;
+
+        const_iterator begin() const {
+            const_iterator it( this, 0 );
+            it._skip();
+            return it;
+        }
+
+        const_iterator end() const { return const_iterator( this, _used.size() ); }
+
+        const_iterator find( const K& key ) const {
+            const long long pos = _find( key );
+            return pos < 0 ? end() : const_iterator( this, pos );
+        }
+
+        void erase( const const_iterator& it ) { _erasePos( it._pos ); }
+
+        void swap( FlatHashSet& other ) {
+            _keys.swap( other._keys );
+            _used.swap( other._used );
+            std::swap( _size, other._size );
+        }
+
+    private:
+        size_t _mask() const { return _keys.size() - 1; }
+
+        size_t _home( const K& key ) const {
+            // murmur3's finalizer
+            uint64_t h = _hash( key );
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return static_cast<size_t>( h ) & _mask();
+        }
+
+        long long _find( const K& key ) const {
+            if ( _size == 0 )
+                return -1;
+            size_t pos = _home( key );
+            while ( _used[pos] ) {
+                if ( _equals( _keys[pos], key ) )
+                    return pos;
+                pos = ( pos + 1 ) & _mask();
+            }
+            return -1;
+        }
+
+        void _erasePos( size_t hole ) {
+            _used[hole] = false;
+            _size--;
+
+            // Move back each following key whose probe sequence passes over the hole.
+            size_t pos = hole;
+            while ( true ) {
+                pos = ( pos + 1 ) & _mask();
+                if ( ! _used[pos] )
+                    return;
+                const size_t home = _home( _keys[pos] );
+                const bool homeInRange = hole <= pos ? ( hole < home && home <= pos )
+                                                     : ( hole < home || home <= pos );
+                if ( homeInRange )
+                    continue;
+                _keys[hole] = _keys[pos];
+                _used[hole] = true;
+                _used[pos] = false;
+                hole = pos;
+            }
+        }
+
+        void _grow() {
+            std::vector<K> oldKeys;
+            std::vector<char> oldUsed;
+            oldKeys.swap( _keys );
+            oldUsed.swap( _used );
+
+            const size_t capacity = oldKeys.empty() ? 16 : oldKeys.size() * 2;
+            _keys.resize( capacity );
+            _used.resize( capacity, false );
+            _size = 0;
+            for ( size_t i = 0; i < oldKeys.size(); i++ ) {
+                if ( oldUsed[i] )
+                    insert( oldKeys[i] );
+            }
+        }
+
+        std::vector<K> _keys; // size is 0 or a power of 2
+        std::vector<char> _used;
+        size_t _size;
+        H _hash;
+        E _equals;
+    };
+
+}  // namespace mongo
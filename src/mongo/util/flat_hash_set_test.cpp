@@ -0,0 +1,142 @@
+// flat_hash_set_test.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/unittest/unittest.h"
+
+#include <set>
+
+#include "mongo/platform/random.h"
+#include "mongo/platform/unordered_set.h"
+#include "mongo/util/flat_hash_set.h"
+
+namespace {
+    using namespace mongo;
+
+    typedef FlatHashSet<int, unordered_set<int>::hasher> IntSet;
+
+    TEST(FlatHashSetTest, Basic) {
+        IntSet s;
+        ASSERT( s.empty() );
+        ASSERT( s.insert( 5 ) );
+        ASSERT( ! s.insert( 5 ) );
+        ASSERT_EQUALS( 1U, s.size() );
+        ASSERT_EQUALS( 1U, s.count( 5 ) );
+        ASSERT_EQUALS( 0U, s.count( 6 ) );
+        ASSERT( s.find( 5 ) != s.end() );
+        ASSERT_EQUALS( 5, *s.find( 5 ) );
+        ASSERT( s.find( 6 ) == s.end() );
+
+        ASSERT_EQUALS( 0U, s.erase( 6 ) );
+        ASSERT_EQUALS( 1U, s.erase( 5 ) );
+        ASSERT( s.empty() );
+        ASSERT( s.find( 5 ) == s.end() );
+    }
+
+    TEST(FlatHashSetTest, Iterate) {
+        IntSet s;
+        ASSERT( s.begin() == s.end() );
+        for ( int i = 0; i < 100; i++ )
+            s.insert( i * 7 );
+
+        std::set<int> seen;
+        for ( IntSet::const_iterator it = s.begin(); it != s.end(); ++it )
+            seen.insert( *it );
+        ASSERT_EQUALS( 100U, seen.size() );
+        ASSERT_EQUALS( 0, *seen.begin() );
+        ASSERT_EQUALS( 99 * 7, *seen.rbegin() );
+    }
+
+    TEST(FlatHashSetTest, EraseByIterator) {
+        IntSet s;
+        s.insert( 1 );
+        s.insert( 2 );
+        s.erase( s.find( 1 ) );
+        ASSERT_EQUALS( 1U, s.size() );
+        ASSERT_EQUALS( 0U, s.count( 1 ) );
+        ASSERT_EQUALS( 1U, s.count( 2 ) );
+    }
+
+    TEST(FlatHashSetTest, ClearAndSwap) {
+        IntSet a;
+        IntSet b;
+        a.insert( 1 );
+        a.insert( 2 );
+        a.swap( b );
+        ASSERT( a.empty() );
+        ASSERT_EQUALS( 2U, b.size() );
+        b.clear();
+        ASSERT( b.empty() );
+        ASSERT( b.insert( 3 ) );
+    }
+
+    // Random inserts and erases, checked against unordered_set; erase shifts keys around, so
+    // this covers probe chains that wrap around the end of the array.
+    TEST(FlatHashSetTest, MatchesUnorderedSet) {
+        PseudoRandom rand( 17 );
+        IntSet s;
+        unordered_set<int> expected;
+        for ( int i = 0; i < 100000; i++ ) {
+            const int key = rand.nextInt32( 5000 );
+            if ( rand.nextInt32( 3 ) == 0 ) {
+                ASSERT_EQUALS( expected.erase( key ), s.erase( key ) );
+            }
+            else {
+                ASSERT_EQUALS( expected.insert( key ).second, s.insert( key ) );
+            }
+            ASSERT_EQUALS( expected.size(), s.size() );
+        }
+
+        for ( int key = 0; key < 5000; key++ )
+            ASSERT_EQUALS( expected.count( key ), s.count( key ) );
+
+        size_t iterated = 0;
+        for ( IntSet::const_iterator it = s.begin(); it != s.end(); ++it ) {
+            ASSERT_EQUALS( 1U, expected.count( *it ) );
+            iterated++;
+        }
+        ASSERT_EQUALS( expected.size(), iterated );
+    }
+
+    // An identity hash of keys that are all multiples of 1024, which the mixing spreads out.
+    TEST(FlatHashSetTest, WeakHash) {
+        IntSet s;
+        for ( int i = 0; i < 10000; i++ )
+            ASSERT( s.insert( i * 1024 ) );
+        for ( int i = 0; i < 10000; i++ )
+            ASSERT_EQUALS( 1U, s.count( i * 1024 ) );
+        ASSERT_EQUALS( 0U, s.count( 1 ) );
+    }
+
+    TEST(FlatHashSetTest, MemUsage) {
+        IntSet s;
+        ASSERT_EQUALS( 0U, s.memUsage() );
+
+        for ( int i = 0; i < 1000; i++ )
+            s.insert( i );
+        // At most half full, at least a quarter.
+        const size_t slotBytes = sizeof( int ) + sizeof( char );
+        ASSERT_GREATER_THAN_OR_EQUALS( s.memUsage(), 2000 * slotBytes );
+        ASSERT_LESS_THAN_OR_EQUALS( s.memUsage(), 4000 * slotBytes );
+
+        // Erasing keeps the arrays.
+        const size_t full = s.memUsage();
+        for ( int i = 0; i < 1000; i++ )
+            s.erase( i );
+        ASSERT_EQUALS( full, s.memUsage() );
+    }
+
+}  // namespace
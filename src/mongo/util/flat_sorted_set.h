@@ -0,0 +1,116 @@
+// flat_sorted_set.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace mongo {
+
+    /**
+     * An ordered set kept in a vector, for sets that are built up with many inserts and then
+     * read in order, where std::set would allocate a node per key.  Inserts append; the vector
+     * is sorted, and duplicates dropped, the next time the set is read.  Erasing a single key
+     * moves the keys after it, so it suits sets that are erased from rarely, or from the front.
+     *
+     * Any insert or erase invalidates iterators.
+     */
+    template< typename T, typename Compare = std::less<T> >
+    class FlatSortedSet {
+    public:
+        typedef T key_type;
+        typedef T value_type;
+        typedef typename std::vector<T>::const_iterator const_iterator;
+        typedef const_iterator iterator;
+
+        FlatSortedSet() : _sorted( true ) {}
+
+        void insert( const T& key ) {
+            if ( _sorted && ! _keys.empty() && ! _less( _keys.back(), key ) )
+                _sorted = false;
+            _keys.push_back( key );
+        }
+
+        size_t size() const { _sort(); return _keys.size(); }
+
+        bool empty() const { return _keys.empty(); }
+
+        const_iterator begin() const { _sort(); return _keys.begin(); }
+
+        const_iterator end() const { _sort(); return _keys.end(); }
+
+        const_iterator find( const T& key ) const {
+            _sort();
+            const_iterator it = std::lower_bound( _keys.begin(), _keys.end(), key, _less );
+            if ( it == _keys.end() || _less( key, *it ) )
+                return _keys.end();
+            return it;
+        }
+
+        size_t count( const T& key ) const { return find( key ) == end() ? 0 : 1; }
+
+        /**
+         * @return number of keys removed
+         */
+        size_t erase( const T& key ) {
+            const_iterator it = find( key );
+            if ( it == _keys.end() )
+                return 0;
+            _keys.erase( _keys.begin() + ( it - _keys.begin() ) );
+            return 1;
+        }
+
+        void erase( const_iterator first, const_iterator last ) {
+            _keys.erase( _keys.begin() + ( first - _keys.begin() ),
+                         _keys.begin() + ( last - _keys.begin() ) );
+        }
+
+        void clear() {
+            _keys.clear();
+            _sorted = true;
+        }
+
+        void reserve( size_t n ) { _keys.reserve( n ); }
+
+    private:
+        void _sort() const {
+            if ( _sorted )
+                return;
+            std::sort( _keys.begin(), _keys.end(), _less );
+            _keys.erase( std::unique( _keys.begin(), _keys.end(), Equivalent( _less ) ),
+                         _keys.end() );
+            _sorted = true;
+        }
+
+        struct Equivalent {
+            explicit Equivalent( const Compare& less ) : _less( less ) {}
+            bool operator()( const T& a, const T& b ) const {
+                return ! _less( a, b ) && ! _less( b, a );
+            }
+            Compare _less;
+        };
+
+        // Sorted lazily, so that const readers can sort
+        mutable std::vector<T> _keys;
+        mutable bool _sorted;
+        Compare _less;
+    };
+
+}  // namespace mongo
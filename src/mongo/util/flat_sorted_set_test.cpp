@@ -0,0 +1,87 @@
+// flat_sorted_set_test.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/unittest/unittest.h"
+
+#include <functional>
+
+#include "mongo/util/flat_sorted_set.h"
+
+namespace {
+    using namespace mongo;
+
+    typedef FlatSortedSet<int> IntSet;
+
+    TEST(FlatSortedSetTest, SortsAndDedupsOnRead) {
+        IntSet s;
+        ASSERT( s.empty() );
+        s.insert( 3 );
+        s.insert( 1 );
+        s.insert( 2 );
+        s.insert( 3 );
+        ASSERT_EQUALS( 3U, s.size() );
+
+        int expected = 1;
+        for ( IntSet::const_iterator it = s.begin(); it != s.end(); ++it )
+            ASSERT_EQUALS( expected++, *it );
+        ASSERT_EQUALS( 4, expected );
+    }
+
+    TEST(FlatSortedSetTest, FindAndErase) {
+        IntSet s;
+        for ( int i = 10; i > 0; i-- )
+            s.insert( i * 2 );
+
+        ASSERT( s.find( 4 ) != s.end() );
+        ASSERT( s.find( 5 ) == s.end() );
+        ASSERT_EQUALS( 1U, s.count( 20 ) );
+        ASSERT_EQUALS( 0U, s.count( 21 ) );
+
+        ASSERT_EQUALS( 1U, s.erase( 4 ) );
+        ASSERT_EQUALS( 0U, s.erase( 4 ) );
+        ASSERT_EQUALS( 9U, s.size() );
+
+        // erase from the front, as a consumer working through the set would
+        IntSet::const_iterator it = s.begin();
+        ++it;
+        ++it;
+        s.erase( s.begin(), it );
+        ASSERT_EQUALS( 7U, s.size() );
+        ASSERT_EQUALS( 8, *s.begin() );
+    }
+
+    TEST(FlatSortedSetTest, InsertAfterRead) {
+        IntSet s;
+        s.insert( 5 );
+        ASSERT_EQUALS( 5, *s.begin() );
+        s.insert( 1 );
+        s.insert( 5 );
+        ASSERT_EQUALS( 2U, s.size() );
+        ASSERT_EQUALS( 1, *s.begin() );
+        s.clear();
+        ASSERT( s.empty() );
+    }
+
+    TEST(FlatSortedSetTest, CustomOrder) {
+        FlatSortedSet<int, std::greater<int> > s;
+        s.insert( 1 );
+        s.insert( 3 );
+        s.insert( 2 );
+        ASSERT_EQUALS( 3, *s.begin() );
+    }
+
+}  // namespace
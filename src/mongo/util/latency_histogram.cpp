@@ -0,0 +1,125 @@
+// @file latency_histogram.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/util/latency_histogram.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "mongo/util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+    // each thread takes the next stripe number the first time it records
+    struct LatencyHistogramStripe {
+        explicit LatencyHistogramStripe( unsigned i ) : index( i ) {}
+        unsigned index;
+    };
+
+    TSP_DECLARE(LatencyHistogramStripe, latencyHistogramStripe)
+    TSP_DEFINE(LatencyHistogramStripe, latencyHistogramStripe)
+
+    namespace {
+        AtomicUInt32 nextStripe;
+
+        unsigned threadStripe() {
+            LatencyHistogramStripe* stripe = latencyHistogramStripe.get();
+            if ( !stripe ) {
+                stripe = new LatencyHistogramStripe( nextStripe.fetchAndAdd( 1 ) );
+                latencyHistogramStripe.reset( stripe );
+            }
+            return stripe->index;
+        }
+    }
+
+    const int LatencyHistogram::kSubBuckets;
+    const int LatencyHistogram::kNumBuckets;
+    const int LatencyHistogram::kDefaultStripes;
+
+    LatencyHistogram::Snapshot::Snapshot() : count( 0 ), totalMicros( 0 ) {
+        memset( buckets, 0, sizeof( buckets ) );
+    }
+
+    void LatencyHistogram::Snapshot::add( const Snapshot& other ) {
+        count += other.count;
+        totalMicros += other.totalMicros;
+        for ( int i = 0; i < kNumBuckets; i++ )
+            buckets[i] += other.buckets[i];
+    }
+
+    unsigned long long LatencyHistogram::Snapshot::percentile( double percentile ) const {
+        unsigned long long total = 0;
+        for ( int i = 0; i < kNumBuckets; i++ )
+            total += buckets[i];
+        if ( total == 0 )
+            return 0;
+        unsigned long long rank =
+            std::max( 1ULL, static_cast<unsigned long long>( ceil( total * percentile / 100 ) ) );
+        unsigned long long seen = 0;
+        for ( int i = 0; i < kNumBuckets; i++ ) {
+            seen += buckets[i];
+            if ( seen >= rank )
+                return bucketMaxMicros( i );
+        }
+        return bucketMaxMicros( kNumBuckets - 1 );
+    }
+
+    LatencyHistogram::LatencyHistogram( int stripes )
+        : _numStripes( stripes ), _stripes( new Stripe[stripes] ) {
+    }
+
+    void LatencyHistogram::record( unsigned long long micros ) {
+        Stripe& s = _stripes[ threadStripe() % _numStripes ];
+        s.count.fetchAndAdd( 1 );
+        s.totalMicros.fetchAndAdd( micros );
+        s.buckets[ bucketFor( micros ) ].fetchAndAdd( 1 );
+    }
+
+    void LatencyHistogram::snapshot( Snapshot* out ) const {
+        *out = Snapshot();
+        for ( int i = 0; i < _numStripes; i++ ) {
+            const Stripe& s = _stripes[i];
+            out->count += s.count.load();
+            out->totalMicros += s.totalMicros.load();
+            for ( int j = 0; j < kNumBuckets; j++ )
+                out->buckets[j] += s.buckets[j].load();
+        }
+    }
+
+    int LatencyHistogram::bucketFor( unsigned long long micros ) {
+        if ( micros < static_cast<unsigned long long>( kSubBuckets ) )
+            return static_cast<int>( micros );
+        int exponent = 4;
+        while ( exponent < 63 && ( micros >> ( exponent + 1 ) ) )
+            ++exponent;
+        int bucket = ( exponent - 3 ) * kSubBuckets +
+                     static_cast<int>( ( micros >> ( exponent - 4 ) ) & ( kSubBuckets - 1 ) );
+        return std::min( bucket, kNumBuckets - 1 );
+    }
+
+    unsigned long long LatencyHistogram::bucketMaxMicros( int bucket ) {
+        if ( bucket < kSubBuckets )
+            return bucket;
+        int shift = bucket / kSubBuckets - 1;
+        unsigned long long lowest =
+            static_cast<unsigned long long>( kSubBuckets + bucket % kSubBuckets ) << shift;
+        return lowest + ( 1ULL << shift ) - 1;
+    }
+
+} // namespace mongo
@@ -0,0 +1,91 @@
+// @file latency_histogram.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * A histogram of latencies in microseconds, cheap enough to fill in for every operation.
+     *
+     * Latencies are counted in buckets a sixteenth of a power of two wide, one microsecond wide
+     * below 16, so a percentile read from it is at most a sixteenth too high.  The buckets are
+     * the same everywhere, so histograms from several threads or servers add bucket by bucket.
+     *
+     * record() takes no lock.  The counters are kept in several stripes, and each thread
+     * records into one of them, so that threads recording at the same time seldom share a
+     * cache line.
+     */
+    class LatencyHistogram : private boost::noncopyable {
+    public:
+        static const int kSubBuckets = 16;
+
+        /** Latencies of 2^40 micros, about twelve days, or more share the last bucket. */
+        static const int kNumBuckets = ( 40 - 3 ) * kSubBuckets;
+
+        static const int kDefaultStripes = 8;
+
+        /** What a histogram held at one moment.  Snapshots of several histograms add up. */
+        struct Snapshot {
+            Snapshot();
+
+            void add( const Snapshot& other );
+
+            /**
+             * @return the micros that 'percentile' percent of the latencies took no longer
+             * than, to the top of the bucket that latency is in; 0 if there are none.
+             */
+            unsigned long long percentile( double percentile ) const;
+
+            unsigned long long count;
+            unsigned long long totalMicros;
+            unsigned long long buckets[kNumBuckets];
+        };
+
+        explicit LatencyHistogram( int stripes = kDefaultStripes );
+
+        void record( unsigned long long micros );
+
+        /**
+         * Fills in out with the counts so far.  While other threads record, the counts of
+         * different buckets may be a few operations apart.
+         */
+        void snapshot( Snapshot* out ) const;
+
+        static int bucketFor( unsigned long long micros );
+
+        /** @return the largest latency counted in bucket. */
+        static unsigned long long bucketMaxMicros( int bucket );
+
+    private:
+        struct Stripe {
+            AtomicUInt64 count;
+            AtomicUInt64 totalMicros;
+            AtomicUInt64 buckets[kNumBuckets];
+            char pad[64];   // keeps the next stripe's counts off this one's last cache line
+        };
+
+        const int _numStripes;
+        boost::scoped_array<Stripe> _stripes;
+    };
+
+} // namespace mongo
@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/latency_histogram.h"
+
+namespace {
+
+    using mongo::LatencyHistogram;
+
+    TEST(LatencyHistogram, BucketsCoverEveryLatencyOnce) {
+        for ( unsigned long long micros = 0; micros < 100000; micros++ ) {
+            int bucket = LatencyHistogram::bucketFor( micros );
+            ASSERT_LESS_THAN_OR_EQUALS( micros, LatencyHistogram::bucketMaxMicros( bucket ) );
+            if ( bucket > 0 )
+                ASSERT_LESS_THAN( LatencyHistogram::bucketMaxMicros( bucket - 1 ), micros );
+            // no more than a sixteenth too high
+            ASSERT_LESS_THAN_OR_EQUALS( LatencyHistogram::bucketMaxMicros( bucket ) - micros,
+                                        micros / 16 );
+        }
+    }
+
+    TEST(LatencyHistogram, LongLatenciesShareTheLastBucket) {
+        ASSERT_EQUALS( LatencyHistogram::kNumBuckets - 1,
+                       LatencyHistogram::bucketFor( 1ULL << 40 ) );
+        ASSERT_EQUALS( LatencyHistogram::kNumBuckets - 1,
+                       LatencyHistogram::bucketFor( ~0ULL ) );
+        ASSERT_LESS_THAN( LatencyHistogram::bucketFor( ( 1ULL << 40 ) - 1 ),
+                          LatencyHistogram::kNumBuckets );
+    }
+
+    TEST(LatencyHistogram, Percentiles) {
+        LatencyHistogram h;
+        for ( int i = 1; i <= 1000; i++ )
+            h.record( i );
+
+        LatencyHistogram::Snapshot s;
+        h.snapshot( &s );
+        ASSERT_EQUALS( 1000U, s.count );
+        ASSERT_EQUALS( 500500U, s.totalMicros );
+        ASSERT_EQUALS( LatencyHistogram::bucketMaxMicros( LatencyHistogram::bucketFor( 500 ) ),
+                       s.percentile( 50 ) );
+        ASSERT_EQUALS( LatencyHistogram::bucketMaxMicros( LatencyHistogram::bucketFor( 990 ) ),
+                       s.percentile( 99 ) );
+        ASSERT_EQUALS( LatencyHistogram::bucketMaxMicros( LatencyHistogram::bucketFor( 1000 ) ),
+                       s.percentile( 100 ) );
+        ASSERT_EQUALS( 1U, s.percentile( 0 ) );
+
+        LatencyHistogram::Snapshot none;
+        ASSERT_EQUALS( 0U, none.percentile( 50 ) );
+    }
+
+    void recordMany( LatencyHistogram* h, int n ) {
+        for ( int i = 0; i < n; i++ )
+            h->record( i % 100 );
+    }
+
+    TEST(LatencyHistogram, RecordsFromManyThreads) {
+        LatencyHistogram h;
+        boost::thread_group threads;
+        for ( int i = 0; i < 16; i++ )
+            threads.create_thread( boost::bind( recordMany, &h, 10000 ) );
+        threads.join_all();
+
+        LatencyHistogram::Snapshot s;
+        h.snapshot( &s );
+        ASSERT_EQUALS( 160000U, s.count );
+        unsigned long long inBuckets = 0;
+        for ( int i = 0; i < LatencyHistogram::kNumBuckets; i++ )
+            inBuckets += s.buckets[i];
+        ASSERT_EQUALS( 160000U, inBuckets );
+    }
+
+    TEST(LatencyHistogram, SnapshotsAdd) {
+        LatencyHistogram a( 1 );
+        LatencyHistogram b;
+        a.record( 10 );
+        b.record( 10 );
+        b.record( 5000 );
+
+        LatencyHistogram::Snapshot sa;
+        LatencyHistogram::Snapshot sb;
+        a.snapshot( &sa );
+        b.snapshot( &sb );
+        sa.add( sb );
+        ASSERT_EQUALS( 3U, sa.count );
+        ASSERT_EQUALS( 5020U, sa.totalMicros );
+        ASSERT_EQUALS( 2U, sa.buckets[ LatencyHistogram::bucketFor( 10 ) ] );
+        ASSERT_EQUALS( 1U, sa.buckets[ LatencyHistogram::bucketFor( 5000 ) ] );
+    }
+
+} // namespace
@@ -187,6 +187,20 @@ namespace mongo {
         _direct = false;
 #endif
 
+        _dsync = false;
+#if defined(__linux__) && defined(O_DSYNC)
+        // with direct i/o, O_DSYNC makes each append a single write to the device (with FUA where
+        // supported) rather than a write followed by a cache flush from fdatasync.
+        if( _fd >= 0 && _direct ) {
+            int dsyncFd = open(name.c_str(), options | O_DSYNC, S_IRUSR | S_IWUSR);
+            if( dsyncFd >= 0 ) {
+                close(_fd);
+                _fd = dsyncFd;
+                _dsync = true;
+            }
+        }
+#endif
+
         if( _fd < 0 ) {
             uasserted(13516, str::stream() << "couldn't open file " << name << " for writing " << errnoWithDescription());
         }
@@ -256,7 +270,7 @@ namespace mongo {
             charsToWrite -= written;
         }
 
-        if( 
+        if( !_dsync &&
 #if defined(__linux__)
            fdatasync(_fd) < 0 
 #else
@@ -65,6 +65,7 @@ namespace mongo {
 #endif
         fd_type _fd;
         bool _direct; // are we using direct I/O
+        bool _dsync;  // opened O_DSYNC: a write returns once it is on disk, no separate fdatasync
     };
 
 }
@@ -0,0 +1,45 @@
+// @file memory_use.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/memory_use.h"
+
+namespace mongo {
+
+    namespace {
+        // MemoryUses are globals, so all register here during static initialization, before
+        // any thread can look.
+        std::vector<const MemoryUse*>& registry() {
+            static std::vector<const MemoryUse*> all;
+            return all;
+        }
+    }
+
+    MemoryUse::MemoryUse( const char* name ) : _name( name ) {
+        registry().push_back( this );
+    }
+
+    void MemoryUse::getAll( std::vector<const MemoryUse*>* all ) {
+        *all = registry();
+    }
+
+    MemoryUse queryExecMemoryUse( "queryExec" );
+    MemoryUse sorterMemoryUse( "sorter" );
+    MemoryUse receiveBufferMemoryUse( "receiveBuffers" );
+
+} // namespace mongo
@@ -0,0 +1,97 @@
+// @file memory_use.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * Bytes held by one of the server's subsystems, as the subsystem counts them, for the
+     * "memoryUse" serverStatus section.  A change costs one atomic add, so subsystems count
+     * where they take memory in chunks (a buffer, a document buffered to sort), not every
+     * allocation.  Instances must be globals, as they register themselves for good.
+     */
+    class MemoryUse {
+        MONGO_DISALLOW_COPYING(MemoryUse);
+    public:
+        explicit MemoryUse( const char* name );
+
+        void add( long long bytes ) { _bytes.addAndFetch( bytes ); }
+        void subtract( long long bytes ) { _bytes.subtractAndFetch( bytes ); }
+
+        const char* name() const { return _name; }
+        long long bytes() const { return _bytes.load(); }
+
+        /** Fills all with every subsystem counted. */
+        static void getAll( std::vector<const MemoryUse*>* all );
+
+    private:
+        const char* const _name;
+        AtomicInt64 _bytes;
+    };
+
+    // Buffered by the sort and hash-AND query stages.
+    extern MemoryUse queryExecMemoryUse;
+
+    // The in-memory data of Sorters: index builds, aggregation $sort and $group spills.
+    extern MemoryUse sorterMemoryUse;
+
+    // Pooled network receive buffers, in use or kept for reuse by connection threads.
+    extern MemoryUse receiveBufferMemoryUse;
+
+    /**
+     * A count of bytes held by one operation, added to a MemoryUse as it changes and taken back
+     * out when it goes away.  Stands in for a size_t member that counted the bytes before.
+     */
+    class TrackedBytes {
+        MONGO_DISALLOW_COPYING(TrackedBytes);
+    public:
+        explicit TrackedBytes( MemoryUse* use ) : _use( use ), _bytes( 0 ) {}
+        ~TrackedBytes() { _use->subtract( _bytes ); }
+
+        TrackedBytes& operator+=( size_t bytes ) {
+            _bytes += bytes;
+            _use->add( bytes );
+            return *this;
+        }
+
+        TrackedBytes& operator-=( size_t bytes ) {
+            _bytes -= bytes;
+            _use->subtract( bytes );
+            return *this;
+        }
+
+        TrackedBytes& operator=( size_t bytes ) {
+            _use->add( static_cast<long long>( bytes ) - static_cast<long long>( _bytes ) );
+            _bytes = bytes;
+            return *this;
+        }
+
+        operator size_t() const { return _bytes; }
+
+    private:
+        MemoryUse* const _use;
+        size_t _bytes;
+    };
+
+} // namespace mongo
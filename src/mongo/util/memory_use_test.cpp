@@ -0,0 +1,65 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/memory_use.h"
+
+namespace {
+
+    using mongo::MemoryUse;
+    using mongo::TrackedBytes;
+
+    MemoryUse testMemoryUse( "test" );
+
+    TEST( MemoryUse, Registered ) {
+        std::vector<const MemoryUse*> all;
+        MemoryUse::getAll( &all );
+
+        std::vector<std::string> names;
+        for ( size_t i = 0; i < all.size(); ++i )
+            names.push_back( all[i]->name() );
+        ASSERT( std::find( names.begin(), names.end(), "queryExec" ) != names.end() );
+        ASSERT( std::find( names.begin(), names.end(), "sorter" ) != names.end() );
+        ASSERT( std::find( names.begin(), names.end(), "receiveBuffers" ) != names.end() );
+        ASSERT( std::find( all.begin(), all.end(), &testMemoryUse ) != all.end() );
+    }
+
+    TEST( TrackedBytes, AddsToItsUse ) {
+        {
+            TrackedBytes a( &testMemoryUse );
+            TrackedBytes b( &testMemoryUse );
+            a += 100;
+            b += 50;
+            ASSERT_EQUALS( 150, testMemoryUse.bytes() );
+
+            a -= 30;
+            ASSERT_EQUALS( 70U, static_cast<size_t>( a ) );
+            ASSERT_EQUALS( 120, testMemoryUse.bytes() );
+
+            b = 10;
+            ASSERT_EQUALS( 80, testMemoryUse.bytes() );
+            a = 0;
+            ASSERT_EQUALS( 10, testMemoryUse.bytes() );
+            a += 5;
+        }
+        // What is left goes when they do.
+        ASSERT_EQUALS( 0, testMemoryUse.bytes() );
+    }
+
+}  // namespace
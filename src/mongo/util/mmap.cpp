@@ -27,6 +27,7 @@
 #include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/startup_test.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -188,6 +189,61 @@ namespace {
         return seen.size();
     }
 
+    /*static*/ int MongoFile::flushAllPaced( long long passMillis, PacedFlushStats* stats ) {
+        notifyPreFlush();
+
+        // the files open now hold everything written before this pass
+        vector< pair<MongoFile*, unsigned long long> > files;
+        long long chunksLeft = 0;
+        {
+            LockMongoFilesShared lk;
+            for ( set<MongoFile*>::iterator i = mmfiles.begin(); i != mmfiles.end(); i++ ) {
+                MongoFile * mmf = *i;
+                if ( ! mmf )
+                    continue;
+                unsigned long long len = mmf->length();
+                files.push_back( make_pair( mmf, len ) );
+                chunksLeft += ( len + FlushChunkSize - 1 ) / FlushChunkSize;
+            }
+        }
+
+        Timer pass;
+        for ( unsigned i = 0; i < files.size(); i++ ) {
+            MongoFile * const mmf = files[i].first;
+            for ( unsigned long long ofs = 0; ofs < files[i].second; ofs += FlushChunkSize ) {
+                // pace by what is left of the pass, less what a flush has been taking
+                long long pause = ( passMillis * 1000 - (long long) pass.micros() ) / chunksLeft;
+                if ( stats->chunks )
+                    pause -= stats->flushingMicros / stats->chunks;
+                chunksLeft--;
+                if ( pause >= 1000 )
+                    sleepmicros( pause );
+
+                if ( inShutdown() )
+                    return files.size();
+
+                Timer t;
+                {
+                    LockMongoFilesShared lk;
+                    if ( ! mmfiles.count( mmf ) ) {
+                        // closed since the pass began, which flushed it
+                        chunksLeft -= ( files[i].second - ofs - 1 ) / FlushChunkSize;
+                        break;
+                    }
+                    auto_ptr<Flushable> f( mmf->prepareFlush() );
+                    f->flushRange( ofs, std::min( FlushChunkSize, files[i].second - ofs ) );
+                }
+                long long micros = t.micros();
+                stats->chunks++;
+                stats->flushingMicros += micros;
+                stats->maxChunkMicros = std::max( stats->maxChunkMicros, micros );
+            }
+        }
+
+        notifyPostFlush();
+        return files.size();
+    }
+
     void MongoFile::created() {
         LockMongoFilesExclusive lk;
         mmfiles.insert(this);
@@ -38,6 +38,9 @@ namespace mongo {
         enum Advice { Sequential=1 , Random=2 };
         MAdvise(void *p, unsigned len, Advice a); 
         ~MAdvise(); // destructor resets the range to MADV_NORMAL
+
+        /** tell the os we'll soon read [p, p+len) so it can start paging it in.  doesn't block. */
+        static void willNeed(void *p, unsigned len);
     };
 
     // lock order: lock dbMutex before this if you lock both
@@ -77,8 +80,27 @@ namespace mongo {
         public:
             virtual ~Flushable() {}
             virtual void flush() = 0;
+
+            /** flush [ofs, ofs+len) of the file.  implementations that can only flush a whole
+                file do so for the range starting at 0, and nothing for the others.
+            */
+            virtual void flushRange(unsigned long long ofs, unsigned long long len) {
+                if( ofs == 0 )
+                    flush();
+            }
+        };
+
+        /** what a flushAllPaced() pass did */
+        struct PacedFlushStats {
+            PacedFlushStats() : chunks(0), flushingMicros(0), maxChunkMicros(0) { }
+            long long chunks;         // ranges flushed
+            long long flushingMicros; // time spent flushing, without the pauses between ranges
+            long long maxChunkMicros; // slowest range
         };
 
+        /** ranges of a file flushed at once by flushAllPaced() */
+        static const unsigned long long FlushChunkSize = 16 * 1024 * 1024;
+
         virtual ~MongoFile() {}
 
         enum Options {
@@ -101,6 +123,15 @@ namespace mongo {
         static void (*notifyPostFlush)();
 
         static int flushAll( bool sync ); // returns n flushed
+
+        /** sync flush of all files, a FlushChunkSize range at a time, spread over about passMillis.
+            the pauses between ranges shrink when ranges are slow to flush, so a slow device isn't
+            made to fall behind.  calls notifyPreFlush/notifyPostFlush around the whole pass, so it
+            counts as a flushAll(true) that started at its beginning.  at shutdown it stops early,
+            without calling notifyPostFlush.
+            @return n files flushed
+        */
+        static int flushAllPaced( long long passMillis, PacedFlushStats* stats );
         static long long totalMappedLength();
         static void closeAllFiles( std::stringstream &message );
 
@@ -228,6 +259,12 @@ namespace mongo {
 
         /** close the current private view and open a new replacement */
         void* remapPrivateView(void *oldPrivateAddr);
+
+#if !defined(_WIN32)
+        /** replace the pages at [ofs, ofs+len) of the private view with fresh ones from the file */
+        void remapPrivateViewRange(void *privateAddr, unsigned long long ofs,
+                                   unsigned long long len);
+#endif
     };
 
     /** p is called from within a mutex that MongoFile uses.  so be careful not to deadlock. */
@@ -70,6 +70,7 @@ namespace mongo {
 #if defined(__sunos__)
     MAdvise::MAdvise(void *,unsigned, Advice) { }
     MAdvise::~MAdvise() { }
+    void MAdvise::willNeed(void *, unsigned) { }
 #else
     MAdvise::MAdvise(void *p, unsigned len, Advice a) {
         
@@ -92,6 +93,15 @@ namespace mongo {
     MAdvise::~MAdvise() { 
         madvise(_p,_len,MADV_NORMAL);
     }
+    void MAdvise::willNeed(void *p, unsigned len) {
+        void *start = (void*)((long)p & ~(g_minOSPageSizeBytes-1));
+        len += (unsigned long long)p-(unsigned long long)start;
+
+        // only a hint, so a failure isn't worth an error
+        if ( madvise(start,len,MADV_WILLNEED) ) {
+            LOG(1) << "madvise WILLNEED failed: " << errnoWithDescription() << endl;
+        }
+    }
 #endif
 
     void* MemoryMappedFile::map(const char *filename, unsigned long long &length, int options) {
@@ -195,6 +205,25 @@ namespace mongo {
         return x;
     }
 
+    void MemoryMappedFile::remapPrivateViewRange(void *privateAddr, unsigned long long ofs,
+                                                 unsigned long long len) {
+        verify( ofs % g_minOSPageSizeBytes == 0 );
+        verify( ofs + len <= this->len );
+        char *start = static_cast<char*>(privateAddr) + ofs;
+
+        // don't unmap, just mmap over the old region
+        void * x = mmap( start, len , PROT_READ|PROT_WRITE , MAP_PRIVATE|MAP_NORESERVE|MAP_FIXED ,
+                         fd , ofs );
+        if( x == MAP_FAILED ) {
+            int err = errno;
+            error()  << "13601 Couldn't remap private view: " << errnoWithDescription(err) << endl;
+            log() << "aborting" << endl;
+            printMemInfo();
+            abort();
+        }
+        verify( x == start );
+    }
+
     void MemoryMappedFile::flush(bool sync) {
         if ( views.empty() || fd == 0 )
             return;
@@ -215,6 +244,16 @@ namespace mongo {
 
         }
 
+        void flushRange(unsigned long long ofs, unsigned long long len) {
+            if ( !_view || !_fd || ofs >= (unsigned long long) _len )
+                return;
+            // the file may have been remapped shorter since the range was chosen
+            len = std::min( len, (unsigned long long) _len - ofs );
+            verify( ofs % g_minOSPageSizeBytes == 0 );
+            if ( msync( (char *) _view + ofs, len, MS_SYNC ) )
+                problem() << "msync " << errnoWithDescription() << endl;
+        }
+
         void * _view;
         HANDLE _fd;
         long _len;
@@ -22,8 +22,12 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <time.h>
+#include <boost/thread/tss.hpp>
 
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/goodies.h"
+#include "mongo/util/memory_use.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message_port.h"
 
@@ -41,6 +45,188 @@ namespace mongo {
         }
     }
 
+namespace {
+
+    // Classes of kMinSize, doubling up to kMaxPooledSize; the first kNumCachedClasses are
+    // cached per thread.
+    const int kNumCachedClasses = 5;
+    const int kNumPooledClasses = 11;
+    BOOST_STATIC_ASSERT( MessageBufferPool::kMinSize << ( kNumCachedClasses - 1 ) ==
+                         MessageBufferPool::kMaxCachedSize );
+    BOOST_STATIC_ASSERT( MessageBufferPool::kMinSize << ( kNumPooledClasses - 1 ) ==
+                         MessageBufferPool::kMaxPooledSize );
+
+    // Buffers kept per class by a thread, and in the shared pool in all.
+    const size_t kMaxCachedPerClass = 2;
+    const size_t kMaxPooledBytesPerClass = 8 * 1024 * 1024;
+
+    struct ThreadBuffers {
+        ~ThreadBuffers() {
+            for ( int i = 0; i < kNumCachedClasses; i++ ) {
+                for ( size_t j = 0; j < buffers[i].size(); j++ ) {
+                    free( buffers[i][j] );
+                    receiveBufferMemoryUse.subtract( MessageBufferPool::kMinSize << i );
+                }
+            }
+        }
+        std::vector< MsgData* > buffers[kNumCachedClasses];
+    };
+
+    boost::thread_specific_ptr< ThreadBuffers > threadBuffers;
+
+    SimpleMutex pooledBuffersMutex( "MessageBufferPool" );
+    std::vector< MsgData* > pooledBuffers[kNumPooledClasses];
+
+    AtomicInt64 buffersReused;
+    AtomicInt64 buffersAllocated;
+
+    int sizeClass( int len ) {
+        int cls = 0;
+        while ( ( MessageBufferPool::kMinSize << cls ) < len ) {
+            cls++;
+        }
+        return cls;
+    }
+
+    std::vector< MsgData* >* freeListFor( int cls ) {
+        if ( cls < kNumCachedClasses ) {
+            ThreadBuffers* buffers = threadBuffers.get();
+            if ( !buffers ) {
+                buffers = new ThreadBuffers();
+                threadBuffers.reset( buffers );
+            }
+            return &buffers->buffers[cls];
+        }
+        return &pooledBuffers[cls];
+    }
+
+} // namespace
+
+    MsgData* MessageBufferPool::allocate( int len, int* size ) {
+        if ( len > kMaxPooledSize ) {
+            *size = 0;
+            buffersAllocated.fetchAndAdd( 1 );
+            MsgData* buf = static_cast< MsgData* >( malloc( ( len + 1023 ) & 0xfffffc00 ) );
+            verify( buf );
+            return buf;
+        }
+
+        int cls = sizeClass( len );
+        *size = kMinSize << cls;
+
+        MsgData* buf = NULL;
+        if ( cls < kNumCachedClasses ) {
+            std::vector< MsgData* >* freeList = freeListFor( cls );
+            if ( !freeList->empty() ) {
+                buf = freeList->back();
+                freeList->pop_back();
+            }
+        }
+        else {
+            SimpleMutex::scoped_lock lk( pooledBuffersMutex );
+            std::vector< MsgData* >* freeList = freeListFor( cls );
+            if ( !freeList->empty() ) {
+                buf = freeList->back();
+                freeList->pop_back();
+            }
+        }
+
+        if ( buf ) {
+            buffersReused.fetchAndAdd( 1 );
+            return buf;
+        }
+
+        buffersAllocated.fetchAndAdd( 1 );
+        buf = static_cast< MsgData* >( malloc( *size ) );
+        verify( buf );
+        receiveBufferMemoryUse.add( *size );
+        return buf;
+    }
+
+    void MessageBufferPool::release( MsgData* buf, int size ) {
+        if ( size == 0 ) {
+            free( buf );
+            return;
+        }
+
+        int cls = sizeClass( size );
+        verify( ( kMinSize << cls ) == size && cls < kNumPooledClasses );
+
+        if ( cls < kNumCachedClasses ) {
+            std::vector< MsgData* >* freeList = freeListFor( cls );
+            if ( freeList->size() < kMaxCachedPerClass ) {
+                freeList->push_back( buf );
+                return;
+            }
+        }
+        else {
+            SimpleMutex::scoped_lock lk( pooledBuffersMutex );
+            std::vector< MsgData* >* freeList = freeListFor( cls );
+            if ( freeList->size() * size < kMaxPooledBytesPerClass ) {
+                freeList->push_back( buf );
+                return;
+            }
+        }
+        free( buf );
+        receiveBufferMemoryUse.subtract( size );
+    }
+
+    long long MessageBufferPool::reused() {
+        return buffersReused.load();
+    }
+
+    long long MessageBufferPool::allocated() {
+        return buffersAllocated.load();
+    }
+
+    ChunkedMessageBuilder::ChunkedMessageBuilder( int headerSize ) : _capacity( 0 ), _len( 0 ) {
+        _newChunk( std::max( headerSize, static_cast<int>( kInitialChunkSize ) ) );
+        _chunks.back().second = headerSize;
+        _len = headerSize;
+    }
+
+    ChunkedMessageBuilder::~ChunkedMessageBuilder() {
+        for ( size_t i = 0; i < _chunks.size(); i++ ) {
+            free( _chunks[i].first );
+        }
+    }
+
+    void ChunkedMessageBuilder::_newChunk( int minSize ) {
+        // Each chunk twice the last, up to a limit, to keep the number of buffers down.
+        int size = std::max( minSize, std::min( _capacity * 2,
+                                                static_cast<int>( kMaxChunkSize ) ) );
+        char* buf = static_cast<char*>( malloc( size ) );
+        if ( buf == NULL ) {
+            msgasserted( 17301, "out of memory ChunkedMessageBuilder" );
+        }
+        _chunks.push_back( std::make_pair( buf, 0 ) );
+        _capacity = size;
+    }
+
+    void ChunkedMessageBuilder::appendBuf( const void* src, int len ) {
+        if ( _chunks.back().second + len > _capacity ) {
+            _newChunk( len );
+        }
+        std::pair< char*, int >& chunk = _chunks.back();
+        memcpy( chunk.first + chunk.second, src, len );
+        chunk.second += len;
+        _len += len;
+    }
+
+    void ChunkedMessageBuilder::appendTo( Message& m ) {
+        verify( m.empty() );
+        for ( size_t i = 0; i < _chunks.size(); i++ ) {
+            if ( _chunks[i].second > 0 ) {
+                m.appendData( _chunks[i].first, _chunks[i].second );
+            }
+            else {
+                free( _chunks[i].first );
+            }
+        }
+        _chunks.clear();
+        _len = 0;
+    }
+
     MSGID NextMsgId;
 
     /*struct MsgStart {
@@ -19,6 +19,8 @@
 
 #include <vector>
 
+#include "mongo/base/disallow_copying.h"
+
 #include "mongo/bson/util/atomic_int.h"
 #include "mongo/util/goodies.h"
 #include "mongo/util/net/hostandport.h"
@@ -46,7 +48,8 @@ namespace mongo {
         dbQuery = 2004,
         dbGetMore = 2005,
         dbDelete = 2006,
-        dbKillCursors = 2007
+        dbKillCursors = 2007,
+        dbCompressed = 2012 /* another message, snappy compressed.  see MessagingPort::say() */
     };
 
     bool doesOpGetAResponse( int op );
@@ -62,6 +65,7 @@ namespace mongo {
         case dbGetMore: return "getmore";
         case dbDelete: return "remove";
         case dbKillCursors: return "killcursors";
+        case dbCompressed: return "compressed";
         default:
             massert( 16141, str::stream() << "cannot translate opcode " << op, !op );
             return "";
@@ -150,15 +154,40 @@ namespace mongo {
     }
 #pragma pack()
 
+    /**
+     * Buffers for received messages, reused rather than freed.  Those of up to kMaxCachedSize
+     * bytes are kept by the thread that gives them back, which with a thread per connection is
+     * the connection's own, so a connection sending small messages reuses the same buffers.
+     * Larger ones, up to kMaxPooledSize, are shared through a pool of size classes.  Anything
+     * larger is malloc()ed and free()d as usual.
+     */
+    class MessageBufferPool {
+    public:
+        enum { kMinSize = 1024, kMaxCachedSize = 16 * 1024, kMaxPooledSize = 1024 * 1024 };
+
+        /**
+         * Returns a buffer of at least 'len' bytes, and sets 'size' to the size of its class,
+         * or to 0 when it is too large to pool.
+         */
+        static MsgData* allocate( int len, int* size );
+
+        /** Takes back a buffer from allocate(), given the size allocate() set. */
+        static void release( MsgData* buf, int size );
+
+        /** Buffers handed out again instead of allocated, and those allocated. */
+        static long long reused();
+        static long long allocated();
+    };
+
     class Message {
     public:
         // we assume here that a vector with initial size 0 does no allocation (0 is the default, but wanted to make it explicit).
-        Message() : _buf( 0 ), _data( 0 ), _freeIt( false ) {}
+        Message() : _buf( 0 ), _data( 0 ), _freeIt( false ), _pooledSize( 0 ) {}
         Message( void * data , bool freeIt ) :
-            _buf( 0 ), _data( 0 ), _freeIt( false ) {
+            _buf( 0 ), _data( 0 ), _freeIt( false ), _pooledSize( 0 ) {
             _setData( reinterpret_cast< MsgData* >( data ), freeIt );
         };
-        Message(Message& r) : _buf( 0 ), _data( 0 ), _freeIt( false ) {
+        Message(Message& r) : _buf( 0 ), _data( 0 ), _freeIt( false ), _pooledSize( 0 ) {
             *this = r;
         }
         ~Message() {
@@ -230,12 +259,17 @@ namespace mongo {
             }
             r._freeIt = false;
             _freeIt = true;
+            _pooledSize = r._pooledSize;
+            r._pooledSize = 0;
             return *this;
         }
 
         void reset() {
             if ( _freeIt ) {
-                if ( _buf ) {
+                if ( _buf && _pooledSize ) {
+                    MessageBufferPool::release( _buf, _pooledSize );
+                }
+                else if ( _buf ) {
                     free( _buf );
                 }
                 for (std::vector< std::pair< char *, int > >::const_iterator i = _data.begin();
@@ -246,6 +280,7 @@ namespace mongo {
             _buf = 0;
             _data.clear();
             _freeIt = false;
+            _pooledSize = 0;
         }
 
         // use to add a buffer
@@ -261,6 +296,8 @@ namespace mongo {
                 return;
             }
             verify( _freeIt );
+            // the buffers in _data are free()d
+            verify( !_pooledSize );
             if ( _buf ) {
                 _data.push_back(std::make_pair((char*)_buf, _buf->len));
                 _buf = 0;
@@ -274,6 +311,12 @@ namespace mongo {
             verify( empty() );
             _setData( d, freeIt );
         }
+        // takes a buffer from MessageBufferPool::allocate(), of the size it gave
+        void setPooledData(MsgData *d, int pooledSize) {
+            verify( empty() );
+            _setData( d, true );
+            _pooledSize = pooledSize;
+        }
         void setData(int operation, const char *msgtxt) {
             setData(operation, msgtxt, strlen(msgtxt)+1);
         }
@@ -306,6 +349,43 @@ namespace mongo {
         typedef std::vector< std::pair< char*, int > > MsgVec;
         MsgVec _data;
         bool _freeIt;
+        // non-zero when _buf goes back to MessageBufferPool
+        int _pooledSize;
+    };
+
+    /**
+     * Builds a message in a chain of buffers rather than one that grows, so that bytes written
+     * are never copied again as the message gets bigger.  The buffers are handed to a Message
+     * as they are, which sends them with a single sendmsg().  The first buffer starts with
+     * 'headerSize' bytes for the caller to fill in through header().
+     */
+    class ChunkedMessageBuilder {
+        MONGO_DISALLOW_COPYING(ChunkedMessageBuilder);
+    public:
+        enum { kInitialChunkSize = 32 * 1024, kMaxChunkSize = 1024 * 1024 };
+
+        explicit ChunkedMessageBuilder( int headerSize );
+        ~ChunkedMessageBuilder();
+
+        void appendBuf( const void* src, int len );
+
+        /** Total length, header included. */
+        int len() const { return _len; }
+
+        char* header() const { return _chunks[0].first; }
+
+        int numChunks() const { return _chunks.size(); }
+
+        /** Hands the buffers to 'm', which must be empty, and leaves this empty. */
+        void appendTo( Message& m );
+
+    private:
+        void _newChunk( int minSize );
+
+        // buffer, bytes used
+        std::vector< std::pair< char*, int > > _chunks;
+        int _capacity; // of the last chunk
+        int _len;
     };
 
 
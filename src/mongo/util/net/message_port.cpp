@@ -23,6 +23,7 @@
 #include <time.h>
 
 #include "mongo/util/background.h"
+#include "mongo/util/compress.h"
 #include "mongo/util/goodies.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
@@ -30,6 +31,7 @@
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/trace_points.h"
 
 #ifndef _WIN32
 # ifndef __sunos__
@@ -127,17 +129,28 @@ namespace mongo {
     MessagingPort::MessagingPort(int fd, const SockAddr& remote) 
         : psock( new Socket( fd , remote ) ) , piggyBackData(0) {
         ports.insert(this);
+        clearCounters();
     }
 
     MessagingPort::MessagingPort( double timeout, logger::LogSeverity ll ) 
         : psock( new Socket( timeout, ll ) ) {
         ports.insert(this);
         piggyBackData = 0;
+        clearCounters();
     }
 
     MessagingPort::MessagingPort( boost::shared_ptr<Socket> sock )
         : psock( sock ), piggyBackData( 0 ) {
         ports.insert(this);
+        clearCounters();
+    }
+
+    void MessagingPort::clearCounters() {
+        psock->clearCounters();
+        _compressedBytesIn = 0;
+        _uncompressedBytesIn = 0;
+        _compressedBytesOut = 0;
+        _uncompressedBytesOut = 0;
     }
 
     void MessagingPort::setSocketTimeout(double timeout) {
@@ -156,6 +169,15 @@ namespace mongo {
     }
     
     bool MessagingPort::recv(Message& m) {
+        if ( !_recv(m) )
+            return false;
+        if ( !_replies.empty() )
+            _replies.erase( m.header()->responseTo );
+        MONGO_TRACE_INSTANT( "network", "message received" );
+        return true;
+    }
+
+    bool MessagingPort::_recv(Message& m) {
         try {
 again:
             //mmm( log() << "*  recv() sock:" << this->sock << endl; )
@@ -209,19 +231,24 @@ again:
             }
 
             psock->setHandshakeReceived();
-            int z = (len+1023)&0xfffffc00;
-            verify(z>=len);
-            MsgData *md = (MsgData *) malloc(z);
-            ScopeGuard guard = MakeGuard(free, md);
-            verify(md);
+            int pooledSize;
+            MsgData *md = MessageBufferPool::allocate(len, &pooledSize);
+            ScopeGuard guard = MakeGuard(MessageBufferPool::release, md, pooledSize);
 
             memcpy(md, &header, headerLen);
             int left = len - headerLen;
 
+            // The wait for the header is idle time; the rest of the message is not.
+            MONGO_TRACE_SCOPE( "network", "recv message body" );
             psock->recv( (char *)&md->_data, left );
 
             guard.Dismiss();
-            m.setData(md, true);
+            m.setPooledData(md, pooledSize);
+
+            if ( m.operation() == dbCompressed && !_uncompress(m) ) {
+                m.reset();
+                return false;
+            }
             return true;
 
         }
@@ -235,6 +262,82 @@ again:
         }
     }
 
+namespace {
+
+    /* A dbCompressed message holds, after its header, the operation and the length without
+       header of the message it replaces, the compressor, and that message's data compressed.
+    */
+    const int kCompressedPrefixSize = 4 + 4 + 1;
+    const char kSnappyCompressor = 1;
+
+    bool compressMessage( Message& m, Message* out ) {
+        m.concat();
+        MsgData* md = m.singleData();
+        const int dataLen = md->dataLen();
+        const int prefixLen = MsgDataHeaderSize + kCompressedPrefixSize;
+
+        char* buf = static_cast<char*>( malloc( prefixLen + maxCompressedLength( dataLen ) ) );
+        verify( buf );
+        size_t compressedLen;
+        rawCompress( md->_data, dataLen, buf + prefixLen, &compressedLen );
+        if ( prefixLen + compressedLen >= static_cast<size_t>( md->len ) ) {
+            free( buf );
+            return false;
+        }
+
+        MsgData* c = reinterpret_cast<MsgData*>( buf );
+        c->len = prefixLen + compressedLen;
+        c->id = md->id;
+        c->responseTo = md->responseTo;
+        c->setOperation( dbCompressed );
+        *reinterpret_cast<int*>( c->_data ) = md->operation();
+        *reinterpret_cast<int*>( c->_data + 4 ) = dataLen;
+        c->_data[8] = kSnappyCompressor;
+        out->setData( c, true );
+        return true;
+    }
+
+} // namespace
+
+    bool MessagingPort::_uncompress( Message& m ) {
+        MsgData* c = m.singleData();
+        if ( c->dataLen() < kCompressedPrefixSize ) {
+            LOG(0) << "recv(): compressed message len " << c->len << " is invalid" << endl;
+            return false;
+        }
+
+        const int op = *reinterpret_cast<const int*>( c->_data );
+        const int len = MsgDataHeaderSize + *reinterpret_cast<const int*>( c->_data + 4 );
+        if ( c->_data[8] != kSnappyCompressor || op == dbCompressed ||
+             len < MsgDataHeaderSize || len > MaxMessageSizeBytes ) {
+            LOG(0) << "recv(): compressed message with op " << op << " len " << len
+                   << " compressor " << static_cast<int>( c->_data[8] ) << " is invalid" << endl;
+            return false;
+        }
+
+        int pooledSize;
+        MsgData* md = MessageBufferPool::allocate( len, &pooledSize );
+        ScopeGuard guard = MakeGuard( MessageBufferPool::release, md, pooledSize );
+        if ( !rawUncompress( c->_data + kCompressedPrefixSize,
+                             c->dataLen() - kCompressedPrefixSize,
+                             md->_data, len - MsgDataHeaderSize ) ) {
+            LOG(0) << "recv(): could not uncompress message of len " << c->len << endl;
+            return false;
+        }
+        md->len = len;
+        md->id = c->id;
+        md->responseTo = c->responseTo;
+        md->setOperation( op );
+
+        _compressedBytesIn += c->len;
+        _uncompressedBytesIn += len;
+
+        guard.Dismiss();
+        m.reset();
+        m.setPooledData( md, pooledSize );
+        return true;
+    }
+
     void MessagingPort::reply(Message& received, Message& response) {
         say(/*received.from, */response, received.header()->id);
     }
@@ -250,15 +353,32 @@ again:
     }
 
     bool MessagingPort::recv( const Message& toSend , Message& response ) {
+        const unsigned id = toSend.header()->id;
+        ReplyMap::iterator held = _replies.find( id );
+        if ( held != _replies.end() && held->second ) {
+            response = *held->second;
+            _replies.erase( held );
+            return true;
+        }
+
         while ( 1 ) {
-            bool ok = recv(response);
+            bool ok = _recv(response);
             if ( !ok ) {
                 mmm( log() << "recv not ok" << endl; )
                 return false;
             }
             //log() << "got response: " << response.data->responseTo << endl;
-            if ( response.header()->responseTo == toSend.header()->id )
+            if ( response.header()->responseTo == id )
                 break;
+
+            ReplyMap::iterator other = _replies.find( response.header()->responseTo );
+            if ( other != _replies.end() && !other->second ) {
+                // the reply to another request outstanding on this port; keep it for its caller
+                other->second.reset( new Message() );
+                *other->second = response;
+                continue;
+            }
+
             error() << "MessagingPort::call() wrong id got:" << hex << (unsigned)response.header()->responseTo << " expect:" << (unsigned)toSend.header()->id << '\n'
                     << dec
                     << "  toSend op: " << (unsigned)toSend.operation() << '\n'
@@ -269,16 +389,23 @@ again:
             verify(false);
             response.reset();
         }
+        _replies.erase( id );
         mmm( log() << "*call() end" << endl; )
         return true;
     }
 
     void MessagingPort::say(Message& toSend, int responseTo) {
         verify( !toSend.empty() );
+        MONGO_TRACE_SCOPE( "network", "send message" );
         mmm( log() << "*  say()  thr:" << GetCurrentThreadId() << endl; )
         toSend.header()->id = nextMessageId();
         toSend.header()->responseTo = responseTo;
 
+        if ( responseTo == 0 && doesOpGetAResponse( toSend.operation() ) ) {
+            // a request; note it until its reply comes in
+            _replies[ toSend.header()->id ];
+        }
+
         if ( piggyBackData && piggyBackData->len() ) {
             mmm( log() << "*     have piggy back" << endl; )
             if ( ( piggyBackData->len() + toSend.header()->len ) > 1300 ) {
@@ -292,6 +419,17 @@ again:
             }
         }
 
+        if ( compressMessages() && toSend.operation() != dbCompressed &&
+             toSend.header()->len >= kMinCompressedMessageSize ) {
+            Message compressed;
+            if ( compressMessage( toSend, &compressed ) ) {
+                _compressedBytesOut += compressed.header()->len;
+                _uncompressedBytesOut += toSend.header()->len;
+                compressed.send( *this, "say" );
+                return;
+            }
+        }
+
         toSend.send( *this, "say" );
     }
 
@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <map>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 #include "mongo/util/net/message.h"
 #include "mongo/util/net/sock.h"
@@ -31,7 +33,7 @@ namespace mongo {
 
     class AbstractMessagingPort : boost::noncopyable {
     public:
-        AbstractMessagingPort() : tag(0), _connectionId(0) {}
+        AbstractMessagingPort() : tag(0), _connectionId(0), _compressMessages(false) {}
         virtual ~AbstractMessagingPort() { }
         virtual void reply(Message& received, Message& response, MSGID responseTo) = 0; // like the reply below, but doesn't rely on received.data still being available
         virtual void reply(Message& received, Message& response) = 0;
@@ -52,6 +54,13 @@ namespace mongo {
         long long connectionId() const { return _connectionId; }
         void setConnectionId( long long connectionId );
 
+        /**
+         * Whether the other side, having asked for it in isMaster, takes compressed messages.
+         * Received messages are uncompressed whether or not this is set.
+         */
+        bool compressMessages() const { return _compressMessages; }
+        void setCompressMessages( bool compress ) { _compressMessages = compress; }
+
     public:
         // TODO make this private with some helpers
 
@@ -61,6 +70,7 @@ namespace mongo {
     private:
         long long _connectionId;
         std::string _x509SubjectName;
+        bool _compressMessages;
     };
 
     class MessagingPort : public AbstractMessagingPort {
@@ -89,6 +99,10 @@ namespace mongo {
         void reply(Message& received, Message& response);
         bool call(Message& toSend, Message& response);
 
+        /**
+         * Sends toSend, as a dbCompressed message when compressMessages() is set, toSend is at
+         * least kMinCompressedMessageSize bytes and compressing makes it smaller.
+         */
         void say(Message& toSend, int responseTo = 0);
 
         /**
@@ -97,6 +111,9 @@ namespace mongo {
          * you would do
          * say( to )
          * recv( from )
+         * Several requests may be outstanding at once, and their replies received in any
+         * order: a reply that comes in for another request said on this port is kept until
+         * recv() is called for that one.
          * Note: if you fail to call recv and someone else uses this port,
          *       horrible things will happen
          */
@@ -104,6 +121,20 @@ namespace mongo {
 
         void piggyBack( Message& toSend , int responseTo = 0 );
 
+        enum { kMinCompressedMessageSize = 1024 };
+
+        /** Resets the socket's byte counts and the compression counts below. */
+        void clearCounters();
+
+        /**
+         * Bytes received and sent on the wire as compressed messages since clearCounters(), and
+         * what those messages came to uncompressed.
+         */
+        long long getCompressedBytesIn() const { return _compressedBytesIn; }
+        long long getUncompressedBytesIn() const { return _uncompressedBytesIn; }
+        long long getCompressedBytesOut() const { return _compressedBytesOut; }
+        long long getUncompressedBytesOut() const { return _uncompressedBytesOut; }
+
         unsigned remotePort() const { return psock->remotePort(); }
         virtual HostAndPort remote() const;
         virtual SockAddr remoteAddr() const;
@@ -142,9 +173,23 @@ namespace mongo {
         }
 
     private:
-        
+        bool _recv( Message& m );
+
+        /** If m is compressed, replaces it with the message it holds. */
+        bool _uncompress( Message& m );
+
+        // Requests said on this port that have not had their reply taken yet, by id, with the
+        // reply once it has come in ahead of the one being waited for.
+        typedef std::map< unsigned, boost::shared_ptr<Message> > ReplyMap;
+        ReplyMap _replies;
+
         PiggyBackData * piggyBackData;
 
+        long long _compressedBytesIn;
+        long long _uncompressedBytesIn;
+        long long _compressedBytesOut;
+        long long _uncompressedBytesOut;
+
         // this is the parsed version of remote
         // mutable because its initialized only on call to remote()
         mutable HostAndPort _remoteParsed; 
@@ -28,6 +28,15 @@ namespace mongo {
 
     struct LastError;
 
+    /**
+     * The per-connection thread locals of a MessageHandler, moved off of the thread that served
+     * the connection's last message.  Destroying it releases them as that thread's exit would.
+     */
+    class DetachedConnectionState {
+    public:
+        virtual ~DetachedConnectionState() {}
+    };
+
     class MessageHandler {
     public:
         virtual ~MessageHandler() {}
@@ -47,6 +56,24 @@ namespace mongo {
          * called once when a socket is disconnected
          */
         virtual void disconnected( AbstractMessagingPort* p ) = 0;
+
+        /**
+         * Handlers that can move a connection's thread locals between threads may have their
+         * connections served by a pool of worker threads, so that idle connections need no thread.
+         */
+        virtual bool canDetach() const { return false; }
+
+        /**
+         * Called between messages.  Moves the calling thread's state for connection 'p' into the
+         * returned object.
+         */
+        virtual DetachedConnectionState* detach( AbstractMessagingPort* p ) { return NULL; }
+
+        /**
+         * Moves 'state', as returned by detach(), onto the calling thread, and takes ownership of
+         * it.
+         */
+        virtual void attach( AbstractMessagingPort* p, DetachedConnectionState* state ) { }
     };
 
     class MessageServer {
@@ -22,22 +22,398 @@
 #ifndef USE_ASIO
 
 
+#include <deque>
+
 #include "mongo/db/lasterror.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/net/message_port.h"
 #include "mongo/util/net/message_server.h"
+#include "mongo/util/net/socket_poll.h"
 #include "mongo/util/net/ssl_manager.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
+# include <sys/epoll.h>
 # include <sys/resource.h>
 #endif
 
 namespace mongo {
 
+    // Number of threads kept running to serve client connections.  When non-zero, and the
+    // handler can move a connection's state between threads, an idle connection waits in an epoll
+    // set instead of holding a thread of its own.  Zero gives each connection its own thread.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionWorkerThreads, int, 0);
+
+    namespace {
+
+        /**
+         * Starts a detached thread running func(arg), with a 1MB stack where we can choose it.
+         * Throws boost::thread_resource_error if the thread can't be created.
+         */
+        void startConnectionThread(void* (*func)(void*), void* arg) {
+#ifndef __linux__  // TODO: consider making this ifdef _WIN32
+            boost::thread thr(boost::bind(func, arg));
+#else
+            pthread_attr_t attrs;
+            pthread_attr_init(&attrs);
+            pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+
+            static const size_t STACK_SIZE = 1024*1024; // if we change this we need to update the warning
+
+            struct rlimit limits;
+            verify(getrlimit(RLIMIT_STACK, &limits) == 0);
+            if (limits.rlim_cur > STACK_SIZE) {
+                pthread_attr_setstacksize(&attrs, (DEBUG_BUILD
+                                                    ? (STACK_SIZE / 2)
+                                                    : STACK_SIZE));
+            } else if (limits.rlim_cur < 1024*1024) {
+                warning() << "Stack size set to " << (limits.rlim_cur/1024) << "KB. We suggest 1MB" << endl;
+            }
+
+
+            pthread_t thread;
+            int failed = pthread_create(&thread, &attrs, func, arg);
+
+            pthread_attr_destroy(&attrs);
+
+            if (failed) {
+                log() << "pthread_create failed: " << errnoWithDescription(failed) << endl;
+                throw boost::thread_resource_error(); // for consistency with boost::thread
+            }
+#endif
+        }
+
+    } // namespace
+
+    class ConnectionReactor;
+
+#ifdef __linux__
+    /**
+     * Serves connections from a pool of worker threads.  A connection holds a worker only while
+     * it has messages to read, process and reply to.  In between, the handler detaches the
+     * connection's state from the thread and its socket waits in an epoll set; the reactor thread
+     * hands connections with data to the workers.
+     *
+     * An operation may wait on one that another connection has yet to send, so a ready
+     * connection never waits for a busy worker: a new worker is started instead.  Workers beyond
+     * the minimum exit after being idle for a while.
+     */
+    class ConnectionReactor : boost::noncopyable {
+    public:
+        ConnectionReactor(MessageHandler* handler, int minWorkers);
+
+        /**
+         * Serves 'p', which holds a connection ticket, until it disconnects.  Takes ownership of
+         * 'p'.
+         */
+        void add(MessagingPort* p);
+
+    private:
+        struct Connection {
+            explicit Connection(MessagingPort* p) :
+                port(p), le(new LastError()), connected(false), registered(false) {
+            }
+
+            scoped_ptr<MessagingPort> port;
+            scoped_ptr<LastError> le;
+
+            // Set between messages, see MessageHandler::detach.
+            auto_ptr<DetachedConnectionState> state;
+
+            string otherSide;
+            bool connected;  // MessageHandler::connected has been called
+            bool registered; // the socket is in _epfd
+        };
+
+        static const int kIdleWorkerExitMillis = 30 * 1000;
+
+        static void* workerThread(void* arg);
+
+        static bool hasDataToRead(MessagingPort* p);
+
+        /** The epoll loop, handing connections whose sockets became readable to the workers. */
+        void _run();
+
+        void _work();
+
+        /** Waits for a connection to serve.  Returns NULL when this worker should exit. */
+        Connection* _next();
+
+        void _enqueue(Connection* c);
+
+        /** Serves the messages 'c' has ready, then hands it back to the epoll set or closes it. */
+        void _serve(Connection* c);
+
+        /** Waits in _epfd for the next message on 'c'.  'c' may be served by another worker once
+         *  this returns true. */
+        bool _arm(Connection* c);
+
+        /** Disconnects 'c' and frees it.  Its state must be attached to the calling thread. */
+        void _close(Connection* c);
+
+        MessageHandler* _handler;
+        const int _minWorkers;
+        int _epfd;
+
+        mongo::mutex _mutex;
+        boost::condition _readyCond;
+
+        // Guarded by _mutex.
+        std::deque<Connection*> _ready;
+        int _workers;
+        int _idleWorkers;
+    };
+
+    ConnectionReactor::ConnectionReactor(MessageHandler* handler, int minWorkers) :
+        _handler(handler),
+        _minWorkers(minWorkers),
+        _epfd(epoll_create(1024)),
+        _mutex("ConnectionReactor"),
+        _workers(0),
+        _idleWorkers(0) {
+
+        if (_epfd < 0) {
+            int err = errno;
+            msgasserted(17299, str::stream() << "epoll_create failed: "
+                                             << errnoWithDescription(err));
+        }
+
+        boost::thread reactor(boost::bind(&ConnectionReactor::_run, this));
+
+        scoped_lock lk(_mutex);
+        for (int i = 0; i < _minWorkers; i++) {
+            startConnectionThread(&ConnectionReactor::workerThread, this);
+            _workers++;
+        }
+    }
+
+    void ConnectionReactor::add(MessagingPort* p) {
+        _enqueue(new Connection(p));
+    }
+
+    void* ConnectionReactor::workerThread(void* arg) {
+        static_cast<ConnectionReactor*>(arg)->_work();
+        return NULL;
+    }
+
+    bool ConnectionReactor::hasDataToRead(MessagingPort* p) {
+        pollfd pfd;
+        pfd.fd = p->psock->rawFD();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        return socketPoll(&pfd, 1, 0) > 0;
+    }
+
+    void ConnectionReactor::_run() {
+        setThreadName("connReactor");
+
+        static const int kMaxEvents = 256;
+        struct epoll_event events[kMaxEvents];
+
+        while (!inShutdown()) {
+            int n = epoll_wait(_epfd, events, kMaxEvents, 1000);
+            if (n < 0) {
+                int err = errno;
+                if (err != EINTR) {
+                    error() << "epoll_wait failed: " << errnoWithDescription(err) << endl;
+                    sleepmillis(10);
+                }
+                continue;
+            }
+
+            for (int i = 0; i < n; i++) {
+                _enqueue(static_cast<Connection*>(events[i].data.ptr));
+            }
+        }
+    }
+
+    void ConnectionReactor::_enqueue(Connection* c) {
+        scoped_lock lk(_mutex);
+        _ready.push_back(c);
+
+        if (_ready.size() > static_cast<size_t>(_idleWorkers)) {
+            try {
+                startConnectionThread(&ConnectionReactor::workerThread, this);
+                _workers++;
+            }
+            catch (boost::thread_resource_error&) {
+                // A running worker takes it when it is done with its current connection.
+                warning() << "can't create new thread, " << _ready.size()
+                          << " connections waiting for workers" << endl;
+            }
+        }
+
+        _readyCond.notify_one();
+    }
+
+    ConnectionReactor::Connection* ConnectionReactor::_next() {
+        scoped_lock lk(_mutex);
+        while (_ready.empty()) {
+            _idleWorkers++;
+            bool woken = _readyCond.timed_wait(lk.boost(),
+                                               incxtimemillis(kIdleWorkerExitMillis));
+            _idleWorkers--;
+
+            if (!woken && _ready.empty() && _workers > _minWorkers) {
+                _workers--;
+                return NULL;
+            }
+        }
+
+        Connection* c = _ready.front();
+        _ready.pop_front();
+        return c;
+    }
+
+    void ConnectionReactor::_work() {
+        setThreadName("connWorker");
+        while (Connection* c = _next()) {
+            _serve(c);
+            setThreadName("connWorker");
+        }
+    }
+
+    void ConnectionReactor::_serve(Connection* c) {
+        MessagingPort* p = c->port.get();
+
+        {
+            string threadName = "conn";
+            if (p->connectionId() > 0)
+                threadName = str::stream() << threadName << p->connectionId();
+            setThreadName(threadName.c_str());
+        }
+
+        // The thread's lastError refers to the connection's while we serve it.
+        lastError.reset(c->le.get());
+
+        // A connection the reactor handed us has data; a new one may not have sent anything yet.
+        bool readable = c->connected;
+        bool open = true;
+
+        Message m;
+        try {
+            if (!c->connected) {
+                c->connected = true;
+                c->otherSide = p->psock->remoteString();
+                p->psock->setLogLevel(logger::LogSeverity::Debug(1));
+                _handler->connected(p);
+            }
+            else {
+                _handler->attach(p, c->state.release());
+            }
+
+            // Keep this connection while it has more messages ready, as a pipelining client does.
+            while (readable || hasDataToRead(p)) {
+                readable = false;
+
+                if (inShutdown()) {
+                    open = false;
+                    break;
+                }
+
+                m.reset();
+                p->clearCounters();
+
+                if (!p->recv(m)) {
+                    if (!serverGlobalParams.quiet) {
+                        int conns = Listener::globalTicketHolder.used()-1;
+                        const char* word = (conns == 1 ? " connection" : " connections");
+                        log() << "end connection " << c->otherSide << " (" << conns << word << " now open)" << endl;
+                    }
+                    open = false;
+                    break;
+                }
+
+                _handler->process(m, p, c->le.get());
+                networkCounter.hit(p->psock->getBytesIn(), p->psock->getBytesOut());
+                networkCounter.hitCompressed(p->getCompressedBytesIn(),
+                                             p->getUncompressedBytesIn(),
+                                             p->getCompressedBytesOut(),
+                                             p->getUncompressedBytesOut());
+            }
+        }
+        catch (AssertionException& e) {
+            log() << "AssertionException handling request, closing client connection: " << e << endl;
+            open = false;
+        }
+        catch (SocketException& e) {
+            log() << "SocketException handling request, closing client connection: " << e << endl;
+            open = false;
+        }
+        catch (const DBException& e) { // must be right above std::exception to avoid catching subclasses
+            log() << "DBException handling request, closing client connection: " << e << endl;
+            open = false;
+        }
+        catch (std::exception &e) {
+            error() << "Uncaught std::exception: " << e.what() << ", terminating" << endl;
+            dbexit( EXIT_UNCAUGHT );
+        }
+        catch (...) {
+            error() << "Uncaught exception, terminating" << endl;
+            dbexit( EXIT_UNCAUGHT );
+        }
+
+        if (!open) {
+            _close(c);
+            return;
+        }
+
+        c->state.reset(_handler->detach(p));
+        lastError.release();
+
+        if (!_arm(c)) {
+            lastError.reset(c->le.get());
+            _handler->attach(p, c->state.release());
+            _close(c);
+        }
+    }
+
+    bool ConnectionReactor::_arm(Connection* c) {
+        int fd = c->port->psock->rawFD();
+        int op = c->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.ptr = c;
+
+        // Nothing may touch 'c' once it is armed, so set this first.
+        bool wasRegistered = c->registered;
+        c->registered = true;
+        if (epoll_ctl(_epfd, op, fd, &event) != 0) {
+            int err = errno;
+            c->registered = wasRegistered;
+            log() << "can't wait for the next message from " << c->otherSide
+                  << ", closing client connection: " << errnoWithDescription(err) << endl;
+            return false;
+        }
+        return true;
+    }
+
+    void ConnectionReactor::_close(Connection* c) {
+        MessagingPort* p = c->port.get();
+
+        if (c->registered) {
+            struct epoll_event event; // ignored, but required by kernels before 2.6.9
+            epoll_ctl(_epfd, EPOLL_CTL_DEL, p->psock->rawFD(), &event);
+        }
+        p->shutdown();
+
+        _handler->disconnected(p);
+
+        // Free the connection's state as the exit of its own thread would have.
+        delete _handler->detach(p);
+        lastError.release();
+
+        delete c;
+        Listener::globalTicketHolder.release();
+    }
+#endif // __linux__
+
     class PortMessageServer : public MessageServer , public Listener {
     public:
         /**
@@ -48,7 +424,7 @@ namespace mongo {
          *     and should make sure that it lives longer than this server.
          */
         PortMessageServer(  const MessageServer::Options& opts, MessageHandler * handler ) :
-            Listener( "" , opts.ipList, opts.port ), _handler(handler) {
+            Listener( "" , opts.ipList, opts.port ), _handler(handler), _reactor(NULL) {
         }
 
         virtual void acceptedMP(MessagingPort * p) {
@@ -65,40 +441,20 @@ namespace mongo {
             }
 
             try {
-#ifndef __linux__  // TODO: consider making this ifdef _WIN32
-                {
-                    HandleIncomingMsgParam* himParam = new HandleIncomingMsgParam(p, _handler);
-                    boost::thread thr(boost::bind(&handleIncomingMsg, himParam));
+#ifdef __linux__
+                if ( _reactor ) {
+                    _reactor->add( p );
+                    return;
                 }
-#else
-                pthread_attr_t attrs;
-                pthread_attr_init(&attrs);
-                pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
-
-                static const size_t STACK_SIZE = 1024*1024; // if we change this we need to update the warning
-
-                struct rlimit limits;
-                verify(getrlimit(RLIMIT_STACK, &limits) == 0);
-                if (limits.rlim_cur > STACK_SIZE) {
-                    pthread_attr_setstacksize(&attrs, (DEBUG_BUILD
-                                                        ? (STACK_SIZE / 2)
-                                                        : STACK_SIZE));
-                } else if (limits.rlim_cur < 1024*1024) {
-                    warning() << "Stack size set to " << (limits.rlim_cur/1024) << "KB. We suggest 1MB" << endl;
-                }
-
-
-                pthread_t thread;
+#endif
                 HandleIncomingMsgParam* himParam = new HandleIncomingMsgParam(p, _handler);
-                int failed = pthread_create(&thread, &attrs, &handleIncomingMsg, himParam);
-
-                pthread_attr_destroy(&attrs);
-
-                if (failed) {
-                    log() << "pthread_create failed: " << errnoWithDescription(failed) << endl;
-                    throw boost::thread_resource_error(); // for consistency with boost::thread
+                try {
+                    startConnectionThread(&handleIncomingMsg, himParam);
+                }
+                catch ( ... ) {
+                    delete himParam;
+                    throw;
                 }
-#endif
             }
             catch ( boost::thread_resource_error& ) {
                 Listener::globalTicketHolder.release();
@@ -130,6 +486,23 @@ namespace mongo {
         }
 
         void run() {
+#ifdef __linux__
+            if ( connectionWorkerThreads > 0 && _handler->canDetach() ) {
+# ifdef MONGO_SSL
+                // A socket's readiness says nothing of the data SSL has already buffered.
+                if ( getSSLManager() ) {
+                    log() << "connectionWorkerThreads is not supported with SSL, starting a "
+                          << "thread for each connection" << endl;
+                }
+                else
+# endif
+                {
+                    log() << "serving connections from " << connectionWorkerThreads
+                          << " or more worker threads" << endl;
+                    _reactor = new ConnectionReactor( _handler, connectionWorkerThreads );
+                }
+            }
+#endif
             initAndListen();
         }
 
@@ -138,6 +511,9 @@ namespace mongo {
     private:
         MessageHandler* _handler;
 
+        // Serves connections when connectionWorkerThreads is set.  Never freed.
+        ConnectionReactor* _reactor;
+
         /**
          * Simple holder for threadRun parameters. Should not destroy the objects it holds -
          * it is the responsibility of the caller to take care of them.
@@ -194,7 +570,7 @@ namespace mongo {
 
                 while ( ! inShutdown() ) {
                     m.reset();
-                    p->psock->clearCounters();
+                    p->clearCounters();
 
                     if ( ! p->recv(m) ) {
                         if (!serverGlobalParams.quiet) {
@@ -208,6 +584,10 @@ namespace mongo {
 
                     handler->process( m , p.get() , le );
                     networkCounter.hit( p->psock->getBytesIn() , p->psock->getBytesOut() );
+                    networkCounter.hitCompressed( p->getCompressedBytesIn(),
+                                                  p->getUncompressedBytesIn(),
+                                                  p->getCompressedBytesOut(),
+                                                  p->getUncompressedBytesOut() );
                 }
             }
             catch ( AssertionException& e ) {
@@ -0,0 +1,204 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message.h"
+
+#include <string>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#endif
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message_port.h"
+
+namespace {
+
+    using mongo::ChunkedMessageBuilder;
+    using mongo::Message;
+    using mongo::MsgData;
+
+    TEST(ChunkedMessageBuilder, SmallMessageIsOneBuffer) {
+        ChunkedMessageBuilder b(sizeof(MsgData) - 4);
+        b.appendBuf("abc", 4);
+        ASSERT_EQUALS(1, b.numChunks());
+        ASSERT_EQUALS(static_cast<int>(sizeof(MsgData)), b.len());
+
+        Message m;
+        b.appendTo(m);
+        ASSERT_EQUALS(static_cast<int>(sizeof(MsgData)), m.size());
+        ASSERT_EQUALS(std::string("abc"), m.singleData()->_data);
+    }
+
+    TEST(ChunkedMessageBuilder, LargeMessageIsChainedAndConcats) {
+        const int headerSize = sizeof(MsgData) - 4;
+        ChunkedMessageBuilder b(headerSize);
+        std::string chunk(1000, 'x');
+        std::string expected;
+        for (int i = 0; i < 3000; i++) {
+            chunk[0] = 'a' + (i % 26);
+            b.appendBuf(chunk.c_str(), chunk.size());
+            expected += chunk;
+        }
+        // One large document gets a buffer of its own.
+        std::string large(3 * ChunkedMessageBuilder::kMaxChunkSize, 'y');
+        b.appendBuf(large.c_str(), large.size());
+        expected += large;
+
+        ASSERT_GREATER_THAN(b.numChunks(), 1);
+        ASSERT_EQUALS(static_cast<int>(headerSize + expected.size()), b.len());
+        reinterpret_cast<MsgData*>(b.header())->setOperation(mongo::opReply);
+
+        Message m;
+        b.appendTo(m);
+        ASSERT_EQUALS(static_cast<int>(headerSize + expected.size()), m.size());
+        ASSERT_EQUALS(static_cast<int>(headerSize + expected.size()), m.header()->len);
+        ASSERT_EQUALS(mongo::opReply, m.operation());
+
+        m.concat();
+        ASSERT_EQUALS(expected, std::string(m.singleData()->_data, expected.size()));
+    }
+
+    TEST(ChunkedMessageBuilder, HeaderOnly) {
+        ChunkedMessageBuilder b(sizeof(MsgData) - 4);
+        Message m;
+        b.appendTo(m);
+        ASSERT_EQUALS(static_cast<int>(sizeof(MsgData) - 4), m.size());
+    }
+
+    TEST(MessageBufferPool, SmallBuffersReusedByThread) {
+        int size;
+        MsgData* buf = mongo::MessageBufferPool::allocate(100, &size);
+        ASSERT_EQUALS(static_cast<int>(mongo::MessageBufferPool::kMinSize), size);
+        mongo::MessageBufferPool::release(buf, size);
+
+        long long reused = mongo::MessageBufferPool::reused();
+        int again;
+        ASSERT_EQUALS(buf, mongo::MessageBufferPool::allocate(1000, &again));
+        ASSERT_EQUALS(size, again);
+        ASSERT_EQUALS(reused + 1, mongo::MessageBufferPool::reused());
+
+        // Given back by a Message taking the buffer
+        Message m;
+        buf->len = 1000;
+        m.setPooledData(buf, again);
+        m.reset();
+        ASSERT_EQUALS(buf, mongo::MessageBufferPool::allocate(500, &again));
+        mongo::MessageBufferPool::release(buf, again);
+    }
+
+    TEST(MessageBufferPool, SizeClasses) {
+        int size;
+        MsgData* buf = mongo::MessageBufferPool::allocate(20 * 1024, &size);
+        ASSERT_EQUALS(32 * 1024, size);
+        mongo::MessageBufferPool::release(buf, size);
+
+        buf = mongo::MessageBufferPool::allocate(mongo::MessageBufferPool::kMaxPooledSize, &size);
+        ASSERT_EQUALS(static_cast<int>(mongo::MessageBufferPool::kMaxPooledSize), size);
+        mongo::MessageBufferPool::release(buf, size);
+
+        // Too large to pool
+        buf = mongo::MessageBufferPool::allocate(mongo::MessageBufferPool::kMaxPooledSize + 1,
+                                                 &size);
+        ASSERT_EQUALS(0, size);
+        mongo::MessageBufferPool::release(buf, size);
+    }
+
+#ifndef _WIN32
+    TEST(MessagingPort, CompressedMessagesArriveUncompressed) {
+        int fds[2];
+        ASSERT_EQUALS(0, ::socketpair(PF_LOCAL, SOCK_STREAM, 0, fds));
+        mongo::MessagingPort sender(boost::shared_ptr<mongo::Socket>(
+                new mongo::Socket(fds[0], mongo::SockAddr())));
+        mongo::MessagingPort receiver(boost::shared_ptr<mongo::Socket>(
+                new mongo::Socket(fds[1], mongo::SockAddr())));
+        sender.setCompressMessages(true);
+
+        std::string large(100 * 1000, 'z');
+        std::string small("small");
+        for (int i = 0; i < 2; i++) {
+            const std::string& body = i == 0 ? large : small;
+            Message toSend;
+            toSend.setData(mongo::dbMsg, body.c_str(), body.size() + 1);
+            sender.say(toSend);
+
+            Message received;
+            ASSERT(receiver.recv(received));
+            ASSERT_EQUALS(mongo::dbMsg, received.operation());
+            ASSERT_EQUALS(toSend.header()->id, received.header()->id);
+            ASSERT_EQUALS(body, std::string(received.singleData()->_data));
+        }
+
+        // Only the large one was worth compressing
+        ASSERT_GREATER_THAN(sender.getCompressedBytesOut(), 0);
+        ASSERT_LESS_THAN(sender.getCompressedBytesOut(), 10 * 1000);
+        ASSERT_EQUALS(receiver.getCompressedBytesIn(), sender.getCompressedBytesOut());
+        ASSERT_EQUALS(static_cast<long long>(mongo::MsgDataHeaderSize + large.size() + 1),
+                      receiver.getUncompressedBytesIn());
+    }
+
+    TEST(MessagingPort, RepliesMatchedToOutstandingRequests) {
+        int fds[2];
+        ASSERT_EQUALS(0, ::socketpair(PF_LOCAL, SOCK_STREAM, 0, fds));
+        mongo::MessagingPort client(boost::shared_ptr<mongo::Socket>(
+                new mongo::Socket(fds[0], mongo::SockAddr())));
+        mongo::MessagingPort server(boost::shared_ptr<mongo::Socket>(
+                new mongo::Socket(fds[1], mongo::SockAddr())));
+
+        const int kRequests = 3;
+        Message requests[kRequests];
+        for (int i = 0; i < kRequests; i++) {
+            std::string body = std::string("request") + char('0' + i);
+            requests[i].setData(mongo::dbQuery, body.c_str(), body.size() + 1);
+            client.say(requests[i]);
+        }
+
+        // Replied to last first
+        Message received[kRequests];
+        for (int i = 0; i < kRequests; i++) {
+            ASSERT(server.recv(received[i]));
+        }
+        for (int i = kRequests - 1; i >= 0; i--) {
+            std::string body = std::string("reply") + char('0' + i);
+            Message reply;
+            reply.setData(mongo::opReply, body.c_str(), body.size() + 1);
+            server.reply(received[i], reply);
+        }
+
+        for (int i = 0; i < kRequests; i++) {
+            Message reply;
+            ASSERT(client.recv(requests[i], reply));
+            ASSERT_EQUALS(std::string("reply") + char('0' + i),
+                          std::string(reply.singleData()->_data));
+        }
+    }
+#endif
+
+} // namespace
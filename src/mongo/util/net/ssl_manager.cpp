@@ -19,16 +19,19 @@
 
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/tss.hpp>
+#include <map>
 #include <string>
 #include <vector>
 
 #include "mongo/base/init.h"
 #include "mongo/bson/util/atomic_int.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/sock.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 #ifdef MONGO_SSL
 #include <openssl/evp.h>
@@ -49,6 +52,19 @@ namespace mongo {
 
     namespace {
 
+        // Stands for this process in the sessions it hands out, so that they are not resumed
+        // in another application's context.
+        const char kSessionIdContext[] = "mongo";
+
+        // Long enough to cover a replica set failover or a mongos restart, and the reconnects
+        // they set off.
+        const long kSessionTimeoutSecs = 30 * 60;
+
+        const long kSessionCacheSize = 20 * 1024;
+
+        // Outgoing connections only go to the members of the cluster.
+        const size_t kMaxClientSessions = 1024;
+
         /**
          * Multithreaded Support for SSL.
          *
@@ -183,6 +199,8 @@ namespace mongo {
 
             virtual std::string getSSLErrorMessage(int code);
 
+            virtual void appendHandshakeStats(BSONObjBuilder* builder);
+
             virtual int SSL_read(SSLConnection* conn, void* buf, int num);
 
             virtual int SSL_write(SSLConnection* conn, const void* buf, int num);
@@ -207,6 +225,35 @@ namespace mongo {
             std::string _serverSubjectName;
             std::string _clientSubjectName;
 
+            /**
+             * Sessions of our outgoing connections, by remote address, offered again the next
+             * time we connect there so the server can skip the full handshake.
+             */
+            typedef std::map<std::string, SSL_SESSION*> SessionMap;
+            SimpleMutex _clientSessionsMutex;
+            SessionMap _clientSessions;
+
+            struct HandshakeStats {
+                AtomicUInt64 handshakes;
+                AtomicUInt64 resumed;
+                AtomicUInt64 totalMicros;
+
+                void hit(const SSLConnection* conn, unsigned long long micros);
+                void append(BSONObjBuilder* builder, const StringData& name) const;
+            };
+            HandshakeStats _acceptStats;
+            HandshakeStats _connectStats;
+
+            /**
+             * Asks to resume the session last negotiated with remote, if there is one.
+             */
+            void _offerClientSession(const std::string& remote, SSLConnection* conn);
+
+            /**
+             * Remembers the session of conn to resume the next connection to remote with.
+             */
+            void _saveClientSession(const std::string& remote, SSLConnection* conn);
+
             /**
              * creates an SSL object to be used for this file descriptor.
              * caller must SSL_free it.
@@ -365,9 +412,12 @@ namespace mongo {
     SSLManagerInterface::~SSLManagerInterface() {}
 
     SSLManager::SSLManager(const Params& params, bool isServer) :
+        _serverContext(NULL),
+        _clientContext(NULL),
         _validateCertificates(false),
         _weakValidation(params.weakCertificateValidation),
-        _allowInvalidCertificates(params.allowInvalidCertificates) {
+        _allowInvalidCertificates(params.allowInvalidCertificates),
+        _clientSessionsMutex("SSL client sessions") {
 
         SSL_library_init();
         SSL_load_error_strings();
@@ -436,6 +486,10 @@ namespace mongo {
         if (NULL != _clientContext) {
             SSL_CTX_free(_clientContext);
         }
+        for (SessionMap::iterator it = _clientSessions.begin();
+             it != _clientSessions.end(); ++it) {
+            SSL_SESSION_free(it->second);
+        }
     }
 
     int SSLManager::password_cb(char *buf,int num, int rwflag,void *userdata) {
@@ -535,8 +589,22 @@ namespace mongo {
         // Note: this is for blocking sockets only.
         SSL_CTX_set_mode(*context, SSL_MODE_AUTO_RETRY);
 
-        // Disable session caching (see SERVER-10261)
-        SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_OFF);
+        // Let returning peers resume their session, by session id or ticket, instead of
+        // paying for a full handshake.  Resuming a session with client certificates fails
+        // unless the session id context is set (see SERVER-10261).  Outgoing connections keep
+        // their sessions in _clientSessions rather than in OpenSSL's cache.
+        if (context == &_serverContext) {
+            SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_set_session_id_context(*context,
+                                           reinterpret_cast<const unsigned char*>(
+                                               kSessionIdContext),
+                                           strlen(kSessionIdContext));
+            SSL_CTX_sess_set_cache_size(*context, kSessionCacheSize);
+        }
+        else {
+            SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_OFF);
+        }
+        SSL_CTX_set_timeout(*context, kSessionTimeoutSecs);
  
         // Use the clusterfile for internal outgoing SSL connections if specified 
         if (context == &_clientContext && !params.clusterfile.empty()) {
@@ -734,7 +802,11 @@ namespace mongo {
         SSLConnection* sslConn = new SSLConnection(_clientContext, socket, NULL, 0);
         ScopeGuard sslGuard = MakeGuard(::SSL_free, sslConn->ssl);
         ScopeGuard bioGuard = MakeGuard(::BIO_free, sslConn->networkBIO);
- 
+
+        const std::string remote = socket->remoteString();
+        _offerClientSession(remote, sslConn);
+
+        Timer t;
         int ret;
         do {
             ret = ::SSL_connect(sslConn->ssl);
@@ -742,7 +814,10 @@ namespace mongo {
  
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn, ret));
- 
+
+        _connectStats.hit(sslConn, t.micros());
+        _saveClientSession(remote, sslConn);
+
         sslGuard.Dismiss();
         bioGuard.Dismiss();
         return sslConn;
@@ -752,7 +827,8 @@ namespace mongo {
         SSLConnection* sslConn = new SSLConnection(_serverContext, socket, initialBytes, len);
         ScopeGuard sslGuard = MakeGuard(::SSL_free, sslConn->ssl);
         ScopeGuard bioGuard = MakeGuard(::BIO_free, sslConn->networkBIO);
- 
+
+        Timer t;
         int ret;
         do {
             ret = ::SSL_accept(sslConn->ssl);
@@ -760,12 +836,63 @@ namespace mongo {
  
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn, ret));
- 
+
+        _acceptStats.hit(sslConn, t.micros());
+
         sslGuard.Dismiss();
         bioGuard.Dismiss();
         return sslConn;
     }
 
+    void SSLManager::_offerClientSession(const std::string& remote, SSLConnection* conn) {
+        SimpleMutex::scoped_lock lk(_clientSessionsMutex);
+        SessionMap::const_iterator it = _clientSessions.find(remote);
+        if (it != _clientSessions.end()) {
+            // takes its own reference, which keeps the session alive if it is replaced
+            SSL_set_session(conn->ssl, it->second);
+        }
+    }
+
+    void SSLManager::_saveClientSession(const std::string& remote, SSLConnection* conn) {
+        SSL_SESSION* session = SSL_get1_session(conn->ssl);
+        if (!session)
+            return;
+
+        SimpleMutex::scoped_lock lk(_clientSessionsMutex);
+        SessionMap::iterator it = _clientSessions.find(remote);
+        if (it != _clientSessions.end()) {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+            return;
+        }
+        if (_clientSessions.size() >= kMaxClientSessions) {
+            SSL_SESSION_free(session);
+            return;
+        }
+        _clientSessions[remote] = session;
+    }
+
+    void SSLManager::HandshakeStats::hit(const SSLConnection* conn, unsigned long long micros) {
+        handshakes.fetchAndAdd(1);
+        if (SSL_session_reused(conn->ssl))
+            resumed.fetchAndAdd(1);
+        totalMicros.fetchAndAdd(micros);
+    }
+
+    void SSLManager::HandshakeStats::append(BSONObjBuilder* builder,
+                                            const StringData& name) const {
+        BSONObjBuilder b(builder->subobjStart(name));
+        b.appendNumber("handshakes", static_cast<long long>(handshakes.load()));
+        b.appendNumber("resumed", static_cast<long long>(resumed.load()));
+        b.appendNumber("totalMicros", static_cast<long long>(totalMicros.load()));
+        b.done();
+    }
+
+    void SSLManager::appendHandshakeStats(BSONObjBuilder* builder) {
+        _acceptStats.append(builder, "accepted");
+        _connectStats.append(builder, "connected");
+    }
+
     // TODO SERVER-11601 Use NFC Unicode canonicalization
     bool SSLManager::_hostNameMatch(const char* nameToMatch, 
                                     const char* certHostName) {
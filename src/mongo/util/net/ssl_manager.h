@@ -19,6 +19,7 @@
 
 #include <string>
 #include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
 #include "mongo/util/net/sock.h"
 
 #include <openssl/err.h>
@@ -97,6 +98,12 @@ namespace mongo {
         * Fetches the error text for an error code, in a thread-safe manner.
         */
         virtual std::string getSSLErrorMessage(int code) = 0;
+
+        /**
+         * Appends the number of handshakes done for incoming and outgoing connections, how
+         * many of them resumed an earlier session, and the time they took.
+         */
+        virtual void appendHandshakeStats(BSONObjBuilder* builder) = 0;
  
         /**
          * ssl.h wrappers 
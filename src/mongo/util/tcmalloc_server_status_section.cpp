@@ -17,7 +17,9 @@
 
 #include <third_party/gperftools-2.0/src/gperftools/malloc_extension.h>
 
+#include "mongo/base/parse_number.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 namespace {
@@ -77,6 +79,91 @@ namespace {
                 builder.appendNumber(bsonName, value);
         }
     } tcmallocServerStatusSection;
+
+    /**
+     * The most tcmalloc's thread caches may hold together.  Lowering it at runtime is the cure
+     * for a resident size blown up by a storm of connections, each caching freed memory.
+     */
+    class TCMallocMaxTotalThreadCacheBytes : public ServerParameter {
+    public:
+        TCMallocMaxTotalThreadCacheBytes()
+            : ServerParameter(ServerParameterSet::getGlobal(),
+                              "tcmallocMaxTotalThreadCacheBytes") {}
+
+        virtual void append(BSONObjBuilder& b, const string& name) {
+            size_t value;
+            if (MallocExtension::instance()->GetNumericProperty(kProperty, &value))
+                b.appendNumber(name, static_cast<long long>(value));
+        }
+
+        virtual Status set(const BSONElement& newValueElement) {
+            if (!newValueElement.isNumber())
+                return Status(ErrorCodes::BadValue,
+                              "tcmallocMaxTotalThreadCacheBytes must be a number");
+            return _set(newValueElement.numberLong());
+        }
+
+        virtual Status setFromString(const string& str) {
+            long long value;
+            Status status = parseNumberFromString(str, &value);
+            if (!status.isOK())
+                return status;
+            return _set(value);
+        }
+
+    private:
+        static Status _set(long long value) {
+            if (value <= 0)
+                return Status(ErrorCodes::BadValue,
+                              "tcmallocMaxTotalThreadCacheBytes must be positive");
+            if (!MallocExtension::instance()->SetNumericProperty(kProperty,
+                                                                 static_cast<size_t>(value)))
+                return Status(ErrorCodes::InternalError,
+                              "tcmalloc would not set max_total_thread_cache_bytes");
+            return Status::OK();
+        }
+
+        static const char* const kProperty;
+    } tcmallocMaxTotalThreadCacheBytes;
+
+    const char* const TCMallocMaxTotalThreadCacheBytes::kProperty =
+        "tcmalloc.max_total_thread_cache_bytes";
+
+    /**
+     * How fast tcmalloc returns free memory to the system: 0 never, 1 its default, 10 about as
+     * fast as it can.
+     */
+    class TCMallocReleaseRate : public ServerParameter {
+    public:
+        TCMallocReleaseRate()
+            : ServerParameter(ServerParameterSet::getGlobal(), "tcmallocReleaseRate") {}
+
+        virtual void append(BSONObjBuilder& b, const string& name) {
+            b.append(name, MallocExtension::instance()->GetMemoryReleaseRate());
+        }
+
+        virtual Status set(const BSONElement& newValueElement) {
+            if (!newValueElement.isNumber())
+                return Status(ErrorCodes::BadValue, "tcmallocReleaseRate must be a number");
+            return _set(newValueElement.numberDouble());
+        }
+
+        virtual Status setFromString(const string& str) {
+            double value;
+            Status status = parseNumberFromString(str, &value);
+            if (!status.isOK())
+                return status;
+            return _set(value);
+        }
+
+    private:
+        static Status _set(double value) {
+            if (value < 0)
+                return Status(ErrorCodes::BadValue, "tcmallocReleaseRate can't be negative");
+            MallocExtension::instance()->SetMemoryReleaseRate(value);
+            return Status::OK();
+        }
+    } tcmallocReleaseRate;
 }
 }
 
@@ -0,0 +1,140 @@
+// @file trace_points.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/util/trace_points.h"
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <set>
+
+#include "mongo/util/concurrency/thread_name.h"
+
+namespace mongo {
+
+    volatile bool TracePoints::_enabled = false;
+
+    namespace {
+
+        /**
+         * The ring of events of one thread.  Only its thread records into it; the mutex is for
+         * getAll() and clear(), so is almost never contended.  Plain boost mutexes are used as
+         * the trace points include the ones in the lock code.
+         */
+        class TraceBuffer {
+        public:
+            TraceBuffer( size_t capacity );
+            ~TraceBuffer();
+
+            void record( const TracePoints::Event& event ) {
+                boost::mutex::scoped_lock lk( _mutex );
+                _events[_recorded % _events.size()] = event;
+                ++_recorded;
+            }
+
+            void appendTo( std::vector<TracePoints::ThreadEvents>* all ) {
+                boost::mutex::scoped_lock lk( _mutex );
+                if ( _recorded == 0 )
+                    return;
+                all->push_back( TracePoints::ThreadEvents() );
+                TracePoints::ThreadEvents& t = all->back();
+                t.threadId = _threadId;
+                t.threadName = _threadName;
+                const size_t n = std::min( _recorded, static_cast<unsigned long long>( _events.size() ) );
+                t.events.reserve( n );
+                for ( unsigned long long i = _recorded - n; i < _recorded; ++i )
+                    t.events.push_back( _events[i % _events.size()] );
+            }
+
+            void clear() {
+                boost::mutex::scoped_lock lk( _mutex );
+                _recorded = 0;
+            }
+
+        private:
+            boost::mutex _mutex;
+            std::vector<TracePoints::Event> _events;
+            unsigned long long _recorded;
+            unsigned long long _threadId;
+            std::string _threadName;
+        };
+
+        // intentional leaks, threads exit while statics are destroyed
+        boost::mutex& buffersMutex = *(new boost::mutex());
+        std::set<TraceBuffer*>& buffers = *(new std::set<TraceBuffer*>());
+        unsigned long long nextThreadId = 1;
+        size_t eventsPerThread = 16384;
+
+        boost::thread_specific_ptr<TraceBuffer> threadBuffer;
+
+        TraceBuffer::TraceBuffer( size_t capacity ) :
+            _events( capacity ), _recorded( 0 ), _threadName( getThreadName() ) {
+            boost::mutex::scoped_lock lk( buffersMutex );
+            _threadId = nextThreadId++;
+            buffers.insert( this );
+        }
+
+        TraceBuffer::~TraceBuffer() {
+            boost::mutex::scoped_lock lk( buffersMutex );
+            buffers.erase( this );
+        }
+
+        void record( const char* category, const char* name, char phase,
+                     long long startMicros, long long durationMicros ) {
+            TraceBuffer* buffer = threadBuffer.get();
+            if ( !buffer ) {
+                size_t capacity;
+                {
+                    boost::mutex::scoped_lock lk( buffersMutex );
+                    capacity = eventsPerThread;
+                }
+                buffer = new TraceBuffer( capacity );
+                threadBuffer.reset( buffer );
+            }
+            TracePoints::Event event = { category, name, phase, startMicros, durationMicros };
+            buffer->record( event );
+        }
+
+    } // namespace
+
+    void TracePoints::setEventsPerThread( size_t n ) {
+        boost::mutex::scoped_lock lk( buffersMutex );
+        eventsPerThread = std::max( n, static_cast<size_t>( 1 ) );
+    }
+
+    void TracePoints::instant( const char* category, const char* name ) {
+        record( category, name, 'i', curTimeMicros64(), 0 );
+    }
+
+    void TracePoints::scope( const char* category, const char* name, long long startMicros ) {
+        record( category, name, 'X', startMicros, curTimeMicros64() - startMicros );
+    }
+
+    void TracePoints::getAll( std::vector<ThreadEvents>* all ) {
+        boost::mutex::scoped_lock lk( buffersMutex );
+        for ( std::set<TraceBuffer*>::const_iterator i = buffers.begin(); i != buffers.end(); ++i )
+            (*i)->appendTo( all );
+    }
+
+    void TracePoints::clear() {
+        boost::mutex::scoped_lock lk( buffersMutex );
+        for ( std::set<TraceBuffer*>::const_iterator i = buffers.begin(); i != buffers.end(); ++i )
+            (*i)->clear();
+    }
+
+} // namespace mongo
@@ -0,0 +1,128 @@
+// @file trace_points.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    /**
+     * Trace points on the server's hot paths: lock acquisition, journal commits, query
+     * execution, replication batches and network messages.  While tracing is enabled each thread
+     * records the trace points it passes in a ring buffer of its own, keeping the most recent
+     * events; while it is disabled a trace point costs a test of one flag.  Building with
+     * --disable-tracing removes the trace points altogether.
+     *
+     * Category and event names must be string literals, or otherwise live forever, as only the
+     * pointers are recorded.  The events of a thread go away when it exits.
+     */
+    class TracePoints {
+    public:
+        struct Event {
+            const char* category;
+            const char* name;
+            char phase;                 // 'X' for a scope, 'i' for an instant
+            long long startMicros;      // since the epoch
+            long long durationMicros;   // 0 for an instant
+        };
+
+        struct ThreadEvents {
+            unsigned long long threadId;
+            std::string threadName;
+            std::vector<Event> events;  // oldest first
+        };
+
+        static bool enabled() { return _enabled; }
+        static void setEnabled( bool enabled ) { _enabled = enabled; }
+
+        /**
+         * Sets how many events each thread keeps, from the next buffer a thread creates on.
+         */
+        static void setEventsPerThread( size_t n );
+
+        static void instant( const char* category, const char* name );
+        static void scope( const char* category, const char* name, long long startMicros );
+
+        /**
+         * Fills all with the buffered events of every thread that has recorded some.
+         */
+        static void getAll( std::vector<ThreadEvents>* all );
+
+        /**
+         * Drops the buffered events of every thread.
+         */
+        static void clear();
+
+    private:
+        static volatile bool _enabled;
+    };
+
+    /**
+     * Records the time from its construction to its destruction as one event, if tracing was
+     * enabled when it was constructed.
+     */
+    class TracePointScope {
+        MONGO_DISALLOW_COPYING(TracePointScope);
+    public:
+        TracePointScope( const char* category, const char* name ) :
+            _category( category ), _name( name ),
+            _startMicros( TracePoints::enabled() ? curTimeMicros64() : 0 ) {}
+
+        ~TracePointScope() {
+            if ( _startMicros )
+                TracePoints::scope( _category, _name, _startMicros );
+        }
+
+    private:
+        const char* _category;
+        const char* _name;
+        long long _startMicros;
+    };
+
+} // namespace mongo
+
+#define MONGO_TRACE_CONCAT_IMPL(a, b) a##b
+#define MONGO_TRACE_CONCAT(a, b) MONGO_TRACE_CONCAT_IMPL(a, b)
+
+#if defined(MONGO_TRACING_DISABLED)
+
+#define MONGO_TRACE_SCOPE(CATEGORY, NAME) do {} while (0)
+#define MONGO_TRACE_INSTANT(CATEGORY, NAME) do {} while (0)
+
+#else
+
+/**
+ * Traces the rest of the enclosing block.
+ */
+#define MONGO_TRACE_SCOPE(CATEGORY, NAME) \
+    ::mongo::TracePointScope MONGO_TRACE_CONCAT(mongoTraceScope, __LINE__)( CATEGORY, NAME )
+
+/**
+ * Traces a point in time.
+ */
+#define MONGO_TRACE_INSTANT(CATEGORY, NAME) \
+    do { \
+        if ( ::mongo::TracePoints::enabled() ) \
+            ::mongo::TracePoints::instant( CATEGORY, NAME ); \
+    } while (0)
+
+#endif
@@ -0,0 +1,126 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <boost/thread/thread.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/trace_points.h"
+
+// The tests go through the trace point macros, which --disable-tracing compiles out.
+#if !defined(MONGO_TRACING_DISABLED)
+
+namespace {
+
+    using mongo::TracePoints;
+
+    /**
+     * The events recorded by the thread named name.
+     */
+    std::vector<TracePoints::Event> eventsOf( const std::string& name ) {
+        std::vector<TracePoints::ThreadEvents> all;
+        TracePoints::getAll( &all );
+        for ( size_t i = 0; i < all.size(); ++i ) {
+            if ( all[i].threadName == name )
+                return all[i].events;
+        }
+        return std::vector<TracePoints::Event>();
+    }
+
+    class TraceTest : public mongo::unittest::Test {
+    public:
+        TraceTest() {
+            TracePoints::clear();
+            TracePoints::setEnabled( true );
+        }
+        virtual ~TraceTest() {
+            TracePoints::setEnabled( false );
+            TracePoints::clear();
+        }
+    };
+
+    TEST_F(TraceTest, RecordsScopesAndInstants) {
+        mongo::setThreadName( "traceTestMain" );
+        {
+            MONGO_TRACE_SCOPE( "test", "scope" );
+            MONGO_TRACE_INSTANT( "test", "instant" );
+        }
+
+        std::vector<TracePoints::Event> events = eventsOf( "traceTestMain" );
+        ASSERT_EQUALS( 2U, events.size() );
+        // The scope is recorded when it ends.
+        ASSERT_EQUALS( std::string( "instant" ), events[0].name );
+        ASSERT_EQUALS( 'i', events[0].phase );
+        ASSERT_EQUALS( std::string( "scope" ), events[1].name );
+        ASSERT_EQUALS( std::string( "test" ), events[1].category );
+        ASSERT_EQUALS( 'X', events[1].phase );
+        ASSERT_LESS_THAN_OR_EQUALS( events[1].startMicros, events[0].startMicros );
+        ASSERT_GREATER_THAN_OR_EQUALS( events[1].durationMicros, 0 );
+    }
+
+    TEST_F(TraceTest, DisabledRecordsNothing) {
+        mongo::setThreadName( "traceTestMain" );
+        TracePoints::setEnabled( false );
+        {
+            MONGO_TRACE_SCOPE( "test", "scope" );
+            MONGO_TRACE_INSTANT( "test", "instant" );
+        }
+        ASSERT_EQUALS( 0U, eventsOf( "traceTestMain" ).size() );
+    }
+
+    TEST_F(TraceTest, ScopeStartedWhileDisabledIsNotRecorded) {
+        mongo::setThreadName( "traceTestMain" );
+        TracePoints::setEnabled( false );
+        {
+            MONGO_TRACE_SCOPE( "test", "scope" );
+            TracePoints::setEnabled( true );
+        }
+        ASSERT_EQUALS( 0U, eventsOf( "traceTestMain" ).size() );
+    }
+
+    void recordNumbered( int n ) {
+        static const char* const names[] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+        mongo::setThreadName( "traceTestRing" );
+        for ( int i = 0; i < n; ++i )
+            MONGO_TRACE_INSTANT( "test", names[i % 10] );
+
+        // The buffer goes away with the thread, so look at it from here.
+        std::vector<TracePoints::Event> events = eventsOf( "traceTestRing" );
+        ASSERT_EQUALS( 4U, events.size() );
+        for ( int i = 0; i < 4; ++i )
+            ASSERT_EQUALS( std::string( names[( n - 4 + i ) % 10] ), events[i].name );
+    }
+
+    TEST_F(TraceTest, RingKeepsTheLatestEvents) {
+        TracePoints::setEventsPerThread( 4 );
+        boost::thread t( recordNumbered, 7 );
+        t.join();
+        TracePoints::setEventsPerThread( 16384 );
+        ASSERT_EQUALS( 0U, eventsOf( "traceTestRing" ).size() );
+    }
+
+    TEST_F(TraceTest, ClearDropsEvents) {
+        mongo::setThreadName( "traceTestMain" );
+        MONGO_TRACE_INSTANT( "test", "instant" );
+        ASSERT_EQUALS( 1U, eventsOf( "traceTestMain" ).size() );
+        TracePoints::clear();
+        ASSERT_EQUALS( 0U, eventsOf( "traceTestMain" ).size() );
+    }
+
+} // namespace
+
+#endif